@@ -1,7 +1,130 @@
 use std::fs;
+use std::path::{Path, PathBuf};
 use std::process::Command;
 
+// GPU families a shader library is precompiled for, with the defines that specialize it. Apple GPUs get the passes
+// that keep their attachments in tile memory, the others are built without them.
+const FAMILIES: [(&str, &[&str]); 2] = [
+    ("apple", &["-DRFW_TILE_MEMORY=1"]),
+    ("mac2", &["-DRFW_TILE_MEMORY=0"]),
+];
+
+fn run(command: &mut Command, description: &str) {
+    match command.output() {
+        Ok(output) => {
+            if !output.stdout.is_empty() {
+                println!("\tstdout: {}", unsafe {
+                    String::from_utf8_unchecked(output.stdout)
+                });
+            }
+            if !output.stderr.is_empty() {
+                eprintln!("\tstderr: {}", unsafe {
+                    String::from_utf8_unchecked(output.stderr)
+                });
+            }
+
+            if !output.status.success() {
+                panic!("Could not {}", description);
+            }
+        }
+        Err(e) => {
+            panic!("Could not {}: {}", description, e);
+        }
+    }
+}
+
+// SDK the shaders are compiled against, iOS and iPadOS builds use the device or simulator SDK. Both families keep
+// their names there, every Apple GPU family of iOS takes the library with the tile memory passes.
+fn shader_sdk() -> &'static str {
+    match std::env::var("CARGO_CFG_TARGET_OS").as_deref() {
+        Ok("ios") => {
+            if std::env::var("TARGET").map_or(false, |t| t.contains("sim")) {
+                "iphonesimulator"
+            } else {
+                "iphoneos"
+            }
+        }
+        _ => "macosx",
+    }
+}
+
+// Compiles a shader source to a metallib for a GPU family and returns the paths of the files it wrote.
+fn compile_library(path: &Path, sdk: &str, family: &str, defines: &[&str]) -> (PathBuf, PathBuf) {
+    let stem = path.file_stem().unwrap().to_str().unwrap();
+    let out = path.with_file_name(format!("{}_{}.air", stem, family));
+    let lib_out = out.with_extension("metallib");
+
+    run(
+        Command::new("xcrun")
+            .arg("-sdk")
+            .arg(sdk)
+            .arg("metal")
+            // Keeps the position of invariant vertex outputs bit-identical across pipelines, which the depth
+            // pre-pass relies on.
+            .arg("-fpreserve-invariance")
+            .args(defines)
+            .arg("-c")
+            .arg(format!("{}", path.display()))
+            .arg("-o")
+            .arg(format!("{}", out.display())),
+        format!("compile {} for {}", path.display(), family).as_str(),
+    );
+
+    run(
+        Command::new("xcrun")
+            .arg("-sdk")
+            .arg(sdk)
+            .arg("metallib")
+            .arg(format!("{}", out.display()))
+            .arg("-o")
+            .arg(format!("{}", lib_out.display())),
+        format!("convert {} to a metallib", out.display()).as_str(),
+    );
+
+    (out, lib_out)
+}
+
+// Writes the libraries of every family as constant arrays, which are placed in the read-only data of the binary so
+// the library of the GPU in use is read straight from the mapped executable and the others are never paged in. Keys
+// identify the contents of a library for the pipeline archives without reading it.
+fn write_library_header(path: &Path, libraries: &[(&str, PathBuf)]) {
+    let stem = path.file_stem().unwrap().to_str().unwrap();
+    let mut header = String::from(
+        "// Generated by build.rs from the precompiled shader libraries, do not edit.\n",
+    );
+    for (family, lib_out) in libraries {
+        let bytes =
+            fs::read(lib_out).expect(format!("Could not read {}", lib_out.display()).as_str());
+        let digest = md5::compute(&bytes);
+        let mut key = [0u8; 8];
+        key.copy_from_slice(&digest[..8]);
+
+        let name = format!("{}_{}_metallib", stem, family);
+        header += format!("\nstatic const unsigned char {}[] = {{", name).as_str();
+        for (i, byte) in bytes.iter().enumerate() {
+            header += if i % 12 == 0 { "\n    " } else { " " };
+            header += format!("0x{:02x},", byte).as_str();
+        }
+        header += "\n};\n";
+        header += format!(
+            "static const unsigned long {}_len = {};\n",
+            name,
+            bytes.len()
+        )
+        .as_str();
+        header += format!(
+            "static const unsigned long long {}_key = 0x{:016x}ULL;\n",
+            name,
+            u64::from_le_bytes(key)
+        )
+        .as_str();
+    }
+
+    fs::write(path, header).expect(format!("Could not write {}", path.display()).as_str());
+}
+
 fn main() {
+    let sdk = shader_sdk();
     let mut files_to_ignore = Vec::new();
     for path in fs::read_dir("cpp/src")
         .unwrap()
@@ -15,69 +138,17 @@ fn main() {
         })
     {
         let path = path.path();
-        let out = path.with_extension("air");
-
-        match Command::new("xcrun")
-            .arg("-sdk")
-            .arg("macosx")
-            .arg("metal")
-            .arg("-c")
-            .arg(format!("{}", path.display()))
-            .arg("-o")
-            .arg(format!("{}", out.display()))
-            .spawn()
-        {
-            Ok(c) => {
-                let output = c
-                    .wait_with_output()
-                    .expect(format!("Failed to compile: {}", path.display()).as_str());
-
-                if !output.stdout.is_empty() {
-                    println!("\tstdout: {}", unsafe {
-                        String::from_utf8_unchecked(output.stdout)
-                    });
-                }
-                if !output.stderr.is_empty() {
-                    eprintln!("\tstderr: {}", unsafe {
-                        String::from_utf8_unchecked(output.stderr)
-                    });
-                }
-
-                if !output.status.success() {
-                    panic!("Could not compile: {}", out.display());
-                }
-
-                let lib_out = out.with_extension("metallib");
-                Command::new("xcrun")
-                    .arg("-sdk")
-                    .arg("macosx")
-                    .arg("metallib")
-                    .arg(format!("{}", out.display()))
-                    .arg("-o")
-                    .arg(format!("{}", lib_out.display()))
-                    .spawn()
-                    .unwrap()
-                    .wait()
-                    .expect("Could not convert to metallib");
-
-                let out_path = out.with_extension("h");
-                Command::new("xxd")
-                    .arg("-i")
-                    .arg(format!("{}", lib_out.display()))
-                    .arg(format!("{}", out_path.display()))
-                    .spawn()
-                    .unwrap()
-                    .wait_with_output()
-                    .unwrap();
-
-                files_to_ignore.push(out);
-                files_to_ignore.push(lib_out);
-                files_to_ignore.push(out_path);
-            }
-            Err(e) => {
-                panic!("Could not compile {}: {}", out.display(), e);
-            }
+        let mut libraries = Vec::new();
+        for (family, defines) in FAMILIES.iter() {
+            let (out, lib_out) = compile_library(&path, sdk, family, defines);
+            files_to_ignore.push(out);
+            files_to_ignore.push(lib_out.clone());
+            libraries.push((*family, lib_out));
         }
+
+        let out_path = path.with_extension("h");
+        write_library_header(&out_path, &libraries);
+        files_to_ignore.push(out_path);
     }
 
     cc::Build::new()
@@ -91,6 +162,19 @@ fn main() {
 
     println!("cargo:rustc-link-lib=framework=Metal");
     println!("cargo:rustc-link-lib=framework=QuartzCore");
+    println!("cargo:rustc-link-lib=framework=CoreGraphics");
+    if sdk != "macosx" {
+        println!("cargo:rustc-link-lib=framework=UIKit");
+    }
+    // Wraps the pixel buffers of video frames as textures.
+    println!("cargo:rustc-link-lib=framework=CoreVideo");
+    // Encodes the frames of video streams.
+    println!("cargo:rustc-link-lib=framework=CoreMedia");
+    println!("cargo:rustc-link-lib=framework=VideoToolbox");
+    // Compresses command captures.
+    println!("cargo:rustc-link-lib=compression");
+    // Weakly linked so the library still loads on systems without MetalFX, which then upscale bilinearly.
+    println!("cargo:rustc-link-arg=-Wl,-weak_framework,MetalFX");
 
     for path in fs::read_dir("cpp/src")
         .unwrap()
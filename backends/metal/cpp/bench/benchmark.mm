@@ -0,0 +1,505 @@
+// Headless benchmark of the Metal backend. Renders synthetic scenes into an offscreen target and prints the CPU time
+// of synchronize and render, the GPU time and the bytes handed to the renderer per frame as JSON, so runs can be
+// compared between commits.
+//
+// Usage: MetalCppBenchmark [--frames N] [--width W] [--height H] [--scenario NAME]
+
+#import <Foundation/Foundation.h>
+
+#include "../src/library.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace
+{
+
+constexpr unsigned int WARMUP_FRAMES = 10;
+constexpr unsigned int CUBE_VERTICES = 36;
+
+struct Options
+{
+    unsigned int frames = 300;
+    unsigned int width = 1280;
+    unsigned int height = 720;
+    const char *scenario = nullptr;
+};
+
+struct Summary
+{
+    double mean = 0.0;
+    double p50 = 0.0;
+    double p95 = 0.0;
+    double max = 0.0;
+};
+
+Summary summarize(std::vector<double> values)
+{
+    Summary summary = {};
+    if (values.empty())
+        return summary;
+
+    std::sort(values.begin(), values.end());
+    for (const double value : values)
+        summary.mean += value;
+    summary.mean /= static_cast<double>(values.size());
+    summary.p50 = values[values.size() / 2];
+    summary.p95 = values[std::min(values.size() - 1, values.size() * 95 / 100)];
+    summary.max = values.back();
+    return summary;
+}
+
+// Samples of the measured frames of one scenario.
+struct Samples
+{
+    // Time of the scenario's set_* calls, including generating their data.
+    std::vector<double> update_ms;
+    std::vector<double> synchronize_ms;
+    std::vector<double> render_ms;
+    std::vector<double> gpu_ms;
+    std::vector<double> uploads_gpu_ms;
+    std::vector<double> bytes;
+    unsigned int draws = 0;
+    unsigned int triangles = 0;
+};
+
+// Vertices of a unit cube around the origin as a triangle list.
+std::vector<Vertex3D> cube(float size, unsigned int material)
+{
+    static const float corners[8][3] = {{-1, -1, -1}, {1, -1, -1}, {1, 1, -1}, {-1, 1, -1},
+                                        {-1, -1, 1},  {1, -1, 1},  {1, 1, 1},  {-1, 1, 1}};
+    static const unsigned int faces[6][4] = {{0, 3, 2, 1}, {4, 5, 6, 7}, {0, 4, 7, 3},
+                                             {1, 2, 6, 5}, {0, 1, 5, 4}, {3, 7, 6, 2}};
+    static const float normals[6][3] = {{0, 0, -1}, {0, 0, 1}, {-1, 0, 0}, {1, 0, 0}, {0, -1, 0}, {0, 1, 0}};
+
+    std::vector<Vertex3D> vertices;
+    vertices.reserve(CUBE_VERTICES);
+    for (unsigned int f = 0; f < 6; f++)
+    {
+        const unsigned int corner_order[6] = {0, 1, 2, 0, 2, 3};
+        for (const unsigned int c : corner_order)
+        {
+            const float *p = corners[faces[f][c]];
+            Vertex3D v = {};
+            v.v_x = p[0] * size;
+            v.v_y = p[1] * size;
+            v.v_z = p[2] * size;
+            v.v_w = 1.0f;
+            v.n_x = normals[f][0];
+            v.n_y = normals[f][1];
+            v.n_z = normals[f][2];
+            v.mat_id = material;
+            v.u = c == 1 || c == 2 ? 1.0f : 0.0f;
+            v.v = c >= 2 ? 1.0f : 0.0f;
+            v.t_w = 1.0f;
+            vertices.push_back(v);
+        }
+    }
+    return vertices;
+}
+
+// Triangles scattered within the unit cube, different for every seed, used for streamed meshes.
+std::vector<Vertex3D> noise_mesh(unsigned int triangles, unsigned int seed)
+{
+    std::vector<Vertex3D> vertices(triangles * 3);
+    for (size_t i = 0; i < vertices.size(); i++)
+    {
+        const float t = static_cast<float>(i + seed) * 0.618034f;
+        Vertex3D &v = vertices[i];
+        v.v_x = std::sin(t * 1.3f);
+        v.v_y = std::cos(t * 0.7f);
+        v.v_z = std::sin(t * 2.1f);
+        v.v_w = 1.0f;
+        v.n_y = 1.0f;
+        v.t_w = 1.0f;
+    }
+    return vertices;
+}
+
+simd_float4x4 translation(float x, float y, float z)
+{
+    simd_float4x4 matrix = matrix_identity_float4x4;
+    matrix.columns[3] = simd_make_float4(x, y, z, 1.0f);
+    return matrix;
+}
+
+Aabb bounds(float size)
+{
+    Aabb aabb = {};
+    aabb.bmin = simd_make_float4(-size, -size, -size, 0.0f);
+    aabb.bmax = simd_make_float4(size, size, size, 0.0f);
+    return aabb;
+}
+
+// Instances laid out on a grid in front of the camera, offset by phase so churned instances actually move.
+void grid_matrices(std::vector<simd_float4x4> &matrices, unsigned int mesh, unsigned int count, float phase)
+{
+    matrices.resize(count);
+    const auto side = static_cast<unsigned int>(std::ceil(std::sqrt(static_cast<double>(count))));
+    for (unsigned int i = 0; i < count; i++)
+    {
+        const float x = static_cast<float>(i % side) * 3.0f - static_cast<float>(side) * 1.5f;
+        const float z = -static_cast<float>(i / side) * 3.0f - 10.0f - static_cast<float>(mesh % 16) * 2.0f;
+        const float y = static_cast<float>(mesh / 16) * 3.0f - 24.0f + std::sin(phase + static_cast<float>(i));
+        matrices[i] = translation(x, y, z);
+    }
+}
+
+CameraView3D camera(const Options &options)
+{
+    CameraView3D view = {};
+    view.pos = {0.0f, 0.0f, 10.0f};
+    view.direction = {0.0f, 0.0f, -1.0f};
+    view.up = {0.0f, 1.0f, 0.0f};
+    view.right = {1.0f, 0.0f, 0.0f};
+    view.inv_width = 1.0f / static_cast<float>(options.width);
+    view.inv_height = 1.0f / static_cast<float>(options.height);
+    view.aspect_ratio = static_cast<float>(options.width) / static_cast<float>(options.height);
+    view.near_plane = 0.1f;
+    view.far_plane = 1000.0f;
+    view.fov = 1.0f;
+    return view;
+}
+
+void set_default_materials(void *instance, unsigned int count, int textures)
+{
+    std::vector<DeviceMaterial> materials(std::max(count, 1u));
+    for (size_t i = 0; i < materials.size(); i++)
+    {
+        DeviceMaterial &m = materials[i];
+        m.c_r = 0.8f;
+        m.c_g = 0.8f;
+        m.c_b = 0.8f;
+        m.c_a = 1.0f;
+        m.diffuse_map = textures > 0 ? static_cast<int>(i % static_cast<size_t>(textures)) : -1;
+        m.normal_map = -1;
+        m.metallic_roughness_map = -1;
+        m.emissive_map = -1;
+        m.sheen_map = -1;
+    }
+    set_materials(instance, materials.data(), static_cast<unsigned int>(materials.size()), nullptr, 0);
+}
+
+// Mesh data is read from the caller's memory until synchronize, so vertices keeps the cubes alive.
+void set_cubes(void *instance, unsigned int meshes, unsigned int instances_per_mesh,
+               std::vector<std::vector<Vertex3D>> &vertices, std::vector<std::vector<simd_float4x4>> &matrices,
+               unsigned int materials)
+{
+    vertices.resize(meshes);
+    matrices.resize(meshes);
+    for (unsigned int id = 0; id < meshes; id++)
+    {
+        vertices[id] = cube(1.0f, materials > 0 ? id % materials : 0);
+        MeshData3D mesh = {};
+        mesh.vertices = vertices[id].data();
+        mesh.num_vertices = static_cast<unsigned int>(vertices[id].size());
+        mesh.bounds = bounds(1.0f);
+        mesh.flags = SHADOW_CASTER;
+        set_3d_mesh(instance, id, mesh);
+
+        grid_matrices(matrices[id], id, instances_per_mesh, 0.0f);
+        InstancesData3D data = {};
+        data.local_aabb = bounds(1.0f);
+        data.matrices = matrices[id].data();
+        data.num_matrices = instances_per_mesh;
+        set_3d_instances(instance, id, data);
+    }
+}
+
+double elapsed_ms(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Renders warmup and measured frames, update is called before every frame's synchronize and returns the bytes of
+// data it handed to the renderer.
+Samples run_frames(void *instance, const Options &options, const std::function<size_t(unsigned int)> &update)
+{
+    const CameraView3D view = camera(options);
+    const simd_float4x4 matrix_2d = matrix_identity_float4x4;
+
+    Samples samples;
+    for (unsigned int frame = 0; frame < WARMUP_FRAMES + options.frames; frame++)
+    {
+        auto start = std::chrono::steady_clock::now();
+        const size_t bytes = update ? update(frame) : 0;
+        const double update_ms = elapsed_ms(start);
+
+        start = std::chrono::steady_clock::now();
+        synchronize(instance);
+        const double synchronize_ms = elapsed_ms(start);
+
+        start = std::chrono::steady_clock::now();
+        render(instance, matrix_2d, view, RENDER_DEFAULT);
+        const double render_ms = elapsed_ms(start);
+
+        if (frame < WARMUP_FRAMES)
+            continue;
+
+        // Stats lag behind by the frames in flight, which evens out over the measured frames.
+        FrameStats stats = {};
+        get_frame_stats(instance, &stats);
+        samples.update_ms.push_back(update_ms);
+        samples.synchronize_ms.push_back(synchronize_ms);
+        samples.render_ms.push_back(render_ms);
+        samples.gpu_ms.push_back(stats.frame_ms);
+        samples.uploads_gpu_ms.push_back(stats.uploads_ms);
+        samples.bytes.push_back(static_cast<double>(bytes));
+        samples.draws = stats.draws;
+        samples.triangles = stats.triangles;
+    }
+    return samples;
+}
+
+void print_summary(const char *name, const Summary &summary, bool last)
+{
+    printf("      \"%s\": {\"mean\": %.4f, \"p50\": %.4f, \"p95\": %.4f, \"max\": %.4f}%s\n", name, summary.mean,
+           summary.p50, summary.p95, summary.max, last ? "" : ",");
+}
+
+void print_scenario(const char *name, const std::string &params, const Samples &samples, bool first)
+{
+    printf("%s    {\n", first ? "" : ",\n");
+    printf("      \"name\": \"%s\",\n", name);
+    printf("      \"params\": {%s},\n", params.c_str());
+    printf("      \"draws\": %u,\n", samples.draws);
+    printf("      \"triangles\": %u,\n", samples.triangles);
+    print_summary("update_ms", summarize(samples.update_ms), false);
+    print_summary("synchronize_ms", summarize(samples.synchronize_ms), false);
+    print_summary("render_ms", summarize(samples.render_ms), false);
+    print_summary("gpu_ms", summarize(samples.gpu_ms), false);
+    print_summary("uploads_gpu_ms", summarize(samples.uploads_gpu_ms), false);
+    print_summary("bytes_uploaded", summarize(samples.bytes), true);
+    printf("    }");
+}
+
+void *create_renderer(const Options &options)
+{
+    void *instance = create_instance(nullptr, nullptr, options.width, options.height, 1.0);
+    if (instance)
+        wait_for_pipelines(instance);
+    return instance;
+}
+
+// N meshes with M instances each that never change after the first frame.
+void static_meshes(const Options &options, bool &first)
+{
+    const unsigned int configs[][2] = {{64, 16}, {256, 64}, {1024, 16}, {16, 4096}};
+    for (const auto &config : configs)
+    {
+        void *instance = create_renderer(options);
+        if (!instance)
+            return;
+
+        std::vector<std::vector<Vertex3D>> vertices;
+        std::vector<std::vector<simd_float4x4>> matrices;
+        set_default_materials(instance, 1, 0);
+        set_cubes(instance, config[0], config[1], vertices, matrices, 1);
+        const Samples samples = run_frames(instance, options, nullptr);
+
+        print_scenario("static_meshes",
+                       "\"meshes\": " + std::to_string(config[0]) + ", \"instances\": " + std::to_string(config[1]),
+                       samples, first);
+        first = false;
+        destroy_instance(instance);
+    }
+}
+
+// Textures set once per run at a growing count, every cube samples one of them.
+void texture_sweep(const Options &options, bool &first)
+{
+    constexpr unsigned int TEXTURE_SIZE = 256;
+    const unsigned int counts[] = {16, 64, 256, 1024};
+    std::vector<unsigned char> pixels(TEXTURE_SIZE * TEXTURE_SIZE * 4);
+    for (size_t i = 0; i < pixels.size(); i++)
+        pixels[i] = static_cast<unsigned char>(i * 31);
+
+    for (const unsigned int count : counts)
+    {
+        void *instance = create_renderer(options);
+        if (!instance)
+            return;
+
+        std::vector<TextureData> textures(count);
+        for (TextureData &texture : textures)
+        {
+            texture.width = TEXTURE_SIZE;
+            texture.height = TEXTURE_SIZE;
+            texture.mip_levels = 1;
+            texture.bytes = pixels.data();
+            texture.num_bytes = pixels.size();
+            texture.format = RGBA8;
+        }
+
+        std::vector<std::vector<Vertex3D>> vertices;
+        std::vector<std::vector<simd_float4x4>> matrices;
+        set_default_materials(instance, count, static_cast<int>(count));
+        set_cubes(instance, 256, 4, vertices, matrices, count);
+
+        const auto start = std::chrono::steady_clock::now();
+        set_textures(instance, textures.data(), count, nullptr, 0);
+        const double set_textures_ms = elapsed_ms(start);
+        const size_t texture_bytes = static_cast<size_t>(count) * pixels.size();
+
+        const Samples samples = run_frames(instance, options, [&](unsigned int frame) -> size_t {
+            return frame == 0 ? texture_bytes : 0;
+        });
+
+        char set_ms[64];
+        snprintf(set_ms, sizeof(set_ms), "%.4f", set_textures_ms);
+        print_scenario("texture_sweep",
+                       "\"textures\": " + std::to_string(count) + ", \"size\": " + std::to_string(TEXTURE_SIZE) +
+                           ", \"set_textures_ms\": " + set_ms,
+                       samples, first);
+        first = false;
+        destroy_instance(instance);
+    }
+}
+
+// Every instance of every mesh moves every frame.
+void instance_churn(const Options &options, bool &first)
+{
+    const unsigned int configs[][2] = {{256, 64}, {1024, 16}};
+    for (const auto &config : configs)
+    {
+        void *instance = create_renderer(options);
+        if (!instance)
+            return;
+
+        std::vector<std::vector<Vertex3D>> vertices;
+        std::vector<std::vector<simd_float4x4>> matrices;
+        set_default_materials(instance, 1, 0);
+        set_cubes(instance, config[0], config[1], vertices, matrices, 1);
+
+        std::vector<unsigned int> ids(config[0]);
+        std::vector<InstancesData3D> data(config[0]);
+        const Samples samples = run_frames(instance, options, [&](unsigned int frame) -> size_t {
+            size_t bytes = 0;
+            for (unsigned int id = 0; id < config[0]; id++)
+            {
+                grid_matrices(matrices[id], id, config[1], static_cast<float>(frame) * 0.1f);
+                ids[id] = id;
+                data[id] = {};
+                data[id].local_aabb = bounds(1.0f);
+                data[id].matrices = matrices[id].data();
+                data[id].num_matrices = config[1];
+                bytes += config[1] * sizeof(simd_float4x4);
+            }
+            set_3d_instances_batch(instance, ids.data(), data.data(), config[0]);
+            return bytes;
+        });
+
+        print_scenario("instance_churn",
+                       "\"meshes\": " + std::to_string(config[0]) + ", \"instances\": " + std::to_string(config[1]),
+                       samples, first);
+        first = false;
+        destroy_instance(instance);
+    }
+}
+
+// Meshes are replaced every frame, as when streaming in level of detail or terrain tiles.
+void mesh_streaming(const Options &options, bool &first)
+{
+    const unsigned int configs[][2] = {{8, 4096}, {64, 1024}};
+    constexpr unsigned int MESHES = 256;
+    for (const auto &config : configs)
+    {
+        void *instance = create_renderer(options);
+        if (!instance)
+            return;
+
+        std::vector<std::vector<Vertex3D>> vertices;
+        std::vector<std::vector<simd_float4x4>> matrices;
+        set_default_materials(instance, 1, 0);
+        set_cubes(instance, MESHES, 4, vertices, matrices, 1);
+
+        std::vector<std::vector<Vertex3D>> streamed(config[0]);
+        const Samples samples = run_frames(instance, options, [&](unsigned int frame) -> size_t {
+            size_t bytes = 0;
+            for (unsigned int i = 0; i < config[0]; i++)
+            {
+                const unsigned int id = (frame * config[0] + i) % MESHES;
+                streamed[i] = noise_mesh(config[1], frame + i);
+                MeshData3D mesh = {};
+                mesh.vertices = streamed[i].data();
+                mesh.num_vertices = static_cast<unsigned int>(streamed[i].size());
+                mesh.bounds = bounds(1.0f);
+                set_3d_mesh(instance, id, mesh);
+                bytes += streamed[i].size() * sizeof(Vertex3D);
+            }
+            return bytes;
+        });
+
+        print_scenario("mesh_streaming",
+                       "\"meshes_per_frame\": " + std::to_string(config[0]) +
+                           ", \"triangles_per_mesh\": " + std::to_string(config[1]),
+                       samples, first);
+        first = false;
+        destroy_instance(instance);
+    }
+}
+
+bool parse(int argc, char **argv, Options &options)
+{
+    for (int i = 1; i < argc; i++)
+    {
+        const bool has_value = i + 1 < argc;
+        if (strcmp(argv[i], "--frames") == 0 && has_value)
+            options.frames = static_cast<unsigned int>(std::max(1, atoi(argv[++i])));
+        else if (strcmp(argv[i], "--width") == 0 && has_value)
+            options.width = static_cast<unsigned int>(std::max(1, atoi(argv[++i])));
+        else if (strcmp(argv[i], "--height") == 0 && has_value)
+            options.height = static_cast<unsigned int>(std::max(1, atoi(argv[++i])));
+        else if (strcmp(argv[i], "--scenario") == 0 && has_value)
+            options.scenario = argv[++i];
+        else
+            return false;
+    }
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+    Options options;
+    if (!parse(argc, argv, options))
+    {
+        fprintf(stderr, "Usage: %s [--frames N] [--width W] [--height H] [--scenario NAME]\n", argv[0]);
+        return 1;
+    }
+
+    const struct
+    {
+        const char *name;
+        void (*run)(const Options &, bool &);
+    } scenarios[] = {{"static_meshes", static_meshes},
+                     {"texture_sweep", texture_sweep},
+                     {"instance_churn", instance_churn},
+                     {"mesh_streaming", mesh_streaming}};
+
+    @autoreleasepool
+    {
+        printf("{\n  \"frames\": %u,\n  \"width\": %u,\n  \"height\": %u,\n  \"scenarios\": [\n", options.frames,
+               options.width, options.height);
+        bool first = true;
+        for (const auto &scenario : scenarios)
+        {
+            if (options.scenario && strcmp(options.scenario, scenario.name) != 0)
+                continue;
+            @autoreleasepool
+            {
+                scenario.run(options, first);
+            }
+        }
+        printf("\n  ]\n}\n");
+    }
+    return 0;
+}
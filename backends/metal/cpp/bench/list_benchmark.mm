@@ -0,0 +1,300 @@
+// Microbenchmarks of the CPU side of VertexList and InstanceList. The lists run on host memory through
+// HostAllocator, so only their bookkeeping and copies are measured, without a device, driver or frames in flight.
+// Every benchmark prints the time of one iteration in milliseconds as JSON, for 1k, 10k and 100k meshes.
+//
+// Usage: MetalCppListBenchmark [--repetitions N] [--benchmark NAME]
+
+#import <Foundation/Foundation.h>
+
+#include "../src/host_buffer.hpp"
+#include "../src/instance_list.h"
+#include "../src/library.h"
+#include "../src/vertex_list.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+namespace
+{
+
+constexpr unsigned int MESH_COUNTS[] = {1000, 10000, 100000};
+constexpr unsigned int VERTICES_PER_MESH = 36;
+constexpr unsigned int INSTANCES_PER_MESH = 16;
+
+using Vertices = VertexList<Vertex3D, JointData, HostAllocator>;
+using Instances = InstanceList<glm::mat4, InstanceTransform, HostAllocator>;
+
+struct Options
+{
+    unsigned int repetitions = 10;
+    const char *benchmark = nullptr;
+};
+
+struct Summary
+{
+    double mean = 0.0;
+    double p50 = 0.0;
+    double p95 = 0.0;
+    double max = 0.0;
+};
+
+Summary summarize(std::vector<double> values)
+{
+    Summary summary = {};
+    if (values.empty())
+        return summary;
+
+    std::sort(values.begin(), values.end());
+    for (const double value : values)
+        summary.mean += value;
+    summary.mean /= static_cast<double>(values.size());
+    summary.p50 = values[values.size() / 2];
+    summary.p95 = values[std::min(values.size() - 1, values.size() * 95 / 100)];
+    summary.max = values.back();
+    return summary;
+}
+
+double elapsed_ms(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Mesh and instance data every list points at. Meshes share it, the lists only see pointers and counts.
+struct Data
+{
+    Data()
+        : vertices(VERTICES_PER_MESH), moved_vertices(VERTICES_PER_MESH), matrices(INSTANCES_PER_MESH, glm::mat4(1.0f)),
+          moved_matrices(INSTANCES_PER_MESH, glm::mat4(1.0f))
+    {
+        for (unsigned int i = 0; i < VERTICES_PER_MESH; i++)
+        {
+            vertices[i].v_x = static_cast<float>(i % 3);
+            vertices[i].v_y = static_cast<float>(i / 3);
+            vertices[i].v_w = 1.0f;
+            moved_vertices[i] = vertices[i];
+            moved_vertices[i].v_z = 1.0f;
+        }
+        for (unsigned int i = 0; i < INSTANCES_PER_MESH; i++)
+            moved_matrices[i][3] = glm::vec4(static_cast<float>(i), 0.0f, 0.0f, 1.0f);
+    }
+
+    std::vector<Vertex3D> vertices;
+    std::vector<Vertex3D> moved_vertices;
+    std::vector<glm::mat4> matrices;
+    std::vector<glm::mat4> moved_matrices;
+};
+
+const Data &data()
+{
+    static const Data data;
+    return data;
+}
+
+// A vertex list holding meshes that were uploaded once.
+std::unique_ptr<Vertices> uploaded_vertices(unsigned int meshes)
+{
+    auto list = std::make_unique<Vertices>();
+    list->reserve(meshes);
+    for (unsigned int id = 0; id < meshes; id++)
+        list->add_pointer(id, data().vertices.data(), VERTICES_PER_MESH);
+    list->update_ranges();
+    list->update_data(nil);
+    return list;
+}
+
+// An instance list holding lists that were copied to its buffer once.
+std::unique_ptr<Instances> uploaded_instances(unsigned int meshes)
+{
+    auto list = std::make_unique<Instances>(nil);
+    list->reserve(meshes);
+    for (unsigned int id = 0; id < meshes; id++)
+        list->add_instances_list(id, data().matrices.data(), INSTANCES_PER_MESH);
+    list->update_ranges();
+    list->update_data();
+    list->update_frame(nil, 0);
+    return list;
+}
+
+double vertex_add(unsigned int meshes)
+{
+    Vertices list;
+    list.reserve(meshes);
+    const auto start = std::chrono::steady_clock::now();
+    for (unsigned int id = 0; id < meshes; id++)
+        list.add_pointer(id, data().vertices.data(), VERTICES_PER_MESH);
+    return elapsed_ms(start);
+}
+
+double vertex_update(unsigned int meshes)
+{
+    auto list = uploaded_vertices(meshes);
+    const auto start = std::chrono::steady_clock::now();
+    for (unsigned int id = 0; id < meshes; id++)
+        list->update_pointer(id, data().moved_vertices.data(), VERTICES_PER_MESH);
+    return elapsed_ms(start);
+}
+
+double vertex_remove(unsigned int meshes)
+{
+    auto list = uploaded_vertices(meshes);
+    const auto start = std::chrono::steady_clock::now();
+    for (unsigned int id = 0; id < meshes; id++)
+        list->remove_pointer(id);
+    return elapsed_ms(start);
+}
+
+// Returns the ranges of every other mesh to the allocator, leaving holes behind.
+double vertex_update_ranges(unsigned int meshes)
+{
+    auto list = uploaded_vertices(meshes);
+    for (unsigned int id = 0; id < meshes; id += 2)
+        list->remove_pointer(id);
+    const auto start = std::chrono::steady_clock::now();
+    list->update_ranges();
+    return elapsed_ms(start);
+}
+
+// Uploads all meshes into a list whose buffers already fit them.
+double vertex_update_data(unsigned int meshes)
+{
+    auto list = uploaded_vertices(meshes);
+    for (unsigned int id = 0; id < meshes; id++)
+        list->update_pointer(id, data().moved_vertices.data(), VERTICES_PER_MESH);
+    list->update_ranges();
+    const auto start = std::chrono::steady_clock::now();
+    list->update_data(nil);
+    return elapsed_ms(start);
+}
+
+double instance_add(unsigned int meshes)
+{
+    Instances list(nil);
+    list.reserve(meshes);
+    const auto start = std::chrono::steady_clock::now();
+    for (unsigned int id = 0; id < meshes; id++)
+        list.add_instances_list(id, data().matrices.data(), INSTANCES_PER_MESH);
+    return elapsed_ms(start);
+}
+
+double instance_update(unsigned int meshes)
+{
+    auto list = uploaded_instances(meshes);
+    const auto start = std::chrono::steady_clock::now();
+    for (unsigned int id = 0; id < meshes; id++)
+        list->update_instances_list(id, data().moved_matrices.data(), INSTANCES_PER_MESH);
+    return elapsed_ms(start);
+}
+
+double instance_remove(unsigned int meshes)
+{
+    auto list = uploaded_instances(meshes);
+    const auto start = std::chrono::steady_clock::now();
+    for (unsigned int id = 0; id < meshes; id++)
+        list->remove_instances_list(id);
+    return elapsed_ms(start);
+}
+
+double instance_update_ranges(unsigned int meshes)
+{
+    auto list = uploaded_instances(meshes);
+    for (unsigned int id = 0; id < meshes; id += 2)
+        list->remove_instances_list(id);
+    const auto start = std::chrono::steady_clock::now();
+    list->update_ranges();
+    return elapsed_ms(start);
+}
+
+// Hands the changes of every list to the frame and copies them into its buffer. Changes beyond
+// MAX_PENDING_CHANGES turn into a full copy, as they do in the renderer.
+double instance_update_data(unsigned int meshes)
+{
+    auto list = uploaded_instances(meshes);
+    for (unsigned int id = 0; id < meshes; id++)
+        list->update_instances_list(id, data().moved_matrices.data(), INSTANCES_PER_MESH);
+    list->update_ranges();
+    const auto start = std::chrono::steady_clock::now();
+    list->update_data();
+    list->update_frame(nil, 0);
+    return elapsed_ms(start);
+}
+
+void print_benchmark(const char *name, unsigned int meshes, const Summary &summary, bool first)
+{
+    printf("%s    {\"name\": \"%s\", \"meshes\": %u, \"ms\": {\"mean\": %.4f, \"p50\": %.4f, \"p95\": %.4f, "
+           "\"max\": %.4f}}",
+           first ? "" : ",\n", name, meshes, summary.mean, summary.p50, summary.p95, summary.max);
+}
+
+bool parse(int argc, char **argv, Options &options)
+{
+    for (int i = 1; i < argc; i++)
+    {
+        const bool has_value = i + 1 < argc;
+        if (strcmp(argv[i], "--repetitions") == 0 && has_value)
+            options.repetitions = static_cast<unsigned int>(std::max(1, atoi(argv[++i])));
+        else if (strcmp(argv[i], "--benchmark") == 0 && has_value)
+            options.benchmark = argv[++i];
+        else
+            return false;
+    }
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+    Options options;
+    if (!parse(argc, argv, options))
+    {
+        fprintf(stderr, "Usage: %s [--repetitions N] [--benchmark NAME]\n", argv[0]);
+        return 1;
+    }
+
+    const struct
+    {
+        const char *name;
+        double (*run)(unsigned int);
+    } benchmarks[] = {{"vertex_add", vertex_add},
+                      {"vertex_update", vertex_update},
+                      {"vertex_remove", vertex_remove},
+                      {"vertex_update_ranges", vertex_update_ranges},
+                      {"vertex_update_data", vertex_update_data},
+                      {"instance_add", instance_add},
+                      {"instance_update", instance_update},
+                      {"instance_remove", instance_remove},
+                      {"instance_update_ranges", instance_update_ranges},
+                      {"instance_update_data", instance_update_data}};
+
+    @autoreleasepool
+    {
+        printf("{\n  \"repetitions\": %u,\n  \"benchmarks\": [\n", options.repetitions);
+        bool first = true;
+        for (const auto &benchmark : benchmarks)
+        {
+            if (options.benchmark && strcmp(options.benchmark, benchmark.name) != 0)
+                continue;
+
+            for (const unsigned int meshes : MESH_COUNTS)
+            {
+                // The first run warms up the allocator and caches and is not reported.
+                benchmark.run(meshes);
+                std::vector<double> samples;
+                for (unsigned int i = 0; i < options.repetitions; i++)
+                    samples.push_back(benchmark.run(meshes));
+
+                print_benchmark(benchmark.name, meshes, summarize(samples), first);
+                first = false;
+            }
+        }
+        printf("\n  ]\n}\n");
+    }
+    return 0;
+}
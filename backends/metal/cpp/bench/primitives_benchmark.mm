@@ -0,0 +1,330 @@
+// Throughput of the compute primitives of gpu_primitives.hpp on the GPU. Every benchmark runs a primitive on random
+// input in a command buffer of its own and prints its GPU time in milliseconds and the elements it processed per
+// second as JSON, for 64k, 1M and 16M elements. The output of the first run is checked against the CPU.
+//
+// Usage: MetalCppPrimitivesBenchmark [--repetitions N] [--benchmark NAME]
+
+#import <Foundation/Foundation.h>
+#import <Metal/Metal.h>
+
+#include "../src/gpu_primitives.hpp"
+#include "../src/pipeline_cache.hpp"
+#include "../src/retired_resources.hpp"
+#include "../src/shaders.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <numeric>
+#include <random>
+#include <vector>
+
+namespace
+{
+
+constexpr unsigned int ELEMENT_COUNTS[] = {1u << 16, 1u << 20, 1u << 24};
+// Segments of the segmented sum hold 1 to 2 * SEGMENT_LENGTH - 1 values.
+constexpr unsigned int SEGMENT_LENGTH = 64;
+
+struct Options
+{
+    unsigned int repetitions = 10;
+    const char *benchmark = nullptr;
+};
+
+struct Summary
+{
+    double mean = 0.0;
+    double p50 = 0.0;
+    double p95 = 0.0;
+    double max = 0.0;
+};
+
+Summary summarize(std::vector<double> values)
+{
+    Summary summary = {};
+    if (values.empty())
+        return summary;
+
+    std::sort(values.begin(), values.end());
+    for (const double value : values)
+        summary.mean += value;
+    summary.mean /= static_cast<double>(values.size());
+    summary.p50 = values[values.size() / 2];
+    summary.p95 = values[std::min(values.size() - 1, values.size() * 95 / 100)];
+    summary.max = values.back();
+    return summary;
+}
+
+struct Context
+{
+    id<MTLDevice> device = nil;
+    id<MTLCommandQueue> queue = nil;
+    GpuPrimitives primitives;
+    RetiredResources retired;
+};
+
+id<MTLBuffer> shared_buffer(Context &context, const void *data, size_t size)
+{
+    return [context.device newBufferWithBytes:data length:std::max<size_t>(size, 4)
+                                      options:MTLResourceStorageModeShared];
+}
+
+template <typename T> std::vector<T> contents(id<MTLBuffer> buffer, size_t count)
+{
+    const auto *data = static_cast<const T *>(buffer.contents);
+    return std::vector<T>(data, data + count);
+}
+
+// GPU time of one run of encode in milliseconds.
+template <typename Encode> double run_gpu(Context &context, Encode encode)
+{
+    id<MTLCommandBuffer> command_buffer = [context.queue commandBuffer];
+    id<MTLComputeCommandEncoder> encoder = [command_buffer computeCommandEncoder];
+    encode(encoder);
+    [encoder endEncoding];
+    [command_buffer commit];
+    [command_buffer waitUntilCompleted];
+    context.retired.release(~0ull);
+    return (command_buffer.GPUEndTime - command_buffer.GPUStartTime) * 1000.0;
+}
+
+std::vector<unsigned int> random_words(unsigned int count, unsigned int max)
+{
+    std::minstd_rand random(count);
+    std::uniform_int_distribution<unsigned int> distribution(0, max);
+    std::vector<unsigned int> words(count);
+    for (unsigned int &word : words)
+        word = distribution(random);
+    return words;
+}
+
+// Every benchmark returns the GPU time of a run and sets valid when asked to check its output.
+double scan(Context &context, unsigned int count, bool *valid)
+{
+    const std::vector<unsigned int> input = random_words(count, 15);
+    id<MTLBuffer> buffer = shared_buffer(context, input.data(), count * sizeof(unsigned int));
+    const double ms = run_gpu(context, [&](id<MTLComputeCommandEncoder> encoder) {
+        context.primitives.encode_scan(encoder, buffer, 0, buffer, 0, count);
+    });
+
+    if (valid)
+    {
+        std::vector<unsigned int> expected(count);
+        std::exclusive_scan(input.begin(), input.end(), expected.begin(), 0u);
+        *valid = contents<unsigned int>(buffer, count) == expected;
+    }
+    return ms;
+}
+
+double compact(Context &context, unsigned int count, bool *valid)
+{
+    const std::vector<unsigned int> flags = random_words(count, 1);
+    std::vector<unsigned int> values(count);
+    std::iota(values.begin(), values.end(), 0u);
+    id<MTLBuffer> values_buffer = shared_buffer(context, values.data(), count * sizeof(unsigned int));
+    id<MTLBuffer> flags_buffer = shared_buffer(context, flags.data(), count * sizeof(unsigned int));
+    id<MTLBuffer> output = [context.device newBufferWithLength:count * sizeof(unsigned int)
+                                                       options:MTLResourceStorageModeShared];
+    id<MTLBuffer> counts = [context.device newBufferWithLength:sizeof(unsigned int)
+                                                       options:MTLResourceStorageModeShared];
+    const double ms = run_gpu(context, [&](id<MTLComputeCommandEncoder> encoder) {
+        context.primitives.encode_compact(encoder, values_buffer, 0, flags_buffer, 0, output, 0, counts, 0, count);
+    });
+
+    if (valid)
+    {
+        std::vector<unsigned int> expected;
+        for (unsigned int i = 0; i < count; i++)
+        {
+            if (flags[i] != 0)
+                expected.push_back(values[i]);
+        }
+        const unsigned int kept = *static_cast<const unsigned int *>(counts.contents);
+        *valid = kept == expected.size() && contents<unsigned int>(output, kept) == expected;
+    }
+    return ms;
+}
+
+// Pairs of random keys with their index as the value, the sort must keep equal keys in the order of their index.
+double sort(Context &context, unsigned int count, bool wide_keys, bool *valid)
+{
+    const unsigned int words = wide_keys ? 4 : 2;
+    const std::vector<unsigned int> keys = random_words(count * 2, ~0u);
+    std::vector<unsigned int> pairs(static_cast<size_t>(count) * words, 0);
+    for (unsigned int i = 0; i < count; i++)
+    {
+        pairs[i * words] = keys[2 * i];
+        if (wide_keys)
+            pairs[i * words + 1] = keys[2 * i + 1] & 0xFF;
+        pairs[i * words + (wide_keys ? 2 : 1)] = i;
+    }
+    id<MTLBuffer> buffer = shared_buffer(context, pairs.data(), pairs.size() * sizeof(unsigned int));
+    const unsigned int key_bits = wide_keys ? 40 : 32;
+    const double ms = run_gpu(context, [&](id<MTLComputeCommandEncoder> encoder) {
+        context.primitives.encode_sort(encoder, buffer, 0, count, key_bits, wide_keys);
+    });
+
+    if (valid)
+    {
+        const auto key = [&](const unsigned int *pair) {
+            return wide_keys ? (uint64_t(pair[1]) << 32) | pair[0] : uint64_t(pair[0]);
+        };
+        std::vector<unsigned int> order(count);
+        std::iota(order.begin(), order.end(), 0u);
+        std::stable_sort(order.begin(), order.end(), [&](unsigned int a, unsigned int b) {
+            return key(&pairs[a * words]) < key(&pairs[b * words]);
+        });
+        const std::vector<unsigned int> sorted = contents<unsigned int>(buffer, pairs.size());
+        *valid = true;
+        for (unsigned int i = 0; i < count && *valid; i++)
+            *valid = std::equal(sorted.begin() + i * words, sorted.begin() + (i + 1) * words,
+                                pairs.begin() + order[i] * words);
+    }
+    return ms;
+}
+
+double sort_32(Context &context, unsigned int count, bool *valid)
+{
+    return sort(context, count, false, valid);
+}
+
+double sort_64(Context &context, unsigned int count, bool *valid)
+{
+    return sort(context, count, true, valid);
+}
+
+double segmented_sum(Context &context, unsigned int count, bool *valid)
+{
+    const std::vector<unsigned int> lengths = random_words(count / SEGMENT_LENGTH, 2 * SEGMENT_LENGTH - 2);
+    std::vector<unsigned int> offsets(1, 0);
+    for (const unsigned int length : lengths)
+    {
+        if (offsets.back() + length + 1 > count)
+            break;
+        offsets.push_back(offsets.back() + length + 1);
+    }
+    const std::vector<unsigned int> integers = random_words(count, 8);
+    const std::vector<float> values(integers.begin(), integers.end());
+    const auto segments = static_cast<unsigned int>(offsets.size() - 1);
+    id<MTLBuffer> values_buffer = shared_buffer(context, values.data(), count * sizeof(float));
+    id<MTLBuffer> offsets_buffer = shared_buffer(context, offsets.data(), offsets.size() * sizeof(unsigned int));
+    id<MTLBuffer> sums = [context.device newBufferWithLength:std::max(segments, 1u) * sizeof(float)
+                                                     options:MTLResourceStorageModeShared];
+    const double ms = run_gpu(context, [&](id<MTLComputeCommandEncoder> encoder) {
+        context.primitives.encode_segmented_sum(encoder, values_buffer, 0, offsets_buffer, 0, sums, 0, segments);
+    });
+
+    // Sums of small integers are exact in any order.
+    if (valid)
+    {
+        const std::vector<float> result = contents<float>(sums, segments);
+        *valid = true;
+        for (unsigned int i = 0; i < segments && *valid; i++)
+            *valid = result[i] == std::accumulate(values.begin() + offsets[i], values.begin() + offsets[i + 1], 0.0f);
+    }
+    return ms;
+}
+
+void print_benchmark(const char *name, unsigned int count, const Summary &summary, bool valid, bool first)
+{
+    const double elements_per_second = summary.p50 > 0.0 ? count / (summary.p50 / 1000.0) : 0.0;
+    printf("%s    {\"name\": \"%s\", \"elements\": %u, \"valid\": %s, \"elements_per_second\": %.0f, \"ms\": "
+           "{\"mean\": %.4f, \"p50\": %.4f, \"p95\": %.4f, \"max\": %.4f}}",
+           first ? "" : ",\n", name, count, valid ? "true" : "false", elements_per_second, summary.mean, summary.p50,
+           summary.p95, summary.max);
+}
+
+bool parse(int argc, char **argv, Options &options)
+{
+    for (int i = 1; i < argc; i++)
+    {
+        const bool has_value = i + 1 < argc;
+        if (strcmp(argv[i], "--repetitions") == 0 && has_value)
+            options.repetitions = static_cast<unsigned int>(std::max(1, atoi(argv[++i])));
+        else if (strcmp(argv[i], "--benchmark") == 0 && has_value)
+            options.benchmark = argv[++i];
+        else
+            return false;
+    }
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+    Options options;
+    if (!parse(argc, argv, options))
+    {
+        fprintf(stderr, "Usage: %s [--repetitions N] [--benchmark NAME]\n", argv[0]);
+        return 1;
+    }
+
+    const struct
+    {
+        const char *name;
+        double (*run)(Context &, unsigned int, bool *);
+    } benchmarks[] = {{"scan", scan},
+                      {"compact", compact},
+                      {"sort_32", sort_32},
+                      {"sort_64", sort_64},
+                      {"segmented_sum", segmented_sum}};
+
+    @autoreleasepool
+    {
+        Context context;
+        context.device = MTLCreateSystemDefaultDevice();
+        if (context.device == nil)
+        {
+            fprintf(stderr, "No Metal device\n");
+            return 1;
+        }
+        context.queue = [context.device newCommandQueue];
+
+        // The library of the GPU family, as the renderer picks it.
+        bool apple = false;
+        if (@available(macOS 11.0, *))
+            apple = [context.device supportsFamily:MTLGPUFamilyApple1];
+        dispatch_data_t data =
+            dispatch_data_create(apple ? shaders_apple_metallib : shaders_mac2_metallib,
+                                 apple ? shaders_apple_metallib_len : shaders_mac2_metallib_len, nil,
+                                 DISPATCH_DATA_DESTRUCTOR_NONE);
+        NSError *err = nil;
+        id<MTLLibrary> library = [context.device newLibraryWithData:data error:&err];
+        if (err)
+        {
+            fprintf(stderr, "Could not load the shader library: %s\n", [[err localizedDescription] UTF8String]);
+            return 1;
+        }
+        PipelineCache pipelines;
+        pipelines.open(context.device, nullptr, 0);
+        context.primitives.create(context.device, library, pipelines, context.retired);
+        pipelines.wait();
+
+        printf("{\n  \"device\": \"%s\",\n  \"tile_size\": %u,\n  \"repetitions\": %u,\n  \"benchmarks\": [\n",
+               [[context.device name] UTF8String], context.primitives.tile_size(), options.repetitions);
+        bool first = true;
+        for (const auto &benchmark : benchmarks)
+        {
+            if (options.benchmark && strcmp(options.benchmark, benchmark.name) != 0)
+                continue;
+
+            for (const unsigned int count : ELEMENT_COUNTS)
+            {
+                // The first run warms up the scratch buffer and checks the output, it is not reported.
+                bool valid = false;
+                benchmark.run(context, count, &valid);
+                std::vector<double> samples;
+                for (unsigned int i = 0; i < options.repetitions; i++)
+                    samples.push_back(benchmark.run(context, count, nullptr));
+
+                print_benchmark(benchmark.name, count, summarize(samples), valid, first);
+                first = false;
+            }
+        }
+        printf("\n  ]\n}\n");
+    }
+    return 0;
+}
@@ -0,0 +1,266 @@
+// Replays a capture written by start_capture on a headless instance, as fast as the renderer takes the calls, and
+// prints the frame timings as JSON. Frames are the time between the ends of two renders, so they include the set_*
+// calls and synchronize of the frame. The instance renders at the drawable size the capture started with.
+//
+// Usage: MetalCppReplay CAPTURE
+
+#import <Foundation/Foundation.h>
+
+#include "../src/command_capture.hpp"
+#include "../src/library.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <vector>
+
+namespace
+{
+
+struct Summary
+{
+    double mean = 0.0;
+    double p50 = 0.0;
+    double p95 = 0.0;
+    double max = 0.0;
+};
+
+Summary summarize(std::vector<double> values)
+{
+    Summary summary = {};
+    if (values.empty())
+        return summary;
+
+    std::sort(values.begin(), values.end());
+    for (const double value : values)
+        summary.mean += value;
+    summary.mean /= static_cast<double>(values.size());
+    summary.p50 = values[values.size() / 2];
+    summary.p95 = values[std::min(values.size() - 1, values.size() * 95 / 100)];
+    summary.max = values.back();
+    return summary;
+}
+
+struct Samples
+{
+    std::vector<double> frame_ms;
+    std::vector<double> gpu_ms;
+    unsigned int commands = 0;
+    unsigned int skipped = 0;
+};
+
+template <typename Light>
+void replay_lights(CaptureReader &reader, void *instance, void (*set)(void *, const Light *, unsigned int))
+{
+    const Light *lights = nullptr;
+    const size_t count = reader.get_array(lights);
+    set(instance, lights, static_cast<unsigned int>(count));
+}
+
+// Makes the call op was captured from, returns false for ops of a newer capture.
+bool replay(CaptureReader &reader, CaptureOp op, void *instance, Samples &samples,
+            std::chrono::steady_clock::time_point &frame_start)
+{
+    switch (op)
+    {
+    case CaptureOp::SET_2D_MESH: {
+        const auto id = reader.get<unsigned int>();
+        auto data = reader.get<MeshData2D>();
+        reader.get_array(data.vertices);
+        set_2d_mesh(instance, id, data);
+        return true;
+    }
+    case CaptureOp::SET_2D_INSTANCES: {
+        const auto id = reader.get<unsigned int>();
+        auto data = reader.get<InstancesData2D>();
+        reader.get_array(data.matrices);
+        set_2d_instances(instance, id, data);
+        return true;
+    }
+    case CaptureOp::SET_3D_MESH: {
+        const auto id = reader.get<unsigned int>();
+        auto data = reader.get<MeshData3D>();
+        reader.get_array(data.vertices);
+        reader.get_array(data.triangles);
+        reader.get_array(data.ranges);
+        reader.get_array(data.skin_data);
+        reader.get_array(data.indices);
+        set_3d_mesh(instance, id, data);
+        return true;
+    }
+    case CaptureOp::UNLOAD_3D_MESHES: {
+        const size_t *ids = nullptr;
+        const size_t count = reader.get_array(ids);
+        unload_3d_meshes(instance, ids, static_cast<unsigned int>(count));
+        return true;
+    }
+    case CaptureOp::SET_3D_INSTANCES: {
+        const auto id = reader.get<unsigned int>();
+        auto data = reader.get<InstancesData3D>();
+        reader.get_array(data.matrices);
+        reader.get_array(data.skin_ids);
+        reader.get_array(data.flags);
+        set_3d_instances(instance, id, data);
+        return true;
+    }
+    case CaptureOp::SET_ANIMATION_TIME:
+        set_animation_time(instance, reader.get<float>());
+        return true;
+    case CaptureOp::SET_SKINS: {
+        const auto num_changed = reader.get<unsigned int>();
+        const size_t *changed = nullptr;
+        reader.get_array(changed);
+        SkinData *skins = nullptr;
+        const size_t count = reader.get_mutable_array(skins);
+        for (size_t i = 0; i < count; i++)
+        {
+            reader.get_array(skins[i].name);
+            reader.get_array(skins[i].inverse_bind_matrices);
+            reader.get_array(skins[i].joint_matrices);
+        }
+        set_skins(instance, skins, static_cast<unsigned int>(count), changed, num_changed);
+        return true;
+    }
+    case CaptureOp::SET_POINT_LIGHTS:
+        replay_lights(reader, instance, set_point_lights);
+        return true;
+    case CaptureOp::SET_SPOT_LIGHTS:
+        replay_lights(reader, instance, set_spot_lights);
+        return true;
+    case CaptureOp::SET_AREA_LIGHTS:
+        replay_lights(reader, instance, set_area_lights);
+        return true;
+    case CaptureOp::SET_DIRECTIONAL_LIGHTS:
+        replay_lights(reader, instance, set_directional_lights);
+        return true;
+    case CaptureOp::SET_MATERIALS: {
+        const auto num_changed = reader.get<unsigned int>();
+        const size_t *changed = nullptr;
+        reader.get_array(changed);
+        const DeviceMaterial *materials = nullptr;
+        const size_t count = reader.get_array(materials);
+        set_materials(instance, materials, static_cast<unsigned int>(count), changed, num_changed);
+        return true;
+    }
+    case CaptureOp::SET_TEXTURES: {
+        const auto num_changed = reader.get<unsigned int>();
+        const size_t *changed = nullptr;
+        reader.get_array(changed);
+        TextureData *textures = nullptr;
+        const size_t count = reader.get_mutable_array(textures);
+        for (size_t i = 0; i < count; i++)
+            reader.get_array(textures[i].bytes);
+        set_textures(instance, textures, static_cast<unsigned int>(count), changed, num_changed);
+        return true;
+    }
+    case CaptureOp::SET_SKYBOX: {
+        auto skybox = reader.get<TextureData>();
+        reader.get_array(skybox.bytes);
+        set_skybox(instance, skybox);
+        return true;
+    }
+    case CaptureOp::SYNCHRONIZE:
+        synchronize(instance);
+        // The data of the calls before it was copied on submit and read by synchronize.
+        reader.release();
+        return true;
+    case CaptureOp::RENDER: {
+        const auto matrix_2d = reader.get<simd_float4x4>();
+        const auto view_3d = reader.get<CameraView3D>();
+        const auto mode = reader.get<RenderMode3D>();
+        if (render(instance, matrix_2d, view_3d, mode) != FRAME_PRESENTED)
+            samples.skipped++;
+
+        const auto now = std::chrono::steady_clock::now();
+        samples.frame_ms.push_back(std::chrono::duration<double, std::milli>(now - frame_start).count());
+        frame_start = now;
+
+        // Stats lag behind by the frames in flight, which evens out over the capture.
+        FrameStats stats = {};
+        get_frame_stats(instance, &stats);
+        if (stats.frame_ms > 0.0f)
+            samples.gpu_ms.push_back(stats.frame_ms);
+        return true;
+    }
+    case CaptureOp::RESIZE: {
+        const auto width = reader.get<unsigned int>();
+        const auto height = reader.get<unsigned int>();
+        resize(instance, width, height, reader.get<double>());
+        return true;
+    }
+    }
+    return false;
+}
+
+void print_summary(const char *name, const std::vector<double> &values, bool last)
+{
+    if (values.empty())
+    {
+        printf("  \"%s\": null%s\n", name, last ? "" : ",");
+        return;
+    }
+
+    const Summary summary = summarize(values);
+    printf("  \"%s\": {\"mean\": %.4f, \"p50\": %.4f, \"p95\": %.4f, \"max\": %.4f}%s\n", name, summary.mean,
+           summary.p50, summary.p95, summary.max, last ? "" : ",");
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+    if (argc != 2)
+    {
+        fprintf(stderr, "Usage: %s CAPTURE\n", argv[0]);
+        return 1;
+    }
+
+    CaptureReader reader;
+    if (!reader.open(argv[1]))
+    {
+        fprintf(stderr, "Could not read capture %s, it may be of another version or struct layout\n", argv[1]);
+        return 1;
+    }
+
+    @autoreleasepool
+    {
+        const capture::Header &header = reader.header();
+        void *instance = create_instance(nullptr, nullptr, header.width, header.height, 1.0);
+        if (!instance)
+        {
+            fprintf(stderr, "Could not create a renderer\n");
+            return 1;
+        }
+        // The chunks of the capture are released after every synchronize, so the renderer has to copy what it reads.
+        set_copy_on_submit(instance, 1);
+        wait_for_pipelines(instance);
+
+        Samples samples;
+        CaptureOp op;
+        const auto start = std::chrono::steady_clock::now();
+        auto frame_start = start;
+        while (reader.next(op))
+        {
+            if (!replay(reader, op, instance, samples, frame_start))
+            {
+                fprintf(stderr, "Unknown command %u, the capture is of a newer version\n", static_cast<unsigned>(op));
+                break;
+            }
+            samples.commands++;
+        }
+        wait_for_frame(instance, get_submitted_frame(instance), 10000);
+        const double total_ms =
+            std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+        printf("{\n  \"width\": %u,\n  \"height\": %u,\n", header.width, header.height);
+        printf("  \"commands\": %u,\n  \"frames\": %zu,\n  \"skipped_frames\": %u,\n", samples.commands,
+               samples.frame_ms.size(), samples.skipped);
+        printf("  \"total_ms\": %.4f,\n", total_ms);
+        print_summary("frame_ms", samples.frame_ms, false);
+        print_summary("gpu_ms", samples.gpu_ms, true);
+        printf("}\n");
+
+        destroy_instance(instance);
+    }
+    return 0;
+}
@@ -0,0 +1,706 @@
+#ifndef METALCPP_SRC_ACCELERATION_STRUCTURES_HPP
+#define METALCPP_SRC_ACCELERATION_STRUCTURES_HPP
+
+#import <Metal/Metal.h>
+
+#include "id_table.hpp"
+#include "instance_list.h"
+#include "library.h"
+#include "retired_resources.hpp"
+#include "upload_ring.hpp"
+#include "vertex_list.h"
+
+#include <algorithm>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+// Ray tracing scene of the full-format 3D meshes. Every mesh gets a primitive acceleration structure, which is built
+// again when the mesh changed or moved in the vertex buffer, and one instance acceleration structure holds all of their
+// instances. Skinned instances reference a structure of their skinning group in the animated vertex buffer instead,
+// which is refit whenever skinning ran. Builds and refits are encoded into the command buffer of the frame that traces
+// against them.
+//
+// Transform changes only rewrite the descriptors of the instances that moved and refit the instance structure. Refits
+// keep the tree of the last build, so its quality degrades as instances move away from where they were built. Once
+// the instances moved far enough on average the instance structure is rebuilt on a background queue, and swapped in
+// when that build completed.
+class AccelerationStructures
+{
+  public:
+    // Average displacement of the instances since the last build, relative to their size, that triggers a rebuild.
+    static constexpr float REBUILD_DEGRADATION = 0.1f;
+    // Skinned structures are rebuilt after this many refits.
+    static constexpr unsigned int SKINNED_REFITS_PER_REBUILD = 64;
+    // Frames with more transform changes than this rewrite all instance descriptors instead.
+    static constexpr size_t MAX_TRANSFORM_CHANGES = 4096;
+
+    void mark_mesh_changed(unsigned int id)
+    {
+        if (Mesh *mesh = _meshes.find(id))
+            mesh->valid = false;
+    }
+
+    void mark_instances_changed()
+    {
+        _instances_dirty = true;
+    }
+
+    // Instances [first, last) of a mesh got new transforms.
+    void mark_transformed(unsigned int id, unsigned int first, unsigned int last)
+    {
+        if (_instances_dirty || _all_transformed || first >= last)
+            return;
+
+        if (_transformed.size() >= MAX_TRANSFORM_CHANGES)
+        {
+            _transformed.clear();
+            _all_transformed = true;
+            return;
+        }
+        _transformed.push_back({id, first, last});
+    }
+
+    // Object space bounds of a mesh, used to measure how far its instances moved.
+    void set_bounds(unsigned int id, const Aabb &bounds)
+    {
+        const glm::vec3 bmin = glm::vec3(bounds.bmin.x, bounds.bmin.y, bounds.bmin.z);
+        const glm::vec3 bmax = glm::vec3(bounds.bmax.x, bounds.bmax.y, bounds.bmax.z);
+        if (glm::any(glm::greaterThan(bmin, bmax)))
+            _bounds.erase(id);
+        else
+            _bounds.insert(id, Bounds{(bmin + bmax) * 0.5f, std::max(glm::length(bmax - bmin) * 0.5f, 1e-4f)});
+    }
+
+    // Brings the structures up to date with the meshes and instances, returns false when there is nothing to trace.
+    // skinned is true when the skinning pass wrote the animated vertices in this command buffer. The command buffer
+    // doesn't retain what it references, replaced structures and build scratch buffers are retired.
+    bool update(id<MTLDevice> device, id<MTLCommandBuffer> command_buffer, UploadRing &ring, RetiredResources &retired,
+                const VertexList<Vertex3D, JointData> &vertices, const IdTable<InstanceRange<glm::mat4>> &instances,
+                const std::vector<SkinningGroup> &skinning_groups,
+                const IdTable<std::vector<unsigned int>> &skinned_instances, bool skinned) API_AVAILABLE(macos(11.0))
+    {
+        const IdTable<DrawDescriptor> &ranges = vertices.get_draw_ranges();
+
+        std::vector<unsigned int> removed;
+        for (const auto &[i, mesh] : _meshes)
+        {
+            const DrawDescriptor *range = ranges.find(i);
+            if (!range || !traced(*range))
+                removed.push_back(i);
+        }
+        for (const unsigned int i : removed)
+        {
+            retired.retire(_meshes[i].structure);
+            _meshes.erase(i);
+        }
+        if (!removed.empty())
+            _instances_dirty = true;
+
+        id<MTLAccelerationStructureCommandEncoder> encoder = nil;
+        const auto begin_encoding = [&]() {
+            if (!encoder)
+            {
+                encoder = [command_buffer accelerationStructureCommandEncoder];
+                encoder.label = @"MeshAccelerationStructures";
+            }
+            return encoder;
+        };
+
+        for (const auto &[i, range] : ranges)
+        {
+            if (!traced(range))
+                continue;
+
+            const Mesh *mesh = _meshes.find(i);
+            if (mesh && mesh->valid && same_geometry(mesh->range, range))
+                continue;
+
+            MTLPrimitiveAccelerationStructureDescriptor *desc =
+                [MTLPrimitiveAccelerationStructureDescriptor descriptor];
+            desc.geometryDescriptors = @[ geometry(vertices, range, vertices.vertex_buffer(), range.start) ];
+
+            // Every build gets its own scratch buffer, retired along with the structure it replaces.
+            const MTLAccelerationStructureSizes sizes = [device accelerationStructureSizesWithDescriptor:desc];
+            id<MTLAccelerationStructure> structure =
+                [device newAccelerationStructureWithSize:sizes.accelerationStructureSize];
+            id<MTLBuffer> scratch = [device newBufferWithLength:std::max<NSUInteger>(sizes.buildScratchBufferSize, 1)
+                                                        options:MTLResourceStorageModePrivate];
+            [begin_encoding() buildAccelerationStructure:structure
+                                              descriptor:desc
+                                           scratchBuffer:scratch
+                                     scratchBufferOffset:0];
+            retired.retire(scratch, mesh ? mesh->structure : nil);
+
+            _meshes.insert(i, Mesh{structure, range, true});
+            _instances_dirty = true;
+        }
+
+        update_skinned(device, retired, vertices, skinning_groups, skinned_instances, skinned, begin_encoding);
+        if (encoder)
+            [encoder endEncoding];
+
+        // Instances reference their mesh or skinning group by its index in the list of primitive structures.
+        NSMutableArray<id<MTLAccelerationStructure>> *structures = [NSMutableArray array];
+        unsigned int num_instances = 0;
+        for (auto &[i, mesh] : _meshes)
+        {
+            mesh.index = static_cast<unsigned int>(structures.count);
+            mesh.first_instance = num_instances;
+            [structures addObject:mesh.structure];
+            if (const InstanceRange<glm::mat4> *insts = instances.find(i))
+                num_instances += insts->count;
+        }
+        for (Skinned &s : _skinned)
+        {
+            if (!s.structure)
+                continue;
+            s.index = static_cast<unsigned int>(structures.count);
+            [structures addObject:s.structure];
+        }
+
+        if (num_instances == 0)
+        {
+            _traced_instances.clear();
+            retired.retire(_instance_structure);
+            _instance_structure = nil;
+            _instance_desc = nil;
+            _pending = {};
+            _instances_dirty = false;
+            _transformed.clear();
+            _all_transformed = false;
+            return false;
+        }
+
+        if (_instances_dirty || _instance_structure == nil)
+            return build_instances(device, command_buffer, ring, retired, instances, skinned_instances, structures,
+                                   num_instances);
+
+        bool refit = skinned && !_skinned.empty();
+        if ((_all_transformed || !_transformed.empty()) && update_transforms(command_buffer, ring, instances))
+            refit = true;
+
+        // A completed background build replaces the current structure, it still needs the changes made since.
+        if (_pending.command_buffer && _pending.command_buffer.status >= MTLCommandBufferStatusCompleted)
+        {
+            if (_pending.command_buffer.status == MTLCommandBufferStatusCompleted)
+            {
+                retired.retire(_instance_structure, _scratch);
+                _instance_structure = _pending.structure;
+                _scratch = _pending.scratch;
+                _build_centers = std::move(_pending.centers);
+                update_degradation();
+                refit = true;
+            }
+            _pending = {};
+        }
+        else if (!_pending.command_buffer && _degradation > REBUILD_DEGRADATION * static_cast<float>(num_instances))
+        {
+            rebuild_in_background(device);
+        }
+
+        if (refit)
+        {
+            id<MTLAccelerationStructureCommandEncoder> refit_encoder =
+                [command_buffer accelerationStructureCommandEncoder];
+            refit_encoder.label = @"InstanceAccelerationStructure";
+            [refit_encoder refitAccelerationStructure:_instance_structure
+                                           descriptor:_instance_desc
+                                          destination:nil
+                                        scratchBuffer:_scratch
+                                  scratchBufferOffset:0];
+            [refit_encoder endEncoding];
+        }
+        return true;
+    }
+
+    id<MTLAccelerationStructure> instance_structure() const API_AVAILABLE(macos(11.0))
+    {
+        return _instance_structure;
+    }
+
+    // Geometry of every instance in the order of the instance structure, for shading the hits of traced rays.
+    const std::vector<TracedInstance> &traced_instances() const
+    {
+        return _traced_instances;
+    }
+
+    // Declares the primitive structures the instance structure references, rays traverse them as well.
+    void use_resources(id<MTLComputeCommandEncoder> encoder) const API_AVAILABLE(macos(11.0))
+    {
+        for (const auto &[i, mesh] : _meshes)
+            [encoder useResource:mesh.structure usage:MTLResourceUsageRead];
+        for (const Skinned &s : _skinned)
+        {
+            if (s.structure)
+                [encoder useResource:s.structure usage:MTLResourceUsageRead];
+        }
+    }
+
+  private:
+    struct Mesh
+    {
+        id<MTLAccelerationStructure> structure API_AVAILABLE(macos(11.0));
+        // Range the structure was built from.
+        DrawDescriptor range;
+        bool valid;
+        unsigned int index = 0;
+        // Index of the first instance of this mesh in the instance structure.
+        unsigned int first_instance = 0;
+    };
+
+    // Structure of one skinning group, built from its vertices in the animated vertex buffer. Groups of meshes that
+    // are not traced have none.
+    struct Skinned
+    {
+        id<MTLAccelerationStructure> structure API_AVAILABLE(macos(11.0));
+        MTLPrimitiveAccelerationStructureDescriptor *desc API_AVAILABLE(macos(11.0));
+        SkinningGroup group;
+        DrawDescriptor range;
+        NSUInteger scratch_offset;
+        unsigned int refits = 0;
+        unsigned int index = 0;
+    };
+
+    struct Bounds
+    {
+        glm::vec3 center;
+        float radius;
+    };
+
+    struct Change
+    {
+        unsigned int id;
+        unsigned int first;
+        unsigned int last;
+    };
+
+    // Instance structure that is being built on the background queue.
+    struct PendingBuild
+    {
+        id<MTLCommandBuffer> command_buffer = nil;
+        id<MTLAccelerationStructure> structure API_AVAILABLE(macos(11.0)) = nil;
+        id<MTLBuffer> scratch = nil;
+        // Centers of the instances the build was made with.
+        std::vector<glm::vec3> centers;
+    };
+
+    static bool traced(const DrawDescriptor &range)
+    {
+        return range.end - range.start >= 3;
+    }
+
+    static bool same_geometry(const DrawDescriptor &a, const DrawDescriptor &b)
+    {
+        return a.start == b.start && a.end == b.end && a.index_offset == b.index_offset &&
+               a.index_count == b.index_count && a.short_indices == b.short_indices;
+    }
+
+    static bool same_group(const SkinningGroup &a, const SkinningGroup &b)
+    {
+        return a.vertex_start == b.vertex_start && a.count == b.count && a.out_start == b.out_start;
+    }
+
+    static MTLAccelerationStructureTriangleGeometryDescriptor *geometry(
+        const VertexList<Vertex3D, JointData> &vertices, const DrawDescriptor &range, id<MTLBuffer> vertex_buffer,
+        unsigned int vertex_start) API_AVAILABLE(macos(11.0))
+    {
+        MTLAccelerationStructureTriangleGeometryDescriptor *geometry =
+            [MTLAccelerationStructureTriangleGeometryDescriptor descriptor];
+        geometry.vertexBuffer = vertex_buffer;
+        geometry.vertexBufferOffset = vertex_start * sizeof(Vertex3D);
+        geometry.vertexStride = sizeof(Vertex3D);
+        geometry.opaque = YES;
+        if (range.index_count > 0)
+        {
+            geometry.indexBuffer = vertices.index_buffer();
+            geometry.indexBufferOffset = range.index_offset;
+            geometry.indexType = range.short_indices ? MTLIndexTypeUInt16 : MTLIndexTypeUInt32;
+            geometry.triangleCount = range.index_count / 3;
+        }
+        else
+        {
+            geometry.triangleCount = (range.end - range.start) / 3;
+        }
+        return geometry;
+    }
+
+    // Builds the structures of the skinning groups when the groups changed and refits them when skinning ran. New
+    // skinned structures always come with a rebuilt instance structure.
+    template <typename BeginEncoding>
+    void update_skinned(id<MTLDevice> device, RetiredResources &retired,
+                        const VertexList<Vertex3D, JointData> &vertices, const std::vector<SkinningGroup> &groups,
+                        const IdTable<std::vector<unsigned int>> &skinned_instances, bool skinned,
+                        const BeginEncoding &begin_encoding) API_AVAILABLE(macos(11.0))
+    {
+        // Mesh of every skinning group.
+        std::vector<const DrawDescriptor *> group_ranges(groups.size(), nullptr);
+        for (const auto &[i, instance_groups] : skinned_instances)
+        {
+            const Mesh *mesh = _meshes.find(i);
+            for (const unsigned int group : instance_groups)
+            {
+                if (mesh && group < groups.size())
+                    group_ranges[group] = &mesh->range;
+            }
+        }
+
+        bool changed = _skinned_vertices != vertices.anim_buffer() || _skinned.size() != groups.size();
+        for (size_t g = 0; !changed && g < groups.size(); g++)
+        {
+            const bool built = _skinned[g].structure != nil;
+            changed = !same_group(_skinned[g].group, groups[g]) || built != (group_ranges[g] != nullptr) ||
+                      (built && !same_geometry(_skinned[g].range, *group_ranges[g]));
+        }
+
+        if (changed)
+        {
+            for (const Skinned &s : _skinned)
+                retired.retire(s.structure);
+            retired.retire(_skinned_scratch);
+            _skinned.clear();
+            _skinned_vertices = vertices.anim_buffer();
+            _instances_dirty = true;
+
+            // Skinned structures share one scratch buffer, each gets a region large enough to build or refit it.
+            NSUInteger scratch_length = 0;
+            for (size_t g = 0; g < groups.size(); g++)
+            {
+                Skinned s = {};
+                s.group = groups[g];
+                if (!group_ranges[g] || !_skinned_vertices)
+                {
+                    _skinned.push_back(s);
+                    continue;
+                }
+
+                MTLPrimitiveAccelerationStructureDescriptor *desc =
+                    [MTLPrimitiveAccelerationStructureDescriptor descriptor];
+                desc.geometryDescriptors =
+                    @[ geometry(vertices, *group_ranges[g], _skinned_vertices, groups[g].out_start) ];
+                desc.usage = MTLAccelerationStructureUsageRefit;
+
+                const MTLAccelerationStructureSizes sizes = [device accelerationStructureSizesWithDescriptor:desc];
+                s.structure = [device newAccelerationStructureWithSize:sizes.accelerationStructureSize];
+                s.desc = desc;
+                s.range = *group_ranges[g];
+                s.scratch_offset = scratch_length;
+                scratch_length += (scratch_size(sizes) + 255) & ~NSUInteger(255);
+                _skinned.push_back(s);
+            }
+            _skinned_scratch =
+                scratch_length > 0
+                    ? [device newBufferWithLength:scratch_length options:MTLResourceStorageModePrivate]
+                    : nil;
+        }
+
+        if (!changed && !skinned)
+            return;
+
+        for (Skinned &s : _skinned)
+        {
+            if (!s.structure)
+                continue;
+
+            if (changed || s.refits >= SKINNED_REFITS_PER_REBUILD)
+            {
+                [begin_encoding() buildAccelerationStructure:s.structure
+                                                  descriptor:s.desc
+                                               scratchBuffer:_skinned_scratch
+                                         scratchBufferOffset:s.scratch_offset];
+                s.refits = 0;
+            }
+            else
+            {
+                [begin_encoding() refitAccelerationStructure:s.structure
+                                                  descriptor:s.desc
+                                                 destination:nil
+                                               scratchBuffer:_skinned_scratch
+                                         scratchBufferOffset:s.scratch_offset];
+                s.refits++;
+            }
+        }
+    }
+
+    static MTLAccelerationStructureInstanceDescriptor descriptor(const glm::mat4 &m, unsigned int structure)
+    {
+        MTLAccelerationStructureInstanceDescriptor d = {};
+        for (int c = 0; c < 4; c++)
+            d.transformationMatrix.columns[c] = MTLPackedFloat3Make(m[c][0], m[c][1], m[c][2]);
+        d.options = MTLAccelerationStructureInstanceOptionOpaque;
+        d.mask = 0xFFu;
+        d.intersectionFunctionTableOffset = 0;
+        d.accelerationStructureIndex = structure;
+        return d;
+    }
+
+    glm::vec3 world_center(unsigned int id, const glm::mat4 &m) const
+    {
+        const Bounds *bounds = _bounds.find(id);
+        return glm::vec3(m * glm::vec4(bounds ? bounds->center : glm::vec3(0.0f), 1.0f));
+    }
+
+    // World space radius of an instance of a mesh.
+    float world_radius(unsigned int id, const glm::mat4 &m) const
+    {
+        const Bounds *bounds = _bounds.find(id);
+        const float scale = std::max({glm::length(glm::vec3(m[0])), glm::length(glm::vec3(m[1])),
+                                      glm::length(glm::vec3(m[2])), 1e-4f});
+        return (bounds ? bounds->radius : 1.0f) * scale;
+    }
+
+    // Measures how far every instance moved from where the instance structure was built, relative to its size and
+    // at most 1 per instance.
+    void update_degradation()
+    {
+        _degradation = 0.0f;
+        for (size_t i = 0; i < _centers.size(); i++)
+        {
+            _displacements[i] = std::min(glm::length(_centers[i] - _build_centers[i]) / _radii[i], 1.0f);
+            _degradation += _displacements[i];
+        }
+    }
+
+    // Rewrites every instance descriptor and rebuilds the instance structure in this command buffer, the instances
+    // reference other structures than before.
+    bool build_instances(id<MTLDevice> device, id<MTLCommandBuffer> command_buffer, UploadRing &ring,
+                         RetiredResources &retired, const IdTable<InstanceRange<glm::mat4>> &instances,
+                         const IdTable<std::vector<unsigned int>> &skinned_instances,
+                         NSArray<id<MTLAccelerationStructure>> *structures,
+                         unsigned int num_instances) API_AVAILABLE(macos(11.0))
+    {
+        constexpr size_t stride = sizeof(MTLAccelerationStructureInstanceDescriptor);
+        const UploadAllocation allocation = ring.allocate(num_instances * stride);
+        if (!allocation.valid())
+            return false;
+        _instances_dirty = false;
+        _transformed.clear();
+        _all_transformed = false;
+        _pending = {};
+
+        _descriptor_data.resize(num_instances);
+        _centers.resize(num_instances);
+        _radii.resize(num_instances);
+        _displacements.resize(num_instances);
+        _traced_instances.clear();
+        for (const auto &[i, mesh] : _meshes)
+        {
+            const InstanceRange<glm::mat4> *insts = instances.find(i);
+            if (!insts)
+                continue;
+
+            const std::vector<unsigned int> *groups = skinned_instances.find(i);
+            const unsigned int index_size = mesh.range.index_count == 0 ? 0 : mesh.range.short_indices ? 2 : 4;
+            for (unsigned int j = 0; j < insts->count; j++)
+            {
+                const unsigned int instance = mesh.first_instance + j;
+                const unsigned int group = groups && j < groups->size() ? (*groups)[j] : ~0u;
+                const bool animated = group < _skinned.size() && _skinned[group].structure;
+                const glm::mat4 &m = insts->ptr[j];
+                _descriptor_data[instance] = descriptor(m, animated ? _skinned[group].index : mesh.index);
+                _centers[instance] = world_center(i, m);
+                _radii[instance] = world_radius(i, m);
+
+                const unsigned int vertex_start = animated ? _skinned[group].group.out_start : mesh.range.start;
+                _traced_instances.push_back(TracedInstance{vertex_start, mesh.range.index_offset, index_size,
+                                                           insts->start + j, animated ? 1u : 0u});
+            }
+        }
+        _build_centers = _centers;
+        update_degradation();
+        memcpy(allocation.data, _descriptor_data.data(), num_instances * stride);
+
+        // Refits read the descriptors from a buffer of their own, later changes only copy the descriptors that moved.
+        if (_descriptors == nil || _descriptors.length < num_instances * stride)
+        {
+            retired.retire(_descriptors);
+            _descriptors = [device newBufferWithLength:num_instances * stride options:MTLResourceStorageModePrivate];
+            _descriptors.label = @"InstanceDescriptors";
+        }
+        id<MTLBlitCommandEncoder> blit = [command_buffer blitCommandEncoder];
+        blit.label = @"InstanceDescriptors";
+        [blit copyFromBuffer:allocation.buffer
+                 sourceOffset:allocation.offset
+                     toBuffer:_descriptors
+            destinationOffset:0
+                         size:num_instances * stride];
+        [blit endEncoding];
+
+        _instance_desc = [MTLInstanceAccelerationStructureDescriptor descriptor];
+        _instance_desc.instancedAccelerationStructures = structures;
+        _instance_desc.instanceCount = num_instances;
+        _instance_desc.usage = MTLAccelerationStructureUsageRefit;
+        _instance_desc.instanceDescriptorBuffer = _descriptors;
+        _instance_desc.instanceDescriptorBufferOffset = 0;
+
+        const MTLAccelerationStructureSizes sizes = [device accelerationStructureSizesWithDescriptor:_instance_desc];
+        retired.retire(_instance_structure, _scratch);
+        _instance_structure = [device newAccelerationStructureWithSize:sizes.accelerationStructureSize];
+        _scratch = [device newBufferWithLength:scratch_size(sizes) options:MTLResourceStorageModePrivate];
+
+        id<MTLAccelerationStructureCommandEncoder> encoder = [command_buffer accelerationStructureCommandEncoder];
+        encoder.label = @"InstanceAccelerationStructure";
+        [encoder buildAccelerationStructure:_instance_structure
+                                 descriptor:_instance_desc
+                              scratchBuffer:_scratch
+                        scratchBufferOffset:0];
+        [encoder endEncoding];
+        return true;
+    }
+
+    // Rewrites the descriptors of the instances that moved and copies them into the descriptor buffer, returns false
+    // when they could not be uploaded this frame.
+    bool update_transforms(id<MTLCommandBuffer> command_buffer, UploadRing &ring,
+                           const IdTable<InstanceRange<glm::mat4>> &instances) API_AVAILABLE(macos(11.0))
+    {
+        std::vector<Change> changes;
+        if (_all_transformed)
+        {
+            for (const auto &[i, insts] : instances)
+                changes.push_back({i, 0, insts.count});
+        }
+        else
+        {
+            changes = _transformed;
+        }
+
+        // Instances of meshes that are not traced have no descriptor.
+        size_t count = 0;
+        for (Change &change : changes)
+        {
+            const InstanceRange<glm::mat4> *insts = instances.find(change.id);
+            change.last = _meshes.has(change.id) && insts ? std::min(change.last, insts->count) : 0;
+            if (change.first < change.last)
+                count += change.last - change.first;
+        }
+
+        _transformed.clear();
+        _all_transformed = false;
+        if (count == 0)
+            return false;
+
+        constexpr size_t stride = sizeof(MTLAccelerationStructureInstanceDescriptor);
+        const UploadAllocation allocation = ring.allocate(count * stride);
+        if (!allocation.valid())
+        {
+            // Tried again next frame.
+            _transformed = std::move(changes);
+            return false;
+        }
+
+        auto *data = reinterpret_cast<MTLAccelerationStructureInstanceDescriptor *>(allocation.data);
+        id<MTLBlitCommandEncoder> blit = [command_buffer blitCommandEncoder];
+        blit.label = @"InstanceDescriptors";
+        size_t written = 0;
+        for (const Change &change : changes)
+        {
+            if (change.first >= change.last)
+                continue;
+
+            const Mesh &mesh = _meshes[change.id];
+            const InstanceRange<glm::mat4> &insts = *instances.find(change.id);
+            for (unsigned int j = change.first; j < change.last; j++)
+            {
+                const unsigned int instance = mesh.first_instance + j;
+                const glm::mat4 &m = insts.ptr[j];
+                MTLAccelerationStructureInstanceDescriptor &d = _descriptor_data[instance];
+                d = descriptor(m, d.accelerationStructureIndex);
+                data[written + j - change.first] = d;
+
+                _centers[instance] = world_center(change.id, m);
+                _radii[instance] = world_radius(change.id, m);
+                const float moved =
+                    std::min(glm::length(_centers[instance] - _build_centers[instance]) / _radii[instance], 1.0f);
+                _degradation += moved - _displacements[instance];
+                _displacements[instance] = moved;
+            }
+
+            const size_t run = change.last - change.first;
+            [blit copyFromBuffer:allocation.buffer
+                     sourceOffset:allocation.offset + written * stride
+                         toBuffer:_descriptors
+                destinationOffset:(mesh.first_instance + change.first) * stride
+                             size:run * stride];
+            written += run;
+        }
+        [blit endEncoding];
+        return true;
+    }
+
+    // Builds a new instance structure from the current descriptors on the build queue, it replaces the current one
+    // once it completed. Refits keep the current structure up to date in the meantime.
+    void rebuild_in_background(id<MTLDevice> device) API_AVAILABLE(macos(11.0))
+    {
+        if (_build_queue == nil)
+        {
+            _build_queue = [device newCommandQueue];
+            _build_queue.label = @"AccelerationStructureBuilds";
+        }
+
+        id<MTLBuffer> descriptors =
+            [device newBufferWithBytes:_descriptor_data.data()
+                                length:_descriptor_data.size() * sizeof(MTLAccelerationStructureInstanceDescriptor)
+                               options:MTLResourceStorageModeShared];
+
+        MTLInstanceAccelerationStructureDescriptor *desc = [MTLInstanceAccelerationStructureDescriptor descriptor];
+        desc.instancedAccelerationStructures = _instance_desc.instancedAccelerationStructures;
+        desc.instanceCount = _instance_desc.instanceCount;
+        desc.usage = MTLAccelerationStructureUsageRefit;
+        desc.instanceDescriptorBuffer = descriptors;
+
+        const MTLAccelerationStructureSizes sizes = [device accelerationStructureSizesWithDescriptor:desc];
+        _pending.structure = [device newAccelerationStructureWithSize:sizes.accelerationStructureSize];
+        _pending.scratch = [device newBufferWithLength:scratch_size(sizes) options:MTLResourceStorageModePrivate];
+        _pending.centers = _centers;
+
+        _pending.command_buffer = [_build_queue commandBuffer];
+        _pending.command_buffer.label = @"InstanceAccelerationStructureRebuild";
+        id<MTLAccelerationStructureCommandEncoder> encoder =
+            [_pending.command_buffer accelerationStructureCommandEncoder];
+        encoder.label = @"InstanceAccelerationStructureRebuild";
+        [encoder buildAccelerationStructure:_pending.structure
+                                 descriptor:desc
+                              scratchBuffer:_pending.scratch
+                        scratchBufferOffset:0];
+        [encoder endEncoding];
+        [_pending.command_buffer commit];
+    }
+
+    // Large enough for both building and refitting a structure.
+    static NSUInteger scratch_size(const MTLAccelerationStructureSizes &sizes) API_AVAILABLE(macos(11.0))
+    {
+        return std::max<NSUInteger>(std::max(sizes.buildScratchBufferSize, sizes.refitScratchBufferSize), 1);
+    }
+
+    IdTable<Mesh> _meshes;
+    IdTable<Bounds> _bounds;
+    bool _instances_dirty = true;
+    std::vector<Change> _transformed;
+    bool _all_transformed = false;
+    std::vector<TracedInstance> _traced_instances;
+
+    std::vector<Skinned> _skinned;
+    // Animated vertex buffer the skinned structures were built from.
+    id<MTLBuffer> _skinned_vertices = nil;
+    id<MTLBuffer> _skinned_scratch = nil;
+
+    id<MTLAccelerationStructure> _instance_structure API_AVAILABLE(macos(11.0)) = nil;
+    MTLInstanceAccelerationStructureDescriptor *_instance_desc API_AVAILABLE(macos(11.0)) = nil;
+    // Kept for refits, large enough for both building and refitting the instance structure.
+    id<MTLBuffer> _scratch = nil;
+    // Instance descriptors in instance structure order, on the CPU and in the buffer refits read them from.
+    std::vector<MTLAccelerationStructureInstanceDescriptor> _descriptor_data;
+    id<MTLBuffer> _descriptors = nil;
+
+    // World centers and radii of the instances, where they were when the instance structure was built and how far
+    // each moved since.
+    std::vector<glm::vec3> _centers;
+    std::vector<float> _radii;
+    std::vector<glm::vec3> _build_centers;
+    std::vector<float> _displacements;
+    float _degradation = 0.0f;
+    id<MTLCommandQueue> _build_queue = nil;
+    PendingBuild _pending;
+};
+
+#endif // METALCPP_SRC_ACCELERATION_STRUCTURES_HPP
@@ -2,16 +2,39 @@
 #define BUFFER_H
 
 #import <Metal/Metal.h>
+#include <TargetConditionals.h>
 
 #include <cxxabi.h>
 #include <string>
 #include <typeinfo>
 
+// Managed storage only exists on macOS, the GPUs of iOS and iPadOS share all of their memory with the CPU.
+#if TARGET_OS_IPHONE
+constexpr MTLResourceOptions MANAGED_STORAGE = MTLResourceStorageModeShared;
+#else
+constexpr MTLResourceOptions MANAGED_STORAGE = MTLResourceStorageModeManaged;
+#endif
+
+// Storage for buffers the CPU writes and the GPU reads. Unified memory devices share the memory directly, other
+// devices keep a managed CPU mirror that needs didModifyRange.
+inline MTLResourceOptions cpu_write_storage(id<MTLDevice> device)
+{
+    return [device hasUnifiedMemory] ? MTLResourceStorageModeShared : MANAGED_STORAGE;
+}
+
+// Tells a managed buffer which bytes the CPU wrote, there is nothing to tell on iOS.
+inline void did_modify(id<MTLBuffer> buffer, NSRange range)
+{
+#if !TARGET_OS_IPHONE
+    [buffer didModifyRange:range];
+#endif
+}
+
 template <typename T> class Buffer
 {
   public:
-    Buffer(id<MTLDevice> device, size_t count, MTLResourceOptions options = MTLResourceStorageModeManaged)
-        : _device(device), _count(count)
+    Buffer(id<MTLDevice> device, size_t count, MTLResourceOptions options = MANAGED_STORAGE)
+        : _device(device), _count(count), _managed(is_managed(options))
     {
         const size_t bytes = count * sizeof(T);
 
@@ -20,15 +43,15 @@ template <typename T> class Buffer
     }
 
     Buffer(id<MTLDevice> device, const T *data, size_t count,
-           MTLResourceOptions options = MTLResourceStorageModeManaged)
-        : _device(device), _count(count)
+           MTLResourceOptions options = MANAGED_STORAGE)
+        : _device(device), _count(count), _managed(is_managed(options))
     {
         const size_t bytes = count * sizeof(T);
         _buffer = [_device newBufferWithLength:bytes options:options];
 
         memcpy([_buffer contents], data, count * sizeof(T));
 
-        [_buffer didModifyRange:NSMakeRange(0, byte_size())];
+        update();
     }
 
     Buffer(const Buffer<T> &buffer)
@@ -38,6 +61,8 @@ template <typename T> class Buffer
 
         _buffer = std::move(buffer._buffer);
         _device = std::move(buffer._device);
+        _count = buffer._count;
+        _managed = buffer._managed;
     }
 
     ~Buffer()
@@ -48,7 +73,7 @@ template <typename T> class Buffer
 
     const void *data() const
     {
-        reinterpret_cast<const T *>([_buffer contents]);
+        return reinterpret_cast<const T *>([_buffer contents]);
     }
 
     void *data()
@@ -56,12 +81,16 @@ template <typename T> class Buffer
         return reinterpret_cast<T *>([_buffer contents]);
     }
 
+    // Shared buffers are coherent, only managed buffers need to be told which range was written.
     void update(unsigned int start = 0, unsigned int end = 0)
     {
+        if (!_managed)
+            return;
+
         if (start == 0 && end == 0)
-            [_buffer didModifyRange:NSMakeRange(0, byte_size())];
+            did_modify(_buffer, NSMakeRange(0, byte_size()));
         else
-            [_buffer didModifyRange:NSMakeRange(start * sizeof(T), end * sizeof(T))];
+            did_modify(_buffer, NSMakeRange(start * sizeof(T), (end - start) * sizeof(T)));
     }
 
     size_t size() const
@@ -84,10 +113,29 @@ template <typename T> class Buffer
         return _buffer;
     }
 
+    bool managed() const
+    {
+        return _managed;
+    }
+
   private:
+    static bool is_managed(MTLResourceOptions options)
+    {
+        return MANAGED_STORAGE != MTLResourceStorageModeShared &&
+               (options & MTLResourceStorageModeMask) == MANAGED_STORAGE;
+    }
+
     id<MTLDevice> _device;
     id<MTLBuffer> _buffer;
     size_t _count;
+    bool _managed;
+};
+
+// Allocator policy of VertexList and InstanceList, their buffers are Metal buffers. See host_buffer.hpp for one that
+// runs the lists without a device.
+struct MetalAllocator
+{
+    template <typename T> using Buffer = ::Buffer<T>;
 };
 
 #endif // BUFFER_H
\ No newline at end of file
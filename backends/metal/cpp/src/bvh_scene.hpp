@@ -0,0 +1,544 @@
+#ifndef METALCPP_SRC_BVH_SCENE_HPP
+#define METALCPP_SRC_BVH_SCENE_HPP
+
+#import <Metal/Metal.h>
+
+#include "buffer.hpp"
+#include "id_table.hpp"
+#include "instance_list.h"
+#include "library.h"
+#include "retired_resources.hpp"
+#include "upload_ring.hpp"
+#include "vertex_list.h"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <limits>
+#include <numeric>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+// Ray tracing scene of the full-format 3D meshes on GPUs without ray tracing support, which the tracing kernels
+// traverse in compute instead of the acceleration structures of acceleration_structures.hpp. Every mesh gets a BVH
+// built on the CPU with binned SAH and collapsed to four children per node like the MBVH of gpu-rt, its triangles are
+// stored in leaf order. Meshes are read back from the vertex list the first time they are traced after they changed,
+// meshes in GPU-only vertex storage are built from the data they were set with instead.
+//
+// The instances get a BVH of the same kind, built again whenever they changed or moved and uploaded every frame along
+// with the argument buffer of BvhScene. Skinned instances are left out, their vertices only exist on the GPU.
+class BvhScene
+{
+  public:
+    // Triangles or instances per leaf at most.
+    static constexpr unsigned int MAX_LEAF_SIZE = 4;
+    static constexpr unsigned int SAH_BINS = 16;
+
+    // Builds the BVH of a mesh from its vertices right away.
+    void set_mesh(unsigned int id, const Vertex3D *vertices, unsigned int num_vertices, const unsigned int *indices,
+                  unsigned int num_indices)
+    {
+        _meshes[id] = build_mesh(vertices, num_vertices, indices, num_indices);
+        _meshes_dirty = true;
+    }
+
+    void mark_mesh_changed(unsigned int id)
+    {
+        if (Mesh *mesh = _meshes.find(id))
+            mesh->valid = false;
+    }
+
+    void mark_instances_changed()
+    {
+        _instances_dirty = true;
+    }
+
+    // Brings the BVHs up to date with the meshes and instances and uploads the instance BVH of this frame, returns
+    // false when there is nothing to trace.
+    bool update(id<MTLDevice> device, UploadRing &ring, RetiredResources &retired,
+                const VertexList<Vertex3D, JointData> &vertices, const IdTable<InstanceRange<glm::mat4>> &instances,
+                const std::vector<SkinningGroup> &skinning_groups,
+                const IdTable<std::vector<unsigned int>> &skinned_instances)
+    {
+        const IdTable<DrawDescriptor> &ranges = vertices.get_draw_ranges();
+
+        std::vector<unsigned int> removed;
+        for (const auto &[i, mesh] : _meshes)
+        {
+            const DrawDescriptor *range = ranges.find(i);
+            if (!range || !traced(*range))
+                removed.push_back(i);
+        }
+        for (const unsigned int i : removed)
+            _meshes.erase(i);
+        if (!removed.empty())
+            _meshes_dirty = true;
+
+        std::vector<Vertex3D> mesh_vertices;
+        std::vector<JointData> joints_weights;
+        std::vector<unsigned int> mesh_indices;
+        for (const auto &[i, range] : ranges)
+        {
+            if (!traced(range) || !instances.has(i))
+                continue;
+
+            Mesh *mesh = _meshes.find(i);
+            if (mesh && mesh->valid && mesh->num_vertices == range.end - range.start &&
+                mesh->num_indices == range.index_count)
+            {
+                // Instances reference the vertices where the mesh lives now.
+                if (mesh->range.start != range.start || mesh->range.index_offset != range.index_offset)
+                    _instances_dirty = true;
+                mesh->range = range;
+                continue;
+            }
+
+            if (!vertices.read_mesh(i, mesh_vertices, joints_weights, mesh_indices))
+            {
+                if (_meshes.erase(i))
+                    _meshes_dirty = true;
+                continue;
+            }
+            _meshes[i] = build_mesh(mesh_vertices.data(), static_cast<unsigned int>(mesh_vertices.size()),
+                                    mesh_indices.empty() ? nullptr : mesh_indices.data(),
+                                    static_cast<unsigned int>(mesh_indices.size()));
+            _meshes[i].range = range;
+            _meshes_dirty = true;
+        }
+
+        if (_meshes_dirty)
+            upload_meshes(device, retired);
+        if (_instances_dirty)
+            build_instances(instances, skinning_groups, skinned_instances);
+        if (_instances.empty())
+            return false;
+
+        const UploadAllocation top_nodes = ring.upload(_top_nodes.data(), _top_nodes.size());
+        const UploadAllocation bvh_instances = ring.upload(_instances.data(), _instances.size());
+        if (_encoder == nil)
+        {
+            NSMutableArray<MTLArgumentDescriptor *> *arguments = [NSMutableArray array];
+            for (unsigned int i = 0; i < BVH_SCENE_ARGUMENT_COUNT; i++)
+            {
+                MTLArgumentDescriptor *argument = [MTLArgumentDescriptor argumentDescriptor];
+                argument.index = i;
+                argument.dataType = MTLDataTypePointer;
+                argument.access = MTLArgumentAccessReadOnly;
+                [arguments addObject:argument];
+            }
+            _encoder = [device newArgumentEncoderWithArguments:arguments];
+        }
+        _arguments = ring.allocate(_encoder.encodedLength);
+        if (!top_nodes.valid() || !bvh_instances.valid() || !_arguments.valid())
+            return false;
+
+        [_encoder setArgumentBuffer:_arguments.buffer offset:_arguments.offset];
+        [_encoder setBuffer:top_nodes.buffer offset:top_nodes.offset atIndex:BVH_TOP_NODES_ARG_INDEX];
+        [_encoder setBuffer:bvh_instances.buffer offset:bvh_instances.offset atIndex:BVH_INSTANCES_ARG_INDEX];
+        [_encoder setBuffer:_nodes offset:0 atIndex:BVH_NODES_ARG_INDEX];
+        [_encoder setBuffer:_triangles offset:0 atIndex:BVH_TRIANGLES_ARG_INDEX];
+        return true;
+    }
+
+    // Geometry of every instance in the order of BvhInstance::instance, for shading the hits of traced rays.
+    const std::vector<TracedInstance> &traced_instances() const
+    {
+        return _traced_instances;
+    }
+
+    // Binds the argument buffer of this frame and declares the buffers it points to.
+    void bind(id<MTLComputeCommandEncoder> encoder, unsigned int index) const
+    {
+        [encoder setBuffer:_arguments.buffer offset:_arguments.offset atIndex:index];
+        [encoder useResource:_arguments.buffer usage:MTLResourceUsageRead];
+        [encoder useResource:_nodes usage:MTLResourceUsageRead];
+        [encoder useResource:_triangles usage:MTLResourceUsageRead];
+    }
+
+  private:
+    struct Box
+    {
+        glm::vec3 bmin = glm::vec3(std::numeric_limits<float>::max());
+        glm::vec3 bmax = glm::vec3(-std::numeric_limits<float>::max());
+
+        void grow(const glm::vec3 &p)
+        {
+            bmin = glm::min(bmin, p);
+            bmax = glm::max(bmax, p);
+        }
+
+        void grow(const Box &box)
+        {
+            bmin = glm::min(bmin, box.bmin);
+            bmax = glm::max(bmax, box.bmax);
+        }
+
+        // Half the surface area, which is all SAH compares.
+        float area() const
+        {
+            const glm::vec3 e = glm::max(bmax - bmin, glm::vec3(0.0f));
+            return e.x * e.y + e.y * e.z + e.z * e.x;
+        }
+    };
+
+    // Node of the binary BVH that is collapsed, leaves have no left child as the root is nobody's child.
+    struct BinaryNode
+    {
+        Box bounds;
+        unsigned int first;
+        unsigned int count;
+        unsigned int left;
+    };
+
+    struct Mesh
+    {
+        std::vector<BvhNode> nodes;
+        std::vector<BvhTriangle> triangles;
+        Box bounds;
+        unsigned int num_vertices = 0;
+        unsigned int num_indices = 0;
+        // Range the instances of the mesh reference its vertices by.
+        DrawDescriptor range = {};
+        bool valid = true;
+        // Index of its root node in the node buffer.
+        unsigned int root = 0;
+    };
+
+    static bool traced(const DrawDescriptor &range)
+    {
+        return range.end - range.start >= 3;
+    }
+
+    static unsigned int bin(float center, float bmin, float scale)
+    {
+        return std::min(static_cast<unsigned int>((center - bmin) * scale), SAH_BINS - 1);
+    }
+
+    // Binary BVH over boxes, split with binned SAH until leaves hold MAX_LEAF_SIZE boxes at most. order gets the
+    // boxes in leaf order, leaves cover a range of it.
+    static void build_binary(const std::vector<Box> &boxes, std::vector<BinaryNode> &nodes,
+                             std::vector<unsigned int> &order)
+    {
+        const auto count = static_cast<unsigned int>(boxes.size());
+        order.resize(count);
+        std::iota(order.begin(), order.end(), 0u);
+        std::vector<glm::vec3> centers(count);
+        Box root;
+        for (unsigned int i = 0; i < count; i++)
+        {
+            centers[i] = (boxes[i].bmin + boxes[i].bmax) * 0.5f;
+            root.grow(boxes[i]);
+        }
+
+        nodes.clear();
+        nodes.push_back({root, 0, count, 0});
+        std::vector<unsigned int> stack = {0};
+        while (!stack.empty())
+        {
+            const unsigned int index = stack.back();
+            stack.pop_back();
+            const BinaryNode node = nodes[index];
+            if (node.count <= MAX_LEAF_SIZE)
+                continue;
+
+            Box centroids;
+            for (unsigned int i = node.first; i < node.first + node.count; i++)
+                centroids.grow(centers[order[i]]);
+
+            int best_axis = -1;
+            unsigned int best_bin = 0;
+            float best_cost = std::numeric_limits<float>::max();
+            for (int axis = 0; axis < 3; axis++)
+            {
+                const float extent = centroids.bmax[axis] - centroids.bmin[axis];
+                if (extent <= 0.0f)
+                    continue;
+
+                const float scale = static_cast<float>(SAH_BINS) / extent;
+                std::array<Box, SAH_BINS> bins;
+                std::array<unsigned int, SAH_BINS> counts = {};
+                for (unsigned int i = node.first; i < node.first + node.count; i++)
+                {
+                    const unsigned int b = bin(centers[order[i]][axis], centroids.bmin[axis], scale);
+                    bins[b].grow(boxes[order[i]]);
+                    counts[b]++;
+                }
+
+                // Areas and counts of the right side of every split, swept from the right.
+                std::array<float, SAH_BINS> right_areas = {};
+                std::array<unsigned int, SAH_BINS> right_counts = {};
+                Box right;
+                unsigned int right_count = 0;
+                for (unsigned int b = SAH_BINS - 1; b > 0; b--)
+                {
+                    right.grow(bins[b]);
+                    right_count += counts[b];
+                    right_areas[b] = right.area();
+                    right_counts[b] = right_count;
+                }
+
+                Box left;
+                unsigned int left_count = 0;
+                for (unsigned int b = 1; b < SAH_BINS; b++)
+                {
+                    left.grow(bins[b - 1]);
+                    left_count += counts[b - 1];
+                    if (left_count == 0 || right_counts[b] == 0)
+                        continue;
+
+                    const float cost = left.area() * static_cast<float>(left_count) +
+                                       right_areas[b] * static_cast<float>(right_counts[b]);
+                    if (cost < best_cost)
+                    {
+                        best_cost = cost;
+                        best_axis = axis;
+                        best_bin = b;
+                    }
+                }
+            }
+
+            // Boxes with coincident centers are split in the middle of their range.
+            unsigned int middle = node.first + node.count / 2;
+            if (best_axis >= 0)
+            {
+                const float bmin = centroids.bmin[best_axis];
+                const float scale = static_cast<float>(SAH_BINS) / (centroids.bmax[best_axis] - bmin);
+                const auto split = std::partition(
+                    order.begin() + node.first, order.begin() + node.first + node.count,
+                    [&](unsigned int i) { return bin(centers[i][best_axis], bmin, scale) < best_bin; });
+                middle = static_cast<unsigned int>(split - order.begin());
+            }
+
+            BinaryNode left = {Box{}, node.first, middle - node.first, 0};
+            BinaryNode right = {Box{}, middle, node.first + node.count - middle, 0};
+            for (unsigned int i = left.first; i < left.first + left.count; i++)
+                left.bounds.grow(boxes[order[i]]);
+            for (unsigned int i = right.first; i < right.first + right.count; i++)
+                right.bounds.grow(boxes[order[i]]);
+
+            const auto left_index = static_cast<unsigned int>(nodes.size());
+            nodes[index].left = left_index;
+            nodes.push_back(left);
+            nodes.push_back(right);
+            stack.push_back(left_index);
+            stack.push_back(left_index + 1);
+        }
+    }
+
+    // Writes the node of four children for a node of the binary BVH, which opens its largest internal children until
+    // it has four, and the nodes below it. Returns the index of the node.
+    static unsigned int collapse(const std::vector<BinaryNode> &binary, unsigned int index, std::vector<BvhNode> &nodes)
+    {
+        std::array<unsigned int, 4> children = {index};
+        unsigned int count = 1;
+        if (binary[index].left != 0)
+        {
+            children = {binary[index].left, binary[index].left + 1};
+            count = 2;
+        }
+        while (count < 4)
+        {
+            int largest = -1;
+            float largest_area = -1.0f;
+            for (unsigned int c = 0; c < count; c++)
+            {
+                const BinaryNode &child = binary[children[c]];
+                if (child.left != 0 && child.bounds.area() > largest_area)
+                {
+                    largest = static_cast<int>(c);
+                    largest_area = child.bounds.area();
+                }
+            }
+            if (largest < 0)
+                break;
+
+            const unsigned int opened = binary[children[largest]].left;
+            children[largest] = opened;
+            children[count++] = opened + 1;
+        }
+
+        const auto node_index = static_cast<unsigned int>(nodes.size());
+        nodes.emplace_back();
+        BvhNode node = {};
+        node.min_x = node.min_y = node.min_z = std::numeric_limits<float>::max();
+        node.max_x = node.max_y = node.max_z = -std::numeric_limits<float>::max();
+        node.children = -1;
+        node.counts = 0;
+        for (unsigned int c = 0; c < count; c++)
+        {
+            const BinaryNode &child = binary[children[c]];
+            node.min_x[c] = child.bounds.bmin.x;
+            node.min_y[c] = child.bounds.bmin.y;
+            node.min_z[c] = child.bounds.bmin.z;
+            node.max_x[c] = child.bounds.bmax.x;
+            node.max_y[c] = child.bounds.bmax.y;
+            node.max_z[c] = child.bounds.bmax.z;
+            if (child.left == 0)
+            {
+                node.children[c] = static_cast<int>(child.first);
+                node.counts[c] = static_cast<int>(child.count);
+            }
+            else
+            {
+                node.children[c] = static_cast<int>(collapse(binary, children[c], nodes));
+                node.counts[c] = -1;
+            }
+        }
+        nodes[node_index] = node;
+        return node_index;
+    }
+
+    static Mesh build_mesh(const Vertex3D *vertices, unsigned int num_vertices, const unsigned int *indices,
+                           unsigned int num_indices)
+    {
+        Mesh mesh;
+        mesh.num_vertices = num_vertices;
+        mesh.num_indices = indices ? num_indices : 0;
+        const unsigned int num_triangles = (indices ? num_indices : num_vertices) / 3;
+        if (num_triangles == 0 || num_vertices == 0)
+            return mesh;
+
+        std::vector<std::array<glm::vec3, 3>> triangles(num_triangles);
+        std::vector<Box> boxes(num_triangles);
+        for (unsigned int t = 0; t < num_triangles; t++)
+        {
+            for (unsigned int k = 0; k < 3; k++)
+            {
+                const unsigned int i = std::min(indices ? indices[t * 3 + k] : t * 3 + k, num_vertices - 1);
+                triangles[t][k] = glm::vec3(vertices[i].v_x, vertices[i].v_y, vertices[i].v_z);
+                boxes[t].grow(triangles[t][k]);
+            }
+        }
+
+        std::vector<BinaryNode> binary;
+        std::vector<unsigned int> order;
+        build_binary(boxes, binary, order);
+        collapse(binary, 0, mesh.nodes);
+        mesh.bounds = binary[0].bounds;
+
+        mesh.triangles.resize(num_triangles);
+        for (unsigned int i = 0; i < num_triangles; i++)
+        {
+            const std::array<glm::vec3, 3> &t = triangles[order[i]];
+            float primitive;
+            memcpy(&primitive, &order[i], sizeof(float));
+            const glm::vec3 e1 = t[1] - t[0];
+            const glm::vec3 e2 = t[2] - t[0];
+            mesh.triangles[i] = {simd_make_float4(t[0].x, t[0].y, t[0].z, primitive),
+                                 simd_make_float4(e1.x, e1.y, e1.z, 0.0f), simd_make_float4(e2.x, e2.y, e2.z, 0.0f)};
+        }
+        return mesh;
+    }
+
+    // Concatenates the BVHs of all meshes into the node and triangle buffers. Children point into the buffers.
+    void upload_meshes(id<MTLDevice> device, RetiredResources &retired)
+    {
+        std::vector<BvhNode> nodes;
+        std::vector<BvhTriangle> triangles;
+        for (auto &[i, mesh] : _meshes)
+        {
+            const auto node_offset = static_cast<int>(nodes.size());
+            const auto triangle_offset = static_cast<int>(triangles.size());
+            mesh.root = static_cast<unsigned int>(node_offset);
+            for (BvhNode node : mesh.nodes)
+            {
+                for (int c = 0; c < 4; c++)
+                {
+                    if (node.children[c] >= 0)
+                        node.children[c] += node.counts[c] < 0 ? node_offset : triangle_offset;
+                }
+                nodes.push_back(node);
+            }
+            triangles.insert(triangles.end(), mesh.triangles.begin(), mesh.triangles.end());
+        }
+
+        // Buffers are never empty, the argument buffer always points at something.
+        nodes.resize(std::max<size_t>(nodes.size(), 1));
+        triangles.resize(std::max<size_t>(triangles.size(), 1));
+        retired.retire(_nodes, _triangles);
+        _nodes = [device newBufferWithBytes:nodes.data()
+                                     length:nodes.size() * sizeof(BvhNode)
+                                    options:cpu_write_storage(device)];
+        _nodes.label = @"BvhNodes";
+        _triangles = [device newBufferWithBytes:triangles.data()
+                                         length:triangles.size() * sizeof(BvhTriangle)
+                                        options:cpu_write_storage(device)];
+        _triangles.label = @"BvhTriangles";
+        _meshes_dirty = false;
+        _instances_dirty = true;
+    }
+
+    // Builds the BVH over the world space bounds of every instance of a traced mesh and lists their geometry.
+    void build_instances(const IdTable<InstanceRange<glm::mat4>> &instances,
+                         const std::vector<SkinningGroup> &skinning_groups,
+                         const IdTable<std::vector<unsigned int>> &skinned_instances)
+    {
+        _instances_dirty = false;
+        _traced_instances.clear();
+        _instances.clear();
+        _top_nodes.clear();
+
+        std::vector<BvhInstance> unordered;
+        std::vector<Box> boxes;
+        for (const auto &[i, mesh] : _meshes)
+        {
+            const InstanceRange<glm::mat4> *insts = instances.find(i);
+            if (!insts || mesh.triangles.empty())
+                continue;
+
+            const std::vector<unsigned int> *groups = skinned_instances.find(i);
+            const unsigned int index_size = mesh.range.index_count == 0 ? 0 : mesh.range.short_indices ? 2 : 4;
+            for (unsigned int j = 0; j < insts->count; j++)
+            {
+                if (groups && j < groups->size() && (*groups)[j] < skinning_groups.size())
+                    continue;
+
+                const glm::mat4 &m = insts->ptr[j];
+                const glm::mat4 inverse = glm::inverse(m);
+                BvhInstance instance = {};
+                for (int r = 0; r < 3; r++)
+                    instance.inverse[r] = simd_make_float4(inverse[0][r], inverse[1][r], inverse[2][r], inverse[3][r]);
+                instance.root = mesh.root;
+                instance.instance = static_cast<unsigned int>(_traced_instances.size());
+                unordered.push_back(instance);
+                _traced_instances.push_back(
+                    TracedInstance{mesh.range.start, mesh.range.index_offset, index_size, insts->start + j, 0u});
+
+                // Corners of the mesh bounds in world space.
+                Box box;
+                for (unsigned int c = 0; c < 8; c++)
+                {
+                    const glm::vec3 corner = glm::vec3((c & 1) ? mesh.bounds.bmax.x : mesh.bounds.bmin.x,
+                                                       (c & 2) ? mesh.bounds.bmax.y : mesh.bounds.bmin.y,
+                                                       (c & 4) ? mesh.bounds.bmax.z : mesh.bounds.bmin.z);
+                    box.grow(glm::vec3(m * glm::vec4(corner, 1.0f)));
+                }
+                boxes.push_back(box);
+            }
+        }
+        if (boxes.empty())
+            return;
+
+        std::vector<BinaryNode> binary;
+        std::vector<unsigned int> order;
+        build_binary(boxes, binary, order);
+        collapse(binary, 0, _top_nodes);
+        for (const unsigned int i : order)
+            _instances.push_back(unordered[i]);
+    }
+
+    IdTable<Mesh> _meshes;
+    bool _meshes_dirty = false;
+    bool _instances_dirty = true;
+    id<MTLBuffer> _nodes = nil;
+    id<MTLBuffer> _triangles = nil;
+
+    std::vector<BvhNode> _top_nodes;
+    std::vector<BvhInstance> _instances;
+    std::vector<TracedInstance> _traced_instances;
+    id<MTLArgumentEncoder> _encoder = nil;
+    UploadAllocation _arguments;
+};
+
+#endif // METALCPP_SRC_BVH_SCENE_HPP
@@ -0,0 +1,170 @@
+#ifndef METALCPP_SRC_CELL_STREAMING_HPP
+#define METALCPP_SRC_CELL_STREAMING_HPP
+
+#include "id_table.hpp"
+#include "library.h"
+#include "texture_format.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+// Copy of a registered cell, the mesh and texture data it points to stays the caller's.
+struct StreamedCell
+{
+    Aabb bounds = {};
+    float priority = 0.0f;
+    std::vector<unsigned int> mesh_ids;
+    std::vector<MeshData3D> meshes;
+    std::vector<unsigned int> texture_slots;
+    std::vector<TextureData> textures;
+    // Bytes its meshes and textures upload.
+    size_t bytes = 0;
+    bool loaded = false;
+};
+
+// Cells to load in the order they should be, and cells to unload.
+struct CellPlan
+{
+    std::vector<unsigned int> load;
+    std::vector<unsigned int> unload;
+};
+
+// Decides which cells of a world partition are loaded from the distance of their bounds to the camera. Cells within
+// the load radius of the camera or of where it will be after the prefetch time at its current velocity load nearest
+// first, cells of higher priority count as nearer, until the loads of a frame reach the upload budget. Cells beyond the
+// unload radius of both are unloaded, the gap between the radii keeps cells on the border from loading every other
+// frame.
+class CellStreamer
+{
+  public:
+    void configure(const StreamingSettings &settings)
+    {
+        _settings = settings;
+        _settings.load_radius = std::max(settings.load_radius, 0.0f);
+        _settings.unload_radius = std::max(settings.unload_radius, _settings.load_radius);
+        _settings.prefetch_seconds = std::max(settings.prefetch_seconds, 0.0f);
+    }
+
+    // A load radius of 0 disables streaming, registered cells are all unloaded.
+    bool enabled() const
+    {
+        return _settings.load_radius > 0.0f;
+    }
+
+    // Returns the previous version of the cell, which is still loaded until the renderer unloads it.
+    StreamedCell set_cell(unsigned int id, const StreamingCell &cell)
+    {
+        StreamedCell previous = remove_cell(id);
+        StreamedCell copy;
+        copy.bounds = cell.bounds;
+        copy.priority = std::max(cell.priority, 0.0f);
+        if (cell.mesh_ids && cell.meshes)
+        {
+            copy.mesh_ids.assign(cell.mesh_ids, cell.mesh_ids + cell.num_meshes);
+            copy.meshes.assign(cell.meshes, cell.meshes + cell.num_meshes);
+        }
+        if (cell.texture_slots && cell.textures)
+        {
+            copy.texture_slots.assign(cell.texture_slots, cell.texture_slots + cell.num_textures);
+            copy.textures.assign(cell.textures, cell.textures + cell.num_textures);
+        }
+        for (const MeshData3D &mesh : copy.meshes)
+        {
+            copy.bytes += size_t(mesh.num_vertices) * (sizeof(Vertex3D) + (mesh.skin_data ? sizeof(JointData) : 0));
+            copy.bytes += size_t(mesh.num_indices) * sizeof(unsigned int);
+        }
+        for (const TextureData &texture : copy.textures)
+            copy.bytes += texture.format == KTX2 ? texture.num_bytes : mip_levels_size(texture, 0);
+        _cells[id] = std::move(copy);
+        return previous;
+    }
+
+    StreamedCell remove_cell(unsigned int id)
+    {
+        StreamedCell previous;
+        if (StreamedCell *cell = _cells.find(id))
+        {
+            previous = std::move(*cell);
+            _cells.erase(id);
+        }
+        return previous;
+    }
+
+    const StreamedCell *find(unsigned int id) const
+    {
+        return _cells.find(id);
+    }
+
+    void mark_loaded(unsigned int id, bool loaded)
+    {
+        if (StreamedCell *cell = _cells.find(id))
+            cell->loaded = loaded;
+    }
+
+    // Adds the camera position of a frame at seconds, its velocity is smoothed over a few frames.
+    void observe_camera(const simd_float3 &position, double seconds)
+    {
+        const double elapsed = seconds - _camera_seconds;
+        if (_camera_seconds > 0.0 && elapsed > 0.0 && elapsed < MAX_FRAME_SECONDS)
+        {
+            const simd_float3 velocity = (position - _camera) / static_cast<float>(elapsed);
+            _velocity = _velocity + (velocity - _velocity) * VELOCITY_SMOOTHING;
+        }
+        else
+        {
+            _velocity = simd_make_float3(0.0f, 0.0f, 0.0f);
+        }
+        _camera = position;
+        _camera_seconds = seconds;
+    }
+
+    CellPlan plan() const
+    {
+        CellPlan plan;
+        const simd_float3 ahead = _camera + _velocity * _settings.prefetch_seconds;
+        std::vector<std::pair<float, unsigned int>> candidates;
+        for (const auto &[id, cell] : _cells)
+        {
+            const float distance = std::min(distance_to(cell.bounds, _camera), distance_to(cell.bounds, ahead));
+            if (cell.loaded && (!enabled() || distance > _settings.unload_radius))
+                plan.unload.push_back(id);
+            else if (!cell.loaded && enabled() && distance <= _settings.load_radius)
+                candidates.emplace_back(distance / (1.0f + cell.priority), id);
+        }
+        std::sort(candidates.begin(), candidates.end());
+
+        // The nearest cell loads even when it alone exceeds the budget, so large cells don't wait forever.
+        const size_t budget = size_t(_settings.upload_megabytes) << 20;
+        size_t bytes = 0;
+        for (const auto &[score, id] : candidates)
+        {
+            const size_t cell_bytes = _cells.find(id)->bytes;
+            if (budget > 0 && !plan.load.empty() && bytes + cell_bytes > budget)
+                break;
+            bytes += cell_bytes;
+            plan.load.push_back(id);
+        }
+        return plan;
+    }
+
+  private:
+    static constexpr double MAX_FRAME_SECONDS = 0.5;
+    static constexpr float VELOCITY_SMOOTHING = 0.25f;
+
+    static float distance_to(const Aabb &bounds, const simd_float3 &point)
+    {
+        const simd_float3 lower = simd_make_float3(bounds.bmin.x, bounds.bmin.y, bounds.bmin.z);
+        const simd_float3 upper = simd_make_float3(bounds.bmax.x, bounds.bmax.y, bounds.bmax.z);
+        return simd_length(point - simd_clamp(point, lower, upper));
+    }
+
+    StreamingSettings _settings = {};
+    IdTable<StreamedCell> _cells;
+    simd_float3 _camera = simd_make_float3(0.0f, 0.0f, 0.0f);
+    simd_float3 _velocity = simd_make_float3(0.0f, 0.0f, 0.0f);
+    double _camera_seconds = 0.0;
+};
+
+#endif // METALCPP_SRC_CELL_STREAMING_HPP
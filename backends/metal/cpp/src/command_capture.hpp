@@ -0,0 +1,480 @@
+#ifndef METALCPP_SRC_COMMAND_CAPTURE_HPP
+#define METALCPP_SRC_COMMAND_CAPTURE_HPP
+
+#include <compression.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "library.h"
+
+// Calls of the C API a capture records, in the order they were made.
+enum class CaptureOp : uint32_t
+{
+    SET_2D_MESH = 1,
+    SET_2D_INSTANCES = 2,
+    SET_3D_MESH = 3,
+    UNLOAD_3D_MESHES = 4,
+    SET_3D_INSTANCES = 5,
+    SET_ANIMATION_TIME = 6,
+    SET_SKINS = 7,
+    SET_POINT_LIGHTS = 8,
+    SET_SPOT_LIGHTS = 9,
+    SET_AREA_LIGHTS = 10,
+    SET_DIRECTIONAL_LIGHTS = 11,
+    SET_MATERIALS = 12,
+    SET_TEXTURES = 13,
+    SET_SKYBOX = 14,
+    SYNCHRONIZE = 15,
+    RENDER = 16,
+    RESIZE = 17
+};
+
+// File layout shared by CommandCapture and CaptureReader. A header is followed by chunks of commands, each command is
+// its op and the size of its payload. Structs are stored as they were passed, followed by the arrays their pointers
+// point at, so the reader only patches pointers. Values and arrays start at a multiple of ALIGNMENT within their
+// chunk, commands never span chunks.
+namespace capture
+{
+
+constexpr char MAGIC[8] = {'R', 'F', 'W', 'C', 'A', 'P', 'T', 'R'};
+constexpr uint32_t VERSION = 1;
+constexpr size_t ALIGNMENT = 16;
+// Chunks are written once they grow past this size and after every synchronize.
+constexpr size_t CHUNK_SIZE = 1 << 20;
+// Stored in place of the element count of null arrays.
+constexpr uint64_t NO_ARRAY = ~0ull;
+
+struct Header
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t layout;
+    // Size of the drawables in pixels when the capture started.
+    uint32_t width;
+    uint32_t height;
+};
+
+// Chunks whose stored size is below their size are compressed with LZ4.
+struct Chunk
+{
+    uint32_t size;
+    uint32_t stored_size;
+};
+
+struct Command
+{
+    CaptureOp op;
+    uint32_t size;
+    uint64_t padding;
+};
+
+inline size_t aligned(size_t size)
+{
+    return (size + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT;
+}
+
+inline size_t bitset_words(unsigned int bits)
+{
+    return (bits + sizeof(size_t) * 8 - 1) / (sizeof(size_t) * 8);
+}
+
+// Captures of another struct layout can't be replayed.
+inline uint32_t layout()
+{
+    const size_t sizes[] = {sizeof(Vertex2D),       sizeof(Vertex3D),    sizeof(RTTriangle),   sizeof(VertexRange),
+                            sizeof(JointData),      sizeof(MeshData3D),  sizeof(SkinData),     sizeof(InstancesData3D),
+                            sizeof(PointLight),     sizeof(SpotLight),   sizeof(AreaLight),    sizeof(DirectionalLight),
+                            sizeof(DeviceMaterial), sizeof(TextureData), sizeof(CameraView3D)};
+    uint32_t hash = 2166136261u;
+    for (const size_t size : sizes)
+        hash = (hash ^ static_cast<uint32_t>(size)) * 16777619u;
+    return hash;
+}
+
+} // namespace capture
+
+// Records the calls an instance gets and their payloads into a file, so a frame sequence seen in the field renders
+// again on another machine. Calls may come from several threads, each is recorded as a whole.
+class CommandCapture
+{
+  public:
+    CommandCapture(const CommandCapture &) = delete;
+    CommandCapture &operator=(const CommandCapture &) = delete;
+
+    ~CommandCapture()
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        flush();
+    }
+
+    // Returns nullptr when path can't be written.
+    static std::unique_ptr<CommandCapture> create(const char *path, unsigned int width, unsigned int height,
+                                                  bool compress)
+    {
+        std::unique_ptr<CommandCapture> capture(new CommandCapture(compress));
+        capture->_file.open(path, std::ios::binary | std::ios::out | std::ios::trunc);
+        if (!capture->_file.is_open())
+            return nullptr;
+
+        capture::Header header = {};
+        memcpy(header.magic, capture::MAGIC, sizeof(header.magic));
+        header.version = capture::VERSION;
+        header.layout = capture::layout();
+        header.width = width;
+        header.height = height;
+        capture->_file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+        return capture->_file.good() ? std::move(capture) : nullptr;
+    }
+
+    void set_2d_mesh(unsigned int id, const MeshData2D &data)
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        begin(CaptureOp::SET_2D_MESH);
+        put(id);
+        put(data);
+        put_array(data.vertices, data.num_vertices);
+        end();
+    }
+
+    void set_2d_instances(unsigned int id, const InstancesData2D &data)
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        begin(CaptureOp::SET_2D_INSTANCES);
+        put(id);
+        put(data);
+        put_array(data.matrices, data.num_matrices);
+        end();
+    }
+
+    void set_3d_mesh(unsigned int id, const MeshData3D &data)
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        begin(CaptureOp::SET_3D_MESH);
+        put(id);
+        put(data);
+        put_array(data.vertices, data.num_vertices);
+        put_array(data.triangles, data.num_triangles);
+        put_array(data.ranges, data.num_ranges);
+        put_array(data.skin_data, data.num_vertices);
+        put_array(data.indices, data.num_indices);
+        end();
+    }
+
+    void unload_3d_meshes(const size_t *ids, unsigned int num)
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        begin(CaptureOp::UNLOAD_3D_MESHES);
+        put_array(ids, num);
+        end();
+    }
+
+    void set_3d_instances(unsigned int id, const InstancesData3D &data)
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        begin(CaptureOp::SET_3D_INSTANCES);
+        put(id);
+        put(data);
+        put_array(data.matrices, data.num_matrices);
+        put_array(data.skin_ids, data.num_skin_ids);
+        put_array(data.flags, data.num_flags);
+        end();
+    }
+
+    void set_animation_time(float seconds)
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        begin(CaptureOp::SET_ANIMATION_TIME);
+        put(seconds);
+        end();
+    }
+
+    void set_skins(const SkinData *skins, unsigned int num_skins, const size_t *changed, unsigned int num_changed)
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        begin(CaptureOp::SET_SKINS);
+        put(num_changed);
+        put_array(changed, capture::bitset_words(num_changed));
+        put_array(skins, num_skins);
+        for (unsigned int i = 0; skins && i < num_skins; i++)
+        {
+            put_array(skins[i].name, skins[i].name_length);
+            put_array(skins[i].inverse_bind_matrices, skins[i].num_inverse_bind_matrices);
+            put_array(skins[i].joint_matrices, skins[i].num_joint_matrices);
+        }
+        end();
+    }
+
+    template <typename Light> void set_lights(CaptureOp op, const Light *lights, unsigned int num_lights)
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        begin(op);
+        put_array(lights, num_lights);
+        end();
+    }
+
+    void set_materials(const DeviceMaterial *materials, unsigned int num_materials, const size_t *changed,
+                       unsigned int num_changed)
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        begin(CaptureOp::SET_MATERIALS);
+        put(num_changed);
+        put_array(changed, capture::bitset_words(num_changed));
+        put_array(materials, num_materials);
+        end();
+    }
+
+    void set_textures(const TextureData *textures, unsigned int num_textures, const size_t *changed,
+                      unsigned int num_changed)
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        begin(CaptureOp::SET_TEXTURES);
+        put(num_changed);
+        put_array(changed, capture::bitset_words(num_changed));
+        put_array(textures, num_textures);
+        for (unsigned int i = 0; textures && i < num_textures; i++)
+            put_array(textures[i].bytes, textures[i].num_bytes);
+        end();
+    }
+
+    void set_skybox(const TextureData &skybox)
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        begin(CaptureOp::SET_SKYBOX);
+        put(skybox);
+        put_array(skybox.bytes, skybox.num_bytes);
+        end();
+    }
+
+    void synchronize()
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        begin(CaptureOp::SYNCHRONIZE);
+        end();
+        // The data of the calls before it may be released after synchronize, see CaptureReader::release.
+        flush();
+    }
+
+    void render(const simd_float4x4 &matrix_2d, const CameraView3D &view_3d, RenderMode3D mode)
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        begin(CaptureOp::RENDER);
+        put(matrix_2d);
+        put(view_3d);
+        put(mode);
+        end();
+    }
+
+    void resize(unsigned int width, unsigned int height, double scale)
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        begin(CaptureOp::RESIZE);
+        put(width);
+        put(height);
+        put(scale);
+        end();
+    }
+
+  private:
+    explicit CommandCapture(bool compress) : _compress(compress)
+    {
+        _chunk.reserve(capture::CHUNK_SIZE * 2);
+    }
+
+    void append(const void *bytes, size_t size)
+    {
+        const size_t offset = _chunk.size();
+        _chunk.resize(offset + capture::aligned(size));
+        if (size > 0)
+            memcpy(_chunk.data() + offset, bytes, size);
+    }
+
+    template <typename T> void put(const T &value)
+    {
+        append(&value, sizeof(T));
+    }
+
+    template <typename T> void put_array(const T *values, size_t count)
+    {
+        put(values ? static_cast<uint64_t>(count) : capture::NO_ARRAY);
+        if (values)
+            append(values, count * sizeof(T));
+    }
+
+    void begin(CaptureOp op)
+    {
+        _command = _chunk.size();
+        put(capture::Command{op, 0, 0});
+    }
+
+    void end()
+    {
+        auto *command = reinterpret_cast<capture::Command *>(_chunk.data() + _command);
+        command->size = static_cast<uint32_t>(_chunk.size() - _command - sizeof(capture::Command));
+        if (_chunk.size() >= capture::CHUNK_SIZE)
+            flush();
+    }
+
+    void flush()
+    {
+        if (_chunk.empty())
+            return;
+
+        capture::Chunk chunk = {static_cast<uint32_t>(_chunk.size()), static_cast<uint32_t>(_chunk.size())};
+        const uint8_t *stored = _chunk.data();
+        if (_compress)
+        {
+            // Chunks that don't get smaller are stored as they are.
+            _compressed.resize(_chunk.size());
+            const size_t size = compression_encode_buffer(_compressed.data(), _compressed.size(), _chunk.data(),
+                                                          _chunk.size(), nullptr, COMPRESSION_LZ4);
+            if (size > 0 && size < _chunk.size())
+            {
+                chunk.stored_size = static_cast<uint32_t>(size);
+                stored = _compressed.data();
+            }
+        }
+
+        _file.write(reinterpret_cast<const char *>(&chunk), sizeof(chunk));
+        _file.write(reinterpret_cast<const char *>(stored), chunk.stored_size);
+        _file.flush();
+        _chunk.clear();
+    }
+
+    std::mutex _mutex;
+    std::ofstream _file;
+    bool _compress;
+    std::vector<uint8_t> _chunk;
+    std::vector<uint8_t> _compressed;
+    // Offset of the command being recorded within the chunk.
+    size_t _command = 0;
+};
+
+// Reads the commands of a capture back. Payloads point into the chunks that were read, which are kept until release()
+// as the renderer reads the data of most calls in the next synchronize.
+class CaptureReader
+{
+  public:
+    // Returns false when path can't be read or was captured by another version or struct layout.
+    bool open(const char *path)
+    {
+        _file.open(path, std::ios::binary | std::ios::in);
+        if (!_file.is_open())
+            return false;
+
+        _file.read(reinterpret_cast<char *>(&_header), sizeof(_header));
+        return _file.good() && memcmp(_header.magic, capture::MAGIC, sizeof(_header.magic)) == 0 &&
+               _header.version == capture::VERSION && _header.layout == capture::layout();
+    }
+
+    const capture::Header &header() const
+    {
+        return _header;
+    }
+
+    // Moves to the next command, false at the end of the capture or when it is truncated.
+    bool next(CaptureOp &op)
+    {
+        // Skips whatever the previous command did not read of its payload.
+        _offset = _next;
+        if ((_chunks.empty() || _offset >= _chunk_size) && !read_chunk())
+            return false;
+
+        const auto &command = *reinterpret_cast<const capture::Command *>(data() + _offset);
+        _offset += sizeof(capture::Command);
+        _next = _offset + command.size;
+        op = command.op;
+        return _next <= _chunk_size;
+    }
+
+    template <typename T> T get()
+    {
+        T value;
+        memcpy(&value, data() + _offset, sizeof(T));
+        _offset += capture::aligned(sizeof(T));
+        return value;
+    }
+
+    // Points values at the next array, or at null for null arrays, and returns its element count.
+    template <typename T> size_t get_array(const T *&values)
+    {
+        const auto count = get<uint64_t>();
+        if (count == capture::NO_ARRAY)
+        {
+            values = nullptr;
+            return 0;
+        }
+
+        values = reinterpret_cast<const T *>(data() + _offset);
+        _offset += capture::aligned(static_cast<size_t>(count) * sizeof(T));
+        return static_cast<size_t>(count);
+    }
+
+    // Arrays of structs whose pointers are patched after they were read.
+    template <typename T> size_t get_mutable_array(T *&values)
+    {
+        const T *read = nullptr;
+        const size_t count = get_array(read);
+        values = const_cast<T *>(read);
+        return count;
+    }
+
+    // Drops the chunks before the current one, their payloads must no longer be used.
+    void release()
+    {
+        if (_chunks.size() > 1)
+            _chunks.erase(_chunks.begin(), _chunks.end() - 1);
+    }
+
+  private:
+    bool read_chunk()
+    {
+        capture::Chunk chunk = {};
+        if (!_file.read(reinterpret_cast<char *>(&chunk), sizeof(chunk)))
+            return false;
+
+        // simd_float4 elements keep every chunk aligned for the vectors and matrices within it.
+        std::vector<simd_float4> bytes((chunk.size + sizeof(simd_float4) - 1) / sizeof(simd_float4));
+        auto *destination = reinterpret_cast<uint8_t *>(bytes.data());
+        if (chunk.stored_size == chunk.size)
+        {
+            if (!_file.read(reinterpret_cast<char *>(destination), chunk.size))
+                return false;
+        }
+        else
+        {
+            _compressed.resize(chunk.stored_size);
+            if (!_file.read(reinterpret_cast<char *>(_compressed.data()), chunk.stored_size) ||
+                compression_decode_buffer(destination, chunk.size, _compressed.data(), _compressed.size(), nullptr,
+                                          COMPRESSION_LZ4) != chunk.size)
+                return false;
+        }
+
+        _chunks.push_back(std::move(bytes));
+        _chunk_size = chunk.size;
+        _offset = 0;
+        _next = 0;
+        return true;
+    }
+
+    const uint8_t *data() const
+    {
+        return reinterpret_cast<const uint8_t *>(_chunks.back().data());
+    }
+
+    std::ifstream _file;
+    capture::Header _header = {};
+    std::vector<std::vector<simd_float4>> _chunks;
+    std::vector<uint8_t> _compressed;
+    size_t _chunk_size = 0;
+    size_t _offset = 0;
+    // Offset of the command after the current one.
+    size_t _next = 0;
+};
+
+#endif // METALCPP_SRC_COMMAND_CAPTURE_HPP
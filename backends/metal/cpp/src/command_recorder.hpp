@@ -0,0 +1,205 @@
+#ifndef METALCPP_SRC_COMMAND_RECORDER_HPP
+#define METALCPP_SRC_COMMAND_RECORDER_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+#include "library.h"
+
+// Copy of a recorded mesh, the renderer keeps it for as long as the mesh is set as its vertex lists point into it.
+// Triangles are copied for the signed distance field of the mesh.
+struct RecordedMesh
+{
+    std::vector<Vertex3D> vertices;
+    std::vector<RTTriangle> triangles;
+    std::vector<JointData> joints_weights;
+    std::vector<unsigned int> indices;
+    // Kept apart from indices so a count without indices is rejected when the mesh is set, like it is directly.
+    unsigned int num_indices = 0;
+    std::vector<VertexRange> ranges;
+    unsigned int flags = 0;
+    Aabb bounds = {};
+
+    MeshData3D data() const
+    {
+        MeshData3D data = {};
+        data.vertices = vertices.data();
+        data.num_vertices = static_cast<unsigned int>(vertices.size());
+        data.triangles = triangles.empty() ? nullptr : triangles.data();
+        data.num_triangles = static_cast<unsigned int>(triangles.size());
+        data.skin_data = joints_weights.empty() ? nullptr : joints_weights.data();
+        data.ranges = ranges.empty() ? nullptr : ranges.data();
+        data.num_ranges = static_cast<unsigned int>(ranges.size());
+        data.flags = flags;
+        data.bounds = bounds;
+        data.indices = indices.empty() ? nullptr : indices.data();
+        data.num_indices = num_indices;
+        return data;
+    }
+};
+
+struct RecordedInstances
+{
+    Aabb local_aabb = {};
+    std::vector<simd_float4x4> matrices;
+    std::vector<int> skin_ids;
+    std::vector<unsigned int> flags;
+
+    InstancesData3D data() const
+    {
+        InstancesData3D data = {};
+        data.local_aabb = local_aabb;
+        data.matrices = matrices.data();
+        data.num_matrices = static_cast<unsigned int>(matrices.size());
+        data.skin_ids = skin_ids.empty() ? nullptr : skin_ids.data();
+        data.num_skin_ids = static_cast<unsigned int>(skin_ids.size());
+        data.flags = flags.empty() ? nullptr : flags.data();
+        data.num_flags = static_cast<unsigned int>(flags.size());
+        return data;
+    }
+};
+
+// Commands of one CommandRecorder::submit in the order they were recorded, index points into the array of their type.
+struct CommandBatch
+{
+    enum Type : unsigned int
+    {
+        Mesh3D,
+        Instances3D,
+        Materials
+    };
+
+    struct Command
+    {
+        Type type;
+        unsigned int id;
+        size_t index;
+    };
+
+    std::vector<Command> commands;
+    std::vector<RecordedMesh> meshes;
+    std::vector<RecordedInstances> instances;
+    std::vector<std::vector<DeviceMaterial>> materials;
+    CommandBatch *next = nullptr;
+};
+
+// Lock-free list of submitted batches, any number of threads push while a single consumer takes them all at once.
+class CommandQueue
+{
+  public:
+    CommandQueue() = default;
+    CommandQueue(const CommandQueue &) = delete;
+    CommandQueue &operator=(const CommandQueue &) = delete;
+
+    ~CommandQueue()
+    {
+        for (CommandBatch *batch = take(); batch;)
+        {
+            CommandBatch *next = batch->next;
+            delete batch;
+            batch = next;
+        }
+    }
+
+    void push(CommandBatch *batch)
+    {
+        batch->next = _head.load(std::memory_order_relaxed);
+        while (!_head.compare_exchange_weak(batch->next, batch, std::memory_order_release, std::memory_order_relaxed))
+        {
+        }
+    }
+
+    // Returns the batches pushed so far linked in the order they were pushed, the caller owns them.
+    CommandBatch *take()
+    {
+        CommandBatch *batch = _head.exchange(nullptr, std::memory_order_acquire);
+        CommandBatch *ordered = nullptr;
+        while (batch)
+        {
+            CommandBatch *next = batch->next;
+            batch->next = ordered;
+            ordered = batch;
+            batch = next;
+        }
+        return ordered;
+    }
+
+  private:
+    std::atomic<CommandBatch *> _head{nullptr};
+};
+
+// Copies mesh, instance and material updates on the thread that records them. A recorder belongs to one thread at a
+// time, submit() hands the recorded commands to the queue and may run concurrently with other recorders.
+class CommandRecorder
+{
+  public:
+    explicit CommandRecorder(CommandQueue *queue) : _queue(queue), _batch(new CommandBatch)
+    {
+    }
+
+    CommandRecorder(const CommandRecorder &) = delete;
+    CommandRecorder &operator=(const CommandRecorder &) = delete;
+
+    ~CommandRecorder()
+    {
+        delete _batch;
+    }
+
+    void set_3d_mesh(unsigned int id, const MeshData3D &data)
+    {
+        RecordedMesh mesh;
+        if (data.vertices)
+            mesh.vertices.assign(data.vertices, data.vertices + data.num_vertices);
+        if (data.triangles)
+            mesh.triangles.assign(data.triangles, data.triangles + data.num_triangles);
+        if (data.skin_data)
+            mesh.joints_weights.assign(data.skin_data, data.skin_data + data.num_vertices);
+        if (data.indices)
+            mesh.indices.assign(data.indices, data.indices + data.num_indices);
+        mesh.num_indices = data.num_indices;
+        if (data.ranges)
+            mesh.ranges.assign(data.ranges, data.ranges + data.num_ranges);
+        mesh.flags = data.flags;
+        mesh.bounds = data.bounds;
+
+        _batch->commands.push_back({CommandBatch::Mesh3D, id, _batch->meshes.size()});
+        _batch->meshes.push_back(std::move(mesh));
+    }
+
+    void set_3d_instances(unsigned int id, const InstancesData3D &data)
+    {
+        RecordedInstances instances;
+        instances.local_aabb = data.local_aabb;
+        if (data.matrices)
+            instances.matrices.assign(data.matrices, data.matrices + data.num_matrices);
+        if (data.skin_ids)
+            instances.skin_ids.assign(data.skin_ids, data.skin_ids + data.num_skin_ids);
+        if (data.flags)
+            instances.flags.assign(data.flags, data.flags + data.num_flags);
+
+        _batch->commands.push_back({CommandBatch::Instances3D, id, _batch->instances.size()});
+        _batch->instances.push_back(std::move(instances));
+    }
+
+    void set_materials(const DeviceMaterial *materials, unsigned int num_materials)
+    {
+        _batch->commands.push_back({CommandBatch::Materials, 0, _batch->materials.size()});
+        _batch->materials.emplace_back(materials, materials + num_materials);
+    }
+
+    void submit()
+    {
+        if (_batch->commands.empty())
+            return;
+
+        _queue->push(_batch);
+        _batch = new CommandBatch;
+    }
+
+  private:
+    CommandQueue *_queue;
+    CommandBatch *_batch;
+};
+
+#endif // METALCPP_SRC_COMMAND_RECORDER_HPP
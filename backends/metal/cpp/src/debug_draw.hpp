@@ -0,0 +1,103 @@
+#ifndef METALCPP_SRC_DEBUG_DRAW_HPP
+#define METALCPP_SRC_DEBUG_DRAW_HPP
+
+#include <cmath>
+#include <cstring>
+#include <vector>
+
+#include "library.h"
+#include "upload_ring.hpp"
+
+// Lines of one frame in the upload ring, the depth tested ones first.
+struct DebugLineBatch
+{
+    UploadAllocation lines;
+    unsigned int tested = 0;
+    unsigned int on_top = 0;
+};
+
+// Collects the lines of the debug draw API until the next frame copies them into its upload ring. Boxes and spheres
+// are broken into lines here, the vertex shader widens every line into a quad, so a frame costs one copy of 32 bytes
+// per line and two instanced draws however many there are.
+class DebugDraw
+{
+  public:
+    static constexpr unsigned int SPHERE_SEGMENTS = 32;
+
+    void add_lines(const DebugLine *lines, unsigned int count, bool depth_test)
+    {
+        std::vector<DebugLine> &list = depth_test ? _tested : _on_top;
+        list.insert(list.end(), lines, lines + count);
+    }
+
+    void add_line(const Vector3 &start, const Vector3 &end, unsigned int color, float width, bool depth_test)
+    {
+        const DebugLine line = {start, color, end, width};
+        add_lines(&line, 1, depth_test);
+    }
+
+    void add_aabb(const Aabb &bounds, unsigned int color, float width, bool depth_test)
+    {
+        const auto corner = [&](unsigned int i) {
+            return Vector3{i & 1 ? bounds.bmax.x : bounds.bmin.x, i & 2 ? bounds.bmax.y : bounds.bmin.y,
+                           i & 4 ? bounds.bmax.z : bounds.bmin.z};
+        };
+        // Corners that differ in one bit share an edge.
+        for (unsigned int i = 0; i < 8; i++)
+        {
+            for (unsigned int bit = 1; bit < 8; bit <<= 1)
+            {
+                if ((i & bit) == 0)
+                    add_line(corner(i), corner(i | bit), color, width, depth_test);
+            }
+        }
+    }
+
+    // Circles around the three axes.
+    void add_sphere(const Vector3 &center, float radius, unsigned int color, float width, bool depth_test)
+    {
+        std::vector<DebugLine> &list = depth_test ? _tested : _on_top;
+        for (unsigned int axis = 0; axis < 3; axis++)
+        {
+            const auto point = [&](unsigned int segment) {
+                const float angle = 2.0f * float(M_PI) * float(segment) / float(SPHERE_SEGMENTS);
+                const float u = std::cos(angle) * radius;
+                const float v = std::sin(angle) * radius;
+                return axis == 0   ? Vector3{center.x, center.y + u, center.z + v}
+                       : axis == 1 ? Vector3{center.x + u, center.y, center.z + v}
+                                   : Vector3{center.x + u, center.y + v, center.z};
+            };
+            for (unsigned int segment = 0; segment < SPHERE_SEGMENTS; segment++)
+                list.push_back({point(segment), color, point(segment + 1), width});
+        }
+    }
+
+    bool empty() const
+    {
+        return _tested.empty() && _on_top.empty();
+    }
+
+    // Copies the lines into ring and drops them, they are only drawn once.
+    DebugLineBatch upload(UploadRing &ring)
+    {
+        DebugLineBatch batch;
+        batch.lines = ring.allocate((_tested.size() + _on_top.size()) * sizeof(DebugLine));
+        if (batch.lines.valid())
+        {
+            auto *lines = static_cast<DebugLine *>(batch.lines.data);
+            memcpy(lines, _tested.data(), _tested.size() * sizeof(DebugLine));
+            memcpy(lines + _tested.size(), _on_top.data(), _on_top.size() * sizeof(DebugLine));
+            batch.tested = static_cast<unsigned int>(_tested.size());
+            batch.on_top = static_cast<unsigned int>(_on_top.size());
+        }
+        _tested.clear();
+        _on_top.clear();
+        return batch;
+    }
+
+  private:
+    std::vector<DebugLine> _tested;
+    std::vector<DebugLine> _on_top;
+};
+
+#endif // METALCPP_SRC_DEBUG_DRAW_HPP
@@ -0,0 +1,284 @@
+#ifndef METALCPP_SRC_FRAME_GRAPH_HPP
+#define METALCPP_SRC_FRAME_GRAPH_HPP
+
+#import <Metal/Metal.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <utility>
+#include <vector>
+
+#include "retired_resources.hpp"
+
+// Texture that only lives within the passes of a frame graph.
+struct TransientTexture
+{
+    MTLPixelFormat format = MTLPixelFormatInvalid;
+    NSUInteger width = 1;
+    NSUInteger height = 1;
+    NSString *label = nil;
+};
+
+// Passes of a frame in the order they are encoded, with the transient textures they read and write. Textures are
+// created right before their first pass and their memory is given to later textures after their last one, so
+// textures whose passes don't overlap share memory. Attachments that never leave the render pass they are drawn in
+// become memoryless on GPUs with tile memory, where a pass that only reads its own pixel of the attachments of the
+// render pass before it is drawn in the same encoder.
+class FrameGraph
+{
+  public:
+    using Handle = unsigned int;
+    using EncodeFunction = std::function<void(id<MTLRenderCommandEncoder>)>;
+    // Encodes a pass. Render passes call merged with their last encoder when passes were merged into them, it is
+    // empty otherwise. Returning false stops the frame, the passes after it are not encoded.
+    using PassFunction = std::function<bool(const EncodeFunction &merged)>;
+
+    enum Access : unsigned int
+    {
+        // Sampled or read by a shader.
+        Read = 0,
+        // Written by a shader.
+        Write = 1,
+        // Drawn into as a color attachment.
+        Attachment = 2,
+        // Reads the pixel it shades of an attachment of the render pass before, from tile memory when merged.
+        TileRead = 3
+    };
+
+    void reset()
+    {
+        _textures.clear();
+        _passes.clear();
+    }
+
+    Handle create_texture(const TransientTexture &desc)
+    {
+        _textures.push_back({desc});
+        return static_cast<Handle>(_textures.size() - 1);
+    }
+
+    // merge draws the pass into the encoder of the pass before it, passes without one always get their own.
+    void add_pass(std::vector<std::pair<Handle, Access>> accesses, PassFunction execute, EncodeFunction merge = {})
+    {
+        _passes.push_back({std::move(accesses), std::move(execute), std::move(merge)});
+    }
+
+    // Merges passes, picks the memoryless textures and sizes the heap for the textures that are live at once. A heap
+    // that gets replaced is retired, frames in flight still use it.
+    void compile(id<MTLDevice> device, bool tile_memory, RetiredResources &retired)
+    {
+        bool memoryless = false;
+        if (@available(macOS 11.0, *))
+            memoryless = tile_memory;
+
+        for (size_t i = 0; i < _passes.size(); i++)
+        {
+            Pass &pass = _passes[i];
+            pass.root = i;
+            if (i == 0 || !tile_memory || !pass.merge)
+                continue;
+
+            bool mergeable = true;
+            for (const auto &[handle, access] : pass.accesses)
+            {
+                if (access == TileRead)
+                    mergeable &= writes(_passes[i - 1], handle, Attachment);
+                else if (access != Attachment)
+                    mergeable = false;
+            }
+            if (mergeable)
+                pass.root = _passes[i - 1].root;
+        }
+
+        for (size_t i = 0; i < _passes.size(); i++)
+        {
+            const Pass &pass = _passes[i];
+            for (const auto &[handle, access] : pass.accesses)
+            {
+                Texture &texture = _textures[handle];
+                const bool merged = pass.root != i;
+                if (texture.first == NONE)
+                {
+                    texture.first = pass.root;
+                    texture.memoryless = memoryless;
+                }
+                texture.last = pass.root;
+                texture.memoryless &= texture.first == pass.root && (access == Attachment || merged);
+                texture.usage |= access == Attachment ? MTLTextureUsageRenderTarget
+                                 : access == Write    ? MTLTextureUsageShaderWrite
+                                 : merged             ? MTLTextureUsageRenderTarget
+                                                      : MTLTextureUsageShaderRead;
+            }
+        }
+
+        for (Texture &texture : _textures)
+        {
+            if (texture.first != NONE && !texture.memoryless)
+                texture.size_align = [device heapTextureSizeAndAlignWithDescriptor:descriptor(texture)];
+        }
+
+        // Textures live from the start of their first pass to the end of their last one.
+        size_t required = 0;
+        for (size_t i = 0; i < _passes.size(); i++)
+        {
+            size_t live = 0;
+            for (const Texture &texture : _textures)
+            {
+                if (texture.first != NONE && texture.first <= i && texture.last >= i)
+                    live += texture.size_align.size + texture.size_align.align;
+            }
+            required = std::max(required, live);
+        }
+
+        if (required == 0 || (required <= size() && required * 2 >= size()))
+            return;
+        retired.retire(_heap);
+        MTLHeapDescriptor *desc = [MTLHeapDescriptor new];
+        desc.storageMode = MTLStorageModePrivate;
+        // Hazards are tracked for the heap as a whole, so passes of textures sharing memory run one after the other.
+        desc.hazardTrackingMode = MTLHazardTrackingModeTracked;
+        desc.size = required;
+        _heap = [device newHeapWithDescriptor:desc];
+        _heap.label = @"TransientTextures";
+    }
+
+    // Encodes the passes in order, false when a pass stopped the frame. The frame's command buffers don't keep its
+    // textures alive, they are retired once encoded.
+    bool execute(id<MTLDevice> device, RetiredResources &retired)
+    {
+        bool completed = true;
+        for (size_t i = 0; i < _passes.size() && completed; i++)
+        {
+            if (_passes[i].root != i)
+                continue;
+
+            for (Handle handle = 0; handle < _textures.size(); handle++)
+            {
+                if (_textures[handle].first == i)
+                    allocate(device, handle, retired);
+            }
+
+            // Passes merged into this one are drawn in order after it.
+            std::vector<const EncodeFunction *> merged;
+            for (size_t j = i + 1; j < _passes.size() && _passes[j].root == i; j++)
+                merged.push_back(&_passes[j].merge);
+            const EncodeFunction encode_merged = [&merged](id<MTLRenderCommandEncoder> encoder) {
+                for (const EncodeFunction *merge : merged)
+                    (*merge)(encoder);
+            };
+            completed = _passes[i].execute(merged.empty() ? EncodeFunction() : encode_merged);
+
+            for (Texture &texture : _textures)
+            {
+                if (texture.last == i && !texture.memoryless && texture.texture.heap != nil)
+                    [texture.texture makeAliasable];
+            }
+        }
+
+        for (Texture &texture : _textures)
+        {
+            if (!texture.memoryless)
+                retired.retire(texture.texture);
+            texture.texture = nil;
+        }
+        return completed;
+    }
+
+    id<MTLTexture> texture(Handle handle) const
+    {
+        return _textures[handle].texture;
+    }
+
+    bool memoryless(Handle handle) const
+    {
+        return _textures[handle].memoryless;
+    }
+
+    size_t size() const
+    {
+        return _heap != nil ? static_cast<size_t>(_heap.size) : 0;
+    }
+
+  private:
+    static constexpr size_t NONE = ~size_t(0);
+
+    struct Texture
+    {
+        TransientTexture desc;
+        size_t first = NONE;
+        size_t last = NONE;
+        MTLTextureUsage usage = MTLTextureUsageUnknown;
+        bool memoryless = false;
+        // Zero for memoryless textures.
+        MTLSizeAndAlign size_align = {0, 0};
+        id<MTLTexture> texture = nil;
+    };
+
+    struct Pass
+    {
+        std::vector<std::pair<Handle, Access>> accesses;
+        PassFunction execute;
+        EncodeFunction merge;
+        // Pass whose encoder this one is drawn in, itself when it has its own.
+        size_t root = 0;
+    };
+
+    static bool writes(const Pass &pass, Handle handle, Access access)
+    {
+        return std::find(pass.accesses.begin(), pass.accesses.end(), std::make_pair(handle, access)) !=
+               pass.accesses.end();
+    }
+
+    static MTLTextureDescriptor *descriptor(const Texture &texture)
+    {
+        MTLTextureDescriptor *desc = [MTLTextureDescriptor texture2DDescriptorWithPixelFormat:texture.desc.format
+                                                                                        width:texture.desc.width
+                                                                                       height:texture.desc.height
+                                                                                    mipmapped:NO];
+        desc.usage = texture.usage;
+        desc.storageMode = MTLStorageModePrivate;
+        if (@available(macOS 11.0, *))
+        {
+            if (texture.memoryless)
+                desc.storageMode = MTLStorageModeMemoryless;
+        }
+        return desc;
+    }
+
+    void allocate(id<MTLDevice> device, Handle handle, RetiredResources &retired)
+    {
+        Texture &texture = _textures[handle];
+        MTLTextureDescriptor *desc = descriptor(texture);
+        // Memoryless textures have no contents, the frames in flight share them.
+        if (texture.memoryless)
+        {
+            if (_memoryless.size() <= handle)
+                _memoryless.resize(handle + 1, nil);
+            id<MTLTexture> &cached = _memoryless[handle];
+            if (cached == nil || cached.pixelFormat != desc.pixelFormat || cached.width != desc.width ||
+                cached.height != desc.height)
+            {
+                retired.retire(cached);
+                cached = [device newTextureWithDescriptor:desc];
+            }
+            texture.texture = cached;
+        }
+        else
+        {
+            texture.texture = _heap != nil ? [_heap newTextureWithDescriptor:desc] : nil;
+            // The heap may be too fragmented for a texture, which then gets memory of its own.
+            if (texture.texture == nil)
+                texture.texture = [device newTextureWithDescriptor:desc];
+        }
+        texture.texture.label = texture.desc.label;
+    }
+
+    std::vector<Texture> _textures;
+    std::vector<Pass> _passes;
+    id<MTLHeap> _heap = nil;
+    // Memoryless texture of every handle, kept from one frame to the next.
+    std::vector<id<MTLTexture>> _memoryless;
+};
+
+#endif // METALCPP_SRC_FRAME_GRAPH_HPP
@@ -0,0 +1,112 @@
+#ifndef METALCPP_SRC_FRAME_PACING_HPP
+#define METALCPP_SRC_FRAME_PACING_HPP
+
+#include "library.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <mutex>
+
+// Measures the intervals between the times drawables were actually shown, from their presented handlers. Intervals
+// are compared with the refresh interval of the display: every refresh an interval spans beyond the first is a missed
+// vsync, intervals of more than one and a half refreshes are hitches. Percentiles cover the last WINDOW intervals, the
+// histogram and the counts everything since the last reset. Gaps of more than MAX_INTERVAL seconds are pauses of the
+// caller rather than frames and are left out.
+class FramePacing
+{
+  public:
+    static constexpr unsigned int WINDOW = 1024;
+    static constexpr double MAX_INTERVAL = 0.5;
+    static constexpr double HITCH_REFRESHES = 1.5;
+
+    // Called with the presented time of frame in seconds, 0 when the drawable was never shown, and the refresh
+    // interval of the display it was shown on. Runs on a thread of Metal's choosing.
+    void presented(uint64_t frame, double presented_time, double refresh_interval)
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _refresh_interval = refresh_interval;
+        if (presented_time <= 0.0)
+        {
+            _stats.dropped++;
+            return;
+        }
+
+        _stats.presented++;
+        const double previous = _last_presented;
+        _last_presented = presented_time;
+        const double interval = presented_time - previous;
+        if (previous <= 0.0 || interval <= 0.0 || interval > MAX_INTERVAL)
+            return;
+
+        const auto ms = static_cast<float>(interval * 1000.0);
+        _window[_next] = ms;
+        _next = (_next + 1) % WINDOW;
+        _count = std::min(_count + 1, WINDOW);
+        _stats.histogram[std::min(static_cast<unsigned int>(ms), PACING_HISTOGRAM_BUCKETS - 1u)]++;
+
+        if (refresh_interval > 0.0)
+        {
+            const double refreshes = std::round(interval / refresh_interval);
+            if (refreshes > 1.0)
+                _stats.missed_vsyncs += static_cast<unsigned long long>(refreshes) - 1;
+            if (interval > refresh_interval * HITCH_REFRESHES)
+            {
+                _stats.hitches++;
+                _stats.last_hitch_frame = frame;
+                _stats.last_hitch_ms = ms;
+            }
+        }
+    }
+
+    FramePacingStats stats() const
+    {
+        std::array<float, WINDOW> window;
+        FramePacingStats stats;
+        unsigned int count = 0;
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            stats = _stats;
+            stats.refresh_ms = static_cast<float>(_refresh_interval * 1000.0);
+            count = _count;
+            std::copy(_window.begin(), _window.begin() + count, window.begin());
+        }
+        if (count == 0)
+            return stats;
+
+        std::sort(window.begin(), window.begin() + count);
+        const auto percentile = [&](unsigned int percent) {
+            return window[std::min(count - 1, count * percent / 100)];
+        };
+        double sum = 0.0;
+        for (unsigned int i = 0; i < count; i++)
+            sum += window[i];
+        stats.mean_ms = static_cast<float>(sum / count);
+        stats.p50_ms = percentile(50);
+        stats.p95_ms = percentile(95);
+        stats.p99_ms = percentile(99);
+        stats.max_ms = window[count - 1];
+        return stats;
+    }
+
+    void reset()
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _stats = {};
+        _count = 0;
+        _next = 0;
+        _last_presented = 0.0;
+    }
+
+  private:
+    mutable std::mutex _mutex;
+    FramePacingStats _stats = {};
+    std::array<float, WINDOW> _window = {};
+    unsigned int _next = 0;
+    unsigned int _count = 0;
+    double _last_presented = 0.0;
+    double _refresh_interval = 0.0;
+};
+
+#endif // METALCPP_SRC_FRAME_PACING_HPP
@@ -0,0 +1,374 @@
+#ifndef METALCPP_SRC_FRAME_TIMER_HPP
+#define METALCPP_SRC_FRAME_TIMER_HPP
+
+#import <Metal/Metal.h>
+
+#include "library.h"
+#include "trace_recorder.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+// Samples GPU timestamps at the start and end of the timed passes of every frame into a counter sample buffer per
+// frame in flight, resolved into FrameStats once the frame completed. Passes are only timed on GPUs that sample at
+// stage boundaries, render passes are split between two passes only on GPUs that also sample at draw boundaries.
+// Pipeline statistics are sampled at the same points into a second buffer on GPUs with the statistic counter set, and
+// at the start and end of the frame with blits on GPUs that sample at blit boundaries.
+class FrameTimer
+{
+  public:
+    // Two samples per timed encoder, encoders beyond that in a frame are not timed.
+    static constexpr unsigned int MAX_SAMPLES = 128;
+    // Samples of the statistics of the whole frame, after those of the passes.
+    static constexpr unsigned int FRAME_START_SAMPLE = MAX_SAMPLES;
+    static constexpr unsigned int FRAME_END_SAMPLE = MAX_SAMPLES + 1;
+
+    void init(id<MTLDevice> device, unsigned int frames_in_flight)
+    {
+        _device = device;
+        if (@available(macOS 11.0, *))
+        {
+            _stage_samples = [device supportsCounterSampling:MTLCounterSamplingPointAtStageBoundary];
+            _draw_samples = [device supportsCounterSampling:MTLCounterSamplingPointAtDrawBoundary];
+            _blit_samples = [device supportsCounterSampling:MTLCounterSamplingPointAtBlitBoundary];
+        }
+        for (id<MTLCounterSet> set in device.counterSets)
+        {
+            if ([set.name isEqualToString:MTLCommonCounterSetTimestamp])
+                _timestamps = set;
+            else if ([set.name isEqualToString:MTLCommonCounterSetStatistic])
+                _statistics = set;
+        }
+        [device sampleTimestamps:&_cpu_start gpuTimestamp:&_gpu_start];
+        set_frames_in_flight(frames_in_flight);
+    }
+
+    // Adds the GPU spans of resolved frames and uploads to trace while it records.
+    void set_trace(TraceRecorder *trace)
+    {
+        _trace = trace;
+    }
+
+    // Only valid when the GPU is idle.
+    void set_frames_in_flight(unsigned int frames_in_flight)
+    {
+        _frames.clear();
+        _frames.resize(frames_in_flight);
+
+        MTLCounterSampleBufferDescriptor *desc = [MTLCounterSampleBufferDescriptor new];
+        desc.storageMode = MTLStorageModeShared;
+        const auto create = [&](id<MTLCounterSet> set, NSUInteger count) -> id<MTLCounterSampleBuffer> {
+            desc.counterSet = set;
+            desc.sampleCount = count;
+            NSError *err = nil;
+            id<MTLCounterSampleBuffer> buffer = [_device newCounterSampleBufferWithDescriptor:desc error:&err];
+            if (err)
+                NSLog(@"Could not create counter sample buffer: %@", [err localizedDescription]);
+            return buffer;
+        };
+        for (Frame &frame : _frames)
+        {
+            if (_timestamps != nil && _stage_samples)
+                frame.samples = create(_timestamps, MAX_SAMPLES);
+            if (_statistics != nil && (_stage_samples || _blit_samples))
+                frame.statistics = create(_statistics, MAX_SAMPLES + 2);
+        }
+    }
+
+    // The GPU must be done with the previous frame of this slot.
+    void begin_frame(unsigned int frame)
+    {
+        _frame = frame;
+        _frames[frame].passes.clear();
+        _frames[frame].next_sample = 0;
+        _frames[frame].render_pass = NO_PASS;
+        _frames[frame].draws = 0;
+        _frames[frame].instances = 0;
+        _frames[frame].triangles = 0;
+    }
+
+    // Samples the statistics of the whole frame at the start of its first and the end of its last command buffer.
+    void sample_frame_start(id<MTLCommandBuffer> command_buffer)
+    {
+        sample_frame(command_buffer, FRAME_START_SAMPLE);
+    }
+    void sample_frame_end(id<MTLCommandBuffer> command_buffer)
+    {
+        sample_frame(command_buffer, FRAME_END_SAMPLE);
+    }
+
+    void count_draws(unsigned int draws, unsigned int instances, unsigned int triangles)
+    {
+        Frame &frame = _frames[_frame];
+        frame.draws += draws;
+        frame.instances += instances;
+        frame.triangles += triangles;
+    }
+
+    // Draws counted so far this frame.
+    unsigned int draws() const
+    {
+        return _frames[_frame].draws;
+    }
+
+    void time_render_pass(MTLRenderPassDescriptor *desc, FramePass pass)
+    {
+        const TimedPass *timed = add_pass(pass);
+        _frames[_frame].render_pass = timed ? static_cast<unsigned int>(_frames[_frame].passes.size() - 1) : NO_PASS;
+        if (!timed)
+            return;
+
+        // The vertex stage starts before and the fragment stage ends after all other work of the pass.
+        MTLRenderPassSampleBufferAttachmentDescriptor *attachment = desc.sampleBufferAttachments[0];
+        attachment.sampleBuffer = _frames[_frame].samples;
+        attachment.startOfVertexSampleIndex = timed->start;
+        attachment.endOfVertexSampleIndex = MTLCounterDontSample;
+        attachment.startOfFragmentSampleIndex = MTLCounterDontSample;
+        attachment.endOfFragmentSampleIndex = timed->end;
+
+        if (id<MTLCounterSampleBuffer> statistics = _frames[_frame].statistics)
+        {
+            MTLRenderPassSampleBufferAttachmentDescriptor *statistics_attachment = desc.sampleBufferAttachments[1];
+            statistics_attachment.sampleBuffer = statistics;
+            statistics_attachment.startOfVertexSampleIndex = timed->start;
+            statistics_attachment.endOfVertexSampleIndex = MTLCounterDontSample;
+            statistics_attachment.startOfFragmentSampleIndex = MTLCounterDontSample;
+            statistics_attachment.endOfFragmentSampleIndex = timed->end;
+        }
+    }
+
+    id<MTLComputeCommandEncoder> compute_encoder(id<MTLCommandBuffer> command_buffer, FramePass pass)
+    {
+        if (@available(macOS 11.0, *))
+        {
+            if (const TimedPass *timed = add_pass(pass))
+            {
+                MTLComputePassDescriptor *desc = [MTLComputePassDescriptor computePassDescriptor];
+                desc.sampleBufferAttachments[0].sampleBuffer = _frames[_frame].samples;
+                desc.sampleBufferAttachments[0].startOfEncoderSampleIndex = timed->start;
+                desc.sampleBufferAttachments[0].endOfEncoderSampleIndex = timed->end;
+                if (id<MTLCounterSampleBuffer> statistics = _frames[_frame].statistics)
+                {
+                    desc.sampleBufferAttachments[1].sampleBuffer = statistics;
+                    desc.sampleBufferAttachments[1].startOfEncoderSampleIndex = timed->start;
+                    desc.sampleBufferAttachments[1].endOfEncoderSampleIndex = timed->end;
+                }
+                return [command_buffer computeCommandEncoderWithDescriptor:desc];
+            }
+        }
+        return [command_buffer computeCommandEncoder];
+    }
+
+    // Times the draws encoded from here on to the end of the last timed render pass as pass.
+    void split_render_pass(id<MTLRenderCommandEncoder> encoder, FramePass pass)
+    {
+        Frame &frame = _frames[_frame];
+        if (!_draw_samples || frame.render_pass == NO_PASS || frame.next_sample >= MAX_SAMPLES)
+            return;
+
+        const unsigned int sample = frame.next_sample++;
+        [encoder sampleCountersInBuffer:frame.samples atSampleIndex:sample withBarrier:YES];
+        if (frame.statistics != nil)
+            [encoder sampleCountersInBuffer:frame.statistics atSampleIndex:sample withBarrier:YES];
+        const unsigned int end = frame.passes[frame.render_pass].end;
+        frame.passes[frame.render_pass].end = sample;
+        frame.passes.push_back({pass, sample, end});
+        frame.render_pass = static_cast<unsigned int>(frame.passes.size() - 1);
+    }
+
+    // Called from a completed handler of the frame's last command buffer, which must run before the frame slot is
+    // reused. Frames split into two command buffers are timed without the time between them.
+    void resolve(unsigned int frame_index, id<MTLCommandBuffer> first, id<MTLCommandBuffer> last)
+    {
+        const Frame &frame = _frames[frame_index];
+        FrameStats stats = {};
+        double seconds = last.GPUEndTime - last.GPUStartTime;
+        if (first != last)
+            seconds += first.GPUEndTime - first.GPUStartTime;
+        stats.frame_ms = static_cast<float>(seconds * 1000.0);
+        stats.uploads_ms = static_cast<float>(static_cast<double>(_upload_ns.exchange(0)) * 1e-6);
+        stats.draws = frame.draws;
+        stats.instances = frame.instances;
+        stats.triangles = frame.triangles;
+        const bool tracing = _trace != nullptr && _trace->recording();
+        if (tracing)
+        {
+            trace_command_buffer("Frame", first);
+            if (first != last)
+                trace_command_buffer("Frame Present", last);
+        }
+
+        if (frame.samples != nil && frame.next_sample > 0)
+        {
+            // GPU timestamps tick at a device specific rate, it is measured against the CPU clock in nanoseconds.
+            MTLTimestamp cpu = 0;
+            MTLTimestamp gpu = 0;
+            [_device sampleTimestamps:&cpu gpuTimestamp:&gpu];
+            const double ns_per_tick =
+                gpu > _gpu_start ? static_cast<double>(cpu - _cpu_start) / static_cast<double>(gpu - _gpu_start) : 1.0;
+            // Traces map timestamps back from the current GPU time onto the clock of the trace.
+            const uint64_t trace_now = TraceRecorder::now();
+            const auto trace_time = [&](uint64_t timestamp) {
+                const double ns_ago = static_cast<double>(gpu > timestamp ? gpu - timestamp : 0) * ns_per_tick;
+                return trace_now - std::min(trace_now, static_cast<uint64_t>(ns_ago));
+            };
+
+            NSData *data = [frame.samples resolveCounterRange:NSMakeRange(0, frame.next_sample)];
+            const auto *timestamps = static_cast<const MTLCounterResultTimestamp *>(data.bytes);
+            const size_t count = data.length / sizeof(MTLCounterResultTimestamp);
+            for (const TimedPass &pass : frame.passes)
+            {
+                if (pass.start >= count || pass.end >= count)
+                    continue;
+                const uint64_t start = timestamps[pass.start].timestamp;
+                const uint64_t end = timestamps[pass.end].timestamp;
+                if (start == MTLCounterErrorValue || end == MTLCounterErrorValue || end < start)
+                    continue;
+                stats.pass_ms[pass.pass] += static_cast<float>(static_cast<double>(end - start) * ns_per_tick * 1e-6);
+                if (tracing)
+                    _trace->add_gpu(PASS_NAMES[pass.pass], TraceRecorder::GPU_PASSES_TRACK, trace_time(start),
+                                    trace_time(end));
+            }
+        }
+        if (frame.statistics != nil)
+            resolve_statistics(frame, stats);
+
+        std::lock_guard<std::mutex> lock(_mutex);
+        _stats = stats;
+        _resolved++;
+    }
+
+    // Adds the GPU time of a completed upload command buffer to the next resolved frame.
+    void add_upload(id<MTLCommandBuffer> command_buffer)
+    {
+        const double seconds = command_buffer.GPUEndTime - command_buffer.GPUStartTime;
+        _upload_ns += static_cast<uint64_t>(std::max(seconds, 0.0) * 1e9);
+        if (_trace != nullptr && _trace->recording())
+            trace_command_buffer("Upload", command_buffer);
+    }
+
+    // Stats of the last completed frame.
+    FrameStats stats() const
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        return _stats;
+    }
+
+    // Number of frames resolved so far, stats changed when it did.
+    uint64_t resolved() const
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        return _resolved;
+    }
+
+  private:
+    static constexpr unsigned int NO_PASS = ~0u;
+    // Names of the FramePass spans of traces.
+    static constexpr const char *PASS_NAMES[FRAME_PASS_COUNT] = {"Skinning", "Culling", "Depth",   "Shadows",
+                                                                 "Lighting", "3D",      "Upscale", "2D"};
+
+    // GPU times of command buffers are seconds of the host clock the trace uses.
+    void trace_command_buffer(const char *name, id<MTLCommandBuffer> command_buffer)
+    {
+        if (command_buffer.GPUEndTime <= 0.0)
+            return;
+        _trace->add_gpu(name, TraceRecorder::GPU_COMMAND_BUFFERS_TRACK,
+                        static_cast<uint64_t>(command_buffer.GPUStartTime * 1e9),
+                        static_cast<uint64_t>(command_buffer.GPUEndTime * 1e9));
+    }
+
+    struct TimedPass
+    {
+        FramePass pass;
+        unsigned int start;
+        unsigned int end;
+    };
+
+    struct Frame
+    {
+        id<MTLCounterSampleBuffer> samples = nil;
+        id<MTLCounterSampleBuffer> statistics = nil;
+        std::vector<TimedPass> passes;
+        unsigned int next_sample = 0;
+        // Timed pass the last timed render pass ends with.
+        unsigned int render_pass = NO_PASS;
+        unsigned int draws = 0;
+        unsigned int instances = 0;
+        unsigned int triangles = 0;
+    };
+
+    const TimedPass *add_pass(FramePass pass)
+    {
+        Frame &frame = _frames[_frame];
+        if (frame.samples == nil || frame.next_sample + 2 > MAX_SAMPLES)
+            return nullptr;
+        frame.passes.push_back({pass, frame.next_sample, frame.next_sample + 1});
+        frame.next_sample += 2;
+        return &frame.passes.back();
+    }
+
+    void sample_frame(id<MTLCommandBuffer> command_buffer, unsigned int sample)
+    {
+        id<MTLCounterSampleBuffer> statistics = _frames[_frame].statistics;
+        if (statistics == nil || !_blit_samples)
+            return;
+
+        id<MTLBlitCommandEncoder> blit = [command_buffer blitCommandEncoder];
+        blit.label = @"FrameStatistics";
+        [blit sampleCountersInBuffer:statistics atSampleIndex:sample withBarrier:YES];
+        [blit endEncoding];
+    }
+
+    static void add_statistics(PipelineStatistics &statistics, const MTLCounterResultStatistic &start,
+                               const MTLCounterResultStatistic &end)
+    {
+        const auto delta = [](uint64_t from, uint64_t to) { return to > from ? to - from : 0; };
+        statistics.vertex_invocations += delta(start.vertexInvocations, end.vertexInvocations);
+        statistics.fragment_invocations += delta(start.fragmentInvocations, end.fragmentInvocations);
+        statistics.clipper_invocations += delta(start.clipperInvocations, end.clipperInvocations);
+        statistics.clipper_primitives_out += delta(start.clipperPrimitivesOut, end.clipperPrimitivesOut);
+    }
+
+    // Samples that were not taken read as MTLCounterErrorValue and are left out.
+    static void resolve_statistics(const Frame &frame, FrameStats &stats)
+    {
+        NSData *data = [frame.statistics resolveCounterRange:NSMakeRange(0, MAX_SAMPLES + 2)];
+        const auto *samples = static_cast<const MTLCounterResultStatistic *>(data.bytes);
+        const size_t count = data.length / sizeof(MTLCounterResultStatistic);
+        const auto valid = [&](unsigned int sample) {
+            return sample < count && samples[sample].vertexInvocations != MTLCounterErrorValue;
+        };
+
+        stats.has_statistics = 1;
+        for (const TimedPass &pass : frame.passes)
+        {
+            if (valid(pass.start) && valid(pass.end))
+                add_statistics(stats.pass_statistics[pass.pass], samples[pass.start], samples[pass.end]);
+        }
+        if (valid(FRAME_START_SAMPLE) && valid(FRAME_END_SAMPLE))
+            add_statistics(stats.statistics, samples[FRAME_START_SAMPLE], samples[FRAME_END_SAMPLE]);
+    }
+
+    id<MTLDevice> _device = nil;
+    id<MTLCounterSet> _timestamps = nil;
+    id<MTLCounterSet> _statistics = nil;
+    bool _stage_samples = false;
+    bool _draw_samples = false;
+    bool _blit_samples = false;
+    MTLTimestamp _cpu_start = 0;
+    MTLTimestamp _gpu_start = 0;
+    TraceRecorder *_trace = nullptr;
+
+    std::vector<Frame> _frames;
+    unsigned int _frame = 0;
+    std::atomic<uint64_t> _upload_ns{0};
+
+    mutable std::mutex _mutex;
+    FrameStats _stats = {};
+    uint64_t _resolved = 0;
+};
+
+#endif // METALCPP_SRC_FRAME_TIMER_HPP
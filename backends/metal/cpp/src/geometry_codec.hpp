@@ -0,0 +1,246 @@
+#ifndef METALCPP_SRC_GEOMETRY_CODEC_HPP
+#define METALCPP_SRC_GEOMETRY_CODEC_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include "utils.hpp"
+
+// Compact vertex and index streams, in the spirit of the codecs of meshoptimizer. Vertices are split into blocks of
+// VERTEX_BLOCK_SIZE, every byte of the vertex layout is stored as the zigzagged difference to the same byte of the
+// previous vertex, in groups of 16 packed to 0, 2, 4 or 8 bits. Blocks start from zero, so they decode independently
+// and in parallel. Indices are stored as a single 0 byte for the next vertex that was not referenced yet, or as the
+// varint of the zigzagged difference to the previous index plus 1. Both streams compress well further with a general
+// purpose compressor.
+constexpr uint32_t VERTEX_STREAM_MAGIC = 0x56574652; // RFWV
+constexpr uint32_t INDEX_STREAM_MAGIC = 0x49574652;  // RFWI
+constexpr unsigned int VERTEX_BLOCK_SIZE = 256;
+constexpr unsigned int VERTEX_GROUP_SIZE = 16;
+constexpr size_t VERTEX_STREAM_HEADER = 16;
+constexpr size_t INDEX_STREAM_HEADER = 8;
+
+// Largest size of count vertices of stride bytes as a vertex stream.
+inline size_t encoded_vertices_bound(unsigned int count, unsigned int stride)
+{
+    const size_t blocks = (count + VERTEX_BLOCK_SIZE - 1) / VERTEX_BLOCK_SIZE;
+    const size_t groups = VERTEX_BLOCK_SIZE / VERTEX_GROUP_SIZE;
+    const size_t block_size = sizeof(uint32_t) + stride * ((groups + 3) / 4 + groups * VERTEX_GROUP_SIZE);
+    return VERTEX_STREAM_HEADER + blocks * block_size;
+}
+
+// Largest size of count indices as an index stream.
+inline size_t encoded_indices_bound(unsigned int count)
+{
+    return INDEX_STREAM_HEADER + size_t(count) * 5;
+}
+
+// Encodes count vertices of stride bytes into out, returns the size of the stream or 0 when it needs more than
+// capacity bytes.
+inline size_t encode_vertices(const void *vertices, unsigned int count, unsigned int stride, unsigned char *out,
+                              size_t capacity)
+{
+    const unsigned int num_blocks = (count + VERTEX_BLOCK_SIZE - 1) / VERTEX_BLOCK_SIZE;
+    std::vector<unsigned char> stream(VERTEX_STREAM_HEADER + num_blocks * sizeof(uint32_t));
+    const uint32_t header[4] = {VERTEX_STREAM_MAGIC, stride, count, num_blocks};
+    memcpy(stream.data(), header, sizeof(header));
+
+    const auto *bytes = static_cast<const unsigned char *>(vertices);
+    unsigned char values[VERTEX_BLOCK_SIZE];
+    for (unsigned int b = 0; b < num_blocks; b++)
+    {
+        const auto offset = static_cast<uint32_t>(stream.size());
+        memcpy(stream.data() + VERTEX_STREAM_HEADER + b * sizeof(uint32_t), &offset, sizeof(offset));
+
+        const unsigned int first = b * VERTEX_BLOCK_SIZE;
+        const unsigned int n = std::min(VERTEX_BLOCK_SIZE, count - first);
+        const unsigned int groups = (n + VERTEX_GROUP_SIZE - 1) / VERTEX_GROUP_SIZE;
+        for (unsigned int k = 0; k < stride; k++)
+        {
+            memset(values, 0, sizeof(values));
+            unsigned char previous = 0;
+            for (unsigned int i = 0; i < n; i++)
+            {
+                const unsigned char value = bytes[size_t(first + i) * stride + k];
+                const auto delta = static_cast<unsigned char>(value - previous);
+                values[i] = static_cast<unsigned char>((delta << 1) ^ (delta & 0x80 ? 0xFF : 0x00));
+                previous = value;
+            }
+
+            const size_t headers = stream.size();
+            stream.resize(stream.size() + (groups + 3) / 4, 0);
+            for (unsigned int g = 0; g < groups; g++)
+            {
+                const unsigned char *group = values + g * VERTEX_GROUP_SIZE;
+                unsigned char bits = 0;
+                for (unsigned int i = 0; i < VERTEX_GROUP_SIZE; i++)
+                    bits |= group[i];
+                const unsigned int code = bits == 0 ? 0 : bits < 4 ? 1 : bits < 16 ? 2 : 3;
+                stream[headers + g / 4] |= static_cast<unsigned char>(code << ((g % 4) * 2));
+
+                const unsigned int width = code == 0 ? 0 : 1u << code;
+                const size_t packed = stream.size();
+                stream.resize(stream.size() + width * VERTEX_GROUP_SIZE / 8, 0);
+                for (unsigned int i = 0; i < VERTEX_GROUP_SIZE && width > 0; i++)
+                    stream[packed + i * width / 8] |= static_cast<unsigned char>(group[i] << (i * width % 8));
+            }
+        }
+    }
+
+    if (stream.size() > capacity)
+        return 0;
+    memcpy(out, stream.data(), stream.size());
+    return stream.size();
+}
+
+// Decodes the vertex block at offset into vertices, false when it runs past size.
+inline bool decode_vertex_block(const unsigned char *stream, size_t size, size_t offset, unsigned int first,
+                                unsigned int n, unsigned int stride, unsigned char *vertices)
+{
+    const unsigned int groups = (n + VERTEX_GROUP_SIZE - 1) / VERTEX_GROUP_SIZE;
+    unsigned char values[VERTEX_BLOCK_SIZE];
+    for (unsigned int k = 0; k < stride; k++)
+    {
+        const size_t headers = offset;
+        offset += (groups + 3) / 4;
+        if (offset > size)
+            return false;
+
+        for (unsigned int g = 0; g < groups; g++)
+        {
+            unsigned char *group = values + g * VERTEX_GROUP_SIZE;
+            const unsigned int code = (stream[headers + g / 4] >> ((g % 4) * 2)) & 3;
+            const unsigned int width = code == 0 ? 0 : 1u << code;
+            if (offset + width * VERTEX_GROUP_SIZE / 8 > size)
+                return false;
+
+            const unsigned char mask = static_cast<unsigned char>((1u << width) - 1);
+            for (unsigned int i = 0; i < VERTEX_GROUP_SIZE; i++)
+                group[i] = width == 0 ? 0 : (stream[offset + i * width / 8] >> (i * width % 8)) & mask;
+            offset += width * VERTEX_GROUP_SIZE / 8;
+        }
+
+        unsigned char previous = 0;
+        for (unsigned int i = 0; i < n; i++)
+        {
+            const unsigned char zigzag = values[i];
+            previous = static_cast<unsigned char>(previous + ((zigzag >> 1) ^ (zigzag & 1 ? 0xFF : 0x00)));
+            vertices[size_t(first + i) * stride + k] = previous;
+        }
+    }
+    return true;
+}
+
+// Decodes a vertex stream of vertices of stride bytes into out, with its blocks spread over the global queue. Returns
+// false for streams of another stride or that are truncated.
+template <typename T> inline bool decode_vertices(const unsigned char *stream, size_t size, std::vector<T> &out)
+{
+    uint32_t header[4];
+    if (size < VERTEX_STREAM_HEADER)
+        return false;
+    memcpy(header, stream, sizeof(header));
+    const unsigned int count = header[2];
+    const unsigned int num_blocks = header[3];
+    if (header[0] != VERTEX_STREAM_MAGIC || header[1] != sizeof(T) ||
+        num_blocks != (count + VERTEX_BLOCK_SIZE - 1) / VERTEX_BLOCK_SIZE ||
+        VERTEX_STREAM_HEADER + size_t(num_blocks) * sizeof(uint32_t) > size)
+        return false;
+
+    out.resize(count);
+    std::vector<uint32_t> offsets(num_blocks);
+    memcpy(offsets.data(), stream + VERTEX_STREAM_HEADER, num_blocks * sizeof(uint32_t));
+    auto *vertices = reinterpret_cast<unsigned char *>(out.data());
+    std::vector<unsigned char> valid(num_blocks, 0);
+    parallel_for(num_blocks, 16, [&](size_t first, size_t last) {
+        for (size_t b = first; b < last; b++)
+        {
+            const auto first_vertex = static_cast<unsigned int>(b * VERTEX_BLOCK_SIZE);
+            const unsigned int n = std::min(VERTEX_BLOCK_SIZE, count - first_vertex);
+            valid[b] = offsets[b] <= size &&
+                       decode_vertex_block(stream, size, offsets[b], first_vertex, n, sizeof(T), vertices);
+        }
+    });
+    return std::all_of(valid.begin(), valid.end(), [](unsigned char v) { return v != 0; });
+}
+
+// Encodes count indices into out, returns the size of the stream or 0 when it needs more than capacity bytes.
+inline size_t encode_indices(const unsigned int *indices, unsigned int count, unsigned char *out, size_t capacity)
+{
+    std::vector<unsigned char> stream(INDEX_STREAM_HEADER);
+    const uint32_t header[2] = {INDEX_STREAM_MAGIC, count};
+    memcpy(stream.data(), header, sizeof(header));
+
+    uint32_t next = 0;
+    uint32_t previous = 0;
+    for (unsigned int i = 0; i < count; i++)
+    {
+        const uint32_t index = indices[i];
+        if (index == next)
+        {
+            stream.push_back(0);
+            next++;
+        }
+        else
+        {
+            const int64_t delta = int64_t(index) - int64_t(previous);
+            uint64_t code = ((uint64_t(delta) << 1) ^ uint64_t(delta >> 63)) + 1;
+            for (; code >= 0x80; code >>= 7)
+                stream.push_back(static_cast<unsigned char>(code | 0x80));
+            stream.push_back(static_cast<unsigned char>(code));
+            next = std::max(next, index + 1);
+        }
+        previous = index;
+    }
+
+    if (stream.size() > capacity)
+        return 0;
+    memcpy(out, stream.data(), stream.size());
+    return stream.size();
+}
+
+// Decodes an index stream into out, false for streams that are truncated or malformed.
+inline bool decode_indices(const unsigned char *stream, size_t size, std::vector<unsigned int> &out)
+{
+    uint32_t header[2];
+    if (size < INDEX_STREAM_HEADER)
+        return false;
+    memcpy(header, stream, sizeof(header));
+    if (header[0] != INDEX_STREAM_MAGIC || header[1] > size - INDEX_STREAM_HEADER)
+        return false;
+
+    out.resize(header[1]);
+    size_t offset = INDEX_STREAM_HEADER;
+    uint32_t next = 0;
+    uint32_t previous = 0;
+    for (unsigned int &index : out)
+    {
+        uint64_t code = 0;
+        for (unsigned int shift = 0;; shift += 7)
+        {
+            if (offset >= size || shift > 63)
+                return false;
+            const unsigned char byte = stream[offset++];
+            code |= uint64_t(byte & 0x7F) << shift;
+            if ((byte & 0x80) == 0)
+                break;
+        }
+
+        if (code == 0)
+        {
+            index = next++;
+        }
+        else
+        {
+            const uint64_t zigzag = code - 1;
+            const int64_t delta = int64_t(zigzag >> 1) ^ -int64_t(zigzag & 1);
+            index = static_cast<uint32_t>(int64_t(previous) + delta);
+            next = std::max(next, index + 1);
+        }
+        previous = index;
+    }
+    return true;
+}
+
+#endif // METALCPP_SRC_GEOMETRY_CODEC_HPP
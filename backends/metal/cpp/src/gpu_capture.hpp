@@ -0,0 +1,166 @@
+#ifndef METALCPP_SRC_GPU_CAPTURE_HPP
+#define METALCPP_SRC_GPU_CAPTURE_HPP
+
+#import <Foundation/Foundation.h>
+#import <Metal/Metal.h>
+
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <mutex>
+#include <string>
+
+#include <unistd.h>
+
+// Captures frames of the renderer into .gputrace documents with MTLCaptureManager, on request or once the GPU time of
+// a frame exceeded a threshold. Captures cover every command buffer of the device from the start of the first frame to
+// the commit of the last, uploads included. Triggered captures start with the frame after the slow one, the GPU time of
+// a frame is only known once it completed. Processes can only capture with MTL_CAPTURE_ENABLED=1 in their environment
+// or MetalCaptureEnabled in their Info.plist.
+class GpuCapture
+{
+  public:
+    ~GpuCapture()
+    {
+        stop();
+    }
+
+    // Whether the process may write .gputrace documents.
+    static bool supported()
+    {
+        if (@available(macOS 10.15, *))
+            return [[MTLCaptureManager sharedCaptureManager] supportsDestination:MTLCaptureDestinationGPUTraceDocument];
+        return false;
+    }
+
+    // Captures the next frames rendered into directory, the temporary directory when it is null. Returns false when
+    // captures are not supported.
+    bool request(const char *directory, unsigned int frames)
+    {
+        if (frames == 0 || !supported())
+            return false;
+
+        std::lock_guard<std::mutex> lock(_mutex);
+        _pending_frames = frames;
+        _pending_directory = directory ? directory : "";
+        _pending = true;
+        return true;
+    }
+
+    // Captures frames frames once a frame took more than threshold_ms on the GPU. The trigger fires once, it is armed
+    // again by setting it again. A threshold of 0 disarms it.
+    void set_trigger(const char *directory, float threshold_ms, unsigned int frames)
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _trigger_frames = frames;
+        _trigger_directory = directory ? directory : "";
+        _threshold_ms = frames > 0 && supported() ? threshold_ms : 0.0f;
+    }
+
+    // Arms captures from RFW_GPU_CAPTURE_THRESHOLD_MS, RFW_GPU_CAPTURE_FRAMES and RFW_GPU_CAPTURE_DIR. Without a
+    // threshold, the first frames are captured.
+    void configure_from_environment()
+    {
+        const char *threshold = getenv("RFW_GPU_CAPTURE_THRESHOLD_MS");
+        const char *frames = getenv("RFW_GPU_CAPTURE_FRAMES");
+        const char *directory = getenv("RFW_GPU_CAPTURE_DIR");
+        const unsigned int count = frames ? static_cast<unsigned int>(strtoul(frames, nullptr, 10)) : 1;
+        if (threshold)
+            set_trigger(directory, strtof(threshold, nullptr), count);
+        else if (frames)
+            request(directory, count);
+    }
+
+    // Called with the GPU time of every completed frame, on a thread of Metal's choosing.
+    void frame_completed(float frame_ms)
+    {
+        const float threshold = _threshold_ms.load();
+        if (threshold <= 0.0f || frame_ms <= threshold)
+            return;
+
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (_threshold_ms.load() <= 0.0f || _pending)
+            return;
+        NSLog(@"Frame took %.2f ms on the GPU, capturing the next %u frames", frame_ms, _trigger_frames);
+        _threshold_ms = 0.0f;
+        _pending_frames = _trigger_frames;
+        _pending_directory = _trigger_directory;
+        _pending = true;
+    }
+
+    // Starts a pending capture before the frame encodes anything.
+    void begin_frame(id<MTLDevice> device, uint64_t frame)
+    {
+        if (_remaining > 0 || !_pending.load())
+            return;
+
+        std::string directory;
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _pending = false;
+            _remaining = _pending_frames;
+            directory = _pending_directory;
+        }
+        if (!start(device, directory, frame))
+            _remaining = 0;
+    }
+
+    // Stops the capture after the last command buffer of its last frame was committed.
+    void end_frame()
+    {
+        if (_remaining > 0 && --_remaining == 0)
+            stop();
+    }
+
+  private:
+    bool start(id<MTLDevice> device, const std::string &directory, uint64_t frame)
+    {
+        if (@available(macOS 10.15, *))
+        {
+            MTLCaptureManager *manager = [MTLCaptureManager sharedCaptureManager];
+            if (manager.isCapturing)
+                return false;
+
+            NSString *folder = directory.empty() ? NSTemporaryDirectory() : @(directory.c_str());
+            NSString *name = [NSString stringWithFormat:@"rfw-%d-frame-%llu.gputrace", getpid(), frame];
+            MTLCaptureDescriptor *desc = [MTLCaptureDescriptor new];
+            desc.captureObject = device;
+            desc.destination = MTLCaptureDestinationGPUTraceDocument;
+            desc.outputURL = [NSURL fileURLWithPath:[folder stringByAppendingPathComponent:name]];
+
+            NSError *err = nil;
+            if (![manager startCaptureWithDescriptor:desc error:&err])
+            {
+                NSLog(@"Could not start GPU capture: %@", [err localizedDescription]);
+                return false;
+            }
+            NSLog(@"Capturing %u frames into %@", _remaining, desc.outputURL.path);
+            _capturing = true;
+            return true;
+        }
+        return false;
+    }
+
+    void stop()
+    {
+        if (!_capturing)
+            return;
+        [[MTLCaptureManager sharedCaptureManager] stopCapture];
+        _capturing = false;
+        _remaining = 0;
+    }
+
+    std::mutex _mutex;
+    std::atomic<bool> _pending{false};
+    unsigned int _pending_frames = 0;
+    std::string _pending_directory;
+    std::atomic<float> _threshold_ms{0.0f};
+    unsigned int _trigger_frames = 0;
+    std::string _trigger_directory;
+
+    // Frames left to capture, only used by the thread that renders.
+    unsigned int _remaining = 0;
+    bool _capturing = false;
+};
+
+#endif // METALCPP_SRC_GPU_CAPTURE_HPP
@@ -0,0 +1,255 @@
+#ifndef METALCPP_SRC_GPU_PRIMITIVES_HPP
+#define METALCPP_SRC_GPU_PRIMITIVES_HPP
+
+#import <Metal/Metal.h>
+
+#include <algorithm>
+#include <cassert>
+
+#include "pipeline_cache.hpp"
+#include "retired_resources.hpp"
+#include "structs.h"
+
+// Parallel building blocks on buffers of 32-bit words: exclusive prefix sums, stream compaction, radix sorts of
+// key-value pairs and sums of segments. They are encoded into a compute encoder of the caller, whose dispatches run in
+// order, and share one scratch buffer, so encoders using them must not run concurrently.
+//
+// Threadgroups on Apple GPUs are not guaranteed to make progress while others wait on them, so nothing spins on the
+// results of other tiles. Scans sum the tiles and scan their sums before scanning the tiles, sorts scatter by the
+// histograms of all tiles.
+class GpuPrimitives
+{
+  public:
+    // Apple GPUs from the A14 on keep PRIMITIVE_MAX_ITEMS elements per thread, other GPUs half as many.
+    void create(id<MTLDevice> device, id<MTLLibrary> library, PipelineCache &pipelines, RetiredResources &retired)
+    {
+        _device = device;
+        _retired = &retired;
+        _items = PRIMITIVE_MAX_ITEMS / 2;
+        if (@available(macOS 11.0, *))
+            _items = [device supportsFamily:MTLGPUFamilyApple7] ? PRIMITIVE_MAX_ITEMS : _items;
+
+        MTLFunctionConstantValues *constants = [MTLFunctionConstantValues new];
+        [constants setConstantValue:&_items type:MTLDataTypeUInt atIndex:PRIMITIVE_ITEMS_CONSTANT_INDEX];
+        const auto create_state = [&](NSString *name, __strong id<MTLComputePipelineState> *state) {
+            NSError *err = nil;
+            id<MTLFunction> function = [library newFunctionWithName:name constantValues:constants error:&err];
+            if (err)
+            {
+                NSLog(@"%@: %@", name, [err localizedDescription]);
+                assert(false);
+            }
+            pipelines.create(function, state);
+        };
+        create_state(@"scan_reduce", &_scan_reduce_state);
+        create_state(@"scan_tiles", &_scan_tiles_state);
+        create_state(@"compact_values", &_compact_state);
+        create_state(@"radix_histogram", &_histogram_state);
+        create_state(@"radix_scatter", &_scatter_state);
+        create_state(@"copy_words", &_copy_state);
+        create_state(@"segmented_sum", &_segmented_sum_state);
+    }
+
+    void release()
+    {
+        _scan_reduce_state = nil;
+        _scan_tiles_state = nil;
+        _compact_state = nil;
+        _histogram_state = nil;
+        _scatter_state = nil;
+        _copy_state = nil;
+        _segmented_sum_state = nil;
+        _scratch = nil;
+    }
+
+    // Elements one threadgroup works on.
+    unsigned int tile_size() const
+    {
+        return PRIMITIVE_THREADS * _items;
+    }
+
+    id<MTLBuffer> scratch() const
+    {
+        return _scratch;
+    }
+
+    // Exclusive prefix sum of count words of input into output, which may be the same range.
+    void encode_scan(id<MTLComputeCommandEncoder> encoder, id<MTLBuffer> input, NSUInteger input_offset,
+                     id<MTLBuffer> output, NSUInteger output_offset, unsigned int count)
+    {
+        if (count == 0)
+            return;
+        reserve(scan_words(count));
+        scan(encoder, input, input_offset, output, output_offset, count, 0);
+    }
+
+    // Copies the values whose flag is 1 to the start of output in their order, flags are 0 or 1. The number of copied
+    // values is written to the word at count_offset of counts.
+    void encode_compact(id<MTLComputeCommandEncoder> encoder, id<MTLBuffer> values, NSUInteger values_offset,
+                        id<MTLBuffer> flags, NSUInteger flags_offset, id<MTLBuffer> output, NSUInteger output_offset,
+                        id<MTLBuffer> counts, NSUInteger count_offset, unsigned int count)
+    {
+        reserve(count + scan_words(count));
+        if (count > 0)
+            scan(encoder, flags, flags_offset, _scratch, 0, count, count);
+
+        PrimitiveUniforms uniforms = {};
+        uniforms.count = count;
+        [encoder setComputePipelineState:_compact_state];
+        [encoder setBuffer:values offset:values_offset atIndex:0];
+        [encoder setBuffer:flags offset:flags_offset atIndex:1];
+        [encoder setBuffer:_scratch offset:0 atIndex:2];
+        [encoder setBuffer:output offset:output_offset atIndex:3];
+        [encoder setBuffer:counts offset:count_offset atIndex:4];
+        [encoder setBytes:&uniforms length:sizeof(uniforms) atIndex:5];
+        dispatch(encoder, std::max(1u, (count + PRIMITIVE_THREADS - 1) / PRIMITIVE_THREADS));
+    }
+
+    // Sorts count pairs at offset of pairs by the lowest key_bits bits of their key, keeping the order of equal keys.
+    // Pairs of 32-bit keys are a key and a value word, pairs of 64-bit keys hold the low and high word of the key, the
+    // value and a word of padding.
+    void encode_sort(id<MTLComputeCommandEncoder> encoder, id<MTLBuffer> pairs, NSUInteger offset, unsigned int count,
+                     unsigned int key_bits, bool wide_keys)
+    {
+        if (count < 2 || key_bits == 0)
+            return;
+
+        PrimitiveUniforms uniforms = {};
+        uniforms.count = count;
+        uniforms.tiles = tiles(count);
+        uniforms.words = wide_keys ? 4 : 2;
+        const unsigned int histogram_words = RADIX_BINS * uniforms.tiles;
+        const NSUInteger histograms = NSUInteger(count) * uniforms.words * sizeof(unsigned int);
+        reserve(count * uniforms.words + histogram_words + scan_words(histogram_words));
+
+        // Passes go back and forth between the pairs and the start of the scratch buffer.
+        id<MTLBuffer> buffers[2] = {pairs, _scratch};
+        const NSUInteger offsets[2] = {offset, 0};
+        const unsigned int passes = (std::min(key_bits, wide_keys ? 64u : 32u) + RADIX_BITS - 1) / RADIX_BITS;
+        for (unsigned int pass = 0; pass < passes; pass++)
+        {
+            const unsigned int from = pass % 2;
+            uniforms.shift = pass * RADIX_BITS;
+            [encoder setComputePipelineState:_histogram_state];
+            [encoder setBuffer:buffers[from] offset:offsets[from] atIndex:0];
+            [encoder setBuffer:_scratch offset:histograms atIndex:1];
+            [encoder setBytes:&uniforms length:sizeof(uniforms) atIndex:2];
+            dispatch(encoder, uniforms.tiles);
+
+            scan(encoder, _scratch, histograms, _scratch, histograms, histogram_words,
+                 histograms / sizeof(unsigned int) + histogram_words);
+
+            [encoder setComputePipelineState:_scatter_state];
+            [encoder setBuffer:buffers[from] offset:offsets[from] atIndex:0];
+            [encoder setBuffer:buffers[1 - from] offset:offsets[1 - from] atIndex:1];
+            [encoder setBuffer:_scratch offset:histograms atIndex:2];
+            [encoder setBytes:&uniforms length:sizeof(uniforms) atIndex:3];
+            dispatch(encoder, uniforms.tiles);
+        }
+
+        if (passes % 2 == 1)
+        {
+            PrimitiveUniforms copy = {};
+            copy.count = count * uniforms.words;
+            [encoder setComputePipelineState:_copy_state];
+            [encoder setBuffer:_scratch offset:0 atIndex:0];
+            [encoder setBuffer:pairs offset:offset atIndex:1];
+            [encoder setBytes:&copy length:sizeof(copy) atIndex:2];
+            dispatch(encoder, (copy.count + PRIMITIVE_THREADS - 1) / PRIMITIVE_THREADS);
+        }
+    }
+
+    // Sum of the floats of values in [offsets[i], offsets[i + 1]) for each of count segments, offsets holds count + 1
+    // words.
+    void encode_segmented_sum(id<MTLComputeCommandEncoder> encoder, id<MTLBuffer> values, NSUInteger values_offset,
+                              id<MTLBuffer> offsets, NSUInteger offsets_offset, id<MTLBuffer> sums,
+                              NSUInteger sums_offset, unsigned int count)
+    {
+        if (count == 0)
+            return;
+
+        PrimitiveUniforms uniforms = {};
+        uniforms.count = count;
+        const NSUInteger segments_per_group = PRIMITIVE_THREADS / _segmented_sum_state.threadExecutionWidth;
+        [encoder setComputePipelineState:_segmented_sum_state];
+        [encoder setBuffer:values offset:values_offset atIndex:0];
+        [encoder setBuffer:offsets offset:offsets_offset atIndex:1];
+        [encoder setBuffer:sums offset:sums_offset atIndex:2];
+        [encoder setBytes:&uniforms length:sizeof(uniforms) atIndex:3];
+        dispatch(encoder, (count + segments_per_group - 1) / segments_per_group);
+    }
+
+  private:
+    unsigned int tiles(unsigned int count) const
+    {
+        return (count + tile_size() - 1) / tile_size();
+    }
+
+    // Words of scratch a scan of count words needs for the sums of its tiles, at every level.
+    NSUInteger scan_words(unsigned int count) const
+    {
+        const unsigned int sums = tiles(count);
+        return sums > 1 ? sums + scan_words(sums) : 0;
+    }
+
+    void reserve(NSUInteger words)
+    {
+        const NSUInteger length = std::max<NSUInteger>(words, 1) * sizeof(unsigned int);
+        if (_scratch != nil && _scratch.length >= length)
+            return;
+
+        _retired->retire(_scratch);
+        _scratch = [_device newBufferWithLength:std::max<NSUInteger>(length, 2 * _scratch.length)
+                                        options:MTLResourceStorageModePrivate];
+        _scratch.label = @"PrimitivesScratch";
+    }
+
+    // Scans with more than one tile scan the sums of their tiles at scratch_word of the scratch buffer first.
+    void scan(id<MTLComputeCommandEncoder> encoder, id<MTLBuffer> input, NSUInteger input_offset,
+              id<MTLBuffer> output, NSUInteger output_offset, unsigned int count, NSUInteger scratch_word)
+    {
+        PrimitiveUniforms uniforms = {};
+        uniforms.count = count;
+        uniforms.tiles = tiles(count);
+        const NSUInteger sums = scratch_word * sizeof(unsigned int);
+        if (uniforms.tiles > 1)
+        {
+            [encoder setComputePipelineState:_scan_reduce_state];
+            [encoder setBuffer:input offset:input_offset atIndex:0];
+            [encoder setBuffer:_scratch offset:sums atIndex:1];
+            [encoder setBytes:&uniforms length:sizeof(uniforms) atIndex:2];
+            dispatch(encoder, uniforms.tiles);
+
+            scan(encoder, _scratch, sums, _scratch, sums, uniforms.tiles, scratch_word + uniforms.tiles);
+            uniforms.offsets = 1;
+        }
+
+        [encoder setComputePipelineState:_scan_tiles_state];
+        [encoder setBuffer:input offset:input_offset atIndex:0];
+        [encoder setBuffer:output offset:output_offset atIndex:1];
+        [encoder setBuffer:_scratch offset:uniforms.offsets ? sums : 0 atIndex:2];
+        [encoder setBytes:&uniforms length:sizeof(uniforms) atIndex:3];
+        dispatch(encoder, uniforms.tiles);
+    }
+
+    static void dispatch(id<MTLComputeCommandEncoder> encoder, NSUInteger groups)
+    {
+        [encoder dispatchThreadgroups:MTLSizeMake(groups, 1, 1)
+                threadsPerThreadgroup:MTLSizeMake(PRIMITIVE_THREADS, 1, 1)];
+    }
+
+    id<MTLDevice> _device = nil;
+    RetiredResources *_retired = nullptr;
+    unsigned int _items = PRIMITIVE_MAX_ITEMS / 2;
+    id<MTLBuffer> _scratch = nil;
+
+    id<MTLComputePipelineState> _scan_reduce_state = nil;
+    id<MTLComputePipelineState> _scan_tiles_state = nil;
+    id<MTLComputePipelineState> _compact_state = nil;
+    id<MTLComputePipelineState> _histogram_state = nil;
+    id<MTLComputePipelineState> _scatter_state = nil;
+    id<MTLComputePipelineState> _copy_state = nil;
+    id<MTLComputePipelineState> _segmented_sum_state = nil;
+};
+
+#endif // METALCPP_SRC_GPU_PRIMITIVES_HPP
@@ -0,0 +1,92 @@
+#ifndef METALCPP_SRC_HOST_BUFFER_HPP
+#define METALCPP_SRC_HOST_BUFFER_HPP
+
+#import <Metal/Metal.h>
+
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+
+// Buffer<T> in host memory, so the bookkeeping of VertexList and InstanceList runs without a device, e.g. in
+// benchmarks. Storage options are ignored and there is no MTLBuffer: buffer() is nil, anything encoding GPU work with
+// it must not be called.
+template <typename T> class HostBuffer
+{
+  public:
+    HostBuffer(id<MTLDevice>, size_t count, MTLResourceOptions = MTLResourceStorageModeShared) : _count(count)
+    {
+        // Zeroed like new Metal buffers, which also makes the page faults part of growing a list.
+        const size_t bytes = (byte_size() + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT;
+        _data = std::aligned_alloc(ALIGNMENT, bytes > 0 ? bytes : ALIGNMENT);
+        memset(_data, 0, bytes);
+    }
+
+    HostBuffer(id<MTLDevice> device, const T *data, size_t count,
+               MTLResourceOptions options = MTLResourceStorageModeShared)
+        : HostBuffer(device, count, options)
+    {
+        memcpy(_data, data, count * sizeof(T));
+    }
+
+    HostBuffer(const HostBuffer<T> &) = delete;
+    HostBuffer &operator=(const HostBuffer<T> &) = delete;
+
+    ~HostBuffer()
+    {
+        std::free(_data);
+    }
+
+    const void *data() const
+    {
+        return _data;
+    }
+
+    void *data()
+    {
+        return _data;
+    }
+
+    void update(unsigned int = 0, unsigned int = 0)
+    {
+    }
+
+    size_t size() const
+    {
+        return _count;
+    }
+
+    size_t byte_size() const
+    {
+        return _count * sizeof(T);
+    }
+
+    id<MTLDevice> device() const
+    {
+        return nil;
+    }
+
+    id<MTLBuffer> buffer() const
+    {
+        return nil;
+    }
+
+    bool managed() const
+    {
+        return false;
+    }
+
+  private:
+    static constexpr size_t ALIGNMENT = 64;
+
+    void *_data;
+    size_t _count;
+};
+
+// Allocator policy of VertexList and InstanceList that keeps their buffers in host memory, lists using it are handed a
+// nil device.
+struct HostAllocator
+{
+    template <typename T> using Buffer = HostBuffer<T>;
+};
+
+#endif // METALCPP_SRC_HOST_BUFFER_HPP
@@ -0,0 +1,174 @@
+#ifndef METALCPP_SRC_ID_TABLE_HPP
+#define METALCPP_SRC_ID_TABLE_HPP
+
+#include <iterator>
+#include <utility>
+#include <vector>
+
+// Values keyed by small, dense integer ids. Entries live in one array indexed by id, so a lookup is a bounds check and
+// iteration walks the ids in ascending order through contiguous memory.
+template <typename T> class IdTable
+{
+  public:
+    static constexpr unsigned int EMPTY = ~0u;
+    using Entry = std::pair<unsigned int, T>;
+
+    template <typename E> class basic_iterator
+    {
+      public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = Entry;
+        using difference_type = std::ptrdiff_t;
+        using pointer = E *;
+        using reference = E &;
+
+        basic_iterator(E *entry, E *end) : _entry(entry), _end(end)
+        {
+            skip_empty();
+        }
+
+        reference operator*() const
+        {
+            return *_entry;
+        }
+
+        pointer operator->() const
+        {
+            return _entry;
+        }
+
+        basic_iterator &operator++()
+        {
+            ++_entry;
+            skip_empty();
+            return *this;
+        }
+
+        bool operator==(const basic_iterator &other) const
+        {
+            return _entry == other._entry;
+        }
+
+        bool operator!=(const basic_iterator &other) const
+        {
+            return _entry != other._entry;
+        }
+
+      private:
+        void skip_empty()
+        {
+            while (_entry != _end && _entry->first == EMPTY)
+                ++_entry;
+        }
+
+        E *_entry;
+        E *_end;
+    };
+
+    using iterator = basic_iterator<Entry>;
+    using const_iterator = basic_iterator<const Entry>;
+
+    bool has(unsigned int id) const
+    {
+        return id < _entries.size() && _entries[id].first != EMPTY;
+    }
+
+    // Returns nullptr when no value is stored for id.
+    T *find(unsigned int id)
+    {
+        return has(id) ? &_entries[id].second : nullptr;
+    }
+
+    const T *find(unsigned int id) const
+    {
+        return has(id) ? &_entries[id].second : nullptr;
+    }
+
+    // Inserts a default constructed value when id is not stored yet.
+    T &operator[](unsigned int id)
+    {
+        if (id >= _entries.size())
+            _entries.resize(id + 1, Entry{EMPTY, T{}});
+
+        Entry &entry = _entries[id];
+        if (entry.first == EMPTY)
+        {
+            entry.first = id;
+            _count++;
+        }
+        return entry.second;
+    }
+
+    void insert(unsigned int id, T value)
+    {
+        (*this)[id] = std::move(value);
+    }
+
+    bool erase(unsigned int id)
+    {
+        if (!has(id))
+            return false;
+
+        _entries[id] = Entry{EMPTY, T{}};
+        _count--;
+
+        // Keeps iteration bounded by the highest id in use.
+        while (!_entries.empty() && _entries.back().first == EMPTY)
+            _entries.pop_back();
+        return true;
+    }
+
+    // Makes room for ids below id_bound, so inserting them does not reallocate.
+    void reserve(unsigned int id_bound)
+    {
+        _entries.reserve(id_bound);
+    }
+
+    void clear()
+    {
+        _entries.clear();
+        _count = 0;
+    }
+
+    size_t size() const
+    {
+        return _count;
+    }
+
+    bool empty() const
+    {
+        return _count == 0;
+    }
+
+    // One past the highest id in use.
+    unsigned int id_bound() const
+    {
+        return static_cast<unsigned int>(_entries.size());
+    }
+
+    iterator begin()
+    {
+        return iterator(_entries.data(), _entries.data() + _entries.size());
+    }
+
+    iterator end()
+    {
+        return iterator(_entries.data() + _entries.size(), _entries.data() + _entries.size());
+    }
+
+    const_iterator begin() const
+    {
+        return const_iterator(_entries.data(), _entries.data() + _entries.size());
+    }
+
+    const_iterator end() const
+    {
+        return const_iterator(_entries.data() + _entries.size(), _entries.data() + _entries.size());
+    }
+
+  private:
+    std::vector<Entry> _entries;
+    size_t _count = 0;
+};
+
+#endif // METALCPP_SRC_ID_TABLE_HPP
@@ -0,0 +1,251 @@
+#ifndef METALCPP_SRC_INSTANCE_BVH_HPP
+#define METALCPP_SRC_INSTANCE_BVH_HPP
+
+#import <Metal/Metal.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <vector>
+
+#include "gpu_primitives.hpp"
+#include "pipeline_cache.hpp"
+#include "retired_resources.hpp"
+#include "structs.h"
+#include "upload_ring.hpp"
+
+// Views with fewer instance slots are culled one slot per thread, which costs less than building and walking a tree.
+constexpr unsigned int INSTANCE_BVH_MIN_SLOTS = 16384;
+// Transformed instance ranges kept for the next refit, more refit every slot.
+constexpr size_t INSTANCE_BVH_MAX_CHANGES = 4096;
+
+// Tree over the instance slots of the culled draws, see InstanceBvhNode. It is built on the GPU when the draws change
+// and refit where instances moved otherwise, which binds the clusters of the moved slots again and then every internal
+// node from its clusters. Refits loosen the tree, once they moved as many slots as it has it is built again.
+class InstanceBvh
+{
+  public:
+    void create(id<MTLDevice> device, id<MTLLibrary> library, PipelineCache &pipelines, RetiredResources &retired)
+    {
+        _device = device;
+        _retired = &retired;
+        pipelines.create([library newFunctionWithName:@"reset_instance_bvh"], &_reset_state);
+        pipelines.create([library newFunctionWithName:@"bound_instance_bvh_centers"], &_centers_state);
+        pipelines.create([library newFunctionWithName:@"instance_bvh_keys"], &_keys_state);
+        pipelines.create([library newFunctionWithName:@"build_instance_bvh"], &_build_state);
+        pipelines.create([library newFunctionWithName:@"mark_instance_bvh_moved"], &_mark_state);
+        pipelines.create([library newFunctionWithName:@"bound_instance_bvh_clusters"], &_clusters_state);
+        pipelines.create([library newFunctionWithName:@"bound_instance_bvh_nodes"], &_nodes_state);
+        pipelines.create([library newFunctionWithName:@"traverse_instance_bvh"], &_traverse_state);
+    }
+
+    void release()
+    {
+        _reset_state = nil;
+        _centers_state = nil;
+        _keys_state = nil;
+        _build_state = nil;
+        _mark_state = nil;
+        _clusters_state = nil;
+        _nodes_state = nil;
+        _traverse_state = nil;
+        _keys = nil;
+        _positions = nil;
+        _nodes = nil;
+        _queues = nil;
+        _clusters = nil;
+        _refit = nil;
+        _dirty = nil;
+        _counters = nil;
+        _draws.clear();
+        _num_slots = 0;
+        _active = false;
+    }
+
+    // Whether the culling of this frame walks the tree, as encode_update decided for its draws.
+    bool active() const
+    {
+        return _active;
+    }
+
+    size_t allocated_size() const
+    {
+        size_t size = 0;
+        for (id<MTLBuffer> buffer : {_keys, _positions, _nodes, _queues, _clusters, _refit, _dirty, _counters})
+            size += buffer != nil ? buffer.allocatedSize : 0;
+        return size;
+    }
+
+    // Brings the tree up to date with the num_slots slots of cull_draws, uploaded at draws, and with instances. The
+    // slots in moved are refit, all of them with refit_all. Encoded before any culling of the frame walks the tree.
+    void encode_update(id<MTLComputeCommandEncoder> encoder, GpuPrimitives &primitives, UploadRing &ring,
+                       id<MTLBuffer> instances, const UploadAllocation &draws,
+                       const std::vector<CullDraw> &cull_draws, unsigned int num_slots,
+                       const std::vector<unsigned int> &moved, bool refit_all)
+    {
+        _active = num_slots >= INSTANCE_BVH_MIN_SLOTS;
+        if (!_active)
+            return;
+
+        const unsigned int num_clusters = (num_slots + INSTANCE_BVH_CLUSTER_SIZE - 1) / INSTANCE_BVH_CLUSTER_SIZE;
+        const bool rebuild = num_slots != _num_slots || cull_draws.size() != _draws.size() ||
+                             std::memcmp(cull_draws.data(), _draws.data(), _draws.size() * sizeof(CullDraw)) != 0 ||
+                             _refit_slots >= num_slots;
+        if (!rebuild && moved.empty() && !refit_all)
+            return;
+
+        if (rebuild)
+        {
+            reserve(num_slots, num_clusters);
+            _draws = cull_draws;
+            _num_slots = num_slots;
+            _refit_slots = 0;
+        }
+        else
+        {
+            _refit_slots += refit_all ? num_slots : static_cast<unsigned int>(moved.size());
+        }
+
+        InstanceBvhUniforms uniforms = {};
+        uniforms.num_slots = num_slots;
+        uniforms.num_clusters = num_clusters;
+        uniforms.num_draws = static_cast<unsigned int>(cull_draws.size());
+        const auto bind = [&]() {
+            [encoder setBuffer:instances offset:0 atIndex:0];
+            [encoder setBuffer:draws.buffer offset:draws.offset atIndex:1];
+            [encoder setBuffer:_keys offset:0 atIndex:2];
+            [encoder setBuffer:_nodes offset:0 atIndex:3];
+            [encoder setBuffer:_counters offset:0 atIndex:4];
+            [encoder setBytes:&uniforms length:sizeof(uniforms) atIndex:5];
+            [encoder setBuffer:_positions offset:0 atIndex:6];
+            [encoder setBuffer:_refit offset:0 atIndex:7];
+            [encoder setBuffer:_dirty offset:0 atIndex:8];
+        };
+        bind();
+        dispatch_threads(encoder, _reset_state, 1);
+
+        if (rebuild)
+        {
+            dispatch_threads(encoder, _centers_state, num_slots);
+            dispatch_threads(encoder, _keys_state, num_slots);
+            // Codes have 30 bits, the radix sort rebinds every buffer it uses.
+            primitives.encode_sort(encoder, _keys, 0, num_slots, 30, false);
+            bind();
+            dispatch_threads(encoder, _build_state, num_clusters - 1);
+        }
+        else if (!refit_all)
+        {
+            uniforms.listed = 1;
+            uniforms.num_moved = static_cast<unsigned int>(moved.size());
+            const UploadAllocation list = ring.upload(moved.data(), moved.size());
+            [encoder setBytes:&uniforms length:sizeof(uniforms) atIndex:5];
+            [encoder setBuffer:list.buffer offset:list.offset atIndex:9];
+            dispatch_threads(encoder, _mark_state, uniforms.num_moved);
+        }
+
+        // One SIMD group per cluster and per internal node.
+        [encoder setComputePipelineState:_clusters_state];
+        const MTLSize cluster_group = MTLSizeMake(_clusters_state.threadExecutionWidth, 1, 1);
+        if (uniforms.listed != 0)
+            [encoder dispatchThreadgroupsWithIndirectBuffer:_counters
+                                       indirectBufferOffset:offsetof(InstanceBvhCounters, refit)
+                                      threadsPerThreadgroup:cluster_group];
+        else
+            [encoder dispatchThreadgroups:MTLSizeMake(num_clusters, 1, 1) threadsPerThreadgroup:cluster_group];
+        if (num_clusters > 1)
+        {
+            [encoder setComputePipelineState:_nodes_state];
+            [encoder dispatchThreadgroups:MTLSizeMake(num_clusters - 1, 1, 1)
+                    threadsPerThreadgroup:MTLSizeMake(_nodes_state.threadExecutionWidth, 1, 1)];
+        }
+    }
+
+    // Walks the tree for the view of uniforms, which the caller bound at index 1, and dispatches state, a culling
+    // kernel like cull_bvh_instances, for the clusters it reached. The other buffers state reads are bound by the
+    // caller.
+    void encode_culling(id<MTLComputeCommandEncoder> encoder, id<MTLComputePipelineState> state)
+    {
+        InstanceBvhUniforms uniforms = {};
+        uniforms.num_slots = _num_slots;
+        uniforms.num_clusters = (_num_slots + INSTANCE_BVH_CLUSTER_SIZE - 1) / INSTANCE_BVH_CLUSTER_SIZE;
+        uniforms.num_draws = static_cast<unsigned int>(_draws.size());
+        [encoder setComputePipelineState:_traverse_state];
+        [encoder setBuffer:_clusters offset:0 atIndex:7];
+        [encoder setBuffer:_nodes offset:0 atIndex:8];
+        [encoder setBuffer:_counters offset:0 atIndex:9];
+        [encoder setBytes:&uniforms length:sizeof(uniforms) atIndex:10];
+        [encoder setBuffer:_queues offset:0 atIndex:11];
+        const NSUInteger threads =
+            std::min<NSUInteger>(_traverse_state.maxTotalThreadsPerThreadgroup, INSTANCE_BVH_GROUP_SIZE);
+        [encoder dispatchThreadgroups:MTLSizeMake(1, 1, 1) threadsPerThreadgroup:MTLSizeMake(threads, 1, 1)];
+
+        [encoder setComputePipelineState:state];
+        [encoder setBuffer:_keys offset:0 atIndex:8];
+        [encoder dispatchThreadgroupsWithIndirectBuffer:_counters
+                                   indirectBufferOffset:offsetof(InstanceBvhCounters, visible)
+                                  threadsPerThreadgroup:MTLSizeMake(INSTANCE_BVH_CLUSTER_SIZE, 1, 1)];
+    }
+
+  private:
+    void reserve(unsigned int num_slots, unsigned int num_clusters)
+    {
+        const auto ensure = [&](__strong id<MTLBuffer> *buffer, NSUInteger length, NSString *label) {
+            if (*buffer != nil && (*buffer).length >= length)
+                return;
+            _retired->retire(*buffer);
+            *buffer = [_device newBufferWithLength:std::max<NSUInteger>(length, (*buffer).length * 3 / 2)
+                                           options:MTLResourceStorageModePrivate];
+            (*buffer).label = label;
+        };
+        ensure(&_keys, NSUInteger(num_slots) * 2 * sizeof(unsigned int), @"InstanceBvhKeys");
+        ensure(&_positions, NSUInteger(num_slots) * sizeof(unsigned int), @"InstanceBvhPositions");
+        ensure(&_nodes, NSUInteger(2 * num_clusters - 1) * sizeof(InstanceBvhNode), @"InstanceBvhNodes");
+        ensure(&_queues, NSUInteger(num_clusters) * 2 * sizeof(unsigned int), @"InstanceBvhQueues");
+        ensure(&_clusters, NSUInteger(num_clusters) * sizeof(unsigned int), @"InstanceBvhClusters");
+        ensure(&_refit, NSUInteger(num_clusters) * sizeof(unsigned int), @"InstanceBvhRefit");
+        ensure(&_dirty, NSUInteger(num_clusters) * sizeof(unsigned int), @"InstanceBvhDirty");
+        ensure(&_counters, sizeof(InstanceBvhCounters), @"InstanceBvhCounters");
+    }
+
+    static void dispatch_threads(id<MTLComputeCommandEncoder> encoder, id<MTLComputePipelineState> state,
+                                 unsigned int threads)
+    {
+        if (threads == 0)
+            return;
+        const NSUInteger group_size = std::min<NSUInteger>(state.maxTotalThreadsPerThreadgroup, 256);
+        [encoder setComputePipelineState:state];
+        [encoder dispatchThreadgroups:MTLSizeMake((threads + group_size - 1) / group_size, 1, 1)
+                threadsPerThreadgroup:MTLSizeMake(group_size, 1, 1)];
+    }
+
+    id<MTLDevice> _device = nil;
+    RetiredResources *_retired = nullptr;
+
+    id<MTLComputePipelineState> _reset_state = nil;
+    id<MTLComputePipelineState> _centers_state = nil;
+    id<MTLComputePipelineState> _keys_state = nil;
+    id<MTLComputePipelineState> _build_state = nil;
+    id<MTLComputePipelineState> _mark_state = nil;
+    id<MTLComputePipelineState> _clusters_state = nil;
+    id<MTLComputePipelineState> _nodes_state = nil;
+    id<MTLComputePipelineState> _traverse_state = nil;
+
+    // Sorted Morton codes with their slots, the sorted position of every slot and the nodes, internal ones first.
+    id<MTLBuffer> _keys = nil;
+    id<MTLBuffer> _positions = nil;
+    id<MTLBuffer> _nodes = nil;
+    // Both node queues of the traversal, the clusters it reached, and the clusters listed for refitting.
+    id<MTLBuffer> _queues = nil;
+    id<MTLBuffer> _clusters = nil;
+    id<MTLBuffer> _refit = nil;
+    id<MTLBuffer> _dirty = nil;
+    id<MTLBuffer> _counters = nil;
+
+    // Draws the tree was built for, and the slots refit since.
+    std::vector<CullDraw> _draws;
+    unsigned int _num_slots = 0;
+    unsigned int _refit_slots = 0;
+    bool _active = false;
+};
+
+#endif // METALCPP_SRC_INSTANCE_BVH_HPP
@@ -6,11 +6,44 @@
 #define METALCPP_SRC_INSTANCE_LIST_H
 
 #include "buffer.hpp"
+#include "id_table.hpp"
+#include "range_allocator.hpp"
+#include "signposts.hpp"
+#include "structs.h"
 #include "utils.hpp"
 
 #import <Metal/Metal.h>
 
+#include <algorithm>
+#include <cstring>
 #include <map>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+// Copies count instances into the layout G the GPU reads them in.
+template <typename T, typename G> inline void store_instances(G *dst, const T *src, size_t count)
+{
+    static_assert(std::is_same<T, G>::value, "instances of another layout need a conversion");
+    memcpy(dst, src, count * sizeof(T));
+}
+
+// 3D instance transforms are affine, only the first three rows are stored. glm matrices are not 16 byte aligned, the
+// memcpy becomes unaligned vector loads and the transpose a few zip instructions.
+inline void store_instances(InstanceTransform *dst, const glm::mat4 *src, size_t count)
+{
+    for (size_t i = 0; i < count; i++)
+    {
+        simd_float4x4 m;
+        memcpy(&m, &src[i], sizeof(m));
+        const simd_float4x4 rows = simd_transpose(m);
+        dst[i].rows[0] = rows.columns[0];
+        dst[i].rows[1] = rows.columns[1];
+        dst[i].rows[2] = rows.columns[2];
+    }
+}
 
 template <typename T> struct InstanceRange
 {
@@ -21,108 +54,469 @@ template <typename T> struct InstanceRange
     unsigned int capacity;
 };
 
-template <typename T> class InstanceList
+// Instances are kept as T on the CPU and stored as G in the buffers the GPU reads, Allocator decides where those live.
+template <typename T, typename G = T, typename Allocator = MetalAllocator> class InstanceList
 {
   public:
-    InstanceList(id<MTLDevice> device)
-        : _buffer(std::make_unique<Buffer<T>>(device, 2048)), _total(0), _recalculate_ranges(true)
+    template <typename U> using Buffer = typename Allocator::template Buffer<U>;
+
+    // Frames with more pending changes than this get a full copy instead.
+    static constexpr size_t MAX_PENDING_CHANGES = 4096;
+
+    InstanceList(id<MTLDevice> device, unsigned int frames_in_flight = 1)
+        : _total(0), _layout_version(0), _recalculate_ranges(true)
     {
+        set_frames_in_flight(device, frames_in_flight);
+    }
+
+    // Every frame in flight owns a copy of the instance buffer, frame N+1 can be written while the GPU reads frame N.
+    void set_frames_in_flight(id<MTLDevice> device, unsigned int frames_in_flight)
+    {
+        const size_t count = _buffers.empty() ? 2048 : _buffers[0]->size();
+
+        _buffers.clear();
+        for (unsigned int i = 0; i < frames_in_flight; i++)
+            _buffers.emplace_back(std::make_unique<Buffer<G>>(device, count, cpu_write_storage(device)));
+
+        _frame_changes.assign(frames_in_flight, {});
+        _frame_full_copy.assign(frames_in_flight, true);
     }
 
     bool has(unsigned int id) const
     {
-        return _lists.find(id) != _lists.end();
+        return _lists.has(id);
+    }
+
+    void reserve(unsigned int id_bound)
+    {
+        _lists.reserve(id_bound);
     }
 
     void add_instances_list(unsigned int id, const T *ptr, unsigned int count)
     {
+        remove_instances_list(id);
+
         InstanceRange<T> desc = {};
         desc.ptr = ptr;
-        desc.start = 0;
-        desc.end = 0;
         desc.count = count;
-        desc.capacity = next_multiple_of(count, 128);
-
-        _lists.insert({id, desc});
+        desc.capacity = size_class(count);
+        place(id, desc);
+        _lists.insert(id, desc);
     }
 
     void update_instances_list(unsigned int id, const T *ptr, unsigned int count)
     {
-        auto it = _lists.find(id);
-        if (it == _lists.end())
+        InstanceRange<T> *desc = _lists.find(id);
+        if (!desc || _owners.has(id))
             return;
 
-        if (count > it->second.capacity)
-            _recalculate_ranges = true;
+        // Only this list moves when it outgrows its range, it grows geometrically so it rarely moves again.
+        desc->ptr = ptr;
+        desc->count = count;
+        if (count > desc->capacity)
+        {
+            release(*desc);
+            desc->capacity = size_class(std::max(count, desc->capacity + desc->capacity / 2));
+            place(id, *desc);
+            update_aliases(id, *desc);
+            return;
+        }
+
+        desc->end = desc->start + count;
+        _pending.push_back({id, 0, count});
+        update_aliases(id, *desc);
+    }
+
+    // Makes list id draw the instances of list owner. It keeps no range of its own and follows the range of its owner
+    // wherever that moves, the instances are stored and copied once. Aliases are removed with their owner.
+    void alias_instances_list(unsigned int id, unsigned int owner)
+    {
+        remove_instances_list(id);
+        const InstanceRange<T> *desc = _lists.find(owner);
+        if (!desc || id == owner || _owners.has(owner))
+            return;
+
+        InstanceRange<T> alias = *desc;
+        alias.capacity = 0;
+        _lists.insert(id, alias);
+        _owners.insert(id, owner);
+        _aliases[owner].push_back(id);
+        _layout_version++;
+    }
 
-        it->second.ptr = ptr;
-        it->second.count = count;
-        it->second.capacity = next_multiple_of(count, 128);
+    // Marks instances [first, last) of a list as changed, only those get copied when the frames are updated.
+    void mark_changed(unsigned int id, unsigned int first, unsigned int last)
+    {
+        if (const unsigned int *owner = _owners.find(id))
+            id = *owner;
+        if (first < last)
+            _pending.push_back({id, first, last});
     }
 
     bool remove_instances_list(unsigned int id)
     {
-        auto it = _lists.find(id);
-        if (it != _lists.end())
+        if (const unsigned int *owner = _owners.find(id))
         {
-            _lists.erase(it);
-            return true;
+            std::vector<unsigned int> &aliases = *_aliases.find(*owner);
+            aliases.erase(std::find(aliases.begin(), aliases.end(), id));
+            if (aliases.empty())
+                _aliases.erase(*owner);
+            _owners.erase(id);
+            _layout_version++;
         }
+        else if (const InstanceRange<T> *desc = _lists.find(id))
+            release(*desc);
 
-        return false;
+        if (const std::vector<unsigned int> *aliases = _aliases.find(id))
+        {
+            for (const unsigned int alias : *aliases)
+            {
+                _lists.erase(alias);
+                _owners.erase(alias);
+            }
+            _aliases.erase(id);
+        }
+        return _lists.erase(id);
     }
 
-    id<MTLBuffer> buffer()
+    id<MTLBuffer> buffer(unsigned int frame) const
     {
-        return _buffer->buffer();
+        return _buffers[frame]->buffer();
     }
 
+    // Lists keep their range until they outgrow it or are removed, placed lists are copied as changes. Every frame
+    // owns its buffer, so ranges freed here are reused right away.
     void update_ranges()
     {
         if (!_recalculate_ranges)
             return;
 
-        unsigned int current_offset = 0;
-        for (auto &[id, desc] : _lists)
+        _total = _allocator.end();
+        _recalculate_ranges = false;
+    }
+
+    // Hands the changes made since the last call to every frame, each frame's buffer applies them once that frame is
+    // prepared.
+    void update_data()
+    {
+        const os_signpost_id_t signpost = signpost_id();
+        os_signpost_interval_begin(signpost_log(), signpost, "InstanceList::update_data", "%zu changes",
+                                   _pending.size());
+        for (size_t i = 0; i < _buffers.size(); i++)
         {
-            desc.start = current_offset;
-            desc.end = desc.start + desc.count;
-            current_offset += desc.capacity;
+            if (_frame_full_copy[i])
+                continue;
+
+            std::vector<Change> &changes = _frame_changes[i];
+            if (changes.size() + _pending.size() > MAX_PENDING_CHANGES)
+            {
+                changes.clear();
+                _frame_full_copy[i] = true;
+                continue;
+            }
+
+            changes.insert(changes.end(), _pending.begin(), _pending.end());
         }
 
-        _total = current_offset;
-        _recalculate_ranges = false;
+        _pending.clear();
+        os_signpost_interval_end(signpost_log(), signpost, "InstanceList::update_data");
     }
 
-    void update_data(id<MTLDevice> device)
+    // Copies the changed instance data into the buffer of the given frame. Must only be called once the GPU is done
+    // with this frame, returns whether the frame's MTLBuffer got replaced.
+    bool update_frame(id<MTLDevice> device, unsigned int frame)
     {
-        if (_total == 0)
-            return;
+        if (_total == 0 || (!_frame_full_copy[frame] && _frame_changes[frame].empty()))
+            return false;
 
-        if (_buffer->size() < _total)
+        const os_signpost_id_t signpost = signpost_id();
+        os_signpost_interval_begin(signpost_log(), signpost, "InstanceList::update_frame", "frame %u", frame);
+        bool reallocated = false;
+        std::unique_ptr<Buffer<G>> &buffer = _buffers[frame];
+        if (buffer->size() < _total)
         {
-            _buffer = std::make_unique<Buffer<T>>(device, next_multiple_of(_total, 512));
+            // Grow geometrically so lists that keep growing only rarely reach the driver allocator.
+            const size_t count = std::max(static_cast<size_t>(_total), buffer->size() + buffer->size() / 2);
+            buffer = std::make_unique<Buffer<G>>(device, next_multiple_of(static_cast<unsigned int>(count), 512),
+                                                 cpu_write_storage(device));
+            reallocated = true;
+            _frame_full_copy[frame] = true;
         }
 
-        std::byte *data = reinterpret_cast<std::byte *>(_buffer->data());
-        for (const auto &[id, desc] : _lists)
+        G *data = reinterpret_cast<G *>(buffer->data());
+        std::vector<Change> &changes = _frame_changes[frame];
+        std::vector<Store> stores;
+        if (_frame_full_copy[frame])
+        {
+            size_t copied = 0;
+            stores.reserve(_lists.size());
+            for (const auto &[id, desc] : _lists)
+            {
+                if (desc.capacity == 0)
+                    continue;
+                stores.push_back({data + desc.start, desc.ptr, desc.count});
+                copied += desc.count * sizeof(G);
+            }
+            store(stores);
+
+            buffer->update();
+            _frame_full_copy[frame] = false;
+            changes.clear();
+            os_signpost_interval_end(signpost_log(), signpost, "InstanceList::update_frame", "%zu bytes copied",
+                                     copied);
+            return reallocated;
+        }
+
+        // Scatter the changed instances into the persistent buffer and only flush the ranges that were written.
+        std::vector<DirtyRange> modified;
+        modified.reserve(changes.size());
+        size_t copied = 0;
+        for (const Change &change : changes)
         {
-            memcpy(data + (desc.start * sizeof(T)), desc.ptr, desc.count * sizeof(T));
+            const InstanceRange<T> *desc = _lists.find(change.id);
+            if (!desc)
+                continue;
+
+            const unsigned int last = std::min(change.last, desc->count);
+            if (change.first >= last)
+                continue;
+
+            stores.push_back({data + desc->start + change.first, desc->ptr + change.first, last - change.first});
+            copied += (last - change.first) * sizeof(G);
+            modified.push_back({desc->start + change.first, desc->start + last});
         }
+        changes.clear();
+        store(stores);
+
+        for (const DirtyRange &range : coalesce(std::move(modified), 0))
+            buffer->update(range.start, range.end);
 
-        _buffer->update();
+        os_signpost_interval_end(signpost_log(), signpost, "InstanceList::update_frame", "%zu bytes copied", copied);
+        return reallocated;
     }
 
-    const std::map<unsigned int, InstanceRange<T>> &get_ranges() const
+    const IdTable<InstanceRange<T>> &get_ranges() const
     {
         return _lists;
     }
 
+    // Number of instance slots, including the spare capacity of every list and the holes between them.
+    unsigned int total() const
+    {
+        return _total;
+    }
+
+    // Changes whenever a list gets a new range, instances keep their index while it is the same.
+    unsigned int layout_version() const
+    {
+        return _layout_version;
+    }
+
+    // Ids of the lists by their first instance, aliases share the entry of their owner.
+    const std::map<unsigned int, unsigned int> &lists_by_offset() const
+    {
+        return _list_by_offset;
+    }
+
+    // Bytes of the instance buffers that hold no instance, the spare capacity of lists, holes left by removed ones
+    // and the room buffers grew by.
+    size_t unused_bytes() const
+    {
+        size_t used = 0;
+        for (const auto &[id, desc] : _lists)
+            used += desc.capacity > 0 ? desc.count : 0;
+
+        size_t unused = 0;
+        for (const std::unique_ptr<Buffer<G>> &buffer : _buffers)
+            unused += buffer->size() > used ? buffer->size() - used : 0;
+        return unused * sizeof(G);
+    }
+
+    // Holes between the ranges of lists.
+    size_t holes() const
+    {
+        const unsigned int tail = _allocator.capacity() - _allocator.end();
+        return _allocator.free_block_count() - (tail > 0 ? 1 : 0);
+    }
+
   private:
-    std::unique_ptr<Buffer<T>> _buffer;
-    std::map<unsigned int, InstanceRange<T>> _lists;
+    struct Change
+    {
+        unsigned int id;
+        unsigned int first;
+        unsigned int last;
+    };
+
+    struct Store
+    {
+        G *dst;
+        const T *src;
+        size_t count;
+    };
+
+    // Small lists are packed tightly. Larger ones round up to a quarter of their power of two at most, so the holes
+    // removed lists leave fit lists of a similar size.
+    static unsigned int size_class(unsigned int count)
+    {
+        if (count <= 16)
+            return count;
+
+        unsigned int step = 1;
+        while (step * 8 < count)
+            step <<= 1;
+        return next_multiple_of(count, step);
+    }
+
+    // Gives a list a range, growing the allocator geometrically when no hole is large enough. The whole list gets
+    // copied into it.
+    void place(unsigned int id, InstanceRange<T> &desc)
+    {
+        desc.start = 0;
+        if (desc.capacity > 0)
+        {
+            desc.start = _allocator.allocate(desc.capacity);
+            if (desc.start == RangeAllocator::INVALID)
+            {
+                const unsigned int capacity = _allocator.capacity();
+                _allocator.grow(next_multiple_of(std::max(capacity + capacity / 2, capacity + desc.capacity), 512));
+                desc.start = _allocator.allocate(desc.capacity);
+            }
+            _list_by_offset[desc.start] = id;
+        }
+
+        desc.end = desc.start + desc.count;
+        _pending.push_back({id, 0, desc.count});
+        _layout_version++;
+        _recalculate_ranges = true;
+    }
+
+    void update_aliases(unsigned int owner, const InstanceRange<T> &desc)
+    {
+        const std::vector<unsigned int> *aliases = _aliases.find(owner);
+        if (!aliases)
+            return;
+
+        for (const unsigned int alias : *aliases)
+        {
+            InstanceRange<T> &range = *_lists.find(alias);
+            range = desc;
+            range.capacity = 0;
+        }
+    }
+
+    void release(const InstanceRange<T> &desc)
+    {
+        if (desc.capacity == 0)
+            return;
+
+        _allocator.free(desc.start);
+        _list_by_offset.erase(desc.start);
+        _recalculate_ranges = true;
+    }
+
+    // Stores are split and batched by size, every piece writes its own part of the buffer.
+    static void store(const std::vector<Store> &stores)
+    {
+        constexpr size_t grain = std::max(size_t(1), size_t(256 * 1024) / sizeof(G));
+        std::vector<size_t> sizes(stores.size());
+        for (size_t i = 0; i < stores.size(); i++)
+            sizes[i] = stores[i].count;
+
+        parallel_ranges(sizes, grain, [&stores](const WorkPiece &piece) {
+            const Store &s = stores[piece.range];
+            store_instances(s.dst + piece.first, s.src + piece.first, piece.count);
+        });
+    }
+
+    std::vector<std::unique_ptr<Buffer<G>>> _buffers;
+    IdTable<InstanceRange<T>> _lists;
+    RangeAllocator _allocator;
+    std::map<unsigned int, unsigned int> _list_by_offset;
+    // Owner of every alias and the aliases of every owner.
+    IdTable<unsigned int> _owners;
+    IdTable<std::vector<unsigned int>> _aliases;
+    // Changes made since the last update_data() and changes each frame still has to apply.
+    std::vector<Change> _pending;
+    std::vector<std::vector<Change>> _frame_changes;
+    std::vector<bool> _frame_full_copy;
     unsigned int _total;
+    unsigned int _layout_version;
     bool _recalculate_ranges;
 };
 
+// Replaces list id with a copy of count instances. A list with as many instances as before keeps its storage and only
+// the instances from the first to the last one that differ are uploaded. Returns whether anything changed.
+template <typename T, typename Allocator>
+inline bool set_copied_instances(InstanceList<T, T, Allocator> &list, IdTable<std::vector<T>> &copies, unsigned int id,
+                                 const T *instances, unsigned int count)
+{
+    if (!instances)
+        count = 0;
+
+    std::vector<T> &copy = copies[id];
+    if (list.has(id) && copy.size() == count)
+    {
+        unsigned int first = 0;
+        while (first < count && memcmp(&copy[first], &instances[first], sizeof(T)) == 0)
+            first++;
+        unsigned int last = count;
+        while (last > first && memcmp(&copy[last - 1], &instances[last - 1], sizeof(T)) == 0)
+            last--;
+        if (first == last)
+            return false;
+
+        std::copy(instances + first, instances + last, copy.begin() + first);
+        list.mark_changed(id, first, last);
+        return true;
+    }
+
+    copy.assign(instances, instances + count);
+    if (list.has(id))
+        list.update_instances_list(id, copy.data(), count);
+    else
+        list.add_instances_list(id, copy.data(), count);
+    return true;
+}
+
+// Snapshot of the slots the lists of an instance list occupy, so slots written by the GPU can be resolved to a list and
+// an instance after the list changed.
+class InstanceSlots
+{
+  public:
+    InstanceSlots() = default;
+
+    template <typename List> explicit InstanceSlots(const List &instances)
+    {
+        const auto &ranges = instances.get_ranges();
+        for (const auto &[start, id] : instances.lists_by_offset())
+            _lists.push_back({start, ranges.find(id)->count, id});
+    }
+
+    // Returns whether slot is a live instance, setting the id of its list and its index in it.
+    bool resolve(unsigned int slot, unsigned int *id, unsigned int *instance) const
+    {
+        const auto list = std::upper_bound(_lists.begin(), _lists.end(), slot,
+                                           [](unsigned int s, const List &l) { return s < l.start; });
+        if (list == _lists.begin() || slot - (list - 1)->start >= (list - 1)->count)
+            return false;
+        *id = (list - 1)->id;
+        *instance = slot - (list - 1)->start;
+        return true;
+    }
+
+    bool empty() const
+    {
+        return _lists.empty();
+    }
+
+  private:
+    struct List
+    {
+        unsigned int start;
+        unsigned int count;
+        unsigned int id;
+    };
+    std::vector<List> _lists;
+};
+
 #endif // METALCPP_SRC_INSTANCE_LIST_H
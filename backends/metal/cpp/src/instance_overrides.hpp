@@ -0,0 +1,157 @@
+#ifndef METALCPP_SRC_INSTANCE_OVERRIDES_HPP
+#define METALCPP_SRC_INSTANCE_OVERRIDES_HPP
+
+#include "buffer.hpp"
+#include "id_table.hpp"
+#include "structs.h"
+#include "utils.hpp"
+
+#import <Metal/Metal.h>
+
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+// Per instance tint and material overrides of 3D instance lists. Overrides follow the slots of the instance list, the
+// first element of every buffer is a header holding the number of slots that follow it. Instances beyond it, or all
+// of them while no list has overrides, keep their mesh's look.
+class InstanceOverrides
+{
+  public:
+    InstanceOverrides(id<MTLDevice> device, unsigned int frames_in_flight = 1)
+    {
+        set_frames_in_flight(device, frames_in_flight);
+    }
+
+    void set_frames_in_flight(id<MTLDevice> device, unsigned int frames_in_flight)
+    {
+        _buffers.clear();
+        for (unsigned int i = 0; i < frames_in_flight; i++)
+        {
+            _buffers.emplace_back(std::make_unique<Buffer<InstanceOverride>>(device, 1, cpu_write_storage(device)));
+            write_header(*_buffers.back(), 0);
+        }
+
+        _frame_changes.assign(frames_in_flight, {});
+        _frame_layout.assign(frames_in_flight, INVALID_LAYOUT);
+    }
+
+    // Overrides of the first count instances of list id, the remaining instances get the default override.
+    void set(unsigned int id, const InstanceOverride *overrides, unsigned int count)
+    {
+        if (count == 0)
+        {
+            erase(id);
+            return;
+        }
+
+        _overrides.insert(id, std::vector<InstanceOverride>(overrides, overrides + count));
+        for (std::vector<unsigned int> &changes : _frame_changes)
+            changes.push_back(id);
+    }
+
+    // Removed overrides are reset by rewriting the whole buffer, this is rare.
+    void erase(unsigned int id)
+    {
+        if (_overrides.erase(id))
+            std::fill(_frame_layout.begin(), _frame_layout.end(), INVALID_LAYOUT);
+    }
+
+    // Writes the overrides into the buffer of the given frame, laid out like the instances of that frame. Must only be
+    // called once the GPU is done with this frame, returns whether the frame's MTLBuffer got replaced.
+    template <typename List> bool update_frame(id<MTLDevice> device, unsigned int frame, const List &instances)
+    {
+        std::unique_ptr<Buffer<InstanceOverride>> &buffer = _buffers[frame];
+        std::vector<unsigned int> &changes = _frame_changes[frame];
+        const unsigned int total = _overrides.empty() ? 0 : instances.total();
+        bool reallocated = false;
+        if (buffer->size() < total + 1)
+        {
+            const size_t count = std::max(static_cast<size_t>(total + 1), buffer->size() + buffer->size() / 2);
+            buffer = std::make_unique<Buffer<InstanceOverride>>(
+                device, next_multiple_of(static_cast<unsigned int>(count), 512), cpu_write_storage(device));
+            reallocated = true;
+            _frame_layout[frame] = INVALID_LAYOUT;
+        }
+
+        // Instances only keep their slot while the layout of the list stays the same.
+        const unsigned int layout = total == 0 ? EMPTY_LAYOUT : instances.layout_version();
+        if (_frame_layout[frame] != layout)
+        {
+            InstanceOverride *data = reinterpret_cast<InstanceOverride *>(buffer->data());
+            std::fill(data + 1, data + 1 + total, default_override());
+            for (const auto &[id, overrides] : _overrides)
+                write_list(*buffer, instances, id, false);
+            write_header(*buffer, total);
+            buffer->update(0, total + 1);
+
+            _frame_layout[frame] = layout;
+            changes.clear();
+            return reallocated;
+        }
+
+        std::sort(changes.begin(), changes.end());
+        changes.erase(std::unique(changes.begin(), changes.end()), changes.end());
+        for (unsigned int id : changes)
+            write_list(*buffer, instances, id, true);
+        changes.clear();
+        return reallocated;
+    }
+
+    id<MTLBuffer> buffer(unsigned int frame) const
+    {
+        return _buffers[frame]->buffer();
+    }
+
+    size_t byte_size() const
+    {
+        size_t bytes = 0;
+        for (const std::unique_ptr<Buffer<InstanceOverride>> &buffer : _buffers)
+            bytes += buffer->byte_size();
+        return bytes;
+    }
+
+  private:
+    static constexpr unsigned int INVALID_LAYOUT = ~0u;
+    static constexpr unsigned int EMPTY_LAYOUT = ~0u - 1;
+
+    static InstanceOverride default_override()
+    {
+        InstanceOverride o = {};
+        o.tint = simd_make_float4(1.0f, 1.0f, 1.0f, 1.0f);
+        o.material = NO_MATERIAL_OVERRIDE;
+        return o;
+    }
+
+    static void write_header(Buffer<InstanceOverride> &buffer, unsigned int count)
+    {
+        InstanceOverride header = {};
+        header.material = count;
+        *reinterpret_cast<InstanceOverride *>(buffer.data()) = header;
+    }
+
+    // Overrides of list id go into the slots of its range, the rest of its capacity gets the default.
+    template <typename List>
+    void write_list(Buffer<InstanceOverride> &buffer, const List &instances, unsigned int id, bool flush) const
+    {
+        const std::vector<InstanceOverride> *overrides = _overrides.find(id);
+        const auto *desc = instances.get_ranges().find(id);
+        if (!overrides || !desc || desc->capacity == 0)
+            return;
+
+        InstanceOverride *data = reinterpret_cast<InstanceOverride *>(buffer.data()) + 1 + desc->start;
+        const unsigned int count = std::min(static_cast<unsigned int>(overrides->size()), desc->capacity);
+        std::copy(overrides->begin(), overrides->begin() + count, data);
+        std::fill(data + count, data + desc->capacity, default_override());
+        if (flush)
+            buffer.update(1 + desc->start, 1 + desc->start + desc->capacity);
+    }
+
+    std::vector<std::unique_ptr<Buffer<InstanceOverride>>> _buffers;
+    IdTable<std::vector<InstanceOverride>> _overrides;
+    // Lists whose overrides changed since each frame was written, and the instance layout each frame was written for.
+    std::vector<std::vector<unsigned int>> _frame_changes;
+    std::vector<unsigned int> _frame_layout;
+};
+
+#endif // METALCPP_SRC_INSTANCE_OVERRIDES_HPP
@@ -0,0 +1,207 @@
+#ifndef METALCPP_SRC_KTX2_HPP
+#define METALCPP_SRC_KTX2_HPP
+
+#import <Foundation/Foundation.h>
+#include <compression.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include "library.h"
+#include "texture_format.hpp"
+
+// Supercompression schemes of the KTX2 header, zlib is inflated with the Compression framework. Basis LZ and
+// Zstandard need decoders that are not part of the system and are not read.
+constexpr uint32_t KTX2_SUPERCOMPRESSION_NONE = 0;
+constexpr uint32_t KTX2_SUPERCOMPRESSION_ZLIB = 3;
+
+// DataFormat of a vkFormat, false for formats DataFormat lacks, which includes the undefined format of Basis
+// Universal payloads.
+inline bool ktx2_data_format(uint32_t vk_format, DataFormat *format)
+{
+    switch (vk_format)
+    {
+    case 9: // VK_FORMAT_R8_UNORM
+        *format = R8;
+        return true;
+    case 16: // VK_FORMAT_R8G8_UNORM
+        *format = RG8;
+        return true;
+    case 37: // VK_FORMAT_R8G8B8A8_UNORM
+        *format = RGBA8;
+        return true;
+    case 43: // VK_FORMAT_R8G8B8A8_SRGB
+        *format = RGBA8_SRGB;
+        return true;
+    case 44: // VK_FORMAT_B8G8R8A8_UNORM
+        *format = BGRA8;
+        return true;
+    case 50: // VK_FORMAT_B8G8R8A8_SRGB
+        *format = BGRA8_SRGB;
+        return true;
+    case 133: // VK_FORMAT_BC1_RGBA_UNORM_BLOCK
+        *format = BC1_RGBA;
+        return true;
+    case 134: // VK_FORMAT_BC1_RGBA_SRGB_BLOCK
+        *format = BC1_RGBA_SRGB;
+        return true;
+    case 135: // VK_FORMAT_BC2_UNORM_BLOCK
+        *format = BC2_RGBA;
+        return true;
+    case 136: // VK_FORMAT_BC2_SRGB_BLOCK
+        *format = BC2_RGBA_SRGB;
+        return true;
+    case 137: // VK_FORMAT_BC3_UNORM_BLOCK
+        *format = BC3_RGBA;
+        return true;
+    case 138: // VK_FORMAT_BC3_SRGB_BLOCK
+        *format = BC3_RGBA_SRGB;
+        return true;
+    case 139: // VK_FORMAT_BC4_UNORM_BLOCK
+        *format = BC4_R;
+        return true;
+    case 141: // VK_FORMAT_BC5_UNORM_BLOCK
+        *format = BC5_RG;
+        return true;
+    case 143: // VK_FORMAT_BC6H_UFLOAT_BLOCK
+        *format = BC6H_RGB_UFLOAT;
+        return true;
+    case 145: // VK_FORMAT_BC7_UNORM_BLOCK
+        *format = BC7_RGBA;
+        return true;
+    case 146: // VK_FORMAT_BC7_SRGB_BLOCK
+        *format = BC7_RGBA_SRGB;
+        return true;
+    case 157: // VK_FORMAT_ASTC_4x4_UNORM_BLOCK
+        *format = ASTC_4x4;
+        return true;
+    case 158: // VK_FORMAT_ASTC_4x4_SRGB_BLOCK
+        *format = ASTC_4x4_SRGB;
+        return true;
+    case 165: // VK_FORMAT_ASTC_6x6_UNORM_BLOCK
+        *format = ASTC_6x6;
+        return true;
+    case 166: // VK_FORMAT_ASTC_6x6_SRGB_BLOCK
+        *format = ASTC_6x6_SRGB;
+        return true;
+    case 171: // VK_FORMAT_ASTC_8x8_UNORM_BLOCK
+        *format = ASTC_8x8;
+        return true;
+    case 172: // VK_FORMAT_ASTC_8x8_SRGB_BLOCK
+        *format = ASTC_8x8_SRGB;
+        return true;
+    default:
+        return false;
+    }
+}
+
+// Reads the KTX2 file in file into levels, in the layout of TextureData with the finest level first, and points
+// texture at them. Only single 2D images are read, arrays, cube maps and 3D textures are not. A level count of 0 in the
+// file reads as a single level, which set_gpu_mipmaps fills the chain of. Returns false and logs why for files it does
+// not read.
+inline bool read_ktx2(const TextureData &file, std::vector<unsigned char> &levels, TextureData *texture)
+{
+    static constexpr unsigned char IDENTIFIER[12] = {0xAB, 0x4B, 0x54, 0x58, 0x20, 0x32,
+                                                     0x30, 0xBB, 0x0D, 0x0A, 0x1A, 0x0A};
+    static constexpr size_t HEADER_SIZE = 80;
+    static constexpr size_t LEVEL_SIZE = 24;
+
+    const unsigned char *bytes = file.bytes;
+    const size_t size = file.num_bytes;
+    const auto u32 = [bytes](size_t offset) {
+        uint32_t value;
+        memcpy(&value, bytes + offset, sizeof(value));
+        return value;
+    };
+    const auto u64 = [bytes](size_t offset) {
+        uint64_t value;
+        memcpy(&value, bytes + offset, sizeof(value));
+        return value;
+    };
+
+    if (!bytes || size < HEADER_SIZE || memcmp(bytes, IDENTIFIER, sizeof(IDENTIFIER)) != 0)
+    {
+        NSLog(@"Texture is not a KTX2 file");
+        return false;
+    }
+
+    const uint32_t vk_format = u32(12);
+    const uint32_t width = u32(20);
+    const uint32_t height = u32(24);
+    const uint32_t depth = u32(28);
+    const uint32_t layers = u32(32);
+    const uint32_t faces = u32(36);
+    const uint32_t level_count = std::max(u32(40), 1u);
+    const uint32_t scheme = u32(44);
+
+    DataFormat format;
+    if (!ktx2_data_format(vk_format, &format))
+    {
+        NSLog(@"KTX2 format %u is not supported, Basis Universal files need to be transcoded first", vk_format);
+        return false;
+    }
+    if (width == 0 || height == 0 || depth > 0 || layers > 0 || faces != 1)
+    {
+        NSLog(@"KTX2 texture is not a single 2D image");
+        return false;
+    }
+    if (scheme != KTX2_SUPERCOMPRESSION_NONE && scheme != KTX2_SUPERCOMPRESSION_ZLIB)
+    {
+        NSLog(@"KTX2 supercompression scheme %u is not supported", scheme);
+        return false;
+    }
+    if (HEADER_SIZE + level_count * LEVEL_SIZE > size || level_count > full_mip_levels(width, height))
+    {
+        NSLog(@"KTX2 level index is truncated");
+        return false;
+    }
+
+    TextureData read = {width, height, level_count, nullptr, 0, format};
+    // Uncompressed levels of TextureData are not clamped to 1 texel, levels past the first side of 1 texel are left
+    // out so their offsets match those of the file.
+    if (texture_format(format).block_width == 1)
+        read.mip_levels = std::min(level_count, full_mip_levels(std::min(width, height), std::min(width, height)));
+
+    levels.resize(mip_levels_size(read, 0));
+    for (unsigned int m = 0; m < read.mip_levels; m++)
+    {
+        const size_t index = HEADER_SIZE + m * LEVEL_SIZE;
+        const uint64_t offset = u64(index);
+        const uint64_t length = u64(index + 8);
+        const uint64_t uncompressed = u64(index + 16);
+        unsigned int w, h;
+        mip_level_width_height(read, m, &w, &h);
+        const size_t expected = texture_format(format).bytes_per_image(w, h);
+        if (offset > size || length > size - offset || uncompressed != expected ||
+            (scheme == KTX2_SUPERCOMPRESSION_NONE && length != expected))
+        {
+            NSLog(@"KTX2 level %u is truncated or has the wrong size", m);
+            return false;
+        }
+
+        unsigned char *level = levels.data() + mip_offset(read, m);
+        if (scheme == KTX2_SUPERCOMPRESSION_NONE)
+        {
+            memcpy(level, bytes + offset, expected);
+            continue;
+        }
+
+        // Levels are zlib streams, the Compression framework inflates the raw DEFLATE data after the 2 byte header.
+        if (length < 6 || (bytes[offset] & 0x0F) != 8 || (bytes[offset + 1] & 0x20) != 0 ||
+            compression_decode_buffer(level, expected, bytes + offset + 2, length - 2, nullptr, COMPRESSION_ZLIB) !=
+                expected)
+        {
+            NSLog(@"KTX2 level %u does not inflate", m);
+            return false;
+        }
+    }
+
+    read.bytes = levels.data();
+    read.num_bytes = levels.size();
+    *texture = read;
+    return true;
+}
+
+#endif // METALCPP_SRC_KTX2_HPP
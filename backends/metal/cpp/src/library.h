@@ -5,6 +5,8 @@
 #define API
 #endif
 
+#include <stddef.h>
+
 #include "structs.h"
 
 typedef struct
@@ -56,7 +58,18 @@ typedef struct
 typedef enum : unsigned int
 {
     SHADOW_CASTER = 1,
-    ALLOW_SKINNING = 2
+    ALLOW_SKINNING = 2,
+    // Blends with order-independent transparency after the opaque meshes, in views that are lit. Transparent meshes
+    // don't occlude other meshes, they still cast shadows with SHADOW_CASTER.
+    TRANSPARENT = 4,
+    // Never deforms, the renderer keeps a copy that set_static_batching merges with its neighbours while the mesh has
+    // one instance. Skinned meshes are never batched.
+    STATIC = 8,
+    // Reorders the triangles of an indexed or welded mesh within its ranges for the post-transform vertex cache and
+    // less overdraw, and its vertices in the order the triangles use them. The renderer keeps the reordered copy, whose
+    // triangle and vertex numbers are those of ray query hits. set_3d_meshes_batch reorders its meshes in parallel on
+    // background threads, write_scene_cache stores them reordered and without the flag so loading skips the work.
+    OPTIMIZE_ORDER = 16
 } Mesh3dFlags;
 
 typedef struct
@@ -65,21 +78,98 @@ typedef struct
     unsigned int num_vertices;
     const RTTriangle *triangles;
     unsigned int num_triangles;
+    // Optional material ranges in vertices, or in indices of indexed meshes. Static meshes with several ranges that
+    // cover all of their triangles only draw the ranges within the camera's view while GPU culling is disabled.
     const VertexRange *ranges;
     unsigned int num_ranges;
     const JointData *skin_data;
     unsigned int flags;
     Aabb bounds;
+    // Optional, vertices are drawn as a triangle list when num_indices is 0. Meshes with indices past num_vertices,
+    // or a count without indices, are not set.
+    const unsigned int *indices;
+    unsigned int num_indices;
 } MeshData3D;
 
+// Vertices and optional indices of a 3D mesh in the compact streams of encode_3d_vertices and encode_3d_indices.
+typedef struct
+{
+    const unsigned char *vertices;
+    size_t num_vertex_bytes;
+    const unsigned char *indices;
+    size_t num_index_bytes;
+} EncodedMesh3D;
+
 typedef enum : unsigned int
 {
     TRANSFORMED = 1
 } InstanceFlags3D;
 
+// Laid out like rfw-backend's SkinData, whose string and slices are a pointer followed by a length.
+typedef struct
+{
+    const char *name;
+    size_t name_length;
+    const simd_float4x4 *inverse_bind_matrices;
+    size_t num_inverse_bind_matrices;
+    const simd_float4x4 *joint_matrices;
+    size_t num_joint_matrices;
+} SkinData;
+
+// Sparse deltas of one morph target, vertex vertices[i] of the mesh moves by 3 floats of positions and its normal by 3
+// floats of normals from i * 3 on. Normals are optional.
+typedef struct
+{
+    const unsigned int *vertices;
+    const float *positions;
+    const float *normals;
+    unsigned int count;
+} MorphTargetData;
+
+typedef enum : unsigned int
+{
+    ANIMATION_TRANSLATION = 0,
+    ANIMATION_ROTATION = 1,
+    ANIMATION_SCALE = 2
+} AnimationPath;
+
+// Linearly interpolated keyframes of one property of a joint with times in seconds, ascending. Translations and scales
+// have 3 floats of values per key, rotations are quaternions of 4 floats with w last.
+typedef struct
+{
+    unsigned int joint;
+    AnimationPath path;
+    const float *times;
+    const float *values;
+    unsigned int num_keys;
+} AnimationChannel;
+
+// Joint hierarchy of a skin, parents come before their children and roots have -1. The rest pose has 3 floats of
+// translation and scale and 4 of rotation per joint.
+typedef struct
+{
+    const int *parents;
+    const float *translations;
+    const float *rotations;
+    const float *scales;
+    const simd_float4x4 *inverse_bind_matrices;
+    unsigned int num_joints;
+} SkeletonData;
+
+// Clip sampled at time seconds, looping clips wrap around their duration and others hold their last key. Weights of
+// the layers of a skin are normalized.
+typedef struct
+{
+    unsigned int clip;
+    float time;
+    float weight;
+    unsigned int loop;
+} AnimationLayer;
+
 typedef struct
 {
     Aabb local_aabb;
+    // Affine transforms, their last row is ignored.
     const simd_float4x4 *matrices;
     unsigned int num_matrices;
     const int *skin_ids;
@@ -88,6 +178,124 @@ typedef struct
     unsigned int num_flags;
 } InstancesData3D;
 
+typedef struct
+{
+    unsigned int mesh_id;
+    // Instances whose bounds span less than this fraction of the screen height are drawn with mesh_id.
+    float screen_size;
+} MeshLod;
+
+typedef struct
+{
+    // Edge of the cubic cells in world units, 0 disables static batching.
+    float cell_size;
+    // Batches are drawn as meshes first_id to first_id + max_batches - 1, which must not be used by other meshes.
+    unsigned int first_id;
+    unsigned int max_batches;
+} StaticBatching;
+
+// A mesh of a prefab with its bounds in the space of the prefab's instances.
+typedef struct
+{
+    unsigned int mesh_id;
+    Aabb local_aabb;
+} PrefabMesh3D;
+
+typedef struct
+{
+    // INSTANCE_ANIMATION_*.
+    unsigned int type;
+    // Largest sway angle in radians and its angular frequency in radians per second, unused by linear animations.
+    float amplitude;
+    float frequency;
+    const AnimatedInstance *instances;
+    unsigned int num_instances;
+} InstanceAnimation3D;
+
+// Node of a transform hierarchy, parents come before their children and roots have -1. The world transform of the
+// node is written to instance `instance` of mesh `mesh`, nodes that only transform their children have
+// NO_HIERARCHY_INSTANCE as mesh.
+typedef struct
+{
+    simd_float4x4 local;
+    int parent;
+    unsigned int mesh;
+    unsigned int instance;
+} TransformNode;
+
+// Heightmap of width by height heights in world units, row by row along z and spaced spacing apart from origin.
+typedef struct
+{
+    simd_float4 origin;
+    const float *heights;
+    // Optional material of every height, vertices use material otherwise.
+    const unsigned int *materials;
+    unsigned int width;
+    unsigned int height;
+    float spacing;
+    // World units the textures of the materials repeat over.
+    float uv_scale;
+    unsigned int material;
+    // Rings of detail around the camera, up to TERRAIN_MAX_LEVELS.
+    unsigned int levels;
+    // Mesh3dFlags of the terrain.
+    unsigned int flags;
+} TerrainData;
+
+// Instances scattered across a terrain, one candidate in every cell of spacing world units within radius of the
+// camera. Candidates are kept with the chance of their density and get a random rotation around y and scale.
+typedef struct
+{
+    // Optional density_width by density_height chances in [0, 1] stretched across the terrain, 1 everywhere otherwise.
+    const float *density;
+    unsigned int density_width;
+    unsigned int density_height;
+    unsigned int terrain;
+    unsigned int seed;
+    float spacing;
+    float radius;
+    float min_scale;
+    float max_scale;
+} ScatterData;
+
+// Point cloud of count positions with optional 0xAABBGGRR colors, white otherwise, placed in the world by transform.
+typedef struct
+{
+    simd_float4x4 transform;
+    const Vector3 *positions;
+    const unsigned int *colors;
+    unsigned int count;
+} PointCloudData;
+
+// Impostor mesh `mesh` of a mesh, drawn with `material`, whose diffuse and normal maps should be the albedo_texture and
+// normal_texture slots the atlases are baked into. Atlases are tiles by tiles views of tile_size texels, the impostor
+// quad faces the camera with grid by grid cells, 0 picks IMPOSTOR_GRID.
+typedef struct
+{
+    unsigned int mesh;
+    unsigned int material;
+    unsigned int albedo_texture;
+    unsigned int normal_texture;
+    unsigned int tiles;
+    unsigned int tile_size;
+    unsigned int grid;
+    // Instances whose bounds span less than this fraction of the screen height are drawn as impostors.
+    float screen_size;
+} ImpostorSettings;
+
+// Lightmap of the instances of meshes baked into texture slot `texture`, width by height texels up to
+// LIGHTMAP_MAX_SIZE. Every texel traces samples paths in total, samples_per_frame of them every frame.
+typedef struct
+{
+    const unsigned int *meshes;
+    unsigned int num_meshes;
+    unsigned int texture;
+    unsigned int width;
+    unsigned int height;
+    unsigned int samples;
+    unsigned int samples_per_frame;
+} LightmapSettings;
+
 typedef struct
 {
     const Vertex2D *vertices;
@@ -101,36 +309,1230 @@ typedef struct
     unsigned int num_matrices;
 } InstancesData2D;
 
+// Rectangle of drawable pixels, counted from the top left corner like the pixels of pick.
+typedef struct
+{
+    int x;
+    int y;
+    unsigned int width;
+    unsigned int height;
+} ClipRect2D;
+
+// Line segment of a 2D path from x0, y0 to x1, y1 in path space.
+typedef struct
+{
+    float x0;
+    float y0;
+    float x1;
+    float y1;
+} PathSegment2D;
+
+typedef enum : unsigned int
+{
+    // Fills the inside of closed contours, counter-clockwise ones add to the winding number, clockwise ones subtract.
+    PATH_FILL_NONZERO = 0,
+    PATH_FILL_EVEN_ODD = 1,
+    // Covers everything within half the stroke width of a segment, with round joins and caps.
+    PATH_STROKE = 2
+} PathMode2D;
+
+// Path of segments placed in 2D space by transform. Color is RGBA8 with red in the lowest byte.
+typedef struct
+{
+    simd_float4x4 transform;
+    const PathSegment2D *segments;
+    unsigned int num_segments;
+    PathMode2D mode;
+    // Width of strokes in path units.
+    float stroke_width;
+    float z;
+    unsigned int color;
+} PathData2D;
+
 typedef enum : unsigned int
 {
     BGRA8 = 0,
-    RGBA8 = 1
+    RGBA8 = 1,
+    // Block compressed formats, BC needs a Mac GPU and ASTC an Apple GPU. Data holds the blocks of every level.
+    BC1_RGBA = 2,
+    BC2_RGBA = 3,
+    BC3_RGBA = 4,
+    BC4_R = 5,
+    BC5_RG = 6,
+    BC6H_RGB_UFLOAT = 7,
+    BC7_RGBA = 8,
+    ASTC_4x4 = 9,
+    ASTC_6x6 = 10,
+    ASTC_8x8 = 11,
+    // Single channel gray and gray with alpha, expanded into color by the swizzle of the texture. Needs macOS 10.15.
+    R8 = 12,
+    RG8 = 13,
+    // Colors encoded in sRGB, converted to linear when they are sampled.
+    BGRA8_SRGB = 14,
+    RGBA8_SRGB = 15,
+    BC1_RGBA_SRGB = 16,
+    BC2_RGBA_SRGB = 17,
+    BC3_RGBA_SRGB = 18,
+    BC7_RGBA_SRGB = 19,
+    ASTC_4x4_SRGB = 20,
+    ASTC_6x6_SRGB = 21,
+    ASTC_8x8_SRGB = 22,
+    // A whole KTX2 file, whose header gives the size, levels and format, see set_textures. Width, height and
+    // mip_levels are ignored.
+    KTX2 = 23
 } DataFormat;
 
+typedef enum : unsigned int
+{
+    VERTEX_3D_FULL = 0,
+    VERTEX_3D_PACKED = 1
+} VertexFormat3D;
+
+// Deferred modes shade from a G-buffer in tile memory, Normal and Albedo show its contents. GPUs without tile memory
+// always render forward.
+typedef enum : unsigned int
+{
+    RENDER_DEFAULT = 0,
+    RENDER_NORMAL = 1,
+    RENDER_ALBEDO = 2,
+    RENDER_GBUFFER = 3,
+    // Show the ambient occlusion traced with set_ray_tracing, or else the screen space occlusion of set_ssao before
+    // and after its blur. White while both are disabled.
+    RENDER_SSAO = 4,
+    // Path traces the full-format 3D meshes, samples accumulate while the view and the scene stay the same. Falls back
+    // to RENDER_DEFAULT before macOS 11.
+    RENDER_PATH_TRACED = 5,
+    RENDER_FILTERED_SSAO = 6,
+    // Heatmap of the 3D fragments rasterized per pixel, opaque and transparent meshes are all counted without depth
+    // testing. Black is none, blue one, then cyan, green, yellow, orange, red and magenta up to white for 8 or more.
+    RENDER_OVERDRAW = 7
+} RenderMode3D;
+
+typedef enum : unsigned int
+{
+    HDR_OFF = 0,
+    // Shades 3D into a half float target, tonemapped into the 8-bit drawable before 2D is drawn.
+    HDR_TONEMAPPED = 1,
+    // Presents a half float drawable in extended sRGB, tonemapped up to the headroom of EDR displays. Offscreen frames
+    // fall back to HDR_TONEMAPPED.
+    HDR_EXTENDED = 2
+} HdrMode;
+
+// Post effects of the overlay pass, an intensity of 0 leaves an effect out. Bloom adds the radiance above
+// bloom_threshold, blurred over a pyramid of ever smaller levels, times bloom_intensity before exposure. The vignette
+// darkens the view by up to vignette_intensity from vignette_radius on, relative to the distance from the center to the
+// corners.
+typedef struct
+{
+    float bloom_threshold;
+    float bloom_intensity;
+    float vignette_intensity;
+    float vignette_radius;
+} PostProcessSettings;
+
+// Reflections traced for surfaces up to max_roughness, from where reflections fade into those of the probes and the
+// skybox. Rays go up to max_distance.
+typedef struct
+{
+    unsigned int enabled;
+    float max_roughness;
+    float max_distance;
+} ReflectionSettings;
+
+// Soft shadows and ambient occlusion traced through signed distance fields instead of rays, see set_sdf_tracing.
+// Penumbras widen by softness per unit of distance to the occluder, occlusion reaches up to ao_distance. The finest
+// level of the fields has voxels of voxel_size, every coarser level reaches twice as far.
+typedef struct
+{
+    unsigned int enabled;
+    float softness;
+    float ao_distance;
+    float voxel_size;
+} SdfSettings;
+
+typedef enum : unsigned int
+{
+    // Presents as soon as a frame is done, without waiting for the display refresh.
+    PRESENT_IMMEDIATE = 0,
+    PRESENT_VSYNC = 1,
+    // Presents at the refresh after min_frame_duration has passed since the previous frame was presented, for a
+    // steady frame rate below the refresh rate.
+    PRESENT_PACED = 2,
+    // Frames are paced by a CAMetalDisplayLink at up to 1 / min_frame_duration frames per second, or at the refresh
+    // rate of the display without a duration. Variable refresh displays may lower their rate to match the frames.
+    // Needs macOS 14 and falls back to PRESENT_PACED before.
+    PRESENT_DISPLAY_LINK = 3
+} PresentMode;
+
+typedef enum : unsigned int
+{
+    // Presented to the layer, or rendered into the offscreen target of instances without a window.
+    FRAME_PRESENTED = 0,
+    // The passes that don't draw into the drawable were submitted, but no drawable was acquired in time.
+    FRAME_NO_DRAWABLE = 1,
+    // Nothing was encoded, the pipelines did not compile yet or no frame in flight completed in time.
+    FRAME_SKIPPED = 2,
+    // Nothing changed since the last frame of an on-demand renderer, which the layer keeps showing.
+    FRAME_IDLE = 3
+} FrameStatus;
+
+// Laid out like rfw-backend's TextureData, whose byte slice is a pointer followed by a length.
 typedef struct
 {
     unsigned int width;
     unsigned int height;
     unsigned int mip_levels;
     const unsigned char *bytes;
+    size_t num_bytes;
     DataFormat format;
 } TextureData;
 
+// Compression of asset files, the values match MTLIOCompressionMethod.
+typedef enum : unsigned int
+{
+    ASSET_COMPRESSION_ZLIB = 0,
+    ASSET_COMPRESSION_LZFSE = 1,
+    ASSET_COMPRESSION_LZ4 = 2,
+    ASSET_COMPRESSION_LZMA = 3,
+    ASSET_COMPRESSION_LZBITMAP = 4,
+    ASSET_COMPRESSION_NONE = 5
+} AssetCompression;
+
+typedef enum : unsigned int
+{
+    ASSET_PRIORITY_HIGH = 0,
+    ASSET_PRIORITY_NORMAL = 1,
+    ASSET_PRIORITY_LOW = 2
+} AssetPriority;
+
+// Texture stored in an asset file, its levels follow each other from offset on in the layout of TextureData.
+typedef struct
+{
+    unsigned int width;
+    unsigned int height;
+    unsigned int mip_levels;
+    DataFormat format;
+    unsigned long long offset;
+    AssetPriority priority;
+} FileTexture;
+
+// Contents of a scene cache, mesh_ids[i] and instance_ids[i] are the ids of meshes[i] and instances[i].
+typedef struct
+{
+    const unsigned int *mesh_ids;
+    const MeshData3D *meshes;
+    unsigned int num_meshes;
+    const unsigned int *instance_ids;
+    const InstancesData3D *instances;
+    unsigned int num_instances;
+    const DeviceMaterial *materials;
+    unsigned int num_materials;
+    const TextureData *textures;
+    unsigned int num_textures;
+} SceneCacheData;
+
+// Passes of a frame whose GPU time is reported by get_frame_stats. Culling includes the depth pyramid and GPU draw
+// encoding, lighting includes light culling, traced shadows, screen space occlusion and path tracing. The depth pass
+// includes the motion vectors of temporal frames. Upscale covers the camera motion, the temporal antialiasing resolve
+// and the overlay pass up to its 2D draws, which tonemaps HDR frames. The temporal scaler itself is only part of the
+// frame time.
+typedef enum : unsigned int
+{
+    FRAME_PASS_SKINNING = 0,
+    FRAME_PASS_CULLING = 1,
+    FRAME_PASS_DEPTH = 2,
+    FRAME_PASS_SHADOWS = 3,
+    FRAME_PASS_LIGHTING = 4,
+    FRAME_PASS_3D = 5,
+    FRAME_PASS_UPSCALE = 6,
+    FRAME_PASS_2D = 7,
+    FRAME_PASS_COUNT = 8
+} FramePass;
+
+// Counters of the GPU's pipeline statistics. Primitives that leave the clipper are those within the view, clipped
+// ones are split.
+typedef struct
+{
+    unsigned long long vertex_invocations;
+    unsigned long long fragment_invocations;
+    unsigned long long clipper_invocations;
+    unsigned long long clipper_primitives_out;
+} PipelineStatistics;
+
+typedef struct
+{
+    // GPU milliseconds by FramePass, 0 for passes that did not run or on GPUs without timestamp sampling. 2D drawn in
+    // the 3D pass is only timed separately on GPUs that sample at draw boundaries.
+    float pass_ms[FRAME_PASS_COUNT];
+    // GPU milliseconds of the whole frame, including work that is not timed per pass.
+    float frame_ms;
+    // GPU milliseconds of the geometry and texture uploads that completed since the previous frame.
+    float uploads_ms;
+    // Submitted 3D and 2D draws, before GPU culling.
+    unsigned int draws;
+    unsigned int instances;
+    unsigned int triangles;
+    // Level of the quality governor, 0 while it renders at the configured quality.
+    unsigned int quality_level;
+    // Whether the GPU has the statistic counter set, which Apple GPUs don't. Passes have statistics on GPUs that sample
+    // counters at stage boundaries, like pass_ms, the frame has them on GPUs that sample at blit boundaries. The frame
+    // covers the GPU work between the start and the end of the frame, including work of other queues.
+    unsigned int has_statistics;
+    PipelineStatistics pass_statistics[FRAME_PASS_COUNT];
+    PipelineStatistics statistics;
+} FrameStats;
+
+// Draws of a 3D mesh in the main and transparency passes of a frame, see set_mesh_profiling.
+typedef struct
+{
+    unsigned int mesh;
+    unsigned int instances;
+    unsigned int triangles;
+    // GPU milliseconds of the draws, 0 on GPUs that don't sample at draw boundaries.
+    float gpu_ms;
+} MeshCost;
+
+typedef struct
+{
+    // Whether the GPU timed the meshes, which Apple GPUs can't. Meshes are ranked by triangles without timings.
+    unsigned int timed;
+    // Meshes the frame drew, the first count of them by cost are in costs.
+    unsigned int meshes;
+    unsigned int count;
+    // GPU milliseconds of all timed draws, which run one after the other while profiling.
+    float total_ms;
+    MeshCost costs[MESH_COST_COUNT];
+} MeshCostStats;
+
+// Intervals between the times frames were shown on the display, see get_frame_pacing.
+typedef struct
+{
+    // Interval the frames are paced at: the refresh interval of the display, or the minimum frame duration of the
+    // present mode or quality level when it is longer.
+    float refresh_ms;
+    // Milliseconds between consecutive frames over the last 1024 intervals.
+    float mean_ms;
+    float p50_ms;
+    float p95_ms;
+    float p99_ms;
+    float max_ms;
+    // Since the last reset: frames shown, drawables that were never shown, refreshes frames were late by, and
+    // intervals of more than 1.5 refreshes.
+    unsigned long long presented;
+    unsigned long long dropped;
+    unsigned long long missed_vsyncs;
+    unsigned long long hitches;
+    // Number of the frame, as returned by get_submitted_frame, that was shown after the last hitch, and the interval
+    // before it.
+    unsigned long long last_hitch_frame;
+    float last_hitch_ms;
+    unsigned int histogram[PACING_HISTOGRAM_BUCKETS];
+} FramePacingStats;
+
+typedef void (*ReadbackCallback)(void *user_data, const unsigned char *pixels, unsigned int width, unsigned int height,
+                                 unsigned int bytes_per_row);
+
+typedef enum : unsigned int
+{
+    VIDEO_CODEC_H264 = 0,
+    VIDEO_CODEC_HEVC = 1
+} VideoCodec;
+
+// Rate control of a video stream, zeros leave the choice to the encoder.
+typedef struct
+{
+    VideoCodec codec;
+    unsigned int bitrate_kbps;
+    // Frames per second the encoder budgets the bitrate for.
+    unsigned int frame_rate;
+    // Most frames between two keyframes.
+    unsigned int keyframe_interval;
+} VideoStreamSettings;
+
+// Encoded frame of a video stream as Annex B NAL units, keyframes start with the parameter sets of the stream. data is
+// only valid during the call, timestamp_us is the time the frame started rendering.
+typedef void (*VideoPacketCallback)(void *user_data, const unsigned char *data, unsigned int size,
+                                    unsigned long long timestamp_us, unsigned int keyframe);
+
+// 3D instance drawn at pixel x, y of the drawable, counted from its top left corner. Pixels without an opaque 3D
+// instance have NO_PICK_HIT for mesh and instance.
+typedef struct
+{
+    unsigned int x;
+    unsigned int y;
+    unsigned int mesh;
+    unsigned int instance;
+} PickResult;
+
+typedef void (*PickCallback)(void *user_data, const PickResult *results, unsigned int count);
+
+// Closest or first hit of a ray query, u and v are the barycentrics of the hit on triangle primitive of the mesh. Rays
+// that hit nothing have NO_RAY_HIT for mesh, instance and primitive.
+typedef struct
+{
+    float distance;
+    unsigned int mesh;
+    unsigned int instance;
+    unsigned int primitive;
+    float u;
+    float v;
+} RayHit;
+
+typedef void (*RayQueryCallback)(void *user_data, const RayHit *hits, unsigned int count);
+
+// Cells of cell_size world units over bounds whose potentially visible meshes bake_pvs finds, rays_per_cell rays are
+// traced from random points of every cell and rays_per_frame of all of them every frame, 0 picks 1048576.
+typedef struct
+{
+    Aabb bounds;
+    float cell_size;
+    unsigned int rays_per_cell;
+    unsigned int rays_per_frame;
+} PvsSettings;
+
+// Potentially visible set of cells_x by cells_y by cells_z cells of cell_size over bounds, cell (x, y, z) has index
+// x + cells_x * (y + cells_y * z). The (num_meshes + 31) / 32 words at that many times its index of bits hold a bit per
+// mesh, bit j of word i is set when meshes[32 * i + j] can be seen from the cell.
+typedef struct
+{
+    Aabb bounds;
+    float cell_size;
+    unsigned int cells_x;
+    unsigned int cells_y;
+    unsigned int cells_z;
+    const unsigned int *meshes;
+    unsigned int num_meshes;
+    const unsigned int *bits;
+} PvsData;
+
+typedef void (*PvsCallback)(void *user_data, const PvsData *pvs);
+
+// Categories of the GPU memory an instance allocates. Arguments include the material buffer, targets everything that
+// is rendered into and staging the memory uploads pass through.
+typedef enum : unsigned int
+{
+    MEMORY_VERTICES = 0,
+    MEMORY_INSTANCES = 1,
+    MEMORY_TEXTURES = 2,
+    MEMORY_ARGUMENTS = 3,
+    MEMORY_TARGETS = 4,
+    MEMORY_STAGING = 5,
+    MEMORY_CATEGORY_COUNT = 6
+} MemoryCategory;
+
+typedef struct
+{
+    // Bytes by MemoryCategory.
+    unsigned long long bytes[MEMORY_CATEGORY_COUNT];
+    // Bytes of vertex buffers that no mesh uses, meshes set later reuse them before the buffers grow.
+    unsigned long long unused_vertex_bytes;
+    // Bytes of instance buffers that hold no instance: spare capacity of growing lists and holes left by removed ones.
+    unsigned long long unused_instance_bytes;
+    // Bytes the device allocated in total, including acceleration structures, drawables and other instances.
+    unsigned long long allocated;
+    unsigned long long recommended_working_set;
+    // Bytes the memory policy compares allocated against.
+    unsigned long long budget;
+    unsigned int evicted_meshes;
+    unsigned int evicted_textures;
+    // Bytes of unloaded meshes and replaced textures in the resource cache, the OS reclaims them under pressure.
+    unsigned long long cached;
+    // Holes between instance lists, lists added later fill them before the instance buffers grow.
+    unsigned int instance_holes;
+} MemoryStats;
+
+// Progress of the render RENDER_PATH_TRACED accumulates, see set_path_tracer_convergence.
+typedef struct
+{
+    unsigned int samples;
+    // Tiles of PATH_TRACER_TILE_SIZE pixels and those of them that still trace paths, reported by the GPU a few
+    // frames late. Tiles only converge with a threshold, all of them trace until the render finishes without one.
+    unsigned int tiles;
+    unsigned int active_tiles;
+    // Seconds since the render started, or that it took once it finished.
+    float seconds;
+    // Whether the render stopped tracing, which it does until the view or the scene changes.
+    unsigned int finished;
+} PathTracerProgress;
+
+typedef struct
+{
+    // Megabytes the device may allocate before meshes and textures are evicted, 0 uses the recommended working set
+    // size of the device. Larger budgets are clamped to it.
+    unsigned int budget_megabytes;
+    // 3D meshes without instances for at least this many frames are unloaded, least recently drawn first. 0 never
+    // unloads meshes.
+    unsigned int mesh_idle_frames;
+    // Streamed textures drop the levels they did not sample during the last feedback period. 0 keeps them.
+    unsigned int evict_textures;
+} MemoryPolicy;
+
+// Cell of a world partition, loaded and unloaded as a whole. Its meshes are set like set_3d_mesh and its textures
+// replace their slots of the texture table, the data must stay valid while the cell is registered. Cells of higher
+// priority load as if they were 1 + priority times nearer.
+typedef struct
+{
+    Aabb bounds;
+    float priority;
+    const unsigned int *mesh_ids;
+    const MeshData3D *meshes;
+    unsigned int num_meshes;
+    const unsigned int *texture_slots;
+    const TextureData *textures;
+    unsigned int num_textures;
+} StreamingCell;
+
+typedef struct
+{
+    // Cells whose bounds come within load_radius of the camera are loaded, those further than unload_radius unloaded.
+    float load_radius;
+    float unload_radius;
+    // Cells are also loaded around where the camera will be after this many seconds at its current velocity.
+    float prefetch_seconds;
+    // Megabytes of meshes and textures a synchronize loads at most, the nearest cell always loads. 0 is unlimited.
+    unsigned int upload_megabytes;
+} StreamingSettings;
+
+typedef struct
+{
+    // Megabytes of mesh and texture data staged per frame, 0 is unlimited.
+    unsigned int megabytes_per_frame;
+    // Microseconds spent copying them per frame, 0 is unlimited.
+    unsigned int microseconds_per_frame;
+} UploadBudget;
+
+// Called from synchronize with the ids of the 3D meshes a memory policy unloaded, they must be set again before they
+// get instances.
+typedef void (*MeshEvictionCallback)(void *user_data, const unsigned int *mesh_ids, unsigned int count);
+
+// Called once the pipelines of an instance compiled, on a thread of Grand Central Dispatch's choosing.
+typedef void (*PipelinesReadyCallback)(void *user_data);
+
+// Called from synchronize after streaming cell was loaded, or unloaded with loaded 0.
+typedef void (*CellStreamingCallback)(void *user_data, unsigned int cell, unsigned int loaded);
+
+// Camera view drawn over a rectangle of the frame, in pixels from the top left corner of the drawable. The aspect ratio
+// of the view should match the rectangle.
+typedef struct
+{
+    CameraView3D view;
+    float x;
+    float y;
+    float width;
+    float height;
+} InsetView3D;
+
+// How often the view of a render texture is drawn again.
+typedef enum : unsigned int
+{
+    RENDER_TEXTURE_EVERY_FRAME = 0,
+    // Every interval frames.
+    RENDER_TEXTURE_INTERVAL = 1,
+    // Only after request_render_texture.
+    RENDER_TEXTURE_ON_DEMAND = 2,
+} RenderTextureUpdate;
+
+// Camera view drawn into a texture slot of width by height texels. The size of the view is that of the texture.
+typedef struct
+{
+    CameraView3D view;
+    unsigned int width;
+    unsigned int height;
+    RenderTextureUpdate update;
+    unsigned int interval;
+} RenderTexture;
+
+typedef enum : unsigned int
+{
+    // The last GPU that isn't low power, or the system default.
+    DEVICE_DEFAULT = 0,
+    // A built-in GPU that isn't low power.
+    DEVICE_DISCRETE = 1,
+    DEVICE_LOW_POWER = 2,
+    // An external GPU.
+    DEVICE_REMOVABLE = 3,
+    // The GPU with the largest recommended working set.
+    DEVICE_LARGEST_WORKING_SET = 4,
+    // The GPU driving the display of ns_window, which presents without copying frames between GPUs. Headless
+    // instances take the default.
+    DEVICE_DISPLAY = 5
+} DevicePreference;
+
+typedef enum : unsigned int
+{
+    DEVICE_OK = 0,
+    // The display of the window is driven by another GPU, every present copies the frame between GPUs.
+    DEVICE_NOT_DISPLAYING = 1,
+    // An external GPU is about to be disconnected. Resources can't move between GPUs, the instance should be
+    // destroyed and created again, load_scene_cache restores a scene written before.
+    DEVICE_REMOVAL_REQUESTED = 2,
+    // The GPU is gone, render skips every frame until the instance is destroyed.
+    DEVICE_REMOVED = 3
+} DeviceStatus;
+
+// GPU of the device list. GPUs of a peer group are linked with each other and copy between each other without the
+// host, peer_group_id is 0 for GPUs without peers.
+typedef struct
+{
+    char name[128];
+    unsigned long long registry_id;
+    unsigned long long recommended_working_set;
+    unsigned long long peer_group_id;
+    unsigned int peer_index;
+    unsigned int peer_count;
+    unsigned int low_power;
+    unsigned int removable;
+} DeviceInfo;
+
+typedef enum : unsigned int
+{
+    // JSON of the Chrome trace event format, for chrome://tracing and ui.perfetto.dev.
+    TRACE_CHROME_JSON = 0,
+    // Protobuf of the Perfetto trace format.
+    TRACE_PERFETTO = 1
+} TraceFormat;
+
+// The Rust backend passes these without converting them and asserts the same layout on its side.
+_Static_assert(sizeof(CameraView3D) == 128, "CameraView3D must match rfw-backend");
+_Static_assert(offsetof(TextureData, bytes) == 16 && offsetof(TextureData, format) == 32 && sizeof(TextureData) == 40,
+               "TextureData must match rfw-backend");
+_Static_assert(offsetof(SkinData, joint_matrices) == 32 && sizeof(SkinData) == 48, "SkinData must match rfw-backend");
+
+// A null ns_window renders headless into an offscreen texture of width and height times scale, which needs no window
+// server session.
 API void *create_instance(void *ns_window, void *ns_view, unsigned int width, unsigned int height, double scale);
+// Keeps the compiled pipelines in a binary archive in the pipeline_cache directory, later instances load them from
+// there instead of compiling them again.
+API void *create_instance_with_pipeline_cache(void *ns_window, void *ns_view, unsigned int width, unsigned int height,
+                                              double scale, const char *pipeline_cache);
+// Creates the instance on the GPU preference asks for, falling back to the default. pipeline_cache may be null.
+API void *create_instance_with_device(void *ns_window, void *ns_view, unsigned int width, unsigned int height,
+                                      double scale, const char *pipeline_cache, DevicePreference preference);
+// Number of GPUs in the device list and the GPU at device_index, get_device_info returns 0 for indices past the list.
+// Every instance renders on one GPU; batch renders spread over several take an instance per GPU, each rendering its
+// own frames or tiles.
+API unsigned int get_device_count(void);
+API unsigned int get_device_info(unsigned int device_index, DeviceInfo *info);
+// Creates the instance on the GPU at device_index, null when there is no such GPU.
+API void *create_instance_on_device(unsigned int device_index, void *ns_window, void *ns_view, unsigned int width,
+                                    unsigned int height, double scale, const char *pipeline_cache);
+// Draws into a CAMetalLayer added to the layer of ui_view on iOS and iPadOS, width and height are in points.
+// pipeline_cache may be null. Returns null on macOS.
+API void *create_instance_in_view(void *ui_view, unsigned int width, unsigned int height, double scale,
+                                  const char *pipeline_cache);
 API void destroy_instance(void *instance);
+// Whether the GPU of the instance is still there and drives the display of its window.
+API DeviceStatus get_device_status(void *instance);
 
 API void set_2d_mesh(void *instance, unsigned int id, MeshData2D data);
 API void set_2d_instances(void *instance, unsigned int id, InstancesData2D data);
+API void set_2d_instances_batch(void *instance, const unsigned int *ids, const InstancesData2D *data,
+                                unsigned int count);
+// Text is drawn on top of all 2D meshes as glyph quads showing regions of one R8 coverage atlas. Creating the atlas
+// clears it, regions still read by frames in flight must not be updated.
+API void set_glyph_atlas(void *instance, unsigned int width, unsigned int height);
+API void update_glyph_atlas(void *instance, unsigned int x, unsigned int y, unsigned int width, unsigned int height,
+                            const unsigned char *pixels, unsigned int bytes_per_row);
+// Replaces the glyphs of run id, a run with as many glyphs as before only uploads the glyphs that changed.
+API void set_glyphs(void *instance, unsigned int id, const GlyphInstance *glyphs, unsigned int count);
+// Replaces the sprites of run id, drawn on top of 2D meshes and below text in the order of their ids. Like glyph runs,
+// a run with as many sprites as before only uploads the sprites that changed, 0 removes it.
+API void set_sprites(void *instance, unsigned int id, const SpriteInstance *sprites, unsigned int count);
+// Keeps all 2D in a layer that is only drawn again when 2D meshes, instances, sprites, glyphs, textures, the 2D matrix
+// or the drawable size changed, other frames composite the layer over the 3D view. Disabled by default.
+API void set_2d_caching(void *instance, unsigned int enabled);
+// Clips the instances of 2D mesh id to rect with a scissor rectangle, nested clips are set as the intersection of
+// their rectangles. Instances outside the drawable or their clip rectangle are not drawn, so the cost of a scrolled
+// list is that of the items in view. The clip stays with the id until it is removed.
+API void set_2d_clip(void *instance, unsigned int id, ClipRect2D rect);
+API void remove_2d_clip(void *instance, unsigned int id);
+// Draws path id after the 2D meshes and before sprites, in the order of their ids. Its segments are uploaded once and
+// every pixel of its bounds computes its coverage from the segments near it, so zooming in or out of the 2D matrix or
+// the transform needs no tessellation or upload. 0 segments removes the path.
+API void set_2d_path(void *instance, unsigned int id, PathData2D path);
+API void set_2d_path_transform(void *instance, unsigned int id, simd_float4x4 transform);
 
 API void set_3d_mesh(void *instance, unsigned int id, MeshData3D data);
-API void unload_3d_meshes(void *instance, const unsigned int *ids, unsigned int num);
+// Encodes vertices or indices into out, returns the size of the stream or 0 when it needs more than capacity bytes,
+// which is at most what the bound functions return. Every byte of a vertex is stored as its difference to the previous
+// vertex and indices as differences to the previous index, so meshes in vertex fetch order shrink to a fifth to a half
+// and compress further with general purpose compressors. Meant for meshes that are stored, such as in scene files.
+API size_t encode_3d_vertices(const Vertex3D *vertices, unsigned int num_vertices, unsigned char *out, size_t capacity);
+API size_t encode_3d_indices(const unsigned int *indices, unsigned int num_indices, unsigned char *out,
+                             size_t capacity);
+API size_t encoded_3d_vertices_bound(unsigned int num_vertices);
+API size_t encoded_3d_indices_bound(unsigned int num_indices);
+// Sets mesh id like set_3d_mesh with the vertices and indices decoded from encoded, blocks of vertices decode in
+// parallel on the global queue. The vertices and indices of data are ignored, its skin data must hold as many entries
+// as there are vertices. Returns 0 and leaves the mesh unchanged when the streams are malformed or indices are out of
+// range. Captures record the decoded mesh.
+API unsigned int set_3d_mesh_encoded(void *instance, unsigned int id, MeshData3D data, EncodedMesh3D encoded);
+API void unload_3d_meshes(void *instance, const size_t *ids, unsigned int num);
+// Sets mesh id again from the copy set_resource_cache kept when it was unloaded, returns 0 when there is none or the OS
+// reclaimed it.
+API unsigned int restore_3d_mesh(void *instance, unsigned int id);
 API void set_3d_instances(void *instance, unsigned int id, InstancesData3D data);
+// Same as calling set_3d_mesh or set_3d_instances (set_2d_instances above) for ids[i] and data[i] in order, with the
+// renderer's tables grown once for the whole batch.
+API void set_3d_meshes_batch(void *instance, const unsigned int *ids, const MeshData3D *data, unsigned int count);
+API void set_3d_instances_batch(void *instance, const unsigned int *ids, const InstancesData3D *data,
+                                unsigned int count);
+// Draws the instances of mesh id that get small on screen with coarser meshes, levels go from the finest to the
+// coarsest and are set like any other 3D mesh, without instances of their own. Levels are selected per instance by
+// GPU culling, without it instances always draw mesh id. Up to MAX_MESH_LODS levels, 0 removes them.
+API void set_3d_mesh_lods(void *instance, unsigned int id, const MeshLod *levels, unsigned int num_levels);
+// Groups the meshes of a prefab so they share the instances of meshes[0], which are set, mapped and changed through it
+// like any instances. They are stored and uploaded once, every other mesh draws the same range with its own bounds and
+// the instance overrides of meshes[0]. Setting the instances of another mesh takes it out of the prefab, unloading
+// meshes[0] or grouping it again leaves the other meshes without instances.
+API void set_3d_prefab(void *instance, const PrefabMesh3D *meshes, unsigned int count);
+// Replaces the instances of mesh id with instances a compute pass transforms every frame at the animation time, the
+// parameters are uploaded once. Setting its instances again stops the animation. Shadows of animated casters are
+// redrawn every frame, ray tracing and the culling of material ranges see the instances at rest.
+API void set_3d_instance_animation(void *instance, unsigned int id, InstanceAnimation3D animation);
+// Propagates the local transforms of nodes down their hierarchy on the GPU every frame, one dispatch per depth, and
+// writes the world transforms over the instances the nodes target. 0 nodes removes the hierarchy. Like animated
+// instances, ray tracing and the culling of material ranges see the instances as they were set.
+API void set_3d_hierarchy(void *instance, const TransformNode *nodes, unsigned int num_nodes);
+// Replaces the local transforms of count nodes of the hierarchy, only the changed transforms are uploaded.
+API void update_3d_hierarchy(void *instance, const unsigned int *nodes, const simd_float4x4 *locals,
+                             unsigned int count);
+// Draws mesh id as a terrain that only keeps its heightmap, its vertices are generated on the GPU in rings of
+// decreasing detail around the camera whenever it moves a texel. The mesh has one identity instance and a fixed vertex
+// count however large the heightmap is. Terrains without heights are unloaded.
+API void set_terrain(void *instance, unsigned int id, TerrainData terrain);
+// Scatters the instances of mesh id across a terrain around the camera. They are generated on the GPU every frame
+// into the instance buffer, culling and level of detail selection see them like any instances but none is set or
+// uploaded by the CPU. Setting instances of the mesh or a spacing or radius of 0 removes the scatter.
+API void set_3d_scatter(void *instance, unsigned int id, ScatterData scatter);
+// Bakes the albedo, normal and depth of static mesh id as seen from the octahedral directions around its instance
+// bounds into impostor atlases on the GPU, in the next frame that has the mesh. Once their texture slots bound them,
+// the impostor mesh becomes the coarsest level of detail of mesh id, so GPU culling draws far instances as one grid
+// facing the camera each. Set the levels of mesh id again to remove it.
+API void bake_3d_impostor(void *instance, unsigned int id, ImpostorSettings settings);
+// Emits, simulates and kills the particles of emitter id on the GPU every frame at the animation time, with up to
+// capacity particles alive. They are drawn as camera facing quads into the transparency layers of the 3D scene, without
+// any work per particle on the CPU. Setting an emitter of the same capacity again keeps its particles, 0 removes it.
+API void set_particle_emitter(void *instance, unsigned int id, ParticleEmitter emitter, unsigned int capacity);
+// Emits count particles of emitter id at once in the next frame, on top of its rate.
+API void emit_particles(void *instance, unsigned int id, unsigned int count);
+// Draws point cloud id as one pixel per point with a compute rasterizer in the 3D scene, without shadows. Points are
+// quantized into chunks of up to POINT_CHUNK_SIZE points with bounds, chunks outside the frustum are skipped and the
+// others only draw as many points as they cover pixels. 0 points removes the cloud, returns 0 when it is too large for
+// one buffer.
+API unsigned int set_point_cloud(void *instance, unsigned int id, PointCloudData data);
+// Moves point cloud id without building its chunks again.
+API void set_point_cloud_transform(void *instance, unsigned int id, simd_float4x4 transform);
+// Tints and material overrides of the first count instances of mesh id, the other instances draw like its mesh. The
+// overrides are kept by instance index until they are set again, 0 removes them.
+API void set_3d_instance_overrides(void *instance, unsigned int id, const InstanceOverride *overrides,
+                                   unsigned int count);
+// Time in seconds the next frames animate their instances at.
+API void set_animation_time(void *instance, float seconds);
+
+// Backend-owned storage for the vertices of mesh id that the caller writes directly, used from the next synchronize()
+// on. The mesh is not indexed or skinned. Returns null when the device has no unified memory.
+API Vertex3D *map_3d_mesh(void *instance, unsigned int id, unsigned int num_vertices);
+// Backend-owned storage for count instance matrices of mesh id, written instances are uploaded once they are marked
+// with mark_3d_instances_changed. Resizing the storage marks every instance as changed.
+API simd_float4x4 *map_3d_instances(void *instance, unsigned int id, unsigned int count);
+API void mark_3d_instances_changed(void *instance, unsigned int id, unsigned int first, unsigned int last);
+// Backend-owned upload memory for texture slot index that the caller decodes into instead of passing bytes to
+// set_textures, laid out like the bytes of data, whose bytes are ignored. It may be written from any thread until
+// commit_texture, so several textures decode in parallel. Returns null for KTX2 files and formats that are transcoded
+// or that the device lacks. Mapping a slot again drops the memory mapped before.
+API void *map_texture(void *instance, unsigned int index, TextureData data);
+// Hands the texture mapped for slot index to the upload budget, which copies its levels on the GPU straight out of the
+// mapped memory. The slot keeps its previous contents until the copy completed, missing levels are generated.
+API void commit_texture(void *instance, unsigned int index);
+
+// Only skins whose bit in changed is set are copied, all are when the skin count changed. changed holds num_changed
+// bits from the least significant bit of each word on, skins past them count as changed and a null changed marks all.
+API void set_skins(void *instance, const SkinData *skins, unsigned int num_skins, const size_t *changed,
+                   unsigned int num_changed);
+// Stores the morph targets of full-format mesh id on the GPU, 0 targets removes them. Deltas are applied by the
+// skinning pass before skinning, into copies of the instances whose weights are not all 0.
+API void set_3d_morph_targets(void *instance, unsigned int id, const MorphTargetData *targets,
+                              unsigned int num_targets);
+// Weights of the morph targets of mesh id, weights[i * num_targets + t] weighs target t for instance i. Only the
+// weights are uploaded, they can be set every frame.
+API void set_3d_morph_weights(void *instance, unsigned int id, const float *weights, unsigned int num_instances);
+// Stores the keyframes of animation clip id on the GPU, 0 channels removes it.
+API void set_animation_clip(void *instance, unsigned int id, const AnimationChannel *channels,
+                            unsigned int num_channels);
+// Stores skeleton id on the GPU, 0 joints removes it. Skeletons have at most MAX_SKELETON_JOINTS joints.
+API void set_skeleton(void *instance, unsigned int id, SkeletonData skeleton);
+// Samples the joint matrices of skin from the clips of layers on the GPU with skeleton, instead of taking those of
+// set_skins. Only layers and times are uploaded, they can be set every frame. 0 layers returns the skin to set_skins.
+API void set_skin_animation(void *instance, unsigned int skin, unsigned int skeleton, const AnimationLayer *layers,
+                            unsigned int num_layers);
+
+// Lights are copied and shaded with tiled forward lighting, point and spot lights reach as far as their radiance stays
+// above 1/256.
+API void set_point_lights(void *instance, const PointLight *lights, unsigned int num_lights);
+API void set_spot_lights(void *instance, const SpotLight *lights, unsigned int num_lights);
+// Emissive triangles, the light tree over them is rebuilt on the GPU by the next frame. Tiles are lit by the lights
+// whose range reaches them and the path tracer samples one by walking down the tree.
+API void set_area_lights(void *instance, const AreaLight *lights, unsigned int num_lights);
+API void set_directional_lights(void *instance, const DirectionalLight *lights, unsigned int num_lights);
+
+// Only materials and textures whose bit in changed is set are uploaded, all materials are when the material count grew
+// and new textures always are. Bitsets are laid out like those of set_skins. Textures in the KTX2 format are read from
+// the file in bytes, whose levels may be zlib supercompressed and must be in a format DataFormat has, Basis Universal
+// files need to be transcoded before. Files that can't be read upload a white texture.
+API void set_materials(void *instance, const DeviceMaterial *materials, unsigned int num_materials,
+                       const size_t *changed, unsigned int num_changed);
+API void set_textures(void *instance, const TextureData *data, unsigned int num_textures, const size_t *changed,
+                      unsigned int num_changed);
+// Equirectangular skybox drawn behind 3D geometry. It is prefiltered on the GPU once, the prefiltered reflections and
+// irradiance replace the constant ambient light. A skybox without data removes it.
+API void set_skybox(void *instance, TextureData skybox);
+
+// Reflection probes capture the scene around their position into cube maps whose reflections replace those of the
+// skybox within their radius, up to MAX_REFLECTION_PROBES. Probes are baked again after they moved or a mesh changed
+// within their radius, faces_per_frame faces at a time, 1 by default and 0 pauses baking.
+API void set_reflection_probes(void *instance, const ReflectionProbe *probes, unsigned int count);
+API void set_reflection_probe_budget(void *instance, unsigned int faces_per_frame);
 
-API void set_materials(void *instance, const DeviceMaterial *materials, unsigned int num_materials);
-API void set_textures(void *instance, const TextureData *data, unsigned int num_textures, const unsigned int *changed);
+// Irradiance volume of probes traced against the acceleration structures of the full-format 3D meshes, which lights
+// the rasterized views in place of the skybox irradiance or the constant ambient light. Probes store their irradiance
+// and distances to the geometry, which keeps light from leaking through walls. Every frame traces the next probes its
+// ray budget covers, GI_RAYS_PER_PROBE rays each and 16384 by default or 0 to pause updates, and the scene is lit once
+// every probe was traced. Hits are lit by the directional lights, a point or spot light at random and the previous
+// irradiance, so light bounces more with every update. Counts are clamped to GI_MAX_PROBES_PER_AXIS, a count of 0
+// removes the volume and a bias of 0 moves lookups a quarter of the closest spacing off surfaces. Ignored before
+// macOS 11.
+API void set_gi_volume(void *instance, GiVolume volume);
+API void set_gi_ray_budget(void *instance, unsigned int rays_per_frame);
+// Bakes the indirect light of static meshes into a lightmap on the GPU. The second texture coordinates of their
+// vertices, pad0 and pad1 of Vertex3D, lay out all of their instances in the lightmap without overlapping. The texel
+// pass rasterizes the world positions and normals of the texels at those coordinates, then the path tracing kernels
+// trace batches of paths off the texels over the next frames. The samples are filtered between texels of the same
+// surface, charts are grown by a texel and the lightmap is bound to its slot as RGB9E5. Direct light is left to the
+// lights of the rasterizer. Packed and skinned meshes are left out. Queuing a bake into the same slot replaces the
+// queued one. Ignored before macOS 11.
+API void bake_lightmap(void *instance, LightmapSettings settings);
+// Makes the fragments of material take their ambient light from the lightmap in texture slot `texture` at their
+// second texture coordinates, in place of the irradiance volume, the skybox harmonics or the constant ambient light.
+// ~0u removes it. The G-buffer of deferred shading has no room for it.
+API void set_material_lightmap(void *instance, unsigned int material, unsigned int texture);
 
-API void render(void *instance, simd_float4x4 matrix_2d, CameraView3D view_3d);
+// Scene caches store meshes, instances, materials and textures in the layouts the setters above take, so a cached
+// scene loads without going through its source files again. Loading maps the file and sets its contents as if they
+// were passed to set_materials, set_textures, set_3d_meshes_batch and set_3d_instances_batch, meshes point into the
+// mapping and textures are copied to the GPU straight out of it. The instance keeps the mapping. Meshes with
+// triangles are stored with the signed distance field of set_sdf_tracing built from them, which loading copies
+// instead of generating. Both return 1 on success, loading fails for files of another cache version or struct layout,
+// which need to be written again.
+API unsigned int write_scene_cache(const char *path, SceneCacheData data);
+API unsigned int load_scene_cache(void *instance, const char *path);
+
+// Asset files are read straight into GPU textures by Metal fast resource loading, without passing through memory the
+// caller owns. Compressed files are split into chunks of chunk_size bytes that are decompressed independently, 0 uses
+// the default size, offsets of FileTexture are offsets into the uncompressed bytes. load_file_textures sets the
+// textures at indices, growing the texture table like set_textures, and each slot shows its previous contents until
+// its texture was read. Higher priorities are read first, e.g. for textures near the camera. Both return 1 on
+// success and need macOS 13, slots whose texture could not be read keep their previous contents.
+API unsigned int write_asset_file(const char *path, const void *bytes, unsigned long long size,
+                                  AssetCompression compression, unsigned long long chunk_size);
+API unsigned int load_file_textures(void *instance, const char *path, AssetCompression compression,
+                                    const unsigned int *indices, const FileTexture *textures, unsigned int count);
+
+// Recorders let several threads prepare mesh, instance and material updates at once, each thread records into its own
+// recorder. Recorded data is copied, submitted commands are applied in submission order by the next synchronize().
+// Recorders must be destroyed before their instance.
+API void *create_command_recorder(void *instance);
+API void destroy_command_recorder(void *recorder);
+API void record_3d_mesh(void *recorder, unsigned int id, MeshData3D data);
+API void record_3d_instances(void *recorder, unsigned int id, InstancesData3D data);
+API void record_materials(void *recorder, const DeviceMaterial *materials, unsigned int num_materials);
+// Hands the commands recorded so far to the instance without locking, safe to call while other threads submit.
+API void submit_command_recorder(void *recorder);
+
+API FrameStatus render(void *instance, simd_float4x4 matrix_2d, CameraView3D view_3d, RenderMode3D mode);
+// Renders like render and calls callback with the BGRA8 pixels of the frame once the GPU finished it, on a thread of
+// Metal's choosing. pixels is only valid during the call, it is null when the frame failed and for instances with a
+// window, whose drawables can't be read back. Frames keep rendering while earlier ones are read back. Skipped frames
+// don't call callback.
+API FrameStatus render_to_buffer(void *instance, simd_float4x4 matrix_2d, CameraView3D view_3d, RenderMode3D mode,
+                                 ReadbackCallback callback, void *user_data);
+// Picks the 3D instances at count pixels, given as x and y pairs, in the next rendered frame. A pass scissored to the
+// rectangle around the pixels draws instance ids and copies the pixels back, callback gets the results once the frame
+// completed, on a thread of Metal's choosing. Frames are never waited on for picks, results of failed frames miss.
+API void pick(void *instance, const unsigned int *pixels, unsigned int count, PickCallback callback, void *user_data);
+// Streams the rendered frames encoded by the hardware H.264 or HEVC encoder, for remote viewing. Headless frames render
+// into IOSurface-backed buffers of the encoder's pool, the drawables of a window are copied into one on the GPU, so no
+// frame passes through the CPU. callback gets the packets in frame order on a thread of VideoToolbox's choosing. Frames
+// are dropped while the encoder holds 6 of them, frames of extended range HDR are not streamed. A new drawable size
+// starts the stream over with a keyframe. Returns 0 when the device has no hardware encoder for the codec.
+API unsigned int start_video_stream(void *instance, VideoStreamSettings settings, VideoPacketCallback callback,
+                                    void *user_data);
+// Returns once the packets of the frames the encoder holds were delivered, frames in flight are not streamed.
+API void stop_video_stream(void *instance);
+// Makes the next streamed frame a keyframe, for viewers that join a running stream or lost packets.
+API void request_video_keyframe(void *instance);
+// Traces count rays against the acceleration structures of the 3D scene in the next rendered frame, which builds them
+// for the queries when ray tracing is off. any_hit accepts the first intersection found instead of the closest one.
+// callback gets the hits once the frame completed, on a thread of Metal's choosing, failed frames miss. Returns 0 and
+// never calls callback before macOS 11.
+API unsigned int trace_rays(void *instance, const RayQuery *rays, unsigned int count, unsigned int any_hit,
+                            RayQueryCallback callback, void *user_data);
+// Adds or moves visibility group id, whose world space bounds are tested against the depth pre-pass of every frame
+// that has one. The boxes don't write depth and never hide anything.
+API void set_visibility_group(void *instance, unsigned int id, Aabb bounds);
+API void remove_visibility_group(void *instance, unsigned int id);
+// Samples of the bounds of group id that passed the depth test in the last completed frame that tested it, which is
+// never waited on; 0 means nothing of the group can be seen. Groups that weren't tested yet and groups around the
+// camera return VISIBILITY_UNTESTED, unknown groups 0.
+API unsigned long long visibility_samples(void *instance, unsigned int id);
+// Bakes the potentially visible set of the static meshes in settings.bounds over the next frames by tracing rays
+// against the acceleration structures of the 3D scene, which builds them for the bake when ray tracing is off. Hits on
+// a mesh of a prefab make the whole prefab visible. callback gets the set on a thread of Metal's choosing once the last
+// frame completed, unless it failed, and the bake starts over when meshes are added or removed while it runs. Returns
+// 0 and never calls callback before macOS 11.
+API unsigned int bake_pvs(void *instance, PvsSettings settings, PvsCallback callback, void *user_data);
+// Hides the meshes of the set that can't be seen from the cell of the camera from the rasterized 3D view, before its
+// instances are culled on the CPU or the GPU. Meshes the set doesn't name, shadows, inset views and cameras outside
+// its bounds are never hidden. The set is copied, a null bits pointer removes it.
+API void set_pvs(void *instance, PvsData pvs);
+// Immediate mode debug drawing. Lines are collected until the next render, which copies them into its upload ring,
+// draws them into the 3D scene with two instanced draws and drops them, so they are given again for every frame they
+// should show. Lines with depth_test are hidden by the scene, the others are drawn on top of it.
+API void debug_lines(void *instance, const DebugLine *lines, unsigned int count, unsigned int depth_test);
+API void debug_line(void *instance, Vector3 start, Vector3 end, unsigned int color, float width,
+                    unsigned int depth_test);
+// The 12 edges of bounds.
+API void debug_aabb(void *instance, Aabb bounds, unsigned int color, float width, unsigned int depth_test);
+// A circle around each axis through center.
+API void debug_sphere(void *instance, Vector3 center, float radius, unsigned int color, float width,
+                      unsigned int depth_test);
 API void synchronize(void *instance);
+// Runs synchronize on a background queue and returns right away, so the range updates, copies into the shared buffers
+// and waits for frames in flight it may need stay off the calling thread. Changes are applied in the background while
+// the caller goes on with the game update of the next frame, and show from the next render, which waits for them at
+// the frame boundary. Until the next synchronize, set_3d_mesh, set_3d_instances and set_materials copy what they are
+// given like command recorders and are applied by it, every other call waits for the background queue and applies
+// those copies first. Data given before must stay valid until the background queue is done, see set_copy_on_submit.
+// The eviction callback is called on the background queue.
+API void synchronize_async(void *instance);
+API void wait_for_synchronize(void *instance);
 
+// Render targets are recreated by the next render, so resizing several times between frames reallocates them once.
 API void resize(void *instance, unsigned int width, unsigned int height, double scale_factor);
+
+// Surfaces are further windows drawn by the same instance, they share all of its meshes, textures and pipelines.
+// Surface 0 is the window of create_instance, render and resize apply to the selected surface. add_surface returns ~0u
+// without a window, select_surface 0 when there is no such surface.
+API unsigned int add_surface(void *instance, void *ns_window, unsigned int width, unsigned int height,
+                             double scale_factor);
+API void remove_surface(void *instance, unsigned int surface);
+API unsigned int select_surface(void *instance, unsigned int surface);
+
+// Number of frames the CPU may encode ahead of the GPU, clamped to [1, 3].
+API void set_frames_in_flight(void *instance, unsigned int count);
+
+// Maximum number of bytes of 3D geometry moved per frame to fill holes left by unloaded meshes, 0 disables it.
+API void set_vertex_compaction_budget(void *instance, unsigned int bytes_per_frame);
+// Merges identical vertices of meshes that are set without indices, 0 disables it.
+API void set_mesh_welding(void *instance, unsigned int enabled);
+// Merges the opaque STATIC meshes with a single instance at rest whose bounds are centered in the same cell into one
+// mesh in world space per cell, which is culled by the bounds of the cell and drawn once. Batches are built at
+// synchronize and only built again when a static mesh, its instance or these settings change. Meshes in a batch keep
+// their geometry and instances but are not drawn themselves, cells with one mesh are not batched.
+API void set_static_batching(void *instance, StaticBatching batching);
+// Copies mesh and 2D instance data set after this call when it is set, so the caller may free it right away rather than
+// keeping it alive until synchronize(). Copies of meshes are dropped once they reside in buffers in shared memory, 0
+// reads from the caller's pointers again. 3D instances are always copied.
+API void set_copy_on_submit(void *instance, unsigned int enabled);
+// Spreads large uploads over frames. Once the synchronizes and scene calls of a frame staged the budget, further meshes
+// and bands of texture rows are left to the synchronizes of the next frames. Meshes draw nothing and textures keep
+// their previous contents or the fallback until they are uploaded whole, their data must stay valid until then unless
+// copy on submit is enabled. Buffers that grow keep their contents rather than uploading every mesh again. Streamed,
+// packed and transcoded textures upload at once, a single mesh larger than the budget uploads in one frame. All zeros,
+// the default, uploads everything at once.
+API void set_upload_budget(void *instance, UploadBudget budget);
+// Returns how many meshes and textures wait for the upload budget of a later frame, synchronize uploads them.
+API unsigned int pending_uploads(void *instance);
+// Vertex layout used for 3D meshes set after this call, skinned meshes always use the full layout.
+API void set_3d_vertex_format(void *instance, VertexFormat3D format);
+// Culls 3D instances against the view frustum with a compute pass and draws the visible ones indirectly. GPUs with
+// tier 1 argument buffers, such as Intel ones, cull on the CPU across all cores instead, without occlusion and cluster
+// culling.
+API void set_gpu_culling(void *instance, unsigned int enabled);
+// Encodes vertex compaction, skinning, instance animation and acceleration structure updates on a compute queue of
+// their own, which starts on the next frame once the 3D passes of the previous one drew its geometry. It overlaps
+// the end of the previous frame, the 3D passes wait for it through an event.
+API void set_async_compute(void *instance, unsigned int enabled);
+// Encodes the draws of full-format 3D meshes into an indirect command buffer on the GPU, only when meshes or
+// instances change. With GPU culling the culled draws are encoded into it every frame once culling ran.
+API void set_gpu_driven_draws(void *instance, unsigned int enabled);
+// Keeps 3D geometry in GPU-only memory and uploads it through a staging buffer, which saves the CPU-side copy on
+// discrete GPUs. map_3d_mesh is unavailable while enabled.
+API void set_private_geometry(void *instance, unsigned int enabled);
+// Keeps the positions of full-format 3D vertices in a stream of their own, which the depth pre-pass, the shadow passes
+// and picking read instead of whole vertices. Costs 16 bytes per vertex of GPU memory, 0 disables it.
+API void set_position_stream(void *instance, unsigned int enabled);
+// Generates the mip chain of textures that are set with a single level on the GPU, 0 disables it. Block compressed
+// textures keep the levels they are set with.
+API void set_gpu_mipmaps(void *instance, unsigned int enabled);
+// Uploads 8-bit color textures set after this call uncompressed and encodes them into BC7 on the upload queue, with a
+// kernel that takes the principal axis of every block as its endpoints, so they take a quarter of the memory. Textures
+// with mips generated by set_gpu_mipmaps are encoded after the chain was generated. Sides must be multiples of 4 texels
+// and the device must support BC formats, other textures stay uncompressed. Transcoded textures are neither streamed
+// nor packed. 0 disables it, the default.
+API void set_texture_transcoding(void *instance, unsigned int enabled);
+// Stores uncompressed color textures set after this call with lossy compression on GPUs that have it, from the A15 and
+// M2 on, which about halves their memory and the bandwidth of sampling them at a small loss of quality. Packed,
+// transcoded and block compressed textures are unaffected. Render targets are compressed losslessly by those GPUs
+// either way. 0 disables it, the default.
+API void set_lossy_textures(void *instance, unsigned int enabled);
+// Shows pixel_buffer, a CVPixelBufferRef of BGRA or 8-bit biplanar 4:2:0 YCbCr, in texture slot index without copying
+// it. Its planes are wrapped as textures with a CVMetalTextureCache and converted into the texture of the slot on the
+// GPU by the next rendered frame, YCbCr with the BT.601 matrix when the buffer is tagged with it and BT.709 otherwise.
+// The slot keeps a reference to the newest buffer and releases the one it replaces once the frames in flight that read
+// it completed, so a decoder's buffer pool only reuses buffers the GPU is done with. The first frame and frames of
+// another size bind a new texture with the next synchronize, any other texture set into the slot ends the video.
+// Returns 0 for other pixel formats.
+API unsigned int set_video_frame(void *instance, unsigned int index, void *pixel_buffer);
+// Like set_video_frame with an IOSurfaceRef, which is wrapped into a pixel buffer.
+API unsigned int set_video_surface(void *instance, unsigned int index, void *io_surface);
+// Textures set after this call whose sides are at most max_size texels are packed into the layers of 2D texture
+// arrays with other textures of the same format, size and levels, so render passes make a few arrays resident instead
+// of every texture. Streamed textures and formats the device lacks keep textures of their own, as do all textures
+// when max_size is 0. Packed textures are not shared by set_deduplication. Defaults to 256, at most 1024.
+API void set_texture_packing(void *instance, unsigned int max_size);
+// Textures set with their mip levels after this call only upload the levels up to 256 texels, finer levels stream in
+// once the 3D pass samples them and are evicted again when no longer sampled and the streamed levels exceed megabytes.
+// 0 uploads all levels of textures set after it.
+API void set_texture_budget(void *instance, unsigned int megabytes);
+// Virtual textures are material maps with more texels than fit the GPU, only the tiles of VIRTUAL_TILE_SIZE texels
+// the 3D pass samples stay in a cache of tiles. Tiles load coarse to fine as texture feedback requests them and evict
+// the tiles requested longest ago, sampling the finest resident tile bilinearly. Data needs BGRA8 or RGBA8 levels down
+// to one that fits a tile and must stay valid until the slot is set again, e.g. in a mapped scene cache. The slot of
+// index grows the texture table and is replaced by set_textures and load_file_textures like any other, returns 0 for
+// unsupported data. Virtual textures are only sampled as material maps, not by 2D meshes.
+API unsigned int set_virtual_texture(void *instance, unsigned int index, TextureData data);
+// Megabytes of the tile cache, 64 by default, and of the tiles uploaded per frame, 4 by default. Resizing the cache
+// drops every tile.
+API void set_virtual_texture_budget(void *instance, unsigned int cache_megabytes, unsigned int upload_megabytes);
+// Lays down the depth of all 3D geometry with a position-only pass first, so the main pass shades every pixel once. 0
+// disables it, it still runs while lights are set.
+API void set_depth_prepass(void *instance, unsigned int enabled);
+// Replaces the depth pre-pass of forward frames with GPU culling by a visibility buffer of the instance and triangle of
+// every pixel. The main pass then shades each opaque pixel once from the triangle it holds, the material maps sampled
+// with derivatives reconstructed from the triangle. Multisampled, deferred, rate mapped and temporal frames keep the
+// pre-pass, 0 disables it.
+API void set_visibility_buffer(void *instance, unsigned int enabled);
+// Extends GPU culling with two-phase occlusion culling against a depth pyramid. Instances are first tested against the
+// pyramid of the previous frame, the rejected ones again against the depth of the instances drawn so far. Renders a
+// depth pre-pass while enabled, 0 disables it.
+API void set_occlusion_culling(void *instance, unsigned int enabled);
+// Splits static indexed 3D meshes set after this call into clusters of up to CLUSTER_TRIANGLES triangles when they are
+// large enough. With GPU culling, the camera then only draws the clusters of visible instances that face it and lie in
+// its frustum, 0 disables it.
+API void set_cluster_culling(void *instance, unsigned int enabled);
+// Meshes flagged SHADOW_CASTER cast shadows of the first directional light up to distance from the camera, and of the
+// first MAX_SPOT_SHADOWS spot lights. Shadow maps are only redrawn where casters moved, 0 disables shadows.
+API void set_shadow_distance(void *instance, float distance);
+// Stores shadow maps as 16-bit unsigned normalized depth instead of 32-bit floats, which halves their memory and the
+// bandwidth of drawing and sampling them. Spot shadows get a larger bias to make up for the precision. 0 disables it.
+API void set_unorm16_shadows(void *instance, unsigned int enabled);
+// Splits the 3D draws of the depth pre-pass and main pass across up to count threads of the system dispatch queues,
+// each encoding its chunk of meshes into a parallel render encoder. 0 or 1 encodes all draws on the rendering thread.
+API void set_encoding_threads(void *instance, unsigned int count);
+// Traces the shadow of the first directional light and ambient occlusion against acceleration structures of the
+// full-format 3D meshes, traced shadows replace its shadow cascades. 0 disables it, ignored before macOS 11. GPUs
+// without ray tracing support trace this and every other ray against a BVH of four children per node that the CPU
+// builds and compute kernels traverse, which leaves skinned instances out.
+API void set_ray_tracing(void *instance, unsigned int enabled);
+// Denoises every sample of RENDER_PATH_TRACED on its own, guided by the first hits of its paths and the denoised
+// samples of previous frames, instead of accumulating samples while the view doesn't change. 0 disables it.
+API void set_path_tracer_denoiser(void *instance, unsigned int enabled);
+// Stops accumulating samples of RENDER_PATH_TRACED once a render converged, renders start over whenever the view or
+// the scene changes. Samples only trace tiles of PATH_TRACER_TILE_SIZE pixels whose error, the mean standard error of
+// their pixels relative to the square root of their luminance, was above threshold after min_samples, and tiles stop
+// after max_samples. Renders stop once every tile converged, after max_samples or after time_budget seconds. A
+// threshold of 0 traces every pixel, max_samples and time_budget of 0 don't limit renders. Ignored by the denoiser.
+API void set_path_tracer_convergence(void *instance, float threshold, unsigned int min_samples,
+                                     unsigned int max_samples, float time_budget);
+API void get_path_tracer_progress(void *instance, PathTracerProgress *progress);
+// Distance up to which geometry occludes the ambient light, 1 by default.
+API void set_ambient_occlusion_radius(void *instance, float radius);
+// Darkens the ambient light by screen space ambient occlusion of the pre-pass depth, computed at half resolution and
+// blurred. Traced occlusion replaces it while ray tracing is enabled, 0 disables it.
+API void set_ssao(void *instance, unsigned int enabled);
+// Traces the reflections of the pre-pass depth at half resolution. Rays march through a pyramid of the closest depth
+// first and take the color of the previous frame where they hit in screen space, only the rays that leave the view or
+// pass behind geometry are traced against the scene on GPUs that support ray tracing. Reflections accumulate over
+// frames and the main pass blends them over those of the probes and the skybox. Frames with reflections take the
+// overlay pass of scaled frames and are shaded at full rate.
+API void set_reflections(void *instance, ReflectionSettings settings);
+// Traces soft shadows of the first directional light and long range ambient occlusion through signed distance fields
+// of the full-format 3D meshes where ray tracing is disabled, written like those of set_ray_tracing. Fields of the
+// meshes are generated on the GPU over a few frames after they were set, from their triangles or else from their
+// vertices, and merged into nested levels around the camera wherever the camera or instances move. Skinned instances
+// are left out.
+API void set_sdf_tracing(void *instance, SdfSettings settings);
+// Antialiases the forward 3D pass with 2 or 4 samples per pixel, resolved into the drawable within the pass. Deferred
+// and traced views are not antialiased. 1 disables it, counts the GPU does not support fall back to no MSAA.
+API void set_msaa_samples(void *instance, unsigned int samples);
+// Renders the 3D view at a fraction of the drawable size between 0.5 and 1, upscaled into the drawable before 2D is
+// drawn at full size. Upscaling is temporal with MetalFX on macOS 13 and later and bilinear before. Scaled frames are
+// not multisampled, 1 renders at full size.
+API void set_render_scale(void *instance, float scale);
+// Adjusts the render scale between min_scale and max_scale to keep the GPU time of frames below target_ms, measured
+// over a window of completed frames. Scales drop as soon as frames are over the target and only rise again when they
+// are well below it, every change creates the scaled targets again within the heap of max_scale. Replaces the scale
+// of set_render_scale while enabled, a target of 0 disables it.
+API void set_dynamic_resolution(void *instance, float target_ms, float min_scale, float max_scale);
+// Lowers quality in steps while the thermal state of the system is elevated or low power mode is on: first the render
+// scale and level of detail, then the cascade shadow resolution and SSAO, and at the last level the frame rate, which
+// is capped at 30. Levels rise with the pressure right away and fall one at a time once it stayed lower for 15
+// seconds. The level is reported in FrameStats, 0 disables the governor.
+API void set_quality_governor(void *instance, unsigned int enabled);
+// Chooses the filters of the default and 2D entries of the sampler table, one of the other SAMPLER_ entries. Materials
+// sample with the default entry unless their sampler picks another one. Both filter between mip levels, anisotropic
+// filtering takes up to max_anisotropy samples between 1 and 16. Defaults to anisotropic 3D with 8 samples and
+// trilinear, clamped 2D.
+API void set_texture_filtering(void *instance, unsigned int sampler_3d, unsigned int sampler_2d,
+                               unsigned int max_anisotropy);
+// Renders 3D in high dynamic range, radiance is multiplied by exposure before it is tonemapped. HDR frames take the
+// overlay pass of scaled frames, they are multisampled at full size.
+API void set_hdr(void *instance, HdrMode mode, float exposure);
+// Applies post effects in the overlay pass of scaled frames, which frames take while any effect is on. The bloom
+// pyramid is downsampled and added back up in compute passes, then the overlay pass adds it, tonemaps, grades and
+// darkens the view in a single draw into the drawable before 2D is drawn. Its pipelines are compiled for the effects
+// that are on whenever they change.
+API void set_post_processing(void *instance, PostProcessSettings settings);
+// Grades the tonemapped view through a size by size by size LUT of RGBA8 texels, with red varying fastest and blue
+// slowest. Null texels or a size below 2 remove it.
+API void set_color_grading_lut(void *instance, const unsigned char *texels, unsigned int size);
+// Antialiases 3D temporally, every frame is drawn with another sub-pixel jitter and blended into the history of the
+// previous frames, reprojected with the motion vectors of the depth pre-pass. Its frames take the overlay pass of
+// scaled frames and are not multisampled. Frames upscaled by MetalFX or shaded with a rate map are not affected.
+API void set_temporal_antialiasing(void *instance, unsigned int enabled);
+// Sets how frames are presented, min_frame_duration is in seconds. Low latency keeps 2 drawables instead of 3, which
+// makes render wait for the display sooner but shows frames earlier. Offscreen frames are not presented. Layer frames
+// acquire their drawable once the passes that don't draw into it are committed.
+API void set_present_mode(void *instance, PresentMode mode, float min_frame_duration, unsigned int low_latency);
+// Longest time in seconds render waits for a frame in flight to complete and then for a drawable, 0 never waits. A
+// drawable that arrives late is kept for the next frame. Negative timeouts wait as long as Metal does, the default.
+API void set_frame_timeout(void *instance, float seconds);
+// Only draws frames when something changed since the last one while enabled, render returns FRAME_IDLE otherwise.
+// Changes are scene data, lights, the skybox, the animation time, video frames, the camera, the 2D matrix and the mode,
+// and settings that recreate render targets. Frames are drawn while picks, ray queries, bakes, render texture requests
+// or a path traced render are pending, and for a few frames after a change so temporal effects converge. A positive
+// heartbeat draws a frame at least every heartbeat seconds. Renders with a readback callback always draw.
+API void set_on_demand_rendering(void *instance, unsigned int enabled, float heartbeat);
+// Draws the next frame of an on-demand renderer, such as after a setting changed that isn't tracked.
+API void request_redraw(void *instance);
+// Shades the 3D view at lower rates in some regions, such as the periphery or areas under opaque UI. The screen is
+// split evenly into num_horizontal columns and num_vertical rows of zones, a zone is shaded at the rates of its column
+// and row between 0 and 1. The rate map is only recreated when the rates changed, so they can be set every frame. 2D
+// is drawn at full rate. Deferred and traced views and frames with occlusion culling ignore the rates. 0 zones
+// disable it, as do GPUs without rasterization rate maps.
+API void set_rasterization_rates(void *instance, const float *horizontal, unsigned int num_horizontal,
+                                 const float *vertical, unsigned int num_vertical);
+// Inset views, such as a minimap or a rear view, are drawn over every following frame in a single pass that renders
+// all of them from one stream of draws. They are lit by the directional lights and the ambient light only, without
+// shadows or occlusion. At most 8 views are drawn, 0 removes them.
+API void set_inset_views(void *instance, const InsetView3D *views, unsigned int count);
+// Shows a view of the scene in texture slot index, for materials such as monitors or mirrors. Views are lit like the
+// inset views and drawn before the frame that samples them, into a mipmapped texture of linear radiance that materials
+// show through their emissive map. A view that is due waits until the views of a frame fit in the budget, the longest
+// waiting ones are drawn first and a view above the budget is drawn on its own. The first view and views of another
+// size bind a new texture with the next synchronize, settings of the same size only change the view. Any other
+// texture set into the slot ends the view, a width or height of 0 leaves the slot with the fallback texture.
+API void set_render_texture(void *instance, unsigned int index, RenderTexture texture);
+// Draws the view of slot index again with the next frames, for RENDER_TEXTURE_ON_DEMAND views.
+API void request_render_texture(void *instance, unsigned int index);
+// Pixels of render textures drawn per frame, 1048576 by default and 0 pauses them.
+API void set_render_texture_budget(void *instance, unsigned int pixels_per_frame);
+// Pipelines are set up and compile in the background after create_instance returns, so a loading screen can keep
+// presenting while they do and meshes, textures and instances can be set meanwhile. Returns 1 once all of them
+// compiled. wait_for_pipelines blocks until then, synchronize, render, set_skybox and changes of the MSAA samples, the
+// HDR mode or the 16-bit shadows wait as well. notify_pipelines_ready calls callback once they compiled instead, right
+// away on a background thread when they already did.
+API unsigned int pipelines_ready(void *instance);
+API void wait_for_pipelines(void *instance);
+API void notify_pipelines_ready(void *instance, PipelinesReadyCallback callback, void *user_data);
+// Stats of the last frame the GPU completed, frames in flight are not reported yet.
+API void get_frame_stats(void *instance, FrameStats *stats);
+// Frames render submits are numbered from 1 in submission order, skipped frames get no number. Once a frame completed,
+// the GPU no longer reads memory that was handed over before it was submitted, so the caller may reuse or free it.
+API unsigned long long get_submitted_frame(void *instance);
+// Number of the last frame the GPU completed, frames complete in submission order.
+API unsigned long long get_completed_frame(void *instance);
+// Blocks until frame completed or timeout_ms passed, returns 1 when it completed. Frames that were not submitted yet
+// return 0 right away.
+API unsigned int wait_for_frame(void *instance, unsigned long long frame, unsigned int timeout_ms);
+// GPU memory of the instance by category, and of the device.
+API void get_memory_stats(void *instance, MemoryStats *stats);
+// Evicts meshes and textures by policy from every synchronize that finds the device over budget, vertex buffer space
+// that no mesh uses counts as available. callback may be null.
+API void set_memory_policy(void *instance, MemoryPolicy policy, MeshEvictionCallback callback, void *user_data);
+// Keeps up to megabytes each of unloaded full-format 3D meshes and of replaced textures in purgeable memory, textures
+// set again with the same data are bound without an upload. Textures placed in heaps are not cached. 0 disables the
+// cache, which is the default.
+API void set_resource_cache(void *instance, unsigned int megabytes);
+// Streams the cells of a world partition around the camera of the last frame. Every synchronize unloads the cells out
+// of range and loads those in range nearest first, so crossing into a region spreads its uploads over the frames
+// within the budget instead of setting everything at once. A load radius of 0 unloads every cell and stops streaming.
+// callback may be null.
+API void set_cell_streaming(void *instance, StreamingSettings settings, CellStreamingCallback callback,
+                            void *user_data);
+// Registers or replaces cell id, a cell that was loaded is unloaded right away and loads again once in range, as does
+// a removed one. Unloading removes the instances of its meshes like unload_3d_meshes, callback is where to set them
+// again. Like the eviction callback it is called on the background queue by synchronize_async.
+API void set_streaming_cell(void *instance, unsigned int id, StreamingCell cell);
+API void remove_streaming_cell(void *instance, unsigned int id);
+// Returns 1 while cell id is loaded.
+API unsigned int streaming_cell_loaded(void *instance, unsigned int id);
+// Meshes and textures set after enabling it whose data matches one already set share its vertex ranges or texture
+// instead of being uploaded again. Meshes are only compared with meshes the instance still has the data of, textures
+// only share textures placed in heaps. The instance keeps a copy of the data of every distinct texture it may share or
+// cache, which textures with the same hash are compared with. Disabled by default.
+API void set_deduplication(void *instance, unsigned int enabled);
+// Records the scene and frame calls the instance gets from now on into a file at path, with their data, so the frames
+// can be replayed by MetalCppReplay on another machine. Meshes, instances, skins, lights, materials, textures, the
+// skybox, the animation time, synchronize, render and resize are recorded, other settings, callbacks, mapped memory and
+// command recorders are not. compress compresses the file with LZ4. Starting a capture ends the previous one, returns
+// 1 when path could be written.
+API unsigned int start_capture(void *instance, const char *path, unsigned int compress);
+API void stop_capture(void *instance);
+// Captures the next frames into a .gputrace document in directory, or in the temporary directory when it is null, for
+// Xcode to open. Captures include every command buffer of the device from the start of the first frame on. Returns 0
+// when the process may not capture, which takes MTL_CAPTURE_ENABLED=1 in its environment.
+API unsigned int capture_gpu_frames(void *instance, const char *directory, unsigned int frames);
+// Captures the frames after the first frame that took more than threshold_ms on the GPU, as measured by
+// get_frame_stats. The trigger fires once and is armed again by calling this again, a threshold of 0 disarms it.
+// RFW_GPU_CAPTURE_THRESHOLD_MS, RFW_GPU_CAPTURE_FRAMES and RFW_GPU_CAPTURE_DIR arm it when the instance is created,
+// without a threshold the first RFW_GPU_CAPTURE_FRAMES frames are captured.
+API void set_gpu_capture_trigger(void *instance, const char *directory, float threshold_ms, unsigned int frames);
+// Draws an overlay over the top left corner of every frame with the CPU time of synchronize and render, the GPU time
+// of the passes, the draw counts, the bytes uploaded per frame and the GPU memory by category, with graphs of their
+// history. It is updated 4 times per second. RFW_METAL_HUD=1 enables it when the instance is created.
+API void set_performance_hud(void *instance, unsigned int enabled);
+// Frame pacing of the window as it was shown, measured from the presented times of the drawables. Pauses of more than
+// half a second between frames are not counted. Headless instances and macOS before 10.15.4 report nothing.
+API void get_frame_pacing(void *instance, FramePacingStats *stats);
+API void reset_frame_pacing(void *instance);
+// Times the draws of every 3D mesh in the main and transparency passes, which then don't overlap on the GPU and skip
+// the indirect command buffer, so frames take longer while enabled. Disabled, which is the default, frames don't pay
+// for it. Waits for the frames in flight.
+API void set_mesh_profiling(void *instance, unsigned int enabled);
+// The most expensive meshes of the last completed frame that was profiled, by GPU time, or by triangles where the GPU
+// can't time them.
+API void get_mesh_costs(void *instance, MeshCostStats *stats);
+// Records spans of the calls into the instance, of synchronize, its list updates and the encoding of frames on the CPU,
+// and of the command buffers and passes of frames on the GPU, into a ring of the last capacity spans, 0 takes 65536.
+// GPU times are mapped onto the CPU clock, so both timelines line up. Starting again drops the recorded spans.
+API void start_trace(void *instance, unsigned int capacity);
+API void stop_trace(void *instance);
+// Writes the recorded spans to path, also while recording, returns 1 when path could be written.
+API unsigned int write_trace(void *instance, const char *path, TraceFormat format);
+// Nanoseconds of the clock of the trace, CLOCK_UPTIME_RAW, for spans timed by the caller.
+API unsigned long long get_trace_time(void *instance);
+// Adds a span of the calling thread from start_ns to end_ns of get_trace_time while recording, name is copied.
+API void add_trace_span(void *instance, const char *name, unsigned long long start_ns, unsigned long long end_ns);
 #endif // CPP_LIBRARY_H
@@ -4,73 +4,1922 @@
 #include "renderer.hpp"
 #import <string.h>
 
+// The threads calling in have no autorelease pool, every entry point drains the objects it autoreleased. Entry points
+// that use the scene call finish_synchronize first, unless they defer their changes, see synchronize_async.
+
 extern "C" void *create_instance(void *ns_window, void *ns_view, unsigned int width, unsigned int height,
                                  double scale_factor)
 {
-    return reinterpret_cast<void *>(MetalRenderer::create_instance(ns_window, ns_view, width, height, scale_factor));
+    @autoreleasepool
+    {
+        return reinterpret_cast<void *>(
+            MetalRenderer::create_instance(ns_window, ns_view, width, height, scale_factor));
+    }
+}
+
+extern "C" void *create_instance_with_pipeline_cache(void *ns_window, void *ns_view, unsigned int width,
+                                                     unsigned int height, double scale_factor,
+                                                     const char *pipeline_cache)
+{
+    @autoreleasepool
+    {
+        return reinterpret_cast<void *>(
+            MetalRenderer::create_instance(ns_window, ns_view, width, height, scale_factor, pipeline_cache));
+    }
+}
+
+extern "C" void *create_instance_with_device(void *ns_window, void *ns_view, unsigned int width, unsigned int height,
+                                             double scale_factor, const char *pipeline_cache,
+                                             DevicePreference preference)
+{
+    @autoreleasepool
+    {
+        return reinterpret_cast<void *>(MetalRenderer::create_instance(ns_window, ns_view, width, height, scale_factor,
+                                                                       pipeline_cache, preference));
+    }
+}
+
+extern "C" unsigned int get_device_count(void)
+{
+    @autoreleasepool
+    {
+        return MetalRenderer::device_count();
+    }
+}
+
+extern "C" unsigned int get_device_info(unsigned int device_index, DeviceInfo *info)
+{
+    @autoreleasepool
+    {
+        return MetalRenderer::device_info(device_index, info) ? 1 : 0;
+    }
+}
+
+extern "C" void *create_instance_on_device(unsigned int device_index, void *ns_window, void *ns_view,
+                                           unsigned int width, unsigned int height, double scale_factor,
+                                           const char *pipeline_cache)
+{
+    @autoreleasepool
+    {
+        return reinterpret_cast<void *>(MetalRenderer::create_instance_on_device(
+            device_index, ns_window, ns_view, width, height, scale_factor, pipeline_cache));
+    }
+}
+
+extern "C" void *create_instance_in_view(void *ui_view, unsigned int width, unsigned int height, double scale_factor,
+                                         const char *pipeline_cache)
+{
+#if TARGET_OS_IPHONE
+    @autoreleasepool
+    {
+        return reinterpret_cast<void *>(
+            MetalRenderer::create_instance(ui_view, nullptr, width, height, scale_factor, pipeline_cache));
+    }
+#else
+    return nullptr;
+#endif
 }
 
 extern "C" void destroy_instance(void *instance)
 {
-    delete reinterpret_cast<MetalRenderer *>(instance);
+    @autoreleasepool
+    {
+        delete reinterpret_cast<MetalRenderer *>(instance);
+    }
+}
+
+extern "C" DeviceStatus get_device_status(void *instance)
+{
+    @autoreleasepool
+    {
+        MetalRenderer *renderer = reinterpret_cast<MetalRenderer *>(instance);
+        return renderer->device_status();
+    }
 }
 
 extern "C" void set_2d_mesh(void *instance, unsigned int id, MeshData2D data)
 {
-    MetalRenderer *renderer = reinterpret_cast<MetalRenderer *>(instance);
-    renderer->set_2d_mesh(id, data);
+    @autoreleasepool
+    {
+        MetalRenderer *renderer = reinterpret_cast<MetalRenderer *>(instance);
+        renderer->finish_synchronize();
+        TraceSpan span(renderer->trace(), "set_2d_mesh");
+        if (CommandCapture *capture = renderer->capture())
+            capture->set_2d_mesh(id, data);
+        renderer->set_2d_mesh(id, data);
+    }
 }
 extern "C" void set_2d_instances(void *instance, unsigned int id, InstancesData2D data)
 {
-    MetalRenderer *renderer = reinterpret_cast<MetalRenderer *>(instance);
-    renderer->set_2d_instances(id, data);
+    @autoreleasepool
+    {
+        MetalRenderer *renderer = reinterpret_cast<MetalRenderer *>(instance);
+        renderer->finish_synchronize();
+        TraceSpan span(renderer->trace(), "set_2d_instances");
+        if (CommandCapture *capture = renderer->capture())
+            capture->set_2d_instances(id, data);
+        renderer->set_2d_instances(id, data);
+    }
+}
+extern "C" void set_2d_instances_batch(void *instance, const unsigned int *ids, const InstancesData2D *data,
+                                       unsigned int count)
+{
+    @autoreleasepool
+    {
+        MetalRenderer *renderer = reinterpret_cast<MetalRenderer *>(instance);
+        renderer->finish_synchronize();
+        TraceSpan span(renderer->trace(), "set_2d_instances_batch");
+        if (CommandCapture *capture = renderer->capture())
+        {
+            for (unsigned int i = 0; i < count; i++)
+                capture->set_2d_instances(ids[i], data[i]);
+        }
+        renderer->set_2d_instances_batch(ids, data, count);
+    }
+}
+extern "C" void set_glyph_atlas(void *instance, unsigned int width, unsigned int height)
+{
+    @autoreleasepool
+    {
+        MetalRenderer *renderer = reinterpret_cast<MetalRenderer *>(instance);
+        renderer->finish_synchronize();
+        renderer->set_glyph_atlas(width, height);
+    }
+}
+extern "C" void update_glyph_atlas(void *instance, unsigned int x, unsigned int y, unsigned int width,
+                                   unsigned int height, const unsigned char *pixels, unsigned int bytes_per_row)
+{
+    @autoreleasepool
+    {
+        MetalRenderer *renderer = reinterpret_cast<MetalRenderer *>(instance);
+        renderer->finish_synchronize();
+        renderer->update_glyph_atlas(x, y, width, height, pixels, bytes_per_row);
+    }
+}
+extern "C" void set_glyphs(void *instance, unsigned int id, const GlyphInstance *glyphs, unsigned int count)
+{
+    @autoreleasepool
+    {
+        MetalRenderer *renderer = reinterpret_cast<MetalRenderer *>(instance);
+        renderer->finish_synchronize();
+        renderer->set_glyphs(id, glyphs, count);
+    }
+}
+
+extern "C" void set_sprites(void *instance, unsigned int id, const SpriteInstance *sprites, unsigned int count)
+{
+    @autoreleasepool
+    {
+        MetalRenderer *renderer = reinterpret_cast<MetalRenderer *>(instance);
+        renderer->finish_synchronize();
+        renderer->set_sprites(id, sprites, count);
+    }
+}
+
+extern "C" void set_2d_caching(void *instance, unsigned int enabled)
+{
+    @autoreleasepool
+    {
+        MetalRenderer *renderer = reinterpret_cast<MetalRenderer *>(instance);
+        renderer->finish_synchronize();
+        renderer->set_2d_caching(enabled != 0);
+    }
+}
+
+extern "C" void set_2d_clip(void *instance, unsigned int id, ClipRect2D rect)
+{
+    @autoreleasepool
+    {
+        MetalRenderer *renderer = reinterpret_cast<MetalRenderer *>(instance);
+        renderer->finish_synchronize();
+        renderer->set_2d_clip(id, rect);
+    }
+}
+
+extern "C" void remove_2d_clip(void *instance, unsigned int id)
+{
+    @autoreleasepool
+    {
+        MetalRenderer *renderer = reinterpret_cast<MetalRenderer *>(instance);
+        renderer->finish_synchronize();
+        renderer->remove_2d_clip(id);
+    }
+}
+
+extern "C" void set_2d_path(void *instance, unsigned int id, PathData2D path)
+{
+    @autoreleasepool
+    {
+        MetalRenderer *renderer = reinterpret_cast<MetalRenderer *>(instance);
+        renderer->finish_synchronize();
+        renderer->set_2d_path(id, path);
+    }
+}
+
+extern "C" void set_2d_path_transform(void *instance, unsigned int id, simd_float4x4 transform)
+{
+    @autoreleasepool
+    {
+        MetalRenderer *renderer = reinterpret_cast<MetalRenderer *>(instance);
+        renderer->finish_synchronize();
+        renderer->set_2d_path_transform(id, transform);
+    }
 }
 
 extern "C" void set_3d_mesh(void *instance, unsigned int id, MeshData3D data)
 {
-    MetalRenderer *renderer = reinterpret_cast<MetalRenderer *>(instance);
-    renderer->set_3d_mesh(id, data);
+    @autoreleasepool
+    {
+        MetalRenderer *renderer = reinterpret_cast<MetalRenderer *>(instance);
+        TraceSpan span(renderer->trace(), "set_3d_mesh");
+        if (CommandCapture *capture = renderer->capture())
+            capture->set_3d_mesh(id, data);
+        if (CommandRecorder *recorder = renderer->deferred_recorder())
+            recorder->set_3d_mesh(id, data);
+        else
+            renderer->set_3d_mesh(id, data);
+    }
 }
-extern "C" void unload_3d_meshes(void *instance, const unsigned int *ids, unsigned int num)
+extern "C" size_t encode_3d_vertices(const Vertex3D *vertices, unsigned int num_vertices, unsigned char *out,
+                                     size_t capacity)
 {
-    MetalRenderer *renderer = reinterpret_cast<MetalRenderer *>(instance);
-    renderer->unload_3d_meshes(ids, num);
+    return encode_vertices(vertices, num_vertices, sizeof(Vertex3D), out, capacity);
+}
+extern "C" size_t encode_3d_indices(const unsigned int *indices, unsigned int num_indices, unsigned char *out,
+                                    size_t capacity)
+{
+    return encode_indices(indices, num_indices, out, capacity);
+}
+extern "C" size_t encoded_3d_vertices_bound(unsigned int num_vertices)
+{
+    return encoded_vertices_bound(num_vertices, sizeof(Vertex3D));
+}
+extern "C" size_t encoded_3d_indices_bound(unsigned int num_indices)
+{
+    return encoded_indices_bound(num_indices);
+}
+extern "C" unsigned int set_3d_mesh_encoded(void *instance, unsigned int id, MeshData3D data, EncodedMesh3D encoded)
+{
+    @autoreleasepool
+    {
+        MetalRenderer *renderer = reinterpret_cast<MetalRenderer *>(instance);
+        renderer->finish_synchronize();
+        TraceSpan span(renderer->trace(), "set_3d_mesh_encoded");
+        return renderer->set_3d_mesh_encoded(id, data, encoded) ? 1 : 0;
+    }
+}
+extern "C" void unload_3d_meshes(void *instance, const size_t *ids, unsigned int num)
+{
+    @autoreleasepool
+    {
+        MetalRenderer *renderer = reinterpret_cast<MetalRenderer *>(instance);
+        renderer->finish_synchronize();
+        TraceSpan span(renderer->trace(), "unload_3d_meshes");
+        if (CommandCapture *capture = renderer->capture())
+            capture->unload_3d_meshes(ids, num);
+        renderer->unload_3d_meshes(ids, num);
+    }
+}
+extern "C" unsigned int restore_3d_mesh(void *instance, unsigned int id)
+{
+    @autoreleasepool
+    {
+        MetalRenderer *renderer = reinterpret_cast<MetalRenderer *>(instance);
+        renderer->finish_synchronize();
+        return renderer->restore_3d_mesh(id) ? 1 : 0;
+    }
 }
 extern "C" void set_3d_instances(void *instance, unsigned int id, InstancesData3D data)
 {
-    MetalRenderer *renderer = reinterpret_cast<MetalRenderer *>(instance);
-    renderer->set_3d_instances(id, data);
+    @autoreleasepool
+    {
+        MetalRenderer *renderer = reinterpret_cast<MetalRenderer *>(instance);
+        TraceSpan span(renderer->trace(), "set_3d_instances");
+        if (CommandCapture *capture = renderer->capture())
+            capture->set_3d_instances(id, data);
+        if (CommandRecorder *recorder = renderer->deferred_recorder())
+            recorder->set_3d_instances(id, data);
+        else
+            renderer->set_3d_instances(id, data);
+    }
+}
+
+extern "C" void set_3d_meshes_batch(void *instance, const unsigned int *ids, const MeshData3D *data,
+                                    unsigned int count)
+{
+    @autoreleasepool
+    {
+        MetalRenderer *renderer = reinterpret_cast<MetalRenderer *>(instance);
+        renderer->finish_synchronize();
+        TraceSpan span(renderer->trace(), "set_3d_meshes_batch");
+        if (CommandCapture *capture = renderer->capture())
+        {
+            for (unsigned int i = 0; i < count; i++)
+                capture->set_3d_mesh(ids[i], data[i]);
+        }
+        renderer->set_3d_meshes_batch(ids, data, count);
+    }
+}
+
+extern "C" void set_3d_instances_batch(void *instance, const unsigned int *ids, const InstancesData3D *data,
+                                       unsigned int count)
+{
+    @autoreleasepool
+    {
+        MetalRenderer *renderer = reinterpret_cast<MetalRenderer *>(instance);
+        renderer->finish_synchronize();
+        TraceSpan span(renderer->trace(), "set_3d_instances_batch");
+        if (CommandCapture *capture = renderer->capture())
+        {
+            for (unsigned int i = 0; i < count; i++)
+                capture->set_3d_instances(ids[i], data[i]);
+        }
+        renderer->set_3d_instances_batch(ids, data, count);
+    }
+}
+extern "C" void set_3d_mesh_lods(void *instance, unsigned int id, const MeshLod *levels, unsigned int num_levels)
+{
+    @autoreleasepool
+    {
+        MetalRenderer *renderer = reinterpret_cast<MetalRenderer *>(instance);
+        renderer->finish_synchronize();
+        renderer->set_3d_mesh_lods(id, levels, num_levels);
+    }
+}
+
+extern "C" void set_3d_prefab(void *instance, const PrefabMesh3D *meshes, unsigned int count)
+{
+    @autoreleasepool
+    {
+        MetalRenderer *renderer = reinterpret_cast<MetalRenderer *>(instance);
+        renderer->finish_synchronize();
+        renderer->set_3d_prefab(meshes, count);
+    }
+}
+
+extern "C" void set_3d_instance_animation(void *instance, unsigned int id, InstanceAnimation3D animation)
+{
+    @autoreleasepool
+    {
+        MetalRenderer *renderer = reinterpret_cast<MetalRenderer *>(instance);
+        renderer->finish_synchronize();
+        renderer->set_3d_instance_animation(id, animation);
+    }
+}
+
+extern "C" void set_3d_hierarchy(void *instance, const TransformNode *nodes, unsigned int num_nodes)
+{
+    @autoreleasepool
+    {
+        MetalRenderer *renderer = reinterpret_cast<MetalRenderer *>(instance);
+        renderer->finish_synchronize();
+        renderer->set_3d_hierarchy(nodes, num_nodes);
+    }
+}
+
+extern "C" void update_3d_hierarchy(void *instance, const unsigned int *nodes, const simd_float4x4 *locals,
+                                    unsigned int count)
+{
+    @autoreleasepool
+    {
+        MetalRenderer *renderer = reinterpret_cast<MetalRenderer *>(instance);
+        renderer->finish_synchronize();
+        renderer->update_3d_hierarchy(nodes, locals, count);
+    }
+}
+
+extern "C" void set_terrain(void *instance, unsigned int id, TerrainData terrain)
+{
+    @autoreleasepool
+    {
+        MetalRenderer *renderer = reinterpret_cast<MetalRenderer *>(instance);
+        renderer->finish_synchronize();
+        renderer->set_terrain(id, terrain);
+    }
+}
+
+extern "C" void set_3d_scatter(void *instance, unsigned int id, ScatterData scatter)
+{
+    @autoreleasepool
+    {
+        MetalRenderer *renderer = reinterpret_cast<MetalRenderer *>(instance);
+        renderer->finish_synchronize();
+        renderer->set_3d_scatter(id, scatter);
+    }
+}
+
+extern "C" void bake_3d_impostor(void *instance, unsigned int id, ImpostorSettings settings)
+{
+    @autoreleasepool
+    {
+        MetalRenderer *renderer = reinterpret_cast<MetalRenderer *>(instance);
+        renderer->finish_synchronize();
+        renderer->bake_3d_impostor(id, settings);
+    }
+}
+
+extern "C" void set_particle_emitter(void *instance, unsigned int id, ParticleEmitter emitter, unsigned int capacity)
+{
+    @autoreleasepool
+    {
+        MetalRenderer *renderer = reinterpret_cast<MetalRenderer *>(instance);
+        renderer->finish_synchronize();
+        renderer->set_particle_emitter(id, emitter, capacity);
+    }
+}
+
+extern "C" void emit_particles(void *instance, unsigned int id, unsigned int count)
+{
+    @autoreleasepool
+    {
+        MetalRenderer *renderer = reinterpret_cast<MetalRenderer *>(instance);
+        renderer->finish_synchronize();
+        renderer->emit_particles(id, count);
+    }
+}
+
+extern "C" unsigned int set_point_cloud(void *instance, unsigned int id, PointCloudData data)
+{
+    @autoreleasepool
+    {
+        MetalRenderer *renderer = reinterpret_cast<MetalRenderer *>(instance);
+        renderer->finish_synchronize();
+        return renderer->set_point_cloud(id, data) ? 1 : 0;
+    }
+}
+
+extern "C" void set_point_cloud_transform(void *instance, unsigned int id, simd_float4x4 transform)
+{
+    @autoreleasepool
+    {
+        MetalRenderer *renderer = reinterpret_cast<MetalRenderer *>(instance);
+        renderer->finish_synchronize();
+        renderer->set_point_cloud_transform(id, transform);
+    }
+}
+
+extern "C" void set_3d_instance_overrides(void *instance, unsigned int id, const InstanceOverride *overrides,
+                                          unsigned int count)
+{
+    @autoreleasepool
+    {
+        MetalRenderer *renderer = reinterpret_cast<MetalRenderer *>(instance);
+        renderer->finish_synchronize();
+        renderer->set_3d_instance_overrides(id, overrides, count);
+    }
+}
+
+extern "C" void set_animation_time(void *instance, float seconds)
+{
+    @autoreleasepool
+    {
+        MetalRenderer *renderer = reinterpret_cast<MetalRenderer *>(instance);
+        renderer->finish_synchronize();
+        TraceSpan span(renderer->trace(), "set_animation_time");
+        if (CommandCapture *capture = renderer->capture())
+            capture->set_animation_time(seconds);
+        renderer->set_animation_time(seconds);
+    }
+}
+
+extern "C" void set_materials(void *instance, const DeviceMaterial *materials, unsigned int num_materials,
+                              const size_t *changed, unsigned int num_changed)
+{
+    @autoreleasepool
+    {
+        MetalRenderer *renderer = reinterpret_cast<MetalRenderer *>(instance);
+        TraceSpan span(renderer->trace(), "set_materials");
+        if (CommandCapture *capture = renderer->capture())
+            capture->set_materials(materials, num_materials, changed, num_changed);
+        if (CommandRecorder *recorder = renderer->deferred_recorder())
+            recorder->set_materials(materials, num_materials);
+        else
+            renderer->set_materials(materials, num_materials, changed, num_changed);
+    }
+}
+extern "C" void *create_command_recorder(void *instance)
+{
+    @autoreleasepool
+    {
+        MetalRenderer *renderer = reinterpret_cast<MetalRenderer *>(instance);
+        return reinterpret_cast<void *>(renderer->create_command_recorder());
+    }
+}
+
+extern "C" void destroy_command_recorder(void *recorder)
+{
+    @autoreleasepool
+    {
+        delete reinterpret_cast<CommandRecorder *>(recorder);
+    }
+}
+
+extern "C" void record_3d_mesh(void *recorder, unsigned int id, MeshData3D data)
+{
+    @autoreleasepool
+    {
+        reinterpret_cast<CommandRecorder *>(recorder)->set_3d_mesh(id, data);
+    }
+}
+
+extern "C" void record_3d_instances(void *recorder, unsigned int id, InstancesData3D data)
+{
+    @autoreleasepool
+    {
+        reinterpret_cast<CommandRecorder *>(recorder)->set_3d_instances(id, data);
+    }
+}
+
+extern "C" void record_materials(void *recorder, const DeviceMaterial *materials, unsigned int num_materials)
+{
+    @autoreleasepool
+    {
+        reinterpret_cast<CommandRecorder *>(recorder)->set_materials(materials, num_materials);
+    }
+}
+
+extern "C" void submit_command_recorder(void *recorder)
+{
+    @autoreleasepool
+    {
+        reinterpret_cast<CommandRecorder *>(recorder)->submit();
+    }
+}
+
+extern "C" unsigned int write_scene_cache(const char *path, SceneCacheData data)
+{
+    @autoreleasepool
+    {
+        return SceneCache::write(path, data) ? 1 : 0;
+    }
+}
+
+extern "C" unsigned int load_scene_cache(void *instance, const char *path)
+{
+    @autoreleasepool
+    {
+        MetalRenderer *renderer = reinterpret_cast<MetalRenderer *>(instance);
+        renderer->finish_synchronize();
+        return renderer->load_scene_cache(path) ? 1 : 0;
+    }
+}
+
+extern "C" unsigned int write_asset_file(const char *path, const void *bytes, unsigned long long size,
+                                         AssetCompression compression, unsigned long long chunk_size)
+{
+    @autoreleasepool
+    {
+        return MetalRenderer::write_asset_file(path, bytes, size, compression, chunk_size) ? 1 : 0;
+    }
+}
+
+extern "C" unsigned int load_file_textures(void *instance, const char *path, AssetCompression compression,
+                                           const unsigned int *indices, const FileTexture *textures,
+                                           unsigned int count)
+{
+    @autoreleasepool
+    {
+        MetalRenderer *renderer = reinterpret_cast<MetalRenderer *>(instance);
+        renderer->finish_synchronize();
+        return renderer->load_file_textures(path, compression, indices, textures, count) ? 1 : 0;
+    }
+}
+
+extern "C" Vertex3D *map_3d_mesh(void *instance, unsigned int id, unsigned int num_vertices)
+{
+    @autoreleasepool
+    {
+        MetalRenderer *renderer = reinterpret_cast<MetalRenderer *>(instance);
+        renderer->finish_synchronize();
+        return renderer->map_3d_mesh(id, num_vertices);
+    }
+}
+
+extern "C" simd_float4x4 *map_3d_instances(void *instance, unsigned int id, unsigned int count)
+{
+    @autoreleasepool
+    {
+        MetalRenderer *renderer = reinterpret_cast<MetalRenderer *>(instance);
+        renderer->finish_synchronize();
+        return renderer->map_3d_instances(id, count);
+    }
+}
+
+extern "C" void mark_3d_instances_changed(void *instance, unsigned int id, unsigned int first, unsigned int last)
+{
+    @autoreleasepool
+    {
+        MetalRenderer *renderer = reinterpret_cast<MetalRenderer *>(instance);
+        renderer->finish_synchronize();
+        renderer->mark_3d_instances_changed(id, first, last);
+    }
+}
+
+extern "C" void *map_texture(void *instance, unsigned int index, TextureData data)
+{
+    @autoreleasepool
+    {
+        MetalRenderer *renderer = reinterpret_cast<MetalRenderer *>(instance);
+        renderer->finish_synchronize();
+        return renderer->map_texture(index, data);
+    }
+}
+
+extern "C" void commit_texture(void *instance, unsigned int index)
+{
+    @autoreleasepool
+    {
+        MetalRenderer *renderer = reinterpret_cast<MetalRenderer *>(instance);
+        renderer->finish_synchronize();
+        renderer->commit_texture(index);
+    }
+}
+
+extern "C" void set_skins(void *instance, const SkinData *skins, unsigned int num_skins, const size_t *changed,
+                          unsigned int num_changed)
+{
+    @autoreleasepool
+    {
+        MetalRenderer *renderer = reinterpret_cast<MetalRenderer *>(instance);
+        renderer->finish_synchronize();
+        TraceSpan span(renderer->trace(), "set_skins");
+        if (CommandCapture *capture = renderer->capture())
+            capture->set_skins(skins, num_skins, changed, num_changed);
+        renderer->set_skins(skins, num_skins, changed, num_changed);
+    }
+}
+
+extern "C" void set_3d_morph_targets(void *instance, unsigned int id, const MorphTargetData *targets,
+                                     unsigned int num_targets)
+{
+    @autoreleasepool
+    {
+        MetalRenderer *renderer = reinterpret_cast<MetalRenderer *>(instance);
+        renderer->finish_synchronize();
+        renderer->set_3d_morph_targets(id, targets, num_targets);
+    }
 }
 
-extern "C" void set_materials(void *instance, const DeviceMaterial *materials, unsigned int num_materials)
+extern "C" void set_3d_morph_weights(void *instance, unsigned int id, const float *weights, unsigned int num_instances)
 {
-    MetalRenderer *renderer = reinterpret_cast<MetalRenderer *>(instance);
-    renderer->set_materials(materials, num_materials);
+    @autoreleasepool
+    {
+        MetalRenderer *renderer = reinterpret_cast<MetalRenderer *>(instance);
+        renderer->finish_synchronize();
+        renderer->set_3d_morph_weights(id, weights, num_instances);
+    }
 }
+
+extern "C" void set_animation_clip(void *instance, unsigned int id, const AnimationChannel *channels,
+                                   unsigned int num_channels)
+{
+    @autoreleasepool
+    {
+        MetalRenderer *renderer = reinterpret_cast<MetalRenderer *>(instance);
+        renderer->finish_synchronize();
+        renderer->set_animation_clip(id, channels, num_channels);
+    }
+}
+
+extern "C" void set_skeleton(void *instance, unsigned int id, SkeletonData skeleton)
+{
+    @autoreleasepool
+    {
+        MetalRenderer *renderer = reinterpret_cast<MetalRenderer *>(instance);
+        renderer->finish_synchronize();
+        renderer->set_skeleton(id, skeleton);
+    }
+}
+
+extern "C" void set_skin_animation(void *instance, unsigned int skin, unsigned int skeleton,
+                                   const AnimationLayer *layers, unsigned int num_layers)
+{
+    @autoreleasepool
+    {
+        MetalRenderer *renderer = reinterpret_cast<MetalRenderer *>(instance);
+        renderer->finish_synchronize();
+        renderer->set_skin_animation(skin, skeleton, layers, num_layers);
+    }
+}
+
+extern "C" void set_point_lights(void *instance, const PointLight *lights, unsigned int num_lights)
+{
+    @autoreleasepool
+    {
+        MetalRenderer *renderer = reinterpret_cast<MetalRenderer *>(instance);
+        renderer->finish_synchronize();
+        TraceSpan span(renderer->trace(), "set_point_lights");
+        if (CommandCapture *capture = renderer->capture())
+            capture->set_lights(CaptureOp::SET_POINT_LIGHTS, lights, num_lights);
+        renderer->set_point_lights(lights, num_lights);
+    }
+}
+
+extern "C" void set_spot_lights(void *instance, const SpotLight *lights, unsigned int num_lights)
+{
+    @autoreleasepool
+    {
+        MetalRenderer *renderer = reinterpret_cast<MetalRenderer *>(instance);
+        renderer->finish_synchronize();
+        TraceSpan span(renderer->trace(), "set_spot_lights");
+        if (CommandCapture *capture = renderer->capture())
+            capture->set_lights(CaptureOp::SET_SPOT_LIGHTS, lights, num_lights);
+        renderer->set_spot_lights(lights, num_lights);
+    }
+}
+
+extern "C" void set_area_lights(void *instance, const AreaLight *lights, unsigned int num_lights)
+{
+    @autoreleasepool
+    {
+        MetalRenderer *renderer = reinterpret_cast<MetalRenderer *>(instance);
+        renderer->finish_synchronize();
+        TraceSpan span(renderer->trace(), "set_area_lights");
+        if (CommandCapture *capture = renderer->capture())
+            capture->set_lights(CaptureOp::SET_AREA_LIGHTS, lights, num_lights);
+        renderer->set_area_lights(lights, num_lights);
+    }
+}
+
+extern "C" void set_directional_lights(void *instance, const DirectionalLight *lights, unsigned int num_lights)
+{
+    @autoreleasepool
+    {
+        MetalRenderer *renderer = reinterpret_cast<MetalRenderer *>(instance);
+        renderer->finish_synchronize();
+        TraceSpan span(renderer->trace(), "set_directional_lights");
+        if (CommandCapture *capture = renderer->capture())
+            capture->set_lights(CaptureOp::SET_DIRECTIONAL_LIGHTS, lights, num_lights);
+        renderer->set_directional_lights(lights, num_lights);
+    }
+}
+
 extern "C" void set_textures(void *instance, const TextureData *const data, unsigned int num_textures,
-                             const unsigned int *changed)
+                             const size_t *changed, unsigned int num_changed)
+{
+    @autoreleasepool
+    {
+        MetalRenderer *renderer = reinterpret_cast<MetalRenderer *>(instance);
+        renderer->finish_synchronize();
+        if (CommandCapture *capture = renderer->capture())
+            capture->set_textures(data, num_textures, changed, num_changed);
+        renderer->set_textures(data, num_textures, changed, num_changed);
+    }
+}
+
+extern "C" void set_skybox(void *instance, TextureData skybox)
+{
+    @autoreleasepool
+    {
+        MetalRenderer *renderer = reinterpret_cast<MetalRenderer *>(instance);
+        renderer->finish_synchronize();
+        TraceSpan span(renderer->trace(), "set_skybox");
+        if (CommandCapture *capture = renderer->capture())
+            capture->set_skybox(skybox);
+        renderer->set_skybox(skybox);
+    }
+}
+
+extern "C" void set_reflection_probes(void *instance, const ReflectionProbe *probes, unsigned int count)
+{
+    @autoreleasepool
+    {
+        MetalRenderer *renderer = reinterpret_cast<MetalRenderer *>(instance);
+        renderer->finish_synchronize();
+        renderer->set_reflection_probes(probes, count);
+    }
+}
+
+extern "C" void set_reflection_probe_budget(void *instance, unsigned int faces_per_frame)
+{
+    @autoreleasepool
+    {
+        MetalRenderer *renderer = reinterpret_cast<MetalRenderer *>(instance);
+        renderer->finish_synchronize();
+        renderer->set_reflection_probe_budget(faces_per_frame);
+    }
+}
+
+extern "C" void set_gi_volume(void *instance, GiVolume volume)
+{
+    @autoreleasepool
+    {
+        MetalRenderer *renderer = reinterpret_cast<MetalRenderer *>(instance);
+        renderer->finish_synchronize();
+        renderer->set_gi_volume(volume);
+    }
+}
+
+extern "C" void set_gi_ray_budget(void *instance, unsigned int rays_per_frame)
+{
+    @autoreleasepool
+    {
+        MetalRenderer *renderer = reinterpret_cast<MetalRenderer *>(instance);
+        renderer->finish_synchronize();
+        renderer->set_gi_ray_budget(rays_per_frame);
+    }
+}
+
+extern "C" void bake_lightmap(void *instance, LightmapSettings settings)
+{
+    @autoreleasepool
+    {
+        MetalRenderer *renderer = reinterpret_cast<MetalRenderer *>(instance);
+        renderer->finish_synchronize();
+        renderer->bake_lightmap(settings);
+    }
+}
+
+extern "C" void set_material_lightmap(void *instance, unsigned int material, unsigned int texture)
+{
+    @autoreleasepool
+    {
+        MetalRenderer *renderer = reinterpret_cast<MetalRenderer *>(instance);
+        renderer->finish_synchronize();
+        renderer->set_material_lightmap(material, texture);
+    }
+}
+
+extern "C" FrameStatus render(void *instance, simd_float4x4 matrix_2d, CameraView3D view_3d, RenderMode3D mode)
+{
+    @autoreleasepool
+    {
+        glm::mat4 matrix;
+        std::memcpy(glm::value_ptr(matrix), &matrix_2d, sizeof(glm::mat4));
+
+        MetalRenderer *renderer = reinterpret_cast<MetalRenderer *>(instance);
+        if (CommandCapture *capture = renderer->capture())
+            capture->render(matrix_2d, view_3d, mode);
+        return renderer->render(matrix, view_3d, mode);
+    }
+}
+
+extern "C" FrameStatus render_to_buffer(void *instance, simd_float4x4 matrix_2d, CameraView3D view_3d,
+                                        RenderMode3D mode, ReadbackCallback callback, void *user_data)
+{
+    @autoreleasepool
+    {
+        glm::mat4 matrix;
+        std::memcpy(glm::value_ptr(matrix), &matrix_2d, sizeof(glm::mat4));
+
+        MetalRenderer *renderer = reinterpret_cast<MetalRenderer *>(instance);
+        if (CommandCapture *capture = renderer->capture())
+            capture->render(matrix_2d, view_3d, mode);
+        return renderer->render(matrix, view_3d, mode, callback, user_data);
+    }
+}
+
+extern "C" void pick(void *instance, const unsigned int *pixels, unsigned int count, PickCallback callback,
+                     void *user_data)
+{
+    @autoreleasepool
+    {
+        MetalRenderer *renderer = reinterpret_cast<MetalRenderer *>(instance);
+        renderer->finish_synchronize();
+        renderer->pick(pixels, count, callback, user_data);
+    }
+}
+
+extern "C" unsigned int start_video_stream(void *instance, VideoStreamSettings settings, VideoPacketCallback callback,
+                                           void *user_data)
+{
+    @autoreleasepool
+    {
+        MetalRenderer *renderer = reinterpret_cast<MetalRenderer *>(instance);
+        renderer->finish_synchronize();
+        return renderer->start_video_stream(settings, callback, user_data) ? 1 : 0;
+    }
+}
+
+extern "C" void stop_video_stream(void *instance)
+{
+    @autoreleasepool
+    {
+        MetalRenderer *renderer = reinterpret_cast<MetalRenderer *>(instance);
+        renderer->finish_synchronize();
+        renderer->stop_video_stream();
+    }
+}
+
+extern "C" void request_video_keyframe(void *instance)
+{
+    @autoreleasepool
+    {
+        MetalRenderer *renderer = reinterpret_cast<MetalRenderer *>(instance);
+        renderer->finish_synchronize();
+        renderer->request_video_keyframe();
+    }
+}
+
+extern "C" unsigned int trace_rays(void *instance, const RayQuery *rays, unsigned int count, unsigned int any_hit,
+                                   RayQueryCallback callback, void *user_data)
+{
+    @autoreleasepool
+    {
+        MetalRenderer *renderer = reinterpret_cast<MetalRenderer *>(instance);
+        renderer->finish_synchronize();
+        return renderer->trace_rays(rays, count, any_hit != 0, callback, user_data) ? 1 : 0;
+    }
+}
+
+extern "C" void set_visibility_group(void *instance, unsigned int id, Aabb bounds)
+{
+    @autoreleasepool
+    {
+        MetalRenderer *renderer = reinterpret_cast<MetalRenderer *>(instance);
+        renderer->finish_synchronize();
+        renderer->set_visibility_group(id, bounds);
+    }
+}
+
+extern "C" void remove_visibility_group(void *instance, unsigned int id)
+{
+    @autoreleasepool
+    {
+        MetalRenderer *renderer = reinterpret_cast<MetalRenderer *>(instance);
+        renderer->finish_synchronize();
+        renderer->remove_visibility_group(id);
+    }
+}
+
+extern "C" unsigned long long visibility_samples(void *instance, unsigned int id)
+{
+    @autoreleasepool
+    {
+        MetalRenderer *renderer = reinterpret_cast<MetalRenderer *>(instance);
+        renderer->finish_synchronize();
+        return renderer->visibility_samples(id);
+    }
+}
+
+extern "C" unsigned int bake_pvs(void *instance, PvsSettings settings, PvsCallback callback, void *user_data)
+{
+    @autoreleasepool
+    {
+        MetalRenderer *renderer = reinterpret_cast<MetalRenderer *>(instance);
+        renderer->finish_synchronize();
+        return renderer->bake_pvs(settings, callback, user_data) ? 1 : 0;
+    }
+}
+
+extern "C" void set_pvs(void *instance, PvsData pvs)
+{
+    @autoreleasepool
+    {
+        MetalRenderer *renderer = reinterpret_cast<MetalRenderer *>(instance);
+        renderer->finish_synchronize();
+        renderer->set_pvs(pvs);
+    }
+}
+
+extern "C" void debug_lines(void *instance, const DebugLine *lines, unsigned int count, unsigned int depth_test)
 {
-    MetalRenderer *renderer = reinterpret_cast<MetalRenderer *>(instance);
-    renderer->set_textures(data, num_textures, changed);
+    @autoreleasepool
+    {
+        MetalRenderer *renderer = reinterpret_cast<MetalRenderer *>(instance);
+        renderer->finish_synchronize();
+        renderer->debug_lines(lines, count, depth_test != 0);
+    }
 }
 
-extern "C" void render(void *instance, simd_float4x4 matrix_2d, CameraView3D view_3d)
+extern "C" void debug_line(void *instance, Vector3 start, Vector3 end, unsigned int color, float width,
+                           unsigned int depth_test)
 {
-    glm::mat4 matrix;
-    std::memcpy(glm::value_ptr(matrix), &matrix_2d, sizeof(glm::mat4));
+    @autoreleasepool
+    {
+        MetalRenderer *renderer = reinterpret_cast<MetalRenderer *>(instance);
+        renderer->finish_synchronize();
+        renderer->debug_line(start, end, color, width, depth_test != 0);
+    }
+}
+
+extern "C" void debug_aabb(void *instance, Aabb bounds, unsigned int color, float width, unsigned int depth_test)
+{
+    @autoreleasepool
+    {
+        MetalRenderer *renderer = reinterpret_cast<MetalRenderer *>(instance);
+        renderer->finish_synchronize();
+        renderer->debug_aabb(bounds, color, width, depth_test != 0);
+    }
+}
 
-    MetalRenderer *renderer = reinterpret_cast<MetalRenderer *>(instance);
-    renderer->render(matrix, view_3d);
+extern "C" void debug_sphere(void *instance, Vector3 center, float radius, unsigned int color, float width,
+                             unsigned int depth_test)
+{
+    @autoreleasepool
+    {
+        MetalRenderer *renderer = reinterpret_cast<MetalRenderer *>(instance);
+        renderer->finish_synchronize();
+        renderer->debug_sphere(center, radius, color, width, depth_test != 0);
+    }
 }
 
 extern "C" void synchronize(void *instance)
 {
-    MetalRenderer *renderer = reinterpret_cast<MetalRenderer *>(instance);
-    renderer->synchronize();
+    @autoreleasepool
+    {
+        MetalRenderer *renderer = reinterpret_cast<MetalRenderer *>(instance);
+        if (CommandCapture *capture = renderer->capture())
+            capture->synchronize();
+        renderer->synchronize();
+    }
+}
+
+extern "C" void synchronize_async(void *instance)
+{
+    @autoreleasepool
+    {
+        MetalRenderer *renderer = reinterpret_cast<MetalRenderer *>(instance);
+        if (CommandCapture *capture = renderer->capture())
+            capture->synchronize();
+        renderer->synchronize_async();
+    }
+}
+
+extern "C" void wait_for_synchronize(void *instance)
+{
+    @autoreleasepool
+    {
+        MetalRenderer *renderer = reinterpret_cast<MetalRenderer *>(instance);
+        renderer->wait_for_synchronize();
+    }
 }
 
 extern "C" void resize(void *instance, unsigned int width, unsigned int height, double scale_factor)
 {
-    MetalRenderer *renderer = reinterpret_cast<MetalRenderer *>(instance);
-    renderer->resize(width, height, scale_factor);
-}
\ No newline at end of file
+    @autoreleasepool
+    {
+        MetalRenderer *renderer = reinterpret_cast<MetalRenderer *>(instance);
+        renderer->finish_synchronize();
+        TraceSpan span(renderer->trace(), "resize");
+        if (CommandCapture *capture = renderer->capture())
+            capture->resize(width, height, scale_factor);
+        renderer->resize(width, height, scale_factor);
+    }
+}
+
+extern "C" unsigned int add_surface(void *instance, void *ns_window, unsigned int width, unsigned int height,
+                                    double scale_factor)
+{
+    @autoreleasepool
+    {
+        MetalRenderer *renderer = reinterpret_cast<MetalRenderer *>(instance);
+        renderer->finish_synchronize();
+        return renderer->add_surface(ns_window, width, height, scale_factor);
+    }
+}
+
+extern "C" void remove_surface(void *instance, unsigned int surface)
+{
+    @autoreleasepool
+    {
+        MetalRenderer *renderer = reinterpret_cast<MetalRenderer *>(instance);
+        renderer->finish_synchronize();
+        renderer->remove_surface(surface);
+    }
+}
+
+extern "C" unsigned int select_surface(void *instance, unsigned int surface)
+{
+    @autoreleasepool
+    {
+        MetalRenderer *renderer = reinterpret_cast<MetalRenderer *>(instance);
+        renderer->finish_synchronize();
+        return renderer->select_surface(surface) ? 1 : 0;
+    }
+}
+
+extern "C" void set_frames_in_flight(void *instance, unsigned int count)
+{
+    @autoreleasepool
+    {
+        MetalRenderer *renderer = reinterpret_cast<MetalRenderer *>(instance);
+        renderer->finish_synchronize();
+        renderer->set_frames_in_flight(count);
+    }
+}
+
+extern "C" void set_vertex_compaction_budget(void *instance, unsigned int bytes_per_frame)
+{
+    @autoreleasepool
+    {
+        MetalRenderer *renderer = reinterpret_cast<MetalRenderer *>(instance);
+        renderer->finish_synchronize();
+        renderer->set_vertex_compaction_budget(bytes_per_frame);
+    }
+}
+
+extern "C" void set_mesh_welding(void *instance, unsigned int enabled)
+{
+    @autoreleasepool
+    {
+        MetalRenderer *renderer = reinterpret_cast<MetalRenderer *>(instance);
+        renderer->finish_synchronize();
+        renderer->set_mesh_welding(enabled != 0);
+    }
+}
+
+extern "C" void set_static_batching(void *instance, StaticBatching batching)
+{
+    @autoreleasepool
+    {
+        MetalRenderer *renderer = reinterpret_cast<MetalRenderer *>(instance);
+        renderer->finish_synchronize();
+        renderer->set_static_batching(batching);
+    }
+}
+
+extern "C" void set_copy_on_submit(void *instance, unsigned int enabled)
+{
+    @autoreleasepool
+    {
+        MetalRenderer *renderer = reinterpret_cast<MetalRenderer *>(instance);
+        renderer->finish_synchronize();
+        renderer->set_copy_on_submit(enabled != 0);
+    }
+}
+
+extern "C" void set_upload_budget(void *instance, UploadBudget budget)
+{
+    @autoreleasepool
+    {
+        MetalRenderer *renderer = reinterpret_cast<MetalRenderer *>(instance);
+        renderer->finish_synchronize();
+        renderer->set_upload_budget(budget);
+    }
+}
+
+extern "C" unsigned int pending_uploads(void *instance)
+{
+    @autoreleasepool
+    {
+        MetalRenderer *renderer = reinterpret_cast<MetalRenderer *>(instance);
+        renderer->finish_synchronize();
+        return renderer->pending_uploads();
+    }
+}
+
+extern "C" void set_3d_vertex_format(void *instance, VertexFormat3D format)
+{
+    @autoreleasepool
+    {
+        MetalRenderer *renderer = reinterpret_cast<MetalRenderer *>(instance);
+        renderer->finish_synchronize();
+        renderer->set_3d_vertex_format(format);
+    }
+}
+
+extern "C" void set_gpu_culling(void *instance, unsigned int enabled)
+{
+    @autoreleasepool
+    {
+        MetalRenderer *renderer = reinterpret_cast<MetalRenderer *>(instance);
+        renderer->finish_synchronize();
+        renderer->set_gpu_culling(enabled != 0);
+    }
+}
+
+extern "C" void set_async_compute(void *instance, unsigned int enabled)
+{
+    @autoreleasepool
+    {
+        MetalRenderer *renderer = reinterpret_cast<MetalRenderer *>(instance);
+        renderer->finish_synchronize();
+        renderer->set_async_compute(enabled != 0);
+    }
+}
+
+extern "C" void set_gpu_driven_draws(void *instance, unsigned int enabled)
+{
+    @autoreleasepool
+    {
+        MetalRenderer *renderer = reinterpret_cast<MetalRenderer *>(instance);
+        renderer->finish_synchronize();
+        renderer->set_gpu_driven_draws(enabled != 0);
+    }
+}
+
+extern "C" void set_private_geometry(void *instance, unsigned int enabled)
+{
+    @autoreleasepool
+    {
+        MetalRenderer *renderer = reinterpret_cast<MetalRenderer *>(instance);
+        renderer->finish_synchronize();
+        renderer->set_private_geometry(enabled != 0);
+    }
+}
+
+extern "C" void set_position_stream(void *instance, unsigned int enabled)
+{
+    @autoreleasepool
+    {
+        MetalRenderer *renderer = reinterpret_cast<MetalRenderer *>(instance);
+        renderer->finish_synchronize();
+        renderer->set_position_stream(enabled != 0);
+    }
+}
+
+extern "C" void set_texture_packing(void *instance, unsigned int max_size)
+{
+    @autoreleasepool
+    {
+        MetalRenderer *renderer = reinterpret_cast<MetalRenderer *>(instance);
+        renderer->finish_synchronize();
+        renderer->set_texture_packing(max_size);
+    }
+}
+
+extern "C" void set_gpu_mipmaps(void *instance, unsigned int enabled)
+{
+    @autoreleasepool
+    {
+        MetalRenderer *renderer = reinterpret_cast<MetalRenderer *>(instance);
+        renderer->finish_synchronize();
+        renderer->set_gpu_mipmaps(enabled != 0);
+    }
+}
+
+extern "C" void set_texture_transcoding(void *instance, unsigned int enabled)
+{
+    @autoreleasepool
+    {
+        MetalRenderer *renderer = reinterpret_cast<MetalRenderer *>(instance);
+        renderer->finish_synchronize();
+        renderer->set_texture_transcoding(enabled != 0);
+    }
+}
+
+extern "C" void set_lossy_textures(void *instance, unsigned int enabled)
+{
+    @autoreleasepool
+    {
+        MetalRenderer *renderer = reinterpret_cast<MetalRenderer *>(instance);
+        renderer->finish_synchronize();
+        renderer->set_lossy_textures(enabled != 0);
+    }
+}
+
+extern "C" unsigned int set_video_frame(void *instance, unsigned int index, void *pixel_buffer)
+{
+    @autoreleasepool
+    {
+        MetalRenderer *renderer = reinterpret_cast<MetalRenderer *>(instance);
+        renderer->finish_synchronize();
+        return renderer->set_video_frame(index, static_cast<CVPixelBufferRef>(pixel_buffer)) ? 1 : 0;
+    }
+}
+
+extern "C" unsigned int set_video_surface(void *instance, unsigned int index, void *io_surface)
+{
+    @autoreleasepool
+    {
+        MetalRenderer *renderer = reinterpret_cast<MetalRenderer *>(instance);
+        renderer->finish_synchronize();
+        return renderer->set_video_surface(index, static_cast<IOSurfaceRef>(io_surface)) ? 1 : 0;
+    }
+}
+
+extern "C" void set_texture_budget(void *instance, unsigned int megabytes)
+{
+    @autoreleasepool
+    {
+        MetalRenderer *renderer = reinterpret_cast<MetalRenderer *>(instance);
+        renderer->finish_synchronize();
+        renderer->set_texture_budget(static_cast<size_t>(megabytes) * 1024 * 1024);
+    }
+}
+
+extern "C" unsigned int set_virtual_texture(void *instance, unsigned int index, TextureData data)
+{
+    @autoreleasepool
+    {
+        MetalRenderer *renderer = reinterpret_cast<MetalRenderer *>(instance);
+        renderer->finish_synchronize();
+        return renderer->set_virtual_texture(index, data) ? 1 : 0;
+    }
+}
+
+extern "C" void set_virtual_texture_budget(void *instance, unsigned int cache_megabytes, unsigned int upload_megabytes)
+{
+    @autoreleasepool
+    {
+        MetalRenderer *renderer = reinterpret_cast<MetalRenderer *>(instance);
+        renderer->finish_synchronize();
+        renderer->set_virtual_texture_budget(static_cast<size_t>(cache_megabytes) * 1024 * 1024,
+                                             static_cast<size_t>(upload_megabytes) * 1024 * 1024);
+    }
+}
+
+extern "C" void set_depth_prepass(void *instance, unsigned int enabled)
+{
+    @autoreleasepool
+    {
+        MetalRenderer *renderer = reinterpret_cast<MetalRenderer *>(instance);
+        renderer->finish_synchronize();
+        renderer->set_depth_prepass(enabled != 0);
+    }
+}
+
+extern "C" void set_visibility_buffer(void *instance, unsigned int enabled)
+{
+    @autoreleasepool
+    {
+        MetalRenderer *renderer = reinterpret_cast<MetalRenderer *>(instance);
+        renderer->finish_synchronize();
+        renderer->set_visibility_buffer(enabled != 0);
+    }
+}
+
+extern "C" void set_occlusion_culling(void *instance, unsigned int enabled)
+{
+    @autoreleasepool
+    {
+        MetalRenderer *renderer = reinterpret_cast<MetalRenderer *>(instance);
+        renderer->finish_synchronize();
+        renderer->set_occlusion_culling(enabled != 0);
+    }
+}
+
+extern "C" void set_cluster_culling(void *instance, unsigned int enabled)
+{
+    @autoreleasepool
+    {
+        MetalRenderer *renderer = reinterpret_cast<MetalRenderer *>(instance);
+        renderer->finish_synchronize();
+        renderer->set_cluster_culling(enabled != 0);
+    }
+}
+
+extern "C" void set_shadow_distance(void *instance, float distance)
+{
+    @autoreleasepool
+    {
+        MetalRenderer *renderer = reinterpret_cast<MetalRenderer *>(instance);
+        renderer->finish_synchronize();
+        renderer->set_shadow_distance(distance);
+    }
+}
+
+extern "C" void set_unorm16_shadows(void *instance, unsigned int enabled)
+{
+    @autoreleasepool
+    {
+        MetalRenderer *renderer = reinterpret_cast<MetalRenderer *>(instance);
+        renderer->finish_synchronize();
+        renderer->set_unorm16_shadows(enabled != 0);
+    }
+}
+
+extern "C" void set_encoding_threads(void *instance, unsigned int count)
+{
+    @autoreleasepool
+    {
+        MetalRenderer *renderer = reinterpret_cast<MetalRenderer *>(instance);
+        renderer->finish_synchronize();
+        renderer->set_encoding_threads(count);
+    }
+}
+
+extern "C" void set_ray_tracing(void *instance, unsigned int enabled)
+{
+    @autoreleasepool
+    {
+        MetalRenderer *renderer = reinterpret_cast<MetalRenderer *>(instance);
+        renderer->finish_synchronize();
+        renderer->set_ray_tracing(enabled != 0);
+    }
+}
+
+extern "C" void set_path_tracer_denoiser(void *instance, unsigned int enabled)
+{
+    @autoreleasepool
+    {
+        MetalRenderer *renderer = reinterpret_cast<MetalRenderer *>(instance);
+        renderer->finish_synchronize();
+        renderer->set_path_tracer_denoiser(enabled != 0);
+    }
+}
+
+extern "C" void set_path_tracer_convergence(void *instance, float threshold, unsigned int min_samples,
+                                            unsigned int max_samples, float time_budget)
+{
+    @autoreleasepool
+    {
+        MetalRenderer *renderer = reinterpret_cast<MetalRenderer *>(instance);
+        renderer->finish_synchronize();
+        renderer->set_path_tracer_convergence(threshold, min_samples, max_samples, time_budget);
+    }
+}
+
+extern "C" void get_path_tracer_progress(void *instance, PathTracerProgress *progress)
+{
+    @autoreleasepool
+    {
+        MetalRenderer *renderer = reinterpret_cast<MetalRenderer *>(instance);
+        renderer->finish_synchronize();
+        if (progress)
+            *progress = renderer->path_tracer_progress();
+    }
+}
+
+extern "C" void set_ambient_occlusion_radius(void *instance, float radius)
+{
+    @autoreleasepool
+    {
+        MetalRenderer *renderer = reinterpret_cast<MetalRenderer *>(instance);
+        renderer->finish_synchronize();
+        renderer->set_ambient_occlusion_radius(radius);
+    }
+}
+
+extern "C" void set_ssao(void *instance, unsigned int enabled)
+{
+    @autoreleasepool
+    {
+        MetalRenderer *renderer = reinterpret_cast<MetalRenderer *>(instance);
+        renderer->finish_synchronize();
+        renderer->set_ssao(enabled != 0);
+    }
+}
+
+extern "C" void set_reflections(void *instance, ReflectionSettings settings)
+{
+    @autoreleasepool
+    {
+        MetalRenderer *renderer = reinterpret_cast<MetalRenderer *>(instance);
+        renderer->finish_synchronize();
+        renderer->set_reflections(settings);
+    }
+}
+
+extern "C" void set_sdf_tracing(void *instance, SdfSettings settings)
+{
+    @autoreleasepool
+    {
+        MetalRenderer *renderer = reinterpret_cast<MetalRenderer *>(instance);
+        renderer->finish_synchronize();
+        renderer->set_sdf_tracing(settings);
+    }
+}
+
+extern "C" void set_msaa_samples(void *instance, unsigned int samples)
+{
+    @autoreleasepool
+    {
+        MetalRenderer *renderer = reinterpret_cast<MetalRenderer *>(instance);
+        renderer->finish_synchronize();
+        renderer->set_msaa_samples(samples);
+    }
+}
+
+extern "C" void set_render_scale(void *instance, float scale)
+{
+    @autoreleasepool
+    {
+        MetalRenderer *renderer = reinterpret_cast<MetalRenderer *>(instance);
+        renderer->finish_synchronize();
+        renderer->set_render_scale(scale);
+    }
+}
+
+extern "C" void set_dynamic_resolution(void *instance, float target_ms, float min_scale, float max_scale)
+{
+    @autoreleasepool
+    {
+        MetalRenderer *renderer = reinterpret_cast<MetalRenderer *>(instance);
+        renderer->finish_synchronize();
+        renderer->set_dynamic_resolution(target_ms, min_scale, max_scale);
+    }
+}
+
+extern "C" void set_quality_governor(void *instance, unsigned int enabled)
+{
+    @autoreleasepool
+    {
+        MetalRenderer *renderer = reinterpret_cast<MetalRenderer *>(instance);
+        renderer->finish_synchronize();
+        renderer->set_quality_governor(enabled != 0);
+    }
+}
+
+extern "C" void set_texture_filtering(void *instance, unsigned int sampler_3d, unsigned int sampler_2d,
+                                      unsigned int max_anisotropy)
+{
+    @autoreleasepool
+    {
+        MetalRenderer *renderer = reinterpret_cast<MetalRenderer *>(instance);
+        renderer->finish_synchronize();
+        renderer->set_texture_filtering(sampler_3d, sampler_2d, max_anisotropy);
+    }
+}
+
+extern "C" void set_hdr(void *instance, HdrMode mode, float exposure)
+{
+    @autoreleasepool
+    {
+        MetalRenderer *renderer = reinterpret_cast<MetalRenderer *>(instance);
+        renderer->finish_synchronize();
+        renderer->set_hdr(mode, exposure);
+    }
+}
+
+extern "C" void set_post_processing(void *instance, PostProcessSettings settings)
+{
+    @autoreleasepool
+    {
+        MetalRenderer *renderer = reinterpret_cast<MetalRenderer *>(instance);
+        renderer->finish_synchronize();
+        renderer->set_post_processing(settings);
+    }
+}
+
+extern "C" void set_color_grading_lut(void *instance, const unsigned char *texels, unsigned int size)
+{
+    @autoreleasepool
+    {
+        MetalRenderer *renderer = reinterpret_cast<MetalRenderer *>(instance);
+        renderer->finish_synchronize();
+        renderer->set_color_grading_lut(texels, size);
+    }
+}
+
+extern "C" void set_temporal_antialiasing(void *instance, unsigned int enabled)
+{
+    @autoreleasepool
+    {
+        MetalRenderer *renderer = reinterpret_cast<MetalRenderer *>(instance);
+        renderer->finish_synchronize();
+        renderer->set_temporal_antialiasing(enabled != 0);
+    }
+}
+
+extern "C" void set_present_mode(void *instance, PresentMode mode, float min_frame_duration, unsigned int low_latency)
+{
+    @autoreleasepool
+    {
+        MetalRenderer *renderer = reinterpret_cast<MetalRenderer *>(instance);
+        renderer->finish_synchronize();
+        renderer->set_present_mode(mode, min_frame_duration, low_latency != 0);
+    }
+}
+
+extern "C" void set_frame_timeout(void *instance, float seconds)
+{
+    @autoreleasepool
+    {
+        MetalRenderer *renderer = reinterpret_cast<MetalRenderer *>(instance);
+        renderer->finish_synchronize();
+        renderer->set_frame_timeout(seconds);
+    }
+}
+
+extern "C" void set_on_demand_rendering(void *instance, unsigned int enabled, float heartbeat)
+{
+    @autoreleasepool
+    {
+        MetalRenderer *renderer = reinterpret_cast<MetalRenderer *>(instance);
+        renderer->finish_synchronize();
+        renderer->set_on_demand_rendering(enabled != 0, heartbeat);
+    }
+}
+
+extern "C" void request_redraw(void *instance)
+{
+    @autoreleasepool
+    {
+        MetalRenderer *renderer = reinterpret_cast<MetalRenderer *>(instance);
+        renderer->finish_synchronize();
+        renderer->request_redraw();
+    }
+}
+
+extern "C" void set_rasterization_rates(void *instance, const float *horizontal, unsigned int num_horizontal,
+                                        const float *vertical, unsigned int num_vertical)
+{
+    @autoreleasepool
+    {
+        MetalRenderer *renderer = reinterpret_cast<MetalRenderer *>(instance);
+        renderer->finish_synchronize();
+        renderer->set_rasterization_rates(horizontal, num_horizontal, vertical, num_vertical);
+    }
+}
+
+extern "C" void set_inset_views(void *instance, const InsetView3D *views, unsigned int count)
+{
+    @autoreleasepool
+    {
+        MetalRenderer *renderer = reinterpret_cast<MetalRenderer *>(instance);
+        renderer->finish_synchronize();
+        renderer->set_inset_views(views, count);
+    }
+}
+
+extern "C" void set_render_texture(void *instance, unsigned int index, RenderTexture texture)
+{
+    @autoreleasepool
+    {
+        MetalRenderer *renderer = reinterpret_cast<MetalRenderer *>(instance);
+        renderer->finish_synchronize();
+        renderer->set_render_texture(index, texture);
+    }
+}
+
+extern "C" void request_render_texture(void *instance, unsigned int index)
+{
+    @autoreleasepool
+    {
+        MetalRenderer *renderer = reinterpret_cast<MetalRenderer *>(instance);
+        renderer->finish_synchronize();
+        renderer->request_render_texture(index);
+    }
+}
+
+extern "C" void set_render_texture_budget(void *instance, unsigned int pixels_per_frame)
+{
+    @autoreleasepool
+    {
+        MetalRenderer *renderer = reinterpret_cast<MetalRenderer *>(instance);
+        renderer->finish_synchronize();
+        renderer->set_render_texture_budget(pixels_per_frame);
+    }
+}
+
+extern "C" unsigned int pipelines_ready(void *instance)
+{
+    @autoreleasepool
+    {
+        MetalRenderer *renderer = reinterpret_cast<MetalRenderer *>(instance);
+        return renderer->pipelines_ready() ? 1 : 0;
+    }
+}
+
+extern "C" void wait_for_pipelines(void *instance)
+{
+    @autoreleasepool
+    {
+        MetalRenderer *renderer = reinterpret_cast<MetalRenderer *>(instance);
+        renderer->wait_for_pipelines();
+    }
+}
+
+extern "C" void notify_pipelines_ready(void *instance, PipelinesReadyCallback callback, void *user_data)
+{
+    @autoreleasepool
+    {
+        MetalRenderer *renderer = reinterpret_cast<MetalRenderer *>(instance);
+        renderer->notify_pipelines_ready(callback, user_data);
+    }
+}
+
+extern "C" unsigned long long get_submitted_frame(void *instance)
+{
+    @autoreleasepool
+    {
+        MetalRenderer *renderer = reinterpret_cast<MetalRenderer *>(instance);
+        return renderer->submitted_frame();
+    }
+}
+
+extern "C" unsigned long long get_completed_frame(void *instance)
+{
+    @autoreleasepool
+    {
+        MetalRenderer *renderer = reinterpret_cast<MetalRenderer *>(instance);
+        return renderer->completed_frame();
+    }
+}
+
+extern "C" unsigned int wait_for_frame(void *instance, unsigned long long frame, unsigned int timeout_ms)
+{
+    @autoreleasepool
+    {
+        MetalRenderer *renderer = reinterpret_cast<MetalRenderer *>(instance);
+        return renderer->wait_for_frame(frame, timeout_ms) ? 1 : 0;
+    }
+}
+
+extern "C" void get_frame_stats(void *instance, FrameStats *stats)
+{
+    @autoreleasepool
+    {
+        MetalRenderer *renderer = reinterpret_cast<MetalRenderer *>(instance);
+        if (stats)
+            *stats = renderer->frame_stats();
+    }
+}
+
+extern "C" void get_memory_stats(void *instance, MemoryStats *stats)
+{
+    @autoreleasepool
+    {
+        MetalRenderer *renderer = reinterpret_cast<MetalRenderer *>(instance);
+        renderer->finish_synchronize();
+        if (stats)
+            *stats = renderer->memory_stats();
+    }
+}
+
+extern "C" void set_memory_policy(void *instance, MemoryPolicy policy, MeshEvictionCallback callback, void *user_data)
+{
+    @autoreleasepool
+    {
+        MetalRenderer *renderer = reinterpret_cast<MetalRenderer *>(instance);
+        renderer->finish_synchronize();
+        renderer->set_memory_policy(policy, callback, user_data);
+    }
+}
+
+extern "C" void set_cell_streaming(void *instance, StreamingSettings settings, CellStreamingCallback callback,
+                                   void *user_data)
+{
+    @autoreleasepool
+    {
+        MetalRenderer *renderer = reinterpret_cast<MetalRenderer *>(instance);
+        renderer->finish_synchronize();
+        renderer->set_cell_streaming(settings, callback, user_data);
+    }
+}
+
+extern "C" void set_streaming_cell(void *instance, unsigned int id, StreamingCell cell)
+{
+    @autoreleasepool
+    {
+        MetalRenderer *renderer = reinterpret_cast<MetalRenderer *>(instance);
+        renderer->finish_synchronize();
+        renderer->set_streaming_cell(id, cell);
+    }
+}
+
+extern "C" void remove_streaming_cell(void *instance, unsigned int id)
+{
+    @autoreleasepool
+    {
+        MetalRenderer *renderer = reinterpret_cast<MetalRenderer *>(instance);
+        renderer->finish_synchronize();
+        renderer->remove_streaming_cell(id);
+    }
+}
+
+extern "C" unsigned int streaming_cell_loaded(void *instance, unsigned int id)
+{
+    @autoreleasepool
+    {
+        MetalRenderer *renderer = reinterpret_cast<MetalRenderer *>(instance);
+        renderer->finish_synchronize();
+        return renderer->streaming_cell_loaded(id) ? 1 : 0;
+    }
+}
+
+extern "C" void set_resource_cache(void *instance, unsigned int megabytes)
+{
+    @autoreleasepool
+    {
+        MetalRenderer *renderer = reinterpret_cast<MetalRenderer *>(instance);
+        renderer->finish_synchronize();
+        renderer->set_resource_cache(static_cast<size_t>(megabytes) * 1024 * 1024);
+    }
+}
+
+extern "C" void set_deduplication(void *instance, unsigned int enabled)
+{
+    @autoreleasepool
+    {
+        MetalRenderer *renderer = reinterpret_cast<MetalRenderer *>(instance);
+        renderer->finish_synchronize();
+        renderer->set_deduplication(enabled != 0);
+    }
+}
+
+extern "C" unsigned int start_capture(void *instance, const char *path, unsigned int compress)
+{
+    @autoreleasepool
+    {
+        MetalRenderer *renderer = reinterpret_cast<MetalRenderer *>(instance);
+        renderer->finish_synchronize();
+        return renderer->start_capture(path, compress != 0) ? 1 : 0;
+    }
+}
+
+extern "C" void stop_capture(void *instance)
+{
+    @autoreleasepool
+    {
+        MetalRenderer *renderer = reinterpret_cast<MetalRenderer *>(instance);
+        renderer->finish_synchronize();
+        renderer->stop_capture();
+    }
+}
+
+extern "C" unsigned int capture_gpu_frames(void *instance, const char *directory, unsigned int frames)
+{
+    @autoreleasepool
+    {
+        MetalRenderer *renderer = reinterpret_cast<MetalRenderer *>(instance);
+        renderer->finish_synchronize();
+        return renderer->capture_gpu_frames(directory, frames) ? 1 : 0;
+    }
+}
+
+extern "C" void set_gpu_capture_trigger(void *instance, const char *directory, float threshold_ms,
+                                        unsigned int frames)
+{
+    @autoreleasepool
+    {
+        MetalRenderer *renderer = reinterpret_cast<MetalRenderer *>(instance);
+        renderer->finish_synchronize();
+        renderer->set_gpu_capture_trigger(directory, threshold_ms, frames);
+    }
+}
+
+extern "C" void set_performance_hud(void *instance, unsigned int enabled)
+{
+    @autoreleasepool
+    {
+        MetalRenderer *renderer = reinterpret_cast<MetalRenderer *>(instance);
+        renderer->finish_synchronize();
+        renderer->set_performance_hud(enabled != 0);
+    }
+}
+
+extern "C" void get_frame_pacing(void *instance, FramePacingStats *stats)
+{
+    @autoreleasepool
+    {
+        MetalRenderer *renderer = reinterpret_cast<MetalRenderer *>(instance);
+        if (stats)
+            *stats = renderer->frame_pacing();
+    }
+}
+
+extern "C" void reset_frame_pacing(void *instance)
+{
+    @autoreleasepool
+    {
+        MetalRenderer *renderer = reinterpret_cast<MetalRenderer *>(instance);
+        renderer->finish_synchronize();
+        renderer->reset_frame_pacing();
+    }
+}
+
+extern "C" void set_mesh_profiling(void *instance, unsigned int enabled)
+{
+    @autoreleasepool
+    {
+        MetalRenderer *renderer = reinterpret_cast<MetalRenderer *>(instance);
+        renderer->finish_synchronize();
+        renderer->set_mesh_profiling(enabled != 0);
+    }
+}
+
+extern "C" void get_mesh_costs(void *instance, MeshCostStats *stats)
+{
+    @autoreleasepool
+    {
+        MetalRenderer *renderer = reinterpret_cast<MetalRenderer *>(instance);
+        renderer->finish_synchronize();
+        if (stats)
+            *stats = renderer->mesh_costs();
+    }
+}
+
+extern "C" void start_trace(void *instance, unsigned int capacity)
+{
+    @autoreleasepool
+    {
+        MetalRenderer *renderer = reinterpret_cast<MetalRenderer *>(instance);
+        renderer->trace().start(capacity > 0 ? capacity : TraceRecorder::DEFAULT_CAPACITY);
+    }
+}
+
+extern "C" void stop_trace(void *instance)
+{
+    @autoreleasepool
+    {
+        MetalRenderer *renderer = reinterpret_cast<MetalRenderer *>(instance);
+        renderer->trace().stop();
+    }
+}
+
+extern "C" unsigned int write_trace(void *instance, const char *path, TraceFormat format)
+{
+    @autoreleasepool
+    {
+        MetalRenderer *renderer = reinterpret_cast<MetalRenderer *>(instance);
+        return renderer->trace().write(path, format) ? 1 : 0;
+    }
+}
+
+extern "C" unsigned long long get_trace_time(void *)
+{
+    return TraceRecorder::now();
+}
+
+extern "C" void add_trace_span(void *instance, const char *name, unsigned long long start_ns,
+                               unsigned long long end_ns)
+{
+    @autoreleasepool
+    {
+        MetalRenderer *renderer = reinterpret_cast<MetalRenderer *>(instance);
+        renderer->trace().add_external(name, start_ns, end_ns);
+    }
+}
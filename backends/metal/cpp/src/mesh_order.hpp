@@ -0,0 +1,235 @@
+#ifndef METALCPP_SRC_MESH_ORDER_HPP
+#define METALCPP_SRC_MESH_ORDER_HPP
+
+#include "library.h"
+#include "structs.h"
+
+#include <algorithm>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+// Entries of the post-transform vertex cache the triangle order is tuned for, and the triangles after which a cluster
+// may be cut where the order misses the cache anyway.
+constexpr unsigned int ORDER_CACHE_SIZE = 16;
+constexpr unsigned int ORDER_CLUSTER_TRIANGLES = 64;
+
+// Orders num_triangles triangles for the vertex cache with Tipsify of Sander, Nehab and Barczak, which fans around the
+// vertices in the cache that are likely to stay in it. order receives triangle numbers and cluster_starts the places
+// in order that jump to another part of the mesh or miss the cache at least twice in a long cluster.
+inline void order_for_vertex_cache(const unsigned int *indices, unsigned int num_triangles, unsigned int num_vertices,
+                                   std::vector<unsigned int> &order, std::vector<unsigned int> &cluster_starts)
+{
+    order.clear();
+    cluster_starts.clear();
+    if (num_triangles == 0)
+        return;
+
+    // Triangles around every vertex.
+    std::vector<unsigned int> offsets(num_vertices + 1, 0);
+    for (unsigned int i = 0; i < num_triangles * 3; i++)
+        offsets[indices[i] + 1]++;
+    for (unsigned int v = 0; v < num_vertices; v++)
+        offsets[v + 1] += offsets[v];
+    std::vector<unsigned int> adjacency(num_triangles * 3);
+    std::vector<unsigned int> fill(offsets.begin(), offsets.end() - 1);
+    for (unsigned int i = 0; i < num_triangles * 3; i++)
+        adjacency[fill[indices[i]]++] = i / 3;
+
+    std::vector<unsigned int> live(num_vertices);
+    for (unsigned int v = 0; v < num_vertices; v++)
+        live[v] = offsets[v + 1] - offsets[v];
+    std::vector<unsigned int> cache_time(num_vertices, 0);
+    std::vector<bool> emitted(num_triangles, false);
+    std::vector<unsigned int> dead_end;
+    std::vector<unsigned int> candidates;
+    unsigned int time = ORDER_CACHE_SIZE + 1;
+    unsigned int scan = 0;
+
+    order.reserve(num_triangles);
+    cluster_starts.push_back(0);
+    unsigned int fanning = indices[0];
+    while (fanning != ~0u)
+    {
+        candidates.clear();
+        for (unsigned int a = offsets[fanning]; a < offsets[fanning + 1]; a++)
+        {
+            const unsigned int t = adjacency[a];
+            if (emitted[t])
+                continue;
+
+            unsigned int misses = 0;
+            for (unsigned int k = 0; k < 3; k++)
+                misses += time - cache_time[indices[t * 3 + k]] > ORDER_CACHE_SIZE ? 1 : 0;
+            if (misses >= 2 && order.size() - cluster_starts.back() >= ORDER_CLUSTER_TRIANGLES)
+                cluster_starts.push_back(static_cast<unsigned int>(order.size()));
+
+            for (unsigned int k = 0; k < 3; k++)
+            {
+                const unsigned int v = indices[t * 3 + k];
+                dead_end.push_back(v);
+                candidates.push_back(v);
+                live[v]--;
+                if (time - cache_time[v] > ORDER_CACHE_SIZE)
+                    cache_time[v] = time++;
+            }
+            emitted[t] = true;
+            order.push_back(t);
+        }
+
+        // The next fan is around the vertex that stays in the cache longest once its triangles are emitted, then
+        // around the last vertices that still have triangles, then at the next triangle that wasn't emitted.
+        fanning = ~0u;
+        int best = -1;
+        for (const unsigned int v : candidates)
+        {
+            if (live[v] == 0)
+                continue;
+            const unsigned int age = time - cache_time[v];
+            const int priority = age + 2 * live[v] <= ORDER_CACHE_SIZE ? static_cast<int>(age) : 0;
+            if (priority > best)
+            {
+                best = priority;
+                fanning = v;
+            }
+        }
+        while (fanning == ~0u && !dead_end.empty())
+        {
+            const unsigned int v = dead_end.back();
+            dead_end.pop_back();
+            if (live[v] > 0)
+                fanning = v;
+        }
+        if (fanning == ~0u)
+        {
+            while (scan < num_triangles && emitted[scan])
+                scan++;
+            if (scan < num_triangles)
+            {
+                fanning = indices[scan * 3];
+                if (order.size() > cluster_starts.back())
+                    cluster_starts.push_back(static_cast<unsigned int>(order.size()));
+            }
+        }
+    }
+}
+
+// Reorders the triangles of an indexed mesh for the post-transform vertex cache and less overdraw, then renumbers the
+// vertices in the order the triangles first use them so they are fetched from consecutive memory. The clusters of the
+// cache order are drawn by how far they face out from the center of bounds, so the outer surfaces that occlude most
+// come first, as in Fast Triangle Reordering of Sander, Nehab and Barczak. Triangles are only moved within their
+// material ranges, so ranges stay valid. Vertices no triangle uses follow the others, the counts don't change.
+template <typename JW>
+void optimize_mesh_order(const Vertex3D *vertices, const JW *joints_weights, unsigned int num_vertices,
+                         const unsigned int *indices, unsigned int num_indices, const VertexRange *ranges,
+                         unsigned int num_ranges, const Aabb &bounds, std::vector<Vertex3D> &out_vertices,
+                         std::vector<JW> &out_joints_weights, std::vector<unsigned int> &out_indices)
+{
+    out_indices.assign(indices, indices + num_indices);
+    out_vertices.assign(vertices, vertices + num_vertices);
+    out_joints_weights.clear();
+    if (joints_weights)
+        out_joints_weights.assign(joints_weights, joints_weights + num_vertices);
+    if (std::any_of(indices, indices + num_indices, [num_vertices](unsigned int i) { return i >= num_vertices; }))
+        return;
+
+    const auto position = [vertices](unsigned int i) {
+        return glm::vec3(vertices[i].v_x, vertices[i].v_y, vertices[i].v_z);
+    };
+    glm::vec3 center = glm::vec3(bounds.bmin.x + bounds.bmax.x, bounds.bmin.y + bounds.bmax.y,
+                                 bounds.bmin.z + bounds.bmax.z) *
+                       0.5f;
+    if (bounds.bmin.x > bounds.bmax.x || bounds.bmin.y > bounds.bmax.y || bounds.bmin.z > bounds.bmax.z)
+    {
+        center = glm::vec3(0.0f);
+        for (unsigned int v = 0; v < num_vertices; v++)
+            center += position(v) / static_cast<float>(num_vertices);
+    }
+
+    // Segments between the ends of all ranges are reordered on their own, which keeps every range whole even where
+    // ranges overlap.
+    const unsigned int end = num_indices - num_indices % 3;
+    std::vector<unsigned int> cuts = {0, end};
+    for (unsigned int i = 0; ranges && i < num_ranges; i++)
+    {
+        cuts.push_back(std::min(ranges[i].first / 3 * 3, end));
+        cuts.push_back(std::min(ranges[i].last / 3 * 3, end));
+    }
+    std::sort(cuts.begin(), cuts.end());
+    cuts.erase(std::unique(cuts.begin(), cuts.end()), cuts.end());
+
+    struct Cluster
+    {
+        unsigned int first;
+        unsigned int count;
+        float facing;
+    };
+    std::vector<unsigned int> order;
+    std::vector<unsigned int> cluster_starts;
+    std::vector<Cluster> clusters;
+    for (size_t c = 0; c + 1 < cuts.size(); c++)
+    {
+        const unsigned int *segment = indices + cuts[c];
+        const unsigned int num_triangles = (cuts[c + 1] - cuts[c]) / 3;
+        order_for_vertex_cache(segment, num_triangles, num_vertices, order, cluster_starts);
+
+        clusters.clear();
+        for (size_t s = 0; s < cluster_starts.size(); s++)
+        {
+            const unsigned int first = cluster_starts[s];
+            const unsigned int last = s + 1 < cluster_starts.size() ? cluster_starts[s + 1] : num_triangles;
+            glm::vec3 area_normal(0.0f);
+            glm::vec3 centroid(0.0f);
+            float area = 0.0f;
+            for (unsigned int i = first; i < last; i++)
+            {
+                const unsigned int *t = segment + order[i] * 3;
+                const glm::vec3 p0 = position(t[0]);
+                const glm::vec3 p1 = position(t[1]);
+                const glm::vec3 p2 = position(t[2]);
+                const glm::vec3 n = glm::cross(p1 - p0, p2 - p0);
+                const float a = glm::length(n);
+                area_normal += n;
+                centroid += (p0 + p1 + p2) * (a / 3.0f);
+                area += a;
+            }
+            const float normal_length = glm::length(area_normal);
+            const float facing = area > 0.0f && normal_length > 0.0f
+                                     ? glm::dot(centroid / area - center, area_normal / normal_length)
+                                     : 0.0f;
+            clusters.push_back({first, last - first, facing});
+        }
+        std::stable_sort(clusters.begin(), clusters.end(),
+                         [](const Cluster &a, const Cluster &b) { return a.facing > b.facing; });
+
+        unsigned int *out = out_indices.data() + cuts[c];
+        for (const Cluster &cluster : clusters)
+        {
+            for (unsigned int i = cluster.first; i < cluster.first + cluster.count; i++)
+            {
+                for (unsigned int k = 0; k < 3; k++)
+                    *out++ = segment[order[i] * 3 + k];
+            }
+        }
+    }
+
+    // Vertices in the order of their first use.
+    std::vector<unsigned int> remap(num_vertices, ~0u);
+    unsigned int next = 0;
+    for (unsigned int &index : out_indices)
+    {
+        if (remap[index] == ~0u)
+            remap[index] = next++;
+        index = remap[index];
+    }
+    for (unsigned int v = 0; v < num_vertices; v++)
+    {
+        if (remap[v] == ~0u)
+            remap[v] = next++;
+        out_vertices[remap[v]] = vertices[v];
+        if (joints_weights)
+            out_joints_weights[remap[v]] = joints_weights[v];
+    }
+}
+
+#endif // METALCPP_SRC_MESH_ORDER_HPP
@@ -0,0 +1,216 @@
+#ifndef METALCPP_SRC_MESH_PROFILER_HPP
+#define METALCPP_SRC_MESH_PROFILER_HPP
+
+#import <Foundation/Foundation.h>
+#import <Metal/Metal.h>
+
+#include "library.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+// Attributes the GPU time of the main and transparency passes to the 3D meshes drawn in them while enabled. Timestamps
+// are sampled around the draws of every mesh into a counter sample buffer per frame in flight, with barriers so the
+// draws of different meshes don't overlap, and resolved into the most expensive meshes once the frame completed. Only
+// GPUs that sample at draw boundaries time meshes, Apple GPUs don't and rank meshes by their triangles. Disabled,
+// the passes sample and count nothing.
+class MeshProfiler
+{
+  public:
+    static constexpr unsigned int NO_SAMPLE = ~0u;
+    // Two samples per timed mesh and pass, meshes beyond that in a frame are counted but not timed.
+    static constexpr unsigned int MAX_SAMPLES = 8192;
+
+    void init(id<MTLDevice> device)
+    {
+        _device = device;
+        if (@available(macOS 11.0, *))
+            _draw_samples = [device supportsCounterSampling:MTLCounterSamplingPointAtDrawBoundary];
+        for (id<MTLCounterSet> set in device.counterSets)
+        {
+            if ([set.name isEqualToString:MTLCommonCounterSetTimestamp])
+                _timestamps = set;
+        }
+        [device sampleTimestamps:&_cpu_start gpuTimestamp:&_gpu_start];
+    }
+
+    bool enabled() const
+    {
+        return !_frames.empty();
+    }
+
+    // Only valid when the GPU is idle.
+    void set_enabled(bool enabled, unsigned int frames_in_flight)
+    {
+        _frames.clear();
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _stats = {};
+        }
+        if (!enabled)
+            return;
+
+        _frames.resize(frames_in_flight);
+        if (!_draw_samples || _timestamps == nil)
+            return;
+
+        MTLCounterSampleBufferDescriptor *desc = [MTLCounterSampleBufferDescriptor new];
+        desc.counterSet = _timestamps;
+        desc.storageMode = MTLStorageModeShared;
+        desc.sampleCount = MAX_SAMPLES;
+        for (Frame &frame : _frames)
+        {
+            NSError *err = nil;
+            frame.samples = [_device newCounterSampleBufferWithDescriptor:desc error:&err];
+            if (frame.samples == nil)
+                NSLog(@"Could not create mesh profiling sample buffer: %@", [err localizedDescription]);
+        }
+    }
+
+    // Starts the frame encoded into slot frame_index, only called while enabled.
+    void begin_frame(unsigned int frame_index)
+    {
+        _frame = frame_index;
+        Frame &frame = _frames[frame_index];
+        frame.next_sample = 0;
+        frame.timed.clear();
+        frame.counts.clear();
+    }
+
+    // Called for every mesh the frame draws, from the thread that renders.
+    void count(unsigned int mesh, unsigned int instances, unsigned int triangles)
+    {
+        _frames[_frame].counts.push_back({mesh, instances, triangles, 0.0f});
+    }
+
+    // Samples the start of the draws of a mesh, returns NO_SAMPLE when they are not timed. Encoders of a parallel
+    // encoder may call it at once.
+    unsigned int begin_mesh(id<MTLRenderCommandEncoder> encoder)
+    {
+        Frame &frame = _frames[_frame];
+        if (frame.samples == nil)
+            return NO_SAMPLE;
+
+        unsigned int sample = NO_SAMPLE;
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            if (frame.next_sample + 2 > MAX_SAMPLES)
+                return NO_SAMPLE;
+            sample = frame.next_sample;
+            frame.next_sample += 2;
+        }
+        [encoder sampleCountersInBuffer:frame.samples atSampleIndex:sample withBarrier:YES];
+        return sample;
+    }
+
+    void end_mesh(id<MTLRenderCommandEncoder> encoder, unsigned int mesh, unsigned int sample)
+    {
+        if (sample == NO_SAMPLE)
+            return;
+
+        Frame &frame = _frames[_frame];
+        [encoder sampleCountersInBuffer:frame.samples atSampleIndex:sample + 1 withBarrier:YES];
+        std::lock_guard<std::mutex> lock(_mutex);
+        frame.timed.push_back({mesh, sample});
+    }
+
+    // Called from a completed handler of the frame's last command buffer, before the frame slot is reused.
+    void resolve(unsigned int frame_index)
+    {
+        if (frame_index >= _frames.size())
+            return;
+
+        const Frame &frame = _frames[frame_index];
+        std::unordered_map<unsigned int, MeshCost> costs;
+        costs.reserve(frame.counts.size());
+        for (const MeshCost &count : frame.counts)
+            costs.emplace(count.mesh, count);
+
+        MeshCostStats stats = {};
+        stats.timed = frame.samples != nil ? 1 : 0;
+        if (frame.samples != nil && frame.next_sample > 0)
+        {
+            // Calibrated against the CPU clock like the pass timings of FrameTimer.
+            MTLTimestamp cpu = 0;
+            MTLTimestamp gpu = 0;
+            [_device sampleTimestamps:&cpu gpuTimestamp:&gpu];
+            const double ns_per_tick =
+                gpu > _gpu_start ? static_cast<double>(cpu - _cpu_start) / static_cast<double>(gpu - _gpu_start) : 1.0;
+
+            NSData *data = [frame.samples resolveCounterRange:NSMakeRange(0, frame.next_sample)];
+            const auto *timestamps = static_cast<const MTLCounterResultTimestamp *>(data.bytes);
+            const size_t count = data.length / sizeof(MTLCounterResultTimestamp);
+            for (const TimedMesh &timed : frame.timed)
+            {
+                if (timed.sample + 1 >= count)
+                    continue;
+                const uint64_t start = timestamps[timed.sample].timestamp;
+                const uint64_t end = timestamps[timed.sample + 1].timestamp;
+                if (start == MTLCounterErrorValue || end == MTLCounterErrorValue || end < start)
+                    continue;
+                const float ms = static_cast<float>(static_cast<double>(end - start) * ns_per_tick * 1e-6);
+                MeshCost &cost = costs.try_emplace(timed.mesh, MeshCost{timed.mesh, 0, 0, 0.0f}).first->second;
+                cost.gpu_ms += ms;
+                stats.total_ms += ms;
+            }
+        }
+
+        std::vector<MeshCost> sorted;
+        sorted.reserve(costs.size());
+        for (const auto &[mesh, cost] : costs)
+            sorted.push_back(cost);
+        const size_t reported = std::min<size_t>(sorted.size(), MESH_COST_COUNT);
+        std::partial_sort(sorted.begin(), sorted.begin() + reported, sorted.end(),
+                          [](const MeshCost &a, const MeshCost &b) {
+                              if (a.gpu_ms != b.gpu_ms)
+                                  return a.gpu_ms > b.gpu_ms;
+                              return a.triangles > b.triangles;
+                          });
+        stats.meshes = static_cast<unsigned int>(sorted.size());
+        stats.count = static_cast<unsigned int>(reported);
+        std::copy(sorted.begin(), sorted.begin() + reported, stats.costs);
+
+        std::lock_guard<std::mutex> lock(_mutex);
+        _stats = stats;
+    }
+
+    // Costs of the last completed frame that was profiled.
+    MeshCostStats stats() const
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        return _stats;
+    }
+
+  private:
+    struct TimedMesh
+    {
+        unsigned int mesh;
+        unsigned int sample;
+    };
+
+    struct Frame
+    {
+        id<MTLCounterSampleBuffer> samples = nil;
+        unsigned int next_sample = 0;
+        std::vector<TimedMesh> timed;
+        std::vector<MeshCost> counts;
+    };
+
+    id<MTLDevice> _device = nil;
+    id<MTLCounterSet> _timestamps = nil;
+    bool _draw_samples = false;
+    MTLTimestamp _cpu_start = 0;
+    MTLTimestamp _gpu_start = 0;
+
+    // One per frame in flight while enabled, empty while disabled.
+    std::vector<Frame> _frames;
+    unsigned int _frame = 0;
+
+    mutable std::mutex _mutex;
+    MeshCostStats _stats = {};
+};
+
+#endif // METALCPP_SRC_MESH_PROFILER_HPP
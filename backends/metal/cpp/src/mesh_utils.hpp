@@ -0,0 +1,271 @@
+#ifndef METALCPP_SRC_MESH_UTILS_HPP
+#define METALCPP_SRC_MESH_UTILS_HPP
+
+#include "library.h"
+#include "structs.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <unordered_map>
+#include <vector>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/packing.hpp>
+
+// FNV-1a over the raw bytes of a value.
+inline uint64_t hash_bytes(const void *data, size_t size, uint64_t hash = 14695981039346656037ull)
+{
+    const auto *bytes = reinterpret_cast<const unsigned char *>(data);
+    for (size_t i = 0; i < size; i++)
+    {
+        hash ^= bytes[i];
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+// Whether indices are given when counted and address only the first num_vertices vertices.
+inline bool mesh_indices_valid(const unsigned int *indices, unsigned int num_indices, unsigned int num_vertices)
+{
+    if (num_indices == 0)
+        return true;
+    return indices && std::all_of(indices, indices + num_indices,
+                                  [num_vertices](unsigned int index) { return index < num_vertices; });
+}
+
+// Turns a triangle soup into unique vertices plus indices. Vertices are only merged when they are bitwise identical,
+// including their joints/weights when those are given.
+template <typename T, typename JW>
+void weld_vertices(const T *vertices, const JW *joints_weights, unsigned int count, std::vector<T> &out_vertices,
+                   std::vector<JW> &out_joints_weights, std::vector<unsigned int> &out_indices)
+{
+    out_vertices.clear();
+    out_joints_weights.clear();
+    out_indices.clear();
+    out_vertices.reserve(count / 2);
+    out_indices.reserve(count);
+    if (joints_weights)
+        out_joints_weights.reserve(count / 2);
+
+    std::unordered_multimap<uint64_t, unsigned int> lookup;
+    lookup.reserve(count);
+
+    for (unsigned int i = 0; i < count; i++)
+    {
+        uint64_t hash = hash_bytes(&vertices[i], sizeof(T));
+        if (joints_weights)
+            hash = hash_bytes(&joints_weights[i], sizeof(JW), hash);
+
+        unsigned int index = ~0u;
+        const auto range = lookup.equal_range(hash);
+        for (auto it = range.first; it != range.second; ++it)
+        {
+            const unsigned int candidate = it->second;
+            if (std::memcmp(&out_vertices[candidate], &vertices[i], sizeof(T)) != 0)
+                continue;
+            if (joints_weights && std::memcmp(&out_joints_weights[candidate], &joints_weights[i], sizeof(JW)) != 0)
+                continue;
+
+            index = candidate;
+            break;
+        }
+
+        if (index == ~0u)
+        {
+            index = static_cast<unsigned int>(out_vertices.size());
+            out_vertices.push_back(vertices[i]);
+            if (joints_weights)
+                out_joints_weights.push_back(joints_weights[i]);
+            lookup.insert({hash, index});
+        }
+
+        out_indices.push_back(index);
+    }
+}
+
+// Octahedral mapping of a unit vector to two snorm16 values.
+inline void encode_octahedral(glm::vec3 n, short &x, short &y)
+{
+    const float length = std::abs(n.x) + std::abs(n.y) + std::abs(n.z);
+    glm::vec2 e = length > 0.0f ? glm::vec2(n.x, n.y) / length : glm::vec2(0.0f);
+    if (n.z < 0.0f)
+    {
+        const glm::vec2 folded = (1.0f - glm::abs(glm::vec2(e.y, e.x)));
+        e = glm::vec2(e.x >= 0.0f ? folded.x : -folded.x, e.y >= 0.0f ? folded.y : -folded.y);
+    }
+
+    x = static_cast<short>(glm::packSnorm1x16(e.x));
+    y = static_cast<short>(glm::packSnorm1x16(e.y));
+}
+
+// Triangles of one material range of a mesh, first and count are in vertices of triangle lists and in indices of
+// indexed meshes. World bounds cover the range in every instance of the mesh.
+struct Submesh
+{
+    Aabb bounds;
+    Aabb world_bounds;
+    unsigned int first;
+    unsigned int count;
+};
+
+// Material ranges of a mesh of count vertices or indices as submeshes in order, false unless there are several and
+// they cover every triangle. Ranges may overlap by a triangle, which is only drawn with the first of them.
+inline bool build_submeshes(const VertexRange *ranges, unsigned int num_ranges, unsigned int count,
+                            std::vector<Submesh> &submeshes)
+{
+    submeshes.clear();
+    for (unsigned int i = 0; i < num_ranges; i++)
+    {
+        const unsigned int first = std::min(ranges[i].first / 3 * 3, count);
+        const unsigned int last = std::min(ranges[i].last / 3 * 3, count);
+        if (first < last)
+            submeshes.push_back({ranges[i].bounds, ranges[i].bounds, first, last - first});
+    }
+    std::sort(submeshes.begin(), submeshes.end(),
+              [](const Submesh &a, const Submesh &b) { return a.first < b.first; });
+
+    // Bounds of a range stay conservative when triangles are left out of it.
+    unsigned int end = 0;
+    for (Submesh &submesh : submeshes)
+    {
+        const unsigned int last = submesh.first + submesh.count;
+        if (submesh.first > end)
+            return false;
+        submesh.first = end;
+        submesh.count = last > end ? last - end : 0;
+        end = std::max(end, last);
+    }
+    submeshes.erase(std::remove_if(submeshes.begin(), submeshes.end(), [](const Submesh &s) { return s.count == 0; }),
+                    submeshes.end());
+    return end == count && submeshes.size() > 1;
+}
+
+// Splits triangles into clusters of consecutive triangles in index order, see MeshCluster.
+inline void build_clusters(const Vertex3D *vertices, const unsigned int *indices, unsigned int num_indices,
+                           std::vector<MeshCluster> &clusters)
+{
+    clusters.clear();
+    const auto position = [vertices](unsigned int i) {
+        return glm::vec3(vertices[i].v_x, vertices[i].v_y, vertices[i].v_z);
+    };
+
+    const auto add_cluster = [&](unsigned int start, unsigned int end) {
+        glm::vec3 bmin(1e34f);
+        glm::vec3 bmax(-1e34f);
+        glm::vec3 axis(0.0f);
+        for (unsigned int i = start; i < end; i += 3)
+        {
+            const glm::vec3 p0 = position(indices[i]);
+            const glm::vec3 p1 = position(indices[i + 1]);
+            const glm::vec3 p2 = position(indices[i + 2]);
+            bmin = glm::min(bmin, glm::min(p0, glm::min(p1, p2)));
+            bmax = glm::max(bmax, glm::max(p0, glm::max(p1, p2)));
+            const glm::vec3 n = glm::cross(p1 - p0, p2 - p0);
+            const float length = glm::length(n);
+            if (length > 0.0f)
+                axis += n / length;
+        }
+
+        const glm::vec3 center = (bmin + bmax) * 0.5f;
+        float radius = 0.0f;
+        for (unsigned int i = start; i < end; i++)
+            radius = std::max(radius, glm::length(position(indices[i]) - center));
+
+        // The cone holds every triangle normal, it is only useful while all of them lie in the same half space.
+        const float axis_length = glm::length(axis);
+        axis = axis_length > 0.0f ? axis / axis_length : glm::vec3(0.0f, 0.0f, 1.0f);
+        float min_dot = axis_length > 0.0f ? 1.0f : -1.0f;
+        for (unsigned int i = start; i < end; i += 3)
+        {
+            const glm::vec3 p0 = position(indices[i]);
+            const glm::vec3 n = glm::cross(position(indices[i + 1]) - p0, position(indices[i + 2]) - p0);
+            const float length = glm::length(n);
+            if (length > 0.0f)
+                min_dot = std::min(min_dot, glm::dot(n / length, axis));
+        }
+
+        MeshCluster cluster = {};
+        cluster.sphere = simd_make_float4(center.x, center.y, center.z, radius);
+        const float cutoff = min_dot > 0.0f ? std::sqrt(1.0f - min_dot * min_dot) : 1.0f;
+        cluster.cone = simd_make_float4(axis.x, axis.y, axis.z, cutoff);
+        cluster.index_start = start;
+        cluster.index_count = end - start;
+        clusters.push_back(cluster);
+    };
+
+    std::vector<unsigned int> unique;
+    unique.reserve(CLUSTER_VERTICES);
+    const unsigned int end = num_indices - num_indices % 3;
+    unsigned int start = 0;
+    for (unsigned int i = 0; i < end; i += 3)
+    {
+        unsigned int added = 0;
+        for (unsigned int k = 0; k < 3; k++)
+        {
+            const bool repeated = std::find(indices + i, indices + i + k, indices[i + k]) != indices + i + k;
+            if (!repeated && std::find(unique.begin(), unique.end(), indices[i + k]) == unique.end())
+                added++;
+        }
+
+        if (i - start == CLUSTER_TRIANGLES * 3 || unique.size() + added > CLUSTER_VERTICES)
+        {
+            add_cluster(start, i);
+            start = i;
+            unique.clear();
+        }
+        for (unsigned int k = 0; k < 3; k++)
+        {
+            if (std::find(unique.begin(), unique.end(), indices[i + k]) == unique.end())
+                unique.push_back(indices[i + k]);
+        }
+    }
+    if (start < end)
+        add_cluster(start, end);
+}
+
+// Quantizes vertices to the packed layout, bounds receives the transform that restores the positions.
+inline void pack_vertices(const Vertex3D *vertices, unsigned int count, std::vector<PackedVertex3D> &out_vertices,
+                          PackedVertexBounds &bounds)
+{
+    glm::vec3 bmin(1e34f);
+    glm::vec3 bmax(-1e34f);
+    for (unsigned int i = 0; i < count; i++)
+    {
+        const glm::vec3 p(vertices[i].v_x, vertices[i].v_y, vertices[i].v_z);
+        bmin = glm::min(bmin, p);
+        bmax = glm::max(bmax, p);
+    }
+
+    const glm::vec3 extent = count > 0 ? bmax - bmin : glm::vec3(0.0f);
+    const glm::vec3 inv_extent = glm::vec3(extent.x > 0.0f ? 1.0f / extent.x : 0.0f,
+                                           extent.y > 0.0f ? 1.0f / extent.y : 0.0f,
+                                           extent.z > 0.0f ? 1.0f / extent.z : 0.0f);
+    bounds.offset = simd_make_float4(bmin.x, bmin.y, bmin.z, 0.0f);
+    bounds.scale = simd_make_float4(extent.x, extent.y, extent.z, 0.0f);
+
+    out_vertices.resize(count);
+    for (unsigned int i = 0; i < count; i++)
+    {
+        const Vertex3D &v = vertices[i];
+        PackedVertex3D &packed = out_vertices[i];
+
+        const glm::vec3 p = (glm::vec3(v.v_x, v.v_y, v.v_z) - bmin) * inv_extent;
+        packed.p_x = glm::packUnorm1x16(p.x);
+        packed.p_y = glm::packUnorm1x16(p.y);
+        packed.p_z = glm::packUnorm1x16(p.z);
+        packed.mat_id = static_cast<unsigned short>(std::min(v.mat_id, 0xFFFFu));
+
+        encode_octahedral(glm::vec3(v.n_x, v.n_y, v.n_z), packed.n_x, packed.n_y);
+        encode_octahedral(glm::vec3(v.t_x, v.t_y, v.t_z), packed.t_x, packed.t_y);
+
+        const glm::uint uv = glm::packHalf2x16(glm::vec2(v.u, v.v));
+        packed.u = static_cast<unsigned short>(uv & 0xFFFFu);
+        packed.v = static_cast<unsigned short>(uv >> 16u);
+        packed.flags = v.t_w < 0.0f ? 1 : 0;
+        packed.pad = 0;
+    }
+}
+
+#endif // METALCPP_SRC_MESH_UTILS_HPP
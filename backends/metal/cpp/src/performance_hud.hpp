@@ -0,0 +1,337 @@
+#ifndef METALCPP_SRC_PERFORMANCE_HUD_HPP
+#define METALCPP_SRC_PERFORMANCE_HUD_HPP
+
+#import <Metal/Metal.h>
+
+#include "library.h"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdarg>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+// Overlay of the timings, counters and memory of the renderer, drawn as quads of the 2D glyph pipeline with a built-in
+// 5x8 font. The quads are only rebuilt every UPDATE_INTERVAL_MS from what was accumulated in between, the frames in
+// between draw the same quads again. Graphs show the last HISTORY updates, each bar scaled to the highest one.
+class PerformanceHud
+{
+  public:
+    static constexpr double UPDATE_INTERVAL_MS = 250.0;
+    static constexpr unsigned int HISTORY = 64;
+    // Drawable pixels per font pixel.
+    static constexpr float SCALE = 2.0f;
+
+    // RFW_METAL_HUD=1 shows the overlay from the start.
+    static bool enabled_by_environment()
+    {
+        const char *hud = getenv("RFW_METAL_HUD");
+        return hud && atoi(hud) != 0;
+    }
+
+    // Creates the font atlas the first time the overlay is shown.
+    void set_enabled(id<MTLDevice> device, bool enabled)
+    {
+        _enabled = enabled;
+        if (!enabled || _atlas != nil)
+            return;
+
+        MTLTextureDescriptor *desc = [MTLTextureDescriptor texture2DDescriptorWithPixelFormat:MTLPixelFormatR8Unorm
+                                                                                        width:ATLAS_WIDTH
+                                                                                       height:ATLAS_HEIGHT
+                                                                                    mipmapped:NO];
+        desc.usage = MTLTextureUsageShaderRead;
+        _atlas = [device newTextureWithDescriptor:desc];
+        _atlas.label = @"PerformanceHudFont";
+
+        // Glyphs keep a texel of no coverage around them, so the linear filter of the glyph pipeline never samples a
+        // neighbour.
+        std::vector<unsigned char> pixels(ATLAS_WIDTH * ATLAS_HEIGHT, 0);
+        for (unsigned int c = 0; c < GLYPH_COUNT; c++)
+        {
+            const unsigned int x = (c % ATLAS_COLUMNS) * CELL_WIDTH + 1;
+            const unsigned int y = (c / ATLAS_COLUMNS) * CELL_HEIGHT + 1;
+            for (unsigned int column = 0; column < FONT_WIDTH; column++)
+            {
+                for (unsigned int row = 0; row < FONT_HEIGHT; row++)
+                {
+                    if ((FONT[c][column] >> row) & 1u)
+                        pixels[(y + row) * ATLAS_WIDTH + x + column] = 255;
+                }
+            }
+        }
+        for (unsigned int y = 0; y < SOLID_SIZE; y++)
+            std::fill_n(pixels.begin() + (SOLID_Y + y) * ATLAS_WIDTH + SOLID_X, SOLID_SIZE, 255);
+        [_atlas replaceRegion:MTLRegionMake2D(0, 0, ATLAS_WIDTH, ATLAS_HEIGHT)
+                  mipmapLevel:0
+                    withBytes:pixels.data()
+                  bytesPerRow:ATLAS_WIDTH];
+        _last_update = std::chrono::steady_clock::now();
+    }
+
+    bool enabled() const
+    {
+        return _enabled;
+    }
+
+    // CPU time of synchronize and render calls, averaged over the calls until the next update.
+    void add_synchronize(double ms)
+    {
+        _synchronize_ms += ms;
+        _synchronizes++;
+    }
+
+    void add_render(double ms)
+    {
+        _render_ms += ms;
+        _renders++;
+    }
+
+    bool due() const
+    {
+        const auto elapsed = std::chrono::steady_clock::now() - _last_update;
+        return _glyphs.empty() || std::chrono::duration<double, std::milli>(elapsed).count() >= UPDATE_INTERVAL_MS;
+    }
+
+    // Rebuilds the quads from the stats of the last completed frame, the memory of the instance and the bytes it
+    // uploaded so far.
+    void update(const FrameStats &stats, const MemoryStats &memory, uint64_t uploaded_bytes)
+    {
+        const auto now = std::chrono::steady_clock::now();
+        const double elapsed_ms = std::chrono::duration<double, std::milli>(now - _last_update).count();
+        const double frames = std::max(_renders, 1u);
+        const double synchronize_ms = _synchronizes > 0 ? _synchronize_ms / _synchronizes : 0.0;
+        const double render_ms = _render_ms / frames;
+        const double upload_bytes = static_cast<double>(uploaded_bytes - _uploaded_bytes) / frames;
+        const double fps = elapsed_ms > 0.0 ? _renders * 1000.0 / elapsed_ms : 0.0;
+        _last_update = now;
+        _uploaded_bytes = uploaded_bytes;
+        _synchronize_ms = _render_ms = 0.0;
+        _synchronizes = _renders = 0;
+
+        _history[GRAPH_GPU][_next] = stats.frame_ms;
+        _history[GRAPH_CPU][_next] = static_cast<float>(synchronize_ms + render_ms);
+        _history[GRAPH_DRAWS][_next] = static_cast<float>(stats.draws);
+        _history[GRAPH_UPLOAD][_next] = static_cast<float>(upload_bytes / MB);
+        _next = (_next + 1) % HISTORY;
+        _filled = std::min(_filled + 1, HISTORY);
+
+        _glyphs.clear();
+        _glyphs.push_back(solid(0.0f, 0.0f, PANEL_WIDTH, PANEL_HEIGHT, BACKGROUND));
+        _line = 0;
+        print("FPS %.1f  CPU SYNC %.2f  RENDER %.2f MS", fps, synchronize_ms, render_ms);
+        print("GPU %.2f MS", stats.frame_ms);
+        print("SKIN %.2f CULL %.2f DEPTH %.2f SHADOW %.2f", stats.pass_ms[FRAME_PASS_SKINNING],
+              stats.pass_ms[FRAME_PASS_CULLING], stats.pass_ms[FRAME_PASS_DEPTH], stats.pass_ms[FRAME_PASS_SHADOWS]);
+        print("LIGHT %.2f 3D %.2f UPSCALE %.2f 2D %.2f", stats.pass_ms[FRAME_PASS_LIGHTING],
+              stats.pass_ms[FRAME_PASS_3D], stats.pass_ms[FRAME_PASS_UPSCALE], stats.pass_ms[FRAME_PASS_2D]);
+        print("DRAWS %u  INSTANCES %u  TRIANGLES %.2fM", stats.draws, stats.instances, stats.triangles / 1e6);
+        print("UPLOAD %.2f MB/FRAME", upload_bytes / MB);
+        print("VERTICES %.1f MB  INSTANCES %.1f MB", memory.bytes[MEMORY_VERTICES] / MB,
+              memory.bytes[MEMORY_INSTANCES] / MB);
+        print("TEXTURES %.1f MB  ARGUMENTS %.1f MB", memory.bytes[MEMORY_TEXTURES] / MB,
+              memory.bytes[MEMORY_ARGUMENTS] / MB);
+        print("TARGETS %.1f MB  STAGING %.1f MB", memory.bytes[MEMORY_TARGETS] / MB,
+              memory.bytes[MEMORY_STAGING] / MB);
+        print("DEVICE %.1f OF %.1f MB", memory.allocated / MB, memory.recommended_working_set / MB);
+
+        graph(GRAPH_GPU, 0, "GPU MS", COLOR_GPU);
+        graph(GRAPH_CPU, 1, "CPU MS", COLOR_CPU);
+        graph(GRAPH_DRAWS, 2, "DRAWS", COLOR_DRAWS);
+        graph(GRAPH_UPLOAD, 3, "UPLOAD MB", COLOR_UPLOAD);
+    }
+
+    const std::vector<GlyphInstance> &glyphs() const
+    {
+        return _glyphs;
+    }
+
+    id<MTLTexture> atlas() const
+    {
+        return _atlas;
+    }
+
+    // Size of the panel in drawable pixels from the top left corner, passes that draw the overlay only cover it.
+    unsigned int width() const
+    {
+        return static_cast<unsigned int>(PANEL_WIDTH * SCALE);
+    }
+
+    unsigned int height() const
+    {
+        return static_cast<unsigned int>(PANEL_HEIGHT * SCALE);
+    }
+
+  private:
+    static constexpr unsigned int FONT_WIDTH = 5;
+    static constexpr unsigned int FONT_HEIGHT = 8;
+    // Glyphs of ' ' to '_', lower case letters are drawn upper case.
+    static constexpr unsigned int FIRST_GLYPH = 32;
+    static constexpr unsigned int GLYPH_COUNT = 64;
+    static constexpr unsigned int CELL_WIDTH = FONT_WIDTH + 2;
+    static constexpr unsigned int CELL_HEIGHT = FONT_HEIGHT + 2;
+    static constexpr unsigned int ATLAS_COLUMNS = 16;
+    static constexpr unsigned int ATLAS_WIDTH = 128;
+    static constexpr unsigned int ATLAS_HEIGHT = 64;
+    // Quads of solid color sample the center of a block of full coverage.
+    static constexpr unsigned int SOLID_X = 120;
+    static constexpr unsigned int SOLID_Y = 0;
+    static constexpr unsigned int SOLID_SIZE = 4;
+
+    // Layout in font pixels.
+    static constexpr float MARGIN = 4.0f;
+    static constexpr float ADVANCE = 6.0f;
+    static constexpr float LINE_HEIGHT = 10.0f;
+    static constexpr unsigned int COLUMNS = 44;
+    static constexpr unsigned int LINES = 10;
+    static constexpr unsigned int GRAPH_ROWS = 2;
+    static constexpr float GRAPH_HEIGHT = 16.0f;
+    static constexpr float GRAPH_ROW_HEIGHT = LINE_HEIGHT + GRAPH_HEIGHT + 4.0f;
+    static constexpr float GRAPH_WIDTH = COLUMNS * ADVANCE / 2.0f - ADVANCE;
+    static constexpr float BAR_WIDTH = GRAPH_WIDTH / HISTORY;
+    static constexpr float PANEL_WIDTH = MARGIN * 2.0f + COLUMNS * ADVANCE;
+    static constexpr float PANEL_HEIGHT = MARGIN * 2.0f + LINES * LINE_HEIGHT + GRAPH_ROWS * GRAPH_ROW_HEIGHT;
+
+    static constexpr double MB = 1024.0 * 1024.0;
+
+    // RGBA8 with red in the lowest byte.
+    static constexpr unsigned int BACKGROUND = 0xC0000000u;
+    static constexpr unsigned int TEXT = 0xFFFFFFFFu;
+    static constexpr unsigned int GRAPH_BACKGROUND = 0x40FFFFFFu;
+    static constexpr unsigned int COLOR_GPU = 0xFF40C0FFu;
+    static constexpr unsigned int COLOR_CPU = 0xFF80FF40u;
+    static constexpr unsigned int COLOR_DRAWS = 0xFFFF8040u;
+    static constexpr unsigned int COLOR_UPLOAD = 0xFF40FFFFu;
+
+    enum Graph : unsigned int
+    {
+        GRAPH_GPU = 0,
+        GRAPH_CPU = 1,
+        GRAPH_DRAWS = 2,
+        GRAPH_UPLOAD = 3,
+        GRAPH_COUNT = 4
+    };
+
+    // Columns of every glyph from left to right, the lowest bit is the top row.
+    static constexpr unsigned char FONT[GLYPH_COUNT][FONT_WIDTH] = {
+        {0x00, 0x00, 0x00, 0x00, 0x00}, {0x00, 0x00, 0x5F, 0x00, 0x00}, {0x00, 0x07, 0x00, 0x07, 0x00},
+        {0x14, 0x7F, 0x14, 0x7F, 0x14}, {0x24, 0x2A, 0x7F, 0x2A, 0x12}, {0x23, 0x13, 0x08, 0x64, 0x62},
+        {0x36, 0x49, 0x56, 0x20, 0x50}, {0x00, 0x08, 0x07, 0x03, 0x00}, {0x00, 0x1C, 0x22, 0x41, 0x00},
+        {0x00, 0x41, 0x22, 0x1C, 0x00}, {0x2A, 0x1C, 0x7F, 0x1C, 0x2A}, {0x08, 0x08, 0x3E, 0x08, 0x08},
+        {0x00, 0x80, 0x70, 0x30, 0x00}, {0x08, 0x08, 0x08, 0x08, 0x08}, {0x00, 0x00, 0x60, 0x60, 0x00},
+        {0x20, 0x10, 0x08, 0x04, 0x02}, {0x3E, 0x51, 0x49, 0x45, 0x3E}, {0x00, 0x42, 0x7F, 0x40, 0x00},
+        {0x72, 0x49, 0x49, 0x49, 0x46}, {0x21, 0x41, 0x49, 0x4D, 0x33}, {0x18, 0x14, 0x12, 0x7F, 0x10},
+        {0x27, 0x45, 0x45, 0x45, 0x39}, {0x3C, 0x4A, 0x49, 0x49, 0x31}, {0x41, 0x21, 0x11, 0x09, 0x07},
+        {0x36, 0x49, 0x49, 0x49, 0x36}, {0x46, 0x49, 0x49, 0x29, 0x1E}, {0x00, 0x00, 0x14, 0x00, 0x00},
+        {0x00, 0x40, 0x34, 0x00, 0x00}, {0x00, 0x08, 0x14, 0x22, 0x41}, {0x14, 0x14, 0x14, 0x14, 0x14},
+        {0x00, 0x41, 0x22, 0x14, 0x08}, {0x02, 0x01, 0x59, 0x09, 0x06}, {0x3E, 0x41, 0x5D, 0x59, 0x4E},
+        {0x7C, 0x12, 0x11, 0x12, 0x7C}, {0x7F, 0x49, 0x49, 0x49, 0x36}, {0x3E, 0x41, 0x41, 0x41, 0x22},
+        {0x7F, 0x41, 0x41, 0x41, 0x3E}, {0x7F, 0x49, 0x49, 0x49, 0x41}, {0x7F, 0x09, 0x09, 0x09, 0x01},
+        {0x3E, 0x41, 0x41, 0x51, 0x73}, {0x7F, 0x08, 0x08, 0x08, 0x7F}, {0x00, 0x41, 0x7F, 0x41, 0x00},
+        {0x20, 0x40, 0x41, 0x3F, 0x01}, {0x7F, 0x08, 0x14, 0x22, 0x41}, {0x7F, 0x40, 0x40, 0x40, 0x40},
+        {0x7F, 0x02, 0x1C, 0x02, 0x7F}, {0x7F, 0x04, 0x08, 0x10, 0x7F}, {0x3E, 0x41, 0x41, 0x41, 0x3E},
+        {0x7F, 0x09, 0x09, 0x09, 0x06}, {0x3E, 0x41, 0x51, 0x21, 0x5E}, {0x7F, 0x09, 0x19, 0x29, 0x46},
+        {0x26, 0x49, 0x49, 0x49, 0x32}, {0x03, 0x01, 0x7F, 0x01, 0x03}, {0x3F, 0x40, 0x40, 0x40, 0x3F},
+        {0x1F, 0x20, 0x40, 0x20, 0x1F}, {0x3F, 0x40, 0x38, 0x40, 0x3F}, {0x63, 0x14, 0x08, 0x14, 0x63},
+        {0x03, 0x04, 0x78, 0x04, 0x03}, {0x61, 0x59, 0x49, 0x4D, 0x43}, {0x00, 0x7F, 0x41, 0x41, 0x41},
+        {0x02, 0x04, 0x08, 0x10, 0x20}, {0x00, 0x41, 0x41, 0x41, 0x7F}, {0x04, 0x02, 0x01, 0x02, 0x04},
+        {0x40, 0x40, 0x40, 0x40, 0x40}};
+
+    // Positions and sizes of quads are in font pixels.
+    static GlyphInstance solid(float x, float y, float width, float height, unsigned int color)
+    {
+        GlyphInstance glyph = {};
+        glyph.x = x * SCALE;
+        glyph.y = y * SCALE;
+        glyph.width = width * SCALE;
+        glyph.height = height * SCALE;
+        glyph.color = color;
+        glyph.atlas_x = SOLID_X + 1;
+        glyph.atlas_y = SOLID_Y + 1;
+        glyph.atlas_width = SOLID_SIZE - 2;
+        glyph.atlas_height = SOLID_SIZE - 2;
+        return glyph;
+    }
+
+    void text(float x, float y, const char *string, unsigned int color)
+    {
+        for (const char *c = string; *c != '\0'; c++, x += ADVANCE)
+        {
+            unsigned int code = static_cast<unsigned char>(*c);
+            if (code >= 'a' && code <= 'z')
+                code -= 'a' - 'A';
+            if (code <= FIRST_GLYPH || code >= FIRST_GLYPH + GLYPH_COUNT)
+                continue;
+
+            const unsigned int index = code - FIRST_GLYPH;
+            GlyphInstance glyph = {};
+            glyph.x = x * SCALE;
+            glyph.y = y * SCALE;
+            glyph.width = FONT_WIDTH * SCALE;
+            glyph.height = FONT_HEIGHT * SCALE;
+            glyph.color = color;
+            glyph.atlas_x = static_cast<unsigned short>((index % ATLAS_COLUMNS) * CELL_WIDTH + 1);
+            glyph.atlas_y = static_cast<unsigned short>((index / ATLAS_COLUMNS) * CELL_HEIGHT + 1);
+            glyph.atlas_width = FONT_WIDTH;
+            glyph.atlas_height = FONT_HEIGHT;
+            _glyphs.push_back(glyph);
+        }
+    }
+
+    // Prints the next line of text, cut off at COLUMNS characters.
+    __attribute__((format(printf, 2, 3))) void print(const char *format, ...)
+    {
+        char line[COLUMNS + 1];
+        va_list args;
+        va_start(args, format);
+        vsnprintf(line, sizeof(line), format, args);
+        va_end(args);
+        text(MARGIN, MARGIN + static_cast<float>(_line++) * LINE_HEIGHT, line, TEXT);
+    }
+
+    // Graphs are laid out two per row below the text, the label shows the latest value over the highest one.
+    void graph(Graph index, unsigned int slot, const char *label, unsigned int color)
+    {
+        const float x = MARGIN + static_cast<float>(slot % 2) * (GRAPH_WIDTH + ADVANCE);
+        const float y = MARGIN + LINES * LINE_HEIGHT + static_cast<float>(slot / 2) * GRAPH_ROW_HEIGHT;
+        const std::array<float, HISTORY> &history = _history[index];
+        const float latest = history[(_next + HISTORY - 1) % HISTORY];
+        const float highest = std::max(*std::max_element(history.begin(), history.end()), 1e-6f);
+
+        char line[COLUMNS / 2];
+        snprintf(line, sizeof(line), "%s %.1f/%.1f", label, latest, highest);
+        text(x, y, line, TEXT);
+
+        const float bottom = y + LINE_HEIGHT + GRAPH_HEIGHT;
+        _glyphs.push_back(solid(x, y + LINE_HEIGHT, GRAPH_WIDTH, GRAPH_HEIGHT, GRAPH_BACKGROUND));
+        // Oldest on the left, bars that were not recorded yet stay empty.
+        for (unsigned int i = HISTORY - _filled; i < HISTORY; i++)
+        {
+            const float value = history[(_next + i) % HISTORY];
+            const float bar = std::min(value / highest, 1.0f) * GRAPH_HEIGHT;
+            if (bar > 0.0f)
+                _glyphs.push_back(solid(x + i * BAR_WIDTH, bottom - bar, BAR_WIDTH, bar, color));
+        }
+    }
+
+    bool _enabled = false;
+    id<MTLTexture> _atlas = nil;
+    std::vector<GlyphInstance> _glyphs;
+    unsigned int _line = 0;
+
+    std::chrono::steady_clock::time_point _last_update;
+    double _synchronize_ms = 0.0;
+    double _render_ms = 0.0;
+    unsigned int _synchronizes = 0;
+    unsigned int _renders = 0;
+    uint64_t _uploaded_bytes = 0;
+
+    std::array<std::array<float, HISTORY>, GRAPH_COUNT> _history = {};
+    unsigned int _next = 0;
+    unsigned int _filled = 0;
+};
+
+#endif // METALCPP_SRC_PERFORMANCE_HUD_HPP
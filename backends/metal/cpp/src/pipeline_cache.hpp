@@ -0,0 +1,185 @@
+#ifndef METALCPP_SRC_PIPELINE_CACHE_HPP
+#define METALCPP_SRC_PIPELINE_CACHE_HPP
+
+#import <Metal/Metal.h>
+
+#include <cassert>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Compiles pipeline states concurrently with the asynchronous Metal calls, every state is written to its target once
+// it compiled. Given a directory, states compiled before are loaded from a binary archive in it, so the driver does
+// not compile them again. Targets must not be read before wait() returned.
+class PipelineCache
+{
+  public:
+    PipelineCache() : _group(dispatch_group_create())
+    {
+    }
+
+    PipelineCache(const PipelineCache &) = delete;
+    PipelineCache &operator=(const PipelineCache &) = delete;
+
+    ~PipelineCache()
+    {
+        wait();
+    }
+
+    // Opens the archive for this device and shader library in directory, key should change whenever the shaders do.
+    // The archive is created once every pipeline compiled when it does not exist yet.
+    void open(id<MTLDevice> device, const char *directory, size_t key)
+    {
+        _device = device;
+        if (!directory)
+            return;
+
+        if (@available(macOS 11.0, *))
+        {
+            const size_t device_key = std::hash<std::string>()([[device name] UTF8String]);
+            NSString *name = [NSString stringWithFormat:@"pipelines-%zx.metalarchive", key ^ (device_key << 1)];
+            _url = [[NSURL fileURLWithPath:[NSString stringWithUTF8String:directory] isDirectory:YES]
+                URLByAppendingPathComponent:name];
+
+            NSError *err = nil;
+            MTLBinaryArchiveDescriptor *desc = [MTLBinaryArchiveDescriptor new];
+            if ([[NSFileManager defaultManager] fileExistsAtPath:[_url path]])
+                desc.url = _url;
+            _archive = [device newBinaryArchiveWithDescriptor:desc error:&err];
+            if (err && desc.url)
+            {
+                // Unreadable archives are replaced by a new one.
+                NSLog(@"Could not load pipeline archive %@: %@", [_url path], [err localizedDescription]);
+                desc.url = nil;
+                err = nil;
+                _archive = [device newBinaryArchiveWithDescriptor:desc error:&err];
+            }
+            if (err)
+            {
+                NSLog(@"Could not create pipeline archive: %@", [err localizedDescription]);
+                _archive = nil;
+            }
+            _serialize = _archive != nil && desc.url == nil;
+        }
+    }
+
+    void create(MTLRenderPipelineDescriptor *desc, __strong id<MTLRenderPipelineState> *target)
+    {
+        // Descriptors are reused for the next variant, compilation continues on a copy.
+        MTLRenderPipelineDescriptor *copy = [desc copy];
+        if (@available(macOS 11.0, *))
+        {
+            if (_archive)
+                copy.binaryArchives = @[ _archive ];
+        }
+
+        dispatch_group_enter(_group);
+        MTLNewRenderPipelineStateCompletionHandler done = ^(id<MTLRenderPipelineState> state, NSError *err) {
+          if (err)
+          {
+              NSLog(@"%@: %@", copy.label, [err localizedDescription]);
+              assert(false);
+          }
+          *target = state;
+          dispatch_group_leave(_group);
+        };
+        [_device newRenderPipelineStateWithDescriptor:copy completionHandler:done];
+
+        std::lock_guard<std::mutex> lock(_mutex);
+        _render_descriptors.push_back(copy);
+    }
+
+    void create(id<MTLFunction> function, __strong id<MTLComputePipelineState> *target)
+    {
+        MTLComputePipelineDescriptor *desc = [MTLComputePipelineDescriptor new];
+        desc.computeFunction = function;
+        desc.label = function.name;
+        if (@available(macOS 11.0, *))
+        {
+            if (_archive)
+                desc.binaryArchives = @[ _archive ];
+        }
+
+        dispatch_group_enter(_group);
+        MTLNewComputePipelineStateWithReflectionCompletionHandler done =
+            ^(id<MTLComputePipelineState> state, MTLComputePipelineReflection *, NSError *err) {
+              if (err)
+              {
+                  NSLog(@"%@: %@", desc.label, [err localizedDescription]);
+                  assert(false);
+              }
+              *target = state;
+              dispatch_group_leave(_group);
+            };
+        [_device newComputePipelineStateWithDescriptor:desc options:MTLPipelineOptionNone completionHandler:done];
+
+        std::lock_guard<std::mutex> lock(_mutex);
+        _compute_descriptors.push_back(desc);
+    }
+
+    // Runs setup on a background queue, ready() and wait() cover it and every state it creates.
+    void prepare(dispatch_block_t setup)
+    {
+        dispatch_group_async(_group, dispatch_get_global_queue(QOS_CLASS_USER_INITIATED, 0), setup);
+    }
+
+    // Calls done on a background queue once setup and every state created so far completed.
+    void notify(dispatch_block_t done)
+    {
+        dispatch_group_notify(_group, dispatch_get_global_queue(QOS_CLASS_USER_INITIATED, 0), done);
+    }
+
+    // True once every state created so far compiled.
+    bool ready() const
+    {
+        return dispatch_group_wait(_group, DISPATCH_TIME_NOW) == 0;
+    }
+
+    // Blocks until every state compiled, then writes a new archive.
+    void wait()
+    {
+        dispatch_group_wait(_group, DISPATCH_TIME_FOREVER);
+
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (_serialize)
+            serialize();
+        _render_descriptors.clear();
+        _compute_descriptors.clear();
+    }
+
+  private:
+    void serialize()
+    {
+        _serialize = false;
+        if (@available(macOS 11.0, *))
+        {
+            NSError *err = nil;
+            for (MTLRenderPipelineDescriptor *desc : _render_descriptors)
+            {
+                if (![_archive addRenderPipelineFunctionsWithDescriptor:desc error:&err])
+                    NSLog(@"%@ is not archived: %@", desc.label, [err localizedDescription]);
+            }
+            for (MTLComputePipelineDescriptor *desc : _compute_descriptors)
+            {
+                if (![_archive addComputePipelineFunctionsWithDescriptor:desc error:&err])
+                    NSLog(@"%@ is not archived: %@", desc.label, [err localizedDescription]);
+            }
+
+            if (![_archive serializeToURL:_url error:&err])
+                NSLog(@"Could not write pipeline archive %@: %@", [_url path], [err localizedDescription]);
+        }
+    }
+
+    id<MTLDevice> _device = nil;
+    dispatch_group_t _group;
+    NSURL *_url = nil;
+    id<MTLBinaryArchive> _archive API_AVAILABLE(macos(11.0)) = nil;
+    bool _serialize = false;
+
+    std::mutex _mutex;
+    std::vector<MTLRenderPipelineDescriptor *> _render_descriptors;
+    std::vector<MTLComputePipelineDescriptor *> _compute_descriptors;
+};
+
+#endif // METALCPP_SRC_PIPELINE_CACHE_HPP
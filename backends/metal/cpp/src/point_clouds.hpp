@@ -0,0 +1,125 @@
+#ifndef METALCPP_SRC_POINT_CLOUDS_HPP
+#define METALCPP_SRC_POINT_CLOUDS_HPP
+
+#import <Metal/Metal.h>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <random>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "structs.h"
+
+// Points of a chunk are quantized to POINT_QUANTIZATION steps of its bounds along every axis.
+constexpr float POINT_QUANTIZATION[3] = {2047.0f, 2047.0f, 1023.0f};
+
+// Range of a point cloud's buffer whose points lie within bmin and bmin + extent. The points are in random order, so
+// the first points of a chunk are an even subset of all of them.
+struct PointChunk
+{
+    glm::vec3 bmin;
+    glm::vec3 extent;
+    unsigned int first;
+    unsigned int count;
+};
+
+struct PointCloud
+{
+    id<MTLBuffer> points = nil;
+    std::vector<PointChunk> chunks;
+    // Kept in double precision, scans are often placed far from the world origin.
+    glm::dmat4 transform = glm::dmat4(1.0);
+};
+
+inline unsigned int pack_point_position(glm::vec3 quantized)
+{
+    const glm::uvec3 q = glm::uvec3(quantized + 0.5f);
+    return q.x | (q.y << 11) | (q.z << 22);
+}
+
+// Sorts count points into cubic cells of about POINT_CHUNK_SIZE points each and writes them packed into out, cell by
+// cell. Cells with more points are split into chunks sharing the bounds of the cell. Points without colors are white.
+inline std::vector<PointChunk> build_point_chunks(const Vector3 *positions, const unsigned int *colors,
+                                                  unsigned int count, PackedPoint *out)
+{
+    const float inf = std::numeric_limits<float>::infinity();
+    glm::vec3 bmin(inf);
+    glm::vec3 bmax(-inf);
+    for (unsigned int i = 0; i < count; i++)
+    {
+        const glm::vec3 p(positions[i].x, positions[i].y, positions[i].z);
+        bmin = glm::min(bmin, p);
+        bmax = glm::max(bmax, p);
+    }
+    const glm::vec3 extent = glm::max(bmax - bmin, glm::vec3(1e-3f));
+
+    // Scans are mostly surfaces, so cells sized by the volume end up with too many points. Cells shrink until the
+    // grid has about as many cells as chunks are wanted, which overestimates the occupied cells of surfaces less.
+    constexpr double MAX_CELLS = 1 << 22;
+    const double wanted = std::max(1.0, static_cast<double>(count) / POINT_CHUNK_SIZE);
+    float cell = std::cbrt(extent.x * extent.y * extent.z / static_cast<float>(wanted));
+    glm::uvec3 dims(1);
+    for (unsigned int attempt = 0; attempt < 32; attempt++)
+    {
+        const glm::uvec3 next = glm::max(glm::uvec3(glm::ceil(extent / cell)), glm::uvec3(1));
+        if (static_cast<double>(next.x) * next.y * next.z > MAX_CELLS)
+            break;
+        dims = next;
+        if (static_cast<double>(dims.x) * dims.y * dims.z >= wanted)
+            break;
+        cell *= 0.7f;
+    }
+    cell = std::max({extent.x / static_cast<float>(dims.x), extent.y / static_cast<float>(dims.y),
+                     extent.z / static_cast<float>(dims.z)});
+
+    const auto cell_of = [&](const Vector3 &p) {
+        return glm::min(glm::uvec3((glm::vec3(p.x, p.y, p.z) - bmin) / cell), dims - 1u);
+    };
+    const auto index_of = [&](glm::uvec3 c) { return c.x + dims.x * (c.y + dims.y * c.z); };
+
+    // Counting sort by cell, the packed points are written straight into their place.
+    std::vector<unsigned int> offsets(static_cast<size_t>(dims.x) * dims.y * dims.z + 1, 0);
+    for (unsigned int i = 0; i < count; i++)
+        offsets[index_of(cell_of(positions[i])) + 1]++;
+    for (size_t c = 1; c < offsets.size(); c++)
+        offsets[c] += offsets[c - 1];
+    std::vector<unsigned int> cursors(offsets.begin(), offsets.end() - 1);
+    const glm::vec3 scale = glm::vec3(POINT_QUANTIZATION[0], POINT_QUANTIZATION[1], POINT_QUANTIZATION[2]) / cell;
+    for (unsigned int i = 0; i < count; i++)
+    {
+        const glm::uvec3 c = cell_of(positions[i]);
+        const glm::vec3 local = glm::vec3(positions[i].x, positions[i].y, positions[i].z) - bmin - glm::vec3(c) * cell;
+        const glm::vec3 quantized =
+            glm::clamp(local * scale, glm::vec3(0.0f),
+                       glm::vec3(POINT_QUANTIZATION[0], POINT_QUANTIZATION[1], POINT_QUANTIZATION[2]));
+        out[cursors[index_of(c)]++] = {pack_point_position(quantized), colors ? colors[i] : 0xFFFFFFFFu};
+    }
+
+    std::vector<PointChunk> chunks;
+    std::minstd_rand random;
+    for (unsigned int z = 0; z < dims.z; z++)
+    {
+        for (unsigned int y = 0; y < dims.y; y++)
+        {
+            for (unsigned int x = 0; x < dims.x; x++)
+            {
+                const unsigned int index = index_of(glm::uvec3(x, y, z));
+                const unsigned int first = offsets[index];
+                const unsigned int end = offsets[index + 1];
+                std::shuffle(out + first, out + end, random);
+                const glm::vec3 cell_min = bmin + glm::vec3(x, y, z) * cell;
+                for (unsigned int start = first; start < end; start += POINT_CHUNK_SIZE)
+                {
+                    const unsigned int points = std::min(end - start, static_cast<unsigned int>(POINT_CHUNK_SIZE));
+                    chunks.push_back({cell_min, glm::vec3(cell), start, points});
+                }
+            }
+        }
+    }
+    return chunks;
+}
+
+#endif // METALCPP_SRC_POINT_CLOUDS_HPP
@@ -0,0 +1,118 @@
+#ifndef METALCPP_SRC_PURGEABLE_CACHE_HPP
+#define METALCPP_SRC_PURGEABLE_CACHE_HPP
+
+#import <Metal/Metal.h>
+
+#include <cstddef>
+#include <iterator>
+#include <list>
+#include <unordered_map>
+
+// Resources that were dropped but may be used again. They are kept volatile, so the OS reclaims their memory under
+// pressure instead of the process getting evicted, and the oldest ones are released once the cache exceeds its
+// capacity. Resources must no longer be used by the GPU when they are inserted.
+template <typename Key, typename Info> class PurgeableCache
+{
+  public:
+    struct Entry
+    {
+        id<MTLResource> resource = nil;
+        Info info = {};
+    };
+
+    void set_capacity(size_t bytes)
+    {
+        _capacity = bytes;
+        trim();
+    }
+
+    size_t capacity() const
+    {
+        return _capacity;
+    }
+
+    // Bytes of the resources in the cache, including ones the OS already purged.
+    size_t size() const
+    {
+        return _size;
+    }
+
+    void insert(const Key &key, id<MTLResource> resource, const Info &info)
+    {
+        erase(key);
+        const size_t size = resource != nil ? resource.allocatedSize : 0;
+        if (size == 0 || size > _capacity)
+            return;
+
+        [resource setPurgeableState:MTLPurgeableStateVolatile];
+        _nodes.push_back({key, {resource, info}, size});
+        _index[key] = std::prev(_nodes.end());
+        _size += size;
+        trim();
+    }
+
+    // Removes the entry of key from the cache and makes its resource non-volatile again, false when there is none or
+    // the OS purged its contents.
+    bool take(const Key &key, Entry &entry)
+    {
+        const auto it = _index.find(key);
+        if (it == _index.end())
+            return false;
+
+        const Entry taken = it->second->entry;
+        remove(it);
+        if ([taken.resource setPurgeableState:MTLPurgeableStateNonVolatile] == MTLPurgeableStateEmpty)
+            return false;
+        entry = taken;
+        return true;
+    }
+
+    bool contains(const Key &key) const
+    {
+        return _index.count(key) > 0;
+    }
+
+    void erase(const Key &key)
+    {
+        const auto it = _index.find(key);
+        if (it != _index.end())
+            remove(it);
+    }
+
+    void clear()
+    {
+        _nodes.clear();
+        _index.clear();
+        _size = 0;
+    }
+
+  private:
+    struct Node
+    {
+        Key key;
+        Entry entry;
+        size_t size;
+    };
+    using Index = std::unordered_map<Key, typename std::list<Node>::iterator>;
+
+    void remove(typename Index::const_iterator it)
+    {
+        _size -= it->second->size;
+        _nodes.erase(it->second);
+        _index.erase(it);
+    }
+
+    void trim()
+    {
+        while (_size > _capacity && !_nodes.empty())
+            remove(_index.find(_nodes.front().key));
+    }
+
+    // Oldest first.
+    std::list<Node> _nodes;
+    Index _index;
+    size_t _size = 0;
+    size_t _capacity = 0;
+};
+
+#endif // METALCPP_SRC_PURGEABLE_CACHE_HPP
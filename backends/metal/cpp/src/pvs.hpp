@@ -0,0 +1,92 @@
+#ifndef METALCPP_SRC_PVS_HPP
+#define METALCPP_SRC_PVS_HPP
+
+#include "id_table.hpp"
+#include "library.h"
+
+#include <cmath>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+// Copy of a baked potentially visible set. Meshes map to their bit in the words of every cell, meshes it doesn't name
+// and positions outside its cells see everything.
+class PotentiallyVisibleSet
+{
+  public:
+    static constexpr unsigned int NO_CELL = ~0u;
+
+    void set(const PvsData &pvs)
+    {
+        _bits.clear();
+        _mesh_bits.clear();
+        if (pvs.bits == nullptr || pvs.meshes == nullptr || pvs.num_meshes == 0 || pvs.cell_size <= 0.0f)
+            return;
+
+        _origin = glm::vec3(pvs.bounds.bmin.x, pvs.bounds.bmin.y, pvs.bounds.bmin.z);
+        _cell_size = pvs.cell_size;
+        _cells = glm::uvec3(pvs.cells_x, pvs.cells_y, pvs.cells_z);
+        _words = (pvs.num_meshes + 31) / 32;
+        _bits.assign(pvs.bits, pvs.bits + size_t(_cells.x) * _cells.y * _cells.z * _words);
+        for (unsigned int i = 0; i < pvs.num_meshes; i++)
+            _mesh_bits.insert(pvs.meshes[i], i);
+    }
+
+    bool empty() const
+    {
+        return _bits.empty();
+    }
+
+    unsigned int cell_at(const glm::vec3 &position) const
+    {
+        if (_bits.empty())
+            return NO_CELL;
+        const glm::vec3 cell = glm::floor((position - _origin) / _cell_size);
+        if (glm::any(glm::lessThan(cell, glm::vec3(0.0f))) || glm::any(glm::greaterThanEqual(cell, glm::vec3(_cells))))
+            return NO_CELL;
+        const glm::uvec3 c(cell);
+        return c.x + _cells.x * (c.y + _cells.y * c.z);
+    }
+
+    bool visible(unsigned int cell, unsigned int mesh) const
+    {
+        const unsigned int *bit = cell == NO_CELL ? nullptr : _mesh_bits.find(mesh);
+        return !bit || (_bits[size_t(cell) * _words + *bit / 32] >> (*bit % 32) & 1u) != 0;
+    }
+
+  private:
+    glm::vec3 _origin = glm::vec3(0.0f);
+    float _cell_size = 1.0f;
+    glm::uvec3 _cells = glm::uvec3(0);
+    unsigned int _words = 0;
+    std::vector<unsigned int> _bits;
+    IdTable<unsigned int> _mesh_bits;
+};
+
+// Turns the bits of the traced instances each of num_cells cells of a bake hit into bits of meshes. A hit on traced
+// instance i sets the mesh bits in traced_bits[i], those of its mesh and of the members of its prefab.
+inline std::vector<unsigned int> pvs_mesh_bits(const unsigned int *hits, unsigned int num_cells,
+                                               unsigned int traced_words,
+                                               const std::vector<std::vector<unsigned int>> &traced_bits,
+                                               unsigned int mesh_words)
+{
+    std::vector<unsigned int> bits(size_t(num_cells) * mesh_words, 0);
+    for (unsigned int cell = 0; cell < num_cells; cell++)
+    {
+        unsigned int *words = &bits[size_t(cell) * mesh_words];
+        for (unsigned int w = 0; w < traced_words; w++)
+        {
+            for (unsigned int word = hits[size_t(cell) * traced_words + w]; word != 0; word &= word - 1)
+            {
+                const unsigned int traced = w * 32 + static_cast<unsigned int>(__builtin_ctz(word));
+                if (traced >= traced_bits.size())
+                    continue;
+                for (const unsigned int bit : traced_bits[traced])
+                    words[bit / 32] |= 1u << (bit % 32);
+            }
+        }
+    }
+    return bits;
+}
+
+#endif // METALCPP_SRC_PVS_HPP
@@ -0,0 +1,129 @@
+#ifndef METALCPP_SRC_QUALITY_GOVERNOR_HPP
+#define METALCPP_SRC_QUALITY_GOVERNOR_HPP
+
+#import <Foundation/Foundation.h>
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+
+// Steps down a ladder of quality levels while the system is thermally constrained or in low power mode, so frames
+// stay predictable instead of running at full quality until the GPU throttles. Levels rise one step at a time as soon
+// as the pressure does and only fall again once it stayed lower for a while.
+class QualityGovernor
+{
+  public:
+    static constexpr unsigned int LEVELS = 4;
+
+    // What a level renders with, relative to the settings of the renderer.
+    struct Level
+    {
+        float render_scale;
+        // Cascade shadow maps are SHADOW_CASCADE_SIZE >> shadow_shift wide.
+        unsigned int shadow_shift;
+        bool ssao;
+        // Divides the projected size level of detail selection uses, larger biases switch to coarser meshes earlier.
+        float lod_bias;
+        // Shortest time between presents in seconds, 0 leaves the present mode alone.
+        float min_frame_duration;
+    };
+
+    void set_enabled(bool enabled)
+    {
+        _enabled = enabled;
+        if (!enabled)
+            _level = 0;
+        _last_poll = {};
+    }
+
+    bool enabled() const
+    {
+        return _enabled;
+    }
+
+    // Polls the thermal state at most every POLL_INTERVAL, returns whether the level changed.
+    bool update()
+    {
+        if (!_enabled)
+            return false;
+
+        const auto now = std::chrono::steady_clock::now();
+        if (_last_poll != std::chrono::steady_clock::time_point{} && now - _last_poll < POLL_INTERVAL)
+            return false;
+        _last_poll = now;
+
+        const unsigned int pressure = current_pressure();
+        if (pressure > _level)
+        {
+            _level++;
+            _lower_since = now;
+            return true;
+        }
+        if (pressure == _level)
+        {
+            _lower_since = now;
+            return false;
+        }
+        if (now - _lower_since < RECOVERY)
+            return false;
+        _level--;
+        _lower_since = now;
+        return true;
+    }
+
+    unsigned int level() const
+    {
+        return _level;
+    }
+
+    const Level &settings() const
+    {
+        return LADDER[_level];
+    }
+
+  private:
+    static constexpr std::chrono::milliseconds POLL_INTERVAL{1000};
+    // Time the pressure has to stay below the current level before quality comes back one step.
+    static constexpr std::chrono::seconds RECOVERY{15};
+
+    static constexpr std::array<Level, LEVELS> LADDER = {{
+        {1.0f, 0, true, 1.0f, 0.0f},
+        {0.85f, 0, true, 1.5f, 0.0f},
+        {0.7f, 1, false, 2.0f, 0.0f},
+        {0.5f, 1, false, 3.0f, 1.0f / 30.0f},
+    }};
+
+    // Level the thermal state and the power mode ask for.
+    static unsigned int current_pressure()
+    {
+        NSProcessInfo *info = [NSProcessInfo processInfo];
+        unsigned int pressure = 0;
+        switch (info.thermalState)
+        {
+        case NSProcessInfoThermalStateNominal:
+            break;
+        case NSProcessInfoThermalStateFair:
+            pressure = 1;
+            break;
+        case NSProcessInfoThermalStateSerious:
+            pressure = 2;
+            break;
+        case NSProcessInfoThermalStateCritical:
+            pressure = 3;
+            break;
+        }
+        if (@available(macOS 12.0, *))
+        {
+            if (info.lowPowerModeEnabled)
+                pressure = std::max(pressure, 1u);
+        }
+        return std::min(pressure, LEVELS - 1);
+    }
+
+    bool _enabled = false;
+    unsigned int _level = 0;
+    std::chrono::steady_clock::time_point _last_poll = {};
+    std::chrono::steady_clock::time_point _lower_since = {};
+};
+
+#endif // METALCPP_SRC_QUALITY_GOVERNOR_HPP
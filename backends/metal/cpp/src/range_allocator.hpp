@@ -0,0 +1,160 @@
+#ifndef METALCPP_SRC_RANGE_ALLOCATOR_HPP
+#define METALCPP_SRC_RANGE_ALLOCATOR_HPP
+
+#include <cstddef>
+#include <map>
+#include <set>
+#include <utility>
+
+// Best-fit free-list allocator over a linear range of elements. Freed blocks are merged with their neighbours, so
+// holes left by removed ranges are reused and existing ranges never move unless explicitly relocated.
+class RangeAllocator
+{
+  public:
+    static constexpr unsigned int INVALID = ~0u;
+
+    explicit RangeAllocator(unsigned int capacity = 0) : _capacity(0), _used(0)
+    {
+        grow(capacity);
+    }
+
+    // Returns the offset of a block of at least count elements, or INVALID when no free block is large enough.
+    unsigned int allocate(unsigned int count)
+    {
+        return allocate_below(count, _capacity);
+    }
+
+    // Like allocate, but the resulting block must end at or before limit.
+    unsigned int allocate_below(unsigned int count, unsigned int limit)
+    {
+        if (count == 0)
+            return INVALID;
+
+        for (auto it = _free_by_size.lower_bound({count, 0}); it != _free_by_size.end(); ++it)
+        {
+            const auto [size, offset] = *it;
+            if (offset + count > limit)
+                continue;
+
+            remove_free_block(offset, size);
+            if (size > count)
+                insert_free_block(offset + count, size - count);
+
+            _allocated.insert({offset, count});
+            _used += count;
+            return offset;
+        }
+
+        return INVALID;
+    }
+
+    void free(unsigned int offset)
+    {
+        auto it = _allocated.find(offset);
+        if (it == _allocated.end())
+            return;
+
+        unsigned int size = it->second;
+        _used -= size;
+        _allocated.erase(it);
+
+        // Merge with the free block right after this one.
+        auto next = _free_by_offset.find(offset + size);
+        if (next != _free_by_offset.end())
+        {
+            const unsigned int next_size = next->second;
+            remove_free_block(next->first, next_size);
+            size += next_size;
+        }
+
+        // Merge with the free block right before this one.
+        auto prev = _free_by_offset.lower_bound(offset);
+        if (prev != _free_by_offset.begin())
+        {
+            --prev;
+            if (prev->first + prev->second == offset)
+            {
+                const unsigned int prev_offset = prev->first;
+                const unsigned int prev_size = prev->second;
+                remove_free_block(prev_offset, prev_size);
+                offset = prev_offset;
+                size += prev_size;
+            }
+        }
+
+        insert_free_block(offset, size);
+    }
+
+    // Extends the managed range, the new elements become one free block.
+    void grow(unsigned int capacity)
+    {
+        if (capacity <= _capacity)
+            return;
+
+        const unsigned int old_capacity = _capacity;
+        _capacity = capacity;
+
+        // The new block is allocated first so free() can merge it with a free block at the old end.
+        _allocated.insert({old_capacity, capacity - old_capacity});
+        _used += capacity - old_capacity;
+        free(old_capacity);
+    }
+
+    unsigned int size_of(unsigned int offset) const
+    {
+        auto it = _allocated.find(offset);
+        return it == _allocated.end() ? 0 : it->second;
+    }
+
+    unsigned int capacity() const
+    {
+        return _capacity;
+    }
+
+    unsigned int used() const
+    {
+        return _used;
+    }
+
+    // One past the last allocated element.
+    unsigned int end() const
+    {
+        if (_allocated.empty())
+            return 0;
+        const auto &last = *_allocated.rbegin();
+        return last.first + last.second;
+    }
+
+    unsigned int largest_free_block() const
+    {
+        if (_free_by_size.empty())
+            return 0;
+        return _free_by_size.rbegin()->first;
+    }
+
+    size_t free_block_count() const
+    {
+        return _free_by_offset.size();
+    }
+
+  private:
+    void insert_free_block(unsigned int offset, unsigned int size)
+    {
+        _free_by_offset.insert({offset, size});
+        _free_by_size.insert({size, offset});
+    }
+
+    void remove_free_block(unsigned int offset, unsigned int size)
+    {
+        _free_by_offset.erase(offset);
+        _free_by_size.erase({size, offset});
+    }
+
+    unsigned int _capacity;
+    unsigned int _used;
+    std::map<unsigned int, unsigned int> _free_by_offset;
+    std::set<std::pair<unsigned int, unsigned int>> _free_by_size;
+    std::map<unsigned int, unsigned int> _allocated;
+};
+
+#endif // METALCPP_SRC_RANGE_ALLOCATOR_HPP
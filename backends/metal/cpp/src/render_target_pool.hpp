@@ -0,0 +1,74 @@
+#ifndef METALCPP_SRC_RENDER_TARGET_POOL_HPP
+#define METALCPP_SRC_RENDER_TARGET_POOL_HPP
+
+#import <Metal/Metal.h>
+
+#include <algorithm>
+#include <cstddef>
+
+// Heap the size dependent render targets are placed in. It is allocated in size buckets and kept while the targets
+// of a new size still fit and use at least half of it, so resizing a window only allocates memory again once the
+// targets outgrow their bucket. Targets that don't fit, such as the first ones or those of features enabled later, get
+// their own allocation.
+class RenderTargetPool
+{
+  public:
+    // Prepares the heap for the targets of pixels render pixels, estimated from the bytes per pixel of the previous
+    // ones. The previous targets must be released and no longer be used by the GPU, so the heap is free. A heap that
+    // fits targets of capacity pixels is kept for smaller ones, so targets that change size within it never allocate.
+    void reserve(id<MTLDevice> device, size_t pixels, size_t capacity = 0)
+    {
+        const size_t reserved = std::max(pixels, capacity);
+        const size_t estimate =
+            _pixels > 0 ? static_cast<size_t>(static_cast<double>(_required) * reserved / _pixels) : 0;
+        _required = 0;
+        _pixels = pixels;
+        if (estimate == 0 || (estimate <= size() && estimate * 2 >= size()))
+            return;
+
+        _heap = nil;
+        MTLHeapDescriptor *desc = [MTLHeapDescriptor new];
+        desc.storageMode = MTLStorageModePrivate;
+        desc.hazardTrackingMode = MTLHazardTrackingModeTracked;
+        desc.size = bucket(estimate);
+        _heap = [device newHeapWithDescriptor:desc];
+        _heap.label = @"RenderTargets";
+    }
+
+    // Memoryless and shared targets are never placed in the heap.
+    id<MTLTexture> create(id<MTLDevice> device, MTLTextureDescriptor *desc)
+    {
+        if (desc.storageMode != MTLStorageModePrivate)
+            return [device newTextureWithDescriptor:desc];
+
+        const MTLSizeAndAlign size_align = [device heapTextureSizeAndAlignWithDescriptor:desc];
+        _required = (_required + size_align.align - 1) / size_align.align * size_align.align + size_align.size;
+        id<MTLTexture> texture = nil;
+        if (_heap != nil && [_heap maxAvailableSizeWithAlignment:size_align.align] >= size_align.size)
+            texture = [_heap newTextureWithDescriptor:desc];
+        return texture != nil ? texture : [device newTextureWithDescriptor:desc];
+    }
+
+    size_t size() const
+    {
+        return _heap != nil ? static_cast<size_t>(_heap.size) : 0;
+    }
+
+  private:
+    // Buckets are multiples of a power of two step between an eighth and a quarter of the size, so they are at most a
+    // quarter larger than it.
+    static size_t bucket(size_t bytes)
+    {
+        size_t step = 1;
+        while (step * 8 < bytes)
+            step *= 2;
+        return (bytes + step - 1) / step * step;
+    }
+
+    id<MTLHeap> _heap = nil;
+    // Bytes of the targets created since the last reserve, for pixels render pixels.
+    size_t _required = 0;
+    size_t _pixels = 0;
+};
+
+#endif // METALCPP_SRC_RENDER_TARGET_POOL_HPP
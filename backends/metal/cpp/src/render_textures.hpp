@@ -0,0 +1,146 @@
+#ifndef METALCPP_SRC_RENDER_TEXTURES_HPP
+#define METALCPP_SRC_RENDER_TEXTURES_HPP
+
+#import <Metal/Metal.h>
+
+#include <algorithm>
+#include <vector>
+
+#include "id_table.hpp"
+#include "library.h"
+#include "retired_resources.hpp"
+
+// Texture slot showing a camera view of the scene, see set_render_texture.
+struct RenderTextureSlot
+{
+    RenderTexture settings = {};
+    // Mipmapped texture the slot binds, views are drawn into the canvas and copied into it so a view may show its own
+    // texture as it was the frame before.
+    id<MTLTexture> texture = nil;
+    id<MTLTexture> canvas = nil;
+    id<MTLTexture> depth = nil;
+    // Frames since the view was last drawn, and whether it was drawn at all.
+    unsigned int age = 0;
+    bool drawn = false;
+    bool requested = false;
+};
+
+// Views of the render texture slots, drawn when their update mode says so. Views that are due wait in the order they
+// fell due and every frame draws the longest waiting ones until their pixels would exceed the budget, so the cost of a
+// frame stays bounded and views over budget are drawn by the next frames instead.
+class RenderTextures
+{
+  public:
+    RenderTextureSlot *find(unsigned int index)
+    {
+        return _slots.find(index);
+    }
+
+    RenderTextureSlot &set(unsigned int index, const RenderTexture &settings)
+    {
+        RenderTextureSlot &slot = _slots[index];
+        // A view that changed how it updates is drawn with its next chance.
+        if (slot.settings.update != settings.update || slot.settings.interval != settings.interval)
+            slot.requested = true;
+        slot.settings = settings;
+        return slot;
+    }
+
+    void request(unsigned int index)
+    {
+        if (RenderTextureSlot *slot = _slots.find(index))
+            slot->requested = true;
+    }
+
+    void remove(unsigned int index, RetiredResources &retired)
+    {
+        if (RenderTextureSlot *slot = _slots.find(index))
+        {
+            retired.retire(slot->texture, slot->canvas, slot->depth);
+            _slots.erase(index);
+        }
+    }
+
+    bool empty() const
+    {
+        return _slots.empty();
+    }
+
+    // Whether a view waits to be drawn for the first time or on request.
+    bool pending() const
+    {
+        for (const auto &[index, slot] : _slots)
+        {
+            if (slot.texture != nil && (!slot.drawn || slot.requested))
+                return true;
+        }
+        return false;
+    }
+
+    template <typename Visit> void for_each(Visit &&visit) const
+    {
+        for (const auto &[index, slot] : _slots)
+            visit(slot);
+    }
+
+    // Calls draw with the index and slot of every view drawn this frame, at most budget pixels of them unless a single
+    // view exceeds it on its own. A budget of 0 pauses the views, draw returning false leaves the rest for later.
+    template <typename Draw> void schedule(size_t budget, Draw &&draw)
+    {
+        std::vector<std::pair<unsigned int, RenderTextureSlot *>> due;
+        for (auto &[index, slot] : _slots)
+        {
+            slot.age++;
+            if (slot.texture != nil && is_due(slot))
+                due.emplace_back(index, &slot);
+        }
+        if (budget == 0)
+            return;
+
+        std::stable_sort(due.begin(), due.end(),
+                         [](const auto &a, const auto &b) { return waiting(*a.second) > waiting(*b.second); });
+        size_t spent = 0;
+        for (auto &[index, slot] : due)
+        {
+            const size_t pixels = size_t(slot->settings.width) * slot->settings.height;
+            if (spent > 0 && spent + pixels > budget)
+                continue;
+            if (!draw(index, *slot))
+                break;
+            spent += pixels;
+            slot->age = 0;
+            slot->drawn = true;
+            slot->requested = false;
+        }
+    }
+
+  private:
+    static bool is_due(const RenderTextureSlot &slot)
+    {
+        if (!slot.drawn || slot.requested)
+            return true;
+        switch (slot.settings.update)
+        {
+        case RENDER_TEXTURE_EVERY_FRAME:
+            return true;
+        case RENDER_TEXTURE_INTERVAL:
+            return slot.age >= std::max(slot.settings.interval, 1u);
+        default:
+            return false;
+        }
+    }
+
+    // Frames a due view has waited past its due frame, views never drawn come first.
+    static unsigned int waiting(const RenderTextureSlot &slot)
+    {
+        if (!slot.drawn)
+            return ~0u;
+        if (slot.settings.update == RENDER_TEXTURE_INTERVAL)
+            return slot.age - std::min(slot.age, std::max(slot.settings.interval, 1u));
+        return slot.age;
+    }
+
+    IdTable<RenderTextureSlot> _slots;
+};
+
+#endif // METALCPP_SRC_RENDER_TEXTURES_HPP
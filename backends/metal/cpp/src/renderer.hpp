@@ -9,30 +9,668 @@
 #import <QuartzCore/QuartzCore.h>
 #import <simd/simd.h>
 
+// iOS and iPadOS draw into a layer added to a UIView, macOS replaces the layer of the content view of an NSWindow.
+#if TARGET_OS_IPHONE
+#import <UIKit/UIKit.h>
+using PlatformWindow = UIView;
+#else
+#import <AppKit/AppKit.h>
+using PlatformWindow = NSWindow;
+#endif
+
+#include "acceleration_structures.hpp"
+#include "bvh_scene.hpp"
+#include "cell_streaming.hpp"
+#include "command_capture.hpp"
 #import "buffer.hpp"
+#include "command_recorder.hpp"
+#include "debug_draw.hpp"
+#include "frame_graph.hpp"
+#include "frame_pacing.hpp"
+#include "frame_timer.hpp"
+#include "geometry_codec.hpp"
+#include "gpu_capture.hpp"
+#include "gpu_primitives.hpp"
+#include "id_table.hpp"
+#include "instance_bvh.hpp"
 #include "instance_list.h"
+#include "instance_overrides.hpp"
+#include "ktx2.hpp"
 #include "library.h"
+#include "mesh_order.hpp"
+#include "mesh_profiler.hpp"
+#include "mesh_utils.hpp"
+#include "performance_hud.hpp"
+#include "pipeline_cache.hpp"
+#include "point_clouds.hpp"
+#include "quality_governor.hpp"
+#include "purgeable_cache.hpp"
+#include "pvs.hpp"
+#include "render_target_pool.hpp"
+#include "render_textures.hpp"
+#include "resolution_controller.hpp"
+#include "retired_resources.hpp"
+#include "scene_cache.hpp"
+#include "sdf_scene.hpp"
+#include "signposts.hpp"
+#include "staging_buffer.hpp"
+#include "static_batches.hpp"
+#include "texture_arrays.hpp"
+#include "texture_format.hpp"
+#include "trace_recorder.hpp"
+#include "upload_ring.hpp"
+#include "upload_scheduler.hpp"
+#include "vector_paths.hpp"
 #include "vertex_list.h"
+#include "video_stream.hpp"
+#include "video_textures.hpp"
+#include "virtual_textures.hpp"
+#include "visibility_queries.hpp"
 
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <map>
 #include <memory>
+#include <string>
+#include <unordered_map>
 #include <vector>
 
 #include <glm/ext.hpp>
 #include <glm/glm.hpp>
 
+// Residency sets need the macOS 15 SDK, older SDKs keep declaring texture residency per render pass.
+#if defined(MAC_OS_VERSION_15_0)
+#define RFW_METAL_RESIDENCY_SETS 1
+#endif
+
+// Temporal upscaling needs MetalFX from the macOS 13 SDK, without it scaled frames are upscaled bilinearly.
+#if defined(MAC_OS_VERSION_13_0)
+#define RFW_METAL_FX 1
+#import <MetalFX/MetalFX.h>
+#endif
+
+// Asset files are read by Metal fast resource loading from the macOS 13 SDK, without it they can't be loaded.
+#if defined(MAC_OS_VERSION_13_0)
+#define RFW_METAL_IO 1
+#endif
+
+@class RfwDrawableQueue;
+
+// CAMetalDisplayLink needs the macOS 14 SDK, without it display link presentation falls back to paced presents.
+#if defined(MAC_OS_VERSION_14_0)
+#define RFW_DISPLAY_LINK 1
+@class RfwDisplayLink;
+#endif
+
 struct Uniforms
 {
     matrix_float4x4 projection;
     matrix_float4x4 view_matrix;
     matrix_float4x4 combined;
     matrix_float4x4 matrix_2d;
+    simd_float4 origin;
     CameraView3D view;
+    matrix_float4x4 previous_combined;
+    simd_float4 jitter;
+};
+
+// Indexed copy of a mesh that was set as a triangle soup, or the decoded copy of an encoded mesh.
+struct WeldedMesh
+{
+    std::vector<Vertex3D> vertices;
+    std::vector<JointData> joints_weights;
+    std::vector<unsigned int> indices;
+};
+
+// Quantized copy of a mesh, the bounds are bound per draw to restore its positions.
+struct PackedMesh
+{
+    std::vector<PackedVertex3D> vertices;
+    PackedVertexBounds bounds;
+};
+
+// Render pipeline variants the 3D draws pick from.
+struct Pipelines3D
+{
+    id<MTLRenderPipelineState> full = nil;
+    id<MTLRenderPipelineState> packed = nil;
+    id<MTLRenderPipelineState> culled = nil;
+    id<MTLRenderPipelineState> packed_culled = nil;
+    id<MTLRenderPipelineState> skinned = nil;
+};
+
+// Descriptor of a render pipeline and the state it is compiled into again when the attachments of its pass change.
+struct PipelineVariant
+{
+    MTLRenderPipelineDescriptor *desc;
+    __strong id<MTLRenderPipelineState> *state;
+};
+
+// Resources that are written by the CPU every frame, one copy exists per frame in flight.
+struct FrameResources
+{
+    id<MTLBuffer> args_buffer = nil;
+    // Buffers encoded in args_buffer by argument index, only slots whose buffer changed get re-encoded.
+    std::array<id<MTLBuffer>, SCENE_ARGUMENT_COUNT> encoded_buffers = {};
+    // Offscreen target of headless frames and the shared copy of it that render_to_buffer reads back.
+    id<MTLTexture> target = nil;
+    id<MTLBuffer> readback = nil;
+    // Copy of the batched 2D vertices, replaced when its version falls behind the renderer's batches.
+    std::unique_ptr<Buffer<Vertex2D>> batched_2d;
+    unsigned int batched_2d_version = 0;
+    // Texture LOD feedback of the frame by texture index, only read while the texture generation it was written
+    // against is current.
+    id<MTLBuffer> texture_feedback = nil;
+    unsigned int texture_generation = 0;
+    // Textures the feedback was written for, the words of virtual textures follow theirs.
+    unsigned int feedback_textures = 0;
+    // Pages of the virtual textures this frame samples.
+    id<MTLBuffer> virtual_pages = nil;
+    uint64_t virtual_pages_version = 0;
+    // Instances the CPU culling found visible, in place of the GPU-only list shared by all frames.
+    id<MTLBuffer> visible_instances = nil;
+    // Copy of the packed material table this frame reads, and the entries that changed since it was last brought up
+    // to date. Frames in flight keep reading their own copy while materials change.
+    id<MTLBuffer> materials = nil;
+    std::vector<DirtyRange> material_ranges;
+};
+
+// Consecutive 2D draws in mesh id order, either one mesh drawn instanced or a run of small meshes whose instances were
+// transformed into the batched vertex stream. Runs of batched meshes end where the clip rectangle changes.
+struct Batch2D
+{
+    static constexpr unsigned int BATCHED = ~0u;
+
+    unsigned int mesh;
+    unsigned int vertex_start;
+    unsigned int vertex_count;
+    // Instances of the batch in _items_2d.
+    unsigned int first_item = 0;
+    unsigned int item_count = 0;
+    bool clipped = false;
+    ClipRect2D clip = {};
+};
+
+// Instance of a 2D batch with its bounds after the instance matrix, before the 2D matrix. start and count are the
+// instance of an instanced mesh or the vertices of a batched one.
+struct Item2D
+{
+    glm::vec3 bmin;
+    glm::vec3 bmax;
+    unsigned int start;
+    unsigned int count;
+};
+
+// Visible items of a 2D batch in the current frame, consecutive items are merged into one draw.
+struct Culled2D
+{
+    MTLScissorRect scissor;
+    unsigned int first_run;
+    unsigned int run_count;
+};
+
+// Culled draws of the current frame, every view culled this frame starts from the same indirect arguments. The late
+// occlusion culling phase is prepared together with the early phase.
+struct CulledDraws
+{
+    UploadAllocation draws;
+    // Draws by slot before they are uploaded and the mesh each of them draws, which the CPU culling reads instead.
+    std::vector<CullDraw> cull_draws;
+    std::vector<unsigned int> draw_meshes;
+    // Visible instances of every batch the CPU culling tested, at the offsets of the batch in the visible list.
+    std::vector<unsigned int> batch_instances;
+    CullUniforms uniforms;
+    // Indirect arguments by draw slot and the word of each slot that holds its base instance.
+    std::vector<unsigned int> args;
+    std::vector<unsigned int> base_instance_words;
+    UploadAllocation late_args;
+    CullUniforms late_uniforms;
+    // Instances of every culled view, those of the coarser levels of detail are laid out after those of all meshes.
+    unsigned int visible_count = 0;
+    // Indirect arguments of the early phase, and of the clustered draws the early phase draws instead.
+    UploadAllocation early_args;
+    UploadAllocation cluster_args;
+    // Indirect arguments of the runs of skinned instances the early phase draws, and the first run of every mesh.
+    UploadAllocation skinned_args;
+    IdTable<unsigned int> skinned_runs;
+    // Whether the views of this frame walk the instance tree instead of testing every slot.
+    bool bvh = false;
+    // Nearest depth of the visible instances of every draw slot in the main view, as the bits of the float, which
+    // orders its draw commands front to back. Invalid when culling runs on the CPU.
+    UploadAllocation draw_depths;
+};
+
+// Clusters of a mesh in the cluster buffer.
+struct ClusterRange
+{
+    unsigned int start;
+    unsigned int count;
+    unsigned int index_count;
+};
+
+// Consecutive submeshes of a mesh drawn together, in the units of Submesh.
+struct SubmeshDraw
+{
+    unsigned int first;
+    unsigned int count;
+};
+
+// Parameters of the animated instances of a mesh, shared by all frames.
+struct InstanceAnimator
+{
+    InstanceAnimationUniforms uniforms;
+    id<MTLBuffer> instances;
+};
+
+// Heightmap of a terrain mesh, only read by the GPU. Vertices are generated into the range of the mesh once the levels
+// of uniforms moved, or when vertices and start no longer are where they were generated.
+struct Terrain3D
+{
+    TerrainUniforms uniforms = {};
+    id<MTLBuffer> heights = nil;
+    id<MTLBuffer> materials = nil;
+    id<MTLBuffer> vertices = nil;
+    unsigned int start = 0;
+};
+
+// Instances of a mesh scattered across terrain `terrain`, its CPU instances are all hidden.
+struct InstanceScatter
+{
+    ScatterUniforms uniforms = {};
+    unsigned int terrain = 0;
+    id<MTLBuffer> density = nil;
+};
+
+// Impostor atlases queued for mesh. Baked atlases wait in albedo and normal until their slots bound them.
+struct ImpostorBake
+{
+    unsigned int mesh = 0;
+    ImpostorSettings settings = {};
+    ImpostorBakeUniforms uniforms = {};
+    id<MTLTexture> albedo = nil;
+    id<MTLTexture> normal = nil;
+};
+
+// Particles of an emitter and the lists of their indices, only written by the GPU once created. list is the alive list
+// the next frame emits into and simulates.
+struct ParticleSystem
+{
+    ParticleEmitter emitter;
+    unsigned int capacity = 0;
+    id<MTLBuffer> particles = nil;
+    // Two alive lists of capacity indices each.
+    id<MTLBuffer> alive = nil;
+    id<MTLBuffer> dead = nil;
+    id<MTLBuffer> counters = nil;
+    unsigned int list = 0;
+    // Particles to emit on top of the rate, and the fraction of a particle the rate emitted so far.
+    unsigned int burst = 0;
+    float carry = 0.0f;
+    unsigned int frame = 0;
+};
+
+// Transform hierarchy propagated on the GPU. Nodes are sorted by depth, so every depth is one contiguous range of
+// nodes. Locals and worlds are only written by the GPU once created, changed locals are scattered into them.
+struct TransformHierarchy
+{
+    // Sorted index of every node as it was set.
+    std::vector<unsigned int> order;
+    // Target mesh and instance of every sorted node.
+    std::vector<simd_uint2> targets;
+    std::vector<int> parents;
+    // First sorted node and node count of every depth.
+    std::vector<simd_uint2> levels;
+    // Meshes with targeted instances, sorted.
+    std::vector<unsigned int> meshes;
+    std::vector<HierarchyUpdate> updates;
+    // Index in updates of every sorted node with a pending update, ~0u otherwise.
+    std::vector<unsigned int> update_slots;
+    id<MTLBuffer> links = nil;
+    id<MTLBuffer> locals = nil;
+    id<MTLBuffer> worlds = nil;
+    // Instance layout the links were resolved against.
+    unsigned int layout_version = ~0u;
+};
+
+// Draw slot of a coarser level of detail of mesh.
+struct LodDraw
+{
+    unsigned int slot;
+    unsigned int mesh;
+};
+
+// Light matrix a shadow cascade or spot shadow tile was last drawn with.
+struct ShadowView
+{
+    glm::mat4 matrix = glm::mat4(1.0f);
+    bool valid = false;
+};
+
+// Morph targets of a mesh by vertex, deltas[offsets[v]] to deltas[offsets[v + 1]] move vertex v. buffer_start is the
+// morph_start of its offset table in the uploaded buffers.
+struct MorphTargets3D
+{
+    unsigned int num_targets = 0;
+    std::vector<unsigned int> offsets;
+    std::vector<MorphDelta> deltas;
+    unsigned int buffer_start = NO_MORPH_TARGETS;
+};
+
+// Keyframes of a clip as uploaded, key_start of its channels indexes times and values. channel_start is the first
+// channel of the clip in the uploaded buffers.
+struct AnimationClip3D
+{
+    unsigned int num_joints = 0;
+    float duration = 0.0f;
+    std::vector<AnimationKeys> channels;
+    std::vector<float> times;
+    std::vector<simd_float4> values;
+    unsigned int channel_start = 0;
+};
+
+struct Skeleton3D
+{
+    std::vector<SkeletonJoint> joints;
+    unsigned int num_levels = 0;
+    unsigned int buffer_start = 0;
+};
+
+// Clips a skin is sampled from.
+struct SkinPlayback
+{
+    unsigned int skeleton = 0;
+    std::vector<AnimationLayer> layers;
+};
+
+// Shadow view that gets redrawn this frame, layer is the cascade or the tile of the spot shadow atlas.
+struct ShadowPass
+{
+    glm::mat4 matrix;
+    bool cascade;
+    unsigned int layer;
+};
+
+// Texture that is being uploaded, index is ~0u when a newer upload of the same texture superseded it.
+struct PendingTexture
+{
+    unsigned int index;
+    id<MTLTexture> texture;
+    uint64_t upload;
+    // Finest level of the texture data that texture holds, non-zero for streamed textures.
+    unsigned int first_mip;
+    // Hash of the texture data the resource cache finds texture by once it got replaced, 0 when it is not cached.
+    size_t key;
+    // MTLIOCommandBuffer reading texture from an asset file, nil for uploads through the staging buffer.
+    id io = nil;
+    // Entry of the layer that texture, an array of small textures, holds the data in, NO_TEXTURE_LAYER otherwise.
+    unsigned int layer = NO_TEXTURE_LAYER;
+    // Mapped memory texture is copied out of, kept until the copy completed.
+    id<MTLBuffer> source = nil;
+};
+
+// Texture whose upload the upload budget spreads over several frames, staging continues at row of level mip. It
+// becomes a PendingTexture once its last level is staged.
+struct DeferredTexture
+{
+    unsigned int index;
+    id<MTLTexture> texture;
+    TextureData data;
+    size_t key;
+    // Levels of KTX2 files and data set while copying on submit, data points into them.
+    std::vector<unsigned char> bytes;
+    unsigned int mip = 0;
+    unsigned int row = 0;
+};
+
+// Texture whose levels the caller writes into buffer, data points at its contents, see map_texture.
+struct MappedTexture
+{
+    unsigned int index;
+    TextureData data;
+    id<MTLBuffer> buffer;
+};
+
+// Layout of a mesh in the resource cache, its vertices are followed by its joints and weights and its indices.
+// Data a texture key was made from, the first texture with a key keeps it so textures with a colliding hash are told
+// apart from ones with the same contents.
+struct TextureContents
+{
+    unsigned int width;
+    unsigned int height;
+    unsigned int mip_levels;
+    MTLPixelFormat format;
+    std::vector<unsigned char> bytes;
+};
+
+struct CachedMesh
+{
+    unsigned int num_vertices;
+    unsigned int num_indices;
+    size_t joints_offset;
+    size_t indices_offset;
+    bool has_joints;
+    unsigned int flags;
+};
+
+// CPU copy of a texture whose finest mip levels are only uploaded once texture LOD feedback asks for them. Levels
+// resident_mip and on are in the texture table, levels tail_mip and on are always resident.
+struct StreamedTexture
+{
+    std::vector<unsigned char> bytes;
+    TextureData data = {};
+    unsigned int resident_mip = 0;
+    unsigned int tail_mip = 0;
+    // Finest level asked for since the current feedback period began, and during the last one or since.
+    unsigned int requested_mip = 0;
+    unsigned int wanted_mip = 0;
+};
+
+// Wavefront path tracer of RENDER_PATH_TRACED. The path and shadow ray queues are GPU-only and shared by all frames,
+// samples accumulate per pixel until the view or the scene changes.
+struct PathTracer
+{
+    id<MTLComputePipelineState> begin = nil;
+    id<MTLComputePipelineState> generate = nil;
+    id<MTLComputePipelineState> extend = nil;
+    id<MTLComputePipelineState> shade = nil;
+    id<MTLComputePipelineState> advance = nil;
+    id<MTLComputePipelineState> shadow = nil;
+    // Shows the mean of the accumulated samples.
+    id<MTLRenderPipelineState> resolve = nil;
+
+    id<MTLBuffer> paths = nil;
+    id<MTLBuffer> hits = nil;
+    id<MTLBuffer> shadow_rays = nil;
+    id<MTLBuffer> counters = nil;
+    id<MTLBuffer> accumulator = nil;
+
+    unsigned int samples = 0;
+    // View the accumulated samples were traced from.
+    CameraView3D view = {};
+    // Samples traced into these buffers, which seed the random numbers of the next one.
+    unsigned int traced = 0;
+
+    // The denoiser filters every sample on its own instead of accumulating them, guided by the first hits of their
+    // paths. First hits and the temporal history of a frame alternate with those of the previous one, the passes of
+    // the wavelet filter between the two filtered buffers.
+    bool denoise = false;
+    id<MTLComputePipelineState> reproject = nil;
+    id<MTLComputePipelineState> filter = nil;
+    std::array<id<MTLBuffer>, 2> surfaces = {};
+    std::array<id<MTLBuffer>, 2> history = {};
+    std::array<id<MTLBuffer>, 2> filtered = {};
+    // Whether the history of the previous frame was denoised from these buffers, and with which camera.
+    bool history_valid = false;
+    glm::mat4 previous_combined = glm::mat4(1.0f);
+
+    // Adaptive samples trace the tiles that did not converge into the radiance buffer, which accumulate adds to the
+    // accumulator. Settings of set_path_tracer_convergence, a threshold of 0 traces every pixel.
+    id<MTLComputePipelineState> queue = nil;
+    id<MTLComputePipelineState> accumulate = nil;
+    id<MTLComputePipelineState> finish = nil;
+    float threshold = 0.0f;
+    unsigned int min_samples = 0;
+    unsigned int max_samples = 0;
+    float time_budget = 0.0f;
+    id<MTLBuffer> radiance = nil;
+    id<MTLBuffer> moments = nil;
+    id<MTLBuffer> tiles = nil;
+    // Shared with the CPU, holds the PathProgress of the last adaptive sample the GPU completed.
+    id<MTLBuffer> progress = nil;
+
+    // Render of the accumulated samples, when it started and whether it stopped tracing after the seconds it took.
+    unsigned int render = 0;
+    std::chrono::steady_clock::time_point started = {};
+    bool finished = false;
+    float seconds = 0.0f;
+};
+
+// Traced instances and lights the path tracing kernels read, uploaded for one frame.
+struct PathScene
+{
+    UploadAllocation instances;
+    UploadAllocation point_lights;
+    UploadAllocation spot_lights;
+    UploadAllocation directional_lights;
+};
+
+// Lightmap queued by bake_lightmap. The texel pass rasterizes positions and normals once, the samples of the texels
+// accumulate in queues and an accumulator of their own, then the filter passes alternate between the filtered buffers
+// and pack the last one into packed.
+struct LightmapBake
+{
+    LightmapSettings settings = {};
+    std::vector<unsigned int> meshes;
+    unsigned int samples = 0;
+    id<MTLTexture> positions = nil;
+    id<MTLTexture> normals = nil;
+    id<MTLBuffer> paths = nil;
+    id<MTLBuffer> hits = nil;
+    id<MTLBuffer> shadow_rays = nil;
+    id<MTLBuffer> counters = nil;
+    id<MTLBuffer> accumulator = nil;
+    std::array<id<MTLBuffer>, 2> filtered = {};
+    id<MTLBuffer> packed = nil;
+};
+
+// Probes of the irradiance volume, traced a ray budget at a time in the order of their index. The textures are shared
+// by all frames and filter the updates of every probe over time by the hysteresis.
+struct IrradianceVolume
+{
+    id<MTLComputePipelineState> trace = nil;
+    id<MTLComputePipelineState> blend_irradiance = nil;
+    id<MTLComputePipelineState> blend_distances = nil;
+
+    id<MTLTexture> irradiance = nil;
+    id<MTLTexture> distances = nil;
+    // Rays of the probes of one update.
+    id<MTLBuffer> radiance = nil;
+
+    GiVolume volume = {};
+    unsigned int ray_budget = 16384;
+    unsigned int next_probe = 0;
+    // Probes updated since the volume was created, it lights the scene once all of them were.
+    unsigned int updated = 0;
+    unsigned int seed = 0;
+    float hysteresis = 0.97f;
+};
+
+// Half resolution reflections of the pre-pass depth, see set_reflections. Rays that miss in the closest depth pyramid
+// queue their pixel in rays, the traced reflections accumulate in the history textures, which alternate between
+// frames, and source keeps the main pass of the previous frame at half resolution for the hits in screen space.
+struct Reflections
+{
+    id<MTLComputePipelineState> begin = nil;
+    id<MTLComputePipelineState> hzb_init = nil;
+    id<MTLComputePipelineState> hzb_downsample = nil;
+    id<MTLComputePipelineState> trace_screen = nil;
+    id<MTLComputePipelineState> queue = nil;
+    id<MTLComputePipelineState> trace = nil;
+    id<MTLComputePipelineState> resolve = nil;
+    id<MTLComputePipelineState> downsample = nil;
+
+    id<MTLTexture> hzb = nil;
+    std::vector<id<MTLTexture>> hzb_levels;
+    id<MTLTexture> traced = nil;
+    id<MTLTexture> source = nil;
+    std::array<id<MTLTexture>, 2> history = {};
+    id<MTLBuffer> rays = nil;
+    id<MTLBuffer> counters = nil;
+    unsigned int history_index = 0;
+    // Whether the history and the source were written by the previous frame.
+    bool history_valid = false;
+    bool source_valid = false;
+
+    ReflectionSettings settings = {0, 0.5f, 50.0f};
+};
+
+// Window of a renderer with its layer and the render targets, temporal history and caches that depend on its size or
+// view. The members of the selected surface are those of the renderer, the surfaces that are not selected keep theirs
+// here until they are selected again.
+// Frames drawn after a change in on-demand mode, so temporal history converges before the renderer idles.
+constexpr unsigned int ON_DEMAND_SETTLE_FRAMES = 16;
+
+// Last frame an on-demand renderer presented to a surface, see set_on_demand_rendering.
+struct OnDemandFrame
+{
+    bool valid = false;
+    glm::mat4 matrix_2d = glm::mat4(1.0f);
+    CameraView3D view_3d = {};
+    RenderMode3D mode = RENDER_DEFAULT;
+    // Changes of the renderer the frame showed, and frames still drawn after the last change.
+    uint64_t changes = 0;
+    unsigned int settle = 0;
+    std::chrono::steady_clock::time_point presented = {};
 };
 
-struct Matrices
+struct Surface
 {
-    glm::mat4 transform;
-    glm::mat4 normal_transform;
+    CAMetalLayer *layer = nil;
+    __weak PlatformWindow *window = nil;
+    RfwDrawableQueue *drawable_queue = nil;
+
+    RenderTargetPool target_pool;
+    bool targets_dirty = true;
+    FrameGraph frame_graph;
+    id<MTLTexture> depth_texture = nil;
+    std::array<id<MTLTexture>, 3> gbuffer = {};
+    id<MTLTexture> msaa_color = nil;
+    id<MTLTexture> msaa_depth = nil;
+    id<MTLTexture> ray_traced = nil;
+    id<MTLTexture> scaled_color = nil;
+    id<MTLRasterizationRateMap> rate_map = nil;
+    id<MTLBuffer> rate_map_data = nil;
+    id<MTLTexture> inset_depth = nil;
+
+    id<MTLTexture> depth_pyramid = nil;
+    std::vector<id<MTLTexture>> depth_pyramid_levels;
+    glm::mat4 depth_pyramid_combined = glm::mat4(1.0f);
+    bool depth_pyramid_valid = false;
+
+    glm::mat4 previous_combined = glm::mat4(1.0f);
+    glm::mat4 previous_relative_combined = glm::mat4(1.0f);
+    glm::vec3 previous_origin = glm::vec3(0.0f);
+    unsigned int jitter_index = 0;
+    id<MTLTexture> motion_vectors = nil;
+    id<MTLBuffer> previous_instances = nil;
+    unsigned int previous_instances_layout = ~0u;
+    std::array<id<MTLTexture>, 2> taa_history = {};
+    unsigned int taa_index = 0;
+    bool taa_reset = true;
+    std::vector<id<MTLTexture>> bloom_down;
+    std::vector<id<MTLTexture>> bloom_up;
+#ifdef RFW_METAL_FX
+    id<MTLFXTemporalScaler> temporal_scaler API_AVAILABLE(macos(13.0)) = nil;
+    id<MTLTexture> upscaled = nil;
+    bool upscale_reset = true;
+#endif
+
+    // Path tracer queues and accumulated samples.
+    PathTracer path_tracer;
+    Reflections reflections;
+    OnDemandFrame on_demand;
 };
 
 class MetalRenderer
@@ -46,66 +684,1457 @@ class MetalRenderer
         Update2D = 4,
         UpdateInstances2D = 8,
         UpdateMaterials = 16,
-        UpdateTextures = 32
+        UpdateTextures = 32,
+        // Only matrices of existing 3D instances changed, instance ranges stay the same.
+        UpdateTransforms3D = 64,
+        UpdateGlyphs = 128,
+        UpdateSprites = 256,
+        UpdateClips2D = 512,
+        UpdatePaths2D = 1024
+    };
+
+    // Render passes a frame encodes, each keeps its descriptor across frames.
+    enum PassDescriptor : unsigned int
+    {
+        ShadowPass = 0,
+        PrePass = 1,
+        MainPass = 2,
+        ProbePass = 3,
+        TransparencyPass = 4,
+        CompositePass = 5,
+        OverlayPass = 6,
+        InsetPass = 7,
+        Layer2DPass = 8,
+        PickPass = 9,
+        VisibilityPass = 10,
+        HudPass = 11,
+        VideoFramePass = 12,
+        RenderTexturePass = 13,
+        OverdrawPass = 14,
+        PassDescriptorCount = 15
+    };
+
+    // Meshes drawn by a 3D pass, shadow casters include transparent ones.
+    enum MeshSelection : unsigned int
+    {
+        OpaqueMeshes = 0,
+        ShadowCasters = 1,
+        TransparentMeshes = 2,
+        // Only the opaque skinned meshes, which the visibility buffer leaves to their own draws.
+        SkinnedMeshes = 3
     };
 
+    static constexpr unsigned int MAX_FRAMES_IN_FLIGHT = 3;
+    static constexpr unsigned int DEFAULT_FRAMES_IN_FLIGHT = 2;
+    static constexpr unsigned int SHADOW_CASCADE_SIZE = 2048;
+    static constexpr unsigned int SPOT_SHADOW_ATLAS_SIZE = 4096;
+    // Fewer meshes are not worth handing to another encoding thread.
+    static constexpr unsigned int MIN_MESHES_PER_CHUNK = 256;
+    static constexpr unsigned int MAX_INSET_VIEWS = 8;
+    // Dirty face bits of a reflection probe that is baked again.
+    static constexpr unsigned int ALL_PROBE_FACES = (1u << 6) - 1;
+
     ~MetalRenderer();
 
+    // Pipelines are archived in pipeline_cache when it is a directory, they compile in the background until the first
+    // synchronize() or render(). Without ns_window frames are rendered into an offscreen texture of the scaled size.
+    // On iOS ns_window is the UIView the layer is added to, the preference is ignored.
     static MetalRenderer *create_instance(void *ns_window, void *ns_view, unsigned int width, unsigned int height,
-                                          double scale);
+                                          double scale, const char *pipeline_cache = nullptr,
+                                          DevicePreference preference = DEVICE_DEFAULT);
+    // Instance on the GPU at device_index of the device list, nullptr when there is none.
+    static MetalRenderer *create_instance_on_device(unsigned int device_index, void *ns_window, void *ns_view,
+                                                    unsigned int width, unsigned int height, double scale,
+                                                    const char *pipeline_cache = nullptr);
+    static unsigned int device_count();
+    static bool device_info(unsigned int device_index, DeviceInfo *info);
+    DeviceStatus device_status() const;
 
     void set_2d_mesh(unsigned int id, MeshData2D data);
     void set_2d_instances(unsigned int id, InstancesData2D data);
+    void set_2d_instances_batch(const unsigned int *ids, const InstancesData2D *data, unsigned int count);
+    void set_glyph_atlas(unsigned int width, unsigned int height);
+    void update_glyph_atlas(unsigned int x, unsigned int y, unsigned int width, unsigned int height,
+                            const unsigned char *pixels, unsigned int bytes_per_row);
+    void set_glyphs(unsigned int id, const GlyphInstance *glyphs, unsigned int count);
+    void set_sprites(unsigned int id, const SpriteInstance *sprites, unsigned int count);
+    void set_2d_caching(bool enabled);
+    void set_2d_clip(unsigned int id, ClipRect2D rect);
+    void remove_2d_clip(unsigned int id);
+    void set_2d_path(unsigned int id, const PathData2D &path);
+    void set_2d_path_transform(unsigned int id, const simd_float4x4 &transform);
 
-    void set_3d_mesh(unsigned int id, MeshData3D data);
+    bool set_3d_mesh(unsigned int id, MeshData3D data);
+    bool set_3d_mesh_encoded(unsigned int id, MeshData3D data, const EncodedMesh3D &encoded);
     void set_3d_instances(unsigned int id, InstancesData3D data);
+    void set_3d_meshes_batch(const unsigned int *ids, const MeshData3D *data, unsigned int count);
+    void set_3d_instances_batch(const unsigned int *ids, const InstancesData3D *data, unsigned int count);
     void unload_3d_meshes(const unsigned int *ids, unsigned int num);
+    void unload_3d_meshes(const size_t *ids, unsigned int num);
+    void set_3d_mesh_lods(unsigned int id, const MeshLod *levels, unsigned int num_levels);
+    void set_3d_prefab(const PrefabMesh3D *meshes, unsigned int count);
+    void set_3d_instance_animation(unsigned int id, InstanceAnimation3D animation);
+    void set_3d_hierarchy(const TransformNode *nodes, unsigned int num_nodes);
+    void update_3d_hierarchy(const unsigned int *nodes, const simd_float4x4 *locals, unsigned int count);
+    void set_terrain(unsigned int id, const TerrainData &data);
+    void set_3d_scatter(unsigned int id, const ScatterData &data);
+    void bake_3d_impostor(unsigned int id, const ImpostorSettings &settings);
+    void bake_lightmap(const LightmapSettings &settings);
+    void set_material_lightmap(unsigned int material, unsigned int texture);
+    void set_particle_emitter(unsigned int id, const ParticleEmitter &emitter, unsigned int capacity);
+    void emit_particles(unsigned int id, unsigned int count);
+    bool set_point_cloud(unsigned int id, const PointCloudData &data);
+    void set_point_cloud_transform(unsigned int id, const simd_float4x4 &transform);
+    void set_3d_instance_overrides(unsigned int id, const InstanceOverride *overrides, unsigned int count);
+    void set_animation_time(float seconds);
+    bool restore_3d_mesh(unsigned int id);
+    void set_visibility_group(unsigned int id, const Aabb &bounds);
+    void remove_visibility_group(unsigned int id);
+    uint64_t visibility_samples(unsigned int id) const;
+    void debug_lines(const DebugLine *lines, unsigned int count, bool depth_test)
+    {
+        _debug_draw.add_lines(lines, count, depth_test);
+    }
+    void debug_line(const Vector3 &start, const Vector3 &end, unsigned int color, float width, bool depth_test)
+    {
+        _debug_draw.add_line(start, end, color, width, depth_test);
+    }
+    void debug_aabb(const Aabb &bounds, unsigned int color, float width, bool depth_test)
+    {
+        _debug_draw.add_aabb(bounds, color, width, depth_test);
+    }
+    void debug_sphere(const Vector3 &center, float radius, unsigned int color, float width, bool depth_test)
+    {
+        _debug_draw.add_sphere(center, radius, color, width, depth_test);
+    }
+
+    Vertex3D *map_3d_mesh(unsigned int id, unsigned int num_vertices);
+    void *map_texture(unsigned int index, const TextureData &data);
+    void commit_texture(unsigned int index);
+    simd_float4x4 *map_3d_instances(unsigned int id, unsigned int count);
+    void mark_3d_instances_changed(unsigned int id, unsigned int first, unsigned int last);
+
+    void set_skins(const SkinData *skins, unsigned int num_skins, const size_t *changed, unsigned int num_changed);
+    void set_3d_morph_targets(unsigned int id, const MorphTargetData *targets, unsigned int num_targets);
+    void set_3d_morph_weights(unsigned int id, const float *weights, unsigned int num_instances);
+    void set_animation_clip(unsigned int id, const AnimationChannel *channels, unsigned int num_channels);
+    void set_skeleton(unsigned int id, const SkeletonData &skeleton);
+    void set_skin_animation(unsigned int skin, unsigned int skeleton, const AnimationLayer *layers,
+                            unsigned int num_layers);
+    void set_point_lights(const PointLight *lights, unsigned int num_lights);
+    void set_spot_lights(const SpotLight *lights, unsigned int num_lights);
+    void set_area_lights(const AreaLight *lights, unsigned int num_lights);
+    void set_directional_lights(const DirectionalLight *lights, unsigned int num_lights);
+    void set_materials(const DeviceMaterial *materials, unsigned int num_materials, const size_t *changed,
+                       unsigned int num_changed);
+    void set_textures(const TextureData *data, unsigned int num_textures, const size_t *changed,
+                      unsigned int num_changed);
+    void set_skybox(TextureData data);
+    void set_reflection_probes(const ReflectionProbe *probes, unsigned int count);
+    void set_reflection_probe_budget(unsigned int faces_per_frame);
+    void set_gi_volume(const GiVolume &volume);
+    void set_gi_ray_budget(unsigned int rays_per_frame);
+    bool load_scene_cache(const char *path);
+    bool set_virtual_texture(unsigned int index, const TextureData &d);
+    void set_virtual_texture_budget(size_t cache_bytes, size_t upload_bytes);
+    static bool write_asset_file(const char *path, const void *bytes, size_t size, AssetCompression compression,
+                                 size_t chunk_size);
+    bool load_file_textures(const char *path, AssetCompression compression, const unsigned int *indices,
+                            const FileTexture *textures, unsigned int count);
 
-    void set_materials(const DeviceMaterial *materials, unsigned int num_materials);
-    void set_textures(const TextureData *data, unsigned int num_textures, const unsigned int *changed);
+    // Recorders must be destroyed before the renderer, their commands are applied by synchronize.
+    CommandRecorder *create_command_recorder();
 
     void synchronize();
-    void render(glm::mat4 matrix_2d, CameraView3D view_3d);
+    // Runs synchronize on the synchronize queue and returns, synchronize and render wait for it first.
+    void synchronize_async();
+    void wait_for_synchronize();
+    // Recorder of the 3D meshes, instances and materials set after synchronize_async, which the next synchronize
+    // applies, so they don't touch the lists the synchronize queue may still update. Null when they are set directly.
+    CommandRecorder *deferred_recorder();
+    // Waits for synchronize_async and applies the changes deferred since, before the scene is changed directly.
+    void finish_synchronize();
+    // Calls callback with the pixels of the frame once the GPU finished it, when set.
+    FrameStatus render(glm::mat4 matrix_2d, CameraView3D view_3d, RenderMode3D mode,
+                       ReadbackCallback callback = nullptr, void *user_data = nullptr);
+    void pick(const unsigned int *pixels, unsigned int count, PickCallback callback, void *user_data);
+    // Returns false when the device has no hardware encoder for the codec.
+    bool start_video_stream(const VideoStreamSettings &settings, VideoPacketCallback callback, void *user_data);
+    void stop_video_stream();
+    void request_video_keyframe()
+    {
+        _video_stream.request_keyframe();
+    }
+    // Returns false without calling callback when the device can't trace rays.
+    bool trace_rays(const RayQuery *rays, unsigned int count, bool any_hit, RayQueryCallback callback,
+                    void *user_data);
+    bool bake_pvs(const PvsSettings &settings, PvsCallback callback, void *user_data);
+    void set_pvs(const PvsData &pvs);
 
     void resize(unsigned int width, unsigned int height, double scale);
 
+    // Surfaces share every mesh, texture, material and pipeline of the renderer, render() and resize() apply to the
+    // selected one. Surface 0 is the window or offscreen target of create_instance, surfaces added for other windows
+    // get the next free id. Returns ~0u without a window.
+    unsigned int add_surface(void *ns_window, unsigned int width, unsigned int height, double scale);
+    void remove_surface(unsigned int surface);
+    // Returns false when there is no such surface, the selected one stays selected then.
+    bool select_surface(unsigned int surface);
+
+    void set_frames_in_flight(unsigned int count);
+    void set_vertex_compaction_budget(unsigned int bytes_per_frame);
+    void set_mesh_welding(bool enabled);
+    void set_static_batching(const StaticBatching &batching);
+    void set_copy_on_submit(bool enabled);
+    void set_upload_budget(const UploadBudget &budget);
+    // Meshes and textures whose upload waits for the budget of a later frame.
+    unsigned int pending_uploads() const;
+    void set_3d_vertex_format(VertexFormat3D format);
+    void set_gpu_culling(bool enabled);
+    void set_async_compute(bool enabled);
+    void set_gpu_driven_draws(bool enabled);
+    void set_private_geometry(bool enabled);
+    void set_position_stream(bool enabled);
+    void set_gpu_mipmaps(bool enabled);
+    void set_texture_transcoding(bool enabled);
+    void set_lossy_textures(bool enabled);
+    bool set_video_frame(unsigned int index, CVPixelBufferRef pixel_buffer);
+    bool set_video_surface(unsigned int index, IOSurfaceRef surface);
+    void set_texture_packing(unsigned int max_size);
+    void set_texture_budget(size_t bytes);
+    void set_depth_prepass(bool enabled);
+    void set_visibility_buffer(bool enabled);
+    void set_occlusion_culling(bool enabled);
+    void set_cluster_culling(bool enabled);
+    void set_shadow_distance(float distance);
+    void set_unorm16_shadows(bool enabled);
+    void set_encoding_threads(unsigned int count);
+    void set_ray_tracing(bool enabled);
+    void set_path_tracer_denoiser(bool enabled);
+    void set_path_tracer_convergence(float threshold, unsigned int min_samples, unsigned int max_samples,
+                                     float time_budget);
+    PathTracerProgress path_tracer_progress() const;
+    void set_ambient_occlusion_radius(float radius);
+    void set_ssao(bool enabled);
+    void set_reflections(const ReflectionSettings &settings);
+    void set_sdf_tracing(const SdfSettings &settings);
+    void set_msaa_samples(unsigned int samples);
+    void set_hdr(HdrMode mode, float exposure);
+    void set_temporal_antialiasing(bool enabled);
+    void set_post_processing(const PostProcessSettings &settings);
+    void set_color_grading_lut(const unsigned char *texels, unsigned int size);
+    void set_present_mode(PresentMode mode, float min_frame_duration, bool low_latency);
+    void set_frame_timeout(float seconds);
+    void set_on_demand_rendering(bool enabled, float heartbeat);
+    void request_redraw()
+    {
+        _changes++;
+    }
+    void set_render_scale(float scale);
+    void set_dynamic_resolution(float target_ms, float min_scale, float max_scale);
+    void set_quality_governor(bool enabled);
+    void set_texture_filtering(unsigned int sampler_3d, unsigned int sampler_2d, unsigned int max_anisotropy);
+    void set_rasterization_rates(const float *horizontal, unsigned int num_horizontal, const float *vertical,
+                                 unsigned int num_vertical);
+    void set_inset_views(const InsetView3D *views, unsigned int count);
+    void set_render_texture(unsigned int index, const RenderTexture &texture);
+    void request_render_texture(unsigned int index);
+    void set_render_texture_budget(unsigned int pixels_per_frame);
+
+    bool pipelines_ready() const;
+    void wait_for_pipelines();
+    void notify_pipelines_ready(PipelinesReadyCallback callback, void *user_data);
+
+    FrameStats frame_stats() const
+    {
+        FrameStats stats = _frame_timer.stats();
+        stats.quality_level = _quality.level();
+        return stats;
+    }
+    FramePacingStats frame_pacing() const
+    {
+        return _pacing.stats();
+    }
+    void reset_frame_pacing()
+    {
+        _pacing.reset();
+    }
+    void set_mesh_profiling(bool enabled);
+    MeshCostStats mesh_costs() const
+    {
+        return _mesh_profiler.stats();
+    }
+    uint64_t submitted_frame() const
+    {
+        return _frames_rendered;
+    }
+    uint64_t completed_frame() const
+    {
+        return _frame_event.signaledValue;
+    }
+    bool wait_for_frame(uint64_t frame, unsigned int timeout_ms);
+    MemoryStats memory_stats() const;
+    void set_memory_policy(MemoryPolicy policy, MeshEvictionCallback callback, void *user_data);
+    void set_resource_cache(size_t bytes);
+    void set_deduplication(bool enabled);
+    void set_cell_streaming(const StreamingSettings &settings, CellStreamingCallback callback, void *user_data);
+    void set_streaming_cell(unsigned int id, const StreamingCell &cell);
+    void remove_streaming_cell(unsigned int id);
+    bool streaming_cell_loaded(unsigned int id) const
+    {
+        const StreamedCell *cell = _cells.find(id);
+        return cell && cell->loaded;
+    }
+
+    // Records the calls of the C API into a capture at path from now on, replacing a running capture. Returns false
+    // when path can't be written.
+    bool start_capture(const char *path, bool compress)
+    {
+        const CGSize size = drawable_size();
+        _capture = CommandCapture::create(path, static_cast<unsigned int>(size.width),
+                                          static_cast<unsigned int>(size.height), compress);
+        return _capture != nullptr;
+    }
+    void stop_capture()
+    {
+        _capture.reset();
+    }
+    // The running capture, nullptr when calls are not captured.
+    CommandCapture *capture() const
+    {
+        return _capture.get();
+    }
+
+    bool capture_gpu_frames(const char *directory, unsigned int frames)
+    {
+        return _gpu_capture.request(directory, frames);
+    }
+    void set_gpu_capture_trigger(const char *directory, float threshold_ms, unsigned int frames)
+    {
+        _gpu_capture.set_trigger(directory, threshold_ms, frames);
+    }
+
+    void set_performance_hud(bool enabled)
+    {
+        _hud.set_enabled(_device, enabled);
+    }
+
+    TraceRecorder &trace()
+    {
+        return _trace;
+    }
+
   private:
     MetalRenderer(id<MTLDevice> device, void *ns_window, void *ns_view, unsigned int width, unsigned int height,
-                  double scale);
+                  double scale, const char *pipeline_cache);
+
+    // Applies the batches submitted by command recorders in submission order.
+    void apply_recorded_commands();
+    // Updates the vertex and instance lists, the 2D batches and the texture table with the changes since the last
+    // call, on the thread of synchronize or on the synchronize queue.
+    void synchronize_scene();
+
+    // Blocks until the GPU finished every frame in flight, frames can be submitted again after release_all_frames.
+    void acquire_all_frames();
+    void release_all_frames();
+
+    // Size of the drawables, or of the offscreen target without a window.
+    CGSize drawable_size() const
+    {
+        return _layer != nil ? _layer.drawableSize : _offscreen_size;
+    }
+    // Offscreen target of the frame, created with the current size when it has none.
+    id<MTLTexture> offscreen_target(FrameResources &frame);
+    // Sets up every pipeline state, run by _pipelines on a background queue once the capabilities of the device are
+    // known. Only touches the states, their descriptors and the argument encoders of the compute passes.
+    void create_pipelines();
+    // Recreates the depth texture at the render scale of the drawable size, with every attachment sized by it. The
+    // previous targets are released first, frames in flight must not use them.
+    void create_render_targets();
+    // Recreates the attachments the 3D passes draw into when they are upscaled, rate mapped or HDR, none for other
+    // frames.
+    void create_scaled_targets();
+    // Color format of the 3D passes and of the drawable.
+    MTLPixelFormat scene_format() const
+    {
+        return _hdr != HDR_OFF ? MTLPixelFormatRGBA16Float : MTLPixelFormatBGRA8Unorm;
+    }
+    MTLPixelFormat target_format() const
+    {
+        return _hdr == HDR_EXTENDED ? MTLPixelFormatRGBA16Float : MTLPixelFormatBGRA8Unorm;
+    }
+    // Recreates the rate map for the size of the depth texture, none without rates.
+    void create_rate_map();
+    // Upscales or antialiases the scaled color temporally, returns the texture the overlay pass draws the 3D view
+    // from. Upscaled frames whose pre-pass drew no motion vectors get the camera motion of every pixel instead.
+    id<MTLTexture> encode_upscaling(id<MTLCommandBuffer> command_buffer, const glm::mat4 &combined, glm::vec2 jitter,
+                                    bool motion);
+    // Compiles the upscale pipelines again for the post effects that are on, frames take the overlay pass while any
+    // of them is.
+    void update_post_effects();
+    id<MTLFunction> upscale_function(bool rate_mapped) const;
+    // Downsamples the view the overlay pass draws into the bloom pyramid and adds the levels back up into the finest
+    // one, returns it.
+    id<MTLTexture> encode_bloom(id<MTLCommandBuffer> command_buffer, id<MTLTexture> view);
+    MotionUniforms motion_uniforms(const glm::mat4 &combined, glm::vec2 jitter) const;
+    // Scale the 3D targets are created at, the render scale lowered by the quality level.
+    float render_scale() const
+    {
+        return std::max(_render_scale * _quality.settings().render_scale, 0.5f);
+    }
+    // Creates the targets and shadow maps again for the settings of the current quality level.
+    void apply_quality_level();
+    bool temporal_upscaling() const
+    {
+#ifdef RFW_METAL_FX
+        return _upscaled != nil && _rate_map == nil;
+#else
+        return false;
+#endif
+    }
+    // The temporal scaler antialiases by itself.
+    bool temporal_antialiasing() const
+    {
+        return _taa && _rate_map == nil && !temporal_upscaling();
+    }
+    // Recreates the G-buffer attachments with the size of the depth texture.
+    void create_gbuffer();
+    // Recreates the multisampled attachments of the main pass with the size of the depth texture, none without MSAA.
+    void create_msaa_targets();
+
+    // Queues materials start to end for the copy of the table of every frame.
+    void mark_materials_changed(unsigned int start, unsigned int end);
+    // Brings the material table of a frame up to date, its previous frame is done reading it.
+    void update_frame_materials(unsigned int frame_index);
+    void encode_scene_arguments(unsigned int frame);
+    void encode_texture_arguments();
+    void encode_sampler_arguments();
+    void allocate_texture_heap(const TextureData *data, unsigned int num_textures);
+    id<MTLTexture> create_texture(const TextureData &d);
+    // Descriptor of the texture of d, stored with lossy compression while set_lossy_textures is enabled.
+    MTLTextureDescriptor *static_texture_descriptor(const TextureData &d, DataFormat format,
+                                                    unsigned int mip_levels) const;
+    // Whether d is uploaded into a layer of a texture array instead of a texture of its own.
+    bool packs_texture(const TextureData &d) const;
+    // Format a texture is created with, formats the device doesn't support fall back to BGRA8 and 8-bit color is
+    // transcoded into BC7 while set_texture_transcoding is enabled.
+    DataFormat device_format(const TextureData &d) const;
+    // Whether d is uploaded uncompressed and encoded into the blocks of its texture on the GPU.
+    bool transcodes(const TextureData &d) const;
+    // Mip levels a texture is created with, the full chain when its mips are generated on the GPU.
+    unsigned int mip_levels(const TextureData &d) const;
+    // Returns the number of bytes staged.
+    size_t upload_texture(id<MTLTexture> texture, const TextureData &d);
+    // Stages the levels of d in format into texture and generates the levels it has beyond them.
+    size_t stage_texture(id<MTLTexture> texture, const TextureData &d, DataFormat format);
+    // Uploads the levels of d into an uncompressed texture and encodes texture from it with the upload.
+    size_t transcode_texture(id<MTLTexture> texture, const TextureData &d);
+    // Buffer and offset of bytes within a mapped scene cache, false for bytes outside of all of them.
+    bool locate_scene_cache(const void *bytes, id<MTLBuffer> *buffer, size_t *offset) const;
+    void update_texture_residency();
+    // Grows the texture table to hold index, stops streaming its texture and supersedes its pending uploads.
+    void replace_texture_slot(unsigned int index);
+    // Marks the uploads of slot index that are in flight or deferred as superseded.
+    void supersede_texture_uploads(unsigned int index);
+    // Stages the deferred textures the upload budget of the frame allows, in the order they were set.
+    void upload_deferred_textures();
+    // Copies the committed mapped textures the upload budget of the frame allows, in the order they were committed.
+    void upload_committed_textures();
+    // Stages bands of rows of texture until the upload budget is spent, returns true once all of it is staged.
+    bool stage_deferred_texture(DeferredTexture &texture);
+    // Replaces the tile cache with one of the cache budget, which drops every tile.
+    void create_virtual_cache();
+    // Maps the tiles whose upload completed and uploads the wanted tiles that fit the upload budget.
+    void stream_virtual_textures();
+    void update_virtual_pages(FrameResources &frame);
+    bool upload_completed(const PendingTexture &pending) const;
+    // Whether a texture upload completed since the texture table was last encoded.
+    bool textures_uploaded() const;
+    // Binds the textures whose upload completed, frames in flight must be done with the texture table.
+    void swap_uploaded_textures();
+    // Returns true when texture was a standalone allocation, those are kept in the resource cache by a non-zero key.
+    bool release_texture(id<MTLTexture> texture, size_t key = 0);
+    // Key of d in the resource cache, 0 without one. Data whose hash collides with other contents gets no key.
+    size_t texture_key(const TextureData &d);
+    // Drops the contents of keys that no texture, upload or cache entry holds anymore.
+    void prune_texture_contents();
+    // Keeps a copy of a full-format mesh that is about to be unloaded in the resource cache.
+    void cache_3d_mesh(unsigned int id);
+    // Drops everything of mesh id but its cached copy, the skinning groups still need to be rebuilt.
+    void unload_3d_mesh(unsigned int id);
+    // Keeps a copy of d for streaming when it has levels beyond the resident tail, returns the levels to upload now.
+    TextureData track_streamed_texture(unsigned int index, const TextureData &d);
+    // Merges the texture LOD feedback a completed frame wrote into the levels streamed textures want.
+    void read_texture_feedback(FrameResources &frame);
+    // Uploads the levels streamed textures want and evicts levels no longer wanted to stay within the texture budget,
+    // and pressure bytes below the streamed levels. Returns the number of bytes evicted.
+    size_t stream_textures(size_t pressure);
+    // Uploads levels first_mip and on of a streamed texture into a new texture, returns the number of bytes staged.
+    size_t upload_streamed_texture(unsigned int index, unsigned int first_mip);
+    size_t memory_budget() const;
+    // Bytes the device allocated beyond the budget of the memory policy, 0 without one.
+    size_t memory_excess() const;
+    // Unloads the least recently drawn 3D meshes the memory policy allows until bytes of vertices are freed.
+    void evict_meshes(size_t bytes);
+    // Unloads the streaming cells out of range and loads those in range within the upload budget.
+    void stream_cells();
+    // Unloads the meshes of cell and points its texture slots at the fallback texture once frames are synchronized.
+    void unload_cell(unsigned int id, const StreamedCell &cell);
+    bool textures_resident() const
+    {
+#ifdef RFW_METAL_RESIDENCY_SETS
+        return _texture_residency != nil;
+#else
+        return false;
+#endif
+    }
+
+    // Writes the indirect draw arguments of this frame and encodes the culling pass that fills in their instance
+    // counts, returns an invalid allocation when there is nothing to draw. With occlusion culling this is the early
+    // phase, which also prepares the late one.
+    UploadAllocation encode_instance_culling(id<MTLCommandBuffer> command_buffer, unsigned int frame,
+                                             const glm::mat4 &combined, const glm::vec4 &lod_view);
+    // Instances of one culled view, including room for those drawn with coarser levels of detail.
+    unsigned int culled_instance_count() const;
+    // Encodes the cluster culling of the draws the instance culling dispatched on encoder found visible.
+    void encode_cluster_culling(id<MTLComputeCommandEncoder> encoder, unsigned int frame, const CullUniforms &uniforms,
+                                const UploadAllocation &args);
+    // Encodes the culling of the runs of skinned instances with the bounds of the last skinning pass.
+    void encode_skinned_culling(id<MTLComputeCommandEncoder> encoder, unsigned int frame, const CullUniforms &uniforms);
+    // Rebuilds the cluster buffer from the clusters of all meshes, frames in flight must be done with it.
+    void update_clusters();
+    // Updates the world bounds of moved submeshes and collects the draws of the submeshes within the view of combined
+    // or of any inset view.
+    void cull_submeshes(const glm::mat4 &combined);
+    // Builds the depth pyramid from the depth of the early draws and encodes the late occlusion culling phase, returns
+    // the indirect arguments of the instances it found visible.
+    UploadAllocation encode_late_culling(id<MTLCommandBuffer> command_buffer, unsigned int frame,
+                                         const glm::mat4 &combined);
+    // Culls the draws prepared by encode_instance_culling against another view, the instances it finds visible are
+    // written from visible_offset on.
+    UploadAllocation encode_view_culling(id<MTLCommandBuffer> command_buffer, unsigned int frame,
+                                         const glm::mat4 &combined, unsigned int visible_offset);
+    // Copies the indirect arguments prepared by encode_instance_culling, with their base instance moved by
+    // visible_offset.
+    UploadAllocation allocate_culled_args(unsigned int visible_offset);
+    // Culls the draws prepared by encode_instance_culling against the planes of uniforms on the CPU, in batches spread
+    // across cores, and writes the visible instances into the list of frame from visible_offset on. Returns the
+    // indirect arguments that draw them.
+    UploadAllocation cull_instances(unsigned int frame, const CullUniforms &uniforms, unsigned int visible_offset);
+    // The list the culled draws of frame read their visible instances from.
+    id<MTLBuffer> visible_instances(unsigned int frame) const;
+    void dispatch_culling(id<MTLComputeCommandEncoder> encoder, id<MTLComputePipelineState> state, unsigned int frame,
+                          const CullUniforms &uniforms, const UploadAllocation &args);
+    // Recreates the depth pyramid when the depth texture changed size.
+    void update_depth_pyramid();
+
+    // Recreates the shadow maps, they are 1x1 placeholders while shadows are disabled.
+    void create_shadow_maps();
+    // Queues the world bounds of the shadow caster and submeshes of a mesh to be updated after its instances moved,
+    // its shadows are redrawn where it moved.
+    void mark_instances_moved(unsigned int id);
+    // Instances [first, last) of a mesh and of the other meshes of its prefab got new transforms.
+    void mark_instances_transformed(unsigned int id, unsigned int first, unsigned int last);
+    // Stops a mesh from casting shadows, its shadows are redrawn where it was.
+    void remove_caster(unsigned int id);
+    void update_shadow_casters(bool shadows);
+    // Recreates the probe captures and reflections for the number of probes, all of them are baked again.
+    void create_probe_maps();
+    // Marks every face of the probes around meshes that changed since the last frame to be baked again.
+    void update_probe_faces();
+    // Fills in the light matrices of this frame and returns the shadow views that need to be redrawn.
+    std::vector<ShadowPass> update_shadow_views(const CameraView3D &view_3d, const glm::mat4 &view,
+                                                ShadowUniforms &uniforms);
+    // Draws the shadow casters into the shadow views of passes. Culled views write their visible instances from
+    // visible_offset on, one instance list per view.
+    void encode_shadows(id<MTLCommandBuffer> command_buffer, unsigned int frame, const std::vector<ShadowPass> &passes,
+                        bool culled, unsigned int visible_offset);
+
+    // Rebuilds the skinning groups when meshes, instances or skins changed and encodes the pass that writes the skinned
+    // vertices into the animated vertex buffer of the 3D vertex list, returns whether the skinning pass was encoded.
+    bool encode_skinning(id<MTLCommandBuffer> command_buffer);
+    // Writes the transforms of the animated instances into the instance buffer of frame.
+    void encode_instance_animation(id<MTLCommandBuffer> command_buffer, unsigned int frame);
+    // Scatters the changed hierarchy locals and writes the world transforms of its nodes into the instance buffer of
+    // frame, one dispatch per depth.
+    void encode_transform_hierarchy(id<MTLCommandBuffer> command_buffer, unsigned int frame);
+    // Generates the vertices of the terrains whose rings moved with the camera or whose range of the vertex buffer did.
+    void encode_terrains(id<MTLCommandBuffer> command_buffer, const CameraView3D &view);
+    // Copies the positions of the vertices written since the last frame into the position stream.
+    void encode_position_stream(id<MTLCommandBuffer> command_buffer);
+    void erase_terrain(unsigned int id);
+    // Writes the scattered instances around the camera into the instance buffer of frame.
+    void encode_instance_scatters(id<MTLCommandBuffer> command_buffer, unsigned int frame, const CameraView3D &view);
+    void erase_scatter(unsigned int id);
+    // Bakes the atlases of a queued impostor into the command buffer once its mesh has vertices, returns false when the
+    // request has to be dropped.
+    bool encode_impostor_bake(id<MTLCommandBuffer> command_buffer, ImpostorBake &bake,
+                              const std::function<void(id<MTLRenderCommandEncoder>)> &use_resources);
+    // Adds the impostors whose atlases were bound to their slots, drops those whose slots got other textures.
+    void add_baked_impostors();
+    // Adds the grid of a baked impostor to the vertex list and makes it the coarsest level of its mesh.
+    void add_impostor(const ImpostorBake &bake);
+    // Merges the static meshes into the batches of their cells again, the meshes of the previous batches get their
+    // instances back first.
+    void build_static_batches();
+    // Adds the merged mesh of a batch to the vertex list with one identity instance and the bounds of its cell.
+    void set_static_batch_mesh(const StaticBatch &batch);
+    void remove_static_batch_mesh(unsigned int id);
+    void erase_impostor(unsigned int id);
+    void erase_impostor_bakes(unsigned int id);
+    // Emits and simulates the particles of every emitter for the animation time that passed since the last frame, and
+    // sizes the draws of those that stay alive.
+    void encode_particles(id<MTLCommandBuffer> command_buffer);
+    // Draws the particles of every emitter into the transparency layers.
+    void draw_particles(id<MTLRenderCommandEncoder> encoder);
+    // Rasterizes the visible chunks of every point cloud into the point depth and color buffers, false when no point
+    // was drawn. combined has no translation, origin is the camera position.
+    bool encode_point_clouds(id<MTLCommandBuffer> command_buffer, const glm::mat4 &combined, const glm::dvec3 &origin);
+    // Converts the video frames that were set since the last frame into the textures of their slots.
+    void encode_video_frames(id<MTLCommandBuffer> command_buffer);
+    // Draws the views of the render textures that are due within the budget, lit like the inset views.
+    void encode_render_textures(id<MTLCommandBuffer> command_buffer, unsigned int frame_index,
+                                const UploadAllocation &lights, const UploadAllocation &directional_lights,
+                                const UploadAllocation &probes, const glm::mat4 &matrix_2d);
+    // Draws the lines of the debug draw API that were uploaded for the frame, the depth tested ones first.
+    void draw_debug_lines(id<MTLRenderCommandEncoder> encoder, const DebugLineBatch &batch,
+                          const UploadAllocation &camera, id<MTLRenderPipelineState> state);
+    // Whether the instances of mesh id are transformed on the GPU every frame, by an animation, a scatter or the
+    // hierarchy.
+    bool transformed_on_gpu(unsigned int id) const;
+
+    // Re-encodes the indirect command buffer with the 3D draws when meshes or instances changed.
+    void encode_draw_commands(id<MTLCommandBuffer> command_buffer);
+    // Encodes the culled draws of full-format 3D meshes with the indirect arguments args into the indirect command
+    // buffer after first, with the clustered draws of the early phase when clustered. Returns the encoded commands.
+    NSRange encode_culled_draw_commands(id<MTLCommandBuffer> command_buffer, const UploadAllocation &args,
+                                        unsigned int first, bool clustered);
+    // Grows the indirect command buffer to hold count draws, which drops the commands encoded into it.
+    void reserve_draw_commands(unsigned int count);
+
+    // Declares the buffers the 3D vertex functions read through the scene arguments.
+    void use_3d_resources(id<MTLRenderCommandEncoder> encoder, unsigned int frame_index, bool culled);
+    // Draws the 3D meshes with ids in [first_mesh, end_mesh), draw_args holds the culled indirect arguments when GPU
+    // culling ran this frame. Full-format meshes execute draw_commands of the indirect command buffer instead when it
+    // is not empty, the commands only hold opaque meshes. Skinned meshes are only drawn with draw_skinned, culled by
+    // runs of instances with the arguments of the early phase. Draws with the visibility buffer states set the first
+    // triangle of every mesh they draw. With a profiler, the draws of every mesh are timed and the indirect command
+    // buffer is not executed.
+    void encode_3d_draws(id<MTLRenderCommandEncoder> encoder, const Pipelines3D &pipelines,
+                         const UploadAllocation &draw_args, NSRange draw_commands, bool draw_skinned = true,
+                         MeshSelection selection = OpaqueMeshes, unsigned int first_mesh = 0,
+                         unsigned int end_mesh = ~0u, MeshProfiler *profiler = nullptr);
+
+    // Splits the 2D draws into batches after the 2D meshes or instances changed.
+    void build_2d_batches();
+    // Copies the batched 2D vertices into the frame's buffer when they changed since it was last written.
+    void update_2d_batches(FrameResources &frame);
+    // Finds the runs of 2D items inside the drawable and their clip rectangle under matrix_2d, into _culled_2d.
+    void cull_2d_batches(const glm::mat4 &matrix_2d);
+    // Draws the instance slots around the pending picks and hands their mesh and instance to the callbacks once the
+    // command buffer completed.
+    void encode_picks(id<MTLCommandBuffer> command_buffer, unsigned int frame_index, const UploadAllocation &uniforms,
+                      const UploadAllocation &draw_args, const UploadAllocation &late_draw_args);
+    // Counts the samples of the visibility group boxes that pass the pre-pass depth, the results are stored once the
+    // command buffer completed.
+    void encode_visibility(id<MTLCommandBuffer> command_buffer, const UploadAllocation &uniforms,
+                           const CameraView3D &view_3d, bool rate_mapped, const MTLViewport &viewport);
+    // Draws the performance HUD over the top left corner of target, rebuilding its quads when they are due.
+    void encode_hud(id<MTLCommandBuffer> command_buffer, id<MTLTexture> target);
+    // Traces the pending ray queries against the scene's acceleration structures, or misses them all when traced is
+    // false, and hands the hits to the callbacks once the command buffer completed.
+    void encode_ray_queries(id<MTLCommandBuffer> command_buffer, bool traced);
+    void encode_pvs_bake(id<MTLCommandBuffer> command_buffer);
+    // Creates the cached 2D layer for the drawable, returns whether 2D must be drawn into it again this frame.
+    bool update_2d_layer(const glm::mat4 &matrix_2d);
+    // Drops the animation of a 3D instance list, frames in flight may still read its instance buffer.
+    void erase_instance_animation(unsigned int id);
+    // Takes a mesh out of the prefab it is a member of, it has no instances until they are set again.
+    void leave_prefab(unsigned int id);
+    // Takes every other mesh out of the prefab owned by mesh id.
+    void dissolve_prefab(unsigned int id);
+    // Adds the 3D meshes with instances to the draw counts of this frame, before any culling.
+    void count_3d_draws();
+    // Numbers the triangles of the opaque meshes that are not skinned for the visibility buffer and uploads a
+    // VBufferMesh for each of them, sorted by their first triangle.
+    UploadAllocation upload_vbuffer_meshes(unsigned int *count);
+
+    // The descriptor of pass cleared of the attachments of the previous frame, only the first use allocates it.
+    MTLRenderPassDescriptor *pass_descriptor(PassDescriptor pass);
+
+    using EncodeFunction = std::function<void(id<MTLRenderCommandEncoder>)>;
+    using DrawFunction = std::function<void(id<MTLRenderCommandEncoder>, unsigned int, unsigned int)>;
+    // Mesh id bounds of the chunks the 3D draws are split into, one chunk per encoding thread.
+    std::vector<unsigned int> draw_chunks() const;
+    // Encodes a render pass whose 3D draws are split across the encoding threads. setup binds the pass state on every
+    // encoder, draw encodes the meshes of a chunk and finish, which may be empty, encodes what follows all 3D draws.
+    void encode_3d_pass(id<MTLCommandBuffer> command_buffer, MTLRenderPassDescriptor *desc, NSString *label,
+                        const EncodeFunction &setup, const DrawFunction &draw, const EncodeFunction &finish);
+
+    // Encodes the compute pass that builds the light list of every screen tile from the pre-pass depth.
+    void encode_light_culling(id<MTLCommandBuffer> command_buffer, const UploadAllocation &uniforms,
+                              const UploadAllocation &point_lights, const UploadAllocation &spot_lights,
+                              bool rate_mapped);
+    // Encodes the compute pass that sorts the area lights along the Morton curve and builds the light tree over them.
+    void encode_light_tree(id<MTLCommandBuffer> command_buffer);
+
+    // Recreates the texture shadows and occlusion are traced into, a 1x1 placeholder while neither rays nor distance
+    // fields are traced.
+    void create_ray_traced_target();
+    // Encodes the compute pass that traces shadows and ambient occlusion from the pre-pass depth.
+    void encode_ray_tracing(id<MTLCommandBuffer> command_buffer, const UploadAllocation &uniforms,
+                            const UploadAllocation &directional_lights);
+    // Encodes the compute pass that updates the distance fields and traces shadows and ambient occlusion through them,
+    // into the same texture as encode_ray_tracing.
+    void encode_sdf_tracing(id<MTLCommandBuffer> command_buffer, const UploadAllocation &uniforms,
+                            const UploadAllocation &directional_lights, const glm::vec3 &camera);
+    // Encodes the compute pass that computes screen space occlusion from the pre-pass depth, and blurs it through
+    // blurred when there is one.
+    void encode_ssao(id<MTLCommandBuffer> command_buffer, const UploadAllocation &uniforms, const mat4 &combined,
+                     id<MTLTexture> ssao, id<MTLTexture> blurred);
+    // Creates the reflection targets with half the size of the depth texture, unless they have it already.
+    void create_reflection_targets();
+    // Encodes the compute pass that builds the closest depth pyramid, traces the reflections of the pre-pass depth and
+    // resolves them into the history the main pass reads, which it returns.
+    id<MTLTexture> encode_reflections(id<MTLCommandBuffer> command_buffer, unsigned int frame_index,
+                                      const UploadAllocation &uniforms, const mat4 &combined, bool traced);
+    // Downsamples the main pass into the source of the reflections of the next frame.
+    void encode_reflection_source(id<MTLCommandBuffer> command_buffer);
+    // Creates the path queues and the accumulator with the size of the depth texture, and the buffers of the denoiser
+    // and of adaptive sampling while they are enabled.
+    void create_path_tracer_buffers();
+    void create_path_denoiser_buffers();
+    void create_path_adaptive_buffers();
+    // Uploads the traced instances and lights, the instances are invalid without any.
+    PathScene upload_path_scene();
+    // Binds the scene arguments, traced instances, indices, lights, light tree and acceleration structure of the path
+    // tracing kernels, fallback stands in for the light arrays that are empty.
+    void set_path_scene(id<MTLComputeCommandEncoder> encoder, unsigned int frame_index, const PathScene &scene,
+                        id<MTLBuffer> fallback);
+    // Encodes every bounce of the paths generated into the queue of bounce 0, sized by the paths in counters.
+    void encode_path_bounces(id<MTLComputeCommandEncoder> encoder, id<MTLBuffer> counters);
+    // Encodes the bounces of one sample per pixel that adds to the accumulator, returns the uniforms the accumulated
+    // samples are resolved with or an invalid allocation when nothing was traced.
+    UploadAllocation encode_path_tracing(id<MTLCommandBuffer> command_buffer, unsigned int frame_index,
+                                         const CameraView3D &view_3d, const glm::mat4 &combined);
+    // Makes the meshes, instances, materials and textures the hits of traced rays read resident in encoder.
+    void use_traced_resources(id<MTLComputeCommandEncoder> encoder, unsigned int frame_index);
+    // Binds the scene rays are traced against, the acceleration structure at index or else the compute BVH at
+    // BVH_SCENE_BUFFER_INDEX, and makes what it references resident.
+    void set_traced_scene(id<MTLComputeCommandEncoder> encoder, unsigned int index);
+    // Geometry of the instances hits name, of the acceleration structures or the compute BVH.
+    const std::vector<TracedInstance> &traced_instances() const;
+    // Encodes the update of the next probes of the irradiance volume that the ray budget covers.
+    void encode_gi(id<MTLCommandBuffer> command_buffer, unsigned int frame_index);
+    // Traces the samples of this frame of the first queued lightmap bake, and filters and binds the lightmap after its
+    // last one. Returns false once the bake is done or had to be dropped.
+    bool encode_lightmap_bake(id<MTLCommandBuffer> command_buffer, unsigned int frame_index, LightmapBake &bake);
+    // Allocates the buffers of a lightmap bake and rasterizes the positions and normals of its texels, returns false
+    // when they could not be allocated.
+    bool encode_lightmap_texels(id<MTLCommandBuffer> command_buffer, unsigned int frame_index, LightmapBake &bake);
+
+    // Creates the layer of a window with the size of its drawables.
+    CAMetalLayer *attach_layer(PlatformWindow *window, CGSize size);
+    // Exchanges the members of the selected surface with those of surface.
+    void swap_surface(Surface &surface);
+    // Sets the pixel format and color space of the layer for the HDR mode.
+    void update_layer_format();
+    // Surfaces that are not selected create their targets again once they are, after a setting changed them.
+    void invalidate_surface_targets();
+    // Whether an on-demand renderer draws this frame, also starts settling after a change.
+    bool frame_needed(const glm::mat4 &matrix_2d, const CameraView3D &view_3d, RenderMode3D mode);
+
+    // Drawable of the layer from the display link or the layer itself, nil once acquiring it timed out.
+    id<CAMetalDrawable> next_drawable();
+    void present(id<MTLCommandBuffer> command_buffer, id<CAMetalDrawable> drawable);
 
     id<MTLDevice> _device;
+    // DeviceStatus of _device as reported by the device observer, which runs on a thread of Metal's choosing.
+    id<NSObject> _device_observer = nil;
+    std::atomic<unsigned int> _device_status{DEVICE_OK};
     id<MTLCommandQueue> _queue;
+    // Work that only depends on the geometry and instances of a frame runs on the compute queue with async compute.
+    // Its command buffer signals _compute_event once done and waits for the previous frame to signal _geometry_event
+    // after its last 3D pass, as it writes the vertices and acceleration structures those passes read.
+    bool _async_compute = false;
+    id<MTLCommandQueue> _compute_queue = nil;
+    id<MTLEvent> _compute_event = nil;
+    uint64_t _compute_value = 0;
+    id<MTLEvent> _geometry_event = nil;
+    uint64_t _geometry_value = 0;
     CAMetalLayer *_layer;
+    PresentMode _present_mode = PRESENT_IMMEDIATE;
+    float _min_frame_duration = 0.0f;
+    // Negative waits as long as Metal does, the drawable queue only exists with a timeout.
+    double _frame_timeout = -1.0;
+    // On-demand rendering counts the changes frames are compared against, a heartbeat of 0 never draws unchanged.
+    bool _on_demand = false;
+    float _heartbeat = 0.0f;
+    uint64_t _changes = 0;
+    OnDemandFrame _on_demand_frame;
+    RfwDrawableQueue *_drawable_queue = nil;
+    // Encoders copy the descriptor they are created with, so one per pass is enough for all frames in flight. All of
+    // them are allocated together, allocations after the first frame are counted and must stay at zero.
+    std::array<MTLRenderPassDescriptor *, PassDescriptorCount> _pass_descriptors = {};
+    unsigned int _pass_descriptor_allocations = 0;
+#ifdef RFW_DISPLAY_LINK
+    RfwDisplayLink *_display_link API_AVAILABLE(macos(14.0)) = nil;
+#endif
+    // Window of the layer, its screen reports the EDR headroom.
+    __weak PlatformWindow *_window = nil;
+    // Surfaces by id, the entry of the selected one is empty as its members are those of the renderer. Removed
+    // surfaces have no layer.
+    std::vector<Surface> _surfaces;
+    unsigned int _surface = 0;
+    // Size of the offscreen targets of frames rendered without a window.
+    CGSize _offscreen_size = CGSizeMake(0.0, 0.0);
 
     id<MTLLibrary> _library;
     dispatch_semaphore_t _sem;
-    id<MTLRenderPipelineState> _state;
-    id<MTLRenderPipelineState> _state_2d;
+    // Asynchronous synchronizes run one at a time on the queue, the group holds the one that runs.
+    dispatch_queue_t _sync_queue = dispatch_queue_create("rfw synchronize", DISPATCH_QUEUE_SERIAL);
+    dispatch_group_t _sync_group = dispatch_group_create();
+    // Compiles every pipeline state below, which must not be used before wait_for_pipelines().
+    PipelineCache _pipelines;
+    // Scans, compaction, radix sorts and segmented sums other passes are built from.
+    GpuPrimitives _primitives;
+    Pipelines3D _state_3d;
+    // Depth-only variants for the depth pre-pass.
+    Pipelines3D _prepass_state_3d;
+    // Variants of the depth-only states drawing full-format meshes from the position stream.
+    Pipelines3D _position_prepass_state_3d;
+    Pipelines3D _position_pick_state_3d;
+    id<MTLComputePipelineState> _extract_positions_state;
+    id<MTLComputePipelineState> _light_cull_state;
+    id<MTLComputePipelineState> _light_tree_keys_state;
+    id<MTLComputePipelineState> _build_light_tree_state;
+    id<MTLComputePipelineState> _skinning_state;
+    id<MTLComputePipelineState> _animate_skins_state;
+    id<MTLComputePipelineState> _animate_instances_state;
+    id<MTLComputePipelineState> _scatter_hierarchy_state;
+    id<MTLComputePipelineState> _propagate_hierarchy_state;
+    id<MTLComputePipelineState> _generate_terrain_state;
+    id<MTLComputePipelineState> _scatter_instances_state;
+    id<MTLComputePipelineState> _emit_particles_state;
+    id<MTLComputePipelineState> _prepare_particles_state;
+    id<MTLComputePipelineState> _simulate_particles_state;
+    id<MTLComputePipelineState> _finish_particles_state;
+    id<MTLRenderPipelineState> _particle_state;
+    id<MTLComputePipelineState> _cull_state;
+    id<MTLComputePipelineState> _occlusion_cull_state;
+    id<MTLComputePipelineState> _bvh_cull_state;
+    id<MTLComputePipelineState> _bvh_occlusion_cull_state;
+    id<MTLComputePipelineState> _depth_pyramid_init_state;
+    id<MTLComputePipelineState> _depth_pyramid_state;
+    id<MTLComputePipelineState> _encode_draws_state;
+    id<MTLComputePipelineState> _encode_culled_draws_state;
+    id<MTLComputePipelineState> _culled_draw_keys_state;
+    id<MTLComputePipelineState> _encode_bc7_state;
+    id<MTLComputePipelineState> _cull_clusters_state;
+    id<MTLComputePipelineState> _cull_skinned_state;
+    id<MTLArgumentEncoder> _draw_commands_encoder;
+    // 2D pipelines by TEXTURE_MODE_2D_*, the texture mode of every 2D mesh, followed by the pipelines of batched
+    // vertices at BATCHED_2D_STATE, of glyphs at GLYPH_2D_STATE, of sprites at SPRITE_2D_STATE, of paths at
+    // PATH_2D_STATE and the composite of the cached 2D layer at LAYER_2D_STATE.
+    static constexpr unsigned int BATCHED_2D_STATE = TEXTURE_MODES_2D;
+    static constexpr unsigned int GLYPH_2D_STATE = TEXTURE_MODES_2D + 1;
+    static constexpr unsigned int SPRITE_2D_STATE = TEXTURE_MODES_2D + 2;
+    static constexpr unsigned int PATH_2D_STATE = TEXTURE_MODES_2D + 3;
+    static constexpr unsigned int LAYER_2D_STATE = TEXTURE_MODES_2D + 4;
+    using States2D = std::array<id<MTLRenderPipelineState>, TEXTURE_MODES_2D + 5>;
+    States2D _states_2d = {};
+    // With 2D caching, 2D is only drawn into the layer when it changed, every frame composites the layer instead.
+    States2D _states_2d_layer = {};
+    bool _cache_2d = false;
+    bool _layer_2d_dirty = true;
+    id<MTLTexture> _layer_2d = nil;
+    glm::mat4 _layer_2d_matrix = glm::mat4(0.0f);
+    IdTable<unsigned int> _texture_modes_2d;
+    // Meshes with at most this many vertices over all their instances are batched.
+    static constexpr size_t MAX_BATCHED_2D_VERTICES = 1024;
+    std::vector<Batch2D> _batches_2d;
+    std::vector<Vertex2D> _batched_2d_vertices;
+    unsigned int _batches_2d_version = 0;
+    // Clip rectangles by 2D mesh id, the instances of every batch with their bounds and the runs of them a frame draws
+    // as (start, count) pairs, by batch in _culled_2d.
+    IdTable<ClipRect2D> _clips_2d;
+    std::vector<Item2D> _items_2d;
+    std::vector<std::pair<unsigned int, unsigned int>> _runs_2d;
+    std::vector<Culled2D> _culled_2d;
+    // Coverage of the glyphs of instanced text, drawn after all other 2D. Runs of glyphs are copied, only the glyphs
+    // that differ from the previous contents of a run are uploaded again.
+    id<MTLTexture> _glyph_atlas = nil;
+    InstanceList<GlyphInstance> _glyph_list;
+    IdTable<std::vector<GlyphInstance>> _glyph_copies;
+    // Sprites are one instance per quad, drawn after 2D meshes and before glyphs. Runs are copied like glyph runs.
+    InstanceList<SpriteInstance> _sprite_list;
+    IdTable<std::vector<SpriteInstance>> _sprite_copies;
+    // Vector paths are one quad each, drawn after 2D meshes and before sprites.
+    IdTable<Path2D> _paths_2d;
+
+    // Deferred shading keeps the G-buffer in tile memory, only available on Apple GPUs.
+    bool _tile_memory = false;
+    // Depth and multisample attachments that are never loaded or stored are memoryless on every Apple GPU.
+    bool _memoryless = false;
+    Pipelines3D _gbuffer_state_3d;
+    // Resolve pipelines by deferred view, shaded, normals and albedo.
+    std::array<id<MTLRenderPipelineState>, 3> _deferred_states = {};
+    States2D _states_2d_deferred = {};
+    // Memoryless attachments GBUFFER_ALBEDO_INDEX to GBUFFER_DEPTH_INDEX.
+    std::array<id<MTLTexture>, 3> _gbuffer = {};
+
+    // Transparent meshes are drawn with weighted blended order-independent transparency in a pass after the opaque
+    // ones, testing against the depth of a pre-pass without them. With tile memory the accumulation is memoryless and
+    // composited within the pass, which also draws the 2D of frames that are not scaled. Otherwise a second pass
+    // composites the stored accumulation.
+    IdTable<bool> _transparent_meshes;
+    Pipelines3D _transparent_state_3d;
+    id<MTLRenderPipelineState> _transparency_composite_state = nil;
+    States2D _states_2d_transparent = {};
+
+    // The forward main pass draws into multisampled attachments, which are resolved into the drawable at the end of
+    // the pass. They are memoryless on GPUs with tile memory. The pipelines of the pass get multisampled variants.
+    unsigned int _msaa_samples = 1;
+    Pipelines3D _msaa_state_3d;
+    States2D _states_2d_msaa = {};
+    std::vector<PipelineVariant> _msaa_pipelines;
+    id<MTLTexture> _msaa_color = nil;
+    id<MTLTexture> _msaa_depth = nil;
+
+    // Below a render scale of 1 the 3D passes draw into scaled_color, which an overlay pass upscales into the drawable
+    // before drawing 2D at full size. Scaled frames are not multisampled. MetalFX upscales them temporally from a
+    // jittered projection, the depth and the camera motion of every pixel, otherwise they are filtered bilinearly.
+    float _render_scale = 1.0f;
+    id<MTLTexture> _scaled_color = nil;
+    // Adjusts the render scale to the GPU time of the frames resolved since the last one it saw.
+    ResolutionController _dynamic_resolution;
+    uint64_t _resolution_frame = 0;
+    // Scales the render scale, the cascade resolution, SSAO, level of detail and the frame rate down a level at a time
+    // while the system is under thermal or power pressure.
+    QualityGovernor _quality;
+    id<MTLRenderPipelineState> _upscale_state = nil;
 
-    id<MTLBuffer> _args_buffer = nil;
+    // HDR frames shade into a half float scaled_color, also at full size, and the overlay pass tonemaps it into the
+    // drawable. Pipelines that draw into the 3D passes or the drawable keep their descriptors to be compiled again for
+    // the formats of a mode.
+    HdrMode _hdr = HDR_OFF;
+    float _exposure = 1.0f;
+    // Post effects of the overlay pass and the POST_ mask of those that are on. The bloom pyramid has views of every
+    // level of the downsampled levels and of the sums of the coarser ones, the coarsest level has no sum.
+    PostProcessSettings _post = {};
+    unsigned int _post_effects = 0;
+    std::vector<id<MTLTexture>> _bloom_down;
+    std::vector<id<MTLTexture>> _bloom_up;
+    id<MTLTexture> _grading_lut = nil;
+    id<MTLComputePipelineState> _bloom_downsample_state = nil;
+    id<MTLComputePipelineState> _bloom_upsample_state = nil;
+    std::vector<PipelineVariant> _scene_pipelines;
+    std::vector<PipelineVariant> _target_pipelines;
+    id<MTLComputePipelineState> _camera_motion_state = nil;
+    // Combined matrix of the previous frame without jitter, which the camera motion is reprojected with, and the same
+    // relative to the camera position of that frame for the vertices.
+    glm::mat4 _previous_combined = glm::mat4(1.0f);
+    glm::mat4 _previous_relative_combined = glm::mat4(1.0f);
+    glm::vec3 _previous_origin = glm::vec3(0.0f);
+    unsigned int _jitter_index = 0;
+    // Temporal frames draw the motion of every pixel in the depth pre-pass, from the instance transforms of the
+    // previous frame. Those are copied from the frame's instance buffer once the pre-pass read them, and only used
+    // while the instance lists kept their layout.
+    Pipelines3D _motion_state_3d;
+    // Picks wait for the next frame, which draws instance slots into the pick ids at the render resolution. The
+    // targets are only created once something is picked.
+    struct PickRequest
+    {
+        std::vector<PickResult> results;
+        PickCallback callback;
+        void *user_data;
+    };
+    std::vector<PickRequest> _picks;
+    // Groups whose boxes are tested against the pre-pass depth of every frame that has one.
+    VisibilityQueries _visibility;
+    id<MTLRenderPipelineState> _visibility_state = nil;
+    Pipelines3D _pick_state_3d;
+    // Draws of the visibility buffer set the number of their first triangle, see upload_vbuffer_meshes.
+    bool _vbuffer_enabled = false;
+    Pipelines3D _vbuffer_state_3d;
+    id<MTLRenderPipelineState> _vbuffer_resolve_state = nil;
+    id<MTLTexture> _vbuffer = nil;
+    IdTable<unsigned int> _vbuffer_first_triangles;
+    id<MTLTexture> _pick_ids = nil;
+    id<MTLTexture> _pick_depth = nil;
+    // Fragments per pixel of RENDER_OVERDRAW, drawn over the pre-pass depth and shown as a heatmap.
+    Pipelines3D _overdraw_state_3d;
+    id<MTLRenderPipelineState> _overdraw_heatmap_state = nil;
+    id<MTLTexture> _overdraw = nil;
+    id<MTLRenderPipelineState> _background_motion_state = nil;
+    id<MTLTexture> _motion_vectors = nil;
+    id<MTLBuffer> _previous_instances = nil;
+    unsigned int _previous_instances_layout = ~0u;
+
+    // Temporal antialiasing blends every jittered frame into a history that is reprojected with the motion vectors,
+    // the history textures take turns to be read and written. Its frames take the overlay pass of scaled frames and
+    // are not multisampled.
+    bool _taa = false;
+    id<MTLComputePipelineState> _taa_resolve_state = nil;
+    std::array<id<MTLTexture>, 2> _taa_history = {};
+    unsigned int _taa_index = 0;
+    bool _taa_reset = true;
+#ifdef RFW_METAL_FX
+    id<MTLFXTemporalScaler> _temporal_scaler API_AVAILABLE(macos(13.0)) = nil;
+    id<MTLTexture> _upscaled = nil;
+    // The history of the temporal scaler is discarded when its targets were recreated.
+    bool _upscale_reset = true;
+#endif
+
+    // Forward frames shade the zones of a rasterization rate map at their rates, rates are separable into columns and
+    // rows of zones. The 3D passes then render at the physical size of the map, which the overlay pass stretches over
+    // the screen instead of upscaling temporally.
+    bool _rate_maps_supported = false;
+    std::vector<float> _horizontal_rates;
+    std::vector<float> _vertical_rates;
+    id<MTLRasterizationRateMap> _rate_map = nil;
+    id<MTLBuffer> _rate_map_data = nil;
+    id<MTLComputePipelineState> _rate_mapped_light_cull_state = nil;
+    id<MTLRenderPipelineState> _rate_mapped_upscale_state = nil;
+
+    // Inset views are drawn over the finished frame in a pass of their own. Every draw is amplified into the viewports
+    // of up to max_amplification views, so the draws are encoded once for every that many views. Their depth has the
+    // drawable size and is memoryless with tile memory.
+    std::vector<InsetView3D> _inset_views;
+    Pipelines3D _inset_state_3d;
+    unsigned int _max_amplification = 1;
+    id<MTLTexture> _inset_depth = nil;
+
+    // Created once by the first synchronize, which also tells whether the tables are bindless. Bindless tables are
+    // written as plain structs instead of through the encoders.
+    id<MTLArgumentEncoder> _scene_encoder = nil;
+    bool _bindless = false;
+    id<MTLArgumentEncoder> _texture_encoder = nil;
     id<MTLBuffer> _textures_buffer = nil;
+    std::vector<id<MTLTexture>> _encoded_textures;
+    id<MTLBuffer> _texture_layers_buffer = nil;
+    id<MTLArgumentEncoder> _texture_array_encoder = nil;
+    id<MTLBuffer> _texture_arrays_buffer = nil;
+    size_t _encoded_texture_arrays = 0;
+    // The sampler table is encoded again into a new buffer when the filters change, frames in flight keep the old one.
+    id<MTLArgumentEncoder> _sampler_encoder = nil;
+    id<MTLBuffer> _samplers_buffer = nil;
+    std::array<id<MTLSamplerState>, SAMPLER_COUNT> _samplers = {};
+    unsigned int _sampler_3d = SAMPLER_ANISOTROPIC;
+    unsigned int _sampler_2d = SAMPLER_TRILINEAR_CLAMP;
+    unsigned int _max_anisotropy = 8;
+    bool _samplers_dirty = true;
+
+    std::vector<FrameResources> _frames;
+    unsigned int _frame_index = 0;
+    FrameTimer _frame_timer;
+    MeshProfiler _mesh_profiler;
+    // Fed by the presented handlers of the drawables.
+    FramePacing _pacing;
+    // Frame command buffers don't retain their resources, what frames in flight may still use is retired.
+    RetiredResources _retired;
+    UploadRing _upload_ring;
 
-    Buffer<Uniforms> _uniforms;
-    Buffer<DeviceMaterial> _materials;
-    Buffer<Uniforms> _camera;
+    // Packed material table every frame copies the changed entries of, see FrameResources::materials.
+    std::vector<PackedMaterial> _materials;
+    std::vector<DeviceMaterial> _device_materials;
 
     id<MTLTexture> _depth_texture;
+    // Targets are recreated by the next render after the drawable size or render scale changed, so a live resize
+    // reallocates them once per frame at most.
+    RenderTargetPool _target_pool;
+    bool _targets_dirty = false;
+    // Passes of the frame from the occlusion to the transparency composite, with their transient textures.
+    FrameGraph _frame_graph;
+    // The 3D views draw reversed depth with an infinite far plane, nearer surfaces have greater depths.
     id<MTLDepthStencilState> _depth_state;
+    // Always runs while there are lights, as light culling needs its depth.
+    bool _depth_prepass = false;
+    // Main pass depth test against the depth written by the pre-pass.
+    id<MTLDepthStencilState> _depth_state_prepassed;
     id<MTLDepthStencilState> _depth_state_2d;
+    // Shadow maps and impostor atlases keep standard depth, which 16-bit formats store more evenly.
+    id<MTLDepthStencilState> _standard_depth_state;
 
     VertexList<Vertex3D, JointData> _vertex_3d_list;
+    VertexList<PackedVertex3D, JointData> _packed_3d_list;
     VertexList<Vertex2D, unsigned int> _vertex_2d_list;
 
     //    vertex_2d_list: VertexList<Vertex2D>,
     //        mesh_2d_textures: Vec<Option<usize>>,
     //        instance_2d_list: InstanceList<Mat4>,
 
-    std::vector<std::shared_ptr<std::vector<Matrices>>> _instance_3d_matrices;
-    InstanceList<Matrices> _instance_3d_list;
+    CommandQueue _recorded_commands;
+    // Pending changes of the next synchronize while synchronize_async applies the previous ones, see
+    // deferred_recorder. Only the calling thread uses them.
+    CommandRecorder _deferred_commands{&_recorded_commands};
+    bool _defer_changes = false;
+    // Meshes set from recorded commands, their vertex lists point into these copies.
+    IdTable<RecordedMesh> _recorded_meshes;
+    // Mapped scene caches, meshes loaded from them point into their mappings. The mappings are of clean file pages the
+    // system reclaims on its own, so they are kept for the lifetime of the renderer.
+    std::vector<std::unique_ptr<SceneCache>> _scene_caches;
+    std::unique_ptr<CommandCapture> _capture;
+    GpuCapture _gpu_capture;
+    // Drawn over the finished frame in a pass of its own, which only loads and stores the tiles of the panel.
+    PerformanceHud _hud;
+    // Shared with _frame_timer, which adds the GPU spans of completed frames.
+    TraceRecorder _trace;
+
+    IdTable<WeldedMesh> _welded_meshes;
+    bool _weld_meshes = false;
+    // Mesh and 2D instance data is copied when it is set instead of being read from the caller in synchronize.
+    bool _copy_on_submit = false;
+    IdTable<std::vector<glm::mat4>> _instance_2d_copies;
+    IdTable<PackedMesh> _packed_meshes;
+    VertexFormat3D _vertex_format = VERTEX_3D_FULL;
+
+    bool _gpu_culling = false;
+    // GPUs with tier 1 argument buffers cull on the CPU, which skips occlusion and cluster culling.
+    bool _cpu_culling = false;
+    std::vector<Aabb> _instance_3d_bounds;
+    std::vector<unsigned int> _draw_slots;
+    // Levels of detail by mesh, and the culled draws of coarser levels by the mesh they draw.
+    IdTable<std::vector<MeshLod>> _mesh_lods;
+    IdTable<std::vector<LodDraw>> _lod_slots;
+    // Meshes whose instances are transformed on the GPU every frame, their CPU copies hold the instances at rest.
+    IdTable<InstanceAnimator> _instance_animations;
+    TransformHierarchy _hierarchy;
+    IdTable<Terrain3D> _terrains;
+    IdTable<InstanceScatter> _scatters;
+    std::vector<ImpostorBake> _impostor_bakes;
+    // Bakes run one at a time in the order they were queued. Materials keep the lightmap slot set for them, set_materials
+    // writes it over the one they come with.
+    std::vector<LightmapBake> _lightmap_bakes;
+    std::vector<int> _material_lightmaps;
+    id<MTLRenderPipelineState> _lightmap_texel_state = nil;
+    id<MTLComputePipelineState> _generate_lightmap_state = nil;
+    id<MTLComputePipelineState> _filter_lightmap_state = nil;
+    // Vertices of the impostor meshes, which the vertex list may point into.
+    IdTable<std::vector<Vertex3D>> _impostors;
+    // Copies of the meshes flagged STATIC, and the batches the vertex list points into.
+    StaticBatching _static_batching = {};
+    IdTable<StaticMesh> _static_meshes;
+    std::vector<StaticBatch> _static_batches;
+    bool _static_batches_dirty = false;
+    IdTable<ParticleSystem> _particle_systems;
+    float _particle_time = 0.0f;
+    // Particles collide with the depth of the previous frame, when it was drawn without a rasterization rate map.
+    bool _particle_depth_valid = false;
+    glm::mat4 _particle_depth_combined = glm::mat4(1.0f);
+    // Points are rasterized by compute into a reversed depth and a color per pixel of the depth texture, the depths
+    // first with atomic max and then the colors of the points that won. The main pass composites them with a full
+    // screen triangle. Chunks draw at most POINTS_PER_PIXEL points per pixel of their screen bounds.
+    static constexpr float POINTS_PER_PIXEL = 2.0f;
+    IdTable<PointCloud> _point_clouds;
+    id<MTLBuffer> _point_depths = nil;
+    id<MTLBuffer> _point_colors = nil;
+    std::vector<PointChunkDraw> _point_draws;
+    id<MTLComputePipelineState> _point_depth_state = nil;
+    id<MTLComputePipelineState> _point_color_state = nil;
+    id<MTLRenderPipelineState> _point_cloud_state = nil;
+    id<MTLRenderPipelineState> _point_cloud_state_msaa = nil;
+    id<MTLRenderPipelineState> _point_cloud_state_deferred = nil;
+    float _animation_time = 0.0f;
+
+    // Static indexed meshes of at least CLUSTERED_MESH_TRIANGLES triangles are split into clusters. The instances of
+    // their draws found visible by the early culling phase only draw the clusters visible in any of them, copied into
+    // the culled index buffer. Both buffers are shared by all frames.
+    static constexpr unsigned int CLUSTERED_MESH_TRIANGLES = 8192;
+    bool _cluster_culling = false;
+    bool _clusters_dirty = false;
+    IdTable<std::vector<MeshCluster>> _mesh_clusters;
+    IdTable<ClusterRange> _cluster_ranges;
+    unsigned int _num_clusters = 0;
+    id<MTLBuffer> _clusters = nil;
+    id<MTLBuffer> _culled_indices = nil;
+    // Material ranges of static meshes with several of them. Without GPU culling, the camera only draws the ones
+    // within its view, which are collected into the submesh draws of every frame.
+    IdTable<std::vector<Submesh>> _submeshes;
+    std::vector<unsigned int> _moved_submeshes;
+    IdTable<std::vector<SubmeshDraw>> _submesh_draws;
+    // Clustered draw of every mesh drawn with its clusters this frame.
+    IdTable<unsigned int> _cluster_slots;
+    id<MTLBuffer> _visible_instances = nil;
+
+    bool _occlusion_culling = false;
+    // Farthest depth of the 3D geometry at power of two sizes, with a view of every level to write it through. Kept
+    // from one frame to the next for the early phase.
+    id<MTLTexture> _depth_pyramid = nil;
+    std::vector<id<MTLTexture>> _depth_pyramid_levels;
+    glm::mat4 _depth_pyramid_combined = glm::mat4(1.0f);
+    bool _depth_pyramid_valid = false;
+    // Flags of the instances the early phase rejected as occluded, GPU-only and shared by all frames.
+    id<MTLBuffer> _occluded_instances = nil;
+    CulledDraws _culling;
+    // Tree over the instance slots of the culled draws, refit with the instances transformed since the last frame
+    // that culled on the GPU, or with all of them after too many changes.
+    InstanceBvh _instance_bvh;
+    std::vector<glm::uvec3> _bvh_transformed;
+    bool _bvh_all_transformed = false;
+
+    bool _gpu_driven = false;
+    bool _draw_commands_dirty = true;
+    unsigned int _draw_command_count = 0;
+    id<MTLIndirectCommandBuffer> _draw_commands = nil;
+    id<MTLBuffer> _draw_commands_args = nil;
+
+    std::vector<std::vector<glm::mat4>> _skins;
+    std::vector<std::vector<int>> _instance_3d_skin_ids;
+    bool _skinning_dirty = true;
+    std::vector<SkinningGroup> _skinning_groups;
+    // Skinning group of every instance of a skinned mesh, ~0u for instances drawn with the bind pose.
+    IdTable<std::vector<unsigned int>> _skinned_instances;
+    // Bounds of every skinning group from the last skinning pass, see NO_SKINNING_GROUP.
+    id<MTLBuffer> _skinned_bounds = nil;
+    // Deltas are uploaded once they changed, weights with every skinning pass.
+    IdTable<MorphTargets3D> _morph_targets;
+    IdTable<std::vector<float>> _morph_weights;
+    id<MTLBuffer> _morph_deltas = nil;
+    id<MTLBuffer> _morph_offsets = nil;
+    bool _morph_targets_dirty = false;
+    // Clips and skeletons are uploaded once they changed, the layers of animated skins with every skinning pass.
+    IdTable<AnimationClip3D> _animation_clips;
+    IdTable<Skeleton3D> _skeletons;
+    IdTable<SkinPlayback> _skin_animations;
+    id<MTLBuffer> _animation_channels = nil;
+    id<MTLBuffer> _animation_times = nil;
+    id<MTLBuffer> _animation_values = nil;
+    id<MTLBuffer> _skeleton_joints = nil;
+    bool _animations_dirty = false;
+
+    // Members of a prefab share the matrices and the instance range of its owner.
+    std::vector<std::shared_ptr<std::vector<glm::mat4>>> _instance_3d_matrices;
+    IdTable<std::vector<unsigned int>> _prefab_members;
+    IdTable<unsigned int> _prefab_owners;
+    InstanceList<glm::mat4, InstanceTransform> _instance_3d_list;
+    InstanceOverrides _instance_overrides;
     InstanceList<glm::mat4> _instance_2d_list;
 
+    // Copied into the upload ring every frame, tiled forward lighting only runs while there are lights.
+    std::vector<PointLight> _point_lights;
+    std::vector<SpotLight> _spot_lights;
+    std::vector<DirectionalLight> _directional_lights;
+    // Area lights and their tree only change with the scene, so they live in buffers of their own that are replaced
+    // when they do. The tree of new lights is built by the next frame before anything reads it.
+    std::vector<AreaLight> _area_lights;
+    id<MTLBuffer> _area_light_buffer = nil;
+    id<MTLBuffer> _light_tree = nil;
+    bool _light_tree_dirty = false;
+    // Written by cull_lights and read by the main pass, GPU-only and shared by all frames.
+    id<MTLBuffer> _tile_lights = nil;
+
+    // Shadow maps are shared by all frames and keep their contents between frames, a view is only redrawn when its
+    // light matrix changed or a caster moved within it.
+    float _shadow_distance = 0.0f;
+    id<MTLTexture> _cascade_shadows = nil;
+    id<MTLTexture> _spot_shadows = nil;
+    std::array<ShadowView, SHADOW_CASCADES> _cascade_views;
+    std::array<ShadowView, MAX_SPOT_SHADOWS> _spot_views;
+    // World bounds of the instances of every mesh flagged SHADOW_CASTER.
+    IdTable<Aabb> _shadow_casters;
+    std::vector<unsigned int> _moved_casters;
+    // World bounds casters moved from or to since the shadow views were last updated.
+    std::vector<Aabb> _shadow_dirty_bounds;
+    // Clears a tile of the spot shadow atlas to the far plane.
+    id<MTLRenderPipelineState> _shadow_clear_state = nil;
+    id<MTLDepthStencilState> _depth_state_clear = nil;
+    // Depth16Unorm shadow maps take half the memory and bandwidth, their casters are drawn with variants of the
+    // depth-only states that are compiled when they are first enabled.
+    bool _unorm16_shadows = false;
+    Pipelines3D _unorm16_shadow_state_3d;
+    Pipelines3D _unorm16_position_shadow_state_3d;
+    id<MTLRenderPipelineState> _unorm16_shadow_clear_state = nil;
+    std::vector<PipelineVariant> _unorm16_shadow_pipelines;
+
+    // Shadows of the first directional light and ambient occlusion are traced against the full-format meshes, per
+    // pixel of the pre-pass depth. Traced shadows replace the cascades. GPUs without ray tracing support trace all rays
+    // against the compute BVH instead of the acceleration structures.
+    bool _ray_tracing_supported = false;
+    bool _hardware_tracing = false;
+    bool _ray_tracing = false;
+    float _ao_radius = 1.0f;
+    AccelerationStructures _acceleration_structures;
+    BvhScene _bvh_scene;
+    id<MTLComputePipelineState> _trace_state = nil;
+    // Distance fields take the place of ray tracing where it is disabled, see set_sdf_tracing.
+    SdfSettings _sdf_settings = {};
+    SdfScene _sdf_scene;
+    id<MTLComputePipelineState> _sdf_trace_state = nil;
+    // Ray queries wait for the next frame, which builds the acceleration structures for them if nothing else does.
+    struct RayQueryRequest
+    {
+        std::vector<RayQuery> rays;
+        bool any_hit;
+        RayQueryCallback callback;
+        void *user_data;
+    };
+    std::vector<RayQueryRequest> _ray_queries;
+    id<MTLComputePipelineState> _ray_query_state = nil;
+    // PVS bakes trace the next cells of the first one every frame, into hit bits of the traced instances that are kept
+    // until its last cell. A change in the number of traced instances starts it over.
+    struct PvsBake
+    {
+        PvsSettings settings;
+        glm::uvec3 cells;
+        unsigned int next_cell = 0;
+        unsigned int num_traced = 0;
+        id<MTLBuffer> hits = nil;
+        PvsCallback callback;
+        void *user_data;
+    };
+    std::vector<PvsBake> _pvs_bakes;
+    id<MTLComputePipelineState> _pvs_bake_state = nil;
+    // Set of the camera's cell, which invalidates the unculled draw commands when it changes.
+    PotentiallyVisibleSet _pvs;
+    unsigned int _pvs_cell = PotentiallyVisibleSet::NO_CELL;
+    // Shadow in x and occlusion in y, shared by all frames.
+    id<MTLTexture> _ray_traced = nil;
+    // Shows the traced occlusion for RENDER_SSAO.
+    id<MTLRenderPipelineState> _ambient_occlusion_state = nil;
+    // Screen space occlusion where none is traced, in x with the distance to the camera in y. The blur writes rows
+    // into an intermediate texture and its columns back into the occlusion, both are transient textures of the frame.
+    bool _ssao = false;
+    id<MTLComputePipelineState> _ssao_state = nil;
+    id<MTLComputePipelineState> _ssao_blur_state = nil;
+    PathTracer _path_tracer;
+    // Replaces the ambient light of the rasterized views inside its volume on GPUs that support ray tracing.
+    IrradianceVolume _gi;
+    Reflections _reflections;
+
+    // Equirectangular skybox drawn where there is no geometry. It is prefiltered into the environment map and
+    // irradiance once when it is set, they light the scene in place of the constant ambient light. Placeholders are
+    // bound while there is no skybox.
+    id<MTLTexture> _skybox = nil;
+    id<MTLTexture> _environment = nil;
+    id<MTLBuffer> _irradiance = nil;
+    id<MTLRenderPipelineState> _skybox_state = nil;
+    id<MTLRenderPipelineState> _skybox_state_msaa = nil;
+    id<MTLComputePipelineState> _prefilter_environment_state = nil;
+    id<MTLComputePipelineState> _project_irradiance_state = nil;
+
+    // Lines of the debug draw API, drawn at the end of the main pass. The deferred pass draws them with its G-buffer
+    // attachments, which only GPUs with tile memory have.
+    DebugDraw _debug_draw;
+    id<MTLRenderPipelineState> _debug_line_state = nil;
+    id<MTLRenderPipelineState> _debug_line_state_msaa = nil;
+    id<MTLRenderPipelineState> _debug_line_state_deferred = nil;
+
+    // Reflection probes and their faces that are baked again, one bit per face. Faces are baked in order and always
+    // dirtied together, so the dirty faces of a probe are its last ones. Probes keep the reflections of their last
+    // bake until all faces were baked again. Changed meshes dirty the probes around where they were when probes last
+    // saw them and where they are now.
+    std::vector<ReflectionProbe> _probes;
+    std::vector<unsigned int> _probe_dirty_faces;
+    std::vector<bool> _probe_baked;
+    unsigned int _probe_budget = 1;
+    IdTable<Aabb> _probe_mesh_bounds;
+    std::vector<unsigned int> _probe_moved;
+    // Captured faces with a full mip chain for prefiltering, the prefiltered reflections, which are a 1x1 placeholder
+    // without probes, and the depth of the faces baked at once, memoryless with tile memory.
+    id<MTLTexture> _probe_captures = nil;
+    id<MTLTexture> _probe_maps = nil;
+    id<MTLTexture> _probe_depth = nil;
+    Pipelines3D _probe_state_3d;
+    id<MTLRenderPipelineState> _probe_background_state = nil;
+    id<MTLRenderPipelineState> _impostor_bake_state = nil;
+    id<MTLRenderPipelineState> _impostor_bake_packed_state = nil;
+    id<MTLComputePipelineState> _prefilter_probe_state = nil;
+
     std::vector<id<MTLTexture>> _textures;
+    // Every batch of new textures is placed in its own heap so a render pass makes them resident with a few calls,
+    // textures that did not fit a heap are tracked separately.
+    std::vector<id<MTLHeap>> _texture_heaps;
+    std::vector<id<MTLTexture>> _standalone_textures;
+    // Slots of packed textures show the fallback texture in the texture table and their layer in the layer table.
+    TextureArrays _texture_arrays;
+    std::vector<unsigned int> _texture_layers;
+    unsigned int _texture_packing = 256;
+    // Textures are uploaded on their own queue, they replace the fallback or their previous version in the texture
+    // table once the upload completed.
+    id<MTLCommandQueue> _upload_queue = nil;
+    id<MTLTexture> _fallback_texture = nil;
+    std::vector<PendingTexture> _pending_textures;
+    // Mesh and texture uploads past the upload budget of a frame are left to the next ones, see set_upload_budget().
+    UploadScheduler _uploads;
+    std::vector<DeferredTexture> _deferred_textures;
+    // Textures the caller is writing, and those committed that wait for the upload budget, see map_texture.
+    IdTable<MappedTexture> _mapped_textures;
+    std::vector<MappedTexture> _committed_textures;
+    bool _gpu_mipmaps = false;
+    bool _texture_transcoding = false;
+    bool _lossy_textures = false;
+    // Slots showing video frames, see set_video_frame.
+    VideoTextures _video;
+    id<MTLRenderPipelineState> _video_frame_state = nil;
+
+    // Slots showing views of the scene, see set_render_texture. They are drawn with the states of the probe faces and
+    // the skybox fills their background.
+    RenderTextures _render_textures;
+    size_t _render_texture_budget = 1024 * 1024;
+    id<MTLRenderPipelineState> _render_texture_background_state = nil;
+    // Encoder of the frames while a video stream runs, see start_video_stream.
+    VideoStream _video_stream;
+#ifdef RFW_METAL_IO
+    // Asset files are read on a queue per AssetPriority, their handles stay open for later loads.
+    std::array<id<MTLIOCommandQueue>, 3> _io_queues API_AVAILABLE(macos(13.0)) = {};
+    std::map<std::pair<std::string, AssetCompression>, id<MTLIOFileHandle>> _io_files API_AVAILABLE(macos(13.0));
+#endif
+    // Textures set with more than one mip level while a texture budget is set only upload their levels up to
+    // STREAMED_TAIL_SIZE, finer levels stream in when texture LOD feedback asks for them. Levels no frame asked for
+    // during a whole feedback period are evicted once the streamed levels exceed the budget. Texture generations
+    // change with the resident levels of streamed textures.
+    static constexpr unsigned int STREAMED_TAIL_SIZE = 256;
+    static constexpr unsigned int TEXTURE_FEEDBACK_PERIOD = TEXTURE_FEEDBACK_BLOCK * TEXTURE_FEEDBACK_BLOCK;
+    static constexpr size_t MAX_STREAMED_BYTES_PER_FRAME = 32 * 1024 * 1024;
+    size_t _texture_budget = 0;
+    std::vector<StreamedTexture> _streamed_textures;
+    unsigned int _num_streamed_textures = 0;
+    unsigned int _feedback_frame = 0;
+    unsigned int _texture_generation = 0;
+    // Virtual textures bind the tile cache in their slots, up to _virtual_upload_bytes of wanted tiles load per frame.
+    // Tiles no frame requested for VIRTUAL_IDLE_FRAMES are evicted for wanted ones.
+    static constexpr unsigned int VIRTUAL_IDLE_FRAMES = 2 * TEXTURE_FEEDBACK_PERIOD;
+    VirtualTextures _virtual;
+    id<MTLTexture> _virtual_cache = nil;
+    size_t _virtual_cache_bytes = 64 * 1024 * 1024;
+    size_t _virtual_upload_bytes = 4 * 1024 * 1024;
+    unsigned int _virtual_layout = 0;
+
+    // Meshes are evicted by the last frame they had instances in.
+    bool _memory_policy_set = false;
+    MemoryPolicy _memory_policy = {};
+    MeshEvictionCallback _eviction_callback = nullptr;
+    // Streaming cells of the world partition, placed around the camera of the last frame.
+    CellStreamer _cells;
+    CellStreamingCallback _cell_callback = nullptr;
+    void *_cell_user_data = nullptr;
+    void *_eviction_user_data = nullptr;
+    IdTable<uint64_t> _mesh_drawn_frames;
+    uint64_t _frames_rendered = 0;
+    // Signalled with the number of every frame once the GPU completed it.
+    id<MTLSharedEvent> _frame_event = nil;
+    MTLSharedEventListener *_frame_listener = nil;
+    unsigned int _evicted_meshes = 0;
+    unsigned int _evicted_textures = 0;
+    // Unloaded full-format meshes by id and replaced standalone textures by the hash of their data, until the OS
+    // reclaims them. Heap textures share the purgeable state of their heap, so they are never cached.
+    PurgeableCache<unsigned int, CachedMesh> _mesh_cache;
+    PurgeableCache<size_t, bool> _texture_cache;
+    std::vector<size_t> _texture_keys;
+    std::unordered_map<size_t, TextureContents> _texture_contents;
+    // Meshes and textures with the same contents share one range or texture, see set_deduplication().
+    bool _deduplicate = false;
+#ifdef RFW_METAL_RESIDENCY_SETS
+    // Keeps all textures resident on the queue, render passes then don't need to declare them at all.
+    id<MTLResidencySet> _texture_residency = nil;
+#endif
+    StagingBuffer _staging;
+
+    // Threads the 3D draws of the pre-pass and main pass are encoded on with a parallel render encoder.
+    unsigned int _encoding_threads = 1;
 
     unsigned int _flags = Flags::None;
+    unsigned int _vertex_compaction_budget = 0;
 };
 #endif
\ No newline at end of file
@@ -1,10 +1,17 @@
-#import <AppKit/AppKit.h>
-
 #include "renderer.hpp"
 
+#include <algorithm>
 #include <cassert>
+#include <cstddef>
 #include <cstring>
 #include <filesystem>
+#include <fstream>
+#include <limits>
+#include <map>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
 
 #include <glm/ext.hpp>
 #include <glm/glm.hpp>
@@ -13,24 +20,27 @@
 
 using namespace glm;
 
-mat4 get_rh_matrix(const CameraView3D &view)
+// Reversed depth with an infinite far plane, the near plane is at a depth of 1 and depth falls to 0 with the inverse of
+// the distance, which the exponent of float depth keeps precise all the way out. Depth tests pass greater depths.
+mat4 get_rh_projection_matrix(const CameraView3D &view)
 {
     const float width = 1.0f / view.inv_width;
     const float height = 1.0f / view.inv_height;
+    const float focal = 1.0f / std::tan(0.5f * view.fov);
+    mat4 projection(0.0f);
+    projection[0][0] = focal * height / width;
+    projection[1][1] = focal;
+    projection[2][3] = -1.0f;
+    projection[3][2] = view.near_plane;
+    return projection;
+}
 
+mat4 get_rh_matrix(const CameraView3D &view)
+{
     const vec3 pos = vec3(view.pos.x, view.pos.y, view.pos.z);
     const vec3 direction = vec3(view.direction.x, view.direction.y, view.direction.z);
     const vec3 up = vec3(0, 1, 0);
-    const mat4 projection = perspectiveFovRH(view.fov, width, height, view.near_plane, view.far_plane);
-    const mat4 v = lookAtRH(pos, pos + direction, up);
-    return projection * v;
-}
-
-mat4 get_rh_projection_matrix(const CameraView3D &view)
-{
-    const float width = 1.0f / view.inv_width;
-    const float height = 1.0f / view.inv_height;
-    return perspectiveFovRH(view.fov, width, height, view.near_plane, view.far_plane);
+    return get_rh_projection_matrix(view) * lookAtRH(pos, pos + direction, up);
 }
 
 mat4 get_rh_view_matrix(const CameraView3D &view)
@@ -41,23 +51,401 @@ mat4 get_rh_view_matrix(const CameraView3D &view)
     return lookAtRH(pos, pos + direction, up);
 }
 
+// View matrix of positions relative to the camera position, which only rotates them.
+mat4 get_rh_view_rotation(const CameraView3D &view)
+{
+    const vec3 direction = vec3(view.direction.x, view.direction.y, view.direction.z);
+    const vec3 up = vec3(0, 1, 0);
+    return lookAtRH(vec3(0.0f), direction, up);
+}
+
+// Element index of the Halton sequence of base.
+float halton(unsigned int index, unsigned int base)
+{
+    float result = 0.0f;
+    float fraction = 1.0f;
+    while (index > 0)
+    {
+        fraction /= static_cast<float>(base);
+        result += fraction * static_cast<float>(index % base);
+        index /= base;
+    }
+    return result;
+}
+
+Aabb empty_bounds()
+{
+    return {simd_make_float4(1e30f, 1e30f, 1e30f, 0.0f), simd_make_float4(-1e30f, -1e30f, -1e30f, 0.0f)};
+}
+
+// Bounds of local transformed by every matrix, instances of meshes without valid bounds reach everywhere.
+Aabb world_bounds(const Aabb &local, const std::vector<mat4> &matrices)
+{
+    if (matrices.empty())
+        return empty_bounds();
+    if (simd_any(local.bmin.xyz > local.bmax.xyz) || simd_all(local.bmin.xyz == local.bmax.xyz))
+        return {simd_make_float4(-1e30f, -1e30f, -1e30f, 0.0f), simd_make_float4(1e30f, 1e30f, 1e30f, 0.0f)};
+
+    const vec3 lo_local = vec3(local.bmin.x, local.bmin.y, local.bmin.z);
+    const vec3 hi_local = vec3(local.bmax.x, local.bmax.y, local.bmax.z);
+    const vec3 center = (lo_local + hi_local) * 0.5f;
+    const vec3 extent = (hi_local - lo_local) * 0.5f;
+    vec3 lo = vec3(1e30f);
+    vec3 hi = vec3(-1e30f);
+    for (const mat4 &m : matrices)
+    {
+        const vec3 c = vec3(m * vec4(center, 1.0f));
+        const vec3 e = abs(vec3(m[0])) * extent.x + abs(vec3(m[1])) * extent.y + abs(vec3(m[2])) * extent.z;
+        lo = min(lo, c - e);
+        hi = max(hi, c + e);
+    }
+    return {simd_make_float4(lo.x, lo.y, lo.z, 0.0f), simd_make_float4(hi.x, hi.y, hi.z, 0.0f)};
+}
+
+// Packs what shaders read of material, the sampler is clamped to the table and maps without a texture id of 16 bits
+// are left out of its flags.
+PackedMaterial pack_material(const DeviceMaterial &material, int lightmap)
+{
+    const auto map = [](int texture) {
+        return static_cast<unsigned short>(texture >= 0 && texture < NO_MATERIAL_MAP ? texture : NO_MATERIAL_MAP);
+    };
+    const unsigned int rg = packHalf2x16(vec2(material.c_r, material.c_g));
+    const unsigned int ba = packHalf2x16(vec2(material.c_b, material.c_a));
+
+    PackedMaterial packed = {};
+    packed.c_r = static_cast<unsigned short>(rg & 0xFFFFu);
+    packed.c_g = static_cast<unsigned short>(rg >> 16u);
+    packed.c_b = static_cast<unsigned short>(ba & 0xFFFFu);
+    packed.c_a = static_cast<unsigned short>(ba >> 16u);
+    packed.params = material.params_x;
+    packed.diffuse_map = map(material.diffuse_map);
+    packed.normal_map = map(material.normal_map);
+    packed.metallic_roughness_map = map(material.metallic_roughness_map);
+    packed.emissive_map = map(material.emissive_map);
+    packed.lightmap_map = map(lightmap);
+    packed.sampler = static_cast<unsigned short>(std::min(material.sampler, SAMPLER_COUNT - 1u));
+
+    packed.flags = material.flags;
+    if (packed.diffuse_map == NO_MATERIAL_MAP)
+        packed.flags &= ~HAS_DIFFUSE_MAP;
+    if (packed.normal_map == NO_MATERIAL_MAP)
+        packed.flags &= ~HAS_NORMAL_MAP;
+    if (packed.metallic_roughness_map == NO_MATERIAL_MAP)
+        packed.flags &= ~HAS_METAL_ROUGH_MAP;
+    if (packed.emissive_map == NO_MATERIAL_MAP)
+        packed.flags &= ~HAS_EMISSIVE_MAP;
+    return packed;
+}
+
+// Every GPU of the system, iOS devices only have the default one.
+NSArray<id<MTLDevice>> *all_devices()
+{
+#if TARGET_OS_IPHONE
+    id<MTLDevice> device = MTLCreateSystemDefaultDevice();
+    return device != nil ? @[ device ] : @[];
+#else
+    return MTLCopyAllDevices();
+#endif
+}
+
+// Highest refresh rate of the display that shows window, 0 when it isn't known.
+double display_refresh_rate(PlatformWindow *window)
+{
+#if TARGET_OS_IPHONE
+    UIScreen *screen = window.window.screen;
+    return screen != nil ? static_cast<double>(screen.maximumFramesPerSecond) : 0.0;
+#else
+    if (@available(macOS 12.0, *))
+    {
+        NSScreen *screen = window.screen;
+        return screen != nil ? static_cast<double>(screen.maximumFramesPerSecond) : 0.0;
+    }
+    return 0.0;
+#endif
+}
+
+// Headroom above SDR white of the display that shows window, 1 without EDR.
+float display_headroom(PlatformWindow *window)
+{
+#if TARGET_OS_IPHONE
+    if (@available(iOS 16.0, *))
+    {
+        UIScreen *screen = window.window.screen;
+        if (screen != nil)
+            return static_cast<float>(screen.currentEDRHeadroom);
+    }
+    return 1.0f;
+#else
+    NSScreen *screen = window.screen;
+    return screen != nil ? static_cast<float>(screen.maximumExtendedDynamicRangeColorComponentValue) : 1.0f;
+#endif
+}
+
+// Pixel formats of the G-buffer attachments GBUFFER_ALBEDO_INDEX to GBUFFER_DEPTH_INDEX.
+constexpr MTLPixelFormat GBUFFER_FORMATS[] = {MTLPixelFormatRGBA8Unorm, MTLPixelFormatRGBA16Float,
+                                              MTLPixelFormatR32Float};
+
+void set_gbuffer_formats(MTLRenderPipelineDescriptor *desc, bool enabled)
+{
+    for (unsigned int i = 0; i < 3; i++)
+    {
+        const MTLPixelFormat format = enabled ? GBUFFER_FORMATS[i] : MTLPixelFormatInvalid;
+        desc.colorAttachments[GBUFFER_ALBEDO_INDEX + i].pixelFormat = format;
+    }
+}
+
+// Transparent layers add their weighted color to the accumulation and multiply the revealed background by 1 - alpha.
+void set_transparency_formats(MTLRenderPipelineDescriptor *desc, bool enabled)
+{
+    MTLRenderPipelineColorAttachmentDescriptor *accum = desc.colorAttachments[TRANSPARENT_ACCUM_INDEX];
+    accum.pixelFormat = enabled ? MTLPixelFormatRGBA16Float : MTLPixelFormatInvalid;
+    accum.blendingEnabled = enabled;
+    accum.sourceRGBBlendFactor = MTLBlendFactorOne;
+    accum.sourceAlphaBlendFactor = MTLBlendFactorOne;
+    accum.destinationRGBBlendFactor = MTLBlendFactorOne;
+    accum.destinationAlphaBlendFactor = MTLBlendFactorOne;
+
+    MTLRenderPipelineColorAttachmentDescriptor *reveal = desc.colorAttachments[TRANSPARENT_REVEAL_INDEX];
+    reveal.pixelFormat = enabled ? MTLPixelFormatR16Float : MTLPixelFormatInvalid;
+    reveal.blendingEnabled = enabled;
+    reveal.sourceRGBBlendFactor = MTLBlendFactorZero;
+    reveal.sourceAlphaBlendFactor = MTLBlendFactorZero;
+    reveal.destinationRGBBlendFactor = MTLBlendFactorOneMinusSourceColor;
+    reveal.destinationAlphaBlendFactor = MTLBlendFactorOneMinusSourceColor;
+}
+
+// Acquires drawables of the layer on a queue of its own, so render can stop waiting for one and keep it for the next
+// frame once it arrives. Drawables of a previous drawable size are dropped.
+@interface RfwDrawableQueue : NSObject
+- (instancetype)initWithLayer:(CAMetalLayer *)layer;
+- (id<CAMetalDrawable>)nextDrawable:(double)timeout;
+@end
+
+@implementation RfwDrawableQueue
+{
+    CAMetalLayer *_layer;
+    dispatch_queue_t _queue;
+    NSCondition *_condition;
+    id<CAMetalDrawable> _drawable;
+    bool _pending;
+}
+
+- (instancetype)initWithLayer:(CAMetalLayer *)layer
+{
+    if ((self = [super init]))
+    {
+        _layer = layer;
+        _queue = dispatch_queue_create("rfw drawables", DISPATCH_QUEUE_SERIAL);
+        _condition = [[NSCondition alloc] init];
+        _pending = false;
+    }
+    return self;
+}
+
+- (id<CAMetalDrawable>)nextDrawable:(double)timeout
+{
+    const CGSize size = _layer.drawableSize;
+    NSDate *deadline = [NSDate dateWithTimeIntervalSinceNow:timeout];
+    [_condition lock];
+    if (_drawable != nil && (_drawable.texture.width != size.width || _drawable.texture.height != size.height))
+        _drawable = nil;
+    if (_drawable == nil && !_pending)
+    {
+        _pending = true;
+        CAMetalLayer *layer = _layer;
+        NSCondition *condition = _condition;
+        __weak RfwDrawableQueue *weak_self = self;
+        dispatch_async(_queue, ^{
+          id<CAMetalDrawable> drawable = [layer nextDrawable];
+          [condition lock];
+          RfwDrawableQueue *queue = weak_self;
+          if (queue != nil)
+          {
+              queue->_drawable = drawable;
+              queue->_pending = false;
+          }
+          [condition signal];
+          [condition unlock];
+        });
+    }
+    while (_drawable == nil && _pending && [_condition waitUntilDate:deadline])
+        ;
+    id<CAMetalDrawable> drawable = _drawable;
+    _drawable = nil;
+    [_condition unlock];
+    return drawable;
+}
+@end
+
+#ifdef RFW_DISPLAY_LINK
+// Display link of the layer, running on its own thread so the drawables it hands out do not wait for the main run loop.
+// The render thread takes the latest drawable, older ones are dropped unpresented.
+API_AVAILABLE(macos(14.0))
+@interface RfwDisplayLink : NSObject <CAMetalDisplayLinkDelegate>
+- (instancetype)initWithLayer:(CAMetalLayer *)layer;
+- (void)setFrameRateRange:(CAFrameRateRange)range latency:(NSInteger)latency;
+- (id<CAMetalDrawable>)nextDrawable:(double)timeout;
+- (void)stop;
+@end
+
+@implementation RfwDisplayLink
+{
+    CAMetalDisplayLink *_link;
+    NSThread *_thread;
+    NSCondition *_condition;
+    id<CAMetalDrawable> _drawable;
+}
+
+- (instancetype)initWithLayer:(CAMetalLayer *)layer
+{
+    if ((self = [super init]))
+    {
+        _condition = [[NSCondition alloc] init];
+        _link = [[CAMetalDisplayLink alloc] initWithMetalLayer:layer];
+        _link.delegate = self;
+        _thread = [[NSThread alloc] initWithTarget:self selector:@selector(run) object:nil];
+        _thread.name = @"rfw display link";
+        _thread.qualityOfService = NSQualityOfServiceUserInteractive;
+        [_thread start];
+    }
+    return self;
+}
+
+- (void)run
+{
+    [_link addToRunLoop:NSRunLoop.currentRunLoop forMode:NSDefaultRunLoopMode];
+    while (!NSThread.currentThread.isCancelled)
+        [NSRunLoop.currentRunLoop runMode:NSDefaultRunLoopMode beforeDate:NSDate.distantFuture];
+}
+
+- (void)setFrameRateRange:(CAFrameRateRange)range latency:(NSInteger)latency
+{
+    _link.preferredFrameRateRange = range;
+    _link.preferredFrameLatency = static_cast<float>(latency);
+}
+
+- (void)metalDisplayLink:(CAMetalDisplayLink *)link needsUpdate:(CAMetalDisplayLinkUpdate *)update
+{
+    [_condition lock];
+    _drawable = update.drawable;
+    [_condition signal];
+    [_condition unlock];
+}
+
+- (id<CAMetalDrawable>)nextDrawable:(double)timeout
+{
+    NSDate *deadline = [NSDate dateWithTimeIntervalSinceNow:timeout];
+    [_condition lock];
+    while (_drawable == nil && [_condition waitUntilDate:deadline])
+        ;
+    id<CAMetalDrawable> drawable = _drawable;
+    _drawable = nil;
+    [_condition unlock];
+    return drawable;
+}
+
+- (void)invalidateLink
+{
+    [_link invalidate];
+    _link = nil;
+}
+
+- (void)stop
+{
+    // The link is invalidated on its own thread, after which the run loop has no sources left and returns.
+    [_thread cancel];
+    [self performSelector:@selector(invalidateLink) onThread:_thread withObject:nil waitUntilDone:NO];
+}
+@end
+#endif
+
 MetalRenderer *MetalRenderer::create_instance(void *ns_window, void *ns_view, unsigned int width, unsigned int height,
-                                              double scale)
+                                              double scale, const char *pipeline_cache, DevicePreference preference)
 {
-    NSArray<id<MTLDevice>> *devices = MTLCopyAllDevices();
     id<MTLDevice> device = nil;
+#if !TARGET_OS_IPHONE
+    NSWindow *window = (__bridge NSWindow *)ns_window;
+    if (preference == DEVICE_DISPLAY && window.screen != nil)
+    {
+        NSNumber *display = window.screen.deviceDescription[@"NSScreenNumber"];
+        device = CGDirectDisplayCopyCurrentMetalDevice(display.unsignedIntValue);
+    }
+
+    NSArray<id<MTLDevice>> *devices = MTLCopyAllDevices();
     for (id<MTLDevice> dev in devices)
     {
-        if (!dev.lowPower)
+        if (preference == DEVICE_DISPLAY && device != nil)
+            break;
+
+        bool preferred = false;
+        switch (preference)
+        {
+        case DEVICE_DISCRETE:
+            preferred = !dev.lowPower && !dev.removable;
+            break;
+        case DEVICE_LOW_POWER:
+            preferred = dev.lowPower;
+            break;
+        case DEVICE_REMOVABLE:
+            preferred = dev.removable;
+            break;
+        case DEVICE_LARGEST_WORKING_SET:
+            preferred = device == nil || dev.recommendedMaxWorkingSetSize > device.recommendedMaxWorkingSetSize;
+            break;
+        default:
+            preferred = !dev.lowPower;
+            break;
+        }
+        if (preferred)
             device = dev;
     }
+#endif
 
     if (device == nil)
         device = MTLCreateSystemDefaultDevice();
 
     if (!device)
         return nullptr;
-    return new MetalRenderer(device, ns_window, ns_view, width, height, scale);
+    return new MetalRenderer(device, ns_window, ns_view, width, height, scale, pipeline_cache);
+}
+
+MetalRenderer *MetalRenderer::create_instance_on_device(unsigned int device_index, void *ns_window, void *ns_view,
+                                                        unsigned int width, unsigned int height, double scale,
+                                                        const char *pipeline_cache)
+{
+    NSArray<id<MTLDevice>> *devices = all_devices();
+    if (device_index >= devices.count)
+        return nullptr;
+    return new MetalRenderer(devices[device_index], ns_window, ns_view, width, height, scale, pipeline_cache);
+}
+
+unsigned int MetalRenderer::device_count()
+{
+    return static_cast<unsigned int>(all_devices().count);
+}
+
+bool MetalRenderer::device_info(unsigned int device_index, DeviceInfo *info)
+{
+    NSArray<id<MTLDevice>> *devices = all_devices();
+    if (device_index >= devices.count)
+        return false;
+
+    id<MTLDevice> device = devices[device_index];
+    *info = {};
+    strlcpy(info->name, device.name.UTF8String, sizeof(info->name));
+    info->registry_id = device.registryID;
+    info->recommended_working_set = device.recommendedMaxWorkingSetSize;
+#if !TARGET_OS_IPHONE
+    info->low_power = device.lowPower ? 1 : 0;
+    info->removable = device.removable ? 1 : 0;
+#endif
+    if (@available(macOS 10.15, *))
+    {
+        info->peer_group_id = device.peerGroupID;
+        info->peer_index = device.peerIndex;
+        info->peer_count = device.peerCount;
+    }
+    return true;
 }
 
 #define MTL_ERROR(x)                                                                                                   \
@@ -69,10 +457,68 @@ MetalRenderer *MetalRenderer::create_instance(void *ns_window, void *ns_view, un
 
 MetalRenderer::~MetalRenderer()
 {
+#if !TARGET_OS_IPHONE
+    if (_device_observer != nil)
+        MTLRemoveDeviceObserver(_device_observer);
+#endif
+    _pipelines.wait();
+    wait_for_synchronize();
+    acquire_all_frames();
+    release_all_frames();
+#ifdef RFW_DISPLAY_LINK
+    if (@available(macOS 14.0, *))
+    {
+        [_display_link stop];
+        _display_link = nil;
+    }
+#endif
+    _staging.release();
+
     _layer = nil;
     _queue = nil;
-    _state = nil;
-    _state_2d = nil;
+    _state_3d = Pipelines3D();
+    _prepass_state_3d = Pipelines3D();
+    _light_cull_state = nil;
+    _light_tree_keys_state = nil;
+    _build_light_tree_state = nil;
+    _primitives.release();
+    _instance_bvh.release();
+    _sdf_scene.release();
+    _sdf_trace_state = nil;
+    _skinning_state = nil;
+    _animate_skins_state = nil;
+    _animate_instances_state = nil;
+    _scatter_hierarchy_state = nil;
+    _propagate_hierarchy_state = nil;
+    _emit_particles_state = nil;
+    _prepare_particles_state = nil;
+    _simulate_particles_state = nil;
+    _finish_particles_state = nil;
+    _generate_terrain_state = nil;
+    _scatter_instances_state = nil;
+    _particle_state = nil;
+    _cull_state = nil;
+    _occlusion_cull_state = nil;
+    _bvh_cull_state = nil;
+    _bvh_occlusion_cull_state = nil;
+    _depth_pyramid_init_state = nil;
+    _depth_pyramid_state = nil;
+    _depth_pyramid = nil;
+    _depth_pyramid_levels.clear();
+    _encode_draws_state = nil;
+    _encode_culled_draws_state = nil;
+    _culled_draw_keys_state = nil;
+    _cull_clusters_state = nil;
+    _cull_skinned_state = nil;
+    _draw_commands = nil;
+    _states_2d = {};
+    _gbuffer_state_3d = Pipelines3D();
+    _deferred_states = {};
+    _states_2d_deferred = {};
+    _gbuffer = {};
+    _cascade_shadows = nil;
+    _spot_shadows = nil;
+    _shadow_clear_state = nil;
     _library = nil;
     _depth_texture = nil;
     _depth_state = nil;
@@ -80,57 +526,471 @@ MetalRenderer::~MetalRenderer()
 }
 
 MetalRenderer::MetalRenderer(id<MTLDevice> device, void *ns_window, void *, unsigned int width, unsigned int height,
-                             double scale)
-    : _device(device), _uniforms(device, 1), _materials(device, 32), _camera(device, 1), _instance_3d_list(device),
-      _instance_2d_list(device)
+                             double scale, const char *pipeline_cache)
+    : _device(device), _upload_ring(device, 4 * 1024 * 1024, DEFAULT_FRAMES_IN_FLIGHT),
+      _instance_3d_list(device, DEFAULT_FRAMES_IN_FLIGHT), _instance_overrides(device, DEFAULT_FRAMES_IN_FLIGHT),
+      _instance_2d_list(device, DEFAULT_FRAMES_IN_FLIGHT), _glyph_list(device, DEFAULT_FRAMES_IN_FLIGHT),
+      _sprite_list(device, DEFAULT_FRAMES_IN_FLIGHT)
 {
     NSLog(@"Picked Metal device %@", [_device name]);
-
-    _layer = [CAMetalLayer layer];
-    _layer.device = _device;
-    _layer.pixelFormat = MTLPixelFormatBGRA8Unorm;
-    _layer.presentsWithTransaction = false;
-    _layer.displaySyncEnabled = false;
-    _layer.maximumDrawableCount = 3;
-
-    NSWindow *window = (__bridge NSWindow *)ns_window;
-    window.contentView.wantsLayer = YES;
-    window.contentView.layer = _layer;
+    _upload_ring.set_retired(&_retired);
 
     const auto scale_f = static_cast<float>(scale);
-    _layer.drawableSize = CGSizeMake(static_cast<float>(width) * scale_f, static_cast<float>(height) * scale_f);
+    const CGSize size = CGSizeMake(static_cast<float>(width) * scale_f, static_cast<float>(height) * scale_f);
+    _surfaces.resize(1);
+    if (ns_window)
+    {
+        PlatformWindow *window = (__bridge PlatformWindow *)ns_window;
+        _window = window;
+        _layer = attach_layer(window, size);
+    }
+    else
+    {
+        _layer = nil;
+        _offscreen_size = size;
+    }
 
     _queue = [_device newCommandQueue];
-    _sem = dispatch_semaphore_create(1);
+    _frame_event = [_device newSharedEvent];
+    _frame_event.label = @"Frames";
+    _frame_listener = [[MTLSharedEventListener alloc]
+        initWithDispatchQueue:dispatch_queue_create("rfw frame listener", DISPATCH_QUEUE_SERIAL)];
+    _upload_queue = [_device newCommandQueue];
+    _upload_queue.label = @"TextureUploads";
+
+    // External GPUs announce their removal, resources can't move to another GPU so the status is only reported.
+#if !TARGET_OS_IPHONE
+    const uint64_t registry_id = _device.registryID;
+    std::atomic<unsigned int> *device_status = &_device_status;
+    MTLCopyAllDevicesWithObserver(&_device_observer, ^(id<MTLDevice> device, MTLDeviceNotificationName name) {
+      if (device.registryID != registry_id)
+          return;
+      if ([name isEqualToString:MTLDeviceWasRemovedNotification])
+          device_status->store(DEVICE_REMOVED);
+      else if ([name isEqualToString:MTLDeviceRemovalRequestedNotification])
+      {
+          unsigned int ok = DEVICE_OK;
+          device_status->compare_exchange_strong(ok, DEVICE_REMOVAL_REQUESTED);
+      }
+    });
+#endif
+    _sem = dispatch_semaphore_create(DEFAULT_FRAMES_IN_FLIGHT);
+    _frames.resize(DEFAULT_FRAMES_IN_FLIGHT);
+    _frame_timer.init(_device, DEFAULT_FRAMES_IN_FLIGHT);
+    _frame_timer.set_trace(&_trace);
+    _mesh_profiler.init(_device);
+    _gpu_capture.configure_from_environment();
+    if (PerformanceHud::enabled_by_environment())
+        _hud.set_enabled(_device, true);
+#if TARGET_OS_IPHONE
+    // Phones and tablets throttle under sustained load, their quality follows the thermal state from the start.
+    _quality.set_enabled(true);
+#endif
+
+    // Uploads are committed separately from the frames, their GPU time is added to the next completed frame.
+    FrameTimer *timer = &_frame_timer;
+    const MTLCommandBufferHandler upload_handler = ^(id<MTLCommandBuffer> command_buffer) {
+      timer->add_upload(command_buffer);
+    };
+    _staging.set_completed_handler(upload_handler);
+    _vertex_3d_list.set_upload_handler(upload_handler);
+    _packed_3d_list.set_upload_handler(upload_handler);
+    _vertex_2d_list.set_upload_handler(upload_handler);
 
     MTLCompileOptions *options = [[MTLCompileOptions alloc] init];
     options.fastMathEnabled = YES;
     options.languageVersion = MTLLanguageVersion2_3;
 
-    dispatch_data_t data = dispatch_data_create(cpp_src_shaders_metallib, cpp_src_shaders_metallib_len, nil,
-                                                DISPATCH_DATA_DESTRUCTOR_DEFAULT);
+    // Memoryless attachments and reading them back in the fragment shader need the tile memory of Apple GPUs, their
+    // passes are only compiled into the library of the Apple family.
+    if (@available(macOS 11.0, *))
+    {
+        _tile_memory = [_device supportsFamily:MTLGPUFamilyApple1];
+        _memoryless = [_device supportsFamily:MTLGPUFamilyApple1];
+    }
+
+    // Libraries are precompiled for every GPU family and read in place from the constant data of the binary, so only
+    // the pages of the library in use are ever loaded and none of it is copied.
+    const unsigned char *library_data = _tile_memory ? shaders_apple_metallib : shaders_mac2_metallib;
+    const size_t library_size = _tile_memory ? shaders_apple_metallib_len : shaders_mac2_metallib_len;
+    dispatch_data_t data = dispatch_data_create(library_data, library_size, nil, DISPATCH_DATA_DESTRUCTOR_NONE);
     NSError *err{nil};
     _library = [_device newLibraryWithData:data error:&err];
     MTL_ERROR(err);
 
+    // Capabilities are known right away, the states compiled for them are set up and compile in the background until
+    // the first synchronize or render. Archives are keyed by the library.
+    if (@available(macOS 10.15.4, *))
+    {
+        for (unsigned int count = MAX_INSET_VIEWS; count > 1 && _max_amplification == 1; count--)
+        {
+            if ([_device supportsVertexAmplificationCount:count])
+                _max_amplification = count;
+        }
+        _rate_maps_supported = [_device supportsRasterizationRateMapWithLayerCount:1];
+    }
+    // GPUs without ray tracing support traverse the compute BVH in the kernels that trace rays.
+    if (@available(macOS 11.0, *))
+    {
+        _ray_tracing_supported = true;
+        _hardware_tracing = [_device supportsRaytracing];
+    }
+    // Compute culling is slow on GPUs with tier 1 argument buffers, such as Intel ones, which cull on the CPU instead.
+    _cpu_culling = [_device argumentBuffersSupport] == MTLArgumentBuffersTier1;
+
+    _pipelines.open(_device, pipeline_cache, _tile_memory ? shaders_apple_metallib_key : shaders_mac2_metallib_key);
+    _pipelines.prepare(^{
+      create_pipelines();
+    });
+
+    // Render targets are created by the first frame, at the size it renders at.
+    _targets_dirty = true;
+
+    create_shadow_maps();
+
+    // Bound in place of textures whose upload did not complete yet.
+    const unsigned int white = 0xFFFFFFFFu;
+    TextureData fallback = {1, 1, 1, reinterpret_cast<const unsigned char *>(&white), sizeof(white), BGRA8};
+    _fallback_texture = [_device newTextureWithDescriptor:texture_descriptor(fallback, BGRA8, 1)];
+    _fallback_texture.label = @"FallbackTexture";
+    upload_texture(_fallback_texture, fallback);
+    _staging.flush();
+    update_texture_residency();
+
+    MTLTextureDescriptor *environment_desc =
+        [MTLTextureDescriptor textureCubeDescriptorWithPixelFormat:MTLPixelFormatRGBA16Float size:1 mipmapped:NO];
+    environment_desc.storageMode = MTLStorageModePrivate;
+    _environment = [_device newTextureWithDescriptor:environment_desc];
+    _irradiance = [_device newBufferWithLength:sizeof(IrradianceSH) options:MTLResourceStorageModePrivate];
+    create_probe_maps();
+
+    MTLDepthStencilDescriptor *depth_desc = [[MTLDepthStencilDescriptor alloc] init];
+    depth_desc.depthCompareFunction = MTLCompareFunctionGreater;
+    depth_desc.depthWriteEnabled = YES;
+    _depth_state = [_device newDepthStencilStateWithDescriptor:depth_desc];
+
+    depth_desc.depthCompareFunction = MTLCompareFunctionGreaterEqual;
+    depth_desc.depthWriteEnabled = NO;
+    _depth_state_prepassed = [_device newDepthStencilStateWithDescriptor:depth_desc];
+
+    depth_desc.depthCompareFunction = MTLCompareFunctionLess;
+    depth_desc.depthWriteEnabled = YES;
+    _standard_depth_state = [_device newDepthStencilStateWithDescriptor:depth_desc];
+
+    depth_desc.depthCompareFunction = MTLCompareFunctionAlways;
+    depth_desc.depthWriteEnabled = NO;
+    _depth_state_2d = [_device newDepthStencilStateWithDescriptor:depth_desc];
+
+    depth_desc.depthWriteEnabled = YES;
+    _depth_state_clear = [_device newDepthStencilStateWithDescriptor:depth_desc];
+}
+
+void MetalRenderer::create_pipelines()
+{
+    NSError *err{nil};
+    id<MTLFunction> fragment_3d = [_library newFunctionWithName:@"triangle_fragment"];
     MTLRenderPipelineDescriptor *desc = [MTLRenderPipelineDescriptor new];
-    desc.vertexFunction = [_library newFunctionWithName:@"triangle_vertex"];
-    desc.fragmentFunction = [_library newFunctionWithName:@"triangle_fragment"];
     desc.depthAttachmentPixelFormat = MTLPixelFormatDepth32Float;
     desc.inputPrimitiveTopology = MTLPrimitiveTopologyClassTriangle;
     desc.rasterizationEnabled = YES;
     desc.rasterSampleCount = 1;
     desc.label = @"3D-Pipeline";
-    desc.supportIndirectCommandBuffers = NO;
+    desc.supportIndirectCommandBuffers = YES;
+
+    desc.colorAttachments[0].blendingEnabled = NO;
+
+    // Culled variants read their instance index from the visible instance list written by cull_instances. States of
+    // the forward main pass keep their descriptor for a multisampled variant in msaa_state, states that write the
+    // scene color for the HDR format and depth-only states that draw shadows for a 16-bit variant in unorm16_state.
+    const auto create_3d_state = [&](NSString *vertex_function, bool culling, id<MTLFunction> fragment,
+                                     NSString *label, __strong id<MTLRenderPipelineState> *state,
+                                     __strong id<MTLRenderPipelineState> *msaa_state,
+                                     __strong id<MTLRenderPipelineState> *unorm16_state = nullptr) {
+        MTLFunctionConstantValues *constants = [MTLFunctionConstantValues new];
+        [constants setConstantValue:&culling type:MTLDataTypeBool atIndex:INSTANCE_CULLING_CONSTANT_INDEX];
+        desc.vertexFunction = [_library newFunctionWithName:vertex_function constantValues:constants error:&err];
+        MTL_ERROR(err);
+        desc.fragmentFunction = fragment;
+        desc.label = label;
+        _pipelines.create(desc, state);
+        if (desc.colorAttachments[0].pixelFormat == scene_format())
+            _scene_pipelines.push_back({[desc copy], state});
+        if (msaa_state)
+        {
+            _msaa_pipelines.push_back({[desc copy], msaa_state});
+            _msaa_pipelines.back().desc.label = [label stringByAppendingString:@"-MSAA"];
+        }
+        if (unorm16_state)
+        {
+            _unorm16_shadow_pipelines.push_back({[desc copy], unorm16_state});
+            _unorm16_shadow_pipelines.back().desc.label = [label stringByAppendingString:@"-Unorm16"];
+        }
+    };
+
+    const auto create_3d_states = [&](NSString *vertex, id<MTLFunction> fragment, NSString *prefix,
+                                      Pipelines3D &states, Pipelines3D *msaa_states = nullptr) {
+        NSString *packed = [vertex stringByAppendingString:@"_packed"];
+        NSString *skinned = [vertex stringByAppendingString:@"_skinned"];
+        create_3d_state(vertex, false, fragment, [NSString stringWithFormat:@"%@-Pipeline", prefix], &states.full,
+                        msaa_states ? &msaa_states->full : nullptr);
+        create_3d_state(packed, false, fragment, [NSString stringWithFormat:@"%@-Packed-Pipeline", prefix],
+                        &states.packed, msaa_states ? &msaa_states->packed : nullptr);
+        create_3d_state(vertex, true, fragment, [NSString stringWithFormat:@"%@-Culled-Pipeline", prefix],
+                        &states.culled, msaa_states ? &msaa_states->culled : nullptr);
+        create_3d_state(packed, true, fragment, [NSString stringWithFormat:@"%@-Packed-Culled-Pipeline", prefix],
+                        &states.packed_culled, msaa_states ? &msaa_states->packed_culled : nullptr);
+        create_3d_state(skinned, false, fragment, [NSString stringWithFormat:@"%@-Skinned-Pipeline", prefix],
+                        &states.skinned, msaa_states ? &msaa_states->skinned : nullptr);
+    };
 
     desc.colorAttachments[0].pixelFormat = MTLPixelFormatBGRA8Unorm;
+    create_3d_states(@"triangle_vertex", fragment_3d, @"3D", _state_3d, &_msaa_state_3d);
+
+    // Inset views draw into the drawable, their states are compiled again for the target format.
+    if (@available(macOS 10.15.4, *))
+        desc.maxVertexAmplificationCount = _max_amplification;
+    desc.supportIndirectCommandBuffers = NO;
+    id<MTLFunction> inset_fragment = [_library newFunctionWithName:@"inset_fragment"];
+    const auto create_inset_state = [&](NSString *vertex, NSString *label, __strong id<MTLRenderPipelineState> *state) {
+        desc.vertexFunction = [_library newFunctionWithName:vertex];
+        desc.fragmentFunction = inset_fragment;
+        desc.label = label;
+        _pipelines.create(desc, state);
+        _target_pipelines.push_back({[desc copy], state});
+    };
+    create_inset_state(@"inset_vertex", @"Inset-Pipeline", &_inset_state_3d.full);
+    create_inset_state(@"inset_vertex_packed", @"Inset-Packed-Pipeline", &_inset_state_3d.packed);
+    create_inset_state(@"inset_vertex_skinned", @"Inset-Skinned-Pipeline", &_inset_state_3d.skinned);
+    // Reflection probe faces are drawn into layers of the probe captures, amplified like the inset views.
+    desc.colorAttachments[0].pixelFormat = MTLPixelFormatRGBA16Float;
+    const auto create_probe_state = [&](NSString *vertex, id<MTLFunction> fragment, NSString *label,
+                                        __strong id<MTLRenderPipelineState> *state) {
+        desc.vertexFunction = [_library newFunctionWithName:vertex];
+        desc.fragmentFunction = fragment;
+        desc.label = label;
+        _pipelines.create(desc, state);
+    };
+    id<MTLFunction> probe_fragment = [_library newFunctionWithName:@"probe_fragment"];
+    create_probe_state(@"probe_vertex", probe_fragment, @"Probe-Pipeline", &_probe_state_3d.full);
+    create_probe_state(@"probe_vertex_packed", probe_fragment, @"Probe-Packed-Pipeline", &_probe_state_3d.packed);
+    create_probe_state(@"probe_vertex_skinned", probe_fragment, @"Probe-Skinned-Pipeline", &_probe_state_3d.skinned);
+    create_probe_state(@"probe_background_vertex", [_library newFunctionWithName:@"probe_background_fragment"],
+                       @"ProbeBackground-Pipeline", &_probe_background_state);
+    // Render textures are drawn with the probe states into a single layer.
+    create_probe_state(@"probe_background_vertex",
+                       [_library newFunctionWithName:@"render_texture_background_fragment"],
+                       @"RenderTextureBackground-Pipeline", &_render_texture_background_state);
+    // Impostor atlases take the albedo and the normal with depth of a tile in two attachments.
+    desc.colorAttachments[0].pixelFormat = MTLPixelFormatRGBA8Unorm;
+    desc.colorAttachments[1].pixelFormat = MTLPixelFormatRGBA8Unorm;
+    id<MTLFunction> impostor_fragment = [_library newFunctionWithName:@"impostor_bake_fragment"];
+    create_probe_state(@"impostor_bake_vertex", impostor_fragment, @"ImpostorBake-Pipeline", &_impostor_bake_state);
+    create_probe_state(@"impostor_bake_vertex_packed", impostor_fragment, @"ImpostorBake-Packed-Pipeline",
+                       &_impostor_bake_packed_state);
+    desc.colorAttachments[1].pixelFormat = MTLPixelFormatInvalid;
+    if (@available(macOS 10.15.4, *))
+        desc.maxVertexAmplificationCount = 1;
+    desc.supportIndirectCommandBuffers = YES;
+    // The pre-pass only fetches positions.
+    desc.colorAttachments[0].pixelFormat = MTLPixelFormatInvalid;
+    // Shadow maps are drawn with these too, their Depth16Unorm variants are only compiled once they are used.
+    const auto create_depth_states = [&](NSString *vertex, NSString *prefix, Pipelines3D &states,
+                                         Pipelines3D &unorm16_states) {
+        create_3d_state(vertex, false, nil, [NSString stringWithFormat:@"%@-Pipeline", prefix], &states.full, nullptr,
+                        &unorm16_states.full);
+        create_3d_state(@"depth_vertex_packed", false, nil, [NSString stringWithFormat:@"%@-Packed-Pipeline", prefix],
+                        &states.packed, nullptr, &unorm16_states.packed);
+        create_3d_state(vertex, true, nil, [NSString stringWithFormat:@"%@-Culled-Pipeline", prefix], &states.culled,
+                        nullptr, &unorm16_states.culled);
+        create_3d_state(@"depth_vertex_packed", true, nil,
+                        [NSString stringWithFormat:@"%@-Packed-Culled-Pipeline", prefix], &states.packed_culled,
+                        nullptr, &unorm16_states.packed_culled);
+        create_3d_state(@"depth_vertex_skinned", false, nil,
+                        [NSString stringWithFormat:@"%@-Skinned-Pipeline", prefix], &states.skinned, nullptr,
+                        &unorm16_states.skinned);
+    };
+    create_depth_states(@"depth_vertex", @"3D-Prepass", _prepass_state_3d, _unorm16_shadow_state_3d);
+    // Full-format meshes of the depth-only passes read the position stream instead while it is enabled.
+    const auto create_position_states = [&](NSString *vertex, NSString *position_vertex, id<MTLFunction> fragment,
+                                            NSString *prefix, Pipelines3D &states) {
+        NSString *packed = [vertex stringByAppendingString:@"_packed"];
+        create_3d_state(position_vertex, false, fragment, [NSString stringWithFormat:@"%@-Pipeline", prefix],
+                        &states.full, nullptr);
+        create_3d_state(packed, false, fragment, [NSString stringWithFormat:@"%@-Packed-Pipeline", prefix],
+                        &states.packed, nullptr);
+        create_3d_state(position_vertex, true, fragment, [NSString stringWithFormat:@"%@-Culled-Pipeline", prefix],
+                        &states.culled, nullptr);
+        create_3d_state(packed, true, fragment, [NSString stringWithFormat:@"%@-Packed-Culled-Pipeline", prefix],
+                        &states.packed_culled, nullptr);
+        create_3d_state([vertex stringByAppendingString:@"_skinned"], false, fragment,
+                        [NSString stringWithFormat:@"%@-Skinned-Pipeline", prefix], &states.skinned, nullptr);
+    };
+    create_depth_states(@"depth_position_vertex", @"3D-Prepass-Positions", _position_prepass_state_3d,
+                        _unorm16_position_shadow_state_3d);
+    // So does the pre-pass of temporal frames, which also writes motion vectors.
+    desc.colorAttachments[0].pixelFormat = MTLPixelFormatRG16Float;
+    create_3d_states(@"motion_vertex", [_library newFunctionWithName:@"motion_fragment"], @"3D-Motion",
+                     _motion_state_3d);
+    desc.colorAttachments[0].pixelFormat = MTLPixelFormatR32Uint;
+    id<MTLFunction> pick_fragment = [_library newFunctionWithName:@"pick_fragment"];
+    create_3d_states(@"pick_vertex", pick_fragment, @"3D-Pick", _pick_state_3d);
+    create_position_states(@"pick_vertex", @"pick_position_vertex", pick_fragment, @"3D-Pick-Positions",
+                           _position_pick_state_3d);
+    // The visibility buffer draws with the positions of the pick pass, its fragments add the triangle.
+    desc.colorAttachments[0].pixelFormat = MTLPixelFormatRG32Uint;
+    create_3d_states(@"pick_vertex", [_library newFunctionWithName:@"vbuffer_fragment"], @"3D-VisibilityBuffer",
+                     _vbuffer_state_3d);
+    // The overdraw view adds one for every fragment, integer formats can't be blended so the counts are halfs.
+    desc.colorAttachments[0].pixelFormat = MTLPixelFormatR16Float;
+    desc.colorAttachments[0].blendingEnabled = YES;
+    desc.colorAttachments[0].rgbBlendOperation = MTLBlendOperationAdd;
+    desc.colorAttachments[0].sourceRGBBlendFactor = MTLBlendFactorOne;
+    desc.colorAttachments[0].destinationRGBBlendFactor = MTLBlendFactorOne;
+    create_3d_states(@"depth_vertex", [_library newFunctionWithName:@"overdraw_fragment"], @"3D-Overdraw",
+                     _overdraw_state_3d);
     desc.colorAttachments[0].blendingEnabled = NO;
-    _state = [_device newRenderPipelineStateWithDescriptor:desc error:&err];
-    MTL_ERROR(err);
+    desc.colorAttachments[0].pixelFormat = MTLPixelFormatInvalid;
+
+    if (_tile_memory)
+    {
+        // The G-buffer draws write their emitted color, the resolve at the end of the pass adds the lit color to it.
+        desc.colorAttachments[0].pixelFormat = MTLPixelFormatBGRA8Unorm;
+        set_gbuffer_formats(desc, true);
+        id<MTLFunction> gbuffer_fragment = [_library newFunctionWithName:@"gbuffer_fragment"];
+        create_3d_states(@"triangle_vertex", gbuffer_fragment, @"3D-GBuffer", _gbuffer_state_3d);
+        set_gbuffer_formats(desc, false);
+
+        MTLRenderPipelineDescriptor *deferred_desc = [MTLRenderPipelineDescriptor new];
+        deferred_desc.vertexFunction = [_library newFunctionWithName:@"deferred_vertex"];
+        deferred_desc.depthAttachmentPixelFormat = MTLPixelFormatDepth32Float;
+        deferred_desc.colorAttachments[0].pixelFormat = MTLPixelFormatBGRA8Unorm;
+        set_gbuffer_formats(deferred_desc, true);
+        for (unsigned int view = 0; view < _deferred_states.size(); view++)
+        {
+            MTLFunctionConstantValues *constants = [MTLFunctionConstantValues new];
+            [constants setConstantValue:&view type:MTLDataTypeUInt atIndex:DEFERRED_VIEW_CONSTANT_INDEX];
+            deferred_desc.fragmentFunction = [_library newFunctionWithName:@"deferred_fragment"
+                                                            constantValues:constants
+                                                                     error:&err];
+            MTL_ERROR(err);
+            deferred_desc.label = [NSString stringWithFormat:@"Deferred-Pipeline-%u", view];
+            _pipelines.create(deferred_desc, &_deferred_states[view]);
+            _scene_pipelines.push_back({[deferred_desc copy], &_deferred_states[view]});
+        }
+    }
+
+    // Without tile memory transparent meshes only write the accumulation, which is composited in a pass of its own.
+    desc.colorAttachments[0].pixelFormat = _tile_memory ? MTLPixelFormatBGRA8Unorm : MTLPixelFormatInvalid;
+    set_transparency_formats(desc, true);
+    id<MTLFunction> transparent_fragment = [_library newFunctionWithName:@"transparent_fragment"];
+    create_3d_states(@"triangle_vertex", transparent_fragment, @"3D-Transparent", _transparent_state_3d);
+    // Particles are drawn into the same layers and the same passes as transparent meshes.
+    desc.supportIndirectCommandBuffers = NO;
+    desc.vertexFunction = [_library newFunctionWithName:@"particle_vertex"];
+    desc.fragmentFunction = [_library newFunctionWithName:@"particle_fragment"];
+    desc.label = @"3D-Particles-Pipeline";
+    _pipelines.create(desc, &_particle_state);
+    if (desc.colorAttachments[0].pixelFormat == scene_format())
+        _scene_pipelines.push_back({[desc copy], &_particle_state});
+    desc.supportIndirectCommandBuffers = YES;
+    set_transparency_formats(desc, false);
+
+    // Rate mapped variants cover the physical pixels of a rasterization rate map.
+    const auto rate_mapped_function = [&](NSString *name, bool rate_mapped) {
+        MTLFunctionConstantValues *constants = [MTLFunctionConstantValues new];
+        [constants setConstantValue:&rate_mapped type:MTLDataTypeBool atIndex:RATE_MAP_CONSTANT_INDEX];
+        id<MTLFunction> function = [_library newFunctionWithName:name constantValues:constants error:&err];
+        MTL_ERROR(err);
+        return function;
+    };
+
+    _pipelines.create(rate_mapped_function(@"cull_lights", false), &_light_cull_state);
+    if (_rate_maps_supported)
+        _pipelines.create(rate_mapped_function(@"cull_lights", true), &_rate_mapped_light_cull_state);
+    _pipelines.create([_library newFunctionWithName:@"light_tree_keys"], &_light_tree_keys_state);
+    _pipelines.create([_library newFunctionWithName:@"build_light_tree"], &_build_light_tree_state);
+    _primitives.create(_device, _library, _pipelines, _retired);
+    _instance_bvh.create(_device, _library, _pipelines, _retired);
+    _sdf_scene.create(_device, _library, _pipelines);
+    _pipelines.create([_library newFunctionWithName:@"trace_sdf_shadows"], &_sdf_trace_state);
+    const auto traced_function = [&](NSString *name) {
+        MTLFunctionConstantValues *constants = [MTLFunctionConstantValues new];
+        [constants setConstantValue:&_hardware_tracing type:MTLDataTypeBool atIndex:HARDWARE_TRACING_CONSTANT_INDEX];
+        id<MTLFunction> function = [_library newFunctionWithName:name constantValues:constants error:&err];
+        MTL_ERROR(err);
+        return function;
+    };
+    if (_ray_tracing_supported)
+    {
+        _pipelines.create(traced_function(@"trace_shadows"), &_trace_state);
+        _pipelines.create(traced_function(@"trace_ray_queries"), &_ray_query_state);
+        _pipelines.create(traced_function(@"bake_pvs"), &_pvs_bake_state);
+        _pipelines.create([_library newFunctionWithName:@"begin_paths"], &_path_tracer.begin);
+        _pipelines.create([_library newFunctionWithName:@"generate_paths"], &_path_tracer.generate);
+        _pipelines.create(traced_function(@"extend_paths"), &_path_tracer.extend);
+        _pipelines.create([_library newFunctionWithName:@"shade_paths"], &_path_tracer.shade);
+        _pipelines.create([_library newFunctionWithName:@"advance_paths"], &_path_tracer.advance);
+        _pipelines.create(traced_function(@"trace_shadow_rays"), &_path_tracer.shadow);
+        _pipelines.create([_library newFunctionWithName:@"reproject_path_history"], &_path_tracer.reproject);
+        _pipelines.create([_library newFunctionWithName:@"filter_path_radiance"], &_path_tracer.filter);
+        _pipelines.create([_library newFunctionWithName:@"queue_paths"], &_path_tracer.queue);
+        _pipelines.create([_library newFunctionWithName:@"accumulate_path_tiles"], &_path_tracer.accumulate);
+        _pipelines.create([_library newFunctionWithName:@"finish_paths"], &_path_tracer.finish);
+        _pipelines.create(traced_function(@"trace_gi_probes"), &_gi.trace);
+        _pipelines.create(traced_function(@"trace_reflection_rays"), &_reflections.trace);
+        _pipelines.create([_library newFunctionWithName:@"blend_gi_irradiance"], &_gi.blend_irradiance);
+        _pipelines.create([_library newFunctionWithName:@"blend_gi_distances"], &_gi.blend_distances);
+        _pipelines.create([_library newFunctionWithName:@"generate_lightmap_paths"], &_generate_lightmap_state);
+        _pipelines.create([_library newFunctionWithName:@"filter_lightmap"], &_filter_lightmap_state);
+
+        // Texels take the world position with coverage in w and the normal, without depth.
+        MTLRenderPipelineDescriptor *texels = [MTLRenderPipelineDescriptor new];
+        texels.label = @"LightmapTexels-Pipeline";
+        texels.vertexFunction = [_library newFunctionWithName:@"lightmap_texel_vertex"];
+        texels.fragmentFunction = [_library newFunctionWithName:@"lightmap_texel_fragment"];
+        texels.colorAttachments[0].pixelFormat = MTLPixelFormatRGBA32Float;
+        texels.colorAttachments[1].pixelFormat = MTLPixelFormatRGBA16Float;
+        _pipelines.create(texels, &_lightmap_texel_state);
+    }
+    _pipelines.create([_library newFunctionWithName:@"skin_vertices"], &_skinning_state);
+    _pipelines.create([_library newFunctionWithName:@"animate_skins"], &_animate_skins_state);
+    _pipelines.create([_library newFunctionWithName:@"animate_instances"], &_animate_instances_state);
+    _pipelines.create([_library newFunctionWithName:@"scatter_hierarchy_locals"], &_scatter_hierarchy_state);
+    _pipelines.create([_library newFunctionWithName:@"propagate_hierarchy"], &_propagate_hierarchy_state);
+    _pipelines.create([_library newFunctionWithName:@"emit_particles"], &_emit_particles_state);
+    _pipelines.create([_library newFunctionWithName:@"prepare_particles"], &_prepare_particles_state);
+    _pipelines.create([_library newFunctionWithName:@"simulate_particles"], &_simulate_particles_state);
+    _pipelines.create([_library newFunctionWithName:@"finish_particles"], &_finish_particles_state);
+    _pipelines.create([_library newFunctionWithName:@"generate_terrain"], &_generate_terrain_state);
+    _pipelines.create([_library newFunctionWithName:@"extract_positions"], &_extract_positions_state);
+    _pipelines.create([_library newFunctionWithName:@"scatter_instances"], &_scatter_instances_state);
+
+    const auto create_cull_state = [&](NSString *name, bool occlusion, __strong id<MTLComputePipelineState> *state) {
+        MTLFunctionConstantValues *constants = [MTLFunctionConstantValues new];
+        [constants setConstantValue:&occlusion type:MTLDataTypeBool atIndex:OCCLUSION_CULLING_CONSTANT_INDEX];
+        id<MTLFunction> function = [_library newFunctionWithName:name constantValues:constants error:&err];
+        MTL_ERROR(err);
+        _pipelines.create(function, state);
+    };
+    create_cull_state(@"cull_instances", false, &_cull_state);
+    create_cull_state(@"cull_instances", true, &_occlusion_cull_state);
+    create_cull_state(@"cull_bvh_instances", false, &_bvh_cull_state);
+    create_cull_state(@"cull_bvh_instances", true, &_bvh_occlusion_cull_state);
+
+    _pipelines.create([_library newFunctionWithName:@"depth_pyramid_init"], &_depth_pyramid_init_state);
+    _pipelines.create([_library newFunctionWithName:@"depth_pyramid_downsample"], &_depth_pyramid_state);
+
+    id<MTLFunction> encode_draws = [_library newFunctionWithName:@"encode_draws"];
+    _pipelines.create(encode_draws, &_encode_draws_state);
+    _draw_commands_encoder = [encode_draws newArgumentEncoderWithBufferIndex:4];
+    _pipelines.create([_library newFunctionWithName:@"encode_culled_draws"], &_encode_culled_draws_state);
+    _pipelines.create([_library newFunctionWithName:@"culled_draw_keys"], &_culled_draw_keys_state);
+    _pipelines.create([_library newFunctionWithName:@"encode_bc7"], &_encode_bc7_state);
+    _pipelines.create([_library newFunctionWithName:@"cull_clusters"], &_cull_clusters_state);
+    _pipelines.create([_library newFunctionWithName:@"cull_skinned"], &_cull_skinned_state);
 
     desc = [[MTLRenderPipelineDescriptor alloc] init];
     desc.vertexFunction = [_library newFunctionWithName:@"triangle_vertex_2d"];
-    desc.fragmentFunction = [_library newFunctionWithName:@"triangle_fragment_2d"];
     desc.colorAttachments[0].pixelFormat = MTLPixelFormatBGRA8Unorm;
     desc.colorAttachments[0].blendingEnabled = YES;
     desc.colorAttachments[0].rgbBlendOperation = MTLBlendOperationAdd;
@@ -140,31 +1000,286 @@ MetalRenderer::MetalRenderer(id<MTLDevice> device, void *ns_window, void *, unsi
     desc.colorAttachments[0].destinationRGBBlendFactor = MTLBlendFactorOneMinusSourceAlpha;
     desc.colorAttachments[0].destinationAlphaBlendFactor = MTLBlendFactorZero;
 
-    _state_2d = [_device newRenderPipelineStateWithDescriptor:desc error:&err];
-    MTL_ERROR(err);
+    // 2D draws blend straight color over the frame. Drawn into the cached 2D layer they accumulate premultiplied color
+    // and coverage instead, which the layer is composited with.
+    const auto set_2d_blending = [&](MTLBlendFactor source_rgb, MTLBlendFactor source_alpha,
+                                     MTLBlendFactor destination_alpha) {
+        desc.colorAttachments[0].sourceRGBBlendFactor = source_rgb;
+        desc.colorAttachments[0].sourceAlphaBlendFactor = source_alpha;
+        desc.colorAttachments[0].destinationAlphaBlendFactor = destination_alpha;
+    };
+    const auto create_2d_state = [&](unsigned int index, bool layer) {
+        _pipelines.create(desc, &_states_2d[index]);
+        _target_pipelines.push_back({[desc copy], &_states_2d[index]});
+        _msaa_pipelines.push_back({[desc copy], &_states_2d_msaa[index]});
+        _msaa_pipelines.back().desc.label = [desc.label stringByAppendingString:@"-MSAA"];
+        if (!layer)
+            return;
 
-    MTLTextureDescriptor *tex_desc = [[MTLTextureDescriptor alloc] init];
-    tex_desc.pixelFormat = MTLPixelFormatDepth32Float;
-    tex_desc.width = static_cast<unsigned int>(static_cast<double>(width) * scale);
-    tex_desc.height = static_cast<unsigned int>(static_cast<double>(height) * scale);
-    tex_desc.depth = 1;
-    tex_desc.textureType = MTLTextureType2D;
-    tex_desc.storageMode = MTLStorageModePrivate;
+        NSString *label = desc.label;
+        desc.label = [label stringByAppendingString:@"-Layer"];
+        set_2d_blending(MTLBlendFactorSourceAlpha, MTLBlendFactorOne, MTLBlendFactorOneMinusSourceAlpha);
+        _pipelines.create(desc, &_states_2d_layer[index]);
+        _target_pipelines.push_back({[desc copy], &_states_2d_layer[index]});
+        set_2d_blending(MTLBlendFactorSourceAlpha, MTLBlendFactorSourceAlpha, MTLBlendFactorZero);
+        desc.label = label;
+    };
+
+    std::array<id<MTLFunction>, TEXTURE_MODES_2D> fragments_2d;
+    for (unsigned int mode = 0; mode < TEXTURE_MODES_2D; mode++)
+    {
+        MTLFunctionConstantValues *constants = [MTLFunctionConstantValues new];
+        [constants setConstantValue:&mode type:MTLDataTypeUInt atIndex:TEXTURE_MODE_2D_CONSTANT_INDEX];
+        fragments_2d[mode] = [_library newFunctionWithName:@"triangle_fragment_2d" constantValues:constants error:&err];
+        MTL_ERROR(err);
+        desc.fragmentFunction = fragments_2d[mode];
+        desc.label = [NSString stringWithFormat:@"2D-Pipeline-%u", mode];
+        create_2d_state(mode, true);
+    }
 
-    _depth_texture = [_device newTextureWithDescriptor:tex_desc];
+    // Batches mix meshes of every texture mode.
+    id<MTLFunction> vertex_2d = desc.vertexFunction;
+    id<MTLFunction> batched_vertex_2d = [_library newFunctionWithName:@"batched_vertex_2d"];
+    desc.vertexFunction = batched_vertex_2d;
+    desc.fragmentFunction = fragments_2d[TEXTURE_MODE_2D_MIXED];
+    desc.label = @"2D-Batched-Pipeline";
+    create_2d_state(BATCHED_2D_STATE, true);
 
-    MTLDepthStencilDescriptor *depth_desc = [[MTLDepthStencilDescriptor alloc] init];
-    depth_desc.depthCompareFunction = MTLCompareFunctionLess;
-    depth_desc.depthWriteEnabled = YES;
-    _depth_state = [_device newDepthStencilStateWithDescriptor:depth_desc];
+    id<MTLFunction> sprite_vertex = [_library newFunctionWithName:@"sprite_vertex"];
+    desc.vertexFunction = sprite_vertex;
+    desc.label = @"Sprite-Pipeline";
+    create_2d_state(SPRITE_2D_STATE, true);
 
-    depth_desc.depthCompareFunction = MTLCompareFunctionAlways;
-    depth_desc.depthWriteEnabled = NO;
-    _depth_state_2d = [_device newDepthStencilStateWithDescriptor:depth_desc];
+    id<MTLFunction> path_vertex = [_library newFunctionWithName:@"path_vertex"];
+    id<MTLFunction> path_fragment = [_library newFunctionWithName:@"path_fragment"];
+    desc.vertexFunction = path_vertex;
+    desc.fragmentFunction = path_fragment;
+    desc.label = @"Path-Pipeline";
+    create_2d_state(PATH_2D_STATE, true);
+
+    id<MTLFunction> glyph_vertex = [_library newFunctionWithName:@"glyph_vertex"];
+    id<MTLFunction> glyph_fragment = [_library newFunctionWithName:@"glyph_fragment"];
+    desc.vertexFunction = glyph_vertex;
+    desc.fragmentFunction = glyph_fragment;
+    desc.label = @"Glyph-Pipeline";
+    create_2d_state(GLYPH_2D_STATE, true);
+
+    id<MTLFunction> layer_vertex = [_library newFunctionWithName:@"deferred_vertex"];
+    id<MTLFunction> layer_fragment = [_library newFunctionWithName:@"layer_2d_fragment"];
+    desc.vertexFunction = layer_vertex;
+    desc.fragmentFunction = layer_fragment;
+    desc.label = @"2D-Layer-Composite-Pipeline";
+    set_2d_blending(MTLBlendFactorOne, MTLBlendFactorOne, MTLBlendFactorOneMinusSourceAlpha);
+    create_2d_state(LAYER_2D_STATE, false);
+    set_2d_blending(MTLBlendFactorSourceAlpha, MTLBlendFactorSourceAlpha, MTLBlendFactorZero);
+    desc.vertexFunction = vertex_2d;
+
+    // 2D is drawn on top of the resolved color in the deferred pass, pipelines must match all of its attachments.
+    if (_tile_memory)
+    {
+        const auto create_2d_states = [&](NSString *prefix, States2D &states) {
+            for (unsigned int mode = 0; mode < TEXTURE_MODES_2D; mode++)
+            {
+                desc.fragmentFunction = fragments_2d[mode];
+                desc.label = [NSString stringWithFormat:@"2D-%@-Pipeline-%u", prefix, mode];
+                _pipelines.create(desc, &states[mode]);
+            }
+            desc.vertexFunction = batched_vertex_2d;
+            desc.fragmentFunction = fragments_2d[TEXTURE_MODE_2D_MIXED];
+            desc.label = [NSString stringWithFormat:@"2D-%@-Batched-Pipeline", prefix];
+            _pipelines.create(desc, &states[BATCHED_2D_STATE]);
+            desc.vertexFunction = sprite_vertex;
+            desc.label = [NSString stringWithFormat:@"Sprite-%@-Pipeline", prefix];
+            _pipelines.create(desc, &states[SPRITE_2D_STATE]);
+            desc.vertexFunction = path_vertex;
+            desc.fragmentFunction = path_fragment;
+            desc.label = [NSString stringWithFormat:@"Path-%@-Pipeline", prefix];
+            _pipelines.create(desc, &states[PATH_2D_STATE]);
+            desc.vertexFunction = glyph_vertex;
+            desc.fragmentFunction = glyph_fragment;
+            desc.label = [NSString stringWithFormat:@"Glyph-%@-Pipeline", prefix];
+            _pipelines.create(desc, &states[GLYPH_2D_STATE]);
+            desc.vertexFunction = layer_vertex;
+            desc.fragmentFunction = layer_fragment;
+            desc.label = [NSString stringWithFormat:@"2D-%@-Layer-Composite-Pipeline", prefix];
+            set_2d_blending(MTLBlendFactorOne, MTLBlendFactorOne, MTLBlendFactorOneMinusSourceAlpha);
+            _pipelines.create(desc, &states[LAYER_2D_STATE]);
+            set_2d_blending(MTLBlendFactorSourceAlpha, MTLBlendFactorSourceAlpha, MTLBlendFactorZero);
+            desc.vertexFunction = vertex_2d;
+        };
+
+        desc.depthAttachmentPixelFormat = MTLPixelFormatDepth32Float;
+        set_gbuffer_formats(desc, true);
+        create_2d_states(@"Deferred", _states_2d_deferred);
+        set_gbuffer_formats(desc, false);
+        // So is the 2D of the transparency pass, which composites in tile memory.
+        set_transparency_formats(desc, true);
+        create_2d_states(@"Transparent", _states_2d_transparent);
+    }
+
+    // Clears a tile of the spot shadow atlas with a full screen triangle at the far plane.
+    MTLRenderPipelineDescriptor *clear_desc = [MTLRenderPipelineDescriptor new];
+    clear_desc.vertexFunction = [_library newFunctionWithName:@"shadow_clear_vertex"];
+    clear_desc.depthAttachmentPixelFormat = MTLPixelFormatDepth32Float;
+    clear_desc.label = @"ShadowClear-Pipeline";
+    _pipelines.create(clear_desc, &_shadow_clear_state);
+    _unorm16_shadow_pipelines.push_back({[clear_desc copy], &_unorm16_shadow_clear_state});
+    clear_desc.vertexFunction = [_library newFunctionWithName:@"deferred_vertex"];
+
+    // Visibility group boxes only test against the pre-pass depth.
+    MTLRenderPipelineDescriptor *visibility_desc = [MTLRenderPipelineDescriptor new];
+    visibility_desc.vertexFunction = [_library newFunctionWithName:@"visibility_box_vertex"];
+    visibility_desc.depthAttachmentPixelFormat = MTLPixelFormatDepth32Float;
+    visibility_desc.label = @"VisibilityBox-Pipeline";
+    _pipelines.create(visibility_desc, &_visibility_state);
+
+    clear_desc.fragmentFunction = [_library newFunctionWithName:@"ambient_occlusion_fragment"];
+    clear_desc.colorAttachments[0].pixelFormat = MTLPixelFormatBGRA8Unorm;
+    clear_desc.label = @"AmbientOcclusion-Pipeline";
+    _pipelines.create(clear_desc, &_ambient_occlusion_state);
+    _scene_pipelines.push_back({[clear_desc copy], &_ambient_occlusion_state});
+    clear_desc.fragmentFunction = [_library newFunctionWithName:@"overdraw_heatmap_fragment"];
+    clear_desc.label = @"OverdrawHeatmap-Pipeline";
+    _pipelines.create(clear_desc, &_overdraw_heatmap_state);
+    _scene_pipelines.push_back({[clear_desc copy], &_overdraw_heatmap_state});
+    clear_desc.fragmentFunction = [_library newFunctionWithName:@"skybox_fragment"];
+    clear_desc.label = @"Skybox-Pipeline";
+    _pipelines.create(clear_desc, &_skybox_state);
+    _scene_pipelines.push_back({[clear_desc copy], &_skybox_state});
+    _msaa_pipelines.push_back({[clear_desc copy], &_skybox_state_msaa});
+    _msaa_pipelines.back().desc.label = @"Skybox-Pipeline-MSAA";
+
+    // Video frames are converted into the textures of their slots.
+    MTLRenderPipelineDescriptor *video_desc = [MTLRenderPipelineDescriptor new];
+    video_desc.vertexFunction = [_library newFunctionWithName:@"deferred_vertex"];
+    video_desc.fragmentFunction = [_library newFunctionWithName:@"video_frame_fragment"];
+    video_desc.colorAttachments[0].pixelFormat = MTLPixelFormatBGRA8Unorm;
+    video_desc.label = @"VideoFrame-Pipeline";
+    _pipelines.create(video_desc, &_video_frame_state);
+
+    // Debug lines blend over the scene, they are tested against its depth but never write it.
+    MTLRenderPipelineDescriptor *debug_desc = [MTLRenderPipelineDescriptor new];
+    debug_desc.vertexFunction = [_library newFunctionWithName:@"debug_line_vertex"];
+    debug_desc.fragmentFunction = [_library newFunctionWithName:@"debug_line_fragment"];
+    debug_desc.depthAttachmentPixelFormat = MTLPixelFormatDepth32Float;
+    debug_desc.colorAttachments[0].pixelFormat = MTLPixelFormatBGRA8Unorm;
+    debug_desc.colorAttachments[0].blendingEnabled = YES;
+    debug_desc.colorAttachments[0].sourceRGBBlendFactor = MTLBlendFactorSourceAlpha;
+    debug_desc.colorAttachments[0].sourceAlphaBlendFactor = MTLBlendFactorOne;
+    debug_desc.colorAttachments[0].destinationRGBBlendFactor = MTLBlendFactorOneMinusSourceAlpha;
+    debug_desc.colorAttachments[0].destinationAlphaBlendFactor = MTLBlendFactorOneMinusSourceAlpha;
+    debug_desc.label = @"DebugLine-Pipeline";
+    _pipelines.create(debug_desc, &_debug_line_state);
+    _scene_pipelines.push_back({[debug_desc copy], &_debug_line_state});
+    _msaa_pipelines.push_back({[debug_desc copy], &_debug_line_state_msaa});
+    _msaa_pipelines.back().desc.label = @"DebugLine-Pipeline-MSAA";
+    if (_tile_memory)
+    {
+        set_gbuffer_formats(debug_desc, true);
+        debug_desc.label = @"DebugLine-Deferred-Pipeline";
+        _pipelines.create(debug_desc, &_debug_line_state_deferred);
+        _scene_pipelines.push_back({[debug_desc copy], &_debug_line_state_deferred});
+    }
+
+    // Point clouds are rasterized by compute and composited over the 3D pass, tested against its depth.
+    _pipelines.create([_library newFunctionWithName:@"rasterize_point_depth"], &_point_depth_state);
+    _pipelines.create([_library newFunctionWithName:@"rasterize_point_color"], &_point_color_state);
+    MTLRenderPipelineDescriptor *point_desc = [clear_desc copy];
+    point_desc.fragmentFunction = [_library newFunctionWithName:@"point_cloud_fragment"];
+    point_desc.label = @"PointCloud-Pipeline";
+    _pipelines.create(point_desc, &_point_cloud_state);
+    _scene_pipelines.push_back({[point_desc copy], &_point_cloud_state});
+    _msaa_pipelines.push_back({[point_desc copy], &_point_cloud_state_msaa});
+    _msaa_pipelines.back().desc.label = @"PointCloud-Pipeline-MSAA";
+    if (_tile_memory)
+    {
+        set_gbuffer_formats(point_desc, true);
+        point_desc.label = @"PointCloud-Deferred-Pipeline";
+        _pipelines.create(point_desc, &_point_cloud_state_deferred);
+        _scene_pipelines.push_back({[point_desc copy], &_point_cloud_state_deferred});
+    }
+
+    clear_desc.fragmentFunction = [_library newFunctionWithName:@"vbuffer_resolve_fragment"];
+    clear_desc.label = @"VisibilityBufferResolve-Pipeline";
+    _pipelines.create(clear_desc, &_vbuffer_resolve_state);
+    _scene_pipelines.push_back({[clear_desc copy], &_vbuffer_resolve_state});
+    if (_ray_tracing_supported)
+    {
+        clear_desc.fragmentFunction = [_library newFunctionWithName:@"path_traced_fragment"];
+        clear_desc.label = @"PathTraced-Pipeline";
+        _pipelines.create(clear_desc, &_path_tracer.resolve);
+        _scene_pipelines.push_back({[clear_desc copy], &_path_tracer.resolve});
+    }
+    clear_desc.fragmentFunction = [_library newFunctionWithName:@"background_motion_fragment"];
+    clear_desc.colorAttachments[0].pixelFormat = MTLPixelFormatRG16Float;
+    clear_desc.label = @"BackgroundMotion-Pipeline";
+    _pipelines.create(clear_desc, &_background_motion_state);
+
+    // Blends the average color of the transparent layers over the opaque color by the coverage they leave.
+    MTLRenderPipelineDescriptor *composite_desc = [MTLRenderPipelineDescriptor new];
+    composite_desc.vertexFunction = clear_desc.vertexFunction;
+    composite_desc.fragmentFunction = [_library newFunctionWithName:_tile_memory ? @"transparency_resolve_fragment"
+                                                                                 : @"transparency_composite_fragment"];
+    composite_desc.colorAttachments[0].pixelFormat = MTLPixelFormatBGRA8Unorm;
+    composite_desc.colorAttachments[0].blendingEnabled = YES;
+    composite_desc.colorAttachments[0].sourceRGBBlendFactor = MTLBlendFactorSourceAlpha;
+    composite_desc.colorAttachments[0].sourceAlphaBlendFactor = MTLBlendFactorZero;
+    composite_desc.colorAttachments[0].destinationRGBBlendFactor = MTLBlendFactorOneMinusSourceAlpha;
+    composite_desc.colorAttachments[0].destinationAlphaBlendFactor = MTLBlendFactorOne;
+    if (_tile_memory)
+    {
+        composite_desc.depthAttachmentPixelFormat = MTLPixelFormatDepth32Float;
+        set_transparency_formats(composite_desc, true);
+    }
+    composite_desc.label = @"TransparencyComposite-Pipeline";
+    _pipelines.create(composite_desc, &_transparency_composite_state);
+    _scene_pipelines.push_back({[composite_desc copy], &_transparency_composite_state});
+
+    // Draws the scaled 3D view into the drawable before the 2D overlay, tonemapped when it is HDR and with the post
+    // effects.
+    MTLRenderPipelineDescriptor *upscale_desc = [MTLRenderPipelineDescriptor new];
+    upscale_desc.vertexFunction = [_library newFunctionWithName:@"upscale_vertex"];
+    upscale_desc.fragmentFunction = upscale_function(false);
+    upscale_desc.colorAttachments[0].pixelFormat = MTLPixelFormatBGRA8Unorm;
+    upscale_desc.label = @"Upscale-Pipeline";
+    _pipelines.create(upscale_desc, &_upscale_state);
+    _target_pipelines.push_back({[upscale_desc copy], &_upscale_state});
+    if (_rate_maps_supported)
+    {
+        upscale_desc.fragmentFunction = upscale_function(true);
+        upscale_desc.label = @"Upscale-RateMapped-Pipeline";
+        _pipelines.create(upscale_desc, &_rate_mapped_upscale_state);
+        _target_pipelines.push_back({[upscale_desc copy], &_rate_mapped_upscale_state});
+    }
+    _pipelines.create([_library newFunctionWithName:@"camera_motion"], &_camera_motion_state);
+    _pipelines.create([_library newFunctionWithName:@"taa_resolve"], &_taa_resolve_state);
+    _pipelines.create([_library newFunctionWithName:@"bloom_downsample"], &_bloom_downsample_state);
+    _pipelines.create([_library newFunctionWithName:@"bloom_upsample"], &_bloom_upsample_state);
+    _pipelines.create([_library newFunctionWithName:@"prefilter_environment"], &_prefilter_environment_state);
+    _pipelines.create([_library newFunctionWithName:@"prefilter_probe"], &_prefilter_probe_state);
+    _pipelines.create([_library newFunctionWithName:@"compute_ssao"], &_ssao_state);
+    _pipelines.create([_library newFunctionWithName:@"ssao_blur"], &_ssao_blur_state);
+    _pipelines.create([_library newFunctionWithName:@"begin_reflections"], &_reflections.begin);
+    _pipelines.create([_library newFunctionWithName:@"reflection_hzb_init"], &_reflections.hzb_init);
+    _pipelines.create([_library newFunctionWithName:@"reflection_hzb_downsample"], &_reflections.hzb_downsample);
+    _pipelines.create([_library newFunctionWithName:@"trace_screen_reflections"], &_reflections.trace_screen);
+    _pipelines.create([_library newFunctionWithName:@"queue_reflection_rays"], &_reflections.queue);
+    _pipelines.create([_library newFunctionWithName:@"resolve_reflections"], &_reflections.resolve);
+    _pipelines.create([_library newFunctionWithName:@"downsample_reflection_source"], &_reflections.downsample);
+    _pipelines.create([_library newFunctionWithName:@"project_irradiance"], &_project_irradiance_state);
 }
 
 void MetalRenderer::set_2d_mesh(unsigned int id, MeshData2D data)
 {
+    bool textured = false;
+    bool untextured = false;
+    for (unsigned int i = 0; data.vertices && i < data.num_vertices; i++)
+        (data.vertices[i].tex > 0 ? textured : untextured) = true;
+    if (textured)
+        _texture_modes_2d[id] = untextured ? TEXTURE_MODE_2D_MIXED : TEXTURE_MODE_2D_ALL;
+    else
+        _texture_modes_2d[id] = TEXTURE_MODE_2D_NONE;
+
     if (_vertex_2d_list.has(id))
     {
         _vertex_2d_list.update_pointer(id, data.vertices, data.num_vertices);
@@ -179,435 +1294,11705 @@ void MetalRenderer::set_2d_mesh(unsigned int id, MeshData2D data)
 
 void MetalRenderer::set_2d_instances(unsigned int id, InstancesData2D data)
 {
-    if (_instance_2d_list.has(id))
+    const auto *matrices = reinterpret_cast<const mat4 *>(data.matrices);
+    if (_copy_on_submit)
     {
-        _instance_2d_list.update_instances_list(id, reinterpret_cast<const mat4 *>(data.matrices), data.num_matrices);
+        std::vector<mat4> &copy = _instance_2d_copies[id];
+        copy.assign(matrices, matrices + data.num_matrices);
+        matrices = copy.data();
     }
     else
     {
-        _instance_2d_list.add_instances_list(id, reinterpret_cast<const mat4 *>(data.matrices), data.num_matrices);
+        _instance_2d_copies.erase(id);
     }
 
-    _flags |= Flags::UpdateInstances2D;
-}
-
-void MetalRenderer::set_3d_mesh(unsigned int id, MeshData3D data)
-{
-    if (_vertex_3d_list.has(id))
+    if (_instance_2d_list.has(id))
     {
-        _vertex_3d_list.update_pointer(id, data.vertices, data.num_vertices, data.skin_data);
+        _instance_2d_list.update_instances_list(id, matrices, data.num_matrices);
     }
     else
     {
-        _vertex_3d_list.add_pointer(id, data.vertices, data.num_vertices, data.skin_data);
+        _instance_2d_list.add_instances_list(id, matrices, data.num_matrices);
     }
 
-    _flags |= Flags::Update3D;
+    _flags |= Flags::UpdateInstances2D;
 }
 
-void MetalRenderer::set_3d_instances(unsigned int id, InstancesData3D data)
+void MetalRenderer::set_glyph_atlas(unsigned int width, unsigned int height)
 {
-    if (id >= _instance_3d_matrices.size())
+    _retired.retire(_glyph_atlas);
+    _layer_2d_dirty = true;
+    if (width == 0 || height == 0)
+    {
+        _glyph_atlas = nil;
+        return;
+    }
+
+    MTLTextureDescriptor *desc = [MTLTextureDescriptor texture2DDescriptorWithPixelFormat:MTLPixelFormatR8Unorm
+                                                                                    width:width
+                                                                                   height:height
+                                                                                mipmapped:NO];
+    desc.usage = MTLTextureUsageShaderRead;
+    _glyph_atlas = [_device newTextureWithDescriptor:desc];
+    _glyph_atlas.label = @"GlyphAtlas";
+
+    // Starts out without coverage, so glyphs of regions that were not written yet stay invisible.
+    const std::vector<unsigned char> zeros(static_cast<size_t>(width) * height, 0);
+    [_glyph_atlas replaceRegion:MTLRegionMake2D(0, 0, width, height)
+                    mipmapLevel:0
+                      withBytes:zeros.data()
+                    bytesPerRow:width];
+}
+
+void MetalRenderer::update_glyph_atlas(unsigned int x, unsigned int y, unsigned int width, unsigned int height,
+                                       const unsigned char *pixels, unsigned int bytes_per_row)
+{
+    if (_glyph_atlas == nil || !pixels || x >= _glyph_atlas.width || y >= _glyph_atlas.height)
+        return;
+
+    width = std::min(width, static_cast<unsigned int>(_glyph_atlas.width) - x);
+    height = std::min(height, static_cast<unsigned int>(_glyph_atlas.height) - y);
+    _layer_2d_dirty = true;
+    [_glyph_atlas replaceRegion:MTLRegionMake2D(x, y, width, height)
+                    mipmapLevel:0
+                      withBytes:pixels
+                    bytesPerRow:bytes_per_row];
+}
+
+void MetalRenderer::set_glyphs(unsigned int id, const GlyphInstance *glyphs, unsigned int count)
+{
+    if (set_copied_instances(_glyph_list, _glyph_copies, id, glyphs, count))
+        _flags |= Flags::UpdateGlyphs;
+}
+
+void MetalRenderer::set_sprites(unsigned int id, const SpriteInstance *sprites, unsigned int count)
+{
+    if (set_copied_instances(_sprite_list, _sprite_copies, id, sprites, count))
+        _flags |= Flags::UpdateSprites;
+}
+
+void MetalRenderer::set_2d_caching(bool enabled)
+{
+    _cache_2d = enabled;
+    _layer_2d_dirty = true;
+    if (!enabled)
+    {
+        _retired.retire(_layer_2d);
+        _layer_2d = nil;
+    }
+}
+
+void MetalRenderer::set_2d_clip(unsigned int id, ClipRect2D rect)
+{
+    _clips_2d[id] = rect;
+    _flags |= Flags::UpdateClips2D;
+}
+
+void MetalRenderer::remove_2d_clip(unsigned int id)
+{
+    if (_clips_2d.find(id))
+    {
+        _clips_2d.erase(id);
+        _flags |= Flags::UpdateClips2D;
+    }
+}
+
+void MetalRenderer::set_2d_path(unsigned int id, const PathData2D &path)
+{
+    if (Path2D *previous = _paths_2d.find(id))
+    {
+        _retired.retire(previous->buffer);
+        _paths_2d.erase(id);
+        _flags |= Flags::UpdatePaths2D;
+    }
+    if (path.num_segments == 0 || path.segments == nullptr)
+        return;
+
+    Path2D created;
+    const float inf = std::numeric_limits<float>::infinity();
+    vec2 bmin(inf);
+    vec2 bmax(-inf);
+    for (unsigned int i = 0; i < path.num_segments; i++)
+    {
+        const PathSegment2D &segment = path.segments[i];
+        bmin = min(bmin, min(vec2(segment.x0, segment.y0), vec2(segment.x1, segment.y1)));
+        bmax = max(bmax, max(vec2(segment.x0, segment.y0), vec2(segment.x1, segment.y1)));
+    }
+    created.bounds = vec4(bmin, bmax);
+
+    // Paths as wide as they are high get as many rows as columns.
+    const unsigned int bands = std::clamp((path.num_segments + PATH_BAND_SEGMENTS - 1) / PATH_BAND_SEGMENTS, 1u,
+                                          static_cast<unsigned int>(PATH_MAX_BANDS));
+    const PathBands lists = build_path_bands(path.segments, path.num_segments, created.bounds, bands, bands);
+    const NSUInteger segments_size = path.num_segments * sizeof(PathSegment2D);
+    const NSUInteger ranges_size = lists.ranges.size() * sizeof(uvec2);
+    const NSUInteger indices_size = std::max<size_t>(lists.indices.size(), 1) * sizeof(unsigned int);
+    const MTLResourceOptions storage = cpu_write_storage(_device);
+    created.buffer = [_device newBufferWithLength:segments_size + ranges_size + indices_size options:storage];
+    if (created.buffer == nil)
+    {
+        NSLog(@"Could not allocate %u segments of path %u.", path.num_segments, id);
+        return;
+    }
+    created.buffer.label = @"Path2D";
+    created.bands_offset = segments_size;
+    created.indices_offset = segments_size + ranges_size;
+    auto *contents = static_cast<char *>(created.buffer.contents);
+    memcpy(contents, path.segments, segments_size);
+    memcpy(contents + created.bands_offset, lists.ranges.data(), ranges_size);
+    memcpy(contents + created.indices_offset, lists.indices.data(), lists.indices.size() * sizeof(unsigned int));
+    if (storage == MANAGED_STORAGE)
+        did_modify(created.buffer, NSMakeRange(0, created.buffer.length));
+
+    PathUniforms2D &uniforms = created.uniforms;
+    uniforms.transform = path.transform;
+    const vec2 band_size = max(bmax - bmin, vec2(1e-6f)) / static_cast<float>(bands);
+    uniforms.bands = simd_make_float4(bmin.x, bmin.y, band_size.x, band_size.y);
+    uniforms.bands_x = bands;
+    uniforms.bands_y = bands;
+    uniforms.color = path.color;
+    uniforms.even_odd = path.mode == PATH_FILL_EVEN_ODD ? 1 : 0;
+    uniforms.half_width = path.mode == PATH_STROKE ? std::max(path.stroke_width * 0.5f, 1e-6f) : 0.0f;
+    uniforms.z = path.z;
+    _paths_2d.insert(id, std::move(created));
+    _flags |= Flags::UpdatePaths2D;
+}
+
+void MetalRenderer::set_2d_path_transform(unsigned int id, const simd_float4x4 &transform)
+{
+    if (Path2D *path = _paths_2d.find(id))
+    {
+        path->uniforms.transform = transform;
+        _flags |= Flags::UpdatePaths2D;
+    }
+}
+
+void MetalRenderer::set_2d_instances_batch(const unsigned int *ids, const InstancesData2D *data, unsigned int count)
+{
+    if (count == 0)
+        return;
+
+    _instance_2d_list.reserve(*std::max_element(ids, ids + count) + 1);
+    for (unsigned int i = 0; i < count; i++)
+        set_2d_instances(ids[i], data[i]);
+}
+
+void MetalRenderer::set_3d_meshes_batch(const unsigned int *ids, const MeshData3D *data, unsigned int count)
+{
+    if (count == 0)
+        return;
+
+    // Tables keyed by mesh id grow once, ranges are still only built by the next synchronize().
+    const unsigned int id_bound = *std::max_element(ids, ids + count) + 1;
+    if (_vertex_format == VERTEX_3D_PACKED)
+        _packed_3d_list.reserve(id_bound);
+    else
+        _vertex_3d_list.reserve(id_bound);
+
+    // Indexed meshes are reordered on all cores first, and set as if they were passed reordered.
+    std::vector<WeldedMesh> ordered(count);
+    std::vector<MeshData3D> meshes(data, data + count);
+    WeldedMesh *ordered_data = ordered.data();
+    MeshData3D *mesh_data = meshes.data();
+    dispatch_apply(count, dispatch_get_global_queue(QOS_CLASS_USER_INITIATED, 0), ^(size_t i) {
+      MeshData3D &mesh = mesh_data[i];
+      // Invalid indices are left to set_3d_mesh, which rejects the mesh.
+      if ((mesh.flags & OPTIMIZE_ORDER) == 0 || !mesh.indices || mesh.num_indices < 3 ||
+          !mesh_indices_valid(mesh.indices, mesh.num_indices, mesh.num_vertices))
+          return;
+      WeldedMesh &copy = ordered_data[i];
+      optimize_mesh_order(mesh.vertices, mesh.skin_data, mesh.num_vertices, mesh.indices, mesh.num_indices,
+                          mesh.ranges, mesh.num_ranges, mesh.bounds, copy.vertices, copy.joints_weights, copy.indices);
+      mesh.vertices = copy.vertices.data();
+      mesh.skin_data = mesh.skin_data ? copy.joints_weights.data() : nullptr;
+      mesh.indices = copy.indices.data();
+      mesh.flags &= ~OPTIMIZE_ORDER;
+    });
+    for (unsigned int i = 0; i < count; i++)
+    {
+        // The vertex lists point into the reordered copy unless they copied it or rejected the mesh.
+        if (set_3d_mesh(ids[i], meshes[i]) && !ordered[i].indices.empty() && !_copy_on_submit)
+            _welded_meshes[ids[i]] = std::move(ordered[i]);
+    }
+}
+
+void MetalRenderer::set_3d_instances_batch(const unsigned int *ids, const InstancesData3D *data, unsigned int count)
+{
+    if (count == 0)
+        return;
+
+    const unsigned int id_bound = *std::max_element(ids, ids + count) + 1;
+    if (id_bound > _instance_3d_matrices.size())
+    {
+        _instance_3d_matrices.resize(id_bound);
+        _instance_3d_bounds.resize(id_bound);
+        _instance_3d_skin_ids.resize(id_bound);
+    }
+    _instance_3d_list.reserve(id_bound);
+    for (unsigned int i = 0; i < count; i++)
+        set_3d_instances(ids[i], data[i]);
+}
+
+bool MetalRenderer::set_3d_mesh(unsigned int id, MeshData3D data)
+{
+    // Indices are copied to the GPU as they are, so ones past the vertices of the mesh would read the vertices of
+    // others. Such meshes keep their previous geometry.
+    if (data.num_indices > 0 && !data.indices)
+    {
+        NSLog(@"3D mesh %u has %u indices but no index data", id, data.num_indices);
+        return false;
+    }
+    if (!mesh_indices_valid(data.indices, data.num_indices, data.num_vertices))
+    {
+        NSLog(@"Indices of 3D mesh %u are out of range", id);
+        return false;
+    }
+
+    erase_terrain(id);
+    erase_impostor(id);
+    const Vertex3D *vertices = data.vertices;
+    const JointData *joints_weights = data.skin_data;
+    unsigned int num_vertices = data.num_vertices;
+    // A null pointer without a count draws the vertices as a triangle list.
+    const unsigned int *indices = data.num_indices > 0 ? data.indices : nullptr;
+    unsigned int num_indices = data.num_indices;
+
+    if (_weld_meshes && !indices && num_vertices > 0)
+    {
+        WeldedMesh &mesh = _welded_meshes[id];
+        weld_vertices(vertices, joints_weights, num_vertices, mesh.vertices, mesh.joints_weights, mesh.indices);
+        vertices = mesh.vertices.data();
+        joints_weights = joints_weights ? mesh.joints_weights.data() : nullptr;
+        num_vertices = static_cast<unsigned int>(mesh.vertices.size());
+        indices = mesh.indices.data();
+        num_indices = static_cast<unsigned int>(mesh.indices.size());
+    }
+    else
+    {
+        _welded_meshes.erase(id);
+    }
+
+    // Reordered meshes are kept like welded ones.
+    if ((data.flags & OPTIMIZE_ORDER) != 0 && indices && num_indices >= 3)
+    {
+        WeldedMesh ordered;
+        optimize_mesh_order(vertices, joints_weights, num_vertices, indices, num_indices, data.ranges, data.num_ranges,
+                            data.bounds, ordered.vertices, ordered.joints_weights, ordered.indices);
+        WeldedMesh &mesh = _welded_meshes[id];
+        mesh = std::move(ordered);
+        vertices = mesh.vertices.data();
+        joints_weights = joints_weights ? mesh.joints_weights.data() : nullptr;
+        indices = mesh.indices.data();
+    }
+
+    // Skinned vertices are written back in the full layout, so only static meshes get quantized.
+    if (_vertex_format == VERTEX_3D_PACKED && !joints_weights && num_vertices > 0)
+    {
+        PackedMesh &mesh = _packed_meshes[id];
+        pack_vertices(vertices, num_vertices, mesh.vertices, mesh.bounds);
+        _vertex_3d_list.remove_pointer(id);
+
+        if (_packed_3d_list.has(id))
+            _packed_3d_list.update_pointer(id, mesh.vertices.data(), num_vertices, nullptr, indices, num_indices);
+        else
+            _packed_3d_list.add_pointer(id, mesh.vertices.data(), num_vertices, nullptr, indices, num_indices);
+    }
+    else
+    {
+        _packed_meshes.erase(id);
+        _packed_3d_list.remove_pointer(id);
+
+        if (_vertex_3d_list.has(id))
+            _vertex_3d_list.update_pointer(id, vertices, num_vertices, joints_weights, indices, num_indices);
+        else
+            _vertex_3d_list.add_pointer(id, vertices, num_vertices, joints_weights, indices, num_indices);
+    }
+
+    // Skinned vertices move relative to the bounds of their clusters, so only static meshes get clustered.
+    if (_cluster_culling && !_packed_meshes.has(id) && !joints_weights && indices &&
+        num_indices / 3 >= CLUSTERED_MESH_TRIANGLES)
+    {
+        build_clusters(vertices, indices, num_indices, _mesh_clusters[id]);
+        _clusters_dirty = true;
+    }
+    else if (_mesh_clusters.erase(id))
+    {
+        _clusters_dirty = true;
+    }
+
+    // Skinned vertices leave the bounds of their ranges.
+    std::vector<Submesh> submeshes;
+    if (!joints_weights && data.ranges &&
+        build_submeshes(data.ranges, data.num_ranges, indices ? num_indices : num_vertices, submeshes))
+    {
+        _submeshes[id] = std::move(submeshes);
+        _moved_submeshes.push_back(id);
+    }
+    else
+    {
+        _submeshes.erase(id);
+    }
+
+    // The vertex lists keep their own copies, which makes the intermediate ones redundant.
+    if (_copy_on_submit)
+    {
+        _welded_meshes.erase(id);
+        if (PackedMesh *mesh = _packed_meshes.find(id))
+            std::vector<PackedVertex3D>().swap(mesh->vertices);
+    }
+
+    // Nothing points into a recorded copy of the mesh anymore, and a cached one is outdated.
+    _recorded_meshes.erase(id);
+    _mesh_cache.erase(id);
+    _acceleration_structures.mark_mesh_changed(id);
+    _bvh_scene.mark_mesh_changed(id);
+    _sdf_scene.set_mesh(id, data.triangles, data.num_triangles);
+    // The compute BVH can't read GPU-only vertices back once the mesh is traced.
+    if (_ray_tracing_supported && !_hardware_tracing && _vertex_3d_list.private_storage() && !_packed_meshes.has(id))
+        _bvh_scene.set_mesh(id, vertices, num_vertices, indices, num_indices);
+    if (!_mesh_drawn_frames.has(id))
+        _mesh_drawn_frames.insert(id, _frames_rendered);
+
+    // Static batches are merged from a copy, the caller's data is only read until the next synchronize.
+    if ((data.flags & STATIC) != 0 && !joints_weights && num_vertices > 0)
+    {
+        _static_meshes.insert(id, copy_static_mesh(vertices, num_vertices, indices, num_indices));
+        _static_batches_dirty = true;
+    }
+    else if (_static_meshes.erase(id))
+    {
+        _static_batches_dirty = true;
+    }
+
+    if ((data.flags & TRANSPARENT) != 0)
+        _transparent_meshes[id] = true;
+    else
+        _transparent_meshes.erase(id);
+
+    if ((data.flags & SHADOW_CASTER) != 0)
+    {
+        if (!_shadow_casters.has(id))
+            _shadow_casters.insert(id, empty_bounds());
+        mark_instances_moved(id);
+    }
+    else
+    {
+        remove_caster(id);
+    }
+    // Probes around the instances of the mesh reflect its old geometry.
+    if (!_probes.empty())
+        _probe_moved.push_back(id);
+
+    _flags |= Flags::Update3D;
+    return true;
+}
+
+bool MetalRenderer::set_3d_mesh_encoded(unsigned int id, MeshData3D data, const EncodedMesh3D &encoded)
+{
+    WeldedMesh decoded;
+    if (!encoded.vertices || !decode_vertices(encoded.vertices, encoded.num_vertex_bytes, decoded.vertices) ||
+        (encoded.indices && !decode_indices(encoded.indices, encoded.num_index_bytes, decoded.indices)))
+    {
+        NSLog(@"Encoded geometry of 3D mesh %u is malformed", id);
+        return false;
+    }
+    const auto num_vertices = static_cast<unsigned int>(decoded.vertices.size());
+    if (!mesh_indices_valid(decoded.indices.data(), static_cast<unsigned int>(decoded.indices.size()), num_vertices))
+    {
+        NSLog(@"Encoded indices of 3D mesh %u are out of range", id);
+        return false;
+    }
+
+    data.vertices = decoded.vertices.data();
+    data.num_vertices = num_vertices;
+    data.indices = decoded.indices.empty() ? nullptr : decoded.indices.data();
+    data.num_indices = static_cast<unsigned int>(decoded.indices.size());
+    if (_capture)
+        _capture->set_3d_mesh(id, data);
+    if (!set_3d_mesh(id, data))
+        return false;
+
+    // The vertex lists point into the decoded copy, which is kept like a welded one. Welded meshes and copies made on
+    // submit don't need it.
+    if (!_copy_on_submit && !_welded_meshes.has(id))
+        _welded_meshes[id] = std::move(decoded);
+    return true;
+}
+
+void MetalRenderer::set_3d_instances(unsigned int id, InstancesData3D data)
+{
+    _static_batches_dirty |= _static_meshes.has(id);
+    leave_prefab(id);
+    erase_instance_animation(id);
+    erase_scatter(id);
+    if (id >= _instance_3d_matrices.size())
+    {
+        _instance_3d_matrices.resize(id + 1);
+        _instance_3d_bounds.resize(id + 1);
+        _instance_3d_skin_ids.resize(id + 1);
+    }
+    _instance_3d_bounds[id] = data.local_aabb;
+    _acceleration_structures.set_bounds(id, data.local_aabb);
+
+    std::vector<int> &skin_ids = _instance_3d_skin_ids[id];
+    const unsigned int num_skin_ids = data.skin_ids ? data.num_skin_ids : 0;
+    if (skin_ids.size() != num_skin_ids || !std::equal(skin_ids.begin(), skin_ids.end(), data.skin_ids))
+    {
+        skin_ids.assign(data.skin_ids, data.skin_ids + num_skin_ids);
+        _skinning_dirty = true;
+    }
+
+    if (!_instance_3d_matrices[id])
+        _instance_3d_matrices[id] = std::make_shared<std::vector<mat4>>();
+
+    // When the instance count is unchanged, only instances flagged as transformed are copied and uploaded.
+    std::vector<mat4> &matrices = *_instance_3d_matrices[id];
+    if (_instance_3d_list.has(id) && data.flags && data.num_flags >= data.num_matrices &&
+        matrices.size() == data.num_matrices)
+    {
+        const auto *source = reinterpret_cast<const mat4 *>(data.matrices);
+        bool changed = false;
+        for (unsigned int first = 0; first < data.num_matrices;)
+        {
+            if ((data.flags[first] & TRANSFORMED) == 0)
+            {
+                first++;
+                continue;
+            }
+
+            unsigned int last = first + 1;
+            while (last < data.num_matrices && (data.flags[last] & TRANSFORMED) != 0)
+                last++;
+
+            std::memcpy(matrices.data() + first, source + first, (last - first) * sizeof(mat4));
+            _instance_3d_list.mark_changed(id, first, last);
+            mark_instances_transformed(id, first, last);
+            _bvh_scene.mark_instances_changed();
+            _sdf_scene.mark_instances_changed();
+            changed = true;
+            first = last;
+        }
+
+        if (changed)
+        {
+            mark_instances_moved(id);
+            _flags |= Flags::UpdateTransforms3D;
+        }
+        return;
+    }
+
+    // Normal matrices are derived in the vertex shader, only the transforms get uploaded.
+    _instance_3d_matrices[id]->resize(data.num_matrices);
+    if (data.num_matrices > 0)
+        std::memcpy(_instance_3d_matrices[id]->data(), data.matrices, data.num_matrices * sizeof(mat4));
+
+    if (_instance_3d_list.has(id))
+    {
+        _instance_3d_list.update_instances_list(id, _instance_3d_matrices[id]->data(),
+                                                static_cast<unsigned int>(_instance_3d_matrices[id]->size()));
+    }
+    else
+    {
+        _instance_3d_list.add_instances_list(id, _instance_3d_matrices[id]->data(),
+                                             static_cast<unsigned int>(_instance_3d_matrices[id]->size()));
+    }
+
+    mark_instances_moved(id);
+    _flags |= Flags::UpdateInstances3D;
+}
+
+Vertex3D *MetalRenderer::map_3d_mesh(unsigned int id, unsigned int num_vertices)
+{
+    // The caller writes straight into the vertex buffer, which needs memory the CPU and GPU share.
+    if (![_device hasUnifiedMemory] || _vertex_3d_list.private_storage())
+        return nullptr;
+
+    erase_terrain(id);
+    erase_impostor(id);
+    _welded_meshes.erase(id);
+    _packed_meshes.erase(id);
+    _submeshes.erase(id);
+    _packed_3d_list.remove_pointer(id);
+    _vertex_3d_list.map_pointer(id, num_vertices);
+    _acceleration_structures.mark_mesh_changed(id);
+    _bvh_scene.mark_mesh_changed(id);
+    _sdf_scene.mark_mesh_changed(id);
+
+    if (_vertex_3d_list.needs_reallocation())
+    {
+        // Growing copies the current buffer on the CPU, the GPU must not be using it.
+        acquire_all_frames();
+        _vertex_3d_list.update_ranges();
+        _vertex_3d_list.update_data(_device);
+        release_all_frames();
+    }
+
+    _flags |= Flags::Update3D;
+    return _vertex_3d_list.mapped_data(id);
+}
+
+void *MetalRenderer::map_texture(unsigned int index, const TextureData &data)
+{
+    // Levels are copied as they are written, formats that are transcoded or converted need set_textures.
+    if (data.width == 0 || data.height == 0 || data.mip_levels == 0 || data.format == KTX2 || transcodes(data) ||
+        device_format(data) != data.format)
+        return nullptr;
+
+    // Shared memory is a valid blit source on discrete GPUs too, write-combined as the CPU only writes it.
+    id<MTLBuffer> buffer = [_device newBufferWithLength:std::max<size_t>(mip_levels_size(data, 0), 1)
+                                                options:MTLResourceStorageModeShared |
+                                                        MTLResourceCPUCacheModeWriteCombined];
+    if (buffer == nil)
+        return nullptr;
+    buffer.label = @"MappedTexture";
+
+    MappedTexture &mapped = _mapped_textures[index];
+    mapped = {index, data, buffer};
+    mapped.data.bytes = static_cast<const unsigned char *>([buffer contents]);
+    mapped.data.num_bytes = buffer.length;
+    return [buffer contents];
+}
+
+void MetalRenderer::commit_texture(unsigned int index)
+{
+    MappedTexture *mapped = _mapped_textures.find(index);
+    if (!mapped)
+        return;
+
+    // The slot keeps its previous contents until the copy of the new texture completed.
+    MappedTexture committed = *mapped;
+    _mapped_textures.erase(index);
+    replace_texture_slot(index);
+    _committed_textures.push_back(committed);
+}
+
+simd_float4x4 *MetalRenderer::map_3d_instances(unsigned int id, unsigned int count)
+{
+    _static_batches_dirty |= _static_meshes.has(id);
+    leave_prefab(id);
+    erase_instance_animation(id);
+    erase_scatter(id);
+    if (id >= _instance_3d_matrices.size())
+    {
         _instance_3d_matrices.resize(id + 1);
+        _instance_3d_bounds.resize(id + 1);
+        _instance_3d_skin_ids.resize(id + 1);
+    }
 
     if (!_instance_3d_matrices[id])
-        _instance_3d_matrices[id] = std::make_shared<std::vector<Matrices>>();
+        _instance_3d_matrices[id] = std::make_shared<std::vector<mat4>>();
+
+    // The instance list reads from this storage directly, so only a size change needs to re-register it.
+    std::vector<mat4> &matrices = *_instance_3d_matrices[id];
+    if (!_instance_3d_list.has(id))
+    {
+        matrices.resize(count);
+        _instance_3d_list.add_instances_list(id, matrices.data(), count);
+        _flags |= Flags::UpdateInstances3D;
+    }
+    else if (matrices.size() != count)
+    {
+        matrices.resize(count);
+        _instance_3d_list.update_instances_list(id, matrices.data(), count);
+        _flags |= Flags::UpdateInstances3D;
+    }
+
+    // The caller writes the matrices after this call, the bounds are updated once the frame gets rendered.
+    mark_instances_moved(id);
+    return reinterpret_cast<simd_float4x4 *>(matrices.data());
+}
+
+void MetalRenderer::mark_3d_instances_changed(unsigned int id, unsigned int first, unsigned int last)
+{
+    if (const unsigned int *owner = _prefab_owners.find(id))
+        id = *owner;
+    _static_batches_dirty |= _static_meshes.has(id);
+    if (!_instance_3d_list.has(id))
+        return;
+
+    _instance_3d_list.mark_changed(id, first, last);
+    mark_instances_transformed(id, first, last);
+    _bvh_scene.mark_instances_changed();
+    _sdf_scene.mark_instances_changed();
+    mark_instances_moved(id);
+    _flags |= Flags::UpdateTransforms3D;
+}
+
+void MetalRenderer::unload_3d_meshes(const unsigned int *ids, unsigned int num)
+{
+    for (unsigned int i = 0; i < num; i++)
+        unload_3d_mesh(ids[i]);
+    _skinning_dirty = true;
+}
+
+void MetalRenderer::unload_3d_meshes(const size_t *ids, unsigned int num)
+{
+    for (unsigned int i = 0; i < num; i++)
+        unload_3d_mesh(static_cast<unsigned int>(ids[i]));
+    _skinning_dirty = true;
+}
+
+void MetalRenderer::unload_3d_mesh(unsigned int id)
+{
+    cache_3d_mesh(id);
+    erase_terrain(id);
+    erase_impostor(id);
+    _vertex_3d_list.remove_pointer(id);
+    _packed_3d_list.remove_pointer(id);
+    _welded_meshes.erase(id);
+    _packed_meshes.erase(id);
+    _recorded_meshes.erase(id);
+    _mesh_drawn_frames.erase(id);
+    _mesh_lods.erase(id);
+    _transparent_meshes.erase(id);
+    _clusters_dirty |= _mesh_clusters.erase(id);
+    _submeshes.erase(id);
+    erase_instance_animation(id);
+    erase_scatter(id);
+    leave_prefab(id);
+    dissolve_prefab(id);
+    _static_batches_dirty |= _static_meshes.erase(id);
+    if (id < _instance_3d_matrices.size() && _instance_3d_matrices[id])
+        _instance_3d_matrices[id]->clear();
+    _instance_3d_list.remove_instances_list(id);
+    if (id < _instance_3d_skin_ids.size())
+        _instance_3d_skin_ids[id].clear();
+    remove_caster(id);
+    if (!_probes.empty())
+        _probe_moved.push_back(id);
+}
+
+void MetalRenderer::set_3d_mesh_lods(unsigned int id, const MeshLod *levels, unsigned int num_levels)
+{
+    // Levels are looked up by GPU culling every frame, only static batches leave out meshes with levels.
+    _static_batches_dirty |= _static_meshes.has(id);
+    num_levels = std::min(num_levels, static_cast<unsigned int>(MAX_MESH_LODS));
+    if (num_levels == 0 || !levels)
+        _mesh_lods.erase(id);
+    else
+        _mesh_lods[id].assign(levels, levels + num_levels);
+}
+
+void MetalRenderer::set_3d_prefab(const PrefabMesh3D *meshes, unsigned int count)
+{
+    if (!meshes || count == 0)
+        return;
+
+    const unsigned int owner = meshes[0].mesh_id;
+    unsigned int id_bound = owner + 1;
+    for (unsigned int i = 1; i < count; i++)
+        id_bound = std::max(id_bound, meshes[i].mesh_id + 1);
+    if (id_bound > _instance_3d_matrices.size())
+    {
+        _instance_3d_matrices.resize(id_bound);
+        _instance_3d_bounds.resize(id_bound);
+        _instance_3d_skin_ids.resize(id_bound);
+    }
+
+    // The owner keeps its instances, an owner without any gets an empty list the members can share.
+    leave_prefab(owner);
+    dissolve_prefab(owner);
+    if (!_instance_3d_matrices[owner])
+        _instance_3d_matrices[owner] = std::make_shared<std::vector<mat4>>();
+    if (!_instance_3d_list.has(owner))
+    {
+        std::vector<mat4> &matrices = *_instance_3d_matrices[owner];
+        _instance_3d_list.add_instances_list(owner, matrices.data(), static_cast<unsigned int>(matrices.size()));
+    }
+
+    std::vector<unsigned int> members;
+    for (unsigned int i = 1; i < count; i++)
+    {
+        const unsigned int id = meshes[i].mesh_id;
+        if (id == owner || std::find(members.begin(), members.end(), id) != members.end())
+            continue;
+
+        leave_prefab(id);
+        dissolve_prefab(id);
+        erase_instance_animation(id);
+        erase_scatter(id);
+        _instance_3d_bounds[id] = meshes[i].local_aabb;
+        _acceleration_structures.set_bounds(id, meshes[i].local_aabb);
+        if (!_instance_3d_skin_ids[id].empty())
+        {
+            _instance_3d_skin_ids[id].clear();
+            _skinning_dirty = true;
+        }
+
+        // Members draw the instance range of the owner, the list follows it whenever it moves.
+        _instance_3d_matrices[id] = _instance_3d_matrices[owner];
+        _instance_3d_list.alias_instances_list(id, owner);
+        _prefab_owners.insert(id, owner);
+        members.push_back(id);
+    }
+
+    if (!members.empty())
+        _prefab_members.insert(owner, std::move(members));
+    _static_batches_dirty |= !_static_meshes.empty();
+    mark_instances_moved(owner);
+    _bvh_scene.mark_instances_changed();
+    _sdf_scene.mark_instances_changed();
+    _flags |= Flags::UpdateInstances3D;
+}
+
+void MetalRenderer::leave_prefab(unsigned int id)
+{
+    const unsigned int *found = _prefab_owners.find(id);
+    if (!found)
+        return;
+
+    const unsigned int owner = *found;
+    std::vector<unsigned int> &members = *_prefab_members.find(owner);
+    members.erase(std::find(members.begin(), members.end(), id));
+    if (members.empty())
+        _prefab_members.erase(owner);
+    _prefab_owners.erase(id);
+
+    mark_instances_moved(id);
+    _instance_3d_matrices[id].reset();
+    _instance_3d_list.remove_instances_list(id);
+    _bvh_scene.mark_instances_changed();
+    _sdf_scene.mark_instances_changed();
+    _flags |= Flags::UpdateInstances3D;
+}
+
+void MetalRenderer::dissolve_prefab(unsigned int id)
+{
+    const std::vector<unsigned int> *found = _prefab_members.find(id);
+    if (!found)
+        return;
+
+    const std::vector<unsigned int> members = *found;
+    for (const unsigned int member : members)
+        leave_prefab(member);
+}
+
+void MetalRenderer::set_3d_instance_animation(unsigned int id, InstanceAnimation3D animation)
+{
+    const unsigned int count = animation.instances ? animation.num_instances : 0;
+    std::vector<simd_float4x4> matrices(count);
+    for (unsigned int i = 0; i < count; i++)
+    {
+        const simd_float4 p = animation.instances[i].position;
+        matrices[i] = simd_matrix(simd_make_float4(p.w, 0.0f, 0.0f, 0.0f), simd_make_float4(0.0f, p.w, 0.0f, 0.0f),
+                                  simd_make_float4(0.0f, 0.0f, p.w, 0.0f), simd_make_float4(p.x, p.y, p.z, 1.0f));
+    }
+
+    InstancesData3D data = {};
+    data.local_aabb = id < _instance_3d_bounds.size() ? _instance_3d_bounds[id] : Aabb{};
+    data.matrices = matrices.data();
+    data.num_matrices = count;
+    set_3d_instances(id, data);
+    if (count == 0)
+        return;
+
+    InstanceAnimator animator = {};
+    animator.uniforms.type = animation.type;
+    animator.uniforms.count = count;
+    animator.uniforms.amplitude = animation.amplitude;
+    animator.uniforms.frequency = animation.frequency;
+    animator.instances = [_device newBufferWithBytes:animation.instances
+                                              length:count * sizeof(AnimatedInstance)
+                                             options:cpu_write_storage(_device)];
+    animator.instances.label = @"AnimatedInstances";
+    _instance_animations.insert(id, animator);
+}
+
+void MetalRenderer::set_3d_instance_overrides(unsigned int id, const InstanceOverride *overrides, unsigned int count)
+{
+    _instance_overrides.set(id, overrides, overrides ? count : 0);
+    _flags |= Flags::UpdateInstances3D;
+}
+
+void MetalRenderer::set_visibility_group(unsigned int id, const Aabb &bounds)
+{
+    _visibility.set(id, bounds);
+}
+
+void MetalRenderer::remove_visibility_group(unsigned int id)
+{
+    _visibility.erase(id);
+}
+
+uint64_t MetalRenderer::visibility_samples(unsigned int id) const
+{
+    return _visibility.samples(id);
+}
+
+void MetalRenderer::erase_instance_animation(unsigned int id)
+{
+    if (const InstanceAnimator *animator = _instance_animations.find(id))
+        _retired.retire(animator->instances);
+    _instance_animations.erase(id);
+}
+
+bool MetalRenderer::transformed_on_gpu(unsigned int id) const
+{
+    if (const unsigned int *owner = _prefab_owners.find(id))
+        id = *owner;
+    return _instance_animations.has(id) || _scatters.has(id) ||
+           std::binary_search(_hierarchy.meshes.begin(), _hierarchy.meshes.end(), id);
+}
+
+void MetalRenderer::set_3d_hierarchy(const TransformNode *nodes, unsigned int num_nodes)
+{
+    // Instances of the previous hierarchy get their own transforms back, and their shadows redrawn.
+    const IdTable<InstanceRange<mat4>> &ranges = _instance_3d_list.get_ranges();
+    for (const unsigned int mesh : _hierarchy.meshes)
+    {
+        if (const InstanceRange<mat4> *range = ranges.find(mesh))
+            _instance_3d_list.mark_changed(mesh, 0, range->count);
+        if (_shadow_casters.has(mesh))
+            _moved_casters.push_back(mesh);
+    }
+    _flags |= Flags::UpdateInstances3D;
+    _path_tracer.samples = 0;
+    _static_batches_dirty |= !_static_meshes.empty();
+    _retired.retire(_hierarchy.links, _hierarchy.locals, _hierarchy.worlds);
+    _hierarchy = TransformHierarchy();
+    if (num_nodes == 0 || !nodes)
+        return;
+
+    // Nodes whose parent does not come before them are treated as roots.
+    const auto parent_of = [nodes](unsigned int i) {
+        return nodes[i].parent >= 0 && static_cast<unsigned int>(nodes[i].parent) < i ? nodes[i].parent : -1;
+    };
+    std::vector<unsigned int> depths(num_nodes);
+    for (unsigned int i = 0; i < num_nodes; i++)
+    {
+        const int parent = parent_of(i);
+        depths[i] = parent >= 0 ? depths[parent] + 1 : 0;
+        if (depths[i] >= _hierarchy.levels.size())
+            _hierarchy.levels.resize(depths[i] + 1, simd_make_uint2(0, 0));
+        _hierarchy.levels[depths[i]].y++;
+    }
+    for (size_t level = 1; level < _hierarchy.levels.size(); level++)
+        _hierarchy.levels[level].x = _hierarchy.levels[level - 1].x + _hierarchy.levels[level - 1].y;
+
+    std::vector<unsigned int> next(_hierarchy.levels.size());
+    for (size_t level = 0; level < next.size(); level++)
+        next[level] = _hierarchy.levels[level].x;
+    _hierarchy.order.resize(num_nodes);
+    for (unsigned int i = 0; i < num_nodes; i++)
+        _hierarchy.order[i] = next[depths[i]]++;
+
+    std::vector<InstanceTransform> locals(num_nodes);
+    _hierarchy.parents.resize(num_nodes);
+    _hierarchy.targets.resize(num_nodes);
+    for (unsigned int i = 0; i < num_nodes; i++)
+    {
+        const unsigned int node = _hierarchy.order[i];
+        const int parent = parent_of(i);
+        _hierarchy.parents[node] = parent >= 0 ? static_cast<int>(_hierarchy.order[parent]) : -1;
+        _hierarchy.targets[node] = simd_make_uint2(nodes[i].mesh, nodes[i].instance);
+        store_instances(&locals[node], reinterpret_cast<const mat4 *>(&nodes[i].local), 1);
+        if (nodes[i].mesh != NO_HIERARCHY_INSTANCE)
+            _hierarchy.meshes.push_back(nodes[i].mesh);
+    }
+    std::sort(_hierarchy.meshes.begin(), _hierarchy.meshes.end());
+    _hierarchy.meshes.erase(std::unique(_hierarchy.meshes.begin(), _hierarchy.meshes.end()), _hierarchy.meshes.end());
+    _hierarchy.update_slots.assign(num_nodes, ~0u);
+
+    _hierarchy.locals = [_device newBufferWithBytes:locals.data()
+                                             length:num_nodes * sizeof(InstanceTransform)
+                                            options:cpu_write_storage(_device)];
+    _hierarchy.locals.label = @"HierarchyLocals";
+    _hierarchy.worlds = [_device newBufferWithLength:num_nodes * sizeof(InstanceTransform)
+                                             options:MTLResourceStorageModePrivate];
+    _hierarchy.worlds.label = @"HierarchyWorlds";
+}
+
+void MetalRenderer::set_terrain(unsigned int id, const TerrainData &data)
+{
+    erase_terrain(id);
+    erase_impostor(id);
+    if (!data.heights || data.width < 2 || data.height < 2 || data.spacing <= 0.0f)
+    {
+        unload_3d_meshes(&id, 1);
+        return;
+    }
+
+    Terrain3D terrain;
+    TerrainUniforms &uniforms = terrain.uniforms;
+    uniforms.origin = data.origin;
+    uniforms.spacing = data.spacing;
+    uniforms.uv_scale = data.uv_scale > 0.0f ? data.uv_scale : 1.0f;
+    uniforms.width = data.width;
+    uniforms.height = data.height;
+    uniforms.levels = std::clamp(data.levels, 1u, static_cast<unsigned int>(TERRAIN_MAX_LEVELS));
+    constexpr unsigned int full_level = TERRAIN_GRID * TERRAIN_GRID;
+    uniforms.cells = full_level + (uniforms.levels - 1) * (full_level - full_level / 4);
+    uniforms.material = data.material;
+    uniforms.has_materials = data.materials ? 1 : 0;
+
+    const size_t count = static_cast<size_t>(data.width) * data.height;
+    terrain.heights = [_device newBufferWithBytes:data.heights
+                                           length:count * sizeof(float)
+                                          options:cpu_write_storage(_device)];
+    terrain.heights.label = @"TerrainHeights";
+    if (data.materials)
+    {
+        terrain.materials = [_device newBufferWithBytes:data.materials
+                                                 length:count * sizeof(unsigned int)
+                                                options:cpu_write_storage(_device)];
+        terrain.materials.label = @"TerrainMaterials";
+    }
+    if (terrain.heights == nil || (data.materials && terrain.materials == nil))
+    {
+        NSLog(@"Could not allocate the heightmap of terrain %u.", id);
+        return;
+    }
+
+    // The vertices only live in the vertex buffer, where the GPU writes them. Without a copy to restore them from,
+    // terrains are never evicted.
+    _welded_meshes.erase(id);
+    _packed_meshes.erase(id);
+    _submeshes.erase(id);
+    _recorded_meshes.erase(id);
+    _mesh_cache.erase(id);
+    _mesh_drawn_frames.erase(id);
+    _clusters_dirty |= _mesh_clusters.erase(id);
+    _packed_3d_list.remove_pointer(id);
+    _vertex_3d_list.map_pointer(id, uniforms.cells * 6);
+    _acceleration_structures.mark_mesh_changed(id);
+    _bvh_scene.mark_mesh_changed(id);
+    _sdf_scene.mark_mesh_changed(id);
+
+    if ((data.flags & TRANSPARENT) != 0)
+        _transparent_meshes[id] = true;
+    else
+        _transparent_meshes.erase(id);
+    if ((data.flags & SHADOW_CASTER) != 0)
+    {
+        if (!_shadow_casters.has(id))
+            _shadow_casters.insert(id, empty_bounds());
+    }
+    else
+    {
+        remove_caster(id);
+    }
+    _terrains.insert(id, terrain);
+
+    const auto [lowest, highest] = std::minmax_element(data.heights, data.heights + count);
+    const simd_float4x4 identity = matrix_identity_float4x4;
+    InstancesData3D instances = {};
+    instances.local_aabb.bmin = simd_make_float4(data.origin.x, data.origin.y + *lowest, data.origin.z, 0.0f);
+    instances.local_aabb.bmax =
+        simd_make_float4(data.origin.x + static_cast<float>(data.width - 1) * data.spacing, data.origin.y + *highest,
+                         data.origin.z + static_cast<float>(data.height - 1) * data.spacing, 0.0f);
+    instances.matrices = &identity;
+    instances.num_matrices = 1;
+    set_3d_instances(id, instances);
+    _flags |= Flags::Update3D;
+}
+
+void MetalRenderer::erase_terrain(unsigned int id)
+{
+    if (const Terrain3D *terrain = _terrains.find(id))
+        _retired.retire(terrain->heights, terrain->materials);
+    _terrains.erase(id);
+}
+
+void MetalRenderer::set_3d_scatter(unsigned int id, const ScatterData &data)
+{
+    // Candidates are limited to a million, which also bounds the instances the mesh reserves.
+    constexpr unsigned int max_side = 1024;
+    InstancesData3D instances = {};
+    instances.local_aabb = id < _instance_3d_bounds.size() ? _instance_3d_bounds[id] : Aabb{};
+    if (data.spacing <= 0.0f || data.radius <= 0.0f)
+    {
+        set_3d_instances(id, instances);
+        return;
+    }
+
+    InstanceScatter scatter;
+    ScatterUniforms &uniforms = scatter.uniforms;
+    const float cells = std::ceil(data.radius / data.spacing);
+    uniforms.side = std::min(2 * static_cast<unsigned int>(std::min(cells, 1e6f)) + 1, max_side);
+    uniforms.count = uniforms.side * uniforms.side;
+    uniforms.seed = data.seed;
+    uniforms.spacing = data.spacing;
+    uniforms.radius = std::min(data.radius, static_cast<float>(uniforms.side / 2) * data.spacing);
+    uniforms.min_scale = data.min_scale;
+    uniforms.max_scale = data.max_scale;
+    scatter.terrain = data.terrain;
+    if (data.density && data.density_width > 0 && data.density_height > 0)
+    {
+        uniforms.density_width = data.density_width;
+        uniforms.density_height = data.density_height;
+        uniforms.has_density = 1;
+        const size_t bytes = static_cast<size_t>(data.density_width) * data.density_height * sizeof(float);
+        scatter.density = [_device newBufferWithBytes:data.density length:bytes options:cpu_write_storage(_device)];
+        scatter.density.label = @"ScatterDensity";
+        if (scatter.density == nil)
+        {
+            NSLog(@"Could not allocate the density of the scatter of mesh %u.", id);
+            return;
+        }
+    }
+
+    // The CPU instances have no size, only the GPU writes where the scattered instances are.
+    const std::vector<simd_float4x4> hidden(uniforms.count, simd_float4x4{});
+    instances.matrices = hidden.data();
+    instances.num_matrices = uniforms.count;
+    set_3d_instances(id, instances);
+    _scatters.insert(id, scatter);
+}
+
+void MetalRenderer::erase_scatter(unsigned int id)
+{
+    if (const InstanceScatter *scatter = _scatters.find(id))
+        _retired.retire(scatter->density);
+    _scatters.erase(id);
+}
+
+void MetalRenderer::bake_3d_impostor(unsigned int id, const ImpostorSettings &settings)
+{
+    const Aabb bounds = id < _instance_3d_bounds.size() ? _instance_3d_bounds[id] : Aabb{};
+    if (simd_any(bounds.bmin.xyz > bounds.bmax.xyz) || simd_all(bounds.bmin.xyz == bounds.bmax.xyz))
+    {
+        NSLog(@"Mesh %u has no instance bounds to bake an impostor of.", id);
+        return;
+    }
+    if (settings.mesh == id)
+    {
+        NSLog(@"The impostor of mesh %u needs a mesh of its own.", id);
+        return;
+    }
+
+    ImpostorBake bake;
+    bake.mesh = id;
+    bake.settings = settings;
+    bake.settings.tiles = std::clamp(settings.tiles, 2u, static_cast<unsigned int>(IMPOSTOR_MAX_TILES));
+    // Atlases stay within the largest texture size of every GPU family.
+    bake.settings.tile_size = std::clamp(settings.tile_size, 8u, 8192u / bake.settings.tiles);
+    bake.settings.grid =
+        settings.grid == 0 ? IMPOSTOR_GRID : std::min(settings.grid, static_cast<unsigned int>(IMPOSTOR_MAX_GRID));
+    bake.uniforms.center = (bounds.bmin + bounds.bmax) * 0.5f;
+    bake.uniforms.center.w = simd_length(bounds.bmax.xyz - bounds.bmin.xyz) * 0.5f;
+    bake.uniforms.tiles = bake.settings.tiles;
+
+    // A newer bake of the same impostor supersedes a queued one.
+    erase_impostor_bakes(settings.mesh);
+    _impostor_bakes.push_back(bake);
+}
+
+bool MetalRenderer::encode_impostor_bake(id<MTLCommandBuffer> command_buffer, ImpostorBake &bake,
+                                         const std::function<void(id<MTLRenderCommandEncoder>)> &use_resources)
+{
+    const PackedMesh *packed = _packed_meshes.find(bake.mesh);
+    const DrawDescriptor *range = packed ? _packed_3d_list.get_draw_ranges().find(bake.mesh)
+                                         : _vertex_3d_list.get_draw_ranges().find(bake.mesh);
+    if (!range || range->start >= range->end)
+        return true;
+    if (range->jw_end > range->jw_start || _impostors.has(bake.mesh))
+    {
+        NSLog(@"Mesh %u is skinned or an impostor itself, its impostor was not baked.", bake.mesh);
+        return false;
+    }
+
+    const unsigned int size = bake.settings.tiles * bake.settings.tile_size;
+    MTLTextureDescriptor *desc = [MTLTextureDescriptor texture2DDescriptorWithPixelFormat:MTLPixelFormatRGBA8Unorm
+                                                                                    width:size
+                                                                                   height:size
+                                                                                mipmapped:YES];
+    desc.usage = MTLTextureUsageRenderTarget | MTLTextureUsageShaderRead;
+    desc.storageMode = MTLStorageModePrivate;
+    id<MTLTexture> albedo = [_device newTextureWithDescriptor:desc];
+    id<MTLTexture> normal = [_device newTextureWithDescriptor:desc];
+    desc.pixelFormat = MTLPixelFormatDepth32Float;
+    desc.mipmapLevelCount = 1;
+    desc.usage = MTLTextureUsageRenderTarget;
+    id<MTLTexture> depth = [_device newTextureWithDescriptor:desc];
+    if (albedo == nil || normal == nil || depth == nil)
+    {
+        NSLog(@"Could not allocate the impostor atlases of mesh %u.", bake.mesh);
+        return false;
+    }
+    albedo.label = @"ImpostorAlbedo";
+    normal.label = @"ImpostorNormal";
+    depth.label = @"ImpostorDepth";
+
+    // Texels without coverage have an alpha of 0 in the albedo and the far depth in the normal atlas.
+    MTLRenderPassDescriptor *pass = [MTLRenderPassDescriptor renderPassDescriptor];
+    pass.colorAttachments[0].texture = albedo;
+    pass.colorAttachments[0].loadAction = MTLLoadActionClear;
+    pass.colorAttachments[0].storeAction = MTLStoreActionStore;
+    pass.colorAttachments[0].clearColor = MTLClearColorMake(0.0, 0.0, 0.0, 0.0);
+    pass.colorAttachments[1].texture = normal;
+    pass.colorAttachments[1].loadAction = MTLLoadActionClear;
+    pass.colorAttachments[1].storeAction = MTLStoreActionStore;
+    pass.colorAttachments[1].clearColor = MTLClearColorMake(0.5, 0.5, 1.0, 1.0);
+    pass.depthAttachment.texture = depth;
+    pass.depthAttachment.loadAction = MTLLoadActionClear;
+    pass.depthAttachment.storeAction = MTLStoreActionDontCare;
+    pass.depthAttachment.clearDepth = 1.0;
+    _frame_timer.time_render_pass(pass, FRAME_PASS_3D);
+
+    // Every tile draws one instance of the mesh.
+    id<MTLRenderCommandEncoder> encoder = [command_buffer renderCommandEncoderWithDescriptor:pass];
+    encoder.label = @"ImpostorBake";
+    [encoder setRenderPipelineState:packed ? _impostor_bake_packed_state : _impostor_bake_state];
+    [encoder setDepthStencilState:_standard_depth_state];
+    [encoder setFrontFacingWinding:MTLWindingCounterClockwise];
+    [encoder setCullMode:MTLCullModeBack];
+    use_resources(encoder);
+    [encoder setVertexBytes:&bake.uniforms length:sizeof(ImpostorBakeUniforms) atIndex:1];
+    [encoder setFragmentBytes:&bake.uniforms length:sizeof(ImpostorBakeUniforms) atIndex:1];
+    if (packed)
+        [encoder setVertexBytes:&packed->bounds length:sizeof(PackedVertexBounds) atIndex:2];
+    const NSUInteger tiles = bake.settings.tiles * bake.settings.tiles;
+    if (range->index_count > 0)
+    {
+        [encoder drawIndexedPrimitives:MTLPrimitiveTypeTriangle
+                            indexCount:range->index_count
+                             indexType:(range->short_indices ? MTLIndexTypeUInt16 : MTLIndexTypeUInt32)
+                           indexBuffer:(packed ? _packed_3d_list.index_buffer() : _vertex_3d_list.index_buffer())
+                     indexBufferOffset:range->index_offset
+                         instanceCount:tiles
+                            baseVertex:range->start
+                          baseInstance:0];
+    }
+    else
+    {
+        [encoder drawPrimitives:MTLPrimitiveTypeTriangle
+                    vertexStart:range->start
+                    vertexCount:(range->end - range->start)
+                  instanceCount:tiles];
+    }
+    [encoder endEncoding];
+    _retired.retire(depth);
+
+    id<MTLBlitCommandEncoder> blit = [command_buffer blitCommandEncoder];
+    blit.label = @"ImpostorMipmaps";
+    [blit generateMipmapsForTexture:albedo];
+    [blit generateMipmapsForTexture:normal];
+    [blit endEncoding];
+
+    // The slots bind the atlases once frames in flight are done with the texture table.
+    replace_texture_slot(bake.settings.albedo_texture);
+    _pending_textures.push_back({bake.settings.albedo_texture, albedo, 0, 0, 0});
+    replace_texture_slot(bake.settings.normal_texture);
+    _pending_textures.push_back({bake.settings.normal_texture, normal, 0, 0, 0});
+    _standalone_textures.push_back(albedo);
+    _standalone_textures.push_back(normal);
+    update_texture_residency();
+    _flags |= Flags::UpdateTextures;
+
+    bake.albedo = albedo;
+    bake.normal = normal;
+    return true;
+}
+
+void MetalRenderer::add_baked_impostors()
+{
+    const auto bound = [&](unsigned int index, id<MTLTexture> texture) {
+        return index < _textures.size() && _textures[index] == texture;
+    };
+    const auto pending = [&](id<MTLTexture> texture) {
+        return std::any_of(_pending_textures.begin(), _pending_textures.end(),
+                           [&](const PendingTexture &p) { return p.index != ~0u && p.texture == texture; });
+    };
+
+    size_t remaining = 0;
+    for (size_t i = 0; i < _impostor_bakes.size(); i++)
+    {
+        const ImpostorBake &bake = _impostor_bakes[i];
+        if (bake.albedo != nil && bound(bake.settings.albedo_texture, bake.albedo) &&
+            bound(bake.settings.normal_texture, bake.normal))
+            add_impostor(bake);
+        else if (bake.albedo == nil || pending(bake.albedo) || pending(bake.normal))
+            _impostor_bakes[remaining++] = bake;
+    }
+    _impostor_bakes.resize(remaining);
+}
+
+void MetalRenderer::add_impostor(const ImpostorBake &bake)
+{
+    const unsigned int id = bake.settings.mesh;
+    const unsigned int grid = bake.settings.grid;
+    const float step = 1.0f / static_cast<float>(grid);
+    std::vector<Vertex3D> &vertices = _impostors[id];
+    vertices.clear();
+    vertices.reserve(grid * grid * 6);
+    // Cells are wound like the front faces of meshes seen along the direction of a tile.
+    static const float CORNERS[6][2] = {{0, 0}, {1, 0}, {1, 1}, {0, 0}, {1, 1}, {0, 1}};
+    for (unsigned int y = 0; y < grid; y++)
+    {
+        for (unsigned int x = 0; x < grid; x++)
+        {
+            for (const auto &corner : CORNERS)
+            {
+                Vertex3D v = {};
+                v.v_x = bake.uniforms.center.x;
+                v.v_y = bake.uniforms.center.y;
+                v.v_z = bake.uniforms.center.z;
+                v.v_w = 1.0f;
+                v.n_x = bake.uniforms.center.w;
+                v.n_y = static_cast<float>(bake.settings.tiles);
+                v.mat_id = bake.settings.material | IMPOSTOR_VERTEX;
+                v.u = (static_cast<float>(x) + corner[0]) * step;
+                v.v = (static_cast<float>(y) + corner[1]) * step;
+                v.pad0 = (static_cast<float>(x) + 0.5f) * step;
+                v.pad1 = (static_cast<float>(y) + 0.5f) * step;
+                v.t_x = 1.0f;
+                v.t_w = 1.0f;
+                vertices.push_back(v);
+            }
+        }
+    }
+
+    // Impostor vertices are never packed or evicted, the vertex list points into their copy.
+    erase_terrain(id);
+    _welded_meshes.erase(id);
+    _packed_meshes.erase(id);
+    _submeshes.erase(id);
+    _recorded_meshes.erase(id);
+    _mesh_cache.erase(id);
+    _mesh_drawn_frames.erase(id);
+    _transparent_meshes.erase(id);
+    _clusters_dirty |= _mesh_clusters.erase(id);
+    _packed_3d_list.remove_pointer(id);
+    const auto count = static_cast<unsigned int>(vertices.size());
+    if (_vertex_3d_list.has(id))
+        _vertex_3d_list.update_pointer(id, vertices.data(), count);
+    else
+        _vertex_3d_list.add_pointer(id, vertices.data(), count);
+    _acceleration_structures.mark_mesh_changed(id);
+    _bvh_scene.mark_mesh_changed(id);
+    _sdf_scene.mark_mesh_changed(id);
+
+    // Impostors cast the shadows of their mesh.
+    if (_shadow_casters.has(bake.mesh))
+    {
+        if (!_shadow_casters.has(id))
+            _shadow_casters.insert(id, empty_bounds());
+    }
+    else
+    {
+        remove_caster(id);
+    }
+
+    std::vector<MeshLod> &levels = _mesh_lods[bake.mesh];
+    const auto impostor = [id](const MeshLod &level) { return level.mesh_id == id; };
+    levels.erase(std::remove_if(levels.begin(), levels.end(), impostor), levels.end());
+    if (levels.size() == MAX_MESH_LODS)
+        levels.pop_back();
+    levels.push_back({id, bake.settings.screen_size});
+    _flags |= Flags::Update3D;
+}
+
+void MetalRenderer::erase_impostor(unsigned int id)
+{
+    _impostors.erase(id);
+    erase_impostor_bakes(id);
+}
+
+void MetalRenderer::build_static_batches()
+{
+    TraceSpan span(_trace, "build_static_batches");
+    _static_batches_dirty = false;
+    for (const StaticBatch &batch : _static_batches)
+    {
+        for (const unsigned int id : batch.meshes)
+        {
+            const std::vector<mat4> *matrices = id < _instance_3d_matrices.size() ? _instance_3d_matrices[id].get()
+                                                                                   : nullptr;
+            if (!matrices || _instance_3d_list.has(id) || (!_vertex_3d_list.has(id) && !_packed_3d_list.has(id)))
+                continue;
+
+            _instance_3d_list.add_instances_list(id, matrices->data(), static_cast<unsigned int>(matrices->size()));
+            mark_instances_moved(id);
+        }
+    }
+
+    // Only opaque meshes with one instance the CPU knows are merged, levels of detail, prefabs and GPU transforms
+    // need meshes of their own.
+    std::map<StaticCell, StaticBatch> cells;
+    const float cell_size = _static_batching.cell_size;
+    for (const auto &[id, mesh] : _static_meshes)
+    {
+        const std::vector<mat4> *matrices = id < _instance_3d_matrices.size() ? _instance_3d_matrices[id].get()
+                                                                               : nullptr;
+        if (cell_size <= 0.0f || !matrices || matrices->size() != 1 || transformed_on_gpu(id) ||
+            _transparent_meshes.has(id) || _mesh_lods.has(id) || _prefab_members.has(id) ||
+            _prefab_owners.has(id) || _morph_targets.has(id))
+            continue;
+
+        const Aabb bounds = world_bounds(mesh.bounds, *matrices);
+        if (simd_any(bounds.bmax.xyz - bounds.bmin.xyz >= 1e30f))
+            continue;
+        const simd_float4 cell = simd_floor((bounds.bmin + bounds.bmax) * 0.5f / cell_size);
+        const StaticCell key = {static_cast<int>(cell.x), static_cast<int>(cell.y), static_cast<int>(cell.z),
+                                _shadow_casters.has(id)};
+        cells[key].meshes.push_back(id);
+    }
+
+    std::vector<StaticBatch> batches;
+    for (auto &[key, batch] : cells)
+    {
+        if (batch.meshes.size() < 2)
+            continue;
+        if (batches.size() == _static_batching.max_batches)
+            break;
+
+        batch.id = _static_batching.first_id + static_cast<unsigned int>(batches.size());
+        batch.caster = key.caster;
+        batch.bounds = empty_bounds();
+        for (const unsigned int id : batch.meshes)
+        {
+            const std::vector<mat4> &matrices = *_instance_3d_matrices[id];
+            const StaticMesh &mesh = *_static_meshes.find(id);
+            append_static_mesh(batch, mesh, matrices[0]);
+            const Aabb bounds = world_bounds(mesh.bounds, matrices);
+            batch.bounds.bmin = simd_min(batch.bounds.bmin, bounds.bmin);
+            batch.bounds.bmax = simd_max(batch.bounds.bmax, bounds.bmax);
+
+            // The batch draws the mesh from now on, its shadows move into the batch.
+            _instance_3d_list.remove_instances_list(id);
+            mark_instances_moved(id);
+        }
+        batches.push_back(std::move(batch));
+    }
+
+    for (size_t i = batches.size(); i < _static_batches.size(); i++)
+        remove_static_batch_mesh(_static_batches[i].id);
+    for (const StaticBatch &batch : batches)
+        set_static_batch_mesh(batch);
+
+    // The vertex list points into the new batches, the old ones are only freed once it no longer does.
+    _static_batches = std::move(batches);
+    _flags |= Flags::Update3D | Flags::UpdateInstances3D;
+}
+
+void MetalRenderer::set_static_batch_mesh(const StaticBatch &batch)
+{
+    const unsigned int id = batch.id;
+    const auto num_vertices = static_cast<unsigned int>(batch.vertices.size());
+    const auto num_indices = static_cast<unsigned int>(batch.indices.size());
+    if (_vertex_3d_list.has(id))
+        _vertex_3d_list.update_pointer(id, batch.vertices.data(), num_vertices, nullptr, batch.indices.data(),
+                                       num_indices);
+    else
+        _vertex_3d_list.add_pointer(id, batch.vertices.data(), num_vertices, nullptr, batch.indices.data(),
+                                    num_indices);
+    _acceleration_structures.mark_mesh_changed(id);
+    _bvh_scene.mark_mesh_changed(id);
+    _sdf_scene.mark_mesh_changed(id);
+    if (_ray_tracing_supported && !_hardware_tracing && _vertex_3d_list.private_storage())
+        _bvh_scene.set_mesh(id, batch.vertices.data(), num_vertices, batch.indices.data(), num_indices);
+
+    if (batch.caster)
+    {
+        if (!_shadow_casters.has(id))
+            _shadow_casters.insert(id, empty_bounds());
+    }
+    else
+    {
+        remove_caster(id);
+    }
+
+    if (id >= _instance_3d_matrices.size())
+    {
+        _instance_3d_matrices.resize(id + 1);
+        _instance_3d_bounds.resize(id + 1);
+        _instance_3d_skin_ids.resize(id + 1);
+    }
+    _instance_3d_matrices[id] = std::make_shared<std::vector<mat4>>(1, mat4(1.0f));
+    _instance_3d_bounds[id] = batch.bounds;
+    _acceleration_structures.set_bounds(id, batch.bounds);
+    if (_instance_3d_list.has(id))
+        _instance_3d_list.update_instances_list(id, _instance_3d_matrices[id]->data(), 1);
+    else
+        _instance_3d_list.add_instances_list(id, _instance_3d_matrices[id]->data(), 1);
+    mark_instances_moved(id);
+}
+
+void MetalRenderer::remove_static_batch_mesh(unsigned int id)
+{
+    _vertex_3d_list.remove_pointer(id);
+    _instance_3d_list.remove_instances_list(id);
+    if (id < _instance_3d_matrices.size())
+        _instance_3d_matrices[id].reset();
+    _acceleration_structures.mark_mesh_changed(id);
+    _bvh_scene.mark_mesh_changed(id);
+    _sdf_scene.mark_mesh_changed(id);
+    remove_caster(id);
+    if (!_probes.empty())
+        _probe_moved.push_back(id);
+}
+
+void MetalRenderer::erase_impostor_bakes(unsigned int id)
+{
+    _impostor_bakes.erase(std::remove_if(_impostor_bakes.begin(), _impostor_bakes.end(),
+                                         [id](const ImpostorBake &bake) { return bake.settings.mesh == id; }),
+                          _impostor_bakes.end());
+}
+
+void MetalRenderer::set_particle_emitter(unsigned int id, const ParticleEmitter &emitter, unsigned int capacity)
+{
+    ParticleSystem *system = _particle_systems.find(id);
+    if (system && system->capacity == capacity)
+    {
+        system->emitter = emitter;
+        return;
+    }
+
+    if (system)
+        _retired.retire(system->particles, system->alive, system->dead, system->counters);
+    _particle_systems.erase(id);
+    if (capacity == 0)
+        return;
+
+    // Every particle starts out on the dead stack.
+    ParticleSystem created;
+    created.emitter = emitter;
+    created.capacity = capacity;
+    std::vector<unsigned int> dead(capacity);
+    for (unsigned int i = 0; i < capacity; i++)
+        dead[i] = i;
+    ParticleCounters counters = {};
+    counters.dead = static_cast<int>(capacity);
+
+    created.particles = [_device newBufferWithLength:capacity * sizeof(Particle) options:MTLResourceStorageModePrivate];
+    created.particles.label = @"Particles";
+    created.alive = [_device newBufferWithLength:2 * capacity * sizeof(unsigned int)
+                                         options:MTLResourceStorageModePrivate];
+    created.alive.label = @"AliveParticles";
+    created.dead = [_device newBufferWithBytes:dead.data()
+                                        length:capacity * sizeof(unsigned int)
+                                       options:cpu_write_storage(_device)];
+    created.dead.label = @"DeadParticles";
+    created.counters = [_device newBufferWithBytes:&counters
+                                            length:sizeof(ParticleCounters)
+                                           options:cpu_write_storage(_device)];
+    created.counters.label = @"ParticleCounters";
+    if (created.particles == nil || created.alive == nil || created.dead == nil || created.counters == nil)
+    {
+        NSLog(@"Could not allocate %u particles of emitter %u.", capacity, id);
+        return;
+    }
+    _particle_systems.insert(id, created);
+}
+
+void MetalRenderer::emit_particles(unsigned int id, unsigned int count)
+{
+    if (ParticleSystem *system = _particle_systems.find(id))
+        system->burst = std::min(system->burst + count, system->capacity);
+}
+
+bool MetalRenderer::set_point_cloud(unsigned int id, const PointCloudData &data)
+{
+    if (PointCloud *cloud = _point_clouds.find(id))
+        _retired.retire(cloud->points);
+    _point_clouds.erase(id);
+    if (data.count == 0 || data.positions == nullptr)
+        return true;
+
+    const size_t length = static_cast<size_t>(data.count) * sizeof(PackedPoint);
+    if (length > _device.maxBufferLength)
+        return false;
+    const MTLResourceOptions storage = cpu_write_storage(_device);
+    PointCloud cloud;
+    cloud.points = [_device newBufferWithLength:length options:storage];
+    if (cloud.points == nil)
+    {
+        NSLog(@"Could not allocate %u points of point cloud %u.", data.count, id);
+        return false;
+    }
+    cloud.points.label = @"PointCloud";
+    cloud.chunks = build_point_chunks(data.positions, data.colors, data.count,
+                                      static_cast<PackedPoint *>(cloud.points.contents));
+    if (storage == MANAGED_STORAGE)
+        did_modify(cloud.points, NSMakeRange(0, length));
+    cloud.transform = dmat4(*reinterpret_cast<const mat4 *>(&data.transform));
+    _point_clouds.insert(id, std::move(cloud));
+    return true;
+}
+
+void MetalRenderer::set_point_cloud_transform(unsigned int id, const simd_float4x4 &transform)
+{
+    if (PointCloud *cloud = _point_clouds.find(id))
+        cloud->transform = dmat4(*reinterpret_cast<const mat4 *>(&transform));
+    _changes++;
+}
+
+void MetalRenderer::update_3d_hierarchy(const unsigned int *nodes, const simd_float4x4 *locals, unsigned int count)
+{
+    // Repeated updates of a node before the next frame replace each other, so no two threads scatter to it.
+    for (unsigned int i = 0; i < count && nodes && locals; i++)
+    {
+        if (nodes[i] >= _hierarchy.order.size())
+            continue;
+
+        const unsigned int node = _hierarchy.order[nodes[i]];
+        unsigned int &slot = _hierarchy.update_slots[node];
+        if (slot == ~0u)
+        {
+            slot = static_cast<unsigned int>(_hierarchy.updates.size());
+            _hierarchy.updates.push_back({});
+            _hierarchy.updates.back().node = node;
+        }
+
+        InstanceTransform transform;
+        store_instances(&transform, reinterpret_cast<const mat4 *>(&locals[i]), 1);
+        std::copy(transform.rows, transform.rows + 3, _hierarchy.updates[slot].rows);
+    }
+    _path_tracer.samples = 0;
+}
+
+void MetalRenderer::set_animation_time(float seconds)
+{
+    if (seconds != _animation_time)
+        _changes++;
+    _animation_time = seconds;
+}
+
+void MetalRenderer::cache_3d_mesh(unsigned int id)
+{
+    // Packed meshes are only stored quantized and meshes in GPU-only memory can't be read back, neither is cached.
+    std::vector<Vertex3D> vertices;
+    std::vector<JointData> joints_weights;
+    std::vector<unsigned int> indices;
+    if (_mesh_cache.capacity() == 0 || !_vertex_3d_list.read_mesh(id, vertices, joints_weights, indices) ||
+        vertices.empty())
+        return;
+
+    CachedMesh mesh = {};
+    mesh.num_vertices = static_cast<unsigned int>(vertices.size());
+    mesh.num_indices = static_cast<unsigned int>(indices.size());
+    mesh.has_joints = !joints_weights.empty();
+    mesh.joints_offset = vertices.size() * sizeof(Vertex3D);
+    mesh.indices_offset = mesh.joints_offset + joints_weights.size() * sizeof(JointData);
+    mesh.flags = (_shadow_casters.has(id) ? SHADOW_CASTER : 0) | (_transparent_meshes.has(id) ? TRANSPARENT : 0);
+    const size_t size = mesh.indices_offset + indices.size() * sizeof(unsigned int);
+    if (size > _mesh_cache.capacity())
+        return;
+
+    id<MTLBuffer> buffer = [_device newBufferWithLength:size options:MTLResourceStorageModeShared];
+    buffer.label = @"Cached-Mesh";
+    auto *bytes = static_cast<unsigned char *>(buffer.contents);
+    std::memcpy(bytes, vertices.data(), vertices.size() * sizeof(Vertex3D));
+    std::memcpy(bytes + mesh.joints_offset, joints_weights.data(), joints_weights.size() * sizeof(JointData));
+    std::memcpy(bytes + mesh.indices_offset, indices.data(), indices.size() * sizeof(unsigned int));
+    _mesh_cache.insert(id, buffer, mesh);
+}
+
+bool MetalRenderer::restore_3d_mesh(unsigned int id)
+{
+    PurgeableCache<unsigned int, CachedMesh>::Entry entry;
+    if (!_mesh_cache.take(id, entry))
+        return false;
+
+    const CachedMesh &mesh = entry.info;
+    const auto *bytes = static_cast<const unsigned char *>(((id<MTLBuffer>)entry.resource).contents);
+    MeshData3D data = {};
+    data.vertices = reinterpret_cast<const Vertex3D *>(bytes);
+    data.num_vertices = mesh.num_vertices;
+    data.skin_data = mesh.has_joints ? reinterpret_cast<const JointData *>(bytes + mesh.joints_offset) : nullptr;
+    data.indices = reinterpret_cast<const unsigned int *>(bytes + mesh.indices_offset);
+    data.num_indices = mesh.num_indices;
+    data.flags = mesh.flags;
+
+    // The vertex lists copy the mesh, the cached buffer is released when this returns.
+    const bool copy_on_submit = _copy_on_submit;
+    set_copy_on_submit(true);
+    set_3d_mesh(id, data);
+    set_copy_on_submit(copy_on_submit);
+    return true;
+}
+
+void MetalRenderer::set_skins(const SkinData *skins, unsigned int num_skins, const size_t *changed,
+                              unsigned int num_changed)
+{
+    const bool resized = _skins.size() != num_skins;
+    if (resized)
+        _skins.resize(num_skins);
+
+    for (unsigned int i = 0; i < num_skins; i++)
+    {
+        if (!resized && !bit_set(changed, num_changed, i))
+            continue;
+
+        const auto *matrices = reinterpret_cast<const mat4 *>(skins[i].joint_matrices);
+        if (matrices)
+            _skins[i].assign(matrices, matrices + skins[i].num_joint_matrices);
+        else
+            _skins[i].clear();
+    }
+
+    // Joint matrices are uploaded when the skinning pass gets encoded, no synchronization is needed.
+    _skinning_dirty = true;
+    _path_tracer.samples = 0;
+
+    // Skinned casters change shape, their shadows are redrawn like those of moved casters.
+    for (const auto &[id, bounds] : _shadow_casters)
+    {
+        if (id < _instance_3d_skin_ids.size() && !_instance_3d_skin_ids[id].empty())
+            _moved_casters.push_back(id);
+    }
+}
+
+void MetalRenderer::set_3d_morph_targets(unsigned int id, const MorphTargetData *targets, unsigned int num_targets)
+{
+    _morph_targets_dirty = true;
+    _skinning_dirty = true;
+    _path_tracer.samples = 0;
+    if (num_targets == 0 || !targets)
+    {
+        _morph_targets.erase(id);
+        _morph_weights.erase(id);
+        return;
+    }
+
+    // Deltas are sorted by vertex, so every vertex gathers its own.
+    unsigned int num_vertices = 0;
+    for (unsigned int t = 0; t < num_targets; t++)
+    {
+        for (unsigned int i = 0; i < targets[t].count && targets[t].vertices && targets[t].positions; i++)
+            num_vertices = std::max(num_vertices, targets[t].vertices[i] + 1);
+    }
+
+    MorphTargets3D morphs;
+    morphs.num_targets = num_targets;
+    morphs.offsets.assign(num_vertices + 1, 0);
+    for (unsigned int t = 0; t < num_targets; t++)
+    {
+        for (unsigned int i = 0; i < targets[t].count && targets[t].vertices && targets[t].positions; i++)
+            morphs.offsets[targets[t].vertices[i] + 1]++;
+    }
+    for (unsigned int v = 0; v < num_vertices; v++)
+        morphs.offsets[v + 1] += morphs.offsets[v];
+
+    morphs.deltas.resize(morphs.offsets.back());
+    std::vector<unsigned int> next(morphs.offsets.begin(), morphs.offsets.end() - 1);
+    for (unsigned int t = 0; t < num_targets; t++)
+    {
+        const MorphTargetData &target = targets[t];
+        for (unsigned int i = 0; i < target.count && target.vertices && target.positions; i++)
+        {
+            MorphDelta &delta = morphs.deltas[next[target.vertices[i]]++];
+            delta.target = t;
+            delta.p_x = target.positions[i * 3];
+            delta.p_y = target.positions[i * 3 + 1];
+            delta.p_z = target.positions[i * 3 + 2];
+            delta.n_x = target.normals ? target.normals[i * 3] : 0.0f;
+            delta.n_y = target.normals ? target.normals[i * 3 + 1] : 0.0f;
+            delta.n_z = target.normals ? target.normals[i * 3 + 2] : 0.0f;
+        }
+    }
+    _morph_targets.insert(id, std::move(morphs));
+}
+
+void MetalRenderer::set_3d_morph_weights(unsigned int id, const float *weights, unsigned int num_instances)
+{
+    const MorphTargets3D *morphs = _morph_targets.find(id);
+    if (!morphs || !weights || num_instances == 0)
+        _morph_weights.erase(id);
+    else
+        _morph_weights[id].assign(weights, weights + static_cast<size_t>(num_instances) * morphs->num_targets);
+
+    // Weights are uploaded when the skinning pass gets encoded, like joint matrices.
+    _skinning_dirty = true;
+    _path_tracer.samples = 0;
+    if (_shadow_casters.has(id))
+        _moved_casters.push_back(id);
+}
+
+void MetalRenderer::set_animation_clip(unsigned int id, const AnimationChannel *channels, unsigned int num_channels)
+{
+    _animations_dirty = true;
+    _skinning_dirty = true;
+    _path_tracer.samples = 0;
+    _animation_clips.erase(id);
+
+    AnimationClip3D clip;
+    for (unsigned int c = 0; c < num_channels && channels; c++)
+    {
+        if (channels[c].num_keys > 0 && channels[c].times && channels[c].values && channels[c].path <= ANIMATION_SCALE)
+            clip.num_joints = std::max(clip.num_joints, channels[c].joint + 1);
+    }
+    if (clip.num_joints == 0)
+        return;
+
+    // Every joint gets all three channels, those without keys keep the rest pose.
+    clip.channels.assign(clip.num_joints * 3, AnimationKeys{0, 0});
+    for (unsigned int c = 0; c < num_channels; c++)
+    {
+        const AnimationChannel &channel = channels[c];
+        if (channel.num_keys == 0 || !channel.times || !channel.values || channel.path > ANIMATION_SCALE)
+            continue;
+
+        const unsigned int size = channel.path == ANIMATION_ROTATION ? 4 : 3;
+        clip.channels[channel.joint * 3 + channel.path] = {static_cast<unsigned int>(clip.times.size()),
+                                                           channel.num_keys};
+        for (unsigned int k = 0; k < channel.num_keys; k++)
+        {
+            const float *value = channel.values + k * size;
+            clip.times.push_back(channel.times[k]);
+            clip.values.push_back(simd_make_float4(value[0], value[1], value[2], size == 4 ? value[3] : 0.0f));
+        }
+        clip.duration = std::max(clip.duration, channel.times[channel.num_keys - 1]);
+    }
+    _animation_clips.insert(id, std::move(clip));
+}
+
+void MetalRenderer::set_skeleton(unsigned int id, const SkeletonData &skeleton)
+{
+    _animations_dirty = true;
+    _skinning_dirty = true;
+    _path_tracer.samples = 0;
+    _skeletons.erase(id);
+    if (skeleton.num_joints == 0 || !skeleton.parents)
+        return;
+    if (skeleton.num_joints > MAX_SKELETON_JOINTS)
+    {
+        NSLog(@"Skeleton %u has %u joints, at most %u are supported.", id, skeleton.num_joints, MAX_SKELETON_JOINTS);
+        return;
+    }
+
+    Skeleton3D stored;
+    stored.joints.resize(skeleton.num_joints);
+    for (unsigned int j = 0; j < skeleton.num_joints; j++)
+    {
+        SkeletonJoint &joint = stored.joints[j];
+        joint.inverse_bind =
+            skeleton.inverse_bind_matrices ? skeleton.inverse_bind_matrices[j] : matrix_identity_float4x4;
+        const float *t = skeleton.translations ? skeleton.translations + j * 3 : nullptr;
+        const float *r = skeleton.rotations ? skeleton.rotations + j * 4 : nullptr;
+        const float *s = skeleton.scales ? skeleton.scales + j * 3 : nullptr;
+        joint.translation = t ? simd_make_float4(t[0], t[1], t[2], 0.0f) : simd_make_float4(0.0f, 0.0f, 0.0f, 0.0f);
+        joint.rotation = r ? simd_make_float4(r[0], r[1], r[2], r[3]) : simd_make_float4(0.0f, 0.0f, 0.0f, 1.0f);
+        joint.scale = s ? simd_make_float4(s[0], s[1], s[2], 0.0f) : simd_make_float4(1.0f, 1.0f, 1.0f, 0.0f);
+
+        // Joints whose parent does not come before them are treated as roots.
+        const int parent = skeleton.parents[j];
+        joint.parent = parent >= 0 && static_cast<unsigned int>(parent) < j ? parent : -1;
+        joint.depth = joint.parent >= 0 ? stored.joints[joint.parent].depth + 1 : 0;
+        stored.num_levels = std::max(stored.num_levels, joint.depth + 1);
+    }
+    _skeletons.insert(id, std::move(stored));
+}
+
+void MetalRenderer::set_skin_animation(unsigned int skin, unsigned int skeleton, const AnimationLayer *layers,
+                                       unsigned int num_layers)
+{
+    if (num_layers == 0 || !layers)
+        _skin_animations.erase(skin);
+    else
+        _skin_animations[skin] = {skeleton, std::vector<AnimationLayer>(layers, layers + num_layers)};
+    if (skin >= _skins.size())
+        _skins.resize(skin + 1);
+
+    // Sampled matrices are written when the skinning pass gets encoded, like those of set_skins.
+    _skinning_dirty = true;
+    _path_tracer.samples = 0;
+    for (const auto &[id, bounds] : _shadow_casters)
+    {
+        if (id < _instance_3d_skin_ids.size() && !_instance_3d_skin_ids[id].empty())
+            _moved_casters.push_back(id);
+    }
+}
+
+void MetalRenderer::set_point_lights(const PointLight *lights, unsigned int num_lights)
+{
+    _point_lights.assign(lights, lights + num_lights);
+    _path_tracer.samples = 0;
+    _changes++;
+}
+
+void MetalRenderer::set_spot_lights(const SpotLight *lights, unsigned int num_lights)
+{
+    _spot_lights.assign(lights, lights + num_lights);
+    _path_tracer.samples = 0;
+    _changes++;
+}
+
+void MetalRenderer::set_area_lights(const AreaLight *lights, unsigned int num_lights)
+{
+    _area_lights.assign(lights, lights + num_lights);
+    _retired.retire(_area_light_buffer, _light_tree);
+    _area_light_buffer = nil;
+    _light_tree = nil;
+    if (num_lights > 0)
+    {
+        _area_light_buffer = [_device newBufferWithBytes:lights
+                                                  length:num_lights * sizeof(AreaLight)
+                                                 options:MTLResourceStorageModeShared];
+        _area_light_buffer.label = @"AreaLights";
+        _light_tree = [_device newBufferWithLength:(2 * num_lights - 1) * sizeof(LightTreeNode)
+                                           options:MTLResourceStorageModePrivate];
+        _light_tree.label = @"LightTree";
+    }
+    _light_tree_dirty = num_lights > 0;
+    _path_tracer.samples = 0;
+    _changes++;
+}
+
+void MetalRenderer::set_directional_lights(const DirectionalLight *lights, unsigned int num_lights)
+{
+    _directional_lights.assign(lights, lights + num_lights);
+    _path_tracer.samples = 0;
+    _changes++;
+}
+
+void MetalRenderer::set_materials(const DeviceMaterial *materials, unsigned int num_materials,
+                                  const size_t *changed, unsigned int num_changed)
+{
+    // The table holds packed materials, the ones set are kept to repack them when their lightmap changes. New
+    // materials are packed along with the changed ones.
+    if (num_materials > _materials.size())
+    {
+        _materials.resize(num_materials);
+        _device_materials.resize(num_materials);
+        changed = nullptr;
+    }
+
+    const auto lightmap = [&](unsigned int i) {
+        return i < _material_lightmaps.size() ? _material_lightmaps[i] : -1;
+    };
+    if (!changed)
+    {
+        std::copy(materials, materials + num_materials, _device_materials.begin());
+        for (unsigned int i = 0; i < num_materials; i++)
+            _materials[i] = pack_material(materials[i], lightmap(i));
+        mark_materials_changed(0, num_materials);
+    }
+    else
+    {
+        std::vector<DirtyRange> ranges;
+        for (unsigned int i = 0; i < num_materials; i++)
+        {
+            if (!bit_set(changed, num_changed, i))
+                continue;
+            _device_materials[i] = materials[i];
+            _materials[i] = pack_material(materials[i], lightmap(i));
+            if (!ranges.empty() && ranges.back().end == i)
+                ranges.back().end = i + 1;
+            else
+                ranges.push_back({i, i + 1});
+        }
+
+        if (ranges.empty())
+            return;
+        for (const DirtyRange &range : coalesce(std::move(ranges), 16))
+            mark_materials_changed(range.start, range.end);
+    }
+
+    _flags |= Flags::UpdateMaterials;
+}
+
+void MetalRenderer::mark_materials_changed(unsigned int start, unsigned int end)
+{
+    // Frames that fell far behind copy the whole table instead of a long list of ranges.
+    for (FrameResources &frame : _frames)
+    {
+        frame.material_ranges.push_back({start, end});
+        if (frame.material_ranges.size() > 64)
+            frame.material_ranges = {{0, static_cast<unsigned int>(_materials.size())}};
+    }
+}
+
+void MetalRenderer::update_frame_materials(unsigned int frame_index)
+{
+    FrameResources &frame = _frames[frame_index];
+    const NSUInteger length = std::max<size_t>(_materials.size(), 1) * sizeof(PackedMaterial);
+    if (frame.materials == nil || frame.materials.length < length)
+    {
+        // Capacity grows geometrically, a new table receives every material.
+        const NSUInteger capacity =
+            std::max(length, frame.materials != nil ? frame.materials.length * 2 : 32 * sizeof(PackedMaterial));
+        _retired.retire(frame.materials);
+        frame.materials = [_device newBufferWithLength:capacity options:cpu_write_storage(_device)];
+        frame.materials.label = @"Materials";
+        frame.material_ranges = {{0, static_cast<unsigned int>(_materials.size())}};
+    }
+
+    auto *data = static_cast<unsigned char *>(frame.materials.contents);
+    const auto count = static_cast<unsigned int>(_materials.size());
+    for (const DirtyRange &range : coalesce(std::move(frame.material_ranges), 16))
+    {
+        const unsigned int end = std::min(range.end, count);
+        if (range.start >= end)
+            continue;
+        const NSRange bytes =
+            NSMakeRange(range.start * sizeof(PackedMaterial), (end - range.start) * sizeof(PackedMaterial));
+        std::memcpy(data + bytes.location, _materials.data() + range.start, bytes.length);
+        if (frame.materials.storageMode == MTLStorageModeManaged)
+            did_modify(frame.materials, bytes);
+    }
+    frame.material_ranges.clear();
+}
+
+MTLArgumentDescriptor *argumentDescriptorWithIndex(NSUInteger index, MTLDataType dataType)
+{
+    MTLArgumentDescriptor *argumentDescriptor = [MTLArgumentDescriptor argumentDescriptor];
+    argumentDescriptor.index = index;
+    argumentDescriptor.dataType = dataType;
+    argumentDescriptor.access = MTLArgumentAccessReadOnly;
+    return argumentDescriptor;
+}
+
+// Bindless tables of Metal 3 are plain structs, a buffer is its GPU address and a texture or sampler state its
+// resource id. Empty entries are 0.
+void write_buffer_address(id<MTLBuffer> table, NSUInteger offset, id<MTLBuffer> buffer)
+{
+    if (@available(macOS 13.0, *))
+    {
+        const uint64_t address = buffer != nil ? buffer.gpuAddress : 0;
+        std::memcpy(static_cast<char *>(table.contents) + offset, &address, sizeof(address));
+    }
+}
+
+void write_texture_id(id<MTLBuffer> table, NSUInteger offset, id<MTLTexture> texture)
+{
+    if (@available(macOS 13.0, *))
+    {
+        const MTLResourceID resource = texture != nil ? texture.gpuResourceID : MTLResourceID{};
+        std::memcpy(static_cast<char *>(table.contents) + offset, &resource, sizeof(resource));
+    }
+}
+
+void write_sampler_id(id<MTLBuffer> table, NSUInteger offset, id<MTLSamplerState> sampler)
+{
+    if (@available(macOS 13.0, *))
+    {
+        const MTLResourceID resource = sampler.gpuResourceID;
+        std::memcpy(static_cast<char *>(table.contents) + offset, &resource, sizeof(resource));
+    }
+}
+
+void MetalRenderer::acquire_all_frames()
+{
+    for (size_t i = 0; i < _frames.size(); i++)
+        dispatch_semaphore_wait(_sem, DISPATCH_TIME_FOREVER);
+    _retired.release(_frames_rendered);
+}
+
+void MetalRenderer::release_all_frames()
+{
+    for (size_t i = 0; i < _frames.size(); i++)
+        dispatch_semaphore_signal(_sem);
+}
+
+void MetalRenderer::set_frames_in_flight(unsigned int count)
+{
+    count = std::clamp(count, 1u, MAX_FRAMES_IN_FLIGHT);
+    if (count == _frames.size())
+        return;
+
+    wait_for_synchronize();
+    acquire_all_frames();
+    release_all_frames();
+
+    _frames.clear();
+    _frames.resize(count);
+    _frame_index = 0;
+    _frame_timer.set_frames_in_flight(count);
+    if (_mesh_profiler.enabled())
+        _mesh_profiler.set_enabled(true, count);
+
+    _upload_ring.set_frames_in_flight(count);
+
+    _instance_3d_list.set_frames_in_flight(_device, count);
+    _instance_overrides.set_frames_in_flight(_device, count);
+    _instance_2d_list.set_frames_in_flight(_device, count);
+    _glyph_list.set_frames_in_flight(_device, count);
+    _sprite_list.set_frames_in_flight(_device, count);
+
+    _sem = dispatch_semaphore_create(count);
+}
+
+void MetalRenderer::set_mesh_profiling(bool enabled)
+{
+    if (enabled == _mesh_profiler.enabled())
+        return;
+
+    // Completed handlers of frames in flight resolve into the per-frame sample buffers.
+    acquire_all_frames();
+    _mesh_profiler.set_enabled(enabled, static_cast<unsigned int>(_frames.size()));
+    release_all_frames();
+}
+
+void MetalRenderer::set_vertex_compaction_budget(unsigned int bytes_per_frame)
+{
+    _vertex_compaction_budget = bytes_per_frame;
+}
+
+void MetalRenderer::set_mesh_welding(bool enabled)
+{
+    // Only applies to meshes set after this call.
+    _weld_meshes = enabled;
+}
+
+void MetalRenderer::set_static_batching(const StaticBatching &batching)
+{
+    _static_batching = batching;
+    _static_batching.cell_size = std::max(batching.cell_size, 0.0f);
+    _static_batches_dirty = true;
+}
+
+void MetalRenderer::set_copy_on_submit(bool enabled)
+{
+    // Only applies to data set after this call.
+    _copy_on_submit = enabled;
+    _vertex_3d_list.set_copy_on_submit(enabled);
+    _packed_3d_list.set_copy_on_submit(enabled);
+    _vertex_2d_list.set_copy_on_submit(enabled);
+}
+
+void MetalRenderer::set_upload_budget(const UploadBudget &budget)
+{
+    _uploads.configure(budget);
+}
+
+unsigned int MetalRenderer::pending_uploads() const
+{
+    const size_t meshes =
+        _vertex_3d_list.pending_meshes() + _packed_3d_list.pending_meshes() + _vertex_2d_list.pending_meshes();
+    return static_cast<unsigned int>(meshes + _deferred_textures.size() + _committed_textures.size());
+}
+
+void MetalRenderer::set_3d_vertex_format(VertexFormat3D format)
+{
+    // Only applies to meshes set after this call.
+    _vertex_format = format;
+}
+
+void MetalRenderer::set_gpu_culling(bool enabled)
+{
+    _gpu_culling = enabled;
+}
+
+void MetalRenderer::set_async_compute(bool enabled)
+{
+    if (enabled && _compute_queue == nil)
+    {
+        _compute_queue = [_device newCommandQueue];
+        _compute_queue.label = @"Compute";
+        _compute_event = [_device newEvent];
+        _geometry_event = [_device newEvent];
+    }
+    if (enabled == _async_compute)
+        return;
+
+    // Frames encoded without async compute signal no geometry event, the first compute work must not overlap them.
+    acquire_all_frames();
+    _async_compute = enabled;
+    release_all_frames();
+}
+
+void MetalRenderer::set_gpu_driven_draws(bool enabled)
+{
+    _gpu_driven = enabled;
+    _draw_commands_dirty = true;
+}
+
+void MetalRenderer::set_depth_prepass(bool enabled)
+{
+    _depth_prepass = enabled;
+}
+
+void MetalRenderer::set_visibility_buffer(bool enabled)
+{
+    _vbuffer_enabled = enabled;
+    if (!enabled)
+    {
+        _retired.retire(_vbuffer);
+        _vbuffer = nil;
+    }
+}
+
+void MetalRenderer::set_occlusion_culling(bool enabled)
+{
+    _occlusion_culling = enabled;
+    // The pyramid of the last frame with occlusion culling may be arbitrarily old.
+    _depth_pyramid_valid = false;
+}
+
+void MetalRenderer::set_cluster_culling(bool enabled)
+{
+    // Only applies to meshes set after this call.
+    _cluster_culling = enabled;
+}
+
+void MetalRenderer::set_encoding_threads(unsigned int count)
+{
+    _encoding_threads = std::max(count, 1u);
+}
+
+void MetalRenderer::set_ray_tracing(bool enabled)
+{
+    enabled = enabled && _ray_tracing_supported;
+    if (enabled == _ray_tracing)
+        return;
+
+    // The traced texture is shared by all frames.
+    acquire_all_frames();
+    _ray_tracing = enabled;
+    create_ray_traced_target();
+    invalidate_surface_targets();
+    release_all_frames();
+}
+
+void MetalRenderer::set_path_tracer_denoiser(bool enabled)
+{
+    if (enabled == _path_tracer.denoise)
+        return;
+
+    // Accumulated samples were traced without first hits, denoised ones are single samples.
+    acquire_all_frames();
+    _path_tracer.denoise = enabled;
+    _path_tracer.samples = 0;
+    create_path_denoiser_buffers();
+    for (Surface &surface : _surfaces)
+    {
+        surface.path_tracer.surfaces = {};
+        surface.path_tracer.history = {};
+        surface.path_tracer.filtered = {};
+        surface.path_tracer.history_valid = false;
+        surface.path_tracer.samples = 0;
+    }
+    release_all_frames();
+}
+
+void MetalRenderer::set_path_tracer_convergence(float threshold, unsigned int min_samples, unsigned int max_samples,
+                                                float time_budget)
+{
+    // Renders start over with the new settings, samples of the previous ones did not track their error.
+    acquire_all_frames();
+    _path_tracer.threshold = std::max(threshold, 0.0f);
+    _path_tracer.min_samples = min_samples;
+    _path_tracer.max_samples = max_samples;
+    _path_tracer.time_budget = std::max(time_budget, 0.0f);
+    _path_tracer.samples = 0;
+    if (_path_tracer.accumulator != nil)
+        create_path_adaptive_buffers();
+    for (Surface &surface : _surfaces)
+    {
+        surface.path_tracer.radiance = nil;
+        surface.path_tracer.moments = nil;
+        surface.path_tracer.tiles = nil;
+        surface.path_tracer.progress = nil;
+        surface.path_tracer.samples = 0;
+    }
+    release_all_frames();
+}
+
+PathTracerProgress MetalRenderer::path_tracer_progress() const
+{
+    PathTracerProgress progress = {};
+    const auto width = static_cast<unsigned int>(_depth_texture.width);
+    const auto height = static_cast<unsigned int>(_depth_texture.height);
+    progress.samples = _path_tracer.samples;
+    progress.tiles = ((width + PATH_TRACER_TILE_SIZE - 1) / PATH_TRACER_TILE_SIZE) *
+                     ((height + PATH_TRACER_TILE_SIZE - 1) / PATH_TRACER_TILE_SIZE);
+    progress.active_tiles = progress.tiles;
+    if (_path_tracer.progress != nil)
+    {
+        const auto *reported = reinterpret_cast<const PathProgress *>(_path_tracer.progress.contents);
+        if (reported->render == _path_tracer.render)
+            progress.active_tiles = reported->active_tiles;
+    }
+    if (_path_tracer.finished)
+    {
+        progress.active_tiles = 0;
+        progress.seconds = _path_tracer.seconds;
+        progress.finished = 1;
+    }
+    else if (_path_tracer.samples != 0)
+    {
+        const auto elapsed = std::chrono::steady_clock::now() - _path_tracer.started;
+        progress.seconds = std::chrono::duration<float>(elapsed).count();
+    }
+    return progress;
+}
+
+void MetalRenderer::set_ambient_occlusion_radius(float radius)
+{
+    _ao_radius = std::max(radius, 0.0f);
+}
+
+void MetalRenderer::set_ssao(bool enabled)
+{
+    if (enabled == _ssao)
+        return;
+
+    _ssao = enabled;
+}
+
+void MetalRenderer::set_reflections(const ReflectionSettings &settings)
+{
+    const bool enabled = settings.enabled != 0;
+    const bool changed = enabled != (_reflections.settings.enabled != 0);
+    _reflections.settings = settings;
+    _reflections.settings.enabled = enabled ? 1 : 0;
+    _reflections.settings.max_roughness = std::clamp(settings.max_roughness, 0.0f, 1.0f);
+    _reflections.settings.max_distance = std::max(settings.max_distance, 0.0f);
+    if (!changed)
+        return;
+
+    if (!enabled)
+    {
+        _retired.retire(_reflections.hzb, _reflections.traced, _reflections.source, _reflections.history[0],
+                        _reflections.history[1], _reflections.rays, _reflections.counters);
+        for (id<MTLTexture> level : _reflections.hzb_levels)
+            _retired.retire(level);
+        _reflections.hzb = nil;
+        _reflections.hzb_levels.clear();
+        _reflections.traced = nil;
+        _reflections.source = nil;
+        _reflections.history = {};
+        _reflections.rays = nil;
+        _reflections.counters = nil;
+    }
+    _reflections.history_valid = false;
+    _reflections.source_valid = false;
+    // Hits in screen space take their color from the scaled target the main pass draws into.
+    create_scaled_targets();
+    invalidate_surface_targets();
+}
+
+void MetalRenderer::set_sdf_tracing(const SdfSettings &settings)
+{
+    const bool enabled = settings.enabled != 0;
+    const bool changed = enabled != (_sdf_settings.enabled != 0);
+    _sdf_settings.enabled = enabled ? 1 : 0;
+    // Penumbras and voxels without size would divide by zero.
+    _sdf_settings.softness = std::max(settings.softness, 1e-3f);
+    _sdf_settings.ao_distance = std::max(settings.ao_distance, 1e-3f);
+    _sdf_settings.voxel_size = std::max(settings.voxel_size, 1e-3f);
+    if (!changed)
+        return;
+
+    // The traced texture is shared by all frames.
+    acquire_all_frames();
+    if (!enabled)
+        _sdf_scene.clear(_retired);
+    create_ray_traced_target();
+    invalidate_surface_targets();
+    release_all_frames();
+}
+
+void MetalRenderer::set_msaa_samples(unsigned int samples)
+{
+    samples = samples >= 4 ? 4 : samples >= 2 ? 2 : 1;
+    if (samples > 1 && ![_device supportsTextureSampleCount:samples])
+        samples = 1;
+    if (samples == _msaa_samples)
+        return;
+
+    wait_for_pipelines();
+    // The states and attachments frames in flight were encoded with are retired.
+    _msaa_samples = samples;
+    if (_msaa_samples > 1)
+    {
+        for (const PipelineVariant &pipeline : _msaa_pipelines)
+        {
+            pipeline.desc.rasterSampleCount = _msaa_samples;
+            _retired.retire(*pipeline.state);
+            _pipelines.create(pipeline.desc, pipeline.state);
+        }
+    }
+    create_msaa_targets();
+    invalidate_surface_targets();
+}
+
+void MetalRenderer::set_hdr(HdrMode mode, float exposure)
+{
+    _exposure = std::max(exposure, 0.0f);
+    // Offscreen frames are read back as 8-bit pixels.
+    if (mode == HDR_EXTENDED && _layer == nil)
+        mode = HDR_TONEMAPPED;
+    if (mode == _hdr)
+        return;
+
+    wait_for_pipelines();
+    // The states and attachments frames in flight were encoded with are retired.
+    const MTLPixelFormat scene = scene_format();
+    const MTLPixelFormat target = target_format();
+    _hdr = mode;
+    if (scene_format() != scene)
+    {
+        for (const PipelineVariant &pipeline : _scene_pipelines)
+        {
+            pipeline.desc.colorAttachments[0].pixelFormat = scene_format();
+            _retired.retire(*pipeline.state);
+            _pipelines.create(pipeline.desc, pipeline.state);
+        }
+        for (const PipelineVariant &pipeline : _msaa_pipelines)
+        {
+            pipeline.desc.colorAttachments[0].pixelFormat = scene_format();
+            if (_msaa_samples > 1)
+            {
+                _retired.retire(*pipeline.state);
+                _pipelines.create(pipeline.desc, pipeline.state);
+            }
+        }
+    }
+    if (target_format() != target)
+    {
+        for (const PipelineVariant &pipeline : _target_pipelines)
+        {
+            pipeline.desc.colorAttachments[0].pixelFormat = target_format();
+            _retired.retire(*pipeline.state);
+            _pipelines.create(pipeline.desc, pipeline.state);
+        }
+
+        update_layer_format();
+    }
+    create_msaa_targets();
+    create_scaled_targets();
+    invalidate_surface_targets();
+}
+
+void MetalRenderer::update_layer_format()
+{
+    // Extended sRGB keeps the encoding of the 8-bit drawables, values above 1 are brighter than SDR white.
+    _layer.pixelFormat = target_format();
+    if (@available(iOS 16.0, *))
+    {
+        _layer.wantsExtendedDynamicRangeContent = _hdr == HDR_EXTENDED;
+        if (_hdr == HDR_EXTENDED)
+        {
+            CGColorSpaceRef color_space = CGColorSpaceCreateWithName(kCGColorSpaceExtendedSRGB);
+            _layer.colorspace = color_space;
+            CGColorSpaceRelease(color_space);
+        }
+        else
+        {
+            _layer.colorspace = nil;
+        }
+    }
+}
+
+void MetalRenderer::set_temporal_antialiasing(bool enabled)
+{
+    if (enabled == _taa)
+        return;
+
+    _taa = enabled;
+    create_scaled_targets();
+    invalidate_surface_targets();
+}
+
+void MetalRenderer::set_post_processing(const PostProcessSettings &settings)
+{
+    _post = settings;
+    _post.bloom_threshold = std::max(settings.bloom_threshold, 0.0f);
+    _post.bloom_intensity = std::max(settings.bloom_intensity, 0.0f);
+    _post.vignette_intensity = std::clamp(settings.vignette_intensity, 0.0f, 1.0f);
+    _post.vignette_radius = std::clamp(settings.vignette_radius, 0.0f, 0.99f);
+    update_post_effects();
+}
+
+void MetalRenderer::set_color_grading_lut(const unsigned char *texels, unsigned int size)
+{
+    _retired.retire(_grading_lut);
+    _grading_lut = nil;
+    if (texels && size >= 2)
+    {
+        MTLTextureDescriptor *desc = [MTLTextureDescriptor new];
+        desc.textureType = MTLTextureType3D;
+        desc.pixelFormat = MTLPixelFormatRGBA8Unorm;
+        desc.width = size;
+        desc.height = size;
+        desc.depth = size;
+        desc.usage = MTLTextureUsageShaderRead;
+        _grading_lut = [_device newTextureWithDescriptor:desc];
+        _grading_lut.label = @"ColorGradingLut";
+        [_grading_lut replaceRegion:MTLRegionMake3D(0, 0, 0, size, size, size)
+                        mipmapLevel:0
+                              slice:0
+                          withBytes:texels
+                        bytesPerRow:size * 4
+                      bytesPerImage:size * size * 4];
+    }
+    update_post_effects();
+}
+
+void MetalRenderer::set_present_mode(PresentMode mode, float min_frame_duration, bool low_latency)
+{
+    if (_layer == nil)
+        return;
+
+    bool display_link = false;
+#ifdef RFW_DISPLAY_LINK
+    if (@available(macOS 14.0, *))
+        display_link = mode == PRESENT_DISPLAY_LINK;
+#endif
+    if (mode == PRESENT_DISPLAY_LINK && !display_link)
+        mode = PRESENT_PACED;
+
+    // Presents already encoded keep the mode they were encoded with.
+    _present_mode = mode;
+    _min_frame_duration = std::max(min_frame_duration, 0.0f);
+#if !TARGET_OS_IPHONE
+    _layer.displaySyncEnabled = mode != PRESENT_IMMEDIATE;
+#endif
+    _layer.maximumDrawableCount = low_latency ? 2 : 3;
+
+#ifdef RFW_DISPLAY_LINK
+    if (@available(macOS 14.0, *))
+    {
+        if (!display_link)
+        {
+            [_display_link stop];
+            _display_link = nil;
+            return;
+        }
+
+        if (_display_link == nil)
+            _display_link = [[RfwDisplayLink alloc] initWithLayer:_layer];
+        const float rate = _min_frame_duration > 0.0f ? 1.0f / _min_frame_duration : 0.0f;
+        const CAFrameRateRange range =
+            rate > 0.0f ? CAFrameRateRangeMake(rate * 0.5f, rate, rate) : CAFrameRateRangeDefault;
+        [_display_link setFrameRateRange:range latency:low_latency ? 1 : 2];
+    }
+#endif
+}
+
+void MetalRenderer::set_frame_timeout(float seconds)
+{
+    _frame_timeout = seconds;
+    if (seconds < 0.0f)
+        _drawable_queue = nil;
+    else if (_drawable_queue == nil && _layer != nil)
+        _drawable_queue = [[RfwDrawableQueue alloc] initWithLayer:_layer];
+}
+
+void MetalRenderer::set_on_demand_rendering(bool enabled, float heartbeat)
+{
+    _on_demand = enabled;
+    _heartbeat = std::max(heartbeat, 0.0f);
+    _changes++;
+}
+
+id<CAMetalDrawable> MetalRenderer::next_drawable()
+{
+#ifdef RFW_DISPLAY_LINK
+    if (@available(macOS 14.0, *))
+    {
+        // The display link drives the layer of surface 0, other surfaces acquire their drawables themselves.
+        if (_display_link != nil && _surface == 0)
+            return [_display_link nextDrawable:_frame_timeout < 0.0 ? 1.0 : _frame_timeout];
+    }
+#endif
+    if (_drawable_queue != nil)
+        return [_drawable_queue nextDrawable:_frame_timeout];
+    return [_layer nextDrawable];
+}
+
+void MetalRenderer::present(id<MTLCommandBuffer> command_buffer, id<CAMetalDrawable> drawable)
+{
+    // The frame cap of the quality level paces the other modes as well.
+    const float paced = _present_mode == PRESENT_PACED ? _min_frame_duration : 0.0f;
+    const float min_frame_duration = std::max(paced, _quality.settings().min_frame_duration);
+
+    if (@available(macOS 10.15.4, *))
+    {
+        // Displays with adaptive sync report their highest rate, frames are only late against the cap.
+        double refresh_interval = 1.0 / 60.0;
+        const double refresh_rate = display_refresh_rate(_window);
+        if (refresh_rate > 0.0)
+            refresh_interval = 1.0 / refresh_rate;
+        refresh_interval = std::max(refresh_interval, static_cast<double>(min_frame_duration));
+        FramePacing *pacing = &_pacing;
+        const uint64_t frame = _frames_rendered;
+        [drawable addPresentedHandler:^(id<MTLDrawable> presented) {
+          pacing->presented(frame, presented.presentedTime, refresh_interval);
+        }];
+    }
+
+    if (min_frame_duration > 0.0f)
+    {
+        if (@available(macOS 10.15.4, *))
+        {
+            [command_buffer presentDrawable:drawable afterMinimumDuration:min_frame_duration];
+            return;
+        }
+    }
+    [command_buffer presentDrawable:drawable];
+}
+
+void MetalRenderer::set_render_scale(float scale)
+{
+    // The temporal scaler upscales by a factor of 2 at most.
+    scale = std::clamp(scale, 0.5f, 1.0f);
+    if (scale == _render_scale)
+        return;
+
+    _render_scale = scale;
+    _targets_dirty = true;
+    invalidate_surface_targets();
+}
+
+void MetalRenderer::set_dynamic_resolution(float target_ms, float min_scale, float max_scale)
+{
+    _dynamic_resolution.configure(target_ms, min_scale, max_scale);
+    _resolution_frame = _frame_timer.resolved();
+    // The heap is sized for the largest scale once the targets are created again.
+    _targets_dirty = true;
+    invalidate_surface_targets();
+    if (_dynamic_resolution.enabled())
+        set_render_scale(_dynamic_resolution.max_scale());
+}
+
+DeviceStatus MetalRenderer::device_status() const
+{
+    const auto status = static_cast<DeviceStatus>(_device_status.load());
+    if (status != DEVICE_OK || _layer == nil)
+        return status;
+    if (@available(macOS 10.15, *))
+    {
+        id<MTLDevice> preferred = _layer.preferredDevice;
+        if (preferred != nil && preferred.registryID != _device.registryID)
+            return DEVICE_NOT_DISPLAYING;
+    }
+    return DEVICE_OK;
+}
+
+void MetalRenderer::set_quality_governor(bool enabled)
+{
+    const unsigned int level = _quality.level();
+    _quality.set_enabled(enabled);
+    if (_quality.level() != level)
+        apply_quality_level();
+}
+
+void MetalRenderer::set_texture_filtering(unsigned int sampler_3d, unsigned int sampler_2d,
+                                          unsigned int max_anisotropy)
+{
+    // The default and 2D entries can't refer to themselves.
+    const auto valid = [](unsigned int filter, unsigned int fallback) {
+        return filter == SAMPLER_DEFAULT || filter >= SAMPLER_2D ? fallback : filter;
+    };
+    _sampler_3d = valid(sampler_3d, SAMPLER_ANISOTROPIC);
+    _sampler_2d = valid(sampler_2d, SAMPLER_TRILINEAR_CLAMP);
+    _max_anisotropy = std::clamp(max_anisotropy, 1u, 16u);
+    _samplers_dirty = true;
+    _layer_2d_dirty = true;
+}
+
+void MetalRenderer::apply_quality_level()
+{
+    _targets_dirty = true;
+    invalidate_surface_targets();
+    create_shadow_maps();
+}
+
+void MetalRenderer::set_rasterization_rates(const float *horizontal, unsigned int num_horizontal,
+                                            const float *vertical, unsigned int num_vertical)
+{
+    if (!_rate_maps_supported || num_horizontal == 0 || num_vertical == 0)
+        num_horizontal = num_vertical = 0;
+    // Called every frame, the rate map is only recreated when the rates changed.
+    if (std::equal(horizontal, horizontal + num_horizontal, _horizontal_rates.begin(), _horizontal_rates.end()) &&
+        std::equal(vertical, vertical + num_vertical, _vertical_rates.begin(), _vertical_rates.end()))
+        return;
+
+    _horizontal_rates.assign(horizontal, horizontal + num_horizontal);
+    _vertical_rates.assign(vertical, vertical + num_vertical);
+    for (float &rate : _horizontal_rates)
+        rate = std::clamp(rate, 0.0f, 1.0f);
+    for (float &rate : _vertical_rates)
+        rate = std::clamp(rate, 0.0f, 1.0f);
+
+    const bool had_rate_map = _rate_map != nil;
+    create_rate_map();
+    if ((_rate_map != nil) != had_rate_map)
+        create_scaled_targets();
+    invalidate_surface_targets();
+}
+
+void MetalRenderer::set_inset_views(const InsetView3D *views, unsigned int count)
+{
+    count = std::min(count, MAX_INSET_VIEWS);
+    // The depth of the inset pass only exists while there are inset views.
+    if ((count > 0) != !_inset_views.empty())
+    {
+        _targets_dirty = true;
+        invalidate_surface_targets();
+    }
+    _inset_views.assign(views, views + count);
+    _changes++;
+}
+
+void MetalRenderer::set_render_texture(unsigned int index, const RenderTexture &texture)
+{
+    if (texture.width == 0 || texture.height == 0)
+    {
+        replace_texture_slot(index);
+        _pending_textures.push_back({index, _fallback_texture, 0, 0, 0});
+        _flags |= Flags::UpdateTextures;
+        return;
+    }
+
+    // The view always has the size of its texture.
+    RenderTexture settings = texture;
+    settings.view.inv_width = 1.0f / static_cast<float>(texture.width);
+    settings.view.inv_height = 1.0f / static_cast<float>(texture.height);
+    settings.view.aspect_ratio = static_cast<float>(texture.width) / static_cast<float>(texture.height);
+
+    // The slot binds a texture of the size of the view until it changes, later settings only change the view.
+    const RenderTextureSlot *previous = _render_textures.find(index);
+    if (previous != nullptr && previous->settings.width == texture.width &&
+        previous->settings.height == texture.height)
+    {
+        _render_textures.set(index, settings);
+        return;
+    }
+    replace_texture_slot(index);
+
+    MTLTextureDescriptor *desc = [MTLTextureDescriptor texture2DDescriptorWithPixelFormat:MTLPixelFormatRGBA16Float
+                                                                                    width:texture.width
+                                                                                   height:texture.height
+                                                                                mipmapped:YES];
+    desc.usage = MTLTextureUsageShaderRead;
+    desc.storageMode = MTLStorageModePrivate;
+    id<MTLTexture> target = [_device newTextureWithDescriptor:desc];
+    desc.mipmapLevelCount = 1;
+    desc.usage = MTLTextureUsageRenderTarget;
+    id<MTLTexture> canvas = [_device newTextureWithDescriptor:desc];
+    desc.pixelFormat = MTLPixelFormatDepth32Float;
+    if (@available(macOS 11.0, *))
+    {
+        if (_memoryless)
+            desc.storageMode = MTLStorageModeMemoryless;
+    }
+    id<MTLTexture> depth = [_device newTextureWithDescriptor:desc];
+    if (target == nil || canvas == nil || depth == nil)
+    {
+        NSLog(@"Could not allocate the render texture of slot %u.", index);
+        return;
+    }
+    target.label = @"RenderTexture";
+    canvas.label = @"RenderTextureCanvas";
+    depth.label = @"RenderTextureDepth";
+
+    RenderTextureSlot &slot = _render_textures.set(index, settings);
+    slot.texture = target;
+    slot.canvas = canvas;
+    slot.depth = depth;
+    slot.drawn = false;
+
+    // The slot binds the texture once frames in flight are done with the texture table.
+    _pending_textures.push_back({index, target, 0, 0, 0});
+    _standalone_textures.push_back(target);
+    update_texture_residency();
+    _flags |= Flags::UpdateTextures;
+}
+
+void MetalRenderer::request_render_texture(unsigned int index)
+{
+    _render_textures.request(index);
+}
+
+void MetalRenderer::set_render_texture_budget(unsigned int pixels_per_frame)
+{
+    _render_texture_budget = pixels_per_frame;
+}
+
+bool MetalRenderer::pipelines_ready() const
+{
+    return _pipelines.ready();
+}
+
+void MetalRenderer::wait_for_pipelines()
+{
+    _pipelines.wait();
+}
+
+void MetalRenderer::notify_pipelines_ready(PipelinesReadyCallback callback, void *user_data)
+{
+    if (!callback)
+        return;
+    _pipelines.notify(^{
+      callback(user_data);
+    });
+}
+
+void MetalRenderer::set_unorm16_shadows(bool enabled)
+{
+    if (enabled == _unorm16_shadows)
+        return;
+
+    wait_for_pipelines();
+    // The states and shadow maps frames in flight were encoded with are retired.
+    _unorm16_shadows = enabled;
+    if (enabled)
+    {
+        for (const PipelineVariant &pipeline : _unorm16_shadow_pipelines)
+        {
+            pipeline.desc.depthAttachmentPixelFormat = MTLPixelFormatDepth16Unorm;
+            _retired.retire(*pipeline.state);
+            _pipelines.create(pipeline.desc, pipeline.state);
+        }
+    }
+    create_shadow_maps();
+}
+
+void MetalRenderer::set_shadow_distance(float distance)
+{
+    distance = std::max(distance, 0.0f);
+    const bool recreate = (distance > 0.0f) != (_shadow_distance > 0.0f);
+    _shadow_distance = distance;
+    if (recreate)
+        create_shadow_maps();
+}
+
+void MetalRenderer::set_gpu_mipmaps(bool enabled)
+{
+    // Only applies to textures set after this call.
+    _gpu_mipmaps = enabled;
+}
+
+void MetalRenderer::set_texture_transcoding(bool enabled)
+{
+    // Only applies to textures set after this call.
+    _texture_transcoding = enabled;
+}
+
+void MetalRenderer::set_lossy_textures(bool enabled)
+{
+    // Only applies to textures set after this call.
+    _lossy_textures = enabled;
+}
+
+bool MetalRenderer::set_video_frame(unsigned int index, CVPixelBufferRef pixel_buffer)
+{
+    // The slot binds a texture of the size of the frames until it changes, later frames are only converted into it.
+    const NSUInteger width = CVPixelBufferGetWidth(pixel_buffer);
+    const NSUInteger height = CVPixelBufferGetHeight(pixel_buffer);
+    const VideoSlot *previous = _video.find(index);
+    const bool resized = previous == nullptr || previous->target == nil || previous->target.width != width ||
+                         previous->target.height != height;
+    if (resized)
+        replace_texture_slot(index);
+
+    VideoSlot *slot = _video.set_frame(_device, index, pixel_buffer, _retired);
+    if (slot == nullptr)
+        return false;
+    if (!resized)
+        return true;
+
+    MTLTextureDescriptor *desc = [MTLTextureDescriptor texture2DDescriptorWithPixelFormat:MTLPixelFormatBGRA8Unorm
+                                                                                    width:width
+                                                                                   height:height
+                                                                                mipmapped:NO];
+    desc.usage = MTLTextureUsageRenderTarget | MTLTextureUsageShaderRead;
+    desc.storageMode = MTLStorageModePrivate;
+    slot->target = [_device newTextureWithDescriptor:desc];
+    if (slot->target == nil)
+    {
+        NSLog(@"Could not allocate the video texture of slot %u.", index);
+        _video.remove(index, _retired);
+        return false;
+    }
+    slot->target.label = @"VideoFrame";
+
+    // The slot binds the texture once frames in flight are done with the texture table.
+    _pending_textures.push_back({index, slot->target, 0, 0, 0});
+    _standalone_textures.push_back(slot->target);
+    update_texture_residency();
+    _flags |= Flags::UpdateTextures;
+    return true;
+}
+
+bool MetalRenderer::set_video_surface(unsigned int index, IOSurfaceRef surface)
+{
+    CVPixelBufferRef pixel_buffer = nullptr;
+    if (CVPixelBufferCreateWithIOSurface(kCFAllocatorDefault, surface, nullptr, &pixel_buffer) != kCVReturnSuccess)
+        return false;
+    // The slot keeps its own reference while it shows the frame.
+    const bool set = set_video_frame(index, pixel_buffer);
+    CFRelease(pixel_buffer);
+    return set;
+}
+
+void MetalRenderer::set_texture_packing(unsigned int max_size)
+{
+    // Only applies to textures set after this call, packed textures stay in their layer until they change.
+    _texture_packing = std::min(max_size, 1024u);
+}
+
+void MetalRenderer::set_texture_budget(size_t bytes)
+{
+    // Decides which textures set after this call stream, textures that already stream keep doing so without a limit
+    // when it is 0.
+    _texture_budget = bytes;
+}
+
+void MetalRenderer::set_private_geometry(bool enabled)
+{
+    // Recreates the 3D vertex buffers, frames in flight must be done with the current ones.
+    acquire_all_frames();
+    _vertex_3d_list.set_private_storage(_device, enabled ? _queue : nil);
+    _packed_3d_list.set_private_storage(_device, enabled ? _queue : nil);
+    release_all_frames();
+
+    _draw_commands_dirty = true;
+    _skinning_dirty = true;
+}
+
+void MetalRenderer::set_position_stream(bool enabled)
+{
+    // Frames in flight may still draw from the stream that is dropped, a new one is created by the next synchronize.
+    acquire_all_frames();
+    _vertex_3d_list.set_position_stream(enabled);
+    release_all_frames();
+    _flags |= Flags::Update3D;
+}
+
+CommandRecorder *MetalRenderer::create_command_recorder()
+{
+    return new CommandRecorder(&_recorded_commands);
+}
+
+void MetalRenderer::apply_recorded_commands()
+{
+    for (CommandBatch *batch = _recorded_commands.take(); batch;)
+    {
+        for (const CommandBatch::Command &command : batch->commands)
+        {
+            switch (command.type)
+            {
+            case CommandBatch::Mesh3D:
+            {
+                // The vectors keep their storage when moved, so the pointers set here stay valid in the table.
+                RecordedMesh mesh = std::move(batch->meshes[command.index]);
+                // A rejected mesh keeps its previous geometry, which may still point into the previous copy.
+                if (!set_3d_mesh(command.id, mesh.data()))
+                    break;
+                // The distance field keeps its own copy of the triangles.
+                std::vector<RTTriangle>().swap(mesh.triangles);
+                if (!_copy_on_submit)
+                    _recorded_meshes.insert(command.id, std::move(mesh));
+                break;
+            }
+            case CommandBatch::Instances3D:
+                set_3d_instances(command.id, batch->instances[command.index].data());
+                break;
+            case CommandBatch::Materials:
+            {
+                const std::vector<DeviceMaterial> &materials = batch->materials[command.index];
+                set_materials(materials.data(), static_cast<unsigned int>(materials.size()), nullptr, 0);
+                break;
+            }
+            }
+        }
+
+        CommandBatch *next = batch->next;
+        delete batch;
+        batch = next;
+    }
+}
+
+void MetalRenderer::synchronize()
+{
+    wait_for_synchronize();
+    _deferred_commands.submit();
+    _defer_changes = false;
+    synchronize_scene();
+}
+
+void MetalRenderer::synchronize_async()
+{
+    wait_for_synchronize();
+    _deferred_commands.submit();
+    _defer_changes = true;
+    dispatch_group_async(_sync_group, _sync_queue, ^{
+      @autoreleasepool
+      {
+          synchronize_scene();
+      }
+    });
+}
+
+void MetalRenderer::wait_for_synchronize()
+{
+    dispatch_group_wait(_sync_group, DISPATCH_TIME_FOREVER);
+}
+
+CommandRecorder *MetalRenderer::deferred_recorder()
+{
+    return _defer_changes ? &_deferred_commands : nullptr;
+}
+
+void MetalRenderer::finish_synchronize()
+{
+    if (!_defer_changes)
+        return;
+
+    // Changes deferred before this one are applied first, they were made first.
+    wait_for_synchronize();
+    _deferred_commands.submit();
+    apply_recorded_commands();
+    _defer_changes = false;
+}
+
+void MetalRenderer::synchronize_scene()
+{
+    wait_for_pipelines();
+    const auto start = std::chrono::steady_clock::now();
+    const os_signpost_id_t signpost = signpost_id();
+    os_signpost_interval_begin(signpost_log(), signpost, "synchronize");
+    TraceSpan span(_trace, "synchronize");
+    apply_recorded_commands();
+    add_baked_impostors();
+    if (_static_batches_dirty)
+        build_static_batches();
+    upload_deferred_textures();
+    upload_committed_textures();
+    stream_cells();
+
+    // Vertex buffers and the texture table are shared by all frames, so they can only be written once the GPU is done
+    // with every frame. Instance data is copied into the per-frame buffers when a frame gets prepared in render().
+    // Over budget, texture levels no frame sampled are evicted before meshes.
+    const size_t excess = memory_excess();
+    const size_t evicted = stream_textures(_memory_policy.evict_textures != 0 ? excess : 0);
+    stream_virtual_textures();
+    evict_meshes(excess > evicted ? excess - evicted : 0);
+    if (textures_uploaded())
+        _flags |= Flags::UpdateTextures;
+    if (_vertex_3d_list.pending_meshes() > 0 || _packed_3d_list.pending_meshes() > 0)
+        _flags |= Flags::Update3D;
+    if (_vertex_2d_list.pending_meshes() > 0)
+        _flags |= Flags::Update2D;
+
+    const bool shared_data = (_flags & (Flags::Update3D | Flags::Update2D | Flags::UpdateTextures)) != 0;
+    const unsigned int flags = _flags;
+    if (shared_data)
+    {
+        // Waiting here for the frames in flight is where a CPU stage stalls on the GPU.
+        os_signpost_interval_begin(signpost_log(), signpost, "acquire_all_frames");
+        TraceSpan acquire_span(_trace, "acquire_all_frames");
+        acquire_all_frames();
+        os_signpost_interval_end(signpost_log(), signpost, "acquire_all_frames");
+    }
+
+    if (_flags & Flags::Update3D)
+    {
+        TraceSpan list_span(_trace, "update_3d_meshes");
+        _vertex_3d_list.update_ranges();
+        _vertex_3d_list.update_data(_device, &_uploads);
+        _packed_3d_list.update_ranges();
+        _packed_3d_list.update_data(_device, &_uploads);
+        if (_clusters_dirty)
+            update_clusters();
+    }
+
+    if (_flags & (Flags::UpdateInstances3D | Flags::UpdateTransforms3D))
+    {
+        TraceSpan list_span(_trace, "update_3d_instances");
+        _instance_3d_list.update_ranges();
+        _instance_3d_list.update_data();
+    }
+
+    // Instance acceleration structures are refit when only transforms changed.
+    if (_flags & Flags::UpdateInstances3D)
+    {
+        _acceleration_structures.mark_instances_changed();
+        _bvh_scene.mark_instances_changed();
+        _sdf_scene.mark_instances_changed();
+        _bvh_all_transformed = true;
+    }
+
+    if (_flags & Flags::Update2D)
+    {
+        TraceSpan list_span(_trace, "update_2d_meshes");
+        _vertex_2d_list.update_ranges();
+        _vertex_2d_list.update_data(_device, &_uploads);
+    }
+
+    if (_flags & Flags::UpdateInstances2D)
+    {
+        TraceSpan list_span(_trace, "update_2d_instances");
+        _instance_2d_list.update_ranges();
+        _instance_2d_list.update_data();
+    }
+
+    if (_flags & (Flags::Update2D | Flags::UpdateInstances2D | Flags::UpdateClips2D))
+        build_2d_batches();
+
+    if (_flags & Flags::UpdateGlyphs)
+    {
+        TraceSpan list_span(_trace, "update_glyphs");
+        _glyph_list.update_ranges();
+        _glyph_list.update_data();
+    }
+
+    if (_flags & Flags::UpdateSprites)
+    {
+        TraceSpan list_span(_trace, "update_sprites");
+        _sprite_list.update_ranges();
+        _sprite_list.update_data();
+    }
+
+    if (_flags & (Flags::Update3D | Flags::UpdateInstances3D))
+    {
+        _draw_commands_dirty = true;
+        _skinning_dirty = true;
+    }
+
+    // Path traced samples of the previous scene no longer add up.
+    if (_flags & (Flags::Update3D | Flags::UpdateInstances3D | Flags::UpdateTransforms3D | Flags::UpdateMaterials |
+                  Flags::UpdateTextures))
+        _path_tracer.samples = 0;
+
+    if (_flags != Flags::None)
+    {
+        if (_scene_encoder == nil)
+        {
+            // Every member of Scene is a device pointer, in argument index order.
+            NSMutableArray<MTLArgumentDescriptor *> *arguments = [NSMutableArray array];
+            for (unsigned int i = 0; i < SCENE_ARGUMENT_COUNT; i++)
+                [arguments addObject:argumentDescriptorWithIndex(i, MTLDataTypePointer)];
+
+            _scene_encoder = [_device newArgumentEncoderWithArguments:arguments];
+
+            // Tier 2 argument buffers of Metal 3 GPUs have the layout of the structs, the tables are written directly
+            // instead of through the encoders. The encoder confirms the shaders were compiled for that layout.
+            if (@available(macOS 13.0, *))
+                _bindless = [_device supportsFamily:MTLGPUFamilyMetal3] &&
+                            _device.argumentBuffersSupport == MTLArgumentBuffersTier2 &&
+                            _scene_encoder.encodedLength == SCENE_ARGUMENT_COUNT * sizeof(uint64_t);
+        }
+    }
+
+    if (_flags & Flags::UpdateTextures)
+    {
+        TraceSpan list_span(_trace, "update_textures");
+        swap_uploaded_textures();
+        encode_texture_arguments();
+    }
+
+    // Swapped textures may be shown by 2D as well.
+    if (_flags & (Flags::Update2D | Flags::UpdateInstances2D | Flags::UpdateClips2D | Flags::UpdateGlyphs |
+                  Flags::UpdateSprites | Flags::UpdatePaths2D | Flags::UpdateTextures))
+        _layer_2d_dirty = true;
+
+    if (_flags != Flags::None)
+        _changes++;
+    _flags = Flags::None;
+    if (shared_data)
+        release_all_frames();
+    if (_hud.enabled())
+        _hud.add_synchronize(
+            std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+    os_signpost_interval_end(signpost_log(), signpost, "synchronize", "flags 0x%x", flags);
+}
+
+void MetalRenderer::encode_scene_arguments(unsigned int frame_index)
+{
+    if (_samplers_dirty)
+        encode_sampler_arguments();
+
+    FrameResources &frame = _frames[frame_index];
+    bool encode_all = false;
+    if (frame.args_buffer == nil)
+    {
+        const NSUInteger length = _bindless ? SCENE_ARGUMENT_COUNT * sizeof(uint64_t) : _scene_encoder.encodedLength;
+        frame.args_buffer = [_device newBufferWithLength:length options:0];
+        encode_all = true;
+    }
+
+    std::array<id<MTLBuffer>, SCENE_ARGUMENT_COUNT> buffers = {};
+    buffers[VERTICES_ARG_INDEX] = _vertex_3d_list.vertex_buffer();
+    buffers[VERTICES_2D_ARG_INDEX] = _vertex_2d_list.vertex_buffer();
+    buffers[TEXTURES_ARG_INDEX] = _textures_buffer;
+    buffers[MATERIALS_ARG_INDEX] = frame.materials;
+    buffers[INSTANCES_ARG_INDEX] = _instance_3d_list.buffer(frame_index);
+    buffers[INSTANCE_OVERRIDES_ARG_INDEX] = _instance_overrides.buffer(frame_index);
+    buffers[INSTANCES_2D_ARG_INDEX] = _instance_2d_list.buffer(frame_index);
+    buffers[PACKED_VERTICES_ARG_INDEX] = _packed_3d_list.vertex_buffer();
+    buffers[VISIBLE_INSTANCES_ARG_INDEX] = visible_instances(frame_index);
+    buffers[ANIM_VERTICES_ARG_INDEX] = _vertex_3d_list.anim_buffer();
+    buffers[VIRTUAL_PAGES_ARG_INDEX] = frame.virtual_pages;
+    buffers[SAMPLERS_ARG_INDEX] = _samplers_buffer;
+    buffers[TEXTURE_LAYERS_ARG_INDEX] = _texture_layers_buffer;
+    buffers[TEXTURE_ARRAYS_ARG_INDEX] = _texture_arrays_buffer;
+    buffers[POSITIONS_ARG_INDEX] = _vertex_3d_list.position_buffer();
+
+    unsigned int first = SCENE_ARGUMENT_COUNT;
+    unsigned int last = 0;
+    for (unsigned int i = 0; i < SCENE_ARGUMENT_COUNT; i++)
+    {
+        if (!encode_all && frame.encoded_buffers[i] == buffers[i])
+            continue;
+
+        if (_bindless)
+            write_buffer_address(frame.args_buffer, i * sizeof(uint64_t), buffers[i]);
+        else
+        {
+            if (first == SCENE_ARGUMENT_COUNT)
+                [_scene_encoder setArgumentBuffer:frame.args_buffer offset:0];
+            [_scene_encoder setBuffer:buffers[i] offset:0 atIndex:i];
+        }
+        frame.encoded_buffers[i] = buffers[i];
+        first = std::min(first, i);
+        last = i;
+    }
+
+    // Bindless entries are flushed on their own, the layout of encoded ones is opaque.
+    if (first <= last && _bindless)
+        did_modify(frame.args_buffer, NSMakeRange(first * sizeof(uint64_t), (last - first + 1) * sizeof(uint64_t)));
+    else if (first <= last)
+        did_modify(frame.args_buffer, NSMakeRange(0, frame.args_buffer.length));
+}
+
+void MetalRenderer::encode_texture_arguments()
+{
+    if (_texture_encoder == nil)
+    {
+        MTLArgumentDescriptor *textureArgument = argumentDescriptorWithIndex(0, MTLDataTypeTexture);
+        _texture_encoder = [_device newArgumentEncoderWithArguments:@[ textureArgument ]];
+    }
+
+    if (_textures.empty())
+        return;
+
+    const NSUInteger stride = _bindless ? sizeof(MTLResourceID) : _texture_encoder.encodedLength;
+    if (_textures_buffer == nil || _textures_buffer.length < stride * _textures.size())
+    {
+        // Grows in steps so adding a few textures doesn't reallocate the table every time.
+        const unsigned int capacity = next_multiple_of(static_cast<unsigned int>(_textures.size()), 64);
+        _textures_buffer = [_device newBufferWithLength:stride * capacity options:0];
+        _encoded_textures.clear();
+    }
+
+    if (_encoded_textures.size() < _textures.size())
+        _encoded_textures.resize(_textures.size());
+
+    // Only the entries of changed textures are written and flushed, in runs of nearby entries.
+    std::vector<DirtyRange> ranges;
+    for (unsigned int i = 0; i < _textures.size(); i++)
+    {
+        if (_encoded_textures[i] == _textures[i])
+            continue;
+
+        if (_bindless)
+            write_texture_id(_textures_buffer, stride * i, _textures[i]);
+        else
+        {
+            [_texture_encoder setArgumentBuffer:_textures_buffer offset:stride * i];
+            [_texture_encoder setTexture:_textures[i] atIndex:0];
+        }
+        _encoded_textures[i] = _textures[i];
+        if (!ranges.empty() && ranges.back().end == i)
+            ranges.back().end = i + 1;
+        else
+            ranges.push_back({i, i + 1});
+    }
+    for (const DirtyRange &range : coalesce(std::move(ranges), 16))
+        did_modify(_textures_buffer, NSMakeRange(stride * range.start, stride * (range.end - range.start)));
+
+    // The layer table holds a word per texture, it is written whole.
+    const NSUInteger layers_size = sizeof(unsigned int) * _texture_layers.size();
+    if (_texture_layers_buffer == nil || _texture_layers_buffer.length < layers_size)
+    {
+        const unsigned int capacity = next_multiple_of(static_cast<unsigned int>(_texture_layers.size()), 64);
+        _texture_layers_buffer = [_device newBufferWithLength:sizeof(unsigned int) * capacity options:0];
+    }
+    std::memcpy(_texture_layers_buffer.contents, _texture_layers.data(), layers_size);
+    did_modify(_texture_layers_buffer, NSMakeRange(0, layers_size));
+
+    const std::vector<id<MTLTexture>> &arrays = _texture_arrays.textures();
+    if (arrays.empty() || arrays.size() == _encoded_texture_arrays)
+        return;
+
+    if (_texture_array_encoder == nil)
+    {
+        MTLArgumentDescriptor *arrayArgument = argumentDescriptorWithIndex(0, MTLDataTypeTexture);
+        arrayArgument.textureType = MTLTextureType2DArray;
+        _texture_array_encoder = [_device newArgumentEncoderWithArguments:@[ arrayArgument ]];
+    }
+
+    const NSUInteger array_stride = _bindless ? sizeof(MTLResourceID) : _texture_array_encoder.encodedLength;
+    if (_texture_arrays_buffer == nil || _texture_arrays_buffer.length < array_stride * arrays.size())
+    {
+        const unsigned int capacity = next_multiple_of(static_cast<unsigned int>(arrays.size()), 16);
+        _texture_arrays_buffer = [_device newBufferWithLength:array_stride * capacity options:0];
+        _encoded_texture_arrays = 0;
+    }
+    for (size_t i = _encoded_texture_arrays; i < arrays.size(); i++)
+    {
+        if (_bindless)
+        {
+            write_texture_id(_texture_arrays_buffer, array_stride * i, arrays[i]);
+            continue;
+        }
+        [_texture_array_encoder setArgumentBuffer:_texture_arrays_buffer offset:array_stride * i];
+        [_texture_array_encoder setTexture:arrays[i] atIndex:0];
+    }
+    did_modify(_texture_arrays_buffer, NSMakeRange(array_stride * _encoded_texture_arrays,
+                                                   array_stride * (arrays.size() - _encoded_texture_arrays)));
+    _encoded_texture_arrays = arrays.size();
+}
+
+void MetalRenderer::encode_sampler_arguments()
+{
+    if (_sampler_encoder == nil)
+    {
+        MTLArgumentDescriptor *samplerArgument = argumentDescriptorWithIndex(0, MTLDataTypeSampler);
+        _sampler_encoder = [_device newArgumentEncoderWithArguments:@[ samplerArgument ]];
+    }
+
+    const auto create_sampler = [&](unsigned int filter) {
+        MTLSamplerDescriptor *desc = [[MTLSamplerDescriptor alloc] init];
+        const bool nearest = filter == SAMPLER_NEAREST;
+        desc.minFilter = nearest ? MTLSamplerMinMagFilterNearest : MTLSamplerMinMagFilterLinear;
+        desc.magFilter = nearest ? MTLSamplerMinMagFilterNearest : MTLSamplerMinMagFilterLinear;
+        desc.mipFilter = nearest ? MTLSamplerMipFilterNearest : MTLSamplerMipFilterLinear;
+        desc.maxAnisotropy = filter == SAMPLER_ANISOTROPIC ? _max_anisotropy : 1;
+        const bool clamp = filter == SAMPLER_TRILINEAR_CLAMP || filter == SAMPLER_NEAREST;
+        const MTLSamplerAddressMode address = clamp ? MTLSamplerAddressModeClampToEdge : MTLSamplerAddressModeRepeat;
+        desc.sAddressMode = address;
+        desc.tAddressMode = address;
+        desc.supportArgumentBuffers = YES;
+        return [_device newSamplerStateWithDescriptor:desc];
+    };
+
+    const NSUInteger stride = _bindless ? sizeof(MTLResourceID) : _sampler_encoder.encodedLength;
+    _retired.retire(_samplers_buffer, _samplers[0], _samplers[1], _samplers[2], _samplers[3], _samplers[4],
+                    _samplers[5]);
+    _samplers_buffer = [_device newBufferWithLength:stride * SAMPLER_COUNT options:0];
+    for (unsigned int i = 0; i < SAMPLER_COUNT; i++)
+    {
+        const unsigned int filter = i == SAMPLER_DEFAULT ? _sampler_3d : i == SAMPLER_2D ? _sampler_2d : i;
+        _samplers[i] = create_sampler(filter);
+        if (_bindless)
+        {
+            write_sampler_id(_samplers_buffer, stride * i, _samplers[i]);
+            continue;
+        }
+        [_sampler_encoder setArgumentBuffer:_samplers_buffer offset:stride * i];
+        [_sampler_encoder setSamplerState:_samplers[i] atIndex:0];
+    }
+    did_modify(_samplers_buffer, NSMakeRange(0, _samplers_buffer.length));
+    _samplers_dirty = false;
+}
+
+// Planes of the depth zero-to-one clip volume of combined, pointing inwards. The far plane of an infinite projection
+// has no normal and keeps everything.
+std::array<vec4, 6> frustum_planes(const mat4 &combined)
+{
+    const mat4 m = transpose(combined);
+    std::array<vec4, 6> planes = {m[3] + m[0], m[3] - m[0], m[3] + m[1], m[3] - m[1], m[2], m[3] - m[2]};
+    for (vec4 &plane : planes)
+    {
+        const float normal = length(vec3(plane));
+        plane = normal > 0.0f ? plane / normal : vec4(0.0f, 0.0f, 0.0f, 1.0f);
+    }
+    return planes;
+}
+
+void set_cull_planes(CullUniforms &uniforms, const mat4 &combined)
+{
+    const std::array<vec4, 6> planes = frustum_planes(combined);
+    for (int i = 0; i < 6; i++)
+        uniforms.planes[i] = simd_make_float4(planes[i].x, planes[i].y, planes[i].z, planes[i].w);
+}
+
+bool intersects(const std::array<vec4, 6> &planes, const Aabb &bounds)
+{
+    const vec3 lo = vec3(bounds.bmin.x, bounds.bmin.y, bounds.bmin.z);
+    const vec3 hi = vec3(bounds.bmax.x, bounds.bmax.y, bounds.bmax.z);
+    if (any(greaterThan(lo, hi)))
+        return false;
+
+    const vec3 center = (lo + hi) * 0.5f;
+    const vec3 extent = (hi - lo) * 0.5f;
+    for (const vec4 &plane : planes)
+    {
+        if (dot(vec3(plane), center) + plane.w + dot(abs(vec3(plane)), extent) < 0.0f)
+            return false;
+    }
+    return true;
+}
+
+// Whether the sphere of a reflection probe overlaps bounds.
+bool intersects(const ReflectionProbe &probe, const Aabb &bounds)
+{
+    const vec3 lo = vec3(bounds.bmin.x, bounds.bmin.y, bounds.bmin.z);
+    const vec3 hi = vec3(bounds.bmax.x, bounds.bmax.y, bounds.bmax.z);
+    if (any(greaterThan(lo, hi)))
+        return false;
+
+    const vec3 center = vec3(probe.pos_x, probe.pos_y, probe.pos_z);
+    const vec3 offset = clamp(center, lo, hi) - center;
+    return dot(offset, offset) <= probe.radius * probe.radius;
+}
+
+void MetalRenderer::cull_submeshes(const mat4 &combined)
+{
+    std::sort(_moved_submeshes.begin(), _moved_submeshes.end());
+    _moved_submeshes.erase(std::unique(_moved_submeshes.begin(), _moved_submeshes.end()), _moved_submeshes.end());
+    for (const unsigned int id : _moved_submeshes)
+    {
+        std::vector<Submesh> *submeshes = _submeshes.find(id);
+        if (!submeshes)
+            continue;
+
+        const bool has_matrices = id < _instance_3d_matrices.size() && _instance_3d_matrices[id];
+        for (Submesh &submesh : *submeshes)
+        {
+            submesh.world_bounds =
+                has_matrices ? world_bounds(submesh.bounds, *_instance_3d_matrices[id]) : empty_bounds();
+        }
+    }
+    _moved_submeshes.clear();
+
+    // Meshes with all of their submeshes visible get no draws and are drawn whole, adjacent visible submeshes are
+    // drawn together. The inset views and render textures draw the same submeshes, which are visible in the union of
+    // all views.
+    _submesh_draws.clear();
+    std::vector<std::array<vec4, 6>> frusta = {frustum_planes(combined)};
+    for (const InsetView3D &inset : _inset_views)
+        frusta.push_back(frustum_planes(get_rh_projection_matrix(inset.view) * get_rh_view_matrix(inset.view)));
+    _render_textures.for_each([&](const RenderTextureSlot &slot) {
+        frusta.push_back(frustum_planes(get_rh_projection_matrix(slot.settings.view) *
+                                        get_rh_view_matrix(slot.settings.view)));
+    });
+    const auto visible = [&frusta](const Aabb &bounds) {
+        return std::any_of(frusta.begin(), frusta.end(),
+                           [&bounds](const std::array<vec4, 6> &planes) { return intersects(planes, bounds); });
+    };
+    for (const auto &[id, submeshes] : _submeshes)
+    {
+        if (transformed_on_gpu(id))
+            continue;
+
+        std::vector<SubmeshDraw> draws;
+        bool culled = false;
+        for (const Submesh &submesh : submeshes)
+        {
+            if (!visible(submesh.world_bounds))
+                culled = true;
+            else if (!draws.empty() && draws.back().first + draws.back().count == submesh.first)
+                draws.back().count += submesh.count;
+            else
+                draws.push_back({submesh.first, submesh.count});
+        }
+        if (culled)
+            _submesh_draws.insert(id, std::move(draws));
+    }
+}
+
+UploadAllocation MetalRenderer::encode_instance_culling(id<MTLCommandBuffer> command_buffer, unsigned int frame_index,
+                                                        const mat4 &combined, const vec4 &lod_view)
+{
+    _culling.args.clear();
+    _culling.base_instance_words.clear();
+    _culling.late_args = {};
+    _culling.visible_count = culled_instance_count();
+    _culling.early_args = {};
+    _culling.cluster_args = {};
+    _culling.skinned_args = {};
+    _culling.skinned_runs.clear();
+    _culling.bvh = false;
+    _culling.draw_depths = {};
+    _lod_slots.clear();
+    const IdTable<InstanceRange<mat4>> &instances = _instance_3d_list.get_ranges();
+    if (instances.empty())
+        return {};
+
+    _culling.cull_draws.resize(instances.size());
+    _culling.draw_meshes.clear();
+    CullDraw *draws_data = _culling.cull_draws.data();
+
+    _draw_slots.assign(instances.id_bound(), ~0u);
+
+    // Meshes are visited by their first instance, so the draws end up sorted by where their visible instances go.
+    // Those of a mesh with its own instance range take the slots of its instances, the other meshes of a prefab
+    // follow all of them.
+    const IdTable<DrawDescriptor> &full_ranges = _vertex_3d_list.get_draw_ranges();
+    const IdTable<DrawDescriptor> &packed_ranges = _packed_3d_list.get_draw_ranges();
+    unsigned int num_draws = 0;
+    unsigned int num_instances = 0;
+    std::vector<unsigned int> lod_meshes;
+    std::vector<unsigned int> members;
+    const auto add_draw = [&](unsigned int i, const InstanceRange<mat4> &insts, unsigned int visible_start) {
+        // Skinned meshes are drawn per skin, encode_skinned_culling culls their runs.
+        if (_skinned_instances.has(i))
+            return false;
+
+        const DrawDescriptor *range = full_ranges.find(i);
+        if (!range)
+            range = packed_ranges.find(i);
+        if (!range)
+            return false;
+
+        const DrawDescriptor &draw = *range;
+        if (insts.count == 0 || draw.start >= draw.end || !_pvs.visible(_pvs_cell, i))
+            return false;
+
+        const unsigned int slot = num_draws++;
+        _draw_slots[i] = slot;
+        _culling.draw_meshes.push_back(i);
+
+        if (draw.index_count > 0)
+        {
+            _culling.args.insert(_culling.args.end(), {draw.index_count, 0, 0, draw.start, visible_start});
+            _culling.base_instance_words.push_back(4);
+        }
+        else
+        {
+            _culling.args.insert(_culling.args.end(), {draw.end - draw.start, 0, draw.start, visible_start, 0});
+            _culling.base_instance_words.push_back(3);
+        }
+
+        CullDraw &cull_draw = draws_data[slot];
+        const Aabb bounds = i < _instance_3d_bounds.size() ? _instance_3d_bounds[i] : Aabb{};
+        if (simd_any(bounds.bmin.xyz > bounds.bmax.xyz) || simd_all(bounds.bmin.xyz == bounds.bmax.xyz))
+        {
+            // Meshes without valid bounds are never culled.
+            cull_draw.center = simd_make_float4(0.0f, 0.0f, 0.0f, 0.0f);
+            cull_draw.extent = simd_make_float4(1e30f, 1e30f, 1e30f, 0.0f);
+        }
+        else
+        {
+            cull_draw.center = (bounds.bmin + bounds.bmax) * 0.5f;
+            cull_draw.extent = (bounds.bmax - bounds.bmin) * 0.5f;
+        }
+        cull_draw.instance_start = insts.start;
+        cull_draw.instance_count = insts.count;
+        cull_draw.visible_start = visible_start;
+        cull_draw.args_offset = slot * DRAW_ARGS_WORDS;
+        cull_draw.lod_count = 0;
+        num_instances = visible_start + insts.count;
+        if (_mesh_lods.has(i))
+            lod_meshes.push_back(i);
+        return true;
+    };
+
+    for (const auto &[start, i] : _instance_3d_list.lists_by_offset())
+    {
+        add_draw(i, *instances.find(i), start);
+        if (const std::vector<unsigned int> *prefab = _prefab_members.find(i))
+            members.insert(members.end(), prefab->begin(), prefab->end());
+    }
+
+    auto visible_start = static_cast<unsigned int>(_instance_3d_list.total());
+    for (const unsigned int i : members)
+    {
+        const InstanceRange<mat4> &insts = *instances.find(i);
+        if (add_draw(i, insts, visible_start))
+            visible_start += insts.count;
+    }
+
+    if (num_draws == 0)
+        return {};
+
+    // Coarser levels draw from the slots after those of all meshes. Each level has room for every instance of its
+    // mesh, the chain ends at the first level that has nothing to draw.
+    unsigned int lod_instance_start = visible_start;
+    unsigned int next_slot = num_draws;
+    for (const unsigned int i : lod_meshes)
+    {
+        CullDraw &cull_draw = draws_data[_draw_slots[i]];
+        const std::vector<MeshLod> &levels = *_mesh_lods.find(i);
+        cull_draw.lod_instance_start = lod_instance_start;
+        for (const MeshLod &level : levels)
+        {
+            const DrawDescriptor *range = full_ranges.find(level.mesh_id);
+            if (!range)
+                range = packed_ranges.find(level.mesh_id);
+            if (!range || range->start >= range->end)
+                break;
+
+            const unsigned int instance_start = lod_instance_start + cull_draw.lod_count * cull_draw.instance_count;
+            if (range->index_count > 0)
+            {
+                _culling.args.insert(_culling.args.end(), {range->index_count, 0, 0, range->start, instance_start});
+                _culling.base_instance_words.push_back(4);
+            }
+            else
+            {
+                _culling.args.insert(_culling.args.end(),
+                                     {range->end - range->start, 0, range->start, instance_start, 0});
+                _culling.base_instance_words.push_back(3);
+            }
+            cull_draw.lod_sizes[cull_draw.lod_count] = level.screen_size;
+            cull_draw.lod_args_offsets[cull_draw.lod_count] = next_slot * DRAW_ARGS_WORDS;
+            _lod_slots[level.mesh_id].push_back({next_slot++, i});
+            cull_draw.lod_count++;
+        }
+        lod_instance_start += cull_draw.instance_count * static_cast<unsigned int>(levels.size());
+    }
+
+    CullUniforms uniforms = {};
+    set_cull_planes(uniforms, combined);
+    uniforms.lod_view = simd_make_float4(lod_view.x, lod_view.y, lod_view.z, lod_view.w);
+    uniforms.num_draws = num_draws;
+    uniforms.num_instances = num_instances;
+    _culling.cull_draws.resize(num_draws);
+    _culling.uniforms = uniforms;
+    if (_cpu_culling)
+    {
+        _cluster_slots.clear();
+        _culling.early_args = cull_instances(frame_index, uniforms, 0);
+        return _culling.early_args;
+    }
+
+    _culling.draws = _upload_ring.upload(draws_data, num_draws);
+    const UploadAllocation args = allocate_culled_args(0);
+    id<MTLComputePipelineState> state = _cull_state;
+    id<MTLComputeCommandEncoder> encoder = _frame_timer.compute_encoder(command_buffer, FRAME_PASS_CULLING);
+    encoder.label = @"InstanceCulling";
+
+    // Slots of the instances transformed since the tree was last brought up to date and of the meshes transformed on
+    // the GPU. Frames that don't cull on the GPU keep the changes, once they pile up every slot is refit.
+    std::vector<unsigned int> moved;
+    bool refit_all = std::exchange(_bvh_all_transformed, false);
+    const auto add_moved = [&](unsigned int mesh, unsigned int first, unsigned int last) {
+        const unsigned int slot = mesh < _draw_slots.size() ? _draw_slots[mesh] : ~0u;
+        if (refit_all || slot == ~0u)
+            return;
+        const CullDraw &draw = draws_data[slot];
+        for (unsigned int k = first; k < std::min(last, draw.instance_count); k++)
+            moved.push_back(draw.visible_start + k);
+        refit_all = moved.size() > num_instances / 8;
+    };
+    if (num_instances >= INSTANCE_BVH_MIN_SLOTS)
+    {
+        for (const glm::uvec3 &range : _bvh_transformed)
+        {
+            add_moved(range.x, range.y, range.z);
+            if (const std::vector<unsigned int> *prefab = _prefab_members.find(range.x))
+            {
+                for (const unsigned int member : *prefab)
+                    add_moved(member, range.y, range.z);
+            }
+        }
+        for (const unsigned int mesh : _culling.draw_meshes)
+        {
+            if (transformed_on_gpu(mesh))
+                add_moved(mesh, 0, ~0u);
+        }
+    }
+    _bvh_transformed.clear();
+    _instance_bvh.encode_update(encoder, _primitives, _upload_ring, _instance_3d_list.buffer(frame_index),
+                                _culling.draws, _culling.cull_draws, num_instances, moved, refit_all);
+    _culling.bvh = _instance_bvh.active();
+
+    // Only the main view records depths, other views start from uniforms without them.
+    if (_gpu_driven)
+    {
+        _culling.draw_depths = _upload_ring.allocate(_culling.args.size() / DRAW_ARGS_WORDS * sizeof(unsigned int));
+        if (_culling.draw_depths.valid())
+            std::memset(_culling.draw_depths.data, 0xFF, _culling.draw_depths.size);
+        uniforms.sort_depths = _culling.draw_depths.valid() ? 1 : 0;
+    }
+
+    if (_occlusion_culling)
+    {
+        update_depth_pyramid();
+        memcpy(&uniforms.hzb_combined, value_ptr(_depth_pyramid_combined), sizeof(mat4));
+        uniforms.occlusion_phase = 1;
+        uniforms.depth_width = static_cast<unsigned int>(_depth_texture.width);
+        uniforms.depth_height = static_cast<unsigned int>(_depth_texture.height);
+        uniforms.hzb_levels = _depth_pyramid_valid ? static_cast<unsigned int>(_depth_pyramid_levels.size()) : 0;
+
+        state = _occlusion_cull_state;
+        [encoder setBuffer:_occluded_instances offset:0 atIndex:5];
+        [encoder setTexture:_depth_pyramid atIndex:0];
+
+        // Late draws read their instances from the second part of the visible instance list.
+        _culling.late_args = allocate_culled_args(_culling.visible_count);
+        _culling.late_uniforms = uniforms;
+    }
+
+    dispatch_culling(encoder, state, frame_index, uniforms, args);
+    encode_cluster_culling(encoder, frame_index, uniforms, args);
+    encode_skinned_culling(encoder, frame_index, uniforms);
+    [encoder endEncoding];
+
+    _culling.early_args = args;
+    return args;
+}
+
+void MetalRenderer::encode_skinned_culling(id<MTLComputeCommandEncoder> encoder, unsigned int frame_index,
+                                           const CullUniforms &uniforms)
+{
+    if (_skinned_instances.empty() || _skinned_bounds == nil)
+        return;
+
+    // Runs are split like encode_3d_draws draws them, every mesh's runs follow those of the meshes before it.
+    const IdTable<DrawDescriptor> &full_ranges = _vertex_3d_list.get_draw_ranges();
+    const IdTable<InstanceRange<mat4>> &instances = _instance_3d_list.get_ranges();
+    std::vector<SkinnedCullRun> runs;
+    std::vector<unsigned int> args;
+    for (const auto &[i, groups] : _skinned_instances)
+    {
+        const DrawDescriptor *range = full_ranges.find(i);
+        const auto insts = instances.find(i);
+        if (!range || !insts)
+            continue;
+
+        const Aabb bounds = i < _instance_3d_bounds.size() ? _instance_3d_bounds[i] : Aabb{};
+        const bool bounded =
+            !simd_any(bounds.bmin.xyz > bounds.bmax.xyz) && !simd_all(bounds.bmin.xyz == bounds.bmax.xyz);
+        _culling.skinned_runs.insert(i, static_cast<unsigned int>(runs.size()));
+        const unsigned int count = std::min(insts->count, static_cast<unsigned int>(groups.size()));
+        for (unsigned int first = 0; first < count;)
+        {
+            unsigned int last = first + 1;
+            while (last < count && groups[last] == groups[first])
+                last++;
+
+            // Runs without bounds, of the mesh or of a group that skinned nothing, are never culled.
+            SkinnedCullRun run = {};
+            const bool skinned = groups[first] != ~0u;
+            run.center = bounded && !skinned ? (bounds.bmin + bounds.bmax) * 0.5f : simd_make_float4(0.0f);
+            run.extent = bounded && !skinned ? (bounds.bmax - bounds.bmin) * 0.5f : simd_make_float4(1e30f);
+            run.instance_start = insts->start + first;
+            run.instance_count = last - first;
+            run.group = skinned ? groups[first] : NO_SKINNING_GROUP;
+            run.args_offset = static_cast<unsigned int>(args.size());
+            runs.push_back(run);
+
+            const unsigned int vertex_start = skinned ? _skinning_groups[groups[first]].out_start : range->start;
+            if (range->index_count > 0)
+                args.insert(args.end(), {range->index_count, run.instance_count, 0, vertex_start, run.instance_start});
+            else
+                args.insert(args.end(),
+                            {range->end - range->start, run.instance_count, vertex_start, run.instance_start, 0});
+            first = last;
+        }
+    }
+    if (runs.empty())
+        return;
+
+    const UploadAllocation runs_data = _upload_ring.upload(runs.data(), runs.size());
+    _culling.skinned_args = _upload_ring.upload(args.data(), args.size());
+    const simd_uint2 counts =
+        simd_make_uint2(static_cast<unsigned int>(runs.size()), static_cast<unsigned int>(_skinning_groups.size()));
+    [encoder setComputePipelineState:_cull_skinned_state];
+    [encoder setBuffer:_instance_3d_list.buffer(frame_index) offset:0 atIndex:0];
+    [encoder setBytes:&uniforms length:sizeof(CullUniforms) atIndex:1];
+    [encoder setBuffer:runs_data.buffer offset:runs_data.offset atIndex:2];
+    [encoder setBuffer:_culling.skinned_args.buffer offset:_culling.skinned_args.offset atIndex:3];
+    [encoder setBuffer:_skinned_bounds offset:0 atIndex:4];
+    [encoder setBytes:&counts length:sizeof(simd_uint2) atIndex:5];
+    const NSUInteger group_size = std::min<NSUInteger>(_cull_skinned_state.maxTotalThreadsPerThreadgroup, 64);
+    [encoder dispatchThreadgroups:MTLSizeMake((runs.size() + group_size - 1) / group_size, 1, 1)
+            threadsPerThreadgroup:MTLSizeMake(group_size, 1, 1)];
+}
+
+void MetalRenderer::encode_cluster_culling(id<MTLComputeCommandEncoder> encoder, unsigned int frame_index,
+                                           const CullUniforms &uniforms, const UploadAllocation &args)
+{
+    _cluster_slots.clear();
+    if (_num_clusters == 0)
+        return;
+
+    // Meshes set again since their clusters were built draw all of their triangles until the next synchronize.
+    const IdTable<DrawDescriptor> &full_ranges = _vertex_3d_list.get_draw_ranges();
+    std::vector<ClusterDraw> draws;
+    std::vector<unsigned int> cluster_args;
+    unsigned int out_start = 0;
+    for (const auto &[i, clusters] : _cluster_ranges)
+    {
+        const DrawDescriptor *range = full_ranges.find(i);
+        const unsigned int slot = i < _draw_slots.size() ? _draw_slots[i] : ~0u;
+        if (slot == ~0u || !range || range->index_count != clusters.index_count)
+            continue;
+
+        ClusterDraw draw = {};
+        draw.cluster_start = clusters.start;
+        draw.cluster_count = clusters.count;
+        draw.instance_args_offset = slot * DRAW_ARGS_WORDS;
+        draw.args_offset = static_cast<unsigned int>(draws.size()) * DRAW_ARGS_WORDS;
+        draw.index_start = range->index_offset / (range->short_indices ? 2 : 4);
+        draw.out_start = out_start;
+        draw.short_indices = range->short_indices ? 1 : 0;
+        cluster_args.insert(cluster_args.end(), {0, 0, out_start, range->start, 0});
+        _cluster_slots.insert(i, static_cast<unsigned int>(draws.size()));
+        draws.push_back(draw);
+        out_start += range->index_count;
+    }
+    if (draws.empty())
+        return;
+
+    ClusterUniforms cluster_uniforms = {};
+    std::copy(std::begin(uniforms.planes), std::end(uniforms.planes), cluster_uniforms.planes);
+    cluster_uniforms.camera_position = uniforms.lod_view;
+    cluster_uniforms.num_clusters = _num_clusters;
+    cluster_uniforms.num_draws = static_cast<unsigned int>(draws.size());
+    const UploadAllocation draws_data = _upload_ring.upload(draws.data(), draws.size());
+    _culling.cluster_args = _upload_ring.upload(cluster_args.data(), cluster_args.size());
+
+    // Dispatches of a serial compute encoder run in order, the instance counts of the culled draws are final.
+    [encoder setComputePipelineState:_cull_clusters_state];
+    [encoder setBuffer:_instance_3d_list.buffer(frame_index) offset:0 atIndex:0];
+    [encoder setBytes:&cluster_uniforms length:sizeof(ClusterUniforms) atIndex:1];
+    [encoder setBuffer:_clusters offset:0 atIndex:2];
+    [encoder setBuffer:draws_data.buffer offset:draws_data.offset atIndex:3];
+    [encoder setBuffer:args.buffer offset:args.offset atIndex:4];
+    [encoder setBuffer:_visible_instances offset:0 atIndex:5];
+    [encoder setBuffer:_culling.cluster_args.buffer offset:_culling.cluster_args.offset atIndex:6];
+    [encoder setBuffer:_vertex_3d_list.index_buffer() offset:0 atIndex:7];
+    [encoder setBuffer:_vertex_3d_list.index_buffer() offset:0 atIndex:8];
+    [encoder setBuffer:_culled_indices offset:0 atIndex:9];
+    [encoder dispatchThreadgroups:MTLSizeMake(_num_clusters, 1, 1) threadsPerThreadgroup:MTLSizeMake(64, 1, 1)];
+}
+
+void MetalRenderer::update_clusters()
+{
+    _clusters_dirty = false;
+    _cluster_ranges.clear();
+    std::vector<MeshCluster> clusters;
+    unsigned int index_count = 0;
+    for (const auto &[i, mesh_clusters] : _mesh_clusters)
+    {
+        const MeshCluster &last = mesh_clusters.back();
+        const unsigned int mesh_indices = last.index_start + last.index_count;
+        _cluster_ranges.insert(i, {static_cast<unsigned int>(clusters.size()),
+                                   static_cast<unsigned int>(mesh_clusters.size()), mesh_indices});
+        clusters.insert(clusters.end(), mesh_clusters.begin(), mesh_clusters.end());
+        index_count += mesh_indices;
+    }
+
+    _num_clusters = static_cast<unsigned int>(clusters.size());
+    if (clusters.empty())
+    {
+        _clusters = nil;
+        _culled_indices = nil;
+        return;
+    }
+
+    _clusters = [_device newBufferWithBytes:clusters.data()
+                                     length:clusters.size() * sizeof(MeshCluster)
+                                    options:cpu_write_storage(_device)];
+    _clusters.label = @"Clusters";
+    if (_culled_indices == nil || _culled_indices.length < index_count * sizeof(unsigned int))
+    {
+        const unsigned int length =
+            next_multiple_of(index_count * static_cast<unsigned int>(sizeof(unsigned int)), 65536);
+        _culled_indices = [_device newBufferWithLength:length options:MTLResourceStorageModePrivate];
+        _culled_indices.label = @"CulledIndices";
+    }
+}
+
+unsigned int MetalRenderer::culled_instance_count() const
+{
+    auto count = static_cast<unsigned int>(_instance_3d_list.total());
+    const IdTable<InstanceRange<mat4>> &instances = _instance_3d_list.get_ranges();
+    for (const auto &[i, members] : _prefab_members)
+    {
+        if (const InstanceRange<mat4> *insts = instances.find(i))
+            count += insts->count * static_cast<unsigned int>(members.size());
+    }
+    for (const auto &[i, levels] : _mesh_lods)
+    {
+        if (const InstanceRange<mat4> *insts = instances.find(i))
+            count += insts->count * static_cast<unsigned int>(levels.size());
+    }
+    return count;
+}
+
+UploadAllocation MetalRenderer::encode_late_culling(id<MTLCommandBuffer> command_buffer, unsigned int frame_index,
+                                                    const mat4 &combined)
+{
+    if (!_culling.late_args.valid())
+        return {};
+
+    id<MTLComputeCommandEncoder> encoder = _frame_timer.compute_encoder(command_buffer, FRAME_PASS_CULLING);
+    encoder.label = @"DepthPyramid";
+
+    // Dispatches of a serial compute encoder run in order, every level reads the one written before it.
+    const auto dispatch_level = [&](id<MTLComputePipelineState> state, id<MTLTexture> src, id<MTLTexture> dst) {
+        [encoder setComputePipelineState:state];
+        [encoder setTexture:src atIndex:0];
+        [encoder setTexture:dst atIndex:1];
+        [encoder dispatchThreadgroups:MTLSizeMake((dst.width + 7) / 8, (dst.height + 7) / 8, 1)
+                threadsPerThreadgroup:MTLSizeMake(8, 8, 1)];
+    };
+    dispatch_level(_depth_pyramid_init_state, _depth_texture, _depth_pyramid_levels[0]);
+    for (size_t i = 1; i < _depth_pyramid_levels.size(); i++)
+        dispatch_level(_depth_pyramid_state, _depth_pyramid_levels[i - 1], _depth_pyramid_levels[i]);
+
+    CullUniforms uniforms = _culling.late_uniforms;
+    memcpy(&uniforms.hzb_combined, value_ptr(combined), sizeof(mat4));
+    uniforms.occlusion_phase = 2;
+    uniforms.visible_offset = _culling.visible_count;
+    uniforms.hzb_levels = static_cast<unsigned int>(_depth_pyramid_levels.size());
+
+    [encoder setBuffer:_occluded_instances offset:0 atIndex:5];
+    [encoder setTexture:_depth_pyramid atIndex:0];
+    dispatch_culling(encoder, _occlusion_cull_state, frame_index, uniforms, _culling.late_args);
+    [encoder endEncoding];
+
+    // The next frame's early phase tests against the pyramid of this frame's early draws, which is conservative as
+    // it lacks only the late draws.
+    _depth_pyramid_combined = combined;
+    _depth_pyramid_valid = true;
+
+    const UploadAllocation args = _culling.late_args;
+    _culling.late_args = {};
+    return args;
+}
+
+UploadAllocation MetalRenderer::encode_view_culling(id<MTLCommandBuffer> command_buffer, unsigned int frame_index,
+                                                    const mat4 &combined, unsigned int visible_offset)
+{
+    if (_culling.args.empty())
+        return {};
+
+    CullUniforms uniforms = _culling.uniforms;
+    set_cull_planes(uniforms, combined);
+    uniforms.visible_offset = visible_offset;
+    if (_cpu_culling)
+        return cull_instances(frame_index, uniforms, visible_offset);
+
+    const UploadAllocation args = allocate_culled_args(visible_offset);
+    id<MTLComputeCommandEncoder> encoder = _frame_timer.compute_encoder(command_buffer, FRAME_PASS_CULLING);
+    encoder.label = @"ViewCulling";
+    dispatch_culling(encoder, _cull_state, frame_index, uniforms, args);
+    [encoder endEncoding];
+    return args;
+}
+
+UploadAllocation MetalRenderer::allocate_culled_args(unsigned int visible_offset)
+{
+    const UploadAllocation args = _upload_ring.upload(_culling.args.data(), _culling.args.size());
+    auto *data = reinterpret_cast<unsigned int *>(args.data);
+    for (size_t slot = 0; data && visible_offset > 0 && slot < _culling.base_instance_words.size(); slot++)
+        data[slot * DRAW_ARGS_WORDS + _culling.base_instance_words[slot]] += visible_offset;
+    return args;
+}
+
+// Frustum planes of CullUniforms by component, eight wide so one instance is tested against all of them at once. The
+// planes past the six of the frustum keep everything.
+struct CullPlanes
+{
+    simd_float8 x, y, z, w;
+    simd_float8 abs_x, abs_y, abs_z;
+};
+
+CullPlanes cull_planes(const CullUniforms &uniforms)
+{
+    CullPlanes planes = {};
+    planes.w = 1.0f;
+    for (int i = 0; i < 6; i++)
+    {
+        planes.x[i] = uniforms.planes[i].x;
+        planes.y[i] = uniforms.planes[i].y;
+        planes.z[i] = uniforms.planes[i].z;
+        planes.w[i] = uniforms.planes[i].w;
+    }
+    planes.abs_x = simd_abs(planes.x);
+    planes.abs_y = simd_abs(planes.y);
+    planes.abs_z = simd_abs(planes.z);
+    return planes;
+}
+
+// Instances of one draw tested by one task of the CPU culling, with the number found visible at every level of
+// detail.
+struct CullBatch
+{
+    unsigned int draw;
+    unsigned int first;
+    unsigned int count;
+    // Instances at rest of the draw's mesh, null when they are transformed on the GPU and drawn without culling.
+    const mat4 *matrices;
+    std::array<unsigned int, 5> visible;
+};
+
+UploadAllocation MetalRenderer::cull_instances(unsigned int frame_index, const CullUniforms &uniforms,
+                                               unsigned int visible_offset)
+{
+    const os_signpost_id_t signpost = signpost_id();
+    os_signpost_interval_begin(signpost_log(), signpost, "cull_instances");
+    TraceSpan span(_trace, "cull_instances");
+
+    // Large draws are split into batches so their instances spread across cores too.
+    constexpr unsigned int BATCH_SIZE = 4096;
+    const std::vector<CullDraw> &draws = _culling.cull_draws;
+    std::vector<CullBatch> batches;
+    for (size_t d = 0; d < draws.size(); d++)
+    {
+        const unsigned int mesh = _culling.draw_meshes[d];
+        const bool at_rest = mesh < _instance_3d_matrices.size() && _instance_3d_matrices[mesh] &&
+                             !transformed_on_gpu(mesh);
+        const mat4 *matrices = at_rest ? _instance_3d_matrices[mesh]->data() : nullptr;
+        for (unsigned int first = 0; first < draws[d].instance_count; first += BATCH_SIZE)
+        {
+            const unsigned int count = std::min(BATCH_SIZE, draws[d].instance_count - first);
+            batches.push_back({static_cast<unsigned int>(d), first, count, matrices, {}});
+        }
+    }
+    _culling.batch_instances.resize(_culling.visible_count);
+
+    // Every batch writes from its own offset into the part of the visible list of each level, the batches of a draw
+    // are compacted once they all finished.
+    const CullPlanes planes = cull_planes(uniforms);
+    const simd_float4 lod_view = uniforms.lod_view;
+    const CullDraw *draw_data = draws.data();
+    CullBatch *batch_data = batches.data();
+    unsigned int *batch_instances = _culling.batch_instances.data();
+    dispatch_apply(batches.size(), dispatch_get_global_queue(QOS_CLASS_USER_INTERACTIVE, 0), ^(size_t b) {
+      CullBatch &batch = batch_data[b];
+      const CullDraw &draw = draw_data[batch.draw];
+      const unsigned int first = draw.instance_start + batch.first;
+      if (!batch.matrices)
+      {
+          for (unsigned int i = 0; i < batch.count; i++)
+              batch_instances[draw.visible_start + batch.first + i] = first + i;
+          batch.visible[0] = batch.count;
+          return;
+      }
+
+      for (unsigned int i = 0; i < batch.count; i++)
+      {
+          const auto *m = reinterpret_cast<const simd_packed_float4 *>(value_ptr(batch.matrices[batch.first + i]));
+          const simd_float4 center = m[0] * draw.center.x + m[1] * draw.center.y + m[2] * draw.center.z + m[3];
+          const simd_float4 extent =
+              simd_abs(m[0]) * draw.extent.x + simd_abs(m[1]) * draw.extent.y + simd_abs(m[2]) * draw.extent.z;
+          const simd_float8 distances = planes.x * center.x + planes.y * center.y + planes.z * center.z + planes.w +
+                                        planes.abs_x * extent.x + planes.abs_y * extent.y + planes.abs_z * extent.z;
+          if (!simd_all(distances >= 0.0f))
+              continue;
+
+          // Bounding spheres span radius * projection scale / distance of the screen height.
+          unsigned int level = 0;
+          if (draw.lod_count > 0)
+          {
+              const float size = simd_length(extent.xyz) * lod_view.w /
+                                 std::max(simd_distance(center.xyz, lod_view.xyz), 1e-5f);
+              while (level < draw.lod_count && size < draw.lod_sizes[level])
+                  level++;
+          }
+          const unsigned int start =
+              level == 0 ? draw.visible_start : draw.lod_instance_start + (level - 1) * draw.instance_count;
+          batch_instances[start + batch.first + batch.visible[level]++] = first + i;
+      }
+    });
+
+    const UploadAllocation args = allocate_culled_args(visible_offset);
+    auto *words = reinterpret_cast<unsigned int *>(args.data);
+    auto *visible = reinterpret_cast<unsigned int *>(_frames[frame_index].visible_instances.contents) + visible_offset;
+    std::vector<std::array<unsigned int, 5>> counts(draws.size());
+    for (const CullBatch &batch : batches)
+    {
+        const CullDraw &draw = draws[batch.draw];
+        std::array<unsigned int, 5> &count = counts[batch.draw];
+        for (unsigned int level = 0; level <= draw.lod_count; level++)
+        {
+            const unsigned int start =
+                level == 0 ? draw.visible_start : draw.lod_instance_start + (level - 1) * draw.instance_count;
+            memcpy(visible + start + count[level], batch_instances + start + batch.first,
+                   batch.visible[level] * sizeof(unsigned int));
+            count[level] += batch.visible[level];
+        }
+    }
+
+    // The instance count is the second word of both the indexed and non-indexed indirect arguments.
+    for (size_t d = 0; d < draws.size(); d++)
+    {
+        words[draws[d].args_offset + 1] = counts[d][0];
+        for (unsigned int level = 1; level <= draws[d].lod_count; level++)
+            words[draws[d].lod_args_offsets[level - 1] + 1] = counts[d][level];
+    }
+
+    os_signpost_interval_end(signpost_log(), signpost, "cull_instances", "%zu batches", batches.size());
+    return args;
+}
+
+id<MTLBuffer> MetalRenderer::visible_instances(unsigned int frame_index) const
+{
+    return _cpu_culling ? _frames[frame_index].visible_instances : _visible_instances;
+}
+
+void MetalRenderer::dispatch_culling(id<MTLComputeCommandEncoder> encoder, id<MTLComputePipelineState> state,
+                                     unsigned int frame_index, const CullUniforms &uniforms,
+                                     const UploadAllocation &args)
+{
+    [encoder setComputePipelineState:state];
+    [encoder setBuffer:_instance_3d_list.buffer(frame_index) offset:0 atIndex:0];
+    [encoder setBytes:&uniforms length:sizeof(CullUniforms) atIndex:1];
+    [encoder setBuffer:_culling.draws.buffer offset:_culling.draws.offset atIndex:2];
+    [encoder setBuffer:args.buffer offset:args.offset atIndex:3];
+    [encoder setBuffer:_visible_instances offset:0 atIndex:4];
+    // Views that don't record depths never write them.
+    const UploadAllocation &depths = _culling.draw_depths.valid() ? _culling.draw_depths : args;
+    [encoder setBuffer:depths.buffer offset:depths.offset atIndex:6];
+
+    // Views of many instances only cull the clusters of slots the tree finds in or crossing their frustum.
+    if (_culling.bvh)
+    {
+        _instance_bvh.encode_culling(encoder, state == _occlusion_cull_state ? _bvh_occlusion_cull_state
+                                                                              : _bvh_cull_state);
+        return;
+    }
+
+    const NSUInteger group_size = std::min<NSUInteger>(state.maxTotalThreadsPerThreadgroup, 256);
+    [encoder dispatchThreadgroups:MTLSizeMake((uniforms.num_instances + group_size - 1) / group_size, 1, 1)
+            threadsPerThreadgroup:MTLSizeMake(group_size, 1, 1)];
+}
+
+void MetalRenderer::update_depth_pyramid()
+{
+    // Level 0 covers 2x2 depth pixels, power of two sizes keep every level exactly half the size of the one below.
+    const unsigned int width = next_power_of_two((static_cast<unsigned int>(_depth_texture.width) + 1) / 2);
+    const unsigned int height = next_power_of_two((static_cast<unsigned int>(_depth_texture.height) + 1) / 2);
+    if (_depth_pyramid != nil && _depth_pyramid.width == width && _depth_pyramid.height == height)
+        return;
+
+    MTLTextureDescriptor *desc = [MTLTextureDescriptor texture2DDescriptorWithPixelFormat:MTLPixelFormatR32Float
+                                                                                    width:width
+                                                                                   height:height
+                                                                                mipmapped:YES];
+    desc.storageMode = MTLStorageModePrivate;
+    desc.usage = MTLTextureUsageShaderRead | MTLTextureUsageShaderWrite;
+    _retired.retire(_depth_pyramid);
+    for (id<MTLTexture> level : _depth_pyramid_levels)
+        _retired.retire(level);
+    _depth_pyramid = _target_pool.create(_device, desc);
+    _depth_pyramid.label = @"DepthPyramid";
+
+    _depth_pyramid_levels.clear();
+    for (NSUInteger level = 0; level < _depth_pyramid.mipmapLevelCount; level++)
+    {
+        _depth_pyramid_levels.push_back([_depth_pyramid newTextureViewWithPixelFormat:MTLPixelFormatR32Float
+                                                                          textureType:MTLTextureType2D
+                                                                               levels:NSMakeRange(level, 1)
+                                                                               slices:NSMakeRange(0, 1)]);
+    }
+    _depth_pyramid_valid = false;
+}
+
+bool MetalRenderer::encode_skinning(id<MTLCommandBuffer> command_buffer)
+{
+    if (!_skinning_dirty)
+        return false;
+    _skinning_dirty = false;
+
+    std::vector<unsigned int> previous_meshes;
+    for (const auto &[i, groups] : _skinned_instances)
+        previous_meshes.push_back(i);
+
+    _skinning_groups.clear();
+    _skinned_instances.clear();
+
+    // Clips and skeletons are uploaded once they changed, animated skins only upload their layers.
+    if (_animations_dirty)
+    {
+        _animations_dirty = false;
+        std::vector<SkeletonJoint> joints;
+        for (auto &[id, skeleton] : _skeletons)
+        {
+            skeleton.buffer_start = static_cast<unsigned int>(joints.size());
+            joints.insert(joints.end(), skeleton.joints.begin(), skeleton.joints.end());
+        }
+
+        std::vector<AnimationKeys> channels;
+        std::vector<float> times;
+        std::vector<simd_float4> values;
+        for (auto &[id, clip] : _animation_clips)
+        {
+            clip.channel_start = static_cast<unsigned int>(channels.size());
+            const auto key_start = static_cast<unsigned int>(times.size());
+            for (AnimationKeys keys : clip.channels)
+            {
+                keys.key_start += key_start;
+                channels.push_back(keys);
+            }
+            times.insert(times.end(), clip.times.begin(), clip.times.end());
+            values.insert(values.end(), clip.values.begin(), clip.values.end());
+        }
+
+        _retired.retire(_skeleton_joints, _animation_channels, _animation_times, _animation_values);
+        _skeleton_joints = nil;
+        _animation_channels = nil;
+        _animation_times = nil;
+        _animation_values = nil;
+        if (!joints.empty())
+        {
+            _skeleton_joints = [_device newBufferWithBytes:joints.data()
+                                                    length:joints.size() * sizeof(SkeletonJoint)
+                                                   options:cpu_write_storage(_device)];
+            _skeleton_joints.label = @"SkeletonJoints";
+        }
+        if (!channels.empty())
+        {
+            _animation_channels = [_device newBufferWithBytes:channels.data()
+                                                       length:channels.size() * sizeof(AnimationKeys)
+                                                      options:cpu_write_storage(_device)];
+            _animation_channels.label = @"AnimationChannels";
+            _animation_times = [_device newBufferWithBytes:times.data()
+                                                    length:times.size() * sizeof(float)
+                                                   options:cpu_write_storage(_device)];
+            _animation_times.label = @"AnimationTimes";
+            _animation_values = [_device newBufferWithBytes:values.data()
+                                                     length:values.size() * sizeof(simd_float4)
+                                                    options:cpu_write_storage(_device)];
+            _animation_values.label = @"AnimationValues";
+        }
+    }
+
+    // Animated skins take their joints from their skeleton, the GPU writes their matrices.
+    const auto skeleton_of = [&](size_t i) -> const Skeleton3D * {
+        const SkinPlayback *playback = _skin_animations.find(static_cast<unsigned int>(i));
+        return playback && _skeleton_joints != nil ? _skeletons.find(playback->skeleton) : nullptr;
+    };
+    const auto skin_joints = [&](size_t i) {
+        const Skeleton3D *skeleton = skeleton_of(i);
+        return static_cast<unsigned int>(skeleton ? skeleton->joints.size() : _skins[i].size());
+    };
+
+    // All skins are uploaded as one joint matrix buffer.
+    std::vector<unsigned int> joint_offsets(_skins.size());
+    unsigned int num_joints = 0;
+    for (size_t i = 0; i < _skins.size(); i++)
+    {
+        joint_offsets[i] = num_joints;
+        num_joints += skin_joints(i);
+    }
+
+    // Morph targets are uploaded once they changed, only their weights are uploaded with every skinning pass.
+    if (_morph_targets_dirty)
+    {
+        _morph_targets_dirty = false;
+        std::vector<unsigned int> offsets;
+        std::vector<MorphDelta> deltas;
+        for (auto &[id, morphs] : _morph_targets)
+        {
+            morphs.buffer_start = static_cast<unsigned int>(offsets.size());
+            offsets.push_back(static_cast<unsigned int>(morphs.offsets.size() - 1));
+            for (const unsigned int offset : morphs.offsets)
+                offsets.push_back(static_cast<unsigned int>(deltas.size()) + offset);
+            deltas.insert(deltas.end(), morphs.deltas.begin(), morphs.deltas.end());
+        }
+
+        _retired.retire(_morph_deltas, _morph_offsets);
+        _morph_deltas = nil;
+        _morph_offsets = nil;
+        if (!deltas.empty())
+        {
+            _morph_deltas = [_device newBufferWithBytes:deltas.data()
+                                                 length:deltas.size() * sizeof(MorphDelta)
+                                                options:cpu_write_storage(_device)];
+            _morph_deltas.label = @"MorphDeltas";
+            _morph_offsets = [_device newBufferWithBytes:offsets.data()
+                                                  length:offsets.size() * sizeof(unsigned int)
+                                                 options:cpu_write_storage(_device)];
+            _morph_offsets.label = @"MorphOffsets";
+        }
+    }
+
+    // Every distinct skin used by the instances of a mesh gets its own copy of the mesh in the animated vertex buffer,
+    // as does every instance with morph weights.
+    const IdTable<InstanceRange<mat4>> &instances = _instance_3d_list.get_ranges();
+    std::vector<float> morph_weights;
+    unsigned int num_vertices = 0;
+    for (const auto &[i, range] : _vertex_3d_list.get_draw_ranges())
+    {
+        const auto insts = instances.find(i);
+        const MorphTargets3D *morphs = _morph_targets.find(i);
+        const std::vector<float> *weights = morphs && _morph_deltas != nil ? _morph_weights.find(i) : nullptr;
+        const bool skinned = range.jw_start < range.jw_end && i < _instance_3d_skin_ids.size();
+        if ((!skinned && !weights) || !insts || insts->count == 0)
+            continue;
+
+        const auto morphed = [&](unsigned int j) {
+            const size_t first = static_cast<size_t>(j) * morphs->num_targets;
+            if (!weights || first + morphs->num_targets > weights->size())
+                return false;
+            return std::any_of(weights->begin() + first, weights->begin() + first + morphs->num_targets,
+                               [](float weight) { return weight != 0.0f; });
+        };
+
+        std::vector<unsigned int> groups(insts->count, ~0u);
+        std::map<std::pair<int, unsigned int>, unsigned int> skin_groups;
+        for (unsigned int j = 0; j < insts->count; j++)
+        {
+            int skin_id = skinned && j < _instance_3d_skin_ids[i].size() ? _instance_3d_skin_ids[i][j] : -1;
+            if (skin_id >= static_cast<int>(_skins.size()) || (skin_id >= 0 && skin_joints(skin_id) == 0))
+                skin_id = -1;
+            const bool morph = morphed(j);
+            if (skin_id < 0 && !morph)
+                continue;
+
+            const std::pair<int, unsigned int> key = {skin_id, morph ? j : ~0u};
+            auto group = skin_groups.find(key);
+            if (group == skin_groups.end())
+            {
+                SkinningGroup skinning_group = {};
+                skinning_group.vertex_start = range.start;
+                skinning_group.jw_start = range.jw_start;
+                skinning_group.count = range.end - range.start;
+                skinning_group.out_start = num_vertices;
+                skinning_group.joint_offset = skin_id >= 0 ? joint_offsets[skin_id] : 0;
+                skinning_group.num_joints = skin_id >= 0 ? skin_joints(skin_id) : 0;
+                skinning_group.morph_start = morph ? morphs->buffer_start : NO_MORPH_TARGETS;
+                skinning_group.weight_start = static_cast<unsigned int>(morph_weights.size());
+                if (morph)
+                {
+                    const auto first = weights->begin() + static_cast<size_t>(j) * morphs->num_targets;
+                    morph_weights.insert(morph_weights.end(), first, first + morphs->num_targets);
+                }
+                num_vertices += skinning_group.count;
+
+                group = skin_groups.insert({key, static_cast<unsigned int>(_skinning_groups.size())}).first;
+                _skinning_groups.push_back(skinning_group);
+            }
+
+            groups[j] = group->second;
+        }
+
+        if (!skin_groups.empty())
+            _skinned_instances[i] = std::move(groups);
+    }
+
+    // The indirect command buffer skips skinned meshes, so it needs to be re-encoded when that set changes.
+    std::vector<unsigned int> skinned_meshes;
+    for (const auto &[i, groups] : _skinned_instances)
+        skinned_meshes.push_back(i);
+    if (skinned_meshes != previous_meshes)
+        _draw_commands_dirty = true;
+
+    if (_skinning_groups.empty())
+        return false;
+
+    _vertex_3d_list.reserve_anim_vertices(_device, num_vertices);
+
+    const UploadAllocation matrices = _upload_ring.allocate(num_joints * sizeof(mat4));
+    auto *matrices_data = reinterpret_cast<mat4 *>(matrices.data);
+    std::vector<SkinAnimation> animations;
+    for (size_t i = 0; i < _skins.size(); i++)
+    {
+        const Skeleton3D *skeleton = skeleton_of(i);
+        if (!skeleton)
+        {
+            std::copy(_skins[i].begin(), _skins[i].end(), matrices_data + joint_offsets[i]);
+            continue;
+        }
+
+        SkinAnimation animation = {};
+        animation.skeleton_start = skeleton->buffer_start;
+        animation.num_joints = static_cast<unsigned int>(skeleton->joints.size());
+        animation.num_levels = skeleton->num_levels;
+        animation.matrix_offset = joint_offsets[i];
+        float total_weight = 0.0f;
+        for (const AnimationLayer &layer : _skin_animations.find(static_cast<unsigned int>(i))->layers)
+        {
+            const AnimationClip3D *clip = _animation_clips.find(layer.clip);
+            if (!clip || _animation_channels == nil || layer.weight <= 0.0f ||
+                animation.num_layers == MAX_ANIMATION_LAYERS)
+                continue;
+
+            AnimationLayerState &state = animation.layers[animation.num_layers++];
+            state.channel_start = clip->channel_start;
+            state.num_joints = clip->num_joints;
+            state.time = std::clamp(layer.time, 0.0f, clip->duration);
+            if (layer.loop && clip->duration > 0.0f)
+            {
+                state.time = std::fmod(layer.time, clip->duration);
+                state.time += state.time < 0.0f ? clip->duration : 0.0f;
+            }
+            state.weight = layer.weight;
+            total_weight += layer.weight;
+        }
+        for (unsigned int l = 0; l < animation.num_layers; l++)
+            animation.layers[l].weight /= total_weight;
+        animations.push_back(animation);
+    }
+
+    const UploadAllocation groups = _upload_ring.upload(_skinning_groups.data(), _skinning_groups.size());
+    const simd_uint2 counts = simd_make_uint2(static_cast<unsigned int>(_skinning_groups.size()), num_vertices);
+
+    // Bounds start empty, minima at the largest and maxima at the smallest key.
+    const NSUInteger bounds_size = _skinning_groups.size() * 4 * sizeof(unsigned int);
+    if (_skinned_bounds == nil || _skinned_bounds.length < 2 * bounds_size)
+    {
+        _retired.retire(_skinned_bounds);
+        _skinned_bounds = [_device newBufferWithLength:2 * bounds_size options:MTLResourceStorageModePrivate];
+        _skinned_bounds.label = @"SkinnedBounds";
+    }
+    id<MTLBlitCommandEncoder> blit = [command_buffer blitCommandEncoder];
+    blit.label = @"SkinnedBoundsClear";
+    [blit fillBuffer:_skinned_bounds range:NSMakeRange(0, bounds_size) value:0xFF];
+    [blit fillBuffer:_skinned_bounds range:NSMakeRange(bounds_size, bounds_size) value:0];
+    [blit endEncoding];
+
+    id<MTLComputeCommandEncoder> encoder = _frame_timer.compute_encoder(command_buffer, FRAME_PASS_SKINNING);
+    encoder.label = @"Skinning";
+
+    // Dispatches of the encoder run in order, so skins are sampled before any vertex reads their matrices.
+    if (!animations.empty())
+    {
+        const UploadAllocation skins = _upload_ring.upload(animations.data(), animations.size());
+        const NSUInteger joint_threads =
+            std::min<NSUInteger>(_animate_skins_state.maxTotalThreadsPerThreadgroup, MAX_SKELETON_JOINTS);
+        [encoder setComputePipelineState:_animate_skins_state];
+        [encoder setBuffer:skins.buffer offset:skins.offset atIndex:0];
+        [encoder setBuffer:_skeleton_joints offset:0 atIndex:1];
+        // Without clips only rest poses are read, the skeleton stands in for the keyframes.
+        [encoder setBuffer:_animation_channels != nil ? _animation_channels : _skeleton_joints offset:0 atIndex:2];
+        [encoder setBuffer:_animation_times != nil ? _animation_times : _skeleton_joints offset:0 atIndex:3];
+        [encoder setBuffer:_animation_values != nil ? _animation_values : _skeleton_joints offset:0 atIndex:4];
+        [encoder setBuffer:matrices.buffer offset:matrices.offset atIndex:5];
+        [encoder dispatchThreadgroups:MTLSizeMake(animations.size(), 1, 1)
+                threadsPerThreadgroup:MTLSizeMake(joint_threads, 1, 1)];
+    }
+
+    [encoder setComputePipelineState:_skinning_state];
+    [encoder setBuffer:_vertex_3d_list.vertex_buffer() offset:0 atIndex:0];
+    [encoder setBuffer:_vertex_3d_list.jw_buffer() offset:0 atIndex:1];
+    [encoder setBuffer:matrices.buffer offset:matrices.offset atIndex:2];
+    [encoder setBuffer:groups.buffer offset:groups.offset atIndex:3];
+    [encoder setBytes:&counts length:sizeof(simd_uint2) atIndex:4];
+    [encoder setBuffer:_vertex_3d_list.anim_buffer() offset:0 atIndex:5];
+
+    // Without morphed groups the morph buffers are never read, the groups stand in for them.
+    const UploadAllocation weights =
+        morph_weights.empty() ? groups : _upload_ring.upload(morph_weights.data(), morph_weights.size());
+    [encoder setBuffer:_morph_deltas != nil ? _morph_deltas : groups.buffer offset:0 atIndex:6];
+    [encoder setBuffer:_morph_offsets != nil ? _morph_offsets : groups.buffer offset:0 atIndex:7];
+    [encoder setBuffer:weights.buffer offset:weights.offset atIndex:8];
+    [encoder setBuffer:_skinned_bounds offset:0 atIndex:9];
+
+    const NSUInteger group_size = std::min<NSUInteger>(_skinning_state.maxTotalThreadsPerThreadgroup, 256);
+    [encoder dispatchThreadgroups:MTLSizeMake((num_vertices + group_size - 1) / group_size, 1, 1)
+            threadsPerThreadgroup:MTLSizeMake(group_size, 1, 1)];
+    [encoder endEncoding];
+    return true;
+}
+
+void MetalRenderer::encode_draw_commands(id<MTLCommandBuffer> command_buffer)
+{
+    if (!_draw_commands_dirty)
+        return;
+    _draw_commands_dirty = false;
+
+    const IdTable<DrawDescriptor> &draw_ranges = _vertex_3d_list.get_draw_ranges();
+    const IdTable<InstanceRange<mat4>> &instances = _instance_3d_list.get_ranges();
+    _draw_command_count = 0;
+    if (draw_ranges.empty())
+        return;
+
+    const UploadAllocation draws = _upload_ring.allocate(draw_ranges.size() * sizeof(IndirectDraw));
+    auto *draws_data = reinterpret_cast<IndirectDraw *>(draws.data);
+    unsigned int count = 0;
+    for (const auto &[i, range] : draw_ranges)
+    {
+        const auto insts = instances.find(i);
+        if (!insts || insts->count == 0 || range.start >= range.end || _skinned_instances.has(i) ||
+            _transparent_meshes.has(i) || !_pvs.visible(_pvs_cell, i))
+            continue;
+
+        IndirectDraw &draw = draws_data[count++];
+        draw.vertex_start = range.start;
+        draw.vertex_count = range.end - range.start;
+        draw.index_offset = range.index_offset;
+        draw.index_count = range.index_count;
+        draw.instance_start = insts->start;
+        draw.instance_count = insts->count;
+        draw.short_indices = range.short_indices ? 1 : 0;
+        draw.pad = 0;
+    }
+
+    if (count == 0)
+        return;
+
+    reserve_draw_commands(count);
+    id<MTLComputeCommandEncoder> encoder = _frame_timer.compute_encoder(command_buffer, FRAME_PASS_CULLING);
+    encoder.label = @"EncodeDraws";
+    [encoder setComputePipelineState:_encode_draws_state];
+    [encoder setBuffer:draws.buffer offset:draws.offset atIndex:0];
+    [encoder setBytes:&count length:sizeof(unsigned int) atIndex:1];
+    [encoder setBuffer:_vertex_3d_list.index_buffer() offset:0 atIndex:2];
+    [encoder setBuffer:_vertex_3d_list.index_buffer() offset:0 atIndex:3];
+    [encoder setBuffer:_draw_commands_args offset:0 atIndex:4];
+    [encoder useResource:_draw_commands usage:MTLResourceUsageWrite];
+
+    const NSUInteger group_size = std::min<NSUInteger>(_encode_draws_state.maxTotalThreadsPerThreadgroup, 256);
+    [encoder dispatchThreadgroups:MTLSizeMake((count + group_size - 1) / group_size, 1, 1)
+            threadsPerThreadgroup:MTLSizeMake(group_size, 1, 1)];
+    [encoder endEncoding];
+
+    _draw_command_count = count;
+}
+
+NSRange MetalRenderer::encode_culled_draw_commands(id<MTLCommandBuffer> command_buffer, const UploadAllocation &args,
+                                                   unsigned int first, bool clustered)
+{
+    // Culled commands overwrite those of the unculled draws.
+    _draw_commands_dirty = true;
+    _draw_command_count = 0;
+
+    const IdTable<DrawDescriptor> &draw_ranges = _vertex_3d_list.get_draw_ranges();
+    const IdTable<InstanceRange<mat4>> &instances = _instance_3d_list.get_ranges();
+    std::vector<CulledIndirectDraw> draws;
+    for (const auto &[i, range] : draw_ranges)
+    {
+        // The same draws, in the same order, as the culled draws encoded on the CPU.
+        const auto insts = instances.find(i);
+        const bool has_instances = insts && insts->count > 0 && !_transparent_meshes.has(i);
+        const std::vector<LodDraw> *lods = _lod_slots.find(i);
+        if ((!has_instances && !lods) || range.start >= range.end || _skinned_instances.has(i))
+            continue;
+
+        CulledIndirectDraw draw = {};
+        draw.index_offset = range.index_offset;
+        draw.index_size = range.index_count > 0 ? (range.short_indices ? 2 : 4) : 0;
+        const unsigned int *cluster_slot = clustered ? _cluster_slots.find(i) : nullptr;
+        const bool has_slot = i < _draw_slots.size() && _draw_slots[i] != ~0u;
+        if (has_instances && cluster_slot && has_slot)
+        {
+            // Clustered draws are ordered by the depth of the draw slot whose instances their clusters belong to.
+            draws.push_back({*cluster_slot * DRAW_ARGS_WORDS, 0, 4, 1, _draw_slots[i]});
+        }
+        else if (has_instances && has_slot)
+        {
+            draw.args_offset = _draw_slots[i] * DRAW_ARGS_WORDS;
+            draw.depth_slot = _draw_slots[i];
+            draws.push_back(draw);
+        }
+        if (lods)
+        {
+            for (const LodDraw &lod : *lods)
+            {
+                if (_transparent_meshes.has(lod.mesh))
+                    continue;
+                draw.args_offset = lod.slot * DRAW_ARGS_WORDS;
+                draw.depth_slot = lod.slot;
+                draws.push_back(draw);
+            }
+        }
+    }
+    if (draws.empty())
+        return NSMakeRange(first, 0);
+
+    // The early phase makes room for the late phase, which encodes the same draws after it, so growing the buffer
+    // never drops commands of this frame.
+    const auto count = static_cast<unsigned int>(draws.size());
+    reserve_draw_commands(first + count * (_culling.late_args.valid() ? 2 : 1));
+
+    const UploadAllocation draws_data = _upload_ring.upload(draws.data(), draws.size());
+    const UploadAllocation &cluster_args = _culling.cluster_args.valid() ? _culling.cluster_args : args;
+    id<MTLComputeCommandEncoder> encoder = _frame_timer.compute_encoder(command_buffer, FRAME_PASS_CULLING);
+    encoder.label = @"EncodeCulledDraws";
+
+    // Draws are encoded front to back by the nearest depth of their visible instances, which lets early depth testing
+    // reject more of the draws behind them. Keys hold the upper half of the depth, draws of a similar depth keep the
+    // order of their meshes. The pipeline state is inherited by all commands and transparent meshes are drawn
+    // order-independently elsewhere, so depth is all there is to sort by.
+    const UploadAllocation keys =
+        _culling.draw_depths.valid() ? _upload_ring.allocate(draws.size() * sizeof(simd_uint2)) : UploadAllocation{};
+    if (keys.valid())
+    {
+        [encoder setComputePipelineState:_culled_draw_keys_state];
+        [encoder setBuffer:draws_data.buffer offset:draws_data.offset atIndex:0];
+        [encoder setBytes:&count length:sizeof(unsigned int) atIndex:1];
+        [encoder setBuffer:keys.buffer offset:keys.offset atIndex:2];
+        [encoder setBuffer:_culling.draw_depths.buffer offset:_culling.draw_depths.offset atIndex:3];
+        const NSUInteger key_group_size =
+            std::min<NSUInteger>(_culled_draw_keys_state.maxTotalThreadsPerThreadgroup, 256);
+        [encoder dispatchThreadgroups:MTLSizeMake((count + key_group_size - 1) / key_group_size, 1, 1)
+                threadsPerThreadgroup:MTLSizeMake(key_group_size, 1, 1)];
+        _primitives.encode_sort(encoder, keys.buffer, keys.offset, count, 16, false);
+    }
+
+    const simd_uint4 counts = simd_make_uint4(count, first, keys.valid() ? 1 : 0, 0);
+    [encoder setComputePipelineState:_encode_culled_draws_state];
+    [encoder setBuffer:draws_data.buffer offset:draws_data.offset atIndex:0];
+    [encoder setBytes:&counts length:sizeof(simd_uint4) atIndex:1];
+    [encoder setBuffer:_vertex_3d_list.index_buffer() offset:0 atIndex:2];
+    [encoder setBuffer:_vertex_3d_list.index_buffer() offset:0 atIndex:3];
+    [encoder setBuffer:_draw_commands_args offset:0 atIndex:4];
+    [encoder setBuffer:args.buffer offset:args.offset atIndex:5];
+    [encoder setBuffer:cluster_args.buffer offset:cluster_args.offset atIndex:6];
+    [encoder setBuffer:_culled_indices offset:0 atIndex:7];
+    [encoder setBuffer:keys.valid() ? keys.buffer : draws_data.buffer offset:keys.valid() ? keys.offset : 0 atIndex:8];
+    [encoder useResource:_draw_commands usage:MTLResourceUsageWrite];
+
+    const NSUInteger group_size = std::min<NSUInteger>(_encode_culled_draws_state.maxTotalThreadsPerThreadgroup, 256);
+    [encoder dispatchThreadgroups:MTLSizeMake((count + group_size - 1) / group_size, 1, 1)
+            threadsPerThreadgroup:MTLSizeMake(group_size, 1, 1)];
+    [encoder endEncoding];
+    return NSMakeRange(first, count);
+}
+
+void MetalRenderer::reserve_draw_commands(unsigned int count)
+{
+    if (_draw_commands == nil || _draw_commands.size < count)
+    {
+        MTLIndirectCommandBufferDescriptor *desc = [MTLIndirectCommandBufferDescriptor new];
+        desc.commandTypes = MTLIndirectCommandTypeDraw | MTLIndirectCommandTypeDrawIndexed;
+        desc.inheritBuffers = YES;
+        desc.inheritPipelineState = YES;
+        _retired.retire(_draw_commands, _draw_commands_args);
+        _draw_commands = [_device newIndirectCommandBufferWithDescriptor:desc
+                                                         maxCommandCount:next_multiple_of(count, 1024)
+                                                                 options:MTLResourceStorageModePrivate];
+        _draw_commands.label = @"DrawCommands3D";
+
+        // Frames in flight may still encode into the previous command buffer through its own argument buffer.
+        _draw_commands_args = [_device newBufferWithLength:_draw_commands_encoder.encodedLength options:0];
+        [_draw_commands_encoder setArgumentBuffer:_draw_commands_args offset:0];
+        [_draw_commands_encoder setIndirectCommandBuffer:_draw_commands atIndex:ICB_COMMANDS_ARG_INDEX];
+        did_modify(_draw_commands_args, NSMakeRange(0, _draw_commands_args.length));
+    }
+}
+
+void MetalRenderer::encode_instance_animation(id<MTLCommandBuffer> command_buffer, unsigned int frame_index)
+{
+    if (_instance_animations.empty())
+        return;
+
+    id<MTLComputeCommandEncoder> encoder = _frame_timer.compute_encoder(command_buffer, FRAME_PASS_SKINNING);
+    encoder.label = @"InstanceAnimation";
+    [encoder setComputePipelineState:_animate_instances_state];
+    const IdTable<InstanceRange<mat4>> &instances = _instance_3d_list.get_ranges();
+    const NSUInteger group_size = std::min<NSUInteger>(_animate_instances_state.maxTotalThreadsPerThreadgroup, 256);
+    for (auto &[id, animator] : _instance_animations)
+    {
+        const InstanceRange<mat4> *range = instances.find(id);
+        if (!range || range->count < animator.uniforms.count)
+            continue;
+
+        animator.uniforms.time = _animation_time;
+        [encoder setBuffer:animator.instances offset:0 atIndex:0];
+        [encoder setBytes:&animator.uniforms length:sizeof(InstanceAnimationUniforms) atIndex:1];
+        [encoder setBuffer:_instance_3d_list.buffer(frame_index)
+                    offset:range->start * sizeof(InstanceTransform)
+                   atIndex:2];
+        [encoder dispatchThreadgroups:MTLSizeMake((animator.uniforms.count + group_size - 1) / group_size, 1, 1)
+                threadsPerThreadgroup:MTLSizeMake(group_size, 1, 1)];
+    }
+    [encoder endEncoding];
+}
+
+void MetalRenderer::encode_transform_hierarchy(id<MTLCommandBuffer> command_buffer, unsigned int frame_index)
+{
+    if (_hierarchy.levels.empty())
+        return;
+
+    // Targets are resolved to slots of the instance buffer again whenever instance lists moved.
+    if (_hierarchy.links == nil || _hierarchy.layout_version != _instance_3d_list.layout_version())
+    {
+        _hierarchy.layout_version = _instance_3d_list.layout_version();
+        const IdTable<InstanceRange<mat4>> &ranges = _instance_3d_list.get_ranges();
+        std::vector<HierarchyLink> links(_hierarchy.parents.size());
+        for (size_t i = 0; i < links.size(); i++)
+        {
+            const simd_uint2 target = _hierarchy.targets[i];
+            const InstanceRange<mat4> *range = target.x != NO_HIERARCHY_INSTANCE ? ranges.find(target.x) : nullptr;
+            links[i].parent = _hierarchy.parents[i];
+            links[i].target = range && target.y < range->count ? range->start + target.y : NO_HIERARCHY_INSTANCE;
+        }
+
+        _retired.retire(_hierarchy.links);
+        _hierarchy.links = [_device newBufferWithBytes:links.data()
+                                                length:links.size() * sizeof(HierarchyLink)
+                                               options:cpu_write_storage(_device)];
+        _hierarchy.links.label = @"HierarchyLinks";
+    }
+
+    id<MTLComputeCommandEncoder> encoder = _frame_timer.compute_encoder(command_buffer, FRAME_PASS_SKINNING);
+    encoder.label = @"TransformHierarchy";
+    if (!_hierarchy.updates.empty())
+    {
+        const UploadAllocation updates = _upload_ring.upload(_hierarchy.updates.data(), _hierarchy.updates.size());
+        const auto count = static_cast<unsigned int>(_hierarchy.updates.size());
+        const NSUInteger group_size = std::min<NSUInteger>(_scatter_hierarchy_state.maxTotalThreadsPerThreadgroup, 256);
+        [encoder setComputePipelineState:_scatter_hierarchy_state];
+        [encoder setBuffer:updates.buffer offset:updates.offset atIndex:0];
+        [encoder setBytes:&count length:sizeof(unsigned int) atIndex:1];
+        [encoder setBuffer:_hierarchy.locals offset:0 atIndex:2];
+        [encoder dispatchThreadgroups:MTLSizeMake((count + group_size - 1) / group_size, 1, 1)
+                threadsPerThreadgroup:MTLSizeMake(group_size, 1, 1)];
+
+        for (const HierarchyUpdate &update : _hierarchy.updates)
+            _hierarchy.update_slots[update.node] = ~0u;
+        _hierarchy.updates.clear();
+    }
+
+    // Dispatches of the encoder run in order, every depth reads the worlds of its parents the previous one wrote.
+    const NSUInteger group_size = std::min<NSUInteger>(_propagate_hierarchy_state.maxTotalThreadsPerThreadgroup, 256);
+    [encoder setComputePipelineState:_propagate_hierarchy_state];
+    [encoder setBuffer:_hierarchy.links offset:0 atIndex:0];
+    [encoder setBuffer:_hierarchy.locals offset:0 atIndex:1];
+    [encoder setBuffer:_hierarchy.worlds offset:0 atIndex:2];
+    [encoder setBuffer:_instance_3d_list.buffer(frame_index) offset:0 atIndex:3];
+    for (const simd_uint2 &level : _hierarchy.levels)
+    {
+        [encoder setBytes:&level length:sizeof(simd_uint2) atIndex:4];
+        [encoder dispatchThreadgroups:MTLSizeMake((level.y + group_size - 1) / group_size, 1, 1)
+                threadsPerThreadgroup:MTLSizeMake(group_size, 1, 1)];
+    }
+    [encoder endEncoding];
+}
+
+void MetalRenderer::encode_terrains(id<MTLCommandBuffer> command_buffer, const CameraView3D &view)
+{
+    id<MTLBuffer> vertices = _vertex_3d_list.vertex_buffer();
+    if (_terrains.empty() || vertices == nil || _vertex_3d_list.needs_reallocation())
+        return;
+
+    id<MTLComputeCommandEncoder> encoder = nil;
+    for (auto &[id, terrain] : _terrains)
+    {
+        const DrawDescriptor *range = _vertex_3d_list.get_draw_ranges().find(id);
+        if (!range)
+            continue;
+
+        // Every level is centered on the camera texel snapped to two of its cells, so the level below it always
+        // starts at a cell of its own.
+        TerrainUniforms uniforms = terrain.uniforms;
+        const float x = (view.pos.x - uniforms.origin.x) / uniforms.spacing;
+        const float z = (view.pos.z - uniforms.origin.z) / uniforms.spacing;
+        for (unsigned int level = 0; level < uniforms.levels; level++)
+        {
+            const auto snap = static_cast<float>(2u << level);
+            const int half = (TERRAIN_GRID / 2) << level;
+            uniforms.level_x[level] = static_cast<int>(std::floor(x / snap) * snap) - half;
+            uniforms.level_y[level] = static_cast<int>(std::floor(z / snap) * snap) - half;
+        }
+        if (terrain.vertices == vertices && terrain.start == range->start &&
+            std::memcmp(&uniforms, &terrain.uniforms, sizeof(TerrainUniforms)) == 0)
+            continue;
+        terrain.uniforms = uniforms;
+        terrain.vertices = vertices;
+        terrain.start = range->start;
+
+        if (encoder == nil)
+        {
+            encoder = _frame_timer.compute_encoder(command_buffer, FRAME_PASS_SKINNING);
+            encoder.label = @"Terrain";
+            [encoder setComputePipelineState:_generate_terrain_state];
+        }
+        [encoder setBuffer:vertices offset:range->start * sizeof(Vertex3D) atIndex:0];
+        [encoder setBuffer:terrain.heights offset:0 atIndex:1];
+        [encoder setBuffer:terrain.materials ? terrain.materials : terrain.heights offset:0 atIndex:2];
+        [encoder setBytes:&uniforms length:sizeof(TerrainUniforms) atIndex:3];
+        const MTLSize groups = MTLSizeMake((uniforms.cells + TERRAIN_GROUP_SIZE - 1) / TERRAIN_GROUP_SIZE, 1, 1);
+        [encoder dispatchThreadgroups:groups threadsPerThreadgroup:MTLSizeMake(TERRAIN_GROUP_SIZE, 1, 1)];
+
+        // The shadows, the position stream and the ray tracing geometry of the terrain follow its new rings.
+        _vertex_3d_list.mark_positions_dirty(range->start, range->end);
+        _acceleration_structures.mark_mesh_changed(id);
+        _bvh_scene.mark_mesh_changed(id);
+        _sdf_scene.mark_mesh_changed(id);
+        mark_instances_moved(id);
+    }
+    if (encoder != nil)
+        [encoder endEncoding];
+}
+
+void MetalRenderer::encode_position_stream(id<MTLCommandBuffer> command_buffer)
+{
+    id<MTLBuffer> positions = _vertex_3d_list.position_buffer();
+    if (positions == nil || _vertex_3d_list.needs_reallocation())
+        return;
+    const std::vector<DirtyRange> ranges = _vertex_3d_list.take_position_ranges();
+    if (ranges.empty())
+        return;
+
+    id<MTLComputeCommandEncoder> encoder = _frame_timer.compute_encoder(command_buffer, FRAME_PASS_SKINNING);
+    encoder.label = @"PositionStream";
+    [encoder setComputePipelineState:_extract_positions_state];
+    [encoder setBuffer:_vertex_3d_list.vertex_buffer() offset:0 atIndex:0];
+    [encoder setBuffer:positions offset:0 atIndex:1];
+    const NSUInteger group_size = std::min<NSUInteger>(_extract_positions_state.maxTotalThreadsPerThreadgroup, 256);
+    for (const DirtyRange &range : ranges)
+    {
+        const unsigned int end = std::min(range.end, static_cast<unsigned int>(positions.length / sizeof(simd_float4)));
+        if (range.start >= end)
+            continue;
+        const simd_uint2 bounds = simd_make_uint2(range.start, end);
+        [encoder setBytes:&bounds length:sizeof(bounds) atIndex:2];
+        [encoder dispatchThreadgroups:MTLSizeMake((end - range.start + group_size - 1) / group_size, 1, 1)
+                threadsPerThreadgroup:MTLSizeMake(group_size, 1, 1)];
+    }
+    [encoder endEncoding];
+}
+
+void MetalRenderer::encode_instance_scatters(id<MTLCommandBuffer> command_buffer, unsigned int frame_index,
+                                             const CameraView3D &view)
+{
+    if (_scatters.empty())
+        return;
+
+    const IdTable<InstanceRange<mat4>> &ranges = _instance_3d_list.get_ranges();
+    const NSUInteger group_size = std::min<NSUInteger>(_scatter_instances_state.maxTotalThreadsPerThreadgroup, 256);
+    const simd_float4 camera = simd_make_float4(view.pos.x, view.pos.y, view.pos.z, 0.0f);
+    const simd_float4 direction = simd_make_float4(view.direction.x, view.direction.y, view.direction.z, 0.0f);
+    id<MTLComputeCommandEncoder> encoder = nil;
+    for (auto &[id, scatter] : _scatters)
+    {
+        const InstanceRange<mat4> *range = ranges.find(id);
+        const Terrain3D *terrain = _terrains.find(scatter.terrain);
+        if (!range || !terrain || range->count < scatter.uniforms.count)
+            continue;
+
+        // Candidates stay in the cell they were scattered into while the camera moves, only the window of cells
+        // around it moves along.
+        ScatterUniforms &uniforms = scatter.uniforms;
+        const auto half = static_cast<int>(uniforms.side / 2);
+        uniforms.camera = camera;
+        uniforms.hidden = camera - direction * std::max(view.far_plane, 1.0f);
+        uniforms.first_x = static_cast<int>(std::floor(view.pos.x / uniforms.spacing)) - half;
+        uniforms.first_y = static_cast<int>(std::floor(view.pos.z / uniforms.spacing)) - half;
+
+        if (encoder == nil)
+        {
+            encoder = _frame_timer.compute_encoder(command_buffer, FRAME_PASS_SKINNING);
+            encoder.label = @"InstanceScatter";
+            [encoder setComputePipelineState:_scatter_instances_state];
+        }
+        [encoder setBuffer:terrain->heights offset:0 atIndex:0];
+        [encoder setBuffer:scatter.density ? scatter.density : terrain->heights offset:0 atIndex:1];
+        [encoder setBytes:&terrain->uniforms length:sizeof(TerrainUniforms) atIndex:2];
+        [encoder setBytes:&uniforms length:sizeof(ScatterUniforms) atIndex:3];
+        [encoder setBuffer:_instance_3d_list.buffer(frame_index)
+                    offset:range->start * sizeof(InstanceTransform)
+                   atIndex:4];
+        [encoder dispatchThreadgroups:MTLSizeMake((uniforms.count + group_size - 1) / group_size, 1, 1)
+                threadsPerThreadgroup:MTLSizeMake(group_size, 1, 1)];
+    }
+    if (encoder != nil)
+        [encoder endEncoding];
+}
+
+void MetalRenderer::encode_particles(id<MTLCommandBuffer> command_buffer)
+{
+    // Long pauses of the animation time don't emit or age particles all at once.
+    const float delta_time = std::clamp(_animation_time - _particle_time, 0.0f, 0.1f);
+    _particle_time = _animation_time;
+    if (_particle_systems.empty())
+        return;
+
+    const bool collide = _particle_depth_valid && _depth_texture != nil;
+    const mat4 inv_combined = inverse(_particle_depth_combined);
+    const MTLSize group = MTLSizeMake(PARTICLE_GROUP_SIZE, 1, 1);
+    const MTLSize single = MTLSizeMake(1, 1, 1);
+
+    id<MTLComputeCommandEncoder> encoder = _frame_timer.compute_encoder(command_buffer, FRAME_PASS_SKINNING);
+    encoder.label = @"Particles";
+    if (collide)
+        [encoder setTexture:_depth_texture atIndex:0];
+    for (auto &[id, system] : _particle_systems)
+    {
+        system.carry += system.emitter.rate * delta_time;
+        const auto emitted = static_cast<unsigned int>(std::min(system.carry, static_cast<float>(system.capacity)));
+        system.carry -= static_cast<float>(emitted);
+
+        ParticleUniforms uniforms = {};
+        memcpy(&uniforms.depth_combined, &_particle_depth_combined, sizeof(simd_float4x4));
+        memcpy(&uniforms.depth_inv_combined, &inv_combined, sizeof(simd_float4x4));
+        uniforms.emit = std::min(emitted + system.burst, system.capacity);
+        uniforms.capacity = system.capacity;
+        uniforms.list = system.list;
+        uniforms.seed = id * 7919u + system.frame++ * 104729u;
+        uniforms.delta_time = delta_time;
+        uniforms.collide = collide && system.emitter.collide ? 1 : 0;
+        system.burst = 0;
+
+        [encoder setBuffer:system.particles offset:0 atIndex:0];
+        [encoder setBuffer:system.alive offset:0 atIndex:1];
+        [encoder setBuffer:system.dead offset:0 atIndex:2];
+        [encoder setBuffer:system.counters offset:0 atIndex:3];
+        [encoder setBytes:&system.emitter length:sizeof(ParticleEmitter) atIndex:4];
+        [encoder setBytes:&uniforms length:sizeof(ParticleUniforms) atIndex:5];
+        if (uniforms.emit > 0)
+        {
+            [encoder setComputePipelineState:_emit_particles_state];
+            const MTLSize groups = MTLSizeMake((uniforms.emit + PARTICLE_GROUP_SIZE - 1) / PARTICLE_GROUP_SIZE, 1, 1);
+            [encoder dispatchThreadgroups:groups threadsPerThreadgroup:group];
+        }
+
+        // Survivors are compacted into the other list, which the draws of this frame read.
+        [encoder setComputePipelineState:_prepare_particles_state];
+        [encoder dispatchThreadgroups:single threadsPerThreadgroup:single];
+        [encoder setComputePipelineState:_simulate_particles_state];
+        [encoder dispatchThreadgroupsWithIndirectBuffer:system.counters
+                                   indirectBufferOffset:offsetof(ParticleCounters, simulate)
+                                  threadsPerThreadgroup:group];
+        [encoder setComputePipelineState:_finish_particles_state];
+        [encoder dispatchThreadgroups:single threadsPerThreadgroup:single];
+        system.list = 1 - system.list;
+    }
+    [encoder endEncoding];
+}
+
+bool MetalRenderer::encode_point_clouds(id<MTLCommandBuffer> command_buffer, const mat4 &combined,
+                                        const dvec3 &origin)
+{
+    if (_point_clouds.empty() || _point_depth_state == nil || _depth_texture == nil)
+        return false;
+
+    const vec2 size(_depth_texture.width, _depth_texture.height);
+    const vec3 quantization(POINT_QUANTIZATION[0], POINT_QUANTIZATION[1], POINT_QUANTIZATION[2]);
+    struct CloudDraws
+    {
+        id<MTLBuffer> points;
+        size_t first;
+        size_t count;
+    };
+    std::vector<CloudDraws> clouds;
+    _point_draws.clear();
+    for (const auto &[id, cloud] : _point_clouds)
+    {
+        // Chunks are placed relative to the camera in double precision, like the 3D instances.
+        const dmat4 relative = translate(dmat4(1.0), -origin) * cloud.transform;
+        const size_t first = _point_draws.size();
+        for (const PointChunk &chunk : cloud.chunks)
+        {
+            const mat4 matrix = combined * mat4(scale(translate(relative, dvec3(chunk.bmin)),
+                                                      dvec3(chunk.extent) / dvec3(quantization)));
+            // Chunks with all corners beyond one side of the frustum are culled, those reaching behind the camera
+            // draw all of their points.
+            ivec4 outside(0);
+            bool behind = false;
+            vec2 bmin(1.0f);
+            vec2 bmax(-1.0f);
+            for (unsigned int corner = 0; corner < 8; corner++)
+            {
+                const vec3 position = vec3(corner & 1, (corner >> 1) & 1, (corner >> 2) & 1) * quantization;
+                const vec4 clip = matrix * vec4(position, 1.0f);
+                outside += ivec4(clip.x < -clip.w, clip.x > clip.w, clip.y < -clip.w, clip.y > clip.w);
+                if (clip.w <= 0.0f)
+                {
+                    behind = true;
+                    continue;
+                }
+                const vec2 ndc = clamp(vec2(clip) / clip.w, vec2(-1.0f), vec2(1.0f));
+                bmin = min(bmin, ndc);
+                bmax = max(bmax, ndc);
+            }
+            if (any(equal(outside, ivec4(8))))
+                continue;
+
+            unsigned int count = chunk.count;
+            if (!behind)
+            {
+                const vec2 pixels = max(bmax - bmin, vec2(0.0f)) * 0.5f * size;
+                const float wanted = std::ceil(pixels.x * pixels.y * POINTS_PER_PIXEL);
+                count = std::clamp(static_cast<unsigned int>(std::min(wanted, static_cast<float>(chunk.count))), 1u,
+                                   chunk.count);
+            }
+            PointChunkDraw draw = {};
+            memcpy(&draw.matrix, value_ptr(matrix), sizeof(mat4));
+            draw.first = chunk.first;
+            draw.count = count;
+            _point_draws.push_back(draw);
+        }
+        if (_point_draws.size() > first)
+            clouds.push_back({cloud.points, first, _point_draws.size() - first});
+    }
+    if (clouds.empty())
+        return false;
+    const UploadAllocation draws = _upload_ring.upload(_point_draws.data(), _point_draws.size());
+    if (!draws.valid())
+        return false;
+
+    const NSUInteger length = _depth_texture.width * _depth_texture.height * sizeof(unsigned int);
+    if (_point_depths == nil || _point_depths.length != length)
+    {
+        _retired.retire(_point_depths, _point_colors);
+        _point_depths = [_device newBufferWithLength:length options:MTLResourceStorageModePrivate];
+        _point_depths.label = @"PointDepths";
+        _point_colors = [_device newBufferWithLength:length options:MTLResourceStorageModePrivate];
+        _point_colors.label = @"PointColors";
+        if (_point_depths == nil || _point_colors == nil)
+        {
+            _point_depths = nil;
+            _point_colors = nil;
+            return false;
+        }
+    }
+
+    // Depth 0 is the far plane, which no point is drawn at.
+    id<MTLBlitCommandEncoder> blit = [command_buffer blitCommandEncoder];
+    blit.label = @"PointDepthClear";
+    [blit fillBuffer:_point_depths range:NSMakeRange(0, length) value:0];
+    [blit endEncoding];
+
+    const PointRasterUniforms target = {static_cast<unsigned int>(_depth_texture.width),
+                                        static_cast<unsigned int>(_depth_texture.height)};
+    id<MTLComputeCommandEncoder> encoder = _frame_timer.compute_encoder(command_buffer, FRAME_PASS_3D);
+    encoder.label = @"PointClouds";
+    [encoder setBytes:&target length:sizeof(target) atIndex:2];
+    [encoder setBuffer:_point_depths offset:0 atIndex:3];
+    [encoder setBuffer:_point_colors offset:0 atIndex:4];
+    const MTLSize group = MTLSizeMake(POINT_GROUP_SIZE, 1, 1);
+    // Dispatches of a serial encoder run in order, every depth is in before any color is compared against it.
+    for (id<MTLComputePipelineState> state : {_point_depth_state, _point_color_state})
+    {
+        [encoder setComputePipelineState:state];
+        for (const CloudDraws &cloud : clouds)
+        {
+            [encoder setBuffer:cloud.points offset:0 atIndex:0];
+            [encoder setBuffer:draws.buffer offset:draws.offset + cloud.first * sizeof(PointChunkDraw) atIndex:1];
+            [encoder dispatchThreadgroups:MTLSizeMake(cloud.count, 1, 1) threadsPerThreadgroup:group];
+        }
+    }
+    [encoder endEncoding];
+    return true;
+}
+
+void MetalRenderer::draw_particles(id<MTLRenderCommandEncoder> encoder)
+{
+    if (_particle_systems.empty())
+        return;
+
+    [encoder pushDebugGroup:@"Particles"];
+    [encoder setRenderPipelineState:_particle_state];
+    [encoder setCullMode:MTLCullModeNone];
+    for (const auto &[id, system] : _particle_systems)
+    {
+        // The simulation already flipped list to the one the next frame simulates, which holds the survivors.
+        [encoder setVertexBuffer:system.particles offset:0 atIndex:2];
+        [encoder setVertexBuffer:system.alive offset:system.list * system.capacity * sizeof(unsigned int) atIndex:3];
+        [encoder setVertexBytes:&system.emitter length:sizeof(ParticleEmitter) atIndex:4];
+        [encoder drawPrimitives:MTLPrimitiveTypeTriangle
+                 indirectBuffer:system.counters
+           indirectBufferOffset:offsetof(ParticleCounters, draw)];
+    }
+    [encoder popDebugGroup];
+}
+
+void MetalRenderer::draw_debug_lines(id<MTLRenderCommandEncoder> encoder, const DebugLineBatch &batch,
+                                     const UploadAllocation &camera, id<MTLRenderPipelineState> state)
+{
+    if (!batch.lines.valid())
+        return;
+
+    // Every line is a quad of two triangles, the instance picks the line.
+    [encoder pushDebugGroup:@"DebugLines"];
+    [encoder setRenderPipelineState:state];
+    [encoder setCullMode:MTLCullModeNone];
+    [encoder setVertexBuffer:camera.buffer offset:camera.offset atIndex:1];
+    [encoder setVertexBuffer:batch.lines.buffer offset:batch.lines.offset atIndex:2];
+    if (batch.tested > 0)
+    {
+        [encoder setDepthStencilState:_depth_state_prepassed];
+        [encoder drawPrimitives:MTLPrimitiveTypeTriangle vertexStart:0 vertexCount:6 instanceCount:batch.tested];
+    }
+    if (batch.on_top > 0)
+    {
+        [encoder setVertexBufferOffset:batch.lines.offset + batch.tested * sizeof(DebugLine) atIndex:2];
+        [encoder setDepthStencilState:_depth_state_2d];
+        [encoder drawPrimitives:MTLPrimitiveTypeTriangle vertexStart:0 vertexCount:6 instanceCount:batch.on_top];
+    }
+    [encoder popDebugGroup];
+}
+
+void MetalRenderer::encode_video_frames(id<MTLCommandBuffer> command_buffer)
+{
+    _video.convert([&](const VideoSlot &slot) {
+        MTLRenderPassDescriptor *desc = pass_descriptor(VideoFramePass);
+        desc.colorAttachments[0].texture = slot.target;
+        desc.colorAttachments[0].loadAction = MTLLoadActionDontCare;
+        desc.colorAttachments[0].storeAction = MTLStoreActionStore;
+        id<MTLRenderCommandEncoder> encoder = [command_buffer renderCommandEncoderWithDescriptor:desc];
+        encoder.label = @"VideoFrame";
+        [encoder setRenderPipelineState:_video_frame_state];
+        [encoder setFragmentTexture:slot.planes[0] atIndex:0];
+        [encoder setFragmentTexture:slot.planes[1] != nil ? slot.planes[1] : slot.planes[0] atIndex:1];
+        [encoder setFragmentBytes:&slot.format length:sizeof(unsigned int) atIndex:0];
+        [encoder drawPrimitives:MTLPrimitiveTypeTriangle vertexStart:0 vertexCount:3];
+        [encoder endEncoding];
+    });
+}
+
+void MetalRenderer::encode_render_textures(id<MTLCommandBuffer> command_buffer, unsigned int frame_index,
+                                           const UploadAllocation &lights, const UploadAllocation &directional_lights,
+                                           const UploadAllocation &probes, const mat4 &matrix_2d)
+{
+    const FrameResources &frame = _frames[frame_index];
+    std::vector<const RenderTextureSlot *> drawn;
+    _render_textures.schedule(_render_texture_budget, [&](unsigned int, const RenderTextureSlot &slot) {
+        const UploadAllocation camera_allocation = _upload_ring.allocate(sizeof(Uniforms));
+        if (!camera_allocation.valid())
+            return false;
+
+        const CameraView3D &view = slot.settings.view;
+        const mat4 projection = get_rh_projection_matrix(view);
+        const mat4 rotation = get_rh_view_rotation(view);
+        const mat4 relative_combined = projection * rotation;
+        auto *camera = reinterpret_cast<Uniforms *>(camera_allocation.data);
+        memcpy(&camera->projection, value_ptr(projection), sizeof(mat4));
+        memcpy(&camera->view_matrix, value_ptr(rotation), sizeof(mat4));
+        memcpy(&camera->combined, value_ptr(relative_combined), sizeof(mat4));
+        memcpy(&camera->matrix_2d, value_ptr(matrix_2d), sizeof(mat4));
+        camera->origin = simd_make_float4(view.pos.x, view.pos.y, view.pos.z, 0.0f);
+        camera->view = view;
+        memcpy(&camera->previous_combined, value_ptr(relative_combined), sizeof(mat4));
+        camera->jitter = simd_make_float4(0.0f, 0.0f, 0.0f, 0.0f);
+
+        MTLRenderPassDescriptor *desc = pass_descriptor(RenderTexturePass);
+        desc.colorAttachments[0].texture = slot.canvas;
+        desc.colorAttachments[0].loadAction = MTLLoadActionClear;
+        desc.colorAttachments[0].storeAction = MTLStoreActionStore;
+        desc.colorAttachments[0].clearColor = MTLClearColorMake(0.0, 0.0, 0.0, 1.0);
+        desc.depthAttachment.texture = slot.depth;
+        desc.depthAttachment.loadAction = MTLLoadActionClear;
+        desc.depthAttachment.storeAction = MTLStoreActionDontCare;
+        desc.depthAttachment.clearDepth = 0.0;
+        _frame_timer.time_render_pass(desc, FRAME_PASS_3D);
+
+        id<MTLRenderCommandEncoder> encoder = [command_buffer renderCommandEncoderWithDescriptor:desc];
+        encoder.label = @"RenderTexture";
+        [encoder setDepthStencilState:_depth_state];
+        [encoder setFrontFacingWinding:MTLWindingCounterClockwise];
+        [encoder setTriangleFillMode:MTLTriangleFillModeFill];
+        [encoder setCullMode:MTLCullModeBack];
+        use_2d_resources(encoder);
+        use_3d_resources(encoder, frame_index, false);
+        [encoder useResource:_frames[frame_index].materials usage:MTLResourceUsageRead];
+
+        const unsigned int first_view = 0;
+        [encoder setVertexBuffer:frame.args_buffer offset:0 atIndex:0];
+        [encoder setVertexBuffer:camera_allocation.buffer offset:camera_allocation.offset atIndex:1];
+        [encoder setVertexBytes:&first_view length:sizeof(unsigned int) atIndex:3];
+        [encoder setFragmentBuffer:frame.args_buffer offset:0 atIndex:0];
+        [encoder setFragmentBuffer:lights.buffer offset:lights.offset atIndex:1];
+        const UploadAllocation &directional = directional_lights.valid() ? directional_lights : lights;
+        [encoder setFragmentBuffer:directional.buffer offset:directional.offset atIndex:4];
+        [encoder setFragmentBuffer:_irradiance offset:0 atIndex:9];
+        [encoder setFragmentBuffer:camera_allocation.buffer offset:camera_allocation.offset atIndex:10];
+        const UploadAllocation &view_probes = probes.valid() ? probes : lights;
+        [encoder setFragmentBuffer:view_probes.buffer offset:view_probes.offset atIndex:11];
+        [encoder setFragmentTexture:_environment atIndex:3];
+        [encoder setFragmentTexture:_probe_maps atIndex:6];
+        [encoder setFragmentTexture:_gi.irradiance atIndex:8];
+        [encoder setFragmentTexture:_gi.distances atIndex:9];
+        encode_3d_draws(encoder, _probe_state_3d, UploadAllocation{}, NSMakeRange(0, 0), true, OpaqueMeshes);
+        // The skybox fills the background behind the geometry.
+        if (_skybox != nil)
+        {
+            [encoder setRenderPipelineState:_render_texture_background_state];
+            [encoder setDepthStencilState:_depth_state_prepassed];
+            [encoder setCullMode:MTLCullModeNone];
+            [encoder drawPrimitives:MTLPrimitiveTypeTriangle vertexStart:0 vertexCount:3];
+        }
+        [encoder endEncoding];
+        drawn.push_back(&slot);
+        return true;
+    });
+    if (drawn.empty())
+        return;
+
+    // Views are copied into the textures the slots bind, which previous frames may still sample.
+    id<MTLBlitCommandEncoder> blit = [command_buffer blitCommandEncoder];
+    blit.label = @"RenderTextureMipmaps";
+    for (const RenderTextureSlot *slot : drawn)
+    {
+        [blit copyFromTexture:slot->canvas
+                  sourceSlice:0
+                  sourceLevel:0
+                    toTexture:slot->texture
+             destinationSlice:0
+             destinationLevel:0
+                   sliceCount:1
+                   levelCount:1];
+        [blit generateMipmapsForTexture:slot->texture];
+    }
+    [blit endEncoding];
+}
+
+void MetalRenderer::use_3d_resources(id<MTLRenderCommandEncoder> encoder, unsigned int frame_index, bool culled)
+{
+    [encoder useResource:_vertex_3d_list.vertex_buffer() usage:MTLResourceUsageRead];
+    [encoder useResource:_packed_3d_list.vertex_buffer() usage:MTLResourceUsageRead];
+    if (_vertex_3d_list.position_buffer() != nil)
+        [encoder useResource:_vertex_3d_list.position_buffer() usage:MTLResourceUsageRead];
+    if (culled)
+        [encoder useResource:visible_instances(frame_index) usage:MTLResourceUsageRead];
+    [encoder useResource:_instance_3d_list.buffer(frame_index) usage:MTLResourceUsageRead];
+    [encoder useResource:_instance_overrides.buffer(frame_index) usage:MTLResourceUsageRead];
+    [encoder useResource:_frames[frame_index].virtual_pages usage:MTLResourceUsageRead];
+}
+
+void MetalRenderer::encode_3d_draws(id<MTLRenderCommandEncoder> encoder, const Pipelines3D &pipelines,
+                                    const UploadAllocation &draw_args, NSRange draw_commands, bool draw_skinned,
+                                    MeshSelection selection, unsigned int first_mesh, unsigned int end_mesh,
+                                    MeshProfiler *profiler)
+{
+    [encoder setRenderPipelineState:draw_args.valid() ? pipelines.culled : pipelines.full];
+
+    // The potentially visible set holds for the camera, probes, render textures and inset views see the scene from
+    // elsewhere.
+    const bool elsewhere = &pipelines == &_probe_state_3d || &pipelines == &_inset_state_3d;
+    const unsigned int pvs_cell = elsewhere ? PotentiallyVisibleSet::NO_CELL : _pvs_cell;
+    const auto selected = [&](unsigned int mesh) {
+        if (selection == ShadowCasters)
+            return _shadow_casters.has(mesh);
+        return _transparent_meshes.has(mesh) == (selection == TransparentMeshes) && _pvs.visible(pvs_cell, mesh);
+    };
+
+    // Triangles of the visibility buffer are numbered from the whole meshes, which leaves out culled clusters and
+    // submeshes.
+    const bool vbuffer = &pipelines == &_vbuffer_state_3d;
+    // Only draws with the arguments of the early phase leave out the clusters it culled.
+    const bool clustered = _culling.cluster_args.valid() && draw_args.buffer == _culling.early_args.buffer &&
+                           draw_args.offset == _culling.early_args.offset && !vbuffer;
+    const IdTable<InstanceRange<mat4>> &instances = _instance_3d_list.get_ranges();
+    const auto draw_instances = [&](const DrawDescriptor &range, id<MTLBuffer> index_buffer,
+                                    unsigned int vertex_start, unsigned int instance_start,
+                                    unsigned int instance_count) {
+        if (range.index_count > 0)
+        {
+            // Indices are relative to the mesh, the base vertex moves them to its range in the vertex buffer.
+            [encoder drawIndexedPrimitives:MTLPrimitiveTypeTriangle
+                                indexCount:range.index_count
+                                 indexType:(range.short_indices ? MTLIndexTypeUInt16 : MTLIndexTypeUInt32)
+                               indexBuffer:index_buffer
+                         indexBufferOffset:range.index_offset
+                             instanceCount:instance_count
+                                baseVertex:vertex_start
+                              baseInstance:instance_start];
+        }
+        else
+        {
+            [encoder drawPrimitives:MTLPrimitiveTypeTriangle
+                        vertexStart:vertex_start
+                        vertexCount:(range.end - range.start)
+                      instanceCount:instance_count
+                       baseInstance:instance_start];
+        }
+    };
+
+    const auto draw_meshes = [&](const auto &list, bool packed) {
+        if (selection == SkinnedMeshes)
+            return;
+        for (const auto &[i, range] : list.get_draw_ranges())
+        {
+            if (i < first_mesh)
+                continue;
+            if (i >= end_mesh)
+                break;
+
+            // Culled meshes also draw the instances of other meshes that selected them as a coarser level of detail.
+            const auto insts = instances.find(i);
+            const bool has_instances = insts && insts->count > 0 && selected(i);
+            const std::vector<LodDraw> *lods = draw_args.valid() ? _lod_slots.find(i) : nullptr;
+            if ((!has_instances && !lods) || range.start >= range.end || _skinned_instances.has(i))
+                continue;
+            if (vbuffer)
+            {
+                const unsigned int *first_triangle = _vbuffer_first_triangles.find(i);
+                if (!first_triangle)
+                    continue;
+                [encoder setFragmentBytes:first_triangle length:sizeof(unsigned int) atIndex:2];
+            }
+
+            if (packed)
+            {
+                const PackedMesh *mesh = _packed_meshes.find(i);
+                if (!mesh)
+                    continue;
+                [encoder setVertexBytes:&mesh->bounds length:sizeof(PackedVertexBounds) atIndex:2];
+            }
+
+            const unsigned int sample = profiler ? profiler->begin_mesh(encoder) : MeshProfiler::NO_SAMPLE;
+            if (draw_args.valid())
+            {
+                const auto draw_slot = [&](unsigned int slot) {
+                    const NSUInteger offset = draw_args.offset + slot * DRAW_ARGS_WORDS * sizeof(unsigned int);
+                    if (range.index_count > 0)
+                    {
+                        [encoder drawIndexedPrimitives:MTLPrimitiveTypeTriangle
+                                             indexType:(range.short_indices ? MTLIndexTypeUInt16 : MTLIndexTypeUInt32)
+                                           indexBuffer:list.index_buffer()
+                                     indexBufferOffset:range.index_offset
+                                        indirectBuffer:draw_args.buffer
+                                  indirectBufferOffset:offset];
+                    }
+                    else
+                    {
+                        [encoder drawPrimitives:MTLPrimitiveTypeTriangle
+                                  indirectBuffer:draw_args.buffer
+                            indirectBufferOffset:offset];
+                    }
+                };
+
+                const unsigned int *cluster_slot = clustered && !packed ? _cluster_slots.find(i) : nullptr;
+                if (has_instances && cluster_slot)
+                {
+                    // Culled indices are always 32-bit.
+                    const NSUInteger offset =
+                        _culling.cluster_args.offset + *cluster_slot * DRAW_ARGS_WORDS * sizeof(unsigned int);
+                    [encoder drawIndexedPrimitives:MTLPrimitiveTypeTriangle
+                                         indexType:MTLIndexTypeUInt32
+                                       indexBuffer:_culled_indices
+                                 indexBufferOffset:0
+                                    indirectBuffer:_culling.cluster_args.buffer
+                              indirectBufferOffset:offset];
+                }
+                else if (has_instances && i < _draw_slots.size() && _draw_slots[i] != ~0u)
+                {
+                    draw_slot(_draw_slots[i]);
+                }
+                if (lods)
+                {
+                    for (const LodDraw &lod : *lods)
+                    {
+                        if (selected(lod.mesh))
+                            draw_slot(lod.slot);
+                    }
+                }
+            }
+            else if (const std::vector<SubmeshDraw> *submeshes =
+                         selection == ShadowCasters || vbuffer ? nullptr : _submesh_draws.find(i))
+            {
+                if (has_instances)
+                {
+                    for (const SubmeshDraw &submesh : *submeshes)
+                    {
+                        DrawDescriptor part = range;
+                        if (range.index_count > 0)
+                        {
+                            part.index_offset += submesh.first * (range.short_indices ? 2 : 4);
+                            part.index_count = submesh.count;
+                        }
+                        else
+                        {
+                            part.start += submesh.first;
+                            part.end = part.start + submesh.count;
+                        }
+                        draw_instances(part, list.index_buffer(), part.start, insts->start, insts->count);
+                    }
+                }
+            }
+            else if (has_instances)
+            {
+                draw_instances(range, list.index_buffer(), range.start, insts->start, insts->count);
+            }
+            if (profiler)
+                profiler->end_mesh(encoder, i, sample);
+        }
+    };
+
+    // The indirect command buffer holds the draws of all meshes, the chunk of the first mesh executes it.
+    if (draw_commands.length > 0 && !profiler)
+    {
+        if (first_mesh == 0)
+        {
+            [encoder useResource:_draw_commands usage:MTLResourceUsageRead];
+            if (_vertex_3d_list.index_buffer() != nil)
+                [encoder useResource:_vertex_3d_list.index_buffer() usage:MTLResourceUsageRead];
+            if (clustered)
+                [encoder useResource:_culled_indices usage:MTLResourceUsageRead];
+            [encoder executeCommandsInBuffer:_draw_commands withRange:draw_commands];
+        }
+    }
+    else
+    {
+        draw_meshes(_vertex_3d_list, false);
+    }
+    if (!_packed_3d_list.get_draw_ranges().empty())
+    {
+        [encoder setRenderPipelineState:draw_args.valid() ? pipelines.packed_culled : pipelines.packed];
+        draw_meshes(_packed_3d_list, true);
+    }
+
+    if (draw_skinned && !_skinned_instances.empty())
+    {
+        [encoder useResource:_vertex_3d_list.anim_buffer() usage:MTLResourceUsageRead];
+        if (_vertex_3d_list.index_buffer() != nil)
+            [encoder useResource:_vertex_3d_list.index_buffer() usage:MTLResourceUsageRead];
+
+        if (vbuffer)
+        {
+            const unsigned int no_triangle = NO_VBUFFER_TRIANGLE;
+            [encoder setFragmentBytes:&no_triangle length:sizeof(unsigned int) atIndex:2];
+        }
+        // Culled runs are only drawn by the passes of the early phase, whose arguments the culling pass wrote.
+        const bool culled = _culling.skinned_args.valid() && draw_args.valid() &&
+                            draw_args.buffer == _culling.early_args.buffer &&
+                            draw_args.offset == _culling.early_args.offset;
+        const IdTable<DrawDescriptor> &full_ranges = _vertex_3d_list.get_draw_ranges();
+        for (const auto &[i, groups] : _skinned_instances)
+        {
+            if (i < first_mesh || i >= end_mesh)
+                continue;
+
+            const auto range = full_ranges.find(i);
+            const auto insts = instances.find(i);
+            if (!range || !insts || !selected(i))
+                continue;
+            const unsigned int *first_run = culled ? _culling.skinned_runs.find(i) : nullptr;
+
+            // Runs of instances sharing a skin are drawn together, instances without a skin use the bind pose.
+            const unsigned int count = std::min(insts->count, static_cast<unsigned int>(groups.size()));
+            const unsigned int sample = profiler ? profiler->begin_mesh(encoder) : MeshProfiler::NO_SAMPLE;
+            unsigned int runs = 0;
+            for (unsigned int first = 0; first < count;)
+            {
+                unsigned int last = first + 1;
+                while (last < count && groups[last] == groups[first])
+                    last++;
+
+                const bool skinned = groups[first] != ~0u;
+                const unsigned int vertex_start =
+                    skinned ? _skinning_groups[groups[first]].out_start : range->start;
+                [encoder setRenderPipelineState:skinned ? pipelines.skinned : pipelines.full];
+                if (first_run)
+                {
+                    const NSUInteger offset = _culling.skinned_args.offset +
+                                              (*first_run + runs) * DRAW_ARGS_WORDS * sizeof(unsigned int);
+                    if (range->index_count > 0)
+                        [encoder drawIndexedPrimitives:MTLPrimitiveTypeTriangle
+                                             indexType:(range->short_indices ? MTLIndexTypeUInt16 : MTLIndexTypeUInt32)
+                                           indexBuffer:_vertex_3d_list.index_buffer()
+                                     indexBufferOffset:range->index_offset
+                                        indirectBuffer:_culling.skinned_args.buffer
+                                  indirectBufferOffset:offset];
+                    else
+                        [encoder drawPrimitives:MTLPrimitiveTypeTriangle
+                                      indirectBuffer:_culling.skinned_args.buffer
+                                indirectBufferOffset:offset];
+                }
+                else
+                {
+                    draw_instances(*range, _vertex_3d_list.index_buffer(), vertex_start, insts->start + first,
+                                   last - first);
+                }
+                first = last;
+                runs++;
+            }
+            if (profiler)
+                profiler->end_mesh(encoder, i, sample);
+        }
+    }
+}
+
+void MetalRenderer::build_2d_batches()
+{
+    _batches_2d.clear();
+    _batched_2d_vertices.clear();
+    _items_2d.clear();
+    _batches_2d_version++;
+
+    // The vertex buffer of 2D meshes is always CPU-visible, batches transform the vertices it holds.
+    id<MTLBuffer> buffer = _vertex_2d_list.vertex_buffer();
+    const auto *vertices = buffer != nil ? static_cast<const Vertex2D *>(buffer.contents) : nullptr;
+    const IdTable<InstanceRange<mat4>> &instances = _instance_2d_list.get_ranges();
+    const float inf = std::numeric_limits<float>::infinity();
+    for (const auto &[i, range] : _vertex_2d_list.get_draw_ranges())
+    {
+        const auto insts = instances.find(i);
+        if (!insts || insts->count == 0 || range.start >= range.end)
+            continue;
+
+        const ClipRect2D *clip = _clips_2d.find(i);
+        const size_t count = static_cast<size_t>(range.end - range.start) * insts->count;
+        if (!vertices || count > MAX_BATCHED_2D_VERTICES)
+        {
+            Batch2D batch = {i, 0, 0, static_cast<unsigned int>(_items_2d.size()), insts->count, clip != nullptr};
+            if (clip)
+                batch.clip = *clip;
+            _batches_2d.push_back(batch);
+
+            // Instances get the corners of the mesh bounds transformed, without vertices they are never culled.
+            vec3 bmin(inf);
+            vec3 bmax(-inf);
+            for (unsigned int v = range.start; vertices && v < range.end; v++)
+            {
+                bmin = min(bmin, vec3(vertices[v].v_x, vertices[v].v_y, vertices[v].v_z));
+                bmax = max(bmax, vec3(vertices[v].v_x, vertices[v].v_y, vertices[v].v_z));
+            }
+            for (unsigned int instance = 0; instance < insts->count; instance++)
+            {
+                Item2D item = {vec3(-inf), vec3(inf), insts->start + instance, 1};
+                if (vertices)
+                {
+                    item.bmin = vec3(inf);
+                    item.bmax = vec3(-inf);
+                    for (unsigned int corner = 0; corner < 8; corner++)
+                    {
+                        const vec3 position = vec3(
+                            insts->ptr[instance] * vec4(corner & 1 ? bmax.x : bmin.x, corner & 2 ? bmax.y : bmin.y,
+                                                        corner & 4 ? bmax.z : bmin.z, 1.0f));
+                        item.bmin = min(item.bmin, position);
+                        item.bmax = max(item.bmax, position);
+                    }
+                }
+                _items_2d.push_back(item);
+            }
+            continue;
+        }
+
+        const bool same_clip = !_batches_2d.empty() && _batches_2d.back().clipped == (clip != nullptr) &&
+                               (!clip || memcmp(&_batches_2d.back().clip, clip, sizeof(ClipRect2D)) == 0);
+        if (!same_clip || _batches_2d.back().mesh != Batch2D::BATCHED)
+        {
+            Batch2D batch = {Batch2D::BATCHED, static_cast<unsigned int>(_batched_2d_vertices.size()), 0,
+                             static_cast<unsigned int>(_items_2d.size()), 0, clip != nullptr};
+            if (clip)
+                batch.clip = *clip;
+            _batches_2d.push_back(batch);
+        }
+        for (unsigned int instance = 0; instance < insts->count; instance++)
+        {
+            const mat4 &matrix = insts->ptr[instance];
+            Item2D item = {vec3(inf), vec3(-inf), static_cast<unsigned int>(_batched_2d_vertices.size()),
+                           range.end - range.start};
+            for (unsigned int v = range.start; v < range.end; v++)
+            {
+                Vertex2D vertex = vertices[v];
+                const vec4 position = matrix * vec4(vertex.v_x, vertex.v_y, vertex.v_z, 1.0f);
+                vertex.v_x = position.x;
+                vertex.v_y = position.y;
+                vertex.v_z = position.z;
+                _batched_2d_vertices.push_back(vertex);
+                item.bmin = min(item.bmin, vec3(position));
+                item.bmax = max(item.bmax, vec3(position));
+            }
+            _items_2d.push_back(item);
+        }
+        _batches_2d.back().vertex_count += static_cast<unsigned int>(count);
+        _batches_2d.back().item_count += insts->count;
+    }
+}
+
+bool MetalRenderer::update_2d_layer(const mat4 &matrix_2d)
+{
+    const CGSize size = drawable_size();
+    const NSUInteger width = std::max(static_cast<NSUInteger>(size.width), NSUInteger(1));
+    const NSUInteger height = std::max(static_cast<NSUInteger>(size.height), NSUInteger(1));
+    if (_layer_2d == nil || _layer_2d.width != width || _layer_2d.height != height ||
+        _layer_2d.pixelFormat != target_format())
+    {
+        _retired.retire(_layer_2d);
+        MTLTextureDescriptor *desc = [MTLTextureDescriptor texture2DDescriptorWithPixelFormat:target_format()
+                                                                                        width:width
+                                                                                       height:height
+                                                                                    mipmapped:NO];
+        desc.usage = MTLTextureUsageRenderTarget | MTLTextureUsageShaderRead;
+        desc.storageMode = MTLStorageModePrivate;
+        _layer_2d = [_device newTextureWithDescriptor:desc];
+        _layer_2d.label = @"2DLayer";
+        _layer_2d_dirty = true;
+    }
+
+    if (matrix_2d != _layer_2d_matrix)
+    {
+        _layer_2d_matrix = matrix_2d;
+        _layer_2d_dirty = true;
+    }
+
+    const bool redraw = _layer_2d_dirty;
+    _layer_2d_dirty = false;
+    return redraw;
+}
+
+void MetalRenderer::update_2d_batches(FrameResources &frame)
+{
+    if (frame.batched_2d_version == _batches_2d_version || _batched_2d_vertices.empty())
+        return;
+
+    const size_t count = _batched_2d_vertices.size();
+    if (!frame.batched_2d || frame.batched_2d->size() < count)
+    {
+        const unsigned int capacity = next_multiple_of(static_cast<unsigned int>(count), 4096);
+        frame.batched_2d = std::make_unique<Buffer<Vertex2D>>(_device, capacity, cpu_write_storage(_device));
+    }
+    memcpy(frame.batched_2d->data(), _batched_2d_vertices.data(), count * sizeof(Vertex2D));
+    frame.batched_2d->update(0, static_cast<unsigned int>(count));
+    frame.batched_2d_version = _batches_2d_version;
+}
+
+void MetalRenderer::cull_2d_batches(const mat4 &matrix_2d)
+{
+    _runs_2d.clear();
+    _culled_2d.resize(_batches_2d.size());
+    const CGSize size = drawable_size();
+    const vec2 drawable = max(vec2(static_cast<float>(size.width), static_cast<float>(size.height)), vec2(1.0f));
+
+    // Pixel rectangle of the bounds under the 2D matrix, bounds behind the eye or without vertices cover everything.
+    const auto project = [&](const Item2D &item, vec2 &pmin, vec2 &pmax) {
+        pmin = vec2(std::numeric_limits<float>::infinity());
+        pmax = vec2(-std::numeric_limits<float>::infinity());
+        if (std::isinf(item.bmin.x))
+            return false;
+        for (unsigned int corner = 0; corner < 8; corner++)
+        {
+            const vec4 position = matrix_2d * vec4(corner & 1 ? item.bmax.x : item.bmin.x,
+                                                   corner & 2 ? item.bmax.y : item.bmin.y,
+                                                   corner & 4 ? item.bmax.z : item.bmin.z, 1.0f);
+            if (position.w <= 0.0f)
+                return false;
+            const vec2 pixel = vec2(position.x / position.w * 0.5f + 0.5f, 0.5f - position.y / position.w * 0.5f) *
+                               drawable;
+            pmin = min(pmin, pixel);
+            pmax = max(pmax, pixel);
+        }
+        return true;
+    };
+
+    for (size_t b = 0; b < _batches_2d.size(); b++)
+    {
+        const Batch2D &batch = _batches_2d[b];
+        Culled2D &culled = _culled_2d[b];
+        culled.first_run = static_cast<unsigned int>(_runs_2d.size());
+        culled.run_count = 0;
+
+        // The scissor rectangle must lie within the attachments, clip rectangles are cut to the drawable.
+        vec2 visible_min(0.0f);
+        vec2 visible_max = drawable;
+        if (batch.clipped)
+        {
+            const vec2 clip_min(batch.clip.x, batch.clip.y);
+            visible_min = max(visible_min, clip_min);
+            visible_max = min(visible_max, clip_min + vec2(batch.clip.width, batch.clip.height));
+        }
+        if (visible_min.x >= visible_max.x || visible_min.y >= visible_max.y)
+            continue;
+        culled.scissor = {static_cast<NSUInteger>(visible_min.x), static_cast<NSUInteger>(visible_min.y),
+                          static_cast<NSUInteger>(visible_max.x - visible_min.x),
+                          static_cast<NSUInteger>(visible_max.y - visible_min.y)};
+
+        // Consecutive visible items are drawn together, so a scrolled list is one draw of the items in view.
+        for (unsigned int i = batch.first_item; i < batch.first_item + batch.item_count; i++)
+        {
+            const Item2D &item = _items_2d[i];
+            vec2 pmin;
+            vec2 pmax;
+            if (project(item, pmin, pmax) && (pmax.x <= visible_min.x || pmin.x >= visible_max.x ||
+                                              pmax.y <= visible_min.y || pmin.y >= visible_max.y))
+                continue;
+            if (culled.run_count > 0 && _runs_2d.back().first + _runs_2d.back().second == item.start)
+            {
+                _runs_2d.back().second += item.count;
+                continue;
+            }
+            _runs_2d.emplace_back(item.start, item.count);
+            culled.run_count++;
+        }
+    }
+}
+
+void MetalRenderer::count_3d_draws()
+{
+    const IdTable<InstanceRange<mat4>> &instances = _instance_3d_list.get_ranges();
+    unsigned int draws = 0;
+    unsigned int instance_count = 0;
+    unsigned int triangles = 0;
+    MeshProfiler *profiler = _mesh_profiler.enabled() ? &_mesh_profiler : nullptr;
+    const auto count_meshes = [&](const auto &list) {
+        for (const auto &[i, range] : list.get_draw_ranges())
+        {
+            const auto insts = instances.find(i);
+            if (!insts || insts->count == 0 || range.start >= range.end)
+                continue;
+
+            const unsigned int vertices = range.index_count > 0 ? range.index_count : range.end - range.start;
+            draws++;
+            instance_count += insts->count;
+            triangles += vertices / 3 * insts->count;
+            if (profiler)
+                profiler->count(i, insts->count, vertices / 3 * insts->count);
+        }
+    };
+    count_meshes(_vertex_3d_list);
+    count_meshes(_packed_3d_list);
+    _frame_timer.count_draws(draws, instance_count, triangles);
+}
+
+UploadAllocation MetalRenderer::upload_vbuffer_meshes(unsigned int *count)
+{
+    std::vector<VBufferMesh> meshes;
+    _vbuffer_first_triangles.clear();
+    unsigned int first_triangle = 0;
+    const auto add_meshes = [&](const auto &list, bool packed) {
+        for (const auto &[i, range] : list.get_draw_ranges())
+        {
+            const PackedMesh *packed_mesh = packed ? _packed_meshes.find(i) : nullptr;
+            if (range.start >= range.end || _transparent_meshes.has(i) || _skinned_instances.has(i) ||
+                (packed && !packed_mesh))
+                continue;
+
+            VBufferMesh mesh = {first_triangle, range.start, 0, packed ? VBUFFER_PACKED : 0u,
+                                packed_mesh ? packed_mesh->bounds : PackedVertexBounds{}};
+            if (range.index_count > 0)
+            {
+                mesh.index_start = range.index_offset / (range.short_indices ? 2 : 4);
+                mesh.flags |= VBUFFER_INDEXED | (range.short_indices ? VBUFFER_SHORT_INDICES : 0u);
+            }
+
+            const unsigned int vertices = range.index_count > 0 ? range.index_count : range.end - range.start;
+            if (vertices / 3 >= NO_VBUFFER_TRIANGLE - first_triangle)
+                break;
+            meshes.push_back(mesh);
+            _vbuffer_first_triangles.insert(i, first_triangle);
+            first_triangle += vertices / 3;
+        }
+    };
+    add_meshes(_vertex_3d_list, false);
+    add_meshes(_packed_3d_list, true);
+
+    *count = static_cast<unsigned int>(meshes.size());
+    return meshes.empty() ? UploadAllocation{} : _upload_ring.upload(meshes.data(), meshes.size());
+}
+
+std::vector<unsigned int> MetalRenderer::draw_chunks() const
+{
+    std::vector<unsigned int> bounds = {0};
+    const IdTable<InstanceRange<mat4>> &instances = _instance_3d_list.get_ranges();
+    const size_t chunks = std::min<size_t>(_encoding_threads, instances.size() / MIN_MESHES_PER_CHUNK);
+    if (chunks > 1)
+    {
+        const size_t per_chunk = (instances.size() + chunks - 1) / chunks;
+        size_t index = 0;
+        for (const auto &[i, insts] : instances)
+        {
+            if (index > 0 && index % per_chunk == 0)
+                bounds.push_back(i);
+            index++;
+        }
+    }
+    bounds.push_back(~0u);
+    return bounds;
+}
+
+void MetalRenderer::encode_3d_pass(id<MTLCommandBuffer> command_buffer, MTLRenderPassDescriptor *desc, NSString *label,
+                                   const EncodeFunction &setup, const DrawFunction &draw, const EncodeFunction &finish)
+{
+    const std::vector<unsigned int> bounds = draw_chunks();
+    if (bounds.size() <= 2)
+    {
+        id<MTLRenderCommandEncoder> encoder = [command_buffer renderCommandEncoderWithDescriptor:desc];
+        encoder.label = label;
+        setup(encoder);
+        draw(encoder, 0, ~0u);
+        if (finish)
+            finish(encoder);
+        [encoder endEncoding];
+        return;
+    }
+
+    // Sub-encoders execute in the order they were created in, whichever thread encodes them.
+    id<MTLParallelRenderCommandEncoder> parallel = [command_buffer parallelRenderCommandEncoderWithDescriptor:desc];
+    parallel.label = label;
+    const size_t chunks = bounds.size() - 1;
+    std::vector<id<MTLRenderCommandEncoder>> encoders(chunks);
+    for (size_t i = 0; i < chunks; i++)
+    {
+        encoders[i] = [parallel renderCommandEncoder];
+        encoders[i].label = [NSString stringWithFormat:@"%@ %zu", label, i];
+    }
+
+    id<MTLRenderCommandEncoder> *chunk_encoders = encoders.data();
+    const unsigned int *chunk_bounds = bounds.data();
+    dispatch_apply(chunks, dispatch_get_global_queue(QOS_CLASS_USER_INTERACTIVE, 0), ^(size_t i) {
+      @autoreleasepool
+      {
+          id<MTLRenderCommandEncoder> encoder = chunk_encoders[i];
+          setup(encoder);
+          draw(encoder, chunk_bounds[i], chunk_bounds[i + 1]);
+          if (finish && i + 1 == chunks)
+              finish(encoder);
+          [encoder endEncoding];
+      }
+    });
+    [parallel endEncoding];
+}
+
+MTLRenderPassDescriptor *MetalRenderer::pass_descriptor(PassDescriptor pass)
+{
+    // Passes that are only encoded later, such as picking or the overdraw view, get theirs with the first frame too,
+    // so any allocation after it is one that leaks.
+    if (_pass_descriptors[0] == nil)
+    {
+        for (MTLRenderPassDescriptor *&desc : _pass_descriptors)
+            desc = [[MTLRenderPassDescriptor alloc] init];
+        if (_frames_rendered > 1)
+            _pass_descriptor_allocations += PassDescriptorCount;
+        assert(_pass_descriptor_allocations == 0);
+        return _pass_descriptors[pass];
+    }
+
+    MTLRenderPassDescriptor *desc = _pass_descriptors[pass];
+
+    // The G-buffer and the transparency layers are the most color attachments any pass binds.
+    constexpr NSUInteger attachments = std::max(GBUFFER_DEPTH_INDEX, TRANSPARENT_REVEAL_INDEX) + 1;
+    for (NSUInteger i = 0; i < attachments; i++)
+    {
+        MTLRenderPassColorAttachmentDescriptor *attachment = desc.colorAttachments[i];
+        attachment.texture = nil;
+        attachment.resolveTexture = nil;
+        attachment.slice = 0;
+        attachment.loadAction = MTLLoadActionDontCare;
+        attachment.storeAction = MTLStoreActionDontCare;
+        attachment.clearColor = MTLClearColorMake(0.0, 0.0, 0.0, 1.0);
+    }
+    desc.depthAttachment.texture = nil;
+    desc.depthAttachment.slice = 0;
+    desc.depthAttachment.loadAction = MTLLoadActionDontCare;
+    desc.depthAttachment.storeAction = MTLStoreActionDontCare;
+    // The far plane of reversed depth, passes that draw standard depth clear to 1.
+    desc.depthAttachment.clearDepth = 0.0;
+    desc.rasterizationRateMap = nil;
+    desc.renderTargetArrayLength = 0;
+    if (@available(macOS 11.0, *))
+    {
+        desc.sampleBufferAttachments[0].sampleBuffer = nil;
+        desc.sampleBufferAttachments[1].sampleBuffer = nil;
+    }
+    desc.visibilityResultBuffer = nil;
+    return desc;
+}
+
+void MetalRenderer::encode_light_culling(id<MTLCommandBuffer> command_buffer, const UploadAllocation &uniforms,
+                                         const UploadAllocation &point_lights, const UploadAllocation &spot_lights,
+                                         bool rate_mapped)
+{
+    const NSUInteger tiles_x = (_depth_texture.width + LIGHT_TILE_SIZE - 1) / LIGHT_TILE_SIZE;
+    const NSUInteger tiles_y = (_depth_texture.height + LIGHT_TILE_SIZE - 1) / LIGHT_TILE_SIZE;
+    const NSUInteger size = tiles_x * tiles_y * LIGHT_TILE_STRIDE * sizeof(unsigned int);
+    if (_tile_lights == nil || _tile_lights.length < size)
+    {
+        _retired.retire(_tile_lights);
+        _tile_lights = [_device newBufferWithLength:size options:MTLResourceStorageModePrivate];
+        _tile_lights.label = @"TileLights";
+    }
+
+    const UploadAllocation &points = point_lights.valid() ? point_lights : uniforms;
+    const UploadAllocation &spots = spot_lights.valid() ? spot_lights : uniforms;
+
+    id<MTLComputeCommandEncoder> encoder = _frame_timer.compute_encoder(command_buffer, FRAME_PASS_LIGHTING);
+    encoder.label = @"LightCulling";
+    [encoder setComputePipelineState:rate_mapped ? _rate_mapped_light_cull_state : _light_cull_state];
+    [encoder setTexture:_depth_texture atIndex:0];
+    [encoder setBuffer:uniforms.buffer offset:uniforms.offset atIndex:0];
+    [encoder setBuffer:points.buffer offset:points.offset atIndex:1];
+    [encoder setBuffer:spots.buffer offset:spots.offset atIndex:2];
+    [encoder setBuffer:_tile_lights offset:0 atIndex:3];
+    if (_light_tree != nil)
+        [encoder setBuffer:_light_tree offset:0 atIndex:5];
+    else
+        [encoder setBuffer:uniforms.buffer offset:uniforms.offset atIndex:5];
+
+    // Only the tiles of the physical size of a rate map are shaded.
+    MTLSize tiles = MTLSizeMake(tiles_x, tiles_y, 1);
+    if (rate_mapped)
+    {
+        [encoder setBuffer:_rate_map_data offset:0 atIndex:4];
+        if (@available(macOS 10.15.4, *))
+        {
+            const MTLSize physical = [_rate_map physicalSizeForLayer:0];
+            tiles.width = std::min(tiles_x, (physical.width + LIGHT_TILE_SIZE - 1) / LIGHT_TILE_SIZE);
+            tiles.height = std::min(tiles_y, (physical.height + LIGHT_TILE_SIZE - 1) / LIGHT_TILE_SIZE);
+        }
+    }
+    [encoder dispatchThreadgroups:tiles threadsPerThreadgroup:MTLSizeMake(LIGHT_TILE_SIZE, LIGHT_TILE_SIZE, 1)];
+    [encoder endEncoding];
+}
+
+void MetalRenderer::encode_light_tree(id<MTLCommandBuffer> command_buffer)
+{
+    const auto count = static_cast<unsigned int>(_area_lights.size());
+
+    // Codes quantize the centers to 10 bits per axis within their bounds.
+    vec3 center_min = vec3(std::numeric_limits<float>::max());
+    vec3 center_max = vec3(-std::numeric_limits<float>::max());
+    for (const AreaLight &light : _area_lights)
+    {
+        const vec3 center = vec3(light.pos_x, light.pos_y, light.pos_z);
+        center_min = min(center_min, center);
+        center_max = max(center_max, center);
+    }
+    const vec3 scale = 1023.0f / max(center_max - center_min, vec3(1e-6f));
+    LightTreeUniforms uniforms = {};
+    uniforms.center_min = simd_make_float4(center_min.x, center_min.y, center_min.z, 0.0f);
+    uniforms.center_scale = simd_make_float4(scale.x, scale.y, scale.z, 0.0f);
+    uniforms.count = count;
+
+    id<MTLBuffer> keys = [_device newBufferWithLength:count * sizeof(simd_uint2)
+                                              options:MTLResourceStorageModePrivate];
+    keys.label = @"LightTreeKeys";
+    _retired.retire(keys);
+
+    id<MTLComputeCommandEncoder> encoder = _frame_timer.compute_encoder(command_buffer, FRAME_PASS_LIGHTING);
+    encoder.label = @"LightTree";
+    [encoder setBuffer:_area_light_buffer offset:0 atIndex:0];
+    [encoder setBuffer:keys offset:0 atIndex:1];
+    [encoder setBuffer:_light_tree offset:0 atIndex:2];
+    [encoder setBytes:&uniforms length:sizeof(uniforms) atIndex:3];
+
+    const MTLSize group = MTLSizeMake(LIGHT_TREE_GROUP_SIZE, 1, 1);
+    const auto groups = [](NSUInteger threads) {
+        return MTLSizeMake((threads + LIGHT_TREE_GROUP_SIZE - 1) / LIGHT_TREE_GROUP_SIZE, 1, 1);
+    };
+    [encoder setComputePipelineState:_light_tree_keys_state];
+    [encoder dispatchThreadgroups:groups(count) threadsPerThreadgroup:group];
+
+    // Codes have 30 bits, the radix sort rebinds every buffer it uses.
+    _primitives.encode_sort(encoder, keys, 0, count, 30, false);
+
+    // All nodes at once, internal nodes find their range of lights and their split from the sorted codes alone.
+    [encoder setComputePipelineState:_build_light_tree_state];
+    [encoder setBuffer:_area_light_buffer offset:0 atIndex:0];
+    [encoder setBuffer:keys offset:0 atIndex:1];
+    [encoder setBuffer:_light_tree offset:0 atIndex:2];
+    [encoder setBytes:&uniforms length:sizeof(uniforms) atIndex:3];
+    [encoder dispatchThreadgroups:groups(2 * count - 1) threadsPerThreadgroup:group];
+    [encoder endEncoding];
+    _light_tree_dirty = false;
+}
+
+void MetalRenderer::encode_ray_tracing(id<MTLCommandBuffer> command_buffer, const UploadAllocation &uniforms,
+                                       const UploadAllocation &directional_lights)
+{
+    if (@available(macOS 11.0, *))
+    {
+        const UploadAllocation &directional = directional_lights.valid() ? directional_lights : uniforms;
+
+        id<MTLComputeCommandEncoder> encoder = _frame_timer.compute_encoder(command_buffer, FRAME_PASS_LIGHTING);
+        encoder.label = @"RayTracing";
+        [encoder setComputePipelineState:_trace_state];
+        [encoder setTexture:_depth_texture atIndex:0];
+        [encoder setTexture:_ray_traced atIndex:1];
+        [encoder setBuffer:uniforms.buffer offset:uniforms.offset atIndex:0];
+        [encoder setBuffer:directional.buffer offset:directional.offset atIndex:1];
+        set_traced_scene(encoder, 2);
+
+        [encoder dispatchThreadgroups:MTLSizeMake((_ray_traced.width + 7) / 8, (_ray_traced.height + 7) / 8, 1)
+                threadsPerThreadgroup:MTLSizeMake(8, 8, 1)];
+        [encoder endEncoding];
+    }
+}
+
+void MetalRenderer::encode_sdf_tracing(id<MTLCommandBuffer> command_buffer, const UploadAllocation &uniforms,
+                                       const UploadAllocation &directional_lights, const glm::vec3 &camera)
+{
+    const UploadAllocation &directional = directional_lights.valid() ? directional_lights : uniforms;
+
+    id<MTLComputeCommandEncoder> encoder = _frame_timer.compute_encoder(command_buffer, FRAME_PASS_LIGHTING);
+    encoder.label = @"SdfTracing";
+    if (_sdf_scene.update(encoder, _upload_ring, _retired, _vertex_3d_list, _instance_3d_list.get_ranges(),
+                          _instance_3d_bounds, _skinning_groups, _skinned_instances, _sdf_settings, camera))
+    {
+        [encoder setComputePipelineState:_sdf_trace_state];
+        [encoder setTexture:_depth_texture atIndex:0];
+        [encoder setTexture:_ray_traced atIndex:1];
+        [encoder setBuffer:uniforms.buffer offset:uniforms.offset atIndex:0];
+        [encoder setBuffer:directional.buffer offset:directional.offset atIndex:1];
+        _sdf_scene.bind(encoder, 2, 2);
+        [encoder dispatchThreadgroups:MTLSizeMake((_ray_traced.width + 7) / 8, (_ray_traced.height + 7) / 8, 1)
+                threadsPerThreadgroup:MTLSizeMake(8, 8, 1)];
+    }
+    [encoder endEncoding];
+}
+
+void MetalRenderer::encode_ssao(id<MTLCommandBuffer> command_buffer, const UploadAllocation &uniforms,
+                               const mat4 &combined, id<MTLTexture> ssao, id<MTLTexture> blurred)
+{
+    SsaoUniforms ssao_uniforms = {};
+    memcpy(&ssao_uniforms.combined, value_ptr(combined), sizeof(mat4));
+    ssao_uniforms.width = static_cast<unsigned int>(ssao.width);
+    ssao_uniforms.height = static_cast<unsigned int>(ssao.height);
+
+    id<MTLComputeCommandEncoder> encoder = _frame_timer.compute_encoder(command_buffer, FRAME_PASS_LIGHTING);
+    encoder.label = @"SSAO";
+    [encoder setComputePipelineState:_ssao_state];
+    [encoder setTexture:_depth_texture atIndex:0];
+    [encoder setTexture:ssao atIndex:1];
+    [encoder setBuffer:uniforms.buffer offset:uniforms.offset atIndex:0];
+    [encoder setBytes:&ssao_uniforms length:sizeof(ssao_uniforms) atIndex:1];
+    [encoder dispatchThreadgroups:MTLSizeMake((ssao_uniforms.width + 7) / 8, (ssao_uniforms.height + 7) / 8, 1)
+            threadsPerThreadgroup:MTLSizeMake(8, 8, 1)];
+
+    // One group per SSAO_GROUP_SIZE texels of a row, then of a column.
+    if (blurred != nil)
+    {
+        [encoder setComputePipelineState:_ssao_blur_state];
+        for (const unsigned int horizontal : {1u, 0u})
+        {
+            const NSUInteger length = horizontal ? ssao.width : ssao.height;
+            const NSUInteger lines = horizontal ? ssao.height : ssao.width;
+            [encoder setTexture:horizontal ? ssao : blurred atIndex:0];
+            [encoder setTexture:horizontal ? blurred : ssao atIndex:1];
+            [encoder setBytes:&horizontal length:sizeof(horizontal) atIndex:0];
+            [encoder dispatchThreadgroups:MTLSizeMake((length + SSAO_GROUP_SIZE - 1) / SSAO_GROUP_SIZE, lines, 1)
+                    threadsPerThreadgroup:MTLSizeMake(SSAO_GROUP_SIZE, 1, 1)];
+        }
+    }
+    [encoder endEncoding];
+}
+
+void MetalRenderer::create_reflection_targets()
+{
+    const NSUInteger width = (_depth_texture.width + 1) / 2;
+    const NSUInteger height = (_depth_texture.height + 1) / 2;
+    if (_reflections.traced != nil && _reflections.traced.width == width && _reflections.traced.height == height)
+        return;
+
+    _retired.retire(_reflections.hzb, _reflections.traced, _reflections.source, _reflections.history[0],
+                    _reflections.history[1], _reflections.rays, _reflections.counters);
+    for (id<MTLTexture> level : _reflections.hzb_levels)
+        _retired.retire(level);
+
+    const auto create_texture = [&](MTLPixelFormat format, NSUInteger texture_width, NSUInteger texture_height,
+                                    NSUInteger levels, NSString *label) {
+        MTLTextureDescriptor *desc = [MTLTextureDescriptor texture2DDescriptorWithPixelFormat:format
+                                                                                        width:texture_width
+                                                                                       height:texture_height
+                                                                                    mipmapped:levels > 1];
+        desc.mipmapLevelCount = std::min(levels, desc.mipmapLevelCount);
+        desc.storageMode = MTLStorageModePrivate;
+        desc.usage = MTLTextureUsageShaderRead | MTLTextureUsageShaderWrite;
+        id<MTLTexture> texture = [_device newTextureWithDescriptor:desc];
+        texture.label = label;
+        return texture;
+    };
+
+    // Power of two sizes keep every level of the pyramid exactly half the size of the one below, like the depth
+    // pyramid of occlusion culling.
+    _reflections.hzb = create_texture(MTLPixelFormatR32Float, next_power_of_two(static_cast<unsigned int>(width)),
+                                      next_power_of_two(static_cast<unsigned int>(height)), REFLECTION_HZB_LEVELS,
+                                      @"ReflectionHzb");
+    _reflections.hzb_levels.clear();
+    for (NSUInteger level = 0; level < _reflections.hzb.mipmapLevelCount; level++)
+    {
+        _reflections.hzb_levels.push_back([_reflections.hzb newTextureViewWithPixelFormat:MTLPixelFormatR32Float
+                                                                               textureType:MTLTextureType2D
+                                                                                    levels:NSMakeRange(level, 1)
+                                                                                    slices:NSMakeRange(0, 1)]);
+    }
+    _reflections.traced = create_texture(MTLPixelFormatRGBA16Float, width, height, 1, @"TracedReflections");
+    _reflections.source = create_texture(MTLPixelFormatRGBA16Float, width, height, 1, @"ReflectionSource");
+    _reflections.history[0] = create_texture(MTLPixelFormatRGBA16Float, width, height, 1, @"ReflectionHistory");
+    _reflections.history[1] = create_texture(MTLPixelFormatRGBA16Float, width, height, 1, @"ReflectionHistory");
+    _reflections.rays = [_device newBufferWithLength:width * height * sizeof(unsigned int)
+                                             options:MTLResourceStorageModePrivate];
+    _reflections.rays.label = @"ReflectionRays";
+    _reflections.counters = [_device newBufferWithLength:sizeof(ReflectionCounters)
+                                                 options:MTLResourceStorageModePrivate];
+    _reflections.counters.label = @"ReflectionCounters";
+    _reflections.history_valid = false;
+    _reflections.source_valid = false;
+}
+
+id<MTLTexture> MetalRenderer::encode_reflections(id<MTLCommandBuffer> command_buffer, unsigned int frame_index,
+                                                 const UploadAllocation &uniforms, const mat4 &combined, bool traced)
+{
+    create_reflection_targets();
+    ReflectionUniforms reflection_uniforms = {};
+    memcpy(&reflection_uniforms.combined, value_ptr(combined), sizeof(mat4));
+    memcpy(&reflection_uniforms.previous_combined, value_ptr(_previous_combined), sizeof(mat4));
+    reflection_uniforms.width = static_cast<unsigned int>(_reflections.traced.width);
+    reflection_uniforms.height = static_cast<unsigned int>(_reflections.traced.height);
+    reflection_uniforms.max_distance = _reflections.settings.max_distance;
+    reflection_uniforms.traced = traced && _reflections.trace != nil ? 1 : 0;
+    reflection_uniforms.hzb_levels = static_cast<unsigned int>(_reflections.hzb_levels.size());
+    reflection_uniforms.history = _reflections.history_valid ? 1 : 0;
+    reflection_uniforms.source = _reflections.source_valid ? 1 : 0;
+
+    id<MTLTexture> history = _reflections.history[_reflections.history_index];
+    _reflections.history_index = 1 - _reflections.history_index;
+    id<MTLTexture> resolved = _reflections.history[_reflections.history_index];
+
+    // Dispatches of a serial encoder see the writes of the previous ones, the traced dispatch reads its threadgroup
+    // count from the queue the screen space pass filled.
+    id<MTLComputeCommandEncoder> encoder = _frame_timer.compute_encoder(command_buffer, FRAME_PASS_LIGHTING);
+    encoder.label = @"Reflections";
+    const MTLSize group = MTLSizeMake(8, 8, 1);
+    const MTLSize groups = MTLSizeMake((reflection_uniforms.width + 7) / 8, (reflection_uniforms.height + 7) / 8, 1);
+    const auto dispatch_level = [&](id<MTLComputePipelineState> state, id<MTLTexture> src, id<MTLTexture> dst) {
+        [encoder setComputePipelineState:state];
+        [encoder setTexture:src atIndex:0];
+        [encoder setTexture:dst atIndex:1];
+        [encoder dispatchThreadgroups:MTLSizeMake((dst.width + 7) / 8, (dst.height + 7) / 8, 1)
+                threadsPerThreadgroup:group];
+    };
+    dispatch_level(_reflections.hzb_init, _depth_texture, _reflections.hzb_levels[0]);
+    for (size_t i = 1; i < _reflections.hzb_levels.size(); i++)
+        dispatch_level(_reflections.hzb_downsample, _reflections.hzb_levels[i - 1], _reflections.hzb_levels[i]);
+
+    [encoder setBuffer:uniforms.buffer offset:uniforms.offset atIndex:0];
+    [encoder setBytes:&reflection_uniforms length:sizeof(reflection_uniforms) atIndex:1];
+    [encoder setBuffer:_reflections.rays offset:0 atIndex:2];
+    [encoder setBuffer:_reflections.counters offset:0 atIndex:3];
+    [encoder setComputePipelineState:_reflections.begin];
+    [encoder dispatchThreadgroups:MTLSizeMake(1, 1, 1) threadsPerThreadgroup:MTLSizeMake(1, 1, 1)];
+
+    [encoder setComputePipelineState:_reflections.trace_screen];
+    [encoder setTexture:_depth_texture atIndex:0];
+    [encoder setTexture:_reflections.hzb atIndex:1];
+    [encoder setTexture:_reflections.source atIndex:2];
+    [encoder setTexture:_reflections.traced atIndex:3];
+    [encoder dispatchThreadgroups:groups threadsPerThreadgroup:group];
+
+    if (reflection_uniforms.traced != 0)
+    {
+        if (@available(macOS 11.0, *))
+        {
+            const std::vector<TracedInstance> &traced_instances = this->traced_instances();
+            const UploadAllocation instances = _upload_ring.upload(traced_instances.data(), traced_instances.size());
+            const UploadAllocation directional_lights =
+                _upload_ring.upload(_directional_lights.data(), _directional_lights.size());
+            if (instances.valid())
+            {
+                [encoder setComputePipelineState:_reflections.queue];
+                [encoder dispatchThreadgroups:MTLSizeMake(1, 1, 1) threadsPerThreadgroup:MTLSizeMake(1, 1, 1)];
+
+                use_traced_resources(encoder, frame_index);
+                const UploadAllocation &directional = directional_lights.valid() ? directional_lights : uniforms;
+                [encoder setBuffer:_frames[frame_index].args_buffer offset:0 atIndex:4];
+                [encoder setBuffer:instances.buffer offset:instances.offset atIndex:5];
+                [encoder setBuffer:_vertex_3d_list.index_buffer() offset:0 atIndex:6];
+                [encoder setBuffer:directional.buffer offset:directional.offset atIndex:7];
+                set_traced_scene(encoder, 8);
+                [encoder setTexture:_environment atIndex:4];
+                [encoder setComputePipelineState:_reflections.trace];
+                [encoder dispatchThreadgroupsWithIndirectBuffer:_reflections.counters
+                                           indirectBufferOffset:offsetof(ReflectionCounters, trace)
+                                          threadsPerThreadgroup:MTLSizeMake(REFLECTION_GROUP_SIZE, 1, 1)];
+            }
+        }
+    }
+
+    [encoder setComputePipelineState:_reflections.resolve];
+    [encoder setTexture:_depth_texture atIndex:0];
+    [encoder setTexture:_reflections.traced atIndex:1];
+    [encoder setTexture:history atIndex:2];
+    [encoder setTexture:resolved atIndex:3];
+    [encoder dispatchThreadgroups:groups threadsPerThreadgroup:group];
+    [encoder endEncoding];
+    _reflections.history_valid = true;
+    return resolved;
+}
+
+void MetalRenderer::encode_reflection_source(id<MTLCommandBuffer> command_buffer)
+{
+    id<MTLComputeCommandEncoder> encoder = _frame_timer.compute_encoder(command_buffer, FRAME_PASS_LIGHTING);
+    encoder.label = @"ReflectionSource";
+    id<MTLTexture> source = _reflections.source;
+    [encoder setComputePipelineState:_reflections.downsample];
+    [encoder setTexture:_scaled_color atIndex:0];
+    [encoder setTexture:source atIndex:1];
+    [encoder dispatchThreadgroups:MTLSizeMake((source.width + 7) / 8, (source.height + 7) / 8, 1)
+            threadsPerThreadgroup:MTLSizeMake(8, 8, 1)];
+    [encoder endEncoding];
+    _reflections.source_valid = true;
+}
+
+void MetalRenderer::use_traced_resources(id<MTLComputeCommandEncoder> encoder, unsigned int frame_index)
+{
+    if (@available(macOS 11.0, *))
+    {
+        if (!textures_resident())
+        {
+            for (const auto &heap : _texture_heaps)
+                [encoder useHeap:heap];
+            for (const auto &tex : _standalone_textures)
+                [encoder useResource:tex usage:MTLResourceUsageRead];
+            for (const auto &tex : _texture_arrays.textures())
+                [encoder useResource:tex usage:MTLResourceUsageRead];
+            [encoder useResource:_fallback_texture usage:MTLResourceUsageRead];
+        }
+        [encoder useResource:_vertex_3d_list.vertex_buffer() usage:MTLResourceUsageRead];
+        if (_vertex_3d_list.anim_buffer() != nil)
+            [encoder useResource:_vertex_3d_list.anim_buffer() usage:MTLResourceUsageRead];
+        [encoder useResource:_instance_3d_list.buffer(frame_index) usage:MTLResourceUsageRead];
+        [encoder useResource:_instance_overrides.buffer(frame_index) usage:MTLResourceUsageRead];
+        [encoder useResource:_textures_buffer usage:MTLResourceUsageRead];
+        [encoder useResource:_texture_layers_buffer usage:MTLResourceUsageRead];
+        if (_texture_arrays_buffer != nil)
+            [encoder useResource:_texture_arrays_buffer usage:MTLResourceUsageRead];
+        [encoder useResource:_samplers_buffer usage:MTLResourceUsageRead];
+        [encoder useResource:_frames[frame_index].materials usage:MTLResourceUsageRead];
+        [encoder useResource:_frames[frame_index].virtual_pages usage:MTLResourceUsageRead];
+    }
+}
+
+void MetalRenderer::set_traced_scene(id<MTLComputeCommandEncoder> encoder, unsigned int index)
+{
+    if (!_hardware_tracing)
+    {
+        _bvh_scene.bind(encoder, BVH_SCENE_BUFFER_INDEX);
+        return;
+    }
+    if (@available(macOS 11.0, *))
+    {
+        [encoder setAccelerationStructure:_acceleration_structures.instance_structure() atBufferIndex:index];
+        _acceleration_structures.use_resources(encoder);
+    }
+}
+
+const std::vector<TracedInstance> &MetalRenderer::traced_instances() const
+{
+    return _hardware_tracing ? _acceleration_structures.traced_instances() : _bvh_scene.traced_instances();
+}
+
+void MetalRenderer::encode_gi(id<MTLCommandBuffer> command_buffer, unsigned int frame_index)
+{
+    if (@available(macOS 11.0, *))
+    {
+        const GiVolume &volume = _gi.volume;
+        const unsigned int total = volume.count_x * volume.count_y * volume.count_z;
+        if (_gi.ray_budget == 0 || total == 0)
+            return;
+        const unsigned int probes = std::min(std::max(_gi.ray_budget / GI_RAYS_PER_PROBE, 1u), total);
+        const NSUInteger size = probes * GI_RAYS_PER_PROBE * sizeof(simd_float4);
+        if (_gi.radiance == nil || _gi.radiance.length < size)
+        {
+            _retired.retire(_gi.radiance);
+            _gi.radiance = [_device newBufferWithLength:size options:MTLResourceStorageModePrivate];
+            _gi.radiance.label = @"GiRadiance";
+        }
+
+        // Every update turns the rays by a rotation around an axis of the Halton sequence, so the rays of successive
+        // updates of a probe cover the sphere.
+        _gi.seed++;
+        const float z = 1.0f - 2.0f * halton(_gi.seed, 2);
+        const float phi = 2.0f * pi<float>() * halton(_gi.seed, 3);
+        const float r = std::sqrt(std::max(1.0f - z * z, 0.0f));
+        const mat4 rotation =
+            rotate(mat4(1.0f), 2.0f * pi<float>() * halton(_gi.seed, 5), vec3(r * std::cos(phi), r * std::sin(phi), z));
+
+        // The first update of every probe replaces what its texels held.
+        const bool settled = _gi.updated >= total;
+        GiUniforms uniforms = {};
+        memcpy(&uniforms.rotation, value_ptr(rotation), sizeof(mat4));
+        uniforms.volume = volume;
+        uniforms.first_probe = _gi.next_probe;
+        uniforms.num_probes = probes;
+        uniforms.seed = _gi.seed;
+        uniforms.hysteresis = settled ? _gi.hysteresis : 0.0f;
+        uniforms.max_distance = 1.5f * length(vec3(volume.spacing.x, volume.spacing.y, volume.spacing.z));
+        uniforms.environment = _skybox != nil ? 1 : 0;
+        uniforms.num_point_lights = static_cast<unsigned int>(_point_lights.size());
+        uniforms.num_spot_lights = static_cast<unsigned int>(_spot_lights.size());
+        uniforms.num_directional_lights = static_cast<unsigned int>(_directional_lights.size());
+        uniforms.bounce = settled ? 1 : 0;
+
+        const std::vector<TracedInstance> &traced_instances = this->traced_instances();
+        const UploadAllocation uniforms_allocation = _upload_ring.upload(&uniforms, 1);
+        const UploadAllocation instances = _upload_ring.upload(traced_instances.data(), traced_instances.size());
+        const UploadAllocation point_lights = _upload_ring.upload(_point_lights.data(), _point_lights.size());
+        const UploadAllocation spot_lights = _upload_ring.upload(_spot_lights.data(), _spot_lights.size());
+        const UploadAllocation directional_lights =
+            _upload_ring.upload(_directional_lights.data(), _directional_lights.size());
+        if (!uniforms_allocation.valid() || !instances.valid())
+            return;
+
+        id<MTLComputeCommandEncoder> encoder = _frame_timer.compute_encoder(command_buffer, FRAME_PASS_LIGHTING);
+        encoder.label = @"IrradianceVolume";
+        use_traced_resources(encoder, frame_index);
+
+        const auto set_light_buffer = [&](const UploadAllocation &allocation, unsigned int index) {
+            const UploadAllocation &bound = allocation.valid() ? allocation : uniforms_allocation;
+            [encoder setBuffer:bound.buffer offset:bound.offset atIndex:index];
+        };
+        [encoder setBuffer:_frames[frame_index].args_buffer offset:0 atIndex:0];
+        [encoder setBuffer:uniforms_allocation.buffer offset:uniforms_allocation.offset atIndex:1];
+        [encoder setBuffer:_gi.radiance offset:0 atIndex:2];
+        [encoder setBuffer:instances.buffer offset:instances.offset atIndex:3];
+        [encoder setBuffer:_vertex_3d_list.index_buffer() offset:0 atIndex:4];
+        set_light_buffer(point_lights, 5);
+        set_light_buffer(spot_lights, 6);
+        set_light_buffer(directional_lights, 7);
+        set_traced_scene(encoder, 8);
+        [encoder setTexture:_gi.irradiance atIndex:0];
+        [encoder setTexture:_gi.distances atIndex:1];
+        [encoder setTexture:_environment atIndex:2];
+
+        // The blends of a serial encoder see the rays the trace wrote.
+        const unsigned int rays = probes * GI_RAYS_PER_PROBE;
+        [encoder setComputePipelineState:_gi.trace];
+        [encoder dispatchThreadgroups:MTLSizeMake((rays + 63) / 64, 1, 1) threadsPerThreadgroup:MTLSizeMake(64, 1, 1)];
+        [encoder setComputePipelineState:_gi.blend_irradiance];
+        [encoder dispatchThreadgroups:MTLSizeMake(probes, 1, 1)
+                threadsPerThreadgroup:MTLSizeMake(GI_IRRADIANCE_TEXELS, GI_IRRADIANCE_TEXELS, 1)];
+        [encoder setTexture:_gi.distances atIndex:0];
+        [encoder setComputePipelineState:_gi.blend_distances];
+        [encoder dispatchThreadgroups:MTLSizeMake(probes, 1, 1)
+                threadsPerThreadgroup:MTLSizeMake(GI_DISTANCE_TEXELS, GI_DISTANCE_TEXELS, 1)];
+        [encoder endEncoding];
+
+        _gi.next_probe = (_gi.next_probe + probes) % total;
+        _gi.updated = std::min(_gi.updated + probes, total);
+    }
+}
+
+void MetalRenderer::create_path_tracer_buffers()
+{
+    const NSUInteger size = _depth_texture.width * _depth_texture.height;
+    const auto create_buffer = [&](NSUInteger length, NSString *label) {
+        id<MTLBuffer> buffer = [_device newBufferWithLength:length options:MTLResourceStorageModePrivate];
+        buffer.label = label;
+        return buffer;
+    };
+
+    // Paths of even and odd bounces go to separate queues, a bounce appends the paths of the next one.
+    _path_tracer.paths = create_buffer(2 * size * sizeof(PathState), @"Paths");
+    _path_tracer.hits = create_buffer(size * sizeof(PathHit), @"PathHits");
+    _path_tracer.shadow_rays = create_buffer(size * sizeof(ShadowRay), @"ShadowRays");
+    _path_tracer.counters = create_buffer(sizeof(PathCounters), @"PathCounters");
+    _path_tracer.accumulator = create_buffer(size * sizeof(simd_float4), @"PathAccumulator");
+    _path_tracer.samples = 0;
+    create_path_denoiser_buffers();
+    create_path_adaptive_buffers();
+}
+
+void MetalRenderer::create_path_denoiser_buffers()
+{
+    _path_tracer.history_valid = false;
+    if (!_path_tracer.denoise)
+    {
+        _path_tracer.surfaces = {};
+        _path_tracer.history = {};
+        _path_tracer.filtered = {};
+        return;
+    }
+
+    const NSUInteger size = _depth_texture.width * _depth_texture.height;
+    for (unsigned int i = 0; i < 2; i++)
+    {
+        _path_tracer.surfaces[i] =
+            [_device newBufferWithLength:size * sizeof(PathSurface) options:MTLResourceStorageModePrivate];
+        _path_tracer.surfaces[i].label = @"PathSurfaces";
+        _path_tracer.history[i] =
+            [_device newBufferWithLength:size * sizeof(PathHistory) options:MTLResourceStorageModePrivate];
+        _path_tracer.history[i].label = @"PathHistory";
+        _path_tracer.filtered[i] =
+            [_device newBufferWithLength:size * sizeof(simd_float4) options:MTLResourceStorageModePrivate];
+        _path_tracer.filtered[i].label = @"PathFiltered";
+    }
+}
+
+void MetalRenderer::create_path_adaptive_buffers()
+{
+    if (_path_tracer.threshold <= 0.0f)
+    {
+        _path_tracer.radiance = nil;
+        _path_tracer.moments = nil;
+        _path_tracer.tiles = nil;
+        _path_tracer.progress = nil;
+        return;
+    }
+
+    const NSUInteger size = _depth_texture.width * _depth_texture.height;
+    const NSUInteger tiles = ((_depth_texture.width + PATH_TRACER_TILE_SIZE - 1) / PATH_TRACER_TILE_SIZE) *
+                             ((_depth_texture.height + PATH_TRACER_TILE_SIZE - 1) / PATH_TRACER_TILE_SIZE);
+    _path_tracer.radiance =
+        [_device newBufferWithLength:size * sizeof(simd_float4) options:MTLResourceStorageModePrivate];
+    _path_tracer.radiance.label = @"PathRadiance";
+    _path_tracer.moments = [_device newBufferWithLength:size * sizeof(float) options:MTLResourceStorageModePrivate];
+    _path_tracer.moments.label = @"PathMoments";
+    _path_tracer.tiles = [_device newBufferWithLength:tiles * sizeof(PathTile) options:MTLResourceStorageModePrivate];
+    _path_tracer.tiles.label = @"PathTiles";
+    // Starts out with render 0, which no render uses.
+    _path_tracer.progress = [_device newBufferWithLength:sizeof(PathProgress) options:MTLResourceStorageModeShared];
+    _path_tracer.progress.label = @"PathProgress";
+    _path_tracer.samples = 0;
+}
+
+PathScene MetalRenderer::upload_path_scene()
+{
+    const std::vector<TracedInstance> &traced_instances = this->traced_instances();
+    PathScene scene;
+    scene.instances = _upload_ring.upload(traced_instances.data(), traced_instances.size());
+    scene.point_lights = _upload_ring.upload(_point_lights.data(), _point_lights.size());
+    scene.spot_lights = _upload_ring.upload(_spot_lights.data(), _spot_lights.size());
+    scene.directional_lights = _upload_ring.upload(_directional_lights.data(), _directional_lights.size());
+    return scene;
+}
+
+void MetalRenderer::set_path_scene(id<MTLComputeCommandEncoder> encoder, unsigned int frame_index,
+                                   const PathScene &scene, id<MTLBuffer> fallback)
+{
+    if (@available(macOS 11.0, *))
+    {
+        use_traced_resources(encoder, frame_index);
+        const auto set_light_buffer = [&](const UploadAllocation &allocation, unsigned int index) {
+            if (allocation.valid())
+                [encoder setBuffer:allocation.buffer offset:allocation.offset atIndex:index];
+            else
+                [encoder setBuffer:fallback offset:0 atIndex:index];
+        };
+
+        [encoder setBuffer:_frames[frame_index].args_buffer offset:0 atIndex:0];
+        [encoder setBuffer:scene.instances.buffer offset:scene.instances.offset atIndex:7];
+        [encoder setBuffer:_vertex_3d_list.index_buffer() offset:0 atIndex:8];
+        set_light_buffer(scene.point_lights, 9);
+        set_light_buffer(scene.spot_lights, 10);
+        set_light_buffer(scene.directional_lights, 11);
+        set_traced_scene(encoder, 12);
+        if (_light_tree != nil)
+        {
+            [encoder setBuffer:_area_light_buffer offset:0 atIndex:14];
+            [encoder setBuffer:_light_tree offset:0 atIndex:15];
+        }
+        else
+        {
+            set_light_buffer(UploadAllocation{}, 14);
+            set_light_buffer(UploadAllocation{}, 15);
+        }
+    }
+}
+
+void MetalRenderer::encode_path_bounces(id<MTLComputeCommandEncoder> encoder, id<MTLBuffer> counters)
+{
+    // Dispatches of a serial encoder see the writes of the previous ones, including the queue sizes the indirect
+    // dispatches read their threadgroup counts from.
+    const MTLSize single = MTLSizeMake(1, 1, 1);
+    const MTLSize group = MTLSizeMake(PATH_TRACER_GROUP_SIZE, 1, 1);
+    for (unsigned int bounce = 0; bounce < PATH_TRACER_BOUNCES; bounce++)
+    {
+        [encoder setBytes:&bounce length:sizeof(bounce) atIndex:13];
+        [encoder setComputePipelineState:_path_tracer.extend];
+        [encoder dispatchThreadgroupsWithIndirectBuffer:counters
+                                   indirectBufferOffset:offsetof(PathCounters, extend)
+                                  threadsPerThreadgroup:group];
+        [encoder setComputePipelineState:_path_tracer.shade];
+        [encoder dispatchThreadgroupsWithIndirectBuffer:counters
+                                   indirectBufferOffset:offsetof(PathCounters, extend)
+                                  threadsPerThreadgroup:group];
+        [encoder setComputePipelineState:_path_tracer.advance];
+        [encoder dispatchThreadgroups:single threadsPerThreadgroup:single];
+        [encoder setComputePipelineState:_path_tracer.shadow];
+        [encoder dispatchThreadgroupsWithIndirectBuffer:counters
+                                   indirectBufferOffset:offsetof(PathCounters, shadow)
+                                  threadsPerThreadgroup:group];
+    }
+}
+
+UploadAllocation MetalRenderer::encode_path_tracing(id<MTLCommandBuffer> command_buffer, unsigned int frame_index,
+                                                    const CameraView3D &view_3d, const mat4 &combined)
+{
+    if (@available(macOS 11.0, *))
+    {
+        const bool adaptive = _path_tracer.threshold > 0.0f && !_path_tracer.denoise;
+        if (_path_tracer.accumulator == nil)
+            create_path_tracer_buffers();
+        if (_path_tracer.denoise && _path_tracer.surfaces[0] == nil)
+            create_path_denoiser_buffers();
+        if (adaptive && _path_tracer.tiles == nil)
+            create_path_adaptive_buffers();
+        // Denoised frames show the sample of this frame alone.
+        if (memcmp(&view_3d, &_path_tracer.view, sizeof(CameraView3D)) != 0 || _path_tracer.denoise)
+        {
+            _path_tracer.view = view_3d;
+            _path_tracer.samples = 0;
+        }
+
+        // Renders stop tracing once they used up their samples or their time, or all of their tiles converged. The
+        // progress the GPU reports lags behind by the frames in flight, tiles that converged trace nothing meanwhile.
+        const auto now = std::chrono::steady_clock::now();
+        if (_path_tracer.samples == 0)
+        {
+            _path_tracer.render++;
+            _path_tracer.started = now;
+            _path_tracer.finished = false;
+        }
+        else if (!_path_tracer.denoise && !_path_tracer.finished)
+        {
+            const float seconds = std::chrono::duration<float>(now - _path_tracer.started).count();
+            const auto *progress =
+                adaptive ? reinterpret_cast<const PathProgress *>(_path_tracer.progress.contents) : nullptr;
+            _path_tracer.finished =
+                (_path_tracer.max_samples != 0 && _path_tracer.samples >= _path_tracer.max_samples) ||
+                (_path_tracer.time_budget > 0.0f && seconds >= _path_tracer.time_budget) ||
+                (progress != nullptr && progress->render == _path_tracer.render && progress->active_tiles == 0);
+            _path_tracer.seconds = seconds;
+        }
+
+        PathTracerUniforms uniforms = {};
+        const mat4 inv_combined = inverse(combined);
+        memcpy(&uniforms.inv_combined, value_ptr(inv_combined), sizeof(mat4));
+        memcpy(&uniforms.previous_combined, value_ptr(_path_tracer.previous_combined), sizeof(mat4));
+        uniforms.camera_position = simd_make_float4(view_3d.pos.x, view_3d.pos.y, view_3d.pos.z, 1.0f);
+        uniforms.width = static_cast<unsigned int>(_depth_texture.width);
+        uniforms.height = static_cast<unsigned int>(_depth_texture.height);
+        uniforms.sample = _path_tracer.samples;
+        uniforms.num_point_lights = static_cast<unsigned int>(_point_lights.size());
+        uniforms.num_spot_lights = static_cast<unsigned int>(_spot_lights.size());
+        uniforms.num_directional_lights = static_cast<unsigned int>(_directional_lights.size());
+        uniforms.num_area_lights = static_cast<unsigned int>(_area_lights.size());
+        uniforms.seed = _path_tracer.traced;
+        uniforms.denoise = _path_tracer.denoise ? 1 : 0;
+        uniforms.history = _path_tracer.history_valid ? 1 : 0;
+        uniforms.adaptive = adaptive ? 1 : 0;
+        uniforms.tiles_x = (uniforms.width + PATH_TRACER_TILE_SIZE - 1) / PATH_TRACER_TILE_SIZE;
+        uniforms.threshold = _path_tracer.threshold;
+        uniforms.min_samples = _path_tracer.min_samples;
+        uniforms.max_samples = _path_tracer.max_samples;
+        uniforms.render = _path_tracer.render;
+
+        const UploadAllocation uniforms_allocation = _upload_ring.upload(&uniforms, 1);
+        const PathScene scene = upload_path_scene();
+        if (!uniforms_allocation.valid() || !scene.instances.valid())
+            return {};
+        // Finished renders only resolve their samples.
+        if (_path_tracer.finished)
+            return uniforms_allocation;
+
+        id<MTLComputeCommandEncoder> encoder = _frame_timer.compute_encoder(command_buffer, FRAME_PASS_LIGHTING);
+        encoder.label = @"PathTracing";
+        // Light arrays that are empty this frame are never read, the uniforms stand in for them.
+        set_path_scene(encoder, frame_index, scene, uniforms_allocation.buffer);
+        [encoder setBuffer:uniforms_allocation.buffer offset:uniforms_allocation.offset atIndex:1];
+        [encoder setBuffer:_path_tracer.paths offset:0 atIndex:2];
+        [encoder setBuffer:_path_tracer.hits offset:0 atIndex:3];
+        [encoder setBuffer:_path_tracer.shadow_rays offset:0 atIndex:4];
+        [encoder setBuffer:_path_tracer.counters offset:0 atIndex:5];
+        [encoder setBuffer:adaptive ? _path_tracer.radiance : _path_tracer.accumulator offset:0 atIndex:6];
+        // First hits are only written while denoising, the accumulator stands in for them.
+        const unsigned int current = _path_tracer.traced % 2;
+        [encoder setBuffer:_path_tracer.denoise ? _path_tracer.surfaces[current] : _path_tracer.accumulator
+                    offset:0
+                   atIndex:16];
+        [encoder setBuffer:adaptive ? _path_tracer.tiles : _path_tracer.accumulator offset:0 atIndex:19];
+
+        const MTLSize single = MTLSizeMake(1, 1, 1);
+        [encoder setComputePipelineState:_path_tracer.begin];
+        [encoder dispatchThreadgroups:single threadsPerThreadgroup:single];
+        [encoder setComputePipelineState:_path_tracer.generate];
+        [encoder dispatchThreadgroups:MTLSizeMake((uniforms.width + 7) / 8, (uniforms.height + 7) / 8, 1)
+                threadsPerThreadgroup:MTLSizeMake(8, 8, 1)];
+        if (adaptive)
+        {
+            [encoder setComputePipelineState:_path_tracer.queue];
+            [encoder dispatchThreadgroups:single threadsPerThreadgroup:single];
+        }
+        encode_path_bounces(encoder, _path_tracer.counters);
+
+        if (adaptive)
+        {
+            const unsigned int tiles_y = (uniforms.height + PATH_TRACER_TILE_SIZE - 1) / PATH_TRACER_TILE_SIZE;
+            [encoder setBuffer:_path_tracer.accumulator offset:0 atIndex:17];
+            [encoder setBuffer:_path_tracer.moments offset:0 atIndex:18];
+            [encoder setBuffer:_path_tracer.progress offset:0 atIndex:20];
+            [encoder setComputePipelineState:_path_tracer.accumulate];
+            [encoder dispatchThreadgroups:MTLSizeMake(uniforms.tiles_x, tiles_y, 1)
+                    threadsPerThreadgroup:MTLSizeMake(PATH_TRACER_TILE_SIZE, PATH_TRACER_TILE_SIZE, 1)];
+            [encoder setComputePipelineState:_path_tracer.finish];
+            [encoder dispatchThreadgroups:single threadsPerThreadgroup:single];
+        }
+
+        // The denoised sample replaces the one in the accumulator.
+        const MTLSize pixels = MTLSizeMake((uniforms.width + 7) / 8, (uniforms.height + 7) / 8, 1);
+        if (_path_tracer.denoise)
+        {
+            [encoder setBuffer:_path_tracer.surfaces[1 - current] offset:0 atIndex:17];
+            [encoder setBuffer:_path_tracer.history[1 - current] offset:0 atIndex:18];
+            [encoder setBuffer:_path_tracer.history[current] offset:0 atIndex:19];
+            [encoder setBuffer:_path_tracer.filtered[0] offset:0 atIndex:20];
+            [encoder setComputePipelineState:_path_tracer.reproject];
+            [encoder dispatchThreadgroups:pixels threadsPerThreadgroup:MTLSizeMake(8, 8, 1)];
+
+            [encoder setComputePipelineState:_path_tracer.filter];
+            for (unsigned int pass = 0; pass < PATH_DENOISER_PASSES; pass++)
+            {
+                const simd_uint2 step = simd_make_uint2(1u << pass, pass + 1 == PATH_DENOISER_PASSES ? 1 : 0);
+                [encoder setBytes:&step length:sizeof(step) atIndex:13];
+                [encoder setBuffer:_path_tracer.filtered[pass % 2] offset:0 atIndex:20];
+                [encoder setBuffer:_path_tracer.filtered[1 - pass % 2] offset:0 atIndex:21];
+                [encoder dispatchThreadgroups:pixels threadsPerThreadgroup:MTLSizeMake(8, 8, 1)];
+            }
+            _path_tracer.history_valid = true;
+            _path_tracer.previous_combined = combined;
+        }
+        [encoder endEncoding];
+
+        _path_tracer.samples++;
+        _path_tracer.traced++;
+        return uniforms_allocation;
+    }
+    return {};
+}
+
+bool MetalRenderer::encode_lightmap_texels(id<MTLCommandBuffer> command_buffer, unsigned int frame_index,
+                                           LightmapBake &bake)
+{
+    const LightmapSettings &settings = bake.settings;
+    MTLTextureDescriptor *desc = [MTLTextureDescriptor texture2DDescriptorWithPixelFormat:MTLPixelFormatRGBA32Float
+                                                                                    width:settings.width
+                                                                                   height:settings.height
+                                                                                mipmapped:NO];
+    desc.usage = MTLTextureUsageRenderTarget | MTLTextureUsageShaderRead;
+    desc.storageMode = MTLStorageModePrivate;
+    bake.positions = [_device newTextureWithDescriptor:desc];
+    desc.pixelFormat = MTLPixelFormatRGBA16Float;
+    bake.normals = [_device newTextureWithDescriptor:desc];
+
+    const NSUInteger texels = settings.width * settings.height;
+    const auto create_buffer = [&](NSUInteger length, NSString *label) {
+        id<MTLBuffer> buffer = [_device newBufferWithLength:length options:MTLResourceStorageModePrivate];
+        buffer.label = label;
+        return buffer;
+    };
+    bake.paths = create_buffer(2 * texels * sizeof(PathState), @"LightmapPaths");
+    bake.hits = create_buffer(texels * sizeof(PathHit), @"LightmapHits");
+    bake.shadow_rays = create_buffer(texels * sizeof(ShadowRay), @"LightmapShadowRays");
+    bake.counters = create_buffer(sizeof(PathCounters), @"LightmapCounters");
+    bake.accumulator = create_buffer(texels * sizeof(simd_float4), @"LightmapAccumulator");
+    bake.filtered[0] = create_buffer(texels * sizeof(simd_float4), @"LightmapFiltered");
+    bake.filtered[1] = create_buffer(texels * sizeof(simd_float4), @"LightmapFiltered");
+    bake.packed = create_buffer(texels * sizeof(uint32_t), @"LightmapPacked");
+    if (bake.positions == nil || bake.normals == nil || bake.paths == nil || bake.hits == nil ||
+        bake.shadow_rays == nil || bake.counters == nil || bake.accumulator == nil || bake.filtered[0] == nil ||
+        bake.filtered[1] == nil || bake.packed == nil)
+    {
+        NSLog(@"Could not allocate the bake of the lightmap of slot %u.", settings.texture);
+        return false;
+    }
+    bake.positions.label = @"LightmapPositions";
+    bake.normals.label = @"LightmapNormals";
+
+    // Texels no triangle covers keep a w of 0.
+    MTLRenderPassDescriptor *pass = [MTLRenderPassDescriptor renderPassDescriptor];
+    pass.colorAttachments[0].texture = bake.positions;
+    pass.colorAttachments[0].loadAction = MTLLoadActionClear;
+    pass.colorAttachments[0].storeAction = MTLStoreActionStore;
+    pass.colorAttachments[0].clearColor = MTLClearColorMake(0.0, 0.0, 0.0, 0.0);
+    pass.colorAttachments[1].texture = bake.normals;
+    pass.colorAttachments[1].loadAction = MTLLoadActionClear;
+    pass.colorAttachments[1].storeAction = MTLStoreActionStore;
+    pass.colorAttachments[1].clearColor = MTLClearColorMake(0.0, 0.0, 0.0, 0.0);
+    _frame_timer.time_render_pass(pass, FRAME_PASS_3D);
+
+    // Charts are laid out in texture space, where the winding of their triangles says nothing about facing.
+    id<MTLRenderCommandEncoder> encoder = [command_buffer renderCommandEncoderWithDescriptor:pass];
+    encoder.label = @"LightmapTexels";
+    [encoder setRenderPipelineState:_lightmap_texel_state];
+    [encoder setCullMode:MTLCullModeNone];
+    use_3d_resources(encoder, frame_index, false);
+    [encoder setVertexBuffer:_frames[frame_index].args_buffer offset:0 atIndex:0];
+    const IdTable<InstanceRange<mat4>> &instances = _instance_3d_list.get_ranges();
+    for (const unsigned int mesh : bake.meshes)
+    {
+        const DrawDescriptor *range = _vertex_3d_list.get_draw_ranges().find(mesh);
+        const auto insts = instances.find(mesh);
+        if (!range || range->start >= range->end || range->jw_end > range->jw_start || !insts || insts->count == 0 ||
+            _packed_meshes.find(mesh) || _impostors.has(mesh))
+        {
+            NSLog(@"Mesh %u has no static vertices of the full format or no instances, it was left out of the "
+                  @"lightmap of slot %u.",
+                  mesh, settings.texture);
+            continue;
+        }
+
+        if (range->index_count > 0)
+        {
+            [encoder drawIndexedPrimitives:MTLPrimitiveTypeTriangle
+                                indexCount:range->index_count
+                                 indexType:(range->short_indices ? MTLIndexTypeUInt16 : MTLIndexTypeUInt32)
+                               indexBuffer:_vertex_3d_list.index_buffer()
+                         indexBufferOffset:range->index_offset
+                             instanceCount:insts->count
+                                baseVertex:range->start
+                              baseInstance:insts->start];
+        }
+        else
+        {
+            [encoder drawPrimitives:MTLPrimitiveTypeTriangle
+                        vertexStart:range->start
+                        vertexCount:(range->end - range->start)
+                      instanceCount:insts->count
+                       baseInstance:insts->start];
+        }
+    }
+    [encoder endEncoding];
+    return true;
+}
+
+bool MetalRenderer::encode_lightmap_bake(id<MTLCommandBuffer> command_buffer, unsigned int frame_index,
+                                         LightmapBake &bake)
+{
+    if (@available(macOS 11.0, *))
+    {
+        if (bake.positions == nil && !encode_lightmap_texels(command_buffer, frame_index, bake))
+            return false;
+
+        // Frames without room for the traced instances try again in the next one.
+        const LightmapSettings &settings = bake.settings;
+        const PathScene scene = upload_path_scene();
+        if (!scene.instances.valid())
+            return true;
+
+        PathTracerUniforms uniforms = {};
+        uniforms.width = settings.width;
+        uniforms.height = settings.height;
+        uniforms.num_point_lights = static_cast<unsigned int>(_point_lights.size());
+        uniforms.num_spot_lights = static_cast<unsigned int>(_spot_lights.size());
+        uniforms.num_directional_lights = static_cast<unsigned int>(_directional_lights.size());
+        uniforms.num_area_lights = static_cast<unsigned int>(_area_lights.size());
+        uniforms.lightmap = 1;
+
+        id<MTLComputeCommandEncoder> encoder = _frame_timer.compute_encoder(command_buffer, FRAME_PASS_LIGHTING);
+        encoder.label = @"LightmapBake";
+        // Lightmaps neither denoise nor sample adaptively, the accumulator stands in for the first hits and the tiles.
+        set_path_scene(encoder, frame_index, scene, bake.accumulator);
+        [encoder setBuffer:bake.paths offset:0 atIndex:2];
+        [encoder setBuffer:bake.hits offset:0 atIndex:3];
+        [encoder setBuffer:bake.shadow_rays offset:0 atIndex:4];
+        [encoder setBuffer:bake.counters offset:0 atIndex:5];
+        [encoder setBuffer:bake.accumulator offset:0 atIndex:6];
+        [encoder setBuffer:bake.accumulator offset:0 atIndex:16];
+        [encoder setBuffer:bake.accumulator offset:0 atIndex:19];
+        [encoder setTexture:bake.positions atIndex:0];
+        [encoder setTexture:bake.normals atIndex:1];
+
+        const MTLSize single = MTLSizeMake(1, 1, 1);
+        const MTLSize texels = MTLSizeMake((settings.width + 7) / 8, (settings.height + 7) / 8, 1);
+        const unsigned int count = std::min(settings.samples_per_frame, settings.samples - bake.samples);
+        for (unsigned int i = 0; i < count; i++, bake.samples++)
+        {
+            uniforms.sample = bake.samples;
+            uniforms.seed = bake.samples;
+            [encoder setBytes:&uniforms length:sizeof(PathTracerUniforms) atIndex:1];
+            [encoder setComputePipelineState:_path_tracer.begin];
+            [encoder dispatchThreadgroups:single threadsPerThreadgroup:single];
+            [encoder setComputePipelineState:_generate_lightmap_state];
+            [encoder dispatchThreadgroups:texels threadsPerThreadgroup:MTLSizeMake(8, 8, 1)];
+            [encoder setComputePipelineState:_path_tracer.queue];
+            [encoder dispatchThreadgroups:single threadsPerThreadgroup:single];
+            encode_path_bounces(encoder, bake.counters);
+        }
+        if (bake.samples < settings.samples)
+        {
+            [encoder endEncoding];
+            return true;
+        }
+
+        // The first pass filters the mean of the accumulated samples, the last one packs the texels.
+        [encoder setComputePipelineState:_filter_lightmap_state];
+        [encoder setBuffer:bake.packed offset:0 atIndex:3];
+        id<MTLBuffer> source = bake.accumulator;
+        for (unsigned int pass = 0; pass < LIGHTMAP_FILTER_PASSES; pass++)
+        {
+            const LightmapFilterUniforms filter = {settings.width, settings.height, 1u << pass,
+                                                   pass + 1 == LIGHTMAP_FILTER_PASSES ? 1u : 0u};
+            [encoder setBytes:&filter length:sizeof(LightmapFilterUniforms) atIndex:0];
+            [encoder setBuffer:source offset:0 atIndex:1];
+            [encoder setBuffer:bake.filtered[pass % 2] offset:0 atIndex:2];
+            [encoder dispatchThreadgroups:texels threadsPerThreadgroup:MTLSizeMake(8, 8, 1)];
+            source = bake.filtered[pass % 2];
+        }
+        [encoder endEncoding];
+
+        // Shaders can't write shared exponent textures on every GPU, the packed texels are copied into one instead.
+        MTLTextureDescriptor *desc = [MTLTextureDescriptor texture2DDescriptorWithPixelFormat:MTLPixelFormatRGB9E5Float
+                                                                                        width:settings.width
+                                                                                       height:settings.height
+                                                                                    mipmapped:NO];
+        desc.usage = MTLTextureUsageShaderRead;
+        desc.storageMode = MTLStorageModePrivate;
+        id<MTLTexture> lightmap = [_device newTextureWithDescriptor:desc];
+        if (lightmap == nil)
+        {
+            NSLog(@"Could not allocate the lightmap of slot %u.", settings.texture);
+            return false;
+        }
+        lightmap.label = @"Lightmap";
+
+        id<MTLBlitCommandEncoder> blit = [command_buffer blitCommandEncoder];
+        blit.label = @"LightmapCopy";
+        [blit copyFromBuffer:bake.packed
+                   sourceOffset:0
+              sourceBytesPerRow:settings.width * sizeof(uint32_t)
+            sourceBytesPerImage:settings.width * settings.height * sizeof(uint32_t)
+                     sourceSize:MTLSizeMake(settings.width, settings.height, 1)
+                      toTexture:lightmap
+               destinationSlice:0
+               destinationLevel:0
+              destinationOrigin:MTLOriginMake(0, 0, 0)];
+        [blit endEncoding];
+
+        // The slot binds the lightmap once frames in flight are done with the texture table.
+        replace_texture_slot(settings.texture);
+        _pending_textures.push_back({settings.texture, lightmap, 0, 0, 0});
+        _standalone_textures.push_back(lightmap);
+        update_texture_residency();
+        _flags |= Flags::UpdateTextures;
+    }
+    return false;
+}
+
+MotionUniforms MetalRenderer::motion_uniforms(const mat4 &combined, vec2 jitter) const
+{
+    MotionUniforms uniforms = {};
+    const mat4 inv_combined = inverse(combined);
+    memcpy(&uniforms.inv_combined, value_ptr(inv_combined), sizeof(mat4));
+    memcpy(&uniforms.previous_combined, value_ptr(_previous_combined), sizeof(mat4));
+    uniforms.jitter_x = jitter.x / static_cast<float>(_depth_texture.width);
+    uniforms.jitter_y = jitter.y / static_cast<float>(_depth_texture.height);
+    uniforms.width = static_cast<unsigned int>(_depth_texture.width);
+    uniforms.height = static_cast<unsigned int>(_depth_texture.height);
+    return uniforms;
+}
+
+id<MTLTexture> MetalRenderer::encode_upscaling(id<MTLCommandBuffer> command_buffer, const mat4 &combined,
+                                               vec2 jitter, bool motion)
+{
+    if (temporal_antialiasing() && motion)
+    {
+        const TaaUniforms uniforms = {static_cast<unsigned int>(_depth_texture.width),
+                                      static_cast<unsigned int>(_depth_texture.height), _taa_reset ? 1u : 0u, 0};
+        id<MTLTexture> history = _taa_history[_taa_index];
+        _taa_index = 1 - _taa_index;
+        id<MTLTexture> resolved = _taa_history[_taa_index];
+
+        id<MTLComputeCommandEncoder> encoder = _frame_timer.compute_encoder(command_buffer, FRAME_PASS_UPSCALE);
+        encoder.label = @"TaaResolve";
+        [encoder setComputePipelineState:_taa_resolve_state];
+        [encoder setTexture:_scaled_color atIndex:0];
+        [encoder setTexture:_motion_vectors atIndex:1];
+        [encoder setTexture:_depth_texture atIndex:2];
+        [encoder setTexture:history atIndex:3];
+        [encoder setTexture:resolved atIndex:4];
+        [encoder setBytes:&uniforms length:sizeof(TaaUniforms) atIndex:0];
+        [encoder dispatchThreadgroups:MTLSizeMake((uniforms.width + 7) / 8, (uniforms.height + 7) / 8, 1)
+                threadsPerThreadgroup:MTLSizeMake(8, 8, 1)];
+        [encoder endEncoding];
+        _taa_reset = false;
+        return resolved;
+    }
+    // The history is stale once a frame was not resolved into it.
+    _taa_reset = true;
+
+#ifdef RFW_METAL_FX
+    if (@available(macOS 13.0, *))
+    {
+        if (temporal_upscaling())
+        {
+            if (!motion)
+            {
+                const MotionUniforms uniforms = motion_uniforms(combined, jitter);
+                id<MTLComputeCommandEncoder> encoder =
+                    _frame_timer.compute_encoder(command_buffer, FRAME_PASS_UPSCALE);
+                encoder.label = @"CameraMotion";
+                [encoder setComputePipelineState:_camera_motion_state];
+                [encoder setTexture:_depth_texture atIndex:0];
+                [encoder setTexture:_motion_vectors atIndex:1];
+                [encoder setBytes:&uniforms length:sizeof(MotionUniforms) atIndex:0];
+                [encoder dispatchThreadgroups:MTLSizeMake((uniforms.width + 7) / 8, (uniforms.height + 7) / 8, 1)
+                        threadsPerThreadgroup:MTLSizeMake(8, 8, 1)];
+                [encoder endEncoding];
+            }
+
+            // Motion vectors are in texture coordinates of the scaled view, the scaler expects them in its pixels.
+            _temporal_scaler.colorTexture = _scaled_color;
+            _temporal_scaler.depthTexture = _depth_texture;
+            _temporal_scaler.motionTexture = _motion_vectors;
+            _temporal_scaler.outputTexture = _upscaled;
+            _temporal_scaler.jitterOffsetX = jitter.x;
+            _temporal_scaler.jitterOffsetY = jitter.y;
+            _temporal_scaler.motionVectorScaleX = static_cast<float>(_depth_texture.width);
+            _temporal_scaler.motionVectorScaleY = static_cast<float>(_depth_texture.height);
+            _temporal_scaler.reset = _upscale_reset;
+            [_temporal_scaler encodeToCommandBuffer:command_buffer];
+            _upscale_reset = false;
+            return _upscaled;
+        }
+    }
+#endif
+    return _scaled_color;
+}
+
+void MetalRenderer::update_post_effects()
+{
+    unsigned int effects = 0;
+    if (_post.bloom_intensity > 0.0f)
+        effects |= POST_BLOOM;
+    if (_grading_lut != nil)
+        effects |= POST_COLOR_GRADING;
+    if (_post.vignette_intensity > 0.0f)
+        effects |= POST_VIGNETTE;
+    if (effects == _post_effects)
+        return;
+
+    // The states frames in flight were encoded with are retired.
+    wait_for_pipelines();
+    _post_effects = effects;
+    for (const PipelineVariant &pipeline : _target_pipelines)
+    {
+        if (pipeline.state != &_upscale_state && pipeline.state != &_rate_mapped_upscale_state)
+            continue;
+        pipeline.desc.fragmentFunction = upscale_function(pipeline.state == &_rate_mapped_upscale_state);
+        _retired.retire(*pipeline.state);
+        _pipelines.create(pipeline.desc, pipeline.state);
+    }
+    create_scaled_targets();
+    invalidate_surface_targets();
+}
+
+id<MTLFunction> MetalRenderer::upscale_function(bool rate_mapped) const
+{
+    NSError *err = nil;
+    MTLFunctionConstantValues *constants = [MTLFunctionConstantValues new];
+    [constants setConstantValue:&rate_mapped type:MTLDataTypeBool atIndex:RATE_MAP_CONSTANT_INDEX];
+    [constants setConstantValue:&_post_effects type:MTLDataTypeUInt atIndex:POST_EFFECTS_CONSTANT_INDEX];
+    id<MTLFunction> function = [_library newFunctionWithName:@"upscale_fragment" constantValues:constants error:&err];
+    MTL_ERROR(err);
+    return function;
+}
+
+id<MTLTexture> MetalRenderer::encode_bloom(id<MTLCommandBuffer> command_buffer, id<MTLTexture> view)
+{
+    // Every level reads the one written by the dispatch before it.
+    id<MTLComputeCommandEncoder> encoder = _frame_timer.compute_encoder(command_buffer, FRAME_PASS_UPSCALE);
+    encoder.label = @"Bloom";
+    const auto dispatch = [&](id<MTLTexture> destination) {
+        [encoder dispatchThreadgroups:MTLSizeMake((destination.width + BLOOM_GROUP_SIZE - 1) / BLOOM_GROUP_SIZE,
+                                                  (destination.height + BLOOM_GROUP_SIZE - 1) / BLOOM_GROUP_SIZE, 1)
+                threadsPerThreadgroup:MTLSizeMake(BLOOM_GROUP_SIZE, BLOOM_GROUP_SIZE, 1)];
+    };
+
+    [encoder setComputePipelineState:_bloom_downsample_state];
+    const BloomUniforms prefilter = {_post.bloom_threshold, _post.bloom_threshold * 0.5f, 1, 0};
+    const BloomUniforms downsample = {0.0f, 0.0f, 0, 0};
+    for (size_t i = 0; i < _bloom_down.size(); i++)
+    {
+        [encoder setTexture:i == 0 ? view : _bloom_down[i - 1] atIndex:0];
+        [encoder setTexture:_bloom_down[i] atIndex:1];
+        [encoder setBytes:i == 0 ? &prefilter : &downsample length:sizeof(BloomUniforms) atIndex:0];
+        dispatch(_bloom_down[i]);
+    }
+
+    [encoder setComputePipelineState:_bloom_upsample_state];
+    for (size_t i = _bloom_up.size(); i-- > 0;)
+    {
+        [encoder setTexture:i + 1 == _bloom_up.size() ? _bloom_down[i + 1] : _bloom_up[i + 1] atIndex:0];
+        [encoder setTexture:_bloom_down[i] atIndex:1];
+        [encoder setTexture:_bloom_up[i] atIndex:2];
+        dispatch(_bloom_up[i]);
+    }
+    [encoder endEncoding];
+    return _bloom_up.empty() ? _bloom_down.front() : _bloom_up.front();
+}
+
+void MetalRenderer::mark_instances_moved(unsigned int id)
+{
+    if (_shadow_casters.has(id))
+        _moved_casters.push_back(id);
+    if (_submeshes.has(id))
+        _moved_submeshes.push_back(id);
+    if (!_probes.empty())
+        _probe_moved.push_back(id);
+    if (const std::vector<unsigned int> *members = _prefab_members.find(id))
+    {
+        for (const unsigned int member : *members)
+            mark_instances_moved(member);
+    }
+}
+
+void MetalRenderer::mark_instances_transformed(unsigned int id, unsigned int first, unsigned int last)
+{
+    if (!_bvh_all_transformed && first < last)
+    {
+        _bvh_all_transformed = _bvh_transformed.size() >= INSTANCE_BVH_MAX_CHANGES;
+        if (_bvh_all_transformed)
+            _bvh_transformed.clear();
+        else
+            _bvh_transformed.emplace_back(id, first, last);
+    }
+    _acceleration_structures.mark_transformed(id, first, last);
+    if (const std::vector<unsigned int> *members = _prefab_members.find(id))
+    {
+        for (const unsigned int member : *members)
+            _acceleration_structures.mark_transformed(member, first, last);
+    }
+}
+
+void MetalRenderer::remove_caster(unsigned int id)
+{
+    const Aabb *bounds = _shadow_casters.find(id);
+    if (!bounds)
+        return;
+
+    if (_shadow_distance > 0.0f)
+        _shadow_dirty_bounds.push_back(*bounds);
+    _shadow_casters.erase(id);
+}
+
+void MetalRenderer::update_shadow_casters(bool shadows)
+{
+    for (const unsigned int id : _moved_casters)
+    {
+        Aabb *bounds = _shadow_casters.find(id);
+        if (!bounds)
+            continue;
+
+        // Both where the caster was and where it is now need their shadows redrawn.
+        if (shadows)
+            _shadow_dirty_bounds.push_back(*bounds);
+        // Animated instances are only transformed on the GPU, their shadows are redrawn wherever they may be.
+        const Aabb local = id < _instance_3d_bounds.size() ? _instance_3d_bounds[id] : Aabb{};
+        const bool has_matrices = id < _instance_3d_matrices.size() && _instance_3d_matrices[id];
+        if (transformed_on_gpu(id))
+            *bounds = {simd_make_float4(-1e30f, -1e30f, -1e30f, 0.0f), simd_make_float4(1e30f, 1e30f, 1e30f, 0.0f)};
+        else
+            *bounds = has_matrices ? world_bounds(local, *_instance_3d_matrices[id]) : empty_bounds();
+        if (shadows)
+            _shadow_dirty_bounds.push_back(*bounds);
+    }
+    _moved_casters.clear();
+
+    // Changes are not tracked while no shadows are drawn, every view is redrawn once they are again.
+    if (!shadows)
+    {
+        _shadow_dirty_bounds.clear();
+        for (ShadowView &view : _cascade_views)
+            view.valid = false;
+        for (ShadowView &view : _spot_views)
+            view.valid = false;
+    }
+}
+
+std::vector<ShadowPass> MetalRenderer::update_shadow_views(const CameraView3D &view_3d, const mat4 &view,
+                                                           ShadowUniforms &uniforms)
+{
+    std::vector<ShadowPass> passes;
+    const auto update_view = [&](ShadowView &cached, const mat4 &matrix, bool cascade, unsigned int layer) {
+        bool redraw = !cached.valid || cached.matrix != matrix;
+        const std::array<vec4, 6> planes = frustum_planes(matrix);
+        for (size_t i = 0; !redraw && i < _shadow_dirty_bounds.size(); i++)
+            redraw = intersects(planes, _shadow_dirty_bounds[i]);
+
+        cached.matrix = matrix;
+        cached.valid = true;
+        if (redraw)
+            passes.push_back({matrix, cascade, layer});
+    };
+
+    // Every cascade covers the bounding sphere of its slice of the view frustum, so its size does not change when the
+    // camera turns. Its center is snapped to whole shadow map texels, the shadows then stay put while the camera moves.
+    for (ShadowView &cached : _cascade_views)
+        cached.valid = cached.valid && !_directional_lights.empty();
+    if (!_directional_lights.empty())
+    {
+        const DirectionalLight &light = _directional_lights[0];
+        const vec3 direction = normalize(vec3(light.direction_x, light.direction_y, light.direction_z));
+        const vec3 up = std::abs(direction.y) > 0.99f ? vec3(1, 0, 0) : vec3(0, 1, 0);
+        const mat4 light_view = lookAtRH(vec3(0.0f), direction, up);
+        const mat4 inv_view = inverse(view);
+
+        const float tan_y = std::tan(0.5f * view_3d.fov);
+        const float tan_x = tan_y * view_3d.inv_height / view_3d.inv_width;
+        const float near_plane = view_3d.near_plane;
+        const float far_plane = std::max(std::min(_shadow_distance, view_3d.far_plane), near_plane);
+
+        float start = near_plane;
+        for (unsigned int c = 0; c < SHADOW_CASCADES; c++)
+        {
+            // Splits blend logarithmic and uniform distribution, logarithmic splits keep the texel density even.
+            const float t = static_cast<float>(c + 1) / SHADOW_CASCADES;
+            const float end = mix(near_plane + (far_plane - near_plane) * t,
+                                  near_plane * std::pow(far_plane / near_plane, t), 0.75f);
+
+            vec3 corners[8];
+            vec3 center = vec3(0.0f);
+            for (unsigned int i = 0; i < 8; i++)
+            {
+                const float depth = (i & 4) != 0 ? end : start;
+                const vec4 corner = vec4(((i & 1) != 0 ? tan_x : -tan_x) * depth,
+                                         ((i & 2) != 0 ? tan_y : -tan_y) * depth, -depth, 1.0f);
+                corners[i] = vec3(inv_view * corner);
+                center += corners[i] / 8.0f;
+            }
+
+            float radius = 0.0f;
+            for (const vec3 &corner : corners)
+                radius = std::max(radius, length(corner - center));
+            radius = std::ceil(radius * 16.0f) / 16.0f;
+
+            const float texel = 2.0f * radius / static_cast<float>(_cascade_shadows.width);
+            vec3 light_center = vec3(light_view * vec4(center, 1.0f));
+            light_center.x = std::floor(light_center.x / texel) * texel;
+            light_center.y = std::floor(light_center.y / texel) * texel;
+
+            // Casters up to the shadow distance towards the light still cast into the cascade.
+            const mat4 projection =
+                orthoRH(light_center.x - radius, light_center.x + radius, light_center.y - radius,
+                        light_center.y + radius, -light_center.z - radius - _shadow_distance, -light_center.z + radius);
+            const mat4 matrix = projection * light_view;
+
+            memcpy(&uniforms.cascades[c], value_ptr(matrix), sizeof(mat4));
+            uniforms.cascade_ends[c] = end;
+            update_view(_cascade_views[c], matrix, true, c);
+            start = end;
+        }
+        uniforms.num_cascades = SHADOW_CASCADES;
+    }
+
+    // Spot lights cover their outer cone up to their range.
+    const auto num_spot_shadows = static_cast<unsigned int>(std::min<size_t>(_spot_lights.size(), MAX_SPOT_SHADOWS));
+    for (unsigned int i = num_spot_shadows; i < MAX_SPOT_SHADOWS; i++)
+        _spot_views[i].valid = false;
+    for (unsigned int i = 0; i < num_spot_shadows; i++)
+    {
+        const SpotLight &light = _spot_lights[i];
+        const vec3 position = vec3(light.pos_x, light.pos_y, light.pos_z);
+        const vec3 direction = normalize(vec3(light.direction_x, light.direction_y, light.direction_z));
+        const vec3 up = std::abs(direction.y) > 0.99f ? vec3(1, 0, 0) : vec3(0, 1, 0);
+        // Matches light_range in the shaders.
+        const float max_radiance = std::max(light.radiance_r, std::max(light.radiance_g, light.radiance_b));
+        const float range = std::max(std::sqrt(max_radiance * 256.0f), 0.1f);
+        const float fov = std::min(2.0f * std::acos(std::clamp(light.cos_outer, -1.0f, 1.0f)), radians(170.0f));
+
+        const mat4 matrix = perspectiveRH(fov, 1.0f, std::max(range * 1e-3f, 0.01f), range) *
+                            lookAtRH(position, position + direction, up);
+        memcpy(&uniforms.spot_lights[i], value_ptr(matrix), sizeof(mat4));
+        update_view(_spot_views[i], matrix, false, i);
+    }
+    uniforms.num_spot_shadows = num_spot_shadows;
+
+    // The slope of a surface is covered by the depth bias of the shadow passes, these only cover depth precision.
+    uniforms.cascade_bias = 5e-4f;
+    // Perspective depth in 16 bits loses most of its precision away from the light.
+    uniforms.spot_bias = _unorm16_shadows ? 2e-4f : 5e-5f;
+
+    _shadow_dirty_bounds.clear();
+    return passes;
+}
+
+void MetalRenderer::encode_shadows(id<MTLCommandBuffer> command_buffer, unsigned int frame_index,
+                                   const std::vector<ShadowPass> &passes, bool culled, unsigned int visible_offset)
+{
+    const unsigned int total = _culling.visible_count;
+    std::vector<UploadAllocation> draw_args(passes.size());
+    std::vector<UploadAllocation> cameras(passes.size());
+    for (size_t i = 0; i < passes.size(); i++)
+    {
+        if (culled)
+        {
+            draw_args[i] = encode_view_culling(command_buffer, frame_index, passes[i].matrix,
+                                               visible_offset + static_cast<unsigned int>(i) * total);
+        }
+
+        Uniforms camera = {};
+        memcpy(&camera.combined, value_ptr(passes[i].matrix), sizeof(mat4));
+        cameras[i] = _upload_ring.upload(&camera, 1);
+    }
+
+    const auto begin_pass = [&](id<MTLTexture> texture, unsigned int slice, MTLLoadAction load, NSString *label) {
+        MTLRenderPassDescriptor *desc = pass_descriptor(ShadowPass);
+        desc.depthAttachment.texture = texture;
+        desc.depthAttachment.slice = slice;
+        desc.depthAttachment.clearDepth = 1.0;
+        desc.depthAttachment.loadAction = load;
+        desc.depthAttachment.storeAction = MTLStoreActionStore;
+        _frame_timer.time_render_pass(desc, FRAME_PASS_SHADOWS);
+
+        id<MTLRenderCommandEncoder> encoder = [command_buffer renderCommandEncoderWithDescriptor:desc];
+        encoder.label = label;
+        [encoder setFrontFacingWinding:MTLWindingCounterClockwise];
+        [encoder setTriangleFillMode:MTLTriangleFillModeFill];
+        // Keeps surfaces at grazing angles to the light from shadowing themselves.
+        [encoder setDepthBias:0.0f slopeScale:2.0f clamp:0.0f];
+        use_3d_resources(encoder, frame_index, culled);
+        [encoder setVertexBuffer:_frames[frame_index].args_buffer offset:0 atIndex:0];
+        return encoder;
+    };
+
+    const bool positions = _vertex_3d_list.position_buffer() != nil;
+    const Pipelines3D &depth_states =
+        _unorm16_shadows ? (positions ? _unorm16_position_shadow_state_3d : _unorm16_shadow_state_3d)
+                         : (positions ? _position_prepass_state_3d : _prepass_state_3d);
+    const auto draw_casters = [&](id<MTLRenderCommandEncoder> encoder, size_t i) {
+        [encoder setDepthStencilState:_standard_depth_state];
+        [encoder setCullMode:MTLCullModeBack];
+        [encoder setVertexBuffer:cameras[i].buffer offset:cameras[i].offset atIndex:1];
+        encode_3d_draws(encoder, depth_states, draw_args[i], NSMakeRange(0, 0), true, ShadowCasters);
+    };
+
+    // Cascades are layers of their own, the spot shadows share the atlas and are drawn in one pass.
+    id<MTLRenderCommandEncoder> atlas = nil;
+    for (size_t i = 0; i < passes.size(); i++)
+    {
+        const ShadowPass &pass = passes[i];
+        if (pass.cascade)
+        {
+            id<MTLRenderCommandEncoder> encoder =
+                begin_pass(_cascade_shadows, pass.layer, MTLLoadActionClear, @"CascadeShadows");
+            draw_casters(encoder, i);
+            [encoder endEncoding];
+            continue;
+        }
+
+        if (atlas == nil)
+            atlas = begin_pass(_spot_shadows, 0, MTLLoadActionLoad, @"SpotShadows");
+
+        // The tiles that are not redrawn keep their shadows, so only this tile gets cleared.
+        const NSUInteger size = SPOT_SHADOW_ATLAS_SIZE / SPOT_SHADOW_TILES_PER_ROW;
+        const NSUInteger x = (pass.layer % SPOT_SHADOW_TILES_PER_ROW) * size;
+        const NSUInteger y = (pass.layer / SPOT_SHADOW_TILES_PER_ROW) * size;
+        [atlas setViewport:(MTLViewport){static_cast<double>(x), static_cast<double>(y), static_cast<double>(size),
+                                         static_cast<double>(size), 0.0, 1.0}];
+        [atlas setScissorRect:(MTLScissorRect){x, y, size, size}];
+        [atlas setRenderPipelineState:_unorm16_shadows ? _unorm16_shadow_clear_state : _shadow_clear_state];
+        [atlas setDepthStencilState:_depth_state_clear];
+        [atlas setCullMode:MTLCullModeNone];
+        [atlas drawPrimitives:MTLPrimitiveTypeTriangle vertexStart:0 vertexCount:3];
+        draw_casters(atlas, i);
+    }
+    [atlas endEncoding];
+}
+
+FrameStatus MetalRenderer::render(mat4 matrix_2d, CameraView3D view_3d, RenderMode3D mode, ReadbackCallback callback,
+                                  void *user_data)
+{
+    wait_for_synchronize();
+    wait_for_pipelines();
+    if (_scene_encoder == nil || _device_status == DEVICE_REMOVED)
+        return FRAME_SKIPPED;
+    // Idle frames neither wait for a frame in flight nor a drawable, the layer keeps showing the last one.
+    if (_on_demand && callback == nullptr && !frame_needed(matrix_2d, view_3d, mode))
+        return FRAME_IDLE;
+    const auto start = std::chrono::steady_clock::now();
+
+    if (_dynamic_resolution.enabled() && _frame_timer.resolved() != _resolution_frame)
+    {
+        _resolution_frame = _frame_timer.resolved();
+        set_render_scale(_dynamic_resolution.update(_frame_timer.stats().frame_ms, _render_scale));
+    }
+    if (_quality.update())
+        apply_quality_level();
+    if (_targets_dirty)
+    {
+        acquire_all_frames();
+        create_render_targets();
+        release_all_frames();
+    }
+
+    const os_signpost_id_t signpost = signpost_id();
+    os_signpost_interval_begin(signpost_log(), signpost, "render", "mode %u", static_cast<unsigned int>(mode));
+    TraceSpan span(_trace, "render");
+    os_signpost_interval_begin(signpost_log(), signpost, "wait_for_frame");
+    const uint64_t wait_start = TraceRecorder::now();
+    const dispatch_time_t frame_deadline =
+        _frame_timeout < 0.0 ? DISPATCH_TIME_FOREVER
+                             : dispatch_time(DISPATCH_TIME_NOW, static_cast<int64_t>(_frame_timeout * NSEC_PER_SEC));
+    const bool acquired = dispatch_semaphore_wait(_sem, frame_deadline) == 0;
+    os_signpost_interval_end(signpost_log(), signpost, "wait_for_frame");
+    _trace.add_cpu("wait_for_frame", wait_start, TraceRecorder::now());
+    if (!acquired)
+    {
+        os_signpost_interval_end(signpost_log(), signpost, "render", "no frame");
+        return FRAME_SKIPPED;
+    }
+
+    _cells.observe_camera(simd_make_float3(view_3d.pos.x, view_3d.pos.y, view_3d.pos.z),
+                          std::chrono::duration<double>(start.time_since_epoch()).count());
+    _uploads.begin_frame();
+
+    // The GPU is done with this frame's resources, so they can be safely overwritten.
+    _retired.release(_frame_event.signaledValue);
+    const unsigned int frame_index = _frame_index;
+    FrameResources &frame = _frames[frame_index];
+    _upload_ring.begin_frame(frame_index);
+    _instance_3d_list.update_frame(_device, frame_index);
+    _instance_overrides.update_frame(_device, frame_index, _instance_3d_list);
+    update_frame_materials(frame_index);
+    _instance_2d_list.update_frame(_device, frame_index);
+    _glyph_list.update_frame(_device, frame_index);
+    _sprite_list.update_frame(_device, frame_index);
+    _frame_timer.begin_frame(frame_index);
+    MeshProfiler *const mesh_profiler = _mesh_profiler.enabled() ? &_mesh_profiler : nullptr;
+    if (mesh_profiler)
+        mesh_profiler->begin_frame(frame_index);
+    read_texture_feedback(frame);
+    update_virtual_pages(frame);
+    _frames_rendered++;
+    _retired.set_frame(_frames_rendered);
+    _gpu_capture.begin_frame(_device, _frames_rendered);
+
+    // Tiled forward lighting shades with the lights of each screen tile, the tiles get their depth range from a depth
+    // pre-pass of the 3D geometry. Shadows are only drawn while there are lights.
+    const bool has_3d = !_instance_3d_list.get_ranges().empty();
+    // Path tracing replaces all rasterized 3D passes.
+    const bool path_tracing = mode == RENDER_PATH_TRACED && _ray_tracing_supported && has_3d;
+    // The irradiance volume is updated and lights the scene in the rasterized views, once every probe was traced.
+    const bool gi_volume = _gi.volume.count_x != 0 && has_3d && !path_tracing;
+    const bool gi_lit = gi_volume && _gi.updated >= _gi.volume.count_x * _gi.volume.count_y * _gi.volume.count_z;
+    // Lightmaps are baked a batch of samples per frame, whatever the views show.
+    const bool lightmap_bake = !_lightmap_bakes.empty() && has_3d;
+    // Temporal frames draw motion vectors in the pre-pass, the path tracer converges without them.
+    const bool taa = temporal_antialiasing() && has_3d && !path_tracing;
+    const bool motion = (taa || temporal_upscaling()) && has_3d && !path_tracing;
+
+    const mat4 unjittered_projection = get_rh_projection_matrix(view_3d);
+    const mat4 view = get_rh_view_matrix(view_3d);
+    const mat4 unjittered_combined = unjittered_projection * view;
+    // Temporal frames gather detail from another sub-pixel offset of the projection every frame, with more offsets the
+    // more pixels every scaled pixel covers.
+    mat4 projection = unjittered_projection;
+    vec2 jitter = vec2(0.0f);
+    if (taa || temporal_upscaling())
+    {
+        const auto phases = static_cast<unsigned int>(std::ceil(8.0f / (render_scale() * render_scale())));
+        _jitter_index = (_jitter_index + 1) % phases;
+        jitter = vec2(halton(_jitter_index + 1, 2), halton(_jitter_index + 1, 3)) - 0.5f;
+        const vec2 offset = 2.0f * jitter / vec2(_depth_texture.width, _depth_texture.height);
+        projection = translate(mat4(1.0f), vec3(offset.x, -offset.y, 0.0f)) * projection;
+    }
+    const mat4 combined = projection * view;
+    const bool lighting = !(_point_lights.empty() && _spot_lights.empty() && _directional_lights.empty() &&
+                            _area_lights.empty()) &&
+                          has_3d && !path_tracing;
+    const bool shadows = lighting && _shadow_distance > 0.0f;
+    for (const auto &[id, animator] : _instance_animations)
+    {
+        if (_shadow_casters.has(id))
+            _moved_casters.push_back(id);
+    }
+    for (const unsigned int id : _hierarchy.meshes)
+    {
+        if (_shadow_casters.has(id))
+            _moved_casters.push_back(id);
+    }
+    for (const auto &[id, scatter] : _scatters)
+    {
+        if (_shadow_casters.has(id))
+            _moved_casters.push_back(id);
+    }
+    update_shadow_casters(shadows);
+    ShadowUniforms shadow_uniforms = {};
+    const std::vector<ShadowPass> shadow_passes =
+        shadows ? update_shadow_views(view_3d, view, shadow_uniforms) : std::vector<ShadowPass>();
+
+    const bool culling = _gpu_culling && _instance_3d_list.total() > 0 && !path_tracing;
+    const bool occlusion = culling && _occlusion_culling && !_cpu_culling;
+    // The instances found visible by the late occlusion culling phase follow those of the early phase, those of the
+    // redrawn shadow views come last.
+    const size_t visible_lists = (occlusion ? 2 : 1) + shadow_passes.size();
+    const size_t visible_size = culled_instance_count() * sizeof(unsigned int) * visible_lists;
+    id<MTLBuffer> &visible = _cpu_culling ? _frames[frame_index].visible_instances : _visible_instances;
+    if (culling && (visible == nil || visible.length < visible_size))
+    {
+        // GPU-only and shared by all frames, Metal orders the writes of a frame after the reads of the previous one.
+        // The CPU writes a list of every frame, which frames in flight no longer read once this one got its slot.
+        const unsigned int length = next_multiple_of(static_cast<unsigned int>(visible_size), 65536);
+        const MTLResourceOptions options = _cpu_culling
+                                               ? MTLResourceStorageModeShared | MTLResourceCPUCacheModeWriteCombined
+                                               : MTLResourceStorageModePrivate;
+        _retired.retire(visible);
+        visible = [_device newBufferWithLength:length options:options];
+        visible.label = @"VisibleInstances";
+    }
+
+    // Flags are kept by the slot an instance is culled in, the meshes of a prefab cull its instances in slots of
+    // their own.
+    const size_t occluded_size = culled_instance_count() * sizeof(unsigned int);
+    if (occlusion && (_occluded_instances == nil || _occluded_instances.length < occluded_size))
+    {
+        const unsigned int length = next_multiple_of(static_cast<unsigned int>(occluded_size), 65536);
+        _retired.retire(_occluded_instances);
+        _occluded_instances = [_device newBufferWithLength:length options:MTLResourceStorageModePrivate];
+        _occluded_instances.label = @"OccludedInstances";
+    }
+
+    const UploadAllocation uniforms_allocation = _upload_ring.allocate(sizeof(Uniforms));
+    auto *uniforms = reinterpret_cast<Uniforms *>(uniforms_allocation.data);
+    if (uniforms)
+    {
+        // 3D vertices are transformed relative to the camera, built without the translation the absolute matrices
+        // would lose precision to far from the world origin.
+        const mat4 view_rotation = get_rh_view_rotation(view_3d);
+        const mat4 relative_combined = projection * view_rotation;
+        memcpy(&uniforms->projection, value_ptr(projection), sizeof(mat4));
+        memcpy(&uniforms->view_matrix, value_ptr(view_rotation), sizeof(mat4));
+        memcpy(&uniforms->combined, value_ptr(relative_combined), sizeof(mat4));
+        memcpy(&uniforms->matrix_2d, value_ptr(matrix_2d), sizeof(mat4));
+        uniforms->origin = simd_make_float4(view_3d.pos.x, view_3d.pos.y, view_3d.pos.z, 0.0f);
+        uniforms->view = view_3d;
+
+        // Moves the previous view from its own camera position to this one.
+        const vec3 origin = vec3(view_3d.pos.x, view_3d.pos.y, view_3d.pos.z);
+        const mat4 previous_combined = _previous_relative_combined * translate(mat4(1.0f), origin - _previous_origin);
+        memcpy(&uniforms->previous_combined, value_ptr(previous_combined), sizeof(mat4));
+        uniforms->jitter = simd_make_float4(jitter.x / static_cast<float>(_depth_texture.width),
+                                            jitter.y / static_cast<float>(_depth_texture.height), 0.0f, 0.0f);
+    }
+
+    // Layer frames acquire their drawable once everything up to the first pass that draws into it is encoded.
+    id<CAMetalDrawable> drawable = nil;
+    // Headless frames of a video stream render straight into a buffer of the encoder, drawables are copied into one at
+    // the end of the frame. Extended range frames are not streamed.
+    VideoStreamFrame stream_frame;
+    if (_video_stream.active() && target_format() == MTLPixelFormatBGRA8Unorm)
+    {
+        const CGSize size = drawable_size();
+        stream_frame = _video_stream.acquire(static_cast<unsigned int>(std::max(size.width, 1.0)),
+                                             static_cast<unsigned int>(std::max(size.height, 1.0)));
+    }
+    bool streamed = false;
+    id<MTLTexture> target = _layer != nil          ? nil
+                            : stream_frame.valid() ? stream_frame.texture
+                                                   : offscreen_target(frame);
+
+    MTLRenderPassDescriptor *render_desc = pass_descriptor(MainPass);
+
+    render_desc.depthAttachment.clearDepth = 0.0;
+    render_desc.depthAttachment.storeAction = MTLStoreActionStore;
+    render_desc.depthAttachment.loadAction = MTLLoadActionClear;
+    render_desc.depthAttachment.texture = _depth_texture;
+
+    // Scaled and HDR frames draw 2D in the overlay pass that upscales or tonemaps the 3D view into the drawable.
+    const bool scaled = _scaled_color != nil;
+    render_desc.colorAttachments[0].texture = scaled ? _scaled_color : target;
+    render_desc.colorAttachments[0].loadAction = MTLLoadActionClear;
+    render_desc.colorAttachments[0].storeAction = MTLStoreActionStore;
+    render_desc.colorAttachments[0].clearColor = MTLClearColorMake(0.0, 0.0, 0.0, 1.0);
+
+    // The G-buffer is written and resolved within the main pass, so it never leaves tile memory.
+    const bool occlusion_view = mode == RENDER_SSAO || mode == RENDER_FILTERED_SSAO;
+    // The overdraw view counts the fragments of all 3D meshes in a pass of its own and shows them over the 3D pass.
+    const bool overdraw_view = mode == RENDER_OVERDRAW && has_3d;
+    const bool deferred = _tile_memory && mode != RENDER_DEFAULT && !occlusion_view && mode != RENDER_PATH_TRACED &&
+                          mode != RENDER_OVERDRAW;
+    // Views of the G-buffer contents only show the opaque meshes.
+    const bool transparency = (!_transparent_meshes.empty() || !_particle_systems.empty()) && has_3d &&
+                              !path_tracing && !occlusion_view && !overdraw_view && mode != RENDER_NORMAL &&
+                              mode != RENDER_ALBEDO;
+    // Views that draw a full screen triangle over the 3D pass are not antialiased, nor are the deferred ones or those
+    // below the drawable size. Temporally antialiased frames are not multisampled either.
+    const bool resized = render_scale() < 1.0f || _rate_map != nil;
+    const bool msaa =
+        _msaa_color != nil && !deferred && !occlusion_view && !overdraw_view && !path_tracing && !resized && !taa;
+    if (msaa)
+    {
+        render_desc.colorAttachments[0].resolveTexture = render_desc.colorAttachments[0].texture;
+        render_desc.colorAttachments[0].texture = _msaa_color;
+        render_desc.colorAttachments[0].storeAction = MTLStoreActionMultisampleResolve;
+        render_desc.depthAttachment.texture = _msaa_depth;
+        render_desc.depthAttachment.storeAction = MTLStoreActionDontCare;
+    }
+    if (deferred)
+    {
+        for (unsigned int i = 0; i < _gbuffer.size(); i++)
+        {
+            MTLRenderPassColorAttachmentDescriptor *attachment = render_desc.colorAttachments[GBUFFER_ALBEDO_INDEX + i];
+            attachment.texture = _gbuffer[i];
+            attachment.loadAction = MTLLoadActionClear;
+            attachment.storeAction = MTLStoreActionDontCare;
+            attachment.clearColor = MTLClearColorMake(0.0, 0.0, 0.0, 0.0);
+        }
+        // Cleared to the far plane so the resolve can tell pixels without geometry.
+        render_desc.colorAttachments[GBUFFER_DEPTH_INDEX].clearColor = MTLClearColorMake(0.0, 0.0, 0.0, 0.0);
+    }
+
+    // Retaining thousands of bound textures every frame is left out, the renderer retires what it drops instead.
+    id<MTLCommandBuffer> command_buffer = [_queue commandBufferWithUnretainedReferences];
+    command_buffer.label = [NSString stringWithFormat:@"Frame %u", frame_index];
+    id<MTLCommandBuffer> first_command_buffer = command_buffer;
+    _frame_timer.sample_frame_start(command_buffer);
+    // Drawables can't be read back, the readback buffer of the frame is only reused once the callback returned.
+    const bool readback = callback && _layer == nil;
+    if (readback)
+    {
+        const NSUInteger size = target.width * 4 * target.height;
+        if (frame.readback == nil || frame.readback.length < size)
+        {
+            frame.readback = [_device newBufferWithLength:size options:MTLResourceStorageModeShared];
+            frame.readback.label = @"Readback";
+        }
+    }
+
+    // Signalled once the 3D passes of the frame are done with the geometry, or with the frame when they are skipped.
+    const bool async_compute = _async_compute;
+    bool geometry_released = !async_compute;
+    const auto release_geometry = [&]() {
+        if (!geometry_released)
+            [command_buffer encodeSignalEvent:_geometry_event value:++_geometry_value];
+        geometry_released = true;
+    };
+
+    // Commits the last command buffer of the frame. Command buffers of the queue complete in the order they were
+    // committed and handlers in the order they were added, so the frame's samples are resolved before its slot is
+    // released.
+    const auto submit = [&]() {
+        _frame_timer.sample_frame_end(command_buffer);
+        FrameTimer *timer = &_frame_timer;
+        GpuCapture *gpu_capture = &_gpu_capture;
+        id<MTLCommandBuffer> first = first_command_buffer;
+        [command_buffer addCompletedHandler:^(id<MTLCommandBuffer> completed) {
+          timer->resolve(frame_index, first, completed);
+          gpu_capture->frame_completed(timer->stats().frame_ms);
+          if (mesh_profiler)
+              mesh_profiler->resolve(frame_index);
+        }];
+        if (readback)
+        {
+            id<MTLBuffer> buffer = frame.readback;
+            const auto width = static_cast<unsigned int>(target.width);
+            const auto height = static_cast<unsigned int>(target.height);
+            [command_buffer addCompletedHandler:^(id<MTLCommandBuffer> completed) {
+              const bool failed = completed.status != MTLCommandBufferStatusCompleted;
+              callback(user_data, failed ? nullptr : reinterpret_cast<const unsigned char *>(buffer.contents), width,
+                       height, width * 4);
+            }];
+        }
+        else if (callback)
+        {
+            [command_buffer addCompletedHandler:^(id<MTLCommandBuffer>) {
+              callback(user_data, nullptr, 0, 0, 0);
+            }];
+        }
+        if (streamed)
+        {
+            VideoStream *stream = &_video_stream;
+            const VideoStreamFrame encoded = stream_frame;
+            const auto timestamp_us = static_cast<uint64_t>(
+                std::chrono::duration_cast<std::chrono::microseconds>(start.time_since_epoch()).count());
+            [command_buffer addCompletedHandler:^(id<MTLCommandBuffer> completed) {
+              if (completed.status == MTLCommandBufferStatusCompleted)
+                  stream->encode(encoded, timestamp_us);
+            }];
+        }
+        // Failed frames signal their number as well, so waits for them return.
+        const uint64_t frame_number = _frames_rendered;
+        id<MTLSharedEvent> frame_event = _frame_event;
+        [command_buffer encodeSignalEvent:frame_event value:frame_number];
+        __block dispatch_semaphore_t semaphore = _sem;
+        [command_buffer addCompletedHandler:^(id<MTLCommandBuffer> completed) {
+          if (completed.status == MTLCommandBufferStatusError && frame_event.signaledValue < frame_number)
+              frame_event.signaledValue = frame_number;
+          dispatch_semaphore_signal(semaphore);
+        }];
+
+        release_geometry();
+        _upload_ring.end_frame();
+        if (drawable != nil)
+        {
+            present(command_buffer, drawable);
+            _retired.retire(drawable);
+        }
+        [command_buffer commit];
+        _gpu_capture.end_frame();
+        _frame_index = (_frame_index + 1) % static_cast<unsigned int>(_frames.size());
+    };
+
+    // The work encoded so far runs on the GPU while the compositor hands out the drawable, the rest of the frame
+    // goes into a command buffer of its own. Frames without a drawable still complete that work.
+    const auto acquire_target = [&]() {
+        if (_layer == nil)
+            return true;
+
+        [command_buffer commit];
+        command_buffer = [_queue commandBufferWithUnretainedReferences];
+        command_buffer.label = [NSString stringWithFormat:@"Frame %u Present", frame_index];
+        os_signpost_interval_begin(signpost_log(), signpost, "nextDrawable");
+        const uint64_t drawable_start = TraceRecorder::now();
+        drawable = next_drawable();
+        _trace.add_cpu("nextDrawable", drawable_start, TraceRecorder::now());
+        os_signpost_interval_end(signpost_log(), signpost, "nextDrawable");
+        target = drawable.texture;
+        if (target != nil)
+            return true;
+
+        submit();
+        os_signpost_interval_end(signpost_log(), signpost, "render", "no drawable");
+        return false;
+    };
+
+    // Geometry work goes first, on the compute queue with async compute. The 3D passes of the previous frame are the
+    // last to read what it writes.
+    id<MTLCommandBuffer> compute_buffer = command_buffer;
+    if (async_compute)
+    {
+        compute_buffer = [_compute_queue commandBufferWithUnretainedReferences];
+        compute_buffer.label = [NSString stringWithFormat:@"Frame %u Compute", frame_index];
+        [compute_buffer encodeWaitForEvent:_geometry_event value:_geometry_value];
+    }
+
+    // Defragment the 3D vertex buffer a bit every frame, the blits run before any draw of the frame.
+    if (_vertex_compaction_budget > 0)
+    {
+        const size_t moved = _vertex_3d_list.compact(compute_buffer, _vertex_compaction_budget);
+        if (moved > 0)
+        {
+            _draw_commands_dirty = true;
+            _skinning_dirty = true;
+        }
+        if (moved < _vertex_compaction_budget)
+            _packed_3d_list.compact(compute_buffer, _vertex_compaction_budget - moved);
+    }
+
+    const bool skinned = encode_skinning(compute_buffer);
+    encode_instance_animation(compute_buffer, frame_index);
+    encode_transform_hierarchy(compute_buffer, frame_index);
+    encode_terrains(compute_buffer, view_3d);
+    encode_position_stream(compute_buffer);
+    encode_instance_scatters(compute_buffer, frame_index, view_3d);
+    encode_particles(compute_buffer);
+    encode_video_frames(compute_buffer);
+
+    // Acceleration structures, or the compute BVH on GPUs without ray tracing, are built or refit before anything
+    // traces against them.
+    bool traced_scene = false;
+    if (@available(macOS 11.0, *))
+    {
+        if ((_ray_tracing || path_tracing || gi_volume || lightmap_bake || !_ray_queries.empty() ||
+             !_pvs_bakes.empty() || _reflections.settings.enabled != 0) &&
+            has_3d)
+        {
+            if (_hardware_tracing)
+                traced_scene =
+                    _acceleration_structures.update(_device, compute_buffer, _upload_ring, _retired, _vertex_3d_list,
+                                                    _instance_3d_list.get_ranges(), _skinning_groups,
+                                                    _skinned_instances, skinned);
+            else
+                traced_scene = _bvh_scene.update(_device, _upload_ring, _retired, _vertex_3d_list,
+                                                 _instance_3d_list.get_ranges(), _skinning_groups, _skinned_instances);
+        }
+        if (!_ray_queries.empty())
+            encode_ray_queries(compute_buffer, traced_scene);
+        if (!_pvs_bakes.empty() && traced_scene)
+            encode_pvs_bake(compute_buffer);
+    }
+
+    if (async_compute)
+    {
+        [compute_buffer encodeSignalEvent:_compute_event value:++_compute_value];
+        [compute_buffer commit];
+        [command_buffer encodeWaitForEvent:_compute_event value:_compute_value];
+    }
+    const bool ray_tracing = traced_scene && _ray_tracing && !path_tracing;
+    // Distance fields trace the same shadows and occlusion where no rays are traced.
+    const bool sdf_tracing = _sdf_settings.enabled != 0 && has_3d && !path_tracing && !ray_tracing;
+    const bool ssao = _ssao && _quality.settings().ssao && has_3d && !path_tracing && !ray_tracing && !sdf_tracing;
+    // Reflections hit in screen space in the previous frame's main pass, which only scaled frames keep.
+    const bool reflections = _reflections.settings.enabled != 0 && has_3d && !path_tracing && !occlusion_view &&
+                             !overdraw_view && _scaled_color != nil;
+    if (!reflections)
+    {
+        _reflections.history_valid = false;
+        _reflections.source_valid = false;
+    }
+
+    // Light culling maps the physical pixels of a rate mapped frame back to the screen, the other passes that read the
+    // pre-pass depth assume evenly spaced pixels. Frames with any of them are shaded at full rate.
+    const bool rate_mapped = _rate_map != nil && !deferred && !occlusion_view && !overdraw_view && !path_tracing &&
+                             !ray_tracing && !sdf_tracing && !ssao && !reflections && !occlusion && !transparency;
+    // The viewport of a rate mapped pass covers its screen size.
+    const MTLViewport viewport = {0.0, 0.0, static_cast<double>(_depth_texture.width),
+                                  static_cast<double>(_depth_texture.height), 0.0, 1.0};
+    if (rate_mapped)
+        render_desc.rasterizationRateMap = _rate_map;
+
+    // Only re-encodes arguments whose buffer got replaced since this frame was last prepared.
+    encode_scene_arguments(frame_index);
+
+    // The cell of the camera picks the meshes of the potentially visible set, the unculled draw commands hold those of
+    // the last cell.
+    const unsigned int pvs_cell = _pvs.cell_at(vec3(view_3d.pos.x, view_3d.pos.y, view_3d.pos.z));
+    if (pvs_cell != _pvs_cell)
+    {
+        _pvs_cell = pvs_cell;
+        _draw_commands_dirty = true;
+    }
+
+    // Submeshes are culled on the CPU for the draws that are not culled on the GPU.
+    cull_submeshes(combined);
+    const vec4 lod_view =
+        vec4(view_3d.pos.x, view_3d.pos.y, view_3d.pos.z, projection[1][1] / _quality.settings().lod_bias);
+    const UploadAllocation draw_args =
+        culling ? encode_instance_culling(command_buffer, frame_index, combined, lod_view) : UploadAllocation{};
+    // Point clouds are composited in screen space, rate mapped passes and the views of other buffers skip them.
+    const bool point_clouds =
+        !rate_mapped && !occlusion_view && !overdraw_view && !path_tracing &&
+        encode_point_clouds(command_buffer, projection * get_rh_view_rotation(view_3d),
+                            dvec3(view_3d.pos.x, view_3d.pos.y, view_3d.pos.z));
+
+    // Forward frames with GPU culling that need no motion vectors may draw the visibility buffer as their pre-pass.
+    unsigned int vbuffer_meshes = 0;
+    UploadAllocation vbuffer_records;
+    if (_vbuffer_enabled && draw_args.valid() && !deferred && !msaa && !rate_mapped && !motion && !occlusion_view &&
+        !overdraw_view)
+    {
+        if (_vbuffer == nil || _vbuffer.width != _depth_texture.width || _vbuffer.height != _depth_texture.height)
+        {
+            _retired.retire(_vbuffer);
+            MTLTextureDescriptor *desc = [MTLTextureDescriptor texture2DDescriptorWithPixelFormat:MTLPixelFormatRG32Uint
+                                                                                            width:_depth_texture.width
+                                                                                           height:_depth_texture.height
+                                                                                        mipmapped:NO];
+            desc.usage = MTLTextureUsageRenderTarget | MTLTextureUsageShaderRead;
+            desc.storageMode = MTLStorageModePrivate;
+            _vbuffer = [_device newTextureWithDescriptor:desc];
+            _vbuffer.label = @"VisibilityBuffer";
+        }
+        vbuffer_records = upload_vbuffer_meshes(&vbuffer_meshes);
+    }
+    const bool vbuffer = vbuffer_records.valid() && _vbuffer != nil;
+
+    // The fragment counts of the overdraw view are only kept while it is shown.
+    if (overdraw_view &&
+        (_overdraw == nil || _overdraw.width != _depth_texture.width || _overdraw.height != _depth_texture.height))
+    {
+        _retired.retire(_overdraw);
+        MTLTextureDescriptor *desc = [MTLTextureDescriptor texture2DDescriptorWithPixelFormat:MTLPixelFormatR16Float
+                                                                                        width:_depth_texture.width
+                                                                                       height:_depth_texture.height
+                                                                                    mipmapped:NO];
+        desc.usage = MTLTextureUsageRenderTarget | MTLTextureUsageShaderRead;
+        desc.storageMode = MTLStorageModePrivate;
+        _overdraw = [_device newTextureWithDescriptor:desc];
+        _overdraw.label = @"Overdraw";
+    }
+    else if (!overdraw_view && _overdraw != nil)
+    {
+        _retired.retire(_overdraw);
+        _overdraw = nil;
+    }
+
+    // Culled draws are encoded on the GPU once culling wrote their instance counts. The draws of the visibility
+    // buffer set their first triangle from the CPU.
+    NSRange draw_commands = NSMakeRange(0, 0);
+    if (_gpu_driven && draw_args.valid() && !vbuffer)
+    {
+        draw_commands = encode_culled_draw_commands(command_buffer, draw_args, 0, true);
+    }
+    else if (_gpu_driven && !vbuffer)
+    {
+        encode_draw_commands(command_buffer);
+        draw_commands = NSMakeRange(0, _draw_command_count);
+    }
+    NSRange late_draw_commands = NSMakeRange(0, 0);
+
+    // The pre-pass also runs on request to cut overdraw of the main pass, and provides the depth occlusion culling
+    // tests against, rays are traced from and transparent meshes are blended in front of, and the motion vectors.
+    const bool prepass = lighting || ray_tracing || sdf_tracing || ssao || reflections || transparency || motion ||
+                         vbuffer || ((_depth_prepass || occlusion) && has_3d && !path_tracing);
+    _particle_depth_valid = prepass && !rate_mapped;
+    _particle_depth_combined = combined;
+
+    // The skybox is drawn behind 3D geometry and lights it, the path tracer keeps its constant ambient light.
+    const bool sky = _skybox != nil && has_3d && !path_tracing;
+
+    LightUniforms light_uniforms = {};
+    UploadAllocation point_lights;
+    UploadAllocation spot_lights;
+    UploadAllocation directional_lights;
+    if (lighting || deferred || ray_tracing || sdf_tracing || ssao || reflections || sky || gi_lit)
+    {
+        const mat4 inv_projection = inverse(projection);
+        const mat4 inv_combined = inverse(combined);
+        memcpy(&light_uniforms.view, value_ptr(view), sizeof(mat4));
+        memcpy(&light_uniforms.inv_projection, value_ptr(inv_projection), sizeof(mat4));
+        memcpy(&light_uniforms.inv_combined, value_ptr(inv_combined), sizeof(mat4));
+        light_uniforms.camera_position = simd_make_float4(view_3d.pos.x, view_3d.pos.y, view_3d.pos.z, 1.0f);
+        light_uniforms.width = static_cast<unsigned int>(_depth_texture.width);
+        light_uniforms.height = static_cast<unsigned int>(_depth_texture.height);
+        light_uniforms.tiles_x = (light_uniforms.width + LIGHT_TILE_SIZE - 1) / LIGHT_TILE_SIZE;
+        light_uniforms.ray_traced = ray_tracing || sdf_tracing ? 1 : 0;
+        light_uniforms.ao_radius = _ao_radius;
+        light_uniforms.environment = sky ? 1 : 0;
+        light_uniforms.ssao = ssao ? 1 : 0;
+        light_uniforms.num_probes = has_3d && !path_tracing ? static_cast<unsigned int>(_probes.size()) : 0;
+        if (gi_lit)
+            light_uniforms.gi = _gi.volume;
+        light_uniforms.reflections = reflections ? 1 : 0;
+        light_uniforms.reflection_roughness = _reflections.settings.max_roughness;
+    }
+    if (lighting)
+    {
+        light_uniforms.num_point_lights = static_cast<unsigned int>(_point_lights.size());
+        light_uniforms.num_spot_lights = static_cast<unsigned int>(_spot_lights.size());
+        light_uniforms.num_directional_lights = static_cast<unsigned int>(_directional_lights.size());
+        light_uniforms.num_area_lights = static_cast<unsigned int>(_area_lights.size());
+
+        point_lights = _upload_ring.upload(_point_lights.data(), _point_lights.size());
+        spot_lights = _upload_ring.upload(_spot_lights.data(), _spot_lights.size());
+    }
+    if (lighting || ray_tracing || sdf_tracing)
+        directional_lights = _upload_ring.upload(_directional_lights.data(), _directional_lights.size());
+    const UploadAllocation lights = _upload_ring.upload(&light_uniforms, 1);
+    const UploadAllocation shadow_allocation = _upload_ring.upload(&shadow_uniforms, 1);
+
+    UploadAllocation late_draw_args;
+    if (prepass)
+    {
+        // Instances are only reprojected with their own transforms of the previous frame.
+        id<MTLBuffer> previous_instances = _instance_3d_list.buffer(frame_index);
+        if (_previous_instances != nil && _previous_instances_layout == _instance_3d_list.layout_version())
+            previous_instances = _previous_instances;
+        const MotionUniforms background_motion = motion ? motion_uniforms(combined, jitter) : MotionUniforms{};
+        const auto draw_background_motion = [&](id<MTLRenderCommandEncoder> encoder) {
+            [encoder pushDebugGroup:@"BackgroundMotion"];
+            [encoder setRenderPipelineState:_background_motion_state];
+            [encoder setDepthStencilState:_depth_state_prepassed];
+            [encoder setCullMode:MTLCullModeNone];
+            [encoder setFragmentBytes:&background_motion length:sizeof(MotionUniforms) atIndex:0];
+            [encoder drawPrimitives:MTLPrimitiveTypeTriangle vertexStart:0 vertexCount:3];
+            [encoder popDebugGroup];
+        };
+
+        const auto encode_prepass = [&](const UploadAllocation &args, NSRange commands, MTLLoadAction load,
+                                        bool draw_skinned, NSString *label) {
+            MTLRenderPassDescriptor *prepass_desc = pass_descriptor(PrePass);
+            prepass_desc.depthAttachment.clearDepth = 0.0;
+            prepass_desc.depthAttachment.storeAction = MTLStoreActionStore;
+            prepass_desc.depthAttachment.loadAction = load;
+            prepass_desc.depthAttachment.texture = _depth_texture;
+            if (rate_mapped)
+                prepass_desc.rasterizationRateMap = _rate_map;
+            if (motion)
+            {
+                prepass_desc.colorAttachments[0].texture = _motion_vectors;
+                prepass_desc.colorAttachments[0].loadAction = load;
+                prepass_desc.colorAttachments[0].storeAction = MTLStoreActionStore;
+            }
+            else if (vbuffer)
+            {
+                prepass_desc.colorAttachments[0].texture = _vbuffer;
+                prepass_desc.colorAttachments[0].loadAction = load;
+                prepass_desc.colorAttachments[0].storeAction = MTLStoreActionStore;
+                prepass_desc.colorAttachments[0].clearColor =
+                    MTLClearColorMake(NO_VBUFFER_TRIANGLE, NO_VBUFFER_TRIANGLE, 0.0, 0.0);
+            }
+
+            const auto setup = [&](id<MTLRenderCommandEncoder> encoder) {
+                if (rate_mapped)
+                    [encoder setViewport:viewport];
+                [encoder setDepthStencilState:_depth_state];
+                [encoder setFrontFacingWinding:MTLWindingCounterClockwise];
+                [encoder setTriangleFillMode:MTLTriangleFillModeFill];
+                [encoder setCullMode:MTLCullModeBack];
+                use_3d_resources(encoder, frame_index, args.valid());
+                [encoder setVertexBuffer:frame.args_buffer offset:0 atIndex:0];
+                [encoder setVertexBuffer:uniforms_allocation.buffer offset:uniforms_allocation.offset atIndex:1];
+                if (motion)
+                {
+                    [encoder setVertexBuffer:previous_instances offset:0 atIndex:3];
+                    [encoder setFragmentBuffer:uniforms_allocation.buffer
+                                        offset:uniforms_allocation.offset
+                                       atIndex:1];
+                }
+            };
+            const auto draw = [&](id<MTLRenderCommandEncoder> encoder, unsigned int first_mesh, unsigned int end_mesh) {
+                const Pipelines3D &depth_states =
+                    _vertex_3d_list.position_buffer() != nil ? _position_prepass_state_3d : _prepass_state_3d;
+                const Pipelines3D &states = motion ? _motion_state_3d : vbuffer ? _vbuffer_state_3d : depth_states;
+                encode_3d_draws(encoder, states, args, commands, draw_skinned, OpaqueMeshes, first_mesh, end_mesh);
+            };
+            // Geometry of the late phase covers the background motion of the early one.
+            const bool background = motion && load == MTLLoadActionClear;
+            _frame_timer.time_render_pass(prepass_desc, FRAME_PASS_DEPTH);
+            encode_3d_pass(command_buffer, prepass_desc, label, setup, draw,
+                           background ? EncodeFunction(draw_background_motion) : EncodeFunction());
+        };
+
+        encode_prepass(draw_args, draw_commands, MTLLoadActionClear, true, @"DepthPrepass");
+
+        // Instances the early phase rejected are tested again against the depth just written, the ones that turned
+        // out visible are added to the depth.
+        if (occlusion && draw_args.valid())
+            late_draw_args = encode_late_culling(command_buffer, frame_index, combined);
+        if (late_draw_args.valid() && _gpu_driven && !vbuffer)
+            late_draw_commands = encode_culled_draw_commands(command_buffer, late_draw_args,
+                                                             static_cast<unsigned int>(NSMaxRange(draw_commands)),
+                                                             false);
+        if (late_draw_args.valid())
+            encode_prepass(late_draw_args, late_draw_commands, MTLLoadActionLoad, false, @"DepthPrepass-Late");
+        if (!_visibility.empty())
+            encode_visibility(command_buffer, uniforms_allocation, view_3d, rate_mapped, viewport);
+
+        // The next frame reprojects with the instance transforms of this one.
+        if (motion)
+        {
+            const NSUInteger size = _instance_3d_list.total() * sizeof(InstanceTransform);
+            if (_previous_instances == nil || _previous_instances.length < size)
+            {
+                const unsigned int length = next_multiple_of(static_cast<unsigned int>(size), 65536);
+                _retired.retire(_previous_instances);
+                _previous_instances = [_device newBufferWithLength:length options:MTLResourceStorageModePrivate];
+                _previous_instances.label = @"PreviousInstances";
+            }
+
+            id<MTLBlitCommandEncoder> blit = [command_buffer blitCommandEncoder];
+            blit.label = @"PreviousInstances";
+            [blit copyFromBuffer:_instance_3d_list.buffer(frame_index)
+                     sourceOffset:0
+                         toBuffer:_previous_instances
+                destinationOffset:0
+                             size:size];
+            [blit endEncoding];
+            _previous_instances_layout = _instance_3d_list.layout_version();
+        }
+
+        // The main pass only shades the fragments that ended up visible in the pre-pass. Multisampled depth can not
+        // be loaded from it and is tested again.
+        if (!msaa)
+            render_desc.depthAttachment.loadAction = MTLLoadActionLoad;
+    }
+    // Transforms copied before a frame without motion vectors may be from any frame.
+    if (!motion)
+        _previous_instances_layout = ~0u;
+
+    if (!shadow_passes.empty())
+    {
+        const unsigned int first_shadow_list = _culling.visible_count * (occlusion ? 2 : 1);
+        encode_shadows(command_buffer, frame_index, shadow_passes, draw_args.valid(), first_shadow_list);
+    }
+
+    if (_light_tree_dirty && (lighting || ((path_tracing || lightmap_bake) && traced_scene)))
+        encode_light_tree(command_buffer);
+    if (lighting)
+        encode_light_culling(command_buffer, lights, point_lights, spot_lights, rate_mapped);
+    if (ray_tracing)
+        encode_ray_tracing(command_buffer, lights, directional_lights);
+    if (sdf_tracing)
+        encode_sdf_tracing(command_buffer, lights, directional_lights,
+                           vec3(view_3d.pos.x, view_3d.pos.y, view_3d.pos.z));
+    if (gi_volume && traced_scene)
+        encode_gi(command_buffer, frame_index);
+    id<MTLTexture> reflection_texture =
+        reflections ? encode_reflections(command_buffer, frame_index, lights, combined, traced_scene) : nil;
+    if (lightmap_bake && traced_scene && !encode_lightmap_bake(command_buffer, frame_index, _lightmap_bakes.front()))
+        _lightmap_bakes.erase(_lightmap_bakes.begin());
+
+    // The passes from the occlusion to the transparency composite get their transient textures from the frame graph.
+    using FrameAccesses = std::vector<std::pair<FrameGraph::Handle, FrameGraph::Access>>;
+    _frame_graph.reset();
+    const NSUInteger width = _depth_texture.width;
+    const NSUInteger height = _depth_texture.height;
+    const FrameGraph::Handle ssao_texture =
+        _frame_graph.create_texture({MTLPixelFormatRG16Float, (width + 1) / 2, (height + 1) / 2, @"SSAO"});
+    const FrameGraph::Handle ssao_blurred =
+        _frame_graph.create_texture({MTLPixelFormatRG16Float, (width + 1) / 2, (height + 1) / 2, @"SSAO-Blurred"});
+    const FrameGraph::Handle transparent_accum =
+        _frame_graph.create_texture({MTLPixelFormatRGBA16Float, width, height, @"TransparentAccum"});
+    const FrameGraph::Handle transparent_reveal =
+        _frame_graph.create_texture({MTLPixelFormatR16Float, width, height, @"TransparentReveal"});
+    if (ssao)
+    {
+        // The blur filters from one texture into the other and back.
+        const bool filtered = mode != RENDER_SSAO;
+        FrameAccesses accesses = {{ssao_texture, FrameGraph::Write}, {ssao_texture, FrameGraph::Read}};
+        if (filtered)
+        {
+            accesses.push_back({ssao_blurred, FrameGraph::Write});
+            accesses.push_back({ssao_blurred, FrameGraph::Read});
+        }
+        _frame_graph.add_pass(accesses, [&, filtered](const FrameGraph::EncodeFunction &) {
+            encode_ssao(command_buffer, lights, combined, _frame_graph.texture(ssao_texture),
+                        filtered ? _frame_graph.texture(ssao_blurred) : nil);
+            return true;
+        });
+    }
+    UploadAllocation path_tracer_uniforms;
+    if (path_tracing && traced_scene)
+        path_tracer_uniforms = encode_path_tracing(command_buffer, frame_index, view_3d, combined);
+
+    const auto use_2d_resources = [&](id<MTLRenderCommandEncoder> encoder) {
+        if (!textures_resident())
+        {
+            for (const auto &heap : _texture_heaps)
+                [encoder useHeap:heap];
+            for (const auto &tex : _standalone_textures)
+                [encoder useResource:tex usage:MTLResourceUsageRead];
+            for (const auto &tex : _texture_arrays.textures())
+                [encoder useResource:tex usage:MTLResourceUsageRead];
+            [encoder useResource:_fallback_texture usage:MTLResourceUsageRead];
+        }
+        [encoder useResource:_vertex_2d_list.vertex_buffer() usage:MTLResourceUsageRead];
+        [encoder useResource:_textures_buffer usage:MTLResourceUsageRead];
+        [encoder useResource:_texture_layers_buffer usage:MTLResourceUsageRead];
+        if (_texture_arrays_buffer != nil)
+            [encoder useResource:_texture_arrays_buffer usage:MTLResourceUsageRead];
+        [encoder useResource:_samplers_buffer usage:MTLResourceUsageRead];
+        [encoder useResource:_instance_2d_list.buffer(frame_index) usage:MTLResourceUsageRead];
+    };
+
+    // Queued impostors are baked before any pass could draw them, they are only drawn once their slots bound them.
+    if (has_3d && !_impostor_bakes.empty())
+    {
+        const auto use_impostor_resources = [&](id<MTLRenderCommandEncoder> encoder) {
+            use_2d_resources(encoder);
+            use_3d_resources(encoder, frame_index, false);
+            [encoder useResource:_frames[frame_index].materials usage:MTLResourceUsageRead];
+            [encoder setVertexBuffer:frame.args_buffer offset:0 atIndex:0];
+            [encoder setFragmentBuffer:frame.args_buffer offset:0 atIndex:0];
+        };
+        size_t remaining = 0;
+        for (size_t i = 0; i < _impostor_bakes.size(); i++)
+        {
+            ImpostorBake &bake = _impostor_bakes[i];
+            if (bake.albedo != nil || encode_impostor_bake(command_buffer, bake, use_impostor_resources))
+                _impostor_bakes[remaining++] = bake;
+        }
+        _impostor_bakes.resize(remaining);
+    }
+
+    // Dirty faces of the reflection probes are baked up to the budget, in a pass per probe whose layers are the
+    // consecutive faces it bakes. Probes whose last face was baked are prefiltered before this frame reads them.
+    update_probe_faces();
+    UploadAllocation probe_allocation;
+    if (has_3d && !path_tracing && !_probes.empty())
+    {
+        // Probes that are not baked yet have no radius, so no surface is within them.
+        const auto upload_probes = [&]() {
+            std::vector<ReflectionProbe> baked = _probes;
+            for (size_t i = 0; i < baked.size(); i++)
+                baked[i].radius = _probe_baked[i] ? baked[i].radius : 0.0f;
+            return _upload_ring.upload(baked.data(), baked.size());
+        };
+        // Faces reflect the probes of the previous bakes.
+        const UploadAllocation previous_probes = upload_probes();
+
+        std::vector<unsigned int> prefiltered;
+        unsigned int budget = _probe_budget;
+        for (unsigned int probe = 0; probe < _probes.size() && budget > 0; probe++)
+        {
+            const unsigned int dirty = _probe_dirty_faces[probe];
+            if (dirty == 0)
+                continue;
+            const auto first_face = static_cast<unsigned int>(__builtin_ctz(dirty));
+            const unsigned int num_faces = std::min(6 - first_face, budget);
+            const UploadAllocation cameras = _upload_ring.allocate(sizeof(Uniforms) * num_faces);
+            if (!cameras.valid())
+                break;
+            budget -= num_faces;
+
+            // Cube map faces are mirrored, their view rotations map the right, up and forward axes of the face
+            // directions of cube_direction to x, y and -z.
+            static const vec3 FACE_RIGHT[] = {{0, 0, -1}, {0, 0, 1}, {1, 0, 0}, {1, 0, 0}, {1, 0, 0}, {-1, 0, 0}};
+            static const vec3 FACE_UP[] = {{0, 1, 0}, {0, 1, 0}, {0, 0, -1}, {0, 0, 1}, {0, 1, 0}, {0, 1, 0}};
+            static const vec3 FACE_FORWARD[] = {{1, 0, 0}, {-1, 0, 0}, {0, 1, 0}, {0, -1, 0}, {0, 0, 1}, {0, 0, -1}};
+            const ReflectionProbe &probe_data = _probes[probe];
+            auto *face_cameras = reinterpret_cast<Uniforms *>(cameras.data);
+            for (unsigned int i = 0; i < num_faces; i++)
+            {
+                const unsigned int face = first_face + i;
+                CameraView3D face_view = view_3d;
+                face_view.pos = {probe_data.pos_x, probe_data.pos_y, probe_data.pos_z};
+                face_view.direction = {FACE_FORWARD[face].x, FACE_FORWARD[face].y, FACE_FORWARD[face].z};
+                face_view.fov = half_pi<float>();
+                face_view.aspect_ratio = 1.0f;
+                face_view.inv_width = 1.0f / REFLECTION_PROBE_SIZE;
+                face_view.inv_height = 1.0f / REFLECTION_PROBE_SIZE;
+
+                mat4 rotation = mat4(1.0f);
+                for (int axis = 0; axis < 3; axis++)
+                {
+                    rotation[axis][0] = FACE_RIGHT[face][axis];
+                    rotation[axis][1] = FACE_UP[face][axis];
+                    rotation[axis][2] = -FACE_FORWARD[face][axis];
+                }
+                const mat4 face_projection = get_rh_projection_matrix(face_view);
+                const mat4 face_combined = face_projection * rotation;
+                Uniforms &camera = face_cameras[i];
+                memcpy(&camera.projection, value_ptr(face_projection), sizeof(mat4));
+                memcpy(&camera.view_matrix, value_ptr(rotation), sizeof(mat4));
+                memcpy(&camera.combined, value_ptr(face_combined), sizeof(mat4));
+                memcpy(&camera.matrix_2d, value_ptr(matrix_2d), sizeof(mat4));
+                camera.origin = simd_make_float4(probe_data.pos_x, probe_data.pos_y, probe_data.pos_z, 0.0f);
+                camera.view = face_view;
+                memcpy(&camera.previous_combined, value_ptr(face_combined), sizeof(mat4));
+                camera.jitter = simd_make_float4(0.0f, 0.0f, 0.0f, 0.0f);
+            }
+
+            MTLRenderPassDescriptor *probe_desc = pass_descriptor(ProbePass);
+            probe_desc.colorAttachments[0].texture = _probe_captures;
+            probe_desc.colorAttachments[0].slice = probe * 6 + first_face;
+            probe_desc.colorAttachments[0].loadAction = MTLLoadActionClear;
+            probe_desc.colorAttachments[0].storeAction = MTLStoreActionStore;
+            probe_desc.colorAttachments[0].clearColor = MTLClearColorMake(0.0, 0.0, 0.0, 1.0);
+            probe_desc.depthAttachment.texture = _probe_depth;
+            probe_desc.depthAttachment.loadAction = MTLLoadActionClear;
+            probe_desc.depthAttachment.storeAction = MTLStoreActionDontCare;
+            probe_desc.depthAttachment.clearDepth = 0.0;
+            probe_desc.renderTargetArrayLength = num_faces;
+            _frame_timer.time_render_pass(probe_desc, FRAME_PASS_3D);
+
+            id<MTLRenderCommandEncoder> encoder = [command_buffer renderCommandEncoderWithDescriptor:probe_desc];
+            encoder.label = @"ReflectionProbe";
+            [encoder setDepthStencilState:_depth_state];
+            [encoder setFrontFacingWinding:MTLWindingClockwise];
+            [encoder setTriangleFillMode:MTLTriangleFillModeFill];
+            [encoder setCullMode:MTLCullModeBack];
+            use_2d_resources(encoder);
+            use_3d_resources(encoder, frame_index, false);
+            [encoder useResource:_frames[frame_index].materials usage:MTLResourceUsageRead];
+
+            [encoder setVertexBuffer:frame.args_buffer offset:0 atIndex:0];
+            [encoder setVertexBuffer:cameras.buffer offset:cameras.offset atIndex:1];
+            [encoder setFragmentBuffer:frame.args_buffer offset:0 atIndex:0];
+            [encoder setFragmentBuffer:lights.buffer offset:lights.offset atIndex:1];
+            const UploadAllocation &directional = directional_lights.valid() ? directional_lights : lights;
+            [encoder setFragmentBuffer:directional.buffer offset:directional.offset atIndex:4];
+            [encoder setFragmentBuffer:_irradiance offset:0 atIndex:9];
+            [encoder setFragmentBuffer:cameras.buffer offset:cameras.offset atIndex:10];
+            [encoder setFragmentTexture:_environment atIndex:3];
+            [encoder setFragmentTexture:_probe_maps atIndex:6];
+            [encoder setFragmentTexture:_gi.irradiance atIndex:8];
+            [encoder setFragmentTexture:_gi.distances atIndex:9];
+            [encoder setFragmentBuffer:previous_probes.buffer offset:previous_probes.offset atIndex:11];
+
+            const auto draw_faces = [&](const std::function<void()> &draw) {
+                for (unsigned int first_view = 0; first_view < num_faces; first_view += _max_amplification)
+                {
+                    if (@available(macOS 10.15.4, *))
+                        [encoder setVertexAmplificationCount:std::min(num_faces - first_view, _max_amplification)
+                                                viewMappings:nil];
+                    [encoder setVertexBytes:&first_view length:sizeof(unsigned int) atIndex:3];
+                    draw();
+                }
+            };
+            draw_faces([&]() {
+                encode_3d_draws(encoder, _probe_state_3d, UploadAllocation{}, NSMakeRange(0, 0), true, OpaqueMeshes);
+            });
+            // The skybox fills the faces behind the geometry.
+            if (_skybox != nil)
+            {
+                [encoder setRenderPipelineState:_probe_background_state];
+                [encoder setDepthStencilState:_depth_state_prepassed];
+                [encoder setCullMode:MTLCullModeNone];
+                [encoder setFragmentBytes:&first_face length:sizeof(unsigned int) atIndex:3];
+                draw_faces([&]() { [encoder drawPrimitives:MTLPrimitiveTypeTriangle vertexStart:0 vertexCount:3]; });
+            }
+            [encoder endEncoding];
+
+            _probe_dirty_faces[probe] = dirty & ~((1u << (first_face + num_faces)) - 1);
+            if (_probe_dirty_faces[probe] == 0)
+                prefiltered.push_back(probe);
+        }
+
+        if (!prefiltered.empty())
+        {
+            // The mip chains of all captures are generated at once, they are small.
+            id<MTLBlitCommandEncoder> blit = [command_buffer blitCommandEncoder];
+            blit.label = @"ProbeMipmaps";
+            [blit generateMipmapsForTexture:_probe_captures];
+            [blit endEncoding];
+
+            id<MTLComputeCommandEncoder> encoder = _frame_timer.compute_encoder(command_buffer, FRAME_PASS_LIGHTING);
+            encoder.label = @"PrefilterProbes";
+            [encoder setComputePipelineState:_prefilter_probe_state];
+            const NSRange capture_levels = NSMakeRange(0, _probe_captures.mipmapLevelCount);
+            for (const unsigned int probe : prefiltered)
+            {
+                id<MTLTexture> capture = [_probe_captures newTextureViewWithPixelFormat:_probe_captures.pixelFormat
+                                                                            textureType:MTLTextureTypeCube
+                                                                                 levels:capture_levels
+                                                                                 slices:NSMakeRange(probe * 6, 6)];
+                [encoder setTexture:capture atIndex:0];
+                _retired.retire(capture);
+                for (unsigned int level = 0; level < ENVIRONMENT_MIP_LEVELS; level++)
+                {
+                    id<MTLTexture> view = [_probe_maps newTextureViewWithPixelFormat:_probe_maps.pixelFormat
+                                                                         textureType:MTLTextureTypeCube
+                                                                              levels:NSMakeRange(level, 1)
+                                                                              slices:NSMakeRange(probe * 6, 6)];
+                    const EnvironmentUniforms uniforms = {
+                        REFLECTION_PROBE_SIZE >> level, static_cast<float>(level) / (ENVIRONMENT_MIP_LEVELS - 1), 0, 0};
+                    [encoder setTexture:view atIndex:1];
+                    _retired.retire(view);
+                    [encoder setBytes:&uniforms length:sizeof(uniforms) atIndex:0];
+                    [encoder dispatchThreadgroups:MTLSizeMake((uniforms.size + 7) / 8, (uniforms.size + 7) / 8, 6)
+                            threadsPerThreadgroup:MTLSizeMake(8, 8, 1)];
+                }
+                _probe_baked[probe] = true;
+            }
+            [encoder endEncoding];
+        }
+        probe_allocation = prefiltered.empty() ? previous_probes : upload_probes();
+    }
+
+    // Render textures are drawn before the passes that sample them.
+    if (has_3d && !path_tracing && !_render_textures.empty())
+        encode_render_textures(command_buffer, frame_index, lights, directional_lights, probe_allocation, matrix_2d);
+
+    const Pipelines3D &pipelines_3d = deferred ? _gbuffer_state_3d : msaa ? _msaa_state_3d : _state_3d;
+    const size_t feedback_words = frame.texture_feedback != nil ? frame.texture_feedback.length / sizeof(int) : 0;
+    const unsigned int feedback_textures =
+        _num_streamed_textures > 0 || !_virtual.empty()
+            ? static_cast<unsigned int>(std::min(_textures.size(), feedback_words))
+            : 0;
+    // Pages of virtual textures are requested after the words of all textures.
+    const auto virtual_words =
+        static_cast<unsigned int>(feedback_textures > 0 && feedback_textures == _textures.size()
+                                      ? std::min(feedback_words - feedback_textures, _virtual.feedback_words())
+                                      : 0);
+    frame.feedback_textures = feedback_textures;
+    const TextureFeedbackUniforms feedback_uniforms = {_feedback_frame % TEXTURE_FEEDBACK_PERIOD, feedback_textures,
+                                                       virtual_words};
+    const auto setup = [&](id<MTLRenderCommandEncoder> encoder) {
+        if (rate_mapped)
+            [encoder setViewport:viewport];
+        [encoder setDepthStencilState:prepass && !msaa ? _depth_state_prepassed : _depth_state];
+        [encoder setFrontFacingWinding:MTLWindingCounterClockwise];
+        [encoder setTriangleFillMode:MTLTriangleFillModeFill];
+        [encoder setCullMode:MTLCullModeBack];
+
+        use_2d_resources(encoder);
+        use_3d_resources(encoder, frame_index, draw_args.valid());
+        [encoder useResource:_frames[frame_index].materials usage:MTLResourceUsageRead];
+
+        [encoder setVertexBuffer:frame.args_buffer offset:0 atIndex:0];
+        [encoder setVertexBuffer:uniforms_allocation.buffer offset:uniforms_allocation.offset atIndex:1];
+        [encoder setFragmentBuffer:frame.args_buffer offset:0 atIndex:0];
+
+        // Light arrays that are empty this frame are never read, the light uniforms stand in for them.
+        const auto set_light_buffer = [&](const UploadAllocation &allocation, unsigned int index) {
+            const UploadAllocation &bound = allocation.valid() ? allocation : lights;
+            [encoder setFragmentBuffer:bound.buffer offset:bound.offset atIndex:index];
+        };
+        set_light_buffer(lights, 1);
+        set_light_buffer(point_lights, 2);
+        set_light_buffer(spot_lights, 3);
+        set_light_buffer(directional_lights, 4);
+        set_light_buffer(probe_allocation, 11);
+        if (_area_light_buffer != nil)
+            [encoder setFragmentBuffer:_area_light_buffer offset:0 atIndex:12];
+        else
+            set_light_buffer(lights, 12);
+        if (lighting)
+            [encoder setFragmentBuffer:_tile_lights offset:0 atIndex:5];
+        else
+            set_light_buffer(lights, 5);
+        [encoder setFragmentBuffer:shadow_allocation.buffer offset:shadow_allocation.offset atIndex:6];
+        // The scene arguments stand in for the texture feedback while no texture streams.
+        [encoder setFragmentBuffer:feedback_textures > 0 ? frame.texture_feedback : frame.args_buffer
+                            offset:0
+                           atIndex:7];
+        [encoder setFragmentBytes:&feedback_uniforms length:sizeof(feedback_uniforms) atIndex:8];
+        [encoder setFragmentBuffer:_irradiance offset:0 atIndex:9];
+        [encoder setFragmentTexture:_cascade_shadows atIndex:0];
+        [encoder setFragmentTexture:_spot_shadows atIndex:1];
+        [encoder setFragmentTexture:_ray_traced atIndex:2];
+        [encoder setFragmentTexture:_environment atIndex:3];
+        [encoder setFragmentTexture:_skybox != nil ? _skybox : _fallback_texture atIndex:4];
+        [encoder setFragmentTexture:ssao ? _frame_graph.texture(ssao_texture) : _fallback_texture atIndex:5];
+        [encoder setFragmentTexture:_probe_maps atIndex:6];
+        [encoder setFragmentTexture:_gi.irradiance atIndex:8];
+        [encoder setFragmentTexture:_gi.distances atIndex:9];
+        [encoder setFragmentTexture:reflection_texture != nil ? reflection_texture : _fallback_texture atIndex:10];
+    };
+
+    // The occlusion view only shows what was traced from the pre-pass depth, the path traced view what was accumulated
+    // and the overdraw view what was counted in its own pass.
+    const auto draw = [&](id<MTLRenderCommandEncoder> encoder, unsigned int first_mesh, unsigned int end_mesh) {
+        if (occlusion_view || path_tracing || overdraw_view)
+            return;
+        [encoder pushDebugGroup:@"3D"];
+        if (vbuffer)
+        {
+            // Every pixel of the visibility buffer is shaded once, the skinned meshes are shaded where they are drawn.
+            if (first_mesh == 0)
+            {
+                [encoder setRenderPipelineState:_vbuffer_resolve_state];
+                [encoder setDepthStencilState:_depth_state_2d];
+                [encoder setCullMode:MTLCullModeNone];
+                [encoder setFragmentBuffer:uniforms_allocation.buffer offset:uniforms_allocation.offset atIndex:10];
+                [encoder setFragmentBuffer:vbuffer_records.buffer offset:vbuffer_records.offset atIndex:13];
+                [encoder setFragmentBytes:&vbuffer_meshes length:sizeof(unsigned int) atIndex:14];
+                [encoder setFragmentBuffer:_vertex_3d_list.index_buffer() offset:0 atIndex:15];
+                [encoder setFragmentBuffer:_packed_3d_list.index_buffer() offset:0 atIndex:16];
+                [encoder setFragmentTexture:_vbuffer atIndex:7];
+                [encoder drawPrimitives:MTLPrimitiveTypeTriangle vertexStart:0 vertexCount:3];
+                [encoder setDepthStencilState:_depth_state_prepassed];
+                [encoder setCullMode:MTLCullModeBack];
+            }
+            encode_3d_draws(encoder, pipelines_3d, draw_args, NSMakeRange(0, 0), true, SkinnedMeshes, first_mesh,
+                            end_mesh, mesh_profiler);
+        }
+        else
+        {
+            encode_3d_draws(encoder, pipelines_3d, draw_args, draw_commands, true, OpaqueMeshes, first_mesh, end_mesh,
+                            mesh_profiler);
+            if (late_draw_args.valid())
+                encode_3d_draws(encoder, pipelines_3d, late_draw_args, late_draw_commands, false, OpaqueMeshes,
+                                first_mesh, end_mesh, mesh_profiler);
+        }
+        [encoder popDebugGroup];
+    };
+
+    // 2D draws go on top of everything else, with pipelines matching the attachments of the pass they are drawn in.
+    update_2d_batches(frame);
+    bool culled_2d = false;
+    const auto encode_2d = [&](id<MTLRenderCommandEncoder> encoder, const States2D &states_2d) {
+        const IdTable<DrawDescriptor> &ranges_2d = _vertex_2d_list.get_draw_ranges();
+        const IdTable<InstanceRange<mat4>> &instances_2d = _instance_2d_list.get_ranges();
+        [encoder pushDebugGroup:@"2D"];
+        // Culled by the first pass that draws 2D, frames that composite cached 2D skip it.
+        if (!culled_2d)
+        {
+            cull_2d_batches(matrix_2d);
+            culled_2d = true;
+        }
+
+        [encoder setDepthStencilState:_depth_state_2d];
+        [encoder setFrontFacingWinding:MTLWindingCounterClockwise];
+        [encoder setTriangleFillMode:MTLTriangleFillModeFill];
+        [encoder setCullMode:MTLCullModeNone];
+        [encoder setVertexBuffer:frame.args_buffer offset:0 atIndex:0];
+        [encoder setVertexBuffer:uniforms_allocation.buffer offset:uniforms_allocation.offset atIndex:1];
+        [encoder setFragmentBuffer:frame.args_buffer offset:0 atIndex:0];
+
+        if (frame.batched_2d)
+            [encoder setVertexBuffer:frame.batched_2d->buffer() offset:0 atIndex:2];
+
+        // Blending depends on the draw order, so the pipeline only changes between meshes of different texture modes.
+        // Batches draw the runs of their items that are in view, clipped ones with their scissor rectangle.
+        unsigned int texture_mode = ~0u;
+        bool scissored = false;
+        for (size_t b = 0; b < _batches_2d.size(); b++)
+        {
+            const Batch2D &batch = _batches_2d[b];
+            const Culled2D &culled = _culled_2d[b];
+            if (culled.run_count == 0)
+                continue;
+            if (batch.clipped || scissored)
+            {
+                [encoder setScissorRect:culled.scissor];
+                scissored = batch.clipped;
+            }
+            const auto *runs = _runs_2d.data() + culled.first_run;
+
+            if (batch.mesh == Batch2D::BATCHED)
+            {
+                if (texture_mode != BATCHED_2D_STATE)
+                {
+                    texture_mode = BATCHED_2D_STATE;
+                    [encoder setRenderPipelineState:states_2d[texture_mode]];
+                }
+                for (unsigned int r = 0; r < culled.run_count; r++)
+                {
+                    [encoder drawPrimitives:MTLPrimitiveTypeTriangle
+                                vertexStart:runs[r].first
+                                vertexCount:runs[r].second];
+                    _frame_timer.count_draws(1, 1, runs[r].second / 3);
+                }
+                continue;
+            }
+
+            const DrawDescriptor *range = ranges_2d.find(batch.mesh);
+            const auto insts = instances_2d.find(batch.mesh);
+            if (!range || !insts)
+                continue;
+
+            const unsigned int *mode = _texture_modes_2d.find(batch.mesh);
+            const unsigned int mesh_mode = mode ? *mode : TEXTURE_MODE_2D_MIXED;
+            if (mesh_mode != texture_mode)
+            {
+                texture_mode = mesh_mode;
+                [encoder setRenderPipelineState:states_2d[texture_mode]];
+            }
+
+            for (unsigned int r = 0; r < culled.run_count; r++)
+            {
+                [encoder drawPrimitives:MTLPrimitiveTypeTriangle
+                            vertexStart:range->start
+                            vertexCount:(range->end - range->start)
+                          instanceCount:runs[r].second
+                           baseInstance:runs[r].first];
+                _frame_timer.count_draws(1, runs[r].second, (range->end - range->start) / 3 * runs[r].second);
+            }
+        }
+        // Paths, sprites and text are not clipped.
+        if (scissored)
+        {
+            const CGSize size = drawable_size();
+            const MTLScissorRect drawable = {0, 0, std::max(static_cast<NSUInteger>(size.width), NSUInteger(1)),
+                                             std::max(static_cast<NSUInteger>(size.height), NSUInteger(1))};
+            [encoder setScissorRect:drawable];
+        }
+
+        // Paths are one quad each, drawn unless it is outside the view.
+        if (!_paths_2d.empty())
+        {
+            const CGSize size = drawable_size();
+            const vec2 target(size.width, size.height);
+            bool bound = false;
+            for (auto &[id, path] : _paths_2d)
+            {
+                if (!update_path_quad(path, matrix_2d, target))
+                    continue;
+                if (!bound)
+                {
+                    [encoder setRenderPipelineState:states_2d[PATH_2D_STATE]];
+                    bound = true;
+                }
+                [encoder setVertexBytes:&path.uniforms length:sizeof(PathUniforms2D) atIndex:3];
+                [encoder setFragmentBytes:&path.uniforms length:sizeof(PathUniforms2D) atIndex:3];
+                [encoder setFragmentBuffer:path.buffer offset:0 atIndex:2];
+                [encoder setFragmentBuffer:path.buffer offset:path.bands_offset atIndex:4];
+                [encoder setFragmentBuffer:path.buffer offset:path.indices_offset atIndex:5];
+                [encoder drawPrimitives:MTLPrimitiveTypeTriangle vertexStart:0 vertexCount:6];
+                _frame_timer.count_draws(1, 1, 2);
+            }
+        }
+
+        // Every sprite and glyph is a quad of two triangles.
+        if (_sprite_list.total() > 0)
+        {
+            [encoder setRenderPipelineState:states_2d[SPRITE_2D_STATE]];
+            [encoder setVertexBuffer:_sprite_list.buffer(frame_index) offset:0 atIndex:2];
+            for (const auto &[i, run] : _sprite_list.get_ranges())
+            {
+                if (run.count == 0)
+                    continue;
+                [encoder drawPrimitives:MTLPrimitiveTypeTriangle
+                            vertexStart:0
+                            vertexCount:6
+                          instanceCount:run.count
+                           baseInstance:run.start];
+                _frame_timer.count_draws(1, run.count, run.count * 2);
+            }
+        }
+
+        if (_glyph_atlas != nil && _glyph_list.total() > 0)
+        {
+            [encoder setRenderPipelineState:states_2d[GLYPH_2D_STATE]];
+            [encoder setVertexBuffer:_glyph_list.buffer(frame_index) offset:0 atIndex:2];
+            [encoder setVertexTexture:_glyph_atlas atIndex:0];
+            [encoder setFragmentTexture:_glyph_atlas atIndex:0];
+            for (const auto &[i, run] : _glyph_list.get_ranges())
+            {
+                if (run.count == 0)
+                    continue;
+                [encoder drawPrimitives:MTLPrimitiveTypeTriangle
+                            vertexStart:0
+                            vertexCount:6
+                          instanceCount:run.count
+                           baseInstance:run.start];
+                _frame_timer.count_draws(1, run.count, run.count * 2);
+            }
+        }
+        [encoder popDebugGroup];
+    };
+
+    // Cached 2D is drawn into its layer when it changed, before any pass composites it.
+    const bool has_2d = !_batches_2d.empty() || _sprite_list.total() > 0 || !_paths_2d.empty() ||
+                        (_glyph_atlas != nil && _glyph_list.total() > 0);
+    const bool cache_2d = _cache_2d && has_2d;
+    if (cache_2d && update_2d_layer(matrix_2d))
+    {
+        MTLRenderPassDescriptor *layer_desc = pass_descriptor(Layer2DPass);
+        layer_desc.colorAttachments[0].texture = _layer_2d;
+        layer_desc.colorAttachments[0].loadAction = MTLLoadActionClear;
+        layer_desc.colorAttachments[0].clearColor = MTLClearColorMake(0.0, 0.0, 0.0, 0.0);
+        layer_desc.colorAttachments[0].storeAction = MTLStoreActionStore;
+        _frame_timer.time_render_pass(layer_desc, FRAME_PASS_2D);
+
+        id<MTLRenderCommandEncoder> encoder = [command_buffer renderCommandEncoderWithDescriptor:layer_desc];
+        encoder.label = @"2DLayer";
+        use_2d_resources(encoder);
+        encode_2d(encoder, _states_2d_layer);
+        [encoder endEncoding];
+    }
+
+    const auto draw_2d = [&](id<MTLRenderCommandEncoder> encoder, const States2D &states_2d) {
+        _frame_timer.split_render_pass(encoder, FRAME_PASS_2D);
+        if (!cache_2d)
+        {
+            encode_2d(encoder, states_2d);
+            return;
+        }
+
+        [encoder pushDebugGroup:@"2DLayerComposite"];
+        [encoder setRenderPipelineState:states_2d[LAYER_2D_STATE]];
+        [encoder setDepthStencilState:_depth_state_2d];
+        [encoder setCullMode:MTLCullModeNone];
+        [encoder setFragmentTexture:_layer_2d atIndex:0];
+        [encoder drawPrimitives:MTLPrimitiveTypeTriangle vertexStart:0 vertexCount:3];
+        [encoder popDebugGroup];
+    };
+
+    // The deferred resolve, the full screen views, the debug lines and the 2D draws of frames that are not scaled go on
+    // top of all 3D draws.
+    DebugLineBatch debug_lines;
+    const auto finish = [&](id<MTLRenderCommandEncoder> encoder) {
+        if (deferred)
+        {
+            const unsigned int view = mode == RENDER_NORMAL ? 1 : mode == RENDER_ALBEDO ? 2 : 0;
+            [encoder pushDebugGroup:@"DeferredResolve"];
+            [encoder setRenderPipelineState:_deferred_states[view]];
+            [encoder setDepthStencilState:_depth_state_2d];
+            [encoder setCullMode:MTLCullModeNone];
+            [encoder drawPrimitives:MTLPrimitiveTypeTriangle vertexStart:0 vertexCount:3];
+            [encoder popDebugGroup];
+        }
+        else if (occlusion_view)
+        {
+            [encoder pushDebugGroup:@"AmbientOcclusion"];
+            [encoder setRenderPipelineState:_ambient_occlusion_state];
+            [encoder setDepthStencilState:_depth_state_2d];
+            [encoder setCullMode:MTLCullModeNone];
+            [encoder drawPrimitives:MTLPrimitiveTypeTriangle vertexStart:0 vertexCount:3];
+            [encoder popDebugGroup];
+        }
+        else if (overdraw_view)
+        {
+            [encoder pushDebugGroup:@"OverdrawHeatmap"];
+            [encoder setRenderPipelineState:_overdraw_heatmap_state];
+            [encoder setDepthStencilState:_depth_state_2d];
+            [encoder setCullMode:MTLCullModeNone];
+            [encoder setFragmentTexture:_overdraw atIndex:0];
+            [encoder drawPrimitives:MTLPrimitiveTypeTriangle vertexStart:0 vertexCount:3];
+            [encoder popDebugGroup];
+        }
+        else if (path_tracer_uniforms.valid())
+        {
+            [encoder pushDebugGroup:@"PathTracerResolve"];
+            [encoder setRenderPipelineState:_path_tracer.resolve];
+            [encoder setDepthStencilState:_depth_state_2d];
+            [encoder setCullMode:MTLCullModeNone];
+            [encoder setFragmentBuffer:path_tracer_uniforms.buffer offset:path_tracer_uniforms.offset atIndex:1];
+            [encoder setFragmentBuffer:_path_tracer.accumulator offset:0 atIndex:2];
+            [encoder drawPrimitives:MTLPrimitiveTypeTriangle vertexStart:0 vertexCount:3];
+            [encoder popDebugGroup];
+        }
+        else if (sky)
+        {
+            // Only the pixels still at the far plane pass the depth test.
+            [encoder pushDebugGroup:@"Skybox"];
+            [encoder setRenderPipelineState:msaa ? _skybox_state_msaa : _skybox_state];
+            [encoder setDepthStencilState:_depth_state_prepassed];
+            [encoder setCullMode:MTLCullModeNone];
+            [encoder drawPrimitives:MTLPrimitiveTypeTriangle vertexStart:0 vertexCount:3];
+            [encoder popDebugGroup];
+        }
+
+        if (point_clouds)
+        {
+            const PointRasterUniforms target = {static_cast<unsigned int>(_depth_texture.width),
+                                                static_cast<unsigned int>(_depth_texture.height)};
+            [encoder pushDebugGroup:@"PointClouds"];
+            [encoder setRenderPipelineState:deferred ? _point_cloud_state_deferred
+                                            : msaa   ? _point_cloud_state_msaa
+                                                     : _point_cloud_state];
+            [encoder setDepthStencilState:_depth_state];
+            [encoder setCullMode:MTLCullModeNone];
+            [encoder setFragmentBuffer:_point_depths offset:0 atIndex:0];
+            [encoder setFragmentBuffer:_point_colors offset:0 atIndex:1];
+            [encoder setFragmentBytes:&target length:sizeof(target) atIndex:2];
+            [encoder drawPrimitives:MTLPrimitiveTypeTriangle vertexStart:0 vertexCount:3];
+            [encoder popDebugGroup];
+        }
+        draw_debug_lines(encoder, debug_lines, uniforms_allocation,
+                         deferred ? _debug_line_state_deferred : msaa ? _debug_line_state_msaa : _debug_line_state);
+        if (!scaled && !transparency)
+            draw_2d(encoder, deferred ? _states_2d_deferred : msaa ? _states_2d_msaa : _states_2d);
+    };
+
+    // Every opaque and transparent fragment adds one to its pixel, whatever the depth, so the counts include the
+    // fragments the pre-pass would reject.
+    const auto overdraw_pass = [&]() {
+        MTLRenderPassDescriptor *overdraw_desc = pass_descriptor(OverdrawPass);
+        overdraw_desc.colorAttachments[0].texture = _overdraw;
+        overdraw_desc.colorAttachments[0].loadAction = MTLLoadActionClear;
+        overdraw_desc.colorAttachments[0].storeAction = MTLStoreActionStore;
+        overdraw_desc.colorAttachments[0].clearColor = MTLClearColorMake(0.0, 0.0, 0.0, 0.0);
+        overdraw_desc.depthAttachment.texture = _depth_texture;
+        overdraw_desc.depthAttachment.loadAction = MTLLoadActionLoad;
+        overdraw_desc.depthAttachment.storeAction = MTLStoreActionStore;
+
+        const auto overdraw_setup = [&](id<MTLRenderCommandEncoder> encoder) {
+            [encoder setDepthStencilState:_depth_state_2d];
+            [encoder setFrontFacingWinding:MTLWindingCounterClockwise];
+            [encoder setTriangleFillMode:MTLTriangleFillModeFill];
+            [encoder setCullMode:MTLCullModeBack];
+            use_3d_resources(encoder, frame_index, draw_args.valid());
+            [encoder setVertexBuffer:frame.args_buffer offset:0 atIndex:0];
+            [encoder setVertexBuffer:uniforms_allocation.buffer offset:uniforms_allocation.offset atIndex:1];
+        };
+        const auto overdraw_draw = [&](id<MTLRenderCommandEncoder> encoder, unsigned int first_mesh,
+                                       unsigned int end_mesh) {
+            encode_3d_draws(encoder, _overdraw_state_3d, draw_args, draw_commands, true, OpaqueMeshes, first_mesh,
+                            end_mesh);
+            encode_3d_draws(encoder, _overdraw_state_3d, draw_args, NSMakeRange(0, 0), true, TransparentMeshes,
+                            first_mesh, end_mesh);
+            if (late_draw_args.valid())
+            {
+                encode_3d_draws(encoder, _overdraw_state_3d, late_draw_args, late_draw_commands, false, OpaqueMeshes,
+                                first_mesh, end_mesh);
+                encode_3d_draws(encoder, _overdraw_state_3d, late_draw_args, NSMakeRange(0, 0), false,
+                                TransparentMeshes, first_mesh, end_mesh);
+            }
+        };
+        _frame_timer.time_render_pass(overdraw_desc, FRAME_PASS_3D);
+        encode_3d_pass(command_buffer, overdraw_desc, @"Overdraw", overdraw_setup, overdraw_draw, EncodeFunction());
+    };
+
+    // Frames that are not scaled draw the main pass into the drawable, which stops the frame when there is none.
+    const auto main_pass = [&](const FrameGraph::EncodeFunction &) {
+        if (overdraw_view)
+            overdraw_pass();
+        if (!scaled)
+        {
+            if (!acquire_target())
+                return false;
+            if (msaa)
+                render_desc.colorAttachments[0].resolveTexture = target;
+            else
+                render_desc.colorAttachments[0].texture = target;
+        }
+
+        if (!occlusion_view && !path_tracing)
+            count_3d_draws();
+        debug_lines = _debug_draw.upload(_upload_ring);
+        _frame_timer.time_render_pass(render_desc, FRAME_PASS_3D);
+        encode_3d_pass(command_buffer, render_desc, @"MainPass", setup, draw, finish);
+        return true;
+    };
+    _frame_graph.add_pass(ssao ? FrameAccesses{{ssao_texture, FrameGraph::Read}} : FrameAccesses{}, main_pass);
+
+    // Transparent meshes don't write depth, so they are only hidden by opaque ones.
+    const auto draw_transparent = [&](id<MTLRenderCommandEncoder> encoder, unsigned int first_mesh,
+                                      unsigned int end_mesh) {
+        [encoder setDepthStencilState:_depth_state_prepassed];
+        [encoder pushDebugGroup:@"Transparent"];
+        encode_3d_draws(encoder, _transparent_state_3d, draw_args, NSMakeRange(0, 0), true, TransparentMeshes,
+                        first_mesh, end_mesh, mesh_profiler);
+        if (late_draw_args.valid())
+            encode_3d_draws(encoder, _transparent_state_3d, late_draw_args, NSMakeRange(0, 0), false,
+                            TransparentMeshes, first_mesh, end_mesh, mesh_profiler);
+        [encoder popDebugGroup];
+        // The layers are order independent, any chunk can draw the particles.
+        if (first_mesh == 0)
+            draw_particles(encoder);
+    };
+    // Merged into the transparency pass, the composite reads the layers of its pixel from tile memory.
+    const auto composite = [&](id<MTLRenderCommandEncoder> encoder, bool merged) {
+        [encoder pushDebugGroup:@"TransparencyComposite"];
+        [encoder setRenderPipelineState:_transparency_composite_state];
+        [encoder setDepthStencilState:_depth_state_2d];
+        [encoder setCullMode:MTLCullModeNone];
+        if (!merged)
+        {
+            [encoder setFragmentTexture:_frame_graph.texture(transparent_accum) atIndex:0];
+            [encoder setFragmentTexture:_frame_graph.texture(transparent_reveal) atIndex:1];
+        }
+        [encoder drawPrimitives:MTLPrimitiveTypeTriangle vertexStart:0 vertexCount:3];
+        [encoder popDebugGroup];
+        if (!scaled)
+            draw_2d(encoder, merged ? _states_2d_transparent : _states_2d);
+    };
+    // Multisampled frames composite over the resolved color.
+    const auto composite_color = [&]() {
+        return msaa ? render_desc.colorAttachments[0].resolveTexture : render_desc.colorAttachments[0].texture;
+    };
+
+    if (transparency)
+    {
+        const auto transparency_pass = [&](const FrameGraph::EncodeFunction &merged) {
+            MTLRenderPassDescriptor *transparency_desc = pass_descriptor(TransparencyPass);
+            transparency_desc.depthAttachment.texture = _depth_texture;
+            transparency_desc.depthAttachment.loadAction = MTLLoadActionLoad;
+            transparency_desc.depthAttachment.storeAction = MTLStoreActionStore;
+            const auto set_layer = [&](unsigned int index, FrameGraph::Handle layer, MTLClearColor clear) {
+                MTLRenderPassColorAttachmentDescriptor *attachment = transparency_desc.colorAttachments[index];
+                attachment.texture = _frame_graph.texture(layer);
+                attachment.loadAction = MTLLoadActionClear;
+                attachment.storeAction = _frame_graph.memoryless(layer) ? MTLStoreActionDontCare : MTLStoreActionStore;
+                attachment.clearColor = clear;
+            };
+            set_layer(TRANSPARENT_ACCUM_INDEX, transparent_accum, MTLClearColorMake(0.0, 0.0, 0.0, 0.0));
+            set_layer(TRANSPARENT_REVEAL_INDEX, transparent_reveal, MTLClearColorMake(1.0, 0.0, 0.0, 0.0));
+            if (merged)
+            {
+                transparency_desc.colorAttachments[0].texture = composite_color();
+                transparency_desc.colorAttachments[0].loadAction = MTLLoadActionLoad;
+                transparency_desc.colorAttachments[0].storeAction = MTLStoreActionStore;
+            }
+
+            _frame_timer.time_render_pass(transparency_desc, FRAME_PASS_3D);
+            encode_3d_pass(command_buffer, transparency_desc, @"Transparency", setup, draw_transparent, merged);
+            return true;
+        };
+        const auto composite_pass = [&](const FrameGraph::EncodeFunction &) {
+            MTLRenderPassDescriptor *composite_desc = pass_descriptor(CompositePass);
+            composite_desc.colorAttachments[0].texture = composite_color();
+            composite_desc.colorAttachments[0].loadAction = MTLLoadActionLoad;
+            composite_desc.colorAttachments[0].storeAction = MTLStoreActionStore;
+            _frame_timer.time_render_pass(composite_desc, FRAME_PASS_3D);
+
+            id<MTLRenderCommandEncoder> encoder = [command_buffer renderCommandEncoderWithDescriptor:composite_desc];
+            encoder.label = @"TransparencyComposite";
+            use_2d_resources(encoder);
+            composite(encoder, false);
+            [encoder endEncoding];
+            return true;
+        };
+        // Transparent meshes are shaded with the occlusion as well.
+        FrameAccesses accesses = {{transparent_accum, FrameGraph::Attachment},
+                                  {transparent_reveal, FrameGraph::Attachment}};
+        if (ssao)
+            accesses.push_back({ssao_texture, FrameGraph::Read});
+        _frame_graph.add_pass(accesses, transparency_pass);
+        _frame_graph.add_pass({{transparent_accum, FrameGraph::TileRead}, {transparent_reveal, FrameGraph::TileRead}},
+                              composite_pass, [&](id<MTLRenderCommandEncoder> encoder) { composite(encoder, true); });
+    }
+
+    _frame_graph.compile(_device, _tile_memory, _retired);
+    if (!_frame_graph.execute(_device, _retired))
+        return FRAME_NO_DRAWABLE;
+    if (!_picks.empty())
+        encode_picks(command_buffer, frame_index, uniforms_allocation, draw_args, late_draw_args);
+    release_geometry();
+
+    if (scaled)
+    {
+        if (reflections)
+            encode_reflection_source(command_buffer);
+        id<MTLTexture> upscaled = encode_upscaling(command_buffer, combined, jitter, motion);
+        id<MTLTexture> bloom = _bloom_down.empty() ? nil : encode_bloom(command_buffer, upscaled);
+        _previous_combined = unjittered_combined;
+        _previous_relative_combined = unjittered_projection * get_rh_view_rotation(view_3d);
+        _previous_origin = vec3(view_3d.pos.x, view_3d.pos.y, view_3d.pos.z);
+
+        // EDR displays present values up to their headroom above SDR white, which changes with the display brightness.
+        ToneMapUniforms tonemap = {};
+        tonemap.enabled = _hdr != HDR_OFF ? 1 : 0;
+        tonemap.exposure = _exposure;
+        tonemap.headroom = 1.0f;
+        if (_hdr == HDR_EXTENDED && _window != nil)
+            tonemap.headroom = std::max(display_headroom(_window), 1.0f);
+        tonemap.bloom_intensity = _post.bloom_intensity;
+        tonemap.vignette_intensity = _post.vignette_intensity;
+        tonemap.vignette_radius = _post.vignette_radius;
+
+        if (!acquire_target())
+            return FRAME_NO_DRAWABLE;
+        tonemap.aspect = static_cast<float>(target.width) / static_cast<float>(std::max<NSUInteger>(target.height, 1));
+        MTLRenderPassDescriptor *overlay_desc = pass_descriptor(OverlayPass);
+        overlay_desc.colorAttachments[0].texture = target;
+        overlay_desc.colorAttachments[0].loadAction = MTLLoadActionDontCare;
+        overlay_desc.colorAttachments[0].storeAction = MTLStoreActionStore;
+        _frame_timer.time_render_pass(overlay_desc, FRAME_PASS_UPSCALE);
+
+        id<MTLRenderCommandEncoder> encoder = [command_buffer renderCommandEncoderWithDescriptor:overlay_desc];
+        encoder.label = @"Overlay";
+        use_2d_resources(encoder);
+        [encoder pushDebugGroup:@"Upscale"];
+        [encoder setRenderPipelineState:rate_mapped ? _rate_mapped_upscale_state : _upscale_state];
+        [encoder setCullMode:MTLCullModeNone];
+        [encoder setFragmentTexture:upscaled atIndex:0];
+        if (rate_mapped)
+            [encoder setFragmentBuffer:_rate_map_data offset:0 atIndex:0];
+        [encoder setFragmentBytes:&tonemap length:sizeof(ToneMapUniforms) atIndex:1];
+        [encoder setFragmentTexture:bloom atIndex:1];
+        [encoder setFragmentTexture:_grading_lut atIndex:2];
+        [encoder drawPrimitives:MTLPrimitiveTypeTriangle vertexStart:0 vertexCount:3];
+        [encoder popDebugGroup];
+        draw_2d(encoder, _states_2d);
+        [encoder endEncoding];
+    }
+
+    // Inset views are drawn over the finished frame with a camera per viewport. Every draw is amplified into the
+    // viewports from first_view on.
+    const auto num_insets = static_cast<unsigned int>(_inset_views.size());
+    const UploadAllocation inset_cameras =
+        num_insets > 0 && has_3d && !path_tracing && _inset_depth != nil
+            ? _upload_ring.allocate(sizeof(Uniforms) * num_insets)
+            : UploadAllocation{};
+    if (inset_cameras.valid())
+    {
+        std::vector<MTLViewport> viewports;
+        auto *cameras = reinterpret_cast<Uniforms *>(inset_cameras.data);
+        for (unsigned int i = 0; i < num_insets; i++)
+        {
+            const InsetView3D &inset = _inset_views[i];
+            const mat4 inset_projection = get_rh_projection_matrix(inset.view);
+            const mat4 relative_combined = inset_projection * get_rh_view_rotation(inset.view);
+            Uniforms &camera = cameras[i];
+            memcpy(&camera.projection, value_ptr(inset_projection), sizeof(mat4));
+            memcpy(&camera.view_matrix, value_ptr(get_rh_view_rotation(inset.view)), sizeof(mat4));
+            memcpy(&camera.combined, value_ptr(relative_combined), sizeof(mat4));
+            memcpy(&camera.matrix_2d, value_ptr(matrix_2d), sizeof(mat4));
+            camera.origin = simd_make_float4(inset.view.pos.x, inset.view.pos.y, inset.view.pos.z, 0.0f);
+            camera.view = inset.view;
+            memcpy(&camera.previous_combined, value_ptr(relative_combined), sizeof(mat4));
+            camera.jitter = simd_make_float4(0.0f, 0.0f, 0.0f, 0.0f);
+            viewports.push_back({inset.x, inset.y, inset.width, inset.height, 0.0, 1.0});
+        }
+
+        MTLRenderPassDescriptor *inset_desc = pass_descriptor(InsetPass);
+        inset_desc.colorAttachments[0].texture = target;
+        inset_desc.colorAttachments[0].loadAction = MTLLoadActionLoad;
+        inset_desc.colorAttachments[0].storeAction = MTLStoreActionStore;
+        inset_desc.depthAttachment.texture = _inset_depth;
+        inset_desc.depthAttachment.loadAction = MTLLoadActionClear;
+        inset_desc.depthAttachment.storeAction = MTLStoreActionDontCare;
+        inset_desc.depthAttachment.clearDepth = 0.0;
+        _frame_timer.time_render_pass(inset_desc, FRAME_PASS_3D);
+
+        id<MTLRenderCommandEncoder> encoder = [command_buffer renderCommandEncoderWithDescriptor:inset_desc];
+        encoder.label = @"InsetViews";
+        [encoder setDepthStencilState:_depth_state];
+        [encoder setFrontFacingWinding:MTLWindingCounterClockwise];
+        [encoder setTriangleFillMode:MTLTriangleFillModeFill];
+        [encoder setCullMode:MTLCullModeBack];
+        [encoder setViewports:viewports.data() count:viewports.size()];
+        use_2d_resources(encoder);
+        use_3d_resources(encoder, frame_index, false);
+        [encoder useResource:_frames[frame_index].materials usage:MTLResourceUsageRead];
+
+        [encoder setVertexBuffer:frame.args_buffer offset:0 atIndex:0];
+        [encoder setVertexBuffer:inset_cameras.buffer offset:inset_cameras.offset atIndex:1];
+        [encoder setFragmentBuffer:frame.args_buffer offset:0 atIndex:0];
+        [encoder setFragmentBuffer:lights.buffer offset:lights.offset atIndex:1];
+        const UploadAllocation &directional = directional_lights.valid() ? directional_lights : lights;
+        [encoder setFragmentBuffer:directional.buffer offset:directional.offset atIndex:4];
+        [encoder setFragmentBuffer:_irradiance offset:0 atIndex:9];
+        [encoder setFragmentBuffer:inset_cameras.buffer offset:inset_cameras.offset atIndex:10];
+        const UploadAllocation &inset_probes = probe_allocation.valid() ? probe_allocation : lights;
+        [encoder setFragmentBuffer:inset_probes.buffer offset:inset_probes.offset atIndex:11];
+        [encoder setFragmentTexture:_environment atIndex:3];
+        [encoder setFragmentTexture:_probe_maps atIndex:6];
+        [encoder setFragmentTexture:_gi.irradiance atIndex:8];
+        [encoder setFragmentTexture:_gi.distances atIndex:9];
+
+        for (unsigned int first_view = 0; first_view < num_insets; first_view += _max_amplification)
+        {
+            if (@available(macOS 10.15.4, *))
+                [encoder setVertexAmplificationCount:std::min(num_insets - first_view, _max_amplification)
+                                        viewMappings:nil];
+            [encoder setVertexBytes:&first_view length:sizeof(unsigned int) atIndex:3];
+            encode_3d_draws(encoder, _inset_state_3d, UploadAllocation{}, NSMakeRange(0, 0), true, OpaqueMeshes);
+        }
+        [encoder endEncoding];
+    }
+
+    if (_hud.enabled())
+        encode_hud(command_buffer, target);
+
+    if (stream_frame.valid() && target.width == stream_frame.texture.width &&
+        target.height == stream_frame.texture.height)
+    {
+        if (_layer != nil)
+        {
+            id<MTLBlitCommandEncoder> blit = [command_buffer blitCommandEncoder];
+            blit.label = @"VideoStream";
+            [blit copyFromTexture:target toTexture:stream_frame.texture];
+            [blit endEncoding];
+        }
+        streamed = true;
+    }
+
+    if (readback)
+    {
+        id<MTLBlitCommandEncoder> blit = [command_buffer blitCommandEncoder];
+        blit.label = @"Readback";
+        [blit copyFromTexture:target
+                         sourceSlice:0
+                         sourceLevel:0
+                        sourceOrigin:MTLOriginMake(0, 0, 0)
+                          sourceSize:MTLSizeMake(target.width, target.height, 1)
+                            toBuffer:frame.readback
+                   destinationOffset:0
+              destinationBytesPerRow:target.width * 4
+            destinationBytesPerImage:target.width * 4 * target.height];
+        [blit endEncoding];
+    }
+
+    submit();
+    _on_demand_frame.valid = true;
+    _on_demand_frame.matrix_2d = matrix_2d;
+    _on_demand_frame.view_3d = view_3d;
+    _on_demand_frame.mode = mode;
+    _on_demand_frame.changes = _changes;
+    _on_demand_frame.settle -= std::min(_on_demand_frame.settle, 1u);
+    _on_demand_frame.presented = start;
+    if (_hud.enabled())
+        _hud.add_render(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+    os_signpost_interval_end(signpost_log(), signpost, "render", "%u draws", _frame_timer.draws());
+    return FRAME_PRESENTED;
+}
+
+void MetalRenderer::encode_hud(id<MTLCommandBuffer> command_buffer, id<MTLTexture> target)
+{
+    // Memory stats walk every resource, the HUD only asks for them when it rebuilds its quads.
+    if (_hud.due())
+        _hud.update(_frame_timer.stats(), memory_stats(), _upload_ring.uploaded() + _staging.staged());
+
+    const std::vector<GlyphInstance> &glyphs = _hud.glyphs();
+    const UploadAllocation instances = _upload_ring.upload(glyphs.data(), glyphs.size());
+    const UploadAllocation camera = _upload_ring.allocate(sizeof(UniformCamera));
+    if (!instances.valid() || !camera.valid())
+        return;
+
+    // The glyph pipeline transforms by the 2D matrix of the camera, which maps drawable pixels from the top left
+    // corner to clip space here.
+    mat4 matrix = mat4(1.0f);
+    matrix[0][0] = 2.0f / static_cast<float>(target.width);
+    matrix[1][1] = -2.0f / static_cast<float>(target.height);
+    matrix[3][0] = -1.0f;
+    matrix[3][1] = 1.0f;
+    auto *uniforms = reinterpret_cast<UniformCamera *>(camera.data);
+    memcpy(&uniforms->matrix_2d, value_ptr(matrix), sizeof(mat4));
+
+    MTLRenderPassDescriptor *desc = pass_descriptor(HudPass);
+    desc.colorAttachments[0].texture = target;
+    desc.colorAttachments[0].loadAction = MTLLoadActionLoad;
+    desc.colorAttachments[0].storeAction = MTLStoreActionStore;
+    desc.renderTargetWidth = std::min<NSUInteger>(_hud.width(), target.width);
+    desc.renderTargetHeight = std::min<NSUInteger>(_hud.height(), target.height);
+
+    id<MTLRenderCommandEncoder> encoder = [command_buffer renderCommandEncoderWithDescriptor:desc];
+    encoder.label = @"PerformanceHud";
+    [encoder setRenderPipelineState:_states_2d[GLYPH_2D_STATE]];
+    [encoder setCullMode:MTLCullModeNone];
+    [encoder setVertexBuffer:camera.buffer offset:camera.offset atIndex:1];
+    [encoder setVertexBuffer:instances.buffer offset:instances.offset atIndex:2];
+    [encoder setVertexTexture:_hud.atlas() atIndex:0];
+    [encoder setFragmentTexture:_hud.atlas() atIndex:0];
+    [encoder drawPrimitives:MTLPrimitiveTypeTriangle
+                vertexStart:0
+                vertexCount:6
+              instanceCount:glyphs.size()];
+    [encoder endEncoding];
+}
+
+bool MetalRenderer::start_video_stream(const VideoStreamSettings &settings, VideoPacketCallback callback,
+                                       void *user_data)
+{
+    const CGSize size = drawable_size();
+    if (!_video_stream.start(_device, settings, static_cast<unsigned int>(std::max(size.width, 1.0)),
+                             static_cast<unsigned int>(std::max(size.height, 1.0)), callback, user_data))
+        return false;
+    // Drawables are only copied from when they are not framebuffer only.
+    _layer.framebufferOnly = NO;
+    return true;
+}
+
+void MetalRenderer::stop_video_stream()
+{
+    _video_stream.stop();
+    _layer.framebufferOnly = YES;
+}
+
+void MetalRenderer::pick(const unsigned int *pixels, unsigned int count, PickCallback callback, void *user_data)
+{
+    if (!callback)
+        return;
+
+    PickRequest request = {std::vector<PickResult>(pixels ? count : 0), callback, user_data};
+    for (size_t i = 0; i < request.results.size(); i++)
+        request.results[i] = {pixels[i * 2], pixels[i * 2 + 1], NO_PICK_HIT, NO_PICK_HIT};
+    _picks.push_back(std::move(request));
+}
+
+void MetalRenderer::encode_visibility(id<MTLCommandBuffer> command_buffer, const UploadAllocation &uniforms,
+                                      const CameraView3D &view_3d, bool rate_mapped, const MTLViewport &viewport)
+{
+    // The near plane clips boxes the camera is about to enter.
+    auto frame = std::make_shared<VisibilityQueries::Frame>(
+        _visibility.begin_frame(vec3(view_3d.pos.x, view_3d.pos.y, view_3d.pos.z), view_3d.near_plane * 2.0f));
+    id<MTLBuffer> results = nil;
+    if (!frame->boxes.empty())
+    {
+        const UploadAllocation boxes = _upload_ring.upload(frame->boxes.data(), frame->boxes.size());
+        if (!boxes.valid())
+            return;
+        results = [_device newBufferWithLength:frame->ids.size() * sizeof(uint64_t)
+                                       options:MTLResourceStorageModeShared];
+        results.label = @"VisibilityResults";
+
+        MTLRenderPassDescriptor *desc = pass_descriptor(VisibilityPass);
+        desc.depthAttachment.texture = _depth_texture;
+        desc.depthAttachment.loadAction = MTLLoadActionLoad;
+        desc.depthAttachment.storeAction = MTLStoreActionStore;
+        desc.visibilityResultBuffer = results;
+        if (rate_mapped)
+            desc.rasterizationRateMap = _rate_map;
+
+        id<MTLRenderCommandEncoder> encoder = [command_buffer renderCommandEncoderWithDescriptor:desc];
+        encoder.label = @"Visibility";
+        if (rate_mapped)
+            [encoder setViewport:viewport];
+        [encoder setRenderPipelineState:_visibility_state];
+        [encoder setDepthStencilState:_depth_state_prepassed];
+        [encoder setCullMode:MTLCullModeNone];
+        [encoder setVertexBuffer:boxes.buffer offset:boxes.offset atIndex:0];
+        [encoder setVertexBuffer:uniforms.buffer offset:uniforms.offset atIndex:1];
+        for (size_t i = 0; i < frame->boxes.size(); i++)
+        {
+            [encoder setVisibilityResultMode:MTLVisibilityResultModeCounting offset:i * sizeof(uint64_t)];
+            [encoder drawPrimitives:MTLPrimitiveTypeTriangleStrip vertexStart:0 vertexCount:14 instanceCount:1
+                       baseInstance:i];
+        }
+        [encoder setVisibilityResultMode:MTLVisibilityResultModeDisabled offset:0];
+        [encoder endEncoding];
+    }
+
+    VisibilityQueries *visibility = &_visibility;
+    [command_buffer addCompletedHandler:^(id<MTLCommandBuffer> completed) {
+      if (completed.status == MTLCommandBufferStatusCompleted)
+          visibility->resolve(*frame, reinterpret_cast<const uint64_t *>(results.contents));
+    }];
+}
+
+bool MetalRenderer::trace_rays(const RayQuery *rays, unsigned int count, bool any_hit, RayQueryCallback callback,
+                               void *user_data)
+{
+    if (!_ray_tracing_supported)
+        return false;
+    if (callback)
+        _ray_queries.push_back({std::vector<RayQuery>(rays, rays ? rays + count : rays), any_hit, callback, user_data});
+    return true;
+}
+
+void MetalRenderer::encode_ray_queries(id<MTLCommandBuffer> command_buffer, bool traced)
+{
+    std::vector<RayQueryRequest> queries = std::move(_ray_queries);
+    _ray_queries.clear();
+    size_t total = 0;
+    for (const RayQueryRequest &request : queries)
+        total += request.rays.size();
+
+    // Hits name traced instances, which are resolved to their instance slots and those to lists on completion.
+    std::vector<unsigned int> traced_slots;
+    id<MTLBuffer> hits = nil;
+    if (traced && total > 0)
+    {
+        for (const TracedInstance &instance : traced_instances())
+            traced_slots.push_back(instance.instance);
+        hits = [_device newBufferWithLength:total * sizeof(PathHit) options:MTLResourceStorageModeShared];
+        hits.label = @"RayQueryHits";
+
+        id<MTLComputeCommandEncoder> encoder = _frame_timer.compute_encoder(command_buffer, FRAME_PASS_SKINNING);
+        encoder.label = @"RayQueries";
+        [encoder setComputePipelineState:_ray_query_state];
+        set_traced_scene(encoder, 4);
+        size_t offset = 0;
+        for (const RayQueryRequest &request : queries)
+        {
+            const auto count = static_cast<unsigned int>(request.rays.size());
+            const UploadAllocation rays = _upload_ring.upload(request.rays.data(), request.rays.size());
+            if (count > 0 && rays.valid())
+            {
+                const unsigned int any_hit = request.any_hit ? 1 : 0;
+                [encoder setBuffer:rays.buffer offset:rays.offset atIndex:0];
+                [encoder setBuffer:hits offset:offset * sizeof(PathHit) atIndex:1];
+                [encoder setBytes:&count length:sizeof(unsigned int) atIndex:2];
+                [encoder setBytes:&any_hit length:sizeof(unsigned int) atIndex:3];
+                [encoder dispatchThreadgroups:MTLSizeMake((count + 63) / 64, 1, 1)
+                        threadsPerThreadgroup:MTLSizeMake(64, 1, 1)];
+            }
+            else
+            {
+                // Queries the ring had no room for miss.
+                std::fill_n(reinterpret_cast<PathHit *>(hits.contents) + offset, count, PathHit{~0u, 0, 0.0f, 0});
+            }
+            offset += count;
+        }
+        [encoder endEncoding];
+    }
+
+    const InstanceSlots slots(_instance_3d_list);
+    [command_buffer addCompletedHandler:^(id<MTLCommandBuffer> completed) {
+      const bool failed = completed.status != MTLCommandBufferStatusCompleted || hits == nil;
+      const auto *gpu_hits = failed ? nullptr : reinterpret_cast<const PathHit *>(hits.contents);
+      size_t next = 0;
+      for (const RayQueryRequest &request : queries)
+      {
+          const RayHit miss = {0.0f, NO_RAY_HIT, NO_RAY_HIT, NO_RAY_HIT, 0.0f, 0.0f};
+          std::vector<RayHit> results(request.rays.size(), miss);
+          for (RayHit &result : results)
+          {
+              const PathHit *hit = gpu_hits ? &gpu_hits[next] : nullptr;
+              next++;
+              if (!hit || hit->instance >= traced_slots.size() ||
+                  !slots.resolve(traced_slots[hit->instance], &result.mesh, &result.instance))
+                  continue;
+              const simd_float2 barycentrics = simd_make_float2(static_cast<float>(hit->barycentrics & 0xFFFF),
+                                                                static_cast<float>(hit->barycentrics >> 16)) /
+                                               65535.0f;
+              result.distance = hit->distance;
+              result.primitive = hit->primitive;
+              result.u = barycentrics.x;
+              result.v = barycentrics.y;
+          }
+          request.callback(request.user_data, results.data(), static_cast<unsigned int>(results.size()));
+      }
+    }];
+}
+
+bool MetalRenderer::bake_pvs(const PvsSettings &settings, PvsCallback callback, void *user_data)
+{
+    if (!_ray_tracing_supported)
+        return false;
+    const simd_float4 size = settings.bounds.bmax - settings.bounds.bmin;
+    if (!callback || settings.cell_size <= 0.0f || simd_any(size.xyz <= 0.0f))
+    {
+        NSLog(@"The PVS bake has no callback, cells or bounds.");
+        return true;
+    }
+
+    PvsBake bake;
+    bake.settings = settings;
+    bake.settings.rays_per_cell = std::max(settings.rays_per_cell, 1u);
+    bake.settings.rays_per_frame =
+        std::max(settings.rays_per_frame == 0 ? 1u << 20 : settings.rays_per_frame, bake.settings.rays_per_cell);
+    bake.cells = glm::uvec3(glm::max(glm::ceil(vec3(size.x, size.y, size.z) / settings.cell_size), vec3(1.0f)));
+    bake.callback = callback;
+    bake.user_data = user_data;
+    _pvs_bakes.push_back(bake);
+    return true;
+}
+
+void MetalRenderer::set_pvs(const PvsData &pvs)
+{
+    _pvs.set(pvs);
+    _pvs_cell = PotentiallyVisibleSet::NO_CELL;
+    _draw_commands_dirty = true;
+}
+
+void MetalRenderer::encode_pvs_bake(id<MTLCommandBuffer> command_buffer)
+{
+    PvsBake &bake = _pvs_bakes.front();
+    const std::vector<TracedInstance> &traced = traced_instances();
+    const auto num_traced = static_cast<unsigned int>(traced.size());
+    const unsigned int num_cells = bake.cells.x * bake.cells.y * bake.cells.z;
+    const unsigned int words = (num_traced + 31) / 32;
+    if (bake.hits == nil || num_traced != bake.num_traced)
+    {
+        // Hits name traced instances, whose indices change with the meshes of the scene.
+        const NSUInteger length = std::max<NSUInteger>(NSUInteger(num_cells) * words * sizeof(unsigned int), 4);
+        if (length > _device.maxBufferLength || NSUInteger(num_cells) * bake.settings.rays_per_cell > ~0u)
+        {
+            NSLog(@"The PVS of %u cells and %u traced instances is too large to bake.", num_cells, num_traced);
+            _pvs_bakes.erase(_pvs_bakes.begin());
+            return;
+        }
+        _retired.retire(bake.hits);
+        bake.hits = [_device newBufferWithLength:length options:MTLResourceStorageModeShared];
+        bake.hits.label = @"PvsHits";
+        bake.num_traced = num_traced;
+        bake.next_cell = 0;
+    }
+
+    const unsigned int cells =
+        std::min(std::max(bake.settings.rays_per_frame / bake.settings.rays_per_cell, 1u), num_cells - bake.next_cell);
+    PvsUniforms uniforms = {};
+    uniforms.origin = bake.settings.bounds.bmin;
+    uniforms.cell_size = bake.settings.cell_size;
+    uniforms.cells_x = bake.cells.x;
+    uniforms.cells_y = bake.cells.y;
+    uniforms.first_cell = bake.next_cell;
+    uniforms.count = cells * bake.settings.rays_per_cell;
+    uniforms.rays_per_cell = bake.settings.rays_per_cell;
+    uniforms.words_per_cell = words;
+    uniforms.num_traced = num_traced;
+
+    id<MTLComputeCommandEncoder> encoder = _frame_timer.compute_encoder(command_buffer, FRAME_PASS_SKINNING);
+    encoder.label = @"PvsBake";
+    [encoder setComputePipelineState:_pvs_bake_state];
+    [encoder setBytes:&uniforms length:sizeof(uniforms) atIndex:0];
+    [encoder setBuffer:bake.hits offset:0 atIndex:1];
+    set_traced_scene(encoder, 2);
+    [encoder dispatchThreadgroups:MTLSizeMake((uniforms.count + 63) / 64, 1, 1)
+            threadsPerThreadgroup:MTLSizeMake(64, 1, 1)];
+    [encoder endEncoding];
+
+    bake.next_cell += cells;
+    if (bake.next_cell < num_cells)
+        return;
+
+    // Traced instances resolve to the meshes of their slots now, the hits of all cells once the frame completed. The
+    // meshes of a prefab share the slots of its first mesh, a hit on any of them shows all of them.
+    const InstanceSlots slots(_instance_3d_list);
+    std::vector<unsigned int> meshes;
+    IdTable<unsigned int> mesh_bits;
+    const auto mesh_bit = [&](unsigned int mesh) {
+        if (const unsigned int *bit = mesh_bits.find(mesh))
+            return *bit;
+        const auto bit = static_cast<unsigned int>(meshes.size());
+        mesh_bits.insert(mesh, bit);
+        meshes.push_back(mesh);
+        return bit;
+    };
+    std::vector<std::vector<unsigned int>> traced_bits(num_traced);
+    for (unsigned int i = 0; i < num_traced; i++)
+    {
+        unsigned int mesh = 0;
+        unsigned int instance = 0;
+        if (!slots.resolve(traced[i].instance, &mesh, &instance))
+            continue;
+        traced_bits[i].push_back(mesh_bit(mesh));
+        if (const std::vector<unsigned int> *members = _prefab_members.find(mesh))
+        {
+            for (const unsigned int member : *members)
+                traced_bits[i].push_back(mesh_bit(member));
+        }
+    }
+
+    id<MTLBuffer> hits = bake.hits;
+    const PvsSettings settings = bake.settings;
+    const glm::uvec3 grid = bake.cells;
+    const PvsCallback callback = bake.callback;
+    void *user_data = bake.user_data;
+    _pvs_bakes.erase(_pvs_bakes.begin());
+    [command_buffer addCompletedHandler:^(id<MTLCommandBuffer> completed) {
+      if (completed.status != MTLCommandBufferStatusCompleted)
+          return;
+      const auto num_meshes = static_cast<unsigned int>(meshes.size());
+      const std::vector<unsigned int> bits = pvs_mesh_bits(reinterpret_cast<const unsigned int *>(hits.contents),
+                                                           num_cells, words, traced_bits, (num_meshes + 31) / 32);
+      PvsData pvs = {};
+      pvs.bounds = settings.bounds;
+      pvs.cell_size = settings.cell_size;
+      pvs.cells_x = grid.x;
+      pvs.cells_y = grid.y;
+      pvs.cells_z = grid.z;
+      pvs.meshes = meshes.data();
+      pvs.num_meshes = num_meshes;
+      pvs.bits = bits.data();
+      callback(user_data, &pvs);
+    }];
+}
+
+void MetalRenderer::encode_picks(id<MTLCommandBuffer> command_buffer, unsigned int frame_index,
+                                 const UploadAllocation &uniforms, const UploadAllocation &draw_args,
+                                 const UploadAllocation &late_draw_args)
+{
+    const NSUInteger width = _depth_texture.width;
+    const NSUInteger height = _depth_texture.height;
+    if (_pick_ids == nil || _pick_ids.width != width || _pick_ids.height != height)
+    {
+        _retired.retire(_pick_ids, _pick_depth);
+        MTLTextureDescriptor *desc = [MTLTextureDescriptor texture2DDescriptorWithPixelFormat:MTLPixelFormatR32Uint
+                                                                                        width:width
+                                                                                       height:height
+                                                                                    mipmapped:NO];
+        desc.usage = MTLTextureUsageRenderTarget;
+        desc.storageMode = MTLStorageModePrivate;
+        _pick_ids = [_device newTextureWithDescriptor:desc];
+        _pick_ids.label = @"PickIds";
+        desc.pixelFormat = MTLPixelFormatDepth32Float;
+        if (@available(macOS 11.0, *))
+        {
+            if (_memoryless)
+                desc.storageMode = MTLStorageModeMemoryless;
+        }
+        _pick_depth = [_device newTextureWithDescriptor:desc];
+        _pick_depth.label = @"PickDepth";
+    }
+
+    // Picks are in drawable pixels, the pass draws at the render resolution.
+    std::vector<PickRequest> picks = std::move(_picks);
+    _picks.clear();
+    const CGSize size = drawable_size();
+    const double scale_x = static_cast<double>(width) / std::max(size.width, 1.0);
+    const double scale_y = static_cast<double>(height) / std::max(size.height, 1.0);
+    std::vector<MTLOrigin> origins;
+    NSUInteger min_x = width, min_y = height, max_x = 0, max_y = 0;
+    for (const PickRequest &request : picks)
+    {
+        for (const PickResult &result : request.results)
+        {
+            const NSUInteger x = std::min(static_cast<NSUInteger>(result.x * scale_x), width - 1);
+            const NSUInteger y = std::min(static_cast<NSUInteger>(result.y * scale_y), height - 1);
+            origins.push_back(MTLOriginMake(x, y, 0));
+            min_x = std::min(min_x, x);
+            min_y = std::min(min_y, y);
+            max_x = std::max(max_x, x);
+            max_y = std::max(max_y, y);
+        }
+    }
+
+    // The slots of every list this frame draws, results are resolved against them once the frame completed.
+    const InstanceSlots slots(_instance_3d_list);
+
+    id<MTLBuffer> readback = nil;
+    if (!origins.empty())
+    {
+        readback = [_device newBufferWithLength:origins.size() * sizeof(unsigned int)
+                                        options:MTLResourceStorageModeShared];
+        readback.label = @"PickReadback";
+
+        MTLRenderPassDescriptor *pick_desc = pass_descriptor(PickPass);
+        pick_desc.colorAttachments[0].texture = _pick_ids;
+        pick_desc.colorAttachments[0].loadAction = MTLLoadActionClear;
+        pick_desc.colorAttachments[0].clearColor = MTLClearColorMake(NO_PICK_HIT, 0.0, 0.0, 0.0);
+        pick_desc.colorAttachments[0].storeAction = MTLStoreActionStore;
+        pick_desc.depthAttachment.texture = _pick_depth;
+        pick_desc.depthAttachment.loadAction = MTLLoadActionClear;
+        pick_desc.depthAttachment.storeAction = MTLStoreActionDontCare;
+
+        const FrameResources &frame = _frames[frame_index];
+        const MTLScissorRect scissor = {min_x, min_y, max_x - min_x + 1, max_y - min_y + 1};
+        const auto setup = [&](id<MTLRenderCommandEncoder> encoder) {
+            [encoder setScissorRect:scissor];
+            [encoder setDepthStencilState:_depth_state];
+            [encoder setFrontFacingWinding:MTLWindingCounterClockwise];
+            [encoder setTriangleFillMode:MTLTriangleFillModeFill];
+            [encoder setCullMode:MTLCullModeBack];
+            use_3d_resources(encoder, frame_index, draw_args.valid());
+            [encoder setVertexBuffer:frame.args_buffer offset:0 atIndex:0];
+            [encoder setVertexBuffer:uniforms.buffer offset:uniforms.offset atIndex:1];
+        };
+        const Pipelines3D &states =
+            _vertex_3d_list.position_buffer() != nil ? _position_pick_state_3d : _pick_state_3d;
+        const auto draw = [&](id<MTLRenderCommandEncoder> encoder, unsigned int first_mesh, unsigned int end_mesh) {
+            if (slots.empty())
+                return;
+            encode_3d_draws(encoder, states, draw_args, NSMakeRange(0, 0), true, OpaqueMeshes, first_mesh, end_mesh);
+            if (late_draw_args.valid())
+                encode_3d_draws(encoder, states, late_draw_args, NSMakeRange(0, 0), false, OpaqueMeshes, first_mesh,
+                                end_mesh);
+        };
+        encode_3d_pass(command_buffer, pick_desc, @"Pick", setup, draw, EncodeFunction());
+
+        id<MTLBlitCommandEncoder> blit = [command_buffer blitCommandEncoder];
+        blit.label = @"PickReadback";
+        for (size_t i = 0; i < origins.size(); i++)
+        {
+            [blit copyFromTexture:_pick_ids
+                             sourceSlice:0
+                             sourceLevel:0
+                            sourceOrigin:origins[i]
+                              sourceSize:MTLSizeMake(1, 1, 1)
+                                toBuffer:readback
+                       destinationOffset:i * sizeof(unsigned int)
+                  destinationBytesPerRow:sizeof(unsigned int)
+                destinationBytesPerImage:sizeof(unsigned int)];
+        }
+        [blit endEncoding];
+    }
+
+    [command_buffer addCompletedHandler:^(id<MTLCommandBuffer> completed) {
+      const bool failed = completed.status != MTLCommandBufferStatusCompleted || readback == nil;
+      const auto *ids = failed ? nullptr : reinterpret_cast<const unsigned int *>(readback.contents);
+      size_t next = 0;
+      for (const PickRequest &request : picks)
+      {
+          std::vector<PickResult> results = request.results;
+          for (PickResult &result : results)
+          {
+              const unsigned int slot = ids ? ids[next] : NO_PICK_HIT;
+              next++;
+              if (slot != NO_PICK_HIT)
+                  slots.resolve(slot, &result.mesh, &result.instance);
+          }
+          request.callback(request.user_data, results.data(), static_cast<unsigned int>(results.size()));
+      }
+    }];
+}
+
+void MetalRenderer::resize(unsigned int width, unsigned int height, double scale)
+{
+    const auto scale_f = static_cast<float>(scale);
+    const CGSize size = CGSizeMake(static_cast<float>(width) * scale_f, static_cast<float>(height) * scale_f);
+
+    if (_layer != nil)
+    {
+#if TARGET_OS_IPHONE
+        _layer.frame = _window.layer.bounds;
+        _layer.contentsScale = scale;
+#endif
+        [_layer setDrawableSize:size];
+    }
+    else
+    {
+        _offscreen_size = size;
+    }
+    _targets_dirty = true;
+}
+
+CAMetalLayer *MetalRenderer::attach_layer(PlatformWindow *window, CGSize size)
+{
+    CAMetalLayer *layer = [CAMetalLayer layer];
+    layer.device = _device;
+    layer.pixelFormat = MTLPixelFormatBGRA8Unorm;
+    layer.presentsWithTransaction = false;
+    layer.maximumDrawableCount = 3;
+    layer.framebufferOnly = !_video_stream.active();
+
+#if TARGET_OS_IPHONE
+    // Views keep the layer UIKit gave them, the drawables cover it from a sublayer that resize() keeps in its bounds.
+    layer.frame = window.layer.bounds;
+    layer.contentsScale = window.layer.bounds.size.width > 0.0 ? size.width / window.layer.bounds.size.width : 1.0;
+    [window.layer addSublayer:layer];
+#else
+    layer.displaySyncEnabled = false;
+    window.contentView.wantsLayer = YES;
+    window.contentView.layer = layer;
+#endif
+    layer.drawableSize = size;
+    return layer;
+}
+
+unsigned int MetalRenderer::add_surface(void *ns_window, unsigned int width, unsigned int height, double scale)
+{
+    if (!ns_window)
+        return ~0u;
+
+    // Ids of removed surfaces are given out again.
+    unsigned int id = 1;
+    while (id < _surfaces.size() && (id == _surface || _surfaces[id].layer != nil))
+        id++;
+    if (id == _surfaces.size())
+        _surfaces.emplace_back();
+
+    const auto scale_f = static_cast<float>(scale);
+    const CGSize size = CGSizeMake(static_cast<float>(width) * scale_f, static_cast<float>(height) * scale_f);
+    PlatformWindow *window = (__bridge PlatformWindow *)ns_window;
+    Surface &surface = _surfaces[id];
+    surface = Surface();
+    surface.window = window;
+    surface.layer = attach_layer(window, size);
+    return id;
+}
+
+void MetalRenderer::remove_surface(unsigned int surface)
+{
+    if (surface == 0 || surface >= _surfaces.size() || (surface != _surface && _surfaces[surface].layer == nil))
+        return;
+
+    // Frames in flight may still draw into its targets and present to its layer.
+    acquire_all_frames();
+    if (surface == _surface)
+        select_surface(0);
+    _surfaces[surface] = Surface();
+    release_all_frames();
+}
+
+bool MetalRenderer::select_surface(unsigned int surface)
+{
+    if (surface == _surface)
+        return true;
+    if (surface >= _surfaces.size() || (surface != 0 && _surfaces[surface].layer == nil))
+        return false;
+
+    // Frames in flight keep the targets and drawables they were encoded with, selecting only exchanges members.
+    const NSUInteger drawable_count = _layer != nil ? _layer.maximumDrawableCount : 3;
+    swap_surface(_surfaces[_surface]);
+    swap_surface(_surfaces[surface]);
+    _surface = surface;
+    if (_layer == nil)
+        return true;
+
+    // Settings changed while the surface was not selected apply to its layer now.
+    update_layer_format();
+#if !TARGET_OS_IPHONE
+    _layer.displaySyncEnabled = _present_mode != PRESENT_IMMEDIATE;
+#endif
+    _layer.maximumDrawableCount = drawable_count;
+    if (_frame_timeout < 0.0)
+        _drawable_queue = nil;
+    else if (_drawable_queue == nil)
+        _drawable_queue = [[RfwDrawableQueue alloc] initWithLayer:_layer];
+    return true;
+}
+
+void MetalRenderer::swap_surface(Surface &surface)
+{
+    std::swap(_layer, surface.layer);
+    std::swap(_window, surface.window);
+    std::swap(_drawable_queue, surface.drawable_queue);
+
+    std::swap(_target_pool, surface.target_pool);
+    std::swap(_targets_dirty, surface.targets_dirty);
+    std::swap(_frame_graph, surface.frame_graph);
+    std::swap(_depth_texture, surface.depth_texture);
+    std::swap(_gbuffer, surface.gbuffer);
+    std::swap(_msaa_color, surface.msaa_color);
+    std::swap(_msaa_depth, surface.msaa_depth);
+    std::swap(_ray_traced, surface.ray_traced);
+    std::swap(_scaled_color, surface.scaled_color);
+    std::swap(_rate_map, surface.rate_map);
+    std::swap(_rate_map_data, surface.rate_map_data);
+    std::swap(_inset_depth, surface.inset_depth);
+
+    std::swap(_depth_pyramid, surface.depth_pyramid);
+    std::swap(_depth_pyramid_levels, surface.depth_pyramid_levels);
+    std::swap(_depth_pyramid_combined, surface.depth_pyramid_combined);
+    std::swap(_depth_pyramid_valid, surface.depth_pyramid_valid);
+
+    std::swap(_previous_combined, surface.previous_combined);
+    std::swap(_previous_relative_combined, surface.previous_relative_combined);
+    std::swap(_previous_origin, surface.previous_origin);
+    std::swap(_jitter_index, surface.jitter_index);
+    std::swap(_motion_vectors, surface.motion_vectors);
+    std::swap(_previous_instances, surface.previous_instances);
+    std::swap(_previous_instances_layout, surface.previous_instances_layout);
+    std::swap(_taa_history, surface.taa_history);
+    std::swap(_taa_index, surface.taa_index);
+    std::swap(_taa_reset, surface.taa_reset);
+    std::swap(_on_demand_frame, surface.on_demand);
+    std::swap(_bloom_down, surface.bloom_down);
+    std::swap(_bloom_up, surface.bloom_up);
+#ifdef RFW_METAL_FX
+    if (@available(macOS 13.0, *))
+        std::swap(_temporal_scaler, surface.temporal_scaler);
+    std::swap(_upscaled, surface.upscaled);
+    std::swap(_upscale_reset, surface.upscale_reset);
+#endif
+
+    std::swap(_path_tracer.paths, surface.path_tracer.paths);
+    std::swap(_path_tracer.hits, surface.path_tracer.hits);
+    std::swap(_path_tracer.shadow_rays, surface.path_tracer.shadow_rays);
+    std::swap(_path_tracer.counters, surface.path_tracer.counters);
+    std::swap(_path_tracer.accumulator, surface.path_tracer.accumulator);
+    std::swap(_path_tracer.samples, surface.path_tracer.samples);
+    std::swap(_path_tracer.view, surface.path_tracer.view);
+    std::swap(_path_tracer.traced, surface.path_tracer.traced);
+    std::swap(_path_tracer.surfaces, surface.path_tracer.surfaces);
+    std::swap(_path_tracer.history, surface.path_tracer.history);
+    std::swap(_path_tracer.filtered, surface.path_tracer.filtered);
+    std::swap(_path_tracer.history_valid, surface.path_tracer.history_valid);
+    std::swap(_path_tracer.previous_combined, surface.path_tracer.previous_combined);
+    std::swap(_path_tracer.radiance, surface.path_tracer.radiance);
+    std::swap(_path_tracer.moments, surface.path_tracer.moments);
+    std::swap(_path_tracer.tiles, surface.path_tracer.tiles);
+    std::swap(_path_tracer.progress, surface.path_tracer.progress);
+    std::swap(_path_tracer.render, surface.path_tracer.render);
+
+    std::swap(_reflections.hzb, surface.reflections.hzb);
+    std::swap(_reflections.hzb_levels, surface.reflections.hzb_levels);
+    std::swap(_reflections.traced, surface.reflections.traced);
+    std::swap(_reflections.source, surface.reflections.source);
+    std::swap(_reflections.history, surface.reflections.history);
+    std::swap(_reflections.rays, surface.reflections.rays);
+    std::swap(_reflections.counters, surface.reflections.counters);
+    std::swap(_reflections.history_index, surface.reflections.history_index);
+    std::swap(_reflections.history_valid, surface.reflections.history_valid);
+    std::swap(_reflections.source_valid, surface.reflections.source_valid);
+    std::swap(_path_tracer.started, surface.path_tracer.started);
+    std::swap(_path_tracer.finished, surface.path_tracer.finished);
+    std::swap(_path_tracer.seconds, surface.path_tracer.seconds);
+}
+
+void MetalRenderer::invalidate_surface_targets()
+{
+    for (Surface &surface : _surfaces)
+        surface.targets_dirty = true;
+}
+
+bool MetalRenderer::frame_needed(const mat4 &matrix_2d, const CameraView3D &view_3d, RenderMode3D mode)
+{
+    OnDemandFrame &last = _on_demand_frame;
+    if (!last.valid || last.changes != _changes || _targets_dirty || last.matrix_2d != matrix_2d ||
+        memcmp(&last.view_3d, &view_3d, sizeof(CameraView3D)) != 0 || last.mode != mode || _skinning_dirty ||
+        !_hierarchy.updates.empty() || _video.pending())
+    {
+        last.settle = ON_DEMAND_SETTLE_FRAMES;
+        return true;
+    }
+    if (last.settle > 0)
+        return true;
+
+    // Work that is only done by frames, or that takes more than one.
+    const bool has_3d = !_instance_3d_list.get_ranges().empty();
+    const unsigned int probes = _gi.volume.count_x * _gi.volume.count_y * _gi.volume.count_z;
+    if (!_picks.empty() || !_ray_queries.empty() || !_pvs_bakes.empty() || !_lightmap_bakes.empty() ||
+        !_impostor_bakes.empty() || _render_textures.pending() ||
+        (has_3d && mode != RENDER_PATH_TRACED && _gi.updated < probes))
+        return true;
+    if (mode == RENDER_PATH_TRACED && _ray_tracing_supported && has_3d &&
+        (_path_tracer.denoise || !_path_tracer.finished))
+        return true;
+    return _heartbeat > 0.0f &&
+           std::chrono::duration<float>(std::chrono::steady_clock::now() - last.presented).count() >= _heartbeat;
+}
+
+id<MTLTexture> MetalRenderer::offscreen_target(FrameResources &frame)
+{
+    const auto width = std::max(static_cast<NSUInteger>(_offscreen_size.width), NSUInteger(1));
+    const auto height = std::max(static_cast<NSUInteger>(_offscreen_size.height), NSUInteger(1));
+    if (frame.target != nil && frame.target.width == width && frame.target.height == height)
+        return frame.target;
+
+    // Every frame in flight has its own target, so frames don't wait on the readback of the previous one.
+    MTLTextureDescriptor *desc = [MTLTextureDescriptor texture2DDescriptorWithPixelFormat:MTLPixelFormatBGRA8Unorm
+                                                                                    width:width
+                                                                                   height:height
+                                                                                mipmapped:NO];
+    desc.storageMode = MTLStorageModePrivate;
+    desc.usage = MTLTextureUsageRenderTarget | MTLTextureUsageShaderRead;
+    frame.target = [_device newTextureWithDescriptor:desc];
+    frame.target.label = @"OffscreenTarget";
+    return frame.target;
+}
+
+void MetalRenderer::create_render_targets()
+{
+    // The new targets take the place of the previous ones in the pool. The depth pyramid is created again by the next
+    // frame that needs it.
+    _depth_texture = nil;
+    _particle_depth_valid = false;
+    _gbuffer = {};
+    _msaa_color = nil;
+    _msaa_depth = nil;
+    _inset_depth = nil;
+    _ray_traced = nil;
+    _depth_pyramid = nil;
+    _depth_pyramid_levels.clear();
+    _scaled_color = nil;
+    _motion_vectors = nil;
+    _taa_history = {};
+#ifdef RFW_METAL_FX
+    _upscaled = nil;
+    if (@available(macOS 13.0, *))
+        _temporal_scaler = nil;
+#endif
+    _targets_dirty = false;
+
+    const CGSize size = drawable_size();
+    MTLTextureDescriptor *tex_desc = [[MTLTextureDescriptor alloc] init];
+    tex_desc.pixelFormat = MTLPixelFormatDepth32Float;
+    tex_desc.width = std::max(static_cast<NSUInteger>(size.width * render_scale()), NSUInteger(1));
+    tex_desc.height = std::max(static_cast<NSUInteger>(size.height * render_scale()), NSUInteger(1));
+    tex_desc.depth = 1;
+    tex_desc.textureType = MTLTextureType2D;
+    tex_desc.storageMode = MTLStorageModePrivate;
+    // Light culling reads the depth of the pre-pass.
+    tex_desc.usage = MTLTextureUsageRenderTarget | MTLTextureUsageShaderRead;
+
+    // Dynamically scaled targets keep the heap of the largest scale.
+    const double max_scale = _dynamic_resolution.enabled() ? _dynamic_resolution.max_scale() : 0.0;
+    _target_pool.reserve(_device, tex_desc.width * tex_desc.height,
+                         static_cast<size_t>(size.width * max_scale) * static_cast<size_t>(size.height * max_scale));
+    _depth_texture = _target_pool.create(_device, tex_desc);
+    create_gbuffer();
+    create_msaa_targets();
+    create_ray_traced_target();
+    create_rate_map();
+    create_scaled_targets();
+    if (!_inset_views.empty())
+    {
+        const NSUInteger width = std::max(static_cast<NSUInteger>(size.width), NSUInteger(1));
+        const NSUInteger height = std::max(static_cast<NSUInteger>(size.height), NSUInteger(1));
+        MTLTextureDescriptor *desc = [MTLTextureDescriptor texture2DDescriptorWithPixelFormat:MTLPixelFormatDepth32Float
+                                                                                        width:width
+                                                                                       height:height
+                                                                                    mipmapped:NO];
+        desc.usage = MTLTextureUsageRenderTarget;
+        desc.storageMode = MTLStorageModePrivate;
+        if (@available(macOS 11.0, *))
+        {
+            if (_memoryless)
+                desc.storageMode = MTLStorageModeMemoryless;
+        }
+        _inset_depth = _target_pool.create(_device, desc);
+        _inset_depth.label = @"InsetDepth";
+    }
+
+    // Path tracer buffers are created again with the new size once they are used.
+    _path_tracer.paths = nil;
+    _path_tracer.hits = nil;
+    _path_tracer.shadow_rays = nil;
+    _path_tracer.counters = nil;
+    _path_tracer.accumulator = nil;
+    _path_tracer.samples = 0;
+    _path_tracer.surfaces = {};
+    _path_tracer.history = {};
+    _path_tracer.filtered = {};
+    _path_tracer.history_valid = false;
+    _path_tracer.radiance = nil;
+    _path_tracer.moments = nil;
+    _path_tracer.tiles = nil;
+    _path_tracer.progress = nil;
+
+    // So are the reflection targets.
+    _reflections.hzb = nil;
+    _reflections.hzb_levels.clear();
+    _reflections.traced = nil;
+    _reflections.source = nil;
+    _reflections.history = {};
+    _reflections.rays = nil;
+    _reflections.counters = nil;
+    _reflections.history_valid = false;
+    _reflections.source_valid = false;
+}
+
+void MetalRenderer::create_gbuffer()
+{
+    if (!_tile_memory)
+        return;
+
+    for (unsigned int i = 0; i < _gbuffer.size(); i++)
+    {
+        MTLTextureDescriptor *desc = [MTLTextureDescriptor texture2DDescriptorWithPixelFormat:GBUFFER_FORMATS[i]
+                                                                                        width:_depth_texture.width
+                                                                                       height:_depth_texture.height
+                                                                                    mipmapped:NO];
+        desc.usage = MTLTextureUsageRenderTarget;
+        if (@available(macOS 11.0, *))
+            desc.storageMode = MTLStorageModeMemoryless;
+        _gbuffer[i] = _target_pool.create(_device, desc);
+    }
+}
+
+void MetalRenderer::create_msaa_targets()
+{
+    _retired.retire(_msaa_color, _msaa_depth);
+    _msaa_color = nil;
+    _msaa_depth = nil;
+    if (_msaa_samples <= 1)
+        return;
+
+    const auto create_target = [&](MTLPixelFormat format) {
+        MTLTextureDescriptor *desc = [MTLTextureDescriptor texture2DDescriptorWithPixelFormat:format
+                                                                                        width:_depth_texture.width
+                                                                                       height:_depth_texture.height
+                                                                                    mipmapped:NO];
+        desc.textureType = MTLTextureType2DMultisample;
+        desc.sampleCount = _msaa_samples;
+        desc.usage = MTLTextureUsageRenderTarget;
+        desc.storageMode = MTLStorageModePrivate;
+        // Samples are resolved at the end of the pass, so they never need to leave tile memory.
+        if (@available(macOS 11.0, *))
+        {
+            if (_memoryless)
+                desc.storageMode = MTLStorageModeMemoryless;
+        }
+        return _target_pool.create(_device, desc);
+    };
+    _msaa_color = create_target(scene_format());
+    _msaa_depth = create_target(MTLPixelFormatDepth32Float);
+}
+
+void MetalRenderer::create_scaled_targets()
+{
+    _retired.retire(_scaled_color, _motion_vectors, _taa_history[0], _taa_history[1]);
+    _scaled_color = nil;
+    _motion_vectors = nil;
+    _taa_history = {};
+    for (id<MTLTexture> level : _bloom_down)
+        _retired.retire(level);
+    for (id<MTLTexture> level : _bloom_up)
+        _retired.retire(level);
+    _bloom_down.clear();
+    _bloom_up.clear();
+#ifdef RFW_METAL_FX
+    _retired.retire(_upscaled);
+    _upscaled = nil;
+    if (@available(macOS 13.0, *))
+    {
+        _retired.retire(_temporal_scaler);
+        _temporal_scaler = nil;
+    }
+#endif
+    if (render_scale() >= 1.0f && _rate_map == nil && _hdr == HDR_OFF && !_taa && _post_effects == 0 &&
+        _reflections.settings.enabled == 0)
+        return;
+
+    const auto create_target = [&](MTLPixelFormat format, NSUInteger width, NSUInteger height, MTLTextureUsage usage,
+                                   NSString *label) {
+        MTLTextureDescriptor *desc = [MTLTextureDescriptor texture2DDescriptorWithPixelFormat:format
+                                                                                        width:width
+                                                                                       height:height
+                                                                                    mipmapped:NO];
+        desc.usage = usage;
+        desc.storageMode = MTLStorageModePrivate;
+        id<MTLTexture> texture = _target_pool.create(_device, desc);
+        texture.label = label;
+        return texture;
+    };
+    _scaled_color = create_target(scene_format(), _depth_texture.width, _depth_texture.height,
+                                  MTLTextureUsageRenderTarget | MTLTextureUsageShaderRead, @"ScaledColor");
+
+    // The pre-pass draws the motion vectors. Only the temporal scaler's frames without it write them with the camera
+    // motion kernel, shader writes would keep the GPU from compressing the target in all others.
+    MTLTextureUsage motion_usage = MTLTextureUsageRenderTarget | MTLTextureUsageShaderRead;
+#ifdef RFW_METAL_FX
+    if (@available(macOS 13.0, *))
+    {
+        if (render_scale() < 1.0f && [MTLFXTemporalScalerDescriptor supportsDevice:_device])
+        {
+            const CGSize size = drawable_size();
+            MTLFXTemporalScalerDescriptor *desc = [MTLFXTemporalScalerDescriptor new];
+            desc.colorTextureFormat = scene_format();
+            desc.depthTextureFormat = MTLPixelFormatDepth32Float;
+            desc.motionTextureFormat = MTLPixelFormatRG16Float;
+            desc.outputTextureFormat = scene_format();
+            desc.inputWidth = _depth_texture.width;
+            desc.inputHeight = _depth_texture.height;
+            desc.outputWidth = static_cast<NSUInteger>(size.width);
+            desc.outputHeight = static_cast<NSUInteger>(size.height);
+            _temporal_scaler = [desc newTemporalScalerWithDevice:_device];
+            if (_temporal_scaler != nil)
+            {
+                _temporal_scaler.depthReversed = YES;
+                motion_usage |= _temporal_scaler.motionTextureUsage | MTLTextureUsageShaderWrite;
+                // The overlay pass samples the output like the scaled color.
+                _upscaled = create_target(scene_format(), desc.outputWidth, desc.outputHeight,
+                                          _temporal_scaler.outputTextureUsage | MTLTextureUsageShaderRead, @"Upscaled");
+                _upscale_reset = true;
+            }
+        }
+    }
+#endif
+
+    if (temporal_upscaling() || temporal_antialiasing())
+        _motion_vectors = create_target(MTLPixelFormatRG16Float, _depth_texture.width, _depth_texture.height,
+                                        motion_usage, @"MotionVectors");
+    if (temporal_antialiasing())
+    {
+        for (id<MTLTexture> &history : _taa_history)
+            history = create_target(MTLPixelFormatRGBA16Float, _depth_texture.width, _depth_texture.height,
+                                    MTLTextureUsageShaderRead | MTLTextureUsageShaderWrite, @"TaaHistory");
+        _taa_reset = true;
+    }
+
+    // The pyramid starts at half the size of the view the overlay pass samples, which MetalFX upscales to the drawable.
+    if ((_post_effects & POST_BLOOM) != 0)
+    {
+        NSUInteger width = _depth_texture.width;
+        NSUInteger height = _depth_texture.height;
+#ifdef RFW_METAL_FX
+        if (_upscaled != nil)
+        {
+            width = _upscaled.width;
+            height = _upscaled.height;
+        }
+#endif
+        width = std::max<NSUInteger>(width / 2, 1);
+        height = std::max<NSUInteger>(height / 2, 1);
+        const unsigned int levels = std::min<unsigned int>(
+            BLOOM_LEVELS, full_mip_levels(static_cast<unsigned int>(width), static_cast<unsigned int>(height)));
+        const auto create_pyramid = [&](unsigned int count, NSString *label) {
+            MTLTextureDescriptor *desc = [MTLTextureDescriptor new];
+            desc.pixelFormat = MTLPixelFormatRGBA16Float;
+            desc.width = width;
+            desc.height = height;
+            desc.mipmapLevelCount = count;
+            desc.usage = MTLTextureUsageShaderRead | MTLTextureUsageShaderWrite | MTLTextureUsagePixelFormatView;
+            desc.storageMode = MTLStorageModePrivate;
+            id<MTLTexture> texture = _target_pool.create(_device, desc);
+            texture.label = label;
+            std::vector<id<MTLTexture>> views;
+            for (unsigned int level = 0; level < count; level++)
+                views.push_back([texture newTextureViewWithPixelFormat:MTLPixelFormatRGBA16Float
+                                                           textureType:MTLTextureType2D
+                                                                levels:NSMakeRange(level, 1)
+                                                                slices:NSMakeRange(0, 1)]);
+            return views;
+        };
+        _bloom_down = create_pyramid(levels, @"BloomDown");
+        if (levels > 1)
+            _bloom_up = create_pyramid(levels - 1, @"BloomUp");
+    }
+}
+
+void MetalRenderer::create_rate_map()
+{
+    _retired.retire(_rate_map, _rate_map_data);
+    _rate_map = nil;
+    _rate_map_data = nil;
+    if (_horizontal_rates.empty())
+        return;
+
+    if (@available(macOS 10.15.4, *))
+    {
+        const MTLSize zones = MTLSizeMake(_horizontal_rates.size(), _vertical_rates.size(), 0);
+        MTLRasterizationRateLayerDescriptor *layer =
+            [[MTLRasterizationRateLayerDescriptor alloc] initWithSampleCount:zones
+                                                                  horizontal:_horizontal_rates.data()
+                                                                    vertical:_vertical_rates.data()];
+        const MTLSize screen = MTLSizeMake(_depth_texture.width, _depth_texture.height, 0);
+        MTLRasterizationRateMapDescriptor *desc =
+            [MTLRasterizationRateMapDescriptor rasterizationRateMapDescriptorWithScreenSize:screen layer:layer];
+        desc.label = @"RateMap";
+        _rate_map = [_device newRasterizationRateMapWithDescriptor:desc];
+        if (_rate_map == nil)
+            return;
+
+        // Light culling and the overlay pass map between physical and screen pixels with the parameters of the map.
+        _rate_map_data = [_device newBufferWithLength:_rate_map.parameterBufferSizeAndAlign.size
+                                              options:MTLResourceStorageModeShared];
+        _rate_map_data.label = @"RateMapParameters";
+        [_rate_map copyParameterDataToBuffer:_rate_map_data offset:0];
+    }
+}
+
+void MetalRenderer::create_ray_traced_target()
+{
+    _retired.retire(_ray_traced);
+    MTLTextureDescriptor *desc = [MTLTextureDescriptor texture2DDescriptorWithPixelFormat:MTLPixelFormatRG8Unorm
+                                                                                    width:1
+                                                                                   height:1
+                                                                                mipmapped:NO];
+    if (_ray_tracing || _sdf_settings.enabled != 0)
+    {
+        desc.width = _depth_texture.width;
+        desc.height = _depth_texture.height;
+    }
+    desc.storageMode = MTLStorageModePrivate;
+    desc.usage = MTLTextureUsageShaderRead | MTLTextureUsageShaderWrite;
+    _ray_traced = _target_pool.create(_device, desc);
+    _ray_traced.label = @"RayTracedShadows";
+}
+
+void MetalRenderer::create_shadow_maps()
+{
+    const bool enabled = _shadow_distance > 0.0f;
+    const MTLPixelFormat format = _unorm16_shadows ? MTLPixelFormatDepth16Unorm : MTLPixelFormatDepth32Float;
+    MTLTextureDescriptor *desc = [MTLTextureDescriptor texture2DDescriptorWithPixelFormat:format
+                                                                                    width:1
+                                                                                   height:1
+                                                                                mipmapped:NO];
+    desc.storageMode = MTLStorageModePrivate;
+    desc.usage = MTLTextureUsageRenderTarget | MTLTextureUsageShaderRead;
+
+    desc.textureType = MTLTextureType2DArray;
+    desc.width = enabled ? SHADOW_CASCADE_SIZE >> _quality.settings().shadow_shift : 1;
+    desc.height = desc.width;
+    desc.arrayLength = enabled ? SHADOW_CASCADES : 1;
+    _retired.retire(_cascade_shadows, _spot_shadows);
+    _cascade_shadows = [_device newTextureWithDescriptor:desc];
+    _cascade_shadows.label = @"CascadeShadows";
+
+    desc.textureType = MTLTextureType2D;
+    desc.width = enabled ? SPOT_SHADOW_ATLAS_SIZE : 1;
+    desc.height = desc.width;
+    desc.arrayLength = 1;
+    _spot_shadows = [_device newTextureWithDescriptor:desc];
+    _spot_shadows.label = @"SpotShadows";
+
+    for (ShadowView &view : _cascade_views)
+        view.valid = false;
+    for (ShadowView &view : _spot_views)
+        view.valid = false;
+}
+
+void MetalRenderer::allocate_texture_heap(const TextureData *data, unsigned int num_textures)
+{
+    NSUInteger size = 0;
+    for (unsigned int i = 0; i < num_textures; i++)
+    {
+        MTLTextureDescriptor *desc = static_texture_descriptor(data[i], device_format(data[i]), mip_levels(data[i]));
+        const MTLSizeAndAlign size_align = [_device heapTextureSizeAndAlignWithDescriptor:desc];
+        size = (size + size_align.align - 1) / size_align.align * size_align.align + size_align.size;
+    }
+
+    if (size == 0)
+        return;
+
+    MTLHeapDescriptor *desc = [MTLHeapDescriptor new];
+    desc.storageMode = MTLStorageModePrivate;
+    // Heap textures are only written on the upload queue and bound once their upload completed.
+    desc.hazardTrackingMode = MTLHazardTrackingModeUntracked;
+    desc.size = size;
+    id<MTLHeap> heap = [_device newHeapWithDescriptor:desc];
+    heap.label = @"Textures";
+    _texture_heaps.push_back(heap);
+}
+
+MTLTextureDescriptor *MetalRenderer::static_texture_descriptor(const TextureData &d, DataFormat format,
+                                                               unsigned int mip_levels) const
+{
+    MTLTextureDescriptor *desc = texture_descriptor(d, format, mip_levels);
+    if (@available(macOS 12.5, *))
+    {
+        // Only written by the upload queue's copies and mip generation, never by shaders.
+        if (_lossy_textures && supports_lossy_compression(_device, format))
+            desc.compressionType = MTLTextureCompressionTypeLossy;
+    }
+    return desc;
+}
+
+id<MTLTexture> MetalRenderer::create_texture(const TextureData &d)
+{
+    MTLTextureDescriptor *desc = static_texture_descriptor(d, device_format(d), mip_levels(d));
+    id<MTLTexture> texture = nil;
+    for (auto it = _texture_heaps.rbegin(); it != _texture_heaps.rend() && texture == nil; ++it)
+        texture = [*it newTextureWithDescriptor:desc];
+
+    // Textures that no longer fit a heap, e.g. replacements of changed textures, get their own allocation.
+    if (texture == nil)
+    {
+        texture = [_device newTextureWithDescriptor:desc];
+        _standalone_textures.push_back(texture);
+    }
+
+    return texture;
+}
+
+bool MetalRenderer::packs_texture(const TextureData &d) const
+{
+    return _texture_packing > 0 && d.bytes && d.width > 0 && d.height > 0 &&
+           std::max(d.width, d.height) <= _texture_packing && device_format(d) == d.format;
+}
+
+DataFormat MetalRenderer::device_format(const TextureData &d) const
+{
+    if (!supports_format(_device, d.format))
+        return BGRA8;
+
+    // Block compressed textures need sides of whole blocks.
+    const DataFormat transcoded = bc7_format(d.format);
+    if (_texture_transcoding && transcoded != d.format && d.width % 4 == 0 && d.height % 4 == 0 &&
+        supports_format(_device, transcoded))
+        return transcoded;
+    return d.format;
+}
+
+bool MetalRenderer::transcodes(const TextureData &d) const
+{
+    return device_format(d) != d.format && supports_format(_device, d.format);
+}
+
+unsigned int MetalRenderer::mip_levels(const TextureData &d) const
+{
+    // Block compressed formats can't be rendered to, so their mips can't be generated by the GPU. Transcoded textures
+    // generate them before they are encoded.
+    if (!_gpu_mipmaps || d.mip_levels > 1 || (texture_format(device_format(d)).block_width > 1 && !transcodes(d)))
+        return d.mip_levels;
+    return full_mip_levels(d.width, d.height);
+}
+
+size_t MetalRenderer::upload_texture(id<MTLTexture> texture, const TextureData &d)
+{
+    if (transcodes(d))
+        return transcode_texture(texture, d);
+
+    const DataFormat format = device_format(d);
+    if (format != d.format)
+        NSLog(@"Texture format %u is not supported by %@, using a white texture instead", d.format, _device.name);
+    return stage_texture(texture, d, format);
+}
+
+size_t MetalRenderer::stage_texture(id<MTLTexture> texture, const TextureData &d, DataFormat format)
+{
+    const TextureFormat info = texture_format(format);
+    size_t staged = 0;
+    for (unsigned int m = 0; m < d.mip_levels; m++)
+    {
+        unsigned int w, h;
+        mip_level_width_height(d, m, &w, &h);
+
+        const size_t bytes_per_row = info.bytes_per_row(w);
+        const size_t bytes_per_image = info.bytes_per_image(w, h);
+        staged += bytes_per_image;
+
+        // Levels in a mapped scene cache are copied straight out of the mapping.
+        id<MTLBuffer> source = nil;
+        size_t offset = 0;
+        if (format == d.format && locate_scene_cache(d.bytes + mip_offset(d, m), &source, &offset))
+        {
+            _staging.copy(_upload_queue, source, offset, texture, m, w, h, bytes_per_row, bytes_per_image);
+            continue;
+        }
+
+        void *staging = _staging.stage(_device, _upload_queue, texture, m, w, h, bytes_per_row, bytes_per_image);
+        if (format == d.format)
+            memcpy(staging, d.bytes + mip_offset(d, m), bytes_per_image);
+        else
+            memset(staging, 0xFF, bytes_per_image);
+    }
+
+    if (texture.mipmapLevelCount > d.mip_levels)
+        _staging.generate_mipmaps(_upload_queue, texture);
+    return staged;
+}
+
+size_t MetalRenderer::transcode_texture(id<MTLTexture> texture, const TextureData &d)
+{
+    // The kernel compiles with the other pipelines, textures set before they compiled wait for it.
+    wait_for_pipelines();
+
+    // Levels the GPU generates are filtered on the uncompressed texture, before they are encoded.
+    MTLTextureDescriptor *desc = texture_descriptor(d, d.format, static_cast<unsigned int>(texture.mipmapLevelCount));
+    desc.usage |= MTLTextureUsagePixelFormatView;
+    id<MTLTexture> source = [_device newTextureWithDescriptor:desc];
+    source.label = @"TranscodeSource";
+    const size_t staged = stage_texture(source, d, d.format);
+
+    // sRGB texels are encoded as they are stored, through views of every level that don't decode them.
+    const MTLPixelFormat read_format =
+        d.format == BGRA8 || d.format == BGRA8_SRGB ? MTLPixelFormatBGRA8Unorm : MTLPixelFormatRGBA8Unorm;
+    const TextureFormat bc7 = texture_format(BC7_RGBA);
+    std::vector<id<MTLTexture>> views;
+    std::vector<size_t> offsets;
+    size_t size = 0;
+    for (NSUInteger m = 0; m < texture.mipmapLevelCount; m++)
+    {
+        views.push_back([source newTextureViewWithPixelFormat:read_format
+                                                  textureType:MTLTextureType2D
+                                                       levels:NSMakeRange(m, 1)
+                                                       slices:NSMakeRange(0, 1)]);
+        offsets.push_back(size);
+        size += bc7.bytes_per_image(views.back().width, views.back().height);
+    }
+    id<MTLBuffer> blocks = [_device newBufferWithLength:size options:MTLResourceStorageModePrivate];
+    blocks.label = @"TranscodeBlocks";
+
+    // BC textures can't be written by kernels, blocks are encoded into a buffer and copied into texture.
+    id<MTLComputePipelineState> state = _encode_bc7_state;
+    _staging.encode(_upload_queue, ^(id<MTLCommandBuffer> command_buffer) {
+      id<MTLComputeCommandEncoder> encoder = [command_buffer computeCommandEncoder];
+      encoder.label = @"EncodeBC7";
+      [encoder setComputePipelineState:state];
+      for (size_t m = 0; m < views.size(); m++)
+      {
+          const NSUInteger blocks_wide = (views[m].width + 3) / 4;
+          const NSUInteger blocks_high = (views[m].height + 3) / 4;
+          [encoder setTexture:views[m] atIndex:0];
+          [encoder setBuffer:blocks offset:offsets[m] atIndex:0];
+          [encoder dispatchThreadgroups:MTLSizeMake((blocks_wide + 7) / 8, (blocks_high + 7) / 8, 1)
+                  threadsPerThreadgroup:MTLSizeMake(8, 8, 1)];
+      }
+      [encoder endEncoding];
+
+      id<MTLBlitCommandEncoder> blit = [command_buffer blitCommandEncoder];
+      blit.label = @"CopyBC7";
+      for (size_t m = 0; m < views.size(); m++)
+      {
+          [blit copyFromBuffer:blocks
+                     sourceOffset:offsets[m]
+                sourceBytesPerRow:bc7.bytes_per_row(views[m].width)
+              sourceBytesPerImage:bc7.bytes_per_image(views[m].width, views[m].height)
+                       sourceSize:MTLSizeMake(views[m].width, views[m].height, 1)
+                        toTexture:texture
+                 destinationSlice:0
+                 destinationLevel:m
+                destinationOrigin:MTLOriginMake(0, 0, 0)];
+      }
+      [blit endEncoding];
+    });
+    return staged;
+}
+
+void MetalRenderer::set_textures(const TextureData *data, unsigned int num_textures, const size_t *changed,
+                                 unsigned int num_changed)
+{
+    const os_signpost_id_t signpost = signpost_id();
+    os_signpost_interval_begin(signpost_log(), signpost, "set_textures", "%u textures", num_textures);
+    TraceSpan span(_trace, "set_textures");
+
+    if (num_textures < _textures.size())
+    {
+        // Only the dropped slots are released, the remaining textures and their table entries are kept. Frames in
+        // flight must be done with the dropped textures before they get released.
+        acquire_all_frames();
+        for (unsigned int i = num_textures; i < _textures.size(); i++)
+        {
+            if (_textures[i] != _fallback_texture)
+                release_texture(_textures[i], _texture_keys[i]);
+            _texture_arrays.free(_texture_layers[i]);
+            if (!_streamed_textures[i].bytes.empty())
+                _num_streamed_textures--;
+        }
+        for (PendingTexture &pending : _pending_textures)
+        {
+            if (pending.index != ~0u && pending.index >= num_textures)
+                pending.index = ~0u;
+        }
+        for (const DeferredTexture &deferred : _deferred_textures)
+        {
+            if (deferred.index >= num_textures)
+                _pending_textures.push_back({~0u, deferred.texture, 0, 0, 0});
+        }
+        _deferred_textures.erase(std::remove_if(_deferred_textures.begin(), _deferred_textures.end(),
+                                                [num_textures](const DeferredTexture &deferred) {
+                                                    return deferred.index >= num_textures;
+                                                }),
+                                 _deferred_textures.end());
+        _committed_textures.erase(std::remove_if(_committed_textures.begin(), _committed_textures.end(),
+                                                 [num_textures](const MappedTexture &mapped) {
+                                                     return mapped.index >= num_textures;
+                                                 }),
+                                  _committed_textures.end());
+        _virtual.remove_from(num_textures, _frames_rendered);
+        _textures.resize(num_textures);
+        _texture_layers.resize(num_textures);
+        _texture_keys.resize(num_textures);
+        _streamed_textures.resize(num_textures);
+        _encoded_textures.resize(std::min(_encoded_textures.size(), size_t(num_textures)));
+
+        // Heaps can't shrink, they are only released once no texture is left.
+        if (_textures.empty())
+        {
+            for (const PendingTexture &pending : _pending_textures)
+            {
+                if (pending.layer == NO_TEXTURE_LAYER)
+                    release_texture(pending.texture, pending.key);
+            }
+            _pending_textures.clear();
+            _texture_heaps.clear();
+            _standalone_textures.clear();
+            _texture_arrays.clear();
+            _encoded_texture_arrays = 0;
+            _virtual_cache = nil;
+        }
+        update_texture_residency();
+        release_all_frames();
+        _flags |= Flags::UpdateTextures;
+    }
+
+    // Only textures that are new or changed get uploaded, the texture table shows the fallback for new slots and the
+    // previous contents of changed ones until their upload completed. Streamed textures upload their resident tail,
+    // other textures whose data is in the resource cache are bound without an upload.
+    const auto first_new = static_cast<unsigned int>(_textures.size());
+    _streamed_textures.resize(num_textures);
+    std::vector<TextureData> levels(num_textures);
+    std::vector<std::vector<unsigned char>> files(num_textures);
+    std::vector<size_t> keys(num_textures, 0);
+    std::vector<id<MTLTexture>> cached(num_textures, nil);
+    std::vector<bool> packed(num_textures, false);
+    std::vector<TextureData> heap_levels;
+    // Heap textures are only released with their heap, so slots with the same data may share one. Shared textures
+    // are bound once the upload of their data completed.
+    std::unordered_map<size_t, PendingTexture> shared;
+    if (_deduplicate)
+    {
+        for (unsigned int i = 0; i < first_new; i++)
+        {
+            if (_texture_keys[i] != 0 && _textures[i].heap != nil)
+                shared.emplace(_texture_keys[i], PendingTexture{~0u, _textures[i], 0, 0, _texture_keys[i]});
+        }
+        for (const PendingTexture &pending : _pending_textures)
+        {
+            if (pending.key != 0 && pending.texture.heap != nil)
+                shared[pending.key] = pending;
+        }
+    }
+
+    std::unordered_map<size_t, id<MTLTexture>> created;
+    for (unsigned int i = 0; i < num_textures; i++)
+    {
+        if (i < first_new && !bit_set(changed, num_changed, i))
+            continue;
+
+        // KTX2 files are read into levels that are kept until their upload is staged, files that can't be read upload
+        // a white texture like formats the device lacks.
+        TextureData d = data[i];
+        if (d.format == KTX2 && !read_ktx2(data[i], files[i], &d))
+            d = {1, 1, 1, nullptr, 0, KTX2};
+        levels[i] = track_streamed_texture(i, d);
+        // Packed textures are neither cached nor shared, their layers are freed as soon as they are replaced.
+        packed[i] = _streamed_textures[i].bytes.empty() && packs_texture(levels[i]);
+        PurgeableCache<size_t, bool>::Entry entry;
+        if (_streamed_textures[i].bytes.empty() && !packed[i])
+            keys[i] = texture_key(levels[i]);
+        if (keys[i] != 0 && _texture_cache.take(keys[i], entry))
+            cached[i] = (id<MTLTexture>)entry.resource;
+
+        // Duplicates take no room in the new heap, nil marks the first texture with its data until it is created.
+        const bool duplicate =
+            _deduplicate && keys[i] != 0 && (shared.count(keys[i]) > 0 || !created.emplace(keys[i], nil).second);
+        if (i >= first_new && cached[i] == nil && !duplicate && !packed[i])
+            heap_levels.push_back(levels[i]);
+    }
+
+    if (num_textures > first_new)
+    {
+        allocate_texture_heap(heap_levels.data(), static_cast<unsigned int>(heap_levels.size()));
+        _textures.resize(num_textures, _fallback_texture);
+        _texture_layers.resize(num_textures, NO_TEXTURE_LAYER);
+        _texture_keys.resize(num_textures, 0);
+        _flags |= Flags::UpdateTextures;
+    }
+
+    const size_t first_pending = _pending_textures.size();
+    const size_t num_arrays = _texture_arrays.textures().size();
+    std::vector<PendingTexture> reused;
+    size_t uploaded = 0;
+    for (unsigned int i = 0; i < num_textures; i++)
+    {
+        if (i < first_new && !bit_set(changed, num_changed, i))
+            continue;
+
+        // A newer upload of the same texture supersedes one that is still in flight.
+        supersede_texture_uploads(i);
+
+        if (cached[i] != nil)
+        {
+            _standalone_textures.push_back(cached[i]);
+            reused.push_back({i, cached[i], 0, 0, keys[i]});
+            continue;
+        }
+
+        if (keys[i] != 0 && _deduplicate)
+        {
+            if (const auto it = created.find(keys[i]); it != created.end() && it->second != nil)
+            {
+                _pending_textures.push_back({i, it->second, 0, 0, keys[i]});
+                continue;
+            }
+            if (const auto it = shared.find(keys[i]); it != shared.end())
+            {
+                PendingTexture pending = it->second;
+                pending.index = i;
+                reused.push_back(pending);
+                continue;
+            }
+        }
+
+        // Frames only sample the layers the layer table points to, so the free layer of a packed texture can be
+        // written right away. Its levels are uploaded and generated through a 2D view of the layer.
+        if (packed[i])
+        {
+            id<MTLTexture> array = nil;
+            const unsigned int layer = _texture_arrays.allocate(_device, levels[i], mip_levels(levels[i]), &array);
+            if (layer != NO_TEXTURE_LAYER)
+            {
+                id<MTLTexture> view = [array newTextureViewWithPixelFormat:array.pixelFormat
+                                                               textureType:MTLTextureType2D
+                                                                    levels:NSMakeRange(0, array.mipmapLevelCount)
+                                                                    slices:NSMakeRange(layer & 0xFFFF, 1)];
+                uploaded += upload_texture(view, levels[i]);
+                _pending_textures.push_back({i, array, 0, 0, 0, nil, layer});
+                continue;
+            }
+        }
+
+        // Textures in use by frames in flight are never written, changed textures upload into a new one.
+        id<MTLTexture> texture = create_texture(levels[i]);
+        const StreamedTexture &streamed = _streamed_textures[i];
+        id<MTLBuffer> mapped = nil;
+        size_t mapped_offset = 0;
+        if (_uploads.enabled() && streamed.bytes.empty() && !transcodes(levels[i]) &&
+            device_format(levels[i]) == levels[i].format &&
+            !locate_scene_cache(levels[i].bytes, &mapped, &mapped_offset))
+        {
+            // Uploads past the budget continue with the next frames, after the textures deferred before them.
+            DeferredTexture deferred = {i, texture, levels[i], keys[i]};
+            if (!files[i].empty())
+                deferred.bytes = std::move(files[i]);
+            else if (_copy_on_submit)
+                deferred.bytes.assign(levels[i].bytes, levels[i].bytes + mip_levels_size(levels[i], 0));
+            if (!deferred.bytes.empty())
+                deferred.data.bytes = deferred.bytes.data();
+
+            if (_deferred_textures.empty() && stage_deferred_texture(deferred))
+                _pending_textures.push_back({i, texture, 0, 0, keys[i]});
+            else
+                _deferred_textures.push_back(std::move(deferred));
+            continue;
+        }
+
+        uploaded += upload_texture(texture, levels[i]);
+        _pending_textures.push_back({i, texture, 0, streamed.bytes.empty() ? 0 : streamed.tail_mip, keys[i]});
+        if (keys[i] != 0 && _deduplicate && texture.heap != nil)
+            created[keys[i]] = texture;
+    }
+
+    _uploads.spend(uploaded);
+    const uint64_t upload = _staging.submit();
+    for (size_t i = first_pending; i < _pending_textures.size(); i++)
+        _pending_textures[i].upload = upload;
+    _pending_textures.insert(_pending_textures.end(), reused.begin(), reused.end());
+    prune_texture_contents();
+    if (_texture_arrays.textures().size() != num_arrays)
+        update_texture_residency();
+    os_signpost_interval_end(signpost_log(), signpost, "set_textures", "%zu textures, %zu bytes uploaded",
+                             _pending_textures.size() - first_pending, uploaded);
+}
+
+void MetalRenderer::set_skybox(TextureData data)
+{
+    _changes++;
+    // The skybox frames in flight were encoded with is retired, a new one is prefiltered into new resources.
+    if (data.width == 0 || data.height == 0 || !data.bytes)
+    {
+        _retired.retire(_skybox);
+        _skybox = nil;
+        return;
+    }
+    wait_for_pipelines();
+
+    // Prefiltering reads the skybox level matching the footprint of each sample. Its upload is waited for, setting a
+    // skybox is rare and the prefiltered resources are only usable once it completed.
+    const DataFormat format = device_format(data);
+    const unsigned int levels =
+        texture_format(format).block_width > 1 ? data.mip_levels : full_mip_levels(data.width, data.height);
+    id<MTLTexture> skybox = [_device newTextureWithDescriptor:texture_descriptor(data, format, levels)];
+    skybox.label = @"Skybox";
+    upload_texture(skybox, data);
+    _staging.flush();
+
+    MTLTextureDescriptor *desc = [MTLTextureDescriptor textureCubeDescriptorWithPixelFormat:MTLPixelFormatRGBA16Float
+                                                                                       size:ENVIRONMENT_SIZE
+                                                                                  mipmapped:YES];
+    desc.mipmapLevelCount = ENVIRONMENT_MIP_LEVELS;
+    desc.storageMode = MTLStorageModePrivate;
+    desc.usage = MTLTextureUsageShaderRead | MTLTextureUsageShaderWrite;
+    id<MTLTexture> environment = [_device newTextureWithDescriptor:desc];
+    environment.label = @"Environment";
+    id<MTLBuffer> irradiance = [_device newBufferWithLength:sizeof(IrradianceSH)
+                                                    options:MTLResourceStorageModePrivate];
+    irradiance.label = @"Irradiance";
+
+    // Frames committed later are ordered after the prefiltering on the same queue.
+    id<MTLCommandBuffer> command_buffer = [_queue commandBuffer];
+    command_buffer.label = @"PrefilterEnvironment";
+    id<MTLComputeCommandEncoder> encoder = [command_buffer computeCommandEncoder];
+    encoder.label = @"PrefilterEnvironment";
+    [encoder setComputePipelineState:_prefilter_environment_state];
+    [encoder setTexture:skybox atIndex:0];
+    for (unsigned int level = 0; level < ENVIRONMENT_MIP_LEVELS; level++)
+    {
+        // Every level is written through a view of it.
+        id<MTLTexture> view = [environment newTextureViewWithPixelFormat:desc.pixelFormat
+                                                             textureType:MTLTextureTypeCube
+                                                                  levels:NSMakeRange(level, 1)
+                                                                  slices:NSMakeRange(0, 6)];
+        const EnvironmentUniforms uniforms = {ENVIRONMENT_SIZE >> level,
+                                              static_cast<float>(level) / (ENVIRONMENT_MIP_LEVELS - 1), 0, 0};
+        [encoder setTexture:view atIndex:1];
+        [encoder setBytes:&uniforms length:sizeof(uniforms) atIndex:0];
+        [encoder dispatchThreadgroups:MTLSizeMake((uniforms.size + 7) / 8, (uniforms.size + 7) / 8, 6)
+                threadsPerThreadgroup:MTLSizeMake(8, 8, 1)];
+    }
+
+    // Irradiance varies slowly with the normal, a level of about 64x32 texels is projected.
+    unsigned int irradiance_level = 0;
+    while (irradiance_level + 1 < skybox.mipmapLevelCount && (skybox.width >> irradiance_level) > 64)
+        irradiance_level++;
+    id<MTLTexture> irradiance_view = [skybox newTextureViewWithPixelFormat:skybox.pixelFormat
+                                                               textureType:MTLTextureType2D
+                                                                    levels:NSMakeRange(irradiance_level, 1)
+                                                                    slices:NSMakeRange(0, 1)];
+    [encoder setComputePipelineState:_project_irradiance_state];
+    [encoder setTexture:irradiance_view atIndex:0];
+    [encoder setBuffer:irradiance offset:0 atIndex:0];
+    [encoder dispatchThreadgroups:MTLSizeMake(1, 1, 1) threadsPerThreadgroup:MTLSizeMake(IRRADIANCE_GROUP_SIZE, 1, 1)];
+    [encoder endEncoding];
+    [command_buffer commit];
+
+    _retired.retire(_skybox, _environment, _irradiance);
+    _skybox = skybox;
+    _environment = environment;
+    _irradiance = irradiance;
+}
+
+void MetalRenderer::set_reflection_probes(const ReflectionProbe *probes, unsigned int count)
+{
+    count = std::min(count, static_cast<unsigned int>(MAX_REFLECTION_PROBES));
+    // Changes are not tracked without probes, the first probes see where every mesh is.
+    if (_probes.empty() && count > 0)
+    {
+        for (unsigned int id = 0; id < _instance_3d_matrices.size(); id++)
+        {
+            if (_instance_3d_matrices[id])
+                _probe_moved.push_back(id);
+        }
+    }
+
+    const bool resized = count != _probes.size();
+    _probe_dirty_faces.resize(count);
+    _probe_baked.resize(count);
+    for (unsigned int i = 0; i < count; i++)
+    {
+        const bool moved = i >= _probes.size() || _probes[i].pos_x != probes[i].pos_x ||
+                           _probes[i].pos_y != probes[i].pos_y || _probes[i].pos_z != probes[i].pos_z ||
+                           _probes[i].radius != probes[i].radius;
+        if (resized || moved)
+            _probe_dirty_faces[i] = ALL_PROBE_FACES;
+        if (resized)
+            _probe_baked[i] = false;
+    }
+    _probes.assign(probes, probes + count);
+    if (resized)
+        create_probe_maps();
+}
+
+void MetalRenderer::set_reflection_probe_budget(unsigned int faces_per_frame)
+{
+    _probe_budget = faces_per_frame;
+}
+
+void MetalRenderer::set_gi_volume(const GiVolume &volume)
+{
+    GiVolume clamped = volume;
+    clamped.count_x = std::min(volume.count_x, GI_MAX_PROBES_PER_AXIS);
+    clamped.count_y = std::min(volume.count_y, GI_MAX_PROBES_PER_AXIS);
+    clamped.count_z = std::min(volume.count_z, GI_MAX_PROBES_PER_AXIS);
+    for (int axis = 0; axis < 3; axis++)
+        clamped.spacing[axis] = std::max(volume.spacing[axis], 1e-3f);
+    if (volume.bias <= 0.0f)
+        clamped.bias = 0.25f * std::min({clamped.spacing.x, clamped.spacing.y, clamped.spacing.z});
+    if (clamped.count_x == 0 || clamped.count_y == 0 || clamped.count_z == 0 || !_ray_tracing_supported)
+        clamped = {};
+    if (memcmp(&clamped, &_gi.volume, sizeof(GiVolume)) == 0)
+        return;
+
+    // Probes start over wherever the volume moved to.
+    _retired.retire(_gi.irradiance, _gi.distances);
+    _gi.irradiance = nil;
+    _gi.distances = nil;
+    _gi.volume = clamped;
+    _gi.next_probe = 0;
+    _gi.updated = 0;
+    if (clamped.count_x == 0)
+        return;
+
+    const auto create_texture = [&](MTLPixelFormat format, unsigned int texels, NSString *label) {
+        MTLTextureDescriptor *desc =
+            [MTLTextureDescriptor texture2DDescriptorWithPixelFormat:format
+                                                               width:clamped.count_x * clamped.count_y * (texels + 2)
+                                                              height:clamped.count_z * (texels + 2)
+                                                           mipmapped:NO];
+        desc.usage = MTLTextureUsageShaderRead | MTLTextureUsageShaderWrite;
+        desc.storageMode = MTLStorageModePrivate;
+        id<MTLTexture> texture = [_device newTextureWithDescriptor:desc];
+        texture.label = label;
+        return texture;
+    };
+    _gi.irradiance = create_texture(MTLPixelFormatRGBA16Float, GI_IRRADIANCE_TEXELS, @"GiIrradiance");
+    _gi.distances = create_texture(MTLPixelFormatRG16Float, GI_DISTANCE_TEXELS, @"GiDistances");
+}
+
+void MetalRenderer::set_gi_ray_budget(unsigned int rays_per_frame)
+{
+    _gi.ray_budget = rays_per_frame;
+}
+
+void MetalRenderer::bake_lightmap(const LightmapSettings &settings)
+{
+    if (!_ray_tracing_supported)
+        return;
+    if (settings.meshes == nullptr || settings.num_meshes == 0 || settings.samples == 0)
+    {
+        NSLog(@"The lightmap of slot %u has no meshes or samples to bake.", settings.texture);
+        return;
+    }
+
+    LightmapBake bake;
+    bake.settings = settings;
+    bake.settings.meshes = nullptr;
+    bake.settings.width = std::clamp(settings.width, 1u, static_cast<unsigned int>(LIGHTMAP_MAX_SIZE));
+    bake.settings.height = std::clamp(settings.height, 1u, static_cast<unsigned int>(LIGHTMAP_MAX_SIZE));
+    bake.settings.samples_per_frame = std::clamp(settings.samples_per_frame, 1u, settings.samples);
+    bake.meshes.assign(settings.meshes, settings.meshes + settings.num_meshes);
+
+    // A newer bake into the same slot supersedes a queued one.
+    _lightmap_bakes.erase(std::remove_if(_lightmap_bakes.begin(), _lightmap_bakes.end(),
+                                         [&](const LightmapBake &b) { return b.settings.texture == settings.texture; }),
+                          _lightmap_bakes.end());
+    _lightmap_bakes.push_back(std::move(bake));
+}
+
+void MetalRenderer::set_material_lightmap(unsigned int material, unsigned int texture)
+{
+    if (material >= _material_lightmaps.size())
+        _material_lightmaps.resize(material + 1, -1);
+    _material_lightmaps[material] = texture == ~0u ? -1 : static_cast<int>(texture);
+
+    // Materials that were not set yet get their slot once they are.
+    if (material < _device_materials.size())
+    {
+        _materials[material] = pack_material(_device_materials[material], _material_lightmaps[material]);
+        mark_materials_changed(material, material + 1);
+        _flags |= Flags::UpdateMaterials;
+    }
+}
+
+bool MetalRenderer::load_scene_cache(const char *path)
+{
+    auto cache = std::make_unique<SceneCache>();
+    if (!cache->open(_device, path))
+        return false;
+
+    // Textures are copied out of the mapping, so it is registered before they are set.
+    const SceneCache &contents = *cache;
+    _scene_caches.push_back(std::move(cache));
+    if (contents.num_materials() > 0)
+        set_materials(contents.materials(), contents.num_materials(), nullptr, 0);
+    if (!contents.textures().empty())
+    {
+        set_textures(contents.textures().data(), static_cast<unsigned int>(contents.textures().size()), nullptr, 0);
+    }
+    set_3d_meshes_batch(contents.mesh_ids().data(), contents.meshes().data(),
+                        static_cast<unsigned int>(contents.meshes().size()));
+    // Stored fields are copied out of the mapping like texture levels.
+    for (size_t i = 0; i < contents.fields().size(); i++)
+    {
+        const SceneCache::Field &field = contents.fields()[i];
+        id<MTLBuffer> buffer = nil;
+        size_t offset = 0;
+        if (field.voxels && locate_scene_cache(field.voxels, &buffer, &offset))
+            _sdf_scene.set_cached_field(contents.mesh_ids()[i], field.volume, buffer, offset);
+    }
+    set_3d_instances_batch(contents.instance_ids().data(), contents.instances().data(),
+                           static_cast<unsigned int>(contents.instances().size()));
+    return true;
+}
+
+bool MetalRenderer::locate_scene_cache(const void *bytes, id<MTLBuffer> *buffer, size_t *offset) const
+{
+    for (const auto &cache : _scene_caches)
+    {
+        if (cache->locate(bytes, buffer, offset))
+            return true;
+    }
+    return false;
+}
+
+bool MetalRenderer::write_asset_file(const char *path, const void *bytes, size_t size, AssetCompression compression,
+                                     size_t chunk_size)
+{
+    if (compression == ASSET_COMPRESSION_NONE)
+    {
+        std::ofstream file(path, std::ios::binary | std::ios::trunc);
+        file.write(static_cast<const char *>(bytes), static_cast<std::streamsize>(size));
+        return file.good();
+    }
+
+#ifdef RFW_METAL_IO
+    if (@available(macOS 13.0, *))
+    {
+        if (chunk_size == 0)
+            chunk_size = MTLIOCompressionContextDefaultChunkSize();
+        MTLIOCompressionContext context =
+            MTLIOCreateCompressionContext(path, static_cast<MTLIOCompressionMethod>(compression), chunk_size);
+        if (context == nullptr)
+            return false;
+        MTLIOCompressionContextAppendData(context, bytes, size);
+        return MTLIOFlushAndDestroyCompressionContext(context) == MTLIOCompressionStatusComplete;
+    }
+#endif
+    return false;
+}
+
+bool MetalRenderer::load_file_textures(const char *path, AssetCompression compression, const unsigned int *indices,
+                                       const FileTexture *textures, unsigned int count)
+{
+#ifdef RFW_METAL_IO
+    if (@available(macOS 13.0, *))
+    {
+        id<MTLIOFileHandle> &file = _io_files[{path, compression}];
+        NSError *error = nil;
+        NSURL *url = [NSURL fileURLWithPath:@(path)];
+        if (file == nil && compression == ASSET_COMPRESSION_NONE)
+            file = [_device newIOFileHandleWithURL:url error:&error];
+        else if (file == nil)
+            file = [_device newIOFileHandleWithURL:url
+                                 compressionMethod:static_cast<MTLIOCompressionMethod>(compression)
+                                             error:&error];
+        if (file == nil)
+        {
+            NSLog(@"Could not open asset file %s: %@", path, error);
+            _io_files.erase({path, compression});
+            return false;
+        }
+
+        std::array<id<MTLIOCommandBuffer>, 3> command_buffers = {};
+        for (unsigned int i = 0; i < count; i++)
+        {
+            const FileTexture &source = textures[i];
+            const TextureData d = {source.width, source.height, source.mip_levels, nullptr, 0, source.format};
+            if (d.width == 0 || d.height == 0 || d.mip_levels == 0 || !supports_format(_device, d.format))
+            {
+                NSLog(@"Texture %u of %s can't be read into a texture of format %u", indices[i], path, d.format);
+                continue;
+            }
+
+            const auto priority = static_cast<size_t>(std::min(source.priority, ASSET_PRIORITY_LOW));
+            if (_io_queues[priority] == nil)
+            {
+                MTLIOCommandQueueDescriptor *desc = [MTLIOCommandQueueDescriptor new];
+                desc.type = MTLIOCommandQueueTypeConcurrent;
+                desc.priority = static_cast<MTLIOPriority>(priority);
+                _io_queues[priority] = [_device newIOCommandQueueWithDescriptor:desc error:&error];
+                if (_io_queues[priority] == nil)
+                {
+                    NSLog(@"Could not create an IO command queue: %@", error);
+                    continue;
+                }
+                _io_queues[priority].label = @"AssetFiles";
+            }
+            if (command_buffers[priority] == nil)
+                command_buffers[priority] = [_io_queues[priority] commandBuffer];
+
+            // Textures read from files don't stream.
+            const unsigned int index = indices[i];
+            replace_texture_slot(index);
+
+            id<MTLTexture> texture =
+                [_device newTextureWithDescriptor:static_texture_descriptor(d, d.format, d.mip_levels)];
+            _standalone_textures.push_back(texture);
+            const TextureFormat info = texture_format(d.format);
+            for (unsigned int m = 0; m < d.mip_levels; m++)
+            {
+                unsigned int w, h;
+                mip_level_width_height(d, m, &w, &h);
+                [command_buffers[priority] loadTexture:texture
+                                                 slice:0
+                                                 level:m
+                                                  size:MTLSizeMake(w, h, 1)
+                                     sourceBytesPerRow:info.bytes_per_row(w)
+                                   sourceBytesPerImage:info.bytes_per_image(w, h)
+                                     destinationOrigin:MTLOriginMake(0, 0, 0)
+                                          sourceHandle:file
+                                    sourceHandleOffset:source.offset + mip_offset(d, m)];
+            }
+            _pending_textures.push_back({index, texture, 0, 0, 0, command_buffers[priority]});
+        }
+
+        for (id<MTLIOCommandBuffer> command_buffer : command_buffers)
+            [command_buffer commit];
+        return true;
+    }
+#endif
+    NSLog(@"Asset files need macOS 13, %s was not loaded", path);
+    return false;
+}
+
+void MetalRenderer::create_probe_maps()
+{
+    // Frames in flight may still use the previous textures.
+    _retired.retire(_probe_captures, _probe_maps, _probe_depth);
+    _probe_captures = nil;
+    _probe_depth = nil;
+    const unsigned int size = _probes.empty() ? 1 : REFLECTION_PROBE_SIZE;
+    MTLTextureDescriptor *desc = [MTLTextureDescriptor textureCubeDescriptorWithPixelFormat:MTLPixelFormatRGBA16Float
+                                                                                       size:size
+                                                                                  mipmapped:!_probes.empty()];
+    desc.textureType = MTLTextureTypeCubeArray;
+    desc.arrayLength = std::max(_probes.size(), size_t(1));
+    desc.storageMode = MTLStorageModePrivate;
+    if (!_probes.empty())
+    {
+        desc.usage = MTLTextureUsageShaderRead | MTLTextureUsageRenderTarget;
+        _probe_captures = [_device newTextureWithDescriptor:desc];
+        _probe_captures.label = @"ProbeCaptures";
+        desc.mipmapLevelCount = ENVIRONMENT_MIP_LEVELS;
+    }
+    desc.usage = MTLTextureUsageShaderRead | MTLTextureUsageShaderWrite;
+    _probe_maps = [_device newTextureWithDescriptor:desc];
+    _probe_maps.label = @"ReflectionProbes";
+    if (_probes.empty())
+        return;
+
+    MTLTextureDescriptor *depth_desc =
+        [MTLTextureDescriptor texture2DDescriptorWithPixelFormat:MTLPixelFormatDepth32Float
+                                                           width:REFLECTION_PROBE_SIZE
+                                                          height:REFLECTION_PROBE_SIZE
+                                                       mipmapped:NO];
+    depth_desc.textureType = MTLTextureType2DArray;
+    depth_desc.arrayLength = 6;
+    depth_desc.usage = MTLTextureUsageRenderTarget;
+    depth_desc.storageMode = MTLStorageModePrivate;
+    if (@available(macOS 11.0, *))
+    {
+        if (_memoryless)
+            depth_desc.storageMode = MTLStorageModeMemoryless;
+    }
+    _probe_depth = [_device newTextureWithDescriptor:depth_desc];
+    _probe_depth.label = @"ProbeDepth";
+}
+
+void MetalRenderer::update_probe_faces()
+{
+    if (_probes.empty())
+    {
+        _probe_moved.clear();
+        _probe_mesh_bounds.clear();
+        return;
+    }
+
+    for (const unsigned int id : _probe_moved)
+    {
+        const Aabb local = id < _instance_3d_bounds.size() ? _instance_3d_bounds[id] : Aabb{};
+        const bool has_matrices = id < _instance_3d_matrices.size() && _instance_3d_matrices[id];
+        const Aabb bounds = has_matrices ? world_bounds(local, *_instance_3d_matrices[id]) : empty_bounds();
+        const Aabb *previous = _probe_mesh_bounds.find(id);
+        for (size_t i = 0; i < _probes.size(); i++)
+        {
+            if (intersects(_probes[i], bounds) || (previous && intersects(_probes[i], *previous)))
+                _probe_dirty_faces[i] = ALL_PROBE_FACES;
+        }
+
+        if (has_matrices && !_instance_3d_matrices[id]->empty())
+            _probe_mesh_bounds[id] = bounds;
+        else
+            _probe_mesh_bounds.erase(id);
+    }
+    _probe_moved.clear();
+}
+
+void MetalRenderer::replace_texture_slot(unsigned int index)
+{
+    if (index >= _textures.size())
+    {
+        _textures.resize(index + 1, _fallback_texture);
+        _texture_layers.resize(index + 1, NO_TEXTURE_LAYER);
+        _texture_keys.resize(index + 1, 0);
+        _streamed_textures.resize(index + 1);
+        _flags |= Flags::UpdateTextures;
+    }
+
+    StreamedTexture &streamed = _streamed_textures[index];
+    if (!streamed.bytes.empty())
+        _num_streamed_textures--;
+    const unsigned int resident_mip = streamed.resident_mip;
+    streamed = StreamedTexture();
+    streamed.resident_mip = resident_mip;
+
+    // A newer texture supersedes uploads that are still in flight, and the video or view the slot showed.
+    supersede_texture_uploads(index);
+    _video.remove(index, _retired);
+    _render_textures.remove(index, _retired);
+}
+
+void MetalRenderer::upload_deferred_textures()
+{
+    if (_deferred_textures.empty())
+        return;
 
-    _instance_3d_matrices[id]->resize(data.num_matrices);
-    for (unsigned int i = 0; i < data.num_matrices; i++)
+    TraceSpan span(_trace, "upload_deferred_textures");
+    const size_t first_pending = _pending_textures.size();
+    while (!_deferred_textures.empty() && stage_deferred_texture(_deferred_textures.front()))
     {
-        std::memcpy(value_ptr(_instance_3d_matrices[id]->at(i).transform), &data.matrices[i], sizeof(mat4));
-        _instance_3d_matrices[id]->at(i).normal_transform =
-            transpose(inverse(_instance_3d_matrices[id]->at(i).transform));
+        const DeferredTexture &deferred = _deferred_textures.front();
+        _pending_textures.push_back({deferred.index, deferred.texture, 0, 0, deferred.key});
+        _deferred_textures.erase(_deferred_textures.begin());
     }
 
-    if (_instance_3d_list.has(id))
+    // The bands staged of the first texture that is left are copied with the textures that are done.
+    const uint64_t upload = _staging.submit();
+    for (size_t i = first_pending; i < _pending_textures.size(); i++)
+        _pending_textures[i].upload = upload;
+}
+
+void MetalRenderer::upload_committed_textures()
+{
+    if (_committed_textures.empty())
+        return;
+
+    TraceSpan span(_trace, "upload_committed_textures");
+    const size_t first_pending = _pending_textures.size();
+    const size_t num_standalone = _standalone_textures.size();
+    size_t count = 0;
+    for (; count < _committed_textures.size(); count++)
     {
-        _instance_3d_list.update_instances_list(id, _instance_3d_matrices[id]->data(),
-                                                static_cast<unsigned int>(_instance_3d_matrices[id]->size()));
+        // The CPU already wrote the levels, the budget only spreads the copies of the GPU over frames.
+        const MappedTexture &mapped = _committed_textures[count];
+        const TextureData &d = mapped.data;
+        const size_t size = mip_levels_size(d, 0);
+        if (!_uploads.allows(size))
+            break;
+
+        id<MTLTexture> texture = create_texture(d);
+        const TextureFormat info = texture_format(d.format);
+        for (unsigned int mip = 0; mip < d.mip_levels; mip++)
+        {
+            unsigned int w, h;
+            mip_level_width_height(d, mip, &w, &h);
+            const size_t bytes_per_row = info.bytes_per_row(w);
+            const unsigned int rows = (h + info.block_height - 1) / info.block_height;
+            _staging.copy(_upload_queue, mapped.buffer, mip_offset(d, mip), texture, mip, w, h, bytes_per_row,
+                          bytes_per_row * rows);
+        }
+        if (texture.mipmapLevelCount > d.mip_levels)
+            _staging.generate_mipmaps(_upload_queue, texture);
+        _uploads.spend(size);
+
+        PendingTexture pending = {mapped.index, texture, 0, 0, 0};
+        pending.source = mapped.buffer;
+        _pending_textures.push_back(pending);
     }
-    else
+    _committed_textures.erase(_committed_textures.begin(),
+                              _committed_textures.begin() + static_cast<std::ptrdiff_t>(count));
+
+    const uint64_t upload = _staging.submit();
+    for (size_t i = first_pending; i < _pending_textures.size(); i++)
+        _pending_textures[i].upload = upload;
+    if (_standalone_textures.size() != num_standalone)
+        update_texture_residency();
+}
+
+bool MetalRenderer::stage_deferred_texture(DeferredTexture &deferred)
+{
+    const TextureData &d = deferred.data;
+    const TextureFormat info = texture_format(d.format);
+    for (; deferred.mip < d.mip_levels; deferred.mip++, deferred.row = 0)
     {
-        _instance_3d_list.add_instances_list(id, _instance_3d_matrices[id]->data(),
-                                             static_cast<unsigned int>(_instance_3d_matrices[id]->size()));
+        unsigned int w, h;
+        mip_level_width_height(d, deferred.mip, &w, &h);
+        const size_t bytes_per_row = info.bytes_per_row(w);
+        const unsigned int rows = (h + info.block_height - 1) / info.block_height;
+        while (deferred.row < rows)
+        {
+            // Bands are as many rows of blocks as the rest of the budget has room for.
+            const auto band = static_cast<unsigned int>(
+                std::min<size_t>(rows - deferred.row, _uploads.available() / bytes_per_row));
+            if (band == 0)
+                return false;
+
+            const auto start = UploadScheduler::Clock::now();
+            const unsigned int y = deferred.row * info.block_height;
+            const size_t size = bytes_per_row * band;
+            void *staging = _staging.stage(_device, _upload_queue, deferred.texture, deferred.mip, w,
+                                           std::min(band * info.block_height, h - y), bytes_per_row, size,
+                                           MTLOriginMake(0, y, 0));
+            memcpy(staging, d.bytes + mip_offset(d, deferred.mip) + deferred.row * bytes_per_row, size);
+            deferred.row += band;
+            _uploads.spend(size, start);
+        }
     }
 
-    _flags |= Flags::UpdateInstances3D;
+    if (deferred.texture.mipmapLevelCount > d.mip_levels)
+        _staging.generate_mipmaps(_upload_queue, deferred.texture);
+    return true;
 }
 
-void MetalRenderer::unload_3d_meshes(const unsigned int *ids, unsigned int num)
+void MetalRenderer::supersede_texture_uploads(unsigned int index)
 {
-    for (size_t i = 0; i < num; i++)
+    for (PendingTexture &pending : _pending_textures)
     {
-        const unsigned int id = ids[i];
-        _vertex_3d_list.remove_pointer(id);
-        _instance_3d_matrices[id]->clear();
-        _instance_3d_list.remove_instances_list(id);
+        if (pending.index == index)
+            pending.index = ~0u;
+    }
+
+    // Deferred textures are released like superseded uploads, they are not cached with their partial contents.
+    for (size_t i = 0; i < _deferred_textures.size();)
+    {
+        if (_deferred_textures[i].index != index)
+        {
+            i++;
+            continue;
+        }
+        _pending_textures.push_back({~0u, _deferred_textures[i].texture, 0, 0, 0});
+        _deferred_textures.erase(_deferred_textures.begin() + static_cast<std::ptrdiff_t>(i));
     }
+    _committed_textures.erase(std::remove_if(_committed_textures.begin(), _committed_textures.end(),
+                                             [index](const MappedTexture &mapped) { return mapped.index == index; }),
+                              _committed_textures.end());
 }
 
-void MetalRenderer::set_materials(const DeviceMaterial *materials, unsigned int num_materials)
+bool MetalRenderer::set_virtual_texture(unsigned int index, const TextureData &d)
 {
-    if (num_materials > _materials.size())
-        _materials = Buffer<DeviceMaterial>(_device, num_materials);
-
-    memcpy(_materials.data(), materials, num_materials * sizeof(DeviceMaterial));
-    _materials.update();
+    if (!_virtual.add(index, d, _frames_rendered))
+    {
+        NSLog(@"Texture %u can't be virtual, it needs BGRA8 or RGBA8 levels down to one within %u texels", index,
+              VIRTUAL_TILE_SIZE);
+        return false;
+    }
+    if (_virtual_cache == nil)
+        create_virtual_cache();
 
-    _flags |= Flags::UpdateMaterials;
+    // The slot binds the tile cache once frames in flight are done with the texture table.
+    replace_texture_slot(index);
+    _pending_textures.push_back({index, _virtual_cache, 0, 0, 0});
+    return true;
 }
 
-MTLArgumentDescriptor *argumentDescriptorWithIndex(NSUInteger index, MTLDataType dataType)
+void MetalRenderer::set_virtual_texture_budget(size_t cache_bytes, size_t upload_bytes)
 {
-    MTLArgumentDescriptor *argumentDescriptor = [MTLArgumentDescriptor argumentDescriptor];
-    argumentDescriptor.index = index;
-    argumentDescriptor.dataType = dataType;
-    argumentDescriptor.access = MTLArgumentAccessReadOnly;
-    return argumentDescriptor;
+    const bool resized = cache_bytes != _virtual_cache_bytes;
+    _virtual_cache_bytes = cache_bytes;
+    _virtual_upload_bytes = upload_bytes;
+    if (resized && _virtual_cache != nil)
+        create_virtual_cache();
 }
 
-void MetalRenderer::synchronize()
+void MetalRenderer::create_virtual_cache()
 {
-    dispatch_semaphore_wait(_sem, DISPATCH_TIME_FOREVER);
+    constexpr size_t max_tiles = 16384 / VIRTUAL_TILE_STRIDE;
+    const size_t tiles = std::max(_virtual_cache_bytes / VirtualTextures::TILE_BYTES, size_t(1));
+    const size_t columns = std::min(static_cast<size_t>(std::ceil(std::sqrt(static_cast<double>(tiles)))), max_tiles);
+    const size_t rows = std::clamp(tiles / columns, size_t(1), max_tiles);
+    MTLTextureDescriptor *desc = [MTLTextureDescriptor texture2DDescriptorWithPixelFormat:MTLPixelFormatBGRA8Unorm
+                                                                                    width:columns * VIRTUAL_TILE_STRIDE
+                                                                                   height:rows * VIRTUAL_TILE_STRIDE
+                                                                                mipmapped:NO];
+    desc.storageMode = MTLStorageModePrivate;
+    desc.usage = MTLTextureUsageShaderRead;
+    id<MTLTexture> previous = _virtual_cache;
+    _retired.retire(_virtual_cache);
+    _virtual_cache = [_device newTextureWithDescriptor:desc];
+    _virtual_cache.label = @"VirtualTextureCache";
+    _standalone_textures.push_back(_virtual_cache);
+    _virtual.set_cache(static_cast<unsigned int>(columns), static_cast<unsigned int>(rows));
 
-    if (_flags & Flags::Update3D)
+    // Slots keep the previous cache until they bind the new one, which is released with the last of them.
+    bool bound = false;
+    for (PendingTexture &pending : _pending_textures)
     {
-        _vertex_3d_list.update_ranges();
-        _vertex_3d_list.update_data(_device);
+        if (pending.texture == previous && pending.index != ~0u)
+            pending.texture = _virtual_cache;
     }
-
-    if (_flags & Flags::UpdateInstances3D)
+    for (unsigned int i = 0; previous != nil && i < _textures.size(); i++)
     {
-        _instance_3d_list.update_ranges();
-        _instance_3d_list.update_data(_device);
+        if (_textures[i] != previous)
+            continue;
+        bound = true;
+        const bool replaced = std::any_of(_pending_textures.begin(), _pending_textures.end(),
+                                          [&](const PendingTexture &pending) { return pending.index == i; });
+        if (!replaced)
+            _pending_textures.push_back({i, _virtual_cache, 0, 0, 0});
     }
+    if (previous != nil && !bound)
+        _standalone_textures.erase(std::remove(_standalone_textures.begin(), _standalone_textures.end(), previous),
+                                   _standalone_textures.end());
+    update_texture_residency();
+}
 
-    if (_flags & Flags::Update2D)
+void MetalRenderer::stream_virtual_textures()
+{
+    if (_virtual.empty() && !_virtual.loading())
+        return;
+
+    const os_signpost_id_t signpost = signpost_id();
+    os_signpost_interval_begin(signpost_log(), signpost, "stream_virtual_textures");
+    TraceSpan span(_trace, "stream_virtual_textures");
+    _virtual.finish([&](uint64_t upload) { return _staging.completed(upload); });
+    const auto max_loads = static_cast<unsigned int>(std::max(_virtual_upload_bytes / VirtualTextures::TILE_BYTES,
+                                                              size_t(1)));
+    const std::vector<VirtualTextures::Load> loads = _virtual.schedule(
+        max_loads, _frames_rendered, VIRTUAL_IDLE_FRAMES, _frames_rendered, _frame_event.signaledValue);
+    for (const VirtualTextures::Load &load : loads)
     {
-        _vertex_2d_list.update_ranges();
-        _vertex_2d_list.update_data(_device);
+        const MTLOrigin origin = MTLOriginMake(load.slot % _virtual.columns() * VIRTUAL_TILE_STRIDE,
+                                               load.slot / _virtual.columns() * VIRTUAL_TILE_STRIDE, 0);
+        void *staging = _staging.stage(_device, _upload_queue, _virtual_cache, 0, VIRTUAL_TILE_STRIDE,
+                                       VIRTUAL_TILE_STRIDE, VIRTUAL_TILE_STRIDE * 4, VirtualTextures::TILE_BYTES,
+                                       origin);
+        _virtual.copy_tile(load, static_cast<unsigned char *>(staging));
     }
+    if (!loads.empty())
+        _virtual.loading(_staging.submit());
+    os_signpost_interval_end(signpost_log(), signpost, "stream_virtual_textures", "%zu tiles", loads.size());
+}
 
-    if (_flags & Flags::UpdateInstances2D)
+void MetalRenderer::update_virtual_pages(FrameResources &frame)
+{
+    // Frames keep the pages they were encoded with, the tiles they map are only reused once the frame completed.
+    const uint64_t version = _virtual.pages_version();
+    if (frame.virtual_pages != nil && frame.virtual_pages_version == version)
+        return;
+
+    const std::vector<unsigned int> &pages = _virtual.pages();
+    if (frame.virtual_pages == nil || frame.virtual_pages.length < pages.size() * sizeof(unsigned int))
     {
-        _instance_2d_list.update_ranges();
-        _instance_2d_list.update_data(_device);
+        const unsigned int capacity = next_multiple_of(static_cast<unsigned int>(pages.size()), 1024);
+        frame.virtual_pages = [_device newBufferWithLength:capacity * sizeof(unsigned int)
+                                                   options:MTLResourceStorageModeShared];
+        frame.virtual_pages.label = @"VirtualPages";
     }
+    memcpy(frame.virtual_pages.contents, pages.data(), pages.size() * sizeof(unsigned int));
+    frame.virtual_pages_version = version;
+}
 
-    if (_flags != Flags::None)
+bool MetalRenderer::upload_completed(const PendingTexture &pending) const
+{
+#ifdef RFW_METAL_IO
+    if (@available(macOS 13.0, *))
     {
-        MTLArgumentDescriptor *verticesArgument = argumentDescriptorWithIndex(VERTICES_ARG_INDEX, MTLDataTypePointer);
-        MTLArgumentDescriptor *vertices2dArgument =
-            argumentDescriptorWithIndex(VERTICES_2D_ARG_INDEX, MTLDataTypePointer);
-        MTLArgumentDescriptor *texturesArgument = argumentDescriptorWithIndex(TEXTURES_ARG_INDEX, MTLDataTypePointer);
-        MTLArgumentDescriptor *materialsArgument = argumentDescriptorWithIndex(MATERIALS_ARG_INDEX, MTLDataTypePointer);
-        MTLArgumentDescriptor *instancesArgument = argumentDescriptorWithIndex(INSTANCES_ARG_INDEX, MTLDataTypePointer);
-        MTLArgumentDescriptor *instances2dArgument =
-            argumentDescriptorWithIndex(INSTANCES_2D_ARG_INDEX, MTLDataTypePointer);
+        if (pending.io != nil)
+            return [(id<MTLIOCommandBuffer>)pending.io status] != MTLIOStatusPending;
+    }
+#endif
+    return _staging.completed(pending.upload);
+}
 
-        MTLArgumentDescriptor *textureArgument = argumentDescriptorWithIndex(0, MTLDataTypeTexture);
-        id<MTLArgumentEncoder> textureEncoder = [_device newArgumentEncoderWithArguments:@[ textureArgument ]];
+bool MetalRenderer::textures_uploaded() const
+{
+    for (const PendingTexture &pending : _pending_textures)
+    {
+        if (upload_completed(pending))
+            return true;
+    }
+    return false;
+}
 
-        id<MTLArgumentEncoder> sceneEncoder = [_device newArgumentEncoderWithArguments:@[
-            verticesArgument, vertices2dArgument, texturesArgument, materialsArgument, instancesArgument,
-            instances2dArgument
-        ]];
+void MetalRenderer::swap_uploaded_textures()
+{
+    bool standalone_changed = false;
+    size_t remaining = 0;
+    for (PendingTexture &pending : _pending_textures)
+    {
+        if (!upload_completed(pending))
+        {
+            _pending_textures[remaining++] = pending;
+            continue;
+        }
 
-        _args_buffer = [_device newBufferWithLength:sceneEncoder.encodedLength options:0];
-        _textures_buffer = [_device newBufferWithLength:textureEncoder.encodedLength * _textures.size() options:0];
+#ifdef RFW_METAL_IO
+        // Slots whose texture could not be read from its file keep their previous contents.
+        if (@available(macOS 13.0, *))
+        {
+            id<MTLIOCommandBuffer> io = pending.io;
+            if (io != nil && io.status != MTLIOStatusComplete)
+            {
+                NSLog(@"Reading texture %u from its asset file failed: %@", pending.index, io.error);
+                pending.index = ~0u;
+            }
+        }
+#endif
 
-        for (size_t i = 0; i < _textures.size(); i++)
+        if (pending.index == ~0u)
         {
-            [textureEncoder setArgumentBuffer:_textures_buffer offset:textureEncoder.encodedLength * i];
-            [textureEncoder setTexture:_textures[i] atIndex:0];
+            if (pending.layer != NO_TEXTURE_LAYER)
+                _texture_arrays.free(pending.layer);
+            else
+                standalone_changed |= release_texture(pending.texture, pending.key);
+            continue;
         }
 
-        [_textures_buffer didModifyRange:NSMakeRange(0, _textures_buffer.length)];
+        // Slots that bind the tile cache are virtual, any other texture replaces the virtual texture of its slot.
+        if (pending.texture == _virtual_cache)
+            _virtual.activate(pending.index);
+        else
+            _virtual.remove(pending.index, _frames_rendered);
 
-        [sceneEncoder setArgumentBuffer:_args_buffer offset:0];
-        [sceneEncoder setBuffer:_vertex_3d_list.vertex_buffer() offset:0 atIndex:VERTICES_ARG_INDEX];
-        [sceneEncoder setBuffer:_vertex_2d_list.vertex_buffer() offset:0 atIndex:VERTICES_2D_ARG_INDEX];
-        [sceneEncoder setBuffer:_textures_buffer offset:0 atIndex:TEXTURES_ARG_INDEX];
-        [sceneEncoder setBuffer:_materials.buffer() offset:0 atIndex:MATERIALS_ARG_INDEX];
-        [sceneEncoder setBuffer:_instance_3d_list.buffer() offset:0 atIndex:INSTANCES_ARG_INDEX];
-        [sceneEncoder setBuffer:_instance_2d_list.buffer() offset:0 atIndex:INSTANCES_2D_ARG_INDEX];
-        [_args_buffer didModifyRange:NSMakeRange(0, _args_buffer.length)];
+        // Feedback of frames drawn with the previous levels of a streamed texture no longer applies.
+        StreamedTexture &streamed = _streamed_textures[pending.index];
+        if (!streamed.bytes.empty() || streamed.resident_mip != pending.first_mip)
+            _texture_generation++;
+        streamed.resident_mip = pending.first_mip;
+
+        // Packed slots show the fallback in the texture table.
+        const bool packed = pending.layer != NO_TEXTURE_LAYER;
+        id<MTLTexture> previous = _textures[pending.index];
+        _textures[pending.index] = packed ? _fallback_texture : pending.texture;
+        if (previous != _fallback_texture)
+            standalone_changed |= release_texture(previous, _texture_keys[pending.index]);
+        _texture_arrays.free(_texture_layers[pending.index]);
+        _texture_layers[pending.index] = pending.layer;
+        _texture_keys[pending.index] = pending.key;
+        standalone_changed |= !packed && pending.texture.heap == nil;
     }
+    _pending_textures.resize(remaining);
 
-    _flags = Flags::None;
-    dispatch_semaphore_signal(_sem);
+    if (standalone_changed)
+        update_texture_residency();
 }
 
-void MetalRenderer::render(mat4 matrix_2d, CameraView3D view_3d)
+TextureData MetalRenderer::track_streamed_texture(unsigned int index, const TextureData &d)
 {
-    if (_args_buffer == nil)
-        return;
+    // The resident levels of the previous contents stay in the texture table until the new ones are uploaded.
+    StreamedTexture &streamed = _streamed_textures[index];
+    if (!streamed.bytes.empty())
+        _num_streamed_textures--;
+    const unsigned int resident_mip = streamed.resident_mip;
+    streamed = StreamedTexture();
+    streamed.resident_mip = resident_mip;
 
-    dispatch_semaphore_wait(_sem, DISPATCH_TIME_FOREVER);
+    // Only chains set by the caller stream, formats the device lacks upload a white texture instead.
+    if (_texture_budget == 0 || d.mip_levels <= 1 || device_format(d) != d.format)
+        return d;
 
-    auto *uniforms = reinterpret_cast<Uniforms *>(_uniforms.data());
-    if (uniforms)
+    unsigned int tail = 0;
+    while (tail + 1 < d.mip_levels && std::max(d.width, d.height) >> tail > STREAMED_TAIL_SIZE &&
+           std::min(d.width, d.height) >> (tail + 1) > 0)
+        tail++;
+    if (tail == 0)
+        return d;
+
+    streamed.bytes.assign(d.bytes, d.bytes + mip_levels_size(d, 0));
+    streamed.data = d;
+    streamed.data.bytes = streamed.bytes.data();
+    streamed.data.num_bytes = streamed.bytes.size();
+    streamed.tail_mip = tail;
+    streamed.requested_mip = tail;
+    streamed.wanted_mip = tail;
+    _num_streamed_textures++;
+    return mip_tail(streamed.data, tail);
+}
+
+void MetalRenderer::read_texture_feedback(FrameResources &frame)
+{
+    // Feedback of virtual textures is only read back in the layout it was written in.
+    if (_virtual_layout != _virtual.layout_version())
     {
-        const mat4 projection = get_rh_projection_matrix(view_3d);
-        const mat4 view = get_rh_view_matrix(view_3d);
-        memcpy(&uniforms->projection, value_ptr(projection), sizeof(mat4));
-        memcpy(&uniforms->view_matrix, value_ptr(view), sizeof(mat4));
-        const mat4 combined = projection * view;
-        memcpy(&uniforms->combined, value_ptr(combined), sizeof(mat4));
-        memcpy(&uniforms->matrix_2d, value_ptr(matrix_2d), sizeof(mat4));
-        uniforms->view = view_3d;
+        _virtual_layout = _virtual.layout_version();
+        _texture_generation++;
     }
-    _uniforms.update();
-
-    id<CAMetalDrawable> drawable = [_layer nextDrawable];
-    if (!drawable)
+    if (_num_streamed_textures == 0 && _virtual.empty())
         return;
 
-    MTLRenderPassDescriptor *render_desc = [[MTLRenderPassDescriptor alloc] init];
+    const auto count = static_cast<unsigned int>(_streamed_textures.size());
+    const auto words = static_cast<unsigned int>(count + _virtual.feedback_words());
+    if (frame.texture_feedback == nil || frame.texture_feedback.length < words * sizeof(int))
+    {
+        frame.texture_feedback = [_device newBufferWithLength:next_multiple_of(words, 256) * sizeof(int)
+                                                      options:MTLResourceStorageModeShared];
+        frame.texture_feedback.label = @"TextureFeedback";
+    }
+    else if (frame.texture_generation == _texture_generation)
+    {
+        // Levels are relative to the resident levels the frame was drawn with, the fallback has none to stream.
+        const int *feedback = static_cast<const int *>(frame.texture_feedback.contents);
+        for (unsigned int i = 0; i < count; i++)
+        {
+            StreamedTexture &streamed = _streamed_textures[i];
+            if (feedback[i] == NO_TEXTURE_FEEDBACK || streamed.bytes.empty() || _textures[i] == _fallback_texture)
+                continue;
 
-    render_desc.depthAttachment.clearDepth = 1.0;
-    render_desc.depthAttachment.storeAction = MTLStoreActionStore;
-    render_desc.depthAttachment.loadAction = MTLLoadActionClear;
-    render_desc.depthAttachment.texture = _depth_texture;
+            const int level = std::clamp(static_cast<int>(streamed.resident_mip) + feedback[i], 0,
+                                         static_cast<int>(streamed.tail_mip));
+            streamed.requested_mip = std::min(streamed.requested_mip, static_cast<unsigned int>(level));
+            streamed.wanted_mip = std::min(streamed.wanted_mip, streamed.requested_mip);
+        }
 
-    render_desc.colorAttachments[0].texture = drawable.texture;
-    render_desc.colorAttachments[0].loadAction = MTLLoadActionClear;
-    render_desc.colorAttachments[0].storeAction = MTLStoreActionStore;
-    render_desc.colorAttachments[0].clearColor = MTLClearColorMake(0.0, 0.0, 0.0, 1.0);
+        if (frame.feedback_textures == count)
+            _virtual.read_feedback(feedback + count, frame.texture_feedback.length / sizeof(int) - count,
+                                   _frames_rendered);
+    }
 
-    id<MTLCommandBuffer> command_buffer = [_queue commandBuffer];
-    __block dispatch_semaphore_t semaphore = _sem;
-    [command_buffer addCompletedHandler:^(id<MTLCommandBuffer>) {
-      dispatch_semaphore_signal(semaphore);
-    }];
+    int *feedback = static_cast<int *>(frame.texture_feedback.contents);
+    std::fill_n(feedback, count, NO_TEXTURE_FEEDBACK);
+    std::fill(feedback + count, feedback + frame.texture_feedback.length / sizeof(int), 0);
+    frame.texture_generation = _texture_generation;
 
+    // Every pixel wrote feedback once within a period, levels it did not ask for since are no longer wanted.
+    if (++_feedback_frame % TEXTURE_FEEDBACK_PERIOD == 0)
     {
-        id<MTLRenderCommandEncoder> encoder = [command_buffer renderCommandEncoderWithDescriptor:render_desc];
+        for (StreamedTexture &streamed : _streamed_textures)
+        {
+            streamed.wanted_mip = streamed.requested_mip;
+            streamed.requested_mip = streamed.tail_mip;
+        }
+    }
+}
 
-        [encoder setRenderPipelineState:_state];
-        [encoder setDepthStencilState:_depth_state];
-        [encoder setFrontFacingWinding:MTLWindingCounterClockwise];
-        [encoder setTriangleFillMode:MTLTriangleFillModeFill];
-        [encoder setCullMode:MTLCullModeBack];
+size_t MetalRenderer::upload_streamed_texture(unsigned int index, unsigned int first_mip)
+{
+    const TextureData levels = mip_tail(_streamed_textures[index].data, first_mip);
+    id<MTLTexture> texture = create_texture(levels);
+    const size_t staged = upload_texture(texture, levels);
+    _pending_textures.push_back({index, texture, 0, first_mip});
+    return staged;
+}
 
-        for (const auto &tex : _textures)
-            [encoder useResource:tex usage:MTLResourceUsageRead];
+size_t MetalRenderer::stream_textures(size_t pressure)
+{
+    if (_num_streamed_textures == 0)
+        return 0;
 
-        [encoder useResource:_vertex_3d_list.vertex_buffer() usage:MTLResourceUsageRead];
-        [encoder useResource:_vertex_2d_list.vertex_buffer() usage:MTLResourceUsageRead];
-        [encoder useResource:_textures_buffer usage:MTLResourceUsageRead];
-        [encoder useResource:_materials.buffer() usage:MTLResourceUsageRead];
-        [encoder useResource:_instance_3d_list.buffer() usage:MTLResourceUsageRead];
-        [encoder useResource:_instance_2d_list.buffer() usage:MTLResourceUsageRead];
+    const os_signpost_id_t signpost = signpost_id();
+    os_signpost_interval_begin(signpost_log(), signpost, "stream_textures");
+    TraceSpan span(_trace, "stream_textures");
 
-        [encoder setVertexBuffer:_args_buffer offset:0 atIndex:0];
-        [encoder setVertexBuffer:_uniforms.buffer() offset:0 atIndex:1];
-        [encoder setFragmentBuffer:_args_buffer offset:0 atIndex:0];
+    // Sizes are those the levels take once the frames in flight released the versions they replace.
+    const auto count = static_cast<unsigned int>(_streamed_textures.size());
+    std::vector<size_t> sizes(count, 0);
+    std::vector<bool> uploading(count, false);
+    for (const PendingTexture &pending : _pending_textures)
+    {
+        if (pending.index >= count || _streamed_textures[pending.index].bytes.empty())
+            continue;
+        uploading[pending.index] = true;
+        sizes[pending.index] = pending.texture.allocatedSize;
+    }
 
-        const std::map<unsigned int, DrawDescriptor> &draw_ranges = _vertex_3d_list.get_draw_ranges();
-        const std::map<unsigned int, InstanceRange<Matrices>> &instances = _instance_3d_list.get_ranges();
+    size_t resident = 0;
+    std::vector<unsigned int> stream_in;
+    std::vector<unsigned int> evictable;
+    for (unsigned int i = 0; i < count; i++)
+    {
+        const StreamedTexture &streamed = _streamed_textures[i];
+        if (streamed.bytes.empty())
+            continue;
+        if (!uploading[i])
+            sizes[i] = _textures[i] == _fallback_texture ? 0 : _textures[i].allocatedSize;
+        resident += sizes[i];
 
-        for (const auto &[i, range] : draw_ranges)
-        {
-            const auto insts = instances.find(i);
-            if (insts == instances.end() || insts->second.count == 0 || range.start >= range.end)
-                continue;
+        if (uploading[i] || _textures[i] == _fallback_texture)
+            continue;
+        if (streamed.wanted_mip < streamed.resident_mip)
+            stream_in.push_back(i);
+        else if (streamed.wanted_mip > streamed.resident_mip)
+            evictable.push_back(i);
+    }
 
-            [encoder drawPrimitives:MTLPrimitiveTypeTriangle
-                        vertexStart:range.start
-                        vertexCount:(range.end - range.start)
-                      instanceCount:insts->second.count
-                       baseInstance:insts->second.start];
-        }
+    // Textures missing the most levels stream in first, textures holding the most unwanted levels are evicted first.
+    const auto missing = [&](unsigned int i) {
+        const StreamedTexture &streamed = _streamed_textures[i];
+        return static_cast<int>(streamed.resident_mip) - static_cast<int>(streamed.wanted_mip);
+    };
+    std::sort(stream_in.begin(), stream_in.end(),
+              [&](unsigned int a, unsigned int b) { return missing(a) > missing(b); });
+    std::sort(evictable.begin(), evictable.end(),
+              [&](unsigned int a, unsigned int b) { return missing(a) < missing(b); });
 
-        const std::map<unsigned int, DrawDescriptor> &ranges_2d = _vertex_2d_list.get_draw_ranges();
-        const std::map<unsigned int, InstanceRange<mat4>> &instances_2d = _instance_2d_list.get_ranges();
+    const auto levels_size = [&](unsigned int i, unsigned int first_mip) {
+        const TextureData levels = mip_tail(_streamed_textures[i].data, first_mip);
+        MTLTextureDescriptor *desc = static_texture_descriptor(levels, levels.format, mip_levels(levels));
+        return static_cast<size_t>([_device heapTextureSizeAndAlignWithDescriptor:desc].size);
+    };
 
-        [encoder setRenderPipelineState:_state_2d];
-        [encoder setDepthStencilState:_depth_state_2d];
-        [encoder setFrontFacingWinding:MTLWindingCounterClockwise];
-        [encoder setTriangleFillMode:MTLTriangleFillModeFill];
-        [encoder setCullMode:MTLCullModeNone];
-        [encoder setVertexBuffer:_args_buffer offset:0 atIndex:0];
-        [encoder setVertexBuffer:_uniforms.buffer() offset:0 atIndex:1];
-        [encoder setFragmentBuffer:_args_buffer offset:0 atIndex:0];
+    size_t budget = _texture_budget > 0 ? _texture_budget : std::numeric_limits<size_t>::max();
+    if (pressure > 0)
+        budget = std::min(budget, resident > pressure ? resident - pressure : 0);
+    const size_t first_pending = _pending_textures.size();
+    size_t next_evicted = 0;
+    size_t staged = 0;
+    size_t evicted = 0;
+    const auto evict = [&]() {
+        const unsigned int i = evictable[next_evicted++];
+        const size_t size = levels_size(i, _streamed_textures[i].wanted_mip);
+        staged += upload_streamed_texture(i, _streamed_textures[i].wanted_mip);
+        evicted += sizes[i] > size ? sizes[i] - size : 0;
+        resident = resident - sizes[i] + size;
+        _evicted_textures++;
+    };
 
-        for (const auto &[i, range] : ranges_2d)
-        {
-            const auto insts = instances_2d.find(i);
-            if (insts == instances_2d.end() || insts->second.count == 0 || range.start >= range.end)
-                continue;
+    for (unsigned int i : stream_in)
+    {
+        if (staged >= MAX_STREAMED_BYTES_PER_FRAME)
+            break;
 
-            [encoder drawPrimitives:MTLPrimitiveTypeTriangle
-                        vertexStart:range.start
-                        vertexCount:(range.end - range.start)
-                      instanceCount:insts->second.count
-                       baseInstance:insts->second.start];
+        // Streams in as many of the wanted levels as fit the budget once unwanted levels are evicted.
+        const StreamedTexture &streamed = _streamed_textures[i];
+        unsigned int first_mip = streamed.wanted_mip;
+        for (; first_mip < streamed.resident_mip; first_mip++)
+        {
+            const size_t size = levels_size(i, first_mip);
+            while (resident - sizes[i] + size > budget && next_evicted < evictable.size())
+                evict();
+            if (resident - sizes[i] + size <= budget)
+                break;
         }
+        if (first_mip == streamed.resident_mip)
+            continue;
 
-        [encoder endEncoding];
+        const size_t size = levels_size(i, first_mip);
+        staged += upload_streamed_texture(i, first_mip);
+        resident = resident - sizes[i] + size;
     }
 
-    [command_buffer presentDrawable:drawable];
-    [command_buffer commit];
+    // A lowered budget evicts without anything streaming in.
+    while (resident > budget && next_evicted < evictable.size())
+        evict();
+
+    if (_pending_textures.size() > first_pending)
+    {
+        const uint64_t upload = _staging.submit();
+        for (size_t i = first_pending; i < _pending_textures.size(); i++)
+            _pending_textures[i].upload = upload;
+    }
+    os_signpost_interval_end(signpost_log(), signpost, "stream_textures", "%zu textures, %zu bytes uploaded",
+                             _pending_textures.size() - first_pending, staged);
+    return evicted;
 }
 
-void MetalRenderer::resize(unsigned int width, unsigned int height, double scale)
+bool MetalRenderer::wait_for_frame(uint64_t frame, unsigned int timeout_ms)
 {
-    const auto scale_f = static_cast<float>(scale);
-    const CGSize size = CGSizeMake(static_cast<float>(width) * scale_f, static_cast<float>(height) * scale_f);
-
-    [_layer setDrawableSize:size];
-
-    MTLTextureDescriptor *tex_desc = [[MTLTextureDescriptor alloc] init];
-    tex_desc.pixelFormat = MTLPixelFormatDepth32Float;
-    tex_desc.width = static_cast<unsigned int>(static_cast<double>(width) * scale);
-    tex_desc.height = static_cast<unsigned int>(static_cast<double>(height) * scale);
-    tex_desc.depth = 1;
-    tex_desc.textureType = MTLTextureType2D;
-    tex_desc.storageMode = MTLStorageModePrivate;
+    if (_frame_event.signaledValue >= frame)
+        return true;
+    if (frame > _frames_rendered)
+        return false;
 
-    _depth_texture = [_device newTextureWithDescriptor:tex_desc];
+    dispatch_semaphore_t completed = dispatch_semaphore_create(0);
+    [_frame_event notifyListener:_frame_listener
+                         atValue:frame
+                           block:^(id<MTLSharedEvent>, uint64_t) {
+                             dispatch_semaphore_signal(completed);
+                           }];
+    const int64_t timeout = static_cast<int64_t>(timeout_ms) * static_cast<int64_t>(NSEC_PER_MSEC);
+    return dispatch_semaphore_wait(completed, dispatch_time(DISPATCH_TIME_NOW, timeout)) == 0;
 }
 
-void mip_level_width_height(const TextureData &d, unsigned int level, unsigned int *width, unsigned int *height)
+MemoryStats MetalRenderer::memory_stats() const
 {
-    unsigned int w = d.width;
-    unsigned int h = d.height;
-    if (level == 0)
+    MemoryStats stats = {};
+    const auto add = [&stats](MemoryCategory category, id<MTLResource> resource) {
+        stats.bytes[category] += [resource allocatedSize];
+    };
+
+    const auto add_vertex_list = [&](const auto &list, size_t vertex_size) {
+        add(MEMORY_VERTICES, list.vertex_buffer());
+        add(MEMORY_VERTICES, list.jw_buffer());
+        add(MEMORY_VERTICES, list.index_buffer());
+        add(MEMORY_VERTICES, list.anim_buffer());
+        stats.unused_vertex_bytes += (list.allocator().capacity() - list.allocator().used()) * vertex_size;
+    };
+    add_vertex_list(_vertex_3d_list, sizeof(Vertex3D));
+    add_vertex_list(_packed_3d_list, sizeof(PackedVertex3D));
+    add_vertex_list(_vertex_2d_list, sizeof(Vertex2D));
+
+    const auto add_instance_list = [&stats](const auto &list) {
+        stats.unused_instance_bytes += list.unused_bytes();
+        stats.instance_holes += static_cast<unsigned int>(list.holes());
+    };
+    add_instance_list(_instance_3d_list);
+    add_instance_list(_instance_2d_list);
+    add_instance_list(_glyph_list);
+    add_instance_list(_sprite_list);
+
+    for (unsigned int i = 0; i < _frames.size(); i++)
     {
-        if (width)
-            *width = w;
-        if (height)
-            *height = h;
-        return;
+        const FrameResources &frame = _frames[i];
+        if (frame.batched_2d)
+            add(MEMORY_VERTICES, frame.batched_2d->buffer());
+        add(MEMORY_INSTANCES, _instance_3d_list.buffer(i));
+        add(MEMORY_INSTANCES, _instance_overrides.buffer(i));
+        add(MEMORY_INSTANCES, _instance_2d_list.buffer(i));
+        add(MEMORY_INSTANCES, _glyph_list.buffer(i));
+        add(MEMORY_INSTANCES, _sprite_list.buffer(i));
+        add(MEMORY_ARGUMENTS, frame.args_buffer);
+        add(MEMORY_ARGUMENTS, frame.texture_feedback);
+        add(MEMORY_ARGUMENTS, frame.virtual_pages);
+        add(MEMORY_INSTANCES, frame.visible_instances);
+        add(MEMORY_TARGETS, frame.target);
+        add(MEMORY_TARGETS, frame.readback);
+    }
+    add(MEMORY_VERTICES, _clusters);
+    add(MEMORY_VERTICES, _culled_indices);
+    add(MEMORY_VERTICES, _skinned_bounds);
+    add(MEMORY_INSTANCES, _visible_instances);
+    for (const auto &[id, animator] : _instance_animations)
+        add(MEMORY_INSTANCES, animator.instances);
+    add(MEMORY_INSTANCES, _hierarchy.links);
+    add(MEMORY_INSTANCES, _hierarchy.locals);
+    add(MEMORY_INSTANCES, _hierarchy.worlds);
+    for (const auto &[id, terrain] : _terrains)
+    {
+        add(MEMORY_VERTICES, terrain.heights);
+        add(MEMORY_VERTICES, terrain.materials);
+    }
+    for (const auto &[id, scatter] : _scatters)
+        add(MEMORY_INSTANCES, scatter.density);
+    for (const auto &[id, cloud] : _point_clouds)
+        add(MEMORY_VERTICES, cloud.points);
+    for (const auto &[id, path] : _paths_2d)
+        add(MEMORY_VERTICES, path.buffer);
+    for (const auto &[id, system] : _particle_systems)
+    {
+        add(MEMORY_INSTANCES, system.particles);
+        add(MEMORY_INSTANCES, system.alive);
+        add(MEMORY_INSTANCES, system.dead);
+        add(MEMORY_INSTANCES, system.counters);
     }
+    add(MEMORY_INSTANCES, _occluded_instances);
+    add(MEMORY_INSTANCES, _previous_instances);
 
-    for (unsigned int i = 0; i < level; i++)
+    // Heaps are allocated whole, the textures placed in them are part of their size.
+    for (id<MTLHeap> heap : _texture_heaps)
+        stats.bytes[MEMORY_TEXTURES] += heap.size;
+    for (id<MTLTexture> texture : _standalone_textures)
+        add(MEMORY_TEXTURES, texture);
+    for (id<MTLTexture> texture : _texture_arrays.textures())
+        add(MEMORY_TEXTURES, texture);
+    add(MEMORY_TEXTURES, _fallback_texture);
+    add(MEMORY_TEXTURES, _glyph_atlas);
+    add(MEMORY_TEXTURES, _hud.atlas());
+    for (id<MTLResource> resource : {_skybox, _environment, _irradiance, _probe_captures, _probe_maps, _probe_depth})
+        add(MEMORY_TEXTURES, resource);
+
+    add(MEMORY_ARGUMENTS, _textures_buffer);
+    add(MEMORY_ARGUMENTS, _samplers_buffer);
+    add(MEMORY_ARGUMENTS, _texture_layers_buffer);
+    add(MEMORY_ARGUMENTS, _texture_arrays_buffer);
+    for (const FrameResources &frame : _frames)
+        add(MEMORY_ARGUMENTS, frame.materials);
+    add(MEMORY_ARGUMENTS, _draw_commands);
+    add(MEMORY_ARGUMENTS, _draw_commands_args);
+    add(MEMORY_ARGUMENTS, _rate_map_data);
+    add(MEMORY_ARGUMENTS, _area_light_buffer);
+    add(MEMORY_ARGUMENTS, _light_tree);
+    stats.bytes[MEMORY_ARGUMENTS] += _instance_bvh.allocated_size();
+
+    // Targets placed in the pool are part of the size of its heap.
+    const auto add_target = [&](id<MTLResource> target) {
+        if (target.heap == nil)
+            add(MEMORY_TARGETS, target);
+    };
+    stats.bytes[MEMORY_TARGETS] += _target_pool.size() + _frame_graph.size();
+    // Targets of the surfaces that are not selected only count by their heaps.
+    for (const Surface &surface : _surfaces)
+        stats.bytes[MEMORY_TARGETS] += surface.target_pool.size() + surface.frame_graph.size();
+    for (id<MTLTexture> texture : _gbuffer)
+        add_target(texture);
+    for (id<MTLResource> target : {_depth_texture, _msaa_color, _msaa_depth, _inset_depth, _scaled_color,
+                                   _motion_vectors, _taa_history[0], _taa_history[1], _depth_pyramid, _cascade_shadows,
+                                   _spot_shadows, _ray_traced, _layer_2d, _pick_ids, _pick_depth})
+        add_target(target);
+#ifdef RFW_METAL_FX
+    add_target(_upscaled);
+#endif
+    for (id<MTLResource> buffer : {_tile_lights, _path_tracer.paths, _path_tracer.hits, _path_tracer.shadow_rays,
+                                   _path_tracer.counters, _path_tracer.accumulator, _path_tracer.radiance,
+                                   _path_tracer.moments, _path_tracer.tiles, _path_tracer.progress, _gi.irradiance,
+                                   _gi.distances, _gi.radiance})
+        add(MEMORY_TARGETS, buffer);
+    stats.bytes[MEMORY_TARGETS] += _sdf_scene.allocated_size();
+    for (const LightmapBake &bake : _lightmap_bakes)
+    {
+        for (id<MTLResource> resource : {bake.positions, bake.normals, bake.paths, bake.hits, bake.shadow_rays,
+                                         bake.counters, bake.accumulator, bake.filtered[0], bake.filtered[1],
+                                         bake.packed})
+            add(MEMORY_TARGETS, resource);
+    }
+    for (unsigned int i = 0; i < 2; i++)
     {
-        w >>= 1;
-        h >>= 1;
+        for (id<MTLResource> buffer : {_path_tracer.surfaces[i], _path_tracer.history[i], _path_tracer.filtered[i]})
+            add(MEMORY_TARGETS, buffer);
     }
 
-    if (width)
-        *width = w;
-    if (height)
-        *height = h;
+    add(MEMORY_STAGING, _upload_ring.buffer());
+    add(MEMORY_STAGING, _primitives.scratch());
+    stats.bytes[MEMORY_STAGING] += _staging.allocated_size();
+
+    stats.allocated = _device.currentAllocatedSize;
+    stats.recommended_working_set = _device.recommendedMaxWorkingSetSize;
+    stats.budget = memory_budget();
+    stats.evicted_meshes = _evicted_meshes;
+    stats.evicted_textures = _evicted_textures;
+    stats.cached = _mesh_cache.size() + _texture_cache.size();
+    return stats;
+}
+
+void MetalRenderer::set_memory_policy(MemoryPolicy policy, MeshEvictionCallback callback, void *user_data)
+{
+    _memory_policy_set = true;
+    _memory_policy = policy;
+    _eviction_callback = callback;
+    _eviction_user_data = user_data;
+}
+
+void MetalRenderer::set_resource_cache(size_t bytes)
+{
+    _mesh_cache.set_capacity(bytes);
+    _texture_cache.set_capacity(bytes);
+}
+
+void MetalRenderer::set_deduplication(bool enabled)
+{
+    _deduplicate = enabled;
+    _vertex_3d_list.set_deduplication(enabled);
+    _packed_3d_list.set_deduplication(enabled);
+    _vertex_2d_list.set_deduplication(enabled);
+}
+
+size_t MetalRenderer::memory_budget() const
+{
+    const auto recommended = static_cast<size_t>(_device.recommendedMaxWorkingSetSize);
+    const size_t budget = static_cast<size_t>(_memory_policy.budget_megabytes) * 1024 * 1024;
+    return budget > 0 ? std::min(budget, recommended) : recommended;
 }
 
-unsigned int mip_offset(const TextureData &d, unsigned int level)
+size_t MetalRenderer::memory_excess() const
 {
-    unsigned int w = d.width;
-    unsigned int h = d.height;
-    if (level == 0)
+    if (!_memory_policy_set)
         return 0;
 
-    unsigned int offset = 0;
-    for (unsigned int i = 0; i < level; i++)
+    // Vertex buffer space is reused before buffers grow, textures replaced by pending uploads are released soon and
+    // the OS reclaims the resource cache before anything else.
+    const MemoryStats stats = memory_stats();
+    size_t available = memory_budget() + stats.unused_vertex_bytes + stats.cached;
+    for (const PendingTexture &pending : _pending_textures)
     {
-        offset += w * h;
-        w >>= 1;
-        h >>= 1;
+        if (pending.index < _textures.size() && _textures[pending.index] != _fallback_texture)
+            available += [_textures[pending.index] allocatedSize];
     }
 
-    return offset;
+    const auto allocated = static_cast<size_t>(_device.currentAllocatedSize);
+    return allocated > available ? allocated - available : 0;
 }
 
-void MetalRenderer::set_textures(const TextureData *data, unsigned int num_textures, const unsigned int *changed)
+void MetalRenderer::evict_meshes(size_t bytes)
 {
-    if (_textures.empty() || _textures.size() != num_textures)
+    if (!_memory_policy_set || _memory_policy.mesh_idle_frames == 0)
+        return;
+
+    const auto has_instances = [&](unsigned int id) {
+        return id < _instance_3d_matrices.size() && _instance_3d_matrices[id] && !_instance_3d_matrices[id]->empty();
+    };
+    for (auto &[id, frame] : _mesh_drawn_frames)
     {
-        for (auto &_texture : _textures)
-            _texture = nil;
-        _textures.clear();
+        if (has_instances(id))
+            frame = _frames_rendered;
+    }
+    if (bytes == 0)
+        return;
 
-        for (size_t i = 0; i < num_textures; i++)
-        {
-            MTLTextureDescriptor *desc = [[MTLTextureDescriptor alloc] init];
-            const TextureData &d = data[i];
-            desc.width = d.width;
-            desc.height = d.height;
-            desc.pixelFormat = MTLPixelFormatBGRA8Unorm;
-            desc.mipmapLevelCount = d.mip_levels;
-            desc.sampleCount = 1;
-            desc.storageMode = MTLStorageModeManaged;
-            desc.textureType = MTLTextureType2D;
-            desc.usage = MTLTextureUsageShaderRead;
+    std::vector<std::pair<uint64_t, unsigned int>> idle;
+    for (const auto &[id, frame] : _mesh_drawn_frames)
+    {
+        if (!has_instances(id) && _frames_rendered - frame >= _memory_policy.mesh_idle_frames)
+            idle.emplace_back(frame, id);
+    }
+    std::sort(idle.begin(), idle.end());
 
-            id<MTLTexture> texture = [_device newTextureWithDescriptor:desc];
+    const auto mesh_bytes = [](const DrawDescriptor *range, size_t vertex_size) -> size_t {
+        if (!range)
+            return 0;
+        return (range->end - range->start) * vertex_size + range->index_count * (range->short_indices ? 2 : 4);
+    };
 
-            for (unsigned int m = 0; m < d.mip_levels; m++)
-            {
-                unsigned int w = d.width;
-                unsigned int h = d.height;
-                mip_level_width_height(d, m, &w, &h);
+    std::vector<unsigned int> evicted;
+    size_t freed = 0;
+    for (size_t i = 0; i < idle.size() && freed < bytes; i++)
+    {
+        const unsigned int id = idle[i].second;
+        freed += mesh_bytes(_vertex_3d_list.get_draw_ranges().find(id), sizeof(Vertex3D));
+        freed += mesh_bytes(_packed_3d_list.get_draw_ranges().find(id), sizeof(PackedVertex3D));
+        evicted.push_back(id);
+    }
+    if (evicted.empty())
+        return;
 
-                [texture replaceRegion:MTLRegionMake2D(0, 0, w, h)
-                           mipmapLevel:m
-                             withBytes:d.bytes + mip_offset(d, m)
-                           bytesPerRow:w * sizeof(unsigned int)];
-            }
+    const auto count = static_cast<unsigned int>(evicted.size());
+    unload_3d_meshes(evicted.data(), count);
+    _evicted_meshes += count;
+    _flags |= Flags::Update3D | Flags::UpdateInstances3D;
+    if (_eviction_callback)
+        _eviction_callback(_eviction_user_data, evicted.data(), count);
+}
 
-            _textures.push_back(texture);
-        }
+void MetalRenderer::set_cell_streaming(const StreamingSettings &settings, CellStreamingCallback callback,
+                                       void *user_data)
+{
+    _cells.configure(settings);
+    _cell_callback = callback;
+    _cell_user_data = user_data;
+}
+
+void MetalRenderer::set_streaming_cell(unsigned int id, const StreamingCell &cell)
+{
+    const StreamedCell previous = _cells.set_cell(id, cell);
+    if (previous.loaded)
+        unload_cell(id, previous);
+}
+
+void MetalRenderer::remove_streaming_cell(unsigned int id)
+{
+    const StreamedCell previous = _cells.remove_cell(id);
+    if (previous.loaded)
+        unload_cell(id, previous);
+}
+
+void MetalRenderer::stream_cells()
+{
+    const CellPlan plan = _cells.plan();
+    if (plan.load.empty() && plan.unload.empty())
+        return;
+
+    TraceSpan span(_trace, "stream_cells");
+    for (unsigned int id : plan.unload)
+    {
+        unload_cell(id, *_cells.find(id));
+        _cells.mark_loaded(id, false);
     }
-    else
+
+    // The textures of every cell are set at once, the slots that don't change are not read.
+    constexpr unsigned int word_bits = sizeof(size_t) * 8;
+    const auto num_textures = static_cast<unsigned int>(_textures.size());
+    std::vector<TextureData> textures(num_textures);
+    std::vector<size_t> changed((num_textures + word_bits - 1) / word_bits, 0);
+    bool textures_changed = false;
+    for (unsigned int id : plan.load)
     {
-        for (size_t i = 0; i < num_textures; i++)
+        const StreamedCell &cell = *_cells.find(id);
+        for (size_t i = 0; i < cell.mesh_ids.size(); i++)
+            set_3d_mesh(cell.mesh_ids[i], cell.meshes[i]);
+        for (size_t i = 0; i < cell.texture_slots.size(); i++)
         {
-            if (changed[i] != 1)
+            const unsigned int slot = cell.texture_slots[i];
+            if (slot >= num_textures)
                 continue;
+            textures[slot] = cell.textures[i];
+            changed[slot / word_bits] |= size_t(1) << (slot % word_bits);
+            textures_changed = true;
+        }
+        _cells.mark_loaded(id, true);
+    }
+    if (textures_changed)
+        set_textures(textures.data(), num_textures, changed.data(), num_textures);
+    _flags |= Flags::Update3D | Flags::UpdateInstances3D;
+
+    if (_cell_callback)
+    {
+        for (unsigned int id : plan.load)
+            _cell_callback(_cell_user_data, id, 1);
+    }
+}
 
-            const TextureData &d = data[i];
-            id<MTLTexture> texture = _textures[i];
+void MetalRenderer::unload_cell(unsigned int id, const StreamedCell &cell)
+{
+    if (!cell.mesh_ids.empty())
+        unload_3d_meshes(cell.mesh_ids.data(), static_cast<unsigned int>(cell.mesh_ids.size()));
+    _flags |= Flags::Update3D | Flags::UpdateInstances3D;
 
-            MTLTextureDescriptor *desc = [[MTLTextureDescriptor alloc] init];
-            if (d.width != texture.width || d.height != texture.height)
-            {
-                desc.width = d.width;
-                desc.height = d.height;
-                desc.pixelFormat = MTLPixelFormatBGRA8Unorm;
-                desc.mipmapLevelCount = d.mip_levels;
-                desc.sampleCount = 1;
-                desc.storageMode = MTLStorageModeManaged;
-                desc.textureType = MTLTextureType2D;
-                desc.usage = MTLTextureUsageShaderRead;
+    // The fallback replaces the slots like an upload that completed, which releases their textures.
+    for (unsigned int slot : cell.texture_slots)
+    {
+        if (slot >= _textures.size())
+            continue;
+        supersede_texture_uploads(slot);
+        track_streamed_texture(slot, TextureData{});
+        _pending_textures.push_back({slot, _fallback_texture, 0, 0, 0});
+    }
 
-                texture = [_device newTextureWithDescriptor:desc];
+    if (_cell_callback)
+        _cell_callback(_cell_user_data, id, 0);
+}
 
-                for (unsigned int m = 0; m < d.mip_levels; m++)
-                {
-                    unsigned int w = d.width;
-                    unsigned int h = d.height;
-                    mip_level_width_height(d, m, &w, &h);
-
-                    [texture replaceRegion:MTLRegionMake2D(0, 0, w, h)
-                               mipmapLevel:m
-                                 withBytes:d.bytes + mip_offset(d, m)
-                               bytesPerRow:w * sizeof(unsigned int)];
-                }
+bool MetalRenderer::release_texture(id<MTLTexture> texture, size_t key)
+{
+    // The tile cache stays for the other virtual textures.
+    if (texture.heap != nil || texture == _virtual_cache)
+        return false;
 
-                _flags |= UpdateTextures;
-                _textures[i] = texture;
-            }
-            else
+    _standalone_textures.erase(std::remove(_standalone_textures.begin(), _standalone_textures.end(), texture),
+                               _standalone_textures.end());
+    if (key != 0)
+        _texture_cache.insert(key, texture, true);
+    return true;
+}
+
+size_t MetalRenderer::texture_key(const TextureData &d)
+{
+    if ((_texture_cache.capacity() == 0 && !_deduplicate) || !d.bytes || d.width == 0 || d.height == 0 ||
+        d.mip_levels == 0)
+        return 0;
+
+    // Textures only match when they are created the same way as well.
+    const size_t size = mip_levels_size(d, 0);
+    const std::string_view bytes(reinterpret_cast<const char *>(d.bytes), size);
+    const unsigned int levels = mip_levels(d);
+    const MTLPixelFormat format = device_format(d);
+    size_t key = std::hash<std::string_view>()(bytes);
+    for (const size_t value : {size_t(d.width), size_t(d.height), size_t(levels), size_t(format)})
+        key ^= value + 0x9e3779b97f4a7c15ull + (key << 6) + (key >> 2);
+    key = key != 0 ? key : 1;
+
+    // Hashes only pick the candidate, the contents of the first texture with the key decide.
+    const auto [it, inserted] = _texture_contents.try_emplace(key);
+    TextureContents &contents = it->second;
+    if (inserted)
+    {
+        contents = {d.width, d.height, levels, format, std::vector<unsigned char>(d.bytes, d.bytes + size)};
+        return key;
+    }
+    if (contents.width != d.width || contents.height != d.height || contents.mip_levels != levels ||
+        contents.format != format || contents.bytes.size() != size ||
+        std::memcmp(contents.bytes.data(), d.bytes, size) != 0)
+        return 0;
+    return key;
+}
+
+void MetalRenderer::prune_texture_contents()
+{
+    std::unordered_set<size_t> held(_texture_keys.begin(), _texture_keys.end());
+    for (const PendingTexture &pending : _pending_textures)
+        held.insert(pending.key);
+    for (const DeferredTexture &deferred : _deferred_textures)
+        held.insert(deferred.key);
+    for (auto it = _texture_contents.begin(); it != _texture_contents.end();)
+    {
+        if (held.count(it->first) == 0 && !_texture_cache.contains(it->first))
+            it = _texture_contents.erase(it);
+        else
+            ++it;
+    }
+}
+
+void MetalRenderer::update_texture_residency()
+{
+#ifdef RFW_METAL_RESIDENCY_SETS
+    if (@available(macOS 15.0, *))
+    {
+        if (_texture_residency == nil)
+        {
+            MTLResidencySetDescriptor *desc = [MTLResidencySetDescriptor new];
+            desc.label = @"Textures";
+            NSError *error = nil;
+            _texture_residency = [_device newResidencySetWithDescriptor:desc error:&error];
+            if (_texture_residency == nil)
             {
-                const unsigned char *bytes = d.bytes;
-                for (unsigned int m = 0; m < d.mip_levels; m++)
-                {
-                    unsigned int w = d.width;
-                    unsigned int h = d.height;
-                    mip_level_width_height(d, m, &w, &h);
-
-                    [texture replaceRegion:MTLRegionMake2D(0, 0, w, h)
-                               mipmapLevel:m
-                                 withBytes:d.bytes + mip_offset(d, m)
-                               bytesPerRow:w * sizeof(unsigned int)];
-                    bytes += w * h;
-                }
+                NSLog(@"Could not create texture residency set: %@", error);
+                return;
             }
+            [_queue addResidencySet:_texture_residency];
         }
-    }
 
-    _flags |= Flags::UpdateTextures;
+        [_texture_residency removeAllAllocations];
+        [_texture_residency addAllocation:_fallback_texture];
+        for (const auto &heap : _texture_heaps)
+            [_texture_residency addAllocation:heap];
+        for (const auto &tex : _standalone_textures)
+            [_texture_residency addAllocation:tex];
+        for (const auto &tex : _texture_arrays.textures())
+            [_texture_residency addAllocation:tex];
+        [_texture_residency commit];
+        [_texture_residency requestResidency];
+    }
+#endif
 }
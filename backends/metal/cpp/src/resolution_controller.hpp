@@ -0,0 +1,95 @@
+#ifndef METALCPP_SRC_RESOLUTION_CONTROLLER_HPP
+#define METALCPP_SRC_RESOLUTION_CONTROLLER_HPP
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+
+// Picks the 3D render scale that keeps the GPU time of frames below a target. The cost of a frame is assumed to grow
+// with its pixels, so the scale follows the square root of the time it has to lose or may gain. Scales change in
+// steps and only once a full window of frames measured the current one, frames rendered before a change are skipped.
+class ResolutionController
+{
+  public:
+    // A target of 0 disables the controller.
+    void configure(float target_ms, float min_scale, float max_scale)
+    {
+        _target_ms = std::max(target_ms, 0.0f);
+        _min_scale = std::clamp(std::min(min_scale, max_scale), MIN_SCALE, 1.0f);
+        _max_scale = std::clamp(std::max(min_scale, max_scale), MIN_SCALE, 1.0f);
+        reset();
+    }
+
+    bool enabled() const
+    {
+        return _target_ms > 0.0f;
+    }
+
+    float max_scale() const
+    {
+        return _max_scale;
+    }
+
+    // Adds the GPU time of the last completed frame, returns the scale the next frames render at.
+    float update(float frame_ms, float scale)
+    {
+        scale = std::clamp(scale, _min_scale, _max_scale);
+        if (_settle > 0)
+        {
+            _settle--;
+            return scale;
+        }
+
+        _window[_next] = frame_ms;
+        _next = (_next + 1) % WINDOW;
+        _count = std::min(_count + 1, WINDOW);
+        if (_count < WINDOW)
+            return scale;
+
+        float total = 0.0f;
+        for (float ms : _window)
+            total += ms;
+        const float average = total / static_cast<float>(WINDOW);
+
+        // Frames over the target lose resolution right away, frames only gain it back when they are well below it, so
+        // the scale doesn't alternate between two steps.
+        if (average <= _target_ms && average >= _target_ms * GROW_BELOW)
+            return scale;
+        const float ideal = scale * std::sqrt(_target_ms * HEADROOM / std::max(average, 0.01f));
+        float next = std::floor(ideal / STEP) * STEP;
+        next = average > _target_ms ? std::min(next, scale - STEP) : std::max(next, scale);
+        next = std::clamp(next, _min_scale, _max_scale);
+        if (std::abs(next - scale) < STEP * 0.5f)
+            return scale;
+
+        reset();
+        return next;
+    }
+
+  private:
+    static constexpr float MIN_SCALE = 0.5f;
+    static constexpr float STEP = 0.05f;
+    // Fraction of the target a new scale aims for and below which frames may grow.
+    static constexpr float HEADROOM = 0.9f;
+    static constexpr float GROW_BELOW = 0.75f;
+    static constexpr size_t WINDOW = 16;
+    // Frames that may still be in flight at the previous scale.
+    static constexpr unsigned int SETTLE_FRAMES = 4;
+
+    void reset()
+    {
+        _count = 0;
+        _next = 0;
+        _settle = SETTLE_FRAMES;
+    }
+
+    float _target_ms = 0.0f;
+    float _min_scale = MIN_SCALE;
+    float _max_scale = 1.0f;
+    std::array<float, WINDOW> _window = {};
+    size_t _next = 0;
+    size_t _count = 0;
+    unsigned int _settle = 0;
+};
+
+#endif // METALCPP_SRC_RESOLUTION_CONTROLLER_HPP
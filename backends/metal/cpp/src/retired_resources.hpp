@@ -0,0 +1,48 @@
+#ifndef METALCPP_SRC_RETIRED_RESOURCES_HPP
+#define METALCPP_SRC_RETIRED_RESOURCES_HPP
+
+#import <Metal/Metal.h>
+
+#include <cstdint>
+#include <deque>
+#include <utility>
+
+// Frame command buffers don't retain the resources they reference. Objects that are replaced or dropped while frames
+// in flight may still use them are retired instead, they are kept until the last frame submitted at that point
+// completed. Objects dropped while the GPU is idle don't need it.
+class RetiredResources
+{
+  public:
+    // Frame that objects retired from now on may be used by.
+    void set_frame(uint64_t frame)
+    {
+        _frame = frame;
+    }
+
+    template <typename... Objects> void retire(Objects... objects)
+    {
+        for (id object : {static_cast<id>(objects)...})
+        {
+            if (object != nil)
+                _objects.emplace_back(_frame, object);
+        }
+    }
+
+    // Releases the objects of the frames up to completed, frames complete in order.
+    void release(uint64_t completed)
+    {
+        while (!_objects.empty() && _objects.front().first <= completed)
+            _objects.pop_front();
+    }
+
+    size_t size() const
+    {
+        return _objects.size();
+    }
+
+  private:
+    std::deque<std::pair<uint64_t, id>> _objects;
+    uint64_t _frame = 0;
+};
+
+#endif // METALCPP_SRC_RETIRED_RESOURCES_HPP
@@ -0,0 +1,468 @@
+#ifndef METALCPP_SRC_SCENE_CACHE_HPP
+#define METALCPP_SRC_SCENE_CACHE_HPP
+
+#import <Metal/Metal.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <utility>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "library.h"
+#include "mesh_order.hpp"
+#include "sdf_field.hpp"
+#include "texture_format.hpp"
+
+// Binary cache of the meshes, instances, materials and textures of a scene, stored in the layouts the renderer takes
+// them in, along with the signed distance fields of the meshes that have RTTriangles. Loading maps the file and hands
+// the renderer pointers into the mapping, nothing is parsed or converted. Every array starts at a multiple of
+// BLOB_ALIGNMENT, so texture levels and fields are copied to the GPU straight out of the mapping. Files of another
+// version or written with other struct layouts are rejected.
+class SceneCache
+{
+  public:
+    // Distance field of a mesh in the layout of the field buffer of SdfScene, voxels is null for meshes without one.
+    struct Field
+    {
+        SdfVolume volume;
+        const uint16_t *voxels;
+    };
+
+    static constexpr uint32_t VERSION = 2;
+    static constexpr size_t BLOB_ALIGNMENT = 256;
+
+    SceneCache() = default;
+    SceneCache(const SceneCache &) = delete;
+    SceneCache &operator=(const SceneCache &) = delete;
+
+    ~SceneCache()
+    {
+        _buffer = nil;
+        if (_mapping)
+            munmap(_mapping, _mapped_size);
+    }
+
+    static bool write(const char *path, const SceneCacheData &data)
+    {
+        Header header = {};
+        memcpy(header.magic, MAGIC, sizeof(header.magic));
+        header.version = VERSION;
+        header.layout = layout();
+        header.num_meshes = data.num_meshes;
+        header.num_instances = data.num_instances;
+        header.num_materials = data.num_materials;
+        header.num_textures = data.num_textures;
+
+        // Blobs follow the records in the order they are laid out here.
+        uint64_t end = sizeof(Header) + data.num_meshes * sizeof(Mesh) + data.num_instances * sizeof(Instances) +
+                       data.num_textures * sizeof(Texture);
+        std::vector<std::pair<const void *, uint64_t>> blobs;
+        const auto place = [&](const void *bytes, uint64_t size) -> uint64_t {
+            if (!bytes || size == 0)
+                return 0;
+            end = (end + BLOB_ALIGNMENT - 1) / BLOB_ALIGNMENT * BLOB_ALIGNMENT;
+            const uint64_t offset = end;
+            blobs.emplace_back(bytes, size);
+            end += size;
+            return offset;
+        };
+
+        // Meshes flagged OPTIMIZE_ORDER are stored reordered, on all cores, and without the flag.
+        std::vector<OrderedMesh> ordered(data.num_meshes);
+        std::vector<MeshData3D> source(data.meshes, data.meshes + data.num_meshes);
+        OrderedMesh *ordered_data = ordered.data();
+        MeshData3D *source_data = source.data();
+        dispatch_apply(data.num_meshes, dispatch_get_global_queue(QOS_CLASS_UTILITY, 0), ^(size_t i) {
+          MeshData3D &mesh = source_data[i];
+          if ((mesh.flags & OPTIMIZE_ORDER) == 0 || !mesh.indices || mesh.num_indices < 3)
+              return;
+          OrderedMesh &copy = ordered_data[i];
+          optimize_mesh_order(mesh.vertices, mesh.skin_data, mesh.num_vertices, mesh.indices, mesh.num_indices,
+                              mesh.ranges, mesh.num_ranges, mesh.bounds, copy.vertices, copy.skin_data, copy.indices);
+          mesh.vertices = copy.vertices.data();
+          mesh.skin_data = mesh.skin_data ? copy.skin_data.data() : nullptr;
+          mesh.indices = copy.indices.data();
+          mesh.flags &= ~OPTIMIZE_ORDER;
+        });
+
+        // Fields are built from the triangles of the meshes on all cores, so SdfScene copies them when the cache is
+        // loaded instead of generating them.
+        std::vector<std::vector<uint16_t>> fields(data.num_meshes);
+        std::vector<SdfVolume> volumes(data.num_meshes);
+        std::vector<uint16_t> *fields_data = fields.data();
+        SdfVolume *volumes_data = volumes.data();
+        dispatch_apply(data.num_meshes, dispatch_get_global_queue(QOS_CLASS_UTILITY, 0), ^(size_t i) {
+          const MeshData3D &mesh = source_data[i];
+          if (mesh.triangles && mesh.num_triangles > 0 && fit_sdf_volume(mesh.bounds, volumes_data[i]))
+              build_sdf_field(mesh.triangles, mesh.num_triangles, volumes_data[i], fields_data[i]);
+        });
+
+        std::vector<Mesh> meshes(data.num_meshes);
+        for (unsigned int i = 0; i < data.num_meshes; i++)
+        {
+            const MeshData3D &mesh = source[i];
+            Mesh &record = meshes[i];
+            record.bounds = mesh.bounds;
+            record.id = data.mesh_ids[i];
+            record.flags = mesh.flags;
+            record.num_vertices = mesh.vertices ? mesh.num_vertices : 0;
+            record.num_indices = mesh.indices ? mesh.num_indices : 0;
+            record.num_ranges = mesh.ranges ? mesh.num_ranges : 0;
+            record.vertices = place(mesh.vertices, uint64_t(mesh.num_vertices) * sizeof(Vertex3D));
+            record.skin_data = place(mesh.skin_data, uint64_t(mesh.num_vertices) * sizeof(JointData));
+            record.indices = place(mesh.indices, uint64_t(record.num_indices) * sizeof(unsigned int));
+            record.ranges = place(mesh.ranges, uint64_t(record.num_ranges) * sizeof(VertexRange));
+            record.field_volume = volumes[i];
+            record.field = place(fields[i].data(), uint64_t(fields[i].size()) * sizeof(uint16_t));
+        }
+
+        std::vector<Instances> instances(data.num_instances);
+        for (unsigned int i = 0; i < data.num_instances; i++)
+        {
+            const InstancesData3D &instance = data.instances[i];
+            Instances &record = instances[i];
+            record.local_aabb = instance.local_aabb;
+            record.id = data.instance_ids[i];
+            record.num_matrices = instance.matrices ? instance.num_matrices : 0;
+            record.num_skin_ids = instance.skin_ids ? instance.num_skin_ids : 0;
+            record.num_flags = instance.flags ? instance.num_flags : 0;
+            record.matrices = place(instance.matrices, uint64_t(record.num_matrices) * sizeof(simd_float4x4));
+            record.skin_ids = place(instance.skin_ids, uint64_t(record.num_skin_ids) * sizeof(int));
+            record.flags = place(instance.flags, uint64_t(record.num_flags) * sizeof(unsigned int));
+        }
+
+        header.materials = place(data.materials, uint64_t(data.num_materials) * sizeof(DeviceMaterial));
+
+        std::vector<Texture> textures(data.num_textures);
+        for (unsigned int i = 0; i < data.num_textures; i++)
+        {
+            const TextureData &texture = data.textures[i];
+            Texture &record = textures[i];
+            record.width = texture.width;
+            record.height = texture.height;
+            record.mip_levels = texture.mip_levels;
+            record.format = texture.format;
+            record.size = texture.bytes && texture.mip_levels > 0 ? mip_levels_size(texture, 0) : 0;
+            record.bytes = place(texture.bytes, record.size);
+        }
+        header.file_size = end;
+
+        std::ofstream file(path, std::ios::binary | std::ios::out | std::ios::trunc);
+        if (!file.is_open())
+            return false;
+
+        const auto write_bytes = [&](const void *bytes, uint64_t size) {
+            file.write(reinterpret_cast<const char *>(bytes), static_cast<std::streamsize>(size));
+        };
+        write_bytes(&header, sizeof(header));
+        write_bytes(meshes.data(), meshes.size() * sizeof(Mesh));
+        write_bytes(instances.data(), instances.size() * sizeof(Instances));
+        write_bytes(textures.data(), textures.size() * sizeof(Texture));
+
+        const char padding[BLOB_ALIGNMENT] = {};
+        uint64_t written = sizeof(Header) + meshes.size() * sizeof(Mesh) + instances.size() * sizeof(Instances) +
+                           textures.size() * sizeof(Texture);
+        for (const auto &[bytes, size] : blobs)
+        {
+            const uint64_t aligned = (written + BLOB_ALIGNMENT - 1) / BLOB_ALIGNMENT * BLOB_ALIGNMENT;
+            write_bytes(padding, aligned - written);
+            write_bytes(bytes, size);
+            written = aligned + size;
+        }
+        return file.good();
+    }
+
+    // Maps the cache at path, false when it can't be read, was written by another version or layout or has arrays
+    // outside of the file.
+    bool open(id<MTLDevice> device, const char *path)
+    {
+        const int fd = ::open(path, O_RDONLY);
+        if (fd < 0)
+            return false;
+
+        struct stat info = {};
+        if (fstat(fd, &info) != 0 || static_cast<size_t>(info.st_size) < sizeof(Header))
+        {
+            close(fd);
+            return false;
+        }
+
+        // Whole pages are mapped, the buffer wrapping the mapping must be a multiple of the page size.
+        const size_t page = static_cast<size_t>(getpagesize());
+        _mapped_size = (static_cast<size_t>(info.st_size) + page - 1) / page * page;
+        void *mapping = mmap(nullptr, _mapped_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        close(fd);
+        if (mapping == MAP_FAILED)
+            return false;
+        _mapping = mapping;
+
+        const Header &header = *reinterpret_cast<const Header *>(_mapping);
+        const uint64_t records = sizeof(Header) + uint64_t(header.num_meshes) * sizeof(Mesh) +
+                                 uint64_t(header.num_instances) * sizeof(Instances) +
+                                 uint64_t(header.num_textures) * sizeof(Texture);
+        if (memcmp(header.magic, MAGIC, sizeof(header.magic)) != 0 || header.version != VERSION ||
+            header.layout != layout() || header.file_size > static_cast<uint64_t>(info.st_size) ||
+            records > header.file_size)
+            return false;
+
+        const std::byte *base = reinterpret_cast<const std::byte *>(_mapping);
+        const auto *meshes = reinterpret_cast<const Mesh *>(base + sizeof(Header));
+        const auto *instances = reinterpret_cast<const Instances *>(meshes + header.num_meshes);
+        const auto *textures = reinterpret_cast<const Texture *>(instances + header.num_instances);
+        const auto at = [base](uint64_t offset) -> const void * { return offset != 0 ? base + offset : nullptr; };
+        // Arrays that are stored must lie after the records within the file, at the alignment they were written with.
+        // Arrays that are not stored have no elements.
+        const auto fits = [&header, records](uint64_t offset, uint64_t count, uint64_t size) {
+            if (offset == 0)
+                return count == 0;
+            return offset >= records && offset % BLOB_ALIGNMENT == 0 && offset <= header.file_size &&
+                   count <= (header.file_size - offset) / size;
+        };
+
+        for (uint32_t i = 0; i < header.num_meshes; i++)
+        {
+            const Mesh &record = meshes[i];
+            if (!fits(record.vertices, record.num_vertices, sizeof(Vertex3D)) ||
+                (record.skin_data != 0 && !fits(record.skin_data, record.num_vertices, sizeof(JointData))) ||
+                !fits(record.indices, record.num_indices, sizeof(unsigned int)) ||
+                !fits(record.ranges, record.num_ranges, sizeof(VertexRange)) ||
+                (record.field != 0 && !field_fits(record.field_volume, record.field, fits)))
+                return false;
+
+            MeshData3D data = {};
+            data.vertices = static_cast<const Vertex3D *>(at(record.vertices));
+            data.num_vertices = record.num_vertices;
+            data.ranges = static_cast<const VertexRange *>(at(record.ranges));
+            data.num_ranges = record.num_ranges;
+            data.skin_data = static_cast<const JointData *>(at(record.skin_data));
+            data.flags = record.flags;
+            data.bounds = record.bounds;
+            data.indices = static_cast<const unsigned int *>(at(record.indices));
+            data.num_indices = record.num_indices;
+            _mesh_ids.push_back(record.id);
+            _meshes.push_back(data);
+            _fields.push_back({record.field_volume, static_cast<const uint16_t *>(at(record.field))});
+        }
+
+        for (uint32_t i = 0; i < header.num_instances; i++)
+        {
+            const Instances &record = instances[i];
+            if (!fits(record.matrices, record.num_matrices, sizeof(simd_float4x4)) ||
+                !fits(record.skin_ids, record.num_skin_ids, sizeof(int)) ||
+                !fits(record.flags, record.num_flags, sizeof(unsigned int)))
+                return false;
+
+            InstancesData3D data = {};
+            data.local_aabb = record.local_aabb;
+            data.matrices = static_cast<const simd_float4x4 *>(at(record.matrices));
+            data.num_matrices = record.num_matrices;
+            data.skin_ids = static_cast<const int *>(at(record.skin_ids));
+            data.num_skin_ids = record.num_skin_ids;
+            data.flags = static_cast<const unsigned int *>(at(record.flags));
+            data.num_flags = record.num_flags;
+            _instance_ids.push_back(record.id);
+            _instances.push_back(data);
+        }
+
+        if (header.materials != 0 && !fits(header.materials, header.num_materials, sizeof(DeviceMaterial)))
+            return false;
+        _materials = static_cast<const DeviceMaterial *>(at(header.materials));
+        _num_materials = _materials ? header.num_materials : 0;
+
+        for (uint32_t i = 0; i < header.num_textures; i++)
+        {
+            const Texture &record = textures[i];
+            TextureData data = {};
+            data.width = record.width;
+            data.height = record.height;
+            data.mip_levels = record.mip_levels;
+            data.bytes = static_cast<const unsigned char *>(at(record.bytes));
+            data.num_bytes = data.bytes ? record.size : 0;
+            data.format = static_cast<DataFormat>(record.format);
+            // The levels of a stored texture must fill its bytes exactly, textures without bytes are only a size.
+            if (data.bytes && (data.width == 0 || data.height == 0 || data.width > MAX_TEXTURE_SIZE ||
+                               data.height > MAX_TEXTURE_SIZE || data.mip_levels == 0 ||
+                               data.mip_levels > full_mip_levels(data.width, data.height) ||
+                               record.size != mip_levels_size(data, 0) || !fits(record.bytes, record.size, 1)))
+                return false;
+            _textures.push_back(data);
+        }
+
+        // The GPU reads texture levels through a buffer that wraps the mapping, which is never written.
+        _buffer = [device newBufferWithBytesNoCopy:_mapping
+                                            length:_mapped_size
+                                           options:MTLResourceStorageModeShared
+                                       deallocator:nil];
+        if (_buffer == nil)
+            return false;
+        _buffer.label = @"SceneCache";
+        return true;
+    }
+
+    // Finds the buffer and offset that bytes within the mapping are at, false for bytes outside of it.
+    bool locate(const void *bytes, id<MTLBuffer> *buffer, size_t *offset) const
+    {
+        const auto *begin = reinterpret_cast<const std::byte *>(_mapping);
+        const auto *p = reinterpret_cast<const std::byte *>(bytes);
+        if (_buffer == nil || !p || p < begin || p >= begin + _mapped_size)
+            return false;
+        *buffer = _buffer;
+        *offset = static_cast<size_t>(p - begin);
+        return true;
+    }
+
+    const std::vector<unsigned int> &mesh_ids() const
+    {
+        return _mesh_ids;
+    }
+
+    const std::vector<MeshData3D> &meshes() const
+    {
+        return _meshes;
+    }
+
+    const std::vector<Field> &fields() const
+    {
+        return _fields;
+    }
+
+    const std::vector<unsigned int> &instance_ids() const
+    {
+        return _instance_ids;
+    }
+
+    const std::vector<InstancesData3D> &instances() const
+    {
+        return _instances;
+    }
+
+    const DeviceMaterial *materials() const
+    {
+        return _materials;
+    }
+
+    unsigned int num_materials() const
+    {
+        return _num_materials;
+    }
+
+    const std::vector<TextureData> &textures() const
+    {
+        return _textures;
+    }
+
+    size_t size() const
+    {
+        return _mapped_size;
+    }
+
+  private:
+    static constexpr char MAGIC[8] = {'R', 'F', 'W', 'S', 'C', 'E', 'N', 'E'};
+    // Largest side of a 2D texture in Metal, which also keeps the sizes of stored levels from overflowing.
+    static constexpr uint32_t MAX_TEXTURE_SIZE = 16384;
+
+    // Offsets are from the start of the file, 0 for arrays that are not stored.
+    struct Header
+    {
+        char magic[8];
+        uint32_t version;
+        uint32_t layout;
+        uint32_t num_meshes;
+        uint32_t num_instances;
+        uint32_t num_materials;
+        uint32_t num_textures;
+        uint64_t materials;
+        uint64_t file_size;
+    };
+
+    struct Mesh
+    {
+        Aabb bounds;
+        SdfVolume field_volume;
+        uint64_t vertices;
+        uint64_t skin_data;
+        uint64_t indices;
+        uint64_t ranges;
+        uint64_t field;
+        uint32_t id;
+        uint32_t flags;
+        uint32_t num_vertices;
+        uint32_t num_indices;
+        uint32_t num_ranges;
+        uint32_t pad;
+    };
+
+    // Reordered copy of a mesh that is written.
+    struct OrderedMesh
+    {
+        std::vector<Vertex3D> vertices;
+        std::vector<JointData> skin_data;
+        std::vector<unsigned int> indices;
+    };
+
+    struct Instances
+    {
+        Aabb local_aabb;
+        uint64_t matrices;
+        uint64_t skin_ids;
+        uint64_t flags;
+        uint32_t id;
+        uint32_t num_matrices;
+        uint32_t num_skin_ids;
+        uint32_t num_flags;
+    };
+
+    struct Texture
+    {
+        uint64_t bytes;
+        uint64_t size;
+        uint32_t width;
+        uint32_t height;
+        uint32_t mip_levels;
+        uint32_t format;
+    };
+
+    // Whether the field at offset has the voxels of a volume that fit_sdf_volume fits and lies within the file.
+    template <typename Fits> static bool field_fits(const SdfVolume &volume, uint64_t offset, const Fits &fits)
+    {
+        const simd_uint4 size = volume.size;
+        if (size.x == 0 || size.y == 0 || size.z == 0 || size.x > SDF_MESH_RESOLUTION ||
+            size.y > SDF_MESH_RESOLUTION || size.z > SDF_MESH_RESOLUTION)
+            return false;
+        return fits(offset, uint64_t(size.x) * size.y * size.z, sizeof(uint16_t));
+    }
+
+    // Hash of the sizes of the stored structs, caches of another layout can't be read in place.
+    static uint32_t layout()
+    {
+        const size_t sizes[] = {sizeof(Header),    sizeof(Mesh),        sizeof(Instances),
+                                sizeof(Texture),   sizeof(Vertex3D),    sizeof(JointData),
+                                sizeof(VertexRange), sizeof(Aabb),      sizeof(DeviceMaterial),
+                                sizeof(simd_float4x4), sizeof(SdfVolume)};
+        uint32_t hash = 2166136261u;
+        for (const size_t size : sizes)
+            hash = (hash ^ static_cast<uint32_t>(size)) * 16777619u;
+        return hash;
+    }
+
+    void *_mapping = nullptr;
+    size_t _mapped_size = 0;
+    id<MTLBuffer> _buffer = nil;
+    std::vector<unsigned int> _mesh_ids;
+    std::vector<MeshData3D> _meshes;
+    std::vector<Field> _fields;
+    std::vector<unsigned int> _instance_ids;
+    std::vector<InstancesData3D> _instances;
+    const DeviceMaterial *_materials = nullptr;
+    unsigned int _num_materials = 0;
+    std::vector<TextureData> _textures;
+};
+
+#endif // METALCPP_SRC_SCENE_CACHE_HPP
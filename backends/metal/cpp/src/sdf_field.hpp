@@ -0,0 +1,149 @@
+#ifndef METALCPP_SRC_SDF_FIELD_HPP
+#define METALCPP_SRC_SDF_FIELD_HPP
+
+#include "library.h"
+#include "structs.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/packing.hpp>
+
+// Fits the voxels of a field around the bounds of its mesh, false for meshes without extent. The field starts at
+// the element in size.w of the field buffer, which is left for the caller.
+inline bool fit_sdf_volume(const Aabb &bounds, SdfVolume &volume)
+{
+    const glm::vec3 bmin(bounds.bmin.x, bounds.bmin.y, bounds.bmin.z);
+    const glm::vec3 extent = glm::vec3(bounds.bmax.x, bounds.bmax.y, bounds.bmax.z) - bmin;
+    const float longest = std::max(std::max(extent.x, extent.y), extent.z);
+    if (!(longest > 0.0f) || !std::isfinite(longest))
+        return false;
+
+    const unsigned int inner = SDF_MESH_RESOLUTION - 2 * SDF_MESH_PADDING;
+    const float size = longest / static_cast<float>(inner);
+    const glm::uvec3 cells =
+        glm::min(glm::uvec3(glm::ceil(extent / size)), glm::uvec3(inner)) + glm::uvec3(2 * SDF_MESH_PADDING);
+    const glm::vec3 origin = bmin - glm::vec3(size * SDF_MESH_PADDING);
+    volume.origin = simd_make_float4(origin.x, origin.y, origin.z, size);
+    volume.size = simd_make_uint4(cells.x, cells.y, cells.z, 0);
+    return true;
+}
+
+inline unsigned int sdf_volume_voxels(const SdfVolume &volume)
+{
+    return volume.size.x * volume.size.y * volume.size.z;
+}
+
+// Corners of the triangles in the layout generate_triangle_sdf reads, three packed float3 per triangle.
+inline void sdf_triangle_positions(const RTTriangle *triangles, unsigned int count, std::vector<float> &positions)
+{
+    positions.resize(size_t(count) * 9);
+    for (unsigned int i = 0; i < count; i++)
+    {
+        const RTTriangle &t = triangles[i];
+        const Vector3 corners[3] = {t.vertex0, t.vertex1, t.vertex2};
+        for (unsigned int c = 0; c < 3; c++)
+        {
+            positions[i * 9 + c * 3 + 0] = corners[c].x;
+            positions[i * 9 + c * 3 + 1] = corners[c].y;
+            positions[i * 9 + c * 3 + 2] = corners[c].z;
+        }
+    }
+}
+
+// Distance from p to the triangle abc, the closest feature is found like triangle_distance of the shaders.
+inline float sdf_triangle_distance(const glm::vec3 &p, const glm::vec3 &a, const glm::vec3 &b, const glm::vec3 &c)
+{
+    const glm::vec3 ab = b - a;
+    const glm::vec3 ac = c - a;
+    const glm::vec3 ap = p - a;
+    const float d1 = glm::dot(ab, ap);
+    const float d2 = glm::dot(ac, ap);
+    if (d1 <= 0.0f && d2 <= 0.0f)
+        return glm::distance(p, a);
+
+    const glm::vec3 bp = p - b;
+    const float d3 = glm::dot(ab, bp);
+    const float d4 = glm::dot(ac, bp);
+    if (d3 >= 0.0f && d4 <= d3)
+        return glm::distance(p, b);
+    const float vc = d1 * d4 - d3 * d2;
+    if (vc <= 0.0f && d1 >= 0.0f && d3 <= 0.0f)
+        return glm::distance(p, a + ab * (d1 / (d1 - d3)));
+
+    const glm::vec3 cp = p - c;
+    const float d5 = glm::dot(ab, cp);
+    const float d6 = glm::dot(ac, cp);
+    if (d6 >= 0.0f && d5 <= d6)
+        return glm::distance(p, c);
+    const float vb = d5 * d2 - d1 * d6;
+    if (vb <= 0.0f && d2 >= 0.0f && d6 <= 0.0f)
+        return glm::distance(p, a + ac * (d2 / (d2 - d6)));
+    const float va = d3 * d6 - d5 * d4;
+    if (va <= 0.0f && d4 - d3 >= 0.0f && d5 - d6 >= 0.0f)
+        return glm::distance(p, b + (c - b) * ((d4 - d3) / ((d4 - d3) + (d5 - d6))));
+
+    const float scale = 1.0f / std::max(va + vb + vc, std::numeric_limits<float>::min());
+    return glm::distance(p, a + ab * (vb * scale) + ac * (vc * scale));
+}
+
+// Whether the ray from p along the axis crosses the triangle at a, spanned by e1 and e2.
+inline bool sdf_crosses_triangle(const glm::vec3 &p, int axis, const glm::vec3 &a, const glm::vec3 &e1,
+                                 const glm::vec3 &e2)
+{
+    glm::vec3 direction(0.0f);
+    direction[axis] = 1.0f;
+    const glm::vec3 h = glm::cross(direction, e2);
+    const float det = glm::dot(e1, h);
+    if (det == 0.0f)
+        return false;
+    const float f = 1.0f / det;
+    const glm::vec3 s = p - a;
+    const float u = f * glm::dot(s, h);
+    if (u < 0.0f || u > 1.0f)
+        return false;
+    const glm::vec3 q = glm::cross(s, e1);
+    const float v = f * glm::dot(direction, q);
+    return v >= 0.0f && u + v <= 1.0f && f * glm::dot(e2, q) > 0.0f;
+}
+
+// Builds the half distances of every voxel of a field on the CPU, the way generate_triangle_sdf does on the GPU.
+// write_scene_cache stores the fields, so loading a cache skips generating them.
+inline void build_sdf_field(const RTTriangle *triangles, unsigned int count, const SdfVolume &volume,
+                            std::vector<uint16_t> &field)
+{
+    std::vector<float> positions;
+    sdf_triangle_positions(triangles, count, positions);
+    field.resize(sdf_volume_voxels(volume));
+    const glm::vec3 origin(volume.origin.x, volume.origin.y, volume.origin.z);
+    const float half_max = 65504.0f;
+    for (unsigned int voxel = 0; voxel < field.size(); voxel++)
+    {
+        const glm::uvec3 cell(voxel % volume.size.x, voxel / volume.size.x % volume.size.y,
+                              voxel / (volume.size.x * volume.size.y));
+        const glm::vec3 p = origin + (glm::vec3(cell) + 0.5f) * volume.origin.w;
+
+        float closest = std::numeric_limits<float>::infinity();
+        glm::uvec3 crossings(0);
+        for (unsigned int i = 0; i < count; i++)
+        {
+            const float *t = positions.data() + size_t(i) * 9;
+            const glm::vec3 a(t[0], t[1], t[2]);
+            const glm::vec3 b(t[3], t[4], t[5]);
+            const glm::vec3 c(t[6], t[7], t[8]);
+            closest = std::min(closest, sdf_triangle_distance(p, a, b, c));
+            for (int axis = 0; axis < 3; axis++)
+                crossings[axis] += sdf_crosses_triangle(p, axis, a, b - a, c - a) ? 1 : 0;
+        }
+
+        const glm::uvec3 odd = crossings & 1u;
+        const float signed_distance = odd.x + odd.y + odd.z >= 2 ? -closest : closest;
+        field[voxel] = glm::packHalf1x16(std::clamp(signed_distance, -half_max, half_max));
+    }
+}
+
+#endif // METALCPP_SRC_SDF_FIELD_HPP
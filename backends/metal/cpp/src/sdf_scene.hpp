@@ -0,0 +1,624 @@
+#ifndef METALCPP_SRC_SDF_SCENE_HPP
+#define METALCPP_SRC_SDF_SCENE_HPP
+
+#import <Metal/Metal.h>
+
+#include "id_table.hpp"
+#include "instance_list.h"
+#include "library.h"
+#include "pipeline_cache.hpp"
+#include "range_allocator.hpp"
+#include "retired_resources.hpp"
+#include "sdf_field.hpp"
+#include "upload_ring.hpp"
+#include "vertex_list.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+// Voxels times triangles the fields of the meshes generate per frame at most, larger meshes take several frames.
+constexpr size_t SDF_GENERATE_BUDGET = size_t(1) << 26;
+// Voxels the field buffer holds at first, it grows by half again whenever it runs out.
+constexpr unsigned int SDF_MIN_FIELD_VOXELS = 1u << 18;
+// Regions of a clipmap level updated per frame, more are merged into the box around them.
+constexpr size_t SDF_MAX_REGIONS = 16;
+
+// Signed distance fields of the full-format 3D meshes, merged into a clipmap around the camera that the soft shadows
+// and the occlusion of set_sdf_tracing are traced through. The field of a mesh covers its bounds with a padding of
+// SDF_MESH_PADDING voxels and is generated on the GPU when it was set or changed, within SDF_GENERATE_BUDGET per
+// frame. Meshes set with RTTriangles keep their corners and generate their field from those, others from their
+// vertices. A field stored in a scene cache is copied instead. Fields live in one buffer allocated with a
+// RangeAllocator, a buffer that grows is created anew and generates every field again.
+//
+// The levels of the clipmap are 3D textures addressed modulo their size, so a level that follows the camera only
+// updates the slabs of voxels it moved into. Instances are compared with their bounds of the previous frame whenever
+// they changed, the voxels around the old and new bounds of those that moved, came or went are updated too. Skinned
+// instances are left out, their vertices only exist on the GPU.
+class SdfScene
+{
+  public:
+    void create(id<MTLDevice> device, id<MTLLibrary> library, PipelineCache &pipelines)
+    {
+        _device = device;
+        pipelines.create([library newFunctionWithName:@"generate_mesh_sdf"], &_generate_state);
+        pipelines.create([library newFunctionWithName:@"generate_triangle_sdf"], &_triangles_state);
+        pipelines.create([library newFunctionWithName:@"copy_mesh_sdf"], &_copy_state);
+        pipelines.create([library newFunctionWithName:@"update_sdf_clipmap"], &_clipmap_state);
+    }
+
+    void release()
+    {
+        _generate_state = nil;
+        _triangles_state = nil;
+        _copy_state = nil;
+        _clipmap_state = nil;
+        _fields = nil;
+        _levels = {};
+        _meshes.clear();
+        _sources.clear();
+        _dropped.clear();
+        _placed.clear();
+        _allocator = RangeAllocator();
+        _windows_valid = false;
+        _instances_dirty = true;
+    }
+
+    // Drops the fields and the clipmap once nothing traces them anymore. The triangles and cached fields of the meshes
+    // are kept to generate the fields from once tracing is enabled again.
+    void clear(RetiredResources &retired)
+    {
+        retired.retire(_fields);
+        for (id<MTLBuffer> buffer : _dropped)
+            retired.retire(buffer);
+        _dropped.clear();
+        for (id<MTLTexture> level : _levels)
+            retired.retire(level);
+        _fields = nil;
+        _levels = {};
+        _meshes.clear();
+        _placed.clear();
+        _allocator = RangeAllocator();
+        _windows_valid = false;
+        _instances_dirty = true;
+    }
+
+    // Geometry that is no longer described by the triangles or the cached field the mesh was set with.
+    void mark_mesh_changed(unsigned int id)
+    {
+        if (Mesh *mesh = _meshes.find(id))
+            mesh->valid = false;
+        // Frames in flight may still generate from the triangles, they are retired with the next update. Nothing read
+        // them before the first one.
+        const Source *source = _sources.find(id);
+        if (source && source->triangles != nil && _fields != nil)
+            _dropped.push_back(source->triangles);
+        _sources.erase(id);
+    }
+
+    // Keeps the corners of the triangles of a mesh to generate its field from, the field of a mesh set without them
+    // is generated from its vertices.
+    void set_mesh(unsigned int id, const RTTriangle *triangles, unsigned int count)
+    {
+        mark_mesh_changed(id);
+        if (!triangles || count == 0)
+            return;
+
+        std::vector<float> positions;
+        sdf_triangle_positions(triangles, count, positions);
+        Source &source = _sources[id];
+        source.triangles = [_device newBufferWithBytes:positions.data()
+                                                length:positions.size() * sizeof(float)
+                                               options:MTLResourceStorageModeShared];
+        source.triangles.label = @"SdfTriangles";
+        source.num_triangles = count;
+    }
+
+    // Copies the field of a mesh out of buffer from offset on, where a scene cache stored it, instead of generating
+    // it. volume is where write_scene_cache placed its voxels.
+    void set_cached_field(unsigned int id, const SdfVolume &volume, id<MTLBuffer> buffer, size_t offset)
+    {
+        if (Mesh *mesh = _meshes.find(id))
+            mesh->valid = false;
+        Source &source = _sources[id];
+        source.field = buffer;
+        source.field_offset = offset;
+        source.field_volume = volume;
+    }
+
+    void mark_instances_changed()
+    {
+        _instances_dirty = true;
+    }
+
+    size_t allocated_size() const
+    {
+        size_t size = _fields != nil ? _fields.allocatedSize : 0;
+        for (const auto &[i, source] : _sources)
+            size += source.triangles != nil ? source.triangles.allocatedSize : 0;
+        for (id<MTLTexture> level : _levels)
+            size += level != nil ? level.allocatedSize : 0;
+        return size;
+    }
+
+    // Generates the fields that are due and updates the clipmap around camera, returns false when there is nothing
+    // to trace. bounds holds the mesh space bounds of every mesh by id.
+    bool update(id<MTLComputeCommandEncoder> encoder, UploadRing &ring, RetiredResources &retired,
+                const VertexList<Vertex3D, JointData> &vertices, const IdTable<InstanceRange<glm::mat4>> &instances,
+                const std::vector<Aabb> &bounds, const std::vector<SkinningGroup> &skinning_groups,
+                const IdTable<std::vector<unsigned int>> &skinned_instances, const SdfSettings &settings,
+                const glm::vec3 &camera)
+    {
+        for (id<MTLBuffer> buffer : _dropped)
+            retired.retire(buffer);
+        _dropped.clear();
+        if (_generate_state == nil || _triangles_state == nil || _copy_state == nil || _clipmap_state == nil ||
+            vertices.vertex_buffer() == nil)
+            return false;
+
+        allocate_meshes(retired, vertices, instances, bounds);
+        generate_meshes(encoder, vertices);
+        if (_instances_dirty)
+            place_instances(instances, skinning_groups, skinned_instances);
+
+        if (_levels[0] == nil)
+        {
+            MTLTextureDescriptor *descriptor = [MTLTextureDescriptor new];
+            descriptor.textureType = MTLTextureType3D;
+            descriptor.pixelFormat = MTLPixelFormatR16Float;
+            descriptor.width = SDF_CLIPMAP_SIZE;
+            descriptor.height = SDF_CLIPMAP_SIZE;
+            descriptor.depth = SDF_CLIPMAP_SIZE;
+            descriptor.storageMode = MTLStorageModePrivate;
+            descriptor.usage = MTLTextureUsageShaderRead | MTLTextureUsageShaderWrite;
+            for (id<MTLTexture> &level : _levels)
+            {
+                level = [_device newTextureWithDescriptor:descriptor];
+                level.label = @"SdfClipmap";
+            }
+            _windows_valid = false;
+        }
+        if (settings.voxel_size != _voxel_size)
+        {
+            _voxel_size = settings.voxel_size;
+            _windows_valid = false;
+        }
+
+        const SdfInstance no_instance = {};
+        const SdfVolume no_volume = {};
+        const UploadAllocation instances_data = _instances.empty() ? ring.upload(&no_instance, 1)
+                                                                   : ring.upload(_instances.data(), _instances.size());
+        const UploadAllocation volumes_data =
+            _volumes.empty() ? ring.upload(&no_volume, 1) : ring.upload(_volumes.data(), _volumes.size());
+        if (!instances_data.valid() || !volumes_data.valid())
+            return false;
+
+        [encoder setComputePipelineState:_clipmap_state];
+        [encoder setBuffer:instances_data.buffer offset:instances_data.offset atIndex:0];
+        [encoder setBuffer:volumes_data.buffer offset:volumes_data.offset atIndex:3];
+        [encoder setBuffer:_fields offset:0 atIndex:4];
+        for (unsigned int l = 0; l < SDF_CLIPMAP_LEVELS; l++)
+        {
+            const float voxel_size = _voxel_size * static_cast<float>(1u << l);
+            const glm::ivec3 window =
+                glm::ivec3(glm::floor(camera / voxel_size)) - glm::ivec3(static_cast<int>(SDF_CLIPMAP_SIZE / 2));
+            std::vector<Region> regions = level_regions(l, window, voxel_size);
+            _uniforms.windows[l] = simd_make_int4(window.x, window.y, window.z, 0);
+            _windows[l] = window;
+
+            [encoder setTexture:_levels[l] atIndex:0];
+            for (const Region &region : regions)
+                encode_region(encoder, ring, region, voxel_size, instances_data);
+        }
+        _windows_valid = true;
+        _dirty.clear();
+
+        _uniforms.voxel_size = _voxel_size;
+        _uniforms.softness = settings.softness;
+        _uniforms.ao_distance = settings.ao_distance;
+        return true;
+    }
+
+    // Binds the uniforms of the clipmap at index and its levels from the texture first_texture on.
+    void bind(id<MTLComputeCommandEncoder> encoder, unsigned int index, unsigned int first_texture) const
+    {
+        [encoder setBytes:&_uniforms length:sizeof(_uniforms) atIndex:index];
+        for (unsigned int l = 0; l < SDF_CLIPMAP_LEVELS; l++)
+            [encoder setTexture:_levels[l] atIndex:first_texture + l];
+    }
+
+  private:
+    struct Box
+    {
+        glm::vec3 bmin = glm::vec3(std::numeric_limits<float>::max());
+        glm::vec3 bmax = glm::vec3(-std::numeric_limits<float>::max());
+
+        void grow(const glm::vec3 &p)
+        {
+            bmin = glm::min(bmin, p);
+            bmax = glm::max(bmax, p);
+        }
+
+        bool empty() const
+        {
+            return bmin.x > bmax.x;
+        }
+
+        bool operator==(const Box &other) const
+        {
+            return bmin == other.bmin && bmax == other.bmax;
+        }
+    };
+
+    // Voxels from first up to but not including end.
+    struct Region
+    {
+        glm::ivec3 first;
+        glm::ivec3 end;
+    };
+
+    struct Mesh
+    {
+        // The field starts at the element in size.w of the field buffer.
+        SdfVolume volume = {};
+        unsigned int num_triangles = 0;
+        // Voxels generated so far, the field is traced once all of them are.
+        unsigned int generated = 0;
+        bool valid = true;
+
+        unsigned int num_voxels() const
+        {
+            return volume.size.x * volume.size.y * volume.size.z;
+        }
+
+        bool ready() const
+        {
+            return generated == num_voxels();
+        }
+    };
+
+    // Triangles or cached field of a mesh, the field of a mesh without either is generated from its vertices.
+    struct Source
+    {
+        id<MTLBuffer> triangles = nil;
+        unsigned int num_triangles = 0;
+        id<MTLBuffer> field = nil;
+        size_t field_offset = 0;
+        SdfVolume field_volume = {};
+    };
+
+    static bool traced(const DrawDescriptor &range)
+    {
+        return range.end - range.start >= 3;
+    }
+
+    // Drops the fields of meshes that are gone and allocates those of new and changed meshes. A full buffer is
+    // created anew with room for all of them.
+    void allocate_meshes(RetiredResources &retired, const VertexList<Vertex3D, JointData> &vertices,
+                         const IdTable<InstanceRange<glm::mat4>> &instances, const std::vector<Aabb> &bounds)
+    {
+        const IdTable<DrawDescriptor> &ranges = vertices.get_draw_ranges();
+        std::vector<unsigned int> removed;
+        for (const auto &[i, mesh] : _meshes)
+        {
+            const DrawDescriptor *range = ranges.find(i);
+            if (!range || !traced(*range) || !instances.has(i) || !mesh.valid)
+                removed.push_back(i);
+        }
+        for (const unsigned int i : removed)
+        {
+            _allocator.free(_meshes[i].volume.size.w);
+            _meshes.erase(i);
+            _instances_dirty = true;
+        }
+
+        std::vector<unsigned int> unallocated;
+        for (const auto &[i, range] : ranges)
+        {
+            if (!traced(range) || !instances.has(i) || _meshes.has(i) || i >= bounds.size())
+                continue;
+
+            // Copying a cached field costs about as much per voxel as testing one triangle.
+            Mesh mesh;
+            const Source *source = _sources.find(i);
+            if (source && source->field != nil)
+            {
+                mesh.volume = source->field_volume;
+                mesh.num_triangles = 1;
+            }
+            else if (fit_sdf_volume(bounds[i], mesh.volume))
+            {
+                mesh.num_triangles = source ? source->num_triangles
+                                            : (range.index_count > 0 ? range.index_count : range.end - range.start) / 3;
+            }
+            else
+            {
+                continue;
+            }
+            mesh.volume.size.w = _allocator.allocate(mesh.num_voxels());
+            if (mesh.volume.size.w == RangeAllocator::INVALID)
+                unallocated.push_back(i);
+            _meshes[i] = mesh;
+        }
+
+        if (_fields != nil && unallocated.empty())
+            return;
+
+        // The new buffer holds no fields yet, every mesh is generated again.
+        unsigned int needed = _allocator.used();
+        for (const unsigned int i : unallocated)
+            needed += _meshes[i].num_voxels();
+        _allocator.grow(
+            std::max({SDF_MIN_FIELD_VOXELS, needed + needed / 2, _allocator.capacity() + _allocator.capacity() / 2}));
+        for (const unsigned int i : unallocated)
+            _meshes[i].volume.size.w = _allocator.allocate(_meshes[i].num_voxels());
+        for (auto &[i, mesh] : _meshes)
+            mesh.generated = 0;
+        _instances_dirty = true;
+
+        retired.retire(_fields);
+        _fields = [_device newBufferWithLength:size_t(_allocator.capacity()) * sizeof(uint16_t)
+                                       options:MTLResourceStorageModePrivate];
+        _fields.label = @"SdfFields";
+    }
+
+    // Generates the voxels that are due within SDF_GENERATE_BUDGET, meshes whose fields are complete are placed.
+    void generate_meshes(id<MTLComputeCommandEncoder> encoder, const VertexList<Vertex3D, JointData> &vertices)
+    {
+        const IdTable<DrawDescriptor> &ranges = vertices.get_draw_ranges();
+        id<MTLBuffer> index_buffer = vertices.index_buffer();
+        size_t budget = SDF_GENERATE_BUDGET;
+        id<MTLComputePipelineState> bound = nil;
+        for (auto &[i, mesh] : _meshes)
+        {
+            if (mesh.ready() || budget == 0)
+                continue;
+            const DrawDescriptor &range = *ranges.find(i);
+            const Source *source = _sources.find(i);
+
+            const unsigned int remaining = mesh.num_voxels() - mesh.generated;
+            const size_t affordable = std::max<size_t>(budget / std::max(mesh.num_triangles, 1u), 64);
+            const auto count = static_cast<unsigned int>(std::min<size_t>(remaining, affordable));
+            budget -= std::min(budget, size_t(count) * mesh.num_triangles);
+
+            SdfMeshUniforms uniforms = {};
+            uniforms.volume = mesh.volume;
+            uniforms.num_triangles = mesh.num_triangles;
+            uniforms.first_voxel = mesh.generated;
+            uniforms.num_voxels = count;
+            id<MTLComputePipelineState> state = _generate_state;
+            if (source && source->field != nil)
+            {
+                state = _copy_state;
+                [encoder setBuffer:source->field offset:source->field_offset atIndex:0];
+            }
+            else if (source)
+            {
+                state = _triangles_state;
+                [encoder setBuffer:source->triangles offset:0 atIndex:0];
+            }
+            else
+            {
+                uniforms.vertex_start = range.start;
+                uniforms.index_offset = range.index_offset;
+                uniforms.index_size = range.index_count == 0 ? 0 : range.short_indices ? 2 : 4;
+            }
+
+            if (state != bound)
+            {
+                [encoder setComputePipelineState:state];
+                [encoder setBuffer:_fields offset:0 atIndex:3];
+                if (state == _generate_state)
+                {
+                    [encoder setBuffer:vertices.vertex_buffer() offset:0 atIndex:0];
+                    [encoder setBuffer:index_buffer != nil ? index_buffer : vertices.vertex_buffer()
+                                offset:0
+                               atIndex:1];
+                }
+                bound = state;
+            }
+            [encoder setBytes:&uniforms length:sizeof(uniforms) atIndex:2];
+            const NSUInteger group_size = std::min<NSUInteger>(state.maxTotalThreadsPerThreadgroup, 256);
+            [encoder dispatchThreadgroups:MTLSizeMake((count + group_size - 1) / group_size, 1, 1)
+                    threadsPerThreadgroup:MTLSizeMake(group_size, 1, 1)];
+
+            mesh.generated += count;
+            if (mesh.ready())
+                _instances_dirty = true;
+        }
+    }
+
+    // Lists the instances of every complete field and marks the bounds of those that changed since last time.
+    void place_instances(const IdTable<InstanceRange<glm::mat4>> &instances,
+                         const std::vector<SkinningGroup> &skinning_groups,
+                         const IdTable<std::vector<unsigned int>> &skinned_instances)
+    {
+        _instances_dirty = false;
+        _instances.clear();
+        _volumes.clear();
+
+        IdTable<std::vector<Box>> placed;
+        for (const auto &[i, mesh] : _meshes)
+        {
+            const InstanceRange<glm::mat4> *insts = instances.find(i);
+            if (!insts || !mesh.ready())
+                continue;
+
+            const auto volume = static_cast<unsigned int>(_volumes.size());
+            _volumes.push_back(mesh.volume);
+            const glm::vec3 vmin(mesh.volume.origin.x, mesh.volume.origin.y, mesh.volume.origin.z);
+            const glm::vec3 vmax =
+                vmin + glm::vec3(mesh.volume.size.x, mesh.volume.size.y, mesh.volume.size.z) * mesh.volume.origin.w;
+
+            const std::vector<unsigned int> *groups = skinned_instances.find(i);
+            std::vector<Box> &boxes = placed[i];
+            boxes.resize(insts->count);
+            for (unsigned int j = 0; j < insts->count; j++)
+            {
+                if (groups && j < groups->size() && (*groups)[j] < skinning_groups.size())
+                    continue;
+
+                const glm::mat4 &m = insts->ptr[j];
+                const glm::mat4 inverse = glm::inverse(m);
+                SdfInstance instance = {};
+                for (int r = 0; r < 3; r++)
+                    instance.inverse[r] = simd_make_float4(inverse[0][r], inverse[1][r], inverse[2][r], inverse[3][r]);
+                instance.scale = std::min({glm::length(glm::vec3(m[0])), glm::length(glm::vec3(m[1])),
+                                           glm::length(glm::vec3(m[2]))});
+                instance.volume = volume;
+
+                Box &box = boxes[j];
+                for (unsigned int c = 0; c < 8; c++)
+                {
+                    const glm::vec3 corner = glm::vec3((c & 1) ? vmax.x : vmin.x, (c & 2) ? vmax.y : vmin.y,
+                                                       (c & 4) ? vmax.z : vmin.z);
+                    box.grow(glm::vec3(m * glm::vec4(corner, 1.0f)));
+                }
+                instance.bmin = simd_make_float4(box.bmin.x, box.bmin.y, box.bmin.z, 0.0f);
+                instance.bmax = simd_make_float4(box.bmax.x, box.bmax.y, box.bmax.z, 0.0f);
+                _instances.push_back(instance);
+            }
+        }
+
+        for (const auto &[i, boxes] : placed)
+        {
+            const std::vector<Box> *old = _placed.find(i);
+            const size_t num_old = old ? old->size() : 0;
+            for (size_t j = 0; j < std::max(boxes.size(), num_old); j++)
+            {
+                const Box none;
+                const Box &box = j < boxes.size() ? boxes[j] : none;
+                const Box &old_box = j < num_old ? (*old)[j] : none;
+                if (box == old_box)
+                    continue;
+                mark_dirty(box);
+                mark_dirty(old_box);
+            }
+        }
+        for (const auto &[i, boxes] : _placed)
+        {
+            if (!placed.has(i))
+            {
+                for (const Box &box : boxes)
+                    mark_dirty(box);
+            }
+        }
+        _placed = std::move(placed);
+    }
+
+    void mark_dirty(const Box &box)
+    {
+        if (!box.empty())
+            _dirty.push_back(box);
+    }
+
+    // Regions of a level that moved to window or whose instances changed, clipped to the window.
+    std::vector<Region> level_regions(unsigned int level, const glm::ivec3 &window, float voxel_size) const
+    {
+        const glm::ivec3 end = window + glm::ivec3(static_cast<int>(SDF_CLIPMAP_SIZE));
+        const glm::ivec3 moved = window - _windows[level];
+        if (!_windows_valid || glm::any(glm::greaterThanEqual(glm::abs(moved), glm::ivec3(SDF_CLIPMAP_SIZE))))
+            return {Region{window, end}};
+
+        // Slabs the window moved into along each axis.
+        std::vector<Region> regions;
+        for (int axis = 0; axis < 3; axis++)
+        {
+            if (moved[axis] == 0)
+                continue;
+            Region slab = {window, end};
+            if (moved[axis] > 0)
+                slab.first[axis] = _windows[level][axis] + static_cast<int>(SDF_CLIPMAP_SIZE);
+            else
+                slab.end[axis] = _windows[level][axis];
+            regions.push_back(slab);
+        }
+
+        const float band = SDF_BAND_VOXELS * voxel_size;
+        for (const Box &box : _dirty)
+        {
+            Region region;
+            region.first = glm::max(glm::ivec3(glm::floor((box.bmin - band) / voxel_size)), window);
+            region.end = glm::min(glm::ivec3(glm::floor((box.bmax + band) / voxel_size)) + 1, end);
+            if (glm::all(glm::lessThan(region.first, region.end)))
+                regions.push_back(region);
+        }
+
+        if (regions.size() > SDF_MAX_REGIONS)
+        {
+            Region merged = regions[0];
+            for (const Region &region : regions)
+            {
+                merged.first = glm::min(merged.first, region.first);
+                merged.end = glm::max(merged.end, region.end);
+            }
+            return {merged};
+        }
+        return regions;
+    }
+
+    // Lists the instances within the band of a region and updates its voxels.
+    void encode_region(id<MTLComputeCommandEncoder> encoder, UploadRing &ring, const Region &region,
+                       float voxel_size, const UploadAllocation &instances_data)
+    {
+        const float band = SDF_BAND_VOXELS * voxel_size;
+        const glm::vec3 rmin = glm::vec3(region.first) * voxel_size - band;
+        const glm::vec3 rmax = glm::vec3(region.end) * voxel_size + band;
+        std::vector<unsigned int> listed;
+        for (unsigned int i = 0; i < _instances.size(); i++)
+        {
+            const SdfInstance &instance = _instances[i];
+            if (instance.bmin.x <= rmax.x && instance.bmin.y <= rmax.y && instance.bmin.z <= rmax.z &&
+                instance.bmax.x >= rmin.x && instance.bmax.y >= rmin.y && instance.bmax.z >= rmin.z)
+                listed.push_back(i);
+        }
+
+        const UploadAllocation list = listed.empty() ? instances_data : ring.upload(listed.data(), listed.size());
+        if (!list.valid())
+            return;
+
+        const glm::ivec3 size = region.end - region.first;
+        SdfRegionUniforms uniforms = {};
+        uniforms.first_cell = simd_make_int4(region.first.x, region.first.y, region.first.z, 0);
+        uniforms.size = simd_make_uint4(size.x, size.y, size.z, 0);
+        uniforms.num_instances = static_cast<unsigned int>(listed.size());
+        uniforms.voxel_size = voxel_size;
+        uniforms.band = band;
+        [encoder setBuffer:list.buffer offset:list.offset atIndex:1];
+        [encoder setBytes:&uniforms length:sizeof(uniforms) atIndex:2];
+        [encoder dispatchThreadgroups:MTLSizeMake((size.x + 3) / 4, (size.y + 3) / 4, (size.z + 3) / 4)
+                threadsPerThreadgroup:MTLSizeMake(4, 4, 4)];
+    }
+
+    id<MTLDevice> _device = nil;
+    id<MTLComputePipelineState> _generate_state = nil;
+    id<MTLComputePipelineState> _triangles_state = nil;
+    id<MTLComputePipelineState> _copy_state = nil;
+    id<MTLComputePipelineState> _clipmap_state = nil;
+
+    IdTable<Mesh> _meshes;
+    IdTable<Source> _sources;
+    // Triangles of meshes that changed, retired with the next update.
+    std::vector<id<MTLBuffer>> _dropped;
+    RangeAllocator _allocator;
+    id<MTLBuffer> _fields = nil;
+
+    // Instances of the complete fields and their world space bounds by mesh, as of the last placement.
+    std::vector<SdfInstance> _instances;
+    std::vector<SdfVolume> _volumes;
+    IdTable<std::vector<Box>> _placed;
+    std::vector<Box> _dirty;
+    bool _instances_dirty = true;
+
+    std::array<id<MTLTexture>, SDF_CLIPMAP_LEVELS> _levels = {};
+    std::array<glm::ivec3, SDF_CLIPMAP_LEVELS> _windows = {};
+    bool _windows_valid = false;
+    float _voxel_size = 0.0f;
+    SdfTraceUniforms _uniforms = {};
+};
+
+#endif // METALCPP_SRC_SDF_SCENE_HPP
@@ -1,2065 +0,0 @@
-unsigned char cpp_src_shaders_metallib[] = {
-  0x4d, 0x54, 0x4c, 0x42, 0x01, 0x80, 0x02, 0x00, 0x05, 0x00, 0x00, 0x00,
-  0x00, 0x00, 0x00, 0x00, 0x9e, 0x60, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-  0x58, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x1e, 0x02, 0x00, 0x00,
-  0x00, 0x00, 0x00, 0x00, 0x7e, 0x02, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-  0x20, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x9e, 0x02, 0x00, 0x00,
-  0x00, 0x00, 0x00, 0x00, 0x20, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-  0xbe, 0x02, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xe0, 0x5d, 0x00, 0x00,
-  0x00, 0x00, 0x00, 0x00, 0x04, 0x00, 0x00, 0x00, 0x88, 0x00, 0x00, 0x00,
-  0x4e, 0x41, 0x4d, 0x45, 0x13, 0x00, 0x74, 0x72, 0x69, 0x61, 0x6e, 0x67,
-  0x6c, 0x65, 0x5f, 0x76, 0x65, 0x72, 0x74, 0x65, 0x78, 0x5f, 0x32, 0x64,
-  0x00, 0x54, 0x59, 0x50, 0x45, 0x01, 0x00, 0x00, 0x48, 0x41, 0x53, 0x48,
-  0x20, 0x00, 0x50, 0x63, 0x36, 0x38, 0x76, 0xf3, 0x12, 0x0c, 0x17, 0x07,
-  0x97, 0xf7, 0xb8, 0x00, 0x16, 0x0f, 0x11, 0x97, 0xdf, 0xcb, 0xd5, 0xf0,
-  0xce, 0xd6, 0x16, 0x8b, 0x29, 0x3a, 0x00, 0xc6, 0x3d, 0x01, 0x4d, 0x44,
-  0x53, 0x5a, 0x08, 0x00, 0x80, 0x18, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-  0x4f, 0x46, 0x46, 0x54, 0x18, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x56, 0x45, 0x52, 0x53, 0x08, 0x00,
-  0x02, 0x00, 0x03, 0x00, 0x02, 0x00, 0x03, 0x00, 0x45, 0x4e, 0x44, 0x54,
-  0x85, 0x00, 0x00, 0x00, 0x4e, 0x41, 0x4d, 0x45, 0x10, 0x00, 0x74, 0x72,
-  0x69, 0x61, 0x6e, 0x67, 0x6c, 0x65, 0x5f, 0x76, 0x65, 0x72, 0x74, 0x65,
-  0x78, 0x00, 0x54, 0x59, 0x50, 0x45, 0x01, 0x00, 0x00, 0x48, 0x41, 0x53,
-  0x48, 0x20, 0x00, 0x2b, 0x30, 0xbf, 0xf7, 0xd7, 0x55, 0xd2, 0x39, 0x3c,
-  0x90, 0xd4, 0x95, 0xa0, 0x28, 0xb4, 0x67, 0x60, 0x16, 0xb1, 0xbd, 0x82,
-  0x1e, 0x88, 0x70, 0xe2, 0x5b, 0x8b, 0x9e, 0xca, 0x3b, 0xa7, 0x79, 0x4d,
-  0x44, 0x53, 0x5a, 0x08, 0x00, 0xe0, 0x1a, 0x00, 0x00, 0x00, 0x00, 0x00,
-  0x00, 0x4f, 0x46, 0x46, 0x54, 0x18, 0x00, 0x08, 0x00, 0x00, 0x00, 0x00,
-  0x00, 0x00, 0x00, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x80,
-  0x18, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x56, 0x45, 0x52, 0x53, 0x08,
-  0x00, 0x02, 0x00, 0x03, 0x00, 0x02, 0x00, 0x03, 0x00, 0x45, 0x4e, 0x44,
-  0x54, 0x8a, 0x00, 0x00, 0x00, 0x4e, 0x41, 0x4d, 0x45, 0x15, 0x00, 0x74,
-  0x72, 0x69, 0x61, 0x6e, 0x67, 0x6c, 0x65, 0x5f, 0x66, 0x72, 0x61, 0x67,
-  0x6d, 0x65, 0x6e, 0x74, 0x5f, 0x32, 0x64, 0x00, 0x54, 0x59, 0x50, 0x45,
-  0x01, 0x00, 0x01, 0x48, 0x41, 0x53, 0x48, 0x20, 0x00, 0xb2, 0xca, 0x86,
-  0xf2, 0x7b, 0xfe, 0xbc, 0x9e, 0xf1, 0xe3, 0x5b, 0xb9, 0xb4, 0x9d, 0x2d,
-  0x9d, 0xb0, 0x41, 0x9a, 0x67, 0x9c, 0xc4, 0xf4, 0x19, 0xea, 0x27, 0x46,
-  0x47, 0x9e, 0xb5, 0x2a, 0xb1, 0x4d, 0x44, 0x53, 0x5a, 0x08, 0x00, 0x50,
-  0x15, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x4f, 0x46, 0x46, 0x54, 0x18,
-  0x00, 0x10, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x10, 0x00, 0x00,
-  0x00, 0x00, 0x00, 0x00, 0x00, 0x60, 0x33, 0x00, 0x00, 0x00, 0x00, 0x00,
-  0x00, 0x56, 0x45, 0x52, 0x53, 0x08, 0x00, 0x02, 0x00, 0x03, 0x00, 0x02,
-  0x00, 0x03, 0x00, 0x45, 0x4e, 0x44, 0x54, 0x87, 0x00, 0x00, 0x00, 0x4e,
-  0x41, 0x4d, 0x45, 0x12, 0x00, 0x74, 0x72, 0x69, 0x61, 0x6e, 0x67, 0x6c,
-  0x65, 0x5f, 0x66, 0x72, 0x61, 0x67, 0x6d, 0x65, 0x6e, 0x74, 0x00, 0x54,
-  0x59, 0x50, 0x45, 0x01, 0x00, 0x01, 0x48, 0x41, 0x53, 0x48, 0x20, 0x00,
-  0x6b, 0x10, 0x10, 0x8c, 0x19, 0x36, 0xb0, 0x39, 0x5e, 0x47, 0xaa, 0x1a,
-  0x6f, 0x2e, 0xcd, 0xae, 0x90, 0x87, 0x3f, 0xb1, 0x94, 0xf7, 0xb8, 0x74,
-  0x1b, 0x3b, 0xe3, 0xd7, 0x5c, 0xca, 0x97, 0x5d, 0x4d, 0x44, 0x53, 0x5a,
-  0x08, 0x00, 0x30, 0x15, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x4f, 0x46,
-  0x46, 0x54, 0x18, 0x00, 0x18, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-  0x18, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xb0, 0x48, 0x00, 0x00,
-  0x00, 0x00, 0x00, 0x00, 0x56, 0x45, 0x52, 0x53, 0x08, 0x00, 0x02, 0x00,
-  0x03, 0x00, 0x02, 0x00, 0x03, 0x00, 0x45, 0x4e, 0x44, 0x54, 0x45, 0x4e,
-  0x44, 0x54, 0x04, 0x00, 0x00, 0x00, 0x45, 0x4e, 0x44, 0x54, 0x04, 0x00,
-  0x00, 0x00, 0x45, 0x4e, 0x44, 0x54, 0x04, 0x00, 0x00, 0x00, 0x45, 0x4e,
-  0x44, 0x54, 0x04, 0x00, 0x00, 0x00, 0x45, 0x4e, 0x44, 0x54, 0x04, 0x00,
-  0x00, 0x00, 0x45, 0x4e, 0x44, 0x54, 0x04, 0x00, 0x00, 0x00, 0x45, 0x4e,
-  0x44, 0x54, 0x04, 0x00, 0x00, 0x00, 0x45, 0x4e, 0x44, 0x54, 0x04, 0x00,
-  0x00, 0x00, 0x45, 0x4e, 0x44, 0x54, 0xde, 0xc0, 0x17, 0x0b, 0x00, 0x00,
-  0x00, 0x00, 0x14, 0x00, 0x00, 0x00, 0x6c, 0x18, 0x00, 0x00, 0xff, 0xff,
-  0xff, 0xff, 0x42, 0x43, 0xc0, 0xde, 0x35, 0x14, 0x00, 0x00, 0x03, 0x00,
-  0x00, 0x00, 0x62, 0x0c, 0x30, 0x24, 0x80, 0x10, 0x05, 0xc8, 0x14, 0x00,
-  0x00, 0x00, 0x21, 0x0c, 0x00, 0x00, 0xe2, 0x05, 0x00, 0x00, 0x0b, 0x02,
-  0x21, 0x00, 0x02, 0x00, 0x00, 0x00, 0x13, 0x00, 0x00, 0x00, 0x07, 0x81,
-  0x23, 0x91, 0x41, 0xc8, 0x04, 0x49, 0x06, 0x10, 0x32, 0x39, 0x92, 0x01,
-  0x84, 0x0c, 0x25, 0x05, 0x08, 0x19, 0x1e, 0x04, 0x8b, 0x62, 0x80, 0x18,
-  0x45, 0x02, 0x42, 0x92, 0x0b, 0x42, 0xc4, 0x10, 0x32, 0x14, 0x38, 0x08,
-  0x18, 0x4b, 0x0a, 0x32, 0x62, 0x88, 0x48, 0x90, 0x14, 0x20, 0x43, 0x46,
-  0x88, 0xa5, 0x00, 0x19, 0x32, 0x42, 0x04, 0x49, 0x0e, 0x90, 0x11, 0x23,
-  0xc4, 0x50, 0x41, 0x51, 0x81, 0x8c, 0xe1, 0x83, 0xe5, 0x8a, 0x04, 0x31,
-  0x46, 0x06, 0x89, 0x20, 0x00, 0x00, 0x66, 0x00, 0x00, 0x00, 0x32, 0x22,
-  0x88, 0x09, 0x20, 0x64, 0x85, 0x04, 0x13, 0x23, 0xa4, 0x84, 0x04, 0x13,
-  0x23, 0xe3, 0x84, 0xa1, 0x90, 0x14, 0x12, 0x4c, 0x8c, 0x8c, 0x0b, 0x84,
-  0xc4, 0x4c, 0x10, 0xa0, 0xc1, 0x0c, 0xc0, 0x30, 0x02, 0x01, 0x0c, 0x23,
-  0x08, 0xc0, 0x1c, 0x01, 0x18, 0xd8, 0x22, 0x08, 0x84, 0x61, 0xb8, 0x47,
-  0x9a, 0x22, 0x4a, 0x98, 0xfc, 0x97, 0x88, 0x26, 0xe2, 0xba, 0x3b, 0x04,
-  0x01, 0x00, 0x00, 0x00, 0x00, 0x30, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-  0x0c, 0x22, 0x14, 0xc1, 0x3d, 0xd2, 0x14, 0x51, 0xc2, 0xe4, 0xbf, 0x44,
-  0x34, 0x11, 0x97, 0xdd, 0x21, 0x05, 0x00, 0x80, 0x01, 0x00, 0x00, 0x00,
-  0x00, 0x06, 0x11, 0x8e, 0xe0, 0x28, 0x69, 0x8a, 0x28, 0x61, 0xf2, 0xff,
-  0x89, 0xb8, 0x26, 0x2a, 0x22, 0x7e, 0x7b, 0xf8, 0xa7, 0x31, 0x02, 0x60,
-  0x10, 0x21, 0x09, 0x66, 0xba, 0xe6, 0x81, 0x1e, 0xe4, 0xa1, 0x1e, 0xc6,
-  0x81, 0x1e, 0xdc, 0xa0, 0x1d, 0xca, 0x81, 0x1e, 0xc2, 0x81, 0x1d, 0xf4,
-  0x40, 0x0f, 0xe8, 0xa1, 0x1c, 0xf0, 0x81, 0x1e, 0xea, 0x41, 0x1e, 0xca,
-  0x41, 0x0e, 0xc8, 0x01, 0x05, 0xca, 0x39, 0xd2, 0x14, 0x51, 0xc2, 0xe4,
-  0xb7, 0xc4, 0x35, 0x51, 0x11, 0x81, 0x82, 0x65, 0x10, 0x81, 0x09, 0xae,
-  0x92, 0xa6, 0x88, 0x12, 0x26, 0xbf, 0x23, 0x2a, 0x44, 0x20, 0x4c, 0x60,
-  0x22, 0x22, 0x04, 0x58, 0x10, 0x06, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-  0x00, 0x00, 0x30, 0x0c, 0xc3, 0x30, 0x0c, 0xc3, 0x30, 0x0c, 0x00, 0x30,
-  0x88, 0xe0, 0x04, 0x49, 0x10, 0xcc, 0x44, 0xcd, 0x03, 0x3d, 0xc8, 0x43,
-  0x3d, 0x8c, 0x03, 0x3d, 0xb8, 0x41, 0x3b, 0x94, 0x03, 0x3d, 0x84, 0x03,
-  0x3b, 0xe8, 0x81, 0x1e, 0xb4, 0x43, 0x38, 0xd0, 0x83, 0x3c, 0xa4, 0x03,
-  0x3e, 0xa0, 0x00, 0x3a, 0x4c, 0x9a, 0x22, 0x4a, 0x98, 0x7c, 0xb1, 0x91,
-  0x26, 0xa0, 0x11, 0x88, 0x36, 0x02, 0x1a, 0xa9, 0x70, 0x22, 0x06, 0x09,
-  0x51, 0x34, 0x88, 0x20, 0x05, 0x83, 0x08, 0x51, 0x70, 0x8c, 0x34, 0x45,
-  0x94, 0x30, 0xf9, 0xac, 0x40, 0x34, 0x04, 0x32, 0x0c, 0xa4, 0x79, 0x26,
-  0x6a, 0x10, 0xa1, 0x0a, 0x2e, 0x92, 0xa6, 0x88, 0x12, 0x26, 0x9f, 0x03,
-  0x18, 0x22, 0x02, 0x5e, 0x84, 0xb0, 0xd0, 0x05, 0x00, 0x00, 0x00, 0x00,
-  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-  0xc0, 0x1c, 0x01, 0x92, 0x04, 0xd8, 0x51, 0xd2, 0x14, 0x51, 0xc2, 0xe4,
-  0xbb, 0x0d, 0x52, 0x38, 0x11, 0xc3, 0x01, 0x0c, 0x11, 0x01, 0xd8, 0x88,
-  0xa2, 0x28, 0xba, 0xb2, 0x41, 0x04, 0x2d, 0x28, 0x05, 0x61, 0x6d, 0xc3,
-  0x40, 0xdc, 0x40, 0x40, 0x0a, 0x0c, 0x73, 0x04, 0xa0, 0x30, 0x88, 0x80,
-  0x04, 0x83, 0x08, 0x54, 0x30, 0x88, 0x10, 0x04, 0xc3, 0x08, 0xc4, 0x30,
-  0x88, 0x00, 0x04, 0x83, 0x08, 0x43, 0x30, 0x02, 0x00, 0x00, 0x51, 0x18,
-  0x00, 0x00, 0x84, 0x00, 0x00, 0x00, 0x1b, 0xc8, 0x25, 0xf8, 0xff, 0xff,
-  0xff, 0xff, 0x01, 0x90, 0x80, 0x8a, 0x18, 0x87, 0x77, 0x90, 0x07, 0x79,
-  0x28, 0x87, 0x71, 0xa0, 0x07, 0x76, 0xc8, 0x87, 0x36, 0x90, 0x87, 0x77,
-  0xa8, 0x07, 0x77, 0x20, 0x87, 0x72, 0x20, 0x87, 0x36, 0x20, 0x87, 0x74,
-  0xb0, 0x87, 0x74, 0x20, 0x87, 0x72, 0x68, 0x83, 0x79, 0x88, 0x07, 0x79,
-  0xa0, 0x87, 0x36, 0x30, 0x07, 0x78, 0x68, 0x83, 0x76, 0x08, 0x07, 0x7a,
-  0x40, 0x07, 0xc0, 0x1c, 0xc2, 0x81, 0x1d, 0xe6, 0xa1, 0x1c, 0x00, 0x82,
-  0x1c, 0xd2, 0x61, 0x1e, 0xc2, 0x41, 0x1c, 0xd8, 0xa1, 0x1c, 0xda, 0x80,
-  0x1e, 0xc2, 0x21, 0x1d, 0xd8, 0xa1, 0x0d, 0xc6, 0x21, 0x1c, 0xd8, 0x81,
-  0x1d, 0xe6, 0x01, 0x30, 0x87, 0x70, 0x60, 0x87, 0x79, 0x28, 0x07, 0x80,
-  0x60, 0x87, 0x72, 0x98, 0x87, 0x79, 0x68, 0x03, 0x78, 0x90, 0x87, 0x72,
-  0x18, 0x87, 0x74, 0x98, 0x87, 0x72, 0x68, 0x03, 0x73, 0x80, 0x87, 0x76,
-  0x08, 0x07, 0x72, 0x00, 0xcc, 0x21, 0x1c, 0xd8, 0x61, 0x1e, 0xca, 0x01,
-  0x20, 0xdc, 0xe1, 0x1d, 0xda, 0xc0, 0x1c, 0xe4, 0x21, 0x1c, 0xda, 0xa1,
-  0x1c, 0xda, 0x00, 0x1e, 0xde, 0x21, 0x1d, 0xdc, 0x81, 0x1e, 0xca, 0x41,
-  0x1e, 0xda, 0xa0, 0x1c, 0xd8, 0x21, 0x1d, 0xda, 0x01, 0xa0, 0x07, 0x79,
-  0xa8, 0x87, 0x72, 0x00, 0x06, 0x77, 0x78, 0x87, 0x36, 0x30, 0x07, 0x79,
-  0x08, 0x87, 0x76, 0x28, 0x87, 0x36, 0x80, 0x87, 0x77, 0x48, 0x07, 0x77,
-  0xa0, 0x87, 0x72, 0x90, 0x87, 0x36, 0x28, 0x07, 0x76, 0x48, 0x87, 0x76,
-  0x68, 0x03, 0x77, 0x78, 0x07, 0x77, 0x68, 0x03, 0x76, 0x28, 0x87, 0x70,
-  0x30, 0x07, 0x80, 0x70, 0x87, 0x77, 0x68, 0x83, 0x74, 0x70, 0x07, 0x73,
-  0x98, 0x87, 0x36, 0x30, 0x07, 0x78, 0x68, 0x83, 0x76, 0x08, 0x07, 0x7a,
-  0x40, 0x07, 0x80, 0x1e, 0xe4, 0xa1, 0x1e, 0xca, 0x01, 0x20, 0xdc, 0xe1,
-  0x1d, 0xda, 0x40, 0x1d, 0xea, 0xa1, 0x1d, 0xe0, 0xa1, 0x0d, 0xe8, 0x21,
-  0x1c, 0xc4, 0x81, 0x1d, 0xca, 0x61, 0x1e, 0x00, 0x73, 0x08, 0x07, 0x76,
-  0x98, 0x87, 0x72, 0x00, 0x08, 0x77, 0x78, 0x87, 0x36, 0x70, 0x87, 0x70,
-  0x70, 0x87, 0x79, 0x68, 0x03, 0x73, 0x80, 0x87, 0x36, 0x68, 0x87, 0x70,
-  0xa0, 0x07, 0x74, 0x00, 0xe8, 0x41, 0x1e, 0xea, 0xa1, 0x1c, 0x00, 0xc2,
-  0x1d, 0xde, 0xa1, 0x0d, 0xe6, 0x21, 0x1d, 0xce, 0xc1, 0x1d, 0xca, 0x81,
-  0x1c, 0xda, 0x40, 0x1f, 0xca, 0x41, 0x1e, 0xde, 0x61, 0x1e, 0xda, 0xc0,
-  0x1c, 0xe0, 0xa1, 0x0d, 0xda, 0x21, 0x1c, 0xe8, 0x01, 0x1d, 0x00, 0x7a,
-  0x90, 0x87, 0x7a, 0x28, 0x07, 0x80, 0x70, 0x87, 0x77, 0x68, 0x03, 0x7a,
-  0x90, 0x87, 0x70, 0x80, 0x07, 0x78, 0x48, 0x07, 0x77, 0x38, 0x87, 0x36,
-  0x68, 0x87, 0x70, 0xa0, 0x07, 0x74, 0x00, 0xe8, 0x41, 0x1e, 0xea, 0xa1,
-  0x1c, 0x00, 0x62, 0x1e, 0xe8, 0x21, 0x1c, 0xc6, 0x61, 0x1d, 0xda, 0x00,
-  0x1e, 0xe4, 0xe1, 0x1d, 0xe8, 0xa1, 0x1c, 0xc6, 0x81, 0x1e, 0xde, 0x41,
-  0x1e, 0xda, 0x40, 0x1c, 0xea, 0xc1, 0x1c, 0xcc, 0xa1, 0x1c, 0xe4, 0xa1,
-  0x0d, 0xe6, 0x21, 0x1d, 0xf4, 0xa1, 0x1c, 0x00, 0x3c, 0x00, 0x88, 0x7a,
-  0x70, 0x87, 0x79, 0x08, 0x07, 0x73, 0x28, 0x87, 0x36, 0x30, 0x07, 0x78,
-  0x68, 0x83, 0x76, 0x08, 0x07, 0x7a, 0x40, 0x07, 0x80, 0x1e, 0xe4, 0xa1,
-  0x1e, 0xca, 0x01, 0x20, 0xea, 0x61, 0x1e, 0xca, 0xa1, 0x0d, 0xe6, 0xe1,
-  0x1d, 0xcc, 0x81, 0x1e, 0xda, 0xc0, 0x1c, 0xd8, 0xe1, 0x1d, 0xc2, 0x81,
-  0x1e, 0x00, 0x73, 0x08, 0x07, 0x76, 0x98, 0x87, 0x72, 0x00, 0x36, 0x2c,
-  0x42, 0x00, 0x24, 0xc0, 0x02, 0x54, 0x41, 0x1a, 0xc0, 0xc1, 0x06, 0x64,
-  0x10, 0x80, 0x04, 0x58, 0x80, 0x0a, 0x49, 0x18, 0x00, 0x00, 0x02, 0x00,
-  0x00, 0x00, 0x13, 0x86, 0x40, 0x18, 0x00, 0x00, 0x00, 0x00, 0x13, 0xb0,
-  0x70, 0x48, 0x07, 0x79, 0xb0, 0x03, 0x3a, 0x68, 0x83, 0x70, 0x80, 0x07,
-  0x78, 0x60, 0x87, 0x72, 0x68, 0x83, 0x76, 0x08, 0x87, 0x71, 0x78, 0x87,
-  0x79, 0xc0, 0x87, 0x38, 0x88, 0x03, 0x37, 0x80, 0x03, 0x37, 0x80, 0x83,
-  0x0d, 0xb7, 0x51, 0x0e, 0x6d, 0x00, 0x0f, 0x7a, 0x60, 0x07, 0x74, 0xa0,
-  0x07, 0x76, 0x40, 0x07, 0x7a, 0x60, 0x07, 0x74, 0xd0, 0x06, 0xe9, 0x10,
-  0x07, 0x7a, 0x80, 0x07, 0x7a, 0x80, 0x07, 0x6d, 0x90, 0x0e, 0x78, 0xa0,
-  0x07, 0x78, 0xa0, 0x07, 0x78, 0xd0, 0x06, 0xe9, 0x10, 0x07, 0x76, 0xa0,
-  0x07, 0x71, 0x60, 0x07, 0x7a, 0x10, 0x07, 0x76, 0xd0, 0x06, 0xe9, 0x30,
-  0x07, 0x72, 0xa0, 0x07, 0x73, 0x20, 0x07, 0x7a, 0x30, 0x07, 0x72, 0xd0,
-  0x06, 0xe9, 0x60, 0x07, 0x74, 0xa0, 0x07, 0x76, 0x40, 0x07, 0x7a, 0x60,
-  0x07, 0x74, 0xd0, 0x06, 0xe6, 0x30, 0x07, 0x72, 0xa0, 0x07, 0x73, 0x20,
-  0x07, 0x7a, 0x30, 0x07, 0x72, 0xd0, 0x06, 0xe6, 0x60, 0x07, 0x74, 0xa0,
-  0x07, 0x76, 0x40, 0x07, 0x7a, 0x60, 0x07, 0x74, 0xd0, 0x06, 0xf6, 0x10,
-  0x07, 0x76, 0xa0, 0x07, 0x71, 0x60, 0x07, 0x7a, 0x10, 0x07, 0x76, 0xd0,
-  0x06, 0xf6, 0x20, 0x07, 0x74, 0xa0, 0x07, 0x73, 0x20, 0x07, 0x7a, 0x30,
-  0x07, 0x72, 0xd0, 0x06, 0xf6, 0x30, 0x07, 0x72, 0xa0, 0x07, 0x73, 0x20,
-  0x07, 0x7a, 0x30, 0x07, 0x72, 0xd0, 0x06, 0xf6, 0x40, 0x07, 0x78, 0xa0,
-  0x07, 0x76, 0x40, 0x07, 0x7a, 0x60, 0x07, 0x74, 0xd0, 0x06, 0xf6, 0x60,
-  0x07, 0x74, 0xa0, 0x07, 0x76, 0x40, 0x07, 0x7a, 0x60, 0x07, 0x74, 0xd0,
-  0x06, 0xf6, 0x90, 0x07, 0x76, 0xa0, 0x07, 0x71, 0x20, 0x07, 0x78, 0xa0,
-  0x07, 0x71, 0x20, 0x07, 0x78, 0xd0, 0x06, 0xf6, 0x10, 0x07, 0x72, 0x80,
-  0x07, 0x7a, 0x10, 0x07, 0x72, 0x80, 0x07, 0x7a, 0x10, 0x07, 0x72, 0x80,
-  0x07, 0x6d, 0x60, 0x0f, 0x71, 0x90, 0x07, 0x72, 0xa0, 0x07, 0x72, 0x50,
-  0x07, 0x76, 0xa0, 0x07, 0x72, 0x50, 0x07, 0x76, 0xd0, 0x06, 0xf6, 0x20,
-  0x07, 0x75, 0x60, 0x07, 0x7a, 0x20, 0x07, 0x75, 0x60, 0x07, 0x7a, 0x20,
-  0x07, 0x75, 0x60, 0x07, 0x6d, 0x60, 0x0f, 0x75, 0x10, 0x07, 0x72, 0xa0,
-  0x07, 0x75, 0x10, 0x07, 0x72, 0xa0, 0x07, 0x75, 0x10, 0x07, 0x72, 0xd0,
-  0x06, 0xf6, 0x10, 0x07, 0x70, 0x20, 0x07, 0x74, 0xa0, 0x07, 0x71, 0x00,
-  0x07, 0x72, 0x40, 0x07, 0x7a, 0x10, 0x07, 0x70, 0x20, 0x07, 0x74, 0xd0,
-  0x06, 0xee, 0x80, 0x07, 0x7a, 0x10, 0x07, 0x76, 0xa0, 0x07, 0x73, 0x20,
-  0x07, 0x1a, 0x21, 0x0c, 0x29, 0x4d, 0x11, 0x02, 0x34, 0xc6, 0x42, 0xfc,
-  0x15, 0x11, 0x4d, 0xc4, 0xf5, 0xdb, 0xc3, 0x10, 0x09, 0x90, 0x38, 0x00,
-  0x00, 0x02, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x00, 0x24, 0x36,
-  0x08, 0x14, 0x25, 0x2f, 0x00, 0x00, 0xc8, 0x02, 0x01, 0x00, 0x1b, 0x00,
-  0x00, 0x00, 0x32, 0x1e, 0x98, 0x18, 0x19, 0x11, 0x4c, 0x90, 0x8c, 0x09,
-  0x26, 0x47, 0xc6, 0x04, 0x43, 0x1a, 0x8a, 0xa0, 0x04, 0x0a, 0xa1, 0x1c,
-  0xca, 0xa7, 0x00, 0x05, 0x0a, 0xa2, 0x40, 0xca, 0x60, 0x04, 0xa0, 0xc0,
-  0x0a, 0xa3, 0x50, 0x0a, 0xa6, 0x70, 0x0a, 0xa8, 0x90, 0x0a, 0xaa, 0xb0,
-  0x0a, 0xad, 0xe0, 0x0a, 0xaf, 0x00, 0x03, 0x0a, 0x31, 0xa0, 0x20, 0x03,
-  0x0a, 0x33, 0xa0, 0x40, 0x03, 0x0a, 0x35, 0xa0, 0x60, 0x03, 0x0a, 0x37,
-  0xa0, 0x80, 0x03, 0x4a, 0xa1, 0x00, 0x07, 0x0a, 0x90, 0xa0, 0x80, 0x0b,
-  0x08, 0x1c, 0x01, 0x28, 0x88, 0x02, 0x29, 0x98, 0x02, 0x2a, 0xa8, 0x42,
-  0x28, 0x8c, 0x42, 0x29, 0x9c, 0x42, 0xa2, 0x6f, 0x2c, 0x61, 0x19, 0x00,
-  0x00, 0x00, 0xb1, 0x18, 0x00, 0x00, 0x7b, 0x00, 0x00, 0x00, 0x33, 0x08,
-  0x80, 0x1c, 0xc4, 0xe1, 0x1c, 0x66, 0x14, 0x01, 0x3d, 0x88, 0x43, 0x38,
-  0x84, 0xc3, 0x8c, 0x42, 0x80, 0x07, 0x79, 0x78, 0x07, 0x73, 0x98, 0x71,
-  0x0c, 0xe6, 0x00, 0x0f, 0xed, 0x10, 0x0e, 0xf4, 0x80, 0x0e, 0x33, 0x0c,
-  0x42, 0x1e, 0xc2, 0xc1, 0x1d, 0xce, 0xa1, 0x1c, 0x66, 0x30, 0x05, 0x3d,
-  0x88, 0x43, 0x38, 0x84, 0x83, 0x1b, 0xcc, 0x03, 0x3d, 0xc8, 0x43, 0x3d,
-  0x8c, 0x03, 0x3d, 0xcc, 0x78, 0x8c, 0x74, 0x70, 0x07, 0x7b, 0x08, 0x07,
-  0x79, 0x48, 0x87, 0x70, 0x70, 0x07, 0x7a, 0x70, 0x03, 0x76, 0x78, 0x87,
-  0x70, 0x20, 0x87, 0x19, 0xcc, 0x11, 0x0e, 0xec, 0x90, 0x0e, 0xe1, 0x30,
-  0x0f, 0x6e, 0x30, 0x0f, 0xe3, 0xf0, 0x0e, 0xf0, 0x50, 0x0e, 0x33, 0x10,
-  0xc4, 0x1d, 0xde, 0x21, 0x1c, 0xd8, 0x21, 0x1d, 0xc2, 0x61, 0x1e, 0x66,
-  0x30, 0x89, 0x3b, 0xbc, 0x83, 0x3b, 0xd0, 0x43, 0x39, 0xb4, 0x03, 0x3c,
-  0xbc, 0x83, 0x3c, 0x84, 0x03, 0x3b, 0xcc, 0xf0, 0x14, 0x76, 0x60, 0x07,
-  0x7b, 0x68, 0x07, 0x37, 0x68, 0x87, 0x72, 0x68, 0x07, 0x37, 0x80, 0x87,
-  0x70, 0x90, 0x87, 0x70, 0x60, 0x07, 0x76, 0x28, 0x07, 0x76, 0xf8, 0x05,
-  0x76, 0x78, 0x87, 0x77, 0x80, 0x87, 0x5f, 0x08, 0x87, 0x71, 0x18, 0x87,
-  0x72, 0x98, 0x87, 0x79, 0x98, 0x81, 0x2c, 0xee, 0xf0, 0x0e, 0xee, 0xe0,
-  0x0e, 0xf5, 0xc0, 0x0e, 0xec, 0x30, 0x03, 0x62, 0xc8, 0xa1, 0x1c, 0xe4,
-  0xa1, 0x1c, 0xcc, 0xa1, 0x1c, 0xe4, 0xa1, 0x1c, 0xdc, 0x61, 0x1c, 0xca,
-  0x21, 0x1c, 0xc4, 0x81, 0x1d, 0xca, 0x61, 0x06, 0xd6, 0x90, 0x43, 0x39,
-  0xc8, 0x43, 0x39, 0x98, 0x43, 0x39, 0xc8, 0x43, 0x39, 0xb8, 0xc3, 0x38,
-  0x94, 0x43, 0x38, 0x88, 0x03, 0x3b, 0x94, 0xc3, 0x2f, 0xbc, 0x83, 0x3c,
-  0xfc, 0x82, 0x3b, 0xd4, 0x03, 0x3b, 0xb0, 0xc3, 0x0c, 0xc7, 0x69, 0x87,
-  0x70, 0x58, 0x87, 0x72, 0x70, 0x83, 0x74, 0x68, 0x07, 0x78, 0x60, 0x87,
-  0x74, 0x18, 0x87, 0x74, 0xa0, 0x87, 0x19, 0xce, 0x53, 0x0f, 0xee, 0x00,
-  0x0f, 0xf2, 0x50, 0x0e, 0xe4, 0x90, 0x0e, 0xe3, 0x40, 0x0f, 0xe1, 0x20,
-  0x0e, 0xec, 0x50, 0x0e, 0x33, 0x20, 0x28, 0x1d, 0xdc, 0xc1, 0x1e, 0xc2,
-  0x41, 0x1e, 0xd2, 0x21, 0x1c, 0xdc, 0x81, 0x1e, 0xdc, 0xe0, 0x1c, 0xe4,
-  0xe1, 0x1d, 0xea, 0x01, 0x1e, 0x66, 0x18, 0x51, 0x38, 0xb0, 0x43, 0x3a,
-  0x9c, 0x83, 0x3b, 0xcc, 0x50, 0x24, 0x76, 0x60, 0x07, 0x7b, 0x68, 0x07,
-  0x37, 0x60, 0x87, 0x77, 0x78, 0x07, 0x78, 0x98, 0x51, 0x4c, 0xf4, 0x90,
-  0x0f, 0xf0, 0x50, 0x0e, 0x33, 0x1e, 0x6a, 0x1e, 0xca, 0x61, 0x1c, 0xe8,
-  0x21, 0x1d, 0xde, 0xc1, 0x1d, 0x7e, 0x01, 0x1e, 0xe4, 0xa1, 0x1c, 0xcc,
-  0x21, 0x1d, 0xf0, 0x61, 0x06, 0x54, 0x85, 0x83, 0x38, 0xcc, 0xc3, 0x3b,
-  0xb0, 0x43, 0x3d, 0xd0, 0x43, 0x39, 0xfc, 0xc2, 0x3c, 0xe4, 0x43, 0x3b,
-  0x88, 0xc3, 0x3b, 0xb0, 0xc3, 0x8c, 0xc5, 0x0a, 0x87, 0x79, 0x98, 0x87,
-  0x77, 0x18, 0x87, 0x74, 0x08, 0x07, 0x7a, 0x28, 0x07, 0x72, 0x98, 0x81,
-  0x5c, 0xe3, 0x10, 0x0e, 0xec, 0xc0, 0x0e, 0xe5, 0x50, 0x0e, 0xf3, 0x30,
-  0x23, 0xc1, 0xd2, 0x41, 0x1e, 0xe4, 0xe1, 0x17, 0xd8, 0xe1, 0x1d, 0xde,
-  0x01, 0x1e, 0x66, 0x50, 0x59, 0x38, 0xa4, 0x83, 0x3c, 0xb8, 0x81, 0x39,
-  0xd4, 0x83, 0x3b, 0x8c, 0x03, 0x3d, 0xa4, 0xc3, 0x3b, 0xb8, 0xc3, 0x2f,
-  0x9c, 0x83, 0x3c, 0xbc, 0x43, 0x3d, 0xc0, 0xc3, 0x3c, 0x00, 0x79, 0x20,
-  0x00, 0x00, 0xc7, 0x02, 0x00, 0x00, 0x62, 0x1e, 0x48, 0x20, 0x43, 0x88,
-  0x0c, 0x19, 0x39, 0x19, 0x24, 0x90, 0x91, 0x40, 0xc6, 0xc8, 0xc8, 0x68,
-  0x22, 0x50, 0x08, 0x14, 0x32, 0x9e, 0x18, 0x19, 0x21, 0x47, 0xc8, 0x90,
-  0x51, 0x2c, 0x09, 0x74, 0x70, 0xd7, 0x00, 0x00, 0x00, 0x00, 0x8b, 0x62,
-  0x61, 0x1b, 0xb4, 0x41, 0x70, 0x50, 0x6c, 0x1c, 0x19, 0x30, 0x91, 0xc1,
-  0x20, 0x91, 0x55, 0x4c, 0x86, 0x00, 0x11, 0xc3, 0x64, 0x4c, 0x8f, 0x84,
-  0x50, 0x08, 0x52, 0x29, 0xc5, 0x30, 0x0c, 0xc3, 0x30, 0x0c, 0x46, 0x10,
-  0x10, 0xc4, 0x30, 0x0c, 0x43, 0x74, 0x21, 0xcb, 0x30, 0x0c, 0xc3, 0x81,
-  0x60, 0x8b, 0xe2, 0x24, 0xc3, 0x30, 0x0c, 0xc3, 0x30, 0x0c, 0x08, 0x82,
-  0x20, 0xc5, 0xb0, 0x28, 0x16, 0x93, 0x10, 0x51, 0x82, 0x18, 0x0d, 0x53,
-  0x14, 0xca, 0x82, 0x24, 0x45, 0x51, 0x1c, 0xc7, 0x41, 0x10, 0x04, 0x41,
-  0x10, 0xcb, 0xb2, 0x24, 0x4c, 0xa2, 0x28, 0x09, 0x33, 0x28, 0x44, 0x63,
-  0x34, 0xc3, 0x43, 0x00, 0x00, 0x00, 0x53, 0x44, 0x4b, 0x20, 0x56, 0x65,
-  0x72, 0x73, 0x69, 0x6f, 0x6e, 0x77, 0x63, 0x68, 0x61, 0x72, 0x5f, 0x73,
-  0x69, 0x7a, 0x65, 0x61, 0x69, 0x72, 0x2e, 0x6d, 0x61, 0x78, 0x5f, 0x64,
-  0x65, 0x76, 0x69, 0x63, 0x65, 0x5f, 0x62, 0x75, 0x66, 0x66, 0x65, 0x72,
-  0x73, 0x61, 0x69, 0x72, 0x2e, 0x6d, 0x61, 0x78, 0x5f, 0x63, 0x6f, 0x6e,
-  0x73, 0x74, 0x61, 0x6e, 0x74, 0x5f, 0x62, 0x75, 0x66, 0x66, 0x65, 0x72,
-  0x73, 0x61, 0x69, 0x72, 0x2e, 0x6d, 0x61, 0x78, 0x5f, 0x74, 0x68, 0x72,
-  0x65, 0x61, 0x64, 0x67, 0x72, 0x6f, 0x75, 0x70, 0x5f, 0x62, 0x75, 0x66,
-  0x66, 0x65, 0x72, 0x73, 0x61, 0x69, 0x72, 0x2e, 0x6d, 0x61, 0x78, 0x5f,
-  0x74, 0x65, 0x78, 0x74, 0x75, 0x72, 0x65, 0x73, 0x61, 0x69, 0x72, 0x2e,
-  0x6d, 0x61, 0x78, 0x5f, 0x72, 0x65, 0x61, 0x64, 0x5f, 0x77, 0x72, 0x69,
-  0x74, 0x65, 0x5f, 0x74, 0x65, 0x78, 0x74, 0x75, 0x72, 0x65, 0x73, 0x61,
-  0x69, 0x72, 0x2e, 0x6d, 0x61, 0x78, 0x5f, 0x73, 0x61, 0x6d, 0x70, 0x6c,
-  0x65, 0x72, 0x73, 0x41, 0x70, 0x70, 0x6c, 0x65, 0x20, 0x4c, 0x4c, 0x56,
-  0x4d, 0x20, 0x76, 0x65, 0x72, 0x73, 0x69, 0x6f, 0x6e, 0x20, 0x33, 0x31,
-  0x30, 0x30, 0x31, 0x2e, 0x31, 0x38, 0x34, 0x20, 0x28, 0x6d, 0x65, 0x74,
-  0x61, 0x6c, 0x66, 0x65, 0x2d, 0x33, 0x31, 0x30, 0x30, 0x31, 0x2e, 0x31,
-  0x38, 0x34, 0x29, 0x4d, 0x65, 0x74, 0x61, 0x6c, 0x61, 0x69, 0x72, 0x2e,
-  0x63, 0x6f, 0x6d, 0x70, 0x69, 0x6c, 0x65, 0x2e, 0x64, 0x65, 0x6e, 0x6f,
-  0x72, 0x6d, 0x73, 0x5f, 0x64, 0x69, 0x73, 0x61, 0x62, 0x6c, 0x65, 0x61,
-  0x69, 0x72, 0x2e, 0x63, 0x6f, 0x6d, 0x70, 0x69, 0x6c, 0x65, 0x2e, 0x66,
-  0x61, 0x73, 0x74, 0x5f, 0x6d, 0x61, 0x74, 0x68, 0x5f, 0x65, 0x6e, 0x61,
-  0x62, 0x6c, 0x65, 0x61, 0x69, 0x72, 0x2e, 0x63, 0x6f, 0x6d, 0x70, 0x69,
-  0x6c, 0x65, 0x2e, 0x66, 0x72, 0x61, 0x6d, 0x65, 0x62, 0x75, 0x66, 0x66,
-  0x65, 0x72, 0x5f, 0x66, 0x65, 0x74, 0x63, 0x68, 0x5f, 0x65, 0x6e, 0x61,
-  0x62, 0x6c, 0x65, 0x61, 0x69, 0x72, 0x2e, 0x70, 0x6f, 0x73, 0x69, 0x74,
-  0x69, 0x6f, 0x6e, 0x61, 0x69, 0x72, 0x2e, 0x61, 0x72, 0x67, 0x5f, 0x74,
-  0x79, 0x70, 0x65, 0x5f, 0x6e, 0x61, 0x6d, 0x65, 0x66, 0x6c, 0x6f, 0x61,
-  0x74, 0x34, 0x61, 0x69, 0x72, 0x2e, 0x61, 0x72, 0x67, 0x5f, 0x6e, 0x61,
-  0x6d, 0x65, 0x70, 0x6f, 0x73, 0x69, 0x74, 0x69, 0x6f, 0x6e, 0x61, 0x69,
-  0x72, 0x2e, 0x76, 0x65, 0x72, 0x74, 0x65, 0x78, 0x5f, 0x6f, 0x75, 0x74,
-  0x70, 0x75, 0x74, 0x67, 0x65, 0x6e, 0x65, 0x72, 0x61, 0x74, 0x65, 0x64,
-  0x28, 0x35, 0x63, 0x6f, 0x6c, 0x6f, 0x72, 0x44, 0x76, 0x34, 0x5f, 0x66,
-  0x29, 0x63, 0x6f, 0x6c, 0x6f, 0x72, 0x67, 0x65, 0x6e, 0x65, 0x72, 0x61,
-  0x74, 0x65, 0x64, 0x28, 0x32, 0x75, 0x76, 0x44, 0x76, 0x32, 0x5f, 0x66,
-  0x29, 0x66, 0x6c, 0x6f, 0x61, 0x74, 0x32, 0x75, 0x76, 0x67, 0x65, 0x6e,
-  0x65, 0x72, 0x61, 0x74, 0x65, 0x64, 0x28, 0x33, 0x74, 0x65, 0x78, 0x6a,
-  0x29, 0x75, 0x69, 0x6e, 0x74, 0x74, 0x65, 0x78, 0x67, 0x65, 0x6e, 0x65,
-  0x72, 0x61, 0x74, 0x65, 0x64, 0x28, 0x36, 0x5f, 0x64, 0x75, 0x6d, 0x6d,
-  0x79, 0x6a, 0x29, 0x5f, 0x64, 0x75, 0x6d, 0x6d, 0x79, 0x61, 0x69, 0x72,
-  0x2e, 0x69, 0x6e, 0x64, 0x69, 0x72, 0x65, 0x63, 0x74, 0x5f, 0x62, 0x75,
-  0x66, 0x66, 0x65, 0x72, 0x61, 0x69, 0x72, 0x2e, 0x62, 0x75, 0x66, 0x66,
-  0x65, 0x72, 0x5f, 0x73, 0x69, 0x7a, 0x65, 0x61, 0x69, 0x72, 0x2e, 0x6c,
-  0x6f, 0x63, 0x61, 0x74, 0x69, 0x6f, 0x6e, 0x5f, 0x69, 0x6e, 0x64, 0x65,
-  0x78, 0x61, 0x69, 0x72, 0x2e, 0x72, 0x65, 0x61, 0x64, 0x61, 0x69, 0x72,
-  0x2e, 0x73, 0x74, 0x72, 0x75, 0x63, 0x74, 0x5f, 0x74, 0x79, 0x70, 0x65,
-  0x5f, 0x69, 0x6e, 0x66, 0x6f, 0x56, 0x65, 0x72, 0x74, 0x65, 0x78, 0x33,
-  0x44, 0x76, 0x65, 0x72, 0x74, 0x69, 0x63, 0x65, 0x73, 0x61, 0x69, 0x72,
-  0x2e, 0x69, 0x6e, 0x64, 0x69, 0x72, 0x65, 0x63, 0x74, 0x5f, 0x61, 0x72,
-  0x67, 0x75, 0x6d, 0x65, 0x6e, 0x74, 0x61, 0x69, 0x72, 0x2e, 0x62, 0x75,
-  0x66, 0x66, 0x65, 0x72, 0x66, 0x6c, 0x6f, 0x61, 0x74, 0x76, 0x5f, 0x78,
-  0x76, 0x5f, 0x79, 0x76, 0x5f, 0x7a, 0x76, 0x5f, 0x77, 0x6e, 0x5f, 0x78,
-  0x6e, 0x5f, 0x79, 0x6e, 0x5f, 0x7a, 0x6d, 0x61, 0x74, 0x5f, 0x69, 0x64,
-  0x75, 0x76, 0x70, 0x61, 0x64, 0x30, 0x70, 0x61, 0x64, 0x31, 0x74, 0x5f,
-  0x78, 0x74, 0x5f, 0x79, 0x74, 0x5f, 0x7a, 0x74, 0x5f, 0x77, 0x61, 0x69,
-  0x72, 0x2e, 0x61, 0x72, 0x67, 0x5f, 0x74, 0x79, 0x70, 0x65, 0x5f, 0x73,
-  0x69, 0x7a, 0x65, 0x61, 0x69, 0x72, 0x2e, 0x61, 0x72, 0x67, 0x5f, 0x74,
-  0x79, 0x70, 0x65, 0x5f, 0x61, 0x6c, 0x69, 0x67, 0x6e, 0x5f, 0x73, 0x69,
-  0x7a, 0x65, 0x56, 0x65, 0x72, 0x74, 0x65, 0x78, 0x32, 0x44, 0x76, 0x65,
-  0x72, 0x74, 0x69, 0x63, 0x65, 0x73, 0x5f, 0x32, 0x64, 0x63, 0x5f, 0x72,
-  0x63, 0x5f, 0x67, 0x63, 0x5f, 0x62, 0x63, 0x5f, 0x61, 0x54, 0x65, 0x78,
-  0x74, 0x75, 0x72, 0x65, 0x74, 0x65, 0x78, 0x74, 0x75, 0x72, 0x65, 0x73,
-  0x74, 0x65, 0x78, 0x74, 0x75, 0x72, 0x65, 0x32, 0x64, 0x3c, 0x66, 0x6c,
-  0x6f, 0x61, 0x74, 0x2c, 0x20, 0x73, 0x61, 0x6d, 0x70, 0x6c, 0x65, 0x3e,
-  0x61, 0x69, 0x72, 0x2e, 0x74, 0x65, 0x78, 0x74, 0x75, 0x72, 0x65, 0x61,
-  0x69, 0x72, 0x2e, 0x73, 0x61, 0x6d, 0x70, 0x6c, 0x65, 0x44, 0x65, 0x76,
-  0x69, 0x63, 0x65, 0x4d, 0x61, 0x74, 0x65, 0x72, 0x69, 0x61, 0x6c, 0x6d,
-  0x61, 0x74, 0x65, 0x72, 0x69, 0x61, 0x6c, 0x73, 0x61, 0x5f, 0x72, 0x61,
-  0x5f, 0x67, 0x61, 0x5f, 0x62, 0x61, 0x5f, 0x61, 0x73, 0x5f, 0x72, 0x73,
-  0x5f, 0x67, 0x73, 0x5f, 0x62, 0x73, 0x5f, 0x61, 0x70, 0x61, 0x72, 0x61,
-  0x6d, 0x73, 0x5f, 0x78, 0x70, 0x61, 0x72, 0x61, 0x6d, 0x73, 0x5f, 0x79,
-  0x70, 0x61, 0x72, 0x61, 0x6d, 0x73, 0x5f, 0x7a, 0x70, 0x61, 0x72, 0x61,
-  0x6d, 0x73, 0x5f, 0x77, 0x66, 0x6c, 0x61, 0x67, 0x73, 0x69, 0x6e, 0x74,
-  0x64, 0x69, 0x66, 0x66, 0x75, 0x73, 0x65, 0x5f, 0x6d, 0x61, 0x70, 0x6e,
-  0x6f, 0x72, 0x6d, 0x61, 0x6c, 0x5f, 0x6d, 0x61, 0x70, 0x6d, 0x65, 0x74,
-  0x61, 0x6c, 0x6c, 0x69, 0x63, 0x5f, 0x72, 0x6f, 0x75, 0x67, 0x68, 0x6e,
-  0x65, 0x73, 0x73, 0x5f, 0x6d, 0x61, 0x70, 0x65, 0x6d, 0x69, 0x73, 0x73,
-  0x69, 0x76, 0x65, 0x5f, 0x6d, 0x61, 0x70, 0x73, 0x68, 0x65, 0x65, 0x6e,
-  0x5f, 0x6d, 0x61, 0x70, 0x70, 0x61, 0x64, 0x32, 0x49, 0x6e, 0x73, 0x74,
-  0x61, 0x6e, 0x63, 0x65, 0x54, 0x72, 0x61, 0x6e, 0x73, 0x66, 0x6f, 0x72,
-  0x6d, 0x69, 0x6e, 0x73, 0x74, 0x61, 0x6e, 0x63, 0x65, 0x73, 0x66, 0x6c,
-  0x6f, 0x61, 0x74, 0x34, 0x78, 0x34, 0x6d, 0x61, 0x74, 0x72, 0x69, 0x78,
-  0x6e, 0x6f, 0x72, 0x6d, 0x61, 0x6c, 0x5f, 0x6d, 0x61, 0x74, 0x72, 0x69,
-  0x78, 0x69, 0x6e, 0x73, 0x74, 0x61, 0x6e, 0x63, 0x65, 0x73, 0x5f, 0x32,
-  0x64, 0x53, 0x63, 0x65, 0x6e, 0x65, 0x73, 0x63, 0x65, 0x6e, 0x65, 0x70,
-  0x72, 0x6f, 0x6a, 0x65, 0x63, 0x74, 0x69, 0x6f, 0x6e, 0x76, 0x69, 0x65,
-  0x77, 0x5f, 0x6d, 0x61, 0x74, 0x72, 0x69, 0x78, 0x63, 0x6f, 0x6d, 0x62,
-  0x69, 0x6e, 0x65, 0x64, 0x6d, 0x61, 0x74, 0x72, 0x69, 0x78, 0x5f, 0x32,
-  0x64, 0x70, 0x6f, 0x73, 0x5f, 0x78, 0x70, 0x6f, 0x73, 0x5f, 0x79, 0x70,
-  0x6f, 0x73, 0x5f, 0x7a, 0x72, 0x69, 0x67, 0x68, 0x74, 0x5f, 0x78, 0x72,
-  0x69, 0x67, 0x68, 0x74, 0x5f, 0x79, 0x72, 0x69, 0x67, 0x68, 0x74, 0x5f,
-  0x7a, 0x75, 0x70, 0x5f, 0x78, 0x75, 0x70, 0x5f, 0x79, 0x75, 0x70, 0x5f,
-  0x7a, 0x70, 0x31, 0x5f, 0x78, 0x70, 0x31, 0x5f, 0x79, 0x70, 0x31, 0x5f,
-  0x7a, 0x64, 0x69, 0x72, 0x65, 0x63, 0x74, 0x69, 0x6f, 0x6e, 0x5f, 0x78,
-  0x64, 0x69, 0x72, 0x65, 0x63, 0x74, 0x69, 0x6f, 0x6e, 0x5f, 0x79, 0x64,
-  0x69, 0x72, 0x65, 0x63, 0x74, 0x69, 0x6f, 0x6e, 0x5f, 0x7a, 0x6c, 0x65,
-  0x6e, 0x73, 0x5f, 0x73, 0x69, 0x7a, 0x65, 0x73, 0x70, 0x72, 0x65, 0x61,
-  0x64, 0x5f, 0x61, 0x6e, 0x67, 0x6c, 0x65, 0x69, 0x6e, 0x76, 0x5f, 0x77,
-  0x69, 0x64, 0x74, 0x68, 0x69, 0x6e, 0x76, 0x5f, 0x68, 0x65, 0x69, 0x67,
-  0x68, 0x74, 0x6e, 0x65, 0x61, 0x72, 0x5f, 0x70, 0x6c, 0x61, 0x6e, 0x65,
-  0x66, 0x61, 0x72, 0x5f, 0x70, 0x6c, 0x61, 0x6e, 0x65, 0x61, 0x73, 0x70,
-  0x65, 0x63, 0x74, 0x5f, 0x72, 0x61, 0x74, 0x69, 0x6f, 0x66, 0x6f, 0x76,
-  0x43, 0x61, 0x6d, 0x65, 0x72, 0x61, 0x56, 0x69, 0x65, 0x77, 0x76, 0x69,
-  0x65, 0x77, 0x55, 0x6e, 0x69, 0x66, 0x6f, 0x72, 0x6d, 0x43, 0x61, 0x6d,
-  0x65, 0x72, 0x61, 0x63, 0x61, 0x6d, 0x65, 0x72, 0x61, 0x61, 0x69, 0x72,
-  0x2e, 0x76, 0x65, 0x72, 0x74, 0x65, 0x78, 0x5f, 0x69, 0x64, 0x76, 0x69,
-  0x64, 0x61, 0x69, 0x72, 0x2e, 0x69, 0x6e, 0x73, 0x74, 0x61, 0x6e, 0x63,
-  0x65, 0x5f, 0x69, 0x64, 0x69, 0x5f, 0x69, 0x64, 0x00, 0x00, 0xa6, 0x4b,
-  0x02, 0x00, 0x00, 0x00, 0x00, 0x00, 0x30, 0x82, 0x30, 0x04, 0x23, 0x08,
-  0xdf, 0x1b, 0x8c, 0x20, 0x0c, 0xc2, 0x08, 0xc2, 0x30, 0x8c, 0x20, 0x0c,
-  0xc4, 0x08, 0xc2, 0x50, 0x8c, 0x20, 0x0c, 0xc6, 0x08, 0xc2, 0x70, 0x8c,
-  0x20, 0x0c, 0xc8, 0x08, 0xc2, 0x90, 0x8c, 0x20, 0x0c, 0xca, 0x08, 0x42,
-  0x07, 0x8c, 0x20, 0x0c, 0xcb, 0x08, 0xc2, 0xc0, 0x8c, 0x20, 0x0c, 0xcd,
-  0x08, 0xc2, 0xe0, 0x8c, 0x20, 0x0c, 0xcf, 0x08, 0xc2, 0x00, 0x8d, 0x20,
-  0x0c, 0xd1, 0x08, 0xc2, 0x20, 0x8d, 0x20, 0x0c, 0xd3, 0x08, 0xc2, 0x40,
-  0x8d, 0x20, 0x0c, 0xd5, 0x08, 0xc2, 0x60, 0x8d, 0x20, 0x0c, 0xd7, 0x08,
-  0xc2, 0x80, 0x8d, 0x20, 0x0c, 0xd9, 0x08, 0xc2, 0xa0, 0x8d, 0x20, 0x0c,
-  0xdb, 0x08, 0xc2, 0xc0, 0x8d, 0x20, 0x0c, 0xdd, 0x08, 0xc2, 0xe0, 0x8d,
-  0x20, 0x0c, 0xdf, 0x08, 0xc2, 0x00, 0x06, 0x23, 0x08, 0x43, 0x18, 0x8c,
-  0x20, 0x0c, 0x62, 0x30, 0x82, 0x30, 0x8c, 0xc1, 0x0c, 0x83, 0x49, 0x04,
-  0x27, 0x31, 0xc3, 0x80, 0x12, 0x42, 0x4a, 0xcc, 0x30, 0xa8, 0xc4, 0xb0,
-  0x12, 0x33, 0x0c, 0x2a, 0x41, 0xac, 0xc4, 0x0c, 0x83, 0x4a, 0x14, 0x2b,
-  0x31, 0xc3, 0xa0, 0x12, 0x06, 0x4b, 0xcc, 0x30, 0xa8, 0xc4, 0xd1, 0x12,
-  0x33, 0x0c, 0x2a, 0x81, 0xb8, 0xc4, 0x0c, 0x41, 0x32, 0xc3, 0x60, 0x12,
-  0x2f, 0x01, 0x13, 0x33, 0x10, 0x8a, 0x49, 0xbc, 0x04, 0x4c, 0xcc, 0x10,
-  0x2c, 0x33, 0x04, 0xcc, 0x0c, 0x41, 0x33, 0x43, 0xe1, 0x3c, 0x50, 0x24,
-  0xcd, 0x60, 0x4c, 0xd4, 0x03, 0x45, 0xd5, 0x0c, 0xc6, 0x64, 0x3d, 0x57,
-  0x84, 0xcd, 0x60, 0x4c, 0xd9, 0xa3, 0x45, 0xdb, 0x0c, 0xc6, 0xc4, 0x3d,
-  0x5a, 0xd4, 0xcd, 0x50, 0xe4, 0x85, 0x5e, 0xec, 0x05, 0x5f, 0xf4, 0xc5,
-  0x0c, 0xb0, 0x00, 0x13, 0x29, 0x01, 0x13, 0x67, 0x80, 0x06, 0x29, 0x91,
-  0x12, 0x30, 0x71, 0x06, 0x69, 0xd0, 0x12, 0x29, 0x01, 0x13, 0x67, 0xa0,
-  0x06, 0x33, 0x91, 0x12, 0x30, 0x71, 0x06, 0x6b, 0xe0, 0x12, 0x29, 0x01,
-  0x13, 0x67, 0xc0, 0x06, 0x34, 0x91, 0x12, 0x30, 0x71, 0x06, 0x6d, 0x50,
-  0x13, 0x29, 0x01, 0x13, 0x67, 0xe0, 0x06, 0x36, 0x91, 0x12, 0x30, 0xa1,
-  0xbd, 0xc1, 0x4d, 0xa4, 0x04, 0x4c, 0x9c, 0x01, 0x1c, 0xe0, 0x44, 0x4a,
-  0xc0, 0xc4, 0x19, 0xc4, 0x41, 0x4e, 0xa4, 0x04, 0x4c, 0x9c, 0x81, 0x1c,
-  0xe8, 0x44, 0x4a, 0xc0, 0xc4, 0x19, 0xcc, 0x81, 0x4c, 0xa4, 0x04, 0x4c,
-  0x9c, 0x01, 0x1d, 0xec, 0x44, 0x4a, 0xc0, 0xc4, 0x19, 0xd4, 0x01, 0x4f,
-  0xa4, 0x04, 0x4c, 0x9c, 0x81, 0x1d, 0xf4, 0x44, 0x4a, 0xc0, 0xc4, 0x19,
-  0xdc, 0xc1, 0x0c, 0x10, 0x4c, 0x98, 0x01, 0x18, 0xc0, 0x04, 0x4a, 0x84,
-  0x81, 0x18, 0xfc, 0x05, 0x1e, 0xf8, 0x44, 0x1e, 0xa4, 0xc4, 0x33, 0x06,
-  0x11, 0x19, 0xcc, 0x20, 0x07, 0x30, 0x91, 0x12, 0x30, 0x71, 0x06, 0x68,
-  0x90, 0x12, 0x29, 0x01, 0x13, 0x67, 0x90, 0x06, 0x2d, 0x91, 0x12, 0x30,
-  0x71, 0x06, 0x6a, 0x30, 0x13, 0x29, 0x01, 0x13, 0xda, 0xe6, 0x12, 0x29,
-  0x01, 0x13, 0x67, 0x00, 0x07, 0x34, 0x91, 0x12, 0x30, 0x71, 0x06, 0x71,
-  0x50, 0x13, 0x29, 0x01, 0x13, 0x67, 0xc0, 0x07, 0x36, 0x91, 0x12, 0x30,
-  0x71, 0x06, 0x7d, 0x70, 0x13, 0x29, 0x01, 0x13, 0x67, 0xe0, 0x07, 0x38,
-  0x91, 0x12, 0x30, 0x71, 0x06, 0x7f, 0x30, 0x03, 0x84, 0x12, 0x66, 0x00,
-  0x06, 0x28, 0x81, 0x12, 0x61, 0x20, 0x06, 0xa1, 0x81, 0x07, 0x39, 0x91,
-  0x07, 0x29, 0xf1, 0xe8, 0x41, 0xb4, 0x07, 0x33, 0x28, 0x30, 0x31, 0x0a,
-  0x60, 0x00, 0x13, 0x28, 0x41, 0x0a, 0x8f, 0x28, 0x44, 0xdb, 0x0c, 0x07,
-  0x4c, 0xb4, 0x04, 0x4c, 0x88, 0xc2, 0x56, 0x06, 0xa3, 0x31, 0x03, 0x64,
-  0x12, 0x1e, 0x18, 0x98, 0x04, 0x4a, 0x84, 0x81, 0x18, 0x90, 0x06, 0x1e,
-  0xb4, 0x44, 0x1e, 0xb4, 0xc4, 0x03, 0x0a, 0x51, 0x28, 0xcc, 0x80, 0x0f,
-  0x30, 0x91, 0x12, 0x30, 0x71, 0x06, 0x7c, 0x90, 0x12, 0x29, 0x01, 0x13,
-  0x67, 0xd0, 0x07, 0x2d, 0x91, 0x12, 0x30, 0x71, 0x06, 0x7e, 0x30, 0x13,
-  0x29, 0x01, 0x13, 0x67, 0xf0, 0x07, 0x2e, 0x91, 0x12, 0x30, 0x71, 0x06,
-  0xa7, 0x40, 0x13, 0x29, 0x01, 0x13, 0x67, 0x80, 0x0a, 0x35, 0x91, 0x12,
-  0x30, 0x71, 0x06, 0xa9, 0x60, 0x13, 0x29, 0x01, 0x13, 0x67, 0xa0, 0x0a,
-  0x37, 0x91, 0x12, 0x30, 0x71, 0x06, 0xab, 0x80, 0x13, 0x29, 0x01, 0x13,
-  0x67, 0xc0, 0x0a, 0x39, 0x91, 0x12, 0x30, 0x71, 0x06, 0xad, 0xa0, 0x13,
-  0x29, 0x01, 0x13, 0x67, 0xe0, 0x0a, 0x32, 0x91, 0x12, 0x30, 0xa1, 0xbd,
-  0xc2, 0x4e, 0xa4, 0x04, 0x4c, 0x68, 0xb0, 0xc0, 0x13, 0x29, 0x01, 0x13,
-  0x5a, 0x2c, 0xf4, 0x44, 0x4a, 0xc0, 0x84, 0x26, 0x0b, 0x3e, 0x91, 0x12,
-  0x30, 0xa1, 0xcd, 0xc2, 0x4f, 0xa4, 0x04, 0x4c, 0xd0, 0x42, 0x2d, 0x80,
-  0x45, 0x4a, 0xc0, 0x04, 0x2d, 0xd8, 0x42, 0x58, 0xa4, 0x04, 0x4c, 0xd0,
-  0xc2, 0x2d, 0x88, 0x45, 0x4a, 0xc0, 0x04, 0x2d, 0xe0, 0xc2, 0x58, 0xa4,
-  0x04, 0x4c, 0xd0, 0x42, 0x2e, 0x90, 0x45, 0x4a, 0xc0, 0xc4, 0x19, 0xcc,
-  0x41, 0x59, 0xa4, 0x04, 0x4c, 0x9c, 0x81, 0x2e, 0xcc, 0x00, 0xbd, 0x84,
-  0x19, 0x80, 0xc1, 0x4b, 0xa0, 0x44, 0x18, 0x88, 0x81, 0x69, 0xe0, 0x81,
-  0x59, 0xe4, 0x41, 0x4a, 0x3c, 0xa5, 0x10, 0x99, 0xc2, 0x0c, 0x0a, 0x4c,
-  0xf8, 0x04, 0x4c, 0xf4, 0x82, 0x2f, 0xf8, 0x84, 0x4f, 0xc0, 0x44, 0x2f,
-  0xfc, 0xc2, 0x0c, 0x50, 0x4a, 0x98, 0x01, 0x18, 0xa4, 0x04, 0x4a, 0x84,
-  0x81, 0x18, 0xa0, 0x06, 0x1e, 0xb0, 0x44, 0x1e, 0xb8, 0xc4, 0xb3, 0x0b,
-  0x11, 0x2f, 0xcc, 0xe0, 0x9c, 0x85, 0x19, 0x80, 0xc1, 0x59, 0xa0, 0x44,
-  0x18, 0xe0, 0x81, 0x4f, 0xe4, 0x81, 0x4b, 0x3c, 0xbd, 0x10, 0x81, 0xc3,
-  0x0c, 0x6a, 0x00, 0x13, 0x2d, 0x01, 0x13, 0x63, 0x40, 0x06, 0x65, 0x00,
-  0x1a, 0x2d, 0xd1, 0x12, 0x30, 0xa1, 0x07, 0x7b, 0x50, 0x06, 0xa2, 0xe1,
-  0x12, 0x2d, 0x01, 0x13, 0xa0, 0x10, 0x0a, 0x65, 0x50, 0x1a, 0x35, 0xd1,
-  0x12, 0x30, 0x51, 0x0a, 0xa6, 0x50, 0x06, 0xa7, 0x71, 0x13, 0x2d, 0x01,
-  0x13, 0xbb, 0xc0, 0x0b, 0x65, 0x90, 0x1a, 0x39, 0xd1, 0x12, 0x30, 0xd1,
-  0x0b, 0xe0, 0x50, 0x06, 0xaa, 0x31, 0x83, 0x04, 0x13, 0xde, 0x27, 0x13,
-  0x60, 0x00, 0x13, 0x28, 0x11, 0x06, 0x62, 0xb0, 0x1a, 0x78, 0x20, 0x13,
-  0x79, 0xd0, 0x12, 0x4f, 0x38, 0x44, 0xe2, 0x30, 0xc3, 0x3c, 0xc0, 0x44,
-  0x4a, 0xc0, 0xc4, 0x19, 0x9c, 0x43, 0x4a, 0xa4, 0x04, 0x4c, 0x9c, 0x01,
-  0x3a, 0xb4, 0x44, 0x4a, 0xc0, 0xc4, 0x19, 0xa4, 0xc3, 0x4c, 0xa4, 0x04,
-  0x4c, 0x9c, 0x81, 0x3a, 0xb8, 0x44, 0x4a, 0xc0, 0xc4, 0x19, 0xac, 0x03,
-  0x4d, 0xa4, 0x04, 0x4c, 0x9c, 0x01, 0x3b, 0xd4, 0x44, 0x4a, 0xc0, 0xc4,
-  0x19, 0xb4, 0x83, 0x4d, 0xa4, 0x04, 0x4c, 0x9c, 0x81, 0x3b, 0xdc, 0x44,
-  0x4a, 0xc0, 0xc4, 0x19, 0xbc, 0x03, 0x4e, 0xa4, 0x04, 0x4c, 0x9c, 0x01,
-  0x3c, 0xe4, 0x44, 0x4a, 0xc0, 0xc4, 0x19, 0xc4, 0x83, 0x4e, 0xa4, 0x04,
-  0x4c, 0x9c, 0x81, 0x3c, 0xc8, 0x44, 0x4a, 0xc0, 0xc4, 0x19, 0xcc, 0xc3,
-  0x4e, 0xa4, 0x04, 0x4c, 0x9c, 0x01, 0x3d, 0xf0, 0x44, 0x4a, 0xc0, 0xc4,
-  0x19, 0xd4, 0x43, 0x4f, 0xa4, 0x04, 0x4c, 0x9c, 0x81, 0x3d, 0xf8, 0x44,
-  0x4a, 0xc0, 0xc4, 0x19, 0xdc, 0xc3, 0x4f, 0xa4, 0x04, 0x4c, 0x9c, 0x01,
-  0x3e, 0x80, 0x45, 0x4a, 0xc0, 0xc4, 0x19, 0xe4, 0x43, 0x58, 0xa4, 0x04,
-  0x4c, 0x9c, 0x81, 0x3e, 0x88, 0x45, 0x4a, 0xc0, 0xc4, 0x19, 0xec, 0xc3,
-  0x58, 0xa4, 0x04, 0x4c, 0x9c, 0x01, 0x3f, 0x90, 0x45, 0x4a, 0xc0, 0xc4,
-  0x19, 0xf4, 0xc3, 0x0c, 0x1b, 0x4c, 0xf8, 0x04, 0x4c, 0xf4, 0xc2, 0x38,
-  0xf8, 0x84, 0x4f, 0xc0, 0x44, 0x2f, 0x90, 0x03, 0x4b, 0xf8, 0x04, 0x4c,
-  0xf4, 0x42, 0x39, 0xa0, 0x85, 0x4f, 0xc0, 0x44, 0x2f, 0x98, 0x83, 0x18,
-  0xb4, 0x46, 0x5a, 0x94, 0x05, 0x4c, 0xf8, 0xc3, 0x3f, 0xcc, 0x00, 0xa1,
-  0x84, 0x19, 0x80, 0x01, 0x4a, 0xa0, 0x44, 0x18, 0x88, 0x81, 0x6b, 0xe0,
-  0x81, 0x5a, 0xe4, 0x81, 0x4b, 0x3c, 0x20, 0x11, 0x85, 0xc4, 0x0c, 0x86,
-  0x49, 0x88, 0xc4, 0xa3, 0x45, 0x23, 0x31, 0x83, 0xf1, 0x12, 0x24, 0xf1,
-  0x68, 0x51, 0x49, 0xcc, 0x40, 0xb0, 0xc6, 0x6b, 0xc0, 0x46, 0x6c, 0xcc,
-  0x30, 0xc4, 0x84, 0x5f, 0xc8, 0xc6, 0xb9, 0x02, 0xc0, 0x89, 0x01, 0xc7,
-  0x71, 0x1c, 0xc7, 0x71, 0x1c, 0xc7, 0x71, 0x1c, 0xc7, 0x71, 0x1c, 0xc7,
-  0x71, 0x1c, 0xc7, 0x71, 0x1c, 0xc7, 0x71, 0x1c, 0xc7, 0x71, 0x62, 0x20,
-  0x06, 0x62, 0x20, 0x06, 0x6e, 0xe0, 0x06, 0x6e, 0xe0, 0x06, 0x6e, 0xe0,
-  0x06, 0x6e, 0xe0, 0x06, 0x16, 0x1d, 0xe8, 0x81, 0x65, 0x59, 0x6e, 0x40,
-  0x07, 0x74, 0x40, 0x07, 0x74, 0xc0, 0x0a, 0xb0, 0x47, 0x1a, 0xe2, 0x44,
-  0x1a, 0xf6, 0xe0, 0x0b, 0x7e, 0x81, 0xb3, 0x01, 0x69, 0xa0, 0x04, 0x69,
-  0xb0, 0x85, 0x0b, 0xc1, 0x86, 0xbe, 0x06, 0xb4, 0x42, 0x1a, 0xa6, 0x60,
-  0x0a, 0xa0, 0x20, 0x23, 0x81, 0x09, 0xca, 0x88, 0x8d, 0xcd, 0xae, 0xcd,
-  0xa5, 0xed, 0x8d, 0xac, 0x8e, 0xad, 0xcc, 0xc5, 0x8c, 0x2d, 0xec, 0x6c,
-  0x6e, 0x14, 0x44, 0x2d, 0xd6, 0x82, 0x2d, 0xda, 0xc2, 0x2d, 0xde, 0x02,
-  0x2e, 0xe2, 0x22, 0x15, 0x36, 0x36, 0xbb, 0x36, 0x97, 0x34, 0xb2, 0x32,
-  0x37, 0xba, 0x51, 0x02, 0xb9, 0xc8, 0x25, 0x2c, 0x4d, 0xce, 0xc5, 0xae,
-  0x4c, 0x6e, 0x2e, 0xed, 0xcd, 0x6d, 0x94, 0x60, 0x2e, 0x92, 0x0a, 0x4b,
-  0x93, 0x73, 0x61, 0x0b, 0x73, 0x3b, 0xab, 0x0b, 0x3b, 0x2b, 0xfb, 0xb2,
-  0x2b, 0x93, 0x9b, 0x4b, 0x7b, 0x73, 0x1b, 0x25, 0xa0, 0x8b, 0x9c, 0xc2,
-  0xd2, 0xe4, 0x5c, 0xc6, 0xde, 0xda, 0xe0, 0xd2, 0xd8, 0xca, 0xbe, 0xde,
-  0xe0, 0xe8, 0xd2, 0xde, 0xdc, 0xe6, 0x46, 0x19, 0xea, 0xc2, 0x2e, 0xee,
-  0x22, 0x95, 0xb0, 0x34, 0x39, 0x17, 0xbb, 0x32, 0x39, 0xba, 0x32, 0xbc,
-  0x51, 0x02, 0xd9, 0x00, 0x00, 0x00, 0xa9, 0x18, 0x00, 0x00, 0x0b, 0x00,
-  0x00, 0x00, 0x0b, 0x0a, 0x72, 0x28, 0x87, 0x77, 0x80, 0x07, 0x7a, 0x58,
-  0x70, 0x98, 0x43, 0x3d, 0xb8, 0xc3, 0x38, 0xb0, 0x43, 0x39, 0xd0, 0xc3,
-  0x82, 0xe6, 0x1c, 0xc6, 0xa1, 0x0d, 0xe8, 0x41, 0x1e, 0xc2, 0xc1, 0x1d,
-  0xe6, 0x21, 0x1d, 0xe8, 0x21, 0x1d, 0xde, 0xc1, 0x1d, 0x00, 0xd1, 0x10,
-  0x00, 0x00, 0x06, 0x00, 0x00, 0x00, 0x07, 0xcc, 0x3c, 0xa4, 0x83, 0x3b,
-  0x9c, 0x03, 0x3b, 0x94, 0x03, 0x3d, 0xa0, 0x83, 0x3c, 0x94, 0x43, 0x38,
-  0x90, 0xc3, 0x01, 0x00, 0x00, 0x00, 0x61, 0x20, 0x00, 0x00, 0xf5, 0x00,
-  0x00, 0x00, 0x13, 0x04, 0x41, 0x2c, 0x10, 0x00, 0x00, 0x00, 0x0a, 0x00,
-  0x00, 0x00, 0x34, 0x14, 0x43, 0x49, 0x10, 0x58, 0x02, 0x45, 0x50, 0x06,
-  0x44, 0x8e, 0x00, 0x8c, 0x45, 0x04, 0x41, 0x10, 0x8c, 0x45, 0x08, 0x82,
-  0x20, 0x8c, 0x45, 0x0c, 0xc3, 0x30, 0x50, 0x30, 0x03, 0x40, 0xc2, 0x0c,
-  0x00, 0x11, 0x33, 0x00, 0x00, 0x00, 0xf1, 0x30, 0x00, 0x00, 0x4c, 0x00,
-  0x00, 0x00, 0x22, 0x47, 0xc8, 0x90, 0x51, 0x16, 0x04, 0x29, 0x00, 0x00,
-  0x00, 0x00, 0xca, 0xf2, 0x3c, 0x0d, 0x5f, 0x5a, 0x54, 0x53, 0x35, 0x53,
-  0x63, 0x65, 0x6e, 0x65, 0x61, 0x6e, 0x79, 0x20, 0x70, 0x6f, 0x69, 0x6e,
-  0x74, 0x65, 0x72, 0x6f, 0x6d, 0x6e, 0x69, 0x70, 0x6f, 0x74, 0x65, 0x6e,
-  0x74, 0x20, 0x63, 0x68, 0x61, 0x72, 0x53, 0x69, 0x6d, 0x70, 0x6c, 0x65,
-  0x20, 0x43, 0x2b, 0x2b, 0x20, 0x54, 0x42, 0x41, 0x41, 0x5f, 0x5a, 0x54,
-  0x53, 0x38, 0x56, 0x65, 0x72, 0x74, 0x65, 0x78, 0x32, 0x44, 0x13, 0x04,
-  0x30, 0x20, 0x83, 0x09, 0x02, 0x18, 0x94, 0xc1, 0x04, 0x01, 0x0c, 0xcc,
-  0x60, 0x82, 0x00, 0x06, 0x67, 0x30, 0x41, 0x00, 0x03, 0x34, 0x98, 0x20,
-  0x80, 0x41, 0x1a, 0x4c, 0x10, 0xc0, 0x40, 0x0d, 0x26, 0x08, 0x60, 0xb0,
-  0x06, 0x13, 0x04, 0x30, 0x60, 0x83, 0x09, 0x02, 0x18, 0xb4, 0xc1, 0x04,
-  0x01, 0x0c, 0xdc, 0x60, 0x43, 0x70, 0x1b, 0x1b, 0x06, 0xdb, 0x20, 0x8f,
-  0xdc, 0xd8, 0x30, 0xd4, 0x46, 0x79, 0xe4, 0xc6, 0x86, 0x86, 0x36, 0xcc,
-  0x23, 0x37, 0xcc, 0x43, 0x37, 0xcc, 0x63, 0x37, 0xcc, 0x83, 0x37, 0xcc,
-  0xa3, 0x37, 0xcc, 0xc3, 0x37, 0x36, 0x0c, 0xe7, 0x61, 0x1e, 0xba, 0xb1,
-  0x61, 0x38, 0x0f, 0xf3, 0xf0, 0x8d, 0x0d, 0x43, 0x79, 0x94, 0x47, 0x6e,
-  0x6c, 0x18, 0xce, 0xa0, 0x3c, 0x72, 0x63, 0xc3, 0x40, 0x0b, 0xe5, 0x91,
-  0x1b, 0x1b, 0x2a, 0xdc, 0x58, 0x8f, 0xdc, 0x58, 0x8f, 0xdf, 0x58, 0x0f,
-  0xdd, 0x60, 0x0f, 0xf0, 0x58, 0x8f, 0xdd, 0x58, 0x8f, 0xf0, 0x58, 0x0f,
-  0xde, 0x58, 0x0f, 0xf1, 0x58, 0x8f, 0xde, 0x58, 0x8f, 0xf1, 0xd8, 0x30,
-  0xb4, 0xc7, 0x7a, 0xe4, 0xc6, 0x86, 0xa1, 0x3d, 0xd6, 0xe3, 0x37, 0x36,
-  0x0c, 0xed, 0xb1, 0x1e, 0xba, 0xb1, 0x61, 0x68, 0x8f, 0xf5, 0xe0, 0x8d,
-  0x0d, 0x43, 0x7b, 0xac, 0x87, 0x78, 0x6c, 0x18, 0xda, 0x63, 0x3d, 0x7a,
-  0x63, 0xc3, 0xd0, 0x1e, 0xeb, 0x31, 0x1e, 0x1b, 0x86, 0xf6, 0x58, 0x8f,
-  0xdd, 0xd8, 0x30, 0xb4, 0xc7, 0x7a, 0x84, 0xc7, 0x86, 0xa1, 0x3d, 0xd8,
-  0x03, 0x3c, 0x00, 0x00, 0x00, 0x00, 0xbb, 0x1a, 0x20, 0xce, 0x0f, 0x28,
-  0x40, 0xc8, 0x41, 0x60, 0xec, 0x6a, 0x98, 0xbe, 0x31, 0xa0, 0x80, 0x22,
-  0x27, 0x81, 0xb1, 0x23, 0x42, 0x08, 0xf8, 0x40, 0x0c, 0x28, 0x08, 0xca,
-  0xd6, 0x8a, 0x8b, 0x0c, 0xfe, 0xc0, 0x0f, 0xc8, 0x80, 0x82, 0xa0, 0x0c,
-  0x32, 0x0c, 0x4d, 0x64, 0x42, 0x20, 0xfe, 0x5b, 0x2b, 0x36, 0x34, 0x18,
-  0x05, 0x51, 0xb0, 0x28, 0x08, 0xca, 0x20, 0xc3, 0x11, 0x51, 0x26, 0x04,
-  0xe2, 0x6f, 0x41, 0x01, 0xfe, 0x5b, 0x2b, 0xc0, 0xa0, 0x0d, 0x50, 0xe1,
-  0x14, 0x34, 0x0a, 0x82, 0x32, 0xc8, 0xc0, 0x58, 0x98, 0x09, 0x81, 0xf8,
-  0x5b, 0x11, 0x80, 0xff, 0xd6, 0x8a, 0x32, 0x90, 0x83, 0x56, 0x60, 0x05,
-  0x8f, 0x82, 0xa0, 0x0c, 0x32, 0x44, 0x1b, 0x67, 0x42, 0x20, 0xfe, 0x56,
-  0x04, 0xe0, 0xbf, 0x23, 0xe2, 0xb2, 0x62, 0xa1, 0x0c, 0x28, 0x08, 0xca,
-  0x20, 0x43, 0x00, 0x06, 0x64, 0x60, 0x41, 0x25, 0xfe, 0x83, 0x0c, 0x83,
-  0x18, 0x94, 0x81, 0x05, 0x93, 0xf8, 0xdb, 0x10, 0x80, 0xff, 0x20, 0x83,
-  0x51, 0x06, 0x67, 0x60, 0x41, 0x24, 0xfe, 0x36, 0x04, 0xe0, 0x3f, 0xc8,
-  0x90, 0xa0, 0x41, 0x1a, 0x58, 0xf0, 0x88, 0xbf, 0x0d, 0x01, 0xf8, 0xef,
-  0x88, 0x20, 0x83, 0x31, 0xf0, 0x85, 0x38, 0xa0, 0x20, 0x28, 0x83, 0x0c,
-  0x41, 0x1b, 0xc4, 0x81, 0x05, 0x62, 0x20, 0xfe, 0x83, 0x0c, 0xc3, 0x1b,
-  0xc8, 0x81, 0x05, 0x60, 0x20, 0xfe, 0x36, 0x04, 0xe0, 0x3f, 0xc8, 0x60,
-  0xc8, 0x01, 0x1d, 0x58, 0xe0, 0x89, 0xbf, 0x0d, 0x01, 0xf8, 0x0f, 0x32,
-  0x24, 0x75, 0x60, 0x07, 0x16, 0x70, 0xe2, 0x6f, 0x43, 0x00, 0xfe, 0x3b,
-  0x22, 0xe2, 0x00, 0x0e, 0xd6, 0xa1, 0x0f, 0x28, 0x08, 0xca, 0x20, 0x43,
-  0xa0, 0x07, 0x7e, 0x60, 0xc1, 0x1b, 0x88, 0xff, 0x20, 0xc3, 0xc0, 0x07,
-  0x7f, 0x60, 0x41, 0x1b, 0x88, 0xff, 0x20, 0x43, 0xe1, 0x07, 0xa0, 0x60,
-  0x81, 0x1a, 0x88, 0xff, 0x20, 0xc3, 0x01, 0x0a, 0xa1, 0x60, 0xc1, 0x19,
-  0x88, 0xff, 0x3e, 0x06, 0x3f, 0xe8, 0x83, 0x7a, 0xa0, 0x00, 0x18, 0xfb,
-  0x18, 0x40, 0xe1, 0x0f, 0xfe, 0x81, 0x02, 0x60, 0xec, 0x63, 0x10, 0x85,
-  0x50, 0x10, 0x09, 0x0a, 0x80, 0x31, 0xc7, 0x80, 0x0a, 0xc5, 0x3e, 0x0c,
-  0x32, 0x04, 0xa9, 0xd0, 0x0a, 0x16, 0xb4, 0x81, 0xf8, 0xcf, 0x31, 0xac,
-  0x82, 0xe1, 0x0f, 0x83, 0x0c, 0x01, 0x2b, 0xc0, 0x82, 0x05, 0x63, 0x20,
-  0xfe, 0x73, 0x0c, 0xae, 0x70, 0x84, 0xc4, 0x20, 0x43, 0xf0, 0x0a, 0xb3,
-  0x60, 0x41, 0x26, 0xfe, 0x66, 0x51, 0xe0, 0x6f, 0xc1, 0x04, 0xfe, 0x16,
-  0x48, 0xe0, 0x6f, 0x81, 0x02, 0xfe, 0x16, 0x20, 0xe0, 0x6f, 0x81, 0x01,
-  0xfe, 0xfb, 0x18, 0x66, 0x41, 0x16, 0xc0, 0x81, 0x02, 0x60, 0xcc, 0x31,
-  0xe4, 0x42, 0xc0, 0x12, 0xfb, 0x18, 0x6c, 0xa1, 0x16, 0x66, 0x82, 0x02,
-  0x60, 0xcc, 0x31, 0x0c, 0xc1, 0x4d, 0xec, 0x63, 0xc8, 0x05, 0x5c, 0x98,
-  0x09, 0x0a, 0x80, 0x31, 0xc7, 0x30, 0x04, 0x3b, 0xb1, 0x8f, 0x81, 0x17,
-  0x76, 0x01, 0x1d, 0x28, 0x00, 0xc6, 0x1c, 0xc3, 0x10, 0xd8, 0xc4, 0x3e,
-  0x86, 0x5f, 0xf0, 0x85, 0x9e, 0xa0, 0x00, 0x18, 0x73, 0x0c, 0xe4, 0x10,
-  0xe0, 0xc4, 0x3e, 0x06, 0x71, 0x08, 0x87, 0x91, 0xa0, 0x00, 0x18, 0x73,
-  0x0c, 0x43, 0x30, 0x16, 0xfb, 0x18, 0xca, 0x81, 0x1c, 0x7a, 0x82, 0x82,
-  0x61, 0xcc, 0x36, 0xa4, 0x43, 0x05, 0xcc, 0x36, 0x04, 0x4a, 0x30, 0xdb,
-  0x10, 0x14, 0xc2, 0x6c, 0x43, 0x40, 0x0c, 0x19, 0x04, 0xc4, 0x00, 0x00,
-  0x00, 0x00, 0x1b, 0x00, 0x00, 0x00, 0x5b, 0x86, 0x20, 0x38, 0x8f, 0x2d,
-  0x03, 0x11, 0xa0, 0xc7, 0x96, 0xe1, 0x08, 0xd2, 0x63, 0xcb, 0x90, 0x04,
-  0xe9, 0xb1, 0x65, 0x68, 0x82, 0xf4, 0xd8, 0x32, 0x48, 0x41, 0x7a, 0x6c,
-  0x19, 0xae, 0x20, 0x3d, 0xb6, 0x0c, 0x5c, 0x90, 0x1e, 0x5b, 0x86, 0x34,
-  0x08, 0xd2, 0x63, 0xcb, 0x60, 0x07, 0x41, 0x7a, 0x6c, 0x19, 0x40, 0x21,
-  0x68, 0x8f, 0x2d, 0x83, 0x28, 0x04, 0xee, 0xb1, 0x65, 0x20, 0x85, 0xe0,
-  0x3d, 0xb6, 0x0c, 0xb5, 0x10, 0xc0, 0xc7, 0x96, 0x01, 0x17, 0x82, 0xf8,
-  0xd8, 0x32, 0xec, 0x42, 0x20, 0x1f, 0x5b, 0x06, 0x5f, 0x08, 0xe6, 0x63,
-  0xcb, 0x10, 0x0e, 0x01, 0x7d, 0x6c, 0x19, 0xc8, 0x21, 0xa8, 0x8f, 0x2d,
-  0xc3, 0x39, 0x04, 0xf6, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x71, 0x20,
-  0x00, 0x00, 0x03, 0x00, 0x00, 0x00, 0x32, 0x0e, 0x10, 0x22, 0x84, 0x00,
-  0xed, 0x09, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x65, 0x0c,
-  0x00, 0x00, 0x1d, 0x00, 0x00, 0x00, 0x12, 0x03, 0x94, 0xe8, 0x00, 0x00,
-  0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x12, 0x00, 0x00, 0x00, 0x09, 0x00,
-  0x00, 0x00, 0x44, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x50, 0x00,
-  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x50, 0x00, 0x00, 0x00, 0x01, 0x00,
-  0x00, 0x00, 0x68, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x1b, 0x00,
-  0x00, 0x00, 0x18, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x12, 0x00,
-  0x00, 0x00, 0x33, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-  0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-  0x00, 0x00, 0x12, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x12, 0x00,
-  0x00, 0x00, 0xff, 0xff, 0xff, 0xff, 0x00, 0x24, 0x00, 0x00, 0x00, 0x00,
-  0x00, 0x00, 0x5d, 0x0c, 0x00, 0x00, 0x10, 0x00, 0x00, 0x00, 0x12, 0x03,
-  0x94, 0x73, 0x00, 0x00, 0x00, 0x00, 0x74, 0x72, 0x69, 0x61, 0x6e, 0x67,
-  0x6c, 0x65, 0x5f, 0x76, 0x65, 0x72, 0x74, 0x65, 0x78, 0x5f, 0x32, 0x64,
-  0x33, 0x31, 0x30, 0x30, 0x31, 0x2e, 0x31, 0x38, 0x34, 0x61, 0x69, 0x72,
-  0x36, 0x34, 0x2d, 0x61, 0x70, 0x70, 0x6c, 0x65, 0x2d, 0x6d, 0x61, 0x63,
-  0x6f, 0x73, 0x78, 0x31, 0x31, 0x2e, 0x30, 0x2e, 0x30, 0x00, 0x00, 0x00,
-  0x00, 0x00, 0xde, 0xc0, 0x17, 0x0b, 0x00, 0x00, 0x00, 0x00, 0x14, 0x00,
-  0x00, 0x00, 0xc8, 0x1a, 0x00, 0x00, 0xff, 0xff, 0xff, 0xff, 0x42, 0x43,
-  0xc0, 0xde, 0x35, 0x14, 0x00, 0x00, 0x03, 0x00, 0x00, 0x00, 0x62, 0x0c,
-  0x30, 0x24, 0x80, 0x10, 0x05, 0xc8, 0x14, 0x00, 0x00, 0x00, 0x21, 0x0c,
-  0x00, 0x00, 0x4c, 0x06, 0x00, 0x00, 0x0b, 0x02, 0x21, 0x00, 0x02, 0x00,
-  0x00, 0x00, 0x13, 0x00, 0x00, 0x00, 0x07, 0x81, 0x23, 0x91, 0x41, 0xc8,
-  0x04, 0x49, 0x06, 0x10, 0x32, 0x39, 0x92, 0x01, 0x84, 0x0c, 0x25, 0x05,
-  0x08, 0x19, 0x1e, 0x04, 0x8b, 0x62, 0x80, 0x18, 0x45, 0x02, 0x42, 0x92,
-  0x0b, 0x42, 0xc4, 0x10, 0x32, 0x14, 0x38, 0x08, 0x18, 0x4b, 0x0a, 0x32,
-  0x62, 0x88, 0x48, 0x90, 0x14, 0x20, 0x43, 0x46, 0x88, 0xa5, 0x00, 0x19,
-  0x32, 0x42, 0x04, 0x49, 0x0e, 0x90, 0x11, 0x23, 0xc4, 0x50, 0x41, 0x51,
-  0x81, 0x8c, 0xe1, 0x83, 0xe5, 0x8a, 0x04, 0x31, 0x46, 0x06, 0x89, 0x20,
-  0x00, 0x00, 0x6f, 0x00, 0x00, 0x00, 0x32, 0x22, 0x88, 0x09, 0x20, 0x64,
-  0x85, 0x04, 0x13, 0x23, 0xa4, 0x84, 0x04, 0x13, 0x23, 0xe3, 0x84, 0xa1,
-  0x90, 0x14, 0x12, 0x4c, 0x8c, 0x8c, 0x0b, 0x84, 0xc4, 0x4c, 0x10, 0xd8,
-  0xc1, 0x0c, 0xc0, 0x30, 0x02, 0x01, 0x8c, 0x02, 0x0c, 0x23, 0x10, 0xc2,
-  0x30, 0xc2, 0x20, 0xcc, 0x11, 0x40, 0xc3, 0x08, 0x02, 0x60, 0x8b, 0x60,
-  0x20, 0x0a, 0x63, 0x8e, 0x00, 0x0c, 0xee, 0x91, 0xa6, 0x88, 0x12, 0x26,
-  0xff, 0x25, 0xa2, 0x89, 0xb8, 0xee, 0x0e, 0x41, 0x00, 0x00, 0x00, 0x00,
-  0x00, 0x20, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x83, 0x08, 0x49, 0x70,
-  0x8f, 0x34, 0x45, 0x94, 0x30, 0xf9, 0x2f, 0x11, 0x4d, 0xc4, 0x65, 0x77,
-  0x48, 0x01, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x80, 0x41, 0x84, 0x25,
-  0x38, 0x4a, 0x9a, 0x22, 0x4a, 0x98, 0xfc, 0x7f, 0x22, 0xae, 0x89, 0x8a,
-  0x88, 0xdf, 0x1e, 0xfe, 0x69, 0x8c, 0x00, 0x18, 0x44, 0x68, 0x82, 0x99,
-  0xae, 0x79, 0xa0, 0x07, 0x79, 0xa8, 0x87, 0x71, 0xa0, 0x07, 0x37, 0x68,
-  0x87, 0x72, 0xa0, 0x87, 0x70, 0x60, 0x07, 0x3d, 0xd0, 0x03, 0x7a, 0x28,
-  0x07, 0x7c, 0xa0, 0x87, 0x7a, 0x90, 0x87, 0x72, 0x90, 0x03, 0x72, 0x40,
-  0x81, 0x73, 0x8e, 0x34, 0x45, 0x94, 0x30, 0xf9, 0x2d, 0x71, 0x4d, 0x54,
-  0x44, 0xa0, 0xe0, 0x19, 0x44, 0x80, 0x82, 0xab, 0xa4, 0x29, 0xa2, 0x84,
-  0xc9, 0xef, 0x88, 0x0a, 0x11, 0x08, 0x13, 0x98, 0x88, 0x08, 0x01, 0x16,
-  0x84, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x20, 0x08,
-  0x82, 0x20, 0x08, 0x82, 0x20, 0x08, 0x00, 0x0c, 0x22, 0x48, 0x41, 0x12,
-  0x04, 0x33, 0x51, 0xf3, 0x40, 0x0f, 0xf2, 0x50, 0x0f, 0xe3, 0x40, 0x0f,
-  0x6e, 0xd0, 0x0e, 0xe5, 0x40, 0x0f, 0xe1, 0xc0, 0x0e, 0x7a, 0xa0, 0x07,
-  0xed, 0x10, 0x0e, 0xf4, 0x20, 0x0f, 0xe9, 0x80, 0x0f, 0x28, 0xa0, 0x0e,
-  0x93, 0xa6, 0x88, 0x12, 0x26, 0x5f, 0x6c, 0xa4, 0x09, 0x68, 0x04, 0xa2,
-  0x8d, 0x80, 0x46, 0x2a, 0x9c, 0x88, 0x41, 0x42, 0x55, 0x0d, 0x22, 0x58,
-  0xc1, 0x20, 0x42, 0x15, 0x1c, 0x23, 0x4d, 0x11, 0x25, 0x4c, 0x3e, 0x2b,
-  0x10, 0x0d, 0x81, 0x0c, 0x85, 0x89, 0xa6, 0x0b, 0x1b, 0x44, 0xc8, 0x82,
-  0x8b, 0xa4, 0x29, 0xa2, 0x84, 0xc9, 0xe7, 0x00, 0x86, 0x88, 0x80, 0x17,
-  0x21, 0x2c, 0x74, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x30, 0x47, 0x80, 0x24,
-  0x01, 0x77, 0x94, 0x34, 0x45, 0x94, 0x30, 0xf9, 0x6e, 0x83, 0x14, 0x4e,
-  0xc4, 0x70, 0x00, 0x43, 0x44, 0x00, 0x36, 0xaa, 0xaa, 0xaa, 0xb6, 0x6e,
-  0x10, 0xc1, 0x0b, 0x4a, 0x71, 0x68, 0x1f, 0x82, 0x10, 0x38, 0x8c, 0x30,
-  0x00, 0x45, 0x20, 0x44, 0x1a, 0x8b, 0x30, 0x04, 0x54, 0x16, 0x01, 0x00,
-  0xe8, 0x2c, 0x03, 0x20, 0x8a, 0x94, 0x0e, 0x04, 0xa4, 0x00, 0x32, 0x47,
-  0x00, 0x0a, 0x83, 0x08, 0x4a, 0x30, 0x88, 0x70, 0x05, 0x83, 0x08, 0x40,
-  0x30, 0x88, 0x10, 0x04, 0xc3, 0x08, 0x04, 0x32, 0x8c, 0x30, 0x20, 0x83,
-  0x08, 0x48, 0x30, 0x02, 0x00, 0x00, 0x51, 0x18, 0x00, 0x00, 0x87, 0x00,
-  0x00, 0x00, 0x1b, 0xc8, 0x25, 0xf8, 0xff, 0xff, 0xff, 0xff, 0x01, 0x90,
-  0x80, 0x8a, 0x18, 0x87, 0x77, 0x90, 0x07, 0x79, 0x28, 0x87, 0x71, 0xa0,
-  0x07, 0x76, 0xc8, 0x87, 0x36, 0x90, 0x87, 0x77, 0xa8, 0x07, 0x77, 0x20,
-  0x87, 0x72, 0x20, 0x87, 0x36, 0x20, 0x87, 0x74, 0xb0, 0x87, 0x74, 0x20,
-  0x87, 0x72, 0x68, 0x83, 0x79, 0x88, 0x07, 0x79, 0xa0, 0x87, 0x36, 0x30,
-  0x07, 0x78, 0x68, 0x83, 0x76, 0x08, 0x07, 0x7a, 0x40, 0x07, 0xc0, 0x1c,
-  0xc2, 0x81, 0x1d, 0xe6, 0xa1, 0x1c, 0x00, 0x82, 0x1c, 0xd2, 0x61, 0x1e,
-  0xc2, 0x41, 0x1c, 0xd8, 0xa1, 0x1c, 0xda, 0x80, 0x1e, 0xc2, 0x21, 0x1d,
-  0xd8, 0xa1, 0x0d, 0xc6, 0x21, 0x1c, 0xd8, 0x81, 0x1d, 0xe6, 0x01, 0x30,
-  0x87, 0x70, 0x60, 0x87, 0x79, 0x28, 0x07, 0x80, 0x60, 0x87, 0x72, 0x98,
-  0x87, 0x79, 0x68, 0x03, 0x78, 0x90, 0x87, 0x72, 0x18, 0x87, 0x74, 0x98,
-  0x87, 0x72, 0x68, 0x03, 0x73, 0x80, 0x87, 0x76, 0x08, 0x07, 0x72, 0x00,
-  0xcc, 0x21, 0x1c, 0xd8, 0x61, 0x1e, 0xca, 0x01, 0x20, 0xdc, 0xe1, 0x1d,
-  0xda, 0xc0, 0x1c, 0xe4, 0x21, 0x1c, 0xda, 0xa1, 0x1c, 0xda, 0x00, 0x1e,
-  0xde, 0x21, 0x1d, 0xdc, 0x81, 0x1e, 0xca, 0x41, 0x1e, 0xda, 0xa0, 0x1c,
-  0xd8, 0x21, 0x1d, 0xda, 0x01, 0xa0, 0x07, 0x79, 0xa8, 0x87, 0x72, 0x00,
-  0x06, 0x77, 0x78, 0x87, 0x36, 0x30, 0x07, 0x79, 0x08, 0x87, 0x76, 0x28,
-  0x87, 0x36, 0x80, 0x87, 0x77, 0x48, 0x07, 0x77, 0xa0, 0x87, 0x72, 0x90,
-  0x87, 0x36, 0x28, 0x07, 0x76, 0x48, 0x87, 0x76, 0x68, 0x03, 0x77, 0x78,
-  0x07, 0x77, 0x68, 0x03, 0x76, 0x28, 0x87, 0x70, 0x30, 0x07, 0x80, 0x70,
-  0x87, 0x77, 0x68, 0x83, 0x74, 0x70, 0x07, 0x73, 0x98, 0x87, 0x36, 0x30,
-  0x07, 0x78, 0x68, 0x83, 0x76, 0x08, 0x07, 0x7a, 0x40, 0x07, 0x80, 0x1e,
-  0xe4, 0xa1, 0x1e, 0xca, 0x01, 0x20, 0xdc, 0xe1, 0x1d, 0xda, 0x40, 0x1d,
-  0xea, 0xa1, 0x1d, 0xe0, 0xa1, 0x0d, 0xe8, 0x21, 0x1c, 0xc4, 0x81, 0x1d,
-  0xca, 0x61, 0x1e, 0x00, 0x73, 0x08, 0x07, 0x76, 0x98, 0x87, 0x72, 0x00,
-  0x08, 0x77, 0x78, 0x87, 0x36, 0x70, 0x87, 0x70, 0x70, 0x87, 0x79, 0x68,
-  0x03, 0x73, 0x80, 0x87, 0x36, 0x68, 0x87, 0x70, 0xa0, 0x07, 0x74, 0x00,
-  0xe8, 0x41, 0x1e, 0xea, 0xa1, 0x1c, 0x00, 0xc2, 0x1d, 0xde, 0xa1, 0x0d,
-  0xe6, 0x21, 0x1d, 0xce, 0xc1, 0x1d, 0xca, 0x81, 0x1c, 0xda, 0x40, 0x1f,
-  0xca, 0x41, 0x1e, 0xde, 0x61, 0x1e, 0xda, 0xc0, 0x1c, 0xe0, 0xa1, 0x0d,
-  0xda, 0x21, 0x1c, 0xe8, 0x01, 0x1d, 0x00, 0x7a, 0x90, 0x87, 0x7a, 0x28,
-  0x07, 0x80, 0x70, 0x87, 0x77, 0x68, 0x03, 0x7a, 0x90, 0x87, 0x70, 0x80,
-  0x07, 0x78, 0x48, 0x07, 0x77, 0x38, 0x87, 0x36, 0x68, 0x87, 0x70, 0xa0,
-  0x07, 0x74, 0x00, 0xe8, 0x41, 0x1e, 0xea, 0xa1, 0x1c, 0x00, 0x62, 0x1e,
-  0xe8, 0x21, 0x1c, 0xc6, 0x61, 0x1d, 0xda, 0x00, 0x1e, 0xe4, 0xe1, 0x1d,
-  0xe8, 0xa1, 0x1c, 0xc6, 0x81, 0x1e, 0xde, 0x41, 0x1e, 0xda, 0x40, 0x1c,
-  0xea, 0xc1, 0x1c, 0xcc, 0xa1, 0x1c, 0xe4, 0xa1, 0x0d, 0xe6, 0x21, 0x1d,
-  0xf4, 0xa1, 0x1c, 0x00, 0x3c, 0x00, 0x88, 0x7a, 0x70, 0x87, 0x79, 0x08,
-  0x07, 0x73, 0x28, 0x87, 0x36, 0x30, 0x07, 0x78, 0x68, 0x83, 0x76, 0x08,
-  0x07, 0x7a, 0x40, 0x07, 0x80, 0x1e, 0xe4, 0xa1, 0x1e, 0xca, 0x01, 0x20,
-  0xea, 0x61, 0x1e, 0xca, 0xa1, 0x0d, 0xe6, 0xe1, 0x1d, 0xcc, 0x81, 0x1e,
-  0xda, 0xc0, 0x1c, 0xd8, 0xe1, 0x1d, 0xc2, 0x81, 0x1e, 0x00, 0x73, 0x08,
-  0x07, 0x76, 0x98, 0x87, 0x72, 0x00, 0x36, 0x2c, 0x42, 0x00, 0x24, 0xc0,
-  0x02, 0x54, 0x41, 0x1a, 0xc0, 0xc1, 0x06, 0x64, 0x10, 0x80, 0x04, 0x58,
-  0x80, 0x6a, 0x83, 0x41, 0xfc, 0xff, 0xff, 0xff, 0xff, 0x00, 0x48, 0x00,
-  0x05, 0x00, 0x49, 0x18, 0x00, 0x00, 0x02, 0x00, 0x00, 0x00, 0x13, 0x86,
-  0x40, 0x18, 0x26, 0x04, 0x04, 0x00, 0x13, 0xb0, 0x70, 0x48, 0x07, 0x79,
-  0xb0, 0x03, 0x3a, 0x68, 0x83, 0x70, 0x80, 0x07, 0x78, 0x60, 0x87, 0x72,
-  0x68, 0x83, 0x76, 0x08, 0x87, 0x71, 0x78, 0x87, 0x79, 0xc0, 0x87, 0x38,
-  0x88, 0x03, 0x37, 0x80, 0x03, 0x37, 0x80, 0x83, 0x0d, 0xb7, 0x51, 0x0e,
-  0x6d, 0x00, 0x0f, 0x7a, 0x60, 0x07, 0x74, 0xa0, 0x07, 0x76, 0x40, 0x07,
-  0x7a, 0x60, 0x07, 0x74, 0xd0, 0x06, 0xe9, 0x10, 0x07, 0x7a, 0x80, 0x07,
-  0x7a, 0x80, 0x07, 0x6d, 0x90, 0x0e, 0x78, 0xa0, 0x07, 0x78, 0xa0, 0x07,
-  0x78, 0xd0, 0x06, 0xe9, 0x10, 0x07, 0x76, 0xa0, 0x07, 0x71, 0x60, 0x07,
-  0x7a, 0x10, 0x07, 0x76, 0xd0, 0x06, 0xe9, 0x30, 0x07, 0x72, 0xa0, 0x07,
-  0x73, 0x20, 0x07, 0x7a, 0x30, 0x07, 0x72, 0xd0, 0x06, 0xe9, 0x60, 0x07,
-  0x74, 0xa0, 0x07, 0x76, 0x40, 0x07, 0x7a, 0x60, 0x07, 0x74, 0xd0, 0x06,
-  0xe6, 0x30, 0x07, 0x72, 0xa0, 0x07, 0x73, 0x20, 0x07, 0x7a, 0x30, 0x07,
-  0x72, 0xd0, 0x06, 0xe6, 0x60, 0x07, 0x74, 0xa0, 0x07, 0x76, 0x40, 0x07,
-  0x7a, 0x60, 0x07, 0x74, 0xd0, 0x06, 0xf6, 0x10, 0x07, 0x76, 0xa0, 0x07,
-  0x71, 0x60, 0x07, 0x7a, 0x10, 0x07, 0x76, 0xd0, 0x06, 0xf6, 0x20, 0x07,
-  0x74, 0xa0, 0x07, 0x73, 0x20, 0x07, 0x7a, 0x30, 0x07, 0x72, 0xd0, 0x06,
-  0xf6, 0x30, 0x07, 0x72, 0xa0, 0x07, 0x73, 0x20, 0x07, 0x7a, 0x30, 0x07,
-  0x72, 0xd0, 0x06, 0xf6, 0x40, 0x07, 0x78, 0xa0, 0x07, 0x76, 0x40, 0x07,
-  0x7a, 0x60, 0x07, 0x74, 0xd0, 0x06, 0xf6, 0x60, 0x07, 0x74, 0xa0, 0x07,
-  0x76, 0x40, 0x07, 0x7a, 0x60, 0x07, 0x74, 0xd0, 0x06, 0xf6, 0x90, 0x07,
-  0x76, 0xa0, 0x07, 0x71, 0x20, 0x07, 0x78, 0xa0, 0x07, 0x71, 0x20, 0x07,
-  0x78, 0xd0, 0x06, 0xf6, 0x10, 0x07, 0x72, 0x80, 0x07, 0x7a, 0x10, 0x07,
-  0x72, 0x80, 0x07, 0x7a, 0x10, 0x07, 0x72, 0x80, 0x07, 0x6d, 0x60, 0x0f,
-  0x71, 0x90, 0x07, 0x72, 0xa0, 0x07, 0x72, 0x50, 0x07, 0x76, 0xa0, 0x07,
-  0x72, 0x50, 0x07, 0x76, 0xd0, 0x06, 0xf6, 0x20, 0x07, 0x75, 0x60, 0x07,
-  0x7a, 0x20, 0x07, 0x75, 0x60, 0x07, 0x7a, 0x20, 0x07, 0x75, 0x60, 0x07,
-  0x6d, 0x60, 0x0f, 0x75, 0x10, 0x07, 0x72, 0xa0, 0x07, 0x75, 0x10, 0x07,
-  0x72, 0xa0, 0x07, 0x75, 0x10, 0x07, 0x72, 0xd0, 0x06, 0xf6, 0x10, 0x07,
-  0x70, 0x20, 0x07, 0x74, 0xa0, 0x07, 0x71, 0x00, 0x07, 0x72, 0x40, 0x07,
-  0x7a, 0x10, 0x07, 0x70, 0x20, 0x07, 0x74, 0xd0, 0x06, 0xee, 0x80, 0x07,
-  0x7a, 0x10, 0x07, 0x76, 0xa0, 0x07, 0x73, 0x20, 0x07, 0x1a, 0x21, 0x0c,
-  0xf9, 0x4c, 0x11, 0x02, 0x34, 0xc6, 0x42, 0xfc, 0x15, 0x11, 0x4d, 0xc4,
-  0x35, 0x44, 0x02, 0x1e, 0x30, 0x00, 0x00, 0x20, 0x00, 0x00, 0x00, 0x10,
-  0x00, 0x00, 0x00, 0x00, 0x60, 0x88, 0xf4, 0x6c, 0x63, 0x00, 0x04, 0x80,
-  0x00, 0x00, 0x00, 0x20, 0x00, 0x00, 0x00, 0x00, 0xc0, 0x10, 0x49, 0x0d,
-  0xb6, 0x32, 0x00, 0x02, 0x40, 0x00, 0x00, 0x00, 0x10, 0x00, 0x00, 0x00,
-  0x00, 0x60, 0x88, 0x54, 0x0a, 0xd2, 0x19, 0x00, 0x01, 0x20, 0x00, 0x00,
-  0x00, 0x08, 0x00, 0x00, 0x00, 0x00, 0x30, 0x44, 0xba, 0x85, 0x26, 0x0d,
-  0x80, 0x00, 0x10, 0x00, 0x00, 0x00, 0x04, 0x00, 0x00, 0x00, 0x00, 0x90,
-  0xd8, 0x20, 0x50, 0xd4, 0xc9, 0x00, 0x00, 0x20, 0x0b, 0x04, 0x1d, 0x00,
-  0x00, 0x00, 0x32, 0x1e, 0x98, 0x18, 0x19, 0x11, 0x4c, 0x90, 0x8c, 0x09,
-  0x26, 0x47, 0xc6, 0x04, 0x43, 0x42, 0x8a, 0xa0, 0x04, 0x0a, 0xa1, 0x1c,
-  0xca, 0xa7, 0x00, 0x05, 0x0a, 0xa2, 0x40, 0xca, 0x60, 0x04, 0xa0, 0xc0,
-  0x0a, 0xa3, 0x50, 0x0a, 0xa6, 0x70, 0x0a, 0xa8, 0x90, 0x0a, 0xaa, 0xb0,
-  0x0a, 0xad, 0xe0, 0x0a, 0xaf, 0x00, 0x03, 0x0a, 0x31, 0xa0, 0x20, 0x03,
-  0x0a, 0x33, 0xa0, 0x40, 0x03, 0x0a, 0x35, 0xa0, 0x60, 0x03, 0x0a, 0x37,
-  0xa0, 0x80, 0x03, 0x4a, 0xa1, 0x00, 0x07, 0x0a, 0x90, 0xa0, 0x80, 0x0b,
-  0xa8, 0x1d, 0x01, 0x28, 0x88, 0x02, 0x29, 0x98, 0x02, 0x2a, 0xa8, 0x42,
-  0x28, 0x8c, 0x42, 0x29, 0x9c, 0x42, 0x2a, 0xac, 0x02, 0x2b, 0xb4, 0x82,
-  0x2b, 0x3c, 0x62, 0xc7, 0x12, 0x96, 0x01, 0x00, 0x00, 0x00, 0xb1, 0x18,
-  0x00, 0x00, 0x7b, 0x00, 0x00, 0x00, 0x33, 0x08, 0x80, 0x1c, 0xc4, 0xe1,
-  0x1c, 0x66, 0x14, 0x01, 0x3d, 0x88, 0x43, 0x38, 0x84, 0xc3, 0x8c, 0x42,
-  0x80, 0x07, 0x79, 0x78, 0x07, 0x73, 0x98, 0x71, 0x0c, 0xe6, 0x00, 0x0f,
-  0xed, 0x10, 0x0e, 0xf4, 0x80, 0x0e, 0x33, 0x0c, 0x42, 0x1e, 0xc2, 0xc1,
-  0x1d, 0xce, 0xa1, 0x1c, 0x66, 0x30, 0x05, 0x3d, 0x88, 0x43, 0x38, 0x84,
-  0x83, 0x1b, 0xcc, 0x03, 0x3d, 0xc8, 0x43, 0x3d, 0x8c, 0x03, 0x3d, 0xcc,
-  0x78, 0x8c, 0x74, 0x70, 0x07, 0x7b, 0x08, 0x07, 0x79, 0x48, 0x87, 0x70,
-  0x70, 0x07, 0x7a, 0x70, 0x03, 0x76, 0x78, 0x87, 0x70, 0x20, 0x87, 0x19,
-  0xcc, 0x11, 0x0e, 0xec, 0x90, 0x0e, 0xe1, 0x30, 0x0f, 0x6e, 0x30, 0x0f,
-  0xe3, 0xf0, 0x0e, 0xf0, 0x50, 0x0e, 0x33, 0x10, 0xc4, 0x1d, 0xde, 0x21,
-  0x1c, 0xd8, 0x21, 0x1d, 0xc2, 0x61, 0x1e, 0x66, 0x30, 0x89, 0x3b, 0xbc,
-  0x83, 0x3b, 0xd0, 0x43, 0x39, 0xb4, 0x03, 0x3c, 0xbc, 0x83, 0x3c, 0x84,
-  0x03, 0x3b, 0xcc, 0xf0, 0x14, 0x76, 0x60, 0x07, 0x7b, 0x68, 0x07, 0x37,
-  0x68, 0x87, 0x72, 0x68, 0x07, 0x37, 0x80, 0x87, 0x70, 0x90, 0x87, 0x70,
-  0x60, 0x07, 0x76, 0x28, 0x07, 0x76, 0xf8, 0x05, 0x76, 0x78, 0x87, 0x77,
-  0x80, 0x87, 0x5f, 0x08, 0x87, 0x71, 0x18, 0x87, 0x72, 0x98, 0x87, 0x79,
-  0x98, 0x81, 0x2c, 0xee, 0xf0, 0x0e, 0xee, 0xe0, 0x0e, 0xf5, 0xc0, 0x0e,
-  0xec, 0x30, 0x03, 0x62, 0xc8, 0xa1, 0x1c, 0xe4, 0xa1, 0x1c, 0xcc, 0xa1,
-  0x1c, 0xe4, 0xa1, 0x1c, 0xdc, 0x61, 0x1c, 0xca, 0x21, 0x1c, 0xc4, 0x81,
-  0x1d, 0xca, 0x61, 0x06, 0xd6, 0x90, 0x43, 0x39, 0xc8, 0x43, 0x39, 0x98,
-  0x43, 0x39, 0xc8, 0x43, 0x39, 0xb8, 0xc3, 0x38, 0x94, 0x43, 0x38, 0x88,
-  0x03, 0x3b, 0x94, 0xc3, 0x2f, 0xbc, 0x83, 0x3c, 0xfc, 0x82, 0x3b, 0xd4,
-  0x03, 0x3b, 0xb0, 0xc3, 0x0c, 0xc7, 0x69, 0x87, 0x70, 0x58, 0x87, 0x72,
-  0x70, 0x83, 0x74, 0x68, 0x07, 0x78, 0x60, 0x87, 0x74, 0x18, 0x87, 0x74,
-  0xa0, 0x87, 0x19, 0xce, 0x53, 0x0f, 0xee, 0x00, 0x0f, 0xf2, 0x50, 0x0e,
-  0xe4, 0x90, 0x0e, 0xe3, 0x40, 0x0f, 0xe1, 0x20, 0x0e, 0xec, 0x50, 0x0e,
-  0x33, 0x20, 0x28, 0x1d, 0xdc, 0xc1, 0x1e, 0xc2, 0x41, 0x1e, 0xd2, 0x21,
-  0x1c, 0xdc, 0x81, 0x1e, 0xdc, 0xe0, 0x1c, 0xe4, 0xe1, 0x1d, 0xea, 0x01,
-  0x1e, 0x66, 0x18, 0x51, 0x38, 0xb0, 0x43, 0x3a, 0x9c, 0x83, 0x3b, 0xcc,
-  0x50, 0x24, 0x76, 0x60, 0x07, 0x7b, 0x68, 0x07, 0x37, 0x60, 0x87, 0x77,
-  0x78, 0x07, 0x78, 0x98, 0x51, 0x4c, 0xf4, 0x90, 0x0f, 0xf0, 0x50, 0x0e,
-  0x33, 0x1e, 0x6a, 0x1e, 0xca, 0x61, 0x1c, 0xe8, 0x21, 0x1d, 0xde, 0xc1,
-  0x1d, 0x7e, 0x01, 0x1e, 0xe4, 0xa1, 0x1c, 0xcc, 0x21, 0x1d, 0xf0, 0x61,
-  0x06, 0x54, 0x85, 0x83, 0x38, 0xcc, 0xc3, 0x3b, 0xb0, 0x43, 0x3d, 0xd0,
-  0x43, 0x39, 0xfc, 0xc2, 0x3c, 0xe4, 0x43, 0x3b, 0x88, 0xc3, 0x3b, 0xb0,
-  0xc3, 0x8c, 0xc5, 0x0a, 0x87, 0x79, 0x98, 0x87, 0x77, 0x18, 0x87, 0x74,
-  0x08, 0x07, 0x7a, 0x28, 0x07, 0x72, 0x98, 0x81, 0x5c, 0xe3, 0x10, 0x0e,
-  0xec, 0xc0, 0x0e, 0xe5, 0x50, 0x0e, 0xf3, 0x30, 0x23, 0xc1, 0xd2, 0x41,
-  0x1e, 0xe4, 0xe1, 0x17, 0xd8, 0xe1, 0x1d, 0xde, 0x01, 0x1e, 0x66, 0x50,
-  0x59, 0x38, 0xa4, 0x83, 0x3c, 0xb8, 0x81, 0x39, 0xd4, 0x83, 0x3b, 0x8c,
-  0x03, 0x3d, 0xa4, 0xc3, 0x3b, 0xb8, 0xc3, 0x2f, 0x9c, 0x83, 0x3c, 0xbc,
-  0x43, 0x3d, 0xc0, 0xc3, 0x3c, 0x00, 0x79, 0x20, 0x00, 0x00, 0xd2, 0x02,
-  0x00, 0x00, 0x62, 0x1e, 0x48, 0x20, 0x43, 0x88, 0x0c, 0x19, 0x39, 0x19,
-  0x24, 0x90, 0x91, 0x40, 0xc6, 0xc8, 0xc8, 0x68, 0x22, 0x50, 0x08, 0x14,
-  0x32, 0x9e, 0x18, 0x19, 0x21, 0x47, 0xc8, 0x90, 0x51, 0x44, 0x09, 0x74,
-  0x38, 0xd9, 0x00, 0x00, 0x00, 0x00, 0x8b, 0x62, 0x61, 0x1b, 0xb4, 0x41,
-  0x70, 0x50, 0x6c, 0x1c, 0x19, 0x30, 0x91, 0xc1, 0x20, 0xd1, 0x55, 0x14,
-  0x58, 0x61, 0x4c, 0x86, 0x31, 0x19, 0xc2, 0xf4, 0x48, 0x08, 0x85, 0x20,
-  0x95, 0x52, 0x0c, 0xc3, 0x30, 0x0c, 0xc3, 0x40, 0x04, 0x01, 0x41, 0x0c,
-  0xc3, 0x30, 0x44, 0x17, 0xb2, 0x0c, 0xc3, 0x30, 0x0c, 0x07, 0x82, 0x2d,
-  0x8a, 0x93, 0x0c, 0xc3, 0x30, 0x0c, 0xc3, 0x30, 0x20, 0x08, 0x82, 0x14,
-  0xc3, 0xa2, 0x58, 0x4c, 0x42, 0x44, 0x09, 0x62, 0x34, 0x4c, 0x51, 0x28,
-  0x0b, 0x92, 0x14, 0x45, 0x71, 0x1c, 0x07, 0x41, 0x10, 0x04, 0x41, 0x2c,
-  0xcb, 0x92, 0x30, 0x89, 0xa2, 0x24, 0xcc, 0xa0, 0x10, 0x8d, 0xd1, 0x0c,
-  0x0f, 0x01, 0x53, 0x44, 0x4b, 0x20, 0x56, 0x65, 0x72, 0x73, 0x69, 0x6f,
-  0x6e, 0x77, 0x63, 0x68, 0x61, 0x72, 0x5f, 0x73, 0x69, 0x7a, 0x65, 0x61,
-  0x69, 0x72, 0x2e, 0x6d, 0x61, 0x78, 0x5f, 0x64, 0x65, 0x76, 0x69, 0x63,
-  0x65, 0x5f, 0x62, 0x75, 0x66, 0x66, 0x65, 0x72, 0x73, 0x61, 0x69, 0x72,
-  0x2e, 0x6d, 0x61, 0x78, 0x5f, 0x63, 0x6f, 0x6e, 0x73, 0x74, 0x61, 0x6e,
-  0x74, 0x5f, 0x62, 0x75, 0x66, 0x66, 0x65, 0x72, 0x73, 0x61, 0x69, 0x72,
-  0x2e, 0x6d, 0x61, 0x78, 0x5f, 0x74, 0x68, 0x72, 0x65, 0x61, 0x64, 0x67,
-  0x72, 0x6f, 0x75, 0x70, 0x5f, 0x62, 0x75, 0x66, 0x66, 0x65, 0x72, 0x73,
-  0x61, 0x69, 0x72, 0x2e, 0x6d, 0x61, 0x78, 0x5f, 0x74, 0x65, 0x78, 0x74,
-  0x75, 0x72, 0x65, 0x73, 0x61, 0x69, 0x72, 0x2e, 0x6d, 0x61, 0x78, 0x5f,
-  0x72, 0x65, 0x61, 0x64, 0x5f, 0x77, 0x72, 0x69, 0x74, 0x65, 0x5f, 0x74,
-  0x65, 0x78, 0x74, 0x75, 0x72, 0x65, 0x73, 0x61, 0x69, 0x72, 0x2e, 0x6d,
-  0x61, 0x78, 0x5f, 0x73, 0x61, 0x6d, 0x70, 0x6c, 0x65, 0x72, 0x73, 0x41,
-  0x70, 0x70, 0x6c, 0x65, 0x20, 0x4c, 0x4c, 0x56, 0x4d, 0x20, 0x76, 0x65,
-  0x72, 0x73, 0x69, 0x6f, 0x6e, 0x20, 0x33, 0x31, 0x30, 0x30, 0x31, 0x2e,
-  0x31, 0x38, 0x34, 0x20, 0x28, 0x6d, 0x65, 0x74, 0x61, 0x6c, 0x66, 0x65,
-  0x2d, 0x33, 0x31, 0x30, 0x30, 0x31, 0x2e, 0x31, 0x38, 0x34, 0x29, 0x4d,
-  0x65, 0x74, 0x61, 0x6c, 0x61, 0x69, 0x72, 0x2e, 0x63, 0x6f, 0x6d, 0x70,
-  0x69, 0x6c, 0x65, 0x2e, 0x64, 0x65, 0x6e, 0x6f, 0x72, 0x6d, 0x73, 0x5f,
-  0x64, 0x69, 0x73, 0x61, 0x62, 0x6c, 0x65, 0x61, 0x69, 0x72, 0x2e, 0x63,
-  0x6f, 0x6d, 0x70, 0x69, 0x6c, 0x65, 0x2e, 0x66, 0x61, 0x73, 0x74, 0x5f,
-  0x6d, 0x61, 0x74, 0x68, 0x5f, 0x65, 0x6e, 0x61, 0x62, 0x6c, 0x65, 0x61,
-  0x69, 0x72, 0x2e, 0x63, 0x6f, 0x6d, 0x70, 0x69, 0x6c, 0x65, 0x2e, 0x66,
-  0x72, 0x61, 0x6d, 0x65, 0x62, 0x75, 0x66, 0x66, 0x65, 0x72, 0x5f, 0x66,
-  0x65, 0x74, 0x63, 0x68, 0x5f, 0x65, 0x6e, 0x61, 0x62, 0x6c, 0x65, 0x61,
-  0x69, 0x72, 0x2e, 0x70, 0x6f, 0x73, 0x69, 0x74, 0x69, 0x6f, 0x6e, 0x61,
-  0x69, 0x72, 0x2e, 0x61, 0x72, 0x67, 0x5f, 0x74, 0x79, 0x70, 0x65, 0x5f,
-  0x6e, 0x61, 0x6d, 0x65, 0x66, 0x6c, 0x6f, 0x61, 0x74, 0x34, 0x61, 0x69,
-  0x72, 0x2e, 0x61, 0x72, 0x67, 0x5f, 0x6e, 0x61, 0x6d, 0x65, 0x70, 0x6f,
-  0x73, 0x69, 0x74, 0x69, 0x6f, 0x6e, 0x61, 0x69, 0x72, 0x2e, 0x76, 0x65,
-  0x72, 0x74, 0x65, 0x78, 0x5f, 0x6f, 0x75, 0x74, 0x70, 0x75, 0x74, 0x67,
-  0x65, 0x6e, 0x65, 0x72, 0x61, 0x74, 0x65, 0x64, 0x28, 0x35, 0x63, 0x6f,
-  0x6c, 0x6f, 0x72, 0x44, 0x76, 0x34, 0x5f, 0x44, 0x68, 0x29, 0x68, 0x61,
-  0x6c, 0x66, 0x34, 0x63, 0x6f, 0x6c, 0x6f, 0x72, 0x67, 0x65, 0x6e, 0x65,
-  0x72, 0x61, 0x74, 0x65, 0x64, 0x28, 0x36, 0x6e, 0x6f, 0x72, 0x6d, 0x61,
-  0x6c, 0x44, 0x76, 0x33, 0x5f, 0x44, 0x68, 0x29, 0x68, 0x61, 0x6c, 0x66,
-  0x33, 0x6e, 0x6f, 0x72, 0x6d, 0x61, 0x6c, 0x67, 0x65, 0x6e, 0x65, 0x72,
-  0x61, 0x74, 0x65, 0x64, 0x28, 0x36, 0x6d, 0x61, 0x74, 0x5f, 0x69, 0x64,
-  0x74, 0x29, 0x75, 0x73, 0x68, 0x6f, 0x72, 0x74, 0x6d, 0x61, 0x74, 0x5f,
-  0x69, 0x64, 0x67, 0x65, 0x6e, 0x65, 0x72, 0x61, 0x74, 0x65, 0x64, 0x28,
-  0x32, 0x75, 0x76, 0x44, 0x76, 0x32, 0x5f, 0x66, 0x29, 0x66, 0x6c, 0x6f,
-  0x61, 0x74, 0x32, 0x75, 0x76, 0x61, 0x69, 0x72, 0x2e, 0x69, 0x6e, 0x64,
-  0x69, 0x72, 0x65, 0x63, 0x74, 0x5f, 0x62, 0x75, 0x66, 0x66, 0x65, 0x72,
-  0x61, 0x69, 0x72, 0x2e, 0x62, 0x75, 0x66, 0x66, 0x65, 0x72, 0x5f, 0x73,
-  0x69, 0x7a, 0x65, 0x61, 0x69, 0x72, 0x2e, 0x6c, 0x6f, 0x63, 0x61, 0x74,
-  0x69, 0x6f, 0x6e, 0x5f, 0x69, 0x6e, 0x64, 0x65, 0x78, 0x61, 0x69, 0x72,
-  0x2e, 0x72, 0x65, 0x61, 0x64, 0x61, 0x69, 0x72, 0x2e, 0x73, 0x74, 0x72,
-  0x75, 0x63, 0x74, 0x5f, 0x74, 0x79, 0x70, 0x65, 0x5f, 0x69, 0x6e, 0x66,
-  0x6f, 0x56, 0x65, 0x72, 0x74, 0x65, 0x78, 0x33, 0x44, 0x76, 0x65, 0x72,
-  0x74, 0x69, 0x63, 0x65, 0x73, 0x61, 0x69, 0x72, 0x2e, 0x69, 0x6e, 0x64,
-  0x69, 0x72, 0x65, 0x63, 0x74, 0x5f, 0x61, 0x72, 0x67, 0x75, 0x6d, 0x65,
-  0x6e, 0x74, 0x61, 0x69, 0x72, 0x2e, 0x62, 0x75, 0x66, 0x66, 0x65, 0x72,
-  0x66, 0x6c, 0x6f, 0x61, 0x74, 0x76, 0x5f, 0x78, 0x76, 0x5f, 0x79, 0x76,
-  0x5f, 0x7a, 0x76, 0x5f, 0x77, 0x6e, 0x5f, 0x78, 0x6e, 0x5f, 0x79, 0x6e,
-  0x5f, 0x7a, 0x75, 0x69, 0x6e, 0x74, 0x75, 0x76, 0x70, 0x61, 0x64, 0x30,
-  0x70, 0x61, 0x64, 0x31, 0x74, 0x5f, 0x78, 0x74, 0x5f, 0x79, 0x74, 0x5f,
-  0x7a, 0x74, 0x5f, 0x77, 0x61, 0x69, 0x72, 0x2e, 0x61, 0x72, 0x67, 0x5f,
-  0x74, 0x79, 0x70, 0x65, 0x5f, 0x73, 0x69, 0x7a, 0x65, 0x61, 0x69, 0x72,
-  0x2e, 0x61, 0x72, 0x67, 0x5f, 0x74, 0x79, 0x70, 0x65, 0x5f, 0x61, 0x6c,
-  0x69, 0x67, 0x6e, 0x5f, 0x73, 0x69, 0x7a, 0x65, 0x56, 0x65, 0x72, 0x74,
-  0x65, 0x78, 0x32, 0x44, 0x76, 0x65, 0x72, 0x74, 0x69, 0x63, 0x65, 0x73,
-  0x5f, 0x32, 0x64, 0x74, 0x65, 0x78, 0x63, 0x5f, 0x72, 0x63, 0x5f, 0x67,
-  0x63, 0x5f, 0x62, 0x63, 0x5f, 0x61, 0x54, 0x65, 0x78, 0x74, 0x75, 0x72,
-  0x65, 0x74, 0x65, 0x78, 0x74, 0x75, 0x72, 0x65, 0x73, 0x74, 0x65, 0x78,
-  0x74, 0x75, 0x72, 0x65, 0x32, 0x64, 0x3c, 0x66, 0x6c, 0x6f, 0x61, 0x74,
-  0x2c, 0x20, 0x73, 0x61, 0x6d, 0x70, 0x6c, 0x65, 0x3e, 0x61, 0x69, 0x72,
-  0x2e, 0x74, 0x65, 0x78, 0x74, 0x75, 0x72, 0x65, 0x61, 0x69, 0x72, 0x2e,
-  0x73, 0x61, 0x6d, 0x70, 0x6c, 0x65, 0x44, 0x65, 0x76, 0x69, 0x63, 0x65,
-  0x4d, 0x61, 0x74, 0x65, 0x72, 0x69, 0x61, 0x6c, 0x6d, 0x61, 0x74, 0x65,
-  0x72, 0x69, 0x61, 0x6c, 0x73, 0x61, 0x5f, 0x72, 0x61, 0x5f, 0x67, 0x61,
-  0x5f, 0x62, 0x61, 0x5f, 0x61, 0x73, 0x5f, 0x72, 0x73, 0x5f, 0x67, 0x73,
-  0x5f, 0x62, 0x73, 0x5f, 0x61, 0x70, 0x61, 0x72, 0x61, 0x6d, 0x73, 0x5f,
-  0x78, 0x70, 0x61, 0x72, 0x61, 0x6d, 0x73, 0x5f, 0x79, 0x70, 0x61, 0x72,
-  0x61, 0x6d, 0x73, 0x5f, 0x7a, 0x70, 0x61, 0x72, 0x61, 0x6d, 0x73, 0x5f,
-  0x77, 0x66, 0x6c, 0x61, 0x67, 0x73, 0x69, 0x6e, 0x74, 0x64, 0x69, 0x66,
-  0x66, 0x75, 0x73, 0x65, 0x5f, 0x6d, 0x61, 0x70, 0x6e, 0x6f, 0x72, 0x6d,
-  0x61, 0x6c, 0x5f, 0x6d, 0x61, 0x70, 0x6d, 0x65, 0x74, 0x61, 0x6c, 0x6c,
-  0x69, 0x63, 0x5f, 0x72, 0x6f, 0x75, 0x67, 0x68, 0x6e, 0x65, 0x73, 0x73,
-  0x5f, 0x6d, 0x61, 0x70, 0x65, 0x6d, 0x69, 0x73, 0x73, 0x69, 0x76, 0x65,
-  0x5f, 0x6d, 0x61, 0x70, 0x73, 0x68, 0x65, 0x65, 0x6e, 0x5f, 0x6d, 0x61,
-  0x70, 0x70, 0x61, 0x64, 0x32, 0x49, 0x6e, 0x73, 0x74, 0x61, 0x6e, 0x63,
-  0x65, 0x54, 0x72, 0x61, 0x6e, 0x73, 0x66, 0x6f, 0x72, 0x6d, 0x69, 0x6e,
-  0x73, 0x74, 0x61, 0x6e, 0x63, 0x65, 0x73, 0x66, 0x6c, 0x6f, 0x61, 0x74,
-  0x34, 0x78, 0x34, 0x6d, 0x61, 0x74, 0x72, 0x69, 0x78, 0x6e, 0x6f, 0x72,
-  0x6d, 0x61, 0x6c, 0x5f, 0x6d, 0x61, 0x74, 0x72, 0x69, 0x78, 0x69, 0x6e,
-  0x73, 0x74, 0x61, 0x6e, 0x63, 0x65, 0x73, 0x5f, 0x32, 0x64, 0x53, 0x63,
-  0x65, 0x6e, 0x65, 0x73, 0x63, 0x65, 0x6e, 0x65, 0x70, 0x72, 0x6f, 0x6a,
-  0x65, 0x63, 0x74, 0x69, 0x6f, 0x6e, 0x76, 0x69, 0x65, 0x77, 0x5f, 0x6d,
-  0x61, 0x74, 0x72, 0x69, 0x78, 0x63, 0x6f, 0x6d, 0x62, 0x69, 0x6e, 0x65,
-  0x64, 0x6d, 0x61, 0x74, 0x72, 0x69, 0x78, 0x5f, 0x32, 0x64, 0x70, 0x6f,
-  0x73, 0x5f, 0x78, 0x70, 0x6f, 0x73, 0x5f, 0x79, 0x70, 0x6f, 0x73, 0x5f,
-  0x7a, 0x72, 0x69, 0x67, 0x68, 0x74, 0x5f, 0x78, 0x72, 0x69, 0x67, 0x68,
-  0x74, 0x5f, 0x79, 0x72, 0x69, 0x67, 0x68, 0x74, 0x5f, 0x7a, 0x75, 0x70,
-  0x5f, 0x78, 0x75, 0x70, 0x5f, 0x79, 0x75, 0x70, 0x5f, 0x7a, 0x70, 0x31,
-  0x5f, 0x78, 0x70, 0x31, 0x5f, 0x79, 0x70, 0x31, 0x5f, 0x7a, 0x64, 0x69,
-  0x72, 0x65, 0x63, 0x74, 0x69, 0x6f, 0x6e, 0x5f, 0x78, 0x64, 0x69, 0x72,
-  0x65, 0x63, 0x74, 0x69, 0x6f, 0x6e, 0x5f, 0x79, 0x64, 0x69, 0x72, 0x65,
-  0x63, 0x74, 0x69, 0x6f, 0x6e, 0x5f, 0x7a, 0x6c, 0x65, 0x6e, 0x73, 0x5f,
-  0x73, 0x69, 0x7a, 0x65, 0x73, 0x70, 0x72, 0x65, 0x61, 0x64, 0x5f, 0x61,
-  0x6e, 0x67, 0x6c, 0x65, 0x69, 0x6e, 0x76, 0x5f, 0x77, 0x69, 0x64, 0x74,
-  0x68, 0x69, 0x6e, 0x76, 0x5f, 0x68, 0x65, 0x69, 0x67, 0x68, 0x74, 0x6e,
-  0x65, 0x61, 0x72, 0x5f, 0x70, 0x6c, 0x61, 0x6e, 0x65, 0x66, 0x61, 0x72,
-  0x5f, 0x70, 0x6c, 0x61, 0x6e, 0x65, 0x61, 0x73, 0x70, 0x65, 0x63, 0x74,
-  0x5f, 0x72, 0x61, 0x74, 0x69, 0x6f, 0x66, 0x6f, 0x76, 0x43, 0x61, 0x6d,
-  0x65, 0x72, 0x61, 0x56, 0x69, 0x65, 0x77, 0x76, 0x69, 0x65, 0x77, 0x55,
-  0x6e, 0x69, 0x66, 0x6f, 0x72, 0x6d, 0x43, 0x61, 0x6d, 0x65, 0x72, 0x61,
-  0x63, 0x61, 0x6d, 0x65, 0x72, 0x61, 0x61, 0x69, 0x72, 0x2e, 0x76, 0x65,
-  0x72, 0x74, 0x65, 0x78, 0x5f, 0x69, 0x64, 0x76, 0x69, 0x64, 0x61, 0x69,
-  0x72, 0x2e, 0x69, 0x6e, 0x73, 0x74, 0x61, 0x6e, 0x63, 0x65, 0x5f, 0x69,
-  0x64, 0x69, 0x5f, 0x69, 0x64, 0x00, 0x26, 0x53, 0x02, 0x00, 0x00, 0x00,
-  0x00, 0x00, 0x30, 0x82, 0x80, 0x14, 0x23, 0x08, 0x6c, 0x80, 0x07, 0x23,
-  0x08, 0x88, 0x31, 0x82, 0x80, 0x1c, 0x23, 0x08, 0x08, 0x32, 0x82, 0x80,
-  0x24, 0x23, 0x08, 0x88, 0x32, 0x82, 0x80, 0x2c, 0x23, 0x08, 0x08, 0x33,
-  0x82, 0x80, 0x34, 0x23, 0x08, 0x88, 0x33, 0x82, 0x10, 0x06, 0xc0, 0x08,
-  0x02, 0xf2, 0x8c, 0x20, 0x20, 0xd0, 0x08, 0x02, 0x12, 0x8d, 0x20, 0x20,
-  0xd2, 0x08, 0x02, 0x32, 0x8d, 0x20, 0x20, 0xd4, 0x08, 0x02, 0x52, 0x8d,
-  0x20, 0x20, 0xd6, 0x08, 0x02, 0x72, 0x8d, 0x20, 0x20, 0xd8, 0x08, 0x02,
-  0x92, 0x8d, 0x20, 0x20, 0xda, 0x08, 0x02, 0xb2, 0x8d, 0x20, 0x20, 0xdc,
-  0x08, 0x02, 0xd2, 0x8d, 0x20, 0x20, 0xde, 0x08, 0x02, 0xf2, 0x8d, 0x20,
-  0x20, 0x60, 0x30, 0x82, 0x80, 0x84, 0xc1, 0x08, 0x02, 0x22, 0x06, 0x23,
-  0x08, 0xc8, 0x18, 0x8c, 0x20, 0x20, 0x64, 0x30, 0x82, 0x80, 0x94, 0xc1,
-  0x08, 0x02, 0x62, 0x06, 0x23, 0x08, 0xc8, 0x19, 0xcc, 0x30, 0xa4, 0x44,
-  0xa0, 0x12, 0x33, 0x0c, 0x2b, 0x21, 0xb0, 0xc4, 0x0c, 0x43, 0x4b, 0x0c,
-  0x2e, 0x31, 0xc3, 0xd0, 0x12, 0x84, 0x4b, 0xcc, 0x30, 0xb4, 0x44, 0xe1,
-  0x12, 0x33, 0x0c, 0x2d, 0x61, 0xbc, 0xc4, 0x0c, 0x43, 0x4b, 0x1c, 0x30,
-  0x31, 0xc3, 0xd0, 0x12, 0x48, 0x4c, 0xcc, 0x10, 0x24, 0x33, 0x0c, 0x29,
-  0x21, 0x13, 0x33, 0x31, 0x03, 0xa1, 0xa4, 0x84, 0x4c, 0xcc, 0xc4, 0x0c,
-  0xc1, 0x32, 0x43, 0xc0, 0xcc, 0x10, 0x34, 0x33, 0x14, 0xce, 0x03, 0x45,
-  0xd2, 0x0c, 0xc6, 0x44, 0x3d, 0x55, 0x64, 0xcd, 0x60, 0x4c, 0xd7, 0x83,
-  0x45, 0xd9, 0x0c, 0xc6, 0xa4, 0x3d, 0x5b, 0xc4, 0xcd, 0x60, 0x4c, 0xdd,
-  0xe3, 0x45, 0xdf, 0x0c, 0x05, 0x5f, 0xf4, 0x85, 0x5f, 0xfc, 0x05, 0x68,
-  0xcc, 0x00, 0x0b, 0x33, 0xc1, 0x12, 0x33, 0x91, 0x06, 0x6a, 0xc0, 0x12,
-  0x2c, 0x31, 0x13, 0x69, 0xb0, 0x06, 0x30, 0xc1, 0x12, 0x33, 0x91, 0x06,
-  0x6c, 0x60, 0x13, 0x2c, 0x31, 0x13, 0x69, 0xd0, 0x06, 0x31, 0xc1, 0x12,
-  0x33, 0x91, 0x06, 0x6e, 0x70, 0x13, 0x2c, 0x31, 0x13, 0x69, 0xf0, 0x06,
-  0x38, 0xc1, 0x12, 0x33, 0x91, 0x06, 0x70, 0x90, 0x13, 0x2c, 0x31, 0x13,
-  0x71, 0xc0, 0xe9, 0x04, 0x4b, 0xcc, 0x44, 0x1a, 0xc8, 0xc1, 0x4e, 0xb0,
-  0xc4, 0x4c, 0xa4, 0xc1, 0x1c, 0xf0, 0x04, 0x4b, 0xcc, 0x44, 0x1a, 0xd0,
-  0x41, 0x4f, 0xb0, 0xc4, 0x4c, 0xa4, 0x41, 0x1d, 0xd4, 0x04, 0x4b, 0xcc,
-  0x44, 0x1a, 0xd8, 0x81, 0x4f, 0xb0, 0xc4, 0x4c, 0xa4, 0xc1, 0x1d, 0xfc,
-  0x04, 0x4b, 0xcc, 0x44, 0x1a, 0xe0, 0x01, 0x58, 0xb0, 0xc4, 0x4c, 0xa4,
-  0x41, 0x1e, 0xcc, 0x00, 0xcd, 0x04, 0x1a, 0x88, 0xc1, 0x4c, 0xac, 0xc4,
-  0x18, 0x90, 0x81, 0x68, 0xe8, 0x41, 0x58, 0xec, 0x01, 0x4b, 0x3c, 0x65,
-  0x10, 0x99, 0xc1, 0x0c, 0x72, 0x30, 0x13, 0x2c, 0x31, 0x13, 0x69, 0xa0,
-  0x06, 0x2c, 0xc1, 0x12, 0x33, 0x91, 0x06, 0x6b, 0x00, 0x13, 0x2c, 0x31,
-  0x13, 0x69, 0xc0, 0x06, 0x36, 0xc1, 0x12, 0x33, 0x11, 0x07, 0x7e, 0x10,
-  0x13, 0x2c, 0x31, 0x13, 0x69, 0x20, 0x07, 0x37, 0xc1, 0x12, 0x33, 0x91,
-  0x06, 0x73, 0x80, 0x13, 0x2c, 0x31, 0x13, 0x69, 0xf0, 0x07, 0x39, 0xc1,
-  0x12, 0x33, 0x91, 0x06, 0xa0, 0xa0, 0x13, 0x2c, 0x31, 0x13, 0x69, 0x10,
-  0x0a, 0x3b, 0xc1, 0x12, 0x33, 0x91, 0x06, 0xa2, 0x30, 0x03, 0xb4, 0x12,
-  0x68, 0x20, 0x06, 0x2b, 0xb1, 0x12, 0x63, 0x40, 0x06, 0xa4, 0xa1, 0x07,
-  0x3c, 0xb1, 0x07, 0x2c, 0xf1, 0xf0, 0x41, 0xd4, 0x07, 0x33, 0x28, 0x33,
-  0x61, 0x0a, 0x62, 0x30, 0x13, 0x2b, 0x71, 0x0a, 0x4f, 0x29, 0x44, 0x7e,
-  0x30, 0xc3, 0x31, 0x13, 0x30, 0x31, 0x13, 0xa5, 0xe0, 0x07, 0x67, 0x60,
-  0x1a, 0x33, 0x40, 0x29, 0x01, 0x06, 0x62, 0x90, 0x12, 0x2b, 0x31, 0x06,
-  0x64, 0x70, 0x1a, 0x7a, 0x00, 0x13, 0x7b, 0x00, 0x13, 0xcf, 0x28, 0x44,
-  0xa4, 0x30, 0x03, 0x3e, 0xcc, 0x04, 0x4b, 0xcc, 0x44, 0x1a, 0xfc, 0x01,
-  0x4b, 0xb0, 0xc4, 0x4c, 0xa4, 0x01, 0x28, 0xc0, 0x04, 0x4b, 0xcc, 0x44,
-  0x1a, 0x84, 0x82, 0x4d, 0xb0, 0xc4, 0x4c, 0xa4, 0x81, 0x28, 0xc4, 0x04,
-  0x4b, 0xcc, 0x44, 0x1a, 0xa8, 0xc2, 0x4d, 0xb0, 0xc4, 0x4c, 0xa4, 0xc1,
-  0x2a, 0xe0, 0x04, 0x4b, 0xcc, 0x44, 0x1a, 0xb0, 0x42, 0x4e, 0xb0, 0xc4,
-  0x4c, 0xa4, 0x41, 0x2b, 0xe8, 0x04, 0x4b, 0xcc, 0x44, 0x1a, 0xb8, 0xc2,
-  0x4e, 0xb0, 0xc4, 0x4c, 0xa4, 0xc1, 0x2b, 0xf0, 0x04, 0x4b, 0xcc, 0x44,
-  0x1a, 0xc0, 0x42, 0x4f, 0xb0, 0xc4, 0x4c, 0xa4, 0x41, 0x2c, 0xd4, 0x04,
-  0x4b, 0xcc, 0x44, 0x1c, 0xc8, 0x82, 0x4f, 0xb0, 0xc4, 0x4c, 0xc4, 0xc1,
-  0x2c, 0xfc, 0x04, 0x4b, 0xcc, 0x44, 0x1c, 0xd0, 0x02, 0x58, 0xb0, 0xc4,
-  0x4c, 0xc4, 0x41, 0x2d, 0x84, 0x05, 0x4b, 0xcc, 0x44, 0x1c, 0xd8, 0x82,
-  0x58, 0xb0, 0xc4, 0x4c, 0xdc, 0x02, 0x2e, 0x8c, 0x05, 0x4b, 0xcc, 0xc4,
-  0x2d, 0xe4, 0x02, 0x59, 0xb0, 0xc4, 0x4c, 0xdc, 0x82, 0x2e, 0x94, 0x05,
-  0x4b, 0xcc, 0xc4, 0x2d, 0xec, 0x82, 0x59, 0xb0, 0xc4, 0x4c, 0xdc, 0x02,
-  0x2f, 0x9c, 0x05, 0x4b, 0xcc, 0x44, 0x1a, 0xd4, 0x01, 0x5a, 0xb0, 0xc4,
-  0x4c, 0xa4, 0x41, 0x2f, 0xcc, 0x00, 0xc9, 0x04, 0x1a, 0x88, 0x81, 0x4c,
-  0xac, 0xc4, 0x18, 0x90, 0x41, 0x6a, 0xe8, 0x41, 0x5a, 0xec, 0x01, 0x4b,
-  0x3c, 0xa8, 0x10, 0xa5, 0xc2, 0x0c, 0xca, 0x4c, 0x84, 0xc5, 0x4c, 0x80,
-  0x43, 0x38, 0x84, 0x45, 0x58, 0xcc, 0x04, 0x38, 0x88, 0xc3, 0x0c, 0x10,
-  0x4b, 0xa0, 0x81, 0x18, 0xb0, 0xc4, 0x4a, 0x8c, 0x01, 0x19, 0xac, 0x86,
-  0x1e, 0xbc, 0xc4, 0x1e, 0xc4, 0xc4, 0xe3, 0x0b, 0xd1, 0x2f, 0xcc, 0xe0,
-  0xa8, 0x05, 0x1a, 0x88, 0x81, 0x5a, 0xac, 0xc4, 0x18, 0xe8, 0x41, 0x58,
-  0xec, 0x41, 0x4c, 0x3c, 0xe0, 0x10, 0x8d, 0xc3, 0x0c, 0x6a, 0x30, 0x13,
-  0x30, 0x31, 0x13, 0x65, 0x60, 0x06, 0x67, 0x30, 0x1a, 0x30, 0x01, 0x13,
-  0x33, 0xc1, 0x07, 0x7d, 0x70, 0x06, 0xa5, 0x11, 0x13, 0x30, 0x31, 0x13,
-  0xa3, 0x40, 0x0a, 0x67, 0x80, 0x1a, 0x38, 0x01, 0x13, 0x33, 0x81, 0x0a,
-  0xa9, 0x70, 0x06, 0xaa, 0xa1, 0x13, 0x30, 0x31, 0x13, 0xbe, 0xf0, 0x0b,
-  0x67, 0xc0, 0x1a, 0x3c, 0x01, 0x13, 0x33, 0x01, 0x0e, 0xe3, 0x70, 0x06,
-  0xad, 0x31, 0x83, 0x34, 0x13, 0x60, 0x10, 0x06, 0x35, 0x21, 0x06, 0x33,
-  0xb1, 0x12, 0x63, 0x40, 0x06, 0xae, 0xa1, 0x07, 0x35, 0xb1, 0x07, 0x30,
-  0xf1, 0x90, 0x43, 0x54, 0x0e, 0x33, 0xcc, 0xc3, 0x4c, 0xb0, 0xc4, 0x4c,
-  0xa4, 0x81, 0x3a, 0xb0, 0x04, 0x4b, 0xcc, 0x44, 0x1a, 0xac, 0x03, 0x4c,
-  0xb0, 0xc4, 0x4c, 0xa4, 0x01, 0x3b, 0xd8, 0x04, 0x4b, 0xcc, 0x44, 0x1a,
-  0xb4, 0x43, 0x4c, 0xb0, 0xc4, 0x4c, 0xa4, 0x81, 0x3b, 0xdc, 0x04, 0x4b,
-  0xcc, 0x44, 0x1a, 0xbc, 0x03, 0x4e, 0xb0, 0xc4, 0x4c, 0xa4, 0x01, 0x3c,
-  0xe4, 0x04, 0x4b, 0xcc, 0x44, 0x1a, 0xc4, 0x83, 0x4e, 0xb0, 0xc4, 0x4c,
-  0xa4, 0x81, 0x3c, 0xec, 0x04, 0x4b, 0xcc, 0x44, 0x1a, 0xcc, 0x03, 0x4f,
-  0xb0, 0xc4, 0x4c, 0xa4, 0x01, 0x3d, 0xf4, 0x04, 0x4b, 0xcc, 0x44, 0x1a,
-  0xd4, 0x43, 0x4d, 0xb0, 0xc4, 0x4c, 0xa4, 0x81, 0x3d, 0xf8, 0x04, 0x4b,
-  0xcc, 0x44, 0x1a, 0xdc, 0xc3, 0x4f, 0xb0, 0xc4, 0x4c, 0xa4, 0x01, 0x3e,
-  0x80, 0x05, 0x4b, 0xcc, 0x44, 0x1a, 0xe4, 0x43, 0x58, 0xb0, 0xc4, 0x4c,
-  0xa4, 0x81, 0x3e, 0x88, 0x05, 0x4b, 0xcc, 0x44, 0x1a, 0xec, 0xc3, 0x58,
-  0xb0, 0xc4, 0x4c, 0xa4, 0x01, 0x3f, 0x90, 0x05, 0x4b, 0xcc, 0x44, 0x1a,
-  0xf4, 0x43, 0x59, 0xb0, 0xc4, 0x4c, 0xa4, 0x81, 0x3f, 0x98, 0x05, 0x4b,
-  0xcc, 0x44, 0x1a, 0xfc, 0xc3, 0x59, 0xb0, 0xc4, 0x4c, 0xa4, 0x01, 0x48,
-  0xcc, 0xb0, 0xcd, 0x44, 0x58, 0xcc, 0x04, 0x38, 0x98, 0x43, 0x58, 0x84,
-  0xc5, 0x4c, 0x80, 0xc3, 0x39, 0xbc, 0x44, 0x58, 0xcc, 0x04, 0x38, 0xa0,
-  0xc3, 0x5a, 0x84, 0xc5, 0x4c, 0x80, 0x43, 0x3a, 0x90, 0x01, 0x6c, 0xb0,
-  0x05, 0x5a, 0xcc, 0x44, 0x48, 0x88, 0xc4, 0x0c, 0xd0, 0x4a, 0xa0, 0x81,
-  0x18, 0xac, 0xc4, 0x4a, 0x8c, 0x01, 0x19, 0xc4, 0x86, 0x1e, 0xb4, 0xc5,
-  0x1e, 0xc4, 0xc4, 0x33, 0x12, 0x11, 0x49, 0xcc, 0x60, 0xa4, 0x44, 0x49,
-  0x3c, 0x71, 0x10, 0x99, 0xc4, 0x0c, 0x86, 0x4c, 0x9c, 0xc4, 0x13, 0x07,
-  0x11, 0x4a, 0xcc, 0x40, 0xbc, 0x86, 0x6c, 0xcc, 0x06, 0x6d, 0xcc, 0x30,
-  0xd0, 0x44, 0x68, 0xd4, 0xc6, 0xb9, 0x02, 0xc0, 0xa1, 0x01, 0xc7, 0x71,
-  0x1c, 0xc7, 0x71, 0x1c, 0x27, 0x06, 0x1c, 0xc7, 0x71, 0x1c, 0xc7, 0x71,
-  0x1c, 0xc7, 0x71, 0x1c, 0xc7, 0x71, 0x9c, 0x18, 0x88, 0x81, 0x18, 0x88,
-  0x81, 0x18, 0x88, 0x81, 0x18, 0x88, 0x81, 0x1b, 0xb8, 0x81, 0x1b, 0xb8,
-  0x81, 0x1b, 0xb8, 0x81, 0x1b, 0xb8, 0x81, 0x45, 0x07, 0x7a, 0x60, 0x59,
-  0x96, 0x1b, 0xd0, 0x01, 0x1d, 0xd0, 0x01, 0x1d, 0xb0, 0x02, 0xec, 0x91,
-  0x86, 0x3b, 0x91, 0x06, 0x3f, 0x90, 0x03, 0x69, 0xd8, 0x6d, 0x40, 0x1a,
-  0x28, 0x41, 0x1a, 0x6c, 0xe1, 0x42, 0xbc, 0xa1, 0xaf, 0x01, 0xad, 0x90,
-  0x06, 0x2b, 0xb0, 0x02, 0x28, 0xc8, 0x48, 0x60, 0x82, 0x32, 0x62, 0x63,
-  0xb3, 0x6b, 0x73, 0x69, 0x7b, 0x23, 0xab, 0x63, 0x2b, 0x73, 0x31, 0x63,
-  0x0b, 0x3b, 0x9b, 0x1b, 0x05, 0x69, 0x0b, 0xb7, 0x78, 0x0b, 0xb8, 0x88,
-  0x0b, 0xb9, 0x98, 0x0b, 0xba, 0x48, 0x85, 0x8d, 0xcd, 0xae, 0xcd, 0x25,
-  0x8d, 0xac, 0xcc, 0x8d, 0x6e, 0x94, 0xa0, 0x2e, 0x72, 0x09, 0x4b, 0x93,
-  0x73, 0xb1, 0x2b, 0x93, 0x9b, 0x4b, 0x7b, 0x73, 0x1b, 0x25, 0xb0, 0x8b,
-  0xa4, 0xc2, 0xd2, 0xe4, 0x5c, 0xd8, 0xc2, 0xdc, 0xce, 0xea, 0xc2, 0xce,
-  0xca, 0xbe, 0xec, 0xca, 0xe4, 0xe6, 0xd2, 0xde, 0xdc, 0x46, 0x09, 0xee,
-  0x22, 0xa7, 0xb0, 0x34, 0x39, 0x97, 0xb1, 0xb7, 0x36, 0xb8, 0x34, 0xb6,
-  0xb2, 0xaf, 0x37, 0x38, 0xba, 0xb4, 0x37, 0xb7, 0xb9, 0x51, 0x06, 0xbc,
-  0xc8, 0x0b, 0xbd, 0x48, 0x25, 0x2c, 0x4d, 0xce, 0xc5, 0xae, 0x4c, 0x8e,
-  0xae, 0x0c, 0x6f, 0x94, 0xa0, 0x36, 0x00, 0x00, 0x00, 0x00, 0xa9, 0x18,
-  0x00, 0x00, 0x0b, 0x00, 0x00, 0x00, 0x0b, 0x0a, 0x72, 0x28, 0x87, 0x77,
-  0x80, 0x07, 0x7a, 0x58, 0x70, 0x98, 0x43, 0x3d, 0xb8, 0xc3, 0x38, 0xb0,
-  0x43, 0x39, 0xd0, 0xc3, 0x82, 0xe6, 0x1c, 0xc6, 0xa1, 0x0d, 0xe8, 0x41,
-  0x1e, 0xc2, 0xc1, 0x1d, 0xe6, 0x21, 0x1d, 0xe8, 0x21, 0x1d, 0xde, 0xc1,
-  0x1d, 0x00, 0xd1, 0x10, 0x00, 0x00, 0x06, 0x00, 0x00, 0x00, 0x07, 0xcc,
-  0x3c, 0xa4, 0x83, 0x3b, 0x9c, 0x03, 0x3b, 0x94, 0x03, 0x3d, 0xa0, 0x83,
-  0x3c, 0x94, 0x43, 0x38, 0x90, 0xc3, 0x01, 0x00, 0x00, 0x00, 0x61, 0x20,
-  0x00, 0x00, 0x36, 0x01, 0x00, 0x00, 0x13, 0x04, 0x41, 0x2c, 0x10, 0x00,
-  0x00, 0x00, 0x11, 0x00, 0x00, 0x00, 0x84, 0x14, 0xc3, 0x0c, 0x40, 0x49,
-  0x50, 0x5b, 0x02, 0x45, 0x50, 0x06, 0x24, 0x8f, 0x00, 0x8c, 0x45, 0x04,
-  0x41, 0x10, 0x8c, 0x45, 0x08, 0x82, 0x20, 0x8c, 0x45, 0x0c, 0xc3, 0x30,
-  0xcc, 0x41, 0x38, 0x46, 0xe1, 0x07, 0x34, 0x8f, 0x35, 0x00, 0x81, 0x30,
-  0x02, 0x40, 0xc0, 0x18, 0x41, 0x6b, 0xce, 0x39, 0xf9, 0x51, 0x30, 0x03,
-  0x40, 0xc6, 0x0c, 0x00, 0x1d, 0x33, 0x00, 0x24, 0xce, 0x00, 0x00, 0x00,
-  0x00, 0x00, 0xf1, 0x30, 0x00, 0x00, 0x56, 0x00, 0x00, 0x00, 0x22, 0x47,
-  0xc8, 0x90, 0x51, 0x16, 0x04, 0x29, 0x00, 0x00, 0x00, 0x00, 0xca, 0xf2,
-  0x3c, 0x0d, 0x5f, 0x5a, 0x54, 0x53, 0x35, 0x53, 0x63, 0x65, 0x6e, 0x65,
-  0x61, 0x6e, 0x79, 0x20, 0x70, 0x6f, 0x69, 0x6e, 0x74, 0x65, 0x72, 0x6f,
-  0x6d, 0x6e, 0x69, 0x70, 0x6f, 0x74, 0x65, 0x6e, 0x74, 0x20, 0x63, 0x68,
-  0x61, 0x72, 0x53, 0x69, 0x6d, 0x70, 0x6c, 0x65, 0x20, 0x43, 0x2b, 0x2b,
-  0x20, 0x54, 0x42, 0x41, 0x41, 0x5f, 0x5a, 0x54, 0x53, 0x38, 0x56, 0x65,
-  0x72, 0x74, 0x65, 0x78, 0x33, 0x44, 0x13, 0x84, 0x36, 0x40, 0x83, 0x09,
-  0x42, 0x1b, 0xa4, 0xc1, 0x04, 0xa1, 0x0d, 0xd4, 0x60, 0x82, 0xd0, 0x06,
-  0x6b, 0x30, 0x41, 0x68, 0x03, 0x36, 0x98, 0x20, 0xb4, 0x41, 0x1b, 0x4c,
-  0x10, 0xda, 0xc0, 0x0d, 0x26, 0x08, 0x6d, 0xf0, 0x06, 0x13, 0x84, 0x36,
-  0x80, 0x83, 0x09, 0x42, 0x1b, 0xc4, 0xc1, 0x04, 0xa1, 0x0d, 0xe4, 0x60,
-  0x82, 0xd0, 0x06, 0x73, 0x30, 0x41, 0x68, 0x03, 0x3a, 0x98, 0x20, 0xb4,
-  0x41, 0x1d, 0x4c, 0x10, 0xda, 0xc0, 0x0e, 0x26, 0x08, 0x6d, 0x70, 0x07,
-  0x1b, 0x02, 0xdd, 0xd8, 0x30, 0xe4, 0x06, 0x7b, 0xf0, 0xc6, 0x86, 0x01,
-  0x37, 0xda, 0x83, 0x37, 0x36, 0x34, 0xb7, 0xe1, 0x1e, 0xbc, 0xe1, 0x1e,
-  0xbd, 0xe1, 0x1e, 0xbe, 0xe1, 0x1e, 0xbf, 0xe1, 0x1e, 0xe0, 0xe1, 0x1e,
-  0xe1, 0xb1, 0x61, 0x78, 0x0f, 0xf7, 0xe0, 0x8d, 0x0d, 0xc3, 0x7b, 0xb8,
-  0x07, 0x78, 0x6c, 0x18, 0xd2, 0xa0, 0x3d, 0x78, 0x63, 0xc3, 0x70, 0x0b,
-  0xed, 0xc1, 0x1b, 0x1b, 0xc2, 0x60, 0x37, 0xe4, 0x83, 0x37, 0xe4, 0x43,
-  0x3c, 0xe4, 0xa3, 0x37, 0xe4, 0x63, 0x3c, 0xe4, 0xc3, 0x37, 0xe4, 0x83,
-  0x3c, 0xe4, 0xe3, 0x37, 0xe6, 0xa3, 0x3c, 0xe4, 0x03, 0x3c, 0xe4, 0xc3,
-  0x3c, 0xe4, 0x23, 0x3c, 0xe4, 0xe3, 0x3c, 0xe4, 0x03, 0x3d, 0xe4, 0x23,
-  0x3d, 0xe4, 0x43, 0x3d, 0xe4, 0x63, 0x3d, 0x36, 0x0c, 0xf4, 0x21, 0x1f,
-  0xbe, 0xb1, 0x61, 0xa0, 0x0f, 0xf9, 0x20, 0x8f, 0x0d, 0x03, 0x7d, 0xc8,
-  0xc7, 0x6f, 0x6c, 0x18, 0xda, 0xa3, 0x3d, 0x78, 0x63, 0xc3, 0x40, 0x1f,
-  0xf2, 0xc1, 0x1b, 0x1b, 0x06, 0xfa, 0x90, 0x0f, 0xf1, 0xd8, 0x30, 0xd0,
-  0x87, 0x7c, 0xf4, 0xc6, 0x86, 0x81, 0x3e, 0xe4, 0x63, 0x3c, 0x36, 0x0c,
-  0xf4, 0x21, 0x1f, 0xe0, 0xb1, 0x61, 0xa0, 0x0f, 0xf9, 0x30, 0x8f, 0x0d,
-  0x03, 0x7d, 0xcc, 0x47, 0x79, 0x00, 0x3b, 0x1b, 0xac, 0x33, 0x08, 0x05,
-  0x0a, 0x14, 0x72, 0x56, 0x1b, 0x3b, 0x1b, 0x32, 0x35, 0x58, 0x05, 0x0a,
-  0x2e, 0x72, 0x58, 0x1b, 0x3b, 0x19, 0x0a, 0xc2, 0x15, 0x28, 0x00, 0xc6,
-  0x4e, 0x86, 0xc3, 0x98, 0x03, 0x0a, 0x80, 0xb1, 0x93, 0x21, 0x41, 0x38,
-  0x0a, 0x80, 0xb1, 0xad, 0x02, 0x39, 0x6a, 0xa1, 0x15, 0xe6, 0x80, 0x82,
-  0xa0, 0xcc, 0x31, 0x48, 0xc7, 0x2b, 0x0c, 0x32, 0x04, 0xd3, 0x66, 0x43,
-  0x20, 0xfe, 0xdb, 0x2a, 0x1a, 0x46, 0x17, 0x64, 0x01, 0x0c, 0x28, 0x08,
-  0xca, 0x1c, 0xc3, 0xa5, 0xd0, 0xc2, 0x20, 0x43, 0x80, 0x81, 0x81, 0x0d,
-  0x81, 0xf8, 0x5b, 0x60, 0x80, 0xff, 0xb6, 0x8a, 0x49, 0x02, 0x07, 0x5c,
-  0x28, 0x03, 0x0a, 0x82, 0x32, 0xc7, 0xd0, 0x39, 0xba, 0x30, 0xc8, 0x10,
-  0x78, 0x66, 0x60, 0x43, 0x20, 0xfe, 0x66, 0x04, 0xe0, 0x3f, 0xc8, 0x10,
-  0x84, 0x01, 0x19, 0x6c, 0xab, 0xd0, 0xb2, 0x5f, 0xf8, 0x85, 0x52, 0xa0,
-  0x20, 0x28, 0xdb, 0x2b, 0xea, 0xe0, 0x14, 0xd4, 0x21, 0x1c, 0x4e, 0x81,
-  0x82, 0xa0, 0x0c, 0x32, 0x0c, 0x66, 0xe0, 0x06, 0x26, 0x04, 0xe2, 0xbf,
-  0xbd, 0x22, 0x0f, 0x56, 0xc1, 0x1d, 0xca, 0x61, 0x0e, 0x28, 0x08, 0xca,
-  0x20, 0xc3, 0xa1, 0x06, 0x71, 0x60, 0x42, 0x20, 0xfe, 0x16, 0x14, 0xe0,
-  0xbf, 0xbd, 0xc2, 0x0f, 0x60, 0x61, 0x1e, 0xd4, 0xe1, 0x0e, 0x28, 0x08,
-  0xca, 0x20, 0x03, 0xf3, 0x06, 0x75, 0x60, 0x42, 0x20, 0xfe, 0x56, 0x04,
-  0xe0, 0xbf, 0xbd, 0x62, 0x14, 0x6a, 0x01, 0x1f, 0xde, 0x61, 0x0f, 0x28,
-  0x08, 0xca, 0x20, 0x43, 0x44, 0x07, 0x79, 0x60, 0x42, 0x20, 0xfe, 0x56,
-  0x04, 0xe0, 0xbf, 0xad, 0xe2, 0x0d, 0xdc, 0x80, 0x1e, 0xe8, 0x41, 0x14,
-  0x28, 0x08, 0xca, 0x20, 0x43, 0x90, 0x07, 0xa1, 0x60, 0x41, 0x25, 0xfe,
-  0x83, 0x0c, 0xc3, 0x1e, 0x88, 0x82, 0x05, 0x93, 0xf8, 0xdb, 0x10, 0x80,
-  0xff, 0x20, 0x83, 0xe1, 0x07, 0xa4, 0x60, 0x41, 0x24, 0xfe, 0x36, 0x04,
-  0xe0, 0x3f, 0xc8, 0x90, 0x84, 0x82, 0x29, 0x58, 0xf0, 0x88, 0xbf, 0x0d,
-  0x01, 0xf8, 0x6f, 0xab, 0xe0, 0x83, 0x3d, 0x08, 0x89, 0x90, 0x70, 0x05,
-  0x0a, 0x82, 0x32, 0xc8, 0x10, 0x98, 0x82, 0x2b, 0x58, 0x20, 0x06, 0xe2,
-  0x3f, 0xc8, 0x30, 0xa0, 0xc2, 0x2b, 0x58, 0x00, 0x06, 0xe2, 0x6f, 0x43,
-  0x00, 0xfe, 0x83, 0x0c, 0xc6, 0x2a, 0xc4, 0x82, 0x05, 0x9e, 0xf8, 0xdb,
-  0x10, 0x80, 0xff, 0x20, 0x43, 0xe2, 0x0a, 0xb3, 0x60, 0x01, 0x27, 0xfe,
-  0x36, 0x04, 0xe0, 0xbf, 0xad, 0x22, 0x15, 0x50, 0xc1, 0x25, 0x5c, 0x42,
-  0x17, 0x28, 0x08, 0xca, 0x20, 0x43, 0x30, 0x0b, 0xbb, 0x60, 0xc1, 0x1b,
-  0x88, 0xff, 0x20, 0xc3, 0x50, 0x0b, 0xbc, 0x60, 0x41, 0x1b, 0x88, 0xbf,
-  0x0d, 0x01, 0xf8, 0x0f, 0x32, 0x18, 0xb8, 0xe0, 0x0b, 0x16, 0xac, 0x81,
-  0xf8, 0xdb, 0x10, 0x80, 0xff, 0x20, 0x43, 0xb2, 0x0b, 0xe0, 0x60, 0x41,
-  0x1a, 0x88, 0xbf, 0x0d, 0x01, 0xf8, 0xef, 0x64, 0xc8, 0x05, 0x5c, 0xd8,
-  0x09, 0x0a, 0x80, 0xb1, 0x93, 0x61, 0x17, 0x74, 0xa1, 0x2c, 0x28, 0x00,
-  0xc6, 0x4e, 0x86, 0x5e, 0xe0, 0x05, 0xb4, 0xa0, 0x00, 0x18, 0x3b, 0x19,
-  0x7e, 0xc1, 0x17, 0xc4, 0x82, 0x02, 0x60, 0xcc, 0x31, 0x98, 0xc3, 0x31,
-  0x16, 0x83, 0x0c, 0xc1, 0x39, 0xbc, 0x83, 0x05, 0x72, 0x20, 0xfe, 0x73,
-  0x0c, 0xe9, 0x80, 0x98, 0xc5, 0x20, 0x43, 0xa0, 0x0e, 0xf2, 0x60, 0x01,
-  0x1a, 0x88, 0xbf, 0x05, 0x04, 0xf8, 0xcf, 0x31, 0xb4, 0x83, 0xa2, 0x16,
-  0x83, 0x0c, 0x81, 0x3b, 0xd8, 0x83, 0x05, 0x9f, 0xf8, 0x1b, 0x11, 0x80,
-  0xff, 0x1c, 0x43, 0x3c, 0x30, 0x6e, 0x31, 0xc8, 0x10, 0xc8, 0x83, 0x3e,
-  0x58, 0x60, 0x89, 0xbf, 0x11, 0x01, 0xf8, 0x8f, 0x18, 0x1c, 0x42, 0x08,
-  0x82, 0x85, 0x7f, 0xa4, 0x01, 0x5f, 0xd0, 0x02, 0x2d, 0x8c, 0x18, 0x18,
-  0x42, 0x08, 0x82, 0x85, 0x7f, 0x9c, 0x81, 0x5f, 0x04, 0x73, 0x0c, 0xf4,
-  0x10, 0xd0, 0xc5, 0x20, 0x43, 0x50, 0x0f, 0xfa, 0x60, 0x01, 0x2e, 0x88,
-  0xff, 0x20, 0x43, 0x70, 0x0f, 0xfe, 0x30, 0xc7, 0x10, 0xf0, 0x43, 0x5e,
-  0x8c, 0x18, 0x18, 0x42, 0x08, 0x82, 0x85, 0x7f, 0x94, 0x41, 0x69, 0x04,
-  0x23, 0x06, 0x86, 0x10, 0x82, 0x60, 0xe1, 0x1f, 0x63, 0x70, 0x1a, 0xbc,
-  0xb0, 0x93, 0x21, 0x1f, 0xf0, 0xc1, 0x2f, 0x28, 0x00, 0xc6, 0x1c, 0xc3,
-  0x3f, 0x04, 0x7d, 0xb1, 0x93, 0x81, 0x1f, 0xf6, 0xa1, 0x25, 0x28, 0x00,
-  0xc6, 0x1c, 0xc3, 0x10, 0xa0, 0xc6, 0x4e, 0x86, 0x7f, 0xf0, 0x87, 0xd3,
-  0xa0, 0x00, 0x19, 0x17, 0x14, 0x30, 0xdb, 0x50, 0x12, 0x13, 0x30, 0xdb,
-  0x10, 0x30, 0xc1, 0x6c, 0x43, 0xc0, 0x08, 0xb3, 0x0d, 0x01, 0x31, 0xcc,
-  0x36, 0x04, 0x08, 0x91, 0x41, 0x40, 0x0c, 0x00, 0x00, 0x00, 0x1f, 0x00,
-  0x00, 0x00, 0x5b, 0x86, 0x20, 0x78, 0x8f, 0x2d, 0x03, 0x11, 0xc0, 0xc7,
-  0x96, 0xe1, 0x08, 0xe8, 0x63, 0xcb, 0x90, 0x04, 0xf5, 0xb1, 0x65, 0x58,
-  0x02, 0xfb, 0xd8, 0x32, 0x34, 0xc1, 0x7d, 0x6c, 0x19, 0xa4, 0xe0, 0x3e,
-  0xb6, 0x0c, 0x58, 0x70, 0x1f, 0x5b, 0x86, 0x2f, 0xb8, 0x8f, 0x2d, 0x43,
-  0x18, 0x04, 0xf7, 0xb1, 0x65, 0x28, 0x83, 0xe0, 0x3e, 0xb6, 0x0c, 0x6a,
-  0x10, 0xdc, 0xc7, 0x96, 0xe1, 0x0d, 0x82, 0xfb, 0xd8, 0x32, 0xd0, 0x41,
-  0x70, 0x1f, 0x5b, 0x86, 0x50, 0x08, 0xee, 0x63, 0xcb, 0xe0, 0x0a, 0xc1,
-  0x7d, 0x6c, 0x19, 0x76, 0x21, 0xc0, 0x8f, 0x2d, 0x43, 0x2f, 0x04, 0xf9,
-  0xb1, 0x65, 0xf8, 0x85, 0x40, 0x3f, 0xb6, 0x0c, 0xe1, 0x10, 0xec, 0xc7,
-  0x96, 0x61, 0x1f, 0x02, 0xfe, 0xd8, 0x32, 0xf8, 0x43, 0xd0, 0x1f, 0x5b,
-  0x86, 0x90, 0x08, 0xfc, 0x03, 0x00, 0x00, 0x00, 0x00, 0x00, 0x71, 0x20,
-  0x00, 0x00, 0x03, 0x00, 0x00, 0x00, 0x32, 0x0e, 0x10, 0x22, 0x84, 0x00,
-  0x96, 0x0a, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x65, 0x0c,
-  0x00, 0x00, 0x35, 0x00, 0x00, 0x00, 0x12, 0x03, 0x94, 0xa8, 0x01, 0x00,
-  0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x64, 0x00, 0x00, 0x00, 0x09, 0x00,
-  0x00, 0x00, 0x44, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x50, 0x00,
-  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x50, 0x00, 0x00, 0x00, 0x05, 0x00,
-  0x00, 0x00, 0xc8, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x6d, 0x00,
-  0x00, 0x00, 0x18, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x0f, 0x00,
-  0x00, 0x00, 0x85, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-  0x00, 0x00, 0x05, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-  0x00, 0x00, 0x0f, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x0f, 0x00,
-  0x00, 0x00, 0xff, 0xff, 0xff, 0xff, 0x00, 0x24, 0x00, 0x00, 0x0f, 0x00,
-  0x00, 0x00, 0x1b, 0x00, 0x00, 0x00, 0x0f, 0x00, 0x00, 0x00, 0x1b, 0x00,
-  0x00, 0x00, 0xff, 0xff, 0xff, 0xff, 0x08, 0x24, 0x00, 0x00, 0x2a, 0x00,
-  0x00, 0x00, 0x1b, 0x00, 0x00, 0x00, 0x2a, 0x00, 0x00, 0x00, 0x1b, 0x00,
-  0x00, 0x00, 0xff, 0xff, 0xff, 0xff, 0x08, 0x24, 0x00, 0x00, 0x45, 0x00,
-  0x00, 0x00, 0x12, 0x00, 0x00, 0x00, 0x45, 0x00, 0x00, 0x00, 0x12, 0x00,
-  0x00, 0x00, 0xff, 0xff, 0xff, 0xff, 0x08, 0x24, 0x00, 0x00, 0x57, 0x00,
-  0x00, 0x00, 0x0d, 0x00, 0x00, 0x00, 0x57, 0x00, 0x00, 0x00, 0x0d, 0x00,
-  0x00, 0x00, 0xff, 0xff, 0xff, 0xff, 0x08, 0x24, 0x00, 0x00, 0x00, 0x00,
-  0x00, 0x00, 0x5d, 0x0c, 0x00, 0x00, 0x25, 0x00, 0x00, 0x00, 0x12, 0x03,
-  0x94, 0x25, 0x01, 0x00, 0x00, 0x00, 0x74, 0x72, 0x69, 0x61, 0x6e, 0x67,
-  0x6c, 0x65, 0x5f, 0x76, 0x65, 0x72, 0x74, 0x65, 0x78, 0x61, 0x69, 0x72,
-  0x2e, 0x63, 0x6f, 0x6e, 0x76, 0x65, 0x72, 0x74, 0x2e, 0x66, 0x2e, 0x76,
-  0x33, 0x66, 0x31, 0x36, 0x2e, 0x66, 0x2e, 0x76, 0x33, 0x66, 0x33, 0x32,
-  0x61, 0x69, 0x72, 0x2e, 0x63, 0x6f, 0x6e, 0x76, 0x65, 0x72, 0x74, 0x2e,
-  0x66, 0x2e, 0x76, 0x34, 0x66, 0x31, 0x36, 0x2e, 0x66, 0x2e, 0x76, 0x34,
-  0x66, 0x33, 0x32, 0x61, 0x69, 0x72, 0x2e, 0x66, 0x61, 0x73, 0x74, 0x5f,
-  0x72, 0x73, 0x71, 0x72, 0x74, 0x2e, 0x66, 0x33, 0x32, 0x61, 0x69, 0x72,
-  0x2e, 0x64, 0x6f, 0x74, 0x2e, 0x76, 0x33, 0x66, 0x33, 0x32, 0x33, 0x31,
-  0x30, 0x30, 0x31, 0x2e, 0x31, 0x38, 0x34, 0x61, 0x69, 0x72, 0x36, 0x34,
-  0x2d, 0x61, 0x70, 0x70, 0x6c, 0x65, 0x2d, 0x6d, 0x61, 0x63, 0x6f, 0x73,
-  0x78, 0x31, 0x31, 0x2e, 0x30, 0x2e, 0x30, 0x00, 0x00, 0x00, 0x00, 0x00,
-  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xde, 0xc0, 0x17, 0x0b, 0x00, 0x00,
-  0x00, 0x00, 0x14, 0x00, 0x00, 0x00, 0x30, 0x15, 0x00, 0x00, 0xff, 0xff,
-  0xff, 0xff, 0x42, 0x43, 0xc0, 0xde, 0x35, 0x14, 0x00, 0x00, 0x03, 0x00,
-  0x00, 0x00, 0x62, 0x0c, 0x30, 0x24, 0x80, 0x10, 0x05, 0xc8, 0x14, 0x00,
-  0x00, 0x00, 0x21, 0x0c, 0x00, 0x00, 0xf0, 0x04, 0x00, 0x00, 0x0b, 0x02,
-  0x21, 0x00, 0x02, 0x00, 0x00, 0x00, 0x13, 0x00, 0x00, 0x00, 0x07, 0x81,
-  0x23, 0x91, 0x41, 0xc8, 0x04, 0x49, 0x06, 0x10, 0x32, 0x39, 0x92, 0x01,
-  0x84, 0x0c, 0x25, 0x05, 0x08, 0x19, 0x1e, 0x04, 0x8b, 0x62, 0x80, 0x18,
-  0x45, 0x02, 0x42, 0x92, 0x0b, 0x42, 0xc4, 0x10, 0x32, 0x14, 0x38, 0x08,
-  0x18, 0x4b, 0x0a, 0x32, 0x62, 0x88, 0x48, 0x90, 0x14, 0x20, 0x43, 0x46,
-  0x88, 0xa5, 0x00, 0x19, 0x32, 0x42, 0x04, 0x49, 0x0e, 0x90, 0x11, 0x23,
-  0xc4, 0x50, 0x41, 0x51, 0x81, 0x8c, 0xe1, 0x83, 0xe5, 0x8a, 0x04, 0x31,
-  0x46, 0x06, 0x89, 0x20, 0x00, 0x00, 0x5f, 0x00, 0x00, 0x00, 0x32, 0x22,
-  0x88, 0x09, 0x20, 0x64, 0x85, 0x04, 0x13, 0x23, 0xa4, 0x84, 0x04, 0x13,
-  0x23, 0xe3, 0x84, 0xa1, 0x90, 0x14, 0x12, 0x4c, 0x8c, 0x8c, 0x0b, 0x84,
-  0xc4, 0x4c, 0x10, 0xa8, 0xc1, 0x1c, 0x01, 0x28, 0x0c, 0x22, 0x00, 0xc2,
-  0x0c, 0xc0, 0x30, 0x02, 0x21, 0x0c, 0x23, 0x08, 0xc2, 0x1c, 0x01, 0x18,
-  0xdc, 0x23, 0x4d, 0x11, 0x25, 0x4c, 0xfe, 0x4b, 0x44, 0x13, 0x71, 0xdd,
-  0x1d, 0x82, 0x04, 0x41, 0x10, 0x04, 0x41, 0x28, 0x04, 0x41, 0x10, 0x04,
-  0x41, 0x10, 0x06, 0x11, 0x8c, 0xe0, 0x1e, 0x69, 0x8a, 0x28, 0x61, 0xf2,
-  0x5f, 0x22, 0x9a, 0x88, 0xcb, 0xee, 0x90, 0x22, 0x08, 0x42, 0x21, 0x08,
-  0x82, 0x20, 0x08, 0x83, 0x08, 0x48, 0x70, 0x94, 0x34, 0x45, 0x94, 0x30,
-  0xf9, 0xff, 0x44, 0x5c, 0x13, 0x15, 0x11, 0xbf, 0x3d, 0xfc, 0xd3, 0x18,
-  0x01, 0x30, 0x88, 0xa0, 0x04, 0x33, 0x5d, 0xf3, 0x40, 0x0f, 0xf2, 0x50,
-  0x0f, 0xe3, 0x40, 0x0f, 0x6e, 0xd0, 0x0e, 0xe5, 0x40, 0x0f, 0xe1, 0xc0,
-  0x0e, 0x7a, 0xa0, 0x07, 0xf4, 0x50, 0x0e, 0xf8, 0x40, 0x0f, 0xf5, 0x20,
-  0x0f, 0xe5, 0x20, 0x07, 0xe4, 0x80, 0x82, 0xe5, 0x1c, 0x69, 0x8a, 0x28,
-  0x61, 0xf2, 0x5b, 0xe2, 0x9a, 0xa8, 0x88, 0x40, 0x01, 0x33, 0x88, 0xd0,
-  0x04, 0x57, 0x49, 0x53, 0x44, 0x09, 0x93, 0xdf, 0x11, 0x15, 0x22, 0x10,
-  0x26, 0x30, 0x11, 0x11, 0x02, 0x2c, 0x08, 0x13, 0x04, 0x41, 0x10, 0x04,
-  0x41, 0x10, 0x04, 0x41, 0x28, 0x8a, 0xa2, 0x28, 0x8a, 0xa2, 0x28, 0x0a,
-  0x41, 0x18, 0x44, 0x78, 0x82, 0x24, 0x18, 0x66, 0xa2, 0xe6, 0x81, 0x1e,
-  0xe4, 0xa1, 0x1e, 0xc6, 0x81, 0x1e, 0xdc, 0xa0, 0x1d, 0xca, 0x81, 0x1e,
-  0xc2, 0x81, 0x1d, 0xf4, 0x40, 0x0f, 0xda, 0x21, 0x1c, 0xe8, 0x41, 0x1e,
-  0xd2, 0x01, 0x1f, 0x50, 0x10, 0x1d, 0x26, 0x4d, 0x11, 0x25, 0x4c, 0xbe,
-  0xd8, 0x48, 0x13, 0xd0, 0x08, 0x44, 0x1b, 0x01, 0x8d, 0x54, 0x38, 0x11,
-  0x83, 0x04, 0x49, 0x1a, 0x44, 0x98, 0x82, 0x41, 0x04, 0x29, 0x38, 0x46,
-  0x9a, 0x22, 0x4a, 0x98, 0x7c, 0x56, 0x20, 0x1a, 0x02, 0x19, 0x47, 0xe2,
-  0x40, 0x54, 0x35, 0x88, 0x60, 0x05, 0xe5, 0x18, 0x86, 0x81, 0x28, 0x8a,
-  0x8b, 0xb0, 0x11, 0x80, 0x12, 0x68, 0xb4, 0xcd, 0x11, 0x20, 0x46, 0x18,
-  0xba, 0x8b, 0xa4, 0x29, 0xa2, 0x84, 0xc9, 0xff, 0x25, 0x80, 0x79, 0x16,
-  0x22, 0xfa, 0xa7, 0x31, 0x02, 0x60, 0x10, 0xe1, 0x13, 0xe6, 0x08, 0x82,
-  0x61, 0x04, 0xa1, 0x28, 0x8a, 0xb7, 0x80, 0x44, 0x28, 0x86, 0x82, 0x50,
-  0xd0, 0x38, 0x10, 0x90, 0x02, 0xc5, 0x14, 0xc0, 0x20, 0x82, 0x13, 0x0c,
-  0x22, 0x2c, 0x01, 0x00, 0x00, 0x00, 0x51, 0x18, 0x00, 0x00, 0x8c, 0x00,
-  0x00, 0x00, 0x1b, 0xc8, 0x25, 0xf8, 0xff, 0xff, 0xff, 0xff, 0x01, 0x58,
-  0x03, 0x40, 0x22, 0xc6, 0xe1, 0x1d, 0xe4, 0x41, 0x1e, 0xca, 0x61, 0x1c,
-  0xe8, 0x81, 0x1d, 0xf2, 0xa1, 0x0d, 0xe4, 0xe1, 0x1d, 0xea, 0xc1, 0x1d,
-  0xc8, 0xa1, 0x1c, 0xc8, 0xa1, 0x0d, 0xc8, 0x21, 0x1d, 0xec, 0x21, 0x1d,
-  0xc8, 0xa1, 0x1c, 0xda, 0x60, 0x1e, 0xe2, 0x41, 0x1e, 0xe8, 0xa1, 0x0d,
-  0xcc, 0x01, 0x1e, 0xda, 0xa0, 0x1d, 0xc2, 0x81, 0x1e, 0xd0, 0x01, 0x30,
-  0x87, 0x70, 0x60, 0x87, 0x79, 0x28, 0x07, 0x80, 0x20, 0x87, 0x74, 0x98,
-  0x87, 0x70, 0x10, 0x07, 0x76, 0x28, 0x87, 0x36, 0xa0, 0x87, 0x70, 0x48,
-  0x07, 0x76, 0x68, 0x83, 0x71, 0x08, 0x07, 0x76, 0x60, 0x87, 0x79, 0x00,
-  0xcc, 0x21, 0x1c, 0xd8, 0x61, 0x1e, 0xca, 0x01, 0x20, 0xd8, 0xa1, 0x1c,
-  0xe6, 0x61, 0x1e, 0xda, 0x00, 0x1e, 0xe4, 0xa1, 0x1c, 0xc6, 0x21, 0x1d,
-  0xe6, 0xa1, 0x1c, 0xda, 0xc0, 0x1c, 0xe0, 0xa1, 0x1d, 0xc2, 0x81, 0x1c,
-  0x00, 0x73, 0x08, 0x07, 0x76, 0x98, 0x87, 0x72, 0x00, 0x08, 0x77, 0x78,
-  0x87, 0x36, 0x30, 0x07, 0x79, 0x08, 0x87, 0x76, 0x28, 0x87, 0x36, 0x80,
-  0x87, 0x77, 0x48, 0x07, 0x77, 0xa0, 0x87, 0x72, 0x90, 0x87, 0x36, 0x28,
-  0x07, 0x76, 0x48, 0x87, 0x76, 0x00, 0xe8, 0x41, 0x1e, 0xea, 0xa1, 0x1c,
-  0x80, 0xc1, 0x1d, 0xde, 0xa1, 0x0d, 0xcc, 0x41, 0x1e, 0xc2, 0xa1, 0x1d,
-  0xca, 0xa1, 0x0d, 0xe0, 0xe1, 0x1d, 0xd2, 0xc1, 0x1d, 0xe8, 0xa1, 0x1c,
-  0xe4, 0xa1, 0x0d, 0xca, 0x81, 0x1d, 0xd2, 0xa1, 0x1d, 0xda, 0xc0, 0x1d,
-  0xde, 0xc1, 0x1d, 0xda, 0x80, 0x1d, 0xca, 0x21, 0x1c, 0xcc, 0x01, 0x20,
-  0xdc, 0xe1, 0x1d, 0xda, 0x20, 0x1d, 0xdc, 0xc1, 0x1c, 0xe6, 0xa1, 0x0d,
-  0xcc, 0x01, 0x1e, 0xda, 0xa0, 0x1d, 0xc2, 0x81, 0x1e, 0xd0, 0x01, 0xa0,
-  0x07, 0x79, 0xa8, 0x87, 0x72, 0x00, 0x08, 0x77, 0x78, 0x87, 0x36, 0x50,
-  0x87, 0x7a, 0x68, 0x07, 0x78, 0x68, 0x03, 0x7a, 0x08, 0x07, 0x71, 0x60,
-  0x87, 0x72, 0x98, 0x07, 0xc0, 0x1c, 0xc2, 0x81, 0x1d, 0xe6, 0xa1, 0x1c,
-  0x00, 0xc2, 0x1d, 0xde, 0xa1, 0x0d, 0xdc, 0x21, 0x1c, 0xdc, 0x61, 0x1e,
-  0xda, 0xc0, 0x1c, 0xe0, 0xa1, 0x0d, 0xda, 0x21, 0x1c, 0xe8, 0x01, 0x1d,
-  0x00, 0x7a, 0x90, 0x87, 0x7a, 0x28, 0x07, 0x80, 0x70, 0x87, 0x77, 0x68,
-  0x83, 0x79, 0x48, 0x87, 0x73, 0x70, 0x87, 0x72, 0x20, 0x87, 0x36, 0xd0,
-  0x87, 0x72, 0x90, 0x87, 0x77, 0x98, 0x87, 0x36, 0x30, 0x07, 0x78, 0x68,
-  0x83, 0x76, 0x08, 0x07, 0x7a, 0x40, 0x07, 0x80, 0x1e, 0xe4, 0xa1, 0x1e,
-  0xca, 0x01, 0x20, 0xdc, 0xe1, 0x1d, 0xda, 0x80, 0x1e, 0xe4, 0x21, 0x1c,
-  0xe0, 0x01, 0x1e, 0xd2, 0xc1, 0x1d, 0xce, 0xa1, 0x0d, 0xda, 0x21, 0x1c,
-  0xe8, 0x01, 0x1d, 0x00, 0x7a, 0x90, 0x87, 0x7a, 0x28, 0x07, 0x80, 0x98,
-  0x07, 0x7a, 0x08, 0x87, 0x71, 0x58, 0x87, 0x36, 0x80, 0x07, 0x79, 0x78,
-  0x07, 0x7a, 0x28, 0x87, 0x71, 0xa0, 0x87, 0x77, 0x90, 0x87, 0x36, 0x10,
-  0x87, 0x7a, 0x30, 0x07, 0x73, 0x28, 0x07, 0x79, 0x68, 0x83, 0x79, 0x48,
-  0x07, 0x7d, 0x28, 0x07, 0x00, 0x0f, 0x00, 0xa2, 0x1e, 0xdc, 0x61, 0x1e,
-  0xc2, 0xc1, 0x1c, 0xca, 0xa1, 0x0d, 0xcc, 0x01, 0x1e, 0xda, 0xa0, 0x1d,
-  0xc2, 0x81, 0x1e, 0xd0, 0x01, 0xa0, 0x07, 0x79, 0xa8, 0x87, 0x72, 0x00,
-  0x88, 0x7a, 0x98, 0x87, 0x72, 0x68, 0x83, 0x79, 0x78, 0x07, 0x73, 0xa0,
-  0x87, 0x36, 0x30, 0x07, 0x76, 0x78, 0x87, 0x70, 0xa0, 0x07, 0xc0, 0x1c,
-  0xc2, 0x81, 0x1d, 0xe6, 0xa1, 0x1c, 0x80, 0x0d, 0x8b, 0x60, 0x00, 0x09,
-  0xb0, 0x00, 0x55, 0x90, 0x06, 0x70, 0xb0, 0x81, 0x18, 0xfe, 0xff, 0xff,
-  0xff, 0x7f, 0x00, 0xa4, 0x0d, 0x0a, 0xf1, 0xff, 0xff, 0xff, 0xff, 0x03,
-  0xd0, 0x06, 0xc0, 0x1a, 0x00, 0x12, 0x50, 0x6d, 0x30, 0x8a, 0x00, 0x58,
-  0x80, 0x6a, 0x83, 0x61, 0x08, 0xc0, 0x02, 0x54, 0x00, 0x00, 0x49, 0x18,
-  0x00, 0x00, 0x03, 0x00, 0x00, 0x00, 0x13, 0x84, 0x40, 0x98, 0x10, 0x0c,
-  0x13, 0x06, 0xa2, 0x30, 0x00, 0x00, 0x13, 0xb0, 0x70, 0x48, 0x07, 0x79,
-  0xb0, 0x03, 0x3a, 0x68, 0x83, 0x70, 0x80, 0x07, 0x78, 0x60, 0x87, 0x72,
-  0x68, 0x83, 0x76, 0x08, 0x87, 0x71, 0x78, 0x87, 0x79, 0xc0, 0x87, 0x38,
-  0x88, 0x03, 0x37, 0x80, 0x03, 0x37, 0x80, 0x83, 0x0d, 0xb7, 0x51, 0x0e,
-  0x6d, 0x00, 0x0f, 0x7a, 0x60, 0x07, 0x74, 0xa0, 0x07, 0x76, 0x40, 0x07,
-  0x7a, 0x60, 0x07, 0x74, 0xd0, 0x06, 0xe9, 0x10, 0x07, 0x7a, 0x80, 0x07,
-  0x7a, 0x80, 0x07, 0x6d, 0x90, 0x0e, 0x78, 0xa0, 0x07, 0x78, 0xa0, 0x07,
-  0x78, 0xd0, 0x06, 0xe9, 0x10, 0x07, 0x76, 0xa0, 0x07, 0x71, 0x60, 0x07,
-  0x7a, 0x10, 0x07, 0x76, 0xd0, 0x06, 0xe9, 0x30, 0x07, 0x72, 0xa0, 0x07,
-  0x73, 0x20, 0x07, 0x7a, 0x30, 0x07, 0x72, 0xd0, 0x06, 0xe9, 0x60, 0x07,
-  0x74, 0xa0, 0x07, 0x76, 0x40, 0x07, 0x7a, 0x60, 0x07, 0x74, 0xd0, 0x06,
-  0xe6, 0x30, 0x07, 0x72, 0xa0, 0x07, 0x73, 0x20, 0x07, 0x7a, 0x30, 0x07,
-  0x72, 0xd0, 0x06, 0xe6, 0x60, 0x07, 0x74, 0xa0, 0x07, 0x76, 0x40, 0x07,
-  0x7a, 0x60, 0x07, 0x74, 0xd0, 0x06, 0xf6, 0x10, 0x07, 0x76, 0xa0, 0x07,
-  0x71, 0x60, 0x07, 0x7a, 0x10, 0x07, 0x76, 0xd0, 0x06, 0xf6, 0x20, 0x07,
-  0x74, 0xa0, 0x07, 0x73, 0x20, 0x07, 0x7a, 0x30, 0x07, 0x72, 0xd0, 0x06,
-  0xf6, 0x30, 0x07, 0x72, 0xa0, 0x07, 0x73, 0x20, 0x07, 0x7a, 0x30, 0x07,
-  0x72, 0xd0, 0x06, 0xf6, 0x40, 0x07, 0x78, 0xa0, 0x07, 0x76, 0x40, 0x07,
-  0x7a, 0x60, 0x07, 0x74, 0xd0, 0x06, 0xf6, 0x60, 0x07, 0x74, 0xa0, 0x07,
-  0x76, 0x40, 0x07, 0x7a, 0x60, 0x07, 0x74, 0xd0, 0x06, 0xf6, 0x90, 0x07,
-  0x76, 0xa0, 0x07, 0x71, 0x20, 0x07, 0x78, 0xa0, 0x07, 0x71, 0x20, 0x07,
-  0x78, 0xd0, 0x06, 0xf6, 0x10, 0x07, 0x72, 0x80, 0x07, 0x7a, 0x10, 0x07,
-  0x72, 0x80, 0x07, 0x7a, 0x10, 0x07, 0x72, 0x80, 0x07, 0x6d, 0x60, 0x0f,
-  0x71, 0x90, 0x07, 0x72, 0xa0, 0x07, 0x72, 0x50, 0x07, 0x76, 0xa0, 0x07,
-  0x72, 0x50, 0x07, 0x76, 0xd0, 0x06, 0xf6, 0x20, 0x07, 0x75, 0x60, 0x07,
-  0x7a, 0x20, 0x07, 0x75, 0x60, 0x07, 0x7a, 0x20, 0x07, 0x75, 0x60, 0x07,
-  0x6d, 0x60, 0x0f, 0x75, 0x10, 0x07, 0x72, 0xa0, 0x07, 0x75, 0x10, 0x07,
-  0x72, 0xa0, 0x07, 0x75, 0x10, 0x07, 0x72, 0xd0, 0x06, 0xf6, 0x10, 0x07,
-  0x70, 0x20, 0x07, 0x74, 0xa0, 0x07, 0x71, 0x00, 0x07, 0x72, 0x40, 0x07,
-  0x7a, 0x10, 0x07, 0x70, 0x20, 0x07, 0x74, 0xd0, 0x06, 0xee, 0x80, 0x07,
-  0x7a, 0x10, 0x07, 0x76, 0xa0, 0x07, 0x73, 0x20, 0x07, 0x4a, 0x0f, 0x08,
-  0x11, 0x12, 0x40, 0x86, 0x8c, 0x14, 0x19, 0x01, 0x34, 0x42, 0x18, 0x96,
-  0x9a, 0x22, 0x04, 0x68, 0x8c, 0x85, 0xf8, 0x8b, 0x08, 0x30, 0x18, 0xa2,
-  0x99, 0x7e, 0x7b, 0xd8, 0x01, 0x01, 0x13, 0xb0, 0x14, 0x03, 0x01, 0x00,
-  0x00, 0x00, 0x00, 0x00, 0x10, 0x0c, 0x91, 0x26, 0x0a, 0x03, 0x00, 0x20,
-  0x00, 0x00, 0x00, 0x10, 0x00, 0x00, 0x00, 0x00, 0x60, 0x88, 0x74, 0x06,
-  0xd4, 0x06, 0x04, 0x80, 0x00, 0x00, 0x00, 0x20, 0x00, 0x00, 0x00, 0x00,
-  0xc0, 0x10, 0x69, 0x0f, 0xb6, 0x31, 0x00, 0x02, 0x60, 0x00, 0x00, 0x00,
-  0x10, 0x00, 0x00, 0x00, 0x00, 0x40, 0x62, 0x83, 0x40, 0x61, 0x79, 0x02,
-  0x00, 0x80, 0x2c, 0x10, 0x00, 0x00, 0x1a, 0x00, 0x00, 0x00, 0x32, 0x1e,
-  0x98, 0x18, 0x19, 0x11, 0x4c, 0x90, 0x8c, 0x09, 0x26, 0x47, 0xc6, 0x04,
-  0x43, 0x02, 0xea, 0xdd, 0xfa, 0xf7, 0xff, 0xff, 0x17, 0x90, 0xf0, 0x3f,
-  0x60, 0x04, 0xa0, 0x20, 0x0a, 0xa4, 0x60, 0x0a, 0xa8, 0xa0, 0xa8, 0x28,
-  0x82, 0x12, 0x28, 0x84, 0x72, 0x28, 0x9f, 0x02, 0x14, 0x28, 0x88, 0x02,
-  0x29, 0x83, 0x11, 0x80, 0x52, 0x28, 0xb0, 0xc2, 0x28, 0x94, 0x82, 0x29,
-  0x9c, 0x02, 0x2a, 0xa4, 0x82, 0x2a, 0xac, 0x42, 0x2b, 0xb8, 0xc2, 0x2b,
-  0xc0, 0x80, 0x42, 0x0c, 0x28, 0xc8, 0x80, 0xc2, 0x0c, 0x28, 0xd0, 0x80,
-  0x42, 0x0d, 0x28, 0xd8, 0x80, 0xc2, 0x0d, 0x28, 0xe0, 0x00, 0x32, 0xc7,
-  0x12, 0x96, 0x01, 0x00, 0x00, 0x00, 0xb1, 0x18, 0x00, 0x00, 0x7b, 0x00,
-  0x00, 0x00, 0x33, 0x08, 0x80, 0x1c, 0xc4, 0xe1, 0x1c, 0x66, 0x14, 0x01,
-  0x3d, 0x88, 0x43, 0x38, 0x84, 0xc3, 0x8c, 0x42, 0x80, 0x07, 0x79, 0x78,
-  0x07, 0x73, 0x98, 0x71, 0x0c, 0xe6, 0x00, 0x0f, 0xed, 0x10, 0x0e, 0xf4,
-  0x80, 0x0e, 0x33, 0x0c, 0x42, 0x1e, 0xc2, 0xc1, 0x1d, 0xce, 0xa1, 0x1c,
-  0x66, 0x30, 0x05, 0x3d, 0x88, 0x43, 0x38, 0x84, 0x83, 0x1b, 0xcc, 0x03,
-  0x3d, 0xc8, 0x43, 0x3d, 0x8c, 0x03, 0x3d, 0xcc, 0x78, 0x8c, 0x74, 0x70,
-  0x07, 0x7b, 0x08, 0x07, 0x79, 0x48, 0x87, 0x70, 0x70, 0x07, 0x7a, 0x70,
-  0x03, 0x76, 0x78, 0x87, 0x70, 0x20, 0x87, 0x19, 0xcc, 0x11, 0x0e, 0xec,
-  0x90, 0x0e, 0xe1, 0x30, 0x0f, 0x6e, 0x30, 0x0f, 0xe3, 0xf0, 0x0e, 0xf0,
-  0x50, 0x0e, 0x33, 0x10, 0xc4, 0x1d, 0xde, 0x21, 0x1c, 0xd8, 0x21, 0x1d,
-  0xc2, 0x61, 0x1e, 0x66, 0x30, 0x89, 0x3b, 0xbc, 0x83, 0x3b, 0xd0, 0x43,
-  0x39, 0xb4, 0x03, 0x3c, 0xbc, 0x83, 0x3c, 0x84, 0x03, 0x3b, 0xcc, 0xf0,
-  0x14, 0x76, 0x60, 0x07, 0x7b, 0x68, 0x07, 0x37, 0x68, 0x87, 0x72, 0x68,
-  0x07, 0x37, 0x80, 0x87, 0x70, 0x90, 0x87, 0x70, 0x60, 0x07, 0x76, 0x28,
-  0x07, 0x76, 0xf8, 0x05, 0x76, 0x78, 0x87, 0x77, 0x80, 0x87, 0x5f, 0x08,
-  0x87, 0x71, 0x18, 0x87, 0x72, 0x98, 0x87, 0x79, 0x98, 0x81, 0x2c, 0xee,
-  0xf0, 0x0e, 0xee, 0xe0, 0x0e, 0xf5, 0xc0, 0x0e, 0xec, 0x30, 0x03, 0x62,
-  0xc8, 0xa1, 0x1c, 0xe4, 0xa1, 0x1c, 0xcc, 0xa1, 0x1c, 0xe4, 0xa1, 0x1c,
-  0xdc, 0x61, 0x1c, 0xca, 0x21, 0x1c, 0xc4, 0x81, 0x1d, 0xca, 0x61, 0x06,
-  0xd6, 0x90, 0x43, 0x39, 0xc8, 0x43, 0x39, 0x98, 0x43, 0x39, 0xc8, 0x43,
-  0x39, 0xb8, 0xc3, 0x38, 0x94, 0x43, 0x38, 0x88, 0x03, 0x3b, 0x94, 0xc3,
-  0x2f, 0xbc, 0x83, 0x3c, 0xfc, 0x82, 0x3b, 0xd4, 0x03, 0x3b, 0xb0, 0xc3,
-  0x0c, 0xc7, 0x69, 0x87, 0x70, 0x58, 0x87, 0x72, 0x70, 0x83, 0x74, 0x68,
-  0x07, 0x78, 0x60, 0x87, 0x74, 0x18, 0x87, 0x74, 0xa0, 0x87, 0x19, 0xce,
-  0x53, 0x0f, 0xee, 0x00, 0x0f, 0xf2, 0x50, 0x0e, 0xe4, 0x90, 0x0e, 0xe3,
-  0x40, 0x0f, 0xe1, 0x20, 0x0e, 0xec, 0x50, 0x0e, 0x33, 0x20, 0x28, 0x1d,
-  0xdc, 0xc1, 0x1e, 0xc2, 0x41, 0x1e, 0xd2, 0x21, 0x1c, 0xdc, 0x81, 0x1e,
-  0xdc, 0xe0, 0x1c, 0xe4, 0xe1, 0x1d, 0xea, 0x01, 0x1e, 0x66, 0x18, 0x51,
-  0x38, 0xb0, 0x43, 0x3a, 0x9c, 0x83, 0x3b, 0xcc, 0x50, 0x24, 0x76, 0x60,
-  0x07, 0x7b, 0x68, 0x07, 0x37, 0x60, 0x87, 0x77, 0x78, 0x07, 0x78, 0x98,
-  0x51, 0x4c, 0xf4, 0x90, 0x0f, 0xf0, 0x50, 0x0e, 0x33, 0x1e, 0x6a, 0x1e,
-  0xca, 0x61, 0x1c, 0xe8, 0x21, 0x1d, 0xde, 0xc1, 0x1d, 0x7e, 0x01, 0x1e,
-  0xe4, 0xa1, 0x1c, 0xcc, 0x21, 0x1d, 0xf0, 0x61, 0x06, 0x54, 0x85, 0x83,
-  0x38, 0xcc, 0xc3, 0x3b, 0xb0, 0x43, 0x3d, 0xd0, 0x43, 0x39, 0xfc, 0xc2,
-  0x3c, 0xe4, 0x43, 0x3b, 0x88, 0xc3, 0x3b, 0xb0, 0xc3, 0x8c, 0xc5, 0x0a,
-  0x87, 0x79, 0x98, 0x87, 0x77, 0x18, 0x87, 0x74, 0x08, 0x07, 0x7a, 0x28,
-  0x07, 0x72, 0x98, 0x81, 0x5c, 0xe3, 0x10, 0x0e, 0xec, 0xc0, 0x0e, 0xe5,
-  0x50, 0x0e, 0xf3, 0x30, 0x23, 0xc1, 0xd2, 0x41, 0x1e, 0xe4, 0xe1, 0x17,
-  0xd8, 0xe1, 0x1d, 0xde, 0x01, 0x1e, 0x66, 0x50, 0x59, 0x38, 0xa4, 0x83,
-  0x3c, 0xb8, 0x81, 0x39, 0xd4, 0x83, 0x3b, 0x8c, 0x03, 0x3d, 0xa4, 0xc3,
-  0x3b, 0xb8, 0xc3, 0x2f, 0x9c, 0x83, 0x3c, 0xbc, 0x43, 0x3d, 0xc0, 0xc3,
-  0x3c, 0x00, 0x79, 0x20, 0x00, 0x00, 0x5e, 0x02, 0x00, 0x00, 0x62, 0x1e,
-  0x48, 0x20, 0x43, 0x88, 0x0c, 0x19, 0x39, 0x19, 0x24, 0x90, 0x91, 0x40,
-  0xc6, 0xc8, 0xc8, 0x68, 0x22, 0x50, 0x08, 0x14, 0x32, 0x9e, 0x18, 0x19,
-  0x21, 0x47, 0xc8, 0x90, 0x51, 0x44, 0x07, 0x58, 0xd8, 0xc9, 0x00, 0x00,
-  0x00, 0x00, 0x8b, 0x62, 0x61, 0x1b, 0xb4, 0x41, 0x70, 0x50, 0x6c, 0x1c,
-  0x19, 0x44, 0x91, 0xc1, 0x28, 0x12, 0x83, 0x48, 0xd6, 0x53, 0x4c, 0x86,
-  0x00, 0x21, 0xc4, 0x30, 0x19, 0xd3, 0x23, 0x21, 0x14, 0x82, 0x54, 0x4a,
-  0x31, 0x0c, 0xc3, 0x30, 0x0c, 0x83, 0x11, 0x04, 0x04, 0x31, 0x0c, 0xc3,
-  0x10, 0x5d, 0xc8, 0x32, 0x0c, 0xc3, 0x70, 0x20, 0xd8, 0xa2, 0x38, 0xc9,
-  0x30, 0x0c, 0xc3, 0x30, 0x0c, 0x03, 0x82, 0x20, 0x48, 0x31, 0x2c, 0x8a,
-  0xc5, 0x24, 0x44, 0x94, 0x20, 0x46, 0xc3, 0x14, 0x45, 0x04, 0x53, 0x44,
-  0x4b, 0x20, 0x56, 0x65, 0x72, 0x73, 0x69, 0x6f, 0x6e, 0x77, 0x63, 0x68,
-  0x61, 0x72, 0x5f, 0x73, 0x69, 0x7a, 0x65, 0x61, 0x69, 0x72, 0x2e, 0x6d,
-  0x61, 0x78, 0x5f, 0x64, 0x65, 0x76, 0x69, 0x63, 0x65, 0x5f, 0x62, 0x75,
-  0x66, 0x66, 0x65, 0x72, 0x73, 0x61, 0x69, 0x72, 0x2e, 0x6d, 0x61, 0x78,
-  0x5f, 0x63, 0x6f, 0x6e, 0x73, 0x74, 0x61, 0x6e, 0x74, 0x5f, 0x62, 0x75,
-  0x66, 0x66, 0x65, 0x72, 0x73, 0x61, 0x69, 0x72, 0x2e, 0x6d, 0x61, 0x78,
-  0x5f, 0x74, 0x68, 0x72, 0x65, 0x61, 0x64, 0x67, 0x72, 0x6f, 0x75, 0x70,
-  0x5f, 0x62, 0x75, 0x66, 0x66, 0x65, 0x72, 0x73, 0x61, 0x69, 0x72, 0x2e,
-  0x6d, 0x61, 0x78, 0x5f, 0x74, 0x65, 0x78, 0x74, 0x75, 0x72, 0x65, 0x73,
-  0x61, 0x69, 0x72, 0x2e, 0x6d, 0x61, 0x78, 0x5f, 0x72, 0x65, 0x61, 0x64,
-  0x5f, 0x77, 0x72, 0x69, 0x74, 0x65, 0x5f, 0x74, 0x65, 0x78, 0x74, 0x75,
-  0x72, 0x65, 0x73, 0x61, 0x69, 0x72, 0x2e, 0x6d, 0x61, 0x78, 0x5f, 0x73,
-  0x61, 0x6d, 0x70, 0x6c, 0x65, 0x72, 0x73, 0x41, 0x70, 0x70, 0x6c, 0x65,
-  0x20, 0x4c, 0x4c, 0x56, 0x4d, 0x20, 0x76, 0x65, 0x72, 0x73, 0x69, 0x6f,
-  0x6e, 0x20, 0x33, 0x31, 0x30, 0x30, 0x31, 0x2e, 0x31, 0x38, 0x34, 0x20,
-  0x28, 0x6d, 0x65, 0x74, 0x61, 0x6c, 0x66, 0x65, 0x2d, 0x33, 0x31, 0x30,
-  0x30, 0x31, 0x2e, 0x31, 0x38, 0x34, 0x29, 0x4d, 0x65, 0x74, 0x61, 0x6c,
-  0x61, 0x69, 0x72, 0x2e, 0x63, 0x6f, 0x6d, 0x70, 0x69, 0x6c, 0x65, 0x2e,
-  0x64, 0x65, 0x6e, 0x6f, 0x72, 0x6d, 0x73, 0x5f, 0x64, 0x69, 0x73, 0x61,
-  0x62, 0x6c, 0x65, 0x61, 0x69, 0x72, 0x2e, 0x63, 0x6f, 0x6d, 0x70, 0x69,
-  0x6c, 0x65, 0x2e, 0x66, 0x61, 0x73, 0x74, 0x5f, 0x6d, 0x61, 0x74, 0x68,
-  0x5f, 0x65, 0x6e, 0x61, 0x62, 0x6c, 0x65, 0x61, 0x69, 0x72, 0x2e, 0x63,
-  0x6f, 0x6d, 0x70, 0x69, 0x6c, 0x65, 0x2e, 0x66, 0x72, 0x61, 0x6d, 0x65,
-  0x62, 0x75, 0x66, 0x66, 0x65, 0x72, 0x5f, 0x66, 0x65, 0x74, 0x63, 0x68,
-  0x5f, 0x65, 0x6e, 0x61, 0x62, 0x6c, 0x65, 0x61, 0x69, 0x72, 0x2e, 0x72,
-  0x65, 0x6e, 0x64, 0x65, 0x72, 0x5f, 0x74, 0x61, 0x72, 0x67, 0x65, 0x74,
-  0x61, 0x69, 0x72, 0x2e, 0x61, 0x72, 0x67, 0x5f, 0x74, 0x79, 0x70, 0x65,
-  0x5f, 0x6e, 0x61, 0x6d, 0x65, 0x66, 0x6c, 0x6f, 0x61, 0x74, 0x34, 0x61,
-  0x69, 0x72, 0x2e, 0x70, 0x6f, 0x73, 0x69, 0x74, 0x69, 0x6f, 0x6e, 0x61,
-  0x69, 0x72, 0x2e, 0x63, 0x65, 0x6e, 0x74, 0x65, 0x72, 0x61, 0x69, 0x72,
-  0x2e, 0x6e, 0x6f, 0x5f, 0x70, 0x65, 0x72, 0x73, 0x70, 0x65, 0x63, 0x74,
-  0x69, 0x76, 0x65, 0x61, 0x69, 0x72, 0x2e, 0x61, 0x72, 0x67, 0x5f, 0x6e,
-  0x61, 0x6d, 0x65, 0x70, 0x6f, 0x73, 0x69, 0x74, 0x69, 0x6f, 0x6e, 0x61,
-  0x69, 0x72, 0x2e, 0x66, 0x72, 0x61, 0x67, 0x6d, 0x65, 0x6e, 0x74, 0x5f,
-  0x69, 0x6e, 0x70, 0x75, 0x74, 0x67, 0x65, 0x6e, 0x65, 0x72, 0x61, 0x74,
-  0x65, 0x64, 0x28, 0x35, 0x63, 0x6f, 0x6c, 0x6f, 0x72, 0x44, 0x76, 0x34,
-  0x5f, 0x66, 0x29, 0x61, 0x69, 0x72, 0x2e, 0x70, 0x65, 0x72, 0x73, 0x70,
-  0x65, 0x63, 0x74, 0x69, 0x76, 0x65, 0x63, 0x6f, 0x6c, 0x6f, 0x72, 0x67,
-  0x65, 0x6e, 0x65, 0x72, 0x61, 0x74, 0x65, 0x64, 0x28, 0x32, 0x75, 0x76,
-  0x44, 0x76, 0x32, 0x5f, 0x66, 0x29, 0x66, 0x6c, 0x6f, 0x61, 0x74, 0x32,
-  0x75, 0x76, 0x67, 0x65, 0x6e, 0x65, 0x72, 0x61, 0x74, 0x65, 0x64, 0x28,
-  0x33, 0x74, 0x65, 0x78, 0x6a, 0x29, 0x61, 0x69, 0x72, 0x2e, 0x66, 0x6c,
-  0x61, 0x74, 0x75, 0x69, 0x6e, 0x74, 0x74, 0x65, 0x78, 0x67, 0x65, 0x6e,
-  0x65, 0x72, 0x61, 0x74, 0x65, 0x64, 0x28, 0x36, 0x5f, 0x64, 0x75, 0x6d,
-  0x6d, 0x79, 0x6a, 0x29, 0x5f, 0x64, 0x75, 0x6d, 0x6d, 0x79, 0x61, 0x69,
-  0x72, 0x2e, 0x69, 0x6e, 0x64, 0x69, 0x72, 0x65, 0x63, 0x74, 0x5f, 0x62,
-  0x75, 0x66, 0x66, 0x65, 0x72, 0x61, 0x69, 0x72, 0x2e, 0x62, 0x75, 0x66,
-  0x66, 0x65, 0x72, 0x5f, 0x73, 0x69, 0x7a, 0x65, 0x61, 0x69, 0x72, 0x2e,
-  0x6c, 0x6f, 0x63, 0x61, 0x74, 0x69, 0x6f, 0x6e, 0x5f, 0x69, 0x6e, 0x64,
-  0x65, 0x78, 0x61, 0x69, 0x72, 0x2e, 0x72, 0x65, 0x61, 0x64, 0x61, 0x69,
-  0x72, 0x2e, 0x73, 0x74, 0x72, 0x75, 0x63, 0x74, 0x5f, 0x74, 0x79, 0x70,
-  0x65, 0x5f, 0x69, 0x6e, 0x66, 0x6f, 0x56, 0x65, 0x72, 0x74, 0x65, 0x78,
-  0x33, 0x44, 0x76, 0x65, 0x72, 0x74, 0x69, 0x63, 0x65, 0x73, 0x61, 0x69,
-  0x72, 0x2e, 0x69, 0x6e, 0x64, 0x69, 0x72, 0x65, 0x63, 0x74, 0x5f, 0x61,
-  0x72, 0x67, 0x75, 0x6d, 0x65, 0x6e, 0x74, 0x61, 0x69, 0x72, 0x2e, 0x62,
-  0x75, 0x66, 0x66, 0x65, 0x72, 0x66, 0x6c, 0x6f, 0x61, 0x74, 0x76, 0x5f,
-  0x78, 0x76, 0x5f, 0x79, 0x76, 0x5f, 0x7a, 0x76, 0x5f, 0x77, 0x6e, 0x5f,
-  0x78, 0x6e, 0x5f, 0x79, 0x6e, 0x5f, 0x7a, 0x6d, 0x61, 0x74, 0x5f, 0x69,
-  0x64, 0x75, 0x76, 0x70, 0x61, 0x64, 0x30, 0x70, 0x61, 0x64, 0x31, 0x74,
-  0x5f, 0x78, 0x74, 0x5f, 0x79, 0x74, 0x5f, 0x7a, 0x74, 0x5f, 0x77, 0x61,
-  0x69, 0x72, 0x2e, 0x61, 0x72, 0x67, 0x5f, 0x74, 0x79, 0x70, 0x65, 0x5f,
-  0x73, 0x69, 0x7a, 0x65, 0x61, 0x69, 0x72, 0x2e, 0x61, 0x72, 0x67, 0x5f,
-  0x74, 0x79, 0x70, 0x65, 0x5f, 0x61, 0x6c, 0x69, 0x67, 0x6e, 0x5f, 0x73,
-  0x69, 0x7a, 0x65, 0x56, 0x65, 0x72, 0x74, 0x65, 0x78, 0x32, 0x44, 0x76,
-  0x65, 0x72, 0x74, 0x69, 0x63, 0x65, 0x73, 0x5f, 0x32, 0x64, 0x63, 0x5f,
-  0x72, 0x63, 0x5f, 0x67, 0x63, 0x5f, 0x62, 0x63, 0x5f, 0x61, 0x54, 0x65,
-  0x78, 0x74, 0x75, 0x72, 0x65, 0x74, 0x65, 0x78, 0x74, 0x75, 0x72, 0x65,
-  0x73, 0x74, 0x65, 0x78, 0x74, 0x75, 0x72, 0x65, 0x32, 0x64, 0x3c, 0x66,
-  0x6c, 0x6f, 0x61, 0x74, 0x2c, 0x20, 0x73, 0x61, 0x6d, 0x70, 0x6c, 0x65,
-  0x3e, 0x61, 0x69, 0x72, 0x2e, 0x74, 0x65, 0x78, 0x74, 0x75, 0x72, 0x65,
-  0x61, 0x69, 0x72, 0x2e, 0x73, 0x61, 0x6d, 0x70, 0x6c, 0x65, 0x44, 0x65,
-  0x76, 0x69, 0x63, 0x65, 0x4d, 0x61, 0x74, 0x65, 0x72, 0x69, 0x61, 0x6c,
-  0x6d, 0x61, 0x74, 0x65, 0x72, 0x69, 0x61, 0x6c, 0x73, 0x61, 0x5f, 0x72,
-  0x61, 0x5f, 0x67, 0x61, 0x5f, 0x62, 0x61, 0x5f, 0x61, 0x73, 0x5f, 0x72,
-  0x73, 0x5f, 0x67, 0x73, 0x5f, 0x62, 0x73, 0x5f, 0x61, 0x70, 0x61, 0x72,
-  0x61, 0x6d, 0x73, 0x5f, 0x78, 0x70, 0x61, 0x72, 0x61, 0x6d, 0x73, 0x5f,
-  0x79, 0x70, 0x61, 0x72, 0x61, 0x6d, 0x73, 0x5f, 0x7a, 0x70, 0x61, 0x72,
-  0x61, 0x6d, 0x73, 0x5f, 0x77, 0x66, 0x6c, 0x61, 0x67, 0x73, 0x69, 0x6e,
-  0x74, 0x64, 0x69, 0x66, 0x66, 0x75, 0x73, 0x65, 0x5f, 0x6d, 0x61, 0x70,
-  0x6e, 0x6f, 0x72, 0x6d, 0x61, 0x6c, 0x5f, 0x6d, 0x61, 0x70, 0x6d, 0x65,
-  0x74, 0x61, 0x6c, 0x6c, 0x69, 0x63, 0x5f, 0x72, 0x6f, 0x75, 0x67, 0x68,
-  0x6e, 0x65, 0x73, 0x73, 0x5f, 0x6d, 0x61, 0x70, 0x65, 0x6d, 0x69, 0x73,
-  0x73, 0x69, 0x76, 0x65, 0x5f, 0x6d, 0x61, 0x70, 0x73, 0x68, 0x65, 0x65,
-  0x6e, 0x5f, 0x6d, 0x61, 0x70, 0x70, 0x61, 0x64, 0x32, 0x49, 0x6e, 0x73,
-  0x74, 0x61, 0x6e, 0x63, 0x65, 0x54, 0x72, 0x61, 0x6e, 0x73, 0x66, 0x6f,
-  0x72, 0x6d, 0x69, 0x6e, 0x73, 0x74, 0x61, 0x6e, 0x63, 0x65, 0x73, 0x66,
-  0x6c, 0x6f, 0x61, 0x74, 0x34, 0x78, 0x34, 0x6d, 0x61, 0x74, 0x72, 0x69,
-  0x78, 0x6e, 0x6f, 0x72, 0x6d, 0x61, 0x6c, 0x5f, 0x6d, 0x61, 0x74, 0x72,
-  0x69, 0x78, 0x69, 0x6e, 0x73, 0x74, 0x61, 0x6e, 0x63, 0x65, 0x73, 0x5f,
-  0x32, 0x64, 0x53, 0x63, 0x65, 0x6e, 0x65, 0x73, 0x63, 0x65, 0x6e, 0x65,
-  0x61, 0x69, 0x72, 0x2e, 0x73, 0x61, 0x6d, 0x70, 0x6c, 0x65, 0x72, 0x5f,
-  0x73, 0x74, 0x61, 0x74, 0x65, 0x00, 0x06, 0xd8, 0x01, 0x00, 0x00, 0x00,
-  0x00, 0x00, 0x30, 0x82, 0x50, 0x2c, 0x23, 0x08, 0x66, 0xb0, 0x06, 0x23,
-  0x08, 0x05, 0x33, 0x82, 0x50, 0x34, 0x23, 0x08, 0x85, 0x33, 0x82, 0x50,
-  0x3c, 0x23, 0x08, 0x05, 0x34, 0x82, 0x50, 0x44, 0x23, 0x08, 0x85, 0x34,
-  0x82, 0x50, 0x4c, 0x23, 0x08, 0x05, 0x35, 0x82, 0x90, 0x05, 0x23, 0x08,
-  0x45, 0x35, 0x82, 0x50, 0x58, 0x23, 0x08, 0xc5, 0x35, 0x82, 0x50, 0x60,
-  0x23, 0x08, 0x45, 0x36, 0x82, 0x50, 0x68, 0x23, 0x08, 0xc5, 0x36, 0x82,
-  0x50, 0x70, 0x23, 0x08, 0x45, 0x37, 0x82, 0x50, 0x78, 0x23, 0x08, 0xc5,
-  0x37, 0x82, 0x50, 0x80, 0xc1, 0x08, 0x42, 0x11, 0x06, 0x23, 0x08, 0x85,
-  0x18, 0x8c, 0x20, 0x14, 0x63, 0x30, 0x82, 0x50, 0x90, 0xc1, 0x08, 0x42,
-  0x51, 0x06, 0x23, 0x08, 0x85, 0x19, 0x8c, 0x20, 0x14, 0x67, 0x30, 0x82,
-  0x50, 0xa0, 0xc1, 0x08, 0x42, 0x91, 0x06, 0x23, 0x08, 0x85, 0x1a, 0x8c,
-  0x20, 0x04, 0xc0, 0x0c, 0x43, 0x3a, 0x04, 0xea, 0x30, 0xc3, 0xb0, 0x0e,
-  0x02, 0x3b, 0xcc, 0x30, 0xb4, 0xc3, 0xe0, 0x0e, 0x33, 0x0c, 0xed, 0x40,
-  0xb8, 0xc3, 0x0c, 0x43, 0x3b, 0x14, 0xee, 0x30, 0xc3, 0xd0, 0x0e, 0xc6,
-  0x3b, 0xcc, 0x30, 0xb4, 0xc3, 0x01, 0x0f, 0x33, 0x0c, 0xed, 0x80, 0xc4,
-  0xc3, 0x0c, 0x41, 0x32, 0xc3, 0x90, 0x0e, 0xf2, 0x30, 0x0f, 0x33, 0x10,
-  0x4a, 0x3a, 0xc8, 0xc3, 0x3c, 0xcc, 0x10, 0x2c, 0x33, 0x04, 0xcc, 0x0c,
-  0x41, 0x33, 0x43, 0xe1, 0xcc, 0xc3, 0x3c, 0x3c, 0xd0, 0x0c, 0x81, 0x4e,
-  0xcc, 0x80, 0xcc, 0x43, 0x24, 0x4d, 0x0f, 0x44, 0x55, 0x33, 0x24, 0xeb,
-  0x60, 0x5d, 0x12, 0xf6, 0x40, 0x54, 0x36, 0x43, 0x92, 0x0e, 0x96, 0x26,
-  0x61, 0xcf, 0x46, 0x71, 0x33, 0x20, 0xf2, 0x60, 0x75, 0xde, 0xf3, 0x51,
-  0x60, 0x30, 0x03, 0xc2, 0x0e, 0x56, 0x18, 0x78, 0xcf, 0x47, 0x89, 0xc1,
-  0x0c, 0xb0, 0x30, 0x0f, 0xec, 0x30, 0x0f, 0x6c, 0xd0, 0x06, 0xec, 0xc0,
-  0x0e, 0xf3, 0xc0, 0x06, 0x6e, 0x00, 0x0f, 0xec, 0x30, 0x0f, 0x6c, 0xf0,
-  0x06, 0xf7, 0xc0, 0x0e, 0xf3, 0xc0, 0x06, 0x70, 0x10, 0x0f, 0xec, 0x30,
-  0x0f, 0x6c, 0x10, 0x07, 0xf8, 0xc0, 0x0e, 0xf3, 0xc0, 0x06, 0x72, 0x90,
-  0x0f, 0xec, 0x30, 0x0f, 0x6c, 0x30, 0x07, 0xfa, 0xc0, 0x0e, 0xf3, 0xf0,
-  0xd1, 0xc1, 0x3e, 0xb0, 0xc3, 0x3c, 0xb0, 0x41, 0x1d, 0xf0, 0x03, 0x3b,
-  0xcc, 0x03, 0x1b, 0xd8, 0x41, 0x3f, 0xb0, 0xc3, 0x3c, 0xb0, 0xc1, 0x1d,
-  0xf8, 0x03, 0x3b, 0xcc, 0x03, 0x1b, 0xe0, 0x81, 0x3d, 0xb0, 0xc3, 0x3c,
-  0xb0, 0x41, 0x1e, 0xfc, 0x03, 0x3b, 0xcc, 0x03, 0x1b, 0xe8, 0x01, 0x48,
-  0xb0, 0xc3, 0x3c, 0xb0, 0xc1, 0x1e, 0x84, 0x04, 0x3b, 0xcc, 0x03, 0x1b,
-  0xf0, 0xc1, 0x0c, 0xd0, 0x3c, 0xac, 0x41, 0x19, 0xcc, 0xc3, 0x3a, 0x98,
-  0xc1, 0x19, 0x84, 0x45, 0x1f, 0x88, 0x84, 0x1f, 0xb0, 0xc3, 0x83, 0x06,
-  0x54, 0x1a, 0xcc, 0x20, 0x07, 0xf3, 0xc0, 0x0e, 0xf3, 0xc0, 0x06, 0x6d,
-  0xc0, 0x0e, 0xec, 0x30, 0x0f, 0x6c, 0xe0, 0x06, 0xf0, 0xc0, 0x0e, 0xf3,
-  0xc0, 0x06, 0x6f, 0x70, 0x0f, 0xec, 0x30, 0x0f, 0x1f, 0x18, 0xc4, 0x03,
-  0x3b, 0xcc, 0x03, 0x1b, 0xd4, 0x01, 0x3e, 0xb0, 0xc3, 0x3c, 0xb0, 0x81,
-  0x1d, 0xe4, 0x03, 0x3b, 0xcc, 0x03, 0x1b, 0x84, 0x82, 0x3e, 0xb0, 0xc3,
-  0x3c, 0xb0, 0x81, 0x28, 0xec, 0x03, 0x3b, 0xcc, 0x03, 0x1b, 0x8c, 0x02,
-  0x3f, 0xb0, 0xc3, 0x3c, 0xb0, 0x01, 0x29, 0xcc, 0x00, 0xad, 0xc3, 0x1a,
-  0x94, 0xc1, 0x3a, 0xac, 0x83, 0x19, 0x9c, 0xc1, 0x58, 0xf4, 0x41, 0x3f,
-  0xf8, 0x01, 0x3b, 0x3c, 0x7f, 0x40, 0x81, 0xc2, 0x0c, 0xca, 0x3c, 0xa0,
-  0x42, 0x19, 0xcc, 0xc3, 0x3a, 0xa4, 0xc2, 0x73, 0x0a, 0x14, 0x18, 0xcc,
-  0x70, 0xcc, 0x03, 0x3c, 0xcc, 0xc3, 0x29, 0x80, 0x81, 0x1a, 0x94, 0xc5,
-  0x0c, 0x50, 0x3a, 0x8c, 0x41, 0x19, 0xa4, 0xc3, 0x3a, 0x98, 0xc1, 0x19,
-  0x98, 0x45, 0x1f, 0xc0, 0x83, 0x1f, 0xc0, 0xc3, 0x53, 0x0a, 0x94, 0x29,
-  0xcc, 0x80, 0x0f, 0xf3, 0xc0, 0x0e, 0xf3, 0xc0, 0x06, 0xa1, 0xc0, 0x0e,
-  0xec, 0x30, 0x0f, 0x6c, 0x20, 0x0a, 0xf0, 0xc0, 0x0e, 0xf3, 0xc0, 0x06,
-  0xa3, 0x70, 0x0f, 0xec, 0x30, 0x0f, 0x6c, 0x40, 0x0a, 0xf1, 0xc0, 0x0e,
-  0xf3, 0xc0, 0x06, 0xac, 0x80, 0x0f, 0xec, 0x30, 0x0f, 0x6c, 0xd0, 0x0a,
-  0xf9, 0xc0, 0x0e, 0xf3, 0xc0, 0x06, 0xae, 0xa0, 0x0f, 0xec, 0x30, 0x0f,
-  0x6c, 0xf0, 0x0a, 0xfb, 0xc0, 0x0e, 0xf3, 0xc0, 0x06, 0xb0, 0xc0, 0x0f,
-  0xec, 0x30, 0x0f, 0x6c, 0x10, 0x0b, 0xfd, 0xc0, 0x0e, 0xf3, 0xc0, 0x06,
-  0xb2, 0xe0, 0x0f, 0xec, 0x30, 0x0f, 0x6c, 0x30, 0x0b, 0xf6, 0xc0, 0x0e,
-  0xf3, 0xf0, 0xd1, 0xc2, 0x3f, 0xb0, 0xc3, 0x3c, 0x7c, 0xb5, 0x00, 0x12,
-  0xec, 0x30, 0x0f, 0x9f, 0x2d, 0x84, 0x04, 0x3b, 0xcc, 0xc3, 0x77, 0x0b,
-  0x22, 0xc1, 0x0e, 0xf3, 0xf0, 0xe1, 0xc2, 0x48, 0xb0, 0xc3, 0x3c, 0xe4,
-  0x82, 0x2e, 0x90, 0x04, 0x3b, 0xcc, 0x43, 0x2e, 0xec, 0x42, 0x49, 0xb0,
-  0xc3, 0x3c, 0xe4, 0x02, 0x2f, 0x98, 0x04, 0x3b, 0xcc, 0x43, 0x2e, 0xf4,
-  0xc2, 0x49, 0xb0, 0xc3, 0x3c, 0xe4, 0x82, 0x2f, 0xa0, 0x04, 0x3b, 0xcc,
-  0x03, 0x1b, 0xe0, 0x41, 0x4a, 0xb0, 0xc3, 0x3c, 0xb0, 0xc1, 0x2f, 0xcc,
-  0x00, 0xc9, 0xc3, 0x1a, 0x94, 0x81, 0x3c, 0xac, 0x83, 0x19, 0x9c, 0x01,
-  0x5a, 0xf4, 0x81, 0x4a, 0xf8, 0x01, 0x3b, 0x3c, 0xaa, 0x40, 0xad, 0xc2,
-  0x0c, 0xca, 0x3c, 0x88, 0xc4, 0x3c, 0x88, 0xc3, 0x38, 0x88, 0x84, 0x48,
-  0xcc, 0x83, 0x38, 0x90, 0xc3, 0x0c, 0x10, 0x3b, 0xac, 0x41, 0x19, 0xb0,
-  0xc3, 0x3a, 0x98, 0xc1, 0x19, 0xa8, 0x45, 0x1f, 0xbc, 0x83, 0x1f, 0xc4,
-  0xc3, 0x03, 0x0e, 0x54, 0x38, 0xcc, 0xe0, 0xd4, 0xc3, 0x1a, 0x94, 0x41,
-  0x3d, 0xac, 0x83, 0x19, 0xf4, 0x81, 0x48, 0xf8, 0x41, 0x3c, 0x3c, 0xe2,
-  0x40, 0x95, 0xc3, 0x0c, 0x6a, 0x30, 0x0f, 0xf0, 0x30, 0x0f, 0x68, 0x90,
-  0x06, 0x6a, 0x20, 0x16, 0xf0, 0x00, 0x0f, 0xf3, 0xf0, 0x07, 0xa0, 0xa0,
-  0x06, 0x64, 0x11, 0x0f, 0xf0, 0x30, 0x0f, 0xa5, 0x60, 0x0a, 0x6a, 0x70,
-  0x16, 0xf9, 0x00, 0x0f, 0xf3, 0xa0, 0x0a, 0xab, 0xa0, 0x06, 0x69, 0xb1,
-  0x0f, 0xf0, 0x30, 0x0f, 0xe0, 0x10, 0x0e, 0x6a, 0xb0, 0x16, 0xfd, 0x00,
-  0x0f, 0xf3, 0x20, 0x0e, 0xe5, 0xa0, 0x06, 0x6c, 0x31, 0x83, 0x54, 0x0f,
-  0x63, 0x40, 0x06, 0xf6, 0x50, 0x06, 0xf3, 0xb0, 0x0e, 0x66, 0x70, 0x06,
-  0x6d, 0xd1, 0x07, 0xf6, 0xe0, 0x07, 0xf0, 0xf0, 0x98, 0x03, 0x75, 0x0e,
-  0x33, 0x18, 0x3c, 0xd1, 0x13, 0x3e, 0xf1, 0x13, 0x60, 0xe1, 0x16, 0x33,
-  0x0c, 0xf4, 0xb0, 0x13, 0x6f, 0x31, 0x83, 0x80, 0x0e, 0x2b, 0x71, 0xa9,
-  0x00, 0x70, 0x68, 0xc0, 0x71, 0x1c, 0xc7, 0x71, 0x1c, 0xc7, 0x71, 0x1c,
-  0xc7, 0x71, 0x1c, 0xc7, 0x71, 0x1c, 0xc7, 0x89, 0x81, 0x18, 0x88, 0x81,
-  0x18, 0x88, 0x81, 0x18, 0x88, 0x81, 0x18, 0x88, 0x81, 0x18, 0x88, 0x01,
-  0xe7, 0x06, 0x6e, 0xe0, 0x06, 0x6e, 0xe0, 0x06, 0x6e, 0xe0, 0x06, 0x6e,
-  0x60, 0xd1, 0x81, 0x1e, 0x58, 0x96, 0xa5, 0x07, 0x9c, 0x29, 0xb0, 0x02,
-  0x2b, 0xb0, 0x82, 0x2c, 0xc0, 0x1e, 0x69, 0xa0, 0x13, 0x69, 0xf0, 0x03,
-  0x39, 0x90, 0x06, 0xce, 0x06, 0xa4, 0x81, 0x12, 0xa4, 0xc1, 0x16, 0x2e,
-  0xc4, 0x1b, 0xb8, 0x40, 0x07, 0x32, 0x12, 0x98, 0xa0, 0x8c, 0xd8, 0xd8,
-  0xec, 0xda, 0x5c, 0xda, 0xde, 0xc8, 0xea, 0xd8, 0xca, 0x5c, 0xcc, 0xd8,
-  0xc2, 0xce, 0xe6, 0x46, 0x41, 0x56, 0x82, 0x25, 0x5a, 0xc2, 0x25, 0x5e,
-  0x02, 0x26, 0x62, 0x42, 0x26, 0x52, 0x61, 0x63, 0xb3, 0x6b, 0x73, 0x49,
-  0x23, 0x2b, 0x73, 0xa3, 0x1b, 0x25, 0x98, 0x89, 0x5c, 0xc2, 0xd2, 0xe4,
-  0x5c, 0xec, 0xca, 0xe4, 0xe6, 0xd2, 0xde, 0xdc, 0x46, 0x09, 0x68, 0x22,
-  0xa9, 0xb0, 0x34, 0x39, 0x17, 0xb6, 0x30, 0xb7, 0xb3, 0xba, 0xb0, 0xb3,
-  0xb2, 0x2f, 0xbb, 0x32, 0xb9, 0xb9, 0xb4, 0x37, 0xb7, 0x51, 0x82, 0x9a,
-  0xc8, 0x29, 0x2c, 0x4d, 0xce, 0x65, 0xec, 0xad, 0x0d, 0x2e, 0x8d, 0xad,
-  0xec, 0xeb, 0x0d, 0x8e, 0x2e, 0xed, 0xcd, 0x6d, 0x6e, 0x94, 0xc1, 0x26,
-  0x6e, 0x02, 0x27, 0x92, 0x09, 0x4b, 0x93, 0x73, 0x31, 0x93, 0x0b, 0x3b,
-  0x6b, 0x2b, 0x73, 0xa3, 0x1b, 0x25, 0x78, 0x8b, 0x94, 0xc2, 0xd2, 0xe4,
-  0x5c, 0xe6, 0xc2, 0xda, 0xe0, 0xd8, 0xca, 0xe4, 0xbe, 0xe6, 0xe8, 0xc2,
-  0xe8, 0xca, 0xe6, 0x46, 0x09, 0xe0, 0x02, 0x00, 0x00, 0x00, 0xa9, 0x18,
-  0x00, 0x00, 0x0b, 0x00, 0x00, 0x00, 0x0b, 0x0a, 0x72, 0x28, 0x87, 0x77,
-  0x80, 0x07, 0x7a, 0x58, 0x70, 0x98, 0x43, 0x3d, 0xb8, 0xc3, 0x38, 0xb0,
-  0x43, 0x39, 0xd0, 0xc3, 0x82, 0xe6, 0x1c, 0xc6, 0xa1, 0x0d, 0xe8, 0x41,
-  0x1e, 0xc2, 0xc1, 0x1d, 0xe6, 0x21, 0x1d, 0xe8, 0x21, 0x1d, 0xde, 0xc1,
-  0x1d, 0x00, 0xd1, 0x10, 0x00, 0x00, 0x06, 0x00, 0x00, 0x00, 0x07, 0xcc,
-  0x3c, 0xa4, 0x83, 0x3b, 0x9c, 0x03, 0x3b, 0x94, 0x03, 0x3d, 0xa0, 0x83,
-  0x3c, 0x94, 0x43, 0x38, 0x90, 0xc3, 0x01, 0x00, 0x00, 0x00, 0x61, 0x20,
-  0x00, 0x00, 0x5c, 0x00, 0x00, 0x00, 0x13, 0x04, 0x45, 0x2c, 0x10, 0x00,
-  0x00, 0x00, 0x05, 0x00, 0x00, 0x00, 0x04, 0x94, 0x01, 0x85, 0x35, 0x30,
-  0x02, 0x40, 0xe2, 0x08, 0x00, 0x09, 0x23, 0x00, 0x04, 0xda, 0x06, 0x00,
-  0x00, 0x00, 0xf1, 0x30, 0x00, 0x00, 0x36, 0x00, 0x00, 0x00, 0x22, 0x47,
-  0xc8, 0x90, 0x51, 0x1a, 0xc8, 0x3d, 0x00, 0x00, 0x00, 0x00, 0xca, 0xf2,
-  0x3c, 0x68, 0x40, 0x01, 0x00, 0x00, 0x5f, 0x5a, 0x54, 0x53, 0x35, 0x53,
-  0x63, 0x65, 0x6e, 0x65, 0x61, 0x6e, 0x79, 0x20, 0x70, 0x6f, 0x69, 0x6e,
-  0x74, 0x65, 0x72, 0x6f, 0x6d, 0x6e, 0x69, 0x70, 0x6f, 0x74, 0x65, 0x6e,
-  0x74, 0x20, 0x63, 0x68, 0x61, 0x72, 0x53, 0x69, 0x6d, 0x70, 0x6c, 0x65,
-  0x20, 0x43, 0x2b, 0x2b, 0x20, 0x54, 0x42, 0x41, 0x41, 0x5f, 0x5a, 0x54,
-  0x53, 0x4e, 0x35, 0x6d, 0x65, 0x74, 0x61, 0x6c, 0x39, 0x74, 0x65, 0x78,
-  0x74, 0x75, 0x72, 0x65, 0x32, 0x64, 0x49, 0x66, 0x4c, 0x4e, 0x53, 0x5f,
-  0x36, 0x61, 0x63, 0x63, 0x65, 0x73, 0x73, 0x45, 0x30, 0x45, 0x76, 0x45,
-  0x45, 0x5f, 0x5f, 0x6d, 0x65, 0x74, 0x61, 0x6c, 0x5f, 0x74, 0x65, 0x78,
-  0x74, 0x75, 0x72, 0x65, 0x5f, 0x32, 0x64, 0x5f, 0x74, 0x00, 0x13, 0x04,
-  0xa0, 0x98, 0x20, 0x00, 0xc6, 0x04, 0x01, 0x38, 0x26, 0x08, 0x00, 0x32,
-  0x41, 0x00, 0x92, 0x09, 0x02, 0xa0, 0x6c, 0x08, 0xea, 0x62, 0xc3, 0x40,
-  0x17, 0x7e, 0x81, 0x17, 0x1b, 0x86, 0xb9, 0xf8, 0x0b, 0xbc, 0xd8, 0xd0,
-  0xc8, 0x05, 0x68, 0xe0, 0x05, 0x68, 0xe4, 0x05, 0x68, 0xe8, 0x05, 0x68,
-  0xec, 0x05, 0x68, 0xf0, 0x05, 0x68, 0xf4, 0xc5, 0x86, 0x21, 0x34, 0x40,
-  0x43, 0x2f, 0x36, 0x0c, 0x77, 0xf1, 0x17, 0x78, 0xb1, 0x61, 0xb0, 0x8b,
-  0xd1, 0xc0, 0x8b, 0x0d, 0x03, 0x69, 0x8c, 0x06, 0x5e, 0x00, 0xc3, 0x0d,
-  0x09, 0x19, 0x80, 0xc1, 0x2c, 0x83, 0x10, 0x04, 0xdb, 0x1a, 0x10, 0x3a,
-  0x70, 0x03, 0x0a, 0x1c, 0x72, 0x0c, 0x10, 0xbb, 0x21, 0x84, 0x00, 0x0d,
-  0xd0, 0x80, 0x82, 0x85, 0x8c, 0x18, 0x34, 0x43, 0x08, 0x82, 0xc1, 0x18,
-  0xec, 0x41, 0x70, 0x40, 0x4b, 0xa2, 0x20, 0x88, 0x1a, 0x8c, 0x26, 0x04,
-  0x80, 0x05, 0x93, 0xf8, 0xcf, 0x12, 0x08, 0x03, 0x15, 0x83, 0x10, 0xa0,
-  0x01, 0x30, 0x86, 0x10, 0x40, 0xc3, 0x11, 0x41, 0xa3, 0xf8, 0xc7, 0x2c,
-  0x03, 0x31, 0x04, 0x23, 0x06, 0x84, 0x10, 0x82, 0x60, 0xb0, 0x89, 0xc2,
-  0x2c, 0x01, 0x91, 0x43, 0x40, 0x0c, 0x03, 0x00, 0x00, 0x00, 0x5b, 0x86,
-  0x21, 0x08, 0x8d, 0x2d, 0x83, 0x11, 0x90, 0x06, 0x00, 0x00, 0x00, 0x00,
-  0x00, 0x00, 0x71, 0x20, 0x00, 0x00, 0x03, 0x00, 0x00, 0x00, 0x32, 0x0e,
-  0x10, 0x22, 0x84, 0x01, 0x94, 0x09, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-  0x00, 0x00, 0x65, 0x0c, 0x00, 0x00, 0x2f, 0x00, 0x00, 0x00, 0x12, 0x03,
-  0x94, 0x70, 0x01, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x56, 0x00,
-  0x00, 0x00, 0x09, 0x00, 0x00, 0x00, 0x44, 0x00, 0x00, 0x00, 0x01, 0x00,
-  0x00, 0x00, 0x50, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x50, 0x00,
-  0x00, 0x00, 0x04, 0x00, 0x00, 0x00, 0xb0, 0x00, 0x00, 0x00, 0x00, 0x00,
-  0x00, 0x00, 0x5f, 0x00, 0x00, 0x00, 0x18, 0x00, 0x00, 0x00, 0x13, 0x00,
-  0x00, 0x00, 0x14, 0x00, 0x00, 0x00, 0x77, 0x00, 0x00, 0x00, 0x00, 0x00,
-  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x04, 0x00, 0x00, 0x00, 0x00, 0x00,
-  0x00, 0x00, 0x13, 0x00, 0x00, 0x00, 0x14, 0x00, 0x00, 0x00, 0x13, 0x00,
-  0x00, 0x00, 0x14, 0x00, 0x00, 0x00, 0xff, 0xff, 0xff, 0xff, 0x00, 0x24,
-  0x00, 0x00, 0x27, 0x00, 0x00, 0x00, 0x14, 0x00, 0x00, 0x00, 0x27, 0x00,
-  0x00, 0x00, 0x14, 0x00, 0x00, 0x00, 0xff, 0xff, 0xff, 0xff, 0x08, 0x24,
-  0x00, 0x00, 0x3b, 0x00, 0x00, 0x00, 0x1b, 0x00, 0x00, 0x00, 0x3b, 0x00,
-  0x00, 0x00, 0x1b, 0x00, 0x00, 0x00, 0xff, 0xff, 0xff, 0xff, 0x08, 0x24,
-  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x13, 0x00, 0x00, 0x00, 0x00, 0x00,
-  0x00, 0x00, 0x13, 0x00, 0x00, 0x00, 0xff, 0xff, 0xff, 0xff, 0x00, 0x00,
-  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x5d, 0x0c, 0x00, 0x00, 0x21, 0x00,
-  0x00, 0x00, 0x12, 0x03, 0x94, 0xf7, 0x00, 0x00, 0x00, 0x00, 0x5f, 0x5f,
-  0x61, 0x69, 0x72, 0x5f, 0x73, 0x61, 0x6d, 0x70, 0x6c, 0x65, 0x72, 0x5f,
-  0x73, 0x74, 0x61, 0x74, 0x65, 0x74, 0x72, 0x69, 0x61, 0x6e, 0x67, 0x6c,
-  0x65, 0x5f, 0x66, 0x72, 0x61, 0x67, 0x6d, 0x65, 0x6e, 0x74, 0x5f, 0x32,
-  0x64, 0x61, 0x69, 0x72, 0x2e, 0x64, 0x69, 0x73, 0x63, 0x61, 0x72, 0x64,
-  0x5f, 0x66, 0x72, 0x61, 0x67, 0x6d, 0x65, 0x6e, 0x74, 0x61, 0x69, 0x72,
-  0x2e, 0x73, 0x61, 0x6d, 0x70, 0x6c, 0x65, 0x5f, 0x74, 0x65, 0x78, 0x74,
-  0x75, 0x72, 0x65, 0x5f, 0x32, 0x64, 0x2e, 0x76, 0x34, 0x66, 0x33, 0x32,
-  0x33, 0x31, 0x30, 0x30, 0x31, 0x2e, 0x31, 0x38, 0x34, 0x61, 0x69, 0x72,
-  0x36, 0x34, 0x2d, 0x61, 0x70, 0x70, 0x6c, 0x65, 0x2d, 0x6d, 0x61, 0x63,
-  0x6f, 0x73, 0x78, 0x31, 0x31, 0x2e, 0x30, 0x2e, 0x30, 0x00, 0x00, 0x00,
-  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-  0x00, 0x00, 0xde, 0xc0, 0x17, 0x0b, 0x00, 0x00, 0x00, 0x00, 0x14, 0x00,
-  0x00, 0x00, 0x10, 0x15, 0x00, 0x00, 0xff, 0xff, 0xff, 0xff, 0x42, 0x43,
-  0xc0, 0xde, 0x35, 0x14, 0x00, 0x00, 0x03, 0x00, 0x00, 0x00, 0x62, 0x0c,
-  0x30, 0x24, 0x80, 0x10, 0x05, 0xc8, 0x14, 0x00, 0x00, 0x00, 0x21, 0x0c,
-  0x00, 0x00, 0xfe, 0x04, 0x00, 0x00, 0x0b, 0x02, 0x21, 0x00, 0x02, 0x00,
-  0x00, 0x00, 0x13, 0x00, 0x00, 0x00, 0x07, 0x81, 0x23, 0x91, 0x41, 0xc8,
-  0x04, 0x49, 0x06, 0x10, 0x32, 0x39, 0x92, 0x01, 0x84, 0x0c, 0x25, 0x05,
-  0x08, 0x19, 0x1e, 0x04, 0x8b, 0x62, 0x80, 0x18, 0x45, 0x02, 0x42, 0x92,
-  0x0b, 0x42, 0xc4, 0x10, 0x32, 0x14, 0x38, 0x08, 0x18, 0x4b, 0x0a, 0x32,
-  0x62, 0x88, 0x48, 0x90, 0x14, 0x20, 0x43, 0x46, 0x88, 0xa5, 0x00, 0x19,
-  0x32, 0x42, 0x04, 0x49, 0x0e, 0x90, 0x11, 0x23, 0xc4, 0x50, 0x41, 0x51,
-  0x81, 0x8c, 0xe1, 0x83, 0xe5, 0x8a, 0x04, 0x31, 0x46, 0x06, 0x89, 0x20,
-  0x00, 0x00, 0x57, 0x00, 0x00, 0x00, 0x32, 0x22, 0x88, 0x09, 0x20, 0x64,
-  0x85, 0x04, 0x13, 0x23, 0xa4, 0x84, 0x04, 0x13, 0x23, 0xe3, 0x84, 0xa1,
-  0x90, 0x14, 0x12, 0x4c, 0x8c, 0x8c, 0x0b, 0x84, 0xc4, 0x4c, 0x10, 0x94,
-  0xc1, 0x28, 0xc0, 0x30, 0x02, 0x01, 0xcc, 0x00, 0x0c, 0x23, 0x10, 0xc2,
-  0x30, 0xc2, 0x00, 0xcc, 0x11, 0x40, 0xc3, 0x08, 0x82, 0x30, 0x47, 0x00,
-  0x06, 0xf7, 0x48, 0x53, 0x44, 0x09, 0x93, 0xff, 0x12, 0xd1, 0x44, 0x5c,
-  0x77, 0x87, 0x20, 0x41, 0x10, 0x04, 0x41, 0x10, 0x0e, 0x41, 0x10, 0x04,
-  0x41, 0x10, 0x84, 0x41, 0x04, 0x24, 0xb8, 0x47, 0x9a, 0x22, 0x4a, 0x98,
-  0xfc, 0x97, 0x88, 0x26, 0xe2, 0xb2, 0x3b, 0xa4, 0x08, 0x82, 0x70, 0x08,
-  0x82, 0x20, 0x08, 0xc2, 0x20, 0x82, 0x12, 0x1c, 0x25, 0x4d, 0x11, 0x25,
-  0x4c, 0xfe, 0x3f, 0x11, 0xd7, 0x44, 0x45, 0xc4, 0x6f, 0x0f, 0xff, 0x34,
-  0x46, 0x00, 0x0c, 0x22, 0x30, 0xc1, 0x4c, 0xd7, 0x3c, 0xd0, 0x83, 0x3c,
-  0xd4, 0xc3, 0x38, 0xd0, 0x83, 0x1b, 0xb4, 0x43, 0x39, 0xd0, 0x43, 0x38,
-  0xb0, 0x83, 0x1e, 0xe8, 0x01, 0x3d, 0x94, 0x03, 0x3e, 0xd0, 0x43, 0x3d,
-  0xc8, 0x43, 0x39, 0xc8, 0x01, 0x39, 0xa0, 0xa0, 0x39, 0x47, 0x9a, 0x22,
-  0x4a, 0x98, 0xfc, 0x96, 0xb8, 0x26, 0x2a, 0x22, 0x50, 0xe0, 0x0c, 0x22,
-  0x3c, 0xc1, 0x55, 0xd2, 0x14, 0x51, 0xc2, 0xe4, 0x77, 0x44, 0x85, 0x08,
-  0x84, 0x09, 0x4c, 0x44, 0x84, 0x00, 0x0b, 0xc2, 0x04, 0x41, 0x10, 0x04,
-  0x41, 0x10, 0x04, 0x41, 0x10, 0x8e, 0xe3, 0x38, 0x8e, 0xe3, 0x38, 0x8e,
-  0x43, 0x10, 0x06, 0x11, 0xa2, 0x20, 0x09, 0x86, 0x99, 0xa8, 0x79, 0xa0,
-  0x07, 0x79, 0xa8, 0x87, 0x71, 0xa0, 0x07, 0x37, 0x68, 0x87, 0x72, 0xa0,
-  0x87, 0x70, 0x60, 0x07, 0x3d, 0xd0, 0x83, 0x76, 0x08, 0x07, 0x7a, 0x90,
-  0x87, 0x74, 0xc0, 0x07, 0x14, 0x4c, 0x87, 0x49, 0x53, 0x44, 0x09, 0x93,
-  0x2f, 0x36, 0xd2, 0x04, 0x34, 0x02, 0xd1, 0x46, 0x40, 0x23, 0x15, 0x4e,
-  0xc4, 0x20, 0x81, 0xa2, 0x06, 0x11, 0xaa, 0x60, 0x10, 0x81, 0x0a, 0x8e,
-  0x91, 0xa6, 0x88, 0x12, 0x26, 0x9f, 0x15, 0x88, 0x86, 0x40, 0x46, 0xb2,
-  0x40, 0x92, 0x75, 0x0d, 0x22, 0x60, 0x41, 0x39, 0x82, 0x21, 0x20, 0x0a,
-  0x23, 0x23, 0xad, 0x08, 0xc1, 0x40, 0xdc, 0x40, 0x40, 0x0a, 0x1c, 0x73,
-  0x04, 0xa0, 0x30, 0x88, 0x20, 0x05, 0x83, 0x08, 0x42, 0x30, 0x8c, 0x40,
-  0x1c, 0x23, 0x00, 0x00, 0x00, 0x00, 0x51, 0x18, 0x00, 0x00, 0x85, 0x00,
-  0x00, 0x00, 0x1b, 0xc8, 0x25, 0xf8, 0xff, 0xff, 0xff, 0xff, 0x01, 0x90,
-  0x80, 0x8a, 0x18, 0x87, 0x77, 0x90, 0x07, 0x79, 0x28, 0x87, 0x71, 0xa0,
-  0x07, 0x76, 0xc8, 0x87, 0x36, 0x90, 0x87, 0x77, 0xa8, 0x07, 0x77, 0x20,
-  0x87, 0x72, 0x20, 0x87, 0x36, 0x20, 0x87, 0x74, 0xb0, 0x87, 0x74, 0x20,
-  0x87, 0x72, 0x68, 0x83, 0x79, 0x88, 0x07, 0x79, 0xa0, 0x87, 0x36, 0x30,
-  0x07, 0x78, 0x68, 0x83, 0x76, 0x08, 0x07, 0x7a, 0x40, 0x07, 0xc0, 0x1c,
-  0xc2, 0x81, 0x1d, 0xe6, 0xa1, 0x1c, 0x00, 0x82, 0x1c, 0xd2, 0x61, 0x1e,
-  0xc2, 0x41, 0x1c, 0xd8, 0xa1, 0x1c, 0xda, 0x80, 0x1e, 0xc2, 0x21, 0x1d,
-  0xd8, 0xa1, 0x0d, 0xc6, 0x21, 0x1c, 0xd8, 0x81, 0x1d, 0xe6, 0x01, 0x30,
-  0x87, 0x70, 0x60, 0x87, 0x79, 0x28, 0x07, 0x80, 0x60, 0x87, 0x72, 0x98,
-  0x87, 0x79, 0x68, 0x03, 0x78, 0x90, 0x87, 0x72, 0x18, 0x87, 0x74, 0x98,
-  0x87, 0x72, 0x68, 0x03, 0x73, 0x80, 0x87, 0x76, 0x08, 0x07, 0x72, 0x00,
-  0xcc, 0x21, 0x1c, 0xd8, 0x61, 0x1e, 0xca, 0x01, 0x20, 0xdc, 0xe1, 0x1d,
-  0xda, 0xc0, 0x1c, 0xe4, 0x21, 0x1c, 0xda, 0xa1, 0x1c, 0xda, 0x00, 0x1e,
-  0xde, 0x21, 0x1d, 0xdc, 0x81, 0x1e, 0xca, 0x41, 0x1e, 0xda, 0xa0, 0x1c,
-  0xd8, 0x21, 0x1d, 0xda, 0x01, 0xa0, 0x07, 0x79, 0xa8, 0x87, 0x72, 0x00,
-  0x06, 0x77, 0x78, 0x87, 0x36, 0x30, 0x07, 0x79, 0x08, 0x87, 0x76, 0x28,
-  0x87, 0x36, 0x80, 0x87, 0x77, 0x48, 0x07, 0x77, 0xa0, 0x87, 0x72, 0x90,
-  0x87, 0x36, 0x28, 0x07, 0x76, 0x48, 0x87, 0x76, 0x68, 0x03, 0x77, 0x78,
-  0x07, 0x77, 0x68, 0x03, 0x76, 0x28, 0x87, 0x70, 0x30, 0x07, 0x80, 0x70,
-  0x87, 0x77, 0x68, 0x83, 0x74, 0x70, 0x07, 0x73, 0x98, 0x87, 0x36, 0x30,
-  0x07, 0x78, 0x68, 0x83, 0x76, 0x08, 0x07, 0x7a, 0x40, 0x07, 0x80, 0x1e,
-  0xe4, 0xa1, 0x1e, 0xca, 0x01, 0x20, 0xdc, 0xe1, 0x1d, 0xda, 0x40, 0x1d,
-  0xea, 0xa1, 0x1d, 0xe0, 0xa1, 0x0d, 0xe8, 0x21, 0x1c, 0xc4, 0x81, 0x1d,
-  0xca, 0x61, 0x1e, 0x00, 0x73, 0x08, 0x07, 0x76, 0x98, 0x87, 0x72, 0x00,
-  0x08, 0x77, 0x78, 0x87, 0x36, 0x70, 0x87, 0x70, 0x70, 0x87, 0x79, 0x68,
-  0x03, 0x73, 0x80, 0x87, 0x36, 0x68, 0x87, 0x70, 0xa0, 0x07, 0x74, 0x00,
-  0xe8, 0x41, 0x1e, 0xea, 0xa1, 0x1c, 0x00, 0xc2, 0x1d, 0xde, 0xa1, 0x0d,
-  0xe6, 0x21, 0x1d, 0xce, 0xc1, 0x1d, 0xca, 0x81, 0x1c, 0xda, 0x40, 0x1f,
-  0xca, 0x41, 0x1e, 0xde, 0x61, 0x1e, 0xda, 0xc0, 0x1c, 0xe0, 0xa1, 0x0d,
-  0xda, 0x21, 0x1c, 0xe8, 0x01, 0x1d, 0x00, 0x7a, 0x90, 0x87, 0x7a, 0x28,
-  0x07, 0x80, 0x70, 0x87, 0x77, 0x68, 0x03, 0x7a, 0x90, 0x87, 0x70, 0x80,
-  0x07, 0x78, 0x48, 0x07, 0x77, 0x38, 0x87, 0x36, 0x68, 0x87, 0x70, 0xa0,
-  0x07, 0x74, 0x00, 0xe8, 0x41, 0x1e, 0xea, 0xa1, 0x1c, 0x00, 0x62, 0x1e,
-  0xe8, 0x21, 0x1c, 0xc6, 0x61, 0x1d, 0xda, 0x00, 0x1e, 0xe4, 0xe1, 0x1d,
-  0xe8, 0xa1, 0x1c, 0xc6, 0x81, 0x1e, 0xde, 0x41, 0x1e, 0xda, 0x40, 0x1c,
-  0xea, 0xc1, 0x1c, 0xcc, 0xa1, 0x1c, 0xe4, 0xa1, 0x0d, 0xe6, 0x21, 0x1d,
-  0xf4, 0xa1, 0x1c, 0x00, 0x3c, 0x00, 0x88, 0x7a, 0x70, 0x87, 0x79, 0x08,
-  0x07, 0x73, 0x28, 0x87, 0x36, 0x30, 0x07, 0x78, 0x68, 0x83, 0x76, 0x08,
-  0x07, 0x7a, 0x40, 0x07, 0x80, 0x1e, 0xe4, 0xa1, 0x1e, 0xca, 0x01, 0x20,
-  0xea, 0x61, 0x1e, 0xca, 0xa1, 0x0d, 0xe6, 0xe1, 0x1d, 0xcc, 0x81, 0x1e,
-  0xda, 0xc0, 0x1c, 0xd8, 0xe1, 0x1d, 0xc2, 0x81, 0x1e, 0x00, 0x73, 0x08,
-  0x07, 0x76, 0x98, 0x87, 0x72, 0x00, 0x36, 0x2c, 0x82, 0x01, 0x24, 0xc0,
-  0x02, 0x54, 0x41, 0x1a, 0xc0, 0xc1, 0x06, 0x63, 0xf8, 0xff, 0xff, 0xff,
-  0xff, 0x01, 0x90, 0x00, 0x0a, 0x00, 0x49, 0x18, 0x00, 0x00, 0x02, 0x00,
-  0x00, 0x00, 0x13, 0x84, 0x40, 0x98, 0x10, 0x0c, 0x00, 0x00, 0x13, 0xb0,
-  0x70, 0x48, 0x07, 0x79, 0xb0, 0x03, 0x3a, 0x68, 0x83, 0x70, 0x80, 0x07,
-  0x78, 0x60, 0x87, 0x72, 0x68, 0x83, 0x76, 0x08, 0x87, 0x71, 0x78, 0x87,
-  0x79, 0xc0, 0x87, 0x38, 0x88, 0x03, 0x37, 0x80, 0x03, 0x37, 0x80, 0x83,
-  0x0d, 0xb7, 0x51, 0x0e, 0x6d, 0x00, 0x0f, 0x7a, 0x60, 0x07, 0x74, 0xa0,
-  0x07, 0x76, 0x40, 0x07, 0x7a, 0x60, 0x07, 0x74, 0xd0, 0x06, 0xe9, 0x10,
-  0x07, 0x7a, 0x80, 0x07, 0x7a, 0x80, 0x07, 0x6d, 0x90, 0x0e, 0x78, 0xa0,
-  0x07, 0x78, 0xa0, 0x07, 0x78, 0xd0, 0x06, 0xe9, 0x10, 0x07, 0x76, 0xa0,
-  0x07, 0x71, 0x60, 0x07, 0x7a, 0x10, 0x07, 0x76, 0xd0, 0x06, 0xe9, 0x30,
-  0x07, 0x72, 0xa0, 0x07, 0x73, 0x20, 0x07, 0x7a, 0x30, 0x07, 0x72, 0xd0,
-  0x06, 0xe9, 0x60, 0x07, 0x74, 0xa0, 0x07, 0x76, 0x40, 0x07, 0x7a, 0x60,
-  0x07, 0x74, 0xd0, 0x06, 0xe6, 0x30, 0x07, 0x72, 0xa0, 0x07, 0x73, 0x20,
-  0x07, 0x7a, 0x30, 0x07, 0x72, 0xd0, 0x06, 0xe6, 0x60, 0x07, 0x74, 0xa0,
-  0x07, 0x76, 0x40, 0x07, 0x7a, 0x60, 0x07, 0x74, 0xd0, 0x06, 0xf6, 0x10,
-  0x07, 0x76, 0xa0, 0x07, 0x71, 0x60, 0x07, 0x7a, 0x10, 0x07, 0x76, 0xd0,
-  0x06, 0xf6, 0x20, 0x07, 0x74, 0xa0, 0x07, 0x73, 0x20, 0x07, 0x7a, 0x30,
-  0x07, 0x72, 0xd0, 0x06, 0xf6, 0x30, 0x07, 0x72, 0xa0, 0x07, 0x73, 0x20,
-  0x07, 0x7a, 0x30, 0x07, 0x72, 0xd0, 0x06, 0xf6, 0x40, 0x07, 0x78, 0xa0,
-  0x07, 0x76, 0x40, 0x07, 0x7a, 0x60, 0x07, 0x74, 0xd0, 0x06, 0xf6, 0x60,
-  0x07, 0x74, 0xa0, 0x07, 0x76, 0x40, 0x07, 0x7a, 0x60, 0x07, 0x74, 0xd0,
-  0x06, 0xf6, 0x90, 0x07, 0x76, 0xa0, 0x07, 0x71, 0x20, 0x07, 0x78, 0xa0,
-  0x07, 0x71, 0x20, 0x07, 0x78, 0xd0, 0x06, 0xf6, 0x10, 0x07, 0x72, 0x80,
-  0x07, 0x7a, 0x10, 0x07, 0x72, 0x80, 0x07, 0x7a, 0x10, 0x07, 0x72, 0x80,
-  0x07, 0x6d, 0x60, 0x0f, 0x71, 0x90, 0x07, 0x72, 0xa0, 0x07, 0x72, 0x50,
-  0x07, 0x76, 0xa0, 0x07, 0x72, 0x50, 0x07, 0x76, 0xd0, 0x06, 0xf6, 0x20,
-  0x07, 0x75, 0x60, 0x07, 0x7a, 0x20, 0x07, 0x75, 0x60, 0x07, 0x7a, 0x20,
-  0x07, 0x75, 0x60, 0x07, 0x6d, 0x60, 0x0f, 0x75, 0x10, 0x07, 0x72, 0xa0,
-  0x07, 0x75, 0x10, 0x07, 0x72, 0xa0, 0x07, 0x75, 0x10, 0x07, 0x72, 0xd0,
-  0x06, 0xf6, 0x10, 0x07, 0x70, 0x20, 0x07, 0x74, 0xa0, 0x07, 0x71, 0x00,
-  0x07, 0x72, 0x40, 0x07, 0x7a, 0x10, 0x07, 0x70, 0x20, 0x07, 0x74, 0xd0,
-  0x06, 0xee, 0x80, 0x07, 0x7a, 0x10, 0x07, 0x76, 0xa0, 0x07, 0x73, 0x20,
-  0x07, 0x1a, 0x21, 0x0c, 0x19, 0x4d, 0x11, 0x02, 0x34, 0xc6, 0x42, 0xfc,
-  0x45, 0x04, 0x18, 0x0c, 0xd1, 0x4c, 0x43, 0x24, 0x20, 0xd2, 0x00, 0x00,
-  0x08, 0x00, 0x00, 0x00, 0x04, 0x00, 0x00, 0x00, 0x00, 0x18, 0x22, 0x45,
-  0x1b, 0x07, 0x04, 0x80, 0x00, 0x00, 0x00, 0x20, 0x00, 0x00, 0x00, 0x00,
-  0x80, 0xc4, 0x06, 0x81, 0xa2, 0x00, 0x05, 0x00, 0x00, 0x59, 0x20, 0x00,
-  0x00, 0x00, 0x20, 0x00, 0x00, 0x00, 0x32, 0x1e, 0x98, 0x18, 0x19, 0x11,
-  0x4c, 0x90, 0x8c, 0x09, 0x26, 0x47, 0xc6, 0x04, 0x43, 0x3a, 0x8a, 0xa0,
-  0x04, 0x0a, 0xa1, 0x1c, 0xca, 0xa7, 0x00, 0x05, 0x0a, 0xa2, 0x40, 0xca,
-  0x60, 0x04, 0xa0, 0x14, 0x0a, 0xac, 0x30, 0x0a, 0xa5, 0x60, 0x0a, 0xa7,
-  0x80, 0x0a, 0xa9, 0xa0, 0x0a, 0xab, 0xd0, 0x0a, 0xae, 0xf0, 0x0a, 0x30,
-  0xa0, 0x10, 0x03, 0x0a, 0x32, 0xa0, 0x30, 0x03, 0x0a, 0x34, 0xa0, 0x50,
-  0x03, 0x0a, 0x36, 0xa0, 0x70, 0x03, 0x0a, 0x38, 0x80, 0xc0, 0x11, 0x80,
-  0x82, 0x28, 0x90, 0x82, 0x29, 0xa0, 0x82, 0x2a, 0x84, 0xc2, 0x28, 0x94,
-  0xc2, 0x29, 0xa4, 0xc2, 0x2a, 0xb0, 0x42, 0x2b, 0xb8, 0xc2, 0x2b, 0xc0,
-  0x80, 0x42, 0x0c, 0x28, 0xc8, 0x80, 0xc2, 0x0c, 0x28, 0xd0, 0x80, 0x42,
-  0x0d, 0x28, 0xd8, 0x80, 0xc2, 0x0d, 0xa0, 0x6f, 0x2c, 0x61, 0x19, 0x00,
-  0x00, 0x00, 0xb1, 0x18, 0x00, 0x00, 0x7b, 0x00, 0x00, 0x00, 0x33, 0x08,
-  0x80, 0x1c, 0xc4, 0xe1, 0x1c, 0x66, 0x14, 0x01, 0x3d, 0x88, 0x43, 0x38,
-  0x84, 0xc3, 0x8c, 0x42, 0x80, 0x07, 0x79, 0x78, 0x07, 0x73, 0x98, 0x71,
-  0x0c, 0xe6, 0x00, 0x0f, 0xed, 0x10, 0x0e, 0xf4, 0x80, 0x0e, 0x33, 0x0c,
-  0x42, 0x1e, 0xc2, 0xc1, 0x1d, 0xce, 0xa1, 0x1c, 0x66, 0x30, 0x05, 0x3d,
-  0x88, 0x43, 0x38, 0x84, 0x83, 0x1b, 0xcc, 0x03, 0x3d, 0xc8, 0x43, 0x3d,
-  0x8c, 0x03, 0x3d, 0xcc, 0x78, 0x8c, 0x74, 0x70, 0x07, 0x7b, 0x08, 0x07,
-  0x79, 0x48, 0x87, 0x70, 0x70, 0x07, 0x7a, 0x70, 0x03, 0x76, 0x78, 0x87,
-  0x70, 0x20, 0x87, 0x19, 0xcc, 0x11, 0x0e, 0xec, 0x90, 0x0e, 0xe1, 0x30,
-  0x0f, 0x6e, 0x30, 0x0f, 0xe3, 0xf0, 0x0e, 0xf0, 0x50, 0x0e, 0x33, 0x10,
-  0xc4, 0x1d, 0xde, 0x21, 0x1c, 0xd8, 0x21, 0x1d, 0xc2, 0x61, 0x1e, 0x66,
-  0x30, 0x89, 0x3b, 0xbc, 0x83, 0x3b, 0xd0, 0x43, 0x39, 0xb4, 0x03, 0x3c,
-  0xbc, 0x83, 0x3c, 0x84, 0x03, 0x3b, 0xcc, 0xf0, 0x14, 0x76, 0x60, 0x07,
-  0x7b, 0x68, 0x07, 0x37, 0x68, 0x87, 0x72, 0x68, 0x07, 0x37, 0x80, 0x87,
-  0x70, 0x90, 0x87, 0x70, 0x60, 0x07, 0x76, 0x28, 0x07, 0x76, 0xf8, 0x05,
-  0x76, 0x78, 0x87, 0x77, 0x80, 0x87, 0x5f, 0x08, 0x87, 0x71, 0x18, 0x87,
-  0x72, 0x98, 0x87, 0x79, 0x98, 0x81, 0x2c, 0xee, 0xf0, 0x0e, 0xee, 0xe0,
-  0x0e, 0xf5, 0xc0, 0x0e, 0xec, 0x30, 0x03, 0x62, 0xc8, 0xa1, 0x1c, 0xe4,
-  0xa1, 0x1c, 0xcc, 0xa1, 0x1c, 0xe4, 0xa1, 0x1c, 0xdc, 0x61, 0x1c, 0xca,
-  0x21, 0x1c, 0xc4, 0x81, 0x1d, 0xca, 0x61, 0x06, 0xd6, 0x90, 0x43, 0x39,
-  0xc8, 0x43, 0x39, 0x98, 0x43, 0x39, 0xc8, 0x43, 0x39, 0xb8, 0xc3, 0x38,
-  0x94, 0x43, 0x38, 0x88, 0x03, 0x3b, 0x94, 0xc3, 0x2f, 0xbc, 0x83, 0x3c,
-  0xfc, 0x82, 0x3b, 0xd4, 0x03, 0x3b, 0xb0, 0xc3, 0x0c, 0xc7, 0x69, 0x87,
-  0x70, 0x58, 0x87, 0x72, 0x70, 0x83, 0x74, 0x68, 0x07, 0x78, 0x60, 0x87,
-  0x74, 0x18, 0x87, 0x74, 0xa0, 0x87, 0x19, 0xce, 0x53, 0x0f, 0xee, 0x00,
-  0x0f, 0xf2, 0x50, 0x0e, 0xe4, 0x90, 0x0e, 0xe3, 0x40, 0x0f, 0xe1, 0x20,
-  0x0e, 0xec, 0x50, 0x0e, 0x33, 0x20, 0x28, 0x1d, 0xdc, 0xc1, 0x1e, 0xc2,
-  0x41, 0x1e, 0xd2, 0x21, 0x1c, 0xdc, 0x81, 0x1e, 0xdc, 0xe0, 0x1c, 0xe4,
-  0xe1, 0x1d, 0xea, 0x01, 0x1e, 0x66, 0x18, 0x51, 0x38, 0xb0, 0x43, 0x3a,
-  0x9c, 0x83, 0x3b, 0xcc, 0x50, 0x24, 0x76, 0x60, 0x07, 0x7b, 0x68, 0x07,
-  0x37, 0x60, 0x87, 0x77, 0x78, 0x07, 0x78, 0x98, 0x51, 0x4c, 0xf4, 0x90,
-  0x0f, 0xf0, 0x50, 0x0e, 0x33, 0x1e, 0x6a, 0x1e, 0xca, 0x61, 0x1c, 0xe8,
-  0x21, 0x1d, 0xde, 0xc1, 0x1d, 0x7e, 0x01, 0x1e, 0xe4, 0xa1, 0x1c, 0xcc,
-  0x21, 0x1d, 0xf0, 0x61, 0x06, 0x54, 0x85, 0x83, 0x38, 0xcc, 0xc3, 0x3b,
-  0xb0, 0x43, 0x3d, 0xd0, 0x43, 0x39, 0xfc, 0xc2, 0x3c, 0xe4, 0x43, 0x3b,
-  0x88, 0xc3, 0x3b, 0xb0, 0xc3, 0x8c, 0xc5, 0x0a, 0x87, 0x79, 0x98, 0x87,
-  0x77, 0x18, 0x87, 0x74, 0x08, 0x07, 0x7a, 0x28, 0x07, 0x72, 0x98, 0x81,
-  0x5c, 0xe3, 0x10, 0x0e, 0xec, 0xc0, 0x0e, 0xe5, 0x50, 0x0e, 0xf3, 0x30,
-  0x23, 0xc1, 0xd2, 0x41, 0x1e, 0xe4, 0xe1, 0x17, 0xd8, 0xe1, 0x1d, 0xde,
-  0x01, 0x1e, 0x66, 0x50, 0x59, 0x38, 0xa4, 0x83, 0x3c, 0xb8, 0x81, 0x39,
-  0xd4, 0x83, 0x3b, 0x8c, 0x03, 0x3d, 0xa4, 0xc3, 0x3b, 0xb8, 0xc3, 0x2f,
-  0x9c, 0x83, 0x3c, 0xbc, 0x43, 0x3d, 0xc0, 0xc3, 0x3c, 0x00, 0x79, 0x20,
-  0x00, 0x00, 0x57, 0x02, 0x00, 0x00, 0x62, 0x1e, 0x48, 0x20, 0x43, 0x88,
-  0x0c, 0x19, 0x39, 0x19, 0x24, 0x90, 0x91, 0x40, 0xc6, 0xc8, 0xc8, 0x68,
-  0x22, 0x50, 0x08, 0x14, 0x32, 0x9e, 0x18, 0x19, 0x21, 0x47, 0xc8, 0x90,
-  0x51, 0x54, 0x07, 0x5a, 0x38, 0xcb, 0x00, 0x00, 0x00, 0x00, 0x8b, 0x62,
-  0x61, 0x1b, 0xb4, 0x41, 0x70, 0x50, 0x6c, 0x1c, 0x19, 0x44, 0x51, 0xc1,
-  0x28, 0x92, 0xc1, 0x20, 0xd2, 0xf5, 0x14, 0x58, 0x61, 0x4c, 0x88, 0x61,
-  0x4c, 0x86, 0x30, 0x3d, 0x12, 0x42, 0x21, 0x48, 0xa5, 0x14, 0xc3, 0x30,
-  0x0c, 0xc3, 0x30, 0x10, 0x41, 0x40, 0x10, 0xc3, 0x30, 0x0c, 0xd1, 0x85,
-  0x2c, 0xc3, 0x30, 0x0c, 0xc3, 0x81, 0x60, 0x8b, 0xe2, 0x24, 0xc3, 0x30,
-  0x0c, 0xc3, 0x30, 0x0c, 0x08, 0x82, 0x20, 0xc5, 0xb0, 0x28, 0x16, 0x93,
-  0x10, 0x51, 0x82, 0x18, 0x0d, 0x53, 0x14, 0x00, 0x00, 0x00, 0x53, 0x44,
-  0x4b, 0x20, 0x56, 0x65, 0x72, 0x73, 0x69, 0x6f, 0x6e, 0x77, 0x63, 0x68,
-  0x61, 0x72, 0x5f, 0x73, 0x69, 0x7a, 0x65, 0x61, 0x69, 0x72, 0x2e, 0x6d,
-  0x61, 0x78, 0x5f, 0x64, 0x65, 0x76, 0x69, 0x63, 0x65, 0x5f, 0x62, 0x75,
-  0x66, 0x66, 0x65, 0x72, 0x73, 0x61, 0x69, 0x72, 0x2e, 0x6d, 0x61, 0x78,
-  0x5f, 0x63, 0x6f, 0x6e, 0x73, 0x74, 0x61, 0x6e, 0x74, 0x5f, 0x62, 0x75,
-  0x66, 0x66, 0x65, 0x72, 0x73, 0x61, 0x69, 0x72, 0x2e, 0x6d, 0x61, 0x78,
-  0x5f, 0x74, 0x68, 0x72, 0x65, 0x61, 0x64, 0x67, 0x72, 0x6f, 0x75, 0x70,
-  0x5f, 0x62, 0x75, 0x66, 0x66, 0x65, 0x72, 0x73, 0x61, 0x69, 0x72, 0x2e,
-  0x6d, 0x61, 0x78, 0x5f, 0x74, 0x65, 0x78, 0x74, 0x75, 0x72, 0x65, 0x73,
-  0x61, 0x69, 0x72, 0x2e, 0x6d, 0x61, 0x78, 0x5f, 0x72, 0x65, 0x61, 0x64,
-  0x5f, 0x77, 0x72, 0x69, 0x74, 0x65, 0x5f, 0x74, 0x65, 0x78, 0x74, 0x75,
-  0x72, 0x65, 0x73, 0x61, 0x69, 0x72, 0x2e, 0x6d, 0x61, 0x78, 0x5f, 0x73,
-  0x61, 0x6d, 0x70, 0x6c, 0x65, 0x72, 0x73, 0x41, 0x70, 0x70, 0x6c, 0x65,
-  0x20, 0x4c, 0x4c, 0x56, 0x4d, 0x20, 0x76, 0x65, 0x72, 0x73, 0x69, 0x6f,
-  0x6e, 0x20, 0x33, 0x31, 0x30, 0x30, 0x31, 0x2e, 0x31, 0x38, 0x34, 0x20,
-  0x28, 0x6d, 0x65, 0x74, 0x61, 0x6c, 0x66, 0x65, 0x2d, 0x33, 0x31, 0x30,
-  0x30, 0x31, 0x2e, 0x31, 0x38, 0x34, 0x29, 0x4d, 0x65, 0x74, 0x61, 0x6c,
-  0x61, 0x69, 0x72, 0x2e, 0x63, 0x6f, 0x6d, 0x70, 0x69, 0x6c, 0x65, 0x2e,
-  0x64, 0x65, 0x6e, 0x6f, 0x72, 0x6d, 0x73, 0x5f, 0x64, 0x69, 0x73, 0x61,
-  0x62, 0x6c, 0x65, 0x61, 0x69, 0x72, 0x2e, 0x63, 0x6f, 0x6d, 0x70, 0x69,
-  0x6c, 0x65, 0x2e, 0x66, 0x61, 0x73, 0x74, 0x5f, 0x6d, 0x61, 0x74, 0x68,
-  0x5f, 0x65, 0x6e, 0x61, 0x62, 0x6c, 0x65, 0x61, 0x69, 0x72, 0x2e, 0x63,
-  0x6f, 0x6d, 0x70, 0x69, 0x6c, 0x65, 0x2e, 0x66, 0x72, 0x61, 0x6d, 0x65,
-  0x62, 0x75, 0x66, 0x66, 0x65, 0x72, 0x5f, 0x66, 0x65, 0x74, 0x63, 0x68,
-  0x5f, 0x65, 0x6e, 0x61, 0x62, 0x6c, 0x65, 0x61, 0x69, 0x72, 0x2e, 0x72,
-  0x65, 0x6e, 0x64, 0x65, 0x72, 0x5f, 0x74, 0x61, 0x72, 0x67, 0x65, 0x74,
-  0x61, 0x69, 0x72, 0x2e, 0x61, 0x72, 0x67, 0x5f, 0x74, 0x79, 0x70, 0x65,
-  0x5f, 0x6e, 0x61, 0x6d, 0x65, 0x68, 0x61, 0x6c, 0x66, 0x34, 0x61, 0x69,
-  0x72, 0x2e, 0x70, 0x6f, 0x73, 0x69, 0x74, 0x69, 0x6f, 0x6e, 0x61, 0x69,
-  0x72, 0x2e, 0x63, 0x65, 0x6e, 0x74, 0x65, 0x72, 0x61, 0x69, 0x72, 0x2e,
-  0x6e, 0x6f, 0x5f, 0x70, 0x65, 0x72, 0x73, 0x70, 0x65, 0x63, 0x74, 0x69,
-  0x76, 0x65, 0x66, 0x6c, 0x6f, 0x61, 0x74, 0x34, 0x61, 0x69, 0x72, 0x2e,
-  0x61, 0x72, 0x67, 0x5f, 0x6e, 0x61, 0x6d, 0x65, 0x70, 0x6f, 0x73, 0x69,
-  0x74, 0x69, 0x6f, 0x6e, 0x61, 0x69, 0x72, 0x2e, 0x66, 0x72, 0x61, 0x67,
-  0x6d, 0x65, 0x6e, 0x74, 0x5f, 0x69, 0x6e, 0x70, 0x75, 0x74, 0x67, 0x65,
-  0x6e, 0x65, 0x72, 0x61, 0x74, 0x65, 0x64, 0x28, 0x35, 0x63, 0x6f, 0x6c,
-  0x6f, 0x72, 0x44, 0x76, 0x34, 0x5f, 0x44, 0x68, 0x29, 0x61, 0x69, 0x72,
-  0x2e, 0x70, 0x65, 0x72, 0x73, 0x70, 0x65, 0x63, 0x74, 0x69, 0x76, 0x65,
-  0x63, 0x6f, 0x6c, 0x6f, 0x72, 0x67, 0x65, 0x6e, 0x65, 0x72, 0x61, 0x74,
-  0x65, 0x64, 0x28, 0x36, 0x6e, 0x6f, 0x72, 0x6d, 0x61, 0x6c, 0x44, 0x76,
-  0x33, 0x5f, 0x44, 0x68, 0x29, 0x68, 0x61, 0x6c, 0x66, 0x33, 0x6e, 0x6f,
-  0x72, 0x6d, 0x61, 0x6c, 0x67, 0x65, 0x6e, 0x65, 0x72, 0x61, 0x74, 0x65,
-  0x64, 0x28, 0x36, 0x6d, 0x61, 0x74, 0x5f, 0x69, 0x64, 0x74, 0x29, 0x61,
-  0x69, 0x72, 0x2e, 0x66, 0x6c, 0x61, 0x74, 0x75, 0x73, 0x68, 0x6f, 0x72,
-  0x74, 0x6d, 0x61, 0x74, 0x5f, 0x69, 0x64, 0x67, 0x65, 0x6e, 0x65, 0x72,
-  0x61, 0x74, 0x65, 0x64, 0x28, 0x32, 0x75, 0x76, 0x44, 0x76, 0x32, 0x5f,
-  0x66, 0x29, 0x66, 0x6c, 0x6f, 0x61, 0x74, 0x32, 0x75, 0x76, 0x61, 0x69,
-  0x72, 0x2e, 0x69, 0x6e, 0x64, 0x69, 0x72, 0x65, 0x63, 0x74, 0x5f, 0x62,
-  0x75, 0x66, 0x66, 0x65, 0x72, 0x61, 0x69, 0x72, 0x2e, 0x62, 0x75, 0x66,
-  0x66, 0x65, 0x72, 0x5f, 0x73, 0x69, 0x7a, 0x65, 0x61, 0x69, 0x72, 0x2e,
-  0x6c, 0x6f, 0x63, 0x61, 0x74, 0x69, 0x6f, 0x6e, 0x5f, 0x69, 0x6e, 0x64,
-  0x65, 0x78, 0x61, 0x69, 0x72, 0x2e, 0x72, 0x65, 0x61, 0x64, 0x61, 0x69,
-  0x72, 0x2e, 0x73, 0x74, 0x72, 0x75, 0x63, 0x74, 0x5f, 0x74, 0x79, 0x70,
-  0x65, 0x5f, 0x69, 0x6e, 0x66, 0x6f, 0x56, 0x65, 0x72, 0x74, 0x65, 0x78,
-  0x33, 0x44, 0x76, 0x65, 0x72, 0x74, 0x69, 0x63, 0x65, 0x73, 0x61, 0x69,
-  0x72, 0x2e, 0x69, 0x6e, 0x64, 0x69, 0x72, 0x65, 0x63, 0x74, 0x5f, 0x61,
-  0x72, 0x67, 0x75, 0x6d, 0x65, 0x6e, 0x74, 0x61, 0x69, 0x72, 0x2e, 0x62,
-  0x75, 0x66, 0x66, 0x65, 0x72, 0x66, 0x6c, 0x6f, 0x61, 0x74, 0x76, 0x5f,
-  0x78, 0x76, 0x5f, 0x79, 0x76, 0x5f, 0x7a, 0x76, 0x5f, 0x77, 0x6e, 0x5f,
-  0x78, 0x6e, 0x5f, 0x79, 0x6e, 0x5f, 0x7a, 0x75, 0x69, 0x6e, 0x74, 0x75,
-  0x76, 0x70, 0x61, 0x64, 0x30, 0x70, 0x61, 0x64, 0x31, 0x74, 0x5f, 0x78,
-  0x74, 0x5f, 0x79, 0x74, 0x5f, 0x7a, 0x74, 0x5f, 0x77, 0x61, 0x69, 0x72,
-  0x2e, 0x61, 0x72, 0x67, 0x5f, 0x74, 0x79, 0x70, 0x65, 0x5f, 0x73, 0x69,
-  0x7a, 0x65, 0x61, 0x69, 0x72, 0x2e, 0x61, 0x72, 0x67, 0x5f, 0x74, 0x79,
-  0x70, 0x65, 0x5f, 0x61, 0x6c, 0x69, 0x67, 0x6e, 0x5f, 0x73, 0x69, 0x7a,
-  0x65, 0x56, 0x65, 0x72, 0x74, 0x65, 0x78, 0x32, 0x44, 0x76, 0x65, 0x72,
-  0x74, 0x69, 0x63, 0x65, 0x73, 0x5f, 0x32, 0x64, 0x74, 0x65, 0x78, 0x63,
-  0x5f, 0x72, 0x63, 0x5f, 0x67, 0x63, 0x5f, 0x62, 0x63, 0x5f, 0x61, 0x54,
-  0x65, 0x78, 0x74, 0x75, 0x72, 0x65, 0x74, 0x65, 0x78, 0x74, 0x75, 0x72,
-  0x65, 0x73, 0x74, 0x65, 0x78, 0x74, 0x75, 0x72, 0x65, 0x32, 0x64, 0x3c,
-  0x66, 0x6c, 0x6f, 0x61, 0x74, 0x2c, 0x20, 0x73, 0x61, 0x6d, 0x70, 0x6c,
-  0x65, 0x3e, 0x61, 0x69, 0x72, 0x2e, 0x74, 0x65, 0x78, 0x74, 0x75, 0x72,
-  0x65, 0x61, 0x69, 0x72, 0x2e, 0x73, 0x61, 0x6d, 0x70, 0x6c, 0x65, 0x44,
-  0x65, 0x76, 0x69, 0x63, 0x65, 0x4d, 0x61, 0x74, 0x65, 0x72, 0x69, 0x61,
-  0x6c, 0x6d, 0x61, 0x74, 0x65, 0x72, 0x69, 0x61, 0x6c, 0x73, 0x61, 0x5f,
-  0x72, 0x61, 0x5f, 0x67, 0x61, 0x5f, 0x62, 0x61, 0x5f, 0x61, 0x73, 0x5f,
-  0x72, 0x73, 0x5f, 0x67, 0x73, 0x5f, 0x62, 0x73, 0x5f, 0x61, 0x70, 0x61,
-  0x72, 0x61, 0x6d, 0x73, 0x5f, 0x78, 0x70, 0x61, 0x72, 0x61, 0x6d, 0x73,
-  0x5f, 0x79, 0x70, 0x61, 0x72, 0x61, 0x6d, 0x73, 0x5f, 0x7a, 0x70, 0x61,
-  0x72, 0x61, 0x6d, 0x73, 0x5f, 0x77, 0x66, 0x6c, 0x61, 0x67, 0x73, 0x69,
-  0x6e, 0x74, 0x64, 0x69, 0x66, 0x66, 0x75, 0x73, 0x65, 0x5f, 0x6d, 0x61,
-  0x70, 0x6e, 0x6f, 0x72, 0x6d, 0x61, 0x6c, 0x5f, 0x6d, 0x61, 0x70, 0x6d,
-  0x65, 0x74, 0x61, 0x6c, 0x6c, 0x69, 0x63, 0x5f, 0x72, 0x6f, 0x75, 0x67,
-  0x68, 0x6e, 0x65, 0x73, 0x73, 0x5f, 0x6d, 0x61, 0x70, 0x65, 0x6d, 0x69,
-  0x73, 0x73, 0x69, 0x76, 0x65, 0x5f, 0x6d, 0x61, 0x70, 0x73, 0x68, 0x65,
-  0x65, 0x6e, 0x5f, 0x6d, 0x61, 0x70, 0x70, 0x61, 0x64, 0x32, 0x49, 0x6e,
-  0x73, 0x74, 0x61, 0x6e, 0x63, 0x65, 0x54, 0x72, 0x61, 0x6e, 0x73, 0x66,
-  0x6f, 0x72, 0x6d, 0x69, 0x6e, 0x73, 0x74, 0x61, 0x6e, 0x63, 0x65, 0x73,
-  0x66, 0x6c, 0x6f, 0x61, 0x74, 0x34, 0x78, 0x34, 0x6d, 0x61, 0x74, 0x72,
-  0x69, 0x78, 0x6e, 0x6f, 0x72, 0x6d, 0x61, 0x6c, 0x5f, 0x6d, 0x61, 0x74,
-  0x72, 0x69, 0x78, 0x69, 0x6e, 0x73, 0x74, 0x61, 0x6e, 0x63, 0x65, 0x73,
-  0x5f, 0x32, 0x64, 0x53, 0x63, 0x65, 0x6e, 0x65, 0x73, 0x63, 0x65, 0x6e,
-  0x65, 0x00, 0xc6, 0xd3, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x30, 0x82,
-  0x70, 0x08, 0x23, 0x08, 0x9f, 0x1e, 0x8c, 0x20, 0x1c, 0xc3, 0x08, 0xc2,
-  0x41, 0x8c, 0x20, 0x1c, 0xc5, 0x08, 0xc2, 0x61, 0x8c, 0x20, 0x1c, 0xc7,
-  0x08, 0xc2, 0x81, 0x8c, 0x20, 0x1c, 0xc9, 0x08, 0xc2, 0xa1, 0x8c, 0x20,
-  0x1c, 0xcb, 0x08, 0xc2, 0x06, 0x8c, 0x20, 0x1c, 0xcc, 0x08, 0xc2, 0xd1,
-  0x8c, 0x20, 0x1c, 0xce, 0x08, 0xc2, 0xf1, 0x8c, 0x20, 0x1c, 0xd0, 0x08,
-  0xc2, 0x11, 0x8d, 0x20, 0x1c, 0xd2, 0x08, 0xc2, 0x31, 0x8d, 0x20, 0x1c,
-  0xd4, 0x08, 0xc2, 0x51, 0x8d, 0x20, 0x1c, 0xd6, 0x08, 0xc2, 0x71, 0x8d,
-  0x20, 0x1c, 0xd8, 0x08, 0xc2, 0x91, 0x8d, 0x20, 0x1c, 0xda, 0x08, 0xc2,
-  0xb1, 0x8d, 0x20, 0x1c, 0xdc, 0x08, 0xc2, 0xd1, 0x8d, 0x20, 0x1c, 0xde,
-  0x08, 0xc2, 0xf1, 0x8d, 0x20, 0x1c, 0x60, 0x30, 0x82, 0x70, 0x84, 0xc1,
-  0x0c, 0xc3, 0x3a, 0x04, 0xec, 0x30, 0xc3, 0xd0, 0x0e, 0x82, 0x3b, 0xcc,
-  0x30, 0xbc, 0xc3, 0x00, 0x0f, 0x33, 0x0c, 0xef, 0x40, 0xc0, 0xc3, 0x0c,
-  0xc3, 0x3b, 0x14, 0xf0, 0x30, 0xc3, 0xf0, 0x0e, 0x46, 0x3c, 0xcc, 0x30,
-  0xbc, 0xc3, 0x21, 0x0f, 0x33, 0x0c, 0xef, 0x80, 0xcc, 0xc3, 0x0c, 0x41,
-  0x32, 0xc3, 0xb0, 0x0e, 0xf4, 0x50, 0x0f, 0x33, 0x10, 0xca, 0x3a, 0xd0,
-  0x43, 0x3d, 0xcc, 0x10, 0x2c, 0x33, 0x04, 0xcc, 0x0c, 0x41, 0x33, 0x43,
-  0xe1, 0xd4, 0x43, 0x3d, 0x3c, 0xd0, 0x0c, 0xc1, 0x4e, 0xcc, 0x80, 0xd4,
-  0x43, 0x24, 0x4d, 0x0f, 0x55, 0x59, 0x33, 0x24, 0xed, 0x70, 0x61, 0x52,
-  0xf6, 0x40, 0x95, 0x36, 0x43, 0xb2, 0x0e, 0xd7, 0x26, 0x65, 0x0f, 0x57,
-  0x75, 0x33, 0x20, 0xf4, 0x70, 0x79, 0xdf, 0x03, 0x06, 0x55, 0x18, 0xcc,
-  0x90, 0xb8, 0xc3, 0x25, 0x06, 0x52, 0xf6, 0x8c, 0x41, 0x45, 0x06, 0x33,
-  0xc0, 0x42, 0x3d, 0xb8, 0x43, 0x3d, 0xb8, 0xc1, 0x1b, 0xb8, 0x83, 0x3b,
-  0xd4, 0x83, 0x1b, 0xc0, 0x81, 0x3c, 0xb8, 0x43, 0x3d, 0xb8, 0x41, 0x1c,
-  0xe4, 0x83, 0x3b, 0xd4, 0x83, 0x1b, 0xc8, 0xc1, 0x3c, 0xb8, 0x43, 0x3d,
-  0xb8, 0xc1, 0x1c, 0xe8, 0x83, 0x3b, 0xd4, 0x83, 0x1b, 0xd0, 0xc1, 0x3e,
-  0xb8, 0x43, 0x3d, 0xb8, 0x41, 0x1d, 0xf0, 0x83, 0x3b, 0xd4, 0x83, 0x1d,
-  0x84, 0x41, 0x3f, 0xb8, 0x43, 0x3d, 0xb8, 0xc1, 0x1d, 0xf8, 0x83, 0x3b,
-  0xd4, 0x83, 0x1b, 0xe0, 0xc1, 0x3f, 0xb8, 0x43, 0x3d, 0xb8, 0x41, 0x1e,
-  0x80, 0x84, 0x3b, 0xd4, 0x83, 0x1b, 0xe8, 0x01, 0x3e, 0xb8, 0x43, 0x3d,
-  0xb8, 0xc1, 0x1e, 0x84, 0x84, 0x3b, 0xd4, 0x83, 0x1b, 0xf0, 0x81, 0x48,
-  0xb8, 0x43, 0x3d, 0xb8, 0x41, 0x1f, 0x8c, 0x84, 0x3b, 0xd4, 0x83, 0x1b,
-  0xf8, 0xc1, 0x0c, 0x50, 0x3d, 0xb4, 0xc1, 0x19, 0xd4, 0x43, 0x3b, 0xa0,
-  0x41, 0x1a, 0x88, 0xc5, 0x1f, 0x90, 0x04, 0x28, 0xb8, 0xc3, 0xa3, 0x06,
-  0xd5, 0x1a, 0xcc, 0x20, 0x07, 0xf5, 0xe0, 0x0e, 0xf5, 0xe0, 0x06, 0x6f,
-  0xe0, 0x0e, 0xee, 0x50, 0x0f, 0x6e, 0x00, 0x07, 0xf2, 0xe0, 0x0e, 0xf5,
-  0xe0, 0x06, 0x71, 0x90, 0x0f, 0xee, 0x50, 0x0f, 0x76, 0x30, 0x0a, 0xf3,
-  0xe0, 0x0e, 0xf5, 0xe0, 0x06, 0x77, 0xa0, 0x0f, 0xee, 0x50, 0x0f, 0x6e,
-  0x80, 0x07, 0xfb, 0xe0, 0x0e, 0xf5, 0xe0, 0x06, 0xa4, 0xc0, 0x0f, 0xee,
-  0x50, 0x0f, 0x6e, 0x50, 0x0a, 0xfd, 0xe0, 0x0e, 0xf5, 0xe0, 0x06, 0xa6,
-  0xe0, 0x0f, 0xee, 0x50, 0x0f, 0x6e, 0x70, 0x0a, 0x33, 0x40, 0xed, 0xd0,
-  0x06, 0x67, 0xd0, 0x0e, 0xed, 0x80, 0x06, 0x69, 0x40, 0x16, 0x7f, 0xf0,
-  0x0f, 0xa0, 0xe0, 0x0e, 0x4f, 0x28, 0x54, 0xa2, 0x30, 0x83, 0x52, 0x0f,
-  0xab, 0x70, 0x06, 0xf5, 0xd0, 0x0e, 0xac, 0xf0, 0xa8, 0x42, 0x35, 0x0a,
-  0x33, 0x1c, 0xf5, 0x20, 0x0f, 0xf5, 0xa0, 0x0a, 0xa3, 0xc0, 0x06, 0x66,
-  0x31, 0x03, 0xb4, 0x0e, 0x65, 0x70, 0x06, 0xeb, 0xd0, 0x0e, 0x68, 0x90,
-  0x06, 0x67, 0xf1, 0x07, 0xf2, 0x00, 0x0a, 0xf2, 0xf0, 0xa0, 0x42, 0x95,
-  0x0a, 0x33, 0xe0, 0x43, 0x3d, 0xb8, 0x43, 0x3d, 0xb8, 0x01, 0x29, 0xb8,
-  0x83, 0x3b, 0xd4, 0x83, 0x1b, 0x94, 0x82, 0x3c, 0xb8, 0x43, 0x3d, 0xb8,
-  0x81, 0x29, 0xe4, 0x83, 0x3b, 0xd4, 0x83, 0x1b, 0x9c, 0xc2, 0x3c, 0xb8,
-  0x43, 0x3d, 0xb8, 0xc1, 0x2b, 0xe8, 0x83, 0x3b, 0xd4, 0x83, 0x1b, 0xc0,
-  0xc2, 0x3e, 0xb8, 0x43, 0x3d, 0xb8, 0x41, 0x2c, 0xf0, 0x83, 0x3b, 0xd4,
-  0x83, 0x1b, 0xc8, 0x42, 0x3f, 0xb8, 0x43, 0x3d, 0xb8, 0xc1, 0x2c, 0xf8,
-  0x83, 0x3b, 0xd4, 0x83, 0x1b, 0xd0, 0xc2, 0x3f, 0xb8, 0x43, 0x3d, 0xb8,
-  0x41, 0x2d, 0x80, 0x84, 0x3b, 0xd4, 0x83, 0x1b, 0xd8, 0x02, 0x3e, 0xb8,
-  0x43, 0x3d, 0xd8, 0xc1, 0x2d, 0x84, 0x84, 0x3b, 0xd4, 0x83, 0x1d, 0xe0,
-  0x82, 0x48, 0xb8, 0x43, 0x3d, 0xd8, 0x41, 0x2e, 0x8c, 0x84, 0x3b, 0xd4,
-  0x83, 0x1d, 0xe8, 0x02, 0x49, 0xb8, 0x43, 0x3d, 0xd8, 0xc1, 0x2e, 0x94,
-  0x84, 0x3b, 0xd4, 0x03, 0x2f, 0xf4, 0x82, 0x49, 0xb8, 0x43, 0x3d, 0xf0,
-  0x82, 0x2f, 0x9c, 0x84, 0x3b, 0xd4, 0x03, 0x2f, 0xfc, 0x02, 0x4a, 0xb8,
-  0x43, 0x3d, 0xf0, 0x02, 0x38, 0xa4, 0x84, 0x3b, 0xd4, 0x03, 0x2f, 0x84,
-  0x83, 0x4a, 0xb8, 0x43, 0x3d, 0xb8, 0x81, 0x1e, 0xac, 0x84, 0x3b, 0xd4,
-  0x83, 0x1b, 0x88, 0xc3, 0x0c, 0x10, 0x3d, 0xb4, 0xc1, 0x19, 0xd0, 0x43,
-  0x3b, 0xa0, 0x41, 0x1a, 0xa4, 0xc5, 0x1f, 0xb0, 0x04, 0x28, 0xb8, 0xc3,
-  0xd3, 0x0a, 0x95, 0x2b, 0xcc, 0xa0, 0xd4, 0x03, 0x49, 0xd4, 0x43, 0x39,
-  0x98, 0x03, 0x49, 0x90, 0x44, 0x3d, 0x94, 0xc3, 0x39, 0xcc, 0x00, 0xb9,
-  0x43, 0x1b, 0x9c, 0x81, 0x3b, 0xb4, 0x03, 0x1a, 0xa4, 0xc1, 0x5a, 0xfc,
-  0x41, 0x3c, 0x80, 0xc2, 0x3c, 0x3c, 0xe3, 0x50, 0x91, 0xc3, 0x0c, 0xce,
-  0x3d, 0xb4, 0xc1, 0x19, 0xdc, 0x43, 0x3b, 0xa0, 0xc1, 0x1f, 0x90, 0x04,
-  0x28, 0xcc, 0xc3, 0x53, 0x0e, 0x15, 0x3a, 0xcc, 0xa0, 0x06, 0xf5, 0x20,
-  0x0f, 0xf5, 0xa0, 0x06, 0x6b, 0xc0, 0x06, 0x63, 0x21, 0x0f, 0xf2, 0x50,
-  0x0f, 0xa1, 0x20, 0x0a, 0x6c, 0x50, 0x16, 0xf3, 0x20, 0x0f, 0xf5, 0x80,
-  0x0a, 0xa9, 0xc0, 0x06, 0x68, 0xb1, 0x0f, 0xf2, 0x50, 0x0f, 0xad, 0xe0,
-  0x0a, 0x6c, 0xa0, 0x16, 0xfd, 0x20, 0x0f, 0xf5, 0x30, 0x0e, 0xe4, 0xc0,
-  0x06, 0x6c, 0xf1, 0x0f, 0xf2, 0x50, 0x0f, 0xe5, 0x80, 0x0e, 0x6c, 0xd0,
-  0x16, 0x33, 0x48, 0xf7, 0x50, 0x06, 0x66, 0x80, 0x0f, 0x67, 0x50, 0x0f,
-  0xed, 0x80, 0x06, 0x69, 0xe0, 0x16, 0x7f, 0x80, 0x0f, 0xa0, 0x20, 0x0f,
-  0x4f, 0x3a, 0x54, 0xea, 0x30, 0x83, 0xd1, 0x13, 0x3e, 0xf1, 0x13, 0x60,
-  0x11, 0x16, 0x6f, 0x31, 0xc3, 0x60, 0x0f, 0x3c, 0x01, 0x17, 0x77, 0x0a,
-  0x00, 0x27, 0x06, 0x1c, 0xc7, 0x71, 0x1c, 0xc7, 0x71, 0x1c, 0xc7, 0x71,
-  0x1c, 0xc7, 0x71, 0x1c, 0xc7, 0x71, 0x1c, 0xc7, 0x71, 0x1c, 0xc7, 0x71,
-  0x1c, 0x27, 0x06, 0x62, 0xe0, 0x06, 0x6e, 0xe0, 0x06, 0x6e, 0xe0, 0x06,
-  0x6e, 0xe0, 0x06, 0x6e, 0x60, 0xd1, 0x81, 0x1e, 0x58, 0x96, 0xa5, 0x07,
-  0x9c, 0x29, 0xb0, 0x02, 0x2b, 0xc8, 0x82, 0x2f, 0xd8, 0x1e, 0x69, 0xb8,
-  0x13, 0x69, 0xf0, 0x03, 0x39, 0x90, 0x86, 0xdd, 0x06, 0xa4, 0x81, 0x12,
-  0xa4, 0xc1, 0x16, 0x2e, 0xc4, 0x1b, 0xb8, 0x20, 0x23, 0x81, 0x09, 0xca,
-  0x88, 0x8d, 0xcd, 0xae, 0xcd, 0xa5, 0xed, 0x8d, 0xac, 0x8e, 0xad, 0xcc,
-  0xc5, 0x8c, 0x2d, 0xec, 0x6c, 0x6e, 0x14, 0x84, 0x25, 0x5a, 0xc2, 0x25,
-  0x5e, 0x02, 0x26, 0x62, 0x42, 0x26, 0x66, 0x22, 0x15, 0x36, 0x36, 0xbb,
-  0x36, 0x97, 0x34, 0xb2, 0x32, 0x37, 0xba, 0x51, 0x02, 0x9a, 0xc8, 0x25,
-  0x2c, 0x4d, 0xce, 0xc5, 0xae, 0x4c, 0x6e, 0x2e, 0xed, 0xcd, 0x6d, 0x94,
-  0xa0, 0x26, 0x92, 0x0a, 0x4b, 0x93, 0x73, 0x61, 0x0b, 0x73, 0x3b, 0xab,
-  0x0b, 0x3b, 0x2b, 0xfb, 0xb2, 0x2b, 0x93, 0x9b, 0x4b, 0x7b, 0x73, 0x1b,
-  0x25, 0xb0, 0x89, 0x9c, 0xc2, 0xd2, 0xe4, 0x5c, 0xc6, 0xde, 0xda, 0xe0,
-  0xd2, 0xd8, 0xca, 0xbe, 0xde, 0xe0, 0xe8, 0xd2, 0xde, 0xdc, 0xe6, 0x46,
-  0x19, 0x6e, 0x02, 0x27, 0x72, 0x22, 0x99, 0xb0, 0x34, 0x39, 0x17, 0x33,
-  0xb9, 0xb0, 0xb3, 0xb6, 0x32, 0x37, 0xba, 0x51, 0x02, 0xb8, 0x00, 0x00,
-  0x00, 0x00, 0xa9, 0x18, 0x00, 0x00, 0x0b, 0x00, 0x00, 0x00, 0x0b, 0x0a,
-  0x72, 0x28, 0x87, 0x77, 0x80, 0x07, 0x7a, 0x58, 0x70, 0x98, 0x43, 0x3d,
-  0xb8, 0xc3, 0x38, 0xb0, 0x43, 0x39, 0xd0, 0xc3, 0x82, 0xe6, 0x1c, 0xc6,
-  0xa1, 0x0d, 0xe8, 0x41, 0x1e, 0xc2, 0xc1, 0x1d, 0xe6, 0x21, 0x1d, 0xe8,
-  0x21, 0x1d, 0xde, 0xc1, 0x1d, 0x00, 0xd1, 0x10, 0x00, 0x00, 0x06, 0x00,
-  0x00, 0x00, 0x07, 0xcc, 0x3c, 0xa4, 0x83, 0x3b, 0x9c, 0x03, 0x3b, 0x94,
-  0x03, 0x3d, 0xa0, 0x83, 0x3c, 0x94, 0x43, 0x38, 0x90, 0xc3, 0x01, 0x00,
-  0x00, 0x00, 0x61, 0x20, 0x00, 0x00, 0x86, 0x00, 0x00, 0x00, 0x13, 0x04,
-  0x41, 0x2c, 0x10, 0x00, 0x00, 0x00, 0x06, 0x00, 0x00, 0x00, 0x74, 0xcc,
-  0x00, 0xd0, 0x38, 0x07, 0xb1, 0x0c, 0x42, 0x28, 0x10, 0x30, 0x46, 0x00,
-  0x82, 0x0f, 0x0d, 0x33, 0x00, 0x44, 0xcc, 0x00, 0x00, 0x00, 0xf1, 0x30,
-  0x00, 0x00, 0x5b, 0x00, 0x00, 0x00, 0x22, 0x47, 0xc8, 0x90, 0x51, 0x16,
-  0xc4, 0x2a, 0x00, 0x00, 0x00, 0x00, 0xca, 0xf2, 0x3c, 0x14, 0x5f, 0x5a,
-  0x54, 0x53, 0x35, 0x53, 0x63, 0x65, 0x6e, 0x65, 0x61, 0x6e, 0x79, 0x20,
-  0x70, 0x6f, 0x69, 0x6e, 0x74, 0x65, 0x72, 0x6f, 0x6d, 0x6e, 0x69, 0x70,
-  0x6f, 0x74, 0x65, 0x6e, 0x74, 0x20, 0x63, 0x68, 0x61, 0x72, 0x53, 0x69,
-  0x6d, 0x70, 0x6c, 0x65, 0x20, 0x43, 0x2b, 0x2b, 0x20, 0x54, 0x42, 0x41,
-  0x41, 0x5f, 0x5a, 0x54, 0x53, 0x31, 0x34, 0x44, 0x65, 0x76, 0x69, 0x63,
-  0x65, 0x4d, 0x61, 0x74, 0x65, 0x72, 0x69, 0x61, 0x6c, 0x00, 0x13, 0x04,
-  0x30, 0x10, 0x83, 0x09, 0x02, 0x18, 0x8c, 0xc1, 0x04, 0x01, 0x0c, 0xc8,
-  0x60, 0x82, 0x00, 0x06, 0x65, 0x30, 0x41, 0x00, 0x03, 0x33, 0x98, 0x20,
-  0x80, 0xc1, 0x19, 0x4c, 0x10, 0xc0, 0x00, 0x0d, 0x26, 0x08, 0x60, 0x90,
-  0x06, 0x13, 0x04, 0x30, 0x50, 0x83, 0x09, 0x02, 0x18, 0xac, 0xc1, 0x04,
-  0x01, 0x0c, 0xd8, 0x60, 0x82, 0x00, 0x06, 0x6d, 0x30, 0x41, 0x00, 0x03,
-  0x37, 0x98, 0x20, 0x80, 0xc1, 0x1b, 0x4c, 0x10, 0xc0, 0x00, 0x0e, 0x26,
-  0x08, 0x60, 0x10, 0x07, 0x13, 0x04, 0x30, 0x90, 0x83, 0x09, 0x02, 0x18,
-  0xcc, 0xc1, 0x04, 0x01, 0x0c, 0xe8, 0x60, 0x82, 0x00, 0x06, 0x75, 0x30,
-  0x41, 0x00, 0x03, 0x3b, 0x98, 0x20, 0x80, 0xc1, 0x1d, 0x4c, 0x10, 0xc0,
-  0x00, 0x0f, 0x26, 0x08, 0x60, 0x90, 0x07, 0x1b, 0x82, 0xba, 0xd8, 0x30,
-  0xd0, 0xc5, 0x6b, 0xdc, 0xc5, 0x86, 0x61, 0x2e, 0x60, 0xe3, 0x2e, 0x36,
-  0x34, 0x72, 0x11, 0x1b, 0x77, 0x11, 0x1b, 0x78, 0x11, 0x1b, 0x79, 0x11,
-  0x1b, 0x7a, 0x11, 0x1b, 0x7b, 0x11, 0x1b, 0x7c, 0xb1, 0x61, 0x90, 0x8d,
-  0xd8, 0xd0, 0x8b, 0x0d, 0x83, 0x1b, 0xc0, 0xc6, 0x5d, 0x6c, 0x18, 0x78,
-  0x01, 0x36, 0xee, 0x62, 0x43, 0x1c, 0xd8, 0x05, 0x6d, 0xdc, 0x05, 0x6d,
-  0xf4, 0x05, 0x6d, 0xe0, 0x05, 0x6d, 0xf8, 0x05, 0x6d, 0xe4, 0x05, 0x6d,
-  0xfc, 0x05, 0x6d, 0xe8, 0x05, 0x6d, 0x80, 0x06, 0x6d, 0xec, 0x05, 0x6d,
-  0x84, 0x06, 0x6d, 0xf0, 0x05, 0x6d, 0x88, 0x46, 0x6d, 0x8c, 0x46, 0x6d,
-  0x90, 0x46, 0x6d, 0x94, 0x46, 0x6d, 0x98, 0x46, 0x6d, 0x9c, 0x46, 0x6d,
-  0xa0, 0x46, 0x6d, 0xa4, 0x46, 0x6d, 0xa8, 0x46, 0x6d, 0xac, 0x46, 0x6d,
-  0xb0, 0x06, 0x6d, 0xb4, 0x06, 0x6d, 0xb8, 0xc6, 0x86, 0xc1, 0x36, 0x68,
-  0xe3, 0x2e, 0x36, 0x0c, 0xb6, 0x41, 0x1b, 0x7d, 0xb1, 0x61, 0xb0, 0x0d,
-  0xda, 0xc0, 0x8b, 0x0d, 0x83, 0x6d, 0xd0, 0x86, 0x5f, 0x00, 0x1b, 0x1b,
-  0x0c, 0x32, 0xe0, 0x03, 0x0a, 0x24, 0x72, 0x0a, 0x18, 0x3b, 0x1a, 0x84,
-  0xc0, 0x0f, 0x28, 0x10, 0xc6, 0x1c, 0xc3, 0x11, 0x80, 0xc2, 0x8e, 0x86,
-  0x82, 0x48, 0x05, 0x0a, 0x84, 0x31, 0xc7, 0x30, 0x04, 0xab, 0xb0, 0xa3,
-  0x01, 0x39, 0x5a, 0x81, 0x02, 0x61, 0xcc, 0x31, 0x0c, 0xc1, 0x2b, 0xec,
-  0x68, 0x58, 0x14, 0x54, 0xa0, 0x40, 0x18, 0x73, 0x0c, 0x43, 0xa0, 0x0a,
-  0x23, 0x06, 0x86, 0x10, 0x82, 0x60, 0xe1, 0x1f, 0x1c, 0x2d, 0x04, 0x83,
-  0x0c, 0x59, 0x44, 0xcd, 0x31, 0x04, 0x54, 0x2b, 0xd8, 0x10, 0x88, 0x7f,
-  0x06, 0x01, 0x31, 0x00, 0x00, 0x00, 0x07, 0x00, 0x00, 0x00, 0x5b, 0x86,
-  0x20, 0x90, 0x8d, 0x2d, 0x03, 0x11, 0xd8, 0xc6, 0x96, 0xe1, 0x08, 0x6e,
-  0x63, 0xcb, 0xa0, 0x04, 0xb8, 0xb1, 0x65, 0x68, 0x82, 0xdc, 0x00, 0x00,
-  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x71, 0x20, 0x00, 0x00, 0x03, 0x00,
-  0x00, 0x00, 0x32, 0x0e, 0x10, 0x22, 0x84, 0x00, 0xf8, 0x08, 0x00, 0x00,
-  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x65, 0x0c, 0x00, 0x00, 0x23, 0x00,
-  0x00, 0x00, 0x12, 0x03, 0x94, 0x20, 0x01, 0x00, 0x00, 0x00, 0x01, 0x00,
-  0x00, 0x00, 0x2c, 0x00, 0x00, 0x00, 0x09, 0x00, 0x00, 0x00, 0x44, 0x00,
-  0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x50, 0x00, 0x00, 0x00, 0x00, 0x00,
-  0x00, 0x00, 0x50, 0x00, 0x00, 0x00, 0x02, 0x00, 0x00, 0x00, 0x80, 0x00,
-  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x35, 0x00, 0x00, 0x00, 0x18, 0x00,
-  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x11, 0x00, 0x00, 0x00, 0x4d, 0x00,
-  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x00,
-  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x11, 0x00,
-  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x11, 0x00, 0x00, 0x00, 0xff, 0xff,
-  0xff, 0xff, 0x00, 0x24, 0x00, 0x00, 0x11, 0x00, 0x00, 0x00, 0x1b, 0x00,
-  0x00, 0x00, 0x11, 0x00, 0x00, 0x00, 0x1b, 0x00, 0x00, 0x00, 0xff, 0xff,
-  0xff, 0xff, 0x08, 0x24, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x5d, 0x0c,
-  0x00, 0x00, 0x17, 0x00, 0x00, 0x00, 0x12, 0x03, 0x94, 0xad, 0x00, 0x00,
-  0x00, 0x00, 0x74, 0x72, 0x69, 0x61, 0x6e, 0x67, 0x6c, 0x65, 0x5f, 0x66,
-  0x72, 0x61, 0x67, 0x6d, 0x65, 0x6e, 0x74, 0x61, 0x69, 0x72, 0x2e, 0x63,
-  0x6f, 0x6e, 0x76, 0x65, 0x72, 0x74, 0x2e, 0x66, 0x2e, 0x76, 0x34, 0x66,
-  0x31, 0x36, 0x2e, 0x66, 0x2e, 0x76, 0x34, 0x66, 0x33, 0x32, 0x33, 0x31,
-  0x30, 0x30, 0x31, 0x2e, 0x31, 0x38, 0x34, 0x61, 0x69, 0x72, 0x36, 0x34,
-  0x2d, 0x61, 0x70, 0x70, 0x6c, 0x65, 0x2d, 0x6d, 0x61, 0x63, 0x6f, 0x73,
-  0x78, 0x31, 0x31, 0x2e, 0x30, 0x2e, 0x30, 0x00, 0x00, 0x00, 0x00, 0x00,
-  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-  0x00, 0x00
-};
-unsigned int cpp_src_shaders_metallib_len = 24734;
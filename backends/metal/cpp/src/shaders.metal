@@ -1,9 +1,26 @@
+#include <metal_raytracing>
 #include <metal_stdlib>
 
 #include "structs.h"
 
 using namespace metal;
 
+// Set by build.rs for the library of every GPU family, only Apple GPUs have the tile memory passes.
+#ifndef RFW_TILE_MEMORY
+#define RFW_TILE_MEMORY 1
+#endif
+
+constant bool instance_culling [[function_constant(INSTANCE_CULLING_CONSTANT_INDEX)]];
+constant bool occlusion_culling [[function_constant(OCCLUSION_CULLING_CONSTANT_INDEX)]];
+constant uint texture_mode_2d [[function_constant(TEXTURE_MODE_2D_CONSTANT_INDEX)]];
+constant bool rate_mapped [[function_constant(RATE_MAP_CONSTANT_INDEX)]];
+constant bool hardware_tracing [[function_constant(HARDWARE_TRACING_CONSTANT_INDEX)]];
+constant bool software_tracing = !hardware_tracing;
+constant uint post_effects [[function_constant(POST_EFFECTS_CONSTANT_INDEX)]];
+constant bool bloom_effect = (post_effects & POST_BLOOM) != 0;
+constant bool color_grading = (post_effects & POST_COLOR_GRADING) != 0;
+constant bool vignette_effect = (post_effects & POST_VIGNETTE) != 0;
+
 struct ColorInOut
 {
     float4 position [[position]];
@@ -18,14 +35,34 @@ struct Texture
     texture2d<float> tex [[id(0)]];
 };
 
+struct TextureArray
+{
+    texture2d_array<float> tex [[id(0)]];
+};
+
+struct SamplerEntry
+{
+    sampler s [[id(0)]];
+};
+
+// Members are in the order of their index, Metal 3 GPUs write the scene as an array of their addresses.
 struct Scene
 {
     const device Vertex3D *vertices [[id(VERTICES_ARG_INDEX)]];
     const device Vertex2D *vertices_2d [[id(VERTICES_2D_ARG_INDEX)]];
     const device Texture *textures [[id(TEXTURES_ARG_INDEX)]];
-    const device DeviceMaterial *materials [[id(MATERIALS_ARG_INDEX)]];
+    const device PackedMaterial *materials [[id(MATERIALS_ARG_INDEX)]];
     const device InstanceTransform *instances [[id(INSTANCES_ARG_INDEX)]];
     const device simd_float4x4 *instances_2d [[id(INSTANCES_2D_ARG_INDEX)]];
+    const device PackedVertex3D *packed_vertices [[id(PACKED_VERTICES_ARG_INDEX)]];
+    const device uint *visible_instances [[id(VISIBLE_INSTANCES_ARG_INDEX)]];
+    const device Vertex3D *anim_vertices [[id(ANIM_VERTICES_ARG_INDEX)]];
+    const device uint *virtual_pages [[id(VIRTUAL_PAGES_ARG_INDEX)]];
+    const device InstanceOverride *instance_overrides [[id(INSTANCE_OVERRIDES_ARG_INDEX)]];
+    const device SamplerEntry *samplers [[id(SAMPLERS_ARG_INDEX)]];
+    const device uint *texture_layers [[id(TEXTURE_LAYERS_ARG_INDEX)]];
+    const device TextureArray *texture_arrays [[id(TEXTURE_ARRAYS_ARG_INDEX)]];
+    const device float4 *positions [[id(POSITIONS_ARG_INDEX)]];
 };
 
 // vertex shader function
@@ -46,14 +83,190 @@ vertex ColorInOut triangle_vertex_2d(const device Scene &scene [[buffer(0)]],
     return out;
 }
 
+// Vertices of batched 2D meshes, already transformed by their instance.
+vertex ColorInOut batched_vertex_2d(const device UniformCamera *camera [[buffer(1)]],
+                                    const device Vertex2D *vertices [[buffer(2)]], unsigned int vid [[vertex_id]])
+{
+    ColorInOut out;
+
+    const device Vertex2D &v = vertices[vid];
+    out.position = camera->matrix_2d * float4(v.v_x, v.v_y, v.v_z, 1.0);
+    out.color = float4(v.c_r, v.c_g, v.c_b, v.c_a);
+    out.uv = float2(v.u, v.v);
+    out.tex = v.tex;
+
+    return out;
+}
+
+// The corners of sprites are generated from the vertex id, sprites are drawn with the fragment function of 2D meshes.
+vertex ColorInOut sprite_vertex(const device UniformCamera *camera [[buffer(1)]],
+                                const device SpriteInstance *sprites [[buffer(2)]], unsigned int vid [[vertex_id]],
+                                unsigned int i_id [[instance_id]])
+{
+    const device SpriteInstance &s = sprites[i_id];
+    // Corners of the two triangles of the quad, (0, 0), (1, 0), (1, 1) and (0, 0), (1, 1), (0, 1).
+    const float2 corner = float2((0x16u >> vid) & 1u, (0x34u >> vid) & 1u);
+    const float2 offset = (corner - 0.5) * float2(s.width, s.height);
+    const float sin_r = sin(s.rotation);
+    const float cos_r = cos(s.rotation);
+
+    ColorInOut out;
+    const float2 position =
+        float2(s.x, s.y) + float2(offset.x * cos_r - offset.y * sin_r, offset.x * sin_r + offset.y * cos_r);
+    out.position = camera->matrix_2d * float4(position, s.z, 1.0);
+    out.color = unpack_unorm4x8_to_float(s.color);
+    out.uv = (float2(s.uv_x, s.uv_y) + corner * float2(s.uv_width, s.uv_height)) / 65535.0;
+    out.tex = s.tex;
+    return out;
+}
+
+struct GlyphInOut
+{
+    float4 position [[position]];
+    float4 color;
+    float2 uv;
+};
+
+vertex GlyphInOut glyph_vertex(const device UniformCamera *camera [[buffer(1)]],
+                               const device GlyphInstance *glyphs [[buffer(2)]], texture2d<float> atlas [[texture(0)]],
+                               unsigned int vid [[vertex_id]], unsigned int i_id [[instance_id]])
+{
+    const device GlyphInstance &g = glyphs[i_id];
+    // Corners of the two triangles of the quad, (0, 0), (1, 0), (1, 1) and (0, 0), (1, 1), (0, 1).
+    const float2 corner = float2((0x16u >> vid) & 1u, (0x34u >> vid) & 1u);
+
+    GlyphInOut out;
+    const float2 position = float2(g.x, g.y) + corner * float2(g.width, g.height);
+    out.position = camera->matrix_2d * float4(position, g.z, 1.0);
+    out.color = unpack_unorm4x8_to_float(g.color);
+    const float2 texel = float2(g.atlas_x, g.atlas_y) + corner * float2(g.atlas_width, g.atlas_height);
+    out.uv = texel / float2(atlas.get_width(), atlas.get_height());
+    return out;
+}
+
+fragment float4 glyph_fragment(GlyphInOut in [[stage_in]], texture2d<float> atlas [[texture(0)]])
+{
+    constexpr sampler atlas_sampler(mag_filter::linear, min_filter::linear);
+    float4 color = in.color;
+    color.w *= atlas.sample(atlas_sampler, in.uv).r;
+    if (color.w <= 0.0)
+        discard_fragment();
+    return color;
+}
+
+struct PathInOut
+{
+    float4 position [[position]];
+    float2 path;
+};
+
+// Quad over the bounds of a path, the corners of its two triangles like those of sprites.
+vertex PathInOut path_vertex(const device UniformCamera *camera [[buffer(1)]],
+                             constant PathUniforms2D &path [[buffer(3)]], unsigned int vid [[vertex_id]])
+{
+    const float2 corner = float2((0x16u >> vid) & 1u, (0x34u >> vid) & 1u);
+
+    PathInOut out;
+    out.path = mix(path.quad.xy, path.quad.zw, corner);
+    out.position = camera->matrix_2d * path.transform * float4(out.path, path.z, 1.0);
+    return out;
+}
+
+float path_segment_distance(float2 p, float4 segment)
+{
+    const float2 ab = segment.zw - segment.xy;
+    const float t = saturate(dot(p - segment.xy, ab) / max(dot(ab, ab), 1e-12));
+    return length(p - segment.xy - ab * t);
+}
+
+int2 path_band(float2 p, constant PathUniforms2D &path)
+{
+    return int2(floor((p - path.bands.xy) / path.bands.zw));
+}
+
+// Winding number of p along a ray towards +x, or +y for axis 1, through the segments of band `band`. Crossings within
+// half a pixel of p count by how much of the pixel they cover, which antialiases the edges.
+float path_winding(float2 p, float pixel, uint axis, uint band, const device float4 *segments,
+                   const device uint2 *bands, const device uint *indices)
+{
+    const uint other = 1 - axis;
+    float winding = 0.0;
+    for (uint i = bands[band].x; i < bands[band].x + bands[band].y; i++)
+    {
+        const float4 segment = segments[indices[i]];
+        const float2 a = axis == 0 ? segment.xy : segment.yx;
+        const float2 b = axis == 0 ? segment.zw : segment.wz;
+        // Half open, so a ray through a shared end point crosses one of the segments.
+        if ((a.y <= p[other]) == (b.y <= p[other]))
+            continue;
+        const float crossing = mix(a.x, b.x, (p[other] - a.y) / (b.y - a.y));
+        // Counter-clockwise contours wind positively around both rays.
+        const float direction = (b.y > a.y) == (axis == 0) ? 1.0 : -1.0;
+        winding += direction * saturate((crossing - p[axis]) / pixel + 0.5);
+    }
+    return winding;
+}
+
+// Coverage of the pixel by a path computed from its segments, without any tessellation. Fills average the coverage
+// of rays along x and y, strokes are covered within half their width of any segment.
+fragment float4 path_fragment(PathInOut in [[stage_in]], const device float4 *segments [[buffer(2)]],
+                              constant PathUniforms2D &path [[buffer(3)]], const device uint2 *bands [[buffer(4)]],
+                              const device uint *indices [[buffer(5)]])
+{
+    const float2 p = in.path;
+    const float2 pixel = max(fwidth(p), float2(1e-6));
+    const int2 band_count = int2(path.bands_x, path.bands_y);
+
+    float coverage = 0.0;
+    if (path.half_width > 0.0)
+    {
+        // Segments within reach cross a row of bands within reach, visiting a segment again leaves the distance as is.
+        const float size = max(pixel.x, pixel.y);
+        const float reach = path.half_width + size;
+        const int first = max(path_band(p - reach, path).y, 0);
+        const int last = min(path_band(p + reach, path).y, band_count.y - 1);
+        float distance = INFINITY;
+        for (int band = first; band <= last; band++)
+        {
+            for (uint i = bands[band].x; i < bands[band].x + bands[band].y; i++)
+                distance = min(distance, path_segment_distance(p, segments[indices[i]]));
+        }
+        coverage = saturate((path.half_width - distance) / size + 0.5);
+    }
+    else
+    {
+        const int2 band = path_band(p, path);
+        for (uint axis = 0; axis < 2; axis++)
+        {
+            const uint other = 1 - axis;
+            if (band[other] < 0 || band[other] >= band_count[other])
+                continue;
+            // Rows come first, columns after them.
+            const uint index = axis == 0 ? uint(band.y) : uint(band_count.y + band.x);
+            const float winding = abs(path_winding(p, pixel[axis], axis, index, segments, bands, indices));
+            coverage += 0.5 * (path.even_odd != 0 ? 1.0 - abs(1.0 - fmod(winding, 2.0)) : min(winding, 1.0));
+        }
+    }
+
+    float4 color = unpack_unorm4x8_to_float(path.color);
+    color.w *= coverage;
+    if (color.w <= 0.0)
+        discard_fragment();
+    return color;
+}
+
 // fragment shader function
 fragment float4 triangle_fragment_2d(ColorInOut in [[stage_in]], const device Scene &scene [[buffer(0)]])
 {
     auto color = in.color;
-    if (in.tex > 0)
+    if (texture_mode_2d == TEXTURE_MODE_2D_ALL || (texture_mode_2d == TEXTURE_MODE_2D_MIXED && in.tex > 0))
     {
-        constexpr sampler textureSampler(mag_filter::linear, min_filter::linear);
-        color = color * scene.textures[in.tex].tex.sample(textureSampler, in.uv);
+        const sampler filter = scene.samplers[SAMPLER_2D].s;
+        const uint layer = scene.texture_layers[in.tex];
+        if (layer != NO_TEXTURE_LAYER)
+            color = color * scene.texture_arrays[layer >> 16].tex.sample(filter, in.uv, layer & 0xFFFF);
+        else
+            color = color * scene.textures[in.tex].tex.sample(filter, in.uv);
     }
 
     if (color.w <= 0.0)
@@ -64,40 +277,6264 @@ fragment float4 triangle_fragment_2d(ColorInOut in [[stage_in]], const device Sc
     return color;
 }
 
+// Affine transform of an instance as a full matrix, translated to be relative to origin. The translation is moved
+// before the rotation and scale are applied, which keeps it exact near the origin.
+float4x4 instance_matrix(const device InstanceTransform &t, float3 origin = float3(0.0))
+{
+    const float4 translation = float4(t.rows[0].w, t.rows[1].w, t.rows[2].w, 0.0) - float4(origin, 0.0);
+    return float4x4(float4(t.rows[0].x, t.rows[1].x, t.rows[2].x, 0.0),
+                    float4(t.rows[0].y, t.rows[1].y, t.rows[2].y, 0.0),
+                    float4(t.rows[0].z, t.rows[1].z, t.rows[2].z, 0.0), translation + float4(0.0, 0.0, 0.0, 1.0));
+}
+
+// Object to world space normal transform. The cofactor matrix of the upper 3x3 equals its inverse transpose scaled by
+// the determinant, so it handles non-uniform scale without an inverse and reduces to the rotation for uniform scale.
+float3 transform_normal(float4x4 m, float3 n)
+{
+    const float3 c0 = m[0].xyz;
+    const float3 c1 = m[1].xyz;
+    const float3 c2 = m[2].xyz;
+    const float3x3 cofactor = float3x3(cross(c1, c2), cross(c2, c0), cross(c0, c1));
+    // Mirrored transforms have a negative determinant, which would flip the normal.
+    return normalize(cofactor * n) * sign(dot(c0, cofactor[0]));
+}
+
 struct VertexInOut
 {
-    float4 position [[position]];
+    // Invariant so the depth of the main pass matches the depth pre-pass exactly.
+    float4 position [[position, invariant]];
+    float3 world_position;
+    // Tint of the instance, see override_instance.
     half4 color;
     half3 normal;
+    // Bitangent sign in w.
+    half4 tangent;
     ushort mat_id;
     float2 uv;
+    // Second texture coordinates, those of the lightmap of the material.
+    float2 lightmap_uv;
 };
 
+VertexInOut shade_vertex(Vertex3D v, float4x4 m, const device UniformCamera *camera)
+{
+    VertexInOut out;
+
+    const float3 normal = transform_normal(m, float3(v.n_x, v.n_y, v.n_z));
+    const float3 tangent = (m * float4(v.t_x, v.t_y, v.t_z, 0.0)).xyz;
+    const float4 relative_position = m * float4(v.v_x, v.v_y, v.v_z, v.v_w);
+
+    out.position = camera->combined * relative_position;
+    out.world_position = relative_position.xyz + camera->origin.xyz;
+    out.color = half4(1.0);
+    out.normal = (half3)normal;
+    out.tangent = half4(half3(normalize(tangent)), v.t_w < 0.0 ? -1.0h : 1.0h);
+    out.uv = float2(v.u, v.v);
+    out.lightmap_uv = float2(v.pad0, v.pad1);
+    out.mat_id = (ushort)v.mat_id;
+
+    return out;
+}
+
+VertexInOut shade_vertex(const device Vertex3D &v, const device InstanceTransform &t,
+                         const device UniformCamera *camera)
+{
+    return shade_vertex(v, instance_matrix(t, camera->origin.xyz), camera);
+}
+
+// Direction of the octahedral map at uv in [0, 1], with y pointing at the center of the map.
+float3 octahedral_direction(float2 uv)
+{
+    const float2 e = uv * 2.0 - 1.0;
+    float3 d = float3(e.x, 1.0 - abs(e.x) - abs(e.y), e.y);
+    const float t = saturate(-d.y);
+    d.xz += select(float2(t), float2(-t), d.xz >= 0.0);
+    return normalize(d);
+}
+
+float2 octahedral_uv(float3 d)
+{
+    d /= abs(d.x) + abs(d.y) + abs(d.z);
+    float2 e = d.xz;
+    if (d.y < 0.0)
+        e = (1.0 - abs(d.zx)) * select(float2(-1.0), float2(1.0), e >= 0.0);
+    return e * 0.5 + 0.5;
+}
+
+// The tile at tile of an impostor atlas views its mesh along -d, with right and up as its x and y axes.
+float3 impostor_axes(uint2 tile, uint tiles, thread float3 &right, thread float3 &up)
+{
+    const float3 d = octahedral_direction((float2(tile) + 0.5) / float(tiles));
+    const float3 reference = abs(d.y) > 0.999 ? float3(0.0, 0.0, -1.0) : float3(0.0, 1.0, 0.0);
+    right = normalize(cross(reference, d));
+    up = cross(d, right);
+    return d;
+}
+
+bool is_impostor(const device Vertex3D &v)
+{
+    return (v.mat_id & IMPOSTOR_VERTEX) != 0;
+}
+
+// Vertex of an impostor grid facing the camera origin with the tile of its atlas that views the mesh from closest to
+// the same direction. Its vertices hold the center of the bounds of the mesh in v_x, v_y and v_z, their radius in n_x,
+// the tiles of the atlas in n_y, their corner of the grid in u and v and the center of their cell in pad0 and pad1.
+// Corners move along the tile direction by the depth in the alpha of the normal atlas, cells the albedo atlas doesn't
+// cover collapse to the center, so no pass needs to test the alpha of their fragments.
+Vertex3D impostor_vertex(const device Scene &scene, const device Vertex3D &v, float4x4 m)
+{
+    constexpr sampler atlas_sampler(filter::linear, address::clamp_to_edge);
+    const float3 center = float3(v.v_x, v.v_y, v.v_z);
+    const float radius = v.n_x;
+    const uint tiles = uint(v.n_y);
+    const device PackedMaterial &material = scene.materials[v.mat_id & ~IMPOSTOR_VERTEX];
+
+    // Positions are relative to the camera origin, which is at -m * center from the center in object space.
+    const float3x3 axes = float3x3(m[0].xyz, m[1].xyz, m[2].xyz);
+    const float3 eye = transpose(axes) * -(m * float4(center, 1.0)).xyz;
+    const uint2 tile = min(uint2(octahedral_uv(normalize(eye)) * float(tiles)), uint2(tiles - 1));
+    float3 right, up;
+    const float3 d = impostor_axes(tile, tiles, right, up);
+
+    const float2 corner = float2(v.u, v.v);
+    const float2 uv = (float2(tile) + float2(corner.x, 1.0 - corner.y)) / float(tiles);
+    const float2 cell_uv = (float2(tile) + float2(v.pad0, 1.0 - v.pad1)) / float(tiles);
+    const float coverage = scene.textures[material.diffuse_map].tex.sample(atlas_sampler, cell_uv, level(0.0)).a;
+    const float depth = scene.textures[material.normal_map].tex.sample(atlas_sampler, uv, level(0.0)).a;
+
+    float3 p = center;
+    if (coverage >= 0.5)
+        p += (right * (corner.x * 2.0 - 1.0) + up * (corner.y * 2.0 - 1.0) + d * (1.0 - depth * 2.0)) * radius;
+
+    Vertex3D out = {p.x, p.y, p.z, 1.0, d.x, d.y, d.z, v.mat_id & ~IMPOSTOR_VERTEX, uv.x, uv.y, 0.0, 0.0,
+                    right.x, right.y, right.z, 1.0};
+    return out;
+}
+
+// Vertex vid of the full vertex buffer, which may be the vertex of an impostor.
+VertexInOut shade_mesh_vertex(const device Scene &scene, uint vid, const device InstanceTransform &t,
+                              const device UniformCamera *camera)
+{
+    const device Vertex3D &v = scene.vertices[vid];
+    const float4x4 m = instance_matrix(t, camera->origin.xyz);
+    if (is_impostor(v))
+        return shade_vertex(impostor_vertex(scene, v, m), m, camera);
+    return shade_vertex(v, m, camera);
+}
+
+// Object space position of vertex vid of the full vertex buffer, computed like in shade_mesh_vertex.
+float4 mesh_position(const device Scene &scene, uint vid, float4x4 m)
+{
+    const device Vertex3D &v = scene.vertices[vid];
+    if (!is_impostor(v))
+        return float4(v.v_x, v.v_y, v.v_z, v.v_w);
+    const Vertex3D impostor = impostor_vertex(scene, v, m);
+    return float4(impostor.v_x, impostor.v_y, impostor.v_z, impostor.v_w);
+}
+
+// mesh_position reading the position stream, impostor vertices are stored with a w of 0 and take the full vertex.
+float4 stream_position(const device Scene &scene, uint vid, float4x4 m)
+{
+    const float4 position = scene.positions[vid];
+    return position.w != 0.0 ? position : mesh_position(scene, vid, m);
+}
+
+// Applies the material and tint overrides of the instance in slot instance, slots past those the override buffer
+// covers keep the material of their vertices.
+VertexInOut override_instance(VertexInOut out, const device Scene &scene, uint instance)
+{
+    if (instance >= scene.instance_overrides[0].material)
+        return out;
+
+    const device InstanceOverride &o = scene.instance_overrides[1 + instance];
+    if (o.material != NO_MATERIAL_OVERRIDE)
+        out.mat_id = ushort(o.material);
+    out.color = half4(o.tint);
+    return out;
+}
+
 // vertex shader function
 vertex VertexInOut triangle_vertex(const device Scene &scene [[buffer(0)]],
                                    const device UniformCamera *camera [[buffer(1)]], unsigned int vid [[vertex_id]],
                                    unsigned int i_id [[instance_id]])
+{
+    const uint instance = instance_culling ? scene.visible_instances[i_id] : i_id;
+    return override_instance(shade_mesh_vertex(scene, vid, scene.instances[instance], camera), scene, instance);
+}
+
+// vertex shader function for instances drawn from the output of skin_vertices
+vertex VertexInOut triangle_vertex_skinned(const device Scene &scene [[buffer(0)]],
+                                           const device UniformCamera *camera [[buffer(1)]],
+                                           unsigned int vid [[vertex_id]], unsigned int i_id [[instance_id]])
+{
+    return override_instance(shade_vertex(scene.anim_vertices[vid], scene.instances[i_id], camera), scene, i_id);
+}
+
+float3 decode_octahedral(short x, short y)
+{
+    const float2 e = clamp(float2(x, y) / 32767.0, -1.0, 1.0);
+    float3 n = float3(e, 1.0 - abs(e.x) - abs(e.y));
+    const float t = saturate(-n.z);
+    n.xy += select(float2(t), float2(-t), n.xy >= 0.0);
+    return normalize(n);
+}
+
+VertexInOut shade_packed_vertex(const device PackedVertex3D &v, const device InstanceTransform &t,
+                                constant PackedVertexBounds &bounds, const device UniformCamera *camera)
 {
     VertexInOut out;
 
-    const device auto &v = scene.vertices[vid];
-    const device auto &t = scene.instances[i_id];
+    const float3 position = bounds.offset.xyz + float3(v.p_x, v.p_y, v.p_z) / 65535.0 * bounds.scale.xyz;
+    const float4x4 m = instance_matrix(t, camera->origin.xyz);
+    const float3 normal = transform_normal(m, decode_octahedral(v.n_x, v.n_y));
+    const float3 tangent = (m * float4(decode_octahedral(v.t_x, v.t_y), 0.0)).xyz;
 
-    const float3 normal = (t.normal_matrix * float4(v.n_x, v.n_y, v.n_z, 0.0)).xyz;
+    const float4 relative_position = m * float4(position, 1.0);
 
-    out.position = camera->combined * t.matrix * float4(v.v_x, v.v_y, v.v_z, v.v_w);
-    out.color = (half4)(float4(normalize(normal.xyz), 0.2));
+    out.position = camera->combined * relative_position;
+    out.world_position = relative_position.xyz + camera->origin.xyz;
+    out.color = half4(1.0);
     out.normal = (half3)normal;
-    out.uv = float2(v.u, v.v);
-    out.mat_id = (ushort)v.mat_id;
+    out.tangent = half4(half3(normalize(tangent)), (v.flags & 1) != 0 ? -1.0h : 1.0h);
+    out.uv = float2(as_type<half>(v.u), as_type<half>(v.v));
+    // Packed vertices drop the second texture coordinates, lightmaps need meshes of the full format.
+    out.lightmap_uv = float2(0.0);
+    out.mat_id = v.mat_id;
 
     return out;
 }
 
-// fragment shader function
-fragment half4 triangle_fragment(VertexInOut in [[stage_in]], const device Scene &scene [[buffer(0)]])
+// vertex shader function for meshes stored as PackedVertex3D
+vertex VertexInOut triangle_vertex_packed(const device Scene &scene [[buffer(0)]],
+                                          const device UniformCamera *camera [[buffer(1)]],
+                                          constant PackedVertexBounds &bounds [[buffer(2)]],
+                                          unsigned int vid [[vertex_id]], unsigned int i_id [[instance_id]])
+{
+    const uint instance = instance_culling ? scene.visible_instances[i_id] : i_id;
+    return override_instance(shade_packed_vertex(scene.packed_vertices[vid], scene.instances[instance], bounds, camera),
+                             scene, instance);
+}
+
+// Vertex of an inset view, every draw is amplified into the viewports of several views. The members of VertexInOut are
+// matched by name, so fragment functions read it as one.
+struct InsetInOut
+{
+    float4 position [[position]];
+    float3 world_position;
+    half4 color;
+    half3 normal;
+    half4 tangent;
+    ushort mat_id;
+    float2 uv;
+    float2 lightmap_uv;
+    ushort viewport [[viewport_array_index]];
+};
+
+InsetInOut inset_out(VertexInOut v, ushort viewport)
+{
+    InsetInOut out;
+    out.position = v.position;
+    out.world_position = v.world_position;
+    out.color = v.color;
+    out.normal = v.normal;
+    out.tangent = v.tangent;
+    out.mat_id = v.mat_id;
+    out.uv = v.uv;
+    out.lightmap_uv = v.lightmap_uv;
+    out.viewport = viewport;
+    return out;
+}
+
+// Vertex functions of the inset views, the camera of a view is at the index of its viewport. Amplified draws cover the
+// views from first_view on.
+vertex InsetInOut inset_vertex(const device Scene &scene [[buffer(0)]],
+                               const device UniformCamera *cameras [[buffer(1)]],
+                               constant uint &first_view [[buffer(3)]], unsigned int vid [[vertex_id]],
+                               unsigned int i_id [[instance_id]], ushort amplification [[amplification_id]])
+{
+    const ushort view = ushort(first_view) + amplification;
+    const VertexInOut v = shade_mesh_vertex(scene, vid, scene.instances[i_id], cameras + view);
+    return inset_out(override_instance(v, scene, i_id), view);
+}
+
+vertex InsetInOut inset_vertex_skinned(const device Scene &scene [[buffer(0)]],
+                                       const device UniformCamera *cameras [[buffer(1)]],
+                                       constant uint &first_view [[buffer(3)]], unsigned int vid [[vertex_id]],
+                                       unsigned int i_id [[instance_id]], ushort amplification [[amplification_id]])
+{
+    const ushort view = ushort(first_view) + amplification;
+    const VertexInOut v = shade_vertex(scene.anim_vertices[vid], scene.instances[i_id], cameras + view);
+    return inset_out(override_instance(v, scene, i_id), view);
+}
+
+vertex InsetInOut inset_vertex_packed(const device Scene &scene [[buffer(0)]],
+                                      const device UniformCamera *cameras [[buffer(1)]],
+                                      constant PackedVertexBounds &bounds [[buffer(2)]],
+                                      constant uint &first_view [[buffer(3)]], unsigned int vid [[vertex_id]],
+                                      unsigned int i_id [[instance_id]], ushort amplification [[amplification_id]])
+{
+    const ushort view = ushort(first_view) + amplification;
+    const VertexInOut v =
+        shade_packed_vertex(scene.packed_vertices[vid], scene.instances[i_id], bounds, cameras + view);
+    return inset_out(override_instance(v, scene, i_id), view);
+}
+
+// Vertex of a reflection probe face. Every draw is amplified into several faces, the layers of the pass from the first
+// face it draws on. The members of VertexInOut are matched by name, so fragment functions read it as one.
+struct ProbeInOut
+{
+    float4 position [[position]];
+    float3 world_position;
+    half4 color;
+    half3 normal;
+    half4 tangent;
+    ushort mat_id;
+    float2 uv;
+    float2 lightmap_uv;
+    uint layer [[render_target_array_index]];
+};
+
+ProbeInOut probe_out(VertexInOut v, uint layer)
+{
+    ProbeInOut out;
+    out.position = v.position;
+    out.world_position = v.world_position;
+    out.color = v.color;
+    out.normal = v.normal;
+    out.tangent = v.tangent;
+    out.mat_id = v.mat_id;
+    out.uv = v.uv;
+    out.lightmap_uv = v.lightmap_uv;
+    out.layer = layer;
+    return out;
+}
+
+// Vertex functions of the reflection probe faces, the camera of a face is at the index of its layer.
+vertex ProbeInOut probe_vertex(const device Scene &scene [[buffer(0)]],
+                               const device UniformCamera *cameras [[buffer(1)]],
+                               constant uint &first_view [[buffer(3)]], unsigned int vid [[vertex_id]],
+                               unsigned int i_id [[instance_id]], ushort amplification [[amplification_id]])
+{
+    const uint layer = first_view + amplification;
+    const VertexInOut v = shade_mesh_vertex(scene, vid, scene.instances[i_id], cameras + layer);
+    return probe_out(override_instance(v, scene, i_id), layer);
+}
+
+vertex ProbeInOut probe_vertex_skinned(const device Scene &scene [[buffer(0)]],
+                                       const device UniformCamera *cameras [[buffer(1)]],
+                                       constant uint &first_view [[buffer(3)]], unsigned int vid [[vertex_id]],
+                                       unsigned int i_id [[instance_id]], ushort amplification [[amplification_id]])
+{
+    const uint layer = first_view + amplification;
+    const VertexInOut v = shade_vertex(scene.anim_vertices[vid], scene.instances[i_id], cameras + layer);
+    return probe_out(override_instance(v, scene, i_id), layer);
+}
+
+vertex ProbeInOut probe_vertex_packed(const device Scene &scene [[buffer(0)]],
+                                      const device UniformCamera *cameras [[buffer(1)]],
+                                      constant PackedVertexBounds &bounds [[buffer(2)]],
+                                      constant uint &first_view [[buffer(3)]], unsigned int vid [[vertex_id]],
+                                      unsigned int i_id [[instance_id]], ushort amplification [[amplification_id]])
+{
+    const uint layer = first_view + amplification;
+    const VertexInOut v =
+        shade_packed_vertex(scene.packed_vertices[vid], scene.instances[i_id], bounds, cameras + layer);
+    return probe_out(override_instance(v, scene, i_id), layer);
+}
+
+struct DepthOut
+{
+    float4 position [[position, invariant]];
+};
+
+// Position-only vertex functions of the depth pre-pass, positions are computed exactly like in the functions above so
+// both passes produce the same depth.
+vertex DepthOut depth_vertex(const device Scene &scene [[buffer(0)]], const device UniformCamera *camera [[buffer(1)]],
+                             unsigned int vid [[vertex_id]], unsigned int i_id [[instance_id]])
+{
+    const device auto &t = scene.instances[instance_culling ? scene.visible_instances[i_id] : i_id];
+    const float4x4 m = instance_matrix(t, camera->origin.xyz);
+    return {camera->combined * (m * mesh_position(scene, vid, m))};
+}
+
+vertex DepthOut depth_position_vertex(const device Scene &scene [[buffer(0)]],
+                                      const device UniformCamera *camera [[buffer(1)]], unsigned int vid [[vertex_id]],
+                                      unsigned int i_id [[instance_id]])
+{
+    const device auto &t = scene.instances[instance_culling ? scene.visible_instances[i_id] : i_id];
+    const float4x4 m = instance_matrix(t, camera->origin.xyz);
+    return {camera->combined * (m * stream_position(scene, vid, m))};
+}
+
+vertex DepthOut depth_vertex_skinned(const device Scene &scene [[buffer(0)]],
+                                     const device UniformCamera *camera [[buffer(1)]], unsigned int vid [[vertex_id]],
+                                     unsigned int i_id [[instance_id]])
+{
+    const device auto &v = scene.anim_vertices[vid];
+    const float4x4 m = instance_matrix(scene.instances[i_id], camera->origin.xyz);
+    return {camera->combined * (m * float4(v.v_x, v.v_y, v.v_z, v.v_w))};
+}
+
+vertex DepthOut depth_vertex_packed(const device Scene &scene [[buffer(0)]],
+                                    const device UniformCamera *camera [[buffer(1)]],
+                                    constant PackedVertexBounds &bounds [[buffer(2)]], unsigned int vid [[vertex_id]],
+                                    unsigned int i_id [[instance_id]])
+{
+    const device auto &v = scene.packed_vertices[vid];
+    const device auto &t = scene.instances[instance_culling ? scene.visible_instances[i_id] : i_id];
+    const float3 position = bounds.offset.xyz + float3(v.p_x, v.p_y, v.p_z) / 65535.0 * bounds.scale.xyz;
+    return {camera->combined * (instance_matrix(t, camera->origin.xyz) * float4(position, 1.0))};
+}
+
+struct PickOut
+{
+    float4 position [[position, invariant]];
+    uint instance [[flat]];
+};
+
+// Box of a visibility group as a triangle strip of 14 vertices, boxes are minimum and maximum pairs in world space
+// and drawn one instance each.
+vertex DepthOut visibility_box_vertex(const device float4 *boxes [[buffer(0)]],
+                                      const device UniformCamera *camera [[buffer(1)]], uint vid [[vertex_id]],
+                                      uint i_id [[instance_id]])
+{
+    const uint bit = 1u << vid;
+    const float3 corner = float3((0x287Au & bit) != 0, (0x02AFu & bit) != 0, (0x31E3u & bit) != 0);
+    const float3 p = mix(boxes[i_id * 2].xyz, boxes[i_id * 2 + 1].xyz, corner);
+    return {camera->combined * float4(p - camera->origin.xyz, 1.0)};
+}
+
+// Vertex functions of the pick pass, which writes the instance slot of the surface at every pixel. Positions are
+// computed like in the depth pre-pass.
+vertex PickOut pick_vertex(const device Scene &scene [[buffer(0)]], const device UniformCamera *camera [[buffer(1)]],
+                           unsigned int vid [[vertex_id]], unsigned int i_id [[instance_id]])
+{
+    const uint instance = instance_culling ? scene.visible_instances[i_id] : i_id;
+    const float4x4 m = instance_matrix(scene.instances[instance], camera->origin.xyz);
+    return {camera->combined * (m * mesh_position(scene, vid, m)), instance};
+}
+
+vertex PickOut pick_position_vertex(const device Scene &scene [[buffer(0)]],
+                                    const device UniformCamera *camera [[buffer(1)]], unsigned int vid [[vertex_id]],
+                                    unsigned int i_id [[instance_id]])
+{
+    const uint instance = instance_culling ? scene.visible_instances[i_id] : i_id;
+    const float4x4 m = instance_matrix(scene.instances[instance], camera->origin.xyz);
+    return {camera->combined * (m * stream_position(scene, vid, m)), instance};
+}
+
+vertex PickOut pick_vertex_skinned(const device Scene &scene [[buffer(0)]],
+                                   const device UniformCamera *camera [[buffer(1)]], unsigned int vid [[vertex_id]],
+                                   unsigned int i_id [[instance_id]])
+{
+    const device auto &v = scene.anim_vertices[vid];
+    const float4x4 m = instance_matrix(scene.instances[i_id], camera->origin.xyz);
+    return {camera->combined * (m * float4(v.v_x, v.v_y, v.v_z, v.v_w)), i_id};
+}
+
+vertex PickOut pick_vertex_packed(const device Scene &scene [[buffer(0)]],
+                                  const device UniformCamera *camera [[buffer(1)]],
+                                  constant PackedVertexBounds &bounds [[buffer(2)]], unsigned int vid [[vertex_id]],
+                                  unsigned int i_id [[instance_id]])
+{
+    const device auto &v = scene.packed_vertices[vid];
+    const uint instance = instance_culling ? scene.visible_instances[i_id] : i_id;
+    const float3 position = bounds.offset.xyz + float3(v.p_x, v.p_y, v.p_z) / 65535.0 * bounds.scale.xyz;
+    const float4x4 m = instance_matrix(scene.instances[instance], camera->origin.xyz);
+    return {camera->combined * (m * float4(position, 1.0)), instance};
+}
+
+fragment uint pick_fragment(PickOut in [[stage_in]])
+{
+    return in.instance;
+}
+
+fragment uint2 vbuffer_fragment(PickOut in [[stage_in]], uint primitive [[primitive_id]],
+                                constant uint &first_triangle [[buffer(2)]])
+{
+    return uint2(in.instance, first_triangle == NO_VBUFFER_TRIANGLE ? NO_VBUFFER_TRIANGLE : first_triangle + primitive);
+}
+
+// Every fragment of the overdraw view adds one to its pixel with additive blending.
+fragment half overdraw_fragment()
+{
+    return 1.0h;
+}
+
+struct MotionInOut
+{
+    float4 position [[position, invariant]];
+    float4 current;
+    float4 previous;
+};
+
+// Pre-pass vertex functions of frames with motion vectors, which also project the vertex with the instance transform
+// and combined matrix of the previous frame. Skinned vertices only move with their instance.
+MotionInOut motion_out(float4 position, const device InstanceTransform &t, const device InstanceTransform &previous,
+                       const device UniformCamera *camera)
+{
+    MotionInOut out;
+    out.position = camera->combined * (instance_matrix(t, camera->origin.xyz) * position);
+    out.current = out.position;
+    out.previous = camera->previous_combined * (instance_matrix(previous, camera->origin.xyz) * position);
+    return out;
+}
+
+vertex MotionInOut motion_vertex(const device Scene &scene [[buffer(0)]],
+                                 const device UniformCamera *camera [[buffer(1)]],
+                                 const device InstanceTransform *previous_instances [[buffer(3)]],
+                                 unsigned int vid [[vertex_id]], unsigned int i_id [[instance_id]])
+{
+    const uint instance = instance_culling ? scene.visible_instances[i_id] : i_id;
+    const device auto &t = scene.instances[instance];
+    return motion_out(mesh_position(scene, vid, instance_matrix(t, camera->origin.xyz)), t,
+                      previous_instances[instance], camera);
+}
+
+vertex MotionInOut motion_vertex_skinned(const device Scene &scene [[buffer(0)]],
+                                         const device UniformCamera *camera [[buffer(1)]],
+                                         const device InstanceTransform *previous_instances [[buffer(3)]],
+                                         unsigned int vid [[vertex_id]], unsigned int i_id [[instance_id]])
+{
+    const device auto &v = scene.anim_vertices[vid];
+    return motion_out(float4(v.v_x, v.v_y, v.v_z, v.v_w), scene.instances[i_id], previous_instances[i_id], camera);
+}
+
+vertex MotionInOut motion_vertex_packed(const device Scene &scene [[buffer(0)]],
+                                        const device UniformCamera *camera [[buffer(1)]],
+                                        constant PackedVertexBounds &bounds [[buffer(2)]],
+                                        const device InstanceTransform *previous_instances [[buffer(3)]],
+                                        unsigned int vid [[vertex_id]], unsigned int i_id [[instance_id]])
+{
+    const device auto &v = scene.packed_vertices[vid];
+    const uint instance = instance_culling ? scene.visible_instances[i_id] : i_id;
+    const float3 position = bounds.offset.xyz + float3(v.p_x, v.p_y, v.p_z) / 65535.0 * bounds.scale.xyz;
+    return motion_out(float4(position, 1.0), scene.instances[instance], previous_instances[instance], camera);
+}
+
+// Motion in texture coordinates from the pixel to where its surface was in the previous frame, without the jitter of
+// either frame.
+fragment half2 motion_fragment(MotionInOut in [[stage_in]], const device UniformCamera *camera [[buffer(1)]])
+{
+    if (in.previous.w <= 0.0)
+        return half2(0.0);
+
+    // The offset between texture coordinates cancels out, only the flipped y remains.
+    const float2 current = in.current.xy / in.current.w * float2(0.5, -0.5) - camera->jitter.xy;
+    const float2 previous = in.previous.xy / in.previous.w * float2(0.5, -0.5);
+    return half2(previous - current);
+}
+
+// Radiance below which a light is considered out of range.
+constant float LIGHT_CUTOFF = 1.0 / 256.0;
+constant float AMBIENT = 0.03;
+
+float light_range(float3 radiance)
+{
+    return sqrt(max(radiance.x, max(radiance.y, radiance.z)) / LIGHT_CUTOFF);
+}
+
+// Inverse square falloff windowed to reach 0 at the light's range.
+float distance_attenuation(float distance_squared, float range)
 {
-    const float4 color = float4(scene.materials[in.mat_id].c_r, scene.materials[in.mat_id].c_g,
-                                scene.materials[in.mat_id].c_b, scene.materials[in.mat_id].c_a);
-    return (half4)color * half4(in.normal, 1.0);
-}
\ No newline at end of file
+    const float ratio = distance_squared / (range * range);
+    const float window = saturate(1.0 - ratio * ratio);
+    return window * window / max(distance_squared, 1e-4);
+}
+
+struct Surface
+{
+    float4 color;
+    float3 normal;
+    float metallic;
+    float roughness;
+    float3 emissive;
+    // Ambient light of the lightmap of the material in rgb, with an alpha of 0 without one.
+    float4 lightmap;
+};
+
+float unpack_unorm8(uint value, uint shift)
+{
+    return float((value >> shift) & 255) / 255.0;
+}
+
+// Texture feedback measures levels with the trilinear filter, whichever one the material samples with.
+constexpr sampler material_sampler(filter::linear, mip_filter::linear, address::repeat);
+
+// Fragment functions sample texture maps with the derivatives of the fragment, kernels at an explicit level.
+struct ImplicitLod
+{
+};
+
+float4 sample_map(texture2d<float> map, sampler filter, float2 uv, ImplicitLod)
+{
+    return map.sample(filter, uv);
+}
+
+float4 sample_map(texture2d<float> map, sampler filter, float2 uv, float lod)
+{
+    return map.sample(filter, uv, level(lod));
+}
+
+float4 sample_map(texture2d_array<float> map, uint layer, sampler filter, float2 uv, ImplicitLod)
+{
+    return map.sample(filter, uv, layer);
+}
+
+float4 sample_map(texture2d_array<float> map, uint layer, sampler filter, float2 uv, float lod)
+{
+    return map.sample(filter, uv, layer, level(lod));
+}
+
+// The visibility buffer resolve shades pixels of many triangles at once, it samples with the derivatives of the uv of
+// the triangle of each pixel.
+struct GradientLod
+{
+    float2 dx;
+    float2 dy;
+};
+
+float4 sample_map(texture2d<float> map, sampler filter, float2 uv, GradientLod lod)
+{
+    return map.sample(filter, uv, gradient2d(lod.dx, lod.dy));
+}
+
+float4 sample_map(texture2d_array<float> map, uint layer, sampler filter, float2 uv, GradientLod lod)
+{
+    return map.sample(filter, uv, layer, gradient2d(lod.dx, lod.dy));
+}
+
+// Virtual textures bind the tile cache in the texture table, their pages pick the tile of each texel within it.
+constexpr sampler virtual_sampler(filter::linear, address::clamp_to_edge);
+
+uint virtual_texture(const device Scene &scene, uint texture)
+{
+    return texture < scene.virtual_pages[0] ? scene.virtual_pages[1 + texture] : NO_VIRTUAL_TEXTURE;
+}
+
+uint2 virtual_level_size(const device VirtualTexture &vt, uint mip)
+{
+    return max(uint2(vt.width, vt.height) >> mip, 1u);
+}
+
+float virtual_lod(const device VirtualTexture &vt, float2 uv, ImplicitLod)
+{
+    const float2 dx = dfdx(uv) * float2(vt.width, vt.height);
+    const float2 dy = dfdy(uv) * float2(vt.width, vt.height);
+    return 0.5 * log2(max(max(dot(dx, dx), dot(dy, dy)), 1e-8));
+}
+
+float virtual_lod(const device VirtualTexture &, float2, float lod)
+{
+    return lod;
+}
+
+float virtual_lod(const device VirtualTexture &vt, float2, GradientLod lod)
+{
+    const float2 dx = lod.dx * float2(vt.width, vt.height);
+    const float2 dy = lod.dy * float2(vt.width, vt.height);
+    return 0.5 * log2(max(max(dot(dx, dx), dot(dy, dy)), 1e-8));
+}
+
+// Page of the tile covering uv on the level lod selects.
+uint virtual_page(const device VirtualTexture &vt, float2 uv, float lod)
+{
+    const uint mip = uint(clamp(lod, 0.0, float(vt.levels - 1)));
+    const uint2 size = virtual_level_size(vt, mip);
+    const uint2 tiles = (size + VIRTUAL_TILE_SIZE - 1) / VIRTUAL_TILE_SIZE;
+    const uint2 tile = min(uint2(fract(uv) * float2(size)) / VIRTUAL_TILE_SIZE, tiles - 1);
+    return vt.pages[mip] + tile.y * tiles.x + tile.x;
+}
+
+// Samples the finest resident tile covering uv bilinearly, white until the texture has a tile resident.
+float4 sample_virtual(texture2d<float> cache, const device uint *pages, const device VirtualTexture &vt, float2 uv,
+                      float lod)
+{
+    const uint entry = pages[virtual_page(vt, uv, lod)];
+    if (entry == NO_VIRTUAL_TILE)
+        return float4(1.0);
+
+    const float2 texel = fract(uv) * float2(virtual_level_size(vt, entry >> 24));
+    const float2 local = texel - floor(texel / VIRTUAL_TILE_SIZE) * VIRTUAL_TILE_SIZE;
+    const float2 slot = float2(entry & 0xFFF, (entry >> 12) & 0xFFF);
+    const float2 position = slot * VIRTUAL_TILE_STRIDE + VIRTUAL_TILE_BORDER + local;
+    return cache.sample(virtual_sampler, position / float2(cache.get_width(), cache.get_height()), level(0.0));
+}
+
+template <typename Lod>
+float4 sample_material_map(const device Scene &scene, sampler filter, uint texture, float2 uv, Lod lod)
+{
+    const uint layer = scene.texture_layers[texture];
+    if (layer != NO_TEXTURE_LAYER)
+        return sample_map(scene.texture_arrays[layer >> 16].tex, layer & 0xFFFF, filter, uv, lod);
+
+    const uint header = virtual_texture(scene, texture);
+    if (header == NO_VIRTUAL_TEXTURE)
+        return sample_map(scene.textures[texture].tex, filter, uv, lod);
+
+    const device VirtualTexture &vt = *(const device VirtualTexture *)(scene.virtual_pages + header);
+    return sample_virtual(scene.textures[texture].tex, scene.virtual_pages, vt, uv, virtual_lod(vt, uv, lod));
+}
+
+constexpr sampler lightmap_sampler(filter::linear, address::clamp_to_edge);
+
+// Surface of a fragment from its material, texture maps are fetched from the texture table of the scene. Lightmaps
+// have a single level.
+template <typename Lod> Surface material_surface(const device Scene &scene, VertexInOut in, Lod lod)
+{
+    const device PackedMaterial &material = scene.materials[in.mat_id];
+    const sampler filter = scene.samplers[material.sampler].s;
+
+    Surface s;
+    s.color = float4(as_type<half>(material.c_r), as_type<half>(material.c_g), as_type<half>(material.c_b),
+                     as_type<half>(material.c_a));
+    s.normal = normalize(float3(in.normal));
+    s.metallic = unpack_unorm8(material.params, 0);
+    s.roughness = unpack_unorm8(material.params, 24);
+    // Colors brighter than 1 are emitted.
+    s.emissive = any(s.color.rgb > 1.0) ? s.color.rgb : float3(0.0);
+
+    const uint flags = material.flags;
+    if ((flags & HAS_DIFFUSE_MAP) != 0)
+    {
+        const float4 texel = sample_material_map(scene, filter, material.diffuse_map, in.uv, lod);
+        s.color = float4(texel.rgb, s.color.a * texel.a);
+    }
+    s.color *= float4(in.color);
+    s.emissive *= float3(in.color.rgb);
+
+    if ((flags & HAS_NORMAL_MAP) != 0)
+    {
+        const float3 t = normalize(float3(in.tangent.xyz));
+        const float3 b = cross(s.normal, t) * float(in.tangent.w);
+        const float3 n = sample_material_map(scene, filter, material.normal_map, in.uv, lod).rgb * 2.0 - 1.0;
+        s.normal = normalize(float3x3(t, b, s.normal) * n);
+    }
+
+    // glTF layout, roughness in green and metalness in blue.
+    if ((flags & HAS_METAL_ROUGH_MAP) != 0)
+    {
+        const float4 texel = sample_material_map(scene, filter, material.metallic_roughness_map, in.uv, lod);
+        s.roughness = max(s.roughness, texel.g);
+        s.metallic = max(s.metallic, texel.b);
+    }
+
+    if ((flags & HAS_EMISSIVE_MAP) != 0)
+        s.emissive = sample_material_map(scene, filter, material.emissive_map, in.uv, lod).rgb;
+
+    s.lightmap = float4(0.0);
+    if (material.lightmap_map != NO_MATERIAL_MAP)
+        s.lightmap = float4(scene.textures[material.lightmap_map].tex.sample(lightmap_sampler, in.lightmap_uv,
+                                                                              level(0.0)).rgb, 1.0);
+
+    s.roughness = max(s.roughness, 0.01);
+    return s;
+}
+
+// Finest level of a texture map sampled by the fragment, relative to the levels the texture has resident. Virtual
+// textures request the page of the tile the fragment samples instead.
+void write_lod_feedback(const device Scene &scene, device atomic_int *feedback,
+                        constant TextureFeedbackUniforms &uniforms, uint texture, float2 uv)
+{
+    if (texture >= uniforms.num_textures)
+        return;
+
+    const uint header = virtual_texture(scene, texture);
+    if (header != NO_VIRTUAL_TEXTURE)
+    {
+        const device VirtualTexture &vt = *(const device VirtualTexture *)(scene.virtual_pages + header);
+        const uint page = virtual_page(vt, uv, virtual_lod(vt, uv, ImplicitLod())) - vt.pages[0];
+        const uint word = vt.feedback + page / 32;
+        if (word < uniforms.virtual_words)
+            atomic_fetch_or_explicit(&feedback[uniforms.num_textures + word], int(1u << (page % 32)),
+                                     memory_order_relaxed);
+        return;
+    }
+    const float lod = scene.textures[texture].tex.calculate_unclamped_lod(material_sampler, uv);
+    atomic_fetch_min_explicit(&feedback[texture], int(floor(clamp(lod, -16.0, 16.0))), memory_order_relaxed);
+}
+
+void write_texture_feedback(const device Scene &scene, VertexInOut in, device atomic_int *feedback,
+                            constant TextureFeedbackUniforms &uniforms)
+{
+    const uint2 pixel = uint2(in.position.xy) % TEXTURE_FEEDBACK_BLOCK;
+    if (uniforms.num_textures == 0 || pixel.y * TEXTURE_FEEDBACK_BLOCK + pixel.x != uniforms.phase)
+        return;
+
+    const device PackedMaterial &material = scene.materials[in.mat_id];
+    const uint flags = material.flags;
+    if ((flags & HAS_DIFFUSE_MAP) != 0)
+        write_lod_feedback(scene, feedback, uniforms, material.diffuse_map, in.uv);
+    if ((flags & HAS_NORMAL_MAP) != 0)
+        write_lod_feedback(scene, feedback, uniforms, material.normal_map, in.uv);
+    if ((flags & HAS_METAL_ROUGH_MAP) != 0)
+        write_lod_feedback(scene, feedback, uniforms, material.metallic_roughness_map, in.uv);
+    if ((flags & HAS_EMISSIVE_MAP) != 0)
+        write_lod_feedback(scene, feedback, uniforms, material.emissive_map, in.uv);
+}
+
+// Metallic-roughness BRDF: GGX distribution, height-correlated Smith visibility and Schlick's Fresnel, with a
+// Lambertian lobe for the dielectric part.
+float3 brdf(Surface s, float3 v, float3 l)
+{
+    const float3 n = s.normal;
+    const float3 h = normalize(v + l);
+    const float n_dot_v = max(dot(n, v), 1e-4);
+    const float n_dot_l = saturate(dot(n, l));
+    const float n_dot_h = saturate(dot(n, h));
+
+    const float a2 = s.roughness * s.roughness * s.roughness * s.roughness;
+    const float d = n_dot_h * n_dot_h * (a2 - 1.0) + 1.0;
+    const float distribution = a2 / (M_PI_F * d * d);
+    const float visibility = 0.5 / (n_dot_l * sqrt(n_dot_v * n_dot_v * (1.0 - a2) + a2) +
+                                    n_dot_v * sqrt(n_dot_l * n_dot_l * (1.0 - a2) + a2) + 1e-5);
+
+    const float3 f0 = mix(float3(0.04), s.color.rgb, s.metallic);
+    const float3 fresnel = f0 + (1.0 - f0) * pow(1.0 - saturate(dot(v, h)), 5.0);
+    const float3 diffuse = (1.0 - fresnel) * (1.0 - s.metallic) * s.color.rgb / M_PI_F;
+    return diffuse + fresnel * distribution * visibility;
+}
+
+float3 shade_point_light(Surface s, float3 p, float3 v, float3 position, float3 radiance)
+{
+    const float3 l = position - p;
+    const float distance_squared = dot(l, l);
+    const float3 l_n = l * rsqrt(max(distance_squared, 1e-8));
+    const float n_dot_l = saturate(dot(s.normal, l_n));
+    return brdf(s, v, l_n) * radiance * n_dot_l * distance_attenuation(distance_squared, light_range(radiance));
+}
+
+// Area lights are shaded as a point at their centroid that emits their radiance from both sides of their triangle,
+// which falls off with the cosine to their normal.
+float3 shade_area_light(Surface s, float3 p, float3 v, const device AreaLight &light)
+{
+    const float3 l = float3(light.pos_x, light.pos_y, light.pos_z) - p;
+    const float distance_squared = dot(l, l);
+    const float3 l_n = l * rsqrt(max(distance_squared, 1e-8));
+    const float3 radiance = float3(light.radiance_r, light.radiance_g, light.radiance_b) * light.area;
+    const float facing = abs(dot(float3(light.normal_x, light.normal_y, light.normal_z), l_n));
+    return brdf(s, v, l_n) * radiance * facing * saturate(dot(s.normal, l_n)) *
+           distance_attenuation(distance_squared, light_range(radiance));
+}
+
+constexpr sampler shadow_sampler(coord::normalized, filter::linear, address::clamp_to_edge, compare_func::less_equal);
+
+// Fraction of the first directional light that reaches p, the comparison sampler filters 2x2 shadow map texels.
+float cascade_shadow(float3 p, constant LightUniforms &lights, constant ShadowUniforms &shadows,
+                     depth2d_array<float> cascade_shadows)
+{
+    const float depth = -(lights.view * float4(p, 1.0)).z;
+    for (uint c = 0; c < shadows.num_cascades; c++)
+    {
+        if (depth > shadows.cascade_ends[c])
+            continue;
+
+        const float4 clip = shadows.cascades[c] * float4(p, 1.0);
+        const float2 uv = clip.xy * float2(0.5, -0.5) + 0.5;
+        return cascade_shadows.sample_compare(shadow_sampler, uv, c, clip.z - shadows.cascade_bias);
+    }
+    return 1.0;
+}
+
+// Fraction of spot light index that reaches p, read from the light's tile of the spot shadow atlas.
+float spot_shadow(float3 p, uint index, constant ShadowUniforms &shadows, depth2d<float> spot_shadows)
+{
+    if (index >= shadows.num_spot_shadows)
+        return 1.0;
+
+    const float4 clip = shadows.spot_lights[index] * float4(p, 1.0);
+    if (clip.w <= 0.0)
+        return 1.0;
+
+    // Samples stay half a texel inside the tile, so filtering never reads the neighbouring tiles.
+    const float3 ndc = clip.xyz / clip.w;
+    const float border = 0.5 * SPOT_SHADOW_TILES_PER_ROW / float(spot_shadows.get_width());
+    const float2 uv = clamp(ndc.xy * float2(0.5, -0.5) + 0.5, border, 1.0 - border);
+    const float2 tile = float2(index % SPOT_SHADOW_TILES_PER_ROW, index / SPOT_SHADOW_TILES_PER_ROW);
+    return spot_shadows.sample_compare(shadow_sampler, (tile + uv) / SPOT_SHADOW_TILES_PER_ROW,
+                                       ndc.z - shadows.spot_bias);
+}
+
+constexpr sampler skybox_sampler(filter::linear, mip_filter::linear, s_address::repeat, t_address::clamp_to_edge);
+constexpr sampler environment_sampler(filter::linear, mip_filter::linear);
+
+// Texture coordinates of direction d in the equirectangular skybox, with the mapping of the other backends.
+float2 skybox_uv(float3 d)
+{
+    return float2(0.5 * (1.0 + atan2(d.x, -d.z) / M_PI_F), acos(clamp(d.y, -1.0, 1.0)) / M_PI_F);
+}
+
+// Radiance of the skybox behind the pixel at position.
+float3 skybox_radiance(float2 position, constant LightUniforms &lights, texture2d<half> skybox)
+{
+    const float2 ndc = float2(position.x / lights.width * 2.0 - 1.0, 1.0 - position.y / lights.height * 2.0);
+    const float4 p = lights.inv_combined * float4(ndc, 1.0, 1.0);
+    const float3 d = normalize(p.xyz / p.w - lights.camera_position.xyz);
+    return float3(skybox.sample(skybox_sampler, skybox_uv(d), level(0.0)).rgb);
+}
+
+// Spherical harmonics basis of the first 3 bands in direction n.
+void sh_basis(float3 n, thread float *y)
+{
+    y[0] = 0.282095;
+    y[1] = 0.488603 * n.y;
+    y[2] = 0.488603 * n.z;
+    y[3] = 0.488603 * n.x;
+    y[4] = 1.092548 * n.x * n.y;
+    y[5] = 1.092548 * n.y * n.z;
+    y[6] = 0.315392 * (3.0 * n.z * n.z - 1.0);
+    y[7] = 1.092548 * n.x * n.z;
+    y[8] = 0.546274 * (n.x * n.x - n.y * n.y);
+}
+
+// Analytic fit of the split sum BRDF integral, scales f0 of the prefiltered reflections.
+float3 environment_brdf(float3 f0, float roughness, float n_dot_v)
+{
+    const float4 r = roughness * float4(-1.0, -0.0275, -0.572, 0.022) + float4(1.0, 0.0425, 1.04, -0.04);
+    const float a = min(r.x * r.x, exp2(-9.28 * n_dot_v)) * r.x + r.y;
+    const float2 scale_bias = float2(-1.04, 1.04) * a + r.zw;
+    return f0 * scale_bias.x + scale_bias.y;
+}
+
+// Index of the closest baked reflection probe whose radius contains p, -1 outside of all of them.
+int closest_probe(float3 p, uint num_probes, const device ReflectionProbe *probes)
+{
+    int closest = -1;
+    float closest_distance = INFINITY;
+    for (uint i = 0; i < num_probes; i++)
+    {
+        const float d = distance(p, float3(probes[i].pos_x, probes[i].pos_y, probes[i].pos_z));
+        if (d < probes[i].radius && d < closest_distance)
+        {
+            closest = int(i);
+            closest_distance = d;
+        }
+    }
+    return closest;
+}
+
+constexpr sampler gi_sampler(filter::linear, address::clamp_to_edge);
+
+// Texture coordinates of direction d in the tile of probe of an irradiance volume texture with tiles of texels.
+float2 gi_uv(uint3 probe, uint count_x, float3 d, uint texels, float2 size)
+{
+    const float2 tile = float2(probe.x + probe.y * count_x, probe.z) * float(texels + 2);
+    return (tile + 1.0 + octahedral_uv(d) * float(texels)) / size;
+}
+
+// Irradiance over pi of the volume at p with normal n, interpolated between the 8 probes around p. Probes behind the
+// surface weigh less, as do the probes that see geometry in front of p by the Chebyshev bound of their distances.
+float3 volume_irradiance(float3 p, float3 n, float3 v, constant GiVolume &volume, texture2d<half> gi_irradiance,
+                         texture2d<half> gi_distances)
+{
+    const uint3 counts = uint3(volume.count_x, volume.count_y, volume.count_z);
+    const float3 biased = p + (n * 0.2 + v * 0.8) * volume.bias;
+    const float3 grid = clamp((biased - volume.origin.xyz) / volume.spacing.xyz, 0.0, float3(counts - 1));
+    const uint3 base = uint3(grid);
+    const float3 alpha = grid - float3(base);
+    const float2 irradiance_size = float2(gi_irradiance.get_width(), gi_irradiance.get_height());
+    const float2 distance_size = float2(gi_distances.get_width(), gi_distances.get_height());
+
+    float3 sum = 0.0;
+    float total = 0.0;
+    for (uint i = 0; i < 8; i++)
+    {
+        const uint3 offset = uint3(i, i >> 1, i >> 2) & 1u;
+        const uint3 probe = min(base + offset, counts - 1);
+        const float3 position = volume.origin.xyz + volume.spacing.xyz * float3(probe);
+        const float3 trilinear = select(1.0 - alpha, alpha, offset != 0u);
+
+        // Probes fade out smoothly as they move behind the surface, so its lighting doesn't jump.
+        const float facing = (dot(normalize(position - p), n) + 1.0) * 0.5;
+        float weight = facing * facing + 0.2;
+
+        const float3 from_probe = biased - position;
+        const float r = max(length(from_probe), 1e-4);
+        const float2 moments = float2(
+            gi_distances.sample(gi_sampler, gi_uv(probe, volume.count_x, from_probe / r, GI_DISTANCE_TEXELS,
+                                                  distance_size)).xy);
+        if (r > moments.x)
+        {
+            const float variance = abs(moments.x * moments.x - moments.y);
+            const float d = r - moments.x;
+            const float chebyshev = variance / (variance + d * d);
+            weight *= chebyshev * chebyshev * chebyshev;
+        }
+
+        // Small weights are crushed further, which keeps light from leaking through walls every probe is behind.
+        weight = max(weight, 1e-6);
+        if (weight < 0.2)
+            weight *= weight * weight * 25.0;
+        weight *= trilinear.x * trilinear.y * trilinear.z;
+        sum += weight * float3(gi_irradiance.sample(gi_sampler, gi_uv(probe, volume.count_x, n, GI_IRRADIANCE_TEXELS,
+                                                                      irradiance_size)).rgb);
+        total += weight;
+    }
+    return sum / max(total, 1e-6);
+}
+
+// Ambient light reflected by s at p, the irradiance of its lightmap, of the irradiance volume, of the harmonics of the
+// skybox or the constant ambient light without any of them. Reflections are one fetch of the closest reflection probe
+// around p, corrected for the parallax of a sphere of its radius, or of the prefiltered skybox outside of the probes.
+// The traced reflection replaces them by its alpha on surfaces up to the roughness it was traced for.
+float3 environment_light(Surface s, float3 p, float3 v, constant LightUniforms &lights,
+                         constant IrradianceSH &irradiance, texturecube<half> environment,
+                         const device ReflectionProbe *probes, texturecube_array<half> probe_maps,
+                         texture2d<half> gi_irradiance, texture2d<half> gi_distances, half4 traced)
+{
+    // Traced reflections fade out from half the roughness they are traced up to.
+    float traced_weight = 0.0;
+    if (lights.reflections != 0 && s.roughness < lights.reflection_roughness)
+        traced_weight = float(traced.a) *
+                        (1.0 - smoothstep(0.5 * lights.reflection_roughness, lights.reflection_roughness, s.roughness));
+
+    const int probe = closest_probe(p, lights.num_probes, probes);
+    const bool lightmapped = s.lightmap.a > 0.0;
+    float3 diffuse = lightmapped ? s.lightmap.rgb : float3(AMBIENT);
+    if (lights.environment == 0 && probe < 0 && lights.gi.count_x == 0 && traced_weight <= 0.0)
+        return diffuse * s.color.rgb;
+
+    if (!lightmapped && lights.gi.count_x != 0)
+    {
+        diffuse = volume_irradiance(p, s.normal, v, lights.gi, gi_irradiance, gi_distances);
+    }
+    else if (!lightmapped && lights.environment != 0)
+    {
+        float y[9];
+        sh_basis(s.normal, y);
+        diffuse = 0.0;
+        for (uint i = 0; i < 9; i++)
+            diffuse += irradiance.coefficients[i].rgb * y[i];
+    }
+
+    const float n_dot_v = max(dot(s.normal, v), 1e-4);
+    const float3 f0 = mix(float3(0.04), s.color.rgb, s.metallic);
+    const float lod = s.roughness * (ENVIRONMENT_MIP_LEVELS - 1);
+    const float3 r = reflect(-v, s.normal);
+    float3 reflected;
+    if (probe >= 0)
+    {
+        // p is inside the sphere, so the reflected ray leaves it at its far intersection.
+        const device ReflectionProbe &rp = probes[probe];
+        const float3 o = p - float3(rp.pos_x, rp.pos_y, rp.pos_z);
+        const float b = dot(o, r);
+        const float t = -b + sqrt(max(b * b - dot(o, o) + rp.radius * rp.radius, 0.0));
+        reflected = float3(probe_maps.sample(environment_sampler, o + t * r, uint(probe), level(lod)).rgb);
+    }
+    else if (lights.environment == 0 && lights.gi.count_x == 0)
+    {
+        reflected = float3(AMBIENT);
+    }
+    else
+    {
+        reflected = float3(environment.sample(environment_sampler, r, level(lod)).rgb);
+    }
+    reflected = mix(reflected, float3(traced.rgb), traced_weight);
+    return max(diffuse, 0.0) * (1.0 - s.metallic) * s.color.rgb +
+           reflected * environment_brdf(f0, s.roughness, n_dot_v);
+}
+
+constexpr sampler ssao_sampler(filter::linear, address::clamp_to_edge);
+
+// Half resolution occlusion at a pixel position of the full resolution view.
+half screen_space_occlusion(texture2d<half> ssao, constant LightUniforms &lights, float2 position)
+{
+    return ssao.sample(ssao_sampler, position / float2(lights.width, lights.height)).x;
+}
+
+// Half resolution reflection at a pixel of the full resolution view, none while no reflections were traced.
+half4 traced_reflection(texture2d<half> reflections, constant LightUniforms &lights, uint2 pixel)
+{
+    if (lights.reflections == 0)
+        return half4(0.0);
+    return reflections.sample(ssao_sampler, (float2(pixel) + 0.5) / float2(lights.width, lights.height));
+}
+
+// Shades a surface at world position p, pixel picks the light list of its screen tile. reflection replaces the
+// reflections of the probes and the skybox by its alpha.
+half4 shade(Surface s, float3 p, uint2 pixel, constant LightUniforms &lights, const device PointLight *point_lights,
+            const device SpotLight *spot_lights, const device AreaLight *area_lights,
+            const device DirectionalLight *directional_lights, const device uint *tile_lights,
+            constant ShadowUniforms &shadows, depth2d_array<float> cascade_shadows, depth2d<float> spot_shadows,
+            texture2d<half, access::read> ray_traced, constant IrradianceSH &irradiance, texturecube<half> environment,
+            texture2d<half> ssao, const device ReflectionProbe *probes, texturecube_array<half> probe_maps,
+            texture2d<half> gi_irradiance, texture2d<half> gi_distances, half4 reflection)
+{
+    const uint num_tiled = lights.num_point_lights + lights.num_spot_lights + lights.num_area_lights;
+    if (num_tiled + lights.num_directional_lights == 0 && lights.environment == 0 && lights.gi.count_x == 0)
+        return (half4)s.color * half4(half3(s.normal), 1.0);
+
+    // Traced shadows replace the cascades, the traced or screen space occlusion darkens the ambient light.
+    half2 traced = lights.ray_traced != 0 ? ray_traced.read(pixel).xy : half2(1.0);
+    if (lights.ssao != 0)
+        traced.y = screen_space_occlusion(ssao, lights, float2(pixel) + 0.5);
+    const float3 v = normalize(lights.camera_position.xyz - p);
+    const float3 ambient = environment_light(s, p, v, lights, irradiance, environment, probes, probe_maps,
+                                             gi_irradiance, gi_distances, reflection);
+    float3 radiance = ambient * float(traced.y) + s.emissive;
+
+    for (uint i = 0; i < lights.num_directional_lights; i++)
+    {
+        const device DirectionalLight &light = directional_lights[i];
+        const float3 l = -normalize(float3(light.direction_x, light.direction_y, light.direction_z));
+        float shadow = 1.0;
+        if (i == 0)
+            shadow = lights.ray_traced != 0 ? float(traced.x) : cascade_shadow(p, lights, shadows, cascade_shadows);
+        radiance += brdf(s, v, l) * float3(light.radiance_r, light.radiance_g, light.radiance_b) *
+                    saturate(dot(s.normal, l)) * shadow;
+    }
+
+    // Only the lights that touch this fragment's tile are evaluated, there are no tile lists without them.
+    const uint2 tile = pixel / LIGHT_TILE_SIZE;
+    const device uint *list = tile_lights + (tile.y * lights.tiles_x + tile.x) * LIGHT_TILE_STRIDE;
+    const uint count = num_tiled > 0 ? min(list[0], uint(MAX_LIGHTS_PER_TILE)) : 0;
+    for (uint i = 0; i < count; i++)
+    {
+        const uint index = list[1 + i];
+        if (index >= lights.num_point_lights + lights.num_spot_lights)
+        {
+            const uint area = index - lights.num_point_lights - lights.num_spot_lights;
+            radiance += shade_area_light(s, p, v, area_lights[area]);
+        }
+        else if (index < lights.num_point_lights)
+        {
+            const device PointLight &light = point_lights[index];
+            radiance += shade_point_light(s, p, v, float3(light.pos_x, light.pos_y, light.pos_z),
+                                          float3(light.radiance_r, light.radiance_g, light.radiance_b));
+        }
+        else
+        {
+            const uint spot = index - lights.num_point_lights;
+            const device SpotLight &light = spot_lights[spot];
+            const float3 position = float3(light.pos_x, light.pos_y, light.pos_z);
+            const float3 direction = normalize(float3(light.direction_x, light.direction_y, light.direction_z));
+            const float cone = smoothstep(light.cos_outer, light.cos_inner, dot(normalize(p - position), direction));
+            radiance += cone * spot_shadow(p, spot, shadows, spot_shadows) *
+                        shade_point_light(s, p, v, position,
+                                          float3(light.radiance_r, light.radiance_g, light.radiance_b));
+        }
+    }
+
+    return half4(half3(radiance), half(s.color.a));
+}
+
+// fragment shader function, only visible fragments write texture feedback.
+[[early_fragment_tests]]
+fragment half4 triangle_fragment(VertexInOut in [[stage_in]], const device Scene &scene [[buffer(0)]],
+                                 constant LightUniforms &lights [[buffer(1)]],
+                                 const device PointLight *point_lights [[buffer(2)]],
+                                 const device SpotLight *spot_lights [[buffer(3)]],
+                                 const device DirectionalLight *directional_lights [[buffer(4)]],
+                                 const device uint *tile_lights [[buffer(5)]],
+                                 constant ShadowUniforms &shadows [[buffer(6)]],
+                                 device atomic_int *texture_feedback [[buffer(7)]],
+                                 constant TextureFeedbackUniforms &feedback [[buffer(8)]],
+                                 constant IrradianceSH &irradiance [[buffer(9)]],
+                                 depth2d_array<float> cascade_shadows [[texture(0)]],
+                                 depth2d<float> spot_shadows [[texture(1)]],
+                                 texture2d<half, access::read> ray_traced [[texture(2)]],
+                                 texturecube<half> environment [[texture(3)]],
+                                 texture2d<half> ssao [[texture(5)]],
+                                 const device ReflectionProbe *probes [[buffer(11)]],
+                                 const device AreaLight *area_lights [[buffer(12)]],
+                                 texturecube_array<half> probe_maps [[texture(6)]],
+                                 texture2d<half> gi_irradiance [[texture(8)]],
+                                 texture2d<half> gi_distances [[texture(9)]],
+                                 texture2d<half> reflections [[texture(10)]])
+{
+    write_texture_feedback(scene, in, texture_feedback, feedback);
+    const uint2 pixel = uint2(in.position.xy);
+    return shade(material_surface(scene, in, ImplicitLod()), in.world_position, pixel, lights, point_lights,
+                 spot_lights, area_lights, directional_lights, tile_lights, shadows, cascade_shadows, spot_shadows,
+                 ray_traced, irradiance, environment, ssao, probes, probe_maps, gi_irradiance, gi_distances,
+                 traced_reflection(reflections, lights, pixel));
+}
+
+// Shades a surface seen from camera with the directional lights and the ambient light only, without shadows.
+half4 shade_unshadowed(Surface s, float3 p, float3 camera, constant LightUniforms &lights,
+                       const device DirectionalLight *directional_lights, constant IrradianceSH &irradiance,
+                       texturecube<half> environment, const device ReflectionProbe *probes,
+                       texturecube_array<half> probe_maps, texture2d<half> gi_irradiance,
+                       texture2d<half> gi_distances)
+{
+    if (lights.num_point_lights + lights.num_spot_lights + lights.num_directional_lights == 0 &&
+        lights.environment == 0 && lights.gi.count_x == 0)
+        return (half4)s.color * half4(half3(s.normal), 1.0);
+
+    const float3 v = normalize(camera - p);
+    float3 radiance =
+        environment_light(s, p, v, lights, irradiance, environment, probes, probe_maps, gi_irradiance, gi_distances,
+                          half4(0.0)) +
+        s.emissive;
+    for (uint i = 0; i < lights.num_directional_lights; i++)
+    {
+        const device DirectionalLight &light = directional_lights[i];
+        const float3 l = -normalize(float3(light.direction_x, light.direction_y, light.direction_z));
+        radiance += brdf(s, v, l) * float3(light.radiance_r, light.radiance_g, light.radiance_b) *
+                    saturate(dot(s.normal, l));
+    }
+    return half4(half3(radiance), half(s.color.a));
+}
+
+// fragment shader function of the inset views. The light lists, shadows and occlusion of a frame are those of its main
+// view, insets are only lit by the directional lights and the ambient light.
+[[early_fragment_tests]]
+fragment half4 inset_fragment(VertexInOut in [[stage_in]], ushort viewport [[viewport_array_index]],
+                              const device Scene &scene [[buffer(0)]], constant LightUniforms &lights [[buffer(1)]],
+                              const device DirectionalLight *directional_lights [[buffer(4)]],
+                              constant IrradianceSH &irradiance [[buffer(9)]],
+                              const device UniformCamera *cameras [[buffer(10)]],
+                              const device ReflectionProbe *probes [[buffer(11)]],
+                              texturecube<half> environment [[texture(3)]],
+                              texturecube_array<half> probe_maps [[texture(6)]],
+                              texture2d<half> gi_irradiance [[texture(8)]],
+                              texture2d<half> gi_distances [[texture(9)]])
+{
+    return shade_unshadowed(material_surface(scene, in, ImplicitLod()), in.world_position,
+                            cameras[viewport].origin.xyz, lights, directional_lights, irradiance, environment, probes,
+                            probe_maps, gi_irradiance, gi_distances);
+}
+
+// fragment shader function of the reflection probe faces, lit like the inset views. Faces reflect the probes as they
+// were last prefiltered, so reflections between probes build up over bakes.
+[[early_fragment_tests]]
+fragment half4 probe_fragment(VertexInOut in [[stage_in]], uint layer [[render_target_array_index]],
+                              const device Scene &scene [[buffer(0)]], constant LightUniforms &lights [[buffer(1)]],
+                              const device DirectionalLight *directional_lights [[buffer(4)]],
+                              constant IrradianceSH &irradiance [[buffer(9)]],
+                              const device UniformCamera *cameras [[buffer(10)]],
+                              const device ReflectionProbe *probes [[buffer(11)]],
+                              texturecube<half> environment [[texture(3)]],
+                              texturecube_array<half> probe_maps [[texture(6)]],
+                              texture2d<half> gi_irradiance [[texture(8)]],
+                              texture2d<half> gi_distances [[texture(9)]])
+{
+    const half4 shaded = shade_unshadowed(material_surface(scene, in, ImplicitLod()), in.world_position,
+                                          cameras[layer].origin.xyz, lights, directional_lights, irradiance,
+                                          environment, probes, probe_maps, gi_irradiance, gi_distances);
+    return half4(shaded.rgb, 1.0);
+}
+
+// Weighted blended order-independent transparency of McGuire and Bavoil: layers add their premultiplied radiance
+// weighted by coverage and depth, and multiply the revealed opaque color by 1 - alpha.
+struct TransparentLayers
+{
+    half4 accum [[color(TRANSPARENT_ACCUM_INDEX)]];
+    half reveal [[color(TRANSPARENT_REVEAL_INDEX)]];
+};
+
+// fragment shader function of transparent meshes, closer and more opaque layers weigh more.
+[[early_fragment_tests]]
+fragment TransparentLayers transparent_fragment(VertexInOut in [[stage_in]], const device Scene &scene [[buffer(0)]],
+                                                constant LightUniforms &lights [[buffer(1)]],
+                                                const device PointLight *point_lights [[buffer(2)]],
+                                                const device SpotLight *spot_lights [[buffer(3)]],
+                                                const device DirectionalLight *directional_lights [[buffer(4)]],
+                                                const device uint *tile_lights [[buffer(5)]],
+                                                constant ShadowUniforms &shadows [[buffer(6)]],
+                                                device atomic_int *texture_feedback [[buffer(7)]],
+                                                constant TextureFeedbackUniforms &feedback [[buffer(8)]],
+                                                constant IrradianceSH &irradiance [[buffer(9)]],
+                                                depth2d_array<float> cascade_shadows [[texture(0)]],
+                                                depth2d<float> spot_shadows [[texture(1)]],
+                                                texture2d<half, access::read> ray_traced [[texture(2)]],
+                                                texturecube<half> environment [[texture(3)]],
+                                                texture2d<half> ssao [[texture(5)]],
+                                                const device ReflectionProbe *probes [[buffer(11)]],
+                                                const device AreaLight *area_lights [[buffer(12)]],
+                                                texturecube_array<half> probe_maps [[texture(6)]],
+                                                texture2d<half> gi_irradiance [[texture(8)]],
+                                                texture2d<half> gi_distances [[texture(9)]])
+{
+    write_texture_feedback(scene, in, texture_feedback, feedback);
+    const half4 shaded = shade(material_surface(scene, in, ImplicitLod()), in.world_position, uint2(in.position.xy),
+                               lights, point_lights, spot_lights, area_lights, directional_lights, tile_lights,
+                               shadows, cascade_shadows, spot_shadows, ray_traced, irradiance, environment, ssao,
+                               probes, probe_maps, gi_irradiance, gi_distances, half4(0.0));
+
+    const float alpha = saturate(float(shaded.a));
+    const float depth = 0.1 + in.position.z * 0.9;
+    const float weight = clamp(pow(min(1.0, alpha * 10.0) + 0.01, 3.0) * 1e3 * depth * depth * depth, 1e-2, 3e2);
+
+    TransparentLayers out;
+    out.accum = half4(half3(min(float3(shaded.rgb) * alpha * weight, float3(6e4))), half(alpha * weight));
+    out.reveal = half(alpha);
+    return out;
+}
+
+struct ParticleInOut
+{
+    float4 position [[position]];
+    float4 color;
+    float2 uv;
+    uint tex;
+};
+
+// Camera facing quad of particle alive[i_id], its corners are generated from the vertex id like those of sprites.
+vertex ParticleInOut particle_vertex(const device UniformCamera *camera [[buffer(1)]],
+                                     const device Particle *particles [[buffer(2)]],
+                                     const device uint *alive [[buffer(3)]],
+                                     constant ParticleEmitter &emitter [[buffer(4)]], unsigned int vid [[vertex_id]],
+                                     unsigned int i_id [[instance_id]])
+{
+    const Particle p = particles[alive[i_id]];
+    const float t = saturate(p.position.w / max(p.velocity.w, 1e-6));
+    const float size = mix(emitter.size_start, emitter.size_end, t);
+    const float2 corner = float2((0x16u >> vid) & 1u, (0x34u >> vid) & 1u);
+    const float2 offset = (corner - 0.5) * size;
+
+    const float4x4 view = camera->view_matrix;
+    const float3 right = float3(view[0][0], view[1][0], view[2][0]);
+    const float3 up = float3(view[0][1], view[1][1], view[2][1]);
+    const float3 relative = p.position.xyz - camera->origin.xyz + right * offset.x + up * offset.y;
+
+    ParticleInOut out;
+    out.position = camera->combined * float4(relative, 1.0);
+    out.color = mix(unpack_unorm4x8_to_float(emitter.color_start), unpack_unorm4x8_to_float(emitter.color_end), t);
+    out.uv = (float2(emitter.uv_x, emitter.uv_y) + float2(corner.x, 1.0 - corner.y) *
+                                                       float2(emitter.uv_width, emitter.uv_height)) /
+             65535.0;
+    out.tex = emitter.tex;
+    return out;
+}
+
+// Particles are not lit, they add their color to the transparency layers like shaded transparent meshes.
+[[early_fragment_tests]]
+fragment TransparentLayers particle_fragment(ParticleInOut in [[stage_in]], const device Scene &scene [[buffer(0)]])
+{
+    float4 color = in.color;
+    if (in.tex > 0)
+    {
+        const sampler filter = scene.samplers[SAMPLER_2D].s;
+        const uint layer = scene.texture_layers[in.tex];
+        if (layer != NO_TEXTURE_LAYER)
+            color = color * scene.texture_arrays[layer >> 16].tex.sample(filter, in.uv, layer & 0xFFFF);
+        else
+            color = color * scene.textures[in.tex].tex.sample(filter, in.uv);
+    }
+
+    const float alpha = saturate(color.a);
+    const float depth = 0.1 + in.position.z * 0.9;
+    const float weight = clamp(pow(min(1.0, alpha * 10.0) + 0.01, 3.0) * 1e3 * depth * depth * depth, 1e-2, 3e2);
+
+    TransparentLayers out;
+    out.accum = half4(half3(min(color.rgb * alpha * weight, float3(6e4))), half(alpha * weight));
+    out.reveal = half(alpha);
+    return out;
+}
+
+struct DebugLineInOut
+{
+    float4 position [[position]];
+    float4 color;
+};
+
+// Quad of debug line i_id, width pixels wide around the projected segment. The end behind the camera is moved onto the
+// segment just in front of it first, so lines through the camera keep their direction on screen.
+vertex DebugLineInOut debug_line_vertex(const device UniformCamera *camera [[buffer(1)]],
+                                        const device DebugLine *lines [[buffer(2)]], unsigned int vid [[vertex_id]],
+                                        unsigned int i_id [[instance_id]])
+{
+    const DebugLine line = lines[i_id];
+    const float3 origin = camera->origin.xyz;
+    float4 a = camera->combined * float4(float3(line.start.x, line.start.y, line.start.z) - origin, 1.0);
+    float4 b = camera->combined * float4(float3(line.end.x, line.end.y, line.end.z) - origin, 1.0);
+    const float epsilon = 1e-4;
+    if (a.w < epsilon && b.w >= epsilon)
+        a = mix(a, b, (epsilon - a.w) / (b.w - a.w));
+    else if (b.w < epsilon && a.w >= epsilon)
+        b = mix(b, a, (epsilon - b.w) / (a.w - b.w));
+
+    DebugLineInOut out;
+    out.color = unpack_unorm4x8_to_float(line.color);
+    if (a.w < epsilon)
+    {
+        // Entirely behind the camera, outside of the depth range.
+        out.position = float4(0.0, 0.0, -1.0, 1.0);
+        return out;
+    }
+
+    // Corners like those of particles, x picks the end and y the side of the line.
+    const float2 corner = float2((0x16u >> vid) & 1u, (0x34u >> vid) & 1u);
+    const float2 size = float2(1.0 / camera->view.inv_width, 1.0 / camera->view.inv_height);
+    const float2 direction = (b.xy / b.w - a.xy / a.w) * size;
+    const float2 along = length(direction) > 1e-6 ? normalize(direction) : float2(1.0, 0.0);
+    const float2 offset = float2(-along.y, along.x) * line.width / size;
+
+    out.position = corner.x > 0.5 ? b : a;
+    out.position.xy += offset * (corner.y * 2.0 - 1.0) * out.position.w;
+    return out;
+}
+
+fragment half4 debug_line_fragment(DebugLineInOut in [[stage_in]])
+{
+    return half4(in.color);
+}
+
+// Surface attributes of the deferred pass, stored in tile memory. Attachment 0 holds the emitted color until the
+// resolve replaces it with the lit color, metalness and roughness are stored in w of albedo and normal.
+struct GBuffer
+{
+    half4 emissive [[color(0)]];
+    half4 albedo [[color(GBUFFER_ALBEDO_INDEX)]];
+    half4 normal [[color(GBUFFER_NORMAL_INDEX)]];
+    float depth [[color(GBUFFER_DEPTH_INDEX)]];
+};
+
+#if RFW_TILE_MEMORY
+// fragment shader function writing the G-buffer
+[[early_fragment_tests]]
+fragment GBuffer gbuffer_fragment(VertexInOut in [[stage_in]], const device Scene &scene [[buffer(0)]],
+                                  device atomic_int *texture_feedback [[buffer(7)]],
+                                  constant TextureFeedbackUniforms &feedback [[buffer(8)]])
+{
+    write_texture_feedback(scene, in, texture_feedback, feedback);
+    const Surface s = material_surface(scene, in, ImplicitLod());
+
+    GBuffer out;
+    out.emissive = half4(half3(s.emissive), 1.0);
+    out.albedo = half4(half3(s.color.rgb), s.metallic);
+    out.normal = half4(half3(s.normal), s.roughness);
+    out.depth = in.position.z;
+    return out;
+}
+#endif
+
+// 0 shades the G-buffer, 1 shows its normals and 2 its albedo.
+constant uint deferred_view [[function_constant(DEFERRED_VIEW_CONSTANT_INDEX)]];
+
+struct DeferredInOut
+{
+    float4 position [[position]];
+};
+
+// Full screen triangle at the far plane of the reversed depth of the 3D views.
+vertex DeferredInOut deferred_vertex(unsigned int vid [[vertex_id]])
+{
+    DeferredInOut out;
+    out.position = float4(float(vid & 1) * 4.0 - 1.0, float(vid >> 1) * 4.0 - 1.0, 0.0, 1.0);
+    return out;
+}
+
+// Full screen triangle at the far plane of the standard depth of shadow maps.
+vertex DeferredInOut shadow_clear_vertex(unsigned int vid [[vertex_id]])
+{
+    DeferredInOut out;
+    out.position = float4(float(vid & 1) * 4.0 - 1.0, float(vid >> 1) * 4.0 - 1.0, 1.0, 1.0);
+    return out;
+}
+
+// Converts a frame of set_video_frame into the texture of its slot, YCbCr with the BT.709 or BT.601 matrix and its
+// chroma of half the resolution filtered bilinearly. Colors stay gamma encoded, like those of BGRA8 textures.
+fragment half4 video_frame_fragment(DeferredInOut in [[stage_in]], texture2d<half> luma [[texture(0)]],
+                                    texture2d<half> chroma [[texture(1)]], constant uint &format [[buffer(0)]])
+{
+    const uint2 pixel = uint2(in.position.xy);
+    if ((format & VIDEO_FRAME_YCBCR) == 0)
+        return luma.read(pixel);
+
+    constexpr sampler linear(filter::linear, address::clamp_to_edge);
+    const float2 uv = in.position.xy / float2(luma.get_width(), luma.get_height());
+    float y = luma.read(pixel).r;
+    float2 cbcr = float2(chroma.sample(linear, uv).rg) - 128.0 / 255.0;
+    if ((format & VIDEO_FRAME_VIDEO_RANGE) != 0)
+    {
+        y = (y - 16.0 / 255.0) * (255.0 / 219.0);
+        cbcr *= 255.0 / 224.0;
+    }
+    // Red from Cr, green from both, blue from Cb.
+    const bool bt601 = (format & VIDEO_FRAME_BT601) != 0;
+    const float3 cr = bt601 ? float3(1.402, -0.714136, 0.0) : float3(1.5748, -0.468124, 0.0);
+    const float3 cb = bt601 ? float3(0.0, -0.344136, 1.772) : float3(0.0, -0.187324, 1.8556);
+    const float3 rgb = y + cr * cbcr.y + cb * cbcr.x;
+    return half4(half3(saturate(rgb)), 1.0h);
+}
+
+// Composites the cached 2D layer over the frame, it holds premultiplied color and the coverage of all 2D draws.
+fragment float4 layer_2d_fragment(DeferredInOut in [[stage_in]], texture2d<float> layer [[texture(0)]])
+{
+    return layer.read(uint2(in.position.xy));
+}
+
+#if RFW_TILE_MEMORY
+// Resolves the G-buffer of the pixel in tile memory, pixels without geometry keep the clear color.
+fragment half4 deferred_fragment(DeferredInOut in [[stage_in]], GBuffer gbuffer,
+                                 constant LightUniforms &lights [[buffer(1)]],
+                                 const device PointLight *point_lights [[buffer(2)]],
+                                 const device SpotLight *spot_lights [[buffer(3)]],
+                                 const device DirectionalLight *directional_lights [[buffer(4)]],
+                                 const device uint *tile_lights [[buffer(5)]],
+                                 constant ShadowUniforms &shadows [[buffer(6)]],
+                                 constant IrradianceSH &irradiance [[buffer(9)]],
+                                 depth2d_array<float> cascade_shadows [[texture(0)]],
+                                 depth2d<float> spot_shadows [[texture(1)]],
+                                 texture2d<half, access::read> ray_traced [[texture(2)]],
+                                 texturecube<half> environment [[texture(3)]],
+                                 texture2d<half> skybox [[texture(4)]], texture2d<half> ssao [[texture(5)]],
+                                 const device ReflectionProbe *probes [[buffer(11)]],
+                                 const device AreaLight *area_lights [[buffer(12)]],
+                                 texturecube_array<half> probe_maps [[texture(6)]],
+                                 texture2d<half> gi_irradiance [[texture(8)]],
+                                 texture2d<half> gi_distances [[texture(9)]],
+                                 texture2d<half> reflections [[texture(10)]])
+{
+    // The skybox only shows where no geometry was drawn.
+    if (gbuffer.depth <= 0.0)
+    {
+        if (lights.environment != 0 && deferred_view == 0)
+            return half4(half3(skybox_radiance(in.position.xy, lights, skybox)), 1.0);
+        return gbuffer.emissive;
+    }
+    if (deferred_view == 1)
+        return half4(gbuffer.normal.xyz, 1.0);
+    if (deferred_view == 2)
+        return half4(gbuffer.albedo.rgb, 1.0);
+
+    Surface s;
+    s.color = float4(float3(gbuffer.albedo.rgb), 1.0);
+    s.normal = normalize(float3(gbuffer.normal.xyz));
+    s.metallic = gbuffer.albedo.w;
+    s.roughness = gbuffer.normal.w;
+    s.emissive = float3(gbuffer.emissive.rgb);
+    // The G-buffer has no room for lightmaps.
+    s.lightmap = float4(0.0);
+
+    const float2 ndc = float2(in.position.x / lights.width * 2.0 - 1.0, 1.0 - in.position.y / lights.height * 2.0);
+    const float4 p = lights.inv_combined * float4(ndc, gbuffer.depth, 1.0);
+    const uint2 pixel = uint2(in.position.xy);
+    return shade(s, p.xyz / p.w, pixel, lights, point_lights, spot_lights, area_lights, directional_lights,
+                 tile_lights, shadows, cascade_shadows, spot_shadows, ray_traced, irradiance, environment, ssao, probes,
+                 probe_maps, gi_irradiance, gi_distances, traced_reflection(reflections, lights, pixel));
+}
+#endif
+
+// Shows the ambient occlusion traced or computed in screen space for every pixel, white while there is none.
+fragment half4 ambient_occlusion_fragment(DeferredInOut in [[stage_in]], constant LightUniforms &lights [[buffer(1)]],
+                                          texture2d<half, access::read> ray_traced [[texture(2)]],
+                                          texture2d<half> ssao [[texture(5)]])
+{
+    if (lights.ray_traced != 0)
+        return half4(half3(ray_traced.read(uint2(in.position.xy)).y), 1.0);
+    if (lights.ssao != 0)
+        return half4(half3(screen_space_occlusion(ssao, lights, in.position.xy)), 1.0);
+    return half4(1.0);
+}
+
+// Shows the fragments drawn for every pixel, from black for none over blue, cyan, green, yellow, orange, red and
+// magenta to white for 8 and more.
+fragment half4 overdraw_heatmap_fragment(DeferredInOut in [[stage_in]],
+                                         texture2d<half, access::read> counts [[texture(0)]])
+{
+    constexpr half3 ramp[9] = {half3(0.0, 0.0, 0.0), half3(0.0, 0.0, 1.0), half3(0.0, 1.0, 1.0),
+                               half3(0.0, 1.0, 0.0), half3(1.0, 1.0, 0.0), half3(1.0, 0.5, 0.0),
+                               half3(1.0, 0.0, 0.0), half3(1.0, 0.0, 1.0), half3(1.0, 1.0, 1.0)};
+    const uint count = uint(min(counts.read(uint2(in.position.xy)).r, 8.0h));
+    return half4(ramp[count], 1.0);
+}
+
+// Average radiance of the transparent layers of a pixel, blended over the opaque color with the coverage they leave.
+half4 composite_transparency(float4 accum, float reveal)
+{
+    return half4(half3(accum.rgb / max(accum.a, 1e-5)), half(1.0 - reveal));
+}
+
+#if RFW_TILE_MEMORY
+// Composites the layers accumulated in tile memory within the transparency pass.
+fragment half4 transparency_resolve_fragment(DeferredInOut in [[stage_in]], TransparentLayers layers)
+{
+    return composite_transparency(float4(layers.accum), float(layers.reveal));
+}
+#else
+// Composites the layers stored by the transparency pass on GPUs without tile memory.
+fragment half4 transparency_composite_fragment(DeferredInOut in [[stage_in]],
+                                               texture2d<float, access::read> accum [[texture(0)]],
+                                               texture2d<float, access::read> reveal [[texture(1)]])
+{
+    const uint2 pixel = uint2(in.position.xy);
+    return composite_transparency(accum.read(pixel), reveal.read(pixel).x);
+}
+#endif
+
+// Drawn at the far plane after the opaque geometry of the forward pass, the depth test keeps it behind everything.
+fragment half4 skybox_fragment(DeferredInOut in [[stage_in]], constant LightUniforms &lights [[buffer(1)]],
+                               texture2d<half> skybox [[texture(4)]])
+{
+    return half4(half3(skybox_radiance(in.position.xy, lights, skybox)), 1.0);
+}
+
+// Perspective correct barycentrics of a pixel in a triangle, with their change towards the next pixel on the right and
+// the one below.
+struct Barycentrics
+{
+    float3 weights;
+    float3 dx;
+    float3 dy;
+};
+
+// Barycentrics of the pixel at ndc in the triangle of clip space positions c0, c1 and c2 on a target of size pixels.
+Barycentrics triangle_barycentrics(float4 c0, float4 c1, float4 c2, float2 ndc, float2 size)
+{
+    const float3 inv_w = 1.0 / float3(c0.w, c1.w, c2.w);
+    const float2 n0 = c0.xy * inv_w.x;
+    const float2 n1 = c1.xy * inv_w.y;
+    const float2 n2 = c2.xy * inv_w.z;
+    const float inv_det = 1.0 / determinant(float2x2(n2 - n1, n0 - n1));
+
+    // Change of the barycentrics over w along x and y of normalized device coordinates.
+    float3 ddx = float3(n1.y - n2.y, n2.y - n0.y, n0.y - n1.y) * inv_det * inv_w;
+    float3 ddy = float3(n2.x - n1.x, n0.x - n2.x, n1.x - n0.x) * inv_det * inv_w;
+    const float2 delta = ndc - n0;
+    const float interpolated_inv_w = inv_w.x + delta.x * dot(ddx, float3(1.0)) + delta.y * dot(ddy, float3(1.0));
+
+    Barycentrics b;
+    b.weights = (float3(inv_w.x, 0.0, 0.0) + delta.x * ddx + delta.y * ddy) / interpolated_inv_w;
+    // Pixels are 2 / size apart in normalized device coordinates, rows go down the screen.
+    ddx *= 2.0 / size.x;
+    ddy *= -2.0 / size.y;
+    b.dx = (b.weights * interpolated_inv_w + ddx) / (interpolated_inv_w + dot(ddx, float3(1.0))) - b.weights;
+    b.dy = (b.weights * interpolated_inv_w + ddy) / (interpolated_inv_w + dot(ddy, float3(1.0))) - b.weights;
+    return b;
+}
+
+float2 interpolate_corners(float3 w, float2 a, float2 b, float2 c)
+{
+    return a * w.x + b * w.y + c * w.z;
+}
+
+float3 interpolate_corners(float3 w, float3 a, float3 b, float3 c)
+{
+    return a * w.x + b * w.y + c * w.z;
+}
+
+Vertex3D unpack_vertex(const device PackedVertex3D &v, const device PackedVertexBounds &bounds)
+{
+    const float3 position = bounds.offset.xyz + float3(v.p_x, v.p_y, v.p_z) / 65535.0 * bounds.scale.xyz;
+    const float3 normal = decode_octahedral(v.n_x, v.n_y);
+    const float3 tangent = decode_octahedral(v.t_x, v.t_y);
+    Vertex3D out = {position.x, position.y, position.z, 1.0, normal.x, normal.y, normal.z, v.mat_id,
+                    float(as_type<half>(v.u)), float(as_type<half>(v.v)), 0.0, 0.0,
+                    tangent.x, tangent.y, tangent.z, (v.flags & 1) != 0 ? -1.0 : 1.0};
+    return out;
+}
+
+// Corner of triangle of a mesh of the visibility buffer, shaded like by the vertex functions of its mesh.
+VertexInOut vbuffer_corner(const device Scene &scene, const device VBufferMesh &record, const device uchar *indices,
+                           uint triangle, uint corner, float4x4 m, const device UniformCamera *camera)
+{
+    const uint index = triangle * 3 + corner;
+    uint vid = record.vertex_start + index;
+    if ((record.flags & VBUFFER_SHORT_INDICES) != 0)
+        vid = record.vertex_start + ((const device ushort *)indices)[record.index_start + index];
+    else if ((record.flags & VBUFFER_INDEXED) != 0)
+        vid = record.vertex_start + ((const device uint *)indices)[record.index_start + index];
+
+    if ((record.flags & VBUFFER_PACKED) != 0)
+        return shade_vertex(unpack_vertex(scene.packed_vertices[vid], record.bounds), m, camera);
+    const device Vertex3D &v = scene.vertices[vid];
+    if (is_impostor(v))
+        return shade_vertex(impostor_vertex(scene, v, m), m, camera);
+    return shade_vertex(v, m, camera);
+}
+
+// Shades the triangle the visibility buffer holds for the pixel. Its attributes are interpolated from its vertices with
+// the barycentrics of the pixel, whose derivatives also select the levels the material maps are sampled at.
+fragment half4 vbuffer_resolve_fragment(DeferredInOut in [[stage_in]], const device Scene &scene [[buffer(0)]],
+                                        constant LightUniforms &lights [[buffer(1)]],
+                                        const device PointLight *point_lights [[buffer(2)]],
+                                        const device SpotLight *spot_lights [[buffer(3)]],
+                                        const device DirectionalLight *directional_lights [[buffer(4)]],
+                                        const device uint *tile_lights [[buffer(5)]],
+                                        constant ShadowUniforms &shadows [[buffer(6)]],
+                                        device atomic_int *texture_feedback [[buffer(7)]],
+                                        constant TextureFeedbackUniforms &feedback [[buffer(8)]],
+                                        constant IrradianceSH &irradiance [[buffer(9)]],
+                                        const device UniformCamera *camera [[buffer(10)]],
+                                        const device ReflectionProbe *probes [[buffer(11)]],
+                                        const device AreaLight *area_lights [[buffer(12)]],
+                                        const device VBufferMesh *meshes [[buffer(13)]],
+                                        constant uint &num_meshes [[buffer(14)]],
+                                        const device uchar *indices [[buffer(15)]],
+                                        const device uchar *packed_indices [[buffer(16)]],
+                                        depth2d_array<float> cascade_shadows [[texture(0)]],
+                                        depth2d<float> spot_shadows [[texture(1)]],
+                                        texture2d<half, access::read> ray_traced [[texture(2)]],
+                                        texturecube<half> environment [[texture(3)]],
+                                        texture2d<half> ssao [[texture(5)]],
+                                        texturecube_array<half> probe_maps [[texture(6)]],
+                                        texture2d<uint, access::read> vbuffer [[texture(7)]],
+                                        texture2d<half> gi_irradiance [[texture(8)]],
+                                        texture2d<half> gi_distances [[texture(9)]],
+                                        texture2d<half> reflections [[texture(10)]])
+{
+    const uint2 pixel = uint2(in.position.xy);
+    const uint2 ids = vbuffer.read(pixel).xy;
+    if (ids.y == NO_VBUFFER_TRIANGLE || num_meshes == 0)
+    {
+        discard_fragment();
+        return half4(0.0);
+    }
+
+    // The mesh of the triangle is the last one starting at or before it.
+    uint first = 0;
+    uint last = num_meshes;
+    while (last - first > 1)
+    {
+        const uint middle = (first + last) / 2;
+        if (meshes[middle].first_triangle <= ids.y)
+            first = middle;
+        else
+            last = middle;
+    }
+    const device VBufferMesh &record = meshes[first];
+    const uint triangle = ids.y - record.first_triangle;
+    const device uchar *mesh_indices = (record.flags & VBUFFER_PACKED) != 0 ? packed_indices : indices;
+
+    const float4x4 m = instance_matrix(scene.instances[ids.x], camera->origin.xyz);
+    const VertexInOut v0 = vbuffer_corner(scene, record, mesh_indices, triangle, 0, m, camera);
+    const VertexInOut v1 = vbuffer_corner(scene, record, mesh_indices, triangle, 1, m, camera);
+    const VertexInOut v2 = vbuffer_corner(scene, record, mesh_indices, triangle, 2, m, camera);
+
+    const float2 size = float2(vbuffer.get_width(), vbuffer.get_height());
+    const float2 ndc = float2(in.position.x / size.x * 2.0 - 1.0, 1.0 - in.position.y / size.y * 2.0);
+    const Barycentrics b = triangle_barycentrics(v0.position, v1.position, v2.position, ndc, size);
+
+    VertexInOut surface = v0;
+    surface.position = in.position;
+    surface.world_position = interpolate_corners(b.weights, v0.world_position, v1.world_position, v2.world_position);
+    surface.normal = half3(interpolate_corners(b.weights, float3(v0.normal), float3(v1.normal), float3(v2.normal)));
+    surface.tangent.xyz =
+        half3(interpolate_corners(b.weights, float3(v0.tangent.xyz), float3(v1.tangent.xyz), float3(v2.tangent.xyz)));
+    surface.uv = interpolate_corners(b.weights, v0.uv, v1.uv, v2.uv);
+    surface.lightmap_uv = interpolate_corners(b.weights, v0.lightmap_uv, v1.lightmap_uv, v2.lightmap_uv);
+    const GradientLod lod = {interpolate_corners(b.dx, v0.uv, v1.uv, v2.uv),
+                             interpolate_corners(b.dy, v0.uv, v1.uv, v2.uv)};
+    surface = override_instance(surface, scene, ids.x);
+
+    write_texture_feedback(scene, surface, texture_feedback, feedback);
+    return shade(material_surface(scene, surface, lod), surface.world_position, pixel, lights, point_lights,
+                 spot_lights, area_lights, directional_lights, tile_lights, shadows, cascade_shadows, spot_shadows,
+                 ray_traced, irradiance, environment, ssao, probes, probe_maps, gi_irradiance, gi_distances,
+                 traced_reflection(reflections, lights, pixel));
+}
+
+// Direction through texel uv in [-1, 1] of a cube map face, in the face order and orientation of Metal.
+float3 cube_direction(uint face, float2 uv)
+{
+    switch (face)
+    {
+    case 0:
+        return float3(1.0, -uv.y, -uv.x);
+    case 1:
+        return float3(-1.0, -uv.y, uv.x);
+    case 2:
+        return float3(uv.x, 1.0, uv.y);
+    case 3:
+        return float3(uv.x, -1.0, -uv.y);
+    case 4:
+        return float3(uv.x, -uv.y, 1.0);
+    default:
+        return float3(-uv.x, -uv.y, -1.0);
+    }
+}
+
+// Radiance in direction d of the skybox or a captured cube map, from level lod.
+float4 sample_radiance(texture2d<float> skybox, float3 d, float lod)
+{
+    return skybox.sample(skybox_sampler, skybox_uv(d), level(lod));
+}
+
+float4 sample_radiance(texturecube<float> capture, float3 d, float lod)
+{
+    return capture.sample(environment_sampler, d, level(lod));
+}
+
+// Prefilters source into texel gid of one mip level of a cube map with GGX importance sampling, assuming the view
+// direction equals the normal. Texels of the finest source level cover texel_angle, samples read the source level
+// matching their solid angle, so few of them suffice.
+template <typename Source>
+void prefilter_texel(Source source, float texel_angle, texturecube<float, access::write> out,
+                     constant EnvironmentUniforms &uniforms, uint3 gid)
+{
+    if (gid.x >= uniforms.size || gid.y >= uniforms.size)
+        return;
+
+    const float2 uv = (float2(gid.xy) + 0.5) / float(uniforms.size) * 2.0 - 1.0;
+    const float3 n = normalize(cube_direction(gid.z, uv));
+    if (uniforms.roughness == 0.0)
+    {
+        const float cube_texel_angle = 4.0 * M_PI_F / (6.0 * uniforms.size * uniforms.size);
+        const float lod = max(0.5 * log2(cube_texel_angle / texel_angle), 0.0);
+        out.write(sample_radiance(source, n, lod), gid.xy, gid.z);
+        return;
+    }
+
+    const float3 up = abs(n.y) < 0.999 ? float3(0.0, 1.0, 0.0) : float3(1.0, 0.0, 0.0);
+    const float3 tangent = normalize(cross(up, n));
+    const float3 bitangent = cross(n, tangent);
+    const float a2 = uniforms.roughness * uniforms.roughness * uniforms.roughness * uniforms.roughness;
+
+    float3 sum = 0.0;
+    float weight = 0.0;
+    for (uint i = 0; i < ENVIRONMENT_SAMPLES; i++)
+    {
+        // Hammersley point set.
+        const float2 xi = float2(float(i) / ENVIRONMENT_SAMPLES, float(reverse_bits(i)) * 2.3283064365386963e-10);
+        const float phi = 2.0 * M_PI_F * xi.x;
+        const float cos_theta = sqrt((1.0 - xi.y) / (1.0 + (a2 - 1.0) * xi.y));
+        const float sin_theta = sqrt(1.0 - cos_theta * cos_theta);
+        const float3 h = tangent * (cos(phi) * sin_theta) + bitangent * (sin(phi) * sin_theta) + n * cos_theta;
+        const float3 l = 2.0 * dot(n, h) * h - n;
+        const float n_dot_l = dot(n, l);
+        if (n_dot_l <= 0.0)
+            continue;
+
+        // With the view along the normal the probability density of l is a quarter of the distribution.
+        const float d = cos_theta * cos_theta * (a2 - 1.0) + 1.0;
+        const float pdf = a2 / (M_PI_F * d * d) * 0.25;
+        const float lod = 0.5 * log2(1.0 / (ENVIRONMENT_SAMPLES * pdf * texel_angle)) + 1.0;
+        sum += sample_radiance(source, l, max(lod, 0.0)).rgb * n_dot_l;
+        weight += n_dot_l;
+    }
+    out.write(float4(sum / max(weight, 1e-4), 1.0), gid.xy, gid.z);
+}
+
+// Prefilters the skybox into one mip level of the environment map.
+kernel void prefilter_environment(texture2d<float> skybox [[texture(0)]],
+                                  texturecube<float, access::write> environment [[texture(1)]],
+                                  constant EnvironmentUniforms &uniforms [[buffer(0)]],
+                                  uint3 gid [[thread_position_in_grid]])
+{
+    const float texel_angle = 4.0 * M_PI_F / float(skybox.get_width() * skybox.get_height());
+    prefilter_texel(skybox, texel_angle, environment, uniforms, gid);
+}
+
+// Prefilters the faces captured for a reflection probe into one mip level of its reflections.
+kernel void prefilter_probe(texturecube<float> capture [[texture(0)]],
+                            texturecube<float, access::write> probe [[texture(1)]],
+                            constant EnvironmentUniforms &uniforms [[buffer(0)]], uint3 gid [[thread_position_in_grid]])
+{
+    const float size = float(capture.get_width());
+    prefilter_texel(capture, 4.0 * M_PI_F / (6.0 * size * size), probe, uniforms, gid);
+}
+
+struct ProbeBackgroundInOut
+{
+    float4 position [[position]];
+    uint layer [[render_target_array_index]];
+};
+
+// Full screen triangle at the far plane of the probe faces from first_view on.
+vertex ProbeBackgroundInOut probe_background_vertex(unsigned int vid [[vertex_id]],
+                                                    constant uint &first_view [[buffer(3)]],
+                                                    ushort amplification [[amplification_id]])
+{
+    ProbeBackgroundInOut out;
+    out.position = float4(float(vid & 1) * 4.0 - 1.0, float(vid >> 1) * 4.0 - 1.0, 0.0, 1.0);
+    out.layer = first_view + amplification;
+    return out;
+}
+
+// Skybox behind the geometry of a probe face, layers of the pass start at face first_face of the cube map.
+fragment half4 probe_background_fragment(ProbeBackgroundInOut in [[stage_in]], constant uint &first_face [[buffer(3)]],
+                                         texturecube<half> environment [[texture(3)]])
+{
+    const float2 uv = in.position.xy / REFLECTION_PROBE_SIZE * 2.0 - 1.0;
+    const float3 d = cube_direction(first_face + in.layer, uv);
+    return half4(environment.sample(environment_sampler, d, level(0.0)).rgb, 1.0);
+}
+
+// Skybox behind the geometry of a render texture, along the rays of the camera of its single layer.
+fragment half4 render_texture_background_fragment(ProbeBackgroundInOut in [[stage_in]],
+                                                  const device UniformCamera *cameras [[buffer(10)]],
+                                                  texturecube<half> environment [[texture(3)]])
+{
+    const UniformCamera camera = cameras[in.layer];
+    const float2 uv = in.position.xy * float2(camera.view.inv_width, camera.view.inv_height);
+    const float2 ndc = float2(uv.x * 2.0 - 1.0, 1.0 - uv.y * 2.0);
+    const float3 view_ray = float3(ndc.x / camera.projection[0][0], ndc.y / camera.projection[1][1], -1.0);
+    const float3x3 rotation = float3x3(camera.view_matrix[0].xyz, camera.view_matrix[1].xyz, camera.view_matrix[2].xyz);
+    const float3 d = normalize(transpose(rotation) * view_ray);
+    return half4(environment.sample(environment_sampler, d, level(0.0)).rgb, 1.0);
+}
+
+// Projects the radiance of a skybox level onto spherical harmonics in one threadgroup and convolves it with the
+// Lambertian lobe, weighting every texel by its solid angle.
+kernel void project_irradiance(texture2d<float, access::read> skybox [[texture(0)]],
+                               device IrradianceSH &irradiance [[buffer(0)]], uint tid [[thread_index_in_threadgroup]])
+{
+    threadgroup float3 partial[IRRADIANCE_GROUP_SIZE];
+    const uint width = skybox.get_width();
+    const uint height = skybox.get_height();
+
+    float3 sh[9] = {};
+    for (uint i = tid; i < width * height; i += IRRADIANCE_GROUP_SIZE)
+    {
+        const uint2 texel = uint2(i % width, i / width);
+        const float theta = (float(texel.y) + 0.5) / float(height) * M_PI_F;
+        const float phi = ((float(texel.x) + 0.5) / float(width) * 2.0 - 1.0) * M_PI_F;
+        const float3 d = float3(sin(theta) * sin(phi), cos(theta), -sin(theta) * cos(phi));
+        const float solid_angle = 2.0 * M_PI_F * M_PI_F / float(width * height) * sin(theta);
+
+        float y[9];
+        sh_basis(d, y);
+        const float3 radiance = skybox.read(texel).rgb * solid_angle;
+        for (uint c = 0; c < 9; c++)
+            sh[c] += radiance * y[c];
+    }
+
+    // Bands are scaled by the convolution with the clamped cosine, pi, 2 pi / 3 and pi / 4, divided by pi.
+    const float bands[9] = {1.0, 2.0 / 3.0, 2.0 / 3.0, 2.0 / 3.0, 0.25, 0.25, 0.25, 0.25, 0.25};
+    for (uint c = 0; c < 9; c++)
+    {
+        partial[tid] = sh[c];
+        for (uint stride = IRRADIANCE_GROUP_SIZE / 2; stride > 0; stride /= 2)
+        {
+            threadgroup_barrier(mem_flags::mem_threadgroup);
+            if (tid < stride)
+                partial[tid] += partial[tid + stride];
+        }
+        threadgroup_barrier(mem_flags::mem_threadgroup);
+        if (tid == 0)
+            irradiance.coefficients[c] = float4(partial[0] * bands[c], 0.0);
+        threadgroup_barrier(mem_flags::mem_threadgroup);
+    }
+}
+
+// Whether bounds transformed by m intersect the view frustum of uniforms.
+bool frustum_visible(constant CullUniforms &uniforms, float4x4 m, float3 center, float3 extent)
+{
+    const float3 world_center = (m * float4(center, 1.0)).xyz;
+    const float3 world_extent = abs(m[0].xyz) * extent.x + abs(m[1].xyz) * extent.y + abs(m[2].xyz) * extent.z;
+    bool visible = true;
+    for (uint i = 0; i < 6; i++)
+    {
+        const float4 plane = uniforms.planes[i];
+        visible = visible && dot(plane.xyz, world_center) + plane.w + dot(abs(plane.xyz), world_extent) >= 0.0;
+    }
+    return visible;
+}
+
+// Whether bounds transformed by m into clip space are hidden behind the depth pyramid. The nearest and so largest depth
+// of the bounds is compared with the finest pyramid level at which their screen rectangle spans at most 2x2 texels.
+bool hzb_occluded(texture2d<float, access::read> hzb, constant CullUniforms &uniforms, float4x4 m, float3 center,
+                  float3 extent)
+{
+    float3 lo = float3(INFINITY);
+    float3 hi = float3(-INFINITY);
+    for (uint i = 0; i < 8; i++)
+    {
+        const float3 corner =
+            center + extent * float3((i & 1) != 0 ? 1.0 : -1.0, (i & 2) != 0 ? 1.0 : -1.0, (i & 4) != 0 ? 1.0 : -1.0);
+        const float4 clip = m * float4(corner, 1.0);
+        // Bounds crossing the near plane are never occluded.
+        if (clip.w <= 1e-5)
+            return false;
+        lo = min(lo, clip.xyz / clip.w);
+        hi = max(hi, clip.xyz / clip.w);
+    }
+
+    // Pixel p of the depth buffer is covered by texel p >> (level + 1) of the pyramid.
+    const float2 size = float2(uniforms.depth_width, uniforms.depth_height);
+    const uint2 last = uint2(uniforms.depth_width, uniforms.depth_height) - 1;
+    const uint2 p_lo = min(uint2(saturate(float2(lo.x, -hi.y) * 0.5 + 0.5) * size), last);
+    const uint2 p_hi = min(uint2(saturate(float2(hi.x, -lo.y) * 0.5 + 0.5) * size), last);
+
+    uint level = 0;
+    while (level + 1 < uniforms.hzb_levels && any((p_hi >> (level + 1)) - (p_lo >> (level + 1)) > 1))
+        level++;
+
+    const uint2 t_lo = p_lo >> (level + 1);
+    const uint2 t_hi = p_hi >> (level + 1);
+    const float depth = min(min(hzb.read(t_lo, level).x, hzb.read(uint2(t_hi.x, t_lo.y), level).x),
+                            min(hzb.read(uint2(t_lo.x, t_hi.y), level).x, hzb.read(t_hi, level).x));
+    return hi.z < depth;
+}
+
+// Index of the draw whose visible range holds slot gid, num_draws when no draw's does.
+uint cull_draw_index(const device CullDraw *draws, uint num_draws, uint gid)
+{
+    // Find the last draw that starts at or before this slot.
+    uint lo = 0;
+    uint hi = num_draws;
+    while (lo < hi)
+    {
+        const uint mid = (lo + hi) / 2;
+        if (draws[mid].visible_start <= gid)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+
+    if (lo == 0 || gid >= draws[lo - 1].visible_start + draws[lo - 1].instance_count)
+        return num_draws;
+    return lo - 1;
+}
+
+// Tests the 3D instance in slot gid of the draws' visible ranges against the view frustum, unless it is known to be
+// inside. A visible instance is appended to the range of its draw in visible_instances and counted in the draw's
+// indirect arguments, which start with an instance count of 0, or those of the coarsest level of detail of the draw it
+// is small enough on screen for. Meshes of a prefab test the same instances in slots of their own.
+// With occlusion culling the early phase also tests against the depth pyramid and flags the slots it rejected because
+// of it in occluded, the late phase only re-tests those.
+void cull_instance_slot(uint gid, bool inside, const device InstanceTransform *instances,
+                        constant CullUniforms &uniforms, const device CullDraw *draws, device atomic_uint *draw_args,
+                        device uint *visible_instances, device atomic_uint *draw_depths, device uint *occluded,
+                        texture2d<float, access::read> hzb)
+{
+    const uint d = cull_draw_index(draws, uniforms.num_draws, gid);
+    if (d == uniforms.num_draws)
+        return;
+
+    const device CullDraw &draw = draws[d];
+    const uint instance = draw.instance_start + gid - draw.visible_start;
+    const float4x4 m = instance_matrix(instances[instance]);
+    if (occlusion_culling && uniforms.occlusion_phase == 2)
+    {
+        if (occluded[gid] == 0 ||
+            hzb_occluded(hzb, uniforms, uniforms.hzb_combined * m, draw.center.xyz, draw.extent.xyz))
+            return;
+    }
+    else
+    {
+        bool visible = inside || frustum_visible(uniforms, m, draw.center.xyz, draw.extent.xyz);
+        if (occlusion_culling)
+        {
+            const bool hidden = visible && uniforms.hzb_levels > 0 &&
+                                hzb_occluded(hzb, uniforms, uniforms.hzb_combined * m, draw.center.xyz,
+                                             draw.extent.xyz);
+            occluded[gid] = hidden ? 1 : 0;
+            visible = visible && !hidden;
+        }
+
+        if (!visible)
+            return;
+    }
+
+    // Bounding spheres span radius * projection scale / distance of the screen height.
+    uint level = 0;
+    if (draw.lod_count > 0)
+    {
+        const float3 center = (m * float4(draw.center.xyz, 1.0)).xyz;
+        const float3 extent =
+            abs(m[0].xyz) * draw.extent.x + abs(m[1].xyz) * draw.extent.y + abs(m[2].xyz) * draw.extent.z;
+        const float size = length(extent) * uniforms.lod_view.w / max(distance(center, uniforms.lod_view.xyz), 1e-5);
+        while (level < draw.lod_count && size < draw.lod_sizes[level])
+            level++;
+    }
+    const uint args_offset = level == 0 ? draw.args_offset : draw.lod_args_offsets[level - 1];
+    const uint visible_start =
+        level == 0 ? draw.visible_start : draw.lod_instance_start + (level - 1) * draw.instance_count;
+
+    // Distance of the nearest corner of the bounds from the near plane. Depths are positive, so their bits order like
+    // the floats.
+    if (uniforms.sort_depths != 0)
+    {
+        const float3 center = (m * float4(draw.center.xyz, 1.0)).xyz;
+        const float3 extent =
+            abs(m[0].xyz) * draw.extent.x + abs(m[1].xyz) * draw.extent.y + abs(m[2].xyz) * draw.extent.z;
+        const float4 near = uniforms.planes[4];
+        const float depth = max(dot(near.xyz, center) + near.w - dot(abs(near.xyz), extent), 0.0);
+        atomic_fetch_min_explicit(&draw_depths[args_offset / DRAW_ARGS_WORDS], as_type<uint>(depth),
+                                  memory_order_relaxed);
+    }
+
+    // The instance count is the second word of both the indexed and non-indexed indirect arguments.
+    const uint slot = atomic_fetch_add_explicit(&draw_args[args_offset + 1], 1, memory_order_relaxed);
+    visible_instances[uniforms.visible_offset + visible_start + slot] = instance;
+}
+
+// Culls every 3D instance of every draw, one thread per slot of the draws' visible ranges.
+kernel void cull_instances(const device InstanceTransform *instances [[buffer(0)]],
+                           constant CullUniforms &uniforms [[buffer(1)]], const device CullDraw *draws [[buffer(2)]],
+                           device atomic_uint *draw_args [[buffer(3)]], device uint *visible_instances [[buffer(4)]],
+                           device uint *occluded [[buffer(5), function_constant(occlusion_culling)]],
+                           device atomic_uint *draw_depths [[buffer(6)]],
+                           texture2d<float, access::read> hzb [[texture(0), function_constant(occlusion_culling)]],
+                           uint gid [[thread_position_in_grid]])
+{
+    if (gid >= uniforms.num_instances)
+        return;
+    cull_instance_slot(gid, false, instances, uniforms, draws, draw_args, visible_instances, draw_depths, occluded,
+                       hzb);
+}
+
+// Culls the instances of the clusters traverse_instance_bvh reached, one threadgroup of INSTANCE_BVH_CLUSTER_SIZE
+// threads per cluster. Keys hold the slot of every sorted position.
+kernel void cull_bvh_instances(const device InstanceTransform *instances [[buffer(0)]],
+                               constant CullUniforms &uniforms [[buffer(1)]],
+                               const device CullDraw *draws [[buffer(2)]],
+                               device atomic_uint *draw_args [[buffer(3)]],
+                               device uint *visible_instances [[buffer(4)]],
+                               device uint *occluded [[buffer(5), function_constant(occlusion_culling)]],
+                               device atomic_uint *draw_depths [[buffer(6)]], const device uint *clusters [[buffer(7)]],
+                               const device uint2 *keys [[buffer(8)]],
+                               texture2d<float, access::read> hzb [[texture(0), function_constant(occlusion_culling)]],
+                               uint group [[threadgroup_position_in_grid]], uint tid [[thread_index_in_threadgroup]])
+{
+    const uint entry = clusters[group];
+    const uint sorted = (entry & ~INSTANCE_BVH_INSIDE) * INSTANCE_BVH_CLUSTER_SIZE + tid;
+    if (sorted >= uniforms.num_instances)
+        return;
+    cull_instance_slot(keys[sorted].y, (entry & INSTANCE_BVH_INSIDE) != 0, instances, uniforms, draws, draw_args,
+                       visible_instances, draw_depths, occluded, hzb);
+}
+
+// Maps floats to keys of the same order, so the atomic min and max of the keys are those of the floats.
+uint ordered_float_key(float value)
+{
+    const uint bits = as_type<uint>(value);
+    return (bits & 0x80000000u) != 0 ? ~bits : bits | 0x80000000u;
+}
+
+float ordered_float_value(uint key)
+{
+    return as_type<float>((key & 0x80000000u) != 0 ? key & 0x7FFFFFFFu : ~key);
+}
+
+// Tests every run of skinned instances against the view frustum with the bounds the skinning pass found for its
+// group, or the bounds of its mesh for runs in the bind pose. Runs draw all of their instances when any is visible.
+kernel void cull_skinned(const device InstanceTransform *instances [[buffer(0)]],
+                         constant CullUniforms &uniforms [[buffer(1)]], const device SkinnedCullRun *runs [[buffer(2)]],
+                         device uint *draw_args [[buffer(3)]], const device uint *skinned_bounds [[buffer(4)]],
+                         constant uint2 &counts [[buffer(5)]], uint gid [[thread_position_in_grid]])
+{
+    if (gid >= counts.x)
+        return;
+
+    const device SkinnedCullRun &run = runs[gid];
+    float3 center = run.center.xyz;
+    float3 extent = run.extent.xyz;
+    if (run.group != NO_SKINNING_GROUP)
+    {
+        const device uint *lo = skinned_bounds + run.group * 4;
+        const device uint *hi = skinned_bounds + (counts.y + run.group) * 4;
+        const float3 bmin = float3(ordered_float_value(lo[0]), ordered_float_value(lo[1]), ordered_float_value(lo[2]));
+        const float3 bmax = float3(ordered_float_value(hi[0]), ordered_float_value(hi[1]), ordered_float_value(hi[2]));
+        // Groups the skinning pass wrote no vertex of keep the bounds of the run, which are never culled.
+        if (all(bmin <= bmax))
+        {
+            center = (bmin + bmax) * 0.5;
+            extent = (bmax - bmin) * 0.5;
+        }
+    }
+
+    bool visible = false;
+    for (uint i = 0; i < run.instance_count && !visible; i++)
+        visible = frustum_visible(uniforms, instance_matrix(instances[run.instance_start + i]), center, extent);
+    draw_args[run.args_offset + 1] = visible ? run.instance_count : 0;
+}
+
+// Tests one cluster per threadgroup against the frustum and its normal cone in every instance of its draw found
+// visible, clusters visible in any of them are copied to the culled index buffer and counted in the draw's indexed
+// indirect arguments. Those start with 0 indices and get the instances of the culled draw.
+kernel void cull_clusters(const device InstanceTransform *instances [[buffer(0)]],
+                          constant ClusterUniforms &uniforms [[buffer(1)]],
+                          const device MeshCluster *clusters [[buffer(2)]],
+                          const device ClusterDraw *draws [[buffer(3)]], const device uint *instance_args [[buffer(4)]],
+                          const device uint *visible_instances [[buffer(5)]], device atomic_uint *args [[buffer(6)]],
+                          const device ushort *indices_16 [[buffer(7)]], const device uint *indices_32 [[buffer(8)]],
+                          device uint *culled_indices [[buffer(9)]], uint cluster_id [[threadgroup_position_in_grid]],
+                          uint thread [[thread_index_in_threadgroup]], uint threads [[threads_per_threadgroup]])
+{
+    threadgroup uint out_start;
+    threadgroup uint draw_index;
+    if (thread == 0)
+    {
+        out_start = ~0u;
+
+        // Find the last draw that starts at or before this cluster.
+        uint lo = 0;
+        uint hi = uniforms.num_draws;
+        while (lo < hi)
+        {
+            const uint mid = (lo + hi) / 2;
+            if (draws[mid].cluster_start <= cluster_id)
+                lo = mid + 1;
+            else
+                hi = mid;
+        }
+
+        const device ClusterDraw &draw = draws[max(lo, 1u) - 1];
+        const device MeshCluster &cluster = clusters[cluster_id];
+        const bool in_draw = lo > 0 && cluster_id < draw.cluster_start + draw.cluster_count;
+        const uint instance_count = instance_args[draw.instance_args_offset + 1];
+        const uint instance_start = instance_args[draw.instance_args_offset + 4];
+        bool visible = false;
+        for (uint i = 0; in_draw && !visible && i < instance_count; i++)
+        {
+            const float4x4 m = instance_matrix(instances[visible_instances[instance_start + i]]);
+            const float3 m0 = m[0].xyz;
+            const float3 m1 = m[1].xyz;
+            const float3 m2 = m[2].xyz;
+            const float3 center = (m * float4(cluster.sphere.xyz, 1.0)).xyz;
+            const float radius = cluster.sphere.w * sqrt(max(length_squared(m0), max(length_squared(m1),
+                                                                                       length_squared(m2))));
+
+            visible = true;
+            for (uint p = 0; p < 6; p++)
+            {
+                const float4 plane = uniforms.planes[p];
+                visible = visible && dot(plane.xyz, center) + plane.w + length(plane.xyz) * radius >= 0.0;
+            }
+
+            // Normals transform with the cofactors of the matrix, mirrored instances are not cone tested.
+            if (visible && cluster.cone.w < 1.0 && dot(m0, cross(m1, m2)) > 0.0)
+            {
+                const float3x3 cofactors = float3x3(cross(m1, m2), cross(m2, m0), cross(m0, m1));
+                const float3 axis = normalize(cofactors * cluster.cone.xyz);
+                const float3 to_center = center - uniforms.camera_position.xyz;
+                visible = dot(to_center, axis) < cluster.cone.w * length(to_center) + radius;
+            }
+        }
+
+        if (visible)
+        {
+            // Every visible cluster of the draw writes the same instances.
+            atomic_store_explicit(&args[draw.args_offset + 1], instance_count, memory_order_relaxed);
+            atomic_store_explicit(&args[draw.args_offset + 4], instance_start, memory_order_relaxed);
+            out_start = draw.out_start +
+                        atomic_fetch_add_explicit(&args[draw.args_offset], cluster.index_count, memory_order_relaxed);
+            draw_index = lo - 1;
+        }
+    }
+    threadgroup_barrier(mem_flags::mem_threadgroup);
+    if (out_start == ~0u)
+        return;
+
+    const device ClusterDraw &draw = draws[draw_index];
+    const device MeshCluster &cluster = clusters[cluster_id];
+    const uint first = draw.index_start + cluster.index_start;
+    for (uint i = thread; i < cluster.index_count; i += threads)
+        culled_indices[out_start + i] = draw.short_indices != 0 ? uint(indices_16[first + i]) : indices_32[first + i];
+}
+
+// Level 0 of the depth pyramid, every texel holds the farthest and so smallest depth of the 2x2 pixels it covers. Reads
+// past the edge are clamped, so the texels of the power of two sized pyramid that lie beyond the depth buffer stay
+// conservative.
+kernel void depth_pyramid_init(depth2d<float, access::read> depth [[texture(0)]],
+                               texture2d<float, access::write> dst [[texture(1)]],
+                               uint2 gid [[thread_position_in_grid]])
+{
+    if (gid.x >= dst.get_width() || gid.y >= dst.get_height())
+        return;
+
+    const uint2 last = uint2(depth.get_width(), depth.get_height()) - 1;
+    const uint2 p = gid * 2;
+    const float d = min(min(depth.read(min(p, last)), depth.read(min(p + uint2(1, 0), last))),
+                        min(depth.read(min(p + uint2(0, 1), last)), depth.read(min(p + 1, last))));
+    dst.write(float4(d), gid);
+}
+
+// Every further level of the depth pyramid keeps the farthest depth of the 2x2 texels below it.
+kernel void depth_pyramid_downsample(texture2d<float, access::read> src [[texture(0)]],
+                                     texture2d<float, access::write> dst [[texture(1)]],
+                                     uint2 gid [[thread_position_in_grid]])
+{
+    if (gid.x >= dst.get_width() || gid.y >= dst.get_height())
+        return;
+
+    // Levels of non-square pyramids reach a width or height of 1 before the other.
+    const uint2 last = uint2(src.get_width(), src.get_height()) - 1;
+    const uint2 p = gid * 2;
+    const float d = min(min(src.read(min(p, last)).x, src.read(min(p + uint2(1, 0), last)).x),
+                        min(src.read(min(p + uint2(0, 1), last)).x, src.read(min(p + 1, last)).x));
+    dst.write(float4(d), gid);
+}
+
+// Weights of the 16 colors a BC7 mode 6 block interpolates between its endpoints, out of 64.
+constant uint bc7_weights[16] = {0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64};
+
+// Writes the low bits of value at position of a 128-bit block and moves past them.
+static void put_bits(thread uint4 &block, thread uint &position, uint value, uint bits)
+{
+    const uint word = position / 32;
+    const uint shift = position % 32;
+    block[word] |= value << shift;
+    if (shift + bits > 32)
+        block[word + 1] |= value >> (32 - shift);
+    position += bits;
+}
+
+// Encodes every 4x4 block of source into a BC7 mode 6 block, whose RGBA endpoints span the principal axis of the
+// colors of the block and whose 16 weights are picked per texel. Source is read undecoded, so sRGB data stays sRGB.
+// Blocks of levels smaller than 4x4 repeat the last row and column.
+kernel void encode_bc7(texture2d<float, access::read> source [[texture(0)]], device uint4 *blocks [[buffer(0)]],
+                       uint2 gid [[thread_position_in_grid]])
+{
+    const uint2 size = uint2(source.get_width(), source.get_height());
+    const uint2 num_blocks = (size + 3) / 4;
+    if (gid.x >= num_blocks.x || gid.y >= num_blocks.y)
+        return;
+
+    float4 texels[16];
+    float4 mean = float4(0.0f);
+    float4 low = float4(255.0f);
+    float4 high = float4(0.0f);
+    for (uint i = 0; i < 16; i++)
+    {
+        texels[i] = round(source.read(min(gid * 4 + uint2(i % 4, i / 4), size - 1)) * 255.0f);
+        mean += texels[i] / 16.0f;
+        low = min(low, texels[i]);
+        high = max(high, texels[i]);
+    }
+
+    // A few power iterations on the covariance of the colors, starting from the diagonal of their bounds.
+    float4x4 covariance = float4x4(0.0f);
+    for (uint i = 0; i < 16; i++)
+    {
+        const float4 d = texels[i] - mean;
+        covariance += float4x4(d * d.x, d * d.y, d * d.z, d * d.w);
+    }
+    float4 axis = high - low;
+    for (uint i = 0; i < 4; i++)
+    {
+        const float length_squared = dot(axis, axis);
+        axis = length_squared > 1e-6f ? axis * rsqrt(length_squared) : float4(0.5f);
+        axis = covariance * axis;
+    }
+    const float length_squared = dot(axis, axis);
+    axis = length_squared > 1e-6f ? axis * rsqrt(length_squared) : float4(0.5f);
+
+    float t_min = 0.0f;
+    float t_max = 0.0f;
+    for (uint i = 0; i < 16; i++)
+    {
+        const float t = dot(texels[i] - mean, axis);
+        t_min = min(t_min, t);
+        t_max = max(t_max, t);
+    }
+
+    // Endpoints are 7 bits per channel and a shared lowest bit each, which is picked to fit them best.
+    const float4 endpoints[2] = {clamp(mean + axis * t_min, 0.0f, 255.0f), clamp(mean + axis * t_max, 0.0f, 255.0f)};
+    uint4 quantized[2];
+    uint p_bits[2];
+    for (uint e = 0; e < 2; e++)
+    {
+        float best = INFINITY;
+        for (uint p = 0; p < 2; p++)
+        {
+            const uint4 q = uint4(clamp(round((endpoints[e] - float(p)) / 2.0f), 0.0f, 127.0f));
+            const float4 d = float4(q * 2 + p) - endpoints[e];
+            if (dot(d, d) < best)
+            {
+                best = dot(d, d);
+                quantized[e] = q;
+                p_bits[e] = p;
+            }
+        }
+    }
+
+    float4 palette[16];
+    const float4 c0 = float4(quantized[0] * 2 + p_bits[0]);
+    const float4 c1 = float4(quantized[1] * 2 + p_bits[1]);
+    for (uint w = 0; w < 16; w++)
+        palette[w] = floor((c0 * float(64 - bc7_weights[w]) + c1 * float(bc7_weights[w]) + 32.0f) / 64.0f);
+
+    uint indices[16];
+    for (uint i = 0; i < 16; i++)
+    {
+        float best = INFINITY;
+        for (uint w = 0; w < 16; w++)
+        {
+            const float4 d = palette[w] - texels[i];
+            if (dot(d, d) < best)
+            {
+                best = dot(d, d);
+                indices[i] = w;
+            }
+        }
+    }
+
+    // The highest bit of the index of the first texel is implied to be 0, the endpoints swap when it is not.
+    const bool swap = indices[0] >= 8;
+    const uint first = swap ? 1 : 0;
+    uint4 block = uint4(0);
+    uint position = 0;
+    put_bits(block, position, 1 << 6, 7);
+    for (uint c = 0; c < 4; c++)
+    {
+        put_bits(block, position, quantized[first][c], 7);
+        put_bits(block, position, quantized[1 - first][c], 7);
+    }
+    put_bits(block, position, p_bits[first], 1);
+    put_bits(block, position, p_bits[1 - first], 1);
+    for (uint i = 0; i < 16; i++)
+        put_bits(block, position, swap ? 15 - indices[i] : indices[i], i == 0 ? 3 : 4);
+    blocks[gid.y * num_blocks.x + gid.x] = block;
+}
+
+struct DrawCommands
+{
+    command_buffer commands [[id(ICB_COMMANDS_ARG_INDEX)]];
+};
+
+// Encodes one draw per thread into the indirect command buffer, pipeline state and buffers are inherited from the
+// render encoder that executes it.
+kernel void encode_draws(const device IndirectDraw *draws [[buffer(0)]], constant uint &num_draws [[buffer(1)]],
+                         const device ushort *indices_16 [[buffer(2)]], const device uint *indices_32 [[buffer(3)]],
+                         device DrawCommands &icb [[buffer(4)]], uint gid [[thread_position_in_grid]])
+{
+    if (gid >= num_draws)
+        return;
+
+    render_command command(icb.commands, gid);
+    const device IndirectDraw &draw = draws[gid];
+    if (draw.instance_count == 0)
+    {
+        command.reset();
+    }
+    else if (draw.index_count == 0)
+    {
+        command.draw_primitives(primitive_type::triangle, draw.vertex_start, draw.vertex_count, draw.instance_count,
+                                draw.instance_start);
+    }
+    else if (draw.short_indices != 0)
+    {
+        command.draw_indexed_primitives(primitive_type::triangle, draw.index_count, indices_16 + draw.index_offset / 2,
+                                        draw.instance_count, draw.vertex_start, draw.instance_start);
+    }
+    else
+    {
+        command.draw_indexed_primitives(primitive_type::triangle, draw.index_count, indices_32 + draw.index_offset / 4,
+                                        draw.instance_count, draw.vertex_start, draw.instance_start);
+    }
+}
+
+// Sort key and number of every culled draw, the upper half of the nearest depth culling found for its slot. Draws
+// that culling left without instances come last.
+kernel void culled_draw_keys(const device CulledIndirectDraw *draws [[buffer(0)]],
+                             constant uint &num_draws [[buffer(1)]], device uint2 *keys [[buffer(2)]],
+                             const device uint *draw_depths [[buffer(3)]], uint gid [[thread_position_in_grid]])
+{
+    if (gid < num_draws)
+        keys[gid] = uint2(draw_depths[draws[gid].depth_slot] >> 16, gid);
+}
+
+// Encodes one culled draw per thread into the indirect command buffer after first_command, once culling wrote the
+// indirect arguments of this frame. Draws that culling left without instances are reset. With counts.z the draws are
+// encoded in the order of their sorted keys, front to back.
+kernel void encode_culled_draws(const device CulledIndirectDraw *draws [[buffer(0)]],
+                                constant uint4 &counts [[buffer(1)]], const device ushort *indices_16 [[buffer(2)]],
+                                const device uint *indices_32 [[buffer(3)]], device DrawCommands &icb [[buffer(4)]],
+                                const device uint *args [[buffer(5)]], const device uint *cluster_args [[buffer(6)]],
+                                const device uint *culled_indices [[buffer(7)]], const device uint2 *keys [[buffer(8)]],
+                                uint gid [[thread_position_in_grid]])
+{
+    const uint num_draws = counts.x;
+    const uint first_command = counts.y;
+    if (gid >= num_draws)
+        return;
+
+    render_command command(icb.commands, first_command + gid);
+    const device CulledIndirectDraw &draw = draws[counts.z != 0 ? keys[gid].y : gid];
+    const device uint *draw_args = (draw.clustered != 0 ? cluster_args : args) + draw.args_offset;
+    if (draw_args[0] == 0 || draw_args[1] == 0)
+    {
+        command.reset();
+    }
+    else if (draw.index_size == 0)
+    {
+        command.draw_primitives(primitive_type::triangle, draw_args[2], draw_args[0], draw_args[1], draw_args[3]);
+    }
+    else if (draw.clustered != 0)
+    {
+        // Indexed arguments hold the first index relative to the index range and the base vertex of the mesh.
+        command.draw_indexed_primitives(primitive_type::triangle, draw_args[0], culled_indices + draw_args[2],
+                                        draw_args[1], draw_args[3], draw_args[4]);
+    }
+    else if (draw.index_size == 2)
+    {
+        command.draw_indexed_primitives(primitive_type::triangle, draw_args[0],
+                                        indices_16 + draw.index_offset / 2 + draw_args[2], draw_args[1], draw_args[3],
+                                        draw_args[4]);
+    }
+    else
+    {
+        command.draw_indexed_primitives(primitive_type::triangle, draw_args[0],
+                                        indices_32 + draw.index_offset / 4 + draw_args[2], draw_args[1], draw_args[3],
+                                        draw_args[4]);
+    }
+}
+
+// Writes the transform of one animated instance per thread into its slot of the instance buffer.
+kernel void animate_instances(const device AnimatedInstance *animated [[buffer(0)]],
+                              constant InstanceAnimationUniforms &uniforms [[buffer(1)]],
+                              device InstanceTransform *instances [[buffer(2)]], uint gid [[thread_position_in_grid]])
+{
+    if (gid >= uniforms.count)
+        return;
+
+    const AnimatedInstance instance = animated[gid];
+    float3 position = instance.position.xyz;
+    float3x3 basis = float3x3(instance.position.w);
+    if (uniforms.type == INSTANCE_ANIMATION_LINEAR)
+    {
+        position += instance.velocity.xyz * uniforms.time;
+    }
+    else
+    {
+        // Tilts around the horizontal axis across the sway direction, instances swaying straight up stay upright.
+        const float3 axis = cross(float3(0.0, 1.0, 0.0), instance.velocity.xyz);
+        const float axis_length = length(axis);
+        if (axis_length > 0.0)
+        {
+            const float3 k = axis / axis_length;
+            const float angle = uniforms.amplitude * sin(uniforms.frequency * uniforms.time + instance.velocity.w);
+            const float s = sin(angle);
+            const float c = cos(angle);
+            const float3x3 cross_k = float3x3(float3(0.0, k.z, -k.y), float3(-k.z, 0.0, k.x), float3(k.y, -k.x, 0.0));
+            basis = (float3x3(1.0) + s * cross_k + (1.0 - c) * (cross_k * cross_k)) * basis;
+        }
+    }
+
+    device InstanceTransform &t = instances[gid];
+    for (uint row = 0; row < 3; row++)
+        t.rows[row] = float4(basis[0][row], basis[1][row], basis[2][row], position[row]);
+}
+
+// Writes the changed local transforms of hierarchy nodes, every node is updated at most once.
+kernel void scatter_hierarchy_locals(const device HierarchyUpdate *updates [[buffer(0)]],
+                                     constant uint &count [[buffer(1)]], device InstanceTransform *locals [[buffer(2)]],
+                                     uint gid [[thread_position_in_grid]])
+{
+    if (gid >= count)
+        return;
+    const device HierarchyUpdate &update = updates[gid];
+    for (uint row = 0; row < 3; row++)
+        locals[update.node].rows[row] = update.rows[row];
+}
+
+// World transforms of the nodes of one depth, level holds its first node and node count. Parents were written by the
+// dispatch of the previous depth.
+kernel void propagate_hierarchy(const device HierarchyLink *links [[buffer(0)]],
+                                const device InstanceTransform *locals [[buffer(1)]],
+                                device InstanceTransform *worlds [[buffer(2)]],
+                                device InstanceTransform *instances [[buffer(3)]], constant uint2 &level [[buffer(4)]],
+                                uint gid [[thread_position_in_grid]])
+{
+    if (gid >= level.y)
+        return;
+
+    const uint node = level.x + gid;
+    const HierarchyLink link = links[node];
+    const InstanceTransform local = locals[node];
+    InstanceTransform world = local;
+    if (link.parent >= 0)
+    {
+        const InstanceTransform parent = worlds[link.parent];
+        for (uint row = 0; row < 3; row++)
+        {
+            const float4 p = parent.rows[row];
+            world.rows[row] =
+                p.x * local.rows[0] + p.y * local.rows[1] + p.z * local.rows[2] + float4(0.0, 0.0, 0.0, p.w);
+        }
+    }
+
+    worlds[node] = world;
+    if (link.target != NO_HIERARCHY_INSTANCE)
+        instances[link.target] = world;
+}
+
+struct SkinJoints
+{
+    uint4 joints;
+    float4 weights;
+};
+
+// Morph targets and linear blend skinning of every group, one thread per output vertex. Groups are sorted by
+// out_start.
+kernel void skin_vertices(const device Vertex3D *vertices [[buffer(0)]],
+                          const device SkinJoints *joints_weights [[buffer(1)]],
+                          const device float4x4 *joint_matrices [[buffer(2)]],
+                          const device SkinningGroup *groups [[buffer(3)]], constant uint2 &counts [[buffer(4)]],
+                          device Vertex3D *anim_vertices [[buffer(5)]],
+                          const device MorphDelta *morph_deltas [[buffer(6)]],
+                          const device uint *morph_offsets [[buffer(7)]],
+                          const device float *morph_weights [[buffer(8)]],
+                          device atomic_uint *skinned_bounds [[buffer(9)]], uint gid [[thread_position_in_grid]])
+{
+    const uint num_groups = counts.x;
+    const uint num_vertices = counts.y;
+    if (gid >= num_vertices)
+        return;
+
+    uint lo = 0;
+    uint hi = num_groups;
+    while (lo < hi)
+    {
+        const uint mid = (lo + hi) / 2;
+        if (groups[mid].out_start <= gid)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+
+    if (lo == 0)
+        return;
+
+    const device SkinningGroup &group = groups[lo - 1];
+    const uint i = gid - group.out_start;
+    if (i >= group.count)
+        return;
+
+    const device Vertex3D &v = vertices[group.vertex_start + i];
+    float3 position = float3(v.v_x, v.v_y, v.v_z);
+    float3 normal = float3(v.n_x, v.n_y, v.n_z);
+    float3 tangent = float3(v.t_x, v.t_y, v.t_z);
+
+    // Deltas move the bind pose, before it is skinned.
+    if (group.morph_start != NO_MORPH_TARGETS && i < morph_offsets[group.morph_start])
+    {
+        const device uint *offsets = morph_offsets + group.morph_start + 1;
+        for (uint d = offsets[i]; d < offsets[i + 1]; d++)
+        {
+            const device MorphDelta &delta = morph_deltas[d];
+            const float weight = morph_weights[group.weight_start + delta.target];
+            position += weight * float3(delta.p_x, delta.p_y, delta.p_z);
+            normal += weight * float3(delta.n_x, delta.n_y, delta.n_z);
+        }
+    }
+
+    if (group.num_joints > 0)
+    {
+        const device SkinJoints &jw = joints_weights[group.jw_start + i];
+        const device float4x4 *matrices = joint_matrices + group.joint_offset;
+        const uint4 joints = min(jw.joints, uint4(group.num_joints - 1));
+
+        const float4x4 skin = matrices[joints.x] * jw.weights.x + matrices[joints.y] * jw.weights.y +
+                              matrices[joints.z] * jw.weights.z + matrices[joints.w] * jw.weights.w;
+        position = (skin * float4(position, 1.0)).xyz;
+        normal = (skin * float4(normal, 0.0)).xyz;
+        tangent = normalize((skin * float4(tangent, 0.0)).xyz);
+    }
+    normal = normalize(normal);
+
+    Vertex3D out = v;
+    out.v_x = position.x;
+    out.v_y = position.y;
+    out.v_z = position.z;
+    out.n_x = normal.x;
+    out.n_y = normal.y;
+    out.n_z = normal.z;
+    out.t_x = tangent.x;
+    out.t_y = tangent.y;
+    out.t_z = tangent.z;
+    anim_vertices[gid] = out;
+
+    // Groups grow their bounds by the skinned positions, the lanes of a SIMD group that all skin the same group reduce
+    // theirs first so only one of them merges them.
+    const uint g = lo - 1;
+    float3 bmin = position;
+    float3 bmax = position;
+    const bool reduced = simd_all(g == simd_broadcast_first(g));
+    if (reduced)
+    {
+        bmin = simd_min(bmin);
+        bmax = simd_max(bmax);
+    }
+    if (!reduced || simd_is_first())
+    {
+        for (uint c = 0; c < 3; c++)
+        {
+            atomic_fetch_min_explicit(&skinned_bounds[g * 4 + c], ordered_float_key(bmin[c]), memory_order_relaxed);
+            atomic_fetch_max_explicit(&skinned_bounds[(num_groups + g) * 4 + c], ordered_float_key(bmax[c]),
+                                      memory_order_relaxed);
+        }
+    }
+}
+
+// Linearly interpolates the keys of a channel at time, rotations take the shorter way and stay normalized.
+float4 sample_keys(const device AnimationKeys &keys, const device float *times, const device float4 *values,
+                   float time, float4 rest, bool rotation)
+{
+    if (keys.num_keys == 0)
+        return rest;
+    const device float *t = times + keys.key_start;
+    const device float4 *v = values + keys.key_start;
+    if (keys.num_keys == 1 || time <= t[0])
+        return v[0];
+    if (time >= t[keys.num_keys - 1])
+        return v[keys.num_keys - 1];
+
+    uint lo = 0;
+    uint hi = keys.num_keys - 1;
+    while (hi - lo > 1)
+    {
+        const uint mid = (lo + hi) / 2;
+        if (t[mid] <= time)
+            lo = mid;
+        else
+            hi = mid;
+    }
+
+    const float f = (time - t[lo]) / max(t[hi] - t[lo], 1e-6);
+    if (!rotation)
+        return mix(v[lo], v[hi], f);
+    return normalize(mix(v[lo], dot(v[lo], v[hi]) < 0.0 ? -v[hi] : v[hi], f));
+}
+
+float4x4 joint_transform(float3 translation, float4 q, float3 scale)
+{
+    const float3x3 r = float3x3(float3(1.0 - 2.0 * (q.y * q.y + q.z * q.z), 2.0 * (q.x * q.y + q.z * q.w),
+                                       2.0 * (q.x * q.z - q.y * q.w)),
+                                float3(2.0 * (q.x * q.y - q.z * q.w), 1.0 - 2.0 * (q.x * q.x + q.z * q.z),
+                                       2.0 * (q.y * q.z + q.x * q.w)),
+                                float3(2.0 * (q.x * q.z + q.y * q.w), 2.0 * (q.y * q.z - q.x * q.w),
+                                       1.0 - 2.0 * (q.x * q.x + q.y * q.y)));
+    return float4x4(float4(r[0] * scale.x, 0.0), float4(r[1] * scale.y, 0.0), float4(r[2] * scale.z, 0.0),
+                    float4(translation, 1.0));
+}
+
+// Samples and blends the layers of every animated skin, one threadgroup per skin. Local poses are propagated down the
+// hierarchy one depth at a time, then multiplied with the inverse bind matrices into the skin's joint matrices.
+kernel void animate_skins(const device SkinAnimation *skins [[buffer(0)]],
+                          const device SkeletonJoint *skeleton_joints [[buffer(1)]],
+                          const device AnimationKeys *channels [[buffer(2)]], const device float *times [[buffer(3)]],
+                          const device float4 *values [[buffer(4)]], device float4x4 *joint_matrices [[buffer(5)]],
+                          uint skin_index [[threadgroup_position_in_grid]], uint tid [[thread_position_in_threadgroup]],
+                          uint num_threads [[threads_per_threadgroup]])
+{
+    threadgroup float4x4 globals[MAX_SKELETON_JOINTS];
+    const device SkinAnimation &skin = skins[skin_index];
+    const device SkeletonJoint *joints = skeleton_joints + skin.skeleton_start;
+
+    for (uint j = tid; j < skin.num_joints; j += num_threads)
+    {
+        const device SkeletonJoint &joint = joints[j];
+        float3 translation = joint.translation.xyz;
+        float4 rotation = joint.rotation;
+        float3 scale = joint.scale.xyz;
+        if (skin.num_layers > 0)
+        {
+            translation = float3(0.0);
+            rotation = float4(0.0);
+            scale = float3(0.0);
+        }
+
+        for (uint l = 0; l < skin.num_layers; l++)
+        {
+            const AnimationLayerState layer = skin.layers[l];
+            float4 t = joint.translation;
+            float4 r = joint.rotation;
+            float4 s = joint.scale;
+            if (j < layer.num_joints)
+            {
+                const device AnimationKeys *keys = channels + layer.channel_start + j * 3;
+                t = sample_keys(keys[0], times, values, layer.time, t, false);
+                r = sample_keys(keys[1], times, values, layer.time, r, true);
+                s = sample_keys(keys[2], times, values, layer.time, s, false);
+            }
+            translation += layer.weight * t.xyz;
+            rotation += layer.weight * (l > 0 && dot(rotation, r) < 0.0 ? -r : r);
+            scale += layer.weight * s.xyz;
+        }
+
+        globals[j] = joint_transform(translation, normalize(rotation), scale);
+    }
+
+    // Parents of a depth were finished by the previous level.
+    for (uint level = 1; level < skin.num_levels; level++)
+    {
+        threadgroup_barrier(mem_flags::mem_threadgroup);
+        for (uint j = tid; j < skin.num_joints; j += num_threads)
+        {
+            if (joints[j].depth == level)
+                globals[j] = globals[joints[j].parent] * globals[j];
+        }
+    }
+
+    for (uint j = tid; j < skin.num_joints; j += num_threads)
+        joint_matrices[skin.matrix_offset + j] = globals[j] * joints[j].inverse_bind;
+}
+
+float3 unproject(float4x4 inv_projection, float2 ndc, float depth)
+{
+    const float4 p = inv_projection * float4(ndc, depth, 1.0);
+    return p.xyz / p.w;
+}
+
+// Squared distance between two boxes, 0 when they overlap.
+float box_distance_squared(float3 a_min, float3 a_max, float3 b_min, float3 b_max)
+{
+    const float3 d = max(max(a_min - b_max, b_min - a_max), 0.0);
+    return dot(d, d);
+}
+
+// Builds the light list of one screen tile per threadgroup. The depth range of the tile comes from the depth pre-pass,
+// lights are tested as spheres against the view space bounding box of the tile's frustum slice. The area lights are
+// found by walking the light tree breadth first, every level tests the nodes of a queue against the world space box of
+// the slice and queues the children of the nodes whose range reaches it.
+kernel void cull_lights(depth2d<float, access::read> depth [[texture(0)]], constant LightUniforms &lights [[buffer(0)]],
+                        const device PointLight *point_lights [[buffer(1)]],
+                        const device SpotLight *spot_lights [[buffer(2)]], device uint *tile_lights [[buffer(3)]],
+                        constant rasterization_rate_map_data *rates [[buffer(4), function_constant(rate_mapped)]],
+                        const device LightTreeNode *light_tree [[buffer(5)]], uint2 gid [[thread_position_in_grid]],
+                        uint2 tile [[threadgroup_position_in_grid]], uint tid [[thread_index_in_threadgroup]])
+{
+    threadgroup atomic_uint depth_min;
+    threadgroup atomic_uint depth_max;
+    threadgroup atomic_uint count;
+    threadgroup uint queues[2][LIGHT_TREE_QUEUE];
+    threadgroup atomic_uint queue_sizes[2];
+
+    if (tid == 0)
+    {
+        atomic_store_explicit(&depth_min, as_type<uint>(1.0f), memory_order_relaxed);
+        atomic_store_explicit(&depth_max, 0u, memory_order_relaxed);
+        atomic_store_explicit(&count, 0u, memory_order_relaxed);
+    }
+    threadgroup_barrier(mem_flags::mem_threadgroup);
+
+    // Depth is a positive float, so its bits order the same way as its value.
+    if (gid.x < lights.width && gid.y < lights.height)
+    {
+        const uint d = as_type<uint>(depth.read(gid));
+        atomic_fetch_min_explicit(&depth_min, d, memory_order_relaxed);
+        atomic_fetch_max_explicit(&depth_max, d, memory_order_relaxed);
+    }
+    threadgroup_barrier(mem_flags::mem_threadgroup);
+
+    // Pixels without geometry are infinitely far at a depth of 0, tiles end at a depth that is far but finite.
+    const float d_min = max(as_type<float>(atomic_load_explicit(&depth_min, memory_order_relaxed)), 1e-6);
+    const float d_max = max(as_type<float>(atomic_load_explicit(&depth_max, memory_order_relaxed)), 1e-6);
+
+    // Tiles of a rate mapped pass cover physical pixels, their frustum spans the screen region those are stretched to.
+    const float2 size = float2(lights.width, lights.height);
+    float2 lo = float2(tile * LIGHT_TILE_SIZE);
+    float2 hi = float2((tile + 1) * LIGHT_TILE_SIZE);
+    if (rate_mapped)
+    {
+        const rasterization_rate_map_decoder map(*rates);
+        lo = map.map_physical_to_screen_coordinates(lo);
+        hi = map.map_physical_to_screen_coordinates(hi);
+    }
+    lo = lo / size;
+    hi = min(hi / size, 1.0);
+    float3 bmin = float3(INFINITY);
+    float3 bmax = float3(-INFINITY);
+    float3 world_min = float3(INFINITY);
+    float3 world_max = float3(-INFINITY);
+    for (uint i = 0; i < 8; i++)
+    {
+        const float2 uv = float2((i & 1) != 0 ? hi.x : lo.x, (i & 2) != 0 ? hi.y : lo.y);
+        const float2 ndc = float2(uv.x * 2.0 - 1.0, 1.0 - uv.y * 2.0);
+        const float d = (i & 4) != 0 ? d_max : d_min;
+        const float3 corner = unproject(lights.inv_projection, ndc, d);
+        bmin = min(bmin, corner);
+        bmax = max(bmax, corner);
+        const float3 world = unproject(lights.inv_combined, ndc, d);
+        world_min = min(world_min, world);
+        world_max = max(world_max, world);
+    }
+
+    device uint *list = tile_lights + (tile.y * lights.tiles_x + tile.x) * LIGHT_TILE_STRIDE;
+    const uint num_lights = lights.num_point_lights + lights.num_spot_lights;
+    for (uint i = tid; i < num_lights; i += LIGHT_TILE_SIZE * LIGHT_TILE_SIZE)
+    {
+        float3 position;
+        float3 radiance;
+        if (i < lights.num_point_lights)
+        {
+            const device PointLight &light = point_lights[i];
+            position = float3(light.pos_x, light.pos_y, light.pos_z);
+            radiance = float3(light.radiance_r, light.radiance_g, light.radiance_b);
+        }
+        else
+        {
+            const device SpotLight &light = spot_lights[i - lights.num_point_lights];
+            position = float3(light.pos_x, light.pos_y, light.pos_z);
+            radiance = float3(light.radiance_r, light.radiance_g, light.radiance_b);
+        }
+
+        const float3 center = (lights.view * float4(position, 1.0)).xyz;
+        const float range = light_range(radiance);
+        const float3 closest = clamp(center, bmin, bmax);
+        if (distance_squared(closest, center) > range * range)
+            continue;
+
+        const uint slot = atomic_fetch_add_explicit(&count, 1, memory_order_relaxed);
+        if (slot < MAX_LIGHTS_PER_TILE)
+            list[1 + slot] = i;
+    }
+
+    // Every thread reads the queue size after the barrier that ends a level, so all of them take the same path. Nodes
+    // beyond the capacity of a queue are dropped, like lights beyond the capacity of a tile.
+    if (lights.num_area_lights > 0)
+    {
+        if (tid == 0)
+        {
+            queues[0][0] = 0;
+            atomic_store_explicit(&queue_sizes[0], 1u, memory_order_relaxed);
+            atomic_store_explicit(&queue_sizes[1], 0u, memory_order_relaxed);
+        }
+        threadgroup_barrier(mem_flags::mem_threadgroup);
+
+        for (uint level = 0;; level++)
+        {
+            const uint current = level % 2;
+            const uint size = min(atomic_load_explicit(&queue_sizes[current], memory_order_relaxed),
+                                  uint(LIGHT_TREE_QUEUE));
+            if (size == 0)
+                break;
+
+            for (uint i = tid; i < size; i += LIGHT_TILE_SIZE * LIGHT_TILE_SIZE)
+            {
+                const LightTreeNode node = light_tree[queues[current][i]];
+                const float range = node.bmax.w;
+                if (box_distance_squared(node.bmin.xyz, node.bmax.xyz, world_min, world_max) > range * range)
+                    continue;
+
+                if (node.right == LIGHT_TREE_LEAF)
+                {
+                    const uint slot = atomic_fetch_add_explicit(&count, 1, memory_order_relaxed);
+                    if (slot < MAX_LIGHTS_PER_TILE)
+                        list[1 + slot] = num_lights + node.left;
+                    continue;
+                }
+
+                const uint slot = atomic_fetch_add_explicit(&queue_sizes[1 - current], 2u, memory_order_relaxed);
+                if (slot + 1 < LIGHT_TREE_QUEUE)
+                {
+                    queues[1 - current][slot] = node.left;
+                    queues[1 - current][slot + 1] = node.right;
+                }
+            }
+            threadgroup_barrier(mem_flags::mem_threadgroup);
+            if (tid == 0)
+                atomic_store_explicit(&queue_sizes[current], 0u, memory_order_relaxed);
+            threadgroup_barrier(mem_flags::mem_threadgroup);
+        }
+    }
+    threadgroup_barrier(mem_flags::mem_threadgroup);
+
+    if (tid == 0)
+        list[0] = min(atomic_load_explicit(&count, memory_order_relaxed), uint(MAX_LIGHTS_PER_TILE));
+}
+
+// Morton code of every area light's center, with the index of the light.
+uint expand_bits(uint v)
+{
+    v = (v * 0x00010001u) & 0xFF0000FFu;
+    v = (v * 0x00000101u) & 0x0F00F00Fu;
+    v = (v * 0x00000011u) & 0xC30C30C3u;
+    v = (v * 0x00000005u) & 0x49249249u;
+    return v;
+}
+
+kernel void light_tree_keys(const device AreaLight *area_lights [[buffer(0)]], device uint2 *keys [[buffer(1)]],
+                            constant LightTreeUniforms &uniforms [[buffer(3)]], uint i [[thread_position_in_grid]])
+{
+    if (i >= uniforms.count)
+        return;
+
+    const device AreaLight &light = area_lights[i];
+    const float3 center = float3(light.pos_x, light.pos_y, light.pos_z);
+    const uint3 q = uint3(clamp((center - uniforms.center_min.xyz) * uniforms.center_scale.xyz, 0.0, 1023.0));
+    keys[i] = uint2(expand_bits(q.x) * 4 + expand_bits(q.y) * 2 + expand_bits(q.z), i);
+}
+
+// Length of the common prefix of the sorted keys i and j, keys that are equal are told apart by their positions. -1
+// outside of the keys. Only every stride-th key counts, in groups of stride keys the first stands for the others.
+int common_prefix(const device uint2 *keys, int count, int i, int j, int stride = 1)
+{
+    if (j < 0 || j >= count)
+        return -1;
+    const uint a = keys[i * stride].x;
+    const uint b = keys[j * stride].x;
+    return a == b ? 32 + int(clz(uint(i ^ j))) : int(clz(a ^ b));
+}
+
+// Keys from lo to hi internal node i of a tree over n sorted keys covers, its range reaches either way from i. The
+// range is split after gamma, where the common prefix of the keys gets longer than that of the range (Karras 2012).
+void lbvh_node_range(const device uint2 *keys, int n, int i, int stride, thread int &lo, thread int &hi,
+                     thread int &gamma)
+{
+    const int d = common_prefix(keys, n, i, i + 1, stride) > common_prefix(keys, n, i, i - 1, stride) ? 1 : -1;
+    const int prefix_min = common_prefix(keys, n, i, i - d, stride);
+    int length_max = 2;
+    while (common_prefix(keys, n, i, i + length_max * d, stride) > prefix_min)
+        length_max *= 2;
+    int length = 0;
+    for (int t = length_max / 2; t >= 1; t /= 2)
+    {
+        if (common_prefix(keys, n, i, i + (length + t) * d, stride) > prefix_min)
+            length += t;
+    }
+    const int last = i + length * d;
+
+    const int prefix = common_prefix(keys, n, i, last, stride);
+    int split = 0;
+    for (int t = length;;)
+    {
+        t = (t + 1) / 2;
+        if (common_prefix(keys, n, i, i + (split + t) * d, stride) > prefix)
+            split += t;
+        if (t <= 1)
+            break;
+    }
+    gamma = i + split * d + min(d, 0);
+    lo = min(i, last);
+    hi = max(i, last);
+}
+
+// Power and range of an area light, which bound its node.
+float light_power(const device AreaLight &light)
+{
+    const float3 radiance = float3(light.radiance_r, light.radiance_g, light.radiance_b) * light.area;
+    return dot(radiance, float3(0.2126, 0.7152, 0.0722));
+}
+
+void bound_light(const device AreaLight &light, thread float4 &bmin, thread float4 &bmax)
+{
+    const float3 v0 = float3(light.vertex0_x, light.vertex0_y, light.vertex0_z);
+    const float3 v1 = float3(light.vertex1_x, light.vertex1_y, light.vertex1_z);
+    const float3 v2 = float3(light.vertex2_x, light.vertex2_y, light.vertex2_z);
+    const float range = light_range(float3(light.radiance_r, light.radiance_g, light.radiance_b) * light.area);
+    bmin = float4(min(bmin.xyz, min(v0, min(v1, v2))), bmin.w + light_power(light));
+    bmax = float4(max(bmax.xyz, max(v0, max(v1, v2))), max(bmax.w, range));
+}
+
+// Node i of the light tree, internal node i covers the sorted lights from i to the end of its range, which reaches
+// either way, and splits them where their common prefix gets longer than that of the range (Karras 2012). Internal
+// nodes bound their lights themselves, so no node waits for its children.
+kernel void build_light_tree(const device AreaLight *area_lights [[buffer(0)]], const device uint2 *keys [[buffer(1)]],
+                             device LightTreeNode *nodes [[buffer(2)]],
+                             constant LightTreeUniforms &uniforms [[buffer(3)]], uint i [[thread_position_in_grid]])
+{
+    const int n = int(uniforms.count);
+    if (int(i) >= 2 * n - 1)
+        return;
+
+    LightTreeNode node;
+    node.bmin = float4(float3(INFINITY), 0.0);
+    node.bmax = float4(float3(-INFINITY), 0.0);
+    node.pad0 = 0;
+    node.pad1 = 0;
+    if (int(i) >= n - 1)
+    {
+        node.left = keys[int(i) - (n - 1)].y;
+        node.right = LIGHT_TREE_LEAF;
+        bound_light(area_lights[node.left], node.bmin, node.bmax);
+        nodes[i] = node;
+        return;
+    }
+
+    int lo, hi, gamma;
+    lbvh_node_range(keys, n, int(i), 1, lo, hi, gamma);
+    node.left = uint(lo == gamma ? gamma + n - 1 : gamma);
+    node.right = uint(hi == gamma + 1 ? gamma + n : gamma + 1);
+    for (int j = lo; j <= hi; j++)
+        bound_light(area_lights[keys[j].y], node.bmin, node.bmax);
+    nodes[i] = node;
+}
+
+// World space center and extent of the instance in slot gid of the culled draws, false for slots of no draw.
+bool instance_slot_bounds(const device InstanceTransform *instances, const device CullDraw *draws, uint num_draws,
+                          uint gid, thread float3 &center, thread float3 &extent)
+{
+    const uint d = cull_draw_index(draws, num_draws, gid);
+    if (d == num_draws)
+        return false;
+
+    const device CullDraw &draw = draws[d];
+    const float4x4 m = instance_matrix(instances[draw.instance_start + gid - draw.visible_start]);
+    center = (m * float4(draw.center.xyz, 1.0)).xyz;
+    extent = abs(m[0].xyz) * draw.extent.x + abs(m[1].xyz) * draw.extent.y + abs(m[2].xyz) * draw.extent.z;
+    return true;
+}
+
+kernel void reset_instance_bvh(device InstanceBvhCounters &counters [[buffer(4)]])
+{
+    counters.center_min = uint4(~0u);
+    counters.center_max = uint4(0u);
+    counters.refit.threadgroups[0] = 0;
+    counters.refit.threadgroups[1] = 1;
+    counters.refit.threadgroups[2] = 1;
+}
+
+// Bounds of the centers of all instance slots, as ordered float keys in the words of center_min and center_max.
+kernel void bound_instance_bvh_centers(const device InstanceTransform *instances [[buffer(0)]],
+                                       const device CullDraw *draws [[buffer(1)]],
+                                       device atomic_uint *counters [[buffer(4)]],
+                                       constant InstanceBvhUniforms &bvh [[buffer(5)]],
+                                       uint gid [[thread_position_in_grid]])
+{
+    float3 center, extent;
+    if (gid >= bvh.num_slots || !instance_slot_bounds(instances, draws, bvh.num_draws, gid, center, extent))
+        return;
+    for (uint c = 0; c < 3; c++)
+    {
+        atomic_fetch_min_explicit(&counters[c], ordered_float_key(center[c]), memory_order_relaxed);
+        atomic_fetch_max_explicit(&counters[4 + c], ordered_float_key(center[c]), memory_order_relaxed);
+    }
+}
+
+// Morton code of the center of every instance slot with the slot, slots of no draw sort last.
+kernel void instance_bvh_keys(const device InstanceTransform *instances [[buffer(0)]],
+                              const device CullDraw *draws [[buffer(1)]], device uint2 *keys [[buffer(2)]],
+                              const device InstanceBvhCounters &counters [[buffer(4)]],
+                              constant InstanceBvhUniforms &bvh [[buffer(5)]], uint gid [[thread_position_in_grid]])
+{
+    if (gid >= bvh.num_slots)
+        return;
+
+    float3 center, extent;
+    if (!instance_slot_bounds(instances, draws, bvh.num_draws, gid, center, extent))
+    {
+        keys[gid] = uint2(0x3FFFFFFFu, gid);
+        return;
+    }
+    const float3 lo = float3(ordered_float_value(counters.center_min.x), ordered_float_value(counters.center_min.y),
+                             ordered_float_value(counters.center_min.z));
+    const float3 hi = float3(ordered_float_value(counters.center_max.x), ordered_float_value(counters.center_max.y),
+                             ordered_float_value(counters.center_max.z));
+    const uint3 q = uint3(clamp((center - lo) * (1023.0 / max(hi - lo, 1e-6)), 0.0, 1023.0));
+    keys[gid] = uint2(expand_bits(q.x) * 4 + expand_bits(q.y) * 2 + expand_bits(q.z), gid);
+}
+
+// Internal node i of the instance tree over the sorted clusters, which are told apart by the key of their first slot.
+// Bounds are added by bound_instance_bvh_nodes once the clusters are bound.
+kernel void build_instance_bvh(const device uint2 *keys [[buffer(2)]], device InstanceBvhNode *nodes [[buffer(3)]],
+                               constant InstanceBvhUniforms &bvh [[buffer(5)]], uint i [[thread_position_in_grid]])
+{
+    const int n = int(bvh.num_clusters);
+    if (int(i) >= n - 1)
+        return;
+
+    int lo, hi, gamma;
+    lbvh_node_range(keys, n, int(i), INSTANCE_BVH_CLUSTER_SIZE, lo, hi, gamma);
+    device InstanceBvhNode &node = nodes[i];
+    node.left = uint(lo == gamma ? gamma + n - 1 : gamma);
+    node.right = uint(hi == gamma + 1 ? gamma + n : gamma + 1);
+    node.first = uint(lo);
+    node.count = uint(hi - lo + 1);
+}
+
+// Lists the clusters of the moved slots for refitting, every cluster once.
+kernel void mark_instance_bvh_moved(device InstanceBvhCounters &counters [[buffer(4)]],
+                                    constant InstanceBvhUniforms &bvh [[buffer(5)]],
+                                    const device uint *positions [[buffer(6)]], device uint *refit [[buffer(7)]],
+                                    device atomic_uint *dirty [[buffer(8)]], const device uint *moved [[buffer(9)]],
+                                    uint gid [[thread_position_in_grid]])
+{
+    if (gid >= bvh.num_moved || moved[gid] >= bvh.num_slots)
+        return;
+
+    const uint cluster = positions[moved[gid]] / INSTANCE_BVH_CLUSTER_SIZE;
+    if (atomic_exchange_explicit(&dirty[cluster], 1u, memory_order_relaxed) != 0)
+        return;
+    device atomic_uint *count = reinterpret_cast<device atomic_uint *>(&counters.refit.threadgroups[0]);
+    refit[atomic_fetch_add_explicit(count, 1u, memory_order_relaxed)] = cluster;
+}
+
+// Leaf bounds of every cluster, or of those on the refit list, one SIMD group per threadgroup and cluster. Every slot
+// also records its sorted position, so slots that move find their cluster.
+kernel void bound_instance_bvh_clusters(const device InstanceTransform *instances [[buffer(0)]],
+                                        const device CullDraw *draws [[buffer(1)]],
+                                        const device uint2 *keys [[buffer(2)]],
+                                        device InstanceBvhNode *nodes [[buffer(3)]],
+                                        constant InstanceBvhUniforms &bvh [[buffer(5)]],
+                                        device uint *positions [[buffer(6)]], const device uint *refit [[buffer(7)]],
+                                        device uint *dirty [[buffer(8)]], uint group [[threadgroup_position_in_grid]],
+                                        uint lane [[thread_index_in_simdgroup]],
+                                        uint simd_width [[threads_per_simdgroup]])
+{
+    const uint cluster = bvh.listed != 0 ? refit[group] : group;
+    if (cluster >= bvh.num_clusters)
+        return;
+
+    float3 bmin = float3(INFINITY);
+    float3 bmax = float3(-INFINITY);
+    const uint end = min((cluster + 1) * INSTANCE_BVH_CLUSTER_SIZE, bvh.num_slots);
+    for (uint sorted = cluster * INSTANCE_BVH_CLUSTER_SIZE + lane; sorted < end; sorted += simd_width)
+    {
+        const uint slot = keys[sorted].y;
+        positions[slot] = sorted;
+        float3 center, extent;
+        if (instance_slot_bounds(instances, draws, bvh.num_draws, slot, center, extent))
+        {
+            bmin = min(bmin, center - extent);
+            bmax = max(bmax, center + extent);
+        }
+    }
+    bmin = simd_min(bmin);
+    bmax = simd_max(bmax);
+    if (lane != 0)
+        return;
+
+    device InstanceBvhNode &leaf = nodes[bvh.num_clusters - 1 + cluster];
+    leaf.bmin = float4(bmin, 0.0);
+    leaf.bmax = float4(bmax, 0.0);
+    leaf.left = cluster;
+    leaf.right = INSTANCE_BVH_LEAF;
+    leaf.first = cluster;
+    leaf.count = 1;
+    dirty[cluster] = 0;
+}
+
+// Bounds of every internal node from the leaves of its clusters, one SIMD group per threadgroup and node, so no node
+// waits for its children.
+kernel void bound_instance_bvh_nodes(device InstanceBvhNode *nodes [[buffer(3)]],
+                                     constant InstanceBvhUniforms &bvh [[buffer(5)]],
+                                     uint group [[threadgroup_position_in_grid]],
+                                     uint lane [[thread_index_in_simdgroup]],
+                                     uint simd_width [[threads_per_simdgroup]])
+{
+    if (group + 1 >= bvh.num_clusters)
+        return;
+
+    const uint first = bvh.num_clusters - 1 + nodes[group].first;
+    const uint end = first + nodes[group].count;
+    float3 bmin = float3(INFINITY);
+    float3 bmax = float3(-INFINITY);
+    for (uint leaf = first + lane; leaf < end; leaf += simd_width)
+    {
+        bmin = min(bmin, nodes[leaf].bmin.xyz);
+        bmax = max(bmax, nodes[leaf].bmax.xyz);
+    }
+    bmin = simd_min(bmin);
+    bmax = simd_max(bmax);
+    if (lane == 0)
+    {
+        nodes[group].bmin = float4(bmin, 0.0);
+        nodes[group].bmax = float4(bmax, 0.0);
+    }
+}
+
+// -1 when bounds are outside of the view frustum of uniforms, 1 when they are inside of all of its planes and 0 when
+// they cross one. Empty bounds are outside.
+int frustum_classify(constant CullUniforms &uniforms, float3 bmin, float3 bmax)
+{
+    if (any(bmin > bmax))
+        return -1;
+
+    const float3 center = (bmin + bmax) * 0.5;
+    const float3 extent = (bmax - bmin) * 0.5;
+    int result = 1;
+    for (uint i = 0; i < 6; i++)
+    {
+        const float4 plane = uniforms.planes[i];
+        const float offset = dot(plane.xyz, center) + plane.w;
+        const float radius = dot(abs(plane.xyz), extent);
+        if (offset + radius < 0.0)
+            return -1;
+        if (offset - radius < 0.0)
+            result = 0;
+    }
+    return result;
+}
+
+// Walks the instance tree top-down for the view of uniforms in one threadgroup, a level of nodes at a time. Nodes
+// outside the view are dropped with their subtrees, nodes inside it pass that on to their subtrees without testing
+// them. The clusters reached are listed for cull_bvh_instances, which gets a threadgroup for each. Every level holds at
+// most as many nodes as there are clusters, which is the size of both queues.
+kernel void traverse_instance_bvh(constant CullUniforms &uniforms [[buffer(1)]], device uint *clusters [[buffer(7)]],
+                                  const device InstanceBvhNode *nodes [[buffer(8)]],
+                                  device InstanceBvhCounters &counters [[buffer(9)]],
+                                  constant InstanceBvhUniforms &bvh [[buffer(10)]], device uint *queues [[buffer(11)]],
+                                  uint tid [[thread_index_in_threadgroup]], uint threads [[threads_per_threadgroup]])
+{
+    threadgroup atomic_uint queue_sizes[2];
+    threadgroup atomic_uint listed;
+    if (tid == 0)
+    {
+        queues[0] = 0;
+        atomic_store_explicit(&queue_sizes[0], 1u, memory_order_relaxed);
+        atomic_store_explicit(&queue_sizes[1], 0u, memory_order_relaxed);
+        atomic_store_explicit(&listed, 0u, memory_order_relaxed);
+    }
+    threadgroup_barrier(mem_flags::mem_device | mem_flags::mem_threadgroup);
+
+    for (uint current = 0;; current = 1 - current)
+    {
+        const uint size = atomic_load_explicit(&queue_sizes[current], memory_order_relaxed);
+        if (size == 0)
+            break;
+
+        device uint *queue = queues + current * bvh.num_clusters;
+        device uint *next = queues + (1 - current) * bvh.num_clusters;
+        for (uint i = tid; i < size; i += threads)
+        {
+            const uint entry = queue[i];
+            const device InstanceBvhNode &node = nodes[entry & ~INSTANCE_BVH_INSIDE];
+            uint inside = entry & INSTANCE_BVH_INSIDE;
+            if (inside == 0)
+            {
+                const int test = frustum_classify(uniforms, node.bmin.xyz, node.bmax.xyz);
+                if (test < 0)
+                    continue;
+                inside = test > 0 ? INSTANCE_BVH_INSIDE : 0;
+            }
+
+            if (node.right == INSTANCE_BVH_LEAF)
+            {
+                clusters[atomic_fetch_add_explicit(&listed, 1u, memory_order_relaxed)] = node.first | inside;
+                continue;
+            }
+            const uint slot = atomic_fetch_add_explicit(&queue_sizes[1 - current], 2u, memory_order_relaxed);
+            next[slot] = node.left | inside;
+            next[slot + 1] = node.right | inside;
+        }
+        threadgroup_barrier(mem_flags::mem_device | mem_flags::mem_threadgroup);
+        if (tid == 0)
+            atomic_store_explicit(&queue_sizes[current], 0u, memory_order_relaxed);
+        threadgroup_barrier(mem_flags::mem_threadgroup);
+    }
+
+    if (tid == 0)
+    {
+        counters.visible.threadgroups[0] = atomic_load_explicit(&listed, memory_order_relaxed);
+        counters.visible.threadgroups[1] = 1;
+        counters.visible.threadgroups[2] = 1;
+    }
+}
+
+constant uint AO_RAYS = 8;
+
+// World position of the pre-pass depth at the center of pixel.
+float3 depth_position(depth2d<float, access::read> depth, constant LightUniforms &lights, uint2 pixel)
+{
+    const float2 ndc = float2((pixel.x + 0.5) / lights.width * 2.0 - 1.0, 1.0 - (pixel.y + 0.5) / lights.height * 2.0);
+    const float4 p = lights.inv_combined * float4(ndc, depth.read(pixel), 1.0);
+    return p.xyz / p.w;
+}
+
+// The shorter of the differences to both neighbours, so normals don't bend across depth discontinuities. Differences
+// to a neighbour outside the texture are zero.
+float3 shorter_difference(float3 a, float3 b)
+{
+    const float length_a = length_squared(a);
+    const float length_b = length_squared(b);
+    return length_b == 0.0 || (length_a > 0.0 && length_a < length_b) ? a : b;
+}
+
+// Compute BVH of GPUs without ray tracing support, see bvh_scene.hpp.
+struct BvhScene
+{
+    const device BvhNode *top_nodes [[id(BVH_TOP_NODES_ARG_INDEX)]];
+    const device BvhInstance *instances [[id(BVH_INSTANCES_ARG_INDEX)]];
+    const device BvhNode *nodes [[id(BVH_NODES_ARG_INDEX)]];
+    const device BvhTriangle *triangles [[id(BVH_TRIANGLES_ARG_INDEX)]];
+};
+
+// Nodes a traversal still has to visit, deeper ones are dropped.
+constant uint BVH_STACK_SIZE = 32;
+
+// Reciprocal of a direction without infinities, which would turn slabs the ray lies in into NaN.
+float3 bvh_inverse(float3 direction)
+{
+    return 1.0 / select(direction, copysign(float3(1e-20), direction), abs(direction) < 1e-20);
+}
+
+// Child slots of a node the ray enters between min_t and max_t, sorted by the distance it enters them at with the
+// slot in the low two bits. Slots it misses sort last as ~0u.
+uint4 bvh_children(const device BvhNode &node, float3 origin, float3 inverse_direction, float min_t, float max_t)
+{
+    const float4 x0 = (node.min_x - origin.x) * inverse_direction.x;
+    const float4 x1 = (node.max_x - origin.x) * inverse_direction.x;
+    const float4 y0 = (node.min_y - origin.y) * inverse_direction.y;
+    const float4 y1 = (node.max_y - origin.y) * inverse_direction.y;
+    const float4 z0 = (node.min_z - origin.z) * inverse_direction.z;
+    const float4 z1 = (node.max_z - origin.z) * inverse_direction.z;
+    const float4 entry = max(max(min(x0, x1), min(y0, y1)), max(min(z0, z1), float4(min_t)));
+    const float4 exit = min(min(max(x0, x1), max(y0, y1)), min(max(z0, z1), float4(max_t)));
+
+    // Entry distances are positive, their bits sort like the distances.
+    uint4 keys = select(uint4(~0u), (as_type<uint4>(entry) & ~3u) | uint4(0, 1, 2, 3),
+                        entry <= exit && node.children >= 0);
+    keys.xy = uint2(min(keys.x, keys.y), max(keys.x, keys.y));
+    keys.zw = uint2(min(keys.z, keys.w), max(keys.z, keys.w));
+    keys.xz = uint2(min(keys.x, keys.z), max(keys.x, keys.z));
+    keys.yw = uint2(min(keys.y, keys.w), max(keys.y, keys.w));
+    keys.yz = uint2(min(keys.y, keys.z), max(keys.y, keys.z));
+    return keys;
+}
+
+// Moeller-Trumbore intersection of a ray with a triangle, t and barycentrics get the hit when it is closer than t.
+bool bvh_triangle(const device BvhTriangle &triangle, float3 origin, float3 direction, float min_t, thread float &t,
+                  thread float2 &barycentrics)
+{
+    const float3 e1 = triangle.e1.xyz;
+    const float3 e2 = triangle.e2.xyz;
+    const float3 h = cross(direction, e2);
+    const float a = dot(e1, h);
+    if (a == 0.0)
+        return false;
+
+    const float f = 1.0 / a;
+    const float3 s = origin - triangle.v0.xyz;
+    const float3 q = cross(s, e1);
+    const float u = f * dot(s, h);
+    const float v = f * dot(direction, q);
+    const float hit_t = f * dot(e2, q);
+    if (u < 0.0 || v < 0.0 || u + v > 1.0 || hit_t < min_t || hit_t >= t)
+        return false;
+
+    t = hit_t;
+    barycentrics = float2(u, v);
+    return true;
+}
+
+// Traverses the BVH of a mesh from root with a ray in the space of the mesh, its distances are the ones of the world
+// space ray as the direction is not normalized. Leaves are tested as soon as the ray enters them, nearest first.
+bool bvh_mesh(const device BvhScene &bvh, uint root, float3 origin, float3 direction, float min_t, thread float &t,
+              thread uint &primitive, thread float2 &barycentrics, bool any_hit)
+{
+    const float3 inverse_direction = bvh_inverse(direction);
+    uint stack[BVH_STACK_SIZE];
+    uint size = 1;
+    stack[0] = root;
+    bool found = false;
+    while (size > 0)
+    {
+        const device BvhNode &node = bvh.nodes[stack[--size]];
+        const uint4 keys = bvh_children(node, origin, inverse_direction, min_t, t);
+        for (uint k = 0; k < 4 && keys[k] != ~0u; k++)
+        {
+            const uint slot = keys[k] & 3;
+            if (node.counts[slot] < 0)
+                continue;
+            const uint first = uint(node.children[slot]);
+            for (uint i = first; i < first + uint(node.counts[slot]); i++)
+            {
+                if (bvh_triangle(bvh.triangles[i], origin, direction, min_t, t, barycentrics))
+                {
+                    primitive = as_type<uint>(bvh.triangles[i].v0.w);
+                    found = true;
+                    if (any_hit)
+                        return true;
+                }
+            }
+        }
+
+        // Farthest first, so the nearest is visited next.
+        for (int k = 3; k >= 0; k--)
+        {
+            const uint slot = keys[k] & 3;
+            if (keys[k] != ~0u && node.counts[slot] < 0 && as_type<float>(keys[k] & ~3u) < t &&
+                size < BVH_STACK_SIZE)
+                stack[size++] = uint(node.children[slot]);
+        }
+    }
+    return found;
+}
+
+// Closest hit of a ray with the instances of the compute BVH, or the first one found with any_hit.
+PathHit bvh_intersect(const device BvhScene &bvh, float3 origin, float3 direction, float min_t, float max_t,
+                      bool any_hit)
+{
+    PathHit hit;
+    hit.instance = ~0u;
+    hit.primitive = 0;
+    hit.distance = max_t;
+    hit.barycentrics = 0;
+
+    const float3 inverse_direction = bvh_inverse(direction);
+    uint stack[BVH_STACK_SIZE];
+    uint size = 1;
+    stack[0] = 0;
+    while (size > 0)
+    {
+        const device BvhNode &node = bvh.top_nodes[stack[--size]];
+        const uint4 keys = bvh_children(node, origin, inverse_direction, min_t, hit.distance);
+        for (uint k = 0; k < 4 && keys[k] != ~0u; k++)
+        {
+            const uint slot = keys[k] & 3;
+            if (node.counts[slot] < 0)
+                continue;
+            const uint first = uint(node.children[slot]);
+            for (uint i = first; i < first + uint(node.counts[slot]); i++)
+            {
+                const device BvhInstance &instance = bvh.instances[i];
+                const float3 o = float3(dot(instance.inverse[0], float4(origin, 1.0)),
+                                        dot(instance.inverse[1], float4(origin, 1.0)),
+                                        dot(instance.inverse[2], float4(origin, 1.0)));
+                const float3 d = float3(dot(instance.inverse[0].xyz, direction),
+                                        dot(instance.inverse[1].xyz, direction),
+                                        dot(instance.inverse[2].xyz, direction));
+                uint primitive;
+                float2 barycentrics;
+                if (bvh_mesh(bvh, instance.root, o, d, min_t, hit.distance, primitive, barycentrics, any_hit))
+                {
+                    hit.instance = instance.instance;
+                    hit.primitive = primitive;
+                    hit.barycentrics = pack_float_to_unorm2x16(barycentrics);
+                    if (any_hit)
+                        return hit;
+                }
+            }
+        }
+
+        for (int k = 3; k >= 0; k--)
+        {
+            const uint slot = keys[k] & 3;
+            if (keys[k] != ~0u && node.counts[slot] < 0 && as_type<float>(keys[k] & ~3u) < hit.distance &&
+                size < BVH_STACK_SIZE)
+                stack[size++] = uint(node.children[slot]);
+        }
+    }
+    return hit;
+}
+
+// Closest hit of a ray with the scene, or the first one found with any_hit, against the acceleration structure on GPUs
+// with ray tracing support and the compute BVH on the others. Only the one of the variant is bound.
+PathHit trace_ray(raytracing::instance_acceleration_structure structure, const device BvhScene &bvh, float3 origin,
+                  float3 direction, float min_distance, float max_distance, bool any_hit)
+{
+    if (software_tracing)
+        return bvh_intersect(bvh, origin, direction, min_distance, max_distance, any_hit);
+
+    const raytracing::ray r(origin, direction, min_distance, max_distance);
+    raytracing::intersector<raytracing::instancing, raytracing::triangle_data> intersector;
+    intersector.accept_any_intersection(any_hit);
+    const auto result = intersector.intersect(r, structure);
+
+    PathHit hit;
+    hit.instance = result.type == raytracing::intersection_type::none ? ~0u : result.instance_id;
+    hit.primitive = result.primitive_id;
+    hit.distance = result.distance;
+    hit.barycentrics = pack_float_to_unorm2x16(result.triangle_barycentric_coord);
+    return hit;
+}
+
+// Whether a ray reaches max_distance without hitting anything.
+bool trace_unoccluded(raytracing::instance_acceleration_structure structure, const device BvhScene &bvh, float3 origin,
+                      float3 direction, float min_distance, float max_distance)
+{
+    if (software_tracing)
+        return bvh_intersect(bvh, origin, direction, min_distance, max_distance, true).instance == ~0u;
+
+    const raytracing::ray r(origin, direction, min_distance, max_distance);
+    raytracing::intersector<raytracing::instancing> intersector;
+    intersector.accept_any_intersection(true);
+    return intersector.intersect(r, structure).type == raytracing::intersection_type::none;
+}
+
+// Traces the shadow of the first directional light and the ambient occlusion of every pixel of the pre-pass depth
+// against the acceleration structures of the scene, shadow is written to x and occlusion to y.
+kernel void trace_shadows(depth2d<float, access::read> depth [[texture(0)]],
+                          texture2d<half, access::write> ray_traced [[texture(1)]],
+                          constant LightUniforms &lights [[buffer(0)]],
+                          const device DirectionalLight *directional_lights [[buffer(1)]],
+                          raytracing::instance_acceleration_structure scene
+                          [[buffer(2), function_constant(hardware_tracing)]],
+                          const device BvhScene &bvh
+                          [[buffer(BVH_SCENE_BUFFER_INDEX), function_constant(software_tracing)]],
+                          uint2 gid [[thread_position_in_grid]])
+{
+    if (gid.x >= lights.width || gid.y >= lights.height)
+        return;
+    if (depth.read(gid) <= 0.0)
+    {
+        ray_traced.write(half4(1.0), gid);
+        return;
+    }
+
+    const float3 p = depth_position(depth, lights, gid);
+    const uint2 last = uint2(lights.width - 1, lights.height - 1);
+    const float3 dx = shorter_difference(depth_position(depth, lights, uint2(min(gid.x + 1, last.x), gid.y)) - p,
+                                         p - depth_position(depth, lights, uint2(max(gid.x, 1u) - 1, gid.y)));
+    const float3 dy = shorter_difference(depth_position(depth, lights, uint2(gid.x, min(gid.y + 1, last.y))) - p,
+                                         p - depth_position(depth, lights, uint2(gid.x, max(gid.y, 1u) - 1)));
+    float3 n = normalize(cross(dx, dy));
+    const float3 to_camera = lights.camera_position.xyz - p;
+    if (dot(n, to_camera) < 0.0)
+        n = -n;
+
+    // Rays start off the surface by an offset that grows with the distance, like the precision of the depth.
+    const float3 origin = p + n * (1e-3 * max(length(to_camera), 1.0));
+
+    float shadow = 1.0;
+    if (lights.num_directional_lights > 0)
+    {
+        const device DirectionalLight &light = directional_lights[0];
+        const float3 l = -normalize(float3(light.direction_x, light.direction_y, light.direction_z));
+        if (dot(l, n) <= 0.0 || !trace_unoccluded(scene, bvh, origin, l, 0.0, INFINITY))
+            shadow = 0.0;
+    }
+
+    // Cosine weighted directions around the normal from the R2 sequence, shifted by interleaved gradient noise so
+    // neighbouring pixels sample different directions.
+    const float3 t = normalize(cross(n, abs(n.x) > 0.5 ? float3(0.0, 1.0, 0.0) : float3(1.0, 0.0, 0.0)));
+    const float3 b = cross(n, t);
+    const float noise = fract(52.9829189 * fract(dot(float2(gid), float2(0.06711056, 0.00583715))));
+    uint unoccluded = 0;
+    for (uint i = 0; i < AO_RAYS; i++)
+    {
+        const float2 u = fract(noise + float2(0.7548776662, 0.5698402910) * float(i + 1));
+        const float radius = sqrt(u.x);
+        const float phi = 2.0 * M_PI_F * u.y;
+        const float3 direction = t * (radius * cos(phi)) + b * (radius * sin(phi)) + n * sqrt(1.0 - u.x);
+        if (trace_unoccluded(scene, bvh, origin, direction, 0.0, lights.ao_radius))
+            unoccluded++;
+    }
+
+    ray_traced.write(half4(shadow, float(unoccluded) / AO_RAYS, 0.0, 0.0), gid);
+}
+
+// Distance from p to the closest point of the triangle abc, found like in Real-Time Collision Detection by the region
+// of the triangle p projects into.
+float triangle_distance(float3 p, float3 a, float3 b, float3 c)
+{
+    const float3 ab = b - a;
+    const float3 ac = c - a;
+    const float3 ap = p - a;
+    const float d1 = dot(ab, ap);
+    const float d2 = dot(ac, ap);
+    if (d1 <= 0.0 && d2 <= 0.0)
+        return distance(p, a);
+
+    const float3 bp = p - b;
+    const float d3 = dot(ab, bp);
+    const float d4 = dot(ac, bp);
+    if (d3 >= 0.0 && d4 <= d3)
+        return distance(p, b);
+    const float vc = d1 * d4 - d3 * d2;
+    if (vc <= 0.0 && d1 >= 0.0 && d3 <= 0.0)
+        return distance(p, a + ab * (d1 / (d1 - d3)));
+
+    const float3 cp = p - c;
+    const float d5 = dot(ab, cp);
+    const float d6 = dot(ac, cp);
+    if (d6 >= 0.0 && d5 <= d6)
+        return distance(p, c);
+    const float vb = d5 * d2 - d1 * d6;
+    if (vb <= 0.0 && d2 >= 0.0 && d6 <= 0.0)
+        return distance(p, a + ac * (d2 / (d2 - d6)));
+    const float va = d3 * d6 - d5 * d4;
+    if (va <= 0.0 && d4 - d3 >= 0.0 && d5 - d6 >= 0.0)
+        return distance(p, b + (c - b) * ((d4 - d3) / ((d4 - d3) + (d5 - d6))));
+
+    const float scale = 1.0 / max(va + vb + vc, FLT_MIN);
+    return distance(p, a + ab * (vb * scale) + ac * (vc * scale));
+}
+
+// Whether the ray from p along direction crosses the triangle at a, spanned by e1 and e2.
+bool crosses_triangle(float3 p, float3 direction, float3 a, float3 e1, float3 e2)
+{
+    const float3 h = cross(direction, e2);
+    const float det = dot(e1, h);
+    if (det == 0.0)
+        return false;
+    const float f = 1.0 / det;
+    const float3 s = p - a;
+    const float u = f * dot(s, h);
+    if (u < 0.0 || u > 1.0)
+        return false;
+    const float3 q = cross(s, e1);
+    const float v = f * dot(direction, q);
+    return v >= 0.0 && u + v <= 1.0 && f * dot(e2, q) > 0.0;
+}
+
+// Mesh space center of a voxel of a field.
+float3 mesh_sdf_position(SdfVolume volume, uint voxel)
+{
+    const uint3 cell = uint3(voxel % volume.size.x, voxel / volume.size.x % volume.size.y,
+                             voxel / (volume.size.x * volume.size.y));
+    return volume.origin.xyz + (float3(cell) + 0.5) * volume.origin.w;
+}
+
+// Stores the distance to the closest triangle, negative inside the mesh. Points inside closed meshes cross their
+// surface an odd number of times along every axis, the majority of the three axes decides for meshes with holes.
+void store_mesh_sdf(device half *fields, SdfVolume volume, uint voxel, float closest, uint3 crossings)
+{
+    const uint3 odd = crossings & 1;
+    const float signed_distance = odd.x + odd.y + odd.z >= 2 ? -closest : closest;
+    fields[volume.size.w + voxel] = half(clamp(signed_distance, -HALF_MAX, HALF_MAX));
+}
+
+// Voxels of the field of a mesh from its vertices, one per thread, for meshes that were set without RTTriangles. Each
+// one takes the distance to the closest of all triangles.
+kernel void generate_mesh_sdf(const device Vertex3D *vertices [[buffer(0)]], const device uchar *indices [[buffer(1)]],
+                              constant SdfMeshUniforms &uniforms [[buffer(2)]], device half *fields [[buffer(3)]],
+                              uint gid [[thread_position_in_grid]])
+{
+    if (gid >= uniforms.num_voxels)
+        return;
+
+    const SdfVolume volume = uniforms.volume;
+    const uint voxel = uniforms.first_voxel + gid;
+    const float3 p = mesh_sdf_position(volume, voxel);
+
+    const device uchar *index_data = indices + uniforms.index_offset;
+    float closest = INFINITY;
+    uint3 crossings = uint3(0);
+    for (uint i = 0; i < uniforms.num_triangles; i++)
+    {
+        uint3 triangle = i * 3 + uint3(0, 1, 2);
+        if (uniforms.index_size == 2)
+        {
+            const device ushort *short_indices = reinterpret_cast<const device ushort *>(index_data);
+            triangle = uint3(short_indices[triangle.x], short_indices[triangle.y], short_indices[triangle.z]);
+        }
+        else if (uniforms.index_size == 4)
+        {
+            const device uint *word_indices = reinterpret_cast<const device uint *>(index_data);
+            triangle = uint3(word_indices[triangle.x], word_indices[triangle.y], word_indices[triangle.z]);
+        }
+        triangle += uniforms.vertex_start;
+
+        const device Vertex3D &v0 = vertices[triangle.x];
+        const device Vertex3D &v1 = vertices[triangle.y];
+        const device Vertex3D &v2 = vertices[triangle.z];
+        const float3 a = float3(v0.v_x, v0.v_y, v0.v_z);
+        const float3 b = float3(v1.v_x, v1.v_y, v1.v_z);
+        const float3 c = float3(v2.v_x, v2.v_y, v2.v_z);
+        closest = min(closest, triangle_distance(p, a, b, c));
+        crossings.x += crosses_triangle(p, float3(1.0, 0.0, 0.0), a, b - a, c - a) ? 1 : 0;
+        crossings.y += crosses_triangle(p, float3(0.0, 1.0, 0.0), a, b - a, c - a) ? 1 : 0;
+        crossings.z += crosses_triangle(p, float3(0.0, 0.0, 1.0), a, b - a, c - a) ? 1 : 0;
+    }
+
+    store_mesh_sdf(fields, volume, voxel, closest, crossings);
+}
+
+// Voxels of the field of a mesh from the corners of its RTTriangles, three per triangle, like generate_mesh_sdf.
+kernel void generate_triangle_sdf(const device packed_float3 *positions [[buffer(0)]],
+                                  constant SdfMeshUniforms &uniforms [[buffer(2)]], device half *fields [[buffer(3)]],
+                                  uint gid [[thread_position_in_grid]])
+{
+    if (gid >= uniforms.num_voxels)
+        return;
+
+    const SdfVolume volume = uniforms.volume;
+    const uint voxel = uniforms.first_voxel + gid;
+    const float3 p = mesh_sdf_position(volume, voxel);
+
+    float closest = INFINITY;
+    uint3 crossings = uint3(0);
+    for (uint i = 0; i < uniforms.num_triangles; i++)
+    {
+        const float3 a = float3(positions[i * 3]);
+        const float3 b = float3(positions[i * 3 + 1]);
+        const float3 c = float3(positions[i * 3 + 2]);
+        closest = min(closest, triangle_distance(p, a, b, c));
+        crossings.x += crosses_triangle(p, float3(1.0, 0.0, 0.0), a, b - a, c - a) ? 1 : 0;
+        crossings.y += crosses_triangle(p, float3(0.0, 1.0, 0.0), a, b - a, c - a) ? 1 : 0;
+        crossings.z += crosses_triangle(p, float3(0.0, 0.0, 1.0), a, b - a, c - a) ? 1 : 0;
+    }
+    store_mesh_sdf(fields, volume, voxel, closest, crossings);
+}
+
+// Copies voxels of a field that was built before, from a scene cache, into the field buffer.
+kernel void copy_mesh_sdf(const device half *source [[buffer(0)]], constant SdfMeshUniforms &uniforms [[buffer(2)]],
+                          device half *fields [[buffer(3)]], uint gid [[thread_position_in_grid]])
+{
+    if (gid >= uniforms.num_voxels)
+        return;
+
+    const uint voxel = uniforms.first_voxel + gid;
+    fields[uniforms.volume.size.w + voxel] = source[voxel];
+}
+
+float mesh_sdf_voxel(const device half *fields, SdfVolume volume, uint3 cell)
+{
+    return float(fields[volume.size.w + cell.x + volume.size.x * (cell.y + volume.size.y * cell.z)]);
+}
+
+// World space distance from p to the mesh of an instance, filtered between the voxels of its field. Points outside of
+// the field add their distance to it.
+float instance_sdf_distance(const device SdfInstance &instance, SdfVolume volume, const device half *fields, float3 p)
+{
+    const float4 world = float4(p, 1.0);
+    const float3 local = float3(dot(instance.inverse[0], world), dot(instance.inverse[1], world),
+                                dot(instance.inverse[2], world));
+    const float size = volume.origin.w;
+    const float3 first = volume.origin.xyz + 0.5 * size;
+    const float3 inside = clamp(local, first, first + float3(volume.size.xyz - 1) * size);
+    const float3 x = (inside - first) / size;
+    const uint3 c0 = min(uint3(x), volume.size.xyz - 1);
+    const uint3 c1 = min(c0 + 1, volume.size.xyz - 1);
+    const float3 f = x - float3(c0);
+
+    const float d00 = mix(mesh_sdf_voxel(fields, volume, c0), mesh_sdf_voxel(fields, volume, uint3(c1.x, c0.y, c0.z)),
+                          f.x);
+    const float d10 = mix(mesh_sdf_voxel(fields, volume, uint3(c0.x, c1.y, c0.z)),
+                          mesh_sdf_voxel(fields, volume, uint3(c1.x, c1.y, c0.z)), f.x);
+    const float d01 = mix(mesh_sdf_voxel(fields, volume, uint3(c0.x, c0.y, c1.z)),
+                          mesh_sdf_voxel(fields, volume, uint3(c1.x, c0.y, c1.z)), f.x);
+    const float d11 = mix(mesh_sdf_voxel(fields, volume, uint3(c0.x, c1.y, c1.z)), mesh_sdf_voxel(fields, volume, c1),
+                          f.x);
+    const float d = mix(mix(d00, d10, f.y), mix(d01, d11, f.y), f.z);
+    return (d + distance(local, inside)) * instance.scale;
+}
+
+// Voxels of a region of a clipmap level, one per thread. Instances whose bounds are farther away than the closest
+// distance found so far are skipped.
+kernel void update_sdf_clipmap(const device SdfInstance *instances [[buffer(0)]],
+                               const device uint *listed [[buffer(1)]],
+                               constant SdfRegionUniforms &uniforms [[buffer(2)]],
+                               const device SdfVolume *volumes [[buffer(3)]], const device half *fields [[buffer(4)]],
+                               texture3d<half, access::write> level [[texture(0)]],
+                               uint3 gid [[thread_position_in_grid]])
+{
+    if (any(gid >= uniforms.size.xyz))
+        return;
+
+    const int3 cell = uniforms.first_cell.xyz + int3(gid);
+    const float3 p = (float3(cell) + 0.5) * uniforms.voxel_size;
+    float closest = uniforms.band;
+    for (uint i = 0; i < uniforms.num_instances; i++)
+    {
+        const device SdfInstance &instance = instances[listed[i]];
+        const float3 outside = max(max(instance.bmin.xyz - p, p - instance.bmax.xyz), 0.0);
+        if (length(outside) >= closest)
+            continue;
+        closest = min(closest, instance_sdf_distance(instance, volumes[instance.volume], fields, p));
+    }
+
+    const int3 wrapped = (cell % int(SDF_CLIPMAP_SIZE) + int(SDF_CLIPMAP_SIZE)) % int(SDF_CLIPMAP_SIZE);
+    level.write(half4(closest), uint3(wrapped));
+}
+
+constant uint SDF_SHADOW_STEPS = 64;
+constant uint SDF_AO_DIRECTIONS = 5;
+constant uint SDF_AO_STEPS = 4;
+
+// Distance to the scene at p in the finest clipmap level that holds it with a voxel to spare for filtering, and the
+// voxel size of that level. Points outside of every level are at least the band of the coarsest one away.
+float clipmap_distance(array<texture3d<half>, SDF_CLIPMAP_LEVELS> levels, constant SdfTraceUniforms &uniforms, float3 p,
+                       thread float &voxel_size)
+{
+    // Voxels are stored modulo the level size, so repeating addresses filter across the wrap.
+    constexpr sampler linear(filter::linear, address::repeat);
+    float size = uniforms.voxel_size;
+    for (uint l = 0; l < SDF_CLIPMAP_LEVELS; l++, size *= 2.0)
+    {
+        const float3 cell = p / size - float3(uniforms.windows[l].xyz);
+        if (all(cell >= 1.0) && all(cell <= float(SDF_CLIPMAP_SIZE - 1)))
+        {
+            voxel_size = size;
+            return levels[l].sample(linear, p / (size * SDF_CLIPMAP_SIZE)).x;
+        }
+    }
+    voxel_size = size * 0.5;
+    return SDF_BAND_VOXELS * voxel_size;
+}
+
+// Visibility of the light along l from origin, sphere traced through the clipmap. The penumbra closes where the
+// distance to the scene gets small relative to the distance travelled, like in Quilez's soft shadows.
+float sdf_soft_shadow(array<texture3d<half>, SDF_CLIPMAP_LEVELS> levels, constant SdfTraceUniforms &uniforms,
+                      float3 origin, float3 l)
+{
+    const float max_distance = uniforms.voxel_size * float(1u << (SDF_CLIPMAP_LEVELS - 1)) * SDF_CLIPMAP_SIZE;
+    float visible = 1.0;
+    float t = 0.0;
+    for (uint i = 0; i < SDF_SHADOW_STEPS && t < max_distance; i++)
+    {
+        float size;
+        const float d = clipmap_distance(levels, uniforms, origin + l * t, size);
+        visible = min(visible, d / (uniforms.softness * max(t, size)));
+        if (visible <= 0.01)
+            return 0.0;
+        t += max(d, 0.25 * size);
+    }
+    return smoothstep(0.0, 1.0, visible);
+}
+
+// Soft shadow of the first directional light and ambient occlusion of the pre-pass depth, traced through the
+// clipmap and written like those of trace_shadows. Occlusion compares the distance to the scene at points along the
+// normal and cosine weighted directions with their distance from the surface, the points double their distance up to
+// the occlusion distance.
+kernel void trace_sdf_shadows(depth2d<float, access::read> depth [[texture(0)]],
+                              texture2d<half, access::write> ray_traced [[texture(1)]],
+                              array<texture3d<half>, SDF_CLIPMAP_LEVELS> levels [[texture(2)]],
+                              constant LightUniforms &lights [[buffer(0)]],
+                              const device DirectionalLight *directional_lights [[buffer(1)]],
+                              constant SdfTraceUniforms &uniforms [[buffer(2)]], uint2 gid [[thread_position_in_grid]])
+{
+    if (gid.x >= lights.width || gid.y >= lights.height)
+        return;
+    if (depth.read(gid) <= 0.0)
+    {
+        ray_traced.write(half4(1.0), gid);
+        return;
+    }
+
+    const float3 p = depth_position(depth, lights, gid);
+    const uint2 last = uint2(lights.width - 1, lights.height - 1);
+    const float3 dx = shorter_difference(depth_position(depth, lights, uint2(min(gid.x + 1, last.x), gid.y)) - p,
+                                         p - depth_position(depth, lights, uint2(max(gid.x, 1u) - 1, gid.y)));
+    const float3 dy = shorter_difference(depth_position(depth, lights, uint2(gid.x, min(gid.y + 1, last.y))) - p,
+                                         p - depth_position(depth, lights, uint2(gid.x, max(gid.y, 1u) - 1)));
+    float3 n = normalize(cross(dx, dy));
+    if (dot(n, lights.camera_position.xyz - p) < 0.0)
+        n = -n;
+
+    // The fields are no finer than their voxels, rays start a voxel and a half off the surface to leave it.
+    float voxel_size;
+    clipmap_distance(levels, uniforms, p, voxel_size);
+    const float3 origin = p + n * (1.5 * voxel_size);
+
+    float shadow = 1.0;
+    if (lights.num_directional_lights > 0)
+    {
+        const device DirectionalLight &light = directional_lights[0];
+        const float3 l = -normalize(float3(light.direction_x, light.direction_y, light.direction_z));
+        shadow = dot(l, n) <= 0.0 ? 0.0 : sdf_soft_shadow(levels, uniforms, origin, l);
+    }
+
+    const float3 t = normalize(cross(n, abs(n.x) > 0.5 ? float3(0.0, 1.0, 0.0) : float3(1.0, 0.0, 0.0)));
+    const float3 b = cross(n, t);
+    const float noise = fract(52.9829189 * fract(dot(float2(gid), float2(0.06711056, 0.00583715))));
+    float occlusion = 0.0;
+    for (uint i = 0; i < SDF_AO_DIRECTIONS; i++)
+    {
+        float3 direction = n;
+        if (i > 0)
+        {
+            const float2 u = fract(noise + float2(0.7548776662, 0.5698402910) * float(i));
+            const float radius = sqrt(u.x);
+            const float phi = 2.0 * M_PI_F * u.y;
+            direction = t * (radius * cos(phi)) + b * (radius * sin(phi)) + n * sqrt(1.0 - u.x);
+        }
+        for (uint s = 0; s < SDF_AO_STEPS; s++)
+        {
+            const float h = uniforms.ao_distance * exp2(float(s) - float(SDF_AO_STEPS - 1));
+            float size;
+            const float d = clipmap_distance(levels, uniforms, origin + direction * h, size);
+            // Levels keep no distances beyond their band, which says nothing about points farther from the surface.
+            const float reach = min(h, SDF_BAND_VOXELS * size);
+            occlusion += saturate((reach - d) / reach);
+        }
+    }
+
+    ray_traced.write(half4(shadow, 1.0 - occlusion / (SDF_AO_DIRECTIONS * SDF_AO_STEPS), 0.0, 0.0), gid);
+}
+
+// Screen space ambient occlusion of every 2x2 block of the pre-pass depth. Cosine weighted points within the occlusion
+// radius around the surface are occluded when the depth at their pixel is closer to the camera. Normals are
+// reconstructed from the depth, as the pre-pass writes nothing else.
+kernel void compute_ssao(depth2d<float, access::read> depth [[texture(0)]],
+                         texture2d<half, access::write> occlusion [[texture(1)]],
+                         constant LightUniforms &lights [[buffer(0)]], constant SsaoUniforms &uniforms [[buffer(1)]],
+                         uint2 gid [[thread_position_in_grid]])
+{
+    if (gid.x >= uniforms.width || gid.y >= uniforms.height)
+        return;
+
+    const uint2 last = uint2(lights.width - 1, lights.height - 1);
+    const uint2 pixel = min(gid * 2, last);
+    if (depth.read(pixel) <= 0.0)
+    {
+        occlusion.write(half4(1.0, HALF_MAX, 0.0, 0.0), gid);
+        return;
+    }
+
+    const float3 p = depth_position(depth, lights, pixel);
+    const float3 dx = shorter_difference(depth_position(depth, lights, uint2(min(pixel.x + 1, last.x), pixel.y)) - p,
+                                         p - depth_position(depth, lights, uint2(max(pixel.x, 1u) - 1, pixel.y)));
+    const float3 dy = shorter_difference(depth_position(depth, lights, uint2(pixel.x, min(pixel.y + 1, last.y))) - p,
+                                         p - depth_position(depth, lights, uint2(pixel.x, max(pixel.y, 1u) - 1)));
+    float3 n = normalize(cross(dx, dy));
+    const float3 camera = lights.camera_position.xyz;
+    const float distance = length(camera - p);
+    if (dot(n, camera - p) < 0.0)
+        n = -n;
+
+    // The same sequence as the traced occlusion, points get denser close to the surface. The blur averages the noise.
+    const float3 t = normalize(cross(n, abs(n.x) > 0.5 ? float3(0.0, 1.0, 0.0) : float3(1.0, 0.0, 0.0)));
+    const float3 b = cross(n, t);
+    const float noise = fract(52.9829189 * fract(dot(float2(gid), float2(0.06711056, 0.00583715))));
+    const float bias = 1e-3 * max(distance, 1.0);
+    float occluded = 0.0;
+    for (uint i = 0; i < SSAO_SAMPLES; i++)
+    {
+        const float2 u = fract(noise + float2(0.7548776662, 0.5698402910) * float(i + 1));
+        const float radius = sqrt(u.x);
+        const float phi = 2.0 * M_PI_F * u.y;
+        const float scale = mix(0.1, 1.0, float(i + 1) / SSAO_SAMPLES);
+        const float3 direction = t * (radius * cos(phi)) + b * (radius * sin(phi)) + n * sqrt(1.0 - u.x);
+        const float3 sample_position = p + direction * (lights.ao_radius * scale);
+
+        const float4 clip = uniforms.combined * float4(sample_position, 1.0);
+        if (clip.w <= 0.0)
+            continue;
+        const float2 uv = clip.xy / clip.w * float2(0.5, -0.5) + 0.5;
+        if (any(uv < 0.0) || any(uv >= 1.0))
+            continue;
+
+        // Geometry further away than the radius does not occlude, the falloff avoids halos around silhouettes.
+        const float3 scene = depth_position(depth, lights, uint2(uv * float2(lights.width, lights.height)));
+        const float range = saturate(lights.ao_radius / max(length(scene - p), 1e-4));
+        if (length(camera - scene) < length(camera - sample_position) - bias)
+            occluded += range * range;
+    }
+
+    occlusion.write(half4(1.0 - occluded / SSAO_SAMPLES, min(distance, float(HALF_MAX)), 0.0, 0.0), gid);
+}
+
+// Separable bilateral blur of the occlusion, along rows while horizontal is non-zero and along columns otherwise.
+// Every group reads its line of texels and their borders into threadgroup memory once, texels at a different distance
+// to the camera than the center are weighted down so occlusion doesn't bleed across edges.
+kernel void ssao_blur(texture2d<half, access::read> source [[texture(0)]],
+                      texture2d<half, access::write> destination [[texture(1)]],
+                      constant uint &horizontal [[buffer(0)]], uint2 group [[threadgroup_position_in_grid]],
+                      uint tid [[thread_index_in_threadgroup]])
+{
+    threadgroup half2 line[SSAO_GROUP_SIZE + 2 * SSAO_BLUR_RADIUS];
+    const int2 size = int2(source.get_width(), source.get_height());
+    const int2 along = horizontal != 0 ? int2(1, 0) : int2(0, 1);
+    const int2 origin = along * int(group.x * SSAO_GROUP_SIZE) + (int2(1) - along) * int(group.y);
+    for (uint i = tid; i < SSAO_GROUP_SIZE + 2 * SSAO_BLUR_RADIUS; i += SSAO_GROUP_SIZE)
+    {
+        const int2 texel = clamp(origin + along * (int(i) - SSAO_BLUR_RADIUS), int2(0), size - 1);
+        line[i] = source.read(uint2(texel)).xy;
+    }
+    threadgroup_barrier(mem_flags::mem_threadgroup);
+
+    const int2 texel = origin + along * int(tid);
+    if (any(texel >= size))
+        return;
+
+    const float center = float(line[tid + SSAO_BLUR_RADIUS].y);
+    float sum = 0.0;
+    float weight = 0.0;
+    for (int i = -SSAO_BLUR_RADIUS; i <= SSAO_BLUR_RADIUS; i++)
+    {
+        const half2 s = line[int(tid) + SSAO_BLUR_RADIUS + i];
+        const float w = exp(-float(i * i) / (0.5 * SSAO_BLUR_RADIUS * SSAO_BLUR_RADIUS)) *
+                        exp(-abs(float(s.y) - center) / (0.05 * center + 1e-3));
+        sum += float(s.x) * w;
+        weight += w;
+    }
+    destination.write(half4(sum / weight, center, 0.0, 0.0), uint2(texel));
+}
+
+// Random numbers of the path tracer, the same generators as in the gpu-rt backend.
+uint wang_hash(uint s)
+{
+    s = (s ^ 61u) ^ (s >> 16u);
+    s *= 9u;
+    s = s ^ (s >> 4u);
+    s *= 0x27d4eb2du;
+    s = s ^ (s >> 15u);
+    return s;
+}
+
+float random_float(thread uint &s)
+{
+    s ^= s << 13;
+    s ^= s >> 17;
+    s ^= s << 5;
+    return float(s) * 2.3283064365387e-10;
+}
+
+DispatchArguments path_dispatch(uint count)
+{
+    DispatchArguments args;
+    args.threadgroups[0] = (count + PATH_TRACER_GROUP_SIZE - 1) / PATH_TRACER_GROUP_SIZE;
+    args.threadgroups[1] = 1;
+    args.threadgroups[2] = 1;
+    return args;
+}
+
+// Uniformly distributed point in the unit sphere.
+float3 random_in_sphere(thread uint &seed)
+{
+    const float z = random_float(seed) * 2.0 - 1.0;
+    const float phi = random_float(seed) * 2.0 * M_PI_F;
+    const float r = sqrt(max(1.0 - z * z, 0.0));
+    return float3(r * cos(phi), r * sin(phi), z) * pow(random_float(seed), 1.0 / 3.0);
+}
+
+// World position of the depth at texel, drawn with the inverse of inv_combined.
+float3 depth_position(depth2d<float, access::read> depth, float4x4 inv_combined, uint2 texel)
+{
+    const float2 uv = (float2(texel) + 0.5) / float2(depth.get_width(), depth.get_height());
+    return unproject(inv_combined, uv * float2(2.0, -2.0) + float2(-1.0, 1.0), depth.read(texel));
+}
+
+// Takes a slot off the dead stack for every particle that is emitted and appends it to the current alive list. Threads
+// that find the stack empty put their slot back.
+kernel void emit_particles(device Particle *particles [[buffer(0)]], device uint *alive [[buffer(1)]],
+                           const device uint *dead [[buffer(2)]], device ParticleCounters &counters [[buffer(3)]],
+                           constant ParticleEmitter &emitter [[buffer(4)]],
+                           constant ParticleUniforms &uniforms [[buffer(5)]], uint gid [[thread_position_in_grid]])
+{
+    if (gid >= uniforms.emit)
+        return;
+
+    device atomic_int *dead_count = reinterpret_cast<device atomic_int *>(&counters.dead);
+    const int slot = atomic_fetch_sub_explicit(dead_count, 1, memory_order_relaxed) - 1;
+    if (slot < 0)
+    {
+        atomic_fetch_add_explicit(dead_count, 1, memory_order_relaxed);
+        return;
+    }
+
+    uint seed = wang_hash(uniforms.seed + gid * 9781u) | 1u;
+    Particle p;
+    p.position = float4(emitter.position.xyz + random_in_sphere(seed) * emitter.position.w, 0.0);
+    p.velocity = float4(emitter.velocity.xyz + random_in_sphere(seed) * emitter.velocity.w, emitter.lifetime);
+    const uint index = dead[slot];
+    particles[index] = p;
+
+    device atomic_uint *count = reinterpret_cast<device atomic_uint *>(&counters.alive[uniforms.list]);
+    alive[uniforms.list * uniforms.capacity + atomic_fetch_add_explicit(count, 1, memory_order_relaxed)] = index;
+}
+
+// Sizes the simulation of the current alive list and empties the list it compacts the survivors into.
+kernel void prepare_particles(device ParticleCounters &counters [[buffer(3)]],
+                              constant ParticleUniforms &uniforms [[buffer(5)]])
+{
+    counters.alive[1 - uniforms.list] = 0;
+    counters.simulate.threadgroups[0] = (counters.alive[uniforms.list] + PARTICLE_GROUP_SIZE - 1) / PARTICLE_GROUP_SIZE;
+    counters.simulate.threadgroups[1] = 1;
+    counters.simulate.threadgroups[2] = 1;
+}
+
+// Ages and moves the particles of the current alive list. Dead particles go back on the dead stack, the others are
+// appended to the next list. Colliding particles that moved behind the depth of the previous frame from in front of it
+// bounce off the surface, whose normal is reconstructed from neighbouring depths.
+kernel void simulate_particles(device Particle *particles [[buffer(0)]], device uint *alive [[buffer(1)]],
+                               device uint *dead [[buffer(2)]], device ParticleCounters &counters [[buffer(3)]],
+                               constant ParticleEmitter &emitter [[buffer(4)]],
+                               constant ParticleUniforms &uniforms [[buffer(5)]],
+                               depth2d<float, access::read> depth [[texture(0)]], uint gid [[thread_position_in_grid]])
+{
+    if (gid >= counters.alive[uniforms.list])
+        return;
+
+    const uint index = alive[uniforms.list * uniforms.capacity + gid];
+    Particle p = particles[index];
+    const float dt = uniforms.delta_time;
+    p.position.w += dt;
+    if (p.position.w >= p.velocity.w)
+    {
+        device atomic_int *dead_count = reinterpret_cast<device atomic_int *>(&counters.dead);
+        dead[atomic_fetch_add_explicit(dead_count, 1, memory_order_relaxed)] = index;
+        return;
+    }
+
+    const float3 previous = p.position.xyz;
+    float3 velocity = (p.velocity.xyz + emitter.acceleration.xyz * dt) * max(1.0 - emitter.acceleration.w * dt, 0.0);
+    float3 position = previous + velocity * dt;
+    if (uniforms.collide != 0)
+    {
+        const float4 clip = uniforms.depth_combined * float4(position, 1.0);
+        const float4 previous_clip = uniforms.depth_combined * float4(previous, 1.0);
+        const float3 ndc = clip.xyz / clip.w;
+        if (clip.w > 0.0 && previous_clip.w > 0.0 && all(abs(ndc.xy) < 1.0))
+        {
+            const uint2 size = uint2(depth.get_width(), depth.get_height());
+            const uint2 texel = min(uint2((ndc.xy * float2(0.5, -0.5) + 0.5) * float2(size)), size - 2);
+            const float surface = depth.read(texel);
+            if (ndc.z < surface && previous_clip.z / previous_clip.w >= surface)
+            {
+                const float4x4 inv = uniforms.depth_inv_combined;
+                const float3 hit = depth_position(depth, inv, texel);
+                float3 normal = cross(depth_position(depth, inv, texel + uint2(1, 0)) - hit,
+                                      depth_position(depth, inv, texel + uint2(0, 1)) - hit);
+                normal = length_squared(normal) > 0.0 ? normalize(normal) : -normalize(velocity);
+                if (dot(normal, previous - hit) < 0.0)
+                    normal = -normal;
+                velocity = reflect(velocity, normal) * emitter.restitution;
+                position = previous;
+            }
+        }
+    }
+
+    p.position.xyz = position;
+    p.velocity.xyz = velocity;
+    particles[index] = p;
+
+    const uint next = 1 - uniforms.list;
+    device atomic_uint *count = reinterpret_cast<device atomic_uint *>(&counters.alive[next]);
+    alive[next * uniforms.capacity + atomic_fetch_add_explicit(count, 1, memory_order_relaxed)] = index;
+}
+
+// Draws a quad for every survivor of the simulation.
+kernel void finish_particles(device ParticleCounters &counters [[buffer(3)]],
+                             constant ParticleUniforms &uniforms [[buffer(5)]])
+{
+    counters.draw.vertex_count = 6;
+    counters.draw.instance_count = counters.alive[1 - uniforms.list];
+    counters.draw.vertex_start = 0;
+    counters.draw.base_instance = 0;
+}
+
+struct ImpostorBakeInOut
+{
+    float4 position [[position]];
+    float3 normal;
+    // Bitangent sign in w.
+    float4 tangent;
+    float2 uv;
+    uint mat_id [[flat]];
+    uint tile [[flat]];
+};
+
+// Instance tile of a bake draws the mesh into its tile of the atlases, orthographically along the tile direction
+// across the bounding sphere of the mesh.
+ImpostorBakeInOut impostor_bake_out(float3 position, float3 normal, float4 tangent, float2 uv, uint mat_id,
+                                    constant ImpostorBakeUniforms &uniforms, uint tile)
+{
+    const uint2 cell = uint2(tile % uniforms.tiles, tile / uniforms.tiles);
+    float3 right, up;
+    const float3 d = impostor_axes(cell, uniforms.tiles, right, up);
+    const float3 p = (position - uniforms.center.xyz) / uniforms.center.w;
+    const float2 local = float2(dot(p, right), dot(p, up)) * 0.5 + 0.5;
+    const float2 texel = (float2(cell) + float2(local.x, 1.0 - local.y)) / float(uniforms.tiles);
+
+    ImpostorBakeInOut out;
+    out.position = float4(texel.x * 2.0 - 1.0, 1.0 - texel.y * 2.0, 0.5 - 0.5 * dot(p, d), 1.0);
+    out.normal = normal;
+    out.tangent = tangent;
+    out.uv = uv;
+    out.mat_id = mat_id;
+    out.tile = tile;
+    return out;
+}
+
+vertex ImpostorBakeInOut impostor_bake_vertex(const device Scene &scene [[buffer(0)]],
+                                              constant ImpostorBakeUniforms &uniforms [[buffer(1)]],
+                                              unsigned int vid [[vertex_id]], unsigned int tile [[instance_id]])
+{
+    const device Vertex3D &v = scene.vertices[vid];
+    return impostor_bake_out(float3(v.v_x, v.v_y, v.v_z), float3(v.n_x, v.n_y, v.n_z),
+                             float4(v.t_x, v.t_y, v.t_z, v.t_w < 0.0 ? -1.0 : 1.0), float2(v.u, v.v), v.mat_id,
+                             uniforms, tile);
+}
+
+vertex ImpostorBakeInOut impostor_bake_vertex_packed(const device Scene &scene [[buffer(0)]],
+                                                     constant ImpostorBakeUniforms &uniforms [[buffer(1)]],
+                                                     constant PackedVertexBounds &bounds [[buffer(2)]],
+                                                     unsigned int vid [[vertex_id]], unsigned int tile [[instance_id]])
+{
+    const device PackedVertex3D &v = scene.packed_vertices[vid];
+    const float3 position = bounds.offset.xyz + float3(v.p_x, v.p_y, v.p_z) / 65535.0 * bounds.scale.xyz;
+    return impostor_bake_out(position, decode_octahedral(v.n_x, v.n_y),
+                             float4(decode_octahedral(v.t_x, v.t_y), (v.flags & 1) != 0 ? -1.0 : 1.0),
+                             float2(as_type<half>(v.u), as_type<half>(v.v)), v.mat_id, uniforms, tile);
+}
+
+struct ImpostorTexels
+{
+    half4 albedo [[color(0)]];
+    half4 normal [[color(1)]];
+};
+
+// Albedo with full coverage, and the normal in the axes of the tile with the depth across the bounding sphere in w.
+fragment ImpostorTexels impostor_bake_fragment(ImpostorBakeInOut in [[stage_in]],
+                                               const device Scene &scene [[buffer(0)]],
+                                               constant ImpostorBakeUniforms &uniforms [[buffer(1)]])
+{
+    VertexInOut surface;
+    surface.position = in.position;
+    surface.world_position = float3(0.0);
+    surface.color = half4(1.0);
+    surface.normal = half3(normalize(in.normal));
+    surface.tangent = half4(half3(normalize(in.tangent.xyz)), half(in.tangent.w));
+    surface.mat_id = ushort(in.mat_id);
+    surface.uv = in.uv;
+    surface.lightmap_uv = float2(0.0);
+    const Surface s = material_surface(scene, surface, ImplicitLod());
+
+    const uint2 cell = uint2(in.tile % uniforms.tiles, in.tile / uniforms.tiles);
+    float3 right, up;
+    const float3 d = impostor_axes(cell, uniforms.tiles, right, up);
+    const float3 n = float3(dot(s.normal, right), dot(s.normal, up), dot(s.normal, d));
+    return {half4(half3(s.color.rgb), 1.0h), half4(half3(n * 0.5 + 0.5), half(in.position.z))};
+}
+
+// Height of a terrain at texel, texels outside of the heightmap repeat its edge.
+float terrain_height(const device float *heights, constant TerrainUniforms &terrain, int2 texel)
+{
+    const int2 clamped = clamp(texel, int2(0), int2(terrain.width - 1, terrain.height - 1));
+    return heights[clamped.y * int(terrain.width) + clamped.x];
+}
+
+// Vertex at grid of a level of a terrain. Vertices on the edge of the level that lie between two vertices of the next
+// level take the height of its edge, so the levels meet without cracks. Positions are kept within the heightmap, cells
+// beyond it collapse to its edge.
+Vertex3D terrain_vertex(const device float *heights, const device uint *materials, constant TerrainUniforms &terrain,
+                        uint level, int2 grid)
+{
+    const int step = 1 << level;
+    const int2 texel = int2(terrain.level_x[level], terrain.level_y[level]) + grid * step;
+    const int2 clamped = clamp(texel, int2(0), int2(terrain.width - 1, terrain.height - 1));
+
+    float height = terrain_height(heights, terrain, texel);
+    const bool edge_x = grid.x == 0 || grid.x == TERRAIN_GRID;
+    const bool edge_y = grid.y == 0 || grid.y == TERRAIN_GRID;
+    if (level + 1 < terrain.levels && edge_x && (grid.y & 1) != 0)
+        height = 0.5f * (terrain_height(heights, terrain, texel - int2(0, step)) +
+                         terrain_height(heights, terrain, texel + int2(0, step)));
+    else if (level + 1 < terrain.levels && edge_y && (grid.x & 1) != 0)
+        height = 0.5f * (terrain_height(heights, terrain, texel - int2(step, 0)) +
+                         terrain_height(heights, terrain, texel + int2(step, 0)));
+
+    // Slopes are taken over the cells of the level, coarser levels get smoother normals.
+    const float left = terrain_height(heights, terrain, clamped - int2(step, 0));
+    const float right = terrain_height(heights, terrain, clamped + int2(step, 0));
+    const float back = terrain_height(heights, terrain, clamped - int2(0, step));
+    const float front = terrain_height(heights, terrain, clamped + int2(0, step));
+    const float width = 2.0f * float(step) * terrain.spacing;
+    const float3 normal = normalize(float3(left - right, width, back - front));
+    const float3 tangent = normalize(float3(width, right - left, 0.0f));
+    const float2 position = float2(clamped) * terrain.spacing;
+
+    Vertex3D v;
+    v.v_x = terrain.origin.x + position.x;
+    v.v_y = terrain.origin.y + height;
+    v.v_z = terrain.origin.z + position.y;
+    v.v_w = 1.0f;
+    v.n_x = normal.x;
+    v.n_y = normal.y;
+    v.n_z = normal.z;
+    v.mat_id = terrain.has_materials != 0 ? materials[clamped.y * int(terrain.width) + clamped.x] : terrain.material;
+    v.u = position.x / terrain.uv_scale;
+    v.v = position.y / terrain.uv_scale;
+    v.pad0 = 0.0f;
+    v.pad1 = 0.0f;
+    v.t_x = tangent.x;
+    v.t_y = tangent.y;
+    v.t_z = tangent.z;
+    v.t_w = 1.0f;
+    return v;
+}
+
+// Two triangles for every cell of every level of a terrain. The first level writes all of its cells, every further
+// level skips the TERRAIN_GRID / 2 cells wide square the level below covers.
+kernel void generate_terrain(device Vertex3D *vertices [[buffer(0)]], const device float *heights [[buffer(1)]],
+                             const device uint *materials [[buffer(2)]],
+                             constant TerrainUniforms &terrain [[buffer(3)]], uint index [[thread_position_in_grid]])
+{
+    if (index >= terrain.cells)
+        return;
+
+    constexpr uint full = TERRAIN_GRID * TERRAIN_GRID;
+    constexpr uint hole = TERRAIN_GRID / 2;
+    constexpr uint beside = TERRAIN_GRID - hole;
+    uint level = 0;
+    uint cell = index;
+    int2 grid = int2(cell % TERRAIN_GRID, cell / TERRAIN_GRID);
+    if (index >= full)
+    {
+        level = 1 + (index - full) / (full - full / 4);
+        cell = (index - full) % (full - full / 4);
+
+        // Rows above the hole have all of their cells, rows next to it only those beside it.
+        const int2 below = int2(terrain.level_x[level - 1], terrain.level_y[level - 1]);
+        const uint2 inner = uint2((below - int2(terrain.level_x[level], terrain.level_y[level])) / (1 << level));
+        const uint above = inner.y * TERRAIN_GRID;
+        if (cell < above)
+        {
+            grid = int2(cell % TERRAIN_GRID, cell / TERRAIN_GRID);
+        }
+        else if (cell < above + hole * beside)
+        {
+            const uint column = (cell - above) % beside;
+            grid = int2(column < inner.x ? column : column + hole, inner.y + (cell - above) / beside);
+        }
+        else
+        {
+            const uint rest = cell - above - hole * beside;
+            grid = int2(rest % TERRAIN_GRID, inner.y + hole + rest / TERRAIN_GRID);
+        }
+    }
+
+    const Vertex3D v00 = terrain_vertex(heights, materials, terrain, level, grid);
+    const Vertex3D v01 = terrain_vertex(heights, materials, terrain, level, grid + int2(0, 1));
+    const Vertex3D v10 = terrain_vertex(heights, materials, terrain, level, grid + int2(1, 0));
+    const Vertex3D v11 = terrain_vertex(heights, materials, terrain, level, grid + int2(1, 1));
+    device Vertex3D *out = vertices + index * 6;
+    out[0] = v00;
+    out[1] = v01;
+    out[2] = v10;
+    out[3] = v10;
+    out[4] = v01;
+    out[5] = v11;
+}
+
+// Pixel and depth of packed point `point` of a chunk drawn with matrix, false outside the view.
+bool project_point(uint point, float4x4 matrix, constant PointRasterUniforms &target, thread uint &pixel,
+                   thread uint &depth)
+{
+    const float3 quantized = float3(point & 2047u, (point >> 11) & 2047u, point >> 22);
+    const float4 clip = matrix * float4(quantized, 1.0);
+    const float3 ndc = clip.xyz / clip.w;
+    if (clip.w <= 0.0 || any(abs(ndc.xy) >= 1.0) || ndc.z > 1.0)
+        return false;
+    const uint2 coords = uint2(float2(ndc.x * 0.5 + 0.5, 0.5 - ndc.y * 0.5) * float2(target.width, target.height));
+    pixel = min(coords.y, target.height - 1) * target.width + min(coords.x, target.width - 1);
+    // Reversed depth is positive, so its bits order like the depths.
+    depth = as_type<uint>(ndc.z);
+    return true;
+}
+
+// First pass of the point rasterizer, keeps the nearest depth of every pixel. Threadgroup `chunk` strides over the
+// points of its chunk.
+kernel void rasterize_point_depth(const device PackedPoint *points [[buffer(0)]],
+                                  const device PointChunkDraw *chunks [[buffer(1)]],
+                                  constant PointRasterUniforms &target [[buffer(2)]],
+                                  device atomic_uint *depths [[buffer(3)]],
+                                  uint chunk [[threadgroup_position_in_grid]],
+                                  uint thread_index [[thread_index_in_threadgroup]])
+{
+    const device PointChunkDraw &draw = chunks[chunk];
+    for (uint i = thread_index; i < draw.count; i += POINT_GROUP_SIZE)
+    {
+        uint pixel;
+        uint depth;
+        if (project_point(points[draw.first + i].position, draw.matrix, target, pixel, depth))
+            atomic_fetch_max_explicit(&depths[pixel], depth, memory_order_relaxed);
+    }
+}
+
+// Second pass, the points at the depth the first pass kept write their color. Points of equal depth race, any of them
+// may win.
+kernel void rasterize_point_color(const device PackedPoint *points [[buffer(0)]],
+                                  const device PointChunkDraw *chunks [[buffer(1)]],
+                                  constant PointRasterUniforms &target [[buffer(2)]],
+                                  const device uint *depths [[buffer(3)]], device uint *colors [[buffer(4)]],
+                                  uint chunk [[threadgroup_position_in_grid]],
+                                  uint thread_index [[thread_index_in_threadgroup]])
+{
+    const device PointChunkDraw &draw = chunks[chunk];
+    for (uint i = thread_index; i < draw.count; i += POINT_GROUP_SIZE)
+    {
+        const PackedPoint point = points[draw.first + i];
+        uint pixel;
+        uint depth;
+        if (project_point(point.position, draw.matrix, target, pixel, depth) && depths[pixel] == depth)
+            colors[pixel] = point.color;
+    }
+}
+
+struct PointCloudOut
+{
+    half4 color [[color(0)]];
+    float depth [[depth(greater)]];
+};
+
+// Composites the rasterized points into the main pass, tested against and written into its depth.
+fragment PointCloudOut point_cloud_fragment(DeferredInOut in [[stage_in]], const device uint *depths [[buffer(0)]],
+                                            const device uint *colors [[buffer(1)]],
+                                            constant PointRasterUniforms &target [[buffer(2)]])
+{
+    const uint2 coords = uint2(in.position.xy);
+    const uint pixel = coords.y * target.width + coords.x;
+    const uint depth = depths[pixel];
+    if (depth == 0)
+        discard_fragment();
+
+    PointCloudOut out;
+    out.color = half4(unpack_unorm4x8_to_half(colors[pixel]).rgb, 1.0h);
+    out.depth = as_type<float>(depth);
+    return out;
+}
+
+// Copies the positions of the vertices in [range.x, range.y) into the position stream, impostors are marked with 0.
+kernel void extract_positions(const device Vertex3D *vertices [[buffer(0)]], device float4 *positions [[buffer(1)]],
+                              constant uint2 &range [[buffer(2)]], uint id [[thread_position_in_grid]])
+{
+    const uint vid = range.x + id;
+    if (vid >= range.y)
+        return;
+    const device Vertex3D &v = vertices[vid];
+    positions[vid] = is_impostor(v) ? float4(0.0) : float4(v.v_x, v.v_y, v.v_z, v.v_w);
+}
+
+// Candidate of a cell of a scatter, kept candidates stand upright on the terrain with a random rotation around y and
+// scale. The others have no size and sit behind the camera, where culling drops them.
+kernel void scatter_instances(const device float *heights [[buffer(0)]], const device float *density [[buffer(1)]],
+                              constant TerrainUniforms &terrain [[buffer(2)]],
+                              constant ScatterUniforms &scatter [[buffer(3)]],
+                              device InstanceTransform *instances [[buffer(4)]], uint gid [[thread_position_in_grid]])
+{
+    if (gid >= scatter.count)
+        return;
+
+    // Candidates are seeded by their cell, so they stay where they are while the window of cells moves.
+    const int2 cell = int2(scatter.first_x, scatter.first_y) + int2(gid % scatter.side, gid / scatter.side);
+    uint seed = wang_hash(scatter.seed ^ wang_hash(uint(cell.x) ^ wang_hash(uint(cell.y)))) | 1u;
+    const float2 position = (float2(cell) + float2(random_float(seed), random_float(seed))) * scatter.spacing;
+    const float2 texel = (position - terrain.origin.xz) / terrain.spacing;
+    const float2 last = float2(terrain.width - 1, terrain.height - 1);
+    bool keep = distance_squared(position, scatter.camera.xz) <= scatter.radius * scatter.radius &&
+                all(texel >= 0.0) && all(texel <= last);
+    const float chance = random_float(seed);
+    if (keep && scatter.has_density != 0)
+    {
+        const uint2 size = uint2(scatter.density_width, scatter.density_height);
+        const uint2 entry = min(uint2(texel / last * float2(size)), size - 1);
+        keep = chance < density[entry.y * size.x + entry.x];
+    }
+
+    device InstanceTransform &t = instances[gid];
+    if (!keep)
+    {
+        for (uint row = 0; row < 3; row++)
+            t.rows[row] = float4(0.0, 0.0, 0.0, scatter.hidden[row]);
+        return;
+    }
+
+    const int2 base = int2(texel);
+    const float2 f = texel - float2(base);
+    const float height = mix(mix(terrain_height(heights, terrain, base),
+                                 terrain_height(heights, terrain, base + int2(1, 0)), f.x),
+                             mix(terrain_height(heights, terrain, base + int2(0, 1)),
+                                 terrain_height(heights, terrain, base + int2(1, 1)), f.x),
+                             f.y);
+    const float scale = mix(scatter.min_scale, scatter.max_scale, random_float(seed));
+    const float angle = random_float(seed) * 2.0 * M_PI_F;
+    const float s = sin(angle) * scale;
+    const float c = cos(angle) * scale;
+    t.rows[0] = float4(c, 0.0, s, position.x);
+    t.rows[1] = float4(0.0, scale, 0.0, terrain.origin.y + height);
+    t.rows[2] = float4(-s, 0.0, c, position.y);
+}
+
+// Starts a sample with a path per pixel in the queue of bounce 0. Adaptive samples and lightmaps queue the paths of
+// the pixels or texels they trace while generating them instead, queue_paths sizes their dispatch.
+kernel void begin_paths(constant PathTracerUniforms &uniforms [[buffer(1)]],
+                        device PathCounters &counters [[buffer(5)]])
+{
+    const uint size = uniforms.adaptive != 0 || uniforms.lightmap != 0 ? 0 : uniforms.width * uniforms.height;
+    counters.paths[0] = size;
+    counters.paths[1] = 0;
+    counters.shadow_rays = 0;
+    counters.traced_shadow_rays = 0;
+    counters.extend = path_dispatch(size);
+    counters.active_tiles = 0;
+}
+
+// Camera ray through a jittered position of every pixel, the first sample clears the accumulated radiance whose w
+// counts the samples of the pixel. Adaptive samples trace into a radiance buffer of their own that
+// accumulate_path_tiles adds up, and skip the pixels of tiles that converged.
+kernel void generate_paths(constant PathTracerUniforms &uniforms [[buffer(1)]], device PathState *paths [[buffer(2)]],
+                           device PathCounters &counters [[buffer(5)]], device float4 *accumulator [[buffer(6)]],
+                           const device PathTile *tiles [[buffer(19)]], uint2 gid [[thread_position_in_grid]])
+{
+    if (gid.x >= uniforms.width || gid.y >= uniforms.height)
+        return;
+
+    const uint pixel = gid.y * uniforms.width + gid.x;
+    uint slot = pixel;
+    if (uniforms.adaptive != 0)
+    {
+        const uint2 tile = gid / PATH_TRACER_TILE_SIZE;
+        if (uniforms.sample != 0 && tiles[tile.y * uniforms.tiles_x + tile.x].converged != 0)
+            return;
+        accumulator[pixel] = float4(0.0);
+        device atomic_uint *count = reinterpret_cast<device atomic_uint *>(&counters.paths[0]);
+        slot = atomic_fetch_add_explicit(count, 1, memory_order_relaxed);
+    }
+    else
+    {
+        const float4 accumulated = uniforms.sample == 0 ? float4(0.0) : accumulator[pixel];
+        accumulator[pixel] = accumulated + float4(0.0, 0.0, 0.0, 1.0);
+    }
+
+    uint seed = wang_hash(pixel * 16789 + uniforms.seed * 1791);
+    const float2 uv = (float2(gid) + float2(random_float(seed), random_float(seed))) /
+                      float2(uniforms.width, uniforms.height);
+    const float4 far = uniforms.inv_combined * float4(uv.x * 2.0 - 1.0, 1.0 - uv.y * 2.0, 1.0, 1.0);
+
+    PathState path;
+    path.origin = float4(uniforms.camera_position.xyz, as_type<float>(pixel));
+    path.direction = float4(normalize(far.xyz / far.w - uniforms.camera_position.xyz), 0.0);
+    path.throughput = float4(1.0);
+    paths[slot] = path;
+}
+
+// Sizes the dispatches of bounce 0 by the paths an adaptive sample or a lightmap queued.
+kernel void queue_paths(device PathCounters &counters [[buffer(5)]])
+{
+    counters.extend = path_dispatch(counters.paths[0]);
+}
+
+// Finds the closest hit of every path in the queue of this bounce.
+kernel void extend_paths(constant PathTracerUniforms &uniforms [[buffer(1)]],
+                         const device PathState *paths [[buffer(2)]], device PathHit *hits [[buffer(3)]],
+                         const device PathCounters &counters [[buffer(5)]],
+                         raytracing::instance_acceleration_structure scene
+                         [[buffer(12), function_constant(hardware_tracing)]],
+                         const device BvhScene &bvh
+                         [[buffer(BVH_SCENE_BUFFER_INDEX), function_constant(software_tracing)]],
+                         constant uint &bounce [[buffer(13)]], uint i [[thread_position_in_grid]])
+{
+    const uint queue = bounce % 2;
+    if (i >= counters.paths[queue])
+        return;
+
+    const device PathState &path = paths[queue * uniforms.width * uniforms.height + i];
+    hits[i] = trace_ray(scene, bvh, path.origin.xyz, path.direction.xyz, 0.0, INFINITY, false);
+}
+
+// Traces count ray queries against the scene, hits are written like the ones of paths. Any hit queries stop at the
+// first intersection they find, which is what visibility tests need.
+kernel void trace_ray_queries(const device RayQuery *queries [[buffer(0)]], device PathHit *hits [[buffer(1)]],
+                              constant uint &count [[buffer(2)]], constant uint &any_hit [[buffer(3)]],
+                              raytracing::instance_acceleration_structure scene
+                              [[buffer(4), function_constant(hardware_tracing)]],
+                              const device BvhScene &bvh
+                              [[buffer(BVH_SCENE_BUFFER_INDEX), function_constant(software_tracing)]],
+                              uint i [[thread_position_in_grid]])
+{
+    if (i >= count)
+        return;
+
+    const RayQuery query = queries[i];
+    hits[i] = trace_ray(scene, bvh, float3(query.origin_x, query.origin_y, query.origin_z),
+                        float3(query.direction_x, query.direction_y, query.direction_z), query.min_distance,
+                        query.max_distance, any_hit != 0);
+}
+
+// Traces ray i of a PVS bake in a random direction from a random point of its cell, the traced instance it hits first
+// can be seen from the cell.
+kernel void bake_pvs(constant PvsUniforms &uniforms [[buffer(0)]], device atomic_uint *bits [[buffer(1)]],
+                     raytracing::instance_acceleration_structure scene
+                     [[buffer(2), function_constant(hardware_tracing)]],
+                     const device BvhScene &bvh [[buffer(BVH_SCENE_BUFFER_INDEX), function_constant(software_tracing)]],
+                     uint i [[thread_position_in_grid]])
+{
+    if (i >= uniforms.count)
+        return;
+
+    const uint cell = uniforms.first_cell + i / uniforms.rays_per_cell;
+    const uint3 coords = uint3(cell % uniforms.cells_x, cell / uniforms.cells_x % uniforms.cells_y,
+                               cell / (uniforms.cells_x * uniforms.cells_y));
+    uint seed = wang_hash(uniforms.first_cell * uniforms.rays_per_cell + i + 1);
+    const float3 jitter = float3(random_float(seed), random_float(seed), random_float(seed));
+    const float3 origin = uniforms.origin.xyz + (float3(coords) + jitter) * uniforms.cell_size;
+
+    const float z = random_float(seed) * 2.0 - 1.0;
+    const float phi = random_float(seed) * 2.0 * M_PI_F;
+    const float r = sqrt(max(1.0 - z * z, 0.0));
+    const PathHit hit = trace_ray(scene, bvh, origin, float3(r * cos(phi), r * sin(phi), z), 0.0, INFINITY, false);
+    if (hit.instance < uniforms.num_traced)
+    {
+        atomic_fetch_or_explicit(&bits[cell * uniforms.words_per_cell + hit.instance / 32], 1u << (hit.instance % 32),
+                                 memory_order_relaxed);
+    }
+}
+
+// Surface at the hit of a path, the attributes of its triangle are interpolated like the rasterizer does. Texture maps
+// are sampled at their base level. Normals face the incoming ray, geometric_normal returns the one of the triangle.
+Surface hit_surface(const device Scene &scene, const device TracedInstance *instances, const device uint *indices,
+                    PathHit hit, float3 direction, thread float3 &geometric_normal)
+{
+    const device TracedInstance &instance = instances[hit.instance];
+    uint3 triangle = hit.primitive * 3 + uint3(0, 1, 2);
+    const device uchar *index_data = reinterpret_cast<const device uchar *>(indices) + instance.index_offset;
+    if (instance.index_size == 2)
+    {
+        const device ushort *short_indices = reinterpret_cast<const device ushort *>(index_data);
+        triangle = uint3(short_indices[triangle.x], short_indices[triangle.y], short_indices[triangle.z]);
+    }
+    else if (instance.index_size == 4)
+    {
+        const device uint *word_indices = reinterpret_cast<const device uint *>(index_data);
+        triangle = uint3(word_indices[triangle.x], word_indices[triangle.y], word_indices[triangle.z]);
+    }
+    triangle += instance.vertex_start;
+
+    const device Vertex3D *vertices = instance.animated != 0 ? scene.anim_vertices : scene.vertices;
+    const device Vertex3D &v0 = vertices[triangle.x];
+    const device Vertex3D &v1 = vertices[triangle.y];
+    const device Vertex3D &v2 = vertices[triangle.z];
+    const float2 barycentrics = unpack_unorm2x16_to_float(hit.barycentrics);
+    const float3 w = float3(1.0 - barycentrics.x - barycentrics.y, barycentrics.x, barycentrics.y);
+    const float4x4 m = instance_matrix(scene.instances[instance.instance]);
+
+    const float3 p0 = float3(v0.v_x, v0.v_y, v0.v_z);
+    const float3 e1 = float3(v1.v_x, v1.v_y, v1.v_z) - p0;
+    const float3 e2 = float3(v2.v_x, v2.v_y, v2.v_z) - p0;
+    geometric_normal = transform_normal(m, cross(e1, e2));
+    const float3 normal = w.x * float3(v0.n_x, v0.n_y, v0.n_z) + w.y * float3(v1.n_x, v1.n_y, v1.n_z) +
+                          w.z * float3(v2.n_x, v2.n_y, v2.n_z);
+    const float3 tangent = w.x * float3(v0.t_x, v0.t_y, v0.t_z) + w.y * float3(v1.t_x, v1.t_y, v1.t_z) +
+                           w.z * float3(v2.t_x, v2.t_y, v2.t_z);
+
+    VertexInOut in;
+    in.normal = half3(transform_normal(m, normal));
+    in.tangent = half4(half3(normalize((m * float4(tangent, 0.0)).xyz)), v0.t_w < 0.0 ? -1.0h : 1.0h);
+    in.uv = w.x * float2(v0.u, v0.v) + w.y * float2(v1.u, v1.v) + w.z * float2(v2.u, v2.v);
+    in.lightmap_uv = w.x * float2(v0.pad0, v0.pad1) + w.y * float2(v1.pad0, v1.pad1) + w.z * float2(v2.pad0, v2.pad1);
+    in.mat_id = ushort(v0.mat_id);
+    in.color = half4(1.0);
+    in = override_instance(in, scene, instance.instance);
+
+    Surface s = material_surface(scene, in, 0.0f);
+    if (dot(direction, geometric_normal) > 0.0)
+    {
+        geometric_normal = -geometric_normal;
+        s.normal = -s.normal;
+    }
+    return s;
+}
+
+// Importance of the lights below a node to p, their power over the squared distance to the node's center, which is no
+// closer than the node's extent so that nodes around p keep a finite importance.
+float light_tree_importance(const device LightTreeNode &node, float3 p)
+{
+    const float3 center = 0.5 * (node.bmin.xyz + node.bmax.xyz);
+    const float3 extent = node.bmax.xyz - node.bmin.xyz;
+    return node.bmin.w / max(distance_squared(p, center), 0.25 * dot(extent, extent));
+}
+
+// Picks an area light by walking down the light tree, every node is left to a child with the probability of its
+// importance. pmf is the probability of the light that was picked, 0 when the lights below a node don't reach p.
+uint sample_light_tree(const device LightTreeNode *nodes, float3 p, thread uint &seed, thread float &pmf)
+{
+    uint node = 0;
+    pmf = 1.0;
+    while (nodes[node].right != LIGHT_TREE_LEAF)
+    {
+        const float left = light_tree_importance(nodes[nodes[node].left], p);
+        const float right = light_tree_importance(nodes[nodes[node].right], p);
+        if (!(left + right > 0.0))
+        {
+            pmf = 0.0;
+            return 0;
+        }
+        const float p_left = left / (left + right);
+        if (random_float(seed) < p_left)
+        {
+            node = nodes[node].left;
+            pmf *= p_left;
+        }
+        else
+        {
+            node = nodes[node].right;
+            pmf *= 1.0 - p_left;
+        }
+    }
+    return nodes[node].left;
+}
+
+// Direction above the plane of normal n distributed with the cosine to n.
+float3 cosine_direction(float3 n, thread uint &seed)
+{
+    const float3 t = normalize(cross(n, abs(n.x) > 0.5 ? float3(0.0, 1.0, 0.0) : float3(1.0, 0.0, 0.0)));
+    const float3 b = cross(n, t);
+    const float r1 = random_float(seed);
+    const float phi = 2.0 * M_PI_F * random_float(seed);
+    const float radius = sqrt(r1);
+    return t * (radius * cos(phi)) + b * (radius * sin(phi)) + n * sqrt(1.0 - r1);
+}
+
+// Shades the hit of every path of this bounce. Hits add their emission, and a light picked at random is sampled with a
+// shadow ray. Area lights are picked from the light tree by half of the samples, or all of them without other lights,
+// and sampled at a uniformly distributed point of their triangle. Emission after the first hit is then only counted by
+// those samples. The first hits of lightmap paths are already one bounce off their texel, whose direct light is left to
+// the rasterizer. Paths continue in a cosine weighted direction into the queue of the next bounce, from the third
+// bounce on they survive by russian roulette.
+kernel void shade_paths(const device Scene &scene [[buffer(0)]], constant PathTracerUniforms &uniforms [[buffer(1)]],
+                        device PathState *paths [[buffer(2)]], const device PathHit *hits [[buffer(3)]],
+                        device ShadowRay *shadow_rays [[buffer(4)]], device PathCounters &counters [[buffer(5)]],
+                        device float4 *accumulator [[buffer(6)]],
+                        const device TracedInstance *instances [[buffer(7)]],
+                        const device uint *indices [[buffer(8)]], const device PointLight *point_lights [[buffer(9)]],
+                        const device SpotLight *spot_lights [[buffer(10)]],
+                        const device DirectionalLight *directional_lights [[buffer(11)]],
+                        constant uint &bounce [[buffer(13)]], const device AreaLight *area_lights [[buffer(14)]],
+                        const device LightTreeNode *light_tree [[buffer(15)]],
+                        device PathSurface *surfaces [[buffer(16)]], uint i [[thread_position_in_grid]])
+{
+    const uint queue = bounce % 2;
+    if (i >= counters.paths[queue])
+        return;
+
+    const uint size = uniforms.width * uniforms.height;
+    const PathState path = paths[queue * size + i];
+    const uint pixel = as_type<uint>(path.origin.w);
+    float3 throughput = path.throughput.xyz;
+    const PathHit hit = hits[i];
+    const bool first_hit = bounce == 0 && uniforms.denoise != 0;
+
+    // Everything around the scene emits the ambient light of the rasterizer.
+    if (hit.instance == ~0u)
+    {
+        accumulator[pixel] += float4(throughput * AMBIENT, 0.0);
+        if (first_hit)
+        {
+            surfaces[pixel].position = float4(0.0);
+            surfaces[pixel].normal = float4(0.0, 0.0, 0.0, as_type<float>(0xFFFFFFFFu));
+        }
+        return;
+    }
+
+    float3 geometric_normal;
+    const Surface s = hit_surface(scene, instances, indices, hit, path.direction.xyz, geometric_normal);
+    if (any(s.emissive > 0.0) && ((bounce == 0 && uniforms.lightmap == 0) || uniforms.num_area_lights == 0))
+        accumulator[pixel] += float4(throughput * s.emissive, 0.0);
+
+    uint seed = wang_hash(pixel * 16789 + uniforms.seed * 1791 + bounce * 720898027);
+    const float3 v = -path.direction.xyz;
+    const float3 hit_position = path.origin.xyz + path.direction.xyz * hit.distance;
+    if (first_hit)
+    {
+        surfaces[pixel].position = float4(hit_position, hit.distance);
+        surfaces[pixel].normal = float4(s.normal, as_type<float>(pack_float_to_unorm4x8(s.color)));
+    }
+    // Rays leave the surface by an offset that grows with the magnitude of the position, like its precision.
+    const float3 p = hit_position + geometric_normal * (1e-4 * max(max3(abs(hit_position.x), abs(hit_position.y),
+                                                                         abs(hit_position.z)), 1.0));
+
+    const uint num_lights = uniforms.num_point_lights + uniforms.num_spot_lights + uniforms.num_directional_lights;
+    const float area_probability = uniforms.num_area_lights == 0 ? 0.0 : num_lights == 0 ? 1.0 : 0.5;
+    if (num_lights > 0 || area_probability > 0.0)
+    {
+        float3 l;
+        float distance = INFINITY;
+        float3 radiance;
+        // Picking a light is compensated by weighting its sample with the inverse of the probability of the pick.
+        const bool area = random_float(seed) < area_probability;
+        const uint index = num_lights > 0 ? min(uint(random_float(seed) * num_lights), num_lights - 1) : 0;
+        float weight = num_lights / (1.0 - area_probability);
+        if (area)
+        {
+            float pmf;
+            const device AreaLight &light = area_lights[sample_light_tree(light_tree, p, seed, pmf)];
+            const float r1 = sqrt(random_float(seed));
+            const float r2 = random_float(seed);
+            const float3 position = (1.0 - r1) * float3(light.vertex0_x, light.vertex0_y, light.vertex0_z) +
+                                    r1 * (1.0 - r2) * float3(light.vertex1_x, light.vertex1_y, light.vertex1_z) +
+                                    r1 * r2 * float3(light.vertex2_x, light.vertex2_y, light.vertex2_z);
+
+            // The area pdf of the point is converted to solid angle by the distance attenuation and the cosine, the
+            // attenuation is windowed like that of the rasterizer. Shadow rays end short of the light's own triangle.
+            const float3 to_light = position - p;
+            const float distance_squared = max(dot(to_light, to_light), 1e-8);
+            distance = sqrt(distance_squared);
+            l = to_light / distance;
+            const float3 emitted = float3(light.radiance_r, light.radiance_g, light.radiance_b) * light.area;
+            const float facing = abs(dot(float3(light.normal_x, light.normal_y, light.normal_z), l));
+            radiance = emitted * facing * distance_attenuation(distance_squared, light_range(emitted));
+            distance *= 0.999;
+            weight = pmf > 0.0 ? 1.0 / (pmf * area_probability) : 0.0;
+        }
+        else if (index < uniforms.num_point_lights + uniforms.num_spot_lights)
+        {
+            const bool spot = index >= uniforms.num_point_lights;
+            const device SpotLight &spot_light = spot_lights[spot ? index - uniforms.num_point_lights : 0];
+            const device PointLight &point_light = point_lights[spot ? 0 : index];
+            const float3 position = spot ? float3(spot_light.pos_x, spot_light.pos_y, spot_light.pos_z)
+                                         : float3(point_light.pos_x, point_light.pos_y, point_light.pos_z);
+            radiance = spot ? float3(spot_light.radiance_r, spot_light.radiance_g, spot_light.radiance_b)
+                            : float3(point_light.radiance_r, point_light.radiance_g, point_light.radiance_b);
+
+            const float3 to_light = position - p;
+            const float distance_squared = max(dot(to_light, to_light), 1e-8);
+            distance = sqrt(distance_squared);
+            l = to_light / distance;
+            radiance *= distance_attenuation(distance_squared, light_range(radiance));
+            if (spot)
+            {
+                const float3 direction =
+                    normalize(float3(spot_light.direction_x, spot_light.direction_y, spot_light.direction_z));
+                radiance *= smoothstep(spot_light.cos_outer, spot_light.cos_inner, dot(-l, direction));
+            }
+        }
+        else
+        {
+            const device DirectionalLight &light =
+                directional_lights[index - uniforms.num_point_lights - uniforms.num_spot_lights];
+            l = -normalize(float3(light.direction_x, light.direction_y, light.direction_z));
+            radiance = float3(light.radiance_r, light.radiance_g, light.radiance_b);
+        }
+
+        const float3 contribution = throughput * brdf(s, v, l) * radiance * saturate(dot(s.normal, l)) * weight;
+        if (dot(geometric_normal, l) > 0.0 && any(contribution > 0.0))
+        {
+            device atomic_uint *count = reinterpret_cast<device atomic_uint *>(&counters.shadow_rays);
+            const uint slot = atomic_fetch_add_explicit(count, 1, memory_order_relaxed);
+
+            ShadowRay shadow_ray;
+            shadow_ray.origin = float4(p, as_type<float>(pixel));
+            shadow_ray.direction = float4(l, distance);
+            shadow_ray.radiance = float4(contribution, 0.0);
+            shadow_rays[slot] = shadow_ray;
+        }
+    }
+
+    if (bounce + 1 >= PATH_TRACER_BOUNCES)
+        return;
+
+    // The cosine weighted pdf cancels the cosine term, which leaves the BRDF times pi.
+    const float3 direction = cosine_direction(s.normal, seed);
+    if (dot(direction, geometric_normal) <= 0.0)
+        return;
+
+    throughput *= brdf(s, v, direction) * M_PI_F;
+    if (bounce >= 2)
+    {
+        const float survival = min(max3(throughput.x, throughput.y, throughput.z), 0.95);
+        if (random_float(seed) >= survival)
+            return;
+        throughput /= survival;
+    }
+
+    device atomic_uint *count = reinterpret_cast<device atomic_uint *>(&counters.paths[1 - queue]);
+    const uint slot = atomic_fetch_add_explicit(count, 1, memory_order_relaxed);
+
+    PathState next;
+    next.origin = float4(p, path.origin.w);
+    next.direction = float4(direction, 0.0);
+    next.throughput = float4(throughput, 0.0);
+    paths[(1 - queue) * size + slot] = next;
+}
+
+// Empties the queue of the bounce that was shaded and sizes the dispatches of its shadow rays and of the next bounce.
+kernel void advance_paths(device PathCounters &counters [[buffer(5)]], constant uint &bounce [[buffer(13)]])
+{
+    const uint queue = bounce % 2;
+    counters.paths[queue] = 0;
+    counters.traced_shadow_rays = counters.shadow_rays;
+    counters.shadow_rays = 0;
+    counters.extend = path_dispatch(counters.paths[1 - queue]);
+    counters.shadow = path_dispatch(counters.traced_shadow_rays);
+}
+
+// Adds the light samples that reach their pixel.
+kernel void trace_shadow_rays(const device ShadowRay *shadow_rays [[buffer(4)]],
+                              const device PathCounters &counters [[buffer(5)]],
+                              device float4 *accumulator [[buffer(6)]],
+                              raytracing::instance_acceleration_structure scene
+                              [[buffer(12), function_constant(hardware_tracing)]],
+                              const device BvhScene &bvh
+                              [[buffer(BVH_SCENE_BUFFER_INDEX), function_constant(software_tracing)]],
+                              uint i [[thread_position_in_grid]])
+{
+    if (i >= counters.traced_shadow_rays)
+        return;
+
+    const ShadowRay shadow_ray = shadow_rays[i];
+    if (trace_unoccluded(scene, bvh, shadow_ray.origin.xyz, shadow_ray.direction.xyz, 0.0, shadow_ray.direction.w))
+        accumulator[as_type<uint>(shadow_ray.origin.w)] += shadow_ray.radiance;
+}
+
+float path_luminance(float3 radiance)
+{
+    return dot(radiance, float3(0.2126, 0.7152, 0.0722));
+}
+
+// Albedo of the first hit the radiance of a pixel is divided by before it is filtered, so the filter doesn't blur
+// textures. At least a small one, which keeps the light of black surfaces.
+float3 path_albedo(PathSurface s)
+{
+    return max(unpack_unorm4x8_to_float(as_type<uint>(s.normal.w)).rgb, 0.01);
+}
+
+// Blends the sample of every pixel, divided by the albedo of its first hit, into the history of the same surface in
+// the previous frame. The history is found by reprojecting the first hit with the previous camera, only the camera is
+// assumed to move, and kept while the surface there is at about the same position and faces the same way. The
+// variance of the luminance follows from its moments, it is raised while the history is short since few frames
+// estimate it poorly. filtered gets the blended radiance with the variance in w.
+kernel void reproject_path_history(constant PathTracerUniforms &uniforms [[buffer(1)]],
+                                   const device float4 *accumulator [[buffer(6)]],
+                                   const device PathSurface *surfaces [[buffer(16)]],
+                                   const device PathSurface *previous_surfaces [[buffer(17)]],
+                                   const device PathHistory *previous_history [[buffer(18)]],
+                                   device PathHistory *history [[buffer(19)]], device float4 *filtered [[buffer(20)]],
+                                   uint2 gid [[thread_position_in_grid]])
+{
+    if (gid.x >= uniforms.width || gid.y >= uniforms.height)
+        return;
+
+    const uint pixel = gid.y * uniforms.width + gid.x;
+    const PathSurface s = surfaces[pixel];
+    const float3 radiance = accumulator[pixel].rgb / path_albedo(s);
+    const float luminance = path_luminance(radiance);
+    PathHistory blended;
+    blended.radiance = float4(radiance, 1.0);
+    blended.moments = float4(luminance, luminance * luminance, 0.0, 0.0);
+
+    const float4 previous = uniforms.previous_combined * float4(s.position.xyz, 1.0);
+    if (uniforms.history != 0 && s.position.w > 0.0 && previous.w > 0.0)
+    {
+        const float2 uv = float2(previous.x, -previous.y) / previous.w * 0.5 + 0.5;
+        const int2 texel = int2(floor(uv * float2(uniforms.width, uniforms.height)));
+        if (all(texel >= 0) && texel.x < int(uniforms.width) && texel.y < int(uniforms.height))
+        {
+            const uint previous_pixel = uint(texel.y) * uniforms.width + uint(texel.x);
+            const PathSurface p = previous_surfaces[previous_pixel];
+            if (p.position.w > 0.0 && distance(p.position.xyz, s.position.xyz) < 0.02 * s.position.w + 1e-3 &&
+                dot(p.normal.xyz, s.normal.xyz) > 0.9)
+            {
+                // Frames blend in at least 1 / 5 so the history follows changes of the lighting.
+                const PathHistory h = previous_history[previous_pixel];
+                const float frames = min(h.radiance.w + 1.0, 64.0);
+                const float alpha = max(1.0 / frames, 0.2);
+                blended.radiance = float4(mix(h.radiance.rgb, radiance, alpha), frames);
+                blended.moments = mix(h.moments, blended.moments, alpha);
+            }
+        }
+    }
+
+    history[pixel] = blended;
+    float variance = max(blended.moments.y - blended.moments.x * blended.moments.x, 0.0);
+    if (blended.radiance.w < 4.0)
+        variance *= 4.0 / blended.radiance.w;
+    filtered[pixel] = float4(blended.radiance.rgb, variance);
+}
+
+// One pass of the edge avoiding wavelet filter with 5x5 taps step pixels apart. Taps weigh less the farther they are
+// from the plane of the first hit of the pixel, the more their normal differs and the more their luminance differs
+// relative to its standard deviation, and the variance is filtered with the squares of the weights. The last pass
+// multiplies the radiance by the albedo again into the accumulator the path traced view shows.
+kernel void filter_path_radiance(constant PathTracerUniforms &uniforms [[buffer(1)]],
+                                 device float4 *accumulator [[buffer(6)]],
+                                 constant uint2 &pass [[buffer(13)]],
+                                 const device PathSurface *surfaces [[buffer(16)]],
+                                 const device float4 *source [[buffer(20)]], device float4 *destination [[buffer(21)]],
+                                 uint2 gid [[thread_position_in_grid]])
+{
+    if (gid.x >= uniforms.width || gid.y >= uniforms.height)
+        return;
+
+    const uint pixel = gid.y * uniforms.width + gid.x;
+    const PathSurface s = surfaces[pixel];
+    const float4 center = source[pixel];
+    float4 result = center;
+    if (s.position.w > 0.0)
+    {
+        const float weights[3] = {3.0 / 8.0, 1.0 / 4.0, 1.0 / 16.0};
+        const float luminance = path_luminance(center.rgb);
+        const float deviation = 4.0 * sqrt(center.w) + 1e-4;
+        const float plane = 0.01 * s.position.w * float(pass.x) + 1e-4;
+        float3 sum = 0.0;
+        float variance = 0.0;
+        float total = 0.0;
+        for (int y = -2; y <= 2; y++)
+        {
+            for (int x = -2; x <= 2; x++)
+            {
+                const int2 texel = int2(gid) + int2(x, y) * int(pass.x);
+                if (any(texel < 0) || texel.x >= int(uniforms.width) || texel.y >= int(uniforms.height))
+                    continue;
+                const uint tap = uint(texel.y) * uniforms.width + uint(texel.x);
+                const PathSurface q = surfaces[tap];
+                if (q.position.w <= 0.0)
+                    continue;
+
+                const float4 value = source[tap];
+                const float w_position = exp(-abs(dot(s.normal.xyz, q.position.xyz - s.position.xyz)) / plane);
+                const float w_normal = pow(saturate(dot(s.normal.xyz, q.normal.xyz)), 128.0);
+                const float w_luminance = exp(-abs(path_luminance(value.rgb) - luminance) / deviation);
+                const float w = weights[abs(x)] * weights[abs(y)] * w_position * w_normal * w_luminance;
+                sum += value.rgb * w;
+                variance += value.w * w * w;
+                total += w;
+            }
+        }
+        if (total > 0.0)
+            result = float4(sum / total, variance / (total * total));
+    }
+
+    if (pass.y != 0)
+        accumulator[pixel] = float4(result.rgb * path_albedo(s), 1.0);
+    else
+        destination[pixel] = result;
+}
+
+// Adds the adaptive sample of a tile that did not converge to the accumulated radiance and its squared luminance to
+// the moments of its pixels, one threadgroup per tile. Its error is the mean standard error of the pixels relative to
+// the square root of their luminance, which follows how visible noise is in bright and dark regions alike. Tiles
+// converge once their error is at most the threshold after min_samples, or after max_samples.
+kernel void accumulate_path_tiles(constant PathTracerUniforms &uniforms [[buffer(1)]],
+                                  device PathCounters &counters [[buffer(5)]],
+                                  const device float4 *radiance [[buffer(6)]],
+                                  device float4 *accumulator [[buffer(17)]],
+                                  device float *moments [[buffer(18)]], device PathTile *tiles [[buffer(19)]],
+                                  uint2 group [[threadgroup_position_in_grid]], uint2 gid [[thread_position_in_grid]],
+                                  uint index [[thread_index_in_threadgroup]])
+{
+    threadgroup float errors[PATH_TRACER_TILE_SIZE * PATH_TRACER_TILE_SIZE];
+    device PathTile &tile = tiles[group.y * uniforms.tiles_x + group.x];
+    if (uniforms.sample != 0 && tile.converged != 0)
+        return;
+
+    const uint samples = (uniforms.sample == 0 ? 0 : tile.samples) + 1;
+    float error = 0.0;
+    if (gid.x < uniforms.width && gid.y < uniforms.height)
+    {
+        const uint pixel = gid.y * uniforms.width + gid.x;
+        const float3 traced = radiance[pixel].rgb;
+        const float luminance = path_luminance(traced);
+        const float4 accumulated = (uniforms.sample == 0 ? float4(0.0) : accumulator[pixel]) + float4(traced, 1.0);
+        const float moment = (uniforms.sample == 0 ? 0.0 : moments[pixel]) + luminance * luminance;
+        accumulator[pixel] = accumulated;
+        moments[pixel] = moment;
+
+        const float n = float(samples);
+        const float mean = path_luminance(accumulated.rgb) / n;
+        const float variance = max(moment / n - mean * mean, 0.0);
+        error = sqrt(variance / n) / sqrt(mean + 1e-4);
+    }
+
+    // Every thread read the tile before the first barrier, only the first one writes it after the last.
+    errors[index] = error;
+    for (uint stride = PATH_TRACER_TILE_SIZE * PATH_TRACER_TILE_SIZE / 2; stride > 0; stride /= 2)
+    {
+        threadgroup_barrier(mem_flags::mem_threadgroup);
+        if (index < stride)
+            errors[index] += errors[index + stride];
+    }
+    if (index != 0)
+        return;
+
+    const uint2 first = group * PATH_TRACER_TILE_SIZE;
+    const uint2 size = min(uint2(uniforms.width, uniforms.height) - first, uint2(PATH_TRACER_TILE_SIZE));
+    const float tile_error = errors[0] / float(size.x * size.y);
+    const bool converged = (samples >= uniforms.min_samples && tile_error <= uniforms.threshold) ||
+                           (uniforms.max_samples != 0 && samples >= uniforms.max_samples);
+    tile.samples = samples;
+    tile.converged = converged ? 1 : 0;
+    tile.error = tile_error;
+    if (!converged)
+        atomic_fetch_add_explicit(reinterpret_cast<device atomic_uint *>(&counters.active_tiles), 1,
+                                  memory_order_relaxed);
+}
+
+// Reports the tiles of the render that did not converge yet to the CPU.
+kernel void finish_paths(constant PathTracerUniforms &uniforms [[buffer(1)]],
+                         const device PathCounters &counters [[buffer(5)]],
+                         device PathProgress &progress [[buffer(20)]])
+{
+    progress.active_tiles = counters.active_tiles;
+    progress.render = uniforms.render;
+}
+
+// Starts a lightmap sample with a path from every texel the texel pass covered, in a cosine weighted direction around
+// its normal. Texels are white Lambertian surfaces, so the mean of their samples is their irradiance over pi, which the
+// rasterizer multiplies with the albedo like its ambient light. The first sample clears the accumulated radiance of
+// every texel.
+kernel void generate_lightmap_paths(constant PathTracerUniforms &uniforms [[buffer(1)]],
+                                    device PathState *paths [[buffer(2)]], device PathCounters &counters [[buffer(5)]],
+                                    device float4 *accumulator [[buffer(6)]],
+                                    texture2d<float, access::read> positions [[texture(0)]],
+                                    texture2d<float, access::read> normals [[texture(1)]],
+                                    uint2 gid [[thread_position_in_grid]])
+{
+    if (gid.x >= uniforms.width || gid.y >= uniforms.height)
+        return;
+
+    const uint texel = gid.y * uniforms.width + gid.x;
+    const float4 position = positions.read(gid);
+    const float4 accumulated = uniforms.sample == 0 ? float4(0.0) : accumulator[texel];
+    if (position.w == 0.0)
+    {
+        accumulator[texel] = accumulated;
+        return;
+    }
+    accumulator[texel] = accumulated + float4(0.0, 0.0, 0.0, 1.0);
+
+    uint seed = wang_hash(texel * 16789 + uniforms.seed * 1791);
+    const float3 n = normalize(normals.read(gid).xyz);
+    const float3 p = position.xyz + n * (1e-4 * max(max3(abs(position.x), abs(position.y), abs(position.z)), 1.0));
+    device atomic_uint *count = reinterpret_cast<device atomic_uint *>(&counters.paths[0]);
+    const uint slot = atomic_fetch_add_explicit(count, 1, memory_order_relaxed);
+
+    PathState path;
+    path.origin = float4(p, as_type<float>(texel));
+    path.direction = float4(cosine_direction(n, seed), 0.0);
+    path.throughput = float4(1.0);
+    paths[slot] = path;
+}
+
+struct LightmapTexelInOut
+{
+    float4 position [[position]];
+    float3 world_position;
+    float3 normal;
+};
+
+// Vertex of a lightmapped mesh at its second texture coordinates, which cover the lightmap from 0 to 1.
+vertex LightmapTexelInOut lightmap_texel_vertex(const device Scene &scene [[buffer(0)]],
+                                                unsigned int vid [[vertex_id]], unsigned int i_id [[instance_id]])
+{
+    const device Vertex3D &v = scene.vertices[vid];
+    const float4x4 m = instance_matrix(scene.instances[i_id]);
+
+    LightmapTexelInOut out;
+    out.position = float4(v.pad0 * 2.0 - 1.0, 1.0 - v.pad1 * 2.0, 0.0, 1.0);
+    out.world_position = (m * float4(v.v_x, v.v_y, v.v_z, v.v_w)).xyz;
+    out.normal = transform_normal(m, float3(v.n_x, v.n_y, v.n_z));
+    return out;
+}
+
+struct LightmapTexels
+{
+    float4 position [[color(0)]];
+    half4 normal [[color(1)]];
+};
+
+// World position of a texel with a w of 1 for coverage, and its normal.
+fragment LightmapTexels lightmap_texel_fragment(LightmapTexelInOut in [[stage_in]])
+{
+    return {float4(in.world_position, 1.0), half4(half3(normalize(in.normal)), 0.0h)};
+}
+
+// RGB9E5 of the shared exponent of the largest channel, as in EXT_texture_shared_exponent.
+uint pack_rgb9e5(float3 rgb)
+{
+    const float3 c = clamp(rgb, 0.0, 65408.0);
+    const float largest = max3(c.x, c.y, c.z);
+    int exponent = int(max(-16.0, floor(log2(max(largest, 1e-30))))) + 16;
+    if (uint(floor(largest / exp2(float(exponent - 24)) + 0.5)) == 512)
+        exponent++;
+    const uint3 mantissa = min(uint3(floor(c / exp2(float(exponent - 24)) + 0.5)), 511u);
+    return mantissa.x | (mantissa.y << 9) | (mantissa.z << 18) | (uint(exponent) << 27);
+}
+
+// World space size of a covered texel, its distance to the closest covered neighbour.
+float lightmap_texel_size(texture2d<float, access::read> positions, int2 texel, float3 p)
+{
+    const int2 size = int2(positions.get_width(), positions.get_height());
+    const int2 offsets[4] = {int2(1, 0), int2(-1, 0), int2(0, 1), int2(0, -1)};
+    float closest = INFINITY;
+    for (uint i = 0; i < 4; i++)
+    {
+        const int2 neighbour = texel + offsets[i];
+        if (any(neighbour < 0) || any(neighbour >= size))
+            continue;
+        const float4 q = positions.read(uint2(neighbour));
+        if (q.w != 0.0)
+            closest = min(closest, distance(q.xyz, p));
+    }
+    return closest;
+}
+
+// One pass of the wavelet filter over the mean radiance of the texels of a lightmap, with 5x5 taps step texels apart.
+// Taps weigh less the farther they are from the plane of the texel or from the texel itself, relative to the texel
+// size, and the more their normal differs. Neighbouring charts of the atlas are elsewhere in the scene, so they are not
+// mixed. The last pass grows the charts by a texel into the texels no triangle covered, which keeps filtering from
+// darkening their edges, and packs every texel to RGB9E5.
+kernel void filter_lightmap(constant LightmapFilterUniforms &uniforms [[buffer(0)]],
+                            const device float4 *source [[buffer(1)]], device float4 *destination [[buffer(2)]],
+                            device uint *packed [[buffer(3)]], texture2d<float, access::read> positions [[texture(0)]],
+                            texture2d<float, access::read> normals [[texture(1)]],
+                            uint2 gid [[thread_position_in_grid]])
+{
+    if (gid.x >= uniforms.width || gid.y >= uniforms.height)
+        return;
+
+    const uint texel = gid.y * uniforms.width + gid.x;
+    const float4 p = positions.read(gid);
+    float3 sum = 0.0;
+    float total = 0.0;
+    if (p.w != 0.0)
+    {
+        const float weights[3] = {3.0 / 8.0, 1.0 / 4.0, 1.0 / 16.0};
+        const float3 n = normals.read(gid).xyz;
+        const float radius = 2.0 * float(uniforms.step) * lightmap_texel_size(positions, int2(gid), p.xyz) + 1e-4;
+        for (int y = -2; y <= 2; y++)
+        {
+            for (int x = -2; x <= 2; x++)
+            {
+                const int2 tap = int2(gid) + int2(x, y) * int(uniforms.step);
+                if (any(tap < 0) || tap.x >= int(uniforms.width) || tap.y >= int(uniforms.height))
+                    continue;
+                const float4 q = positions.read(uint2(tap));
+                if (q.w == 0.0)
+                    continue;
+
+                const float4 value = source[uint(tap.y) * uniforms.width + uint(tap.x)];
+                const float3 offset = q.xyz - p.xyz;
+                const float w_position = exp(-(abs(dot(n, offset)) * 4.0 + length(offset)) / radius);
+                const float w_normal = pow(saturate(dot(n, normals.read(uint2(tap)).xyz)), 32.0);
+                const float w = weights[abs(x)] * weights[abs(y)] * w_position * w_normal;
+                sum += value.rgb / max(value.w, 1.0) * w;
+                total += w;
+            }
+        }
+    }
+    else if (uniforms.last != 0)
+    {
+        for (int y = -1; y <= 1; y++)
+        {
+            for (int x = -1; x <= 1; x++)
+            {
+                const int2 tap = int2(gid) + int2(x, y);
+                if (any(tap < 0) || tap.x >= int(uniforms.width) || tap.y >= int(uniforms.height) ||
+                    positions.read(uint2(tap)).w == 0.0)
+                    continue;
+                const float4 value = source[uint(tap.y) * uniforms.width + uint(tap.x)];
+                sum += value.rgb / max(value.w, 1.0);
+                total += 1.0;
+            }
+        }
+    }
+
+    const float3 result = total > 0.0 ? sum / total : float3(0.0);
+    if (uniforms.last != 0)
+        packed[texel] = pack_rgb9e5(result);
+    else
+        destination[texel] = float4(result, 1.0);
+}
+
+// Direction i of n directions spread evenly over the sphere along a spherical Fibonacci spiral.
+float3 spherical_fibonacci(uint i, uint n)
+{
+    const float phi = 2.0 * M_PI_F * fract(float(i) * 0.6180339887);
+    const float cos_theta = 1.0 - (2.0 * float(i) + 1.0) / float(n);
+    const float sin_theta = sqrt(saturate(1.0 - cos_theta * cos_theta));
+    return float3(cos(phi) * sin_theta, sin(phi) * sin_theta, cos_theta);
+}
+
+// Direction of ray i of every probe updated this frame.
+float3 gi_ray_direction(constant GiUniforms &uniforms, uint i)
+{
+    return (uniforms.rotation * float4(spherical_fibonacci(i, GI_RAYS_PER_PROBE), 0.0)).xyz;
+}
+
+// Grid position of the probe updated by threadgroup or ray group i of this frame.
+uint3 gi_probe(constant GiUniforms &uniforms, uint i)
+{
+    constant GiVolume &volume = uniforms.volume;
+    const uint index = (uniforms.first_probe + i) % (volume.count_x * volume.count_y * volume.count_z);
+    return uint3(index % volume.count_x, index / volume.count_x % volume.count_y,
+                 index / (volume.count_x * volume.count_y));
+}
+
+// Traces the rays of the probes updated this frame, radiance gets what a ray sees in rgb and how far in w. Hits are
+// lit by the directional lights and one point or spot light picked at random, with shadow rays, and once every probe
+// was traced by the irradiance they hold, which adds a bounce of light with every update. Rays that miss see the
+// roughest level of the prefiltered skybox or the constant ambient light.
+kernel void trace_gi_probes(const device Scene &scene [[buffer(0)]], constant GiUniforms &uniforms [[buffer(1)]],
+                            device float4 *radiance [[buffer(2)]],
+                            const device TracedInstance *instances [[buffer(3)]],
+                            const device uint *indices [[buffer(4)]],
+                            const device PointLight *point_lights [[buffer(5)]],
+                            const device SpotLight *spot_lights [[buffer(6)]],
+                            const device DirectionalLight *directional_lights [[buffer(7)]],
+                            raytracing::instance_acceleration_structure structure
+                            [[buffer(8), function_constant(hardware_tracing)]],
+                            const device BvhScene &bvh
+                            [[buffer(BVH_SCENE_BUFFER_INDEX), function_constant(software_tracing)]],
+                            texture2d<half> gi_irradiance [[texture(0)]], texture2d<half> gi_distances [[texture(1)]],
+                            texturecube<half> environment [[texture(2)]], uint i [[thread_position_in_grid]])
+{
+    if (i >= uniforms.num_probes * GI_RAYS_PER_PROBE)
+        return;
+
+    constant GiVolume &volume = uniforms.volume;
+    const float3 origin = volume.origin.xyz + volume.spacing.xyz * float3(gi_probe(uniforms, i / GI_RAYS_PER_PROBE));
+    const float3 direction = gi_ray_direction(uniforms, i % GI_RAYS_PER_PROBE);
+    const PathHit hit = trace_ray(structure, bvh, origin, direction, 0.0, uniforms.max_distance, false);
+    if (hit.instance == ~0u)
+    {
+        const float3 sky =
+            uniforms.environment != 0
+                ? float3(environment.sample(environment_sampler, direction, level(ENVIRONMENT_MIP_LEVELS - 1)).rgb)
+                : float3(AMBIENT);
+        radiance[i] = float4(sky, uniforms.max_distance);
+        return;
+    }
+
+    float3 geometric_normal;
+    const Surface s = hit_surface(scene, instances, indices, hit, direction, geometric_normal);
+    const float3 v = -direction;
+    const float3 hit_position = origin + direction * hit.distance;
+    const float3 p = hit_position + geometric_normal * (1e-4 * max(max3(abs(hit_position.x), abs(hit_position.y),
+                                                                         abs(hit_position.z)), 1.0));
+
+    float3 lit = s.emissive;
+    for (uint l = 0; l < uniforms.num_directional_lights; l++)
+    {
+        const device DirectionalLight &light = directional_lights[l];
+        const float3 to_light = -normalize(float3(light.direction_x, light.direction_y, light.direction_z));
+        if (dot(geometric_normal, to_light) > 0.0 && trace_unoccluded(structure, bvh, p, to_light, 0.0, INFINITY))
+            lit += brdf(s, v, to_light) * float3(light.radiance_r, light.radiance_g, light.radiance_b) *
+                   saturate(dot(s.normal, to_light));
+    }
+
+    // The light that was picked is weighted by the inverse of the probability of the pick.
+    const uint num_lights = uniforms.num_point_lights + uniforms.num_spot_lights;
+    if (num_lights > 0)
+    {
+        uint seed = wang_hash(i * 16789 + uniforms.seed * 1791);
+        const uint index = min(uint(random_float(seed) * num_lights), num_lights - 1);
+        const bool spot = index >= uniforms.num_point_lights;
+        const device SpotLight &spot_light = spot_lights[spot ? index - uniforms.num_point_lights : 0];
+        const device PointLight &point_light = point_lights[spot ? 0 : index];
+        const float3 position = spot ? float3(spot_light.pos_x, spot_light.pos_y, spot_light.pos_z)
+                                     : float3(point_light.pos_x, point_light.pos_y, point_light.pos_z);
+        float3 emitted = spot ? float3(spot_light.radiance_r, spot_light.radiance_g, spot_light.radiance_b)
+                              : float3(point_light.radiance_r, point_light.radiance_g, point_light.radiance_b);
+
+        const float3 to_light = position - p;
+        const float distance_squared = max(dot(to_light, to_light), 1e-8);
+        const float distance = sqrt(distance_squared);
+        const float3 l = to_light / distance;
+        emitted *= distance_attenuation(distance_squared, light_range(emitted));
+        if (spot)
+        {
+            const float3 axis =
+                normalize(float3(spot_light.direction_x, spot_light.direction_y, spot_light.direction_z));
+            emitted *= smoothstep(spot_light.cos_outer, spot_light.cos_inner, dot(-l, axis));
+        }
+        if (dot(geometric_normal, l) > 0.0 && any(emitted > 0.0) &&
+            trace_unoccluded(structure, bvh, p, l, 0.0, distance))
+            lit += brdf(s, v, l) * emitted * saturate(dot(s.normal, l)) * float(num_lights);
+    }
+
+    if (uniforms.bounce != 0)
+        lit += volume_irradiance(p, s.normal, v, volume, gi_irradiance, gi_distances) * (1.0 - s.metallic) *
+               s.color.rgb;
+    radiance[i] = float4(lit, hit.distance);
+}
+
+// Mean of the rays of a probe around texel direction n, irradiance weighs them by their cosine and distances by a
+// sharp power of it. Distances are returned with their squares.
+float3 blend_gi_rays(constant GiUniforms &uniforms, const device float4 *rays, float3 n, bool distances)
+{
+    float3 sum = 0.0;
+    float total = 0.0;
+    for (uint r = 0; r < GI_RAYS_PER_PROBE; r++)
+    {
+        float weight = saturate(dot(n, gi_ray_direction(uniforms, r)));
+        if (distances)
+        {
+            weight = pow(weight, 50.0);
+            const float distance = min(rays[r].w, uniforms.max_distance);
+            sum += float3(distance, distance * distance, 0.0) * weight;
+        }
+        else
+        {
+            sum += rays[r].rgb * weight;
+        }
+        total += weight;
+    }
+    return total > 1e-4 ? sum / total : sum;
+}
+
+// Writes texel of the tile at tile and copies it into the texels of the border that mirror it, so that bilinear
+// lookups wrap around the edges of the octahedron. Interior texels are 1 to texels on both axes.
+void write_gi_texel(texture2d<half, access::read_write> texture, uint2 tile, uint2 texel, uint texels, half4 value)
+{
+    const uint n = texels;
+    texture.write(value, tile + texel);
+    if (texel.y == 1)
+        texture.write(value, tile + uint2(n + 1 - texel.x, 0));
+    if (texel.y == n)
+        texture.write(value, tile + uint2(n + 1 - texel.x, n + 1));
+    if (texel.x == 1)
+        texture.write(value, tile + uint2(0, n + 1 - texel.y));
+    if (texel.x == n)
+        texture.write(value, tile + uint2(n + 1, n + 1 - texel.y));
+    if (texel.x == n && texel.y == n)
+        texture.write(value, tile);
+    if (texel.x == 1 && texel.y == n)
+        texture.write(value, tile + uint2(n + 1, 0));
+    if (texel.x == n && texel.y == 1)
+        texture.write(value, tile + uint2(0, n + 1));
+    if (texel.x == 1 && texel.y == 1)
+        texture.write(value, tile + uint2(n + 1, n + 1));
+}
+
+// Blends the traced irradiance of a probe into its tile, one threadgroup per probe and one thread per texel. Updates
+// without hysteresis replace the texels, which hold nothing before the first one.
+kernel void blend_gi_irradiance(constant GiUniforms &uniforms [[buffer(1)]],
+                                const device float4 *radiance [[buffer(2)]],
+                                texture2d<half, access::read_write> gi_irradiance [[texture(0)]],
+                                uint2 tid [[thread_position_in_threadgroup]],
+                                uint group [[threadgroup_position_in_grid]])
+{
+    const uint3 probe = gi_probe(uniforms, group);
+    const uint2 tile = uint2(probe.x + probe.y * uniforms.volume.count_x, probe.z) * (GI_IRRADIANCE_TEXELS + 2);
+    const uint2 texel = tid + 1;
+    const float3 n = octahedral_direction((float2(tid) + 0.5) / float(GI_IRRADIANCE_TEXELS));
+    const float3 traced = blend_gi_rays(uniforms, radiance + group * GI_RAYS_PER_PROBE, n, false);
+    float3 blended = traced;
+    if (uniforms.hysteresis > 0.0)
+        blended = mix(traced, float3(gi_irradiance.read(tile + texel).rgb), uniforms.hysteresis);
+    blended = min(blended, 6e4);
+    write_gi_texel(gi_irradiance, tile, texel, GI_IRRADIANCE_TEXELS, half4(half3(blended), 1.0));
+}
+
+// Blends the traced distances of a probe and their squares into its tile like blend_gi_irradiance.
+kernel void blend_gi_distances(constant GiUniforms &uniforms [[buffer(1)]],
+                               const device float4 *radiance [[buffer(2)]],
+                               texture2d<half, access::read_write> gi_distances [[texture(0)]],
+                               uint2 tid [[thread_position_in_threadgroup]],
+                               uint group [[threadgroup_position_in_grid]])
+{
+    const uint3 probe = gi_probe(uniforms, group);
+    const uint2 tile = uint2(probe.x + probe.y * uniforms.volume.count_x, probe.z) * (GI_DISTANCE_TEXELS + 2);
+    const uint2 texel = tid + 1;
+    const float3 n = octahedral_direction((float2(tid) + 0.5) / float(GI_DISTANCE_TEXELS));
+    const float2 traced = blend_gi_rays(uniforms, radiance + group * GI_RAYS_PER_PROBE, n, true).xy;
+    float2 blended = traced;
+    if (uniforms.hysteresis > 0.0)
+        blended = mix(traced, float2(gi_distances.read(tile + texel).xy), uniforms.hysteresis);
+    blended = min(blended, 6e4);
+    write_gi_texel(gi_distances, tile, texel, GI_DISTANCE_TEXELS, half4(half2(blended), 0.0, 0.0));
+}
+
+// Level 0 of the reflection pyramid keeps the closest depth of the 2x2 pixels below each texel, reversed depth is
+// highest closest to the camera.
+kernel void reflection_hzb_init(depth2d<float, access::read> depth [[texture(0)]],
+                                texture2d<float, access::write> dst [[texture(1)]],
+                                uint2 gid [[thread_position_in_grid]])
+{
+    if (gid.x >= dst.get_width() || gid.y >= dst.get_height())
+        return;
+
+    const uint2 last = uint2(depth.get_width(), depth.get_height()) - 1;
+    const uint2 p = gid * 2;
+    const float d = max(max(depth.read(min(p, last)), depth.read(min(p + uint2(1, 0), last))),
+                        max(depth.read(min(p + uint2(0, 1), last)), depth.read(min(p + 1, last))));
+    dst.write(float4(d), gid);
+}
+
+// Every further level of the reflection pyramid keeps the closest depth of the 2x2 texels below it.
+kernel void reflection_hzb_downsample(texture2d<float, access::read> src [[texture(0)]],
+                                      texture2d<float, access::write> dst [[texture(1)]],
+                                      uint2 gid [[thread_position_in_grid]])
+{
+    if (gid.x >= dst.get_width() || gid.y >= dst.get_height())
+        return;
+
+    const uint2 last = uint2(src.get_width(), src.get_height()) - 1;
+    const uint2 p = gid * 2;
+    const float d = max(max(src.read(min(p, last)).x, src.read(min(p + uint2(1, 0), last)).x),
+                        max(src.read(min(p + uint2(0, 1), last)).x, src.read(min(p + 1, last)).x));
+    dst.write(float4(d), gid);
+}
+
+struct ReflectionRay
+{
+    float3 origin;
+    float3 direction;
+};
+
+// Mirror reflection of the view at the half resolution texel gid of the pre-pass depth, false where there is no
+// geometry. Normals are reconstructed from the depth like those of the screen space occlusion.
+bool reflection_ray(depth2d<float, access::read> depth, constant LightUniforms &lights, uint2 gid,
+                    thread ReflectionRay &ray)
+{
+    const uint2 last = uint2(lights.width - 1, lights.height - 1);
+    const uint2 pixel = min(gid * 2, last);
+    if (depth.read(pixel) <= 0.0)
+        return false;
+
+    const float3 p = depth_position(depth, lights, pixel);
+    const float3 dx = shorter_difference(depth_position(depth, lights, uint2(min(pixel.x + 1, last.x), pixel.y)) - p,
+                                         p - depth_position(depth, lights, uint2(max(pixel.x, 1u) - 1, pixel.y)));
+    const float3 dy = shorter_difference(depth_position(depth, lights, uint2(pixel.x, min(pixel.y + 1, last.y))) - p,
+                                         p - depth_position(depth, lights, uint2(pixel.x, max(pixel.y, 1u) - 1)));
+    float3 n = normalize(cross(dx, dy));
+    const float3 to_camera = lights.camera_position.xyz - p;
+    if (dot(n, to_camera) < 0.0)
+        n = -n;
+
+    ray.direction = reflect(-normalize(to_camera), n);
+    ray.origin = p + n * (1e-3 * max(length(to_camera), 1.0));
+    return true;
+}
+
+// Marches a reflection ray through the closest depth pyramid, in half resolution texels where the depth of the ray is
+// linear. Cells the ray stays in front of are skipped a level up, cells it passes behind are refined a level down
+// until it passes behind a texel of level 0. Returns the world position of the depth it hit. queued is set where the
+// scene has to decide instead, where the ray leaves the view, passes behind geometry thicker than the depth shows or
+// runs out of steps, and not where it goes the whole distance in front of everything.
+bool march_reflection(depth2d<float, access::read> depth, texture2d<float, access::read> hzb,
+                      constant LightUniforms &lights, constant ReflectionUniforms &uniforms, ReflectionRay ray,
+                      thread float3 &hit, thread bool &queued)
+{
+    queued = true;
+    const float4 clip0 = uniforms.combined * float4(ray.origin, 1.0);
+    float4 clip1 = uniforms.combined * float4(ray.origin + ray.direction * uniforms.max_distance, 1.0);
+    // Rays towards the camera end at the near plane.
+    const float near = 1e-4;
+    if (clip0.w <= near)
+        return false;
+    if (clip1.w < near)
+        clip1 = mix(clip0, clip1, (clip0.w - near) / (clip0.w - clip1.w));
+
+    const float2 size = float2(lights.width, lights.height) * 0.5;
+    const float3 s0 = float3((clip0.xy / clip0.w * float2(0.5, -0.5) + 0.5) * size, clip0.z / clip0.w);
+    const float3 s1 = float3((clip1.xy / clip1.w * float2(0.5, -0.5) + 0.5) * size, clip1.z / clip1.w);
+    const float3 delta = s1 - s0;
+    const float texel = 1.0 / max(max(abs(delta.x), abs(delta.y)), 1e-4);
+
+    float t = texel;
+    uint level = 0;
+    for (uint i = 0; i < REFLECTION_MAX_STEPS; i++)
+    {
+        const float3 s = s0 + delta * t;
+        if (t > 1.0)
+        {
+            queued = false;
+            return false;
+        }
+        if (any(s.xy < 0.0) || any(s.xy >= size))
+            return false;
+
+        // Where the ray leaves the cell, a thousandth of a texel into the next one.
+        const float cell_size = float(1u << level);
+        const float2 cell = floor(s.xy / cell_size);
+        const float2 boundary = (cell + select(float2(0.0), float2(1.0), delta.xy > 0.0)) * cell_size;
+        const float2 exits = select(float2(INFINITY), (boundary - s0.xy) / delta.xy, delta.xy != 0.0);
+        const float t_exit = min(exits.x, exits.y) + texel * 1e-3;
+
+        const float ray_closest = max(s.z, s0.z + delta.z * min(t_exit, 1.0));
+        if (ray_closest > hzb.read(uint2(cell), level).x)
+        {
+            t = t_exit;
+            level = min(level + 1, uniforms.hzb_levels - 1);
+        }
+        else if (level > 0)
+        {
+            level--;
+        }
+        else
+        {
+            // The ray passed behind the closest depth of the texel, it hit unless it is further behind it than the
+            // depth of the surface can be told apart from a gap.
+            const uint2 last = uint2(lights.width - 1, lights.height - 1);
+            hit = depth_position(depth, lights, min(uint2(s.xy * 2.0), last));
+            const float2 ndc = s.xy / size * float2(2.0, -2.0) + float2(-1.0, 1.0);
+            const float4 p = lights.inv_combined * float4(ndc, s.z, 1.0);
+            const float3 camera = lights.camera_position.xyz;
+            const float surface_distance = length(hit - camera);
+            if (length(p.xyz / p.w - camera) - surface_distance > 0.05 * surface_distance + 0.05)
+                return false;
+            queued = false;
+            return true;
+        }
+    }
+    return false;
+}
+
+// Empties the queue of the reflection rays that missed in screen space.
+kernel void begin_reflections(device ReflectionCounters &counters [[buffer(3)]])
+{
+    counters.rays = 0;
+}
+
+// Traces the reflection of every half resolution texel in screen space. Hits take the color the main pass of the
+// previous frame had where they are, faded out towards the border of the view. Rays the scene has to decide are queued
+// while they are traced, the others reflect nothing and leave the reflections to the probes and the skybox.
+kernel void trace_screen_reflections(depth2d<float, access::read> depth [[texture(0)]],
+                                     texture2d<float, access::read> hzb [[texture(1)]],
+                                     texture2d<half> source [[texture(2)]],
+                                     texture2d<half, access::write> traced [[texture(3)]],
+                                     constant LightUniforms &lights [[buffer(0)]],
+                                     constant ReflectionUniforms &uniforms [[buffer(1)]],
+                                     device uint *rays [[buffer(2)]], device ReflectionCounters &counters [[buffer(3)]],
+                                     uint2 gid [[thread_position_in_grid]])
+{
+    if (gid.x >= uniforms.width || gid.y >= uniforms.height)
+        return;
+
+    ReflectionRay ray;
+    float3 hit;
+    bool queued = false;
+    if (reflection_ray(depth, lights, gid, ray) && march_reflection(depth, hzb, lights, uniforms, ray, hit, queued))
+    {
+        const float4 previous = uniforms.previous_combined * float4(hit, 1.0);
+        const float2 uv = previous.xy / max(previous.w, 1e-6) * float2(0.5, -0.5) + 0.5;
+        if (uniforms.source != 0 && previous.w > 0.0 && all(uv >= 0.0) && all(uv <= 1.0))
+        {
+            const float2 border = min(uv, 1.0 - uv);
+            const float fade = saturate(min(border.x, border.y) * 10.0);
+            traced.write(half4(source.sample(ssao_sampler, uv).rgb, half(fade)), gid);
+            return;
+        }
+        queued = true;
+    }
+
+    traced.write(half4(0.0), gid);
+    if (queued && uniforms.traced != 0)
+    {
+        device atomic_uint *count = reinterpret_cast<device atomic_uint *>(&counters.rays);
+        rays[atomic_fetch_add_explicit(count, 1, memory_order_relaxed)] = gid.x | gid.y << 16;
+    }
+}
+
+// Sizes the dispatch that traces the queued reflection rays.
+kernel void queue_reflection_rays(device ReflectionCounters &counters [[buffer(3)]])
+{
+    counters.trace.threadgroups[0] = (counters.rays + REFLECTION_GROUP_SIZE - 1) / REFLECTION_GROUP_SIZE;
+    counters.trace.threadgroups[1] = 1;
+    counters.trace.threadgroups[2] = 1;
+}
+
+// Traces the queued reflection rays against the scene. Hits are lit by the directional lights with shadow rays and by
+// the ambient light, rays that miss reflect nothing like those of the screen space pass.
+kernel void trace_reflection_rays(constant LightUniforms &lights [[buffer(0)]],
+                                  constant ReflectionUniforms &uniforms [[buffer(1)]],
+                                  const device uint *rays [[buffer(2)]],
+                                  const device ReflectionCounters &counters [[buffer(3)]],
+                                  const device Scene &scene [[buffer(4)]],
+                                  const device TracedInstance *instances [[buffer(5)]],
+                                  const device uint *indices [[buffer(6)]],
+                                  const device DirectionalLight *directional_lights [[buffer(7)]],
+                                  raytracing::instance_acceleration_structure structure
+                                  [[buffer(8), function_constant(hardware_tracing)]],
+                                  const device BvhScene &bvh
+                                  [[buffer(BVH_SCENE_BUFFER_INDEX), function_constant(software_tracing)]],
+                                  depth2d<float, access::read> depth [[texture(0)]],
+                                  texture2d<half, access::write> traced [[texture(3)]],
+                                  texturecube<half> environment [[texture(4)]], uint i [[thread_position_in_grid]])
+{
+    if (i >= counters.rays)
+        return;
+
+    const uint2 gid = uint2(rays[i] & 0xFFFFu, rays[i] >> 16);
+    ReflectionRay ray;
+    reflection_ray(depth, lights, gid, ray);
+    const PathHit hit = trace_ray(structure, bvh, ray.origin, ray.direction, 0.0, uniforms.max_distance, false);
+    if (hit.instance == ~0u)
+        return;
+
+    float3 geometric_normal;
+    const Surface s = hit_surface(scene, instances, indices, hit, ray.direction, geometric_normal);
+    const float3 v = -ray.direction;
+    const float3 hit_position = ray.origin + ray.direction * hit.distance;
+    const float3 p = hit_position + geometric_normal * (1e-4 * max(max3(abs(hit_position.x), abs(hit_position.y),
+                                                                         abs(hit_position.z)), 1.0));
+
+    float3 lit = s.emissive;
+    for (uint l = 0; l < lights.num_directional_lights; l++)
+    {
+        const device DirectionalLight &light = directional_lights[l];
+        const float3 to_light = -normalize(float3(light.direction_x, light.direction_y, light.direction_z));
+        if (dot(geometric_normal, to_light) > 0.0 && trace_unoccluded(structure, bvh, p, to_light, 0.0, INFINITY))
+            lit += brdf(s, v, to_light) * float3(light.radiance_r, light.radiance_g, light.radiance_b) *
+                   saturate(dot(s.normal, to_light));
+    }
+    const float3 ambient =
+        lights.environment != 0
+            ? float3(environment.sample(environment_sampler, s.normal, level(ENVIRONMENT_MIP_LEVELS - 1)).rgb)
+            : float3(AMBIENT);
+    lit += ambient * (1.0 - s.metallic) * s.color.rgb;
+    traced.write(half4(half3(min(lit, float(HALF_MAX))), 1.0), gid);
+}
+
+// Blends the traced reflections into the history of the previous frame, reprojected with the reflecting surface and
+// clamped to the reflections around the texel so the history of what moved doesn't trail behind.
+kernel void resolve_reflections(depth2d<float, access::read> depth [[texture(0)]],
+                                texture2d<half, access::read> traced [[texture(1)]],
+                                texture2d<half> history [[texture(2)]],
+                                texture2d<half, access::write> resolved [[texture(3)]],
+                                constant LightUniforms &lights [[buffer(0)]],
+                                constant ReflectionUniforms &uniforms [[buffer(1)]],
+                                uint2 gid [[thread_position_in_grid]])
+{
+    if (gid.x >= uniforms.width || gid.y >= uniforms.height)
+        return;
+
+    const half4 current = traced.read(gid);
+    const uint2 pixel = min(gid * 2, uint2(lights.width - 1, lights.height - 1));
+    if (uniforms.history == 0 || depth.read(pixel) <= 0.0)
+    {
+        resolved.write(current, gid);
+        return;
+    }
+
+    const int2 last = int2(uniforms.width, uniforms.height) - 1;
+    half4 low = current;
+    half4 high = current;
+    for (int y = -1; y <= 1; y++)
+    {
+        for (int x = -1; x <= 1; x++)
+        {
+            const half4 neighbour = traced.read(uint2(clamp(int2(gid) + int2(x, y), int2(0), last)));
+            low = min(low, neighbour);
+            high = max(high, neighbour);
+        }
+    }
+
+    const float4 previous = uniforms.previous_combined * float4(depth_position(depth, lights, pixel), 1.0);
+    const float2 uv = previous.xy / max(previous.w, 1e-6) * float2(0.5, -0.5) + 0.5;
+    if (previous.w <= 0.0 || any(uv < 0.0) || any(uv > 1.0))
+    {
+        resolved.write(current, gid);
+        return;
+    }
+    const half4 reprojected = clamp(history.sample(ssao_sampler, uv), low, high);
+    resolved.write(mix(reprojected, current, 0.2h), gid);
+}
+
+// Averages the 2x2 pixels of the main pass below every texel of the source of the next frame's reflections.
+kernel void downsample_reflection_source(texture2d<half> color [[texture(0)]],
+                                         texture2d<half, access::write> source [[texture(1)]],
+                                         uint2 gid [[thread_position_in_grid]])
+{
+    if (gid.x >= source.get_width() || gid.y >= source.get_height())
+        return;
+
+    const float2 uv = (float2(gid) * 2.0 + 1.0) / float2(color.get_width(), color.get_height());
+    source.write(half4(min(color.sample(ssao_sampler, uv).rgb, HALF_MAX), 1.0), gid);
+}
+
+// Shows the mean of the samples accumulated for every pixel.
+fragment half4 path_traced_fragment(DeferredInOut in [[stage_in]], constant PathTracerUniforms &uniforms [[buffer(1)]],
+                                    const device float4 *accumulator [[buffer(2)]])
+{
+    const uint2 pixel = uint2(in.position.xy);
+    const float4 accumulated = accumulator[pixel.y * uniforms.width + pixel.x];
+    return half4(half3(accumulated.rgb / max(accumulated.w, 1.0)), 1.0);
+}
+
+// Motion in texture coordinates from a pixel of the 3D pass to where the camera saw its depth in the previous frame,
+// without the jitter of either frame. Only the camera moves, the motion of objects is not included.
+float2 camera_motion_at(float2 uv, float depth, constant MotionUniforms &uniforms)
+{
+    // The w of p is proportional to depth, pixels at the infinite far plane have none and only move with the rotation.
+    const float4 p = uniforms.inv_combined * float4(uv.x * 2.0 - 1.0, 1.0 - uv.y * 2.0, depth, 1.0);
+    const float4 previous = uniforms.previous_combined * p;
+    if (previous.w <= 0.0)
+        return float2(0.0);
+
+    const float2 previous_uv = float2(previous.x, -previous.y) / previous.w * 0.5 + 0.5;
+    return previous_uv - (uv - float2(uniforms.jitter_x, uniforms.jitter_y));
+}
+
+// Camera motion of every pixel, for frames whose pre-pass did not draw motion vectors.
+kernel void camera_motion(depth2d<float, access::read> depth [[texture(0)]],
+                          texture2d<half, access::write> motion [[texture(1)]],
+                          constant MotionUniforms &uniforms [[buffer(0)]], uint2 gid [[thread_position_in_grid]])
+{
+    if (gid.x >= uniforms.width || gid.y >= uniforms.height)
+        return;
+
+    const float2 uv = (float2(gid) + 0.5) / float2(uniforms.width, uniforms.height);
+    motion.write(half4(half2(camera_motion_at(uv, depth.read(gid), uniforms)), 0.0, 0.0), gid);
+}
+
+// Pixels the pre-pass left at the far plane only move with the camera.
+fragment half2 background_motion_fragment(DeferredInOut in [[stage_in]],
+                                          constant MotionUniforms &uniforms [[buffer(0)]])
+{
+    const float2 uv = in.position.xy / float2(uniforms.width, uniforms.height);
+    return half2(camera_motion_at(uv, 0.0, uniforms));
+}
+
+float3 rgb_to_ycocg(float3 c)
+{
+    return float3(dot(c, float3(0.25, 0.5, 0.25)), dot(c, float3(0.5, 0.0, -0.5)), dot(c, float3(-0.25, 0.5, -0.25)));
+}
+
+float3 ycocg_to_rgb(float3 c)
+{
+    return float3(c.x + c.y - c.z, c.x + c.z, c.x - c.y - c.z);
+}
+
+// Blends the jittered 3D view into its history, reprojected with the motion of the closest surface around the pixel
+// so the edges of moving objects move with them. The history is clamped to the colors around the pixel, so surfaces
+// that were uncovered or changed leave no trails, and both are weighted by their inverse luminance so single bright
+// pixels don't flicker.
+kernel void taa_resolve(texture2d<float, access::read> color [[texture(0)]],
+                        texture2d<half, access::read> motion [[texture(1)]],
+                        depth2d<float, access::read> depth [[texture(2)]],
+                        texture2d<float, access::sample> history [[texture(3)]],
+                        texture2d<float, access::write> resolved [[texture(4)]],
+                        constant TaaUniforms &uniforms [[buffer(0)]], uint2 gid [[thread_position_in_grid]])
+{
+    if (gid.x >= uniforms.width || gid.y >= uniforms.height)
+        return;
+
+    const float4 current = color.read(gid);
+    const int2 last = int2(uniforms.width, uniforms.height) - 1;
+    float3 minimum = rgb_to_ycocg(current.rgb);
+    float3 maximum = minimum;
+    uint2 closest = gid;
+    float closest_depth = depth.read(gid);
+    for (int y = -1; y <= 1; y++)
+    {
+        for (int x = -1; x <= 1; x++)
+        {
+            const uint2 p = uint2(clamp(int2(gid) + int2(x, y), int2(0), last));
+            const float3 c = rgb_to_ycocg(color.read(p).rgb);
+            minimum = min(minimum, c);
+            maximum = max(maximum, c);
+            const float d = depth.read(p);
+            if (d > closest_depth)
+            {
+                closest_depth = d;
+                closest = p;
+            }
+        }
+    }
+
+    const float2 uv = (float2(gid) + 0.5) / float2(uniforms.width, uniforms.height);
+    const float2 previous_uv = uv + float2(motion.read(closest).xy);
+    if (uniforms.reset != 0 || any(previous_uv < 0.0) || any(previous_uv > 1.0))
+    {
+        resolved.write(float4(current.rgb, 1.0), gid);
+        return;
+    }
+
+    constexpr sampler history_sampler(filter::linear, address::clamp_to_edge);
+    const float3 sampled = rgb_to_ycocg(history.sample(history_sampler, previous_uv).rgb);
+    const float3 previous = ycocg_to_rgb(clamp(sampled, minimum, maximum));
+    const float3 luminance = float3(0.2126, 0.7152, 0.0722);
+    const float current_weight = 0.1 / (1.0 + dot(current.rgb, luminance));
+    const float previous_weight = 0.9 / (1.0 + dot(previous, luminance));
+    const float3 blended = current.rgb * current_weight + previous * previous_weight;
+    resolved.write(float4(blended / (current_weight + previous_weight), 1.0), gid);
+}
+
+struct UpscaleInOut
+{
+    float4 position [[position]];
+    float2 uv;
+};
+
+// Full screen triangle with the texture coordinates of the scaled 3D view.
+vertex UpscaleInOut upscale_vertex(unsigned int vid [[vertex_id]])
+{
+    UpscaleInOut out;
+    out.uv = float2(float(vid & 1) * 2.0, float(vid >> 1) * 2.0);
+    out.position = float4(out.uv.x * 2.0 - 1.0, 1.0 - out.uv.y * 2.0, 0.0, 1.0);
+    return out;
+}
+
+// ACES fit of Narkowicz, stretched so that it reaches white at the headroom of the drawable.
+float3 tonemap(float3 radiance, constant ToneMapUniforms &uniforms)
+{
+    const float3 x = radiance * uniforms.exposure / uniforms.headroom;
+    const float3 mapped = (x * (2.51 * x + 0.03)) / (x * (2.43 * x + 0.59) + 0.14);
+    return saturate(mapped) * uniforms.headroom;
+}
+
+// Downsamples source into the next level of the bloom pyramid with a 4 by 4 tent filter. Every group reads the source
+// texels of its pixels and their border into threadgroup memory once. The first level only keeps the radiance above
+// the threshold, with a soft knee below it.
+kernel void bloom_downsample(texture2d<float, access::read> source [[texture(0)]],
+                             texture2d<float, access::write> destination [[texture(1)]],
+                             constant BloomUniforms &uniforms [[buffer(0)]], uint2 gid [[thread_position_in_grid]],
+                             uint2 tid [[thread_position_in_threadgroup]], uint2 group [[threadgroup_position_in_grid]])
+{
+    constexpr int TILE = BLOOM_GROUP_SIZE * 2 + 2;
+    threadgroup half3 tile[TILE][TILE];
+    const int2 origin = int2(group * BLOOM_GROUP_SIZE * 2) - 1;
+    const int2 last = int2(source.get_width(), source.get_height()) - 1;
+    for (uint i = tid.y * BLOOM_GROUP_SIZE + tid.x; i < TILE * TILE; i += BLOOM_GROUP_SIZE * BLOOM_GROUP_SIZE)
+    {
+        const int2 texel = clamp(origin + int2(i % TILE, i / TILE), int2(0), last);
+        float3 color = source.read(uint2(texel)).rgb;
+        if (uniforms.prefilter != 0)
+        {
+            const float brightness = max3(color.r, color.g, color.b);
+            const float soft = clamp(brightness - uniforms.threshold + uniforms.knee, 0.0, 2.0 * uniforms.knee);
+            const float kept = max(soft * soft / (4.0 * uniforms.knee + 1e-4), brightness - uniforms.threshold);
+            color *= kept / max(brightness, 1e-4);
+        }
+        tile[i / TILE][i % TILE] = half3(clamp(color, 0.0, float(HALF_MAX)));
+    }
+    threadgroup_barrier(mem_flags::mem_threadgroup);
+    if (any(gid >= uint2(destination.get_width(), destination.get_height())))
+        return;
+
+    const float weights[4] = {1.0, 3.0, 3.0, 1.0};
+    float3 sum = float3(0.0);
+    for (uint y = 0; y < 4; y++)
+        for (uint x = 0; x < 4; x++)
+            sum += weights[x] * weights[y] * float3(tile[tid.y * 2 + y][tid.x * 2 + x]);
+    destination.write(float4(sum / 64.0, 1.0), gid);
+}
+
+// Adds the coarser level of the bloom pyramid to the downsampled level source into destination, with a 3 by 3 tent of
+// bilinear taps one coarse texel apart. The coarse texels of a group's pixels are read into threadgroup memory once.
+kernel void bloom_upsample(texture2d<float, access::read> coarse [[texture(0)]],
+                           texture2d<float, access::read> source [[texture(1)]],
+                           texture2d<float, access::write> destination [[texture(2)]],
+                           uint2 gid [[thread_position_in_grid]], uint2 tid [[thread_position_in_threadgroup]],
+                           uint2 group [[threadgroup_position_in_grid]])
+{
+    // Pixels of a group cover half as many coarse texels, the taps reach 2 further on every side.
+    constexpr int TILE = BLOOM_GROUP_SIZE / 2 + 4;
+    threadgroup half3 tile[TILE][TILE];
+    const int2 origin = int2(group * BLOOM_GROUP_SIZE / 2) - 2;
+    const int2 last = int2(coarse.get_width(), coarse.get_height()) - 1;
+    for (uint i = tid.y * BLOOM_GROUP_SIZE + tid.x; i < TILE * TILE; i += BLOOM_GROUP_SIZE * BLOOM_GROUP_SIZE)
+    {
+        const int2 texel = clamp(origin + int2(i % TILE, i / TILE), int2(0), last);
+        tile[i / TILE][i % TILE] = half3(coarse.read(uint2(texel)).rgb);
+    }
+    threadgroup_barrier(mem_flags::mem_threadgroup);
+    if (any(gid >= uint2(destination.get_width(), destination.get_height())))
+        return;
+
+    // Center of the pixel in coarse texels of the tile.
+    const float2 center = (float2(tid) + 0.5) * 0.5 + 1.5;
+    float3 sum = float3(0.0);
+    for (int y = -1; y <= 1; y++)
+    {
+        for (int x = -1; x <= 1; x++)
+        {
+            const float2 p = center + float2(x, y);
+            const int2 i = int2(floor(p));
+            const float2 f = p - floor(p);
+            const float3 top = mix(float3(tile[i.y][i.x]), float3(tile[i.y][i.x + 1]), f.x);
+            const float3 bottom = mix(float3(tile[i.y + 1][i.x]), float3(tile[i.y + 1][i.x + 1]), f.x);
+            sum += float((2 - abs(x)) * (2 - abs(y))) * mix(top, bottom, f.y);
+        }
+    }
+    destination.write(float4(source.read(gid).rgb + sum / 16.0, 1.0), gid);
+}
+
+// Rate mapped views only cover the physical size of their rate map, which is stretched back over the screen. The post
+// effects are fused into the pass: bloom is added before exposure and tonemapping, the view is graded through the LUT
+// and darkened by the vignette after it.
+fragment half4 upscale_fragment(UpscaleInOut in [[stage_in]], texture2d<float> color [[texture(0)]],
+                                constant rasterization_rate_map_data *rates
+                                [[buffer(0), function_constant(rate_mapped)]],
+                                constant ToneMapUniforms &tonemap_uniforms [[buffer(1)]],
+                                texture2d<float> bloom [[texture(1), function_constant(bloom_effect)]],
+                                texture3d<float> grading [[texture(2), function_constant(color_grading)]])
+{
+    constexpr sampler upscale_sampler(filter::linear, address::clamp_to_edge);
+    float2 uv = in.uv;
+    if (rate_mapped)
+    {
+        const float2 size = float2(color.get_width(), color.get_height());
+        const rasterization_rate_map_decoder map(*rates);
+        uv = map.map_screen_to_physical_coordinates(uv * size) / size;
+    }
+    const float4 sampled = color.sample(upscale_sampler, uv);
+    if (!tonemap_uniforms.enabled && post_effects == 0)
+        return half4(sampled);
+
+    float3 radiance = sampled.rgb;
+    if (bloom_effect)
+        radiance += bloom.sample(upscale_sampler, uv).rgb * tonemap_uniforms.bloom_intensity;
+    float3 mapped = tonemap_uniforms.enabled ? tonemap(radiance, tonemap_uniforms) : radiance;
+    if (color_grading)
+    {
+        // The LUT covers SDR, brighter values are graded at white and scaled back up.
+        const float brightness = max(max3(mapped.r, mapped.g, mapped.b), 1.0);
+        const float size = float(grading.get_width());
+        const float3 coords = (saturate(mapped / brightness) * (size - 1.0) + 0.5) / size;
+        mapped = grading.sample(upscale_sampler, coords).rgb * brightness;
+    }
+    if (vignette_effect)
+    {
+        // Distance to the center relative to the corners.
+        const float2 scale = float2(tonemap_uniforms.aspect, 1.0);
+        const float distance = length((in.uv - 0.5) * scale) / length(0.5 * scale);
+        mapped *= 1.0 - tonemap_uniforms.vignette_intensity *
+                            smoothstep(tonemap_uniforms.vignette_radius, 1.0, distance);
+    }
+    return half4(half3(mapped), tonemap_uniforms.enabled ? 1.0h : half(sampled.a));
+}
+
+// Compute primitives of gpu_primitives.hpp. Threads of a tile load and store its elements PRIMITIVE_THREADS apart, so
+// neighboring threads access neighboring words.
+constant uint primitive_items [[function_constant(PRIMITIVE_ITEMS_CONSTANT_INDEX)]];
+
+// SIMD-groups are as narrow as 4 threads on some GPUs. Histograms of radix sorts have a thread per bin.
+#define PRIMITIVE_MAX_SIMD_GROUPS (PRIMITIVE_THREADS / 4)
+static_assert(PRIMITIVE_THREADS == RADIX_BINS, "radix sorts count every bin with a thread");
+
+// Exclusive prefix sum of value over the threads of a threadgroup, total receives the sum of all values. The first
+// thread scans the sums of the SIMD-groups.
+uint threadgroup_exclusive_sum(uint value, threadgroup uint *partials, thread uint &total, uint thread_index,
+                               uint lane, uint simd_group, uint simd_groups)
+{
+    const uint prefix = simd_prefix_exclusive_sum(value);
+    const uint sum = simd_sum(value);
+    if (lane == 0)
+        partials[simd_group] = sum;
+    threadgroup_barrier(mem_flags::mem_threadgroup);
+    if (thread_index == 0)
+    {
+        uint running = 0;
+        for (uint s = 0; s < simd_groups; s++)
+        {
+            const uint partial = partials[s];
+            partials[s] = running;
+            running += partial;
+        }
+        partials[simd_groups] = running;
+    }
+    threadgroup_barrier(mem_flags::mem_threadgroup);
+    const uint result = partials[simd_group] + prefix;
+    total = partials[simd_groups];
+    threadgroup_barrier(mem_flags::mem_threadgroup);
+    return result;
+}
+
+// Sum of every tile of a prefix sum, whose sums are scanned before the tiles are.
+kernel void scan_reduce(const device uint *input [[buffer(0)]], device uint *sums [[buffer(1)]],
+                        constant PrimitiveUniforms &uniforms [[buffer(2)]], uint tile [[threadgroup_position_in_grid]],
+                        uint thread_index [[thread_index_in_threadgroup]], uint lane [[thread_index_in_simdgroup]],
+                        uint simd_group [[simdgroup_index_in_threadgroup]],
+                        uint simd_groups [[simdgroups_per_threadgroup]])
+{
+    threadgroup uint partials[PRIMITIVE_MAX_SIMD_GROUPS + 1];
+    const uint start = tile * PRIMITIVE_THREADS * primitive_items;
+    uint sum = 0;
+    for (uint i = 0; i < primitive_items; i++)
+    {
+        const uint index = start + i * PRIMITIVE_THREADS + thread_index;
+        sum += index < uniforms.count ? input[index] : 0;
+    }
+
+    uint total;
+    threadgroup_exclusive_sum(sum, partials, total, thread_index, lane, simd_group, simd_groups);
+    if (thread_index == 0)
+        sums[tile] = total;
+}
+
+// Exclusive prefix sum of every tile, plus the scanned sum of the tiles before it with offsets. Output may be the
+// input, every tile is read before it is written. Threads sum consecutive elements of the tile in threadgroup memory.
+kernel void scan_tiles(const device uint *input [[buffer(0)]], device uint *output [[buffer(1)]],
+                       const device uint *offsets [[buffer(2)]], constant PrimitiveUniforms &uniforms [[buffer(3)]],
+                       uint tile [[threadgroup_position_in_grid]], uint thread_index [[thread_index_in_threadgroup]],
+                       uint lane [[thread_index_in_simdgroup]], uint simd_group [[simdgroup_index_in_threadgroup]],
+                       uint simd_groups [[simdgroups_per_threadgroup]])
+{
+    threadgroup uint values[PRIMITIVE_THREADS * PRIMITIVE_MAX_ITEMS];
+    threadgroup uint partials[PRIMITIVE_MAX_SIMD_GROUPS + 1];
+    const uint start = tile * PRIMITIVE_THREADS * primitive_items;
+    for (uint i = 0; i < primitive_items; i++)
+    {
+        const uint index = start + i * PRIMITIVE_THREADS + thread_index;
+        values[i * PRIMITIVE_THREADS + thread_index] = index < uniforms.count ? input[index] : 0;
+    }
+    threadgroup_barrier(mem_flags::mem_threadgroup);
+
+    threadgroup uint *items = values + thread_index * primitive_items;
+    uint sum = 0;
+    for (uint i = 0; i < primitive_items; i++)
+        sum += items[i];
+    uint total;
+    uint running = threadgroup_exclusive_sum(sum, partials, total, thread_index, lane, simd_group, simd_groups);
+    running += uniforms.offsets != 0 ? offsets[tile] : 0;
+    for (uint i = 0; i < primitive_items; i++)
+    {
+        const uint value = items[i];
+        items[i] = running;
+        running += value;
+    }
+    threadgroup_barrier(mem_flags::mem_threadgroup);
+
+    for (uint i = 0; i < primitive_items; i++)
+    {
+        const uint index = start + i * PRIMITIVE_THREADS + thread_index;
+        if (index < uniforms.count)
+            output[index] = values[i * PRIMITIVE_THREADS + thread_index];
+    }
+}
+
+// Copies the values whose flag is 1 to their scanned offset in output, count receives the number of copied values.
+// Without values the first thread writes a count of 0.
+kernel void compact_values(const device uint *values [[buffer(0)]], const device uint *flags [[buffer(1)]],
+                           const device uint *offsets [[buffer(2)]], device uint *output [[buffer(3)]],
+                           device uint *count [[buffer(4)]], constant PrimitiveUniforms &uniforms [[buffer(5)]],
+                           uint i [[thread_position_in_grid]])
+{
+    if (i >= uniforms.count)
+    {
+        if (i == 0)
+            *count = 0;
+        return;
+    }
+    if (flags[i] != 0)
+        output[offsets[i]] = values[i];
+    if (i == uniforms.count - 1)
+        *count = offsets[i] + flags[i];
+}
+
+uint radix_digit(const device uint *pairs, uint index, constant PrimitiveUniforms &uniforms)
+{
+    return (pairs[index * uniforms.words + uniforms.shift / 32] >> (uniforms.shift % 32)) & (RADIX_BINS - 1);
+}
+
+// Counts of every digit in a tile, stored digit by digit so that their exclusive prefix sum is where the pairs of a
+// tile with a digit start in the sorted pairs.
+kernel void radix_histogram(const device uint *pairs [[buffer(0)]], device uint *histograms [[buffer(1)]],
+                            constant PrimitiveUniforms &uniforms [[buffer(2)]],
+                            uint tile [[threadgroup_position_in_grid]],
+                            uint thread_index [[thread_index_in_threadgroup]])
+{
+    threadgroup atomic_uint counts[RADIX_BINS];
+    atomic_store_explicit(&counts[thread_index], 0, memory_order_relaxed);
+    threadgroup_barrier(mem_flags::mem_threadgroup);
+
+    const uint start = tile * PRIMITIVE_THREADS * primitive_items;
+    for (uint i = 0; i < primitive_items; i++)
+    {
+        const uint index = start + i * PRIMITIVE_THREADS + thread_index;
+        if (index < uniforms.count)
+            atomic_fetch_add_explicit(&counts[radix_digit(pairs, index, uniforms)], 1, memory_order_relaxed);
+    }
+    threadgroup_barrier(mem_flags::mem_threadgroup);
+    histograms[thread_index * uniforms.tiles + tile] =
+        atomic_load_explicit(&counts[thread_index], memory_order_relaxed);
+}
+
+// Moves the pairs of a tile to the offsets of their digit in the scanned histograms, in the order they are in so that
+// passes keep the order of the digits sorted before. Lanes of a SIMD-group find the lanes below them with the same
+// digit from a ballot of every bit of the digit, SIMD-groups take their offsets one after the other.
+kernel void radix_scatter(const device uint *pairs [[buffer(0)]], device uint *sorted [[buffer(1)]],
+                          const device uint *histograms [[buffer(2)]],
+                          constant PrimitiveUniforms &uniforms [[buffer(3)]],
+                          uint tile [[threadgroup_position_in_grid]], uint thread_index [[thread_index_in_threadgroup]],
+                          uint lane [[thread_index_in_simdgroup]], uint simd_group [[simdgroup_index_in_threadgroup]],
+                          uint simd_groups [[simdgroups_per_threadgroup]])
+{
+    threadgroup uint offsets[RADIX_BINS];
+    offsets[thread_index] = histograms[thread_index * uniforms.tiles + tile];
+    threadgroup_barrier(mem_flags::mem_threadgroup);
+
+    const uint start = tile * PRIMITIVE_THREADS * primitive_items;
+    const simd_vote::vote_t below = (simd_vote::vote_t(1) << lane) - 1;
+    for (uint i = 0; i < primitive_items; i++)
+    {
+        const uint index = start + i * PRIMITIVE_THREADS + thread_index;
+        const bool valid = index < uniforms.count;
+        const uint digit = valid ? radix_digit(pairs, index, uniforms) : 0;
+        simd_vote::vote_t peers = static_cast<simd_vote::vote_t>(simd_ballot(valid));
+        for (uint bit = 0; bit < RADIX_BITS; bit++)
+        {
+            const bool set = ((digit >> bit) & 1) != 0;
+            const simd_vote::vote_t lanes = static_cast<simd_vote::vote_t>(simd_ballot(set));
+            peers &= set ? lanes : ~lanes;
+        }
+        const uint rank = popcount(peers & below);
+
+        for (uint s = 0; s < simd_groups; s++)
+        {
+            if (s == simd_group)
+            {
+                const uint offset = valid ? offsets[digit] + rank : 0;
+                simdgroup_barrier(mem_flags::mem_threadgroup);
+                // The last lane of a digit moves its offset past all of them.
+                if (valid && (peers >> lane) == 1)
+                    offsets[digit] = offset + 1;
+                for (uint w = 0; valid && w < uniforms.words; w++)
+                    sorted[offset * uniforms.words + w] = pairs[index * uniforms.words + w];
+            }
+            threadgroup_barrier(mem_flags::mem_threadgroup);
+        }
+    }
+}
+
+kernel void copy_words(const device uint *input [[buffer(0)]], device uint *output [[buffer(1)]],
+                       constant PrimitiveUniforms &uniforms [[buffer(2)]], uint i [[thread_position_in_grid]])
+{
+    if (i < uniforms.count)
+        output[i] = input[i];
+}
+
+// Sum of the values in [offsets[i], offsets[i + 1]) for every segment i, one SIMD-group per segment.
+kernel void segmented_sum(const device float *values [[buffer(0)]], const device uint *offsets [[buffer(1)]],
+                          device float *sums [[buffer(2)]], constant PrimitiveUniforms &uniforms [[buffer(3)]],
+                          uint group [[threadgroup_position_in_grid]], uint lane [[thread_index_in_simdgroup]],
+                          uint simd_width [[threads_per_simdgroup]],
+                          uint simd_group [[simdgroup_index_in_threadgroup]],
+                          uint simd_groups [[simdgroups_per_threadgroup]])
+{
+    const uint segment = group * simd_groups + simd_group;
+    if (segment >= uniforms.count)
+        return;
+
+    const uint end = offsets[segment + 1];
+    float sum = 0.0;
+    for (uint i = offsets[segment] + lane; i < end; i += simd_width)
+        sum += values[i];
+    sum = simd_sum(sum);
+    if (lane == 0)
+        sums[segment] = sum;
+}
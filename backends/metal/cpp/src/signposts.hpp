@@ -0,0 +1,21 @@
+#ifndef METALCPP_SRC_SIGNPOSTS_HPP
+#define METALCPP_SRC_SIGNPOSTS_HPP
+
+#include <os/log.h>
+#include <os/signpost.h>
+
+// Log the CPU stages of the renderer are marked on with os_signpost intervals, Instruments shows them under the
+// rs.rfw.metal subsystem next to the command buffers of a Metal System Trace.
+inline os_log_t signpost_log()
+{
+    static const os_log_t log = os_log_create("rs.rfw.metal", "Renderer");
+    return log;
+}
+
+// Identifies one interval, so intervals of the same name on different threads don't get mixed up.
+inline os_signpost_id_t signpost_id()
+{
+    return os_signpost_id_generate(signpost_log());
+}
+
+#endif // METALCPP_SRC_SIGNPOSTS_HPP
@@ -0,0 +1,300 @@
+#ifndef METALCPP_SRC_STAGING_BUFFER_HPP
+#define METALCPP_SRC_STAGING_BUFFER_HPP
+
+#import <Metal/Metal.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Shared memory that CPU data is written to before a blit copies it into GPU-only buffers and textures. Copies are
+// batched up to the staging capacity, batches are either waited for with flush() or left to complete in the
+// background with submit(). Destinations must not be in use by the GPU until their batch completed.
+class StagingBuffer
+{
+  public:
+    static constexpr size_t CAPACITY = 8 * 1024 * 1024;
+    static constexpr size_t ALIGNMENT = 16;
+
+    // Returns memory that ends up at offset in buffer once flushed. Sizes must be multiples of 4 bytes, as blits
+    // require.
+    void *stage(id<MTLDevice> device, id<MTLCommandQueue> queue, id<MTLBuffer> buffer, size_t offset, size_t size)
+    {
+        Copy copy = {};
+        copy.buffer = buffer;
+        copy.offset = offset;
+        copy.size = size;
+        return reserve(device, queue, copy);
+    }
+
+    // Returns memory for one mip level of a 2D texture, or the region of it at origin, rows are bytes_per_row apart.
+    // Rows of block compressed formats hold a full row of blocks.
+    void *stage(id<MTLDevice> device, id<MTLCommandQueue> queue, id<MTLTexture> texture, unsigned int level,
+                unsigned int width, unsigned int height, size_t bytes_per_row, size_t bytes_per_image,
+                MTLOrigin origin = MTLOriginMake(0, 0, 0))
+    {
+        Copy copy = {};
+        copy.texture = texture;
+        copy.level = level;
+        copy.origin = origin;
+        copy.width = width;
+        copy.height = height;
+        copy.bytes_per_row = bytes_per_row;
+        copy.size = bytes_per_image;
+        return reserve(device, queue, copy);
+    }
+
+    // Copies one mip level of a 2D texture out of source instead of staging memory, with the batch of the copies staged
+    // so far. Source must not change until the batch completed.
+    void copy(id<MTLCommandQueue> queue, id<MTLBuffer> source, size_t source_offset, id<MTLTexture> texture,
+              unsigned int level, unsigned int width, unsigned int height, size_t bytes_per_row, size_t bytes_per_image)
+    {
+        if (_queue != queue)
+            submit();
+        _queue = queue;
+
+        Copy copy = {};
+        copy.source = source;
+        copy.staging_offset = source_offset;
+        copy.texture = texture;
+        copy.level = level;
+        copy.width = width;
+        copy.height = height;
+        copy.bytes_per_row = bytes_per_row;
+        copy.size = bytes_per_image;
+        _copies.push_back(copy);
+    }
+
+    // Fills the mip chain of texture from its first level once the copies staged so far completed.
+    void generate_mipmaps(id<MTLCommandQueue> queue, id<MTLTexture> texture)
+    {
+        if (_queue != queue)
+            submit();
+        _queue = queue;
+        _mipmaps.push_back(texture);
+    }
+
+    // Calls encode with the command buffer of the batch once its copies and mipmaps are encoded, for passes that read
+    // what the batch uploads.
+    void encode(id<MTLCommandQueue> queue, void (^encode)(id<MTLCommandBuffer>))
+    {
+        if (_queue != queue)
+            submit();
+        _queue = queue;
+        _encoders.push_back(encode);
+    }
+
+    // Commits the copies staged so far without waiting for them, returns the value completed() reports once they are
+    // done. Batches submitted to the same queue complete in order.
+    uint64_t submit()
+    {
+        if (_copies.empty() && _mipmaps.empty() && _encoders.empty())
+            return _submitted;
+
+        id<MTLCommandBuffer> command_buffer = [_queue commandBuffer];
+        command_buffer.label = @"StagingBuffer";
+        id<MTLBlitCommandEncoder> blit = [command_buffer blitCommandEncoder];
+        blit.label = @"StagingBuffer::submit";
+        for (const Copy &copy : _copies)
+        {
+            if (copy.texture != nil)
+            {
+                [blit copyFromBuffer:copy.source != nil ? copy.source : _buffer
+                           sourceOffset:copy.staging_offset
+                      sourceBytesPerRow:copy.bytes_per_row
+                    sourceBytesPerImage:copy.size
+                             sourceSize:MTLSizeMake(copy.width, copy.height, 1)
+                              toTexture:copy.texture
+                       destinationSlice:0
+                       destinationLevel:copy.level
+                      destinationOrigin:copy.origin];
+            }
+            else
+            {
+                [blit copyFromBuffer:_buffer
+                         sourceOffset:copy.staging_offset
+                             toBuffer:copy.buffer
+                    destinationOffset:copy.offset
+                                 size:copy.size];
+            }
+        }
+        [blit endEncoding];
+
+        // A separate encoder, so mip generation reads the first levels after they were copied.
+        if (!_mipmaps.empty())
+        {
+            blit = [command_buffer blitCommandEncoder];
+            blit.label = @"StagingBuffer::generate_mipmaps";
+            for (const auto &texture : _mipmaps)
+                [blit generateMipmapsForTexture:texture];
+            [blit endEncoding];
+        }
+        for (const auto &encode : _encoders)
+            encode(command_buffer);
+
+        if (_event == nil)
+            _event = [_queue.device newSharedEvent];
+        [command_buffer encodeSignalEvent:_event value:++_submitted];
+        if (_completed_handler)
+            [command_buffer addCompletedHandler:_completed_handler];
+        [command_buffer commit];
+
+        _in_flight.push_back({_buffer, command_buffer});
+        _buffer = nil;
+        _copies.clear();
+        _mipmaps.clear();
+        _encoders.clear();
+        _used = 0;
+        return _submitted;
+    }
+
+    // Called with the command buffer of every batch once it completed.
+    void set_completed_handler(MTLCommandBufferHandler handler)
+    {
+        _completed_handler = handler;
+    }
+
+    bool completed(uint64_t value) const
+    {
+        return value == 0 || (_event != nil && _event.signaledValue >= value);
+    }
+
+    // Copies everything staged so far into place and waits for the GPU to finish.
+    void flush()
+    {
+        submit();
+        for (const Batch &batch : _in_flight)
+        {
+            [batch.command_buffer waitUntilCompleted];
+            recycle(batch.buffer);
+        }
+        _in_flight.clear();
+    }
+
+    // Bytes of the staging memory that is in use, in flight or kept for reuse.
+    size_t allocated_size() const
+    {
+        size_t size = [_buffer allocatedSize];
+        for (const Batch &batch : _in_flight)
+            size += [batch.buffer allocatedSize];
+        for (id<MTLBuffer> buffer : _free)
+            size += [buffer allocatedSize];
+        return size;
+    }
+
+    // Bytes staged since the staging buffer was created.
+    uint64_t staged() const
+    {
+        return _staged;
+    }
+
+    // Drops the staging memory, the next stage() allocates it again.
+    void release()
+    {
+        flush();
+        _buffer = nil;
+        _free.clear();
+        _queue = nil;
+    }
+
+  private:
+    // Staging memory of submitted batches is reused once the GPU finished copying out of it, beyond this many batches
+    // in flight stage() waits for the oldest one.
+    static constexpr size_t MAX_BATCHES_IN_FLIGHT = 8;
+
+    struct Copy
+    {
+        // Buffer copied from at staging_offset, nil for the staging memory.
+        id<MTLBuffer> source;
+        id<MTLBuffer> buffer;
+        id<MTLTexture> texture;
+        size_t offset;
+        size_t staging_offset;
+        size_t size;
+        unsigned int level;
+        unsigned int width;
+        unsigned int height;
+        size_t bytes_per_row;
+        MTLOrigin origin;
+    };
+
+    struct Batch
+    {
+        id<MTLBuffer> buffer;
+        id<MTLCommandBuffer> command_buffer;
+    };
+
+    void *reserve(id<MTLDevice> device, id<MTLCommandQueue> queue, Copy copy)
+    {
+        if (_queue != queue || (_buffer != nil && _used + copy.size > _buffer.length))
+            submit();
+        _queue = queue;
+
+        if (_buffer != nil && _buffer.length < copy.size)
+        {
+            recycle(_buffer);
+            _buffer = nil;
+        }
+        if (_buffer == nil)
+            _buffer = acquire(device, copy.size);
+
+        copy.staging_offset = _used;
+        _copies.push_back(copy);
+        _staged += copy.size;
+        _used = (_used + copy.size + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT;
+        return reinterpret_cast<std::byte *>([_buffer contents]) + copy.staging_offset;
+    }
+
+    id<MTLBuffer> acquire(id<MTLDevice> device, size_t size)
+    {
+        while (!_in_flight.empty())
+        {
+            const Batch &batch = _in_flight.front();
+            const bool done = batch.command_buffer.status >= MTLCommandBufferStatusCompleted;
+            if (!done && _in_flight.size() < MAX_BATCHES_IN_FLIGHT)
+                break;
+
+            [batch.command_buffer waitUntilCompleted];
+            recycle(batch.buffer);
+            _in_flight.erase(_in_flight.begin());
+        }
+
+        for (size_t i = 0; i < _free.size(); i++)
+        {
+            if (_free[i].length < size)
+                continue;
+
+            id<MTLBuffer> buffer = _free[i];
+            _free.erase(_free.begin() + static_cast<std::ptrdiff_t>(i));
+            return buffer;
+        }
+
+        id<MTLBuffer> buffer = [device newBufferWithLength:std::max(CAPACITY, size)
+                                                   options:MTLResourceStorageModeShared |
+                                                           MTLResourceCPUCacheModeWriteCombined];
+        buffer.label = @"StagingBuffer";
+        return buffer;
+    }
+
+    void recycle(id<MTLBuffer> buffer)
+    {
+        if (buffer != nil && _free.size() < MAX_BATCHES_IN_FLIGHT)
+            _free.push_back(buffer);
+    }
+
+    id<MTLCommandQueue> _queue = nil;
+    id<MTLBuffer> _buffer = nil;
+    std::vector<Copy> _copies;
+    std::vector<id<MTLTexture>> _mipmaps;
+    std::vector<void (^)(id<MTLCommandBuffer>)> _encoders;
+    size_t _used = 0;
+    uint64_t _staged = 0;
+    std::vector<Batch> _in_flight;
+    std::vector<id<MTLBuffer>> _free;
+    id<MTLSharedEvent> _event = nil;
+    uint64_t _submitted = 0;
+    MTLCommandBufferHandler _completed_handler = nil;
+};
+
+#endif // METALCPP_SRC_STAGING_BUFFER_HPP
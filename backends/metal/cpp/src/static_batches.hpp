@@ -0,0 +1,123 @@
+#ifndef METALCPP_SRC_STATIC_BATCHES_HPP
+#define METALCPP_SRC_STATIC_BATCHES_HPP
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "library.h"
+#include "structs.h"
+
+// Object space copy of a mesh flagged STATIC, indexed even when the mesh was set without indices.
+struct StaticMesh
+{
+    std::vector<Vertex3D> vertices;
+    std::vector<unsigned int> indices;
+    Aabb bounds = {};
+};
+
+// Static meshes of one cell merged in world space, drawn as mesh id with one identity instance.
+struct StaticBatch
+{
+    unsigned int id = 0;
+    bool caster = false;
+    std::vector<unsigned int> meshes;
+    std::vector<Vertex3D> vertices;
+    std::vector<unsigned int> indices;
+    Aabb bounds = {};
+};
+
+// Cell of a static mesh by the center of its world bounds, casters and other meshes are batched apart.
+struct StaticCell
+{
+    int x;
+    int y;
+    int z;
+    bool caster;
+
+    bool operator<(const StaticCell &other) const
+    {
+        if (x != other.x)
+            return x < other.x;
+        if (y != other.y)
+            return y < other.y;
+        if (z != other.z)
+            return z < other.z;
+        return caster < other.caster;
+    }
+};
+
+inline StaticMesh copy_static_mesh(const Vertex3D *vertices, unsigned int num_vertices, const unsigned int *indices,
+                                   unsigned int num_indices)
+{
+    StaticMesh mesh;
+    mesh.vertices.assign(vertices, vertices + num_vertices);
+    if (indices)
+        mesh.indices.assign(indices, indices + num_indices);
+    else
+    {
+        mesh.indices.resize(num_vertices);
+        for (unsigned int i = 0; i < num_vertices; i++)
+            mesh.indices[i] = i;
+    }
+
+    glm::vec3 lo(1e30f);
+    glm::vec3 hi(-1e30f);
+    for (const Vertex3D &v : mesh.vertices)
+    {
+        lo = glm::min(lo, glm::vec3(v.v_x, v.v_y, v.v_z));
+        hi = glm::max(hi, glm::vec3(v.v_x, v.v_y, v.v_z));
+    }
+    mesh.bounds = {simd_make_float4(lo.x, lo.y, lo.z, 0.0f), simd_make_float4(hi.x, hi.y, hi.z, 0.0f)};
+    return mesh;
+}
+
+// Appends mesh transformed by matrix to the batch. Normals transform with the inverse transpose, mirroring matrices
+// flip the winding of the triangles and the sign of the bitangents.
+inline void append_static_mesh(StaticBatch &batch, const StaticMesh &mesh, const glm::mat4 &matrix)
+{
+    const glm::mat3 linear = glm::mat3(matrix);
+    const glm::mat3 normal_matrix = glm::transpose(glm::inverse(linear));
+    const bool mirrored = glm::determinant(linear) < 0.0f;
+    const auto base = static_cast<unsigned int>(batch.vertices.size());
+    batch.vertices.reserve(batch.vertices.size() + mesh.vertices.size());
+    for (const Vertex3D &source : mesh.vertices)
+    {
+        Vertex3D v = source;
+        const glm::vec3 p = glm::vec3(matrix * glm::vec4(v.v_x, v.v_y, v.v_z, 1.0f));
+        const glm::vec3 n = normal_matrix * glm::vec3(v.n_x, v.n_y, v.n_z);
+        const glm::vec3 t = linear * glm::vec3(v.t_x, v.t_y, v.t_z);
+        const float n_length = glm::length(n);
+        const float t_length = glm::length(t);
+        v.v_x = p.x;
+        v.v_y = p.y;
+        v.v_z = p.z;
+        if (n_length > 0.0f)
+        {
+            v.n_x = n.x / n_length;
+            v.n_y = n.y / n_length;
+            v.n_z = n.z / n_length;
+        }
+        if (t_length > 0.0f)
+        {
+            v.t_x = t.x / t_length;
+            v.t_y = t.y / t_length;
+            v.t_z = t.z / t_length;
+        }
+        if (mirrored)
+            v.t_w = -v.t_w;
+        batch.vertices.push_back(v);
+    }
+
+    batch.indices.reserve(batch.indices.size() + mesh.indices.size());
+    for (size_t i = 0; i + 2 < mesh.indices.size(); i += 3)
+    {
+        batch.indices.push_back(base + mesh.indices[i]);
+        batch.indices.push_back(base + mesh.indices[mirrored ? i + 2 : i + 1]);
+        batch.indices.push_back(base + mesh.indices[mirrored ? i + 1 : i + 2]);
+    }
+}
+
+#endif // METALCPP_SRC_STATIC_BATCHES_HPP
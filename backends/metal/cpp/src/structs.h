@@ -7,6 +7,207 @@
 #define MATERIALS_ARG_INDEX 3
 #define INSTANCES_ARG_INDEX 4
 #define INSTANCES_2D_ARG_INDEX 5
+#define PACKED_VERTICES_ARG_INDEX 6
+#define VISIBLE_INSTANCES_ARG_INDEX 7
+#define ANIM_VERTICES_ARG_INDEX 8
+#define VIRTUAL_PAGES_ARG_INDEX 9
+#define INSTANCE_OVERRIDES_ARG_INDEX 10
+#define SAMPLERS_ARG_INDEX 11
+#define TEXTURE_LAYERS_ARG_INDEX 12
+#define TEXTURE_ARRAYS_ARG_INDEX 13
+#define POSITIONS_ARG_INDEX 14
+#define SCENE_ARGUMENT_COUNT 15
+
+// Small textures are packed into layers of texture arrays, the layer table holds the array << 16 | layer of every
+// texture index or NO_TEXTURE_LAYER for textures of their own. See set_texture_packing.
+#define NO_TEXTURE_LAYER 0xFFFFFFFF
+
+// Entries of the sampler table, DeviceMaterial::sampler picks the one its maps are sampled with. The default entry and
+// the 2D entry hold the filters set_texture_filtering chose for them.
+#define SAMPLER_DEFAULT 0
+#define SAMPLER_TRILINEAR 1
+#define SAMPLER_ANISOTROPIC 2
+#define SAMPLER_TRILINEAR_CLAMP 3
+#define SAMPLER_NEAREST 4
+#define SAMPLER_2D 5
+#define SAMPLER_COUNT 6
+
+#define INSTANCE_CULLING_CONSTANT_INDEX 0
+#define OCCLUSION_CULLING_CONSTANT_INDEX 2
+
+// Variants of the 2D fragment function by the texture ids of a mesh's vertices, only meshes that mix textured and
+// untextured vertices test the texture id per fragment.
+#define TEXTURE_MODE_2D_CONSTANT_INDEX 3
+#define TEXTURE_MODE_2D_NONE 0
+#define TEXTURE_MODE_2D_ALL 1
+#define TEXTURE_MODE_2D_MIXED 2
+#define TEXTURE_MODES_2D 3
+
+// Variants of the passes that cover the physical pixels of a rasterization rate map instead of screen pixels.
+#define RATE_MAP_CONSTANT_INDEX 4
+
+// Variants of the kernels that trace rays, against the acceleration structures on GPUs with ray tracing support or
+// else against the compute BVH of bvh_scene.hpp. The BVH is bound as an argument buffer of BvhScene.
+#define HARDWARE_TRACING_CONSTANT_INDEX 5
+#define BVH_SCENE_BUFFER_INDEX 16
+#define BVH_TOP_NODES_ARG_INDEX 0
+#define BVH_INSTANCES_ARG_INDEX 1
+#define BVH_NODES_ARG_INDEX 2
+#define BVH_TRIANGLES_ARG_INDEX 3
+#define BVH_SCENE_ARGUMENT_COUNT 4
+
+// Variants of the overlay pass by the post effects it applies, a mask of the POST_ bits. Bloom is downsampled into up
+// to BLOOM_LEVELS levels below half the size of the view, by groups of BLOOM_GROUP_SIZE by BLOOM_GROUP_SIZE pixels.
+#define POST_EFFECTS_CONSTANT_INDEX 6
+#define POST_BLOOM 1
+#define POST_COLOR_GRADING 2
+#define POST_VIGNETTE 4
+#define BLOOM_LEVELS 6
+#define BLOOM_GROUP_SIZE 8
+
+// Compute primitives of gpu_primitives.hpp work on tiles of PRIMITIVE_THREADS threads times the items per thread
+// their pipelines are specialized with for the GPU family. Radix sorts sort by RADIX_BITS bits per pass, with one
+// thread per bin.
+#define PRIMITIVE_ITEMS_CONSTANT_INDEX 7
+#define PRIMITIVE_THREADS 256
+#define PRIMITIVE_MAX_ITEMS 8
+#define RADIX_BITS 8
+#define RADIX_BINS 256
+
+#define ICB_COMMANDS_ARG_INDEX 0
+
+// Coarser levels of detail a culled draw can switch to, see set_3d_mesh_lods.
+#define MAX_MESH_LODS 4
+
+// Mesh and instance of pick results at pixels that show no 3D instance, see pick.
+#define NO_PICK_HIT 0xFFFFFFFF
+#define NO_RAY_HIT 0xFFFFFFFF
+#define VISIBILITY_UNTESTED 0xFFFFFFFFFFFFFFFFull
+
+// Most expensive meshes reported by get_mesh_costs.
+#define MESH_COST_COUNT 16
+// Whole milliseconds of frame intervals counted by FramePacingStats, the last bucket counts longer ones.
+#define PACING_HISTOGRAM_BUCKETS 64
+
+// Texture LOD feedback of the 3D pass, every frame the pixel at phase of each block writes the finest level its
+// material maps sample relative to the levels each texture has resident. 0 textures disables it. Virtual textures
+// set the bits of the pages they sample in the virtual_words words after those of the textures.
+#define TEXTURE_FEEDBACK_BLOCK 8
+#define NO_TEXTURE_FEEDBACK 0x7FFFFFFF
+typedef struct
+{
+    unsigned int phase;
+    unsigned int num_textures;
+    unsigned int virtual_words;
+} TextureFeedbackUniforms;
+
+// Virtual textures are split into tiles of VIRTUAL_TILE_SIZE texels on every level, tiles are sampled from a cache
+// of tiles with a border of their neighbouring texels. The page buffer starts with the number of texture indices it
+// covers and the word offset of the VirtualTexture of each index, NO_VIRTUAL_TEXTURE for regular textures. The page
+// of every tile holds the cache tile x, y and level of the finest resident tile covering it in bits 0, 12 and 24, or
+// NO_VIRTUAL_TILE.
+#define VIRTUAL_TILE_SIZE 128
+#define VIRTUAL_TILE_BORDER 4
+#define VIRTUAL_TILE_STRIDE (VIRTUAL_TILE_SIZE + 2 * VIRTUAL_TILE_BORDER)
+#define VIRTUAL_TEXTURE_MAX_LEVELS 16
+#define NO_VIRTUAL_TEXTURE 0xFFFFFFFF
+#define NO_VIRTUAL_TILE 0xFFFFFFFF
+typedef struct
+{
+    unsigned int width;
+    unsigned int height;
+    // The last level fits a single tile.
+    unsigned int levels;
+    // Feedback word of the first page.
+    unsigned int feedback;
+    // Word offsets of the pages of each level, the pages of a level are in rows of tiles.
+    unsigned int pages[VIRTUAL_TEXTURE_MAX_LEVELS];
+} VirtualTexture;
+
+// Screen tiles of tiled forward lighting, each tile stores a light count followed by its light indices.
+#define LIGHT_TILE_SIZE 16
+#define MAX_LIGHTS_PER_TILE 255
+#define LIGHT_TILE_STRIDE (MAX_LIGHTS_PER_TILE + 1)
+
+// Color attachments of the deferred pass, the G-buffer only lives in tile memory.
+#define GBUFFER_ALBEDO_INDEX 1
+#define GBUFFER_NORMAL_INDEX 2
+#define GBUFFER_DEPTH_INDEX 3
+#define DEFERRED_VIEW_CONSTANT_INDEX 1
+
+// Color attachments transparent meshes accumulate into, attachment 0 holds the opaque color they are composited over.
+#define TRANSPARENT_ACCUM_INDEX 1
+#define TRANSPARENT_REVEAL_INDEX 2
+
+// Shadows of the first directional light are split into cascades along the view, the first spot lights get a tile of
+// the spot shadow atlas each.
+#define SHADOW_CASCADES 4
+#define MAX_SPOT_SHADOWS 16
+#define SPOT_SHADOW_TILES_PER_ROW 4
+
+// Wavefront path tracing, every bounce extends the surviving paths, shades their hits and traces their shadow rays
+// with one dispatch each.
+#define PATH_TRACER_BOUNCES 4
+#define PATH_TRACER_GROUP_SIZE 64
+// Passes of the wavelet filter of the denoiser, pass i filters with taps 2^i pixels apart.
+#define PATH_DENOISER_PASSES 5
+// Adaptive sampling estimates the error of tiles this many pixels wide, one threadgroup each.
+#define PATH_TRACER_TILE_SIZE 16
+// Lightmap bakes filter their texels with as many passes of the wavelet filter, in lightmaps of up to
+// LIGHTMAP_MAX_SIZE texels on a side.
+#define LIGHTMAP_FILTER_PASSES 3
+#define LIGHTMAP_MAX_SIZE 4096
+
+// The skybox is prefiltered into a cube map whose mip level m holds the reflections of roughness
+// m / (ENVIRONMENT_MIP_LEVELS - 1), its irradiance is projected onto spherical harmonics by one threadgroup.
+#define ENVIRONMENT_SIZE 128
+#define ENVIRONMENT_MIP_LEVELS 6
+#define ENVIRONMENT_SAMPLES 64
+#define IRRADIANCE_GROUP_SIZE 256
+
+// Reflection probe i is captured into faces 6 i to 6 i + 5 of a cube map array and prefiltered like the skybox, its
+// reflections replace those of the skybox within its radius.
+#define MAX_REFLECTION_PROBES 16
+#define REFLECTION_PROBE_SIZE 128
+
+// Area lights are the leaves of a binary tree built on the GPU whenever they change, internal node i of the n - 1
+// internal nodes splits the lights sorted along the Morton curve of their centers, leaf n - 1 + j holds the j-th of
+// them. Node 0 is the root. Each tile of lighting walks the tree with a queue of LIGHT_TREE_QUEUE nodes.
+#define LIGHT_TREE_LEAF 0xFFFFFFFF
+#define LIGHT_TREE_QUEUE 512
+#define LIGHT_TREE_GROUP_SIZE 256
+
+// Screen space ambient occlusion is computed at half resolution, then blurred along rows and columns by groups of
+// SSAO_GROUP_SIZE texels.
+#define SSAO_SAMPLES 8
+#define SSAO_BLUR_RADIUS 4
+#define SSAO_GROUP_SIZE 64
+
+// Reflections are traced at half resolution, first in screen space by up to REFLECTION_MAX_STEPS steps through the
+// REFLECTION_HZB_LEVELS levels of a pyramid of the closest depth. Rays that leave the view or pass behind geometry are
+// queued and traced against the scene by groups of REFLECTION_GROUP_SIZE.
+#define REFLECTION_HZB_LEVELS 6
+#define REFLECTION_MAX_STEPS 48
+#define REFLECTION_GROUP_SIZE 64
+
+// Signed distance fields of the meshes have up to SDF_MESH_RESOLUTION voxels along their longest side, including
+// SDF_MESH_PADDING voxels around the bounds on every side. Instances are merged into SDF_CLIPMAP_LEVELS levels of
+// SDF_CLIPMAP_SIZE voxels on a side around the camera, each level with twice the voxel size of the one before. Levels
+// keep distances up to SDF_BAND_VOXELS of their voxels.
+#define SDF_MESH_RESOLUTION 32
+#define SDF_MESH_PADDING 2
+#define SDF_CLIPMAP_LEVELS 4
+#define SDF_CLIPMAP_SIZE 64
+#define SDF_BAND_VOXELS 4
+
+// Probes of the irradiance volume keep their irradiance and the distance to the geometry around them in octahedral
+// tiles of GI_IRRADIANCE_TEXELS and GI_DISTANCE_TEXELS texels on a side surrounded by a border of one texel. The tiles
+// of the probes at the same z fill one row of tiles. Frames trace GI_RAYS_PER_PROBE rays of as many probes as their ray
+// budget covers, the ones after those of the previous frame.
+#define GI_IRRADIANCE_TEXELS 6
+#define GI_DISTANCE_TEXELS 14
+#define GI_RAYS_PER_PROBE 64
+#define GI_MAX_PROBES_PER_AXIS 32
 
 #include <simd/simd.h>
 
@@ -83,10 +284,45 @@ typedef struct
 
     int emissive_map;
     int sheen_map;
-    float pad1;
-    float pad2;
+    // Entry of the sampler table the maps are sampled with, SAMPLER_DEFAULT for the 3D filter of the renderer.
+    unsigned int sampler;
+    // Texture of the lightmap the ambient light of the material is read from, -1 without one. The renderer keeps its
+    // own value, see set_material_lightmap.
+    int lightmap_map;
 } DeviceMaterial;
 
+// DeviceMaterial::flags, the same bits as in the other backends.
+#define HAS_DIFFUSE_MAP (1 << 0)
+#define HAS_NORMAL_MAP (1 << 1)
+#define HAS_METAL_ROUGH_MAP (1 << 2)
+#define HAS_EMISSIVE_MAP (1 << 4)
+
+// Map of a PackedMaterial without a texture, maps whose texture id doesn't fit in 16 bits are dropped.
+#define NO_MATERIAL_MAP 0xFFFF
+
+// What shaders read of a DeviceMaterial, set_materials packs every material into a third of its size. Colors are
+// halves, which keep the colors brighter than 1 that materials emit.
+typedef struct
+{
+    unsigned short c_r;
+    unsigned short c_g;
+    unsigned short c_b;
+    unsigned short c_a;
+
+    // params_x of DeviceMaterial, metalness in the lowest and roughness in the highest byte.
+    unsigned int params;
+    unsigned int flags;
+
+    unsigned short diffuse_map;
+    unsigned short normal_map;
+    unsigned short metallic_roughness_map;
+    unsigned short emissive_map;
+
+    unsigned short lightmap_map;
+    unsigned short sampler;
+    unsigned int pad;
+} PackedMaterial;
+
 typedef struct
 {
     float v_x;
@@ -116,6 +352,7 @@ typedef struct
 
     float u;
     float v;
+    // Second texture coordinates, which lightmaps are laid out with. Impostor vertices keep the center of their cell.
     float pad0;
     float pad1;
 
@@ -125,6 +362,34 @@ typedef struct
     float t_w;
 } Vertex3D;
 
+// Quantized Vertex3D: positions are unorm16 within the mesh bounds, normal and tangent are octahedral snorm16 and
+// the texture coordinates are half floats.
+typedef struct
+{
+    unsigned short p_x;
+    unsigned short p_y;
+    unsigned short p_z;
+    unsigned short mat_id;
+
+    short n_x;
+    short n_y;
+    short t_x;
+    short t_y;
+
+    unsigned short u;
+    unsigned short v;
+    // Sign of the bitangent in the lowest bit.
+    unsigned short flags;
+    unsigned short pad;
+} PackedVertex3D;
+
+// Maps quantized positions back to object space: position = offset + unorm * scale.
+typedef struct
+{
+    simd_float4 offset;
+    simd_float4 scale;
+} PackedVertexBounds;
+
 typedef struct
 {
     float pos_x;
@@ -152,19 +417,1163 @@ typedef struct
     float fov;
 } CameraView;
 
+// The view and combined matrices transform positions relative to origin, which is the camera position of the main view
+// so large world coordinates keep their precision near the camera.
 typedef struct
 {
     simd_float4x4 projection;
     simd_float4x4 view_matrix;
     simd_float4x4 combined;
     simd_float4x4 matrix_2d;
+    simd_float4 origin;
     CameraView view;
+    // Combined matrix of the previous frame relative to origin and without jitter, and the jitter of this frame in
+    // texture coordinates. Frames with motion vectors reproject their vertices with them.
+    simd_float4x4 previous_combined;
+    simd_float4 jitter;
 } UniformCamera;
 
+// Animations of set_3d_instance_animation.
+#define INSTANCE_ANIMATION_LINEAR 0
+#define INSTANCE_ANIMATION_SWAY 1
+
+// Parameters of one animated 3D instance, which is translated to position and scaled uniformly. Linear animations move
+// it by velocity per second, sway animations tilt it around its position towards velocity.
 typedef struct
 {
-    simd_float4x4 matrix;
-    simd_float4x4 normal_matrix;
+    // Scale in w.
+    simd_float4 position;
+    // Sway phase in radians in w.
+    simd_float4 velocity;
+} AnimatedInstance;
+
+typedef struct
+{
+    unsigned int type;
+    unsigned int count;
+    float time;
+    // Largest sway angle in radians and its angular frequency in radians per second.
+    float amplitude;
+    float frequency;
+    unsigned int pad0;
+    unsigned int pad1;
+    unsigned int pad2;
+} InstanceAnimationUniforms;
+
+// Rows of the affine transform of a 3D instance, its last row is always (0, 0, 0, 1).
+typedef struct
+{
+    simd_float4 rows[3];
 } InstanceTransform;
 
+// Node of a transform hierarchy propagated on the GPU, nodes are sorted by depth and parent is the sorted index of the
+// parent or -1. Target is the slot of the instance buffer its world transform is written to.
+#define NO_HIERARCHY_INSTANCE 0xFFFFFFFF
+typedef struct
+{
+    int parent;
+    unsigned int target;
+} HierarchyLink;
+
+// Local transform of a hierarchy node that changed since the last frame.
+typedef struct
+{
+    simd_float4 rows[3];
+    unsigned int node;
+    unsigned int pad0;
+    unsigned int pad1;
+    unsigned int pad2;
+} HierarchyUpdate;
+
+// Per-instance overrides of a 3D instance, see set_3d_instance_overrides. Material replaces the material id of every
+// vertex unless it is NO_MATERIAL_OVERRIDE, tint multiplies the base and emitted color. Custom is not read by the
+// built-in shaders. The override buffer of a frame starts with one InstanceOverride whose material holds the number of
+// instance slots that follow it.
+#define NO_MATERIAL_OVERRIDE 0xFFFFFFFF
+typedef struct
+{
+    simd_float4 tint;
+    simd_float4 custom;
+    unsigned int material;
+    unsigned int pad0;
+    unsigned int pad1;
+    unsigned int pad2;
+} InstanceOverride;
+
+// Indirect arguments of a culled draw in 32-bit words, large enough for both MTLDrawPrimitivesIndirectArguments and
+// MTLDrawIndexedPrimitivesIndirectArguments. Draw slot i has its arguments at i * DRAW_ARGS_WORDS.
+#define DRAW_ARGS_WORDS 5
+
+// Object space bounds and instance range of one culled draw, draws are sorted by visible_start. The visible instances
+// of a draw are written from visible_start on, which is instance_start unless the draw shares the instances of
+// another mesh of its prefab.
+typedef struct
+{
+    simd_float4 center;
+    simd_float4 extent;
+    unsigned int instance_start;
+    unsigned int instance_count;
+    // Offset in 32-bit words of this draw's indirect arguments.
+    unsigned int args_offset;
+    // Coarser levels of the mesh. Instances spanning less than lod_sizes[i] of the screen height are counted in the
+    // arguments at lod_args_offsets[i] instead, and written from lod_instance_start + i * instance_count on.
+    unsigned int lod_count;
+    simd_float4 lod_sizes;
+    simd_uint4 lod_args_offsets;
+    unsigned int lod_instance_start;
+    unsigned int visible_start;
+    unsigned int pad1;
+    unsigned int pad2;
+} CullDraw;
+
+// Consecutive triangles of a clustered mesh with at most CLUSTER_VERTICES unique vertices, from index_start of the
+// mesh's indices on. Every triangle faces away from points p with dot(center - p, axis) >= cutoff * |center - p| +
+// radius, clusters that are never backfacing have a cutoff of 1.
+#define CLUSTER_VERTICES 64
+#define CLUSTER_TRIANGLES 124
+typedef struct
+{
+    // Object space bounding sphere, radius in w.
+    simd_float4 sphere;
+    // Normal cone axis in xyz, cutoff in w.
+    simd_float4 cone;
+    unsigned int index_start;
+    unsigned int index_count;
+    unsigned int pad0;
+    unsigned int pad1;
+} MeshCluster;
+
+// Clusters of one clustered draw, draws are sorted by cluster_start.
+typedef struct
+{
+    unsigned int cluster_start;
+    unsigned int cluster_count;
+    // Offset in 32-bit words of the culled draw whose visible instances the clusters are tested in.
+    unsigned int instance_args_offset;
+    // Offset in 32-bit words of the indexed indirect arguments the indices of visible clusters are counted in.
+    unsigned int args_offset;
+    // First index of the mesh in the index buffer, and of its visible clusters in the culled index buffer.
+    unsigned int index_start;
+    unsigned int out_start;
+    unsigned int short_indices;
+    unsigned int pad;
+} ClusterDraw;
+
+typedef struct
+{
+    simd_float4 planes[6];
+    simd_float4 camera_position;
+    unsigned int num_clusters;
+    unsigned int num_draws;
+    unsigned int pad0;
+    unsigned int pad1;
+} ClusterUniforms;
+
+// One draw of the 3D indirect command buffer, index_offset is in bytes and index_count is 0 for non-indexed draws.
+typedef struct
+{
+    unsigned int vertex_start;
+    unsigned int vertex_count;
+    unsigned int index_offset;
+    unsigned int index_count;
+    unsigned int instance_start;
+    unsigned int instance_count;
+    unsigned int short_indices;
+    unsigned int pad;
+} IndirectDraw;
+
+// One culled draw of the 3D indirect command buffer, which takes its counts from the culled indirect arguments at
+// args_offset words. index_offset is in bytes and index_size is 0 for non-indexed draws, clustered draws read the
+// cluster arguments and the culled indices instead. Draws are ordered by the nearest depth culling found for the
+// draw slot depth_slot.
+typedef struct
+{
+    unsigned int args_offset;
+    unsigned int index_offset;
+    unsigned int index_size;
+    unsigned int clustered;
+    unsigned int depth_slot;
+    unsigned int pad0;
+    unsigned int pad1;
+    unsigned int pad2;
+} CulledIndirectDraw;
+
+// Vertices of one mesh skinned with one skin, written to out_start in the animated vertex buffer. Groups with morph
+// targets apply the deltas of their mesh with the weights at weight_start first, groups without joints are not
+// skinned.
+typedef struct
+{
+    unsigned int vertex_start;
+    unsigned int jw_start;
+    unsigned int count;
+    unsigned int out_start;
+    unsigned int joint_offset;
+    unsigned int num_joints;
+    unsigned int morph_start;
+    unsigned int weight_start;
+} SkinningGroup;
+
+// The skinning pass grows the bounds of every group by its skinned positions, as order preserving keys of their floats
+// with atomic min and max. Every group has 4 words of minima, x, y, z and one unused, the maxima of all groups follow
+// the minima of all groups.
+#define NO_SKINNING_GROUP 0xFFFFFFFF
+
+// Instances of a skinned mesh drawn with one skinning group, or in the bind pose with the bounds of the mesh for
+// NO_SKINNING_GROUP. Culling writes the instance count of the indirect arguments at args_offset words.
+typedef struct
+{
+    simd_float4 center;
+    simd_float4 extent;
+    unsigned int instance_start;
+    unsigned int instance_count;
+    unsigned int group;
+    unsigned int args_offset;
+} SkinnedCullRun;
+
+// Morph target deltas are stored by vertex. The offset table of a mesh starts at morph_start with the number of
+// vertices it covers, followed by the index of the first delta of every vertex and the end of the last one.
+#define NO_MORPH_TARGETS 0xFFFFFFFF
+typedef struct
+{
+    unsigned int target;
+    float p_x;
+    float p_y;
+    float p_z;
+    float n_x;
+    float n_y;
+    float n_z;
+    float pad;
+} MorphDelta;
+
+// Skeletons animated on the GPU have at most MAX_SKELETON_JOINTS joints and blend at most MAX_ANIMATION_LAYERS clips.
+#define MAX_SKELETON_JOINTS 256
+#define MAX_ANIMATION_LAYERS 4
+typedef struct
+{
+    simd_float4x4 inverse_bind;
+    // Rest pose, rotations are quaternions with w last.
+    simd_float4 translation;
+    simd_float4 rotation;
+    simd_float4 scale;
+    // Parents come before their children, roots have -1. Joints of the same depth are propagated together.
+    int parent;
+    unsigned int depth;
+    unsigned int pad0;
+    unsigned int pad1;
+} SkeletonJoint;
+
+// Keyframes of one property of one joint, every joint of a clip has a translation, rotation and scale channel in that
+// order. num_keys is 0 for properties that keep their rest pose.
+typedef struct
+{
+    unsigned int key_start;
+    unsigned int num_keys;
+} AnimationKeys;
+
+typedef struct
+{
+    unsigned int channel_start;
+    unsigned int num_joints;
+    float time;
+    float weight;
+} AnimationLayerState;
+
+// A skin whose joint matrices are sampled on the GPU, written from matrix_offset on into the joint matrices of the
+// skinning pass.
+typedef struct
+{
+    AnimationLayerState layers[MAX_ANIMATION_LAYERS];
+    unsigned int skeleton_start;
+    unsigned int num_joints;
+    unsigned int num_levels;
+    unsigned int num_layers;
+    unsigned int matrix_offset;
+    unsigned int pad0;
+    unsigned int pad1;
+    unsigned int pad2;
+} SkinAnimation;
+
+// Occlusion culling runs in two phases. The early phase tests against the depth pyramid of the previous frame, the
+// late phase re-tests the instances it rejected against the pyramid built from the early draws.
+typedef struct
+{
+    simd_float4 planes[6];
+    // View projection the depth pyramid was built with.
+    simd_float4x4 hzb_combined;
+    unsigned int num_draws;
+    unsigned int num_instances;
+    // 0 without occlusion culling, 1 for the early and 2 for the late phase.
+    unsigned int occlusion_phase;
+    // Offset of the late phase's visible instances in the visible instance list.
+    unsigned int visible_offset;
+    unsigned int depth_width;
+    unsigned int depth_height;
+    // 0 when there is no depth pyramid to test against yet.
+    unsigned int hzb_levels;
+    // 1 when culling records the nearest depth of the visible instances of every draw slot, to order the draws by.
+    unsigned int sort_depths;
+    // Camera position levels of detail are selected from in xyz and the vertical scale of its projection in w, the
+    // same for every view so shadows are drawn with the levels the camera sees.
+    simd_float4 lod_view;
+} CullUniforms;
+
+typedef struct
+{
+    float pos_x;
+    float pos_y;
+    float pos_z;
+    float energy;
+    float radiance_r;
+    float radiance_g;
+    float radiance_b;
+    float pad;
+} PointLight;
+
+// Probes with a radius of 0 are not baked yet.
+typedef struct
+{
+    float pos_x;
+    float pos_y;
+    float pos_z;
+    float radius;
+} ReflectionProbe;
+
+// Emissive triangle in world space with the layout of rfw's AreaLight, position is its centroid.
+typedef struct
+{
+    float pos_x;
+    float pos_y;
+    float pos_z;
+    float energy;
+    float normal_x;
+    float normal_y;
+    float normal_z;
+    float area;
+    float vertex0_x;
+    float vertex0_y;
+    float vertex0_z;
+    int inst_idx;
+    float vertex1_x;
+    float vertex1_y;
+    float vertex1_z;
+    int mesh_id;
+    float radiance_r;
+    float radiance_g;
+    float radiance_b;
+    int pad0;
+    float vertex2_x;
+    float vertex2_y;
+    float vertex2_z;
+    int pad1;
+} AreaLight;
+
+// Bounds of the area lights below a node, with their summed power in w of bmin and their largest range in w of bmax.
+// Leaves store the index of their light in left and LIGHT_TREE_LEAF in right.
+typedef struct
+{
+    simd_float4 bmin;
+    simd_float4 bmax;
+    unsigned int left;
+    unsigned int right;
+    unsigned int pad0;
+    unsigned int pad1;
+} LightTreeNode;
+
+// Morton codes are computed within the bounds of the light centers, count lights are sorted by them.
+typedef struct
+{
+    simd_float4 center_min;
+    simd_float4 center_scale;
+    unsigned int count;
+    unsigned int pad0;
+    unsigned int pad1;
+    unsigned int pad2;
+} LightTreeUniforms;
+
+typedef struct
+{
+    float pos_x;
+    float pos_y;
+    float pos_z;
+    float cos_inner;
+    float radiance_r;
+    float radiance_g;
+    float radiance_b;
+    float cos_outer;
+    float direction_x;
+    float direction_y;
+    float direction_z;
+    float energy;
+} SpotLight;
+
+typedef struct
+{
+    float direction_x;
+    float direction_y;
+    float direction_z;
+    float energy;
+    float radiance_r;
+    float radiance_g;
+    float radiance_b;
+    float pad;
+} DirectionalLight;
+
+// Probe (x, y, z) of an irradiance volume sits at origin + spacing * (x, y, z) and has index
+// x + count_x * (y + count_y * z). There is no volume while count_x is 0. Surfaces look up the probes from a point
+// moved off them by bias.
+typedef struct
+{
+    simd_float4 origin;
+    simd_float4 spacing;
+    unsigned int count_x;
+    unsigned int count_y;
+    unsigned int count_z;
+    float bias;
+} GiVolume;
+
+// Tile lists index point lights first, followed by the spot lights and the area lights.
+typedef struct
+{
+    simd_float4x4 view;
+    simd_float4x4 inv_projection;
+    simd_float4x4 inv_combined;
+    simd_float4 camera_position;
+    unsigned int num_point_lights;
+    unsigned int num_spot_lights;
+    unsigned int num_directional_lights;
+    unsigned int tiles_x;
+    unsigned int width;
+    unsigned int height;
+    // Whether the shadow of the first directional light and ambient occlusion were traced for every pixel.
+    unsigned int ray_traced;
+    // Distance up to which geometry occludes ambient light.
+    float ao_radius;
+    // Whether the prefiltered skybox lights the scene in place of the constant ambient light.
+    unsigned int environment;
+    // Whether screen space occlusion, blurred unless the unfiltered view shows it, darkens the ambient light.
+    unsigned int ssao;
+    // Reflection probes the closest one around a surface is looked up from.
+    unsigned int num_probes;
+    unsigned int num_area_lights;
+    // Replaces the ambient light within it.
+    GiVolume gi;
+    // Whether traced reflections replace those of the probes and the skybox, up to reflection_roughness.
+    unsigned int reflections;
+    float reflection_roughness;
+    unsigned int pad0;
+    unsigned int pad1;
+} LightUniforms;
+
+typedef struct
+{
+    simd_float4x4 combined;
+    // Size of the half resolution occlusion, which stores the occlusion in x and the distance to the camera in y.
+    unsigned int width;
+    unsigned int height;
+    unsigned int pad0;
+    unsigned int pad1;
+} SsaoUniforms;
+
+typedef struct
+{
+    simd_float4x4 combined;
+    // Camera of the previous frame, its main pass and the history of the reflections are reprojected with it.
+    simd_float4x4 previous_combined;
+    // Size of the half resolution reflections, which store the reflected radiance in rgb and how much of it was
+    // found in a.
+    unsigned int width;
+    unsigned int height;
+    // Distance reflections are traced up to.
+    float max_distance;
+    // Whether rays that miss in screen space are traced against the scene.
+    unsigned int traced;
+    // Levels of the closest depth pyramid.
+    unsigned int hzb_levels;
+    // Whether the history holds the reflections of the previous frame, and the source its downsampled main pass.
+    unsigned int history;
+    unsigned int source;
+    unsigned int pad0;
+} ReflectionUniforms;
+
+// Field of a mesh, distances at the centers of size voxels of voxel_size in w from origin on, in mesh space. They are
+// stored in x, then y, then z order from the element of the field buffer in w of size.
+typedef struct
+{
+    simd_float4 origin;
+    simd_uint4 size;
+} SdfVolume;
+
+// Generates num_voxels voxels of a field from first_voxel on, from num_triangles triangles of the vertex list or of the
+// corners of the RTTriangles of the mesh. Indices into the vertex list start at the byte index_offset and have
+// index_size bytes, 0 for meshes without indices.
+typedef struct
+{
+    SdfVolume volume;
+    unsigned int vertex_start;
+    unsigned int index_offset;
+    unsigned int index_size;
+    unsigned int num_triangles;
+    unsigned int first_voxel;
+    unsigned int num_voxels;
+    unsigned int pad0;
+    unsigned int pad1;
+} SdfMeshUniforms;
+
+// Instance of a mesh field in the clipmap. inverse holds the rows of the transform from world to mesh space, scale the
+// smallest scale of the instance, which makes the distances of the field world distances that are never too long.
+typedef struct
+{
+    simd_float4 inverse[3];
+    // World space bounds of the field.
+    simd_float4 bmin;
+    simd_float4 bmax;
+    float scale;
+    // Index of its SdfVolume.
+    unsigned int volume;
+    unsigned int pad0;
+    unsigned int pad1;
+} SdfInstance;
+
+// Region of size voxels of a clipmap level from the voxel first_cell on, counted from the world origin. Every voxel
+// takes the smallest distance of the num_instances listed instances, up to band.
+typedef struct
+{
+    simd_int4 first_cell;
+    simd_uint4 size;
+    unsigned int num_instances;
+    float voxel_size;
+    float band;
+    unsigned int pad0;
+} SdfRegionUniforms;
+
+// Clipmap the soft shadows and the occlusion are traced through. Level l has voxels of voxel_size * 2^l and covers
+// SDF_CLIPMAP_SIZE of them from the voxel in windows[l] on, voxel c is stored at c modulo SDF_CLIPMAP_SIZE.
+typedef struct
+{
+    simd_int4 windows[SDF_CLIPMAP_LEVELS];
+    float voxel_size;
+    // Penumbra width relative to the distance to the occluder, see SdfSettings.
+    float softness;
+    float ao_distance;
+    unsigned int pad0;
+} SdfTraceUniforms;
+
+// Irradiance of the skybox in the first 9 spherical harmonics, convolved with the Lambertian lobe and divided by pi.
+typedef struct
+{
+    simd_float4 coefficients[9];
+} IrradianceSH;
+
+typedef struct
+{
+    // Texels of a face of the mip level that is written and the roughness it is prefiltered for.
+    unsigned int size;
+    float roughness;
+    unsigned int pad0;
+    unsigned int pad1;
+} EnvironmentUniforms;
+
+// Light matrices map world positions to the clip space of their shadow map.
+typedef struct
+{
+    simd_float4x4 cascades[SHADOW_CASCADES];
+    simd_float4x4 spot_lights[MAX_SPOT_SHADOWS];
+    // View depth up to which each cascade is used.
+    float cascade_ends[SHADOW_CASCADES];
+    unsigned int num_cascades;
+    unsigned int num_spot_shadows;
+    float cascade_bias;
+    float spot_bias;
+} ShadowUniforms;
+
+// Geometry of an instance of the ray tracing scene, by its index in the instance acceleration structure.
+typedef struct
+{
+    unsigned int vertex_start;
+    // Byte offset into the index buffer and size of an index, 0 for meshes without indices.
+    unsigned int index_offset;
+    unsigned int index_size;
+    // Index of the instance transform.
+    unsigned int instance;
+    // Whether vertex_start indexes the animated vertices of a skinning group.
+    unsigned int animated;
+    unsigned int pad0;
+    unsigned int pad1;
+    unsigned int pad2;
+} TracedInstance;
+
+// Node of the compute BVH with four children, laid out like the MBVH nodes of gpu-rt. Children with a count of 0 or
+// more are leaves of that many triangles or instances from child on, -1 marks internal nodes and a child of -1 an
+// empty slot.
+typedef struct
+{
+    simd_float4 min_x;
+    simd_float4 max_x;
+    simd_float4 min_y;
+    simd_float4 max_y;
+    simd_float4 min_z;
+    simd_float4 max_z;
+    simd_int4 children;
+    simd_int4 counts;
+} BvhNode;
+
+// Triangle of the compute BVH as its first vertex and the edges to the other two, in leaf order. The w of v0 holds the
+// bits of the index of the triangle in its mesh.
+typedef struct
+{
+    simd_float4 v0;
+    simd_float4 e1;
+    simd_float4 e2;
+} BvhTriangle;
+
+// Instance of the compute BVH, in the leaf order of the instance BVH.
+typedef struct
+{
+    // Rows of the inverse transform, which brings rays into the space of the mesh.
+    simd_float4 inverse[3];
+    // Root node of the BVH of its mesh and its index in the traced instances.
+    unsigned int root;
+    unsigned int instance;
+    unsigned int pad0;
+    unsigned int pad1;
+} BvhInstance;
+
+typedef struct
+{
+    simd_float4x4 inv_combined;
+    // Combined matrix of the previous frame, the denoiser reprojects its history with it.
+    simd_float4x4 previous_combined;
+    simd_float4 camera_position;
+    unsigned int width;
+    unsigned int height;
+    // Samples accumulated before the one of this frame.
+    unsigned int sample;
+    unsigned int num_point_lights;
+    unsigned int num_spot_lights;
+    unsigned int num_directional_lights;
+    unsigned int num_area_lights;
+    // Samples traced before this one, which seeds its random numbers.
+    unsigned int seed;
+    // Whether the first hits are written for the denoiser, and whether its history holds the previous frame.
+    unsigned int denoise;
+    unsigned int history;
+    // Whether only tiles that did not converge are traced, tiles_x of them per row. See set_path_tracer_convergence
+    // for the threshold and the sample limits.
+    unsigned int adaptive;
+    unsigned int tiles_x;
+    float threshold;
+    unsigned int min_samples;
+    unsigned int max_samples;
+    // Render the samples belong to, counted up whenever the accumulated samples are discarded.
+    unsigned int render;
+    // Whether the paths start at the texels of a lightmap of width by height texels instead of the camera.
+    unsigned int lightmap;
+    unsigned int pad0;
+    unsigned int pad1;
+    unsigned int pad2;
+} PathTracerUniforms;
+
+// Pixel of the path in w of origin.
+typedef struct
+{
+    simd_float4 origin;
+    simd_float4 direction;
+    simd_float4 throughput;
+} PathState;
+
+// Update of num_probes probes of the irradiance volume from first_probe on, wrapping around at the last one. Their rays
+// are turned by rotation, a different one every frame.
+typedef struct
+{
+    simd_float4x4 rotation;
+    GiVolume volume;
+    unsigned int first_probe;
+    unsigned int num_probes;
+    unsigned int seed;
+    // Weight of the irradiance and distances of the probes against those traced this frame.
+    float hysteresis;
+    // Distance rays that miss the scene count as.
+    float max_distance;
+    unsigned int environment;
+    unsigned int num_point_lights;
+    unsigned int num_spot_lights;
+    unsigned int num_directional_lights;
+    // Whether every probe was updated before, so their irradiance lights the hits of the rays.
+    unsigned int bounce;
+    unsigned int pad0;
+    unsigned int pad1;
+} GiUniforms;
+
+// First hit of the path of a pixel, which guides the denoiser. The distance from the camera is in w of position, 0 for
+// paths that left the scene, and the RGBA8 albedo in w of normal.
+typedef struct
+{
+    simd_float4 position;
+    simd_float4 normal;
+} PathSurface;
+
+// Temporal history of the denoiser for a pixel, the radiance divided by the albedo with the number of frames it blends
+// in w, and the first two moments of its luminance in x and y of moments.
+typedef struct
+{
+    simd_float4 radiance;
+    simd_float4 moments;
+} PathHistory;
+
+// Closest hit of a path, instance is ~0u for paths that left the scene. Barycentrics are packed as two unorm16.
+typedef struct
+{
+    unsigned int instance;
+    unsigned int primitive;
+    float distance;
+    unsigned int barycentrics;
+} PathHit;
+
+// Ray traced against the 3D scene by trace_rays, hits between min_distance and max_distance along direction count.
+typedef struct
+{
+    float origin_x;
+    float origin_y;
+    float origin_z;
+    float min_distance;
+    float direction_x;
+    float direction_y;
+    float direction_z;
+    float max_distance;
+} RayQuery;
+
+// Rays of a PVS bake traced by one dispatch, ray i starts in cell first_cell + i / rays_per_cell of a grid of cells of
+// cell_size at origin, cells_x by cells_y cells per layer. The traced instance a ray hits sets its bit in the
+// words_per_cell words of the cell.
+typedef struct
+{
+    simd_float4 origin;
+    float cell_size;
+    unsigned int cells_x;
+    unsigned int cells_y;
+    unsigned int first_cell;
+    unsigned int count;
+    unsigned int rays_per_cell;
+    unsigned int words_per_cell;
+    unsigned int num_traced;
+} PvsUniforms;
+
+// Light sample of a path that reaches its pixel when nothing occludes it, pixel in w of origin and the distance to the
+// light in w of direction.
+typedef struct
+{
+    simd_float4 origin;
+    simd_float4 direction;
+    simd_float4 radiance;
+} ShadowRay;
+
+// MTLDispatchThreadgroupsIndirectArguments
+typedef struct
+{
+    unsigned int threadgroups[3];
+} DispatchArguments;
+
+// Tree over the slots of the culled instances. Slots are sorted by the Morton code of their center and grouped into
+// clusters of INSTANCE_BVH_CLUSTER_SIZE, which are the leaves of a tree built like the light tree. Node 0 is the root,
+// the leaves follow the num_clusters - 1 internal nodes. Culling walks the tree top-down in one threadgroup of
+// INSTANCE_BVH_GROUP_SIZE threads, only the instances of the clusters it reaches are tested one by one.
+#define INSTANCE_BVH_CLUSTER_SIZE 64
+#define INSTANCE_BVH_GROUP_SIZE 1024
+#define INSTANCE_BVH_LEAF 0xFFFFFFFF
+// Set on queued nodes and listed clusters inside the view, whose instances are not tested against its planes again.
+#define INSTANCE_BVH_INSIDE 0x80000000
+typedef struct
+{
+    simd_float4 bmin;
+    simd_float4 bmax;
+    // Children of internal nodes, leaves have INSTANCE_BVH_LEAF in right. Nodes cover count clusters from first on.
+    unsigned int left;
+    unsigned int right;
+    unsigned int first;
+    unsigned int count;
+} InstanceBvhNode;
+
+typedef struct
+{
+    unsigned int num_slots;
+    unsigned int num_clusters;
+    unsigned int num_draws;
+    // Clusters are bound from the refit list instead of all of them, and the slots of the moved list counted.
+    unsigned int listed;
+    unsigned int num_moved;
+    unsigned int pad0;
+    unsigned int pad1;
+    unsigned int pad2;
+} InstanceBvhUniforms;
+
+typedef struct
+{
+    // Bounds of the slot centers as ordered float keys, Morton codes quantize the centers within them.
+    simd_uint4 center_min;
+    simd_uint4 center_max;
+    // One threadgroup for every cluster on the refit list, and for every cluster the last traversal reached.
+    DispatchArguments refit;
+    DispatchArguments visible;
+    unsigned int pad0;
+    unsigned int pad1;
+} InstanceBvhCounters;
+
+// Sizes of the path queues of both bounce parities and of the shadow ray queue, followed by the indirect arguments
+// of the dispatches sized by them.
+typedef struct
+{
+    unsigned int paths[2];
+    unsigned int shadow_rays;
+    // Shadow rays the last shaded bounce appended, which the shadow dispatch traces.
+    unsigned int traced_shadow_rays;
+    DispatchArguments extend;
+    DispatchArguments shadow;
+    // Tiles that did not converge after the adaptive sample.
+    unsigned int active_tiles;
+} PathCounters;
+
+// Reflection rays that missed in screen space and the indirect arguments of the dispatch that traces them.
+typedef struct
+{
+    unsigned int rays;
+    DispatchArguments trace;
+} ReflectionCounters;
+
+// Samples accumulated by the pixels of a tile and their error, the mean standard error of the pixels relative to the
+// square root of their luminance.
+typedef struct
+{
+    unsigned int samples;
+    unsigned int converged;
+    float error;
+    unsigned int pad0;
+} PathTile;
+
+// Tiles of a render that did not converge yet, written for the CPU after every adaptive sample.
+typedef struct
+{
+    unsigned int render;
+    unsigned int active_tiles;
+} PathProgress;
+
+// Pass of the wavelet filter of a lightmap bake, with taps step texels apart. The last pass packs the filtered texels.
+typedef struct
+{
+    unsigned int width;
+    unsigned int height;
+    unsigned int step;
+    unsigned int last;
+} LightmapFilterUniforms;
+
+// Emitter of particles simulated on the GPU, see set_particle_emitter. Particles are born at rate per second in a
+// sphere of radius position.w around position.xyz, move with velocity.xyz plus a random vector up to velocity.w long
+// and live for lifetime seconds. They accelerate by acceleration.xyz and lose the fraction acceleration.w of their
+// velocity per second. Size and color go from their start to their end value over the lifetime, colors are RGBA8 with
+// red in the lowest byte, multiplied by texture tex unless it is 0, like those of sprites. Particles of emitters that
+// collide bounce off the depth of the previous frame and keep restitution of their velocity.
+typedef struct
+{
+    simd_float4 position;
+    simd_float4 velocity;
+    simd_float4 acceleration;
+    float rate;
+    float lifetime;
+    float size_start;
+    float size_end;
+    unsigned int color_start;
+    unsigned int color_end;
+    unsigned short uv_x;
+    unsigned short uv_y;
+    unsigned short uv_width;
+    unsigned short uv_height;
+    unsigned int tex;
+    unsigned int collide;
+    float restitution;
+    unsigned int pad0;
+} ParticleEmitter;
+
+// Line of the debug draw API, see debug_lines. Color is RGBA8 with red in the lowest byte, width is in pixels.
+typedef struct
+{
+    Vector3 start;
+    unsigned int color;
+    Vector3 end;
+    float width;
+} DebugLine;
+
+// Layout of the frames of set_video_frame, for the conversion into the texture of their slot.
+#define VIDEO_FRAME_YCBCR 1
+#define VIDEO_FRAME_VIDEO_RANGE 2
+#define VIDEO_FRAME_BT601 4
+
+// Point clouds are split into chunks of up to POINT_CHUNK_SIZE points, rasterized by a threadgroup of
+// POINT_GROUP_SIZE threads each.
+#define POINT_CHUNK_SIZE 32768
+#define POINT_GROUP_SIZE 256
+
+// Point of a point cloud chunk, position holds 11, 11 and 10 bits of x, y and z within the chunk bounds and color is
+// RGBA8 with red in the lowest byte.
+typedef struct
+{
+    unsigned int position;
+    unsigned int color;
+} PackedPoint;
+
+// Chunk of a point cloud in view, matrix maps quantized positions to clip space. The first count points of the chunk
+// are rasterized, fewer than it has when they would cover its pixels many times over.
+typedef struct
+{
+    simd_float4x4 matrix;
+    unsigned int first;
+    unsigned int count;
+    unsigned int pad0;
+    unsigned int pad1;
+} PointChunkDraw;
+
+// Size of the point buffers, which match the depth texture of the main pass.
+typedef struct
+{
+    unsigned int width;
+    unsigned int height;
+} PointRasterUniforms;
+
+// Age in w of position and lifetime in w of velocity, both in seconds.
+typedef struct
+{
+    simd_float4 position;
+    simd_float4 velocity;
+} Particle;
+
+#define PARTICLE_GROUP_SIZE 64
+
+// MTLDrawPrimitivesIndirectArguments
+typedef struct
+{
+    unsigned int vertex_count;
+    unsigned int instance_count;
+    unsigned int vertex_start;
+    unsigned int base_instance;
+} DrawArguments;
+
+// Particles alive in both lists of an emitter and free slots on its dead stack, followed by the indirect arguments of
+// the simulation of the current list and of the draw of the next one.
+typedef struct
+{
+    unsigned int alive[2];
+    int dead;
+    unsigned int pad0;
+    DispatchArguments simulate;
+    unsigned int pad1;
+    DrawArguments draw;
+} ParticleCounters;
+
+// A frame of an emitter, which emits emit particles into alive list `list` and simulates it into the other list.
+// Colliding particles are tested against the depth drawn with depth_combined in the previous frame.
+typedef struct
+{
+    simd_float4x4 depth_combined;
+    simd_float4x4 depth_inv_combined;
+    unsigned int emit;
+    unsigned int capacity;
+    unsigned int list;
+    unsigned int seed;
+    float delta_time;
+    unsigned int collide;
+    unsigned int pad0;
+    unsigned int pad1;
+} ParticleUniforms;
+
+// Terrains are drawn from rings of cells around the camera, every level is TERRAIN_GRID cells of 1 << level heightmap
+// texels on a side. Each level but the first leaves out the cells of the level below it, which covers half its width.
+#define TERRAIN_GRID 64
+#define TERRAIN_MAX_LEVELS 8
+#define TERRAIN_GROUP_SIZE 64
+
+// Heightmap and levels of a terrain, level_x and level_y hold the texel of the first vertex of every level. Every cell
+// writes two triangles, the cells of all levels are generated by cells threads.
+typedef struct
+{
+    simd_float4 origin;
+    int level_x[TERRAIN_MAX_LEVELS];
+    int level_y[TERRAIN_MAX_LEVELS];
+    float spacing;
+    float uv_scale;
+    unsigned int width;
+    unsigned int height;
+    unsigned int levels;
+    unsigned int cells;
+    unsigned int material;
+    unsigned int has_materials;
+} TerrainUniforms;
+
+// Candidates of an instance scatter, one in every cell of the side by side cells of spacing world units that start at
+// cell first_x, first_y. Candidates left out are written without a size at hidden, behind the camera.
+typedef struct
+{
+    simd_float4 camera;
+    simd_float4 hidden;
+    int first_x;
+    int first_y;
+    unsigned int side;
+    unsigned int count;
+    unsigned int seed;
+    unsigned int density_width;
+    unsigned int density_height;
+    unsigned int has_density;
+    float spacing;
+    float radius;
+    float min_scale;
+    float max_scale;
+} ScatterUniforms;
+
+// Impostors are grids of IMPOSTOR_GRID cells on a side by default whose vertices have IMPOSTOR_VERTEX set in mat_id,
+// see bake_3d_impostor. Atlases have up to IMPOSTOR_MAX_TILES octahedral tiles on a side.
+#define IMPOSTOR_VERTEX 0x80000000
+#define IMPOSTOR_GRID 16
+#define IMPOSTOR_MAX_GRID 64
+#define IMPOSTOR_MAX_TILES 32
+
+// Bake of an impostor atlas with tiles by tiles views of the bounding sphere of a mesh, radius in w of center.
+typedef struct
+{
+    simd_float4 center;
+    unsigned int tiles;
+} ImpostorBakeUniforms;
+
+// Pixels of the visibility buffer hold the instance and the triangle they show, the triangles of a frame are numbered
+// across its meshes in the order of their VBufferMesh. Skinned meshes write NO_VBUFFER_TRIANGLE, they are shaded by
+// their own draws.
+#define NO_VBUFFER_TRIANGLE 0xFFFFFFFF
+#define VBUFFER_INDEXED 1
+#define VBUFFER_SHORT_INDICES 2
+#define VBUFFER_PACKED 4
+
+typedef struct
+{
+    unsigned int first_triangle;
+    unsigned int vertex_start;
+    // In indices of the index buffer of the vertex list of the mesh.
+    unsigned int index_start;
+    unsigned int flags;
+    // Only set for packed meshes.
+    PackedVertexBounds bounds;
+} VBufferMesh;
+
+// Quad of one glyph of instanced text in 2D space, x and y is the corner that shows atlas_x and atlas_y of the glyph
+// atlas. Color is RGBA8 with red in the lowest byte, multiplied by the coverage the atlas holds.
+typedef struct
+{
+    float x;
+    float y;
+    float z;
+    float width;
+    float height;
+    unsigned int color;
+    unsigned short atlas_x;
+    unsigned short atlas_y;
+    unsigned short atlas_width;
+    unsigned short atlas_height;
+} GlyphInstance;
+
+// Quad of one sprite in 2D space, width by height around its center x and y and rotated by rotation radians. The UV
+// rect is unorm16, 0xFFFF is 1. Color is RGBA8 with red in the lowest byte, multiplied by texture tex unless it is 0,
+// like the vertices of 2D meshes with mixed texture modes.
+typedef struct
+{
+    float x;
+    float y;
+    float z;
+    float width;
+    float height;
+    float rotation;
+    unsigned short uv_x;
+    unsigned short uv_y;
+    unsigned short uv_width;
+    unsigned short uv_height;
+    unsigned int color;
+    unsigned int tex;
+} SpriteInstance;
+
+// Paths are divided into up to PATH_MAX_BANDS rows and columns, of about PATH_BAND_SEGMENTS segments each.
+#define PATH_BAND_SEGMENTS 16
+#define PATH_MAX_BANDS 256
+
+// Draw of a 2D path, its quad covers the path space bounds in quad. Bands start at the path space corner in bands.xy
+// and are bands.zw apart. Strokes have a half_width above 0, fills are even-odd or else nonzero. Color is RGBA8 with
+// red in the lowest byte.
+typedef struct
+{
+    simd_float4x4 transform;
+    simd_float4 quad;
+    simd_float4 bands;
+    unsigned int bands_x;
+    unsigned int bands_y;
+    unsigned int color;
+    unsigned int even_odd;
+    float half_width;
+    float z;
+    unsigned int pad0;
+    unsigned int pad1;
+} PathUniforms2D;
+
+// Reprojects the depth of the 3D pass into the previous frame, jitter is the sub-pixel offset of the projection in
+// texture coordinates.
+typedef struct
+{
+    simd_float4x4 inv_combined;
+    simd_float4x4 previous_combined;
+    float jitter_x;
+    float jitter_y;
+    unsigned int width;
+    unsigned int height;
+} MotionUniforms;
+
+// Blends the jittered 3D view into its reprojected history, which is discarded on reset.
+typedef struct
+{
+    unsigned int width;
+    unsigned int height;
+    unsigned int reset;
+    unsigned int pad0;
+} TaaUniforms;
+
+// Maps the HDR 3D view into the range the drawable presents, scaled frames that are not HDR are not tonemapped. The
+// post effects of the overlay pass are applied around it.
+typedef struct
+{
+    float exposure;
+    // Largest value the drawable presents, 1 unless it is an extended range drawable on an EDR display.
+    float headroom;
+    unsigned int enabled;
+    float bloom_intensity;
+    float vignette_intensity;
+    float vignette_radius;
+    // Width over height of the view, so the vignette is round.
+    float aspect;
+    unsigned int pad0;
+} ToneMapUniforms;
+
+// Downsamples a level of the bloom pyramid, the first one only keeps radiance above the threshold with a soft knee.
+typedef struct
+{
+    float threshold;
+    float knee;
+    unsigned int prefilter;
+    unsigned int pad0;
+} BloomUniforms;
+
+// Dispatch of a compute primitive over count elements in tiles tiles. Scans with offsets add the scanned sums of
+// their tiles, sorts order pairs of words words by the digit at bit shift of their key.
+typedef struct
+{
+    unsigned int count;
+    unsigned int tiles;
+    unsigned int offsets;
+    unsigned int shift;
+    unsigned int words;
+    unsigned int pad0;
+    unsigned int pad1;
+    unsigned int pad2;
+} PrimitiveUniforms;
+
 #endif // METALCPP_BACKENDS_METAL_CPP_CPP_SRC_STRUCTS_H
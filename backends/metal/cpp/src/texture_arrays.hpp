@@ -0,0 +1,84 @@
+#ifndef METALCPP_SRC_TEXTURE_ARRAYS_HPP
+#define METALCPP_SRC_TEXTURE_ARRAYS_HPP
+
+#import <Metal/Metal.h>
+
+#include "library.h"
+#include "texture_format.hpp"
+
+#include <tuple>
+#include <vector>
+
+// Small textures of the same format, size and levels share the layers of 2D texture arrays, so thousands of them take
+// a few textures that render passes make resident. Layers are addressed by entries of page << 16 | layer. Pages are
+// only released all at once, like texture heaps.
+class TextureArrays
+{
+  public:
+    static constexpr unsigned int LAYERS_PER_PAGE = 64;
+
+    // Returns the entry of a free layer for a texture like d with mip_levels levels and stores its array in *page.
+    unsigned int allocate(id<MTLDevice> device, const TextureData &d, unsigned int mip_levels, id<MTLTexture> *page)
+    {
+        const Key key = {d.format, d.width, d.height, mip_levels};
+        for (unsigned int i = 0; i < _pages.size(); i++)
+        {
+            Page &candidate = _pages[i];
+            if (candidate.key != key || candidate.free_layers.empty())
+                continue;
+            const unsigned int layer = candidate.free_layers.back();
+            candidate.free_layers.pop_back();
+            *page = candidate.texture;
+            return i << 16 | layer;
+        }
+
+        MTLTextureDescriptor *desc = texture_descriptor(d, d.format, mip_levels);
+        desc.textureType = MTLTextureType2DArray;
+        desc.arrayLength = LAYERS_PER_PAGE;
+        Page created = {key, [device newTextureWithDescriptor:desc], {}};
+        if (created.texture == nil)
+            return NO_TEXTURE_LAYER;
+        created.texture.label = @"TextureArray";
+        for (unsigned int layer = LAYERS_PER_PAGE; layer-- > 1;)
+            created.free_layers.push_back(layer);
+
+        *page = created.texture;
+        _pages.push_back(std::move(created));
+        _textures.push_back(*page);
+        return static_cast<unsigned int>(_pages.size() - 1) << 16;
+    }
+
+    // Frames must be done with the layer of entry.
+    void free(unsigned int entry)
+    {
+        if (entry != NO_TEXTURE_LAYER && (entry >> 16) < _pages.size())
+            _pages[entry >> 16].free_layers.push_back(entry & 0xFFFF);
+    }
+
+    void clear()
+    {
+        _pages.clear();
+        _textures.clear();
+    }
+
+    // Arrays by page, pages are never removed before clear().
+    const std::vector<id<MTLTexture>> &textures() const
+    {
+        return _textures;
+    }
+
+  private:
+    using Key = std::tuple<DataFormat, unsigned int, unsigned int, unsigned int>;
+
+    struct Page
+    {
+        Key key;
+        id<MTLTexture> texture;
+        std::vector<unsigned int> free_layers;
+    };
+
+    std::vector<Page> _pages;
+    std::vector<id<MTLTexture>> _textures;
+};
+
+#endif // METALCPP_SRC_TEXTURE_ARRAYS_HPP
@@ -0,0 +1,234 @@
+#ifndef METALCPP_SRC_TEXTURE_FORMAT_HPP
+#define METALCPP_SRC_TEXTURE_FORMAT_HPP
+
+#import <Metal/Metal.h>
+#include <TargetConditionals.h>
+
+#include <algorithm>
+#include <cstddef>
+
+#include "library.h"
+
+// Memory layout of a texture format, uncompressed formats are described as 1x1 blocks.
+struct TextureFormat
+{
+    MTLPixelFormat pixel_format;
+    unsigned int block_width;
+    unsigned int block_height;
+    unsigned int bytes_per_block;
+
+    size_t bytes_per_row(unsigned int width) const
+    {
+        return static_cast<size_t>((width + block_width - 1) / block_width) * bytes_per_block;
+    }
+
+    size_t bytes_per_image(unsigned int width, unsigned int height) const
+    {
+        return bytes_per_row(width) * ((height + block_height - 1) / block_height);
+    }
+};
+
+inline TextureFormat texture_format(DataFormat format)
+{
+    switch (format)
+    {
+    case RGBA8:
+        return {MTLPixelFormatRGBA8Unorm, 1, 1, 4};
+    case BC1_RGBA:
+        return {MTLPixelFormatBC1_RGBA, 4, 4, 8};
+    case BC2_RGBA:
+        return {MTLPixelFormatBC2_RGBA, 4, 4, 16};
+    case BC3_RGBA:
+        return {MTLPixelFormatBC3_RGBA, 4, 4, 16};
+    case BC4_R:
+        return {MTLPixelFormatBC4_RUnorm, 4, 4, 8};
+    case BC5_RG:
+        return {MTLPixelFormatBC5_RGUnorm, 4, 4, 16};
+    case BC6H_RGB_UFLOAT:
+        return {MTLPixelFormatBC6H_RGBUfloat, 4, 4, 16};
+    case BC7_RGBA:
+        return {MTLPixelFormatBC7_RGBAUnorm, 4, 4, 16};
+    case ASTC_4x4:
+        return {MTLPixelFormatASTC_4x4_LDR, 4, 4, 16};
+    case ASTC_6x6:
+        return {MTLPixelFormatASTC_6x6_LDR, 6, 6, 16};
+    case ASTC_8x8:
+        return {MTLPixelFormatASTC_8x8_LDR, 8, 8, 16};
+    case R8:
+        return {MTLPixelFormatR8Unorm, 1, 1, 1};
+    case RG8:
+        return {MTLPixelFormatRG8Unorm, 1, 1, 2};
+    case BGRA8_SRGB:
+        return {MTLPixelFormatBGRA8Unorm_sRGB, 1, 1, 4};
+    case RGBA8_SRGB:
+        return {MTLPixelFormatRGBA8Unorm_sRGB, 1, 1, 4};
+    case BC1_RGBA_SRGB:
+        return {MTLPixelFormatBC1_RGBA_sRGB, 4, 4, 8};
+    case BC2_RGBA_SRGB:
+        return {MTLPixelFormatBC2_RGBA_sRGB, 4, 4, 16};
+    case BC3_RGBA_SRGB:
+        return {MTLPixelFormatBC3_RGBA_sRGB, 4, 4, 16};
+    case BC7_RGBA_SRGB:
+        return {MTLPixelFormatBC7_RGBAUnorm_sRGB, 4, 4, 16};
+    case ASTC_4x4_SRGB:
+        return {MTLPixelFormatASTC_4x4_sRGB, 4, 4, 16};
+    case ASTC_6x6_SRGB:
+        return {MTLPixelFormatASTC_6x6_sRGB, 6, 6, 16};
+    case ASTC_8x8_SRGB:
+        return {MTLPixelFormatASTC_8x8_sRGB, 8, 8, 16};
+    case BGRA8:
+    default:
+        return {MTLPixelFormatBGRA8Unorm, 1, 1, 4};
+    }
+}
+
+// BC formats need the desktop feature set, ASTC an Apple GPU and the gray formats texture swizzles.
+inline bool supports_format(id<MTLDevice> device, DataFormat format)
+{
+    switch (format)
+    {
+    case BC1_RGBA:
+    case BC2_RGBA:
+    case BC3_RGBA:
+    case BC4_R:
+    case BC5_RG:
+    case BC6H_RGB_UFLOAT:
+    case BC7_RGBA:
+    case BC1_RGBA_SRGB:
+    case BC2_RGBA_SRGB:
+    case BC3_RGBA_SRGB:
+    case BC7_RGBA_SRGB:
+        // Every Mac before macOS 11 decodes BC, iOS devices before iOS 16.4 don't.
+        if (@available(macOS 11.0, iOS 16.4, *))
+            return device.supportsBCTextureCompression;
+        return TARGET_OS_IPHONE == 0;
+    case ASTC_4x4:
+    case ASTC_6x6:
+    case ASTC_8x8:
+    case ASTC_4x4_SRGB:
+    case ASTC_6x6_SRGB:
+    case ASTC_8x8_SRGB:
+        if (@available(macOS 10.15, *))
+            return [device supportsFamily:MTLGPUFamilyApple2];
+        return false;
+    case R8:
+    case RG8:
+        if (@available(macOS 10.15, *))
+            return true;
+        return false;
+    // Only read by set_textures, which replaces it with the contents of the file.
+    case KTX2:
+        return false;
+    default:
+        return true;
+    }
+}
+
+// Block compressed format 8-bit color formats are transcoded into, format itself for others.
+inline DataFormat bc7_format(DataFormat format)
+{
+    switch (format)
+    {
+    case BGRA8:
+    case RGBA8:
+        return BC7_RGBA;
+    case BGRA8_SRGB:
+    case RGBA8_SRGB:
+        return BC7_RGBA_SRGB;
+    default:
+        return format;
+    }
+}
+
+// GPU-only sampled 2D texture with the size of d.
+inline MTLTextureDescriptor *texture_descriptor(const TextureData &d, DataFormat format, unsigned int mip_levels)
+{
+    MTLTextureDescriptor *desc = [[MTLTextureDescriptor alloc] init];
+    desc.width = d.width;
+    desc.height = d.height;
+    desc.pixelFormat = texture_format(format).pixel_format;
+    desc.mipmapLevelCount = mip_levels;
+    desc.sampleCount = 1;
+    desc.storageMode = MTLStorageModePrivate;
+    desc.textureType = MTLTextureType2D;
+    desc.usage = MTLTextureUsageShaderRead;
+    // Gray formats are sampled as color, their last channel as alpha.
+    if (@available(macOS 10.15, *))
+    {
+        if (format == R8)
+            desc.swizzle = MTLTextureSwizzleChannelsMake(MTLTextureSwizzleRed, MTLTextureSwizzleRed,
+                                                         MTLTextureSwizzleRed, MTLTextureSwizzleOne);
+        else if (format == RG8)
+            desc.swizzle = MTLTextureSwizzleChannelsMake(MTLTextureSwizzleRed, MTLTextureSwizzleRed,
+                                                         MTLTextureSwizzleRed, MTLTextureSwizzleGreen);
+    }
+    return desc;
+}
+
+// Whether device stores textures of format with lossy compression, which the GPUs of the A15 and M2 on have for
+// uncompressed color formats.
+inline bool supports_lossy_compression(id<MTLDevice> device, DataFormat format)
+{
+    if (@available(macOS 12.5, *))
+        return texture_format(format).block_width == 1 && [device supportsFamily:MTLGPUFamilyApple8];
+    return false;
+}
+
+inline void mip_level_width_height(const TextureData &d, unsigned int level, unsigned int *width,
+                                   unsigned int *height)
+{
+    if (width)
+        *width = std::max(d.width >> level, 1u);
+    if (height)
+        *height = std::max(d.height >> level, 1u);
+}
+
+// Number of levels of a full mip chain.
+inline unsigned int full_mip_levels(unsigned int width, unsigned int height)
+{
+    unsigned int levels = 1;
+    for (unsigned int size = std::max(width, height); size > 1; size >>= 1)
+        levels++;
+    return levels;
+}
+
+// Byte offset of a mip level in TextureData::bytes, levels are stored tightly packed one after another. Uncompressed
+// levels are not clamped to 1 texel, matching TextureData::offset_for_level in rfw-backend.
+inline size_t mip_offset(const TextureData &d, unsigned int level)
+{
+    const TextureFormat format = texture_format(d.format);
+    size_t offset = 0;
+    for (unsigned int i = 0; i < level; i++)
+    {
+        unsigned int w = d.width >> i;
+        unsigned int h = d.height >> i;
+        if (format.block_width > 1)
+            mip_level_width_height(d, i, &w, &h);
+        offset += format.bytes_per_image(w, h);
+    }
+
+    return offset;
+}
+
+// Bytes of levels first and on of d in TextureData::bytes.
+inline size_t mip_levels_size(const TextureData &d, unsigned int first)
+{
+    const unsigned int last = d.mip_levels - 1;
+    unsigned int w, h;
+    mip_level_width_height(d, last, &w, &h);
+    return mip_offset(d, last) + texture_format(d.format).bytes_per_image(w, h) - mip_offset(d, first);
+}
+
+// Levels first and on of d as a texture of the size of level first. Both sides of level first must be at least 1
+// texel, so the offsets of its levels match those in d.
+inline TextureData mip_tail(const TextureData &d, unsigned int first)
+{
+    TextureData tail = d;
+    mip_level_width_height(d, first, &tail.width, &tail.height);
+    tail.mip_levels = d.mip_levels - first;
+    tail.bytes = d.bytes + mip_offset(d, first);
+    tail.num_bytes = d.num_bytes - std::min(d.num_bytes, mip_offset(d, first));
+    return tail;
+}
+
+#endif // METALCPP_SRC_TEXTURE_FORMAT_HPP
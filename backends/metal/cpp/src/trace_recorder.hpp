@@ -0,0 +1,444 @@
+#ifndef METALCPP_SRC_TRACE_RECORDER_HPP
+#define METALCPP_SRC_TRACE_RECORDER_HPP
+
+#include "library.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+#include <string>
+#include <tuple>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include <pthread.h>
+#include <time.h>
+#include <unistd.h>
+
+// Keeps the last spans of the CPU threads calling into the renderer and of the GPU in a ring, written out on demand
+// as Chrome trace JSON or as a Perfetto trace. Times are nanoseconds of CLOCK_UPTIME_RAW, the clock of
+// mach_absolute_time and of the GPU times of command buffers, FrameTimer maps the GPU timestamps of passes onto it.
+// Span names of the renderer are string literals, names from the caller are interned.
+class TraceRecorder
+{
+  public:
+    static constexpr size_t DEFAULT_CAPACITY = 1 << 16;
+    // Tracks of the GPU, CPU spans are on the track of their thread. Thread ids are never this small.
+    static constexpr uint64_t GPU_COMMAND_BUFFERS_TRACK = 1;
+    static constexpr uint64_t GPU_PASSES_TRACK = 2;
+
+    static uint64_t now()
+    {
+        return clock_gettime_nsec_np(CLOCK_UPTIME_RAW);
+    }
+
+    // Starts recording into a ring of capacity spans, dropping what was recorded before.
+    void start(size_t capacity)
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _events.assign(std::max<size_t>(capacity, 1), Event{});
+        _next = 0;
+        _count = 0;
+        _recording = true;
+    }
+
+    // Stops recording, the spans recorded so far can still be written.
+    void stop()
+    {
+        _recording = false;
+    }
+
+    bool recording() const
+    {
+        return _recording.load(std::memory_order_relaxed);
+    }
+
+    // Adds a span of the calling thread.
+    void add_cpu(const char *name, uint64_t start, uint64_t end)
+    {
+        uint64_t thread = 0;
+        pthread_threadid_np(nullptr, &thread);
+        add(name, "cpu", thread, start, end);
+    }
+
+    // Adds a span of a GPU track, from a completed handler.
+    void add_gpu(const char *name, uint64_t track, uint64_t start, uint64_t end)
+    {
+        add(name, "gpu", track, start, end);
+    }
+
+    // Adds a span the caller timed on the clock of now(), with a name of its own.
+    void add_external(const char *name, uint64_t start, uint64_t end)
+    {
+        if (!recording() || !name)
+            return;
+
+        const char *interned = nullptr;
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            interned = _names.insert(name).first->c_str();
+        }
+        uint64_t thread = 0;
+        pthread_threadid_np(nullptr, &thread);
+        add(interned, "external", thread, start, end);
+    }
+
+    // Writes the recorded spans, oldest first, returns false when path could not be written.
+    bool write(const char *path, TraceFormat format) const
+    {
+        FILE *file = path ? fopen(path, "wb") : nullptr;
+        if (!file)
+            return false;
+
+        std::vector<Event> events;
+        std::vector<std::pair<uint64_t, std::string>> threads;
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            events.reserve(_count);
+            const size_t first = (_next + _events.size() - _count) % std::max<size_t>(_events.size(), 1);
+            for (size_t i = 0; i < _count; i++)
+                events.push_back(_events[(first + i) % _events.size()]);
+            threads = _threads;
+        }
+
+        const bool written = format == TRACE_PERFETTO ? write_perfetto(file, events, threads)
+                                                      : write_chrome_json(file, events, threads);
+        return fclose(file) == 0 && written;
+    }
+
+  private:
+    struct Event
+    {
+        const char *name;
+        const char *category;
+        uint64_t track;
+        uint64_t start;
+        uint64_t end;
+    };
+
+    void add(const char *name, const char *category, uint64_t track, uint64_t start, uint64_t end)
+    {
+        if (!recording())
+            return;
+
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (_events.empty())
+            return;
+        _events[_next] = {name, category, track, start, std::max(start, end)};
+        _next = (_next + 1) % _events.size();
+        _count = std::min(_count + 1, _events.size());
+        if (track > GPU_PASSES_TRACK && std::none_of(_threads.begin(), _threads.end(),
+                                                     [&](const auto &thread) { return thread.first == track; }))
+            _threads.emplace_back(track, thread_name(track));
+    }
+
+    static std::string thread_name(uint64_t thread)
+    {
+        char name[64] = {};
+        pthread_getname_np(pthread_self(), name, sizeof(name));
+        if (name[0] != '\0')
+            return name;
+        if (pthread_main_np())
+            return "Main";
+        return "Thread " + std::to_string(thread);
+    }
+
+    static void write_json_string(FILE *file, const char *string)
+    {
+        fputc('"', file);
+        for (const char *c = string; *c != '\0'; c++)
+        {
+            if (*c == '"' || *c == '\\')
+                fprintf(file, "\\%c", *c);
+            else if (static_cast<unsigned char>(*c) < 0x20)
+                fprintf(file, "\\u%04x", static_cast<unsigned char>(*c));
+            else
+                fputc(*c, file);
+        }
+        fputc('"', file);
+    }
+
+    // Complete events in microseconds, with the names of the tracks as metadata.
+    static bool write_chrome_json(FILE *file, const std::vector<Event> &events,
+                                  const std::vector<std::pair<uint64_t, std::string>> &threads)
+    {
+        const int pid = getpid();
+        fprintf(file, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+        const auto track_name = [&](uint64_t track, const char *name) {
+            fprintf(file, "{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":%d,\"tid\":%llu,\"args\":{\"name\":", pid,
+                    static_cast<unsigned long long>(track));
+            write_json_string(file, name);
+            fprintf(file, "}},\n");
+        };
+        track_name(GPU_COMMAND_BUFFERS_TRACK, "GPU command buffers");
+        track_name(GPU_PASSES_TRACK, "GPU passes");
+        for (const auto &[thread, name] : threads)
+            track_name(thread, name.c_str());
+
+        for (size_t i = 0; i < events.size(); i++)
+        {
+            const Event &event = events[i];
+            fprintf(file, "{\"ph\":\"X\",\"pid\":%d,\"tid\":%llu,\"ts\":%.3f,\"dur\":%.3f,\"cat\":\"%s\",",
+                    pid, static_cast<unsigned long long>(event.track), static_cast<double>(event.start) * 1e-3,
+                    static_cast<double>(event.end - event.start) * 1e-3, event.category);
+            fprintf(file, "\"name\":");
+            write_json_string(file, event.name);
+            fprintf(file, "}%s\n", i + 1 < events.size() ? "," : "");
+        }
+        fprintf(file, "]}\n");
+        return ferror(file) == 0;
+    }
+
+    // Minimal protobuf encoding of the fields of perfetto.protos.Trace that track events need.
+    struct Proto
+    {
+        std::string bytes;
+
+        void varint(uint64_t value)
+        {
+            while (value >= 0x80)
+            {
+                bytes.push_back(static_cast<char>((value & 0x7F) | 0x80));
+                value >>= 7;
+            }
+            bytes.push_back(static_cast<char>(value));
+        }
+        void field(unsigned int number, uint64_t value)
+        {
+            varint(static_cast<uint64_t>(number) << 3);
+            varint(value);
+        }
+        void field(unsigned int number, const std::string &value)
+        {
+            varint((static_cast<uint64_t>(number) << 3) | 2);
+            varint(value.size());
+            bytes += value;
+        }
+        void field(unsigned int number, const Proto &message)
+        {
+            field(number, message.bytes);
+        }
+    };
+
+    // Field numbers of perfetto/trace/trace_packet.proto and the descriptors and events it holds.
+    enum : unsigned int
+    {
+        TRACE_PACKET = 1,
+        PACKET_TIMESTAMP = 8,
+        PACKET_SEQUENCE_ID = 10,
+        PACKET_TRACK_EVENT = 11,
+        PACKET_SEQUENCE_FLAGS = 13,
+        PACKET_TRACK_DESCRIPTOR = 60,
+        TRACK_UUID = 1,
+        TRACK_NAME = 2,
+        TRACK_PROCESS = 3,
+        TRACK_THREAD = 4,
+        TRACK_PARENT_UUID = 5,
+        PROCESS_PID = 1,
+        PROCESS_NAME = 6,
+        THREAD_PID = 1,
+        THREAD_TID = 2,
+        THREAD_NAME = 5,
+        EVENT_TYPE = 9,
+        EVENT_TRACK_UUID = 11,
+        EVENT_CATEGORIES = 22,
+        EVENT_NAME = 23,
+        SLICE_BEGIN = 1,
+        SLICE_END = 2,
+        INSTANT = 3,
+        SEQUENCE_ID = 1,
+        SEQ_INCREMENTAL_STATE_CLEARED = 1
+    };
+
+    // Tracks of the process are children of its track, with uuids of their own: the process, the GPU tracks, the
+    // threads in the order they were seen and the extra lanes of the GPU tracks.
+    static bool write_perfetto(FILE *file, const std::vector<Event> &events,
+                               const std::vector<std::pair<uint64_t, std::string>> &threads)
+    {
+        const int pid = getpid();
+        constexpr uint64_t PROCESS_UUID = 1;
+        const auto uuid = [&](uint64_t track) -> uint64_t {
+            if (track <= GPU_PASSES_TRACK)
+                return PROCESS_UUID + track;
+            for (size_t i = 0; i < threads.size(); i++)
+            {
+                if (threads[i].first == track)
+                    return PROCESS_UUID + GPU_PASSES_TRACK + 1 + i;
+            }
+            return PROCESS_UUID;
+        };
+
+        Proto trace;
+        const auto packet = [&](Proto &contents) {
+            contents.field(PACKET_SEQUENCE_ID, SEQUENCE_ID);
+            trace.field(TRACE_PACKET, contents);
+        };
+
+        Proto process;
+        process.field(PROCESS_PID, static_cast<uint64_t>(pid));
+        process.field(PROCESS_NAME, std::string(getprogname()));
+        Proto process_track;
+        process_track.field(TRACK_UUID, PROCESS_UUID);
+        process_track.field(TRACK_PROCESS, process);
+        Proto descriptor;
+        descriptor.field(PACKET_TRACK_DESCRIPTOR, process_track);
+        descriptor.field(PACKET_SEQUENCE_FLAGS, SEQ_INCREMENTAL_STATE_CLEARED);
+        packet(descriptor);
+
+        // Spans of a GPU track overlap when the work of frames in flight runs at once, which the nested slices of a
+        // single track can't show. They are spread over lanes, the first one is the track itself and the others are
+        // tracks of their own below the process.
+        std::vector<uint64_t> event_tracks(events.size());
+        for (size_t i = 0; i < events.size(); i++)
+            event_tracks[i] = uuid(events[i].track);
+        uint64_t next_uuid = PROCESS_UUID + GPU_PASSES_TRACK + 1 + threads.size();
+        const auto track_descriptor = [&](uint64_t track_uuid, const std::string &name) {
+            Proto gpu_track;
+            gpu_track.field(TRACK_UUID, track_uuid);
+            gpu_track.field(TRACK_NAME, name);
+            gpu_track.field(TRACK_PARENT_UUID, PROCESS_UUID);
+            Proto gpu_descriptor;
+            gpu_descriptor.field(PACKET_TRACK_DESCRIPTOR, gpu_track);
+            packet(gpu_descriptor);
+        };
+        for (const auto &[track, name] : {std::make_pair(GPU_COMMAND_BUFFERS_TRACK, "GPU command buffers"),
+                                          std::make_pair(GPU_PASSES_TRACK, "GPU passes")})
+        {
+            track_descriptor(uuid(track), name);
+
+            std::vector<size_t> spans;
+            for (size_t i = 0; i < events.size(); i++)
+            {
+                // Instants don't nest, they stay on the first lane.
+                if (events[i].track == track && events[i].start != events[i].end)
+                    spans.push_back(i);
+            }
+            std::stable_sort(spans.begin(), spans.end(),
+                             [&](size_t a, size_t b) { return events[a].start < events[b].start; });
+            std::vector<std::pair<uint64_t, uint64_t>> lanes = {{uuid(track), 0}};
+            for (const size_t i : spans)
+            {
+                auto lane = std::find_if(lanes.begin(), lanes.end(),
+                                         [&](const auto &candidate) { return candidate.second <= events[i].start; });
+                if (lane == lanes.end())
+                {
+                    track_descriptor(next_uuid, name + std::string(" ") + std::to_string(lanes.size() + 1));
+                    lanes.emplace_back(next_uuid++, 0);
+                    lane = lanes.end() - 1;
+                }
+                lane->second = events[i].end;
+                event_tracks[i] = lane->first;
+            }
+        }
+        for (const auto &[thread, name] : threads)
+        {
+            Proto thread_descriptor;
+            thread_descriptor.field(THREAD_PID, static_cast<uint64_t>(pid));
+            thread_descriptor.field(THREAD_TID, thread);
+            thread_descriptor.field(THREAD_NAME, name);
+            Proto thread_track;
+            thread_track.field(TRACK_UUID, uuid(thread));
+            thread_track.field(TRACK_PARENT_UUID, PROCESS_UUID);
+            thread_track.field(TRACK_THREAD, thread_descriptor);
+            Proto packet_descriptor;
+            packet_descriptor.field(PACKET_TRACK_DESCRIPTOR, thread_track);
+            packet(packet_descriptor);
+        }
+
+        // Spans are written as a begin and an end event in timestamp order. At the same time ends come first, then
+        // begins with the longest span first so it encloses the others. Spans without length are a single instant,
+        // a begin and end of their own could not be ordered against the others.
+        enum : uint64_t
+        {
+            PHASE_END,
+            PHASE_BEGIN,
+            PHASE_INSTANT
+        };
+        struct Slice
+        {
+            uint64_t timestamp;
+            uint64_t phase;
+            uint64_t order;
+            size_t event;
+
+            bool operator<(const Slice &other) const
+            {
+                return std::tie(timestamp, phase, order, event) <
+                       std::tie(other.timestamp, other.phase, other.order, other.event);
+            }
+        };
+        std::vector<Slice> slices;
+        slices.reserve(events.size() * 2);
+        for (size_t i = 0; i < events.size(); i++)
+        {
+            const Event &event = events[i];
+            if (event.start == event.end)
+            {
+                slices.push_back({event.start, PHASE_INSTANT, 0, i});
+                continue;
+            }
+            slices.push_back({event.start, PHASE_BEGIN, ~(event.end - event.start), i});
+            slices.push_back({event.end, PHASE_END, 0, i});
+        }
+        std::sort(slices.begin(), slices.end());
+        for (const Slice &slice : slices)
+        {
+            const Event &event = events[slice.event];
+            Proto track_event;
+            track_event.field(EVENT_TYPE, slice.phase == PHASE_END     ? SLICE_END
+                                          : slice.phase == PHASE_BEGIN ? SLICE_BEGIN
+                                                                       : INSTANT);
+            track_event.field(EVENT_TRACK_UUID, event_tracks[slice.event]);
+            if (slice.phase != PHASE_END)
+            {
+                track_event.field(EVENT_CATEGORIES, std::string(event.category));
+                track_event.field(EVENT_NAME, std::string(event.name));
+            }
+            Proto contents;
+            contents.field(PACKET_TIMESTAMP, slice.timestamp);
+            contents.field(PACKET_TRACK_EVENT, track_event);
+            packet(contents);
+        }
+        return fwrite(trace.bytes.data(), 1, trace.bytes.size(), file) == trace.bytes.size();
+    }
+
+    std::atomic<bool> _recording{false};
+    mutable std::mutex _mutex;
+    std::vector<Event> _events;
+    size_t _next = 0;
+    size_t _count = 0;
+    // Names of the threads that recorded spans, by thread id.
+    std::vector<std::pair<uint64_t, std::string>> _threads;
+    std::unordered_set<std::string> _names;
+};
+
+// Adds a span of the calling thread from its construction to its destruction while the recorder records.
+class TraceSpan
+{
+  public:
+    TraceSpan(TraceRecorder &recorder, const char *name)
+        : _recorder(recorder.recording() ? &recorder : nullptr), _name(name),
+          _start(_recorder ? TraceRecorder::now() : 0)
+    {
+    }
+
+    TraceSpan(const TraceSpan &) = delete;
+    TraceSpan &operator=(const TraceSpan &) = delete;
+
+    ~TraceSpan()
+    {
+        if (_recorder)
+            _recorder->add_cpu(_name, _start, TraceRecorder::now());
+    }
+
+  private:
+    TraceRecorder *_recorder;
+    const char *_name;
+    uint64_t _start;
+};
+
+#endif // METALCPP_SRC_TRACE_RECORDER_HPP
@@ -0,0 +1,192 @@
+#ifndef METALCPP_SRC_UPLOAD_RING_HPP
+#define METALCPP_SRC_UPLOAD_RING_HPP
+
+#import <Metal/Metal.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include "buffer.hpp"
+#include "retired_resources.hpp"
+#include "utils.hpp"
+
+struct UploadAllocation
+{
+    id<MTLBuffer> buffer = nil;
+    size_t offset = 0;
+    size_t size = 0;
+    void *data = nullptr;
+
+    bool valid() const
+    {
+        return buffer != nil;
+    }
+};
+
+// Linear allocator over one large persistent buffer for data that only lives for a single frame. Allocations are
+// bumped from the head and become free again once the GPU finished the frame that made them, so steady-state frames
+// never touch the driver allocator and never write into memory the GPU may still be reading.
+class UploadRing
+{
+  public:
+    static constexpr size_t ALIGNMENT = 256;
+
+    UploadRing(id<MTLDevice> device, size_t capacity, unsigned int frames_in_flight)
+        : _device(device), _head(0), _tail(0), _frame(0), _flush_start(0)
+    {
+        _frame_ends.resize(frames_in_flight, 0);
+        allocate_buffer(capacity);
+    }
+
+    ~UploadRing()
+    {
+        _buffer = nil;
+        _device = nil;
+    }
+
+    // Buffers the ring outgrows are retired here, frames in flight may still read them.
+    void set_retired(RetiredResources *retired)
+    {
+        _retired = retired;
+    }
+
+    void set_frames_in_flight(unsigned int frames_in_flight)
+    {
+        // Only valid when the GPU is idle, every region can be reused.
+        _frame_ends.assign(frames_in_flight, _head);
+        _tail = _head;
+        _frame = 0;
+    }
+
+    // Must be called once the GPU is done with the previous submission of this frame slot.
+    void begin_frame(unsigned int frame)
+    {
+        _frame = frame;
+        // Frames complete in order, so everything up to the end of this slot's previous frame is free.
+        _tail = std::max(_tail, _frame_ends[frame]);
+        _flush_start = _head;
+    }
+
+    void end_frame()
+    {
+        flush();
+        _frame_ends[_frame] = _head;
+    }
+
+    UploadAllocation allocate(size_t bytes, size_t alignment = ALIGNMENT)
+    {
+        if (bytes == 0)
+            return {};
+
+        alignment = std::max(alignment, ALIGNMENT);
+        const size_t capacity = _capacity;
+
+        uint64_t start = align(_head, alignment);
+        // Allocations never wrap around the end of the buffer, skip to the start instead.
+        if ((start % capacity) + bytes > capacity)
+            start = align(start + (capacity - (start % capacity)), alignment);
+
+        if (start + bytes - _tail > capacity)
+        {
+            // Out of space: switch to a larger buffer. The old one is retired, so it is released once the frames in
+            // flight completed.
+            flush();
+            if (_retired)
+                _retired->retire(_buffer);
+            const size_t min_capacity = next_multiple_of(static_cast<unsigned int>(bytes), ALIGNMENT) * 2;
+            allocate_buffer(std::max(capacity * 2, min_capacity));
+            for (uint64_t &end : _frame_ends)
+                end = 0;
+            _head = _tail = _flush_start = 0;
+            return allocate(bytes, alignment);
+        }
+
+        if (start / capacity != _flush_start / capacity)
+        {
+            // Wrapped around, flush the part written at the end of the buffer first.
+            flush();
+            _flush_start = start;
+        }
+
+        _head = start + bytes;
+        _uploaded += bytes;
+
+        UploadAllocation allocation;
+        allocation.buffer = _buffer;
+        allocation.offset = static_cast<size_t>(start % capacity);
+        allocation.size = bytes;
+        allocation.data = reinterpret_cast<std::byte *>([_buffer contents]) + allocation.offset;
+        return allocation;
+    }
+
+    template <typename T> UploadAllocation upload(const T *data, size_t count, size_t alignment = ALIGNMENT)
+    {
+        UploadAllocation allocation = allocate(count * sizeof(T), alignment);
+        if (allocation.valid())
+            memcpy(allocation.data, data, count * sizeof(T));
+        return allocation;
+    }
+
+    size_t capacity() const
+    {
+        return _capacity;
+    }
+
+    // Bytes allocated since the ring was created.
+    uint64_t uploaded() const
+    {
+        return _uploaded;
+    }
+
+    id<MTLBuffer> buffer() const
+    {
+        return _buffer;
+    }
+
+  private:
+    static uint64_t align(uint64_t value, size_t alignment)
+    {
+        return (value + alignment - 1) / alignment * alignment;
+    }
+
+    void allocate_buffer(size_t capacity)
+    {
+        _capacity = next_multiple_of(static_cast<unsigned int>(capacity), ALIGNMENT);
+        _managed = ![_device hasUnifiedMemory];
+        const MTLResourceOptions options =
+            (_managed ? MANAGED_STORAGE : MTLResourceStorageModeShared) |
+            MTLResourceCPUCacheModeWriteCombined;
+        _buffer = [_device newBufferWithLength:_capacity options:options];
+        _buffer.label = @"UploadRing";
+    }
+
+    // Managed buffers need to know which bytes the CPU wrote before the GPU may read them.
+    void flush()
+    {
+        if (!_managed || _head <= _flush_start)
+            return;
+
+        const size_t start = static_cast<size_t>(_flush_start % _capacity);
+        did_modify(_buffer, NSMakeRange(start, static_cast<size_t>(_head - _flush_start)));
+        _flush_start = _head;
+    }
+
+    id<MTLDevice> _device;
+    id<MTLBuffer> _buffer;
+    RetiredResources *_retired = nullptr;
+    size_t _capacity;
+    bool _managed;
+
+    // Monotonic byte counters, positions in the buffer are these modulo the capacity.
+    uint64_t _head;
+    uint64_t _tail;
+    std::vector<uint64_t> _frame_ends;
+    unsigned int _frame;
+    uint64_t _flush_start;
+    // Unlike the head, not reset when the ring grows.
+    uint64_t _uploaded = 0;
+};
+
+#endif // METALCPP_SRC_UPLOAD_RING_HPP
@@ -0,0 +1,72 @@
+#ifndef METALCPP_SRC_UPLOAD_SCHEDULER_HPP
+#define METALCPP_SRC_UPLOAD_SCHEDULER_HPP
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <limits>
+
+#include "library.h"
+
+// Caps the bytes of mesh and texture data staged per frame and the time spent copying them. Work past the budget is
+// left for the next frame, the first piece of a frame is always allowed so resources larger than the budget still
+// progress.
+class UploadScheduler
+{
+  public:
+    using Clock = std::chrono::steady_clock;
+
+    void configure(const UploadBudget &budget)
+    {
+        _bytes_per_frame = size_t(budget.megabytes_per_frame) << 20;
+        _time_per_frame = std::chrono::microseconds(budget.microseconds_per_frame);
+    }
+
+    bool enabled() const
+    {
+        return _bytes_per_frame > 0 || _time_per_frame.count() > 0;
+    }
+
+    void begin_frame()
+    {
+        _bytes = 0;
+        _time = Clock::duration::zero();
+    }
+
+    // Bytes that may still be staged this frame, 0 once the budget is spent.
+    size_t available() const
+    {
+        if (!enabled() || _bytes == 0)
+            return std::numeric_limits<size_t>::max();
+        if (_time_per_frame.count() > 0 && _time >= _time_per_frame)
+            return 0;
+        if (_bytes_per_frame == 0)
+            return std::numeric_limits<size_t>::max();
+        return _bytes_per_frame - std::min(_bytes, _bytes_per_frame);
+    }
+
+    bool allows(size_t bytes) const
+    {
+        return bytes <= available();
+    }
+
+    // Counts bytes staged and the time since start spent staging them.
+    void spend(size_t bytes, Clock::time_point start)
+    {
+        _bytes += bytes;
+        _time += Clock::now() - start;
+    }
+
+    void spend(size_t bytes)
+    {
+        _bytes += bytes;
+    }
+
+  private:
+    size_t _bytes_per_frame = 0;
+    Clock::duration _time_per_frame = Clock::duration::zero();
+    size_t _bytes = 0;
+    Clock::duration _time = Clock::duration::zero();
+};
+
+#endif // METALCPP_SRC_UPLOAD_SCHEDULER_HPP
@@ -5,10 +5,14 @@
 #ifndef METALCPP_SRC_UTILS_HPP
 #define METALCPP_SRC_UTILS_HPP
 
+#include <algorithm>
 #include <fstream>
 #include <iostream>
 #include <random>
 #include <string>
+#include <vector>
+
+#include <dispatch/dispatch.h>
 
 inline unsigned int next_multiple_of(unsigned int count, unsigned int multiple_of)
 {
@@ -16,6 +20,109 @@ inline unsigned int next_multiple_of(unsigned int count, unsigned int multiple_o
     return a * multiple_of;
 }
 
+inline unsigned int next_power_of_two(unsigned int value)
+{
+    unsigned int result = 1;
+    while (result < value)
+        result <<= 1;
+    return result;
+}
+
+// Whether bit i of a bitset of num_bits bits is set, bits are stored from the least significant bit of each word on.
+// Bits past the end and those of a null bitset count as set.
+inline bool bit_set(const size_t *bits, unsigned int num_bits, unsigned int i)
+{
+    constexpr unsigned int word_bits = sizeof(size_t) * 8;
+    return !bits || i >= num_bits || ((bits[i / word_bits] >> (i % word_bits)) & 1) != 0;
+}
+
+// Element range [start, end) of a buffer that was written by the CPU.
+struct DirtyRange
+{
+    unsigned int start;
+    unsigned int end;
+};
+
+// Merges overlapping ranges and ranges separated by small gaps, the result is sorted by start.
+inline std::vector<DirtyRange> coalesce(std::vector<DirtyRange> ranges, unsigned int max_gap = 512)
+{
+    if (ranges.size() <= 1)
+        return ranges;
+
+    std::sort(ranges.begin(), ranges.end(), [](const DirtyRange &a, const DirtyRange &b) { return a.start < b.start; });
+
+    std::vector<DirtyRange> result;
+    result.push_back(ranges[0]);
+    for (size_t i = 1; i < ranges.size(); i++)
+    {
+        DirtyRange &last = result.back();
+        if (ranges[i].start <= last.end + max_gap)
+            last.end = std::max(last.end, ranges[i].end);
+        else
+            result.push_back(ranges[i]);
+    }
+
+    return result;
+}
+
+// Calls fn(first, last) for chunks of at most grain items on the global queue and waits for all of them, counts
+// that fit one chunk run on the calling thread.
+template <typename F> inline void parallel_for(size_t count, size_t grain, const F &fn)
+{
+    if (count <= grain)
+    {
+        if (count > 0)
+            fn(size_t(0), count);
+        return;
+    }
+
+    const F *chunk = &fn;
+    dispatch_apply((count + grain - 1) / grain, dispatch_get_global_queue(QOS_CLASS_USER_INTERACTIVE, 0), ^(size_t i) {
+      const size_t first = i * grain;
+      (*chunk)(first, std::min(first + grain, count));
+    });
+}
+
+// Part [first, first + count) of range index range.
+struct WorkPiece
+{
+    size_t range;
+    size_t first;
+    size_t count;
+};
+
+// Splits ranges of the given sizes into pieces of at most grain units and runs fn(piece) for batches of about grain
+// units each on the global queue, so a few large ranges spread over the threads just like many small ones.
+template <typename F> inline void parallel_ranges(const std::vector<size_t> &sizes, size_t grain, const F &fn)
+{
+    std::vector<WorkPiece> pieces;
+    std::vector<size_t> batches = {0};
+    size_t batch = 0;
+    for (size_t i = 0; i < sizes.size(); i++)
+    {
+        for (size_t first = 0; first < sizes[i]; first += grain)
+        {
+            const size_t count = std::min(grain, sizes[i] - first);
+            pieces.push_back({i, first, count});
+            batch += count;
+            if (batch >= grain)
+            {
+                batches.push_back(pieces.size());
+                batch = 0;
+            }
+        }
+    }
+    if (batches.back() != pieces.size())
+        batches.push_back(pieces.size());
+
+    const WorkPiece *piece = pieces.data();
+    const size_t *bounds = batches.data();
+    parallel_for(batches.size() - 1, 1, [&fn, piece, bounds](size_t first, size_t last) {
+        for (size_t i = bounds[first]; i < bounds[last]; i++)
+            fn(piece[i]);
+    });
+}
+
 inline std::string random_string(size_t length)
 {
     auto randchar = []() -> char {
@@ -0,0 +1,91 @@
+#ifndef METALCPP_SRC_VECTOR_PATHS_HPP
+#define METALCPP_SRC_VECTOR_PATHS_HPP
+
+#import <Metal/Metal.h>
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "library.h"
+#include "structs.h"
+
+// Segments of a 2D path in path space, followed in the same buffer by the (first, count) ranges of the rows and then
+// the columns of bands its bounds are divided into, and the segment indices of all bands. A pixel only visits the
+// segments of the bands it is in.
+struct Path2D
+{
+    id<MTLBuffer> buffer = nil;
+    NSUInteger bands_offset = 0;
+    NSUInteger indices_offset = 0;
+    // Bounds of the segments, min x, min y, max x and max y.
+    glm::vec4 bounds = glm::vec4(0.0f);
+    PathUniforms2D uniforms = {};
+};
+
+struct PathBands
+{
+    std::vector<glm::uvec2> ranges;
+    std::vector<unsigned int> indices;
+};
+
+// Lists the segments of every band by the span they cross, rows by y first and columns by x after them. Bands of a
+// path have about PATH_BAND_SEGMENTS segments each when its segments are evenly spread.
+inline PathBands build_path_bands(const PathSegment2D *segments, unsigned int count, glm::vec4 bounds,
+                                  unsigned int bands_x, unsigned int bands_y)
+{
+    PathBands bands;
+    bands.ranges.reserve(bands_x + bands_y);
+    const glm::vec2 bmin(bounds.x, bounds.y);
+    const glm::vec2 band_size = glm::max(glm::vec2(bounds.z, bounds.w) - bmin, glm::vec2(1e-6f)) /
+                                glm::vec2(static_cast<float>(bands_x), static_cast<float>(bands_y));
+    const auto add_bands = [&](unsigned int axis, unsigned int num_bands) {
+        std::vector<std::vector<unsigned int>> lists(num_bands);
+        for (unsigned int i = 0; i < count; i++)
+        {
+            const float a = axis == 0 ? segments[i].x0 : segments[i].y0;
+            const float b = axis == 0 ? segments[i].x1 : segments[i].y1;
+            const auto band_of = [&](float v) {
+                return std::clamp(static_cast<int>(std::floor((v - bmin[axis]) / band_size[axis])), 0,
+                                  static_cast<int>(num_bands) - 1);
+            };
+            for (int band = band_of(std::min(a, b)); band <= band_of(std::max(a, b)); band++)
+                lists[band].push_back(i);
+        }
+        for (const std::vector<unsigned int> &list : lists)
+        {
+            bands.ranges.emplace_back(static_cast<unsigned int>(bands.indices.size()),
+                                      static_cast<unsigned int>(list.size()));
+            bands.indices.insert(bands.indices.end(), list.begin(), list.end());
+        }
+    };
+    add_bands(1, bands_y);
+    add_bands(0, bands_x);
+    return bands;
+}
+
+// Grows the quad of path by its stroke and one pixel of its antialiased edges under matrix_2d, in a target of size
+// pixels. Returns false when the quad is outside the view.
+inline bool update_path_quad(Path2D &path, const glm::mat4 &matrix_2d, glm::vec2 size)
+{
+    const glm::mat4 matrix = matrix_2d * *reinterpret_cast<const glm::mat4 *>(&path.uniforms.transform);
+    const float pixels_x = glm::length(glm::vec2(matrix[0]) * size * 0.5f);
+    const float pixels_y = glm::length(glm::vec2(matrix[1]) * size * 0.5f);
+    const float pixel = 1.0f / std::max(std::min(pixels_x, pixels_y), 1e-6f);
+    const float margin = path.uniforms.half_width + pixel;
+    const glm::vec4 quad = path.bounds + glm::vec4(-margin, -margin, margin, margin);
+    path.uniforms.quad = simd_make_float4(quad.x, quad.y, quad.z, quad.w);
+
+    glm::ivec4 outside(0);
+    for (unsigned int corner = 0; corner < 4; corner++)
+    {
+        const glm::vec4 clip =
+            matrix * glm::vec4(corner & 1 ? quad.z : quad.x, corner & 2 ? quad.w : quad.y, path.uniforms.z, 1.0f);
+        outside += glm::ivec4(clip.x < -clip.w, clip.x > clip.w, clip.y < -clip.w, clip.y > clip.w);
+    }
+    return !glm::any(glm::equal(outside, glm::ivec4(4)));
+}
+
+#endif // METALCPP_SRC_VECTOR_PATHS_HPP
@@ -6,9 +6,23 @@
 #define METALCPP_SRC_VERTEXLIST_H
 
 #include "buffer.hpp"
+#include "id_table.hpp"
+#include "range_allocator.hpp"
+#include "signposts.hpp"
+#include "staging_buffer.hpp"
+#include "upload_scheduler.hpp"
 #include "utils.hpp"
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstring>
 #include <map>
 #include <memory>
+#include <simd/simd.h>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
 
 template <typename T, typename JW> struct RangeDescriptor
 {
@@ -20,6 +34,14 @@ template <typename T, typename JW> struct RangeDescriptor
         capacity = 0;
         jw_ptr = nullptr;
         jw_start = 0;
+        has_joints = false;
+        buffer_only = false;
+        index_ptr = nullptr;
+        index_count = 0;
+        index_start = 0;
+        index_capacity = 0;
+        short_indices = false;
+        dirty = true;
     }
 
     const T *ptr;
@@ -28,6 +50,16 @@ template <typename T, typename JW> struct RangeDescriptor
     unsigned int capacity;
     const JW *jw_ptr;
     unsigned int jw_start;
+    bool has_joints;
+    // The list dropped its copy of the data and the pointers are null, see VertexList::set_copy_on_submit().
+    bool buffer_only;
+    // Indices are stored relative to start, in 32-bit words of the index buffer.
+    const unsigned int *index_ptr;
+    unsigned int index_count;
+    unsigned int index_start;
+    unsigned int index_capacity;
+    bool short_indices;
+    bool dirty;
 };
 
 struct DrawDescriptor
@@ -36,34 +68,117 @@ struct DrawDescriptor
     unsigned int end;
     unsigned int jw_start;
     unsigned int jw_end;
+    // Byte offset into the index buffer, index_count is 0 for non-indexed meshes.
+    unsigned int index_offset;
+    unsigned int index_count;
+    bool short_indices;
 };
 
-template <typename T, typename JW> class VertexList
+template <typename T, typename JW, typename Allocator = MetalAllocator> class VertexList
 {
   public:
-    VertexList() : _total_vertices(0), _total_jw(0), _recalculate_ranges(true)
+    template <typename U> using Buffer = typename Allocator::template Buffer<U>;
+
+    // Ranges are rounded up to this many elements so small size changes don't move a mesh.
+    static constexpr unsigned int RANGE_GRANULARITY = 64;
+
+    VertexList() : _total_vertices(0), _total_jw(0), _total_index_words(0)
+    {
+    }
+
+    void reserve(unsigned int id_bound)
     {
+        _pointers.reserve(id_bound);
+        _draw_ranges.reserve(id_bound);
     }
 
-    void add_pointer(unsigned int id, const T *pointer, unsigned int count, const JW *joints_weights = nullptr)
+    void add_pointer(unsigned int id, const T *pointer, unsigned int count, const JW *joints_weights = nullptr,
+                     const unsigned int *indices = nullptr, unsigned int num_indices = 0)
     {
+        if (_copy_on_submit)
+            copy_data(id, pointer, count, joints_weights, indices, num_indices);
+
         RangeDescriptor<T, JW> desc = {};
         desc.ptr = pointer;
-        desc.start = 0;
-        desc.capacity = next_multiple_of(count, 512);
         desc.count = count;
         desc.jw_ptr = joints_weights;
-        desc.jw_start = 0;
-        _pointers.insert({id, desc});
+        desc.has_joints = joints_weights != nullptr;
+
+        const size_t hash = _deduplicate ? content_hash(pointer, count, joints_weights, indices, num_indices) : 0;
+        const unsigned int owner = find_owner(hash, pointer, count, joints_weights, indices, num_indices);
+        if (owner != NO_OWNER)
+        {
+            desc.dirty = false;
+            share(id, desc, owner, indices);
+            _pointers.insert(id, desc);
+            update_draw_range(id, desc);
+            return;
+        }
 
-        DrawDescriptor draw_desc = {};
-        draw_desc.start = 0;
-        draw_desc.end = count;
-        draw_desc.jw_start = 0;
-        draw_desc.jw_end = 0;
-        _draw_ranges.insert({id, draw_desc});
+        desc.capacity = next_multiple_of(count, RANGE_GRANULARITY);
+        desc.start = allocate(_allocator, desc.capacity);
+        if (desc.has_joints)
+            desc.jw_start = allocate(_jw_allocator, desc.capacity);
+        set_indices(desc, indices, num_indices);
+        desc.dirty = true;
+        _pointers.insert(id, desc);
+        _dirty.push_back(id);
+        if (desc.capacity > 0)
+            _mesh_by_offset[desc.start] = id;
+        register_owner(id, hash);
 
-        _recalculate_ranges = true;
+        update_draw_range(id, desc);
+    }
+
+    // Copies the data of a mesh out of the list, false when it only lives in GPU-only memory or with the caller.
+    bool read_mesh(unsigned int id, std::vector<T> &vertices, std::vector<JW> &joints_weights,
+                   std::vector<unsigned int> &indices) const
+    {
+        if (!_pointers.has(id))
+            return false;
+
+        const RangeDescriptor<T, JW> &desc = *_pointers.find(id);
+        const MeshCopy *copy = _copies.find(id);
+        const unsigned int *owner = _owners.find(id);
+        const bool dirty = owner ? _pointers.find(*owner)->dirty : desc.dirty;
+        const bool from_buffer = _buffer && !_staging_queue && !dirty;
+        if (!copy && !from_buffer)
+            return false;
+
+        if (copy && !copy->vertices.empty())
+            vertices = copy->vertices;
+        else if (from_buffer)
+        {
+            const T *data = reinterpret_cast<const T *>(_buffer->data()) + desc.start;
+            vertices.assign(data, data + desc.count);
+        }
+        else
+            return false;
+
+        joints_weights.clear();
+        if (desc.has_joints && copy && !copy->joints_weights.empty())
+            joints_weights = copy->joints_weights;
+        else if (desc.has_joints && from_buffer && _jw_buffer)
+        {
+            const JW *data = reinterpret_cast<const JW *>(_jw_buffer->data()) + desc.jw_start;
+            joints_weights.assign(data, data + desc.count);
+        }
+        else if (desc.has_joints)
+            return false;
+
+        indices.clear();
+        if (desc.index_count > 0 && copy && !copy->indices.empty())
+            indices = copy->indices;
+        else if (desc.index_count > 0 && from_buffer && _index_buffer)
+        {
+            const auto *words = reinterpret_cast<const unsigned int *>(_index_buffer->data()) + desc.index_start;
+            indices.resize(desc.index_count);
+            for (unsigned int i = 0; i < desc.index_count; i++)
+                indices[i] = desc.short_indices ? reinterpret_cast<const uint16_t *>(words)[i] : words[i];
+        }
+        else if (desc.index_count > 0)
+            return false;
+        return true;
     }
 
     size_t size() const
@@ -80,126 +195,364 @@ template <typename T, typename JW> class VertexList
 
     bool has(unsigned int index) const
     {
-        return _draw_ranges.find(index) != _draw_ranges.end();
+        return _draw_ranges.has(index);
     }
 
-    void update_pointer(unsigned int id, const T *pointer, unsigned int count, const JW *joints_weights = nullptr)
+    void update_pointer(unsigned int id, const T *pointer, unsigned int count, const JW *joints_weights = nullptr,
+                        const unsigned int *indices = nullptr, unsigned int num_indices = 0)
     {
+        if (_copy_on_submit)
+            copy_data(id, pointer, count, joints_weights, indices, num_indices);
+        else
+            _copies.erase(id);
+
+        unshare(id);
         RangeDescriptor<T, JW> &reference = _pointers[id];
-        DrawDescriptor draw_range = _draw_ranges[id];
+        const size_t hash = _deduplicate ? content_hash(pointer, count, joints_weights, indices, num_indices) : 0;
+        const unsigned int owner = find_owner(hash, pointer, count, joints_weights, indices, num_indices);
+        if (owner != NO_OWNER)
+        {
+            release(id, reference);
+            if (reference.index_capacity > 0)
+                free_later(&VertexList::_index_allocator, reference.index_start);
+            reference.ptr = pointer;
+            reference.jw_ptr = joints_weights;
+            reference.has_joints = joints_weights != nullptr;
+            reference.buffer_only = false;
+            reference.count = count;
+            share(id, reference, owner, indices);
+            update_draw_range(id, reference);
+            return;
+        }
 
+        // Only this mesh moves when it outgrows its range, every other mesh stays where it is.
+        const bool had_joints = reference.has_joints && reference.capacity > 0;
         if (count > reference.capacity)
         {
-            _recalculate_ranges = true;
-            reference.capacity = next_multiple_of(count, 512);
+            release(id, reference);
+            reference.capacity = next_multiple_of(count, RANGE_GRANULARITY);
+            reference.start = allocate(_allocator, reference.capacity);
+            _mesh_by_offset[reference.start] = id;
+            reference.jw_start = joints_weights ? allocate(_jw_allocator, reference.capacity) : 0;
+        }
+        else if (had_joints && !joints_weights)
+        {
+            // Joint data lives in its own range of the joints/weights buffer.
+            free_later(&VertexList::_jw_allocator, reference.jw_start);
+            reference.jw_start = 0;
+        }
+        else if (!had_joints && joints_weights)
+        {
+            reference.jw_start = allocate(_jw_allocator, reference.capacity);
         }
 
         reference.ptr = pointer;
         reference.jw_ptr = joints_weights;
+        reference.has_joints = joints_weights != nullptr;
+        reference.buffer_only = false;
         reference.count = count;
-        draw_range.end = draw_range.start + count;
+        set_indices(reference, indices, num_indices);
+        update_draw_range(id, reference);
+        register_owner(id, hash);
+
+        if (!reference.dirty)
+        {
+            reference.dirty = true;
+            _dirty.push_back(id);
+        }
+    }
+
+    // Gives mesh id a fresh range that the caller fills in through mapped_data() instead of a pointer the list copies
+    // from. The range is never one that frames in flight may still read, see release().
+    void map_pointer(unsigned int id, unsigned int count)
+    {
+        bool was_dirty = false;
+        _copies.erase(id);
+        unshare(id);
+        if (const RangeDescriptor<T, JW> *previous = _pointers.find(id))
+        {
+            was_dirty = previous->dirty;
+            release(id, *previous);
+            if (previous->index_capacity > 0)
+                free_later(&VertexList::_index_allocator, previous->index_start);
+        }
+
+        RangeDescriptor<T, JW> desc = {};
+        desc.capacity = next_multiple_of(count, RANGE_GRANULARITY);
+        desc.count = count;
+        desc.start = allocate(_allocator, desc.capacity);
+        desc.dirty = true;
+        _pointers.insert(id, desc);
+        if (!was_dirty)
+            _dirty.push_back(id);
+        if (desc.capacity > 0)
+            _mesh_by_offset[desc.start] = id;
+
+        update_draw_range(id, desc);
+    }
+
+    // True when the vertex buffer does not cover every allocated range yet, update_data() grows it.
+    bool needs_reallocation() const
+    {
+        return _allocator.capacity() > 0 && (!_buffer || _buffer->size() < _allocator.capacity());
+    }
+
+    // CPU pointer to the vertices of a mesh set with map_pointer(), nullptr while the buffer needs to grow.
+    T *mapped_data(unsigned int id)
+    {
+        const RangeDescriptor<T, JW> *desc = _pointers.find(id);
+        if (!desc || desc->ptr || _staging_queue || needs_reallocation())
+            return nullptr;
+        return reinterpret_cast<T *>(_buffer->data()) + desc->start;
     }
 
     bool remove_pointer(unsigned int id)
     {
         bool has = false;
-        auto it = _pointers.find(id);
-        if (it != _pointers.end())
+        _copies.erase(id);
+        unshare(id);
+        if (const RangeDescriptor<T, JW> *desc = _pointers.find(id))
         {
             has = true;
-            _pointers.erase(it);
+            release(id, *desc);
+            if (desc->index_capacity > 0)
+                free_later(&VertexList::_index_allocator, desc->index_start);
+            _pointers.erase(id);
         }
 
-        auto it_d = _draw_ranges.find(id);
-        if (it_d != _draw_ranges.end())
-        {
+        if (_draw_ranges.erase(id))
             has = true;
-            _draw_ranges.erase(it_d);
-        }
 
         return has;
     }
 
+    // Must only be called while the GPU is idle, ranges released since the previous call become reusable here.
     void update_ranges()
     {
-        if (!_recalculate_ranges)
+        for (const auto &[allocator, offset] : _pending_frees)
+            (this->*allocator).free(offset);
+        _pending_frees.clear();
+
+        _total_vertices = _allocator.capacity();
+        _total_jw = _jw_allocator.capacity();
+        _total_index_words = _index_allocator.capacity();
+    }
+
+    // Meshes past the budget of uploads stay dirty and draw nothing until a later call uploaded them, nullptr uploads
+    // every dirty mesh.
+    void update_data(id<MTLDevice> device, UploadScheduler *uploads = nullptr)
+    {
+        if (_total_vertices == 0)
             return;
 
-        unsigned int current_offset = 0;
-        unsigned int current_offset_jw = 0;
+        const os_signpost_id_t signpost = signpost_id();
+        os_signpost_interval_begin(signpost_log(), signpost, "VertexList::update_data", "%zu dirty meshes",
+                                   _dirty.size());
 
-        for (auto &[id, desc] : _pointers)
+        unsigned int total = _total_vertices;
+        const MTLResourceOptions storage = _staging_queue ? MTLResourceStorageModePrivate : cpu_write_storage(device);
+        if (!_buffer || (_buffer && _buffer->size() < total))
+        {
+            if (!grow(device, _buffer, next_multiple_of(total, 2048), storage))
+                mark_all_dirty();
+        }
+
+        if (_total_jw > 0 && (!_jw_buffer || _jw_buffer->size() < _total_jw))
         {
-            desc.start = current_offset;
-            std::map<unsigned int, DrawDescriptor>::iterator range = _draw_ranges.find(id);
-            if (range == _draw_ranges.end())
+            if (!grow(device, _jw_buffer, next_multiple_of(_total_jw, 2048), storage))
+                mark_all_dirty();
+        }
+
+        if (_total_index_words > 0 && (!_index_buffer || _index_buffer->size() < _total_index_words))
+        {
+            if (!grow(device, _index_buffer, next_multiple_of(_total_index_words, 2048), storage))
+                mark_all_dirty();
+        }
+
+        // The position stream is only written on the GPU, a new one is extracted whole.
+        if (_position_stream && (!_position_buffer || _position_buffer->size() < _buffer->size()))
+        {
+            _position_buffer = std::make_unique<Buffer<simd_float4>>(device, _buffer->size(),
+                                                                     MTLResourceStorageModePrivate);
+            _position_ranges = {{0, static_cast<unsigned int>(_buffer->size())}};
+        }
+
+        if (_dirty.empty())
+        {
+            os_signpost_interval_end(signpost_log(), signpost, "VertexList::update_data", "0 bytes uploaded");
+            return;
+        }
+
+        // Copy only the meshes that changed and let Metal know which ranges were touched, ranges are coalesced so
+        // neighbouring meshes result in a single modified range.
+        std::vector<DirtyRange> vertex_ranges;
+        std::vector<DirtyRange> jw_ranges;
+        std::vector<DirtyRange> index_ranges;
+        vertex_ranges.reserve(_dirty.size());
+        size_t uploaded = 0;
+
+        // Destinations are reserved here, the copies themselves run on several threads once all of them are known.
+        std::vector<Copy> copies;
+        copies.reserve(_dirty.size());
+        std::vector<unsigned int> deferred;
+        const auto start = UploadScheduler::Clock::now();
+
+        for (const unsigned int id : _dirty)
+        {
+            RangeDescriptor<T, JW> *found = _pointers.find(id);
+            if (!found)
                 continue;
 
-            range->second.start = current_offset;
-            range->second.end = current_offset + desc.count;
+            RangeDescriptor<T, JW> &desc = *found;
+            if (desc.count == 0 || _owners.has(id))
+            {
+                desc.dirty = false;
+                continue;
+            }
 
-            if (desc.jw_ptr)
+            const size_t bytes = upload_size(desc);
+            if (uploads && !uploads->allows(bytes))
             {
-                desc.jw_start = current_offset_jw;
-                range->second.jw_start = current_offset_jw;
-                range->second.jw_end = current_offset_jw + desc.count;
+                hide_draw_range(id);
+                deferred.push_back(id);
+                continue;
+            }
+            if (uploads)
+                uploads->spend(bytes);
+            desc.dirty = false;
+            show_draw_range(id, desc);
 
-                current_offset_jw += desc.capacity;
+            if (desc.ptr)
+            {
+                void *data = write_pointer(device, *_buffer, desc.start * sizeof(T), desc.count * sizeof(T));
+                copies.push_back({data, desc.ptr, desc.count * sizeof(T), false});
+                uploaded += desc.count * sizeof(T);
             }
-            else
+            vertex_ranges.push_back({desc.start, desc.start + desc.count});
+
+            if (desc.jw_ptr && _jw_buffer)
             {
-                desc.jw_start = 0;
-                range->second.jw_start = 0;
-                range->second.jw_end = 0;
+                void *jw_data = write_pointer(device, *_jw_buffer, desc.jw_start * sizeof(JW), desc.count * sizeof(JW));
+                copies.push_back({jw_data, desc.jw_ptr, desc.count * sizeof(JW), false});
+                uploaded += desc.count * sizeof(JW);
+                jw_ranges.push_back({desc.jw_start, desc.jw_start + desc.count});
             }
 
-            current_offset += desc.capacity;
+            if (desc.index_ptr && desc.index_count > 0 && _index_buffer)
+            {
+                void *words = write_pointer(device, *_index_buffer, desc.index_start * sizeof(unsigned int),
+                                            index_words(desc) * sizeof(unsigned int));
+                copies.push_back({words, desc.index_ptr, desc.index_count * sizeof(unsigned int), desc.short_indices});
+                index_ranges.push_back({desc.index_start, desc.index_start + index_words(desc)});
+                uploaded += index_words(desc) * sizeof(unsigned int);
+            }
         }
+        _dirty = std::move(deferred);
+        copy_all(copies);
+        _staging.flush();
+        if (uploads)
+            uploads->spend(0, start);
+        drop_copies();
+
+        for (const DirtyRange &range : coalesce(vertex_ranges))
+            _buffer->update(range.start, range.end);
+        if (_position_buffer)
+            _position_ranges.insert(_position_ranges.end(), vertex_ranges.begin(), vertex_ranges.end());
+
+        for (const DirtyRange &range : coalesce(jw_ranges))
+            _jw_buffer->update(range.start, range.end);
 
-        _total_vertices = current_offset;
-        _total_jw = current_offset_jw;
-        _recalculate_ranges = false;
+        for (const DirtyRange &range : coalesce(index_ranges))
+            _index_buffer->update(range.start, range.end);
+
+        os_signpost_interval_end(signpost_log(), signpost, "VertexList::update_data", "%zu bytes uploaded", uploaded);
     }
 
-    void update_data(id<MTLDevice> device)
+    // Meshes whose data is not uploaded yet.
+    size_t pending_meshes() const
     {
-        if (_total_vertices == 0)
-            return;
+        return _dirty.size();
+    }
 
-        unsigned int total = _total_vertices;
-        if (!_buffer || (_buffer && _buffer->size() < total))
-        {
-            _buffer = std::make_unique<Buffer<T>>(device, next_multiple_of(total, 2048));
-        }
+    // Moves meshes from the end of the vertex buffer into holes closer to its start with GPU copies, at most
+    // max_bytes per call. The source ranges stay intact, so frames still in flight keep reading valid data.
+    size_t compact(id<MTLCommandBuffer> command_buffer, size_t max_bytes)
+    {
+        if (!_buffer || max_bytes == 0 || !_dirty.empty())
+            return 0;
 
-        T *data = reinterpret_cast<T *>(_buffer->data());
-        for (const auto &[id, desc] : _pointers)
+        size_t moved = 0;
+        id<MTLBlitCommandEncoder> blit = nil;
+        while (!_mesh_by_offset.empty())
         {
-            memcpy(data + desc.start, desc.ptr, desc.count * sizeof(T));
-        }
+            const auto last = std::prev(_mesh_by_offset.end());
+            const unsigned int mesh_id = last->second;
+            RangeDescriptor<T, JW> &desc = _pointers[mesh_id];
 
-        // Let Metal know the buffer got updated.
-        _buffer->update();
+            const size_t bytes = desc.count * sizeof(T) + (desc.has_joints ? desc.count * sizeof(JW) : 0);
+            if (moved + bytes > max_bytes)
+                break;
 
-        total = _total_jw;
-        if (total == 0)
-            return;
+            // Only move meshes into holes that lie entirely before their current range.
+            const unsigned int new_start = _allocator.allocate_below(desc.capacity, desc.start);
+            if (new_start == RangeAllocator::INVALID)
+                break;
 
-        if (!_jw_buffer || (_jw_buffer && _jw_buffer->size() < total))
-        {
-            _jw_buffer = std::make_unique<Buffer<JW>>(device, next_multiple_of(total, 2048));
-            _anim_buffer = std::make_unique<Buffer<T>>(device, next_multiple_of(total, 2048));
-        }
+            unsigned int new_jw_start = desc.jw_start;
+            if (desc.has_joints)
+            {
+                new_jw_start = _jw_allocator.allocate_below(desc.capacity, desc.jw_start);
+                if (new_jw_start == RangeAllocator::INVALID)
+                    new_jw_start = desc.jw_start;
+            }
 
-        JW *jw_data = reinterpret_cast<JW *>(_jw_buffer->data());
-        for (const auto &[id, desc] : _pointers)
-        {
-            if (!desc.jw_ptr)
-                continue;
+            if (blit == nil)
+            {
+                blit = [command_buffer blitCommandEncoder];
+                blit.label = @"VertexList::compact";
+            }
+
+            [blit copyFromBuffer:_buffer->buffer()
+                     sourceOffset:desc.start * sizeof(T)
+                         toBuffer:_buffer->buffer()
+                destinationOffset:new_start * sizeof(T)
+                             size:desc.count * sizeof(T)];
+
+            if (new_jw_start != desc.jw_start)
+            {
+                [blit copyFromBuffer:_jw_buffer->buffer()
+                         sourceOffset:desc.jw_start * sizeof(JW)
+                             toBuffer:_jw_buffer->buffer()
+                    destinationOffset:new_jw_start * sizeof(JW)
+                                 size:desc.count * sizeof(JW)];
+                free_later(&VertexList::_jw_allocator, desc.jw_start);
+                desc.jw_start = new_jw_start;
+            }
+
+            free_later(&VertexList::_allocator, desc.start);
+            _mesh_by_offset.erase(last);
+            desc.start = new_start;
+            mark_positions_dirty(desc.start, desc.start + desc.count);
+            _mesh_by_offset[desc.start] = mesh_id;
+            update_draw_range(mesh_id, desc);
+            if (const SharedRange *shared = _shared.find(mesh_id))
+            {
+                for (const unsigned int alias : shared->aliases)
+                {
+                    RangeDescriptor<T, JW> &alias_desc = _pointers[alias];
+                    alias_desc.start = desc.start;
+                    alias_desc.jw_start = desc.jw_start;
+                    update_draw_range(alias, alias_desc);
+                }
+            }
 
-            memcpy(jw_data + desc.start, desc.ptr, desc.count * sizeof(JW));
+            moved += bytes;
         }
-        _jw_buffer->update();
+
+        if (blit != nil)
+            [blit endEncoding];
+
+        return moved;
     }
 
     id<MTLBuffer> vertex_buffer() const
@@ -209,6 +562,42 @@ template <typename T, typename JW> class VertexList
         return nil;
     }
 
+    // Keeps a GPU-only stream of the positions of all vertices next to the vertex buffer, for passes that only need
+    // positions. The stream is not written by the list itself, see take_position_ranges().
+    void set_position_stream(bool enabled)
+    {
+        _position_stream = enabled;
+        if (!enabled)
+        {
+            _position_buffer.reset();
+            _position_ranges.clear();
+        }
+    }
+
+    // Set by update_data() once the position stream is enabled.
+    id<MTLBuffer> position_buffer() const
+    {
+        if (_position_buffer)
+            return _position_buffer->buffer();
+        return nil;
+    }
+
+    // Vertices written outside of update_data(), such as on the GPU, whose positions need to be extracted again.
+    void mark_positions_dirty(unsigned int start, unsigned int end)
+    {
+        if (_position_buffer && start < end)
+            _position_ranges.push_back({start, end});
+    }
+
+    // Vertex ranges whose positions the stream is missing since the last call, which the caller copies from the vertex
+    // buffer before anything reads the stream.
+    std::vector<DirtyRange> take_position_ranges()
+    {
+        std::vector<DirtyRange> ranges = coalesce(std::move(_position_ranges));
+        _position_ranges.clear();
+        return ranges;
+    }
+
     id<MTLBuffer> jw_buffer() const
     {
         if (_jw_buffer)
@@ -216,6 +605,75 @@ template <typename T, typename JW> class VertexList
         return nil;
     }
 
+    id<MTLBuffer> index_buffer() const
+    {
+        if (_index_buffer)
+            return _index_buffer->buffer();
+        return nil;
+    }
+
+    // Keeps the buffers in GPU-only memory and uploads changed meshes through a staging buffer on queue, nil keeps
+    // them CPU-visible. The buffers are recreated from the mesh pointers, mapped meshes lose their contents. Must only
+    // be called while the GPU is idle.
+    void set_private_storage(id<MTLDevice> device, id<MTLCommandQueue> queue)
+    {
+        if ((queue == nil) == (_staging_queue == nil))
+            return;
+
+        // Meshes whose copy was dropped only live in the buffers that are about to be replaced.
+        read_back_copies();
+        _staging_queue = queue;
+        _staging.release();
+        _buffer.reset();
+        _jw_buffer.reset();
+        _index_buffer.reset();
+        mark_all_dirty();
+        update_ranges();
+        update_data(device);
+    }
+
+    // Called with the command buffer of every staged upload once it completed.
+    void set_upload_handler(MTLCommandBufferHandler handler)
+    {
+        _staging.set_completed_handler(handler);
+    }
+
+    bool private_storage() const
+    {
+        return _staging_queue != nil;
+    }
+
+    // Meshes set from here on whose vertices, joints and indices match another mesh draw from its range instead of a
+    // copy of their own. The range is released with the last mesh drawing from it.
+    void set_deduplication(bool enabled)
+    {
+        _deduplicate = enabled;
+    }
+
+    // Meshes drawing from the range of another mesh.
+    size_t shared_meshes() const
+    {
+        return _owners.size();
+    }
+
+    // Copies the data of meshes set from here on into the list, so callers may free it as soon as the call returns.
+    // The copies are dropped again once uploaded to buffers in shared memory, those are the only copy from then on.
+    void set_copy_on_submit(bool enabled)
+    {
+        _copy_on_submit = enabled;
+    }
+
+    // Grows the GPU-only buffer skinned vertices are written to, returns true when it got reallocated.
+    bool reserve_anim_vertices(id<MTLDevice> device, unsigned int count)
+    {
+        if (count == 0 || (_anim_buffer && _anim_buffer->size() >= count))
+            return false;
+
+        _anim_buffer =
+            std::make_unique<Buffer<T>>(device, next_multiple_of(count, 2048), MTLResourceStorageModePrivate);
+        return true;
+    }
+
     id<MTLBuffer> anim_buffer() const
     {
         if (_anim_buffer)
@@ -223,21 +681,459 @@ template <typename T, typename JW> class VertexList
         return nil;
     }
 
-    const std::map<unsigned int, DrawDescriptor> &get_draw_ranges() const
+    const IdTable<DrawDescriptor> &get_draw_ranges() const
     {
         return _draw_ranges;
     }
 
+    const RangeAllocator &allocator() const
+    {
+        return _allocator;
+    }
+
   private:
+    struct MeshCopy
+    {
+        std::vector<T> vertices;
+        std::vector<JW> joints_weights;
+        std::vector<unsigned int> indices;
+    };
+
+    // Allocates a range, growing the allocator geometrically when no hole is large enough.
+    static unsigned int allocate(RangeAllocator &allocator, unsigned int count)
+    {
+        if (count == 0)
+            return 0;
+
+        unsigned int offset = allocator.allocate(count);
+        if (offset == RangeAllocator::INVALID)
+        {
+            const unsigned int capacity = allocator.capacity();
+            allocator.grow(next_multiple_of(std::max(capacity + capacity / 2, capacity + count), 2048));
+            offset = allocator.allocate(count);
+        }
+
+        return offset;
+    }
+
+    static unsigned int index_words(const RangeDescriptor<T, JW> &desc)
+    {
+        return desc.short_indices ? (desc.index_count + 1) / 2 : desc.index_count;
+    }
+
+    // Meshes that address less than 65536 vertices store 16-bit indices.
+    void set_indices(RangeDescriptor<T, JW> &desc, const unsigned int *indices, unsigned int num_indices)
+    {
+        // Callers validate indices against the vertices of the mesh, they are uploaded unchecked.
+        assert(indices || num_indices == 0);
+        assert(std::all_of(indices, indices + num_indices, [&desc](unsigned int index) { return index < desc.count; }));
+        if (!indices)
+            num_indices = 0;
+
+        desc.index_ptr = indices;
+        desc.index_count = num_indices;
+        desc.short_indices = desc.count <= 65536;
+
+        const unsigned int words = index_words(desc);
+        if (words <= desc.index_capacity && words > 0)
+            return;
+
+        if (desc.index_capacity > 0)
+            free_later(&VertexList::_index_allocator, desc.index_start);
+
+        desc.index_capacity = next_multiple_of(words, RANGE_GRANULARITY);
+        desc.index_start = allocate(_index_allocator, desc.index_capacity);
+    }
+
+    // Copy of bytes from src to dst, narrowing copies store each 32-bit source index as 16 bits.
+    struct Copy
+    {
+        void *dst;
+        const void *src;
+        size_t bytes;
+        bool narrow;
+    };
+
+    // Bulk uploads are bandwidth bound, copies are split into pieces of 1 MB and spread over the global queue.
+    static void copy_all(const std::vector<Copy> &copies)
+    {
+        constexpr size_t grain = 1u << 20;
+        std::vector<size_t> sizes(copies.size());
+        for (size_t i = 0; i < copies.size(); i++)
+            sizes[i] = copies[i].bytes;
+
+        parallel_ranges(sizes, grain, [&copies](const WorkPiece &piece) {
+            const Copy &c = copies[piece.range];
+            const auto *src = reinterpret_cast<const std::byte *>(c.src) + piece.first;
+            if (!c.narrow)
+            {
+                memcpy(reinterpret_cast<std::byte *>(c.dst) + piece.first, src, piece.count);
+                return;
+            }
+
+            const auto *indices = reinterpret_cast<const unsigned int *>(src);
+            auto *short_data = reinterpret_cast<uint16_t *>(c.dst) + piece.first / sizeof(unsigned int);
+            for (size_t i = 0; i < piece.count / sizeof(unsigned int); i++)
+                short_data[i] = static_cast<uint16_t>(indices[i]);
+        });
+    }
+
+    // Replaces the caller's pointers with pointers into a copy the list owns.
+    void copy_data(unsigned int id, const T *&pointer, unsigned int count, const JW *&joints_weights,
+                   const unsigned int *&indices, unsigned int num_indices)
+    {
+        MeshCopy &copy = _copies[id];
+        copy.vertices.assign(pointer, pointer + (pointer ? count : 0));
+        copy.joints_weights.assign(joints_weights, joints_weights + (joints_weights ? count : 0));
+        copy.indices.assign(indices, indices + (indices ? num_indices : 0));
+
+        pointer = pointer ? copy.vertices.data() : nullptr;
+        joints_weights = joints_weights ? copy.joints_weights.data() : nullptr;
+        indices = indices ? copy.indices.data() : nullptr;
+    }
+
+    // Buffers in shared memory keep their contents when they grow, so uploaded copies are not needed anymore. Meshes
+    // whose upload was deferred still need theirs.
+    void drop_copies()
+    {
+        if (_copies.empty() || _staging_queue || _buffer->managed())
+            return;
+
+        std::vector<unsigned int> dropped;
+        for (const auto &[id, copy] : _copies)
+        {
+            RangeDescriptor<T, JW> &desc = _pointers[id];
+            if (desc.dirty)
+                continue;
+            desc.ptr = nullptr;
+            desc.jw_ptr = nullptr;
+            desc.index_ptr = nullptr;
+            desc.buffer_only = true;
+            dropped.push_back(id);
+        }
+        for (const unsigned int id : dropped)
+            _copies.erase(id);
+    }
+
+    // Copies meshes whose copy was dropped back out of the buffers, before those get replaced.
+    void read_back_copies()
+    {
+        if (!_buffer || _staging_queue || _buffer->managed())
+            return;
+
+        for (auto &[id, desc] : _pointers)
+        {
+            if (!desc.buffer_only)
+                continue;
+
+            MeshCopy &copy = _copies[id];
+            const T *vertices = reinterpret_cast<const T *>(_buffer->data()) + desc.start;
+            copy.vertices.assign(vertices, vertices + desc.count);
+            desc.ptr = copy.vertices.data();
+
+            if (desc.has_joints && _jw_buffer)
+            {
+                const JW *joints_weights = reinterpret_cast<const JW *>(_jw_buffer->data()) + desc.jw_start;
+                copy.joints_weights.assign(joints_weights, joints_weights + desc.count);
+                desc.jw_ptr = copy.joints_weights.data();
+            }
+
+            if (desc.index_count > 0 && _index_buffer)
+            {
+                const auto *words = reinterpret_cast<const unsigned int *>(_index_buffer->data()) + desc.index_start;
+                copy.indices.resize(desc.index_count);
+                for (unsigned int i = 0; i < desc.index_count; i++)
+                    copy.indices[i] = desc.short_indices ? reinterpret_cast<const uint16_t *>(words)[i] : words[i];
+                desc.index_ptr = copy.indices.data();
+            }
+            desc.buffer_only = false;
+        }
+    }
+
+    // Mapped meshes and meshes whose copy was dropped only exist in the buffer itself, shared memory lets them move
+    // along to the new one. GPU-only buffers are copied on the staging queue ahead of the uploads into the new one.
+    // Returns false when the meshes need to be uploaded again, which is the case for managed buffers.
+    template <typename U>
+    bool grow(id<MTLDevice> device, std::unique_ptr<Buffer<U>> &buffer, unsigned int count, MTLResourceOptions storage)
+    {
+        auto grown = std::make_unique<Buffer<U>>(device, count, storage);
+        bool kept = true;
+        if (buffer && _staging_queue)
+        {
+            id<MTLBuffer> source = buffer->buffer();
+            id<MTLBuffer> destination = grown->buffer();
+            const size_t size = buffer->byte_size();
+            _staging.submit();
+            _staging.encode(_staging_queue, ^(id<MTLCommandBuffer> command_buffer) {
+              id<MTLBlitCommandEncoder> blit = [command_buffer blitCommandEncoder];
+              blit.label = @"VertexList::grow";
+              [blit copyFromBuffer:source sourceOffset:0 toBuffer:destination destinationOffset:0 size:size];
+              [blit endEncoding];
+            });
+            _staging.submit();
+        }
+        else if (buffer && !buffer->managed())
+            memcpy(grown->data(), buffer->data(), buffer->byte_size());
+        else if (buffer)
+            kept = false;
+        buffer = std::move(grown);
+        return kept;
+    }
+
+    size_t upload_size(const RangeDescriptor<T, JW> &desc) const
+    {
+        size_t bytes = 0;
+        if (desc.ptr)
+            bytes += desc.count * sizeof(T);
+        if (desc.jw_ptr)
+            bytes += desc.count * sizeof(JW);
+        if (desc.index_ptr)
+            bytes += index_words(desc) * sizeof(unsigned int);
+        return bytes;
+    }
+
+    // Meshes whose upload was deferred draw nothing, as do the meshes sharing their range.
+    void hide_draw_range(unsigned int id)
+    {
+        const auto hide = [this](unsigned int mesh) {
+            DrawDescriptor &range = _draw_ranges[mesh];
+            range.end = range.start;
+            range.jw_end = range.jw_start;
+            range.index_count = 0;
+        };
+        hide(id);
+        if (const SharedRange *shared = _shared.find(id))
+        {
+            for (const unsigned int alias : shared->aliases)
+                hide(alias);
+        }
+    }
+
+    void show_draw_range(unsigned int id, const RangeDescriptor<T, JW> &desc)
+    {
+        update_draw_range(id, desc);
+        if (const SharedRange *shared = _shared.find(id))
+        {
+            for (const unsigned int alias : shared->aliases)
+                update_draw_range(alias, _pointers[alias]);
+        }
+    }
+
+    // Memory that ends up at offset in buffer, staging memory when the list lives in GPU-only memory.
+    template <typename U> void *write_pointer(id<MTLDevice> device, Buffer<U> &buffer, size_t offset, size_t size)
+    {
+        if (!_staging_queue)
+            return reinterpret_cast<std::byte *>(buffer.data()) + offset;
+        return _staging.stage(device, _staging_queue, buffer.buffer(), offset, size);
+    }
+
+    // Frames in flight may still read a released range, so it only returns to its allocator in update_ranges().
+    void free_later(RangeAllocator VertexList::*allocator, unsigned int offset)
+    {
+        _pending_frees.emplace_back(allocator, offset);
+    }
+
+    void release(unsigned int id, const RangeDescriptor<T, JW> &desc)
+    {
+        if (desc.capacity == 0)
+            return;
+
+        free_later(&VertexList::_allocator, desc.start);
+        auto it = _mesh_by_offset.find(desc.start);
+        if (it != _mesh_by_offset.end() && it->second == id)
+            _mesh_by_offset.erase(it);
+
+        if (desc.has_joints)
+            free_later(&VertexList::_jw_allocator, desc.jw_start);
+    }
+
+    void update_draw_range(unsigned int id, const RangeDescriptor<T, JW> &desc)
+    {
+        DrawDescriptor &range = _draw_ranges[id];
+        range.start = desc.start;
+        range.end = desc.start + desc.count;
+        range.jw_start = desc.has_joints ? desc.jw_start : 0;
+        range.jw_end = desc.has_joints ? desc.jw_start + desc.count : 0;
+        range.index_offset = desc.index_start * static_cast<unsigned int>(sizeof(unsigned int));
+        range.index_count = desc.index_count;
+        range.short_indices = desc.short_indices;
+    }
+
+    static constexpr unsigned int NO_OWNER = ~0u;
+
+    static size_t content_hash(const T *pointer, unsigned int count, const JW *joints_weights,
+                               const unsigned int *indices, unsigned int num_indices)
+    {
+        size_t hash = 0;
+        const auto combine = [&hash](const void *data, size_t bytes) {
+            const std::string_view view(reinterpret_cast<const char *>(data), bytes);
+            hash ^= std::hash<std::string_view>()(view) + 0x9e3779b97f4a7c15ull + (hash << 6) + (hash >> 2);
+        };
+        combine(pointer, count * sizeof(T));
+        if (joints_weights)
+            combine(joints_weights, count * sizeof(JW));
+        if (indices)
+            combine(indices, num_indices * sizeof(unsigned int));
+        return hash;
+    }
+
+    // Mesh whose range holds the same contents, only meshes the list has a CPU copy of are compared with.
+    unsigned int find_owner(size_t hash, const T *pointer, unsigned int count, const JW *joints_weights,
+                            const unsigned int *indices, unsigned int num_indices) const
+    {
+        if (!_deduplicate || !pointer || count == 0)
+            return NO_OWNER;
+        if (!indices)
+            num_indices = 0;
+
+        const auto [first, last] = _by_hash.equal_range(hash);
+        for (auto it = first; it != last; ++it)
+        {
+            const RangeDescriptor<T, JW> &owner = *_pointers.find(it->second);
+            if (!owner.ptr || owner.count != count || owner.has_joints != (joints_weights != nullptr) ||
+                owner.index_count != num_indices)
+                continue;
+            if (memcmp(owner.ptr, pointer, count * sizeof(T)) != 0)
+                continue;
+            if (joints_weights && (!owner.jw_ptr || memcmp(owner.jw_ptr, joints_weights, count * sizeof(JW)) != 0))
+                continue;
+            if (num_indices > 0 &&
+                (!owner.index_ptr || memcmp(owner.index_ptr, indices, num_indices * sizeof(unsigned int)) != 0))
+                continue;
+            return it->second;
+        }
+        return NO_OWNER;
+    }
+
+    // Points desc at the range of owner, the mesh gets no range of its own and is never uploaded.
+    void share(unsigned int id, RangeDescriptor<T, JW> &desc, unsigned int owner, const unsigned int *indices)
+    {
+        const RangeDescriptor<T, JW> &range = *_pointers.find(owner);
+        desc.start = range.start;
+        desc.capacity = 0;
+        desc.jw_start = range.jw_start;
+        desc.index_ptr = indices;
+        desc.index_count = range.index_count;
+        desc.index_start = range.index_start;
+        desc.index_capacity = 0;
+        desc.short_indices = range.short_indices;
+        _shared[owner].aliases.push_back(id);
+        _owners.insert(id, owner);
+    }
+
+    void register_owner(unsigned int id, size_t hash)
+    {
+        const RangeDescriptor<T, JW> &desc = *_pointers.find(id);
+        if (!_deduplicate || !desc.ptr || desc.count == 0)
+            return;
+
+        _shared.insert(id, {hash, {}});
+        _by_hash.emplace(hash, id);
+    }
+
+    // Takes mesh id out of the meshes sharing its range. An alias is left without a range, an owner hands its range
+    // to its first alias.
+    void unshare(unsigned int id)
+    {
+        if (const unsigned int *found = _owners.find(id))
+        {
+            std::vector<unsigned int> &aliases = _shared[*found].aliases;
+            aliases.erase(std::find(aliases.begin(), aliases.end(), id));
+            _owners.erase(id);
+
+            RangeDescriptor<T, JW> &desc = _pointers[id];
+            desc.start = 0;
+            desc.jw_start = 0;
+            desc.index_start = 0;
+            return;
+        }
+
+        const SharedRange *found = _shared.find(id);
+        if (!found)
+            return;
+
+        SharedRange shared = *found;
+        _shared.erase(id);
+        const auto [first, last] = _by_hash.equal_range(shared.hash);
+        _by_hash.erase(std::find_if(first, last, [id](const auto &entry) { return entry.second == id; }));
+        if (shared.aliases.empty())
+            return;
+
+        const unsigned int heir = shared.aliases.front();
+        shared.aliases.erase(shared.aliases.begin());
+        RangeDescriptor<T, JW> &desc = _pointers[id];
+        RangeDescriptor<T, JW> &next = _pointers[heir];
+        next.capacity = desc.capacity;
+        next.index_capacity = desc.index_capacity;
+        desc.start = 0;
+        desc.capacity = 0;
+        desc.jw_start = 0;
+        desc.index_start = 0;
+        desc.index_capacity = 0;
+        if (next.capacity > 0)
+            _mesh_by_offset[next.start] = heir;
+
+        // The contents were not uploaded yet, the heir uploads them from its own copy.
+        if (desc.dirty && !next.dirty)
+        {
+            next.dirty = true;
+            _dirty.push_back(heir);
+        }
+
+        _owners.erase(heir);
+        for (const unsigned int alias : shared.aliases)
+            _owners[alias] = heir;
+        _by_hash.emplace(shared.hash, heir);
+        _shared.insert(heir, std::move(shared));
+    }
+
+    void mark_all_dirty()
+    {
+        _dirty.clear();
+        for (auto &[id, desc] : _pointers)
+        {
+            desc.dirty = true;
+            _dirty.push_back(id);
+        }
+    }
+
     std::unique_ptr<Buffer<T>> _buffer;
     std::unique_ptr<Buffer<JW>> _jw_buffer;
     std::unique_ptr<Buffer<T>> _anim_buffer;
+    std::unique_ptr<Buffer<unsigned int>> _index_buffer;
+    bool _position_stream = false;
+    std::unique_ptr<Buffer<simd_float4>> _position_buffer;
+    std::vector<DirtyRange> _position_ranges;
+
+    id<MTLCommandQueue> _staging_queue = nil;
+    StagingBuffer _staging;
+
+    RangeAllocator _allocator;
+    RangeAllocator _jw_allocator;
+    RangeAllocator _index_allocator;
+    std::map<unsigned int, unsigned int> _mesh_by_offset;
+    std::vector<std::pair<RangeAllocator VertexList::*, unsigned int>> _pending_frees;
+
+    // Meshes with the same contents draw from the range of the first one, see set_deduplication().
+    struct SharedRange
+    {
+        size_t hash;
+        // Meshes besides its owner that draw from the range.
+        std::vector<unsigned int> aliases;
+    };
+    bool _deduplicate = false;
+    IdTable<SharedRange> _shared;
+    IdTable<unsigned int> _owners;
+    std::unordered_multimap<size_t, unsigned int> _by_hash;
 
-    std::map<unsigned int, RangeDescriptor<T, JW>> _pointers;
-    std::map<unsigned int, DrawDescriptor> _draw_ranges;
+    IdTable<RangeDescriptor<T, JW>> _pointers;
+    IdTable<DrawDescriptor> _draw_ranges;
+    IdTable<MeshCopy> _copies;
+    bool _copy_on_submit = false;
+    std::vector<unsigned int> _dirty;
     unsigned int _total_vertices;
     unsigned int _total_jw;
-    bool _recalculate_ranges;
+    unsigned int _total_index_words;
 };
 
 #endif // METALCPP_SRC_VERTEXLIST_H
@@ -0,0 +1,290 @@
+#ifndef METALCPP_SRC_VIDEO_STREAM_HPP
+#define METALCPP_SRC_VIDEO_STREAM_HPP
+
+#import <CoreMedia/CoreMedia.h>
+#import <CoreVideo/CoreVideo.h>
+#import <Metal/Metal.h>
+#import <VideoToolbox/VideoToolbox.h>
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+#include "library.h"
+
+// Pixel buffer of the encoder a frame is rendered or copied into, texture aliases its IOSurface.
+struct VideoStreamFrame
+{
+    id pixel_buffer = nil;
+    // The CVMetalTexture, it keeps the texture cache from handing out the buffer again.
+    id texture_ref = nil;
+    id<MTLTexture> texture = nil;
+    // Session the buffer belongs to, frames of an earlier session are dropped.
+    uint64_t session = 0;
+
+    bool valid() const
+    {
+        return texture != nil;
+    }
+};
+
+// Encodes the frames of the renderer with a hardware VTCompressionSession. The frames are drawn into IOSurface-backed
+// pixel buffers of the session's own pool, so the encoder reads what the GPU wrote without a copy through the CPU, and
+// the encoded packets go to the callback as Annex B with the parameter sets in front of every keyframe.
+class VideoStream
+{
+  public:
+    // Buffers the encoder may hold before frames are dropped instead of waiting for it.
+    static constexpr int MAX_BUFFERS = 6;
+
+    ~VideoStream()
+    {
+        stop();
+        if (_cache != nullptr)
+            CFRelease(_cache);
+    }
+
+    // Starts a stream of width x height frames, returns false when the device has no hardware encoder for the codec.
+    bool start(id<MTLDevice> device, const VideoStreamSettings &settings, unsigned int width, unsigned int height,
+               VideoPacketCallback callback, void *user_data)
+    {
+        stop();
+        if (callback == nullptr)
+            return false;
+        if (_cache == nullptr &&
+            CVMetalTextureCacheCreate(kCFAllocatorDefault, nullptr, device, nullptr, &_cache) != kCVReturnSuccess)
+            return false;
+
+        std::lock_guard<std::mutex> lock(_mutex);
+        _settings = settings;
+        _callback = callback;
+        _user_data = user_data;
+        if (!create_session(width, height))
+        {
+            _callback = nullptr;
+            return false;
+        }
+        return true;
+    }
+
+    // Emits the frames the encoder still holds and ends the stream, their packets are delivered before it returns.
+    void stop()
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        destroy_session();
+        _callback = nullptr;
+        _user_data = nullptr;
+    }
+
+    bool active() const
+    {
+        return _callback != nullptr;
+    }
+
+    void request_keyframe()
+    {
+        _keyframe = true;
+    }
+
+    // Returns a buffer for a frame of width x height, the session is created again for another size. Returns an
+    // invalid frame while the encoder holds every buffer of its pool, that frame is not streamed.
+    VideoStreamFrame acquire(unsigned int width, unsigned int height)
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (_callback == nullptr)
+            return {};
+        if (width != _width || height != _height)
+        {
+            destroy_session();
+            create_session(width, height);
+        }
+        if (_session == nullptr)
+            return {};
+
+        CVPixelBufferPoolRef pool = VTCompressionSessionGetPixelBufferPool(_session);
+        CVPixelBufferRef pixel_buffer = nullptr;
+        NSDictionary *threshold = @{(id)kCVPixelBufferPoolAllocationThresholdKey : @(MAX_BUFFERS)};
+        if (pool == nullptr || CVPixelBufferPoolCreatePixelBufferWithAuxAttributes(
+                                   kCFAllocatorDefault, pool, (__bridge CFDictionaryRef)threshold, &pixel_buffer) !=
+                                   kCVReturnSuccess)
+            return {};
+
+        VideoStreamFrame frame;
+        frame.pixel_buffer = CFBridgingRelease(pixel_buffer);
+        frame.session = _session_id;
+        NSDictionary *attributes =
+            @{(id)kCVMetalTextureUsage : @(MTLTextureUsageRenderTarget | MTLTextureUsageShaderRead)};
+        CVMetalTextureRef texture = nullptr;
+        if (CVMetalTextureCacheCreateTextureFromImage(kCFAllocatorDefault, _cache, pixel_buffer,
+                                                      (__bridge CFDictionaryRef)attributes, MTLPixelFormatBGRA8Unorm,
+                                                      width, height, 0, &texture) != kCVReturnSuccess)
+            return {};
+        frame.texture_ref = CFBridgingRelease(texture);
+        frame.texture = CVMetalTextureGetTexture(texture);
+        // Releases the textures of buffers the encoder is done with.
+        CVMetalTextureCacheFlush(_cache, 0);
+        return frame;
+    }
+
+    // Hands frame to the encoder once the GPU wrote it, called from the completed handler of its command buffer.
+    void encode(const VideoStreamFrame &frame, uint64_t timestamp_us)
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (_session == nullptr || frame.session != _session_id)
+            return;
+        NSDictionary *options = _keyframe.exchange(false) ? @{(id)kVTEncodeFrameOptionKey_ForceKeyFrame : @YES} : nil;
+        VTCompressionSessionEncodeFrame(_session, (__bridge CVImageBufferRef)frame.pixel_buffer,
+                                        CMTimeMake(static_cast<int64_t>(timestamp_us), 1000000), kCMTimeInvalid,
+                                        (__bridge CFDictionaryRef)options, nullptr, nullptr);
+    }
+
+  private:
+    bool create_session(unsigned int width, unsigned int height)
+    {
+        _width = width;
+        _height = height;
+        _session_id++;
+        const bool hevc = _settings.codec == VIDEO_CODEC_HEVC;
+        if (width == 0 || height == 0)
+            return false;
+        NSMutableDictionary *encoder =
+            [@{(id)kVTVideoEncoderSpecification_RequireHardwareAcceleratedVideoEncoder : @YES} mutableCopy];
+        // Trades some quality for frames that leave the encoder as soon as they are done, H.264 only.
+        if (@available(macOS 11.3, *))
+        {
+            if (!hevc)
+                encoder[(id)kVTVideoEncoderSpecification_EnableLowLatencyRateControl] = @YES;
+        }
+        // The pool of the session hands out buffers Metal can render into and the encoder reads in place.
+        NSDictionary *source = @{
+            (id)kCVPixelBufferPixelFormatTypeKey : @(kCVPixelFormatType_32BGRA),
+            (id)kCVPixelBufferWidthKey : @(width),
+            (id)kCVPixelBufferHeightKey : @(height),
+            (id)kCVPixelBufferIOSurfacePropertiesKey : @{},
+            (id)kCVPixelBufferMetalCompatibilityKey : @YES,
+        };
+        if (VTCompressionSessionCreate(kCFAllocatorDefault, static_cast<int32_t>(width), static_cast<int32_t>(height),
+                                       hevc ? kCMVideoCodecType_HEVC : kCMVideoCodecType_H264,
+                                       (__bridge CFDictionaryRef)encoder, (__bridge CFDictionaryRef)source, nullptr,
+                                       output, this, &_session) != noErr)
+        {
+            _session = nullptr;
+            return false;
+        }
+
+        // Frames are not reordered, so every packet can be decoded as soon as it arrives.
+        VTSessionSetProperty(_session, kVTCompressionPropertyKey_RealTime, kCFBooleanTrue);
+        VTSessionSetProperty(_session, kVTCompressionPropertyKey_AllowFrameReordering, kCFBooleanFalse);
+        VTSessionSetProperty(_session, kVTCompressionPropertyKey_ProfileLevel,
+                             hevc ? kVTProfileLevel_HEVC_Main_AutoLevel : kVTProfileLevel_H264_Main_AutoLevel);
+        if (_settings.bitrate_kbps > 0)
+            VTSessionSetProperty(_session, kVTCompressionPropertyKey_AverageBitRate,
+                                 (__bridge CFNumberRef)@(_settings.bitrate_kbps * 1000));
+        if (_settings.frame_rate > 0)
+            VTSessionSetProperty(_session, kVTCompressionPropertyKey_ExpectedFrameRate,
+                                 (__bridge CFNumberRef)@(_settings.frame_rate));
+        if (_settings.keyframe_interval > 0)
+            VTSessionSetProperty(_session, kVTCompressionPropertyKey_MaxKeyFrameInterval,
+                                 (__bridge CFNumberRef)@(_settings.keyframe_interval));
+        VTCompressionSessionPrepareToEncodeFrames(_session);
+        return true;
+    }
+
+    void destroy_session()
+    {
+        if (_session == nullptr)
+            return;
+        VTCompressionSessionCompleteFrames(_session, kCMTimeInvalid);
+        VTCompressionSessionInvalidate(_session);
+        CFRelease(_session);
+        _session = nullptr;
+        _width = 0;
+        _height = 0;
+    }
+
+    // Called by the encoder with every encoded frame, on a thread of its own, one frame at a time.
+    static void output(void *refcon, void *, OSStatus status, VTEncodeInfoFlags flags, CMSampleBufferRef sample)
+    {
+        if (status != noErr || sample == nullptr || (flags & kVTEncodeInfo_FrameDropped) != 0)
+            return;
+        static_cast<VideoStream *>(refcon)->deliver(sample);
+    }
+
+    // Rewrites the length prefixed NAL units of sample as Annex B and passes them to the callback.
+    void deliver(CMSampleBufferRef sample)
+    {
+        CFArrayRef attachments = CMSampleBufferGetSampleAttachmentsArray(sample, false);
+        CFDictionaryRef first = attachments != nullptr && CFArrayGetCount(attachments) > 0
+                                    ? static_cast<CFDictionaryRef>(CFArrayGetValueAtIndex(attachments, 0))
+                                    : nullptr;
+        const bool keyframe = first == nullptr || !CFDictionaryContainsKey(first, kCMSampleAttachmentKey_NotSync);
+        CMFormatDescriptionRef format = CMSampleBufferGetFormatDescription(sample);
+        const bool hevc = CMFormatDescriptionGetMediaSubType(format) == kCMVideoCodecType_HEVC;
+
+        static constexpr uint8_t START_CODE[4] = {0, 0, 0, 1};
+        _packet.clear();
+        int length_size = 4;
+        if (keyframe)
+        {
+            size_t count = 0;
+            for (size_t i = 0; i == 0 || i < count; i++)
+            {
+                const uint8_t *set = nullptr;
+                size_t size = 0;
+                const OSStatus got =
+                    hevc ? CMVideoFormatDescriptionGetHEVCParameterSetAtIndex(format, i, &set, &size, &count,
+                                                                              &length_size)
+                         : CMVideoFormatDescriptionGetH264ParameterSetAtIndex(format, i, &set, &size, &count,
+                                                                              &length_size);
+                if (got != noErr)
+                    break;
+                _packet.insert(_packet.end(), START_CODE, START_CODE + 4);
+                _packet.insert(_packet.end(), set, set + size);
+            }
+        }
+
+        // Copied out, the block buffer of a frame is not always contiguous.
+        CMBlockBufferRef block = CMSampleBufferGetDataBuffer(sample);
+        const size_t size = block != nullptr ? CMBlockBufferGetDataLength(block) : 0;
+        _units.resize(size);
+        if (size == 0 || CMBlockBufferCopyDataBytes(block, 0, size, _units.data()) != kCMBlockBufferNoErr)
+            return;
+        const auto prefix = static_cast<size_t>(length_size);
+        for (size_t offset = 0; offset + prefix <= size;)
+        {
+            size_t length = 0;
+            for (size_t i = 0; i < prefix; i++)
+                length = (length << 8) | _units[offset + i];
+            offset += prefix;
+            if (offset + length > size)
+                break;
+            _packet.insert(_packet.end(), START_CODE, START_CODE + 4);
+            _packet.insert(_packet.end(), _units.data() + offset, _units.data() + offset + length);
+            offset += length;
+        }
+
+        const CMTime time = CMTimeConvertScale(CMSampleBufferGetPresentationTimeStamp(sample), 1000000,
+                                               kCMTimeRoundingMethod_Default);
+        const auto timestamp_us = static_cast<unsigned long long>(time.value);
+        if (const VideoPacketCallback callback = _callback)
+            callback(_user_data, _packet.data(), static_cast<unsigned int>(_packet.size()), timestamp_us,
+                     keyframe ? 1 : 0);
+    }
+
+    std::mutex _mutex;
+    VTCompressionSessionRef _session = nullptr;
+    uint64_t _session_id = 0;
+    unsigned int _width = 0;
+    unsigned int _height = 0;
+    CVMetalTextureCacheRef _cache = nullptr;
+    VideoStreamSettings _settings = {};
+    std::atomic<VideoPacketCallback> _callback = nullptr;
+    void *_user_data = nullptr;
+    std::atomic<bool> _keyframe = false;
+    // Reused by the encoder's thread for every frame.
+    std::vector<uint8_t> _packet;
+    std::vector<uint8_t> _units;
+};
+
+#endif // METALCPP_SRC_VIDEO_STREAM_HPP
@@ -0,0 +1,142 @@
+#ifndef METALCPP_SRC_VIDEO_TEXTURES_HPP
+#define METALCPP_SRC_VIDEO_TEXTURES_HPP
+
+#import <CoreVideo/CoreVideo.h>
+#import <Metal/Metal.h>
+
+#include <utility>
+
+#include "id_table.hpp"
+#include "retired_resources.hpp"
+#include "structs.h"
+
+// Texture slot showing the frames of set_video_frame.
+struct VideoSlot
+{
+    // Texture the slot binds, the newest frame is converted into it by the next rendered frame.
+    id<MTLTexture> target = nil;
+    // Luma and chroma planes of YCbCr frames, the color of BGRA frames in the first.
+    id<MTLTexture> planes[2] = {nil, nil};
+    // The CVMetalTextures of the planes and the pixel buffer, they keep the decoder from reusing its memory.
+    id frame[3] = {nil, nil, nil};
+    // VIDEO_FRAME_* flags of the newest frame.
+    unsigned int format = 0;
+    bool converted = true;
+};
+
+// Wraps the CVPixelBuffers of a video decoder as Metal textures with a CVMetalTextureCache, without copying them. Only
+// the newest frame of a slot is kept, the frames it replaces are retired so their buffers return to the decoder once
+// the frames in flight that read them completed.
+class VideoTextures
+{
+  public:
+    ~VideoTextures()
+    {
+        if (_cache != nullptr)
+            CFRelease(_cache);
+    }
+
+    // Makes pixel_buffer the newest frame of slot index. Returns nullptr for pixel formats other than BGRA and 8-bit
+    // biplanar 4:2:0 YCbCr, which leave the slot as it was.
+    VideoSlot *set_frame(id<MTLDevice> device, unsigned int index, CVPixelBufferRef pixel_buffer,
+                         RetiredResources &retired)
+    {
+        unsigned int format = 0;
+        switch (CVPixelBufferGetPixelFormatType(pixel_buffer))
+        {
+        case kCVPixelFormatType_32BGRA:
+            break;
+        case kCVPixelFormatType_420YpCbCr8BiPlanarVideoRange:
+            format = VIDEO_FRAME_YCBCR | VIDEO_FRAME_VIDEO_RANGE;
+            break;
+        case kCVPixelFormatType_420YpCbCr8BiPlanarFullRange:
+            format = VIDEO_FRAME_YCBCR;
+            break;
+        default:
+            return nullptr;
+        }
+        CFTypeRef matrix = CVBufferGetAttachment(pixel_buffer, kCVImageBufferYCbCrMatrixKey, nullptr);
+        if (matrix != nullptr && CFEqual(matrix, kCVImageBufferYCbCrMatrix_ITU_R_601_4))
+            format |= VIDEO_FRAME_BT601;
+
+        if (_cache == nullptr && CVMetalTextureCacheCreate(kCFAllocatorDefault, nullptr, device, nullptr, &_cache) !=
+                                     kCVReturnSuccess)
+            return nullptr;
+
+        VideoSlot frame;
+        frame.format = format;
+        frame.converted = false;
+        frame.frame[2] = (__bridge id)pixel_buffer;
+        const bool ycbcr = (format & VIDEO_FRAME_YCBCR) != 0;
+        for (size_t plane = 0; plane < (ycbcr ? 2 : 1); plane++)
+        {
+            const MTLPixelFormat pixel_format = !ycbcr ? MTLPixelFormatBGRA8Unorm
+                                                : plane == 0 ? MTLPixelFormatR8Unorm
+                                                             : MTLPixelFormatRG8Unorm;
+            const size_t width = ycbcr ? CVPixelBufferGetWidthOfPlane(pixel_buffer, plane)
+                                       : CVPixelBufferGetWidth(pixel_buffer);
+            const size_t height = ycbcr ? CVPixelBufferGetHeightOfPlane(pixel_buffer, plane)
+                                        : CVPixelBufferGetHeight(pixel_buffer);
+            CVMetalTextureRef texture = nullptr;
+            if (CVMetalTextureCacheCreateTextureFromImage(kCFAllocatorDefault, _cache, pixel_buffer, nullptr,
+                                                          pixel_format, width, height, plane,
+                                                          &texture) != kCVReturnSuccess)
+                return nullptr;
+            frame.frame[plane] = CFBridgingRelease(texture);
+            frame.planes[plane] = CVMetalTextureGetTexture(texture);
+        }
+
+        VideoSlot &slot = _slots[index];
+        retired.retire(slot.frame[0], slot.frame[1], slot.frame[2]);
+        frame.target = slot.target;
+        slot = std::move(frame);
+        return &slot;
+    }
+
+    VideoSlot *find(unsigned int index)
+    {
+        return _slots.find(index);
+    }
+
+    void remove(unsigned int index, RetiredResources &retired)
+    {
+        if (VideoSlot *slot = _slots.find(index))
+        {
+            retired.retire(slot->target, slot->frame[0], slot->frame[1], slot->frame[2]);
+            _slots.erase(index);
+        }
+    }
+
+    // Whether a slot has a frame the next rendered frame converts.
+    bool pending() const
+    {
+        for (const auto &[index, slot] : _slots)
+        {
+            if (!slot.converted && slot.target != nil)
+                return true;
+        }
+        return false;
+    }
+
+    // Calls convert with every slot whose newest frame was not converted yet.
+    template <typename Convert> void convert(Convert &&convert)
+    {
+        for (auto &[index, slot] : _slots)
+        {
+            if (!slot.converted && slot.target != nil)
+            {
+                convert(slot);
+                slot.converted = true;
+            }
+        }
+        // Releases the textures of buffers the decoder freed.
+        if (_cache != nullptr)
+            CVMetalTextureCacheFlush(_cache, 0);
+    }
+
+  private:
+    CVMetalTextureCacheRef _cache = nullptr;
+    IdTable<VideoSlot> _slots;
+};
+
+#endif // METALCPP_SRC_VIDEO_TEXTURES_HPP
@@ -0,0 +1,577 @@
+#ifndef METALCPP_SRC_VIRTUAL_TEXTURES_HPP
+#define METALCPP_SRC_VIRTUAL_TEXTURES_HPP
+
+#include "library.h"
+#include "texture_format.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <map>
+#include <utility>
+#include <vector>
+
+// Tiles of virtual textures that are resident in a cache of tiles, by texture index. Pages map every tile of every
+// level to the finest resident tile covering it, frames request the tiles they sample by setting feedback bits in the
+// order of the pages. Wanted tiles load coarse to fine and evict the least recently requested tiles, the single tile
+// of the last level of each texture stays resident. Slots of evicted tiles are reused once the frames that may still
+// sample them completed.
+class VirtualTextures
+{
+  public:
+    static constexpr unsigned int NONE = ~0u;
+    static constexpr size_t TILE_BYTES = VIRTUAL_TILE_STRIDE * VIRTUAL_TILE_STRIDE * 4;
+
+    // Tile at level, x, y of the texture at index to copy into slot.
+    struct Load
+    {
+        unsigned int texture;
+        unsigned int level;
+        unsigned int x;
+        unsigned int y;
+        unsigned int slot;
+    };
+
+    // Drops every tile, the last levels of all textures are wanted again.
+    void set_cache(unsigned int columns, unsigned int rows)
+    {
+        _columns = columns;
+        _slots.assign(size_t(columns) * rows, Slot());
+        _free.clear();
+        for (unsigned int i = static_cast<unsigned int>(_slots.size()); i-- > 0;)
+            _free.push_back(i);
+        _released.clear();
+        _loading.clear();
+        _wanted.clear();
+        for (auto &[index, texture] : _textures)
+            reset(index, texture);
+        _pages_dirty = true;
+    }
+
+    unsigned int columns() const
+    {
+        return _columns;
+    }
+
+    unsigned int rows() const
+    {
+        return _columns > 0 ? static_cast<unsigned int>(_slots.size()) / _columns : 0;
+    }
+
+    // False for textures of other formats than BGRA8 and RGBA8 or whose levels end before one fits a single tile.
+    // The texture only gets sampled once it was activated, its data must stay valid until it is removed. Slots of
+    // textures that get replaced or removed are free once frame rendered completed.
+    bool add(unsigned int index, const TextureData &d, uint64_t rendered)
+    {
+        // A slot that already binds the tile cache keeps sampling it as virtual.
+        const Texture *previous = find(index);
+        const bool active = previous && previous->active;
+        remove(index, rendered);
+        if ((d.format != BGRA8 && d.format != RGBA8) || !d.bytes || d.width == 0 || d.height == 0)
+            return false;
+
+        Texture texture;
+        texture.data = d;
+        texture.active = active;
+        unsigned int width = d.width;
+        unsigned int height = d.height;
+        unsigned int pages = 0;
+        for (unsigned int level = 0; level < std::min(d.mip_levels, VIRTUAL_TEXTURE_MAX_LEVELS); level++)
+        {
+            const unsigned int tiles_x = (width + VIRTUAL_TILE_SIZE - 1) / VIRTUAL_TILE_SIZE;
+            const unsigned int tiles_y = (height + VIRTUAL_TILE_SIZE - 1) / VIRTUAL_TILE_SIZE;
+            texture.levels.push_back({width, height, tiles_x, tiles_y, pages});
+            pages += tiles_x * tiles_y;
+            if (tiles_x * tiles_y == 1)
+                break;
+            width = std::max(width / 2, 1u);
+            height = std::max(height / 2, 1u);
+        }
+        const Level &last = texture.levels.back();
+        if (last.tiles_x * last.tiles_y != 1)
+            return false;
+
+        texture.entries.assign(pages, NO_VIRTUAL_TILE);
+        texture.slots.assign(pages, NONE);
+        texture.states.assign(pages, Idle);
+        texture.requested.assign(pages, 0);
+        auto &added = _textures[index] = std::move(texture);
+        reset(index, added);
+        _layout_dirty = true;
+        return true;
+    }
+
+    void remove(unsigned int index, uint64_t rendered)
+    {
+        const auto it = _textures.find(index);
+        if (it == _textures.end())
+            return;
+
+        for (const unsigned int slot : it->second.slots)
+        {
+            if (slot != NONE)
+            {
+                _slots[slot] = Slot();
+                _released.emplace_back(rendered, slot);
+            }
+        }
+        // Loads in flight were never mapped, and later copies into their slots are queued after theirs.
+        for (const Loading &loading : _loading)
+        {
+            if (loading.load.texture == index)
+            {
+                _slots[loading.load.slot] = Slot();
+                _free.push_back(loading.load.slot);
+            }
+        }
+        _loading.erase(std::remove_if(_loading.begin(), _loading.end(),
+                                      [&](const Loading &loading) { return loading.load.texture == index; }),
+                       _loading.end());
+        _wanted.erase(std::remove_if(_wanted.begin(), _wanted.end(),
+                                     [&](const Wanted &wanted) { return wanted.texture == index; }),
+                      _wanted.end());
+        _textures.erase(it);
+        _layout_dirty = true;
+    }
+
+    // Removes the textures at first and later indices.
+    void remove_from(unsigned int first, uint64_t rendered)
+    {
+        while (!_textures.empty() && _textures.rbegin()->first >= first)
+            remove(_textures.rbegin()->first, rendered);
+    }
+
+    void activate(unsigned int index)
+    {
+        const auto it = _textures.find(index);
+        if (it != _textures.end() && !it->second.active)
+        {
+            it->second.active = true;
+            _layout_dirty = true;
+        }
+    }
+
+    bool contains(unsigned int index) const
+    {
+        return _textures.find(index) != _textures.end();
+    }
+
+    bool empty() const
+    {
+        return _textures.empty();
+    }
+
+    // Changes whenever textures get added, removed or activated, which moves their pages and feedback words.
+    unsigned int layout_version()
+    {
+        build();
+        return _layout_version;
+    }
+
+    size_t feedback_words()
+    {
+        build();
+        return _feedback_words;
+    }
+
+    // Page buffer contents, the version changes whenever a page does.
+    const std::vector<unsigned int> &pages()
+    {
+        build();
+        return _pages;
+    }
+
+    uint64_t pages_version()
+    {
+        build();
+        return _pages_version;
+    }
+
+    // Requests the pages whose bits are set in the feedback words of the current layout.
+    void read_feedback(const int *words, size_t count, uint64_t frame)
+    {
+        build();
+        for (auto &[index, texture] : _textures)
+        {
+            if (!texture.active)
+                continue;
+            const size_t end = std::min(count, size_t(texture.feedback) + (texture.entries.size() + 31) / 32);
+            for (size_t w = texture.feedback; w < end; w++)
+            {
+                for (auto bits = static_cast<uint32_t>(words[w]); bits != 0; bits &= bits - 1)
+                {
+                    const auto page = static_cast<unsigned int>((w - texture.feedback) * 32 + __builtin_ctz(bits));
+                    if (page < texture.entries.size())
+                        request(index, texture, page, frame);
+                }
+            }
+        }
+    }
+
+    // Picks up to max_loads wanted tiles to load into free slots, evicting tiles no frame requested for idle frames to
+    // free slots for later loads. Slots evicted now are free once frame rendered completed.
+    std::vector<Load> schedule(unsigned int max_loads, uint64_t frame, unsigned int idle_frames, uint64_t rendered,
+                               uint64_t completed)
+    {
+        for (size_t i = 0; i < _released.size();)
+        {
+            if (_released[i].first > completed)
+            {
+                i++;
+                continue;
+            }
+            _free.push_back(_released[i].second);
+            _released[i] = _released.back();
+            _released.pop_back();
+        }
+
+        // Wants nothing requested again for a while are dropped.
+        for (Wanted &wanted : _wanted)
+        {
+            if (const Texture *texture = find(wanted.texture))
+                wanted.frame = texture->requested[wanted.page];
+        }
+        _wanted.erase(std::remove_if(_wanted.begin(), _wanted.end(),
+                                     [&](const Wanted &wanted) {
+                                         Texture *texture = find(wanted.texture);
+                                         if (!texture || texture->states[wanted.page] != Requested)
+                                             return true;
+                                         if (wanted.page + 1 < texture->entries.size() &&
+                                             wanted.frame + idle_frames < frame)
+                                         {
+                                             texture->states[wanted.page] = Idle;
+                                             return true;
+                                         }
+                                         return false;
+                                     }),
+                      _wanted.end());
+        std::sort(_wanted.begin(), _wanted.end(), [](const Wanted &a, const Wanted &b) {
+            return a.level != b.level ? a.level > b.level : a.frame > b.frame;
+        });
+
+        const size_t needed = std::min(size_t(max_loads), _wanted.size());
+        if (_free.size() < needed)
+            evict(needed - _free.size(), frame, idle_frames, rendered);
+
+        std::vector<Load> loads;
+        size_t next = 0;
+        for (; next < _wanted.size() && loads.size() < needed && !_free.empty(); next++)
+        {
+            const Wanted &wanted = _wanted[next];
+            Texture &texture = _textures[wanted.texture];
+            const unsigned int slot = _free.back();
+            _free.pop_back();
+
+            const Level &level = texture.levels[wanted.level];
+            const unsigned int tile = wanted.page - level.first;
+            const Load load = {wanted.texture, wanted.level, tile % level.tiles_x, tile / level.tiles_x, slot};
+            _slots[slot] = {wanted.texture, wanted.page, frame, wanted.page + 1 == texture.entries.size()};
+            texture.states[wanted.page] = Uploading;
+            _loading.push_back({load, 0});
+            loads.push_back(load);
+        }
+        _wanted.erase(_wanted.begin(), _wanted.begin() + next);
+        return loads;
+    }
+
+    // Loads returned by the last schedule() are done once upload completed.
+    void loading(uint64_t upload)
+    {
+        for (Loading &loading : _loading)
+        {
+            if (loading.upload == 0)
+                loading.upload = upload;
+        }
+    }
+
+    // Maps the tiles whose upload completed.
+    template <typename Completed> void finish(const Completed &completed)
+    {
+        for (size_t i = 0; i < _loading.size();)
+        {
+            if (!completed(_loading[i].upload))
+            {
+                i++;
+                continue;
+            }
+
+            const Load &load = _loading[i].load;
+            Texture &texture = _textures[load.texture];
+            const unsigned int page = texture.levels[load.level].first + load.y * texture.levels[load.level].tiles_x +
+                                      load.x;
+            texture.slots[page] = load.slot;
+            texture.states[page] = Idle;
+            const unsigned int entry = this->entry(load.slot, load.level);
+            cover(texture, load.level, load.x, load.y, [&](unsigned int &e) {
+                if (e == NO_VIRTUAL_TILE || e >> 24 > load.level)
+                    e = entry;
+            });
+            _loading[i] = _loading.back();
+            _loading.pop_back();
+            _pages_dirty = true;
+        }
+    }
+
+    bool loading() const
+    {
+        return !_loading.empty();
+    }
+
+    // Copies the tile of load with its border into texels of VIRTUAL_TILE_STRIDE BGRA8 texels per row, the border
+    // wraps around like the repeating material sampler.
+    void copy_tile(const Load &load, unsigned char *destination) const
+    {
+        const Texture &texture = _textures.at(load.texture);
+        const Level &level = texture.levels[load.level];
+        const unsigned char *source = texture.data.bytes + mip_offset(texture.data, load.level);
+        const auto wrap = [](int value, unsigned int size) {
+            const int wrapped = value % static_cast<int>(size);
+            return static_cast<unsigned int>(wrapped < 0 ? wrapped + static_cast<int>(size) : wrapped);
+        };
+
+        std::array<unsigned int, VIRTUAL_TILE_STRIDE> columns;
+        for (int i = 0; i < VIRTUAL_TILE_STRIDE; i++)
+            columns[i] = wrap(static_cast<int>(load.x * VIRTUAL_TILE_SIZE) + i - VIRTUAL_TILE_BORDER, level.width);
+
+        const bool swizzle = texture.data.format == RGBA8;
+        for (int row = 0; row < VIRTUAL_TILE_STRIDE; row++)
+        {
+            const unsigned int y = wrap(static_cast<int>(load.y * VIRTUAL_TILE_SIZE) + row - VIRTUAL_TILE_BORDER,
+                                        level.height);
+            const unsigned char *texels = source + size_t(y) * level.width * 4;
+            unsigned char *out = destination + size_t(row) * VIRTUAL_TILE_STRIDE * 4;
+            for (int i = 0; i < VIRTUAL_TILE_STRIDE; i++)
+            {
+                uint32_t texel;
+                memcpy(&texel, texels + size_t(columns[i]) * 4, 4);
+                if (swizzle)
+                    texel = (texel & 0xFF00FF00u) | ((texel & 0xFFu) << 16) | ((texel >> 16) & 0xFFu);
+                memcpy(out + i * 4, &texel, 4);
+            }
+        }
+    }
+
+  private:
+    enum State : unsigned char
+    {
+        Idle = 0,
+        Requested = 1,
+        Uploading = 2
+    };
+
+    struct Level
+    {
+        unsigned int width;
+        unsigned int height;
+        unsigned int tiles_x;
+        unsigned int tiles_y;
+        // Page of the first tile.
+        unsigned int first;
+    };
+
+    struct Texture
+    {
+        TextureData data = {};
+        bool active = false;
+        std::vector<Level> levels;
+        std::vector<unsigned int> entries;
+        // Cache slot of every resident page.
+        std::vector<unsigned int> slots;
+        std::vector<State> states;
+        // Frame each page was last requested in.
+        std::vector<uint64_t> requested;
+        // Word of the header in the page buffer and first feedback word of the current layout.
+        size_t offset = 0;
+        unsigned int feedback = 0;
+    };
+
+    struct Slot
+    {
+        unsigned int texture = NONE;
+        unsigned int page = NONE;
+        uint64_t used = 0;
+        bool pinned = false;
+    };
+
+    struct Wanted
+    {
+        unsigned int texture;
+        unsigned int page;
+        unsigned int level;
+        uint64_t frame;
+    };
+
+    struct Loading
+    {
+        Load load;
+        uint64_t upload;
+    };
+
+    Texture *find(unsigned int index)
+    {
+        const auto it = _textures.find(index);
+        return it != _textures.end() ? &it->second : nullptr;
+    }
+
+    unsigned int entry(unsigned int slot, unsigned int level) const
+    {
+        return (slot % _columns) | (slot / _columns) << 12 | level << 24;
+    }
+
+    unsigned int level_of(const Texture &texture, unsigned int page) const
+    {
+        unsigned int level = 0;
+        while (level + 1 < texture.levels.size() && texture.levels[level + 1].first <= page)
+            level++;
+        return level;
+    }
+
+    // Calls update with the entry of every page of level and finer levels that the tile at level, x, y covers.
+    template <typename Update>
+    void cover(Texture &texture, unsigned int level, unsigned int x, unsigned int y, const Update &update)
+    {
+        for (unsigned int l = level + 1; l-- > 0;)
+        {
+            const Level &covered = texture.levels[l];
+            const unsigned int shift = level - l;
+            const unsigned int end_x = std::min((x + 1) << shift, covered.tiles_x);
+            const unsigned int end_y = std::min((y + 1) << shift, covered.tiles_y);
+            for (unsigned int ty = y << shift; ty < end_y; ty++)
+            {
+                for (unsigned int tx = x << shift; tx < end_x; tx++)
+                    update(texture.entries[covered.first + ty * covered.tiles_x + tx]);
+            }
+        }
+    }
+
+    // Wants the last level again, nothing of the texture is resident.
+    void reset(unsigned int index, Texture &texture)
+    {
+        std::fill(texture.entries.begin(), texture.entries.end(), NO_VIRTUAL_TILE);
+        std::fill(texture.slots.begin(), texture.slots.end(), NONE);
+        std::fill(texture.states.begin(), texture.states.end(), Idle);
+        const auto last = static_cast<unsigned int>(texture.entries.size() - 1);
+        texture.states[last] = Requested;
+        _wanted.push_back({index, last, static_cast<unsigned int>(texture.levels.size() - 1), 0});
+    }
+
+    void request(unsigned int index, Texture &texture, unsigned int page, uint64_t frame)
+    {
+        if (texture.slots[page] != NONE)
+        {
+            _slots[texture.slots[page]].used = frame;
+            return;
+        }
+
+        // The coarser tile sampled in its place stays in use until it loaded.
+        const unsigned int entry = texture.entries[page];
+        if (entry != NO_VIRTUAL_TILE)
+            _slots[(entry >> 12 & 0xFFF) * _columns + (entry & 0xFFF)].used = frame;
+        if (texture.states[page] == Idle)
+        {
+            texture.states[page] = Requested;
+            _wanted.push_back({index, page, level_of(texture, page), frame});
+        }
+        texture.requested[page] = frame;
+    }
+
+    // Unmaps the least recently requested tiles until count slots are released.
+    void evict(size_t count, uint64_t frame, unsigned int idle_frames, uint64_t rendered)
+    {
+        std::vector<std::pair<uint64_t, unsigned int>> candidates;
+        for (unsigned int i = 0; i < _slots.size(); i++)
+        {
+            const Slot &slot = _slots[i];
+            const Texture *texture = slot.texture != NONE ? find(slot.texture) : nullptr;
+            if (texture && !slot.pinned && texture->slots[slot.page] == i && slot.used + idle_frames < frame)
+                candidates.emplace_back(slot.used, i);
+        }
+        std::sort(candidates.begin(), candidates.end());
+
+        for (size_t i = 0; i < std::min(count, candidates.size()); i++)
+        {
+            const unsigned int slot = candidates[i].second;
+            Texture &texture = _textures[_slots[slot].texture];
+            const unsigned int page = _slots[slot].page;
+            const unsigned int level = level_of(texture, page);
+            const Level &tiles = texture.levels[level];
+            const unsigned int x = (page - tiles.first) % tiles.tiles_x;
+            const unsigned int y = (page - tiles.first) / tiles.tiles_x;
+
+            // Pages it covered fall back to the tile covering the tile of the next level.
+            const Level &parent = texture.levels[level + 1];
+            const unsigned int fallback = texture.entries[parent.first + (y / 2) * parent.tiles_x + x / 2];
+            const unsigned int evicted = entry(slot, level);
+            cover(texture, level, x, y, [&](unsigned int &e) {
+                if (e == evicted)
+                    e = fallback;
+            });
+            texture.slots[page] = NONE;
+            _released.emplace_back(rendered, slot);
+            _slots[slot] = Slot();
+            _pages_dirty = true;
+        }
+    }
+
+    // Lays out the page buffer and the feedback words of the active textures.
+    void build()
+    {
+        if (_layout_dirty)
+        {
+            const unsigned int num_indices = _textures.empty() ? 0 : _textures.rbegin()->first + 1;
+            size_t offset = 1 + num_indices;
+            unsigned int feedback = 0;
+            for (auto &[index, texture] : _textures)
+            {
+                texture.offset = offset;
+                texture.feedback = feedback;
+                offset += sizeof(VirtualTexture) / sizeof(unsigned int) + texture.entries.size();
+                feedback += static_cast<unsigned int>((texture.entries.size() + 31) / 32);
+            }
+            _pages.assign(offset, 0);
+            _pages[0] = num_indices;
+            std::fill(_pages.begin() + 1, _pages.begin() + 1 + num_indices, NO_VIRTUAL_TEXTURE);
+            _feedback_words = feedback;
+            _layout_version++;
+            _layout_dirty = false;
+            _pages_dirty = true;
+        }
+        if (!_pages_dirty)
+            return;
+
+        for (const auto &[index, texture] : _textures)
+        {
+            VirtualTexture header = {};
+            header.width = texture.data.width;
+            header.height = texture.data.height;
+            header.levels = static_cast<unsigned int>(texture.levels.size());
+            header.feedback = texture.feedback;
+            const size_t first = texture.offset + sizeof(VirtualTexture) / sizeof(unsigned int);
+            for (size_t l = 0; l < texture.levels.size(); l++)
+                header.pages[l] = static_cast<unsigned int>(first + texture.levels[l].first);
+            memcpy(&_pages[texture.offset], &header, sizeof(header));
+            std::copy(texture.entries.begin(), texture.entries.end(), _pages.begin() + first);
+            _pages[1 + index] = texture.active ? static_cast<unsigned int>(texture.offset) : NO_VIRTUAL_TEXTURE;
+        }
+        _pages_version++;
+        _pages_dirty = false;
+    }
+
+    std::map<unsigned int, Texture> _textures;
+    unsigned int _columns = 0;
+    std::vector<Slot> _slots;
+    std::vector<unsigned int> _free;
+    // Slots that are free once the frame they were released after completed.
+    std::vector<std::pair<uint64_t, unsigned int>> _released;
+    std::vector<Loading> _loading;
+    std::vector<Wanted> _wanted;
+    std::vector<unsigned int> _pages = {0};
+    bool _layout_dirty = false;
+    bool _pages_dirty = false;
+    unsigned int _layout_version = 0;
+    uint64_t _pages_version = 1;
+    size_t _feedback_words = 0;
+};
+
+#endif // METALCPP_SRC_VIRTUAL_TEXTURES_HPP
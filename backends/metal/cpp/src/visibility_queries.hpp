@@ -0,0 +1,98 @@
+#ifndef METALCPP_SRC_VISIBILITY_QUERIES_HPP
+#define METALCPP_SRC_VISIBILITY_QUERIES_HPP
+
+#include "id_table.hpp"
+#include "library.h"
+
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+// Bounding boxes of caller defined groups, counted against the pre-pass depth of each frame. Results are written by
+// the completion handlers of frames, so they are guarded by a mutex; the groups themselves only change on the thread
+// that renders.
+class VisibilityQueries
+{
+  public:
+    // Groups tested by one frame, the samples of boxes[i] are counted at offset i of the result buffer.
+    struct Frame
+    {
+        std::vector<unsigned int> ids;
+        std::vector<Aabb> boxes;
+        // Groups around the camera, the depth in front of it can't hide their box.
+        std::vector<unsigned int> around_camera;
+    };
+
+    void set(unsigned int id, const Aabb &bounds)
+    {
+        _groups.insert(id, bounds);
+        std::lock_guard<std::mutex> lock(_mutex);
+        _results.insert(id, VISIBILITY_UNTESTED);
+    }
+
+    void erase(unsigned int id)
+    {
+        _groups.erase(id);
+        std::lock_guard<std::mutex> lock(_mutex);
+        _results.erase(id);
+    }
+
+    bool empty() const
+    {
+        return _groups.empty();
+    }
+
+    // Boxes within margin of the camera count as visible instead of being tested.
+    Frame begin_frame(const glm::vec3 &camera, float margin) const
+    {
+        Frame frame;
+        for (const auto &[id, box] : _groups)
+        {
+            const bool around = camera.x >= box.bmin.x - margin && camera.x <= box.bmax.x + margin &&
+                                camera.y >= box.bmin.y - margin && camera.y <= box.bmax.y + margin &&
+                                camera.z >= box.bmin.z - margin && camera.z <= box.bmax.z + margin;
+            if (around)
+            {
+                frame.around_camera.push_back(id);
+                continue;
+            }
+            frame.ids.push_back(id);
+            frame.boxes.push_back(box);
+        }
+        return frame;
+    }
+
+    // Stores the samples of a completed frame, one per tested box. Groups removed since the frame was encoded stay
+    // removed.
+    void resolve(const Frame &frame, const uint64_t *samples)
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        for (size_t i = 0; i < frame.ids.size(); i++)
+        {
+            if (uint64_t *result = _results.find(frame.ids[i]))
+                *result = samples[i];
+        }
+        for (unsigned int id : frame.around_camera)
+        {
+            if (uint64_t *result = _results.find(id))
+                *result = VISIBILITY_UNTESTED;
+        }
+    }
+
+    // Samples of group id that passed the depth test in the last completed frame that tested it, 0 for unknown groups.
+    uint64_t samples(unsigned int id) const
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        const uint64_t *result = _results.find(id);
+        return result ? *result : 0;
+    }
+
+  private:
+    IdTable<Aabb> _groups;
+    mutable std::mutex _mutex;
+    IdTable<uint64_t> _results;
+};
+
+#endif // METALCPP_SRC_VISIBILITY_QUERIES_HPP
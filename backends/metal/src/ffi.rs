@@ -92,6 +92,122 @@ pub const TEXTURES_ARG_INDEX: u32 = 2;
 pub const MATERIALS_ARG_INDEX: u32 = 3;
 pub const INSTANCES_ARG_INDEX: u32 = 4;
 pub const INSTANCES_2D_ARG_INDEX: u32 = 5;
+pub const PACKED_VERTICES_ARG_INDEX: u32 = 6;
+pub const VISIBLE_INSTANCES_ARG_INDEX: u32 = 7;
+pub const ANIM_VERTICES_ARG_INDEX: u32 = 8;
+pub const VIRTUAL_PAGES_ARG_INDEX: u32 = 9;
+pub const INSTANCE_OVERRIDES_ARG_INDEX: u32 = 10;
+pub const SAMPLERS_ARG_INDEX: u32 = 11;
+pub const TEXTURE_LAYERS_ARG_INDEX: u32 = 12;
+pub const TEXTURE_ARRAYS_ARG_INDEX: u32 = 13;
+pub const POSITIONS_ARG_INDEX: u32 = 14;
+pub const SCENE_ARGUMENT_COUNT: u32 = 15;
+pub const NO_TEXTURE_LAYER: u32 = 4294967295;
+pub const SAMPLER_DEFAULT: u32 = 0;
+pub const SAMPLER_TRILINEAR: u32 = 1;
+pub const SAMPLER_ANISOTROPIC: u32 = 2;
+pub const SAMPLER_TRILINEAR_CLAMP: u32 = 3;
+pub const SAMPLER_NEAREST: u32 = 4;
+pub const SAMPLER_2D: u32 = 5;
+pub const SAMPLER_COUNT: u32 = 6;
+pub const INSTANCE_CULLING_CONSTANT_INDEX: u32 = 0;
+pub const OCCLUSION_CULLING_CONSTANT_INDEX: u32 = 2;
+pub const TEXTURE_MODE_2D_CONSTANT_INDEX: u32 = 3;
+pub const TEXTURE_MODE_2D_NONE: u32 = 0;
+pub const TEXTURE_MODE_2D_ALL: u32 = 1;
+pub const TEXTURE_MODE_2D_MIXED: u32 = 2;
+pub const TEXTURE_MODES_2D: u32 = 3;
+pub const RATE_MAP_CONSTANT_INDEX: u32 = 4;
+pub const HARDWARE_TRACING_CONSTANT_INDEX: u32 = 5;
+pub const BVH_SCENE_BUFFER_INDEX: u32 = 16;
+pub const BVH_TOP_NODES_ARG_INDEX: u32 = 0;
+pub const BVH_INSTANCES_ARG_INDEX: u32 = 1;
+pub const BVH_NODES_ARG_INDEX: u32 = 2;
+pub const BVH_TRIANGLES_ARG_INDEX: u32 = 3;
+pub const BVH_SCENE_ARGUMENT_COUNT: u32 = 4;
+pub const ICB_COMMANDS_ARG_INDEX: u32 = 0;
+pub const INSTANCE_ANIMATION_LINEAR: u32 = 0;
+pub const INSTANCE_ANIMATION_SWAY: u32 = 1;
+pub const NO_HIERARCHY_INSTANCE: u32 = 4294967295;
+pub const NO_MATERIAL_OVERRIDE: u32 = 4294967295;
+pub const MAX_MESH_LODS: u32 = 4;
+pub const NO_PICK_HIT: u32 = 4294967295;
+pub const NO_RAY_HIT: u32 = 4294967295;
+pub const VISIBILITY_UNTESTED: u64 = 18446744073709551615;
+pub const MESH_COST_COUNT: u32 = 16;
+pub const PACING_HISTOGRAM_BUCKETS: u32 = 64;
+pub const DRAW_ARGS_WORDS: u32 = 5;
+pub const CLUSTER_VERTICES: u32 = 64;
+pub const CLUSTER_TRIANGLES: u32 = 124;
+pub const NO_MORPH_TARGETS: u32 = 4294967295;
+pub const MAX_SKELETON_JOINTS: u32 = 256;
+pub const MAX_ANIMATION_LAYERS: u32 = 4;
+pub const TEXTURE_FEEDBACK_BLOCK: u32 = 8;
+pub const NO_TEXTURE_FEEDBACK: u32 = 2147483647;
+pub const VIRTUAL_TILE_SIZE: u32 = 128;
+pub const VIRTUAL_TILE_BORDER: u32 = 4;
+pub const VIRTUAL_TILE_STRIDE: u32 = 136;
+pub const VIRTUAL_TEXTURE_MAX_LEVELS: u32 = 16;
+pub const NO_VIRTUAL_TEXTURE: u32 = 4294967295;
+pub const NO_VIRTUAL_TILE: u32 = 4294967295;
+pub const LIGHT_TILE_SIZE: u32 = 16;
+pub const MAX_LIGHTS_PER_TILE: u32 = 255;
+pub const LIGHT_TILE_STRIDE: u32 = 256;
+pub const GBUFFER_ALBEDO_INDEX: u32 = 1;
+pub const GBUFFER_NORMAL_INDEX: u32 = 2;
+pub const GBUFFER_DEPTH_INDEX: u32 = 3;
+pub const DEFERRED_VIEW_CONSTANT_INDEX: u32 = 1;
+pub const TRANSPARENT_ACCUM_INDEX: u32 = 1;
+pub const TRANSPARENT_REVEAL_INDEX: u32 = 2;
+pub const SHADOW_CASCADES: u32 = 4;
+pub const MAX_SPOT_SHADOWS: u32 = 16;
+pub const SPOT_SHADOW_TILES_PER_ROW: u32 = 4;
+pub const PATH_TRACER_BOUNCES: u32 = 4;
+pub const PATH_TRACER_GROUP_SIZE: u32 = 64;
+pub const PATH_DENOISER_PASSES: u32 = 5;
+pub const PATH_TRACER_TILE_SIZE: u32 = 16;
+pub const LIGHTMAP_FILTER_PASSES: u32 = 3;
+pub const LIGHTMAP_MAX_SIZE: u32 = 4096;
+pub const ENVIRONMENT_SIZE: u32 = 128;
+pub const ENVIRONMENT_MIP_LEVELS: u32 = 6;
+pub const ENVIRONMENT_SAMPLES: u32 = 64;
+pub const IRRADIANCE_GROUP_SIZE: u32 = 256;
+pub const MAX_REFLECTION_PROBES: u32 = 16;
+pub const REFLECTION_PROBE_SIZE: u32 = 128;
+pub const LIGHT_TREE_LEAF: u32 = 4294967295;
+pub const LIGHT_TREE_QUEUE: u32 = 512;
+pub const LIGHT_TREE_GROUP_SIZE: u32 = 256;
+pub const SSAO_SAMPLES: u32 = 8;
+pub const SSAO_BLUR_RADIUS: u32 = 4;
+pub const SSAO_GROUP_SIZE: u32 = 64;
+pub const REFLECTION_HZB_LEVELS: u32 = 6;
+pub const REFLECTION_MAX_STEPS: u32 = 48;
+pub const REFLECTION_GROUP_SIZE: u32 = 64;
+pub const SDF_MESH_RESOLUTION: u32 = 32;
+pub const SDF_MESH_PADDING: u32 = 2;
+pub const SDF_CLIPMAP_LEVELS: u32 = 4;
+pub const SDF_CLIPMAP_SIZE: u32 = 64;
+pub const SDF_BAND_VOXELS: u32 = 4;
+pub const GI_IRRADIANCE_TEXELS: u32 = 6;
+pub const GI_DISTANCE_TEXELS: u32 = 14;
+pub const GI_RAYS_PER_PROBE: u32 = 64;
+pub const GI_MAX_PROBES_PER_AXIS: u32 = 32;
+pub const INSTANCE_BVH_CLUSTER_SIZE: u32 = 64;
+pub const INSTANCE_BVH_GROUP_SIZE: u32 = 1024;
+pub const INSTANCE_BVH_LEAF: u32 = 4294967295;
+pub const INSTANCE_BVH_INSIDE: u32 = 2147483648;
+pub const PARTICLE_GROUP_SIZE: u32 = 64;
+pub const TERRAIN_GRID: u32 = 64;
+pub const TERRAIN_MAX_LEVELS: u32 = 8;
+pub const TERRAIN_GROUP_SIZE: u32 = 64;
+pub const IMPOSTOR_VERTEX: u32 = 2147483648;
+pub const IMPOSTOR_GRID: u32 = 16;
+pub const IMPOSTOR_MAX_GRID: u32 = 64;
+pub const IMPOSTOR_MAX_TILES: u32 = 32;
+pub const NO_VBUFFER_TRIANGLE: u32 = 4294967295;
+pub const VBUFFER_INDEXED: u32 = 1;
+pub const VBUFFER_SHORT_INDICES: u32 = 2;
+pub const VBUFFER_PACKED: u32 = 4;
 pub const SIMD_COMPILER_HAS_REQUIRED_FEATURES: u32 = 1;
 pub const __API_TO_BE_DEPRECATED: u32 = 100000;
 pub const __MAC_10_0: u32 = 1000;
@@ -5144,6 +5260,22 @@ extern "C" {
 }
 #[repr(C)]
 #[derive(Debug, Default, Copy, Clone)]
+pub struct TextureFeedbackUniforms {
+    pub phase: ::std::os::raw::c_uint,
+    pub num_textures: ::std::os::raw::c_uint,
+    pub virtual_words: ::std::os::raw::c_uint,
+}
+#[repr(C)]
+#[derive(Debug, Default, Copy, Clone)]
+pub struct VirtualTexture {
+    pub width: ::std::os::raw::c_uint,
+    pub height: ::std::os::raw::c_uint,
+    pub levels: ::std::os::raw::c_uint,
+    pub feedback: ::std::os::raw::c_uint,
+    pub pages: [::std::os::raw::c_uint; 16usize],
+}
+#[repr(C)]
+#[derive(Debug, Default, Copy, Clone)]
 pub struct Vector2 {
     pub x: f32,
     pub y: f32,
@@ -5208,8 +5340,8 @@ pub struct DeviceMaterial {
     pub metallic_roughness_map: ::std::os::raw::c_int,
     pub emissive_map: ::std::os::raw::c_int,
     pub sheen_map: ::std::os::raw::c_int,
-    pub pad1: f32,
-    pub pad2: f32,
+    pub sampler: ::std::os::raw::c_uint,
+    pub lightmap_map: ::std::os::raw::c_int,
 }
 #[repr(C)]
 #[derive(Debug, Default, Copy, Clone)]
@@ -5247,6 +5379,29 @@ pub struct Vertex3D {
 }
 #[repr(C)]
 #[derive(Debug, Default, Copy, Clone)]
+pub struct PackedVertex3D {
+    pub p_x: ::std::os::raw::c_ushort,
+    pub p_y: ::std::os::raw::c_ushort,
+    pub p_z: ::std::os::raw::c_ushort,
+    pub mat_id: ::std::os::raw::c_ushort,
+    pub n_x: ::std::os::raw::c_short,
+    pub n_y: ::std::os::raw::c_short,
+    pub t_x: ::std::os::raw::c_short,
+    pub t_y: ::std::os::raw::c_short,
+    pub u: ::std::os::raw::c_ushort,
+    pub v: ::std::os::raw::c_ushort,
+    pub flags: ::std::os::raw::c_ushort,
+    pub pad: ::std::os::raw::c_ushort,
+}
+#[repr(C)]
+#[repr(align(16))]
+#[derive(Debug, Default, Copy, Clone)]
+pub struct PackedVertexBounds {
+    pub offset: simd_float4,
+    pub scale: simd_float4,
+}
+#[repr(C)]
+#[derive(Debug, Default, Copy, Clone)]
 pub struct CameraView {
     pub pos_x: f32,
     pub pos_y: f32,
@@ -5280,231 +5435,2361 @@ pub struct UniformCamera {
     pub view_matrix: simd_float4x4,
     pub combined: simd_float4x4,
     pub matrix_2d: simd_float4x4,
+    pub origin: simd_float4,
     pub view: CameraView,
+    pub previous_combined: simd_float4x4,
+    pub jitter: simd_float4,
+}
+#[repr(C)]
+#[repr(align(16))]
+#[derive(Debug, Default, Copy, Clone)]
+pub struct AnimatedInstance {
+    pub position: simd_float4,
+    pub velocity: simd_float4,
+}
+#[repr(C)]
+#[derive(Debug, Default, Copy, Clone)]
+pub struct InstanceAnimationUniforms {
+    pub type_: ::std::os::raw::c_uint,
+    pub count: ::std::os::raw::c_uint,
+    pub time: f32,
+    pub amplitude: f32,
+    pub frequency: f32,
+    pub pad0: ::std::os::raw::c_uint,
+    pub pad1: ::std::os::raw::c_uint,
+    pub pad2: ::std::os::raw::c_uint,
 }
 #[repr(C)]
 #[repr(align(16))]
 #[derive(Debug, Default, Copy, Clone)]
 pub struct InstanceTransform {
-    pub matrix: simd_float4x4,
-    pub normal_matrix: simd_float4x4,
+    pub rows: [simd_float4; 3usize],
+}
+#[repr(C)]
+#[derive(Debug, Default, Copy, Clone)]
+pub struct HierarchyLink {
+    pub parent: ::std::os::raw::c_int,
+    pub target: ::std::os::raw::c_uint,
 }
 #[repr(C)]
 #[repr(align(16))]
 #[derive(Debug, Default, Copy, Clone)]
-pub struct Aabb {
-    pub bmin: simd_float4,
-    pub bmax: simd_float4,
+pub struct HierarchyUpdate {
+    pub rows: [simd_float4; 3usize],
+    pub node: ::std::os::raw::c_uint,
+    pub pad0: ::std::os::raw::c_uint,
+    pub pad1: ::std::os::raw::c_uint,
+    pub pad2: ::std::os::raw::c_uint,
 }
 #[repr(C)]
 #[repr(align(16))]
 #[derive(Debug, Default, Copy, Clone)]
-pub struct RTTriangle {
-    pub vertex0: Vector3,
-    pub u0: f32,
-    pub vertex1: Vector3,
-    pub u1: f32,
-    pub vertex2: Vector3,
-    pub u2: f32,
-    pub normal: Vector3,
-    pub v0: f32,
-    pub n0: Vector3,
-    pub v1: f32,
-    pub n1: Vector3,
-    pub v2: f32,
-    pub n2: Vector3,
-    pub id: ::std::os::raw::c_int,
-    pub tangent0: simd_float4,
-    pub tangent1: simd_float4,
-    pub tangent2: simd_float4,
-    pub light_id: ::std::os::raw::c_int,
-    pub mat_id: ::std::os::raw::c_int,
-    pub lod: f32,
-    pub area: f32,
+pub struct InstanceOverride {
+    pub tint: simd_float4,
+    pub custom: simd_float4,
+    pub material: ::std::os::raw::c_uint,
+    pub pad0: ::std::os::raw::c_uint,
+    pub pad1: ::std::os::raw::c_uint,
+    pub pad2: ::std::os::raw::c_uint,
 }
 #[repr(C)]
 #[repr(align(16))]
 #[derive(Debug, Default, Copy, Clone)]
-pub struct VertexRange {
-    pub bounds: Aabb,
-    pub first: ::std::os::raw::c_uint,
-    pub last: ::std::os::raw::c_uint,
-    pub mat_id: ::std::os::raw::c_uint,
-    pub padding: ::std::os::raw::c_uint,
+pub struct CullDraw {
+    pub center: simd_float4,
+    pub extent: simd_float4,
+    pub instance_start: ::std::os::raw::c_uint,
+    pub instance_count: ::std::os::raw::c_uint,
+    pub args_offset: ::std::os::raw::c_uint,
+    pub lod_count: ::std::os::raw::c_uint,
+    pub lod_sizes: simd_float4,
+    pub lod_args_offsets: simd_uint4,
+    pub lod_instance_start: ::std::os::raw::c_uint,
+    pub pad0: ::std::os::raw::c_uint,
+    pub pad1: ::std::os::raw::c_uint,
+    pub pad2: ::std::os::raw::c_uint,
 }
 #[repr(C)]
 #[repr(align(16))]
 #[derive(Debug, Default, Copy, Clone)]
-pub struct JointData {
-    pub j_x: ::std::os::raw::c_uint,
-    pub j_y: ::std::os::raw::c_uint,
-    pub j_z: ::std::os::raw::c_uint,
-    pub j_w: ::std::os::raw::c_uint,
-    pub weight: simd_float4,
+pub struct MeshCluster {
+    pub sphere: simd_float4,
+    pub cone: simd_float4,
+    pub index_start: ::std::os::raw::c_uint,
+    pub index_count: ::std::os::raw::c_uint,
+    pub pad0: ::std::os::raw::c_uint,
+    pub pad1: ::std::os::raw::c_uint,
 }
-#[repr(u32)]
-#[derive(Debug, Copy, Clone, Hash, PartialEq, Eq)]
-pub enum Mesh3dFlags {
-    SHADOW_CASTER = 1,
-    ALLOW_SKINNING = 2,
+#[repr(C)]
+#[derive(Debug, Default, Copy, Clone)]
+pub struct ClusterDraw {
+    pub cluster_start: ::std::os::raw::c_uint,
+    pub cluster_count: ::std::os::raw::c_uint,
+    pub instance_args_offset: ::std::os::raw::c_uint,
+    pub args_offset: ::std::os::raw::c_uint,
+    pub index_start: ::std::os::raw::c_uint,
+    pub out_start: ::std::os::raw::c_uint,
+    pub short_indices: ::std::os::raw::c_uint,
+    pub pad: ::std::os::raw::c_uint,
 }
 #[repr(C)]
 #[repr(align(16))]
-#[derive(Debug, Copy, Clone)]
-pub struct MeshData3D {
-    pub vertices: *const Vertex3D,
-    pub num_vertices: ::std::os::raw::c_uint,
-    pub triangles: *const RTTriangle,
-    pub num_triangles: ::std::os::raw::c_uint,
-    pub ranges: *const VertexRange,
-    pub num_ranges: ::std::os::raw::c_uint,
-    pub skin_data: *const JointData,
-    pub flags: ::std::os::raw::c_uint,
-    pub __bindgen_padding_0: [u64; 0usize],
-    pub bounds: Aabb,
+#[derive(Debug, Default, Copy, Clone)]
+pub struct ClusterUniforms {
+    pub planes: [simd_float4; 6usize],
+    pub camera_position: simd_float4,
+    pub num_clusters: ::std::os::raw::c_uint,
+    pub num_draws: ::std::os::raw::c_uint,
+    pub pad0: ::std::os::raw::c_uint,
+    pub pad1: ::std::os::raw::c_uint,
 }
-impl Default for MeshData3D {
-    fn default() -> Self {
-        unsafe { ::std::mem::zeroed() }
-    }
+#[repr(C)]
+#[derive(Debug, Default, Copy, Clone)]
+pub struct IndirectDraw {
+    pub vertex_start: ::std::os::raw::c_uint,
+    pub vertex_count: ::std::os::raw::c_uint,
+    pub index_offset: ::std::os::raw::c_uint,
+    pub index_count: ::std::os::raw::c_uint,
+    pub instance_start: ::std::os::raw::c_uint,
+    pub instance_count: ::std::os::raw::c_uint,
+    pub short_indices: ::std::os::raw::c_uint,
+    pub pad: ::std::os::raw::c_uint,
 }
-#[repr(u32)]
-#[derive(Debug, Copy, Clone, Hash, PartialEq, Eq)]
-pub enum InstanceFlags3D {
-    TRANSFORMED = 1,
+#[repr(C)]
+#[derive(Debug, Default, Copy, Clone)]
+pub struct CulledIndirectDraw {
+    pub args_offset: ::std::os::raw::c_uint,
+    pub index_offset: ::std::os::raw::c_uint,
+    pub index_size: ::std::os::raw::c_uint,
+    pub clustered: ::std::os::raw::c_uint,
+    pub depth_slot: ::std::os::raw::c_uint,
+    pub pad0: ::std::os::raw::c_uint,
+    pub pad1: ::std::os::raw::c_uint,
+    pub pad2: ::std::os::raw::c_uint,
 }
 #[repr(C)]
-#[repr(align(16))]
-#[derive(Debug, Copy, Clone)]
-pub struct InstancesData3D {
-    pub local_aabb: Aabb,
-    pub matrices: *const simd_float4x4,
-    pub num_matrices: ::std::os::raw::c_uint,
-    pub skin_ids: *const ::std::os::raw::c_int,
-    pub num_skin_ids: ::std::os::raw::c_uint,
-    pub flags: *const ::std::os::raw::c_uint,
-    pub num_flags: ::std::os::raw::c_uint,
+#[derive(Debug, Default, Copy, Clone)]
+pub struct SkinningGroup {
+    pub vertex_start: ::std::os::raw::c_uint,
+    pub jw_start: ::std::os::raw::c_uint,
+    pub count: ::std::os::raw::c_uint,
+    pub out_start: ::std::os::raw::c_uint,
+    pub joint_offset: ::std::os::raw::c_uint,
+    pub num_joints: ::std::os::raw::c_uint,
+    pub morph_start: ::std::os::raw::c_uint,
+    pub weight_start: ::std::os::raw::c_uint,
 }
-impl Default for InstancesData3D {
-    fn default() -> Self {
-        unsafe { ::std::mem::zeroed() }
-    }
+#[repr(C)]
+#[derive(Debug, Default, Copy, Clone)]
+pub struct MorphDelta {
+    pub target: ::std::os::raw::c_uint,
+    pub p_x: f32,
+    pub p_y: f32,
+    pub p_z: f32,
+    pub n_x: f32,
+    pub n_y: f32,
+    pub n_z: f32,
+    pub pad: f32,
 }
 #[repr(C)]
-#[derive(Debug, Copy, Clone)]
-pub struct MeshData2D {
-    pub vertices: *const Vertex2D,
-    pub num_vertices: ::std::os::raw::c_uint,
-    pub tex_id: ::std::os::raw::c_int,
+#[repr(align(16))]
+#[derive(Debug, Default, Copy, Clone)]
+pub struct SkeletonJoint {
+    pub inverse_bind: simd_float4x4,
+    pub translation: simd_float4,
+    pub rotation: simd_float4,
+    pub scale: simd_float4,
+    pub parent: ::std::os::raw::c_int,
+    pub depth: ::std::os::raw::c_uint,
+    pub pad0: ::std::os::raw::c_uint,
+    pub pad1: ::std::os::raw::c_uint,
 }
-impl Default for MeshData2D {
-    fn default() -> Self {
-        unsafe { ::std::mem::zeroed() }
-    }
+#[repr(C)]
+#[derive(Debug, Default, Copy, Clone)]
+pub struct AnimationKeys {
+    pub key_start: ::std::os::raw::c_uint,
+    pub num_keys: ::std::os::raw::c_uint,
 }
 #[repr(C)]
-#[derive(Debug, Copy, Clone)]
-pub struct InstancesData2D {
-    pub matrices: *const simd_float4x4,
-    pub num_matrices: ::std::os::raw::c_uint,
+#[derive(Debug, Default, Copy, Clone)]
+pub struct AnimationLayerState {
+    pub channel_start: ::std::os::raw::c_uint,
+    pub num_joints: ::std::os::raw::c_uint,
+    pub time: f32,
+    pub weight: f32,
 }
-impl Default for InstancesData2D {
-    fn default() -> Self {
-        unsafe { ::std::mem::zeroed() }
-    }
+#[repr(C)]
+#[derive(Debug, Default, Copy, Clone)]
+pub struct SkinAnimation {
+    pub layers: [AnimationLayerState; 4usize],
+    pub skeleton_start: ::std::os::raw::c_uint,
+    pub num_joints: ::std::os::raw::c_uint,
+    pub num_levels: ::std::os::raw::c_uint,
+    pub num_layers: ::std::os::raw::c_uint,
+    pub matrix_offset: ::std::os::raw::c_uint,
+    pub pad0: ::std::os::raw::c_uint,
+    pub pad1: ::std::os::raw::c_uint,
+    pub pad2: ::std::os::raw::c_uint,
 }
-#[repr(u32)]
-#[derive(Debug, Copy, Clone, Hash, PartialEq, Eq)]
-pub enum DataFormat {
-    BGRA8 = 0,
-    RGBA8 = 1,
+#[repr(C)]
+#[repr(align(16))]
+#[derive(Debug, Default, Copy, Clone)]
+pub struct CullUniforms {
+    pub planes: [simd_float4; 6usize],
+    pub hzb_combined: simd_float4x4,
+    pub num_draws: ::std::os::raw::c_uint,
+    pub num_instances: ::std::os::raw::c_uint,
+    pub occlusion_phase: ::std::os::raw::c_uint,
+    pub visible_offset: ::std::os::raw::c_uint,
+    pub depth_width: ::std::os::raw::c_uint,
+    pub depth_height: ::std::os::raw::c_uint,
+    pub hzb_levels: ::std::os::raw::c_uint,
+    pub sort_depths: ::std::os::raw::c_uint,
+    pub lod_view: simd_float4,
 }
 #[repr(C)]
-#[derive(Debug, Copy, Clone)]
-pub struct TextureData {
-    pub width: ::std::os::raw::c_uint,
-    pub height: ::std::os::raw::c_uint,
-    pub mip_levels: ::std::os::raw::c_uint,
-    pub bytes: *const ::std::os::raw::c_uchar,
-    pub format: DataFormat,
+#[derive(Debug, Default, Copy, Clone)]
+pub struct PointLight {
+    pub pos_x: f32,
+    pub pos_y: f32,
+    pub pos_z: f32,
+    pub energy: f32,
+    pub radiance_r: f32,
+    pub radiance_g: f32,
+    pub radiance_b: f32,
+    pub pad: f32,
 }
-impl Default for TextureData {
-    fn default() -> Self {
-        unsafe { ::std::mem::zeroed() }
-    }
+#[repr(C)]
+#[derive(Debug, Default, Copy, Clone)]
+pub struct ReflectionProbe {
+    pub pos_x: f32,
+    pub pos_y: f32,
+    pub pos_z: f32,
+    pub radius: f32,
 }
-extern "C" {
-    pub fn create_instance(
-        ns_window: *mut ::std::os::raw::c_void,
-        ns_view: *mut ::std::os::raw::c_void,
-        width: ::std::os::raw::c_uint,
-        height: ::std::os::raw::c_uint,
-        scale: f64,
-    ) -> *mut ::std::os::raw::c_void;
+#[repr(C)]
+#[derive(Debug, Default, Copy, Clone)]
+pub struct AreaLight {
+    pub pos_x: f32,
+    pub pos_y: f32,
+    pub pos_z: f32,
+    pub energy: f32,
+    pub normal_x: f32,
+    pub normal_y: f32,
+    pub normal_z: f32,
+    pub area: f32,
+    pub vertex0_x: f32,
+    pub vertex0_y: f32,
+    pub vertex0_z: f32,
+    pub inst_idx: ::std::os::raw::c_int,
+    pub vertex1_x: f32,
+    pub vertex1_y: f32,
+    pub vertex1_z: f32,
+    pub mesh_id: ::std::os::raw::c_int,
+    pub radiance_r: f32,
+    pub radiance_g: f32,
+    pub radiance_b: f32,
+    pub pad0: ::std::os::raw::c_int,
+    pub vertex2_x: f32,
+    pub vertex2_y: f32,
+    pub vertex2_z: f32,
+    pub pad1: ::std::os::raw::c_int,
 }
-extern "C" {
-    pub fn destroy_instance(instance: *mut ::std::os::raw::c_void);
+#[repr(C)]
+#[repr(align(16))]
+#[derive(Debug, Default, Copy, Clone)]
+pub struct LightTreeNode {
+    pub bmin: simd_float4,
+    pub bmax: simd_float4,
+    pub left: ::std::os::raw::c_uint,
+    pub right: ::std::os::raw::c_uint,
+    pub pad0: ::std::os::raw::c_uint,
+    pub pad1: ::std::os::raw::c_uint,
 }
-extern "C" {
-    pub fn set_2d_mesh(
-        instance: *mut ::std::os::raw::c_void,
-        id: ::std::os::raw::c_uint,
-        data: MeshData2D,
-    );
+#[repr(C)]
+#[repr(align(16))]
+#[derive(Debug, Default, Copy, Clone)]
+pub struct LightTreeUniforms {
+    pub center_min: simd_float4,
+    pub center_scale: simd_float4,
+    pub count: ::std::os::raw::c_uint,
+    pub padded: ::std::os::raw::c_uint,
+    pub pad0: ::std::os::raw::c_uint,
+    pub pad1: ::std::os::raw::c_uint,
 }
-extern "C" {
-    pub fn set_2d_instances(
-        instance: *mut ::std::os::raw::c_void,
-        id: ::std::os::raw::c_uint,
-        data: InstancesData2D,
-    );
+#[repr(C)]
+#[derive(Debug, Default, Copy, Clone)]
+pub struct SpotLight {
+    pub pos_x: f32,
+    pub pos_y: f32,
+    pub pos_z: f32,
+    pub cos_inner: f32,
+    pub radiance_r: f32,
+    pub radiance_g: f32,
+    pub radiance_b: f32,
+    pub cos_outer: f32,
+    pub direction_x: f32,
+    pub direction_y: f32,
+    pub direction_z: f32,
+    pub energy: f32,
 }
-extern "C" {
-    pub fn set_3d_mesh(
-        instance: *mut ::std::os::raw::c_void,
-        id: ::std::os::raw::c_uint,
-        data: MeshData3D,
-    );
+#[repr(C)]
+#[derive(Debug, Default, Copy, Clone)]
+pub struct DirectionalLight {
+    pub direction_x: f32,
+    pub direction_y: f32,
+    pub direction_z: f32,
+    pub energy: f32,
+    pub radiance_r: f32,
+    pub radiance_g: f32,
+    pub radiance_b: f32,
+    pub pad: f32,
 }
-extern "C" {
-    pub fn unload_3d_meshes(
-        instance: *mut ::std::os::raw::c_void,
-        ids: *const ::std::os::raw::c_uint,
-        num: ::std::os::raw::c_uint,
-    );
+#[repr(C)]
+#[repr(align(16))]
+#[derive(Debug, Default, Copy, Clone)]
+pub struct GiVolume {
+    pub origin: simd_float4,
+    pub spacing: simd_float4,
+    pub count_x: ::std::os::raw::c_uint,
+    pub count_y: ::std::os::raw::c_uint,
+    pub count_z: ::std::os::raw::c_uint,
+    pub bias: f32,
 }
-extern "C" {
-    pub fn set_3d_instances(
-        instance: *mut ::std::os::raw::c_void,
-        id: ::std::os::raw::c_uint,
-        data: InstancesData3D,
-    );
+#[repr(C)]
+#[repr(align(16))]
+#[derive(Debug, Default, Copy, Clone)]
+pub struct LightUniforms {
+    pub view: simd_float4x4,
+    pub inv_projection: simd_float4x4,
+    pub inv_combined: simd_float4x4,
+    pub camera_position: simd_float4,
+    pub num_point_lights: ::std::os::raw::c_uint,
+    pub num_spot_lights: ::std::os::raw::c_uint,
+    pub num_directional_lights: ::std::os::raw::c_uint,
+    pub tiles_x: ::std::os::raw::c_uint,
+    pub width: ::std::os::raw::c_uint,
+    pub height: ::std::os::raw::c_uint,
+    pub ray_traced: ::std::os::raw::c_uint,
+    pub ao_radius: f32,
+    pub environment: ::std::os::raw::c_uint,
+    pub ssao: ::std::os::raw::c_uint,
+    pub num_probes: ::std::os::raw::c_uint,
+    pub num_area_lights: ::std::os::raw::c_uint,
+    pub gi: GiVolume,
+    pub reflections: ::std::os::raw::c_uint,
+    pub reflection_roughness: f32,
+    pub pad0: ::std::os::raw::c_uint,
+    pub pad1: ::std::os::raw::c_uint,
 }
-extern "C" {
-    pub fn set_materials(
-        instance: *mut ::std::os::raw::c_void,
-        materials: *const DeviceMaterial,
-        num_materials: ::std::os::raw::c_uint,
-    );
+#[repr(C)]
+#[repr(align(16))]
+#[derive(Debug, Default, Copy, Clone)]
+pub struct SsaoUniforms {
+    pub combined: simd_float4x4,
+    pub width: ::std::os::raw::c_uint,
+    pub height: ::std::os::raw::c_uint,
+    pub pad0: ::std::os::raw::c_uint,
+    pub pad1: ::std::os::raw::c_uint,
 }
-extern "C" {
-    pub fn set_textures(
+#[repr(C)]
+#[repr(align(16))]
+#[derive(Debug, Default, Copy, Clone)]
+pub struct ReflectionUniforms {
+    pub combined: simd_float4x4,
+    pub previous_combined: simd_float4x4,
+    pub width: ::std::os::raw::c_uint,
+    pub height: ::std::os::raw::c_uint,
+    pub max_distance: f32,
+    pub traced: ::std::os::raw::c_uint,
+    pub hzb_levels: ::std::os::raw::c_uint,
+    pub history: ::std::os::raw::c_uint,
+    pub source: ::std::os::raw::c_uint,
+    pub pad0: ::std::os::raw::c_uint,
+}
+#[repr(C)]
+#[repr(align(16))]
+#[derive(Debug, Default, Copy, Clone)]
+pub struct SdfVolume {
+    pub origin: simd_float4,
+    pub size: simd_uint4,
+}
+#[repr(C)]
+#[repr(align(16))]
+#[derive(Debug, Default, Copy, Clone)]
+pub struct SdfMeshUniforms {
+    pub volume: SdfVolume,
+    pub vertex_start: ::std::os::raw::c_uint,
+    pub index_offset: ::std::os::raw::c_uint,
+    pub index_size: ::std::os::raw::c_uint,
+    pub num_triangles: ::std::os::raw::c_uint,
+    pub first_voxel: ::std::os::raw::c_uint,
+    pub num_voxels: ::std::os::raw::c_uint,
+    pub pad0: ::std::os::raw::c_uint,
+    pub pad1: ::std::os::raw::c_uint,
+}
+#[repr(C)]
+#[repr(align(16))]
+#[derive(Debug, Default, Copy, Clone)]
+pub struct SdfInstance {
+    pub inverse: [simd_float4; 3usize],
+    pub bmin: simd_float4,
+    pub bmax: simd_float4,
+    pub scale: f32,
+    pub volume: ::std::os::raw::c_uint,
+    pub pad0: ::std::os::raw::c_uint,
+    pub pad1: ::std::os::raw::c_uint,
+}
+#[repr(C)]
+#[repr(align(16))]
+#[derive(Debug, Default, Copy, Clone)]
+pub struct SdfRegionUniforms {
+    pub first_cell: simd_int4,
+    pub size: simd_uint4,
+    pub num_instances: ::std::os::raw::c_uint,
+    pub voxel_size: f32,
+    pub band: f32,
+    pub pad0: ::std::os::raw::c_uint,
+}
+#[repr(C)]
+#[repr(align(16))]
+#[derive(Debug, Default, Copy, Clone)]
+pub struct SdfTraceUniforms {
+    pub windows: [simd_int4; 4usize],
+    pub voxel_size: f32,
+    pub softness: f32,
+    pub ao_distance: f32,
+    pub pad0: ::std::os::raw::c_uint,
+}
+#[repr(C)]
+#[repr(align(16))]
+#[derive(Debug, Default, Copy, Clone)]
+pub struct IrradianceSH {
+    pub coefficients: [simd_float4; 9usize],
+}
+#[repr(C)]
+#[derive(Debug, Default, Copy, Clone)]
+pub struct EnvironmentUniforms {
+    pub size: ::std::os::raw::c_uint,
+    pub roughness: f32,
+    pub pad0: ::std::os::raw::c_uint,
+    pub pad1: ::std::os::raw::c_uint,
+}
+#[repr(C)]
+#[repr(align(16))]
+#[derive(Debug, Default, Copy, Clone)]
+pub struct ShadowUniforms {
+    pub cascades: [simd_float4x4; 4usize],
+    pub spot_lights: [simd_float4x4; 16usize],
+    pub cascade_ends: [f32; 4usize],
+    pub num_cascades: ::std::os::raw::c_uint,
+    pub num_spot_shadows: ::std::os::raw::c_uint,
+    pub cascade_bias: f32,
+    pub spot_bias: f32,
+}
+#[repr(C)]
+#[derive(Debug, Default, Copy, Clone)]
+pub struct TracedInstance {
+    pub vertex_start: ::std::os::raw::c_uint,
+    pub index_offset: ::std::os::raw::c_uint,
+    pub index_size: ::std::os::raw::c_uint,
+    pub instance: ::std::os::raw::c_uint,
+    pub animated: ::std::os::raw::c_uint,
+    pub pad0: ::std::os::raw::c_uint,
+    pub pad1: ::std::os::raw::c_uint,
+    pub pad2: ::std::os::raw::c_uint,
+}
+#[repr(C)]
+#[repr(align(16))]
+#[derive(Debug, Default, Copy, Clone)]
+pub struct BvhNode {
+    pub min_x: simd_float4,
+    pub max_x: simd_float4,
+    pub min_y: simd_float4,
+    pub max_y: simd_float4,
+    pub min_z: simd_float4,
+    pub max_z: simd_float4,
+    pub children: simd_int4,
+    pub counts: simd_int4,
+}
+#[repr(C)]
+#[repr(align(16))]
+#[derive(Debug, Default, Copy, Clone)]
+pub struct BvhTriangle {
+    pub v0: simd_float4,
+    pub e1: simd_float4,
+    pub e2: simd_float4,
+}
+#[repr(C)]
+#[repr(align(16))]
+#[derive(Debug, Default, Copy, Clone)]
+pub struct BvhInstance {
+    pub inverse: [simd_float4; 3usize],
+    pub root: ::std::os::raw::c_uint,
+    pub instance: ::std::os::raw::c_uint,
+    pub pad0: ::std::os::raw::c_uint,
+    pub pad1: ::std::os::raw::c_uint,
+}
+#[repr(C)]
+#[repr(align(16))]
+#[derive(Debug, Default, Copy, Clone)]
+pub struct PathTracerUniforms {
+    pub inv_combined: simd_float4x4,
+    pub previous_combined: simd_float4x4,
+    pub camera_position: simd_float4,
+    pub width: ::std::os::raw::c_uint,
+    pub height: ::std::os::raw::c_uint,
+    pub sample: ::std::os::raw::c_uint,
+    pub num_point_lights: ::std::os::raw::c_uint,
+    pub num_spot_lights: ::std::os::raw::c_uint,
+    pub num_directional_lights: ::std::os::raw::c_uint,
+    pub num_area_lights: ::std::os::raw::c_uint,
+    pub seed: ::std::os::raw::c_uint,
+    pub denoise: ::std::os::raw::c_uint,
+    pub history: ::std::os::raw::c_uint,
+    pub adaptive: ::std::os::raw::c_uint,
+    pub tiles_x: ::std::os::raw::c_uint,
+    pub threshold: f32,
+    pub min_samples: ::std::os::raw::c_uint,
+    pub max_samples: ::std::os::raw::c_uint,
+    pub render: ::std::os::raw::c_uint,
+    pub lightmap: ::std::os::raw::c_uint,
+    pub pad0: ::std::os::raw::c_uint,
+    pub pad1: ::std::os::raw::c_uint,
+    pub pad2: ::std::os::raw::c_uint,
+}
+#[repr(C)]
+#[repr(align(16))]
+#[derive(Debug, Default, Copy, Clone)]
+pub struct PathState {
+    pub origin: simd_float4,
+    pub direction: simd_float4,
+    pub throughput: simd_float4,
+}
+#[repr(C)]
+#[repr(align(16))]
+#[derive(Debug, Default, Copy, Clone)]
+pub struct GiUniforms {
+    pub rotation: simd_float4x4,
+    pub volume: GiVolume,
+    pub first_probe: ::std::os::raw::c_uint,
+    pub num_probes: ::std::os::raw::c_uint,
+    pub seed: ::std::os::raw::c_uint,
+    pub hysteresis: f32,
+    pub max_distance: f32,
+    pub environment: ::std::os::raw::c_uint,
+    pub num_point_lights: ::std::os::raw::c_uint,
+    pub num_spot_lights: ::std::os::raw::c_uint,
+    pub num_directional_lights: ::std::os::raw::c_uint,
+    pub bounce: ::std::os::raw::c_uint,
+    pub pad0: ::std::os::raw::c_uint,
+    pub pad1: ::std::os::raw::c_uint,
+}
+#[repr(C)]
+#[repr(align(16))]
+#[derive(Debug, Default, Copy, Clone)]
+pub struct PathSurface {
+    pub position: simd_float4,
+    pub normal: simd_float4,
+}
+#[repr(C)]
+#[repr(align(16))]
+#[derive(Debug, Default, Copy, Clone)]
+pub struct PathHistory {
+    pub radiance: simd_float4,
+    pub moments: simd_float4,
+}
+#[repr(C)]
+#[derive(Debug, Default, Copy, Clone)]
+pub struct PathHit {
+    pub instance: ::std::os::raw::c_uint,
+    pub primitive: ::std::os::raw::c_uint,
+    pub distance: f32,
+    pub barycentrics: ::std::os::raw::c_uint,
+}
+#[repr(C)]
+#[derive(Debug, Default, Copy, Clone)]
+pub struct RayQuery {
+    pub origin_x: f32,
+    pub origin_y: f32,
+    pub origin_z: f32,
+    pub min_distance: f32,
+    pub direction_x: f32,
+    pub direction_y: f32,
+    pub direction_z: f32,
+    pub max_distance: f32,
+}
+#[repr(C)]
+#[repr(align(16))]
+#[derive(Debug, Default, Copy, Clone)]
+pub struct ShadowRay {
+    pub origin: simd_float4,
+    pub direction: simd_float4,
+    pub radiance: simd_float4,
+}
+#[repr(C)]
+#[derive(Debug, Default, Copy, Clone)]
+pub struct DispatchArguments {
+    pub threadgroups: [::std::os::raw::c_uint; 3usize],
+}
+#[repr(C)]
+#[repr(align(16))]
+#[derive(Debug, Default, Copy, Clone)]
+pub struct InstanceBvhNode {
+    pub bmin: simd_float4,
+    pub bmax: simd_float4,
+    pub left: ::std::os::raw::c_uint,
+    pub right: ::std::os::raw::c_uint,
+    pub first: ::std::os::raw::c_uint,
+    pub count: ::std::os::raw::c_uint,
+}
+#[repr(C)]
+#[derive(Debug, Default, Copy, Clone)]
+pub struct InstanceBvhUniforms {
+    pub num_slots: ::std::os::raw::c_uint,
+    pub num_clusters: ::std::os::raw::c_uint,
+    pub num_draws: ::std::os::raw::c_uint,
+    pub listed: ::std::os::raw::c_uint,
+    pub num_moved: ::std::os::raw::c_uint,
+    pub pad0: ::std::os::raw::c_uint,
+    pub pad1: ::std::os::raw::c_uint,
+    pub pad2: ::std::os::raw::c_uint,
+}
+#[repr(C)]
+#[repr(align(16))]
+#[derive(Debug, Default, Copy, Clone)]
+pub struct InstanceBvhCounters {
+    pub center_min: simd_uint4,
+    pub center_max: simd_uint4,
+    pub refit: DispatchArguments,
+    pub visible: DispatchArguments,
+    pub pad0: ::std::os::raw::c_uint,
+    pub pad1: ::std::os::raw::c_uint,
+}
+#[repr(C)]
+#[derive(Debug, Default, Copy, Clone)]
+pub struct PathCounters {
+    pub paths: [::std::os::raw::c_uint; 2usize],
+    pub shadow_rays: ::std::os::raw::c_uint,
+    pub traced_shadow_rays: ::std::os::raw::c_uint,
+    pub extend: DispatchArguments,
+    pub shadow: DispatchArguments,
+    pub active_tiles: ::std::os::raw::c_uint,
+}
+#[repr(C)]
+#[derive(Debug, Default, Copy, Clone)]
+pub struct ReflectionCounters {
+    pub rays: ::std::os::raw::c_uint,
+    pub trace: DispatchArguments,
+}
+#[repr(C)]
+#[derive(Debug, Default, Copy, Clone)]
+pub struct PathTile {
+    pub samples: ::std::os::raw::c_uint,
+    pub converged: ::std::os::raw::c_uint,
+    pub error: f32,
+    pub pad0: ::std::os::raw::c_uint,
+}
+#[repr(C)]
+#[derive(Debug, Default, Copy, Clone)]
+pub struct PathProgress {
+    pub render: ::std::os::raw::c_uint,
+    pub active_tiles: ::std::os::raw::c_uint,
+}
+#[repr(C)]
+#[derive(Debug, Default, Copy, Clone)]
+pub struct LightmapFilterUniforms {
+    pub width: ::std::os::raw::c_uint,
+    pub height: ::std::os::raw::c_uint,
+    pub step: ::std::os::raw::c_uint,
+    pub last: ::std::os::raw::c_uint,
+}
+#[repr(C)]
+#[repr(align(16))]
+#[derive(Debug, Default, Copy, Clone)]
+pub struct ParticleEmitter {
+    pub position: simd_float4,
+    pub velocity: simd_float4,
+    pub acceleration: simd_float4,
+    pub rate: f32,
+    pub lifetime: f32,
+    pub size_start: f32,
+    pub size_end: f32,
+    pub color_start: ::std::os::raw::c_uint,
+    pub color_end: ::std::os::raw::c_uint,
+    pub uv_x: ::std::os::raw::c_ushort,
+    pub uv_y: ::std::os::raw::c_ushort,
+    pub uv_width: ::std::os::raw::c_ushort,
+    pub uv_height: ::std::os::raw::c_ushort,
+    pub tex: ::std::os::raw::c_uint,
+    pub collide: ::std::os::raw::c_uint,
+    pub restitution: f32,
+    pub pad0: ::std::os::raw::c_uint,
+}
+#[repr(C)]
+#[derive(Debug, Default, Copy, Clone)]
+pub struct DebugLine {
+    pub start: Vector3,
+    pub color: ::std::os::raw::c_uint,
+    pub end: Vector3,
+    pub width: f32,
+}
+#[repr(C)]
+#[repr(align(16))]
+#[derive(Debug, Default, Copy, Clone)]
+pub struct Particle {
+    pub position: simd_float4,
+    pub velocity: simd_float4,
+}
+#[repr(C)]
+#[derive(Debug, Default, Copy, Clone)]
+pub struct DrawArguments {
+    pub vertex_count: ::std::os::raw::c_uint,
+    pub instance_count: ::std::os::raw::c_uint,
+    pub vertex_start: ::std::os::raw::c_uint,
+    pub base_instance: ::std::os::raw::c_uint,
+}
+#[repr(C)]
+#[derive(Debug, Default, Copy, Clone)]
+pub struct ParticleCounters {
+    pub alive: [::std::os::raw::c_uint; 2usize],
+    pub dead: ::std::os::raw::c_int,
+    pub pad0: ::std::os::raw::c_uint,
+    pub simulate: DispatchArguments,
+    pub pad1: ::std::os::raw::c_uint,
+    pub draw: DrawArguments,
+}
+#[repr(C)]
+#[repr(align(16))]
+#[derive(Debug, Default, Copy, Clone)]
+pub struct ParticleUniforms {
+    pub depth_combined: simd_float4x4,
+    pub depth_inv_combined: simd_float4x4,
+    pub emit: ::std::os::raw::c_uint,
+    pub capacity: ::std::os::raw::c_uint,
+    pub list: ::std::os::raw::c_uint,
+    pub seed: ::std::os::raw::c_uint,
+    pub delta_time: f32,
+    pub collide: ::std::os::raw::c_uint,
+    pub pad0: ::std::os::raw::c_uint,
+    pub pad1: ::std::os::raw::c_uint,
+}
+#[repr(C)]
+#[repr(align(16))]
+#[derive(Debug, Default, Copy, Clone)]
+pub struct TerrainUniforms {
+    pub origin: simd_float4,
+    pub level_x: [::std::os::raw::c_int; 8usize],
+    pub level_y: [::std::os::raw::c_int; 8usize],
+    pub spacing: f32,
+    pub uv_scale: f32,
+    pub width: ::std::os::raw::c_uint,
+    pub height: ::std::os::raw::c_uint,
+    pub levels: ::std::os::raw::c_uint,
+    pub cells: ::std::os::raw::c_uint,
+    pub material: ::std::os::raw::c_uint,
+    pub has_materials: ::std::os::raw::c_uint,
+}
+#[repr(C)]
+#[repr(align(16))]
+#[derive(Debug, Default, Copy, Clone)]
+pub struct ScatterUniforms {
+    pub camera: simd_float4,
+    pub hidden: simd_float4,
+    pub first_x: ::std::os::raw::c_int,
+    pub first_y: ::std::os::raw::c_int,
+    pub side: ::std::os::raw::c_uint,
+    pub count: ::std::os::raw::c_uint,
+    pub seed: ::std::os::raw::c_uint,
+    pub density_width: ::std::os::raw::c_uint,
+    pub density_height: ::std::os::raw::c_uint,
+    pub has_density: ::std::os::raw::c_uint,
+    pub spacing: f32,
+    pub radius: f32,
+    pub min_scale: f32,
+    pub max_scale: f32,
+}
+#[repr(C)]
+#[repr(align(16))]
+#[derive(Debug, Default, Copy, Clone)]
+pub struct ImpostorBakeUniforms {
+    pub center: simd_float4,
+    pub tiles: ::std::os::raw::c_uint,
+}
+#[repr(C)]
+#[repr(align(16))]
+#[derive(Debug, Default, Copy, Clone)]
+pub struct VBufferMesh {
+    pub first_triangle: ::std::os::raw::c_uint,
+    pub vertex_start: ::std::os::raw::c_uint,
+    pub index_start: ::std::os::raw::c_uint,
+    pub flags: ::std::os::raw::c_uint,
+    pub bounds: PackedVertexBounds,
+}
+#[repr(C)]
+#[derive(Debug, Default, Copy, Clone)]
+pub struct GlyphInstance {
+    pub x: f32,
+    pub y: f32,
+    pub z: f32,
+    pub width: f32,
+    pub height: f32,
+    pub color: ::std::os::raw::c_uint,
+    pub atlas_x: ::std::os::raw::c_ushort,
+    pub atlas_y: ::std::os::raw::c_ushort,
+    pub atlas_width: ::std::os::raw::c_ushort,
+    pub atlas_height: ::std::os::raw::c_ushort,
+}
+#[repr(C)]
+#[derive(Debug, Default, Copy, Clone)]
+pub struct SpriteInstance {
+    pub x: f32,
+    pub y: f32,
+    pub z: f32,
+    pub width: f32,
+    pub height: f32,
+    pub rotation: f32,
+    pub uv_x: ::std::os::raw::c_ushort,
+    pub uv_y: ::std::os::raw::c_ushort,
+    pub uv_width: ::std::os::raw::c_ushort,
+    pub uv_height: ::std::os::raw::c_ushort,
+    pub color: ::std::os::raw::c_uint,
+    pub tex: ::std::os::raw::c_uint,
+}
+#[repr(C)]
+#[repr(align(16))]
+#[derive(Debug, Default, Copy, Clone)]
+pub struct MotionUniforms {
+    pub inv_combined: simd_float4x4,
+    pub previous_combined: simd_float4x4,
+    pub jitter_x: f32,
+    pub jitter_y: f32,
+    pub width: ::std::os::raw::c_uint,
+    pub height: ::std::os::raw::c_uint,
+}
+#[repr(C)]
+#[derive(Debug, Default, Copy, Clone)]
+pub struct ToneMapUniforms {
+    pub exposure: f32,
+    pub headroom: f32,
+    pub enabled: ::std::os::raw::c_uint,
+    pub pad0: ::std::os::raw::c_uint,
+}
+#[repr(C)]
+#[derive(Debug, Default, Copy, Clone)]
+pub struct TaaUniforms {
+    pub width: ::std::os::raw::c_uint,
+    pub height: ::std::os::raw::c_uint,
+    pub reset: ::std::os::raw::c_uint,
+    pub pad0: ::std::os::raw::c_uint,
+}
+#[repr(C)]
+#[repr(align(16))]
+#[derive(Debug, Default, Copy, Clone)]
+pub struct Aabb {
+    pub bmin: simd_float4,
+    pub bmax: simd_float4,
+}
+#[repr(C)]
+#[repr(align(16))]
+#[derive(Debug, Default, Copy, Clone)]
+pub struct RTTriangle {
+    pub vertex0: Vector3,
+    pub u0: f32,
+    pub vertex1: Vector3,
+    pub u1: f32,
+    pub vertex2: Vector3,
+    pub u2: f32,
+    pub normal: Vector3,
+    pub v0: f32,
+    pub n0: Vector3,
+    pub v1: f32,
+    pub n1: Vector3,
+    pub v2: f32,
+    pub n2: Vector3,
+    pub id: ::std::os::raw::c_int,
+    pub tangent0: simd_float4,
+    pub tangent1: simd_float4,
+    pub tangent2: simd_float4,
+    pub light_id: ::std::os::raw::c_int,
+    pub mat_id: ::std::os::raw::c_int,
+    pub lod: f32,
+    pub area: f32,
+}
+#[repr(C)]
+#[repr(align(16))]
+#[derive(Debug, Default, Copy, Clone)]
+pub struct VertexRange {
+    pub bounds: Aabb,
+    pub first: ::std::os::raw::c_uint,
+    pub last: ::std::os::raw::c_uint,
+    pub mat_id: ::std::os::raw::c_uint,
+    pub padding: ::std::os::raw::c_uint,
+}
+#[repr(C)]
+#[repr(align(16))]
+#[derive(Debug, Default, Copy, Clone)]
+pub struct JointData {
+    pub j_x: ::std::os::raw::c_uint,
+    pub j_y: ::std::os::raw::c_uint,
+    pub j_z: ::std::os::raw::c_uint,
+    pub j_w: ::std::os::raw::c_uint,
+    pub weight: simd_float4,
+}
+#[repr(u32)]
+#[derive(Debug, Copy, Clone, Hash, PartialEq, Eq)]
+pub enum Mesh3dFlags {
+    SHADOW_CASTER = 1,
+    ALLOW_SKINNING = 2,
+    TRANSPARENT = 4,
+    STATIC = 8,
+    OPTIMIZE_ORDER = 16,
+}
+#[repr(C)]
+#[repr(align(16))]
+#[derive(Debug, Copy, Clone)]
+pub struct MeshData3D {
+    pub vertices: *const Vertex3D,
+    pub num_vertices: ::std::os::raw::c_uint,
+    pub triangles: *const RTTriangle,
+    pub num_triangles: ::std::os::raw::c_uint,
+    pub ranges: *const VertexRange,
+    pub num_ranges: ::std::os::raw::c_uint,
+    pub skin_data: *const JointData,
+    pub flags: ::std::os::raw::c_uint,
+    pub __bindgen_padding_0: [u64; 0usize],
+    pub bounds: Aabb,
+    pub indices: *const ::std::os::raw::c_uint,
+    pub num_indices: ::std::os::raw::c_uint,
+}
+impl Default for MeshData3D {
+    fn default() -> Self {
+        unsafe { ::std::mem::zeroed() }
+    }
+}
+#[repr(C)]
+#[derive(Debug, Copy, Clone)]
+pub struct EncodedMesh3D {
+    pub vertices: *const ::std::os::raw::c_uchar,
+    pub num_vertex_bytes: size_t,
+    pub indices: *const ::std::os::raw::c_uchar,
+    pub num_index_bytes: size_t,
+}
+impl Default for EncodedMesh3D {
+    fn default() -> Self {
+        unsafe { ::std::mem::zeroed() }
+    }
+}
+#[repr(u32)]
+#[derive(Debug, Copy, Clone, Hash, PartialEq, Eq)]
+pub enum InstanceFlags3D {
+    TRANSFORMED = 1,
+}
+#[repr(C)]
+#[derive(Debug, Copy, Clone)]
+pub struct SkinData {
+    pub name: *const ::std::os::raw::c_char,
+    pub name_length: size_t,
+    pub inverse_bind_matrices: *const simd_float4x4,
+    pub num_inverse_bind_matrices: size_t,
+    pub joint_matrices: *const simd_float4x4,
+    pub num_joint_matrices: size_t,
+}
+impl Default for SkinData {
+    fn default() -> Self {
+        unsafe { ::std::mem::zeroed() }
+    }
+}
+#[repr(C)]
+#[derive(Debug, Copy, Clone)]
+pub struct MorphTargetData {
+    pub vertices: *const ::std::os::raw::c_uint,
+    pub positions: *const f32,
+    pub normals: *const f32,
+    pub count: ::std::os::raw::c_uint,
+}
+impl Default for MorphTargetData {
+    fn default() -> Self {
+        unsafe { ::std::mem::zeroed() }
+    }
+}
+#[repr(u32)]
+#[derive(Debug, Copy, Clone, Hash, PartialEq, Eq)]
+pub enum AnimationPath {
+    ANIMATION_TRANSLATION = 0,
+    ANIMATION_ROTATION = 1,
+    ANIMATION_SCALE = 2,
+}
+#[repr(C)]
+#[derive(Debug, Copy, Clone)]
+pub struct AnimationChannel {
+    pub joint: ::std::os::raw::c_uint,
+    pub path: AnimationPath,
+    pub times: *const f32,
+    pub values: *const f32,
+    pub num_keys: ::std::os::raw::c_uint,
+}
+impl Default for AnimationChannel {
+    fn default() -> Self {
+        unsafe { ::std::mem::zeroed() }
+    }
+}
+#[repr(C)]
+#[derive(Debug, Copy, Clone)]
+pub struct SkeletonData {
+    pub parents: *const ::std::os::raw::c_int,
+    pub translations: *const f32,
+    pub rotations: *const f32,
+    pub scales: *const f32,
+    pub inverse_bind_matrices: *const simd_float4x4,
+    pub num_joints: ::std::os::raw::c_uint,
+}
+impl Default for SkeletonData {
+    fn default() -> Self {
+        unsafe { ::std::mem::zeroed() }
+    }
+}
+#[repr(C)]
+#[derive(Debug, Default, Copy, Clone)]
+pub struct AnimationLayer {
+    pub clip: ::std::os::raw::c_uint,
+    pub time: f32,
+    pub weight: f32,
+    pub loop_: ::std::os::raw::c_uint,
+}
+#[repr(C)]
+#[repr(align(16))]
+#[derive(Debug, Copy, Clone)]
+pub struct InstancesData3D {
+    pub local_aabb: Aabb,
+    pub matrices: *const simd_float4x4,
+    pub num_matrices: ::std::os::raw::c_uint,
+    pub skin_ids: *const ::std::os::raw::c_int,
+    pub num_skin_ids: ::std::os::raw::c_uint,
+    pub flags: *const ::std::os::raw::c_uint,
+    pub num_flags: ::std::os::raw::c_uint,
+}
+impl Default for InstancesData3D {
+    fn default() -> Self {
+        unsafe { ::std::mem::zeroed() }
+    }
+}
+#[repr(C)]
+#[derive(Debug, Copy, Clone)]
+pub struct SceneCacheData {
+    pub mesh_ids: *const ::std::os::raw::c_uint,
+    pub meshes: *const MeshData3D,
+    pub num_meshes: ::std::os::raw::c_uint,
+    pub instance_ids: *const ::std::os::raw::c_uint,
+    pub instances: *const InstancesData3D,
+    pub num_instances: ::std::os::raw::c_uint,
+    pub materials: *const DeviceMaterial,
+    pub num_materials: ::std::os::raw::c_uint,
+    pub textures: *const TextureData,
+    pub num_textures: ::std::os::raw::c_uint,
+}
+impl Default for SceneCacheData {
+    fn default() -> Self {
+        unsafe { ::std::mem::zeroed() }
+    }
+}
+#[repr(C)]
+#[derive(Debug, Default, Copy, Clone)]
+pub struct MeshLod {
+    pub mesh_id: ::std::os::raw::c_uint,
+    pub screen_size: f32,
+}
+#[repr(C)]
+#[derive(Debug, Default, Copy, Clone)]
+pub struct StaticBatching {
+    pub cell_size: f32,
+    pub first_id: ::std::os::raw::c_uint,
+    pub max_batches: ::std::os::raw::c_uint,
+}
+#[repr(C)]
+#[repr(align(16))]
+#[derive(Debug, Default, Copy, Clone)]
+pub struct PrefabMesh3D {
+    pub mesh_id: ::std::os::raw::c_uint,
+    pub local_aabb: Aabb,
+}
+#[repr(C)]
+#[derive(Debug, Copy, Clone)]
+pub struct InstanceAnimation3D {
+    pub type_: ::std::os::raw::c_uint,
+    pub amplitude: f32,
+    pub frequency: f32,
+    pub instances: *const AnimatedInstance,
+    pub num_instances: ::std::os::raw::c_uint,
+}
+#[repr(C)]
+#[repr(align(16))]
+#[derive(Debug, Default, Copy, Clone)]
+pub struct TransformNode {
+    pub local: simd_float4x4,
+    pub parent: ::std::os::raw::c_int,
+    pub mesh: ::std::os::raw::c_uint,
+    pub instance: ::std::os::raw::c_uint,
+}
+#[repr(C)]
+#[repr(align(16))]
+#[derive(Debug, Copy, Clone)]
+pub struct TerrainData {
+    pub origin: simd_float4,
+    pub heights: *const f32,
+    pub materials: *const ::std::os::raw::c_uint,
+    pub width: ::std::os::raw::c_uint,
+    pub height: ::std::os::raw::c_uint,
+    pub spacing: f32,
+    pub uv_scale: f32,
+    pub material: ::std::os::raw::c_uint,
+    pub levels: ::std::os::raw::c_uint,
+    pub flags: ::std::os::raw::c_uint,
+}
+impl Default for TerrainData {
+    fn default() -> Self {
+        unsafe { ::std::mem::zeroed() }
+    }
+}
+#[repr(C)]
+#[derive(Debug, Copy, Clone)]
+pub struct ScatterData {
+    pub density: *const f32,
+    pub density_width: ::std::os::raw::c_uint,
+    pub density_height: ::std::os::raw::c_uint,
+    pub terrain: ::std::os::raw::c_uint,
+    pub seed: ::std::os::raw::c_uint,
+    pub spacing: f32,
+    pub radius: f32,
+    pub min_scale: f32,
+    pub max_scale: f32,
+}
+impl Default for ScatterData {
+    fn default() -> Self {
+        unsafe { ::std::mem::zeroed() }
+    }
+}
+#[repr(C)]
+#[repr(align(16))]
+#[derive(Debug, Copy, Clone)]
+pub struct PointCloudData {
+    pub transform: simd_float4x4,
+    pub positions: *const Vector3,
+    pub colors: *const ::std::os::raw::c_uint,
+    pub count: ::std::os::raw::c_uint,
+}
+impl Default for PointCloudData {
+    fn default() -> Self {
+        unsafe { ::std::mem::zeroed() }
+    }
+}
+#[repr(C)]
+#[derive(Debug, Default, Copy, Clone)]
+pub struct ImpostorSettings {
+    pub mesh: ::std::os::raw::c_uint,
+    pub material: ::std::os::raw::c_uint,
+    pub albedo_texture: ::std::os::raw::c_uint,
+    pub normal_texture: ::std::os::raw::c_uint,
+    pub tiles: ::std::os::raw::c_uint,
+    pub tile_size: ::std::os::raw::c_uint,
+    pub grid: ::std::os::raw::c_uint,
+    pub screen_size: f32,
+}
+#[repr(C)]
+#[derive(Debug, Copy, Clone)]
+pub struct LightmapSettings {
+    pub meshes: *const ::std::os::raw::c_uint,
+    pub num_meshes: ::std::os::raw::c_uint,
+    pub texture: ::std::os::raw::c_uint,
+    pub width: ::std::os::raw::c_uint,
+    pub height: ::std::os::raw::c_uint,
+    pub samples: ::std::os::raw::c_uint,
+    pub samples_per_frame: ::std::os::raw::c_uint,
+}
+#[repr(C)]
+#[derive(Debug, Copy, Clone)]
+pub struct MeshData2D {
+    pub vertices: *const Vertex2D,
+    pub num_vertices: ::std::os::raw::c_uint,
+    pub tex_id: ::std::os::raw::c_int,
+}
+impl Default for MeshData2D {
+    fn default() -> Self {
+        unsafe { ::std::mem::zeroed() }
+    }
+}
+#[repr(C)]
+#[derive(Debug, Copy, Clone)]
+pub struct InstancesData2D {
+    pub matrices: *const simd_float4x4,
+    pub num_matrices: ::std::os::raw::c_uint,
+}
+impl Default for InstancesData2D {
+    fn default() -> Self {
+        unsafe { ::std::mem::zeroed() }
+    }
+}
+#[repr(C)]
+#[derive(Debug, Default, Copy, Clone)]
+pub struct ClipRect2D {
+    pub x: ::std::os::raw::c_int,
+    pub y: ::std::os::raw::c_int,
+    pub width: ::std::os::raw::c_uint,
+    pub height: ::std::os::raw::c_uint,
+}
+#[repr(C)]
+#[derive(Debug, Default, Copy, Clone)]
+pub struct PathSegment2D {
+    pub x0: f32,
+    pub y0: f32,
+    pub x1: f32,
+    pub y1: f32,
+}
+#[repr(u32)]
+#[derive(Debug, Copy, Clone, Hash, PartialEq, Eq)]
+pub enum PathMode2D {
+    PATH_FILL_NONZERO = 0,
+    PATH_FILL_EVEN_ODD = 1,
+    PATH_STROKE = 2,
+}
+#[repr(C)]
+#[repr(align(16))]
+#[derive(Debug, Copy, Clone)]
+pub struct PathData2D {
+    pub transform: simd_float4x4,
+    pub segments: *const PathSegment2D,
+    pub num_segments: ::std::os::raw::c_uint,
+    pub mode: PathMode2D,
+    pub stroke_width: f32,
+    pub z: f32,
+    pub color: ::std::os::raw::c_uint,
+}
+impl Default for PathData2D {
+    fn default() -> Self {
+        unsafe { ::std::mem::zeroed() }
+    }
+}
+#[repr(u32)]
+#[derive(Debug, Copy, Clone, Hash, PartialEq, Eq)]
+pub enum DataFormat {
+    BGRA8 = 0,
+    RGBA8 = 1,
+    BC1_RGBA = 2,
+    BC2_RGBA = 3,
+    BC3_RGBA = 4,
+    BC4_R = 5,
+    BC5_RG = 6,
+    BC6H_RGB_UFLOAT = 7,
+    BC7_RGBA = 8,
+    ASTC_4x4 = 9,
+    ASTC_6x6 = 10,
+    ASTC_8x8 = 11,
+    R8 = 12,
+    RG8 = 13,
+    BGRA8_SRGB = 14,
+    RGBA8_SRGB = 15,
+    BC1_RGBA_SRGB = 16,
+    BC2_RGBA_SRGB = 17,
+    BC3_RGBA_SRGB = 18,
+    BC7_RGBA_SRGB = 19,
+    ASTC_4x4_SRGB = 20,
+    ASTC_6x6_SRGB = 21,
+    ASTC_8x8_SRGB = 22,
+    KTX2 = 23,
+}
+#[repr(u32)]
+#[derive(Debug, Copy, Clone, Hash, PartialEq, Eq)]
+pub enum VertexFormat3D {
+    VERTEX_3D_FULL = 0,
+    VERTEX_3D_PACKED = 1,
+}
+#[repr(u32)]
+#[derive(Debug, Copy, Clone, Hash, PartialEq, Eq)]
+pub enum RenderMode3D {
+    RENDER_DEFAULT = 0,
+    RENDER_NORMAL = 1,
+    RENDER_ALBEDO = 2,
+    RENDER_GBUFFER = 3,
+    RENDER_SSAO = 4,
+    RENDER_PATH_TRACED = 5,
+    RENDER_FILTERED_SSAO = 6,
+    RENDER_OVERDRAW = 7,
+}
+#[repr(u32)]
+#[derive(Debug, Copy, Clone, Hash, PartialEq, Eq)]
+pub enum HdrMode {
+    HDR_OFF = 0,
+    HDR_TONEMAPPED = 1,
+    HDR_EXTENDED = 2,
+}
+#[repr(C)]
+#[derive(Debug, Default, Copy, Clone)]
+pub struct PostProcessSettings {
+    pub bloom_threshold: f32,
+    pub bloom_intensity: f32,
+    pub vignette_intensity: f32,
+    pub vignette_radius: f32,
+}
+#[repr(C)]
+#[derive(Debug, Default, Copy, Clone)]
+pub struct ReflectionSettings {
+    pub enabled: ::std::os::raw::c_uint,
+    pub max_roughness: f32,
+    pub max_distance: f32,
+}
+#[repr(C)]
+#[derive(Debug, Default, Copy, Clone)]
+pub struct SdfSettings {
+    pub enabled: ::std::os::raw::c_uint,
+    pub softness: f32,
+    pub ao_distance: f32,
+    pub voxel_size: f32,
+}
+#[repr(u32)]
+#[derive(Debug, Copy, Clone, Hash, PartialEq, Eq)]
+pub enum PresentMode {
+    PRESENT_IMMEDIATE = 0,
+    PRESENT_VSYNC = 1,
+    PRESENT_PACED = 2,
+    PRESENT_DISPLAY_LINK = 3,
+}
+#[repr(u32)]
+#[derive(Debug, Copy, Clone, Hash, PartialEq, Eq)]
+pub enum FrameStatus {
+    FRAME_PRESENTED = 0,
+    FRAME_NO_DRAWABLE = 1,
+    FRAME_SKIPPED = 2,
+    FRAME_IDLE = 3,
+}
+#[repr(C)]
+#[derive(Debug, Copy, Clone)]
+pub struct TextureData {
+    pub width: ::std::os::raw::c_uint,
+    pub height: ::std::os::raw::c_uint,
+    pub mip_levels: ::std::os::raw::c_uint,
+    pub bytes: *const ::std::os::raw::c_uchar,
+    pub num_bytes: size_t,
+    pub format: DataFormat,
+}
+impl Default for TextureData {
+    fn default() -> Self {
+        unsafe { ::std::mem::zeroed() }
+    }
+}
+#[repr(u32)]
+#[derive(Debug, Copy, Clone, Hash, PartialEq, Eq)]
+pub enum AssetCompression {
+    ASSET_COMPRESSION_ZLIB = 0,
+    ASSET_COMPRESSION_LZFSE = 1,
+    ASSET_COMPRESSION_LZ4 = 2,
+    ASSET_COMPRESSION_LZMA = 3,
+    ASSET_COMPRESSION_LZBITMAP = 4,
+    ASSET_COMPRESSION_NONE = 5,
+}
+#[repr(u32)]
+#[derive(Debug, Copy, Clone, Hash, PartialEq, Eq)]
+pub enum AssetPriority {
+    ASSET_PRIORITY_HIGH = 0,
+    ASSET_PRIORITY_NORMAL = 1,
+    ASSET_PRIORITY_LOW = 2,
+}
+#[repr(C)]
+#[derive(Debug, Copy, Clone)]
+pub struct FileTexture {
+    pub width: ::std::os::raw::c_uint,
+    pub height: ::std::os::raw::c_uint,
+    pub mip_levels: ::std::os::raw::c_uint,
+    pub format: DataFormat,
+    pub offset: ::std::os::raw::c_ulonglong,
+    pub priority: AssetPriority,
+}
+impl Default for FileTexture {
+    fn default() -> Self {
+        unsafe { ::std::mem::zeroed() }
+    }
+}
+#[repr(u32)]
+#[derive(Debug, Copy, Clone, Hash, PartialEq, Eq)]
+pub enum FramePass {
+    FRAME_PASS_SKINNING = 0,
+    FRAME_PASS_CULLING = 1,
+    FRAME_PASS_DEPTH = 2,
+    FRAME_PASS_SHADOWS = 3,
+    FRAME_PASS_LIGHTING = 4,
+    FRAME_PASS_3D = 5,
+    FRAME_PASS_UPSCALE = 6,
+    FRAME_PASS_2D = 7,
+    FRAME_PASS_COUNT = 8,
+}
+#[repr(C)]
+#[derive(Debug, Default, Copy, Clone)]
+pub struct PipelineStatistics {
+    pub vertex_invocations: ::std::os::raw::c_ulonglong,
+    pub fragment_invocations: ::std::os::raw::c_ulonglong,
+    pub clipper_invocations: ::std::os::raw::c_ulonglong,
+    pub clipper_primitives_out: ::std::os::raw::c_ulonglong,
+}
+#[repr(C)]
+#[derive(Debug, Default, Copy, Clone)]
+pub struct FrameStats {
+    pub pass_ms: [f32; 8usize],
+    pub frame_ms: f32,
+    pub uploads_ms: f32,
+    pub draws: ::std::os::raw::c_uint,
+    pub instances: ::std::os::raw::c_uint,
+    pub triangles: ::std::os::raw::c_uint,
+    pub quality_level: ::std::os::raw::c_uint,
+    pub has_statistics: ::std::os::raw::c_uint,
+    pub pass_statistics: [PipelineStatistics; 8usize],
+    pub statistics: PipelineStatistics,
+}
+#[repr(C)]
+#[derive(Debug, Default, Copy, Clone)]
+pub struct MeshCost {
+    pub mesh: ::std::os::raw::c_uint,
+    pub instances: ::std::os::raw::c_uint,
+    pub triangles: ::std::os::raw::c_uint,
+    pub gpu_ms: f32,
+}
+#[repr(C)]
+#[derive(Debug, Default, Copy, Clone)]
+pub struct MeshCostStats {
+    pub timed: ::std::os::raw::c_uint,
+    pub meshes: ::std::os::raw::c_uint,
+    pub count: ::std::os::raw::c_uint,
+    pub total_ms: f32,
+    pub costs: [MeshCost; 16usize],
+}
+#[repr(C)]
+#[derive(Debug, Copy, Clone)]
+pub struct FramePacingStats {
+    pub refresh_ms: f32,
+    pub mean_ms: f32,
+    pub p50_ms: f32,
+    pub p95_ms: f32,
+    pub p99_ms: f32,
+    pub max_ms: f32,
+    pub presented: ::std::os::raw::c_ulonglong,
+    pub dropped: ::std::os::raw::c_ulonglong,
+    pub missed_vsyncs: ::std::os::raw::c_ulonglong,
+    pub hitches: ::std::os::raw::c_ulonglong,
+    pub last_hitch_frame: ::std::os::raw::c_ulonglong,
+    pub last_hitch_ms: f32,
+    pub histogram: [::std::os::raw::c_uint; 64usize],
+}
+pub type ReadbackCallback = ::std::option::Option<
+    unsafe extern "C" fn(
+        user_data: *mut ::std::os::raw::c_void,
+        pixels: *const ::std::os::raw::c_uchar,
+        width: ::std::os::raw::c_uint,
+        height: ::std::os::raw::c_uint,
+        bytes_per_row: ::std::os::raw::c_uint,
+    ),
+>;
+#[repr(u32)]
+#[derive(Debug, Copy, Clone, Hash, PartialEq, Eq)]
+pub enum VideoCodec {
+    VIDEO_CODEC_H264 = 0,
+    VIDEO_CODEC_HEVC = 1,
+}
+#[repr(C)]
+#[derive(Debug, Copy, Clone)]
+pub struct VideoStreamSettings {
+    pub codec: VideoCodec,
+    pub bitrate_kbps: ::std::os::raw::c_uint,
+    pub frame_rate: ::std::os::raw::c_uint,
+    pub keyframe_interval: ::std::os::raw::c_uint,
+}
+pub type VideoPacketCallback = ::std::option::Option<
+    unsafe extern "C" fn(
+        user_data: *mut ::std::os::raw::c_void,
+        data: *const ::std::os::raw::c_uchar,
+        size: ::std::os::raw::c_uint,
+        timestamp_us: ::std::os::raw::c_ulonglong,
+        keyframe: ::std::os::raw::c_uint,
+    ),
+>;
+#[repr(C)]
+#[derive(Debug, Default, Copy, Clone)]
+pub struct PickResult {
+    pub x: ::std::os::raw::c_uint,
+    pub y: ::std::os::raw::c_uint,
+    pub mesh: ::std::os::raw::c_uint,
+    pub instance: ::std::os::raw::c_uint,
+}
+pub type PickCallback = ::std::option::Option<
+    unsafe extern "C" fn(
+        user_data: *mut ::std::os::raw::c_void,
+        results: *const PickResult,
+        count: ::std::os::raw::c_uint,
+    ),
+>;
+#[repr(C)]
+#[derive(Debug, Default, Copy, Clone)]
+pub struct RayHit {
+    pub distance: f32,
+    pub mesh: ::std::os::raw::c_uint,
+    pub instance: ::std::os::raw::c_uint,
+    pub primitive: ::std::os::raw::c_uint,
+    pub u: f32,
+    pub v: f32,
+}
+pub type RayQueryCallback = ::std::option::Option<
+    unsafe extern "C" fn(
+        user_data: *mut ::std::os::raw::c_void,
+        hits: *const RayHit,
+        count: ::std::os::raw::c_uint,
+    ),
+>;
+#[repr(C)]
+#[repr(align(16))]
+#[derive(Debug, Default, Copy, Clone)]
+pub struct PvsSettings {
+    pub bounds: Aabb,
+    pub cell_size: f32,
+    pub rays_per_cell: ::std::os::raw::c_uint,
+    pub rays_per_frame: ::std::os::raw::c_uint,
+}
+#[repr(C)]
+#[repr(align(16))]
+#[derive(Debug, Copy, Clone)]
+pub struct PvsData {
+    pub bounds: Aabb,
+    pub cell_size: f32,
+    pub cells_x: ::std::os::raw::c_uint,
+    pub cells_y: ::std::os::raw::c_uint,
+    pub cells_z: ::std::os::raw::c_uint,
+    pub meshes: *const ::std::os::raw::c_uint,
+    pub num_meshes: ::std::os::raw::c_uint,
+    pub bits: *const ::std::os::raw::c_uint,
+}
+impl Default for PvsData {
+    fn default() -> Self {
+        unsafe { ::std::mem::zeroed() }
+    }
+}
+pub type PvsCallback = ::std::option::Option<
+    unsafe extern "C" fn(user_data: *mut ::std::os::raw::c_void, pvs: *const PvsData),
+>;
+#[repr(u32)]
+#[derive(Debug, Copy, Clone, Hash, PartialEq, Eq)]
+pub enum MemoryCategory {
+    MEMORY_VERTICES = 0,
+    MEMORY_INSTANCES = 1,
+    MEMORY_TEXTURES = 2,
+    MEMORY_ARGUMENTS = 3,
+    MEMORY_TARGETS = 4,
+    MEMORY_STAGING = 5,
+    MEMORY_CATEGORY_COUNT = 6,
+}
+#[repr(C)]
+#[derive(Debug, Default, Copy, Clone)]
+pub struct MemoryStats {
+    pub bytes: [::std::os::raw::c_ulonglong; 6usize],
+    pub unused_vertex_bytes: ::std::os::raw::c_ulonglong,
+    pub unused_instance_bytes: ::std::os::raw::c_ulonglong,
+    pub allocated: ::std::os::raw::c_ulonglong,
+    pub recommended_working_set: ::std::os::raw::c_ulonglong,
+    pub budget: ::std::os::raw::c_ulonglong,
+    pub evicted_meshes: ::std::os::raw::c_uint,
+    pub evicted_textures: ::std::os::raw::c_uint,
+    pub cached: ::std::os::raw::c_ulonglong,
+    pub instance_holes: ::std::os::raw::c_uint,
+}
+#[repr(C)]
+#[derive(Debug, Default, Copy, Clone)]
+pub struct PathTracerProgress {
+    pub samples: ::std::os::raw::c_uint,
+    pub tiles: ::std::os::raw::c_uint,
+    pub active_tiles: ::std::os::raw::c_uint,
+    pub seconds: f32,
+    pub finished: ::std::os::raw::c_uint,
+}
+#[repr(C)]
+#[derive(Debug, Default, Copy, Clone)]
+pub struct MemoryPolicy {
+    pub budget_megabytes: ::std::os::raw::c_uint,
+    pub mesh_idle_frames: ::std::os::raw::c_uint,
+    pub evict_textures: ::std::os::raw::c_uint,
+}
+#[repr(C)]
+#[derive(Debug, Copy, Clone)]
+pub struct StreamingCell {
+    pub bounds: Aabb,
+    pub priority: f32,
+    pub mesh_ids: *const ::std::os::raw::c_uint,
+    pub meshes: *const MeshData3D,
+    pub num_meshes: ::std::os::raw::c_uint,
+    pub texture_slots: *const ::std::os::raw::c_uint,
+    pub textures: *const TextureData,
+    pub num_textures: ::std::os::raw::c_uint,
+}
+impl Default for StreamingCell {
+    fn default() -> Self {
+        unsafe { ::std::mem::zeroed() }
+    }
+}
+#[repr(C)]
+#[derive(Debug, Default, Copy, Clone)]
+pub struct StreamingSettings {
+    pub load_radius: f32,
+    pub unload_radius: f32,
+    pub prefetch_seconds: f32,
+    pub upload_megabytes: ::std::os::raw::c_uint,
+}
+#[repr(C)]
+#[derive(Debug, Default, Copy, Clone)]
+pub struct UploadBudget {
+    pub megabytes_per_frame: ::std::os::raw::c_uint,
+    pub microseconds_per_frame: ::std::os::raw::c_uint,
+}
+pub type MeshEvictionCallback = ::std::option::Option<
+    unsafe extern "C" fn(
+        user_data: *mut ::std::os::raw::c_void,
+        mesh_ids: *const ::std::os::raw::c_uint,
+        count: ::std::os::raw::c_uint,
+    ),
+>;
+pub type PipelinesReadyCallback =
+    ::std::option::Option<unsafe extern "C" fn(user_data: *mut ::std::os::raw::c_void)>;
+pub type CellStreamingCallback = ::std::option::Option<
+    unsafe extern "C" fn(
+        user_data: *mut ::std::os::raw::c_void,
+        cell: ::std::os::raw::c_uint,
+        loaded: ::std::os::raw::c_uint,
+    ),
+>;
+#[repr(C)]
+#[derive(Debug, Default, Copy, Clone)]
+pub struct InsetView3D {
+    pub view: CameraView3D,
+    pub x: f32,
+    pub y: f32,
+    pub width: f32,
+    pub height: f32,
+}
+#[repr(u32)]
+#[derive(Debug, Copy, Clone, Hash, PartialEq, Eq)]
+pub enum RenderTextureUpdate {
+    RENDER_TEXTURE_EVERY_FRAME = 0,
+    RENDER_TEXTURE_INTERVAL = 1,
+    RENDER_TEXTURE_ON_DEMAND = 2,
+}
+#[repr(C)]
+#[derive(Debug, Copy, Clone)]
+pub struct RenderTexture {
+    pub view: CameraView3D,
+    pub width: ::std::os::raw::c_uint,
+    pub height: ::std::os::raw::c_uint,
+    pub update: RenderTextureUpdate,
+    pub interval: ::std::os::raw::c_uint,
+}
+impl Default for RenderTexture {
+    fn default() -> Self {
+        unsafe { ::std::mem::zeroed() }
+    }
+}
+#[repr(C)]
+#[derive(Copy, Clone)]
+pub struct DeviceInfo {
+    pub name: [::std::os::raw::c_char; 128usize],
+    pub registry_id: ::std::os::raw::c_ulonglong,
+    pub recommended_working_set: ::std::os::raw::c_ulonglong,
+    pub peer_group_id: ::std::os::raw::c_ulonglong,
+    pub peer_index: ::std::os::raw::c_uint,
+    pub peer_count: ::std::os::raw::c_uint,
+    pub low_power: ::std::os::raw::c_uint,
+    pub removable: ::std::os::raw::c_uint,
+}
+#[repr(u32)]
+#[derive(Debug, Copy, Clone, Hash, PartialEq, Eq)]
+pub enum DevicePreference {
+    DEVICE_DEFAULT = 0,
+    DEVICE_DISCRETE = 1,
+    DEVICE_LOW_POWER = 2,
+    DEVICE_REMOVABLE = 3,
+    DEVICE_LARGEST_WORKING_SET = 4,
+    DEVICE_DISPLAY = 5,
+}
+#[repr(u32)]
+#[derive(Debug, Copy, Clone, Hash, PartialEq, Eq)]
+pub enum DeviceStatus {
+    DEVICE_OK = 0,
+    DEVICE_NOT_DISPLAYING = 1,
+    DEVICE_REMOVAL_REQUESTED = 2,
+    DEVICE_REMOVED = 3,
+}
+#[repr(u32)]
+#[derive(Debug, Copy, Clone, Hash, PartialEq, Eq)]
+pub enum TraceFormat {
+    TRACE_CHROME_JSON = 0,
+    TRACE_PERFETTO = 1,
+}
+extern "C" {
+    pub fn create_instance(
+        ns_window: *mut ::std::os::raw::c_void,
+        ns_view: *mut ::std::os::raw::c_void,
+        width: ::std::os::raw::c_uint,
+        height: ::std::os::raw::c_uint,
+        scale: f64,
+    ) -> *mut ::std::os::raw::c_void;
+}
+extern "C" {
+    pub fn create_instance_with_pipeline_cache(
+        ns_window: *mut ::std::os::raw::c_void,
+        ns_view: *mut ::std::os::raw::c_void,
+        width: ::std::os::raw::c_uint,
+        height: ::std::os::raw::c_uint,
+        scale: f64,
+        pipeline_cache: *const ::std::os::raw::c_char,
+    ) -> *mut ::std::os::raw::c_void;
+}
+extern "C" {
+    pub fn create_instance_with_device(
+        ns_window: *mut ::std::os::raw::c_void,
+        ns_view: *mut ::std::os::raw::c_void,
+        width: ::std::os::raw::c_uint,
+        height: ::std::os::raw::c_uint,
+        scale: f64,
+        pipeline_cache: *const ::std::os::raw::c_char,
+        preference: DevicePreference,
+    ) -> *mut ::std::os::raw::c_void;
+}
+extern "C" {
+    pub fn get_device_count() -> ::std::os::raw::c_uint;
+}
+extern "C" {
+    pub fn get_device_info(
+        device_index: ::std::os::raw::c_uint,
+        info: *mut DeviceInfo,
+    ) -> ::std::os::raw::c_uint;
+}
+extern "C" {
+    pub fn create_instance_on_device(
+        device_index: ::std::os::raw::c_uint,
+        ns_window: *mut ::std::os::raw::c_void,
+        ns_view: *mut ::std::os::raw::c_void,
+        width: ::std::os::raw::c_uint,
+        height: ::std::os::raw::c_uint,
+        scale: f64,
+        pipeline_cache: *const ::std::os::raw::c_char,
+    ) -> *mut ::std::os::raw::c_void;
+}
+extern "C" {
+    pub fn create_instance_in_view(
+        ui_view: *mut ::std::os::raw::c_void,
+        width: ::std::os::raw::c_uint,
+        height: ::std::os::raw::c_uint,
+        scale: f64,
+        pipeline_cache: *const ::std::os::raw::c_char,
+    ) -> *mut ::std::os::raw::c_void;
+}
+extern "C" {
+    pub fn destroy_instance(instance: *mut ::std::os::raw::c_void);
+}
+extern "C" {
+    pub fn get_device_status(instance: *mut ::std::os::raw::c_void) -> DeviceStatus;
+}
+extern "C" {
+    pub fn set_2d_mesh(
+        instance: *mut ::std::os::raw::c_void,
+        id: ::std::os::raw::c_uint,
+        data: MeshData2D,
+    );
+}
+extern "C" {
+    pub fn set_2d_instances(
+        instance: *mut ::std::os::raw::c_void,
+        id: ::std::os::raw::c_uint,
+        data: InstancesData2D,
+    );
+}
+extern "C" {
+    pub fn set_2d_instances_batch(
+        instance: *mut ::std::os::raw::c_void,
+        ids: *const ::std::os::raw::c_uint,
+        data: *const InstancesData2D,
+        count: ::std::os::raw::c_uint,
+    );
+}
+extern "C" {
+    pub fn set_glyph_atlas(
+        instance: *mut ::std::os::raw::c_void,
+        width: ::std::os::raw::c_uint,
+        height: ::std::os::raw::c_uint,
+    );
+}
+extern "C" {
+    pub fn update_glyph_atlas(
+        instance: *mut ::std::os::raw::c_void,
+        x: ::std::os::raw::c_uint,
+        y: ::std::os::raw::c_uint,
+        width: ::std::os::raw::c_uint,
+        height: ::std::os::raw::c_uint,
+        pixels: *const ::std::os::raw::c_uchar,
+        bytes_per_row: ::std::os::raw::c_uint,
+    );
+}
+extern "C" {
+    pub fn set_glyphs(
+        instance: *mut ::std::os::raw::c_void,
+        id: ::std::os::raw::c_uint,
+        glyphs: *const GlyphInstance,
+        count: ::std::os::raw::c_uint,
+    );
+}
+extern "C" {
+    pub fn set_sprites(
+        instance: *mut ::std::os::raw::c_void,
+        id: ::std::os::raw::c_uint,
+        sprites: *const SpriteInstance,
+        count: ::std::os::raw::c_uint,
+    );
+}
+extern "C" {
+    pub fn set_2d_caching(instance: *mut ::std::os::raw::c_void, enabled: ::std::os::raw::c_uint);
+}
+extern "C" {
+    pub fn set_2d_clip(
+        instance: *mut ::std::os::raw::c_void,
+        id: ::std::os::raw::c_uint,
+        rect: ClipRect2D,
+    );
+}
+extern "C" {
+    pub fn remove_2d_clip(instance: *mut ::std::os::raw::c_void, id: ::std::os::raw::c_uint);
+}
+extern "C" {
+    pub fn set_2d_path(
+        instance: *mut ::std::os::raw::c_void,
+        id: ::std::os::raw::c_uint,
+        path: PathData2D,
+    );
+}
+extern "C" {
+    pub fn set_2d_path_transform(
+        instance: *mut ::std::os::raw::c_void,
+        id: ::std::os::raw::c_uint,
+        transform: simd_float4x4,
+    );
+}
+extern "C" {
+    pub fn set_3d_mesh(
+        instance: *mut ::std::os::raw::c_void,
+        id: ::std::os::raw::c_uint,
+        data: MeshData3D,
+    );
+}
+extern "C" {
+    pub fn encode_3d_vertices(
+        vertices: *const Vertex3D,
+        num_vertices: ::std::os::raw::c_uint,
+        out: *mut ::std::os::raw::c_uchar,
+        capacity: size_t,
+    ) -> size_t;
+}
+extern "C" {
+    pub fn encode_3d_indices(
+        indices: *const ::std::os::raw::c_uint,
+        num_indices: ::std::os::raw::c_uint,
+        out: *mut ::std::os::raw::c_uchar,
+        capacity: size_t,
+    ) -> size_t;
+}
+extern "C" {
+    pub fn encoded_3d_vertices_bound(num_vertices: ::std::os::raw::c_uint) -> size_t;
+}
+extern "C" {
+    pub fn encoded_3d_indices_bound(num_indices: ::std::os::raw::c_uint) -> size_t;
+}
+extern "C" {
+    pub fn set_3d_mesh_encoded(
+        instance: *mut ::std::os::raw::c_void,
+        id: ::std::os::raw::c_uint,
+        data: MeshData3D,
+        encoded: EncodedMesh3D,
+    ) -> ::std::os::raw::c_uint;
+}
+extern "C" {
+    pub fn unload_3d_meshes(
+        instance: *mut ::std::os::raw::c_void,
+        ids: *const size_t,
+        num: ::std::os::raw::c_uint,
+    );
+}
+extern "C" {
+    pub fn restore_3d_mesh(
+        instance: *mut ::std::os::raw::c_void,
+        id: ::std::os::raw::c_uint,
+    ) -> ::std::os::raw::c_uint;
+}
+extern "C" {
+    pub fn set_3d_instances(
+        instance: *mut ::std::os::raw::c_void,
+        id: ::std::os::raw::c_uint,
+        data: InstancesData3D,
+    );
+}
+extern "C" {
+    pub fn set_3d_meshes_batch(
+        instance: *mut ::std::os::raw::c_void,
+        ids: *const ::std::os::raw::c_uint,
+        data: *const MeshData3D,
+        count: ::std::os::raw::c_uint,
+    );
+}
+extern "C" {
+    pub fn set_3d_instances_batch(
+        instance: *mut ::std::os::raw::c_void,
+        ids: *const ::std::os::raw::c_uint,
+        data: *const InstancesData3D,
+        count: ::std::os::raw::c_uint,
+    );
+}
+extern "C" {
+    pub fn set_3d_mesh_lods(
+        instance: *mut ::std::os::raw::c_void,
+        id: ::std::os::raw::c_uint,
+        levels: *const MeshLod,
+        num_levels: ::std::os::raw::c_uint,
+    );
+}
+extern "C" {
+    pub fn set_3d_prefab(
+        instance: *mut ::std::os::raw::c_void,
+        meshes: *const PrefabMesh3D,
+        count: ::std::os::raw::c_uint,
+    );
+}
+extern "C" {
+    pub fn set_3d_instance_animation(
+        instance: *mut ::std::os::raw::c_void,
+        id: ::std::os::raw::c_uint,
+        animation: InstanceAnimation3D,
+    );
+}
+extern "C" {
+    pub fn set_3d_hierarchy(
+        instance: *mut ::std::os::raw::c_void,
+        nodes: *const TransformNode,
+        num_nodes: ::std::os::raw::c_uint,
+    );
+}
+extern "C" {
+    pub fn update_3d_hierarchy(
+        instance: *mut ::std::os::raw::c_void,
+        nodes: *const ::std::os::raw::c_uint,
+        locals: *const simd_float4x4,
+        count: ::std::os::raw::c_uint,
+    );
+}
+extern "C" {
+    pub fn set_terrain(
+        instance: *mut ::std::os::raw::c_void,
+        id: ::std::os::raw::c_uint,
+        terrain: TerrainData,
+    );
+}
+extern "C" {
+    pub fn set_3d_scatter(
+        instance: *mut ::std::os::raw::c_void,
+        id: ::std::os::raw::c_uint,
+        scatter: ScatterData,
+    );
+}
+extern "C" {
+    pub fn bake_3d_impostor(
+        instance: *mut ::std::os::raw::c_void,
+        id: ::std::os::raw::c_uint,
+        settings: ImpostorSettings,
+    );
+}
+extern "C" {
+    pub fn set_particle_emitter(
+        instance: *mut ::std::os::raw::c_void,
+        id: ::std::os::raw::c_uint,
+        emitter: ParticleEmitter,
+        capacity: ::std::os::raw::c_uint,
+    );
+}
+extern "C" {
+    pub fn emit_particles(
+        instance: *mut ::std::os::raw::c_void,
+        id: ::std::os::raw::c_uint,
+        count: ::std::os::raw::c_uint,
+    );
+}
+extern "C" {
+    pub fn set_point_cloud(
+        instance: *mut ::std::os::raw::c_void,
+        id: ::std::os::raw::c_uint,
+        data: PointCloudData,
+    ) -> ::std::os::raw::c_uint;
+}
+extern "C" {
+    pub fn set_point_cloud_transform(
+        instance: *mut ::std::os::raw::c_void,
+        id: ::std::os::raw::c_uint,
+        transform: simd_float4x4,
+    );
+}
+extern "C" {
+    pub fn set_3d_instance_overrides(
+        instance: *mut ::std::os::raw::c_void,
+        id: ::std::os::raw::c_uint,
+        overrides: *const InstanceOverride,
+        count: ::std::os::raw::c_uint,
+    );
+}
+extern "C" {
+    pub fn set_animation_time(instance: *mut ::std::os::raw::c_void, seconds: f32);
+}
+extern "C" {
+    pub fn map_3d_mesh(
+        instance: *mut ::std::os::raw::c_void,
+        id: ::std::os::raw::c_uint,
+        num_vertices: ::std::os::raw::c_uint,
+    ) -> *mut Vertex3D;
+}
+extern "C" {
+    pub fn map_3d_instances(
+        instance: *mut ::std::os::raw::c_void,
+        id: ::std::os::raw::c_uint,
+        count: ::std::os::raw::c_uint,
+    ) -> *mut simd_float4x4;
+}
+extern "C" {
+    pub fn mark_3d_instances_changed(
+        instance: *mut ::std::os::raw::c_void,
+        id: ::std::os::raw::c_uint,
+        first: ::std::os::raw::c_uint,
+        last: ::std::os::raw::c_uint,
+    );
+}
+extern "C" {
+    pub fn map_texture(
+        instance: *mut ::std::os::raw::c_void,
+        index: ::std::os::raw::c_uint,
+        data: TextureData,
+    ) -> *mut ::std::os::raw::c_void;
+}
+extern "C" {
+    pub fn commit_texture(instance: *mut ::std::os::raw::c_void, index: ::std::os::raw::c_uint);
+}
+extern "C" {
+    pub fn set_skins(
+        instance: *mut ::std::os::raw::c_void,
+        skins: *const SkinData,
+        num_skins: ::std::os::raw::c_uint,
+        changed: *const size_t,
+        num_changed: ::std::os::raw::c_uint,
+    );
+}
+extern "C" {
+    pub fn set_3d_morph_targets(
+        instance: *mut ::std::os::raw::c_void,
+        id: ::std::os::raw::c_uint,
+        targets: *const MorphTargetData,
+        num_targets: ::std::os::raw::c_uint,
+    );
+}
+extern "C" {
+    pub fn set_3d_morph_weights(
+        instance: *mut ::std::os::raw::c_void,
+        id: ::std::os::raw::c_uint,
+        weights: *const f32,
+        num_instances: ::std::os::raw::c_uint,
+    );
+}
+extern "C" {
+    pub fn set_animation_clip(
+        instance: *mut ::std::os::raw::c_void,
+        id: ::std::os::raw::c_uint,
+        channels: *const AnimationChannel,
+        num_channels: ::std::os::raw::c_uint,
+    );
+}
+extern "C" {
+    pub fn set_skeleton(
+        instance: *mut ::std::os::raw::c_void,
+        id: ::std::os::raw::c_uint,
+        skeleton: SkeletonData,
+    );
+}
+extern "C" {
+    pub fn set_skin_animation(
+        instance: *mut ::std::os::raw::c_void,
+        skin: ::std::os::raw::c_uint,
+        skeleton: ::std::os::raw::c_uint,
+        layers: *const AnimationLayer,
+        num_layers: ::std::os::raw::c_uint,
+    );
+}
+extern "C" {
+    pub fn set_point_lights(
+        instance: *mut ::std::os::raw::c_void,
+        lights: *const PointLight,
+        num_lights: ::std::os::raw::c_uint,
+    );
+}
+extern "C" {
+    pub fn set_spot_lights(
+        instance: *mut ::std::os::raw::c_void,
+        lights: *const SpotLight,
+        num_lights: ::std::os::raw::c_uint,
+    );
+}
+extern "C" {
+    pub fn set_area_lights(
+        instance: *mut ::std::os::raw::c_void,
+        lights: *const AreaLight,
+        num_lights: ::std::os::raw::c_uint,
+    );
+}
+extern "C" {
+    pub fn set_directional_lights(
+        instance: *mut ::std::os::raw::c_void,
+        lights: *const DirectionalLight,
+        num_lights: ::std::os::raw::c_uint,
+    );
+}
+extern "C" {
+    pub fn set_materials(
+        instance: *mut ::std::os::raw::c_void,
+        materials: *const DeviceMaterial,
+        num_materials: ::std::os::raw::c_uint,
+        changed: *const size_t,
+        num_changed: ::std::os::raw::c_uint,
+    );
+}
+extern "C" {
+    pub fn set_skybox(instance: *mut ::std::os::raw::c_void, skybox: TextureData);
+}
+extern "C" {
+    pub fn set_reflection_probes(
+        instance: *mut ::std::os::raw::c_void,
+        probes: *const ReflectionProbe,
+        count: ::std::os::raw::c_uint,
+    );
+}
+extern "C" {
+    pub fn set_reflection_probe_budget(
+        instance: *mut ::std::os::raw::c_void,
+        faces_per_frame: ::std::os::raw::c_uint,
+    );
+}
+extern "C" {
+    pub fn set_gi_volume(instance: *mut ::std::os::raw::c_void, volume: GiVolume);
+}
+extern "C" {
+    pub fn set_gi_ray_budget(
+        instance: *mut ::std::os::raw::c_void,
+        rays_per_frame: ::std::os::raw::c_uint,
+    );
+}
+extern "C" {
+    pub fn bake_lightmap(instance: *mut ::std::os::raw::c_void, settings: LightmapSettings);
+}
+extern "C" {
+    pub fn set_material_lightmap(
+        instance: *mut ::std::os::raw::c_void,
+        material: ::std::os::raw::c_uint,
+        texture: ::std::os::raw::c_uint,
+    );
+}
+extern "C" {
+    pub fn write_scene_cache(
+        path: *const ::std::os::raw::c_char,
+        data: SceneCacheData,
+    ) -> ::std::os::raw::c_uint;
+}
+extern "C" {
+    pub fn load_scene_cache(
+        instance: *mut ::std::os::raw::c_void,
+        path: *const ::std::os::raw::c_char,
+    ) -> ::std::os::raw::c_uint;
+}
+extern "C" {
+    pub fn write_asset_file(
+        path: *const ::std::os::raw::c_char,
+        bytes: *const ::std::os::raw::c_void,
+        size: ::std::os::raw::c_ulonglong,
+        compression: AssetCompression,
+        chunk_size: ::std::os::raw::c_ulonglong,
+    ) -> ::std::os::raw::c_uint;
+}
+extern "C" {
+    pub fn load_file_textures(
+        instance: *mut ::std::os::raw::c_void,
+        path: *const ::std::os::raw::c_char,
+        compression: AssetCompression,
+        indices: *const ::std::os::raw::c_uint,
+        textures: *const FileTexture,
+        count: ::std::os::raw::c_uint,
+    ) -> ::std::os::raw::c_uint;
+}
+extern "C" {
+    pub fn set_textures(
+        instance: *mut ::std::os::raw::c_void,
+        data: *const TextureData,
+        num_textures: ::std::os::raw::c_uint,
+        changed: *const size_t,
+        num_changed: ::std::os::raw::c_uint,
+    );
+}
+extern "C" {
+    pub fn create_command_recorder(instance: *mut ::std::os::raw::c_void) -> *mut ::std::os::raw::c_void;
+}
+extern "C" {
+    pub fn destroy_command_recorder(recorder: *mut ::std::os::raw::c_void);
+}
+extern "C" {
+    pub fn record_3d_mesh(recorder: *mut ::std::os::raw::c_void, id: ::std::os::raw::c_uint, data: MeshData3D);
+}
+extern "C" {
+    pub fn record_3d_instances(
+        recorder: *mut ::std::os::raw::c_void,
+        id: ::std::os::raw::c_uint,
+        data: InstancesData3D,
+    );
+}
+extern "C" {
+    pub fn record_materials(
+        recorder: *mut ::std::os::raw::c_void,
+        materials: *const DeviceMaterial,
+        num_materials: ::std::os::raw::c_uint,
+    );
+}
+extern "C" {
+    pub fn submit_command_recorder(recorder: *mut ::std::os::raw::c_void);
+}
+extern "C" {
+    pub fn render(
+        instance: *mut ::std::os::raw::c_void,
+        matrix_2d: simd_float4x4,
+        view_3d: CameraView3D,
+        mode: RenderMode3D,
+    ) -> FrameStatus;
+}
+extern "C" {
+    pub fn render_to_buffer(
+        instance: *mut ::std::os::raw::c_void,
+        matrix_2d: simd_float4x4,
+        view_3d: CameraView3D,
+        mode: RenderMode3D,
+        callback: ReadbackCallback,
+        user_data: *mut ::std::os::raw::c_void,
+    ) -> FrameStatus;
+}
+extern "C" {
+    pub fn pick(
+        instance: *mut ::std::os::raw::c_void,
+        pixels: *const ::std::os::raw::c_uint,
+        count: ::std::os::raw::c_uint,
+        callback: PickCallback,
+        user_data: *mut ::std::os::raw::c_void,
+    );
+}
+extern "C" {
+    pub fn start_video_stream(
+        instance: *mut ::std::os::raw::c_void,
+        settings: VideoStreamSettings,
+        callback: VideoPacketCallback,
+        user_data: *mut ::std::os::raw::c_void,
+    ) -> ::std::os::raw::c_uint;
+}
+extern "C" {
+    pub fn stop_video_stream(instance: *mut ::std::os::raw::c_void);
+}
+extern "C" {
+    pub fn request_video_keyframe(instance: *mut ::std::os::raw::c_void);
+}
+extern "C" {
+    pub fn trace_rays(
+        instance: *mut ::std::os::raw::c_void,
+        rays: *const RayQuery,
+        count: ::std::os::raw::c_uint,
+        any_hit: ::std::os::raw::c_uint,
+        callback: RayQueryCallback,
+        user_data: *mut ::std::os::raw::c_void,
+    ) -> ::std::os::raw::c_uint;
+}
+extern "C" {
+    pub fn set_visibility_group(
+        instance: *mut ::std::os::raw::c_void,
+        id: ::std::os::raw::c_uint,
+        bounds: Aabb,
+    );
+}
+extern "C" {
+    pub fn remove_visibility_group(
+        instance: *mut ::std::os::raw::c_void,
+        id: ::std::os::raw::c_uint,
+    );
+}
+extern "C" {
+    pub fn visibility_samples(
+        instance: *mut ::std::os::raw::c_void,
+        id: ::std::os::raw::c_uint,
+    ) -> ::std::os::raw::c_ulonglong;
+}
+extern "C" {
+    pub fn bake_pvs(
+        instance: *mut ::std::os::raw::c_void,
+        settings: PvsSettings,
+        callback: PvsCallback,
+        user_data: *mut ::std::os::raw::c_void,
+    ) -> ::std::os::raw::c_uint;
+}
+extern "C" {
+    pub fn set_pvs(instance: *mut ::std::os::raw::c_void, pvs: PvsData);
+}
+extern "C" {
+    pub fn debug_lines(
+        instance: *mut ::std::os::raw::c_void,
+        lines: *const DebugLine,
+        count: ::std::os::raw::c_uint,
+        depth_test: ::std::os::raw::c_uint,
+    );
+}
+extern "C" {
+    pub fn debug_line(
         instance: *mut ::std::os::raw::c_void,
-        data: *const TextureData,
-        num_textures: ::std::os::raw::c_uint,
-        changed: *const ::std::os::raw::c_uint,
+        start: Vector3,
+        end: Vector3,
+        color: ::std::os::raw::c_uint,
+        width: f32,
+        depth_test: ::std::os::raw::c_uint,
     );
 }
 extern "C" {
-    pub fn render(
+    pub fn debug_aabb(
         instance: *mut ::std::os::raw::c_void,
-        matrix_2d: simd_float4x4,
-        view_3d: CameraView3D,
+        bounds: Aabb,
+        color: ::std::os::raw::c_uint,
+        width: f32,
+        depth_test: ::std::os::raw::c_uint,
+    );
+}
+extern "C" {
+    pub fn debug_sphere(
+        instance: *mut ::std::os::raw::c_void,
+        center: Vector3,
+        radius: f32,
+        color: ::std::os::raw::c_uint,
+        width: f32,
+        depth_test: ::std::os::raw::c_uint,
     );
 }
 extern "C" {
     pub fn synchronize(instance: *mut ::std::os::raw::c_void);
 }
+extern "C" {
+    pub fn synchronize_async(instance: *mut ::std::os::raw::c_void);
+}
+extern "C" {
+    pub fn wait_for_synchronize(instance: *mut ::std::os::raw::c_void);
+}
 extern "C" {
     pub fn resize(
         instance: *mut ::std::os::raw::c_void,
@@ -5513,6 +7798,412 @@ extern "C" {
         scale_factor: f64,
     );
 }
+extern "C" {
+    pub fn add_surface(
+        instance: *mut ::std::os::raw::c_void,
+        ns_window: *mut ::std::os::raw::c_void,
+        width: ::std::os::raw::c_uint,
+        height: ::std::os::raw::c_uint,
+        scale_factor: f64,
+    ) -> ::std::os::raw::c_uint;
+}
+extern "C" {
+    pub fn remove_surface(instance: *mut ::std::os::raw::c_void, surface: ::std::os::raw::c_uint);
+}
+extern "C" {
+    pub fn select_surface(
+        instance: *mut ::std::os::raw::c_void,
+        surface: ::std::os::raw::c_uint,
+    ) -> ::std::os::raw::c_uint;
+}
+extern "C" {
+    pub fn set_frames_in_flight(
+        instance: *mut ::std::os::raw::c_void,
+        count: ::std::os::raw::c_uint,
+    );
+}
+extern "C" {
+    pub fn set_vertex_compaction_budget(
+        instance: *mut ::std::os::raw::c_void,
+        bytes_per_frame: ::std::os::raw::c_uint,
+    );
+}
+extern "C" {
+    pub fn set_mesh_welding(
+        instance: *mut ::std::os::raw::c_void,
+        enabled: ::std::os::raw::c_uint,
+    );
+}
+extern "C" {
+    pub fn set_static_batching(instance: *mut ::std::os::raw::c_void, batching: StaticBatching);
+}
+extern "C" {
+    pub fn set_copy_on_submit(instance: *mut ::std::os::raw::c_void, enabled: ::std::os::raw::c_uint);
+}
+extern "C" {
+    pub fn set_upload_budget(instance: *mut ::std::os::raw::c_void, budget: UploadBudget);
+}
+extern "C" {
+    pub fn pending_uploads(instance: *mut ::std::os::raw::c_void) -> ::std::os::raw::c_uint;
+}
+extern "C" {
+    pub fn set_3d_vertex_format(instance: *mut ::std::os::raw::c_void, format: VertexFormat3D);
+}
+extern "C" {
+    pub fn set_gpu_culling(instance: *mut ::std::os::raw::c_void, enabled: ::std::os::raw::c_uint);
+}
+extern "C" {
+    pub fn set_async_compute(instance: *mut ::std::os::raw::c_void, enabled: ::std::os::raw::c_uint);
+}
+extern "C" {
+    pub fn set_gpu_driven_draws(instance: *mut ::std::os::raw::c_void, enabled: ::std::os::raw::c_uint);
+}
+extern "C" {
+    pub fn set_private_geometry(instance: *mut ::std::os::raw::c_void, enabled: ::std::os::raw::c_uint);
+}
+extern "C" {
+    pub fn set_position_stream(instance: *mut ::std::os::raw::c_void, enabled: ::std::os::raw::c_uint);
+}
+extern "C" {
+    pub fn set_texture_packing(
+        instance: *mut ::std::os::raw::c_void,
+        max_size: ::std::os::raw::c_uint,
+    );
+}
+extern "C" {
+    pub fn set_gpu_mipmaps(instance: *mut ::std::os::raw::c_void, enabled: ::std::os::raw::c_uint);
+}
+extern "C" {
+    pub fn set_texture_transcoding(instance: *mut ::std::os::raw::c_void, enabled: ::std::os::raw::c_uint);
+}
+extern "C" {
+    pub fn set_lossy_textures(instance: *mut ::std::os::raw::c_void, enabled: ::std::os::raw::c_uint);
+}
+extern "C" {
+    pub fn set_video_frame(
+        instance: *mut ::std::os::raw::c_void,
+        index: ::std::os::raw::c_uint,
+        pixel_buffer: *mut ::std::os::raw::c_void,
+    ) -> ::std::os::raw::c_uint;
+}
+extern "C" {
+    pub fn set_video_surface(
+        instance: *mut ::std::os::raw::c_void,
+        index: ::std::os::raw::c_uint,
+        io_surface: *mut ::std::os::raw::c_void,
+    ) -> ::std::os::raw::c_uint;
+}
+extern "C" {
+    pub fn set_texture_budget(instance: *mut ::std::os::raw::c_void, megabytes: ::std::os::raw::c_uint);
+}
+extern "C" {
+    pub fn set_virtual_texture(
+        instance: *mut ::std::os::raw::c_void,
+        index: ::std::os::raw::c_uint,
+        data: TextureData,
+    ) -> ::std::os::raw::c_uint;
+}
+extern "C" {
+    pub fn set_virtual_texture_budget(
+        instance: *mut ::std::os::raw::c_void,
+        cache_megabytes: ::std::os::raw::c_uint,
+        upload_megabytes: ::std::os::raw::c_uint,
+    );
+}
+extern "C" {
+    pub fn set_depth_prepass(instance: *mut ::std::os::raw::c_void, enabled: ::std::os::raw::c_uint);
+}
+extern "C" {
+    pub fn set_visibility_buffer(
+        instance: *mut ::std::os::raw::c_void,
+        enabled: ::std::os::raw::c_uint,
+    );
+}
+extern "C" {
+    pub fn set_occlusion_culling(instance: *mut ::std::os::raw::c_void, enabled: ::std::os::raw::c_uint);
+}
+extern "C" {
+    pub fn set_cluster_culling(instance: *mut ::std::os::raw::c_void, enabled: ::std::os::raw::c_uint);
+}
+extern "C" {
+    pub fn set_shadow_distance(instance: *mut ::std::os::raw::c_void, distance: f32);
+}
+extern "C" {
+    pub fn set_unorm16_shadows(instance: *mut ::std::os::raw::c_void, enabled: ::std::os::raw::c_uint);
+}
+extern "C" {
+    pub fn set_encoding_threads(instance: *mut ::std::os::raw::c_void, count: ::std::os::raw::c_uint);
+}
+extern "C" {
+    pub fn set_ray_tracing(instance: *mut ::std::os::raw::c_void, enabled: ::std::os::raw::c_uint);
+}
+extern "C" {
+    pub fn set_path_tracer_denoiser(instance: *mut ::std::os::raw::c_void, enabled: ::std::os::raw::c_uint);
+}
+extern "C" {
+    pub fn set_path_tracer_convergence(
+        instance: *mut ::std::os::raw::c_void,
+        threshold: f32,
+        min_samples: ::std::os::raw::c_uint,
+        max_samples: ::std::os::raw::c_uint,
+        time_budget: f32,
+    );
+}
+extern "C" {
+    pub fn get_path_tracer_progress(instance: *mut ::std::os::raw::c_void, progress: *mut PathTracerProgress);
+}
+extern "C" {
+    pub fn set_ambient_occlusion_radius(instance: *mut ::std::os::raw::c_void, radius: f32);
+}
+extern "C" {
+    pub fn set_ssao(instance: *mut ::std::os::raw::c_void, enabled: ::std::os::raw::c_uint);
+}
+extern "C" {
+    pub fn set_reflections(instance: *mut ::std::os::raw::c_void, settings: ReflectionSettings);
+}
+extern "C" {
+    pub fn set_sdf_tracing(instance: *mut ::std::os::raw::c_void, settings: SdfSettings);
+}
+extern "C" {
+    pub fn set_msaa_samples(instance: *mut ::std::os::raw::c_void, samples: ::std::os::raw::c_uint);
+}
+extern "C" {
+    pub fn set_render_scale(instance: *mut ::std::os::raw::c_void, scale: f32);
+}
+extern "C" {
+    pub fn set_dynamic_resolution(
+        instance: *mut ::std::os::raw::c_void,
+        target_ms: f32,
+        min_scale: f32,
+        max_scale: f32,
+    );
+}
+extern "C" {
+    pub fn set_quality_governor(
+        instance: *mut ::std::os::raw::c_void,
+        enabled: ::std::os::raw::c_uint,
+    );
+}
+extern "C" {
+    pub fn set_texture_filtering(
+        instance: *mut ::std::os::raw::c_void,
+        sampler_3d: ::std::os::raw::c_uint,
+        sampler_2d: ::std::os::raw::c_uint,
+        max_anisotropy: ::std::os::raw::c_uint,
+    );
+}
+extern "C" {
+    pub fn set_hdr(instance: *mut ::std::os::raw::c_void, mode: HdrMode, exposure: f32);
+}
+extern "C" {
+    pub fn set_post_processing(
+        instance: *mut ::std::os::raw::c_void,
+        settings: PostProcessSettings,
+    );
+}
+extern "C" {
+    pub fn set_color_grading_lut(
+        instance: *mut ::std::os::raw::c_void,
+        texels: *const ::std::os::raw::c_uchar,
+        size: ::std::os::raw::c_uint,
+    );
+}
+extern "C" {
+    pub fn set_temporal_antialiasing(
+        instance: *mut ::std::os::raw::c_void,
+        enabled: ::std::os::raw::c_uint,
+    );
+}
+extern "C" {
+    pub fn set_present_mode(
+        instance: *mut ::std::os::raw::c_void,
+        mode: PresentMode,
+        min_frame_duration: f32,
+        low_latency: ::std::os::raw::c_uint,
+    );
+}
+extern "C" {
+    pub fn set_frame_timeout(instance: *mut ::std::os::raw::c_void, seconds: f32);
+}
+extern "C" {
+    pub fn set_on_demand_rendering(
+        instance: *mut ::std::os::raw::c_void,
+        enabled: ::std::os::raw::c_uint,
+        heartbeat: f32,
+    );
+}
+extern "C" {
+    pub fn request_redraw(instance: *mut ::std::os::raw::c_void);
+}
+extern "C" {
+    pub fn set_rasterization_rates(
+        instance: *mut ::std::os::raw::c_void,
+        horizontal: *const f32,
+        num_horizontal: ::std::os::raw::c_uint,
+        vertical: *const f32,
+        num_vertical: ::std::os::raw::c_uint,
+    );
+}
+extern "C" {
+    pub fn set_inset_views(
+        instance: *mut ::std::os::raw::c_void,
+        views: *const InsetView3D,
+        count: ::std::os::raw::c_uint,
+    );
+}
+extern "C" {
+    pub fn set_render_texture(
+        instance: *mut ::std::os::raw::c_void,
+        index: ::std::os::raw::c_uint,
+        texture: RenderTexture,
+    );
+}
+extern "C" {
+    pub fn request_render_texture(
+        instance: *mut ::std::os::raw::c_void,
+        index: ::std::os::raw::c_uint,
+    );
+}
+extern "C" {
+    pub fn set_render_texture_budget(
+        instance: *mut ::std::os::raw::c_void,
+        pixels_per_frame: ::std::os::raw::c_uint,
+    );
+}
+extern "C" {
+    pub fn pipelines_ready(instance: *mut ::std::os::raw::c_void) -> ::std::os::raw::c_uint;
+}
+extern "C" {
+    pub fn wait_for_pipelines(instance: *mut ::std::os::raw::c_void);
+}
+extern "C" {
+    pub fn notify_pipelines_ready(
+        instance: *mut ::std::os::raw::c_void,
+        callback: PipelinesReadyCallback,
+        user_data: *mut ::std::os::raw::c_void,
+    );
+}
+extern "C" {
+    pub fn get_frame_stats(instance: *mut ::std::os::raw::c_void, stats: *mut FrameStats);
+}
+extern "C" {
+    pub fn get_submitted_frame(instance: *mut ::std::os::raw::c_void) -> ::std::os::raw::c_ulonglong;
+}
+extern "C" {
+    pub fn get_completed_frame(instance: *mut ::std::os::raw::c_void) -> ::std::os::raw::c_ulonglong;
+}
+extern "C" {
+    pub fn wait_for_frame(
+        instance: *mut ::std::os::raw::c_void,
+        frame: ::std::os::raw::c_ulonglong,
+        timeout_ms: ::std::os::raw::c_uint,
+    ) -> ::std::os::raw::c_uint;
+}
+extern "C" {
+    pub fn get_memory_stats(instance: *mut ::std::os::raw::c_void, stats: *mut MemoryStats);
+}
+extern "C" {
+    pub fn set_memory_policy(
+        instance: *mut ::std::os::raw::c_void,
+        policy: MemoryPolicy,
+        callback: MeshEvictionCallback,
+        user_data: *mut ::std::os::raw::c_void,
+    );
+}
+extern "C" {
+    pub fn set_resource_cache(instance: *mut ::std::os::raw::c_void, megabytes: ::std::os::raw::c_uint);
+}
+extern "C" {
+    pub fn set_cell_streaming(
+        instance: *mut ::std::os::raw::c_void,
+        settings: StreamingSettings,
+        callback: CellStreamingCallback,
+        user_data: *mut ::std::os::raw::c_void,
+    );
+}
+extern "C" {
+    pub fn set_streaming_cell(
+        instance: *mut ::std::os::raw::c_void,
+        id: ::std::os::raw::c_uint,
+        cell: StreamingCell,
+    );
+}
+extern "C" {
+    pub fn remove_streaming_cell(instance: *mut ::std::os::raw::c_void, id: ::std::os::raw::c_uint);
+}
+extern "C" {
+    pub fn streaming_cell_loaded(
+        instance: *mut ::std::os::raw::c_void,
+        id: ::std::os::raw::c_uint,
+    ) -> ::std::os::raw::c_uint;
+}
+extern "C" {
+    pub fn set_deduplication(instance: *mut ::std::os::raw::c_void, enabled: ::std::os::raw::c_uint);
+}
+extern "C" {
+    pub fn start_capture(
+        instance: *mut ::std::os::raw::c_void,
+        path: *const ::std::os::raw::c_char,
+        compress: ::std::os::raw::c_uint,
+    ) -> ::std::os::raw::c_uint;
+}
+extern "C" {
+    pub fn stop_capture(instance: *mut ::std::os::raw::c_void);
+}
+extern "C" {
+    pub fn capture_gpu_frames(
+        instance: *mut ::std::os::raw::c_void,
+        directory: *const ::std::os::raw::c_char,
+        frames: ::std::os::raw::c_uint,
+    ) -> ::std::os::raw::c_uint;
+}
+extern "C" {
+    pub fn set_gpu_capture_trigger(
+        instance: *mut ::std::os::raw::c_void,
+        directory: *const ::std::os::raw::c_char,
+        threshold_ms: f32,
+        frames: ::std::os::raw::c_uint,
+    );
+}
+extern "C" {
+    pub fn set_performance_hud(instance: *mut ::std::os::raw::c_void, enabled: ::std::os::raw::c_uint);
+}
+extern "C" {
+    pub fn get_frame_pacing(instance: *mut ::std::os::raw::c_void, stats: *mut FramePacingStats);
+}
+extern "C" {
+    pub fn reset_frame_pacing(instance: *mut ::std::os::raw::c_void);
+}
+extern "C" {
+    pub fn set_mesh_profiling(instance: *mut ::std::os::raw::c_void, enabled: ::std::os::raw::c_uint);
+}
+extern "C" {
+    pub fn get_mesh_costs(instance: *mut ::std::os::raw::c_void, stats: *mut MeshCostStats);
+}
+extern "C" {
+    pub fn start_trace(instance: *mut ::std::os::raw::c_void, capacity: ::std::os::raw::c_uint);
+}
+extern "C" {
+    pub fn stop_trace(instance: *mut ::std::os::raw::c_void);
+}
+extern "C" {
+    pub fn write_trace(
+        instance: *mut ::std::os::raw::c_void,
+        path: *const ::std::os::raw::c_char,
+        format: TraceFormat,
+    ) -> ::std::os::raw::c_uint;
+}
+extern "C" {
+    pub fn get_trace_time(instance: *mut ::std::os::raw::c_void) -> ::std::os::raw::c_ulonglong;
+}
+extern "C" {
+    pub fn add_trace_span(
+        instance: *mut ::std::os::raw::c_void,
+        name: *const ::std::os::raw::c_char,
+        start_ns: ::std::os::raw::c_ulonglong,
+        end_ns: ::std::os::raw::c_ulonglong,
+    );
+}
 pub type __builtin_va_list = [__va_list_tag; 1usize];
 #[repr(C)]
 #[derive(Debug, Copy, Clone)]
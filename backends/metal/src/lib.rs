@@ -3,6 +3,39 @@ use rfw::prelude::*;
 #[allow(dead_code, non_snake_case, improper_ctypes, non_camel_case_types)]
 mod ffi;
 
+// Types handed to the library without conversion, which library.h lays out the same way. Field offsets and the layout
+// of slices are checked by test_layout.
+macro_rules! assert_size {
+    ($rust:ty, $c:ty) => {
+        const _: [(); std::mem::size_of::<$rust>()] = [(); std::mem::size_of::<$c>()];
+    };
+}
+
+assert_size!(Mat4, ffi::matrix_float4x4);
+assert_size!(CameraView3D, ffi::CameraView3D);
+assert_size!(Vertex2D, ffi::Vertex2D);
+assert_size!(Vertex3D, ffi::Vertex3D);
+assert_size!(RTTriangle, ffi::RTTriangle);
+assert_size!(VertexMesh, ffi::VertexRange);
+assert_size!(JointData, ffi::JointData);
+assert_size!(DeviceMaterial, ffi::DeviceMaterial);
+assert_size!(PointLight, ffi::PointLight);
+assert_size!(SpotLight, ffi::SpotLight);
+assert_size!(DirectionalLight, ffi::DirectionalLight);
+assert_size!(TextureData<'static>, ffi::TextureData);
+assert_size!(SkinData<'static>, ffi::SkinData);
+assert_size!(usize, ffi::size_t);
+
+// Words of a bitset and its length in bits as library.h takes them. Bits are numbered from the least significant bit
+// of each word on like those of bitvec's default order, bitsets borrowed whole from a BitVec start at the first bit of
+// their first word.
+fn bitset(bits: &BitSlice) -> (*const ffi::size_t, u32) {
+    (
+        bits.as_raw_slice().as_ptr() as *const ffi::size_t,
+        bits.len() as u32,
+    )
+}
+
 #[derive(Default)]
 #[repr(C)]
 pub struct CameraUniform {
@@ -44,10 +77,35 @@ impl FromWindowHandle for MetalBackend {
 
         #[cfg(target_os = "ios")]
         {
-            todo!()
+            match window.raw_window_handle() {
+                RawWindowHandle::IOS(handle) => unsafe {
+                    instance = ffi::create_instance_in_view(
+                        handle.ui_view,
+                        width,
+                        height,
+                        scale_factor,
+                        std::ptr::null(),
+                    );
+                },
+                _ => panic!("Unsupported type of window handle."),
+            }
         }
 
         if !instance.is_null() {
+            // Synchronize runs in the background while the scene of the next frame is updated, so the data of the
+            // scene is copied when it is set rather than read until synchronize is done.
+            unsafe {
+                ffi::set_copy_on_submit(instance, 1);
+            }
+
+            // Captures the calls of the backend into the file RFW_METAL_CAPTURE names, for MetalCppReplay.
+            if let Some(path) = std::env::var_os("RFW_METAL_CAPTURE") {
+                let path = std::ffi::CString::new(path.to_string_lossy().as_bytes()).unwrap();
+                if unsafe { ffi::start_capture(instance, path.as_ptr(), 1) } == 0 {
+                    eprintln!("Could not capture into {:?}", path);
+                }
+            }
+
             Ok(Box::new(Self { instance }))
         } else {
             panic!("Could not initialize Metal renderer.");
@@ -105,10 +163,16 @@ impl Backend for MetalBackend {
                     num_triangles: data.triangles.len() as _,
                     ranges: data.ranges.as_ptr() as *const ffi::VertexRange,
                     num_ranges: data.ranges.len() as _,
-                    skin_data: data.skin_data.as_ptr() as *const ffi::JointData,
+                    skin_data: if data.skin_data.is_empty() {
+                        std::ptr::null()
+                    } else {
+                        data.skin_data.as_ptr() as *const ffi::JointData
+                    },
                     flags: std::ptr::read((&data.flags) as *const Mesh3dFlags as *const u32),
                     __bindgen_padding_0: [],
                     bounds,
+                    indices: std::ptr::null(),
+                    num_indices: 0,
                 },
             );
         }
@@ -116,8 +180,11 @@ impl Backend for MetalBackend {
 
     fn unload_3d_meshes(&mut self, ids: &[usize]) {
         unsafe {
-            let ids = ids.iter().copied().map(|i| i as u32).collect::<Vec<_>>();
-            ffi::unload_3d_meshes(self.instance, ids.as_ptr(), ids.len() as _);
+            ffi::unload_3d_meshes(
+                self.instance,
+                ids.as_ptr() as *const ffi::size_t,
+                ids.len() as _,
+            );
         }
     }
 
@@ -149,94 +216,64 @@ impl Backend for MetalBackend {
         }
     }
 
-    fn set_materials(&mut self, materials: &[DeviceMaterial], _changed: &BitSlice) {
+    fn set_materials(&mut self, materials: &[DeviceMaterial], changed: &BitSlice) {
+        let (changed, num_changed) = bitset(changed);
         unsafe {
             ffi::set_materials(
                 self.instance,
                 materials.as_ptr() as *const ffi::DeviceMaterial,
                 materials.len() as _,
+                changed,
+                num_changed,
             );
         }
     }
 
     fn set_textures(&mut self, textures: &[TextureData<'_>], changed: &BitSlice) {
-        let textures = textures
-            .iter()
-            .map(|t| ffi::TextureData {
-                width: t.width,
-                height: t.height,
-                mip_levels: t.mip_levels,
-                bytes: t.bytes.as_ptr(),
-                format: unsafe {
-                    std::ptr::read(&t.format as *const DataFormat as *const ffi::DataFormat)
-                },
-            })
-            .collect::<Vec<ffi::TextureData>>();
-
-        let changed = changed
-            .iter()
-            .take(textures.len())
-            .map(|i| if *i { 1 } else { 0 })
-            .collect::<Vec<u32>>();
+        let (changed, num_changed) = bitset(changed);
         unsafe {
             ffi::set_textures(
                 self.instance,
-                textures.as_ptr(),
+                textures.as_ptr() as *const ffi::TextureData,
                 textures.len() as _,
-                changed.as_ptr(),
+                changed,
+                num_changed,
             );
         }
     }
 
     fn synchronize(&mut self) {
+        // Returns right away and render waits for it, what is set in the meantime is applied by the next one.
         unsafe {
-            ffi::synchronize(self.instance);
+            ffi::synchronize_async(self.instance);
         }
     }
 
-    fn render(&mut self, camera_2d: CameraView2D, camera: CameraView3D, _mode: RenderMode) {
+    fn render(&mut self, camera_2d: CameraView2D, camera: CameraView3D, mode: RenderMode) {
+        let mode = match mode {
+            RenderMode::Normal => ffi::RenderMode3D::RENDER_NORMAL,
+            RenderMode::Albedo => ffi::RenderMode3D::RENDER_ALBEDO,
+            RenderMode::GBuffer => ffi::RenderMode3D::RENDER_GBUFFER,
+            RenderMode::Ssao => ffi::RenderMode3D::RENDER_SSAO,
+            RenderMode::FilteredSsao => ffi::RenderMode3D::RENDER_FILTERED_SSAO,
+            RenderMode::Overdraw => ffi::RenderMode3D::RENDER_OVERDRAW,
+            _ => ffi::RenderMode3D::RENDER_DEFAULT,
+        };
+
+        // Occlusion is computed in screen space, which stays enabled once it was shown.
+        if mode == ffi::RenderMode3D::RENDER_SSAO || mode == ffi::RenderMode3D::RENDER_FILTERED_SSAO
+        {
+            unsafe {
+                ffi::set_ssao(self.instance, 1);
+            }
+        }
+
         unsafe {
             ffi::render(
                 self.instance,
                 std::ptr::read(&camera_2d.matrix as *const Mat4 as *const ffi::matrix_float4x4),
-                ffi::CameraView3D {
-                    pos: ffi::Vector3 {
-                        x: camera.pos.x,
-                        y: camera.pos.y,
-                        z: camera.pos.z,
-                    },
-                    right: ffi::Vector3 {
-                        x: camera.right.x,
-                        y: camera.right.y,
-                        z: camera.right.z,
-                    },
-                    up: ffi::Vector3 {
-                        x: camera.up.x,
-                        y: camera.up.y,
-                        z: camera.up.z,
-                    },
-                    p1: ffi::Vector3 {
-                        x: camera.p1.x,
-                        y: camera.p1.y,
-                        z: camera.p1.z,
-                    },
-                    direction: ffi::Vector3 {
-                        x: camera.direction.x,
-                        y: camera.direction.y,
-                        z: camera.direction.z,
-                    },
-                    lens_size: camera.lens_size,
-                    spread_angle: camera.spread_angle,
-                    epsilon: camera.epsilon,
-                    inv_width: camera.inv_width,
-                    inv_height: camera.inv_height,
-                    near_plane: camera.near_plane,
-                    far_plane: camera.far_plane,
-                    aspect_ratio: camera.aspect_ratio,
-                    fov: camera.fov,
-                    custom0: Default::default(),
-                    custom1: Default::default(),
-                },
+                std::ptr::read(&camera as *const CameraView3D as *const ffi::CameraView3D),
+                mode,
             );
         }
     }
@@ -247,17 +284,81 @@ impl Backend for MetalBackend {
         }
     }
 
-    fn set_point_lights(&mut self, _lights: &[PointLight], _changed: &BitSlice) {}
+    fn set_point_lights(&mut self, lights: &[PointLight], _changed: &BitSlice) {
+        unsafe {
+            ffi::set_point_lights(
+                self.instance,
+                lights.as_ptr() as *const ffi::PointLight,
+                lights.len() as _,
+            );
+        }
+    }
 
-    fn set_spot_lights(&mut self, _lights: &[SpotLight], _changed: &BitSlice) {}
+    fn set_spot_lights(&mut self, lights: &[SpotLight], _changed: &BitSlice) {
+        unsafe {
+            ffi::set_spot_lights(
+                self.instance,
+                lights.as_ptr() as *const ffi::SpotLight,
+                lights.len() as _,
+            );
+        }
+    }
+
+    fn set_area_lights(&mut self, lights: &[AreaLight], _changed: &BitSlice) {
+        unsafe {
+            ffi::set_area_lights(
+                self.instance,
+                lights.as_ptr() as *const ffi::AreaLight,
+                lights.len() as _,
+            );
+        }
+    }
+
+    fn set_directional_lights(&mut self, lights: &[DirectionalLight], _changed: &BitSlice) {
+        unsafe {
+            ffi::set_directional_lights(
+                self.instance,
+                lights.as_ptr() as *const ffi::DirectionalLight,
+                lights.len() as _,
+            );
+        }
+    }
 
-    fn set_area_lights(&mut self, _lights: &[AreaLight], _changed: &BitSlice) {}
+    fn set_skybox(&mut self, skybox: TextureData<'_>) {
+        unsafe {
+            ffi::set_skybox(
+                self.instance,
+                std::ptr::read(&skybox as *const TextureData as *const ffi::TextureData),
+            );
+        }
+    }
 
-    fn set_directional_lights(&mut self, _lights: &[DirectionalLight], _changed: &BitSlice) {}
+    fn set_skins(&mut self, skins: &[SkinData<'_>], changed: &BitSlice) {
+        let (changed, num_changed) = bitset(changed);
+        unsafe {
+            ffi::set_skins(
+                self.instance,
+                skins.as_ptr() as *const ffi::SkinData,
+                skins.len() as _,
+                changed,
+                num_changed,
+            );
+        }
+    }
 
-    fn set_skybox(&mut self, _skybox: TextureData<'_>) {}
+    fn stats(&self) -> BackendStats {
+        let mut frame = ffi::FrameStats::default();
+        let mut memory = ffi::MemoryStats::default();
+        unsafe {
+            ffi::get_frame_stats(self.instance, &mut frame);
+            ffi::get_memory_stats(self.instance, &mut memory);
+        }
 
-    fn set_skins(&mut self, _skins: &[SkinData<'_>], _changed: &BitSlice) {}
+        BackendStats {
+            gpu_ms: Some(frame.frame_ms),
+            memory_bytes: Some(memory.bytes.iter().sum()),
+        }
+    }
 }
 
 impl Drop for MetalBackend {
@@ -344,5 +445,57 @@ mod tests {
             std::mem::size_of::<RTTriangle>(),
             std::mem::size_of::<ffi::RTTriangle>()
         );
+        assert_eq!(
+            std::mem::size_of::<PointLight>(),
+            std::mem::size_of::<ffi::PointLight>()
+        );
+        assert_eq!(
+            std::mem::size_of::<SpotLight>(),
+            std::mem::size_of::<ffi::SpotLight>()
+        );
+        assert_eq!(
+            std::mem::size_of::<DirectionalLight>(),
+            std::mem::size_of::<ffi::DirectionalLight>()
+        );
+    }
+
+    #[test]
+    fn test_slices() {
+        use crate::ffi;
+
+        let bytes = [0u8; 3];
+        let texture = TextureData {
+            width: 1,
+            height: 1,
+            mip_levels: 1,
+            bytes: &bytes,
+            format: DataFormat::RGBA8,
+        };
+        let view = unsafe { &*(&texture as *const TextureData as *const ffi::TextureData) };
+        assert_eq!(view.width, 1);
+        assert_eq!(view.mip_levels, 1);
+        assert_eq!(view.bytes, bytes.as_ptr());
+        assert_eq!(view.num_bytes, 3);
+        assert_eq!(view.format as u32, DataFormat::RGBA8 as u32);
+
+        let matrices = [Mat4::default(); 2];
+        let skin = SkinData {
+            name: "skin",
+            inverse_bind_matrices: &matrices[..1],
+            joint_matrices: &matrices,
+        };
+        let view = unsafe { &*(&skin as *const SkinData as *const ffi::SkinData) };
+        assert_eq!(view.name_length, 4);
+        assert_eq!(view.num_inverse_bind_matrices, 1);
+        assert_eq!(view.joint_matrices as *const Mat4, matrices.as_ptr());
+        assert_eq!(view.num_joint_matrices, 2);
+
+        let mut bits: BitVec = BitVec::repeat(false, 70);
+        bits.set(3, true);
+        bits.set(65, true);
+        let (words, num_bits) = crate::bitset(&bits);
+        assert_eq!(num_bits, 70);
+        assert_eq!(unsafe { *words }, 1 << 3);
+        assert_eq!(unsafe { *words.add(1) }, 1 << 1);
     }
 }
@@ -720,7 +720,7 @@ impl Backend for WgpuBackend {
                 &self.output.output_texture_view,
                 &mut output_encoder,
                 match mode {
-                    RenderMode::Default => WgpuView::Output,
+                    RenderMode::Default | RenderMode::Overdraw => WgpuView::Output,
                     RenderMode::Normal => WgpuView::Normal,
                     RenderMode::Albedo => WgpuView::Albedo,
                     RenderMode::GBuffer => WgpuView::GBuffer,
@@ -15,6 +15,8 @@ pub enum RenderMode {
     ScreenSpace = 4,
     Ssao = 5,
     FilteredSsao = 6,
+    /// Fragments drawn per pixel as a heatmap, backends without it render the default view.
+    Overdraw = 7,
 }
 
 impl Default for RenderMode {
@@ -79,4 +81,9 @@ pub trait Backend {
 
     // Sets skins
     fn set_skins(&mut self, skins: &[SkinData<'_>], changed: &BitSlice);
+
+    /// Returns statistics of the last completed frame, backends that measure nothing report none
+    fn stats(&self) -> BackendStats {
+        BackendStats::default()
+    }
 }
@@ -4,6 +4,7 @@ use rtbvh::*;
 use std::{fmt::Debug, write};
 
 #[derive(Debug, Copy, Clone)]
+#[repr(C)]
 pub struct SkinData<'a> {
     pub name: &'a str,
     pub inverse_bind_matrices: &'a [Mat4],
@@ -192,6 +193,32 @@ impl From<SkinID> for usize {
 pub enum DataFormat {
     BGRA8 = 0,
     RGBA8 = 1,
+    /// Block compressed formats, bytes contain the blocks of every mip level back to back.
+    BC1RGBA = 2,
+    BC2RGBA = 3,
+    BC3RGBA = 4,
+    BC4R = 5,
+    BC5RG = 6,
+    BC6HRGBUfloat = 7,
+    BC7RGBA = 8,
+    ASTC4x4 = 9,
+    ASTC6x6 = 10,
+    ASTC8x8 = 11,
+    /// Gray and gray with alpha, one and two bytes per texel.
+    R8 = 12,
+    RG8 = 13,
+    /// Colors encoded in sRGB, converted to linear when they are sampled.
+    BGRA8SRGB = 14,
+    RGBA8SRGB = 15,
+    BC1RGBASRGB = 16,
+    BC2RGBASRGB = 17,
+    BC3RGBASRGB = 18,
+    BC7RGBASRGB = 19,
+    ASTC4x4SRGB = 20,
+    ASTC6x6SRGB = 21,
+    ASTC8x8SRGB = 22,
+    /// A whole KTX2 file, which gives the size, levels and format itself. Only read by the Metal backend.
+    KTX2 = 23,
 }
 
 #[derive(Debug, Copy, Clone, Eq, PartialEq, Hash)]
@@ -476,6 +503,16 @@ impl DeviceMaterial {
     }
 }
 
+/// Timings and memory usage a backend reports for its most recently completed frame.
+/// Fields are `None` when a backend has no way of measuring them.
+#[derive(Default, Debug, Copy, Clone, PartialEq)]
+pub struct BackendStats {
+    /// GPU time of the last completed frame in milliseconds
+    pub gpu_ms: Option<f32>,
+    /// Bytes of device memory allocated by the backend
+    pub memory_bytes: Option<u64>,
+}
+
 #[derive(Default, Debug, Copy, Clone)]
 pub struct CameraView2D {
     pub matrix: Mat4,
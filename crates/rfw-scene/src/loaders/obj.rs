@@ -3,6 +3,7 @@ use crate::{
     Mesh3dFlags, SceneError, {LoadResult, Mesh3D, ObjectLoader},
 };
 use l3d::mat::{Flip, Texture, TextureSource};
+use rayon::prelude::*;
 use rfw_backend::MeshId3D;
 use rfw_math::*;
 use rfw_utils::collections::TrackedStorage;
@@ -45,6 +46,8 @@ impl ObjectLoader for ObjLoader {
         let (models, materials) = object.unwrap();
         let materials = materials.unwrap_or_default();
         let mut material_indices = vec![0; materials.len()];
+        let mut descriptors = Vec::with_capacity(materials.len());
+        let mut texture_paths = Vec::new();
 
         for (i, material) in materials.iter().enumerate() {
             let mut color = Vec3::from(material.diffuse);
@@ -147,11 +150,20 @@ impl ObjectLoader for ObjLoader {
                 _ => None,
             };
 
-            let mat_index = mat_manager.add_with_maps(
+            for path in [&d_path, &n_path, &emissive_map, &sheen_map]
+                .iter()
+                .copied()
+                .flatten()
+            {
+                texture_paths.push((path.clone(), Flip::FlipV));
+            }
+
+            descriptors.push((
                 color,
                 roughness,
                 specular,
                 opacity,
+                eta,
                 TextureDescriptor {
                     albedo: if let Some(path) = d_path {
                         Some(TextureSource::Filesystem(path, Flip::FlipV))
@@ -175,7 +187,16 @@ impl ObjectLoader for ObjLoader {
                         None
                     },
                 },
-            );
+            ));
+        }
+
+        // Decode the texture files of all materials in parallel, the materials then find them already loaded
+        mat_manager.preload_textures(texture_paths);
+        for (i, (color, roughness, specular, opacity, eta, textures)) in
+            descriptors.into_iter().enumerate()
+        {
+            let mat_index =
+                mat_manager.add_with_maps(color, roughness, specular, opacity, textures);
             mat_manager.get_mut(mat_index, |m| {
                 if let Some(mat) = m {
                     mat.eta = eta;
@@ -195,52 +216,64 @@ impl ObjectLoader for ObjLoader {
         }
 
         let num_vertices: usize = models.iter().map(|m| m.mesh.indices.len()).sum();
+        let num_triangles: usize = models.iter().map(|m| (m.mesh.indices.len() + 2) / 3).sum();
 
-        let mut vertices = Vec::with_capacity(num_vertices);
-        let mut normals = Vec::with_capacity(num_vertices);
-        let mut uvs = Vec::with_capacity(num_vertices);
-        let mut material_ids = Vec::with_capacity(num_vertices);
+        let mut vertices = vec![Vec3::ZERO; num_vertices];
+        let mut normals = vec![Vec3::ZERO; num_vertices];
+        let mut uvs = vec![Vec2::ZERO; num_vertices];
+        let mut material_ids = vec![0_u32; num_triangles];
 
+        // Every model decodes into its own part of the arrays, in parallel and without copying
+        let mut parts = Vec::with_capacity(models.len());
+        let mut vertices_left = vertices.as_mut_slice();
+        let mut normals_left = normals.as_mut_slice();
+        let mut uvs_left = uvs.as_mut_slice();
+        let mut material_ids_left = material_ids.as_mut_slice();
         for m in models.iter() {
-            let mesh = &m.mesh;
-
-            for (i, idx) in mesh.indices.iter().copied().enumerate() {
-                let idx = idx as usize;
-                let i0 = 3 * idx;
-                let i1 = i0 + 1;
-                let i2 = i0 + 2;
+            let count = m.mesh.indices.len();
+            let (v, rest) = std::mem::take(&mut vertices_left).split_at_mut(count);
+            vertices_left = rest;
+            let (n, rest) = std::mem::take(&mut normals_left).split_at_mut(count);
+            normals_left = rest;
+            let (uv, rest) = std::mem::take(&mut uvs_left).split_at_mut(count);
+            uvs_left = rest;
+            let (ids, rest) = std::mem::take(&mut material_ids_left).split_at_mut((count + 2) / 3);
+            material_ids_left = rest;
+            parts.push((m, v, n, uv, ids));
+        }
 
-                let pos = [mesh.positions[i0], mesh.positions[i1], mesh.positions[i2]];
+        parts
+            .into_par_iter()
+            .for_each(|(m, vertices, normals, uvs, material_ids)| {
+                let mesh = &m.mesh;
 
-                let normal = if !mesh.normals.is_empty() {
-                    [mesh.normals[i0], mesh.normals[i1], mesh.normals[i2]]
-                } else {
-                    [0.0; 3]
-                };
-
-                let uv = if !mesh.texcoords.is_empty() {
-                    [mesh.texcoords[idx * 2], mesh.texcoords[idx * 2 + 1]]
-                } else {
-                    [0.0; 2]
-                };
+                for (i, idx) in mesh.indices.iter().copied().enumerate() {
+                    let idx = idx as usize;
+                    let i0 = 3 * idx;
+                    let i1 = i0 + 1;
+                    let i2 = i0 + 2;
 
-                vertices.push(pos.into());
-                normals.push(normal.into());
-                uvs.push(uv.into());
+                    vertices[i] =
+                        [mesh.positions[i0], mesh.positions[i1], mesh.positions[i2]].into();
 
-                if i % 3 == 0 {
-                    let material_id = if mesh.material_id.is_some() {
-                        *material_indices
-                            .get(mesh.material_id.unwrap())
-                            .unwrap_or(&0)
-                    } else {
-                        material_indices[0]
-                    };
+                    if !mesh.normals.is_empty() {
+                        normals[i] = [mesh.normals[i0], mesh.normals[i1], mesh.normals[i2]].into();
+                    }
 
-                    material_ids.push(material_id as u32);
+                    if !mesh.texcoords.is_empty() {
+                        uvs[i] = [mesh.texcoords[idx * 2], mesh.texcoords[idx * 2 + 1]].into();
+                    }
                 }
-            }
-        }
+
+                let material_id = if let Some(id) = mesh.material_id {
+                    *material_indices.get(id).unwrap_or(&0)
+                } else {
+                    material_indices[0]
+                };
+                material_ids
+                    .iter_mut()
+                    .for_each(|id| *id = material_id as u32);
+            });
 
         let mesh_id = mesh_storage.allocate();
         mesh_storage[mesh_id] = Mesh3D::new(
@@ -1,6 +1,7 @@
 use crate::{MaterialFlags, MaterialProps};
 use bitvec::prelude::*;
 use l3d::mat::{Flip, Material, Texture, TextureSource};
+use rayon::prelude::*;
 use rfw_backend::DeviceMaterial;
 use rfw_math::*;
 use rfw_utils::collections::{
@@ -636,6 +637,43 @@ impl Materials {
         };
     }
 
+    /// Decodes the textures at the given paths that aren't loaded yet on the rayon thread pool, so that
+    /// `get_texture_index` finds them without loading them one after another.
+    pub fn preload_textures(&mut self, paths: Vec<(PathBuf, Flip)>) {
+        let mut requested = HashSet::new();
+        let paths: Vec<(PathBuf, Flip)> = paths
+            .into_iter()
+            .filter(|(path, _)| {
+                !self.tex_path_mapping.contains_key(path) && requested.insert(path.clone())
+            })
+            .collect();
+
+        let loaded: Vec<(PathBuf, Option<Texture>)> = paths
+            .into_par_iter()
+            .map(|(path, flip)| {
+                let tex = Texture::load(&path, flip).ok().map(|mut tex| {
+                    if tex.width < 64 || tex.height < 64 {
+                        tex = tex.resized(64.max(tex.width), 64.max(tex.height));
+                    }
+
+                    tex.generate_mipmaps(Texture::MIP_LEVELS);
+                    tex
+                });
+                (path, tex)
+            })
+            .collect();
+
+        // Textures that fail to load are left to get_texture_index, which reports them
+        for (path, tex) in loaded {
+            if let Some(tex) = tex {
+                let index = self.textures.push(tex);
+                self.tex_material_mapping
+                    .overwrite_val(index, HashSet::new());
+                self.tex_path_mapping.insert(path, index);
+            }
+        }
+    }
+
     pub fn get_default(&self) -> usize {
         0
     }
@@ -139,6 +139,9 @@ fn render_mode_system(keys: Res<Input<VirtualKeyCode>>, mut system: ResMut<Rende
     if keys.just_pressed(VirtualKeyCode::Key7) {
         system.mode = RenderMode::FilteredSsao;
     }
+    if keys.just_pressed(VirtualKeyCode::Key8) {
+        system.mode = RenderMode::Overdraw;
+    }
 }
 
 struct CesiumMan;
@@ -0,0 +1,249 @@
+//! Benchmark of canonical scenes that runs on every backend through the same `Backend` interface,
+//! so backends can be compared with each other and between commits. Frames are rendered into a
+//! hidden window, per frame the CPU time of updating the scene, synchronizing it and rendering it
+//! is measured together with the GPU time and memory the backend reports. Results are printed as
+//! JSON in the format of the Metal backend's C++ benchmark.
+//!
+//! Usage: bench [--backend wgpu|metal] [--frames N] [--width W] [--height H] [--scenario NAME]
+//!
+//! Each scenario runs in a process of its own as windowing systems only allow a single event loop
+//! per process.
+mod scenes;
+
+use std::process::Command;
+
+const WARMUP_FRAMES: u32 = 10;
+
+struct Options {
+    backend: String,
+    frames: u32,
+    width: u32,
+    height: u32,
+}
+
+#[derive(Debug, Default, Copy, Clone)]
+struct Summary {
+    mean: f64,
+    p50: f64,
+    p95: f64,
+    max: f64,
+}
+
+fn summarize(mut values: Vec<f64>) -> Summary {
+    if values.is_empty() {
+        return Summary::default();
+    }
+
+    values.sort_by(|a, b| a.partial_cmp(b).unwrap());
+    Summary {
+        mean: values.iter().sum::<f64>() / values.len() as f64,
+        p50: values[values.len() / 2],
+        p95: values[(values.len() - 1).min(values.len() * 95 / 100)],
+        max: *values.last().unwrap(),
+    }
+}
+
+/// Samples of the measured frames of one scenario.
+#[derive(Default)]
+struct Samples {
+    /// Time of the scenario's scene changes
+    update_ms: Vec<f64>,
+    synchronize_ms: Vec<f64>,
+    render_ms: Vec<f64>,
+    /// Empty when the backend does not measure GPU time
+    gpu_ms: Vec<f64>,
+    /// Empty when the backend does not report its memory
+    memory_bytes: Vec<f64>,
+}
+
+fn run_frames(
+    instance: &mut rfw::Instance,
+    scenario: &mut dyn scenes::Scenario,
+    options: &Options,
+) -> Samples {
+    let mut samples = Samples::default();
+    for frame in 0..(WARMUP_FRAMES + options.frames) {
+        let timer = rfw::utils::Timer::new();
+        scenario.update(instance, frame, frame as f32 / 60.0);
+        let update_ms = timer.elapsed_in_millis();
+
+        instance.render();
+
+        if frame < WARMUP_FRAMES {
+            continue;
+        }
+
+        // Backend stats lag behind by the frames in flight, which evens out over the measured
+        // frames.
+        let system = instance
+            .get_resource::<rfw::system::RenderSystem>()
+            .unwrap();
+        let stats = system.backend_stats();
+        samples.update_ms.push(update_ms as f64);
+        samples.synchronize_ms.push(system.synchronize_ms() as f64);
+        samples.render_ms.push(system.render_ms() as f64);
+        if let Some(gpu_ms) = stats.gpu_ms {
+            samples.gpu_ms.push(gpu_ms as f64);
+        }
+        if let Some(memory_bytes) = stats.memory_bytes {
+            samples.memory_bytes.push(memory_bytes as f64);
+        }
+    }
+    samples
+}
+
+fn summary_json(name: &str, values: &[f64], last: bool) -> String {
+    let separator = if last { "" } else { "," };
+    if values.is_empty() {
+        return format!("      \"{}\": null{}\n", name, separator);
+    }
+
+    let summary = summarize(values.to_vec());
+    format!(
+        "      \"{}\": {{\"mean\": {:.4}, \"p50\": {:.4}, \"p95\": {:.4}, \"max\": {:.4}}}{}\n",
+        name, summary.mean, summary.p50, summary.p95, summary.max, separator
+    )
+}
+
+fn scenario_json(name: &str, params: &str, options: &Options, samples: &Samples) -> String {
+    let mut json = String::from("    {\n");
+    json += &format!("      \"name\": \"{}\",\n", name);
+    json += &format!("      \"backend\": \"{}\",\n", options.backend);
+    json += &format!("      \"params\": {{{}}},\n", params);
+    json += &summary_json("update_ms", &samples.update_ms, false);
+    json += &summary_json("synchronize_ms", &samples.synchronize_ms, false);
+    json += &summary_json("render_ms", &samples.render_ms, false);
+    json += &summary_json("gpu_ms", &samples.gpu_ms, false);
+    json += &summary_json("memory_bytes", &samples.memory_bytes, true);
+    json += "    }";
+    json
+}
+
+fn create_instance(options: &Options) -> rfw::Instance {
+    #[cfg(target_vendor = "apple")]
+    {
+        if options.backend == "metal" {
+            return rfw::Instance::new_hidden::<rfw_backend_metal::MetalBackend>(
+                options.width,
+                options.height,
+            );
+        }
+    }
+
+    rfw::Instance::new_hidden::<rfw_backend_wgpu::WgpuBackend>(options.width, options.height)
+}
+
+fn run_scenario(name: &str, options: &Options) -> String {
+    let mut scenario = scenes::create(name).unwrap_or_else(|| panic!("Unknown scenario {}", name));
+    let mut instance = create_instance(options);
+    scenario.setup(&mut instance);
+    let samples = run_frames(&mut instance, scenario.as_mut(), options);
+    scenario_json(name, &scenario.params(), options, &samples)
+}
+
+/// Runs a scenario in a child process and returns its JSON object, or None when it failed.
+fn spawn_scenario(name: &str, options: &Options) -> Option<String> {
+    let output = Command::new(std::env::current_exe().ok()?)
+        .args(&["--backend", &options.backend])
+        .args(&["--frames", &options.frames.to_string()])
+        .args(&["--width", &options.width.to_string()])
+        .args(&["--height", &options.height.to_string()])
+        .args(&["--scenario", name, "--entry"])
+        .output()
+        .ok()?;
+
+    if !output.status.success() {
+        eprintln!(
+            "Scenario {} failed: {}",
+            name,
+            String::from_utf8_lossy(&output.stderr)
+        );
+        return None;
+    }
+
+    String::from_utf8(output.stdout)
+        .ok()
+        .map(|json| json.trim_end().to_string())
+}
+
+fn main() {
+    use clap::*;
+    let mut app = App::new("rfw benchmark")
+        .author("Mèir Noordermeer")
+        .about("Renders canonical scenes with a backend and prints frame timings as JSON.")
+        .arg(
+            Arg::with_name("frames")
+                .long("frames")
+                .takes_value(true)
+                .default_value("300"),
+        )
+        .arg(
+            Arg::with_name("width")
+                .long("width")
+                .takes_value(true)
+                .default_value("1280"),
+        )
+        .arg(
+            Arg::with_name("height")
+                .long("height")
+                .takes_value(true)
+                .default_value("720"),
+        )
+        .arg(
+            Arg::with_name("scenario")
+                .long("scenario")
+                .takes_value(true)
+                .possible_values(&scenes::NAMES),
+        )
+        .arg(Arg::with_name("entry").long("entry").hidden(true));
+
+    #[cfg(target_vendor = "apple")]
+    {
+        app = app.arg(
+            Arg::with_name("backend")
+                .long("backend")
+                .takes_value(true)
+                .default_value("wgpu")
+                .possible_values(&["wgpu", "metal"]),
+        );
+    }
+
+    #[cfg(not(target_vendor = "apple"))]
+    {
+        app = app.arg(
+            Arg::with_name("backend")
+                .long("backend")
+                .takes_value(true)
+                .default_value("wgpu")
+                .possible_values(&["wgpu"]),
+        );
+    }
+
+    let matches = app.get_matches();
+    let options = Options {
+        backend: matches.value_of("backend").unwrap().to_string(),
+        frames: value_t_or_exit!(matches, "frames", u32),
+        width: value_t_or_exit!(matches, "width", u32),
+        height: value_t_or_exit!(matches, "height", u32),
+    };
+
+    let entries: Vec<String> = match matches.value_of("scenario") {
+        Some(name) if matches.is_present("entry") => {
+            println!("{}", run_scenario(name, &options));
+            return;
+        }
+        Some(name) => vec![run_scenario(name, &options)],
+        None => scenes::NAMES
+            .iter()
+            .filter_map(|name| spawn_scenario(name, &options))
+            .collect(),
+    };
+
+    println!(
+        "{{\n  \"frames\": {},\n  \"width\": {},\n  \"height\": {},\n  \"scenarios\": [\n{}\n  ]\n}}",
+        options.frames,
+        options.width,
+        options.height,
+        entries.join(",\n")
+    );
+}
@@ -0,0 +1,525 @@
+use rfw::prelude::*;
+use rfw::Instance;
+
+const ASSETS: &str = concat!(env!("CARGO_MANIFEST_DIR"), "/../../assets/models");
+
+/// A canonical scene, built once through the scene API and updated every frame the way an
+/// application would.
+pub trait Scenario {
+    /// Parameters of the scene as JSON members, printed with its results.
+    fn params(&self) -> String;
+
+    fn setup(&mut self, instance: &mut Instance);
+
+    /// Changes the scene for frame, time is in seconds of a fixed 60 Hz clock so runs stay
+    /// comparable.
+    fn update(&mut self, instance: &mut Instance, frame: u32, time: f32);
+}
+
+pub const NAMES: [&str; 5] = ["interior", "city", "crowd", "ui", "textures"];
+
+pub fn create(name: &str) -> Option<Box<dyn Scenario>> {
+    match name {
+        "interior" => Some(Box::new(Interior::default())),
+        "city" => Some(Box::new(City::default())),
+        "crowd" => Some(Box::new(Crowd::default())),
+        "ui" => Some(Box::new(Ui::default())),
+        "textures" => Some(Box::new(Textures::default())),
+        _ => None,
+    }
+}
+
+fn load_texture(scene: &mut Scene, file: &str) -> i16 {
+    let path = format!("{}/sponza/textures/{}", ASSETS, file);
+    let texture =
+        Texture::load(&path, Flip::None).unwrap_or_else(|_| panic!("Could not load {}", path));
+    scene.get_materials_mut().push_texture(texture) as i16
+}
+
+fn textured_material(scene: &mut Scene, diffuse: &str, normal: &str) -> u32 {
+    let diffuse_tex = load_texture(scene, diffuse);
+    let normal_tex = load_texture(scene, normal);
+    scene.get_materials_mut().push(Material {
+        diffuse_tex,
+        normal_tex,
+        ..Material::default()
+    }) as u32
+}
+
+/// Unit cube centered on the origin with 36 unindexed vertices.
+fn cube(mat_id: u32) -> Mesh3D {
+    const FACES: [([f32; 3], [f32; 3], [f32; 3]); 6] = [
+        ([1.0, 0.0, 0.0], [0.0, 1.0, 0.0], [0.0, 0.0, -1.0]),
+        ([-1.0, 0.0, 0.0], [0.0, 1.0, 0.0], [0.0, 0.0, 1.0]),
+        ([0.0, 1.0, 0.0], [0.0, 0.0, -1.0], [1.0, 0.0, 0.0]),
+        ([0.0, -1.0, 0.0], [0.0, 0.0, 1.0], [1.0, 0.0, 0.0]),
+        ([0.0, 0.0, 1.0], [0.0, 1.0, 0.0], [1.0, 0.0, 0.0]),
+        ([0.0, 0.0, -1.0], [0.0, 1.0, 0.0], [-1.0, 0.0, 0.0]),
+    ];
+    const CORNERS: [(f32, f32); 6] = [
+        (-1.0, -1.0),
+        (1.0, -1.0),
+        (1.0, 1.0),
+        (-1.0, -1.0),
+        (1.0, 1.0),
+        (-1.0, 1.0),
+    ];
+
+    let mut vertices = Vec::with_capacity(36);
+    let mut normals = Vec::with_capacity(36);
+    let mut uvs = Vec::with_capacity(36);
+    for (normal, up, right) in FACES.iter() {
+        let (normal, up, right) = (Vec3::from(*normal), Vec3::from(*up), Vec3::from(*right));
+        for (u, v) in CORNERS.iter() {
+            vertices.push((normal + right * *u + up * *v) * 0.5);
+            normals.push(normal);
+            uvs.push(vec2(u * 0.5 + 0.5, v * 0.5 + 0.5));
+        }
+    }
+
+    Mesh3D::new(
+        vertices,
+        normals,
+        Vec::new(),
+        Vec::new(),
+        uvs,
+        vec![mat_id; 12],
+        Mesh3dFlags::default(),
+        Some("cube"),
+    )
+}
+
+fn add_instance(scene: &mut Scene, mesh: MeshId3D, transform: Mat4) {
+    scene
+        .add_3d_instance(mesh)
+        .expect("Could not add instance")
+        .set_matrix(transform);
+}
+
+fn look_at(instance: &mut Instance, origin: Vec3, target: Vec3) {
+    instance.get_camera_3d().look_at(origin, target);
+}
+
+/// Sponza-like interior: a two-storey colonnade around a courtyard with textured walls, floors and
+/// arches, lit by a row of point lights. Few meshes and instances, most of the cost is in shading
+/// and overdraw.
+#[derive(Default)]
+pub struct Interior {
+    length: f32,
+}
+
+impl Scenario for Interior {
+    fn params(&self) -> String {
+        "\"columns\": 48, \"lights\": 16".to_string()
+    }
+
+    fn setup(&mut self, instance: &mut Instance) {
+        let mut scene = instance.get_scene_mut();
+        let floor = textured_material(
+            &mut scene,
+            "sponza_floor_a_diff.tga",
+            "sponza_floor_a_ddn.tga",
+        );
+        let bricks = textured_material(
+            &mut scene,
+            "spnza_bricks_a_diff.tga",
+            "spnza_bricks_a_ddn.tga",
+        );
+        let column = textured_material(
+            &mut scene,
+            "sponza_column_a_diff.tga",
+            "sponza_column_a_ddn.tga",
+        );
+        let arch = textured_material(&mut scene, "sponza_arch_diff.tga", "sponza_arch_ddn.tga");
+        let curtain = textured_material(
+            &mut scene,
+            "sponza_curtain_diff.tga",
+            "sponza_curtain_ddn.tga",
+        );
+
+        let floor = scene.add_3d_object(cube(floor));
+        let bricks = scene.add_3d_object(cube(bricks));
+        let column =
+            scene.add_3d_object(Sphere::new(Vec3::ZERO, 1.0, column).with_quality(Quality::High));
+        let arch = scene.add_3d_object(cube(arch));
+        let curtain = scene.add_3d_object(cube(curtain));
+
+        self.length = 60.0;
+        let (length, width, storey) = (self.length, 20.0, 8.0);
+        add_instance(
+            &mut scene,
+            floor,
+            Mat4::from_scale_rotation_translation(
+                vec3(width, 0.2, length),
+                Quat::IDENTITY,
+                vec3(0.0, -0.1, 0.0),
+            ),
+        );
+        for side in [-1.0_f32, 1.0].iter() {
+            add_instance(
+                &mut scene,
+                bricks,
+                Mat4::from_scale_rotation_translation(
+                    vec3(0.5, storey * 2.0, length),
+                    Quat::IDENTITY,
+                    vec3(side * width * 0.5, storey, 0.0),
+                ),
+            );
+        }
+
+        for storey_index in 0..2 {
+            let y = storey_index as f32 * storey;
+            // Galleries between the colonnades and the outer walls, the courtyard stays open to the
+            // sky.
+            for side in [-1.0_f32, 1.0].iter() {
+                add_instance(
+                    &mut scene,
+                    floor,
+                    Mat4::from_scale_rotation_translation(
+                        vec3(width * 0.2, 0.3, length),
+                        Quat::IDENTITY,
+                        vec3(side * width * 0.4, y + storey, 0.0),
+                    ),
+                );
+            }
+
+            for i in 0..12 {
+                let z = (i as f32 + 0.5) / 12.0 * length - length * 0.5;
+                for side in [-1.0_f32, 1.0].iter() {
+                    let x = side * width * 0.3;
+                    add_instance(
+                        &mut scene,
+                        column,
+                        Mat4::from_scale_rotation_translation(
+                            vec3(0.4, storey * 0.5, 0.4),
+                            Quat::IDENTITY,
+                            vec3(x, y + storey * 0.5, z),
+                        ),
+                    );
+                    add_instance(
+                        &mut scene,
+                        arch,
+                        Mat4::from_scale_rotation_translation(
+                            vec3(0.6, 0.8, length / 12.0),
+                            Quat::IDENTITY,
+                            vec3(x, y + storey - 0.4, z),
+                        ),
+                    );
+                    if storey_index == 1 && i % 3 == 0 {
+                        add_instance(
+                            &mut scene,
+                            curtain,
+                            Mat4::from_scale_rotation_translation(
+                                vec3(0.05, storey * 0.6, 2.0),
+                                Quat::IDENTITY,
+                                vec3(x - side * 0.5, y + storey * 0.6, z),
+                            ),
+                        );
+                    }
+                }
+            }
+        }
+
+        for i in 0..16 {
+            let z = (i as f32 + 0.5) / 16.0 * length - length * 0.5;
+            scene.add_point_light(vec3(0.0, 3.0, z), vec3(8.0, 6.0, 4.0));
+        }
+        scene.add_directional_light(vec3(0.3, -1.0, 0.2), vec3(1.0, 0.95, 0.9));
+    }
+
+    fn update(&mut self, instance: &mut Instance, _frame: u32, time: f32) {
+        // Walk down the nave and back.
+        let z = (time * 0.2).sin() * self.length * 0.4;
+        look_at(
+            instance,
+            vec3(0.0, 2.0, z),
+            vec3((time * 0.5).sin() * 5.0, 4.0, z + 10.0),
+        );
+    }
+}
+
+/// 200k instances of 8 building meshes on a grid, all static, seen from a camera circling above the
+/// roofs. Stresses instance uploads, culling and draw submission.
+#[derive(Default)]
+pub struct City {}
+
+impl City {
+    const BLOCKS: u32 = 448;
+    const MESHES: u32 = 8;
+}
+
+impl Scenario for City {
+    fn params(&self) -> String {
+        format!(
+            "\"instances\": {}, \"meshes\": {}",
+            Self::BLOCKS * Self::BLOCKS,
+            Self::MESHES
+        )
+    }
+
+    fn setup(&mut self, instance: &mut Instance) {
+        let mut scene = instance.get_scene_mut();
+        let meshes: Vec<MeshId3D> = (0..Self::MESHES)
+            .map(|i| {
+                let t = i as f32 / Self::MESHES as f32;
+                let material = scene.get_materials_mut().add(
+                    vec3(0.4 + t * 0.5, 0.4, 0.9 - t * 0.5),
+                    0.6,
+                    Vec3::ONE,
+                    0.0,
+                );
+                scene.add_3d_object(cube(material as u32))
+            })
+            .collect();
+
+        let mut seed = 0x9e37_79b9_u32;
+        let mut random = move || {
+            seed ^= seed << 13;
+            seed ^= seed >> 17;
+            seed ^= seed << 5;
+            seed as f32 / u32::MAX as f32
+        };
+
+        let half = Self::BLOCKS as f32 * 0.5;
+        for x in 0..Self::BLOCKS {
+            for z in 0..Self::BLOCKS {
+                let mesh = meshes[((x * 7 + z * 13) % Self::MESHES) as usize];
+                let height = 1.0 + random() * random() * 12.0;
+                let position = vec3(
+                    (x as f32 - half) * 3.0,
+                    height * 0.5,
+                    (z as f32 - half) * 3.0,
+                );
+                add_instance(
+                    &mut scene,
+                    mesh,
+                    Mat4::from_scale_rotation_translation(
+                        vec3(2.0, height, 2.0),
+                        Quat::IDENTITY,
+                        position,
+                    ),
+                );
+            }
+        }
+
+        scene.add_directional_light(vec3(0.4, -1.0, 0.3), vec3(1.0, 0.95, 0.9));
+    }
+
+    fn update(&mut self, instance: &mut Instance, _frame: u32, time: f32) {
+        let radius = Self::BLOCKS as f32 * 0.75;
+        let angle = time * 0.1;
+        let origin = vec3(angle.cos() * radius, 60.0, angle.sin() * radius);
+        look_at(instance, origin, Vec3::ZERO);
+    }
+}
+
+/// A crowd of animated glTF characters, every instance has its own skin so joint matrices of all of
+/// them change every frame.
+#[derive(Default)]
+pub struct Crowd {}
+
+impl Crowd {
+    const ROWS: u32 = 32;
+}
+
+impl Scenario for Crowd {
+    fn params(&self) -> String {
+        format!("\"characters\": {}", Self::ROWS * Self::ROWS)
+    }
+
+    fn setup(&mut self, instance: &mut Instance) {
+        let mut scene = instance.get_scene_mut();
+        let path = format!("{}/CesiumMan/CesiumMan.gltf", ASSETS);
+        let character = scene
+            .load(&path)
+            .unwrap_or_else(|_| panic!("Could not load {}", path))
+            .scene()
+            .expect("Character is not a scene");
+
+        let half = Self::ROWS as f32 * 0.5;
+        for x in 0..Self::ROWS {
+            for z in 0..Self::ROWS {
+                let mut handle = scene.add_3d(&character);
+                handle
+                    .get_transform()
+                    .set_matrix(Mat4::from_translation(vec3(
+                        (x as f32 - half) * 1.5,
+                        0.0,
+                        (z as f32 - half) * 1.5,
+                    )));
+            }
+        }
+
+        let ground = scene
+            .get_materials_mut()
+            .add(vec3(0.5, 0.5, 0.5), 1.0, Vec3::ONE, 0.0);
+        let ground = scene.add_3d_object(cube(ground as u32));
+        add_instance(
+            &mut scene,
+            ground,
+            Mat4::from_scale_rotation_translation(
+                vec3(60.0, 0.1, 60.0),
+                Quat::IDENTITY,
+                vec3(0.0, -0.05, 0.0),
+            ),
+        );
+        scene.add_directional_light(vec3(0.2, -1.0, 0.4), vec3(1.0, 1.0, 1.0));
+    }
+
+    fn update(&mut self, instance: &mut Instance, _frame: u32, time: f32) {
+        instance.get_scene_mut().set_animations_time(time);
+        look_at(
+            instance,
+            vec3((time * 0.2).sin() * 10.0, 12.0, -30.0),
+            Vec3::ZERO,
+        );
+    }
+}
+
+/// 10k textured and colored 2D quads in 16 meshes, a quarter of them moving every frame like
+/// animated widgets.
+#[derive(Default)]
+pub struct Ui {
+    quads: Vec<(InstanceHandle2D, Vec2)>,
+}
+
+impl Ui {
+    const MESHES: u32 = 16;
+    const QUADS: u32 = 10_000;
+}
+
+impl Scenario for Ui {
+    fn params(&self) -> String {
+        format!("\"quads\": {}, \"meshes\": {}", Self::QUADS, Self::MESHES)
+    }
+
+    fn setup(&mut self, instance: &mut Instance) {
+        let (width, height) = {
+            let camera = instance.get_camera_2d();
+            (camera.width(), camera.height())
+        };
+
+        let mut scene = instance.get_scene_mut();
+        let texture = load_texture(&mut scene, "background.tga") as usize;
+        let meshes: Vec<MeshId2D> = (0..Self::MESHES)
+            .map(|i| {
+                let t = i as f32 / Self::MESHES as f32;
+                scene.add_2d(Quad2D {
+                    bottom_left: vec2(-8.0, -8.0),
+                    top_right: vec2(8.0, 8.0),
+                    layer: t,
+                    texture: if i % 2 == 0 { Some(texture) } else { None },
+                    color: vec4(t, 1.0 - t, 0.5, 0.9),
+                    ..Quad2D::default()
+                })
+            })
+            .collect();
+
+        let columns = (Self::QUADS as f32).sqrt().ceil() as u32;
+        self.quads = (0..Self::QUADS)
+            .map(|i| {
+                let mut handle = scene
+                    .add_2d_instance(meshes[(i % Self::MESHES) as usize])
+                    .expect("Could not add instance");
+                let position = vec2(
+                    ((i % columns) as f32 / columns as f32 - 0.5) * width,
+                    ((i / columns) as f32 / columns as f32 - 0.5) * height,
+                );
+                handle.set_matrix(Mat4::from_translation(position.extend(0.0)));
+                (handle, position)
+            })
+            .collect();
+    }
+
+    fn update(&mut self, _instance: &mut Instance, frame: u32, time: f32) {
+        // Handles write into the scene's instance lists directly.
+        for (i, (handle, position)) in self.quads.iter_mut().enumerate() {
+            if (i as u32 + frame) % 4 != 0 {
+                continue;
+            }
+            let offset = vec2((time + i as f32).sin(), (time + i as f32).cos()) * 4.0;
+            handle.set_matrix(Mat4::from_translation((*position + offset).extend(0.0)));
+        }
+    }
+}
+
+/// A level where every surface has its own diffuse and normal map: all textures of the Sponza set
+/// on a grid of blocks. Stresses texture uploads, residency and material binding.
+#[derive(Default)]
+pub struct Textures {
+    materials: u32,
+}
+
+impl Textures {
+    const MAPS: [(&'static str, &'static str); 18] = [
+        ("background.tga", "background_ddn.tga"),
+        ("chain_texture.tga", "chain_texture_ddn.tga"),
+        ("lion.tga", "lion_ddn.tga"),
+        ("spnza_bricks_a_diff.tga", "spnza_bricks_a_ddn.tga"),
+        ("sponza_arch_diff.tga", "sponza_arch_ddn.tga"),
+        ("sponza_ceiling_a_diff.tga", "sponza_ceiling_a_ddn.tga"),
+        ("sponza_column_a_diff.tga", "sponza_column_a_ddn.tga"),
+        ("sponza_column_b_diff.tga", "sponza_column_b_ddn.tga"),
+        ("sponza_column_c_diff.tga", "sponza_column_c_ddn.tga"),
+        ("sponza_curtain_diff.tga", "sponza_curtain_ddn.tga"),
+        ("sponza_curtain_blue_diff.tga", "sponza_curtain_ddn.tga"),
+        ("sponza_curtain_green_diff.tga", "sponza_curtain_ddn.tga"),
+        ("sponza_details_diff.tga", "sponza_details_ddn.tga"),
+        ("sponza_fabric_diff.tga", "sponza_fabric_ddn.tga"),
+        ("sponza_flagpole_diff.tga", "sponza_flagpole_ddn.tga"),
+        ("sponza_floor_a_diff.tga", "sponza_floor_a_ddn.tga"),
+        ("sponza_roof_diff.tga", "sponza_roof_ddn.tga"),
+        ("vase_dif.tga", "vase_ddn.tga"),
+    ];
+    const BLOCKS: u32 = 24;
+}
+
+impl Scenario for Textures {
+    fn params(&self) -> String {
+        format!(
+            "\"materials\": {}, \"blocks\": {}",
+            self.materials,
+            Self::BLOCKS * Self::BLOCKS
+        )
+    }
+
+    fn setup(&mut self, instance: &mut Instance) {
+        let mut scene = instance.get_scene_mut();
+        let meshes: Vec<MeshId3D> = Self::MAPS
+            .iter()
+            .map(|(diffuse, normal)| {
+                let material = textured_material(&mut scene, diffuse, normal);
+                scene.add_3d_object(cube(material))
+            })
+            .collect();
+        self.materials = meshes.len() as u32;
+
+        let half = Self::BLOCKS as f32 * 0.5;
+        for x in 0..Self::BLOCKS {
+            for z in 0..Self::BLOCKS {
+                let mesh = meshes[((x + z * Self::BLOCKS) as usize) % meshes.len()];
+                let position = vec3((x as f32 - half) * 4.0, 1.5, (z as f32 - half) * 4.0);
+                add_instance(
+                    &mut scene,
+                    mesh,
+                    Mat4::from_scale_rotation_translation(
+                        Vec3::splat(3.0),
+                        Quat::IDENTITY,
+                        position,
+                    ),
+                );
+            }
+        }
+
+        scene.add_directional_light(vec3(0.3, -1.0, 0.5), vec3(1.0, 1.0, 1.0));
+    }
+
+    fn update(&mut self, instance: &mut Instance, _frame: u32, time: f32) {
+        let angle = time * 0.15;
+        look_at(
+            instance,
+            vec3(angle.cos() * 30.0, 8.0, angle.sin() * 30.0),
+            Vec3::ZERO,
+        );
+    }
+}
@@ -105,11 +105,26 @@ pub struct Settings {
 
 impl Instance {
     pub fn new<T: 'static + Backend + FromWindowHandle>(width: u32, height: u32) -> Self {
+        Self::with_window::<T>(width, height, true)
+    }
+
+    /// Creates an instance with an invisible window, to drive frames through `render` without
+    /// presenting them, e.g. for benchmarks.
+    pub fn new_hidden<T: 'static + Backend + FromWindowHandle>(width: u32, height: u32) -> Self {
+        Self::with_window::<T>(width, height, false)
+    }
+
+    fn with_window<T: 'static + Backend + FromWindowHandle>(
+        width: u32,
+        height: u32,
+        visible: bool,
+    ) -> Self {
         env_logger::init();
         let event_loop = EventLoop::new();
         let window = winit::window::WindowBuilder::new()
             .with_inner_size(winit::dpi::LogicalSize::new(width, height))
             .with_title("rfw")
+            .with_visible(visible)
             .build(&event_loop)
             .expect("Could not create window.");
 
@@ -134,6 +149,8 @@ impl Instance {
             scale_factor: 1.0,
             renderer,
             mode: RenderMode::Default,
+            synchronize_ms: 0.0,
+            render_ms: 0.0,
         })
         .add_resource(bevy_tasks::ComputeTaskPool(
             bevy_tasks::TaskPoolBuilder::new().build(),
@@ -143,7 +160,11 @@ impl Instance {
         .add_resource(Camera2D::from_width_height(width, height, None))
         .add_resource(Input::<winit::event::VirtualKeyCode>::new())
         .add_resource(Input::<winit::event::MouseButton>::new())
-        .add_system_at_stage(ecs::CoreStage::PostUpdate, render_system.system());
+        .add_system_at_stage(ecs::CoreStage::PostUpdate, render_system.system())
+        .add_bundle(Events::<WindowEvent>::new())
+        .add_bundle(Events::<ResizeEvent>::new())
+        .add_bundle(InputBundle {})
+        .add_bundle(GameTimer::default());
 
         this
     }
@@ -285,6 +306,7 @@ impl Instance {
         system.scale_factor = scale_factor;
     }
 
+    /// Runs the systems of a single frame, which synchronizes the scene and renders it.
     pub fn render(&mut self) {
         self.scheduler.run(&mut self.world);
     }
@@ -298,12 +320,6 @@ impl Instance {
     }
 
     pub fn run(mut self, settings: Settings) {
-        // TODO: we need to make a proper distinction between what plugins and bundles are, instead of this mess..
-        self.add_bundle(Events::<WindowEvent>::new())
-            .add_bundle(Events::<ResizeEvent>::new())
-            .add_bundle(InputBundle {})
-            .add_bundle(GameTimer::default());
-
         let (event_loop, window, mut world, mut scheduler) =
             (self.event_loop, self.window, self.world, self.scheduler);
 
@@ -426,5 +442,7 @@ fn render_system(
     let view_2d = camera_2d.get_view();
     let view_3d = camera_3d.get_view(system.width, system.height);
     let mode = system.mode;
+    let timer = Timer::new();
     system.renderer.render(view_2d, view_3d, mode);
+    system.render_ms = timer.elapsed_in_millis();
 }
@@ -1,9 +1,11 @@
 use crate::backend::RenderMode;
 use crate::ecs::*;
 use crate::prelude::InstancesData3D;
-use rfw_backend::{Backend, DataFormat, MeshData2D, MeshData3D, SkinData, TextureData};
+use rfw_backend::{
+    Backend, BackendStats, DataFormat, MeshData2D, MeshData3D, SkinData, TextureData,
+};
 use rfw_scene::Scene;
-use rfw_utils::BytesConversion;
+use rfw_utils::{BytesConversion, Timer};
 
 pub struct RenderSystem {
     pub(crate) width: u32,
@@ -11,12 +13,15 @@ pub struct RenderSystem {
     pub(crate) scale_factor: f64,
     pub(crate) renderer: Box<dyn Backend>,
     pub mode: RenderMode,
+    pub(crate) synchronize_ms: f32,
+    pub(crate) render_ms: f32,
 }
 
 unsafe impl Send for RenderSystem {}
 unsafe impl Sync for RenderSystem {}
 
 fn synchronize_system(mut system: ResMut<RenderSystem>, mut scene: ResMut<Scene>) {
+    let timer = Timer::new();
     let mut changed = false;
     let mut update_lights = false;
     let mut found_light = false;
@@ -203,6 +208,8 @@ fn synchronize_system(mut system: ResMut<RenderSystem>, mut scene: ResMut<Scene>
     if changed {
         system.renderer.synchronize();
     }
+
+    system.synchronize_ms = timer.elapsed_in_millis();
 }
 
 impl RenderSystem {
@@ -226,6 +233,20 @@ impl RenderSystem {
         self.scale_factor
     }
 
+    /// CPU milliseconds the last frame spent synchronizing the scene with the backend
+    pub fn synchronize_ms(&self) -> f32 {
+        self.synchronize_ms
+    }
+
+    /// CPU milliseconds the last frame spent in the backend's render call
+    pub fn render_ms(&self) -> f32 {
+        self.render_ms
+    }
+
+    pub fn backend_stats(&self) -> BackendStats {
+        self.renderer.stats()
+    }
+
     pub fn resize(&mut self, width: u32, height: u32, scale_factor: Option<f64>) {
         let scale_factor = scale_factor.unwrap_or(self.scale_factor);
         self.renderer.resize((width, height), scale_factor);